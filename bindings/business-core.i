@@ -115,6 +115,9 @@ GLIST_HELPER_INOUT(OwnerList, SWIGTYPE_p__gncOwner);
 #endif
 
 
+%ignore gncOwnerGetAging;
+%ignore gncOwnerAgingFree;
+
 /* Parse the header files to generate wrappers */
 %include <gncAddress.h>
 %include <gncBillTerm.h>
@@ -130,6 +133,45 @@ GLIST_HELPER_INOUT(OwnerList, SWIGTYPE_p__gncOwner);
 %include <gncVendor.h>
 #if defined(SWIGGUILE)
 %include <gnc-engine-guile.h>
+
+/* gncOwnerGetAging taking the bounds as a list of time64s.  It returns
+ * a list with a list of the owner, the buckets and their total for each
+ * owner.  The owners are new; free them with gncOwnerFree. */
+%inline %{
+static SCM
+gncOwnerGetAgingList (Account *account, time64 date, SCM bounds,
+                      gboolean use_due_date)
+{
+    guint n_bounds = scm_to_uint (scm_length (bounds));
+    time64 *values = g_new (time64, n_bounds ? n_bounds : 1);
+    GList *agings, *node;
+    SCM list = SCM_EOL;
+    guint i;
+
+    for (i = 0; i < n_bounds; ++i, bounds = SCM_CDR (bounds))
+        values[i] = scm_to_int64 (SCM_CAR (bounds));
+    agings = gncOwnerGetAging (account, date, values, n_bounds, use_due_date);
+    g_free (values);
+
+    for (node = agings; node; node = node->next)
+    {
+        GncOwnerAging *aging = node->data;
+        GncOwner *owner = gncOwnerNew ();
+        SCM buckets = SCM_EOL;
+
+        gncOwnerCopy (&aging->owner, owner);
+        for (i = aging->n_buckets; i--;)
+            buckets = scm_cons (gnc_numeric_to_scm (aging->buckets[i]), buckets);
+        list = scm_cons (scm_list_3 (SWIG_NewPointerObj (owner,
+                                                         SWIGTYPE_p__gncOwner, 0),
+                                     buckets,
+                                     gnc_numeric_to_scm (aging->total)),
+                         list);
+    }
+    gncOwnerAgingFree (agings);
+    return scm_reverse (list);
+}
+%}
 #endif
 /* Import query bindings for the below invoice query functions (but
  * don't generate bindings for them). */
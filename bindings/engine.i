@@ -26,6 +26,7 @@
 #include "qof.h"
 #include "qoflog.h"
 #include "Query.h"
+#include "gnc-book-archive.h"
 #include "gnc-budget.h"
 #include "gnc-commodity.h"
 #include "gnc-engine.h"
@@ -33,6 +34,8 @@
 #include "gnc-pricedb.h"
 #include "gnc-lot.h"
 #include "gnc-session.h"
+#include "gnc-split-table.h"
+#include "gnc-portfolio.h"
 #include "engine-helpers.h"
 #include "gnc-engine-guile.h"
 #include "policy.h"
@@ -77,6 +80,7 @@ declarations in the header files, some of which are included by
 engine-common.i */
 
 %newobject gnc_account_get_full_name;
+%ignore xaccAccountsGetBalancesAsOfDates;
 
 %include "engine-common.i"
 
@@ -179,8 +183,90 @@ functions. */
 %typemap(in) char * action;
 
 %include <policy.h>
+%ignore gnc_pricedb_build_price_table;
+%ignore gnc_pricedb_add_prices;
 %include <gnc-pricedb.h>
 
+/* List version of gnc_pricedb_add_prices. The db takes its own reference
+ * to each price it adds. */
+%inline {
+static guint
+gnc_pricedb_add_price_list (GNCPriceDB *db, PriceList *prices)
+{
+    guint n_prices = g_list_length (prices);
+    GNCPrice **array = g_new (GNCPrice *, n_prices ? n_prices : 1);
+    guint i = 0, added;
+    GList *node;
+
+    for (node = prices; node; node = node->next)
+        array[i++] = node->data;
+    added = gnc_pricedb_add_prices (db, array, n_prices);
+    g_free (array);
+    g_list_free (prices);
+    return added;
+}
+}
+
+/* List version of gnc_pricedb_build_price_table taking the dates as a list
+ * of time64s. The table isn't garbage collected; free it with
+ * gnc-price-table-destroy. */
+%inline {
+static GNCPriceTable *
+gnc_pricedb_build_price_table_list (GNCPriceDB *db, CommodityList *commodities,
+                                    SCM dates, gnc_commodity *report_currency)
+{
+    guint n_dates = scm_to_uint (scm_length (dates));
+    time64 *values = g_new (time64, n_dates ? n_dates : 1);
+    GNCPriceTable *table;
+    guint i;
+
+    for (i = 0; i < n_dates; ++i, dates = SCM_CDR (dates))
+        values[i] = scm_to_int64 (SCM_CAR (dates));
+    table = gnc_pricedb_build_price_table (db, commodities, values, n_dates,
+                                           report_currency);
+    g_free (values);
+    g_list_free (commodities);
+    return table;
+}
+}
+
+/* List version of xaccAccountsGetBalancesAsOfDates taking the dates as
+ * an ascending list of time64s and the exchange-rate table or #f. It
+ * returns a list with the list of balances of each account. */
+%inline {
+static SCM
+xaccAccountsGetBalancesAsOfDatesList (AccountList *accounts, SCM dates,
+                                      gboolean include_children, SCM rates)
+{
+    guint n_dates = scm_to_uint (scm_length (dates));
+    guint n_accounts = g_list_length (accounts);
+    time64 *values = g_new (time64, n_dates ? n_dates : 1);
+    gnc_numeric *balances = g_new (gnc_numeric,
+                                   n_accounts * n_dates ? n_accounts * n_dates : 1);
+    GNCPriceTable *table = NULL;
+    SCM list = SCM_EOL;
+    guint i, j;
+
+    if (scm_is_true (rates))
+        table = SWIG_MustGetPtr (rates, SWIGTYPE_p_gnc_price_table_s, 4, 0);
+    for (i = 0; i < n_dates; ++i, dates = SCM_CDR (dates))
+        values[i] = scm_to_int64 (SCM_CAR (dates));
+    xaccAccountsGetBalancesAsOfDates (accounts, values, n_dates,
+                                      include_children, table, balances);
+    for (i = n_accounts; i--;)
+    {
+        SCM row = SCM_EOL;
+        for (j = n_dates; j--;)
+            row = scm_cons (gnc_numeric_to_scm (balances[i * n_dates + j]), row);
+        list = scm_cons (row, list);
+    }
+    g_free (values);
+    g_free (balances);
+    g_list_free (accounts);
+    return list;
+}
+}
+
 QofSession * qof_session_new (QofBook* book);
 QofBook * qof_session_get_book (QofSession *session);
 // TODO: Unroll/remove
@@ -188,9 +274,174 @@ const char *qof_session_get_url (QofSession *session);
 
 %ignore qof_print_date_time_buff;
 %ignore gnc_tm_free;
+%ignore gnc_date_period_starts;
+%ignore gnc_date_bucket_times;
 %include <gnc-date.h>
 extern const char *gnc_default_strftime_date_format;
 
+/* List versions of the period functions so that reports can generate
+ * boundaries and bin their splits without looping in Scheme. year_end is
+ * a time64 on the last day of the fiscal year, as returned by
+ * gnc-accounting-period-fiscal-end. */
+%inline {
+static SCM
+gnc_date_period_starts_list (time64 start, time64 end, GncDatePeriod period,
+                             GDate year_end)
+{
+    size_t count;
+    time64 *starts = gnc_date_period_starts (start, end, period, &year_end,
+                                            &count);
+    SCM list = SCM_EOL;
+    while (count--)
+        list = scm_cons (scm_from_int64 (starts[count]), list);
+    g_free (starts);
+    return list;
+}
+
+static SCM
+gnc_date_bucket_times_list (SCM boundaries, SCM times)
+{
+    size_t n_boundaries = scm_to_size_t (scm_length (boundaries));
+    size_t n_times = scm_to_size_t (scm_length (times));
+    time64 *bounds = g_new (time64, n_boundaries);
+    time64 *values = g_new (time64, n_times);
+    gint *buckets = g_new (gint, n_times);
+    SCM list = SCM_EOL;
+    size_t i;
+
+    for (i = 0; i < n_boundaries; ++i, boundaries = SCM_CDR (boundaries))
+        bounds[i] = scm_to_int64 (SCM_CAR (boundaries));
+    for (i = 0; i < n_times; ++i, times = SCM_CDR (times))
+        values[i] = scm_to_int64 (SCM_CAR (times));
+    gnc_date_bucket_times (bounds, n_boundaries, values, n_times, buckets);
+    for (i = n_times; i--;)
+        list = scm_cons (scm_from_int (buckets[i]), list);
+    g_free (bounds);
+    g_free (values);
+    g_free (buckets);
+    return list;
+}
+}
+
+%ignore gnc_split_table_new;
+%ignore gnc_split_table_new_from_query;
+%ignore gnc_split_table_get_group_amounts;
+%ignore gnc_split_table_get_group_values;
+%newobject gnc_split_table_get_splits;
+%include <gnc-split-table.h>
+
+/* Versions of the split table functions taking the sort of each level
+ * as its key, date grouping, ascending? and subtotal? and giving the
+ * sums as lists of (commodity . amount) pairs.  The table isn't garbage
+ * collected; free it with gnc-split-table-destroy. */
+%inline {
+static GncSplitTable *
+gnc_split_table_new_list (SplitList *splits, GncSplitTableKey primary_key,
+                          GncSplitTableDateGroup primary_date_group,
+                          gboolean primary_ascending, gboolean primary_subtotal,
+                          GncSplitTableKey secondary_key,
+                          GncSplitTableDateGroup secondary_date_group,
+                          gboolean secondary_ascending,
+                          gboolean secondary_subtotal, gboolean sort)
+{
+    GncSplitTableSort primary = { primary_key, primary_date_group,
+                                  primary_ascending, primary_subtotal };
+    GncSplitTableSort secondary = { secondary_key, secondary_date_group,
+                                    secondary_ascending, secondary_subtotal };
+    GncSplitTable *table = gnc_split_table_new (splits, &primary, &secondary,
+                                                sort);
+    g_list_free (splits);
+    return table;
+}
+
+static SCM
+gnc_split_table_sums_to_scm (MonetaryList *sums)
+{
+    SCM list = SCM_EOL;
+    MonetaryList *node;
+
+    for (node = sums; node; node = node->next)
+    {
+        gnc_monetary *mon = node->data;
+        list = scm_cons (scm_cons (SWIG_NewPointerObj (mon->commodity,
+                                                       SWIGTYPE_p_gnc_commodity,
+                                                       0),
+                                   gnc_numeric_to_scm (mon->value)),
+                         list);
+    }
+    gnc_monetary_list_free (sums);
+    return scm_reverse (list);
+}
+
+static SCM
+gnc_split_table_get_group_amounts_list (const GncSplitTable *table,
+                                        GncSplitTableLevel level, guint group)
+{
+    return gnc_split_table_sums_to_scm (
+        gnc_split_table_get_group_amounts (table, level, group));
+}
+
+static SCM
+gnc_split_table_get_group_values_list (const GncSplitTable *table,
+                                       GncSplitTableLevel level, guint group)
+{
+    return gnc_split_table_sums_to_scm (
+        gnc_split_table_get_group_values (table, level, group));
+}
+}
+
+%ignore gnc_portfolio_get_holdings;
+%ignore gnc_portfolio_holdings_free;
+%include <gnc-portfolio.h>
+
+/* gnc_portfolio_get_holdings giving each holding as an association list
+ * of the fields of GncPortfolioHolding, keyed by symbols like
+ * 'realized-gain. */
+%inline {
+static SCM
+gnc_portfolio_get_holdings_list (AccountList *accounts, time64 date,
+                                 gnc_commodity *currency,
+                                 GncPortfolioBasis method,
+                                 gboolean fees_in_basis)
+{
+    GList *holdings = gnc_portfolio_get_holdings (accounts, date, currency,
+                                                  method, fees_in_basis);
+    GList *node;
+    SCM list = SCM_EOL;
+
+    for (node = holdings; node; node = node->next)
+    {
+        GncPortfolioHolding *h = node->data;
+        SCM alist = SCM_EOL;
+#define ADD_FIELD(name, value) \
+        alist = scm_acons (scm_from_utf8_symbol (name), value, alist)
+#define ADD_NUMERIC(name, field) ADD_FIELD (name, gnc_numeric_to_scm (h->field))
+        ADD_FIELD ("account",
+                   SWIG_NewPointerObj (h->account, SWIGTYPE_p_Account, 0));
+        ADD_FIELD ("commodity",
+                   SWIG_NewPointerObj (h->commodity, SWIGTYPE_p_gnc_commodity, 0));
+        ADD_FIELD ("currency",
+                   SWIG_NewPointerObj (h->currency, SWIGTYPE_p_gnc_commodity, 0));
+        ADD_NUMERIC ("units", units);
+        ADD_NUMERIC ("basis", basis);
+        ADD_NUMERIC ("value", value);
+        ADD_FIELD ("have-price", scm_from_bool (h->have_price));
+        ADD_NUMERIC ("realized-gain", realized_gain);
+        ADD_NUMERIC ("unrealized-gain", unrealized_gain);
+        ADD_NUMERIC ("income", income);
+        ADD_NUMERIC ("brokerage", brokerage);
+        ADD_NUMERIC ("money-in", money_in);
+        ADD_NUMERIC ("money-out", money_out);
+#undef ADD_NUMERIC
+#undef ADD_FIELD
+        list = scm_cons (scm_reverse (alist), list);
+    }
+    gnc_portfolio_holdings_free (holdings);
+    g_list_free (accounts);
+    return scm_reverse (list);
+}
+}
+
 GncGUID guid_new_return(void);
 
 %inline {
@@ -206,6 +457,13 @@ SplitList * qof_query_run_subquery (QofQuery *q, const QofQuery *q);
 %typemap(in) QofQueryParamList * "$1 = gnc_query_scm2path($input);"
 
 %include <gnc-session.h>
+
+/* Scheme code reads the archived balances through the accounts' ordinary
+ * balance functions, which include them. */
+%newobject gnc_book_archive_get_uri;
+%ignore gnc_account_get_archived_balances;
+%ignore gnc_book_archive_set_start_balances;
+%include <gnc-book-archive.h>
 %include <Query.h>
 %ignore qof_query_run;
 %ignore qof_query_last_run;
@@ -215,6 +473,87 @@ SplitList * qof_query_run_subquery (QofQuery *q, const QofQuery *q);
 %include <qofbookslots.h>
 %include <qofbook.h>
 
+%{
+static SCM
+gnc_glist_to_scm_vector (GList *list, swig_type_info *type)
+{
+    SCM vector = scm_c_make_vector (g_list_length (list), SCM_BOOL_F);
+    size_t i = 0;
+
+    for (GList *node = list; node; node = node->next, ++i)
+        SCM_SIMPLE_VECTOR_SET (vector, i,
+                               SWIG_NewPointerObj (node->data, type, 0));
+    return vector;
+}
+
+static void
+gnc_account_foreach_descendant_thunk (Account *acc, gpointer data)
+{
+    scm_call_1 (SCM_PACK ((scm_t_bits) data),
+                SWIG_NewPointerObj (acc, SWIGTYPE_p_Account, 0));
+}
+%}
+
+/* Vector versions of the list accessors heavy reports call, which wrap
+ * each element straight into a vector instead of consing and reversing
+ * a list, and iterators that don't build one at all. */
+%inline {
+static SCM
+xaccAccountGetSplitsVector (const Account *acc)
+{
+    return gnc_glist_to_scm_vector (xaccAccountGetSplitList (acc),
+                                    SWIGTYPE_p_Split);
+}
+
+static SCM
+gnc_account_get_descendants_vector (const Account *acc)
+{
+    GList *descendants = gnc_account_get_descendants (acc);
+    SCM vector = gnc_glist_to_scm_vector (descendants, SWIGTYPE_p_Account);
+    g_list_free (descendants);
+    return vector;
+}
+
+static SCM
+gnc_account_get_descendants_sorted_vector (const Account *acc)
+{
+    GList *descendants = gnc_account_get_descendants_sorted (acc);
+    SCM vector = gnc_glist_to_scm_vector (descendants, SWIGTYPE_p_Account);
+    g_list_free (descendants);
+    return vector;
+}
+
+static SCM
+qof_query_run_vector (QofQuery *q)
+{
+    /* The results belong to the query. */
+    return gnc_glist_to_scm_vector (qof_query_run (q), SWIGTYPE_p_Split);
+}
+
+static SCM
+xaccQueryGetSplitsUniqueTransVector (QofQuery *q)
+{
+    SplitList *splits = xaccQueryGetSplitsUniqueTrans (q);
+    SCM vector = gnc_glist_to_scm_vector (splits, SWIGTYPE_p_Split);
+    g_list_free (splits);
+    return vector;
+}
+
+static void
+gnc_account_foreach_split_scm (const Account *acc, SCM proc)
+{
+    for (GList *node = xaccAccountGetSplitList (acc); node; node = node->next)
+        scm_call_1 (proc, SWIG_NewPointerObj (node->data, SWIGTYPE_p_Split, 0));
+}
+
+static void
+gnc_account_foreach_descendant_scm (const Account *acc, SCM proc)
+{
+    gnc_account_foreach_descendant (acc, gnc_account_foreach_descendant_thunk,
+                                    (gpointer) SCM_UNPACK (proc));
+}
+}
+
 %ignore GNC_DENOM_AUTO;
 %ignore GNCNumericErrorCodes;
 %ignore GNC_ERROR_OK;
@@ -433,6 +772,43 @@ void qof_book_set_string_option(QofBook* book, const char* opt_name, const char*
     SET_ENUM("QOF-DATE-FORMAT-UTC");
     SET_ENUM("QOF-DATE-FORMAT-CUSTOM");
 
+    SET_ENUM("GNC-DATE-PERIOD-MONTH");
+    SET_ENUM("GNC-DATE-PERIOD-QUARTER");
+    SET_ENUM("GNC-DATE-PERIOD-YEAR");
+    SET_ENUM("GNC-DATE-PERIOD-FISCAL-YEAR");
+
+    SET_ENUM("GNC-SPLIT-TABLE-KEY-NONE");
+    SET_ENUM("GNC-SPLIT-TABLE-KEY-ACCOUNT-NAME");
+    SET_ENUM("GNC-SPLIT-TABLE-KEY-ACCOUNT-CODE");
+    SET_ENUM("GNC-SPLIT-TABLE-KEY-DATE");
+    SET_ENUM("GNC-SPLIT-TABLE-KEY-RECONCILED-DATE");
+    SET_ENUM("GNC-SPLIT-TABLE-KEY-RECONCILED-STATUS");
+    SET_ENUM("GNC-SPLIT-TABLE-KEY-REGISTER-ORDER");
+    SET_ENUM("GNC-SPLIT-TABLE-KEY-CORR-ACCOUNT-NAME");
+    SET_ENUM("GNC-SPLIT-TABLE-KEY-CORR-ACCOUNT-CODE");
+    SET_ENUM("GNC-SPLIT-TABLE-KEY-AMOUNT");
+    SET_ENUM("GNC-SPLIT-TABLE-KEY-DESCRIPTION");
+    SET_ENUM("GNC-SPLIT-TABLE-KEY-NUMBER");
+    SET_ENUM("GNC-SPLIT-TABLE-KEY-ACTION");
+    SET_ENUM("GNC-SPLIT-TABLE-KEY-MEMO");
+    SET_ENUM("GNC-SPLIT-TABLE-KEY-NOTES");
+
+    SET_ENUM("GNC-SPLIT-TABLE-DATE-NONE");
+    SET_ENUM("GNC-SPLIT-TABLE-DATE-DAY");
+    SET_ENUM("GNC-SPLIT-TABLE-DATE-WEEK");
+    SET_ENUM("GNC-SPLIT-TABLE-DATE-MONTH");
+    SET_ENUM("GNC-SPLIT-TABLE-DATE-QUARTER");
+    SET_ENUM("GNC-SPLIT-TABLE-DATE-YEAR");
+
+    SET_ENUM("GNC-SPLIT-TABLE-PRIMARY");
+    SET_ENUM("GNC-SPLIT-TABLE-SECONDARY");
+    SET_ENUM("GNC-SPLIT-TABLE-TOTAL");
+
+    SET_ENUM("GNC-PORTFOLIO-BASIS-LOTS");
+    SET_ENUM("GNC-PORTFOLIO-BASIS-AVERAGE");
+    SET_ENUM("GNC-PORTFOLIO-BASIS-FIFO");
+    SET_ENUM("GNC-PORTFOLIO-BASIS-LIFO");
+
 
 #undef SET_ENUM
 
@@ -467,3 +843,4 @@ Process *gnc_spawn_process_async(GList *argl, const gboolean search_path);
 
 gint gnc_process_get_fd(const Process *proc, const guint std_fd);
 void gnc_detach_process(Process *proc, const gboolean kill_it);
+gboolean gnc_process_is_alive(const Process *proc);
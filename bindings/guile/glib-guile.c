@@ -340,3 +340,10 @@ gnc_detach_process (Process *proc, const gboolean kill_it)
     else
         g_free (proc);
 }
+
+gboolean
+gnc_process_is_alive (const Process *proc)
+{
+    g_return_val_if_fail (proc, FALSE);
+    return !proc->dead;
+}
@@ -73,4 +73,12 @@ gint gnc_process_get_fd(const Process *proc, const gint std_fd);
  *  @param kill_it If TRUE, kill the process. */
 void gnc_detach_process(Process *proc, const gboolean kill_it);
 
+/** Check whether a process is still running.  The exit is only noticed
+ *  when the main loop dispatches the child watch.
+ *
+ *  @param proc A process structure returned by gnc_spawn_process_async.
+ *
+ *  @return FALSE once the process has exited. */
+gboolean gnc_process_is_alive(const Process *proc);
+
 #endif
@@ -351,6 +351,19 @@ Invoice.decorate_functions(
     decorate_to_return_instance_instead_of_owner,
     'GetOwner', 'GetBillTo')
 
+def post_invoices_to_account(invoices, account, post_date, due_date, memo,
+                             accumulate_splits=True, autopay=False):
+    """Post the invoices to account together, as Invoice.PostToAccount
+    posts one, but in one batch of events and of backend changes.
+
+    Returns the posted transaction of each invoice, in order, or None
+    for those that weren't posted.
+    """
+    return [Transaction(instance=txn) if txn is not None else None
+            for txn in gnucash_core_c.gnc_invoices_post_to_account(
+                invoices, account.instance, post_date, due_date, memo,
+                accumulate_splits, autopay)]
+
 # Entry
 Entry.add_constructor_and_methods_with_prefix('gncEntry', 'Create')
 
@@ -79,9 +79,11 @@
 #include "gncTaxTable.h"
 #include "gncIDSearch.h"
 #include "gnc-pricedb.h"
+#include "gnc-date.h"
 #include "gnc-prefs-utils.h"
 #include "cap-gains.h"
 #include "Scrub3.h"
+#include "gnc-portfolio.h"
 %}
 
 %include <time64.i>
@@ -97,6 +99,12 @@
 %ignore qof_session_not_saved;
 %include <qofsession.h>
 
+// Python gets the memory usage as a dict from gnc_book_memory_usage.
+%newobject qof_book_memory_report;
+%ignore qof_book_get_memory_usage;
+%ignore qof_book_memory_usage_free;
+%ignore qof_memory_usage_total;
+%ignore QofTypeMemoryUsage;
 %include <qofbook.h>
 
 %include <qofid.h>
@@ -202,6 +210,7 @@ static const GncGUID * gncEntryGetGUID(GncEntry *x);
 %include <gncVendorP.h>
 %include <gncAddress.h>
 %include <gncBillTerm.h>
+%ignore gncInvoicePostListToAccount;
 %include <gncInvoice.h>
 %include <gncInvoiceP.h>
 %include <gncJob.h>
@@ -210,11 +219,443 @@ static const GncGUID * gncEntryGetGUID(GncEntry *x);
 %include <gncIDSearch.h>
 
 // Commodity prices includes and stuff
+%ignore gnc_pricedb_build_price_table;
 %include <gnc-pricedb.h>
 
 %include <cap-gains.h>
 %include <Scrub3.h>
 
+// Holdings, basis and gains of investment accounts, over a python
+// sequence of accounts. The holdings returned are owned by python.
+%ignore gnc_portfolio_get_holdings;
+%ignore gnc_portfolio_holdings_free;
+%include <gnc-portfolio.h>
+
+%inline %{
+static PyObject *
+gnc_portfolio_get_holdings_list (PyObject *accounts, time64 date,
+                                 gnc_commodity *currency,
+                                 GncPortfolioBasis method,
+                                 gboolean fees_in_basis)
+{
+    PyObject *fast = PySequence_Fast (accounts,
+                                      "a sequence of accounts expected");
+    GList *list = NULL, *holdings, *node;
+    PyObject *result;
+    Py_ssize_t i;
+
+    if (!fast)
+        return NULL;
+    for (i = PySequence_Fast_GET_SIZE (fast); i-- > 0;)
+    {
+        PyObject *item = PySequence_Fast_GET_ITEM (fast, i);
+        PyObject *instance = PyObject_HasAttrString (item, "instance") ?
+            PyObject_GetAttrString (item, "instance") : (Py_INCREF (item), item);
+        void *account = NULL;
+        int res = SWIG_ConvertPtr (instance, &account, SWIGTYPE_p_Account, 0);
+        Py_DECREF (instance);
+        if (!SWIG_IsOK (res))
+        {
+            PyErr_SetString (PyExc_TypeError, "account expected");
+            g_list_free (list);
+            Py_DECREF (fast);
+            return NULL;
+        }
+        list = g_list_prepend (list, account);
+    }
+    Py_DECREF (fast);
+
+    holdings = gnc_portfolio_get_holdings (list, date, currency, method,
+                                           fees_in_basis);
+    result = PyList_New (0);
+    for (node = holdings; node; node = node->next)
+    {
+        PyObject *holding = SWIG_NewPointerObj (node->data,
+                                                SWIGTYPE_p_GncPortfolioHolding,
+                                                SWIG_POINTER_OWN);
+        PyList_Append (result, holding);
+        Py_DECREF (holding);
+    }
+    g_list_free (holdings);
+    g_list_free (list);
+    return result;
+}
+%}
+
+// Period boundaries and bucketing from gnc-date.h, over python lists so
+// that scripts needn't loop over the periods themselves. year_end is any
+// date on the last day of the fiscal year.
+typedef enum
+{
+    GNC_DATE_PERIOD_MONTH,
+    GNC_DATE_PERIOD_QUARTER,
+    GNC_DATE_PERIOD_YEAR,
+    GNC_DATE_PERIOD_FISCAL_YEAR,
+} GncDatePeriod;
+
+%inline %{
+static PyObject *
+gnc_date_period_starts_list (time64 start, time64 end, GncDatePeriod period,
+                             time64 year_end)
+{
+    GDate fy_end = time64_to_gdate (year_end);
+    size_t count, i;
+    time64 *starts = gnc_date_period_starts (start, end, period, &fy_end,
+                                            &count);
+    PyObject *list = PyList_New (count);
+
+    PyDateTime_IMPORT;
+    for (i = 0; i < count; ++i)
+    {
+        struct tm t;
+        gnc_localtime_r (&starts[i], &t);
+        PyList_SetItem (list, i,
+                        PyDateTime_FromDateAndTime (t.tm_year + 1900,
+                                                    t.tm_mon + 1, t.tm_mday,
+                                                    t.tm_hour, t.tm_min,
+                                                    t.tm_sec, 0));
+    }
+    g_free (starts);
+    return list;
+}
+
+static gboolean
+gnc_py_sequence_to_time64s (PyObject *seq, time64 **times, size_t *count)
+{
+    PyObject *fast = PySequence_Fast (seq, "a sequence of dates expected");
+    size_t i;
+
+    if (!fast)
+        return FALSE;
+    PyDateTime_IMPORT;
+    *count = PySequence_Fast_GET_SIZE (fast);
+    *times = g_new (time64, *count ? *count : 1);
+    for (i = 0; i < *count; ++i)
+    {
+        PyObject *item = PySequence_Fast_GET_ITEM (fast, i);
+        if (PyDate_Check (item))
+        {
+            struct tm time = {PyDateTime_DATE_GET_SECOND (item),
+                              PyDateTime_DATE_GET_MINUTE (item),
+                              PyDateTime_DATE_GET_HOUR (item),
+                              PyDateTime_GET_DAY (item),
+                              PyDateTime_GET_MONTH (item) - 1,
+                              PyDateTime_GET_YEAR (item) - 1900};
+            (*times)[i] = gnc_mktime (&time);
+        }
+        else if (PyInt_Check (item))
+            (*times)[i] = PyInt_AsLong (item);
+        else
+        {
+            PyErr_SetString (PyExc_ValueError,
+                             "date, datetime or integer expected");
+            g_free (*times);
+            Py_DECREF (fast);
+            return FALSE;
+        }
+    }
+    Py_DECREF (fast);
+    return TRUE;
+}
+
+static PyObject *
+gnc_date_bucket_times_list (PyObject *boundaries, PyObject *times)
+{
+    time64 *bounds, *values;
+    size_t n_boundaries, n_times, i;
+    gint *buckets;
+    PyObject *list;
+
+    if (!gnc_py_sequence_to_time64s (boundaries, &bounds, &n_boundaries))
+        return NULL;
+    if (!gnc_py_sequence_to_time64s (times, &values, &n_times))
+    {
+        g_free (bounds);
+        return NULL;
+    }
+    buckets = g_new (gint, n_times ? n_times : 1);
+    gnc_date_bucket_times (bounds, n_boundaries, values, n_times, buckets);
+    list = PyList_New (n_times);
+    for (i = 0; i < n_times; ++i)
+        PyList_SetItem (list, i, PyInt_FromLong (buckets[i]));
+    g_free (bounds);
+    g_free (values);
+    g_free (buckets);
+    return list;
+}
+
+// Exchange-rate table over a python sequence of commodities and one of
+// dates. Free the table with gnc_price_table_destroy.
+static PyObject *
+gnc_pricedb_build_price_table_list (GNCPriceDB *db, PyObject *commodities,
+                                    PyObject *dates,
+                                    gnc_commodity *report_currency)
+{
+    PyObject *fast = PySequence_Fast (commodities,
+                                      "a sequence of commodities expected");
+    GList *list = NULL;
+    GNCPriceTable *table;
+    time64 *values;
+    size_t n_dates;
+    Py_ssize_t i;
+
+    if (!fast)
+        return NULL;
+    for (i = PySequence_Fast_GET_SIZE (fast); i-- > 0;)
+    {
+        PyObject *item = PySequence_Fast_GET_ITEM (fast, i);
+        PyObject *instance = PyObject_HasAttrString (item, "instance") ?
+            PyObject_GetAttrString (item, "instance") : (Py_INCREF (item), item);
+        void *commodity = NULL;
+        int res = SWIG_ConvertPtr (instance, &commodity,
+                                   SWIGTYPE_p_gnc_commodity, 0);
+        Py_DECREF (instance);
+        if (!SWIG_IsOK (res))
+        {
+            PyErr_SetString (PyExc_TypeError, "commodity expected");
+            g_list_free (list);
+            Py_DECREF (fast);
+            return NULL;
+        }
+        list = g_list_prepend (list, commodity);
+    }
+    Py_DECREF (fast);
+
+    if (!gnc_py_sequence_to_time64s (dates, &values, &n_dates))
+    {
+        g_list_free (list);
+        return NULL;
+    }
+    table = gnc_pricedb_build_price_table (db, list, values, n_dates,
+                                           report_currency);
+    g_free (values);
+    g_list_free (list);
+    return SWIG_NewPointerObj (table, SWIGTYPE_p_gnc_price_table_s, 0);
+}
+
+// gncInvoicePostListToAccount over a python sequence of invoices. The
+// list returned has the posted transaction of each invoice, None for
+// those that weren't posted.
+static PyObject *
+gnc_invoices_post_to_account (PyObject *invoices, Account *acc,
+                              time64 post_date, time64 due_date,
+                              const char *memo, gboolean accumulatesplits,
+                              gboolean autopay)
+{
+    PyObject *fast = PySequence_Fast (invoices,
+                                      "a sequence of invoices expected");
+    GList *list = NULL, *txns, *node;
+    PyObject *result;
+    Py_ssize_t i;
+
+    if (!fast)
+        return NULL;
+    for (i = PySequence_Fast_GET_SIZE (fast); i-- > 0;)
+    {
+        PyObject *item = PySequence_Fast_GET_ITEM (fast, i);
+        PyObject *instance = PyObject_HasAttrString (item, "instance") ?
+            PyObject_GetAttrString (item, "instance") : (Py_INCREF (item), item);
+        void *invoice = NULL;
+        int res = SWIG_ConvertPtr (instance, &invoice,
+                                   SWIGTYPE_p__gncInvoice, 0);
+        Py_DECREF (instance);
+        if (!SWIG_IsOK (res))
+        {
+            PyErr_SetString (PyExc_TypeError, "invoice expected");
+            g_list_free (list);
+            Py_DECREF (fast);
+            return NULL;
+        }
+        list = g_list_prepend (list, invoice);
+    }
+    Py_DECREF (fast);
+
+    txns = gncInvoicePostListToAccount (list, acc, post_date, due_date, memo,
+                                        accumulatesplits, autopay);
+    result = PyList_New (0);
+    for (node = txns; node; node = node->next)
+    {
+        PyObject *txn = SWIG_NewPointerObj (node->data,
+                                            SWIGTYPE_p_Transaction, 0);
+        PyList_Append (result, txn);
+        Py_DECREF (txn);
+    }
+    g_list_free (txns);
+    g_list_free (list);
+    return result;
+}
+%}
+
+// Columns of the splits of an account or a query, for scripts going
+// through many splits: a dict of bytearrays of native int64s
+// (date_posted, value_num, value_denom, amount_num, amount_denom), of
+// GUID_DATA_SIZE bytes per split (split_guid, transaction_guid,
+// account_guid) and of reconcile flags, and lists of the descriptions
+// and memos, all filled in one call.
+%{
+static PyObject *
+gnc_split_columns (GList *splits)
+{
+    static const char *int64_names[] = { "date_posted", "value_num",
+                                         "value_denom", "amount_num",
+                                         "amount_denom" };
+    static const char *guid_names[] = { "split_guid", "transaction_guid",
+                                        "account_guid" };
+    enum { N_INT64 = 5, N_GUID = 3 };
+    Py_ssize_t n = g_list_length (splits), i;
+    PyObject *int64s[N_INT64], *guids[N_GUID], *reconcile, *descriptions;
+    PyObject *memos, *dict = PyDict_New ();
+    PyObject *description = NULL;
+    Transaction *last_trans = NULL;
+    GList *node;
+    int k;
+
+    for (k = 0; k < N_INT64; ++k)
+    {
+        int64s[k] = PyByteArray_FromStringAndSize (NULL, n * sizeof (gint64));
+        PyDict_SetItemString (dict, int64_names[k], int64s[k]);
+        Py_DECREF (int64s[k]);
+    }
+    for (k = 0; k < N_GUID; ++k)
+    {
+        guids[k] = PyByteArray_FromStringAndSize (NULL, n * GUID_DATA_SIZE);
+        PyDict_SetItemString (dict, guid_names[k], guids[k]);
+        Py_DECREF (guids[k]);
+    }
+    reconcile = PyByteArray_FromStringAndSize (NULL, n);
+    PyDict_SetItemString (dict, "reconcile", reconcile);
+    Py_DECREF (reconcile);
+    descriptions = PyList_New (n);
+    PyDict_SetItemString (dict, "description", descriptions);
+    Py_DECREF (descriptions);
+    memos = PyList_New (n);
+    PyDict_SetItemString (dict, "memo", memos);
+    Py_DECREF (memos);
+
+    for (node = splits, i = 0; node; node = node->next, ++i)
+    {
+        Split *split = node->data;
+        Transaction *trans = xaccSplitGetParent (split);
+        Account *acc = xaccSplitGetAccount (split);
+        gnc_numeric value = xaccSplitGetValue (split);
+        gnc_numeric amount = xaccSplitGetAmount (split);
+        gint64 row[N_INT64] = { trans ? xaccTransRetDatePosted (trans) : 0,
+                                value.num, value.denom,
+                                amount.num, amount.denom };
+        const GncGUID *row_guids[N_GUID] =
+            { qof_entity_get_guid (split),
+              trans ? qof_entity_get_guid (trans) : guid_null (),
+              acc ? qof_entity_get_guid (acc) : guid_null () };
+        const char *memo = xaccSplitGetMemo (split);
+        PyObject *item;
+
+        for (k = 0; k < N_INT64; ++k)
+            ((gint64*)PyByteArray_AS_STRING (int64s[k]))[i] = row[k];
+        for (k = 0; k < N_GUID; ++k)
+            memcpy (PyByteArray_AS_STRING (guids[k]) + i * GUID_DATA_SIZE,
+                    row_guids[k]->reserved, GUID_DATA_SIZE);
+        PyByteArray_AS_STRING (reconcile)[i] = xaccSplitGetReconcile (split);
+
+        /* The splits of a transaction usually come together; they share
+         * the description. */
+        if (!description || trans != last_trans)
+        {
+            const char *str = trans ? xaccTransGetDescription (trans) : NULL;
+            description = PyUnicode_FromString (str ? str : "");
+            last_trans = trans;
+        }
+        else
+            Py_INCREF (description);
+        item = PyUnicode_FromString (memo ? memo : "");
+        if (!description || !item)
+        {
+            Py_XDECREF (item);
+            Py_DECREF (dict);
+            return NULL;
+        }
+        PyList_SET_ITEM (descriptions, i, description);
+        PyList_SET_ITEM (memos, i, item);
+    }
+    return dict;
+}
+%}
+
+%inline %{
+static PyObject *
+gnc_account_split_columns (Account *acc, gboolean include_children)
+{
+    GList *splits = g_list_copy (xaccAccountGetSplitList (acc));
+    PyObject *result;
+
+    if (include_children)
+    {
+        GList *descendants = gnc_account_get_descendants (acc), *node;
+        for (node = descendants; node; node = node->next)
+            splits = g_list_concat (splits,
+                                    g_list_copy (xaccAccountGetSplitList (node->data)));
+        g_list_free (descendants);
+    }
+    result = gnc_split_columns (splits);
+    g_list_free (splits);
+    return result;
+}
+
+// The query must search for splits.
+static PyObject *
+gnc_query_split_columns (QofQuery *query)
+{
+    if (g_strcmp0 (qof_query_get_search_for (query), GNC_ID_SPLIT))
+    {
+        PyErr_SetString (PyExc_ValueError, "a query for splits expected");
+        return NULL;
+    }
+    return gnc_split_columns (qof_query_run (query));
+}
+
+// The book's qof_book_get_memory_usage by type, and the string cache.
+static PyObject *
+gnc_book_memory_usage (QofBook *book)
+{
+    GList *usage = qof_book_get_memory_usage (book), *node;
+    PyObject *result = PyDict_New ();
+    guint strings;
+    gsize string_bytes;
+
+    for (node = usage; result && node; node = node->next)
+    {
+        QofTypeMemoryUsage *type_usage = node->data;
+        QofMemoryUsage *u = &type_usage->usage;
+        PyObject *counts =
+            Py_BuildValue ("{s:I,s:K,s:K,s:K,s:K,s:K,s:K,s:K}",
+                           "count", type_usage->count,
+                           "instance_bytes", (unsigned long long)u->instance_bytes,
+                           "kvp_frames", (unsigned long long)u->kvp_frames,
+                           "kvp_values", (unsigned long long)u->kvp_values,
+                           "kvp_bytes", (unsigned long long)u->kvp_bytes,
+                           "list_nodes", (unsigned long long)u->list_nodes,
+                           "other_bytes", (unsigned long long)u->other_bytes,
+                           "total_bytes",
+                           (unsigned long long)qof_memory_usage_total (u));
+        if (!counts || PyDict_SetItemString (result, type_usage->type, counts))
+            Py_CLEAR (result);
+        Py_XDECREF (counts);
+    }
+    qof_book_memory_usage_free (usage);
+    if (result)
+    {
+        PyObject *counts;
+
+        qof_string_cache_get_usage (&strings, &string_bytes);
+        counts = Py_BuildValue ("{s:I,s:K}", "count", strings, "total_bytes",
+                                (unsigned long long)string_bytes);
+        if (!counts || PyDict_SetItemString (result, "string cache", counts))
+            Py_CLEAR (result);
+        Py_XDECREF (counts);
+    }
+    return result;
+}
+%}
+
 %init %{
 gnc_environment_setup();
 qof_log_init();
@@ -226,3 +667,13 @@ gnc_prefs_init();
 %}
 //We must explicitly declare this or it gets left out and we can't create books.
 QofBook* qof_book_new (void);
+
+// Engine counters and timers; empty unless built with ENABLE_INSTRUMENTATION.
+gboolean qof_counters_enabled (void);
+%newobject qof_counter_report;
+gchar *qof_counter_report (void);
+void qof_counter_reset (void);
+
+// Chrome trace events, for scripts that want a timeline of their own run.
+gboolean qof_trace_start (const gchar *filename);
+void qof_trace_stop (void);
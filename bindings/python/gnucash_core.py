@@ -681,6 +681,7 @@ Book.add_method('gnc_book_set_root_account', 'set_root_account')
 Book.add_method('gnc_commodity_table_get_table', 'get_table')
 Book.add_method('gnc_pricedb_get_db', 'get_price_db')
 Book.add_method('qof_book_increment_and_format_counter', 'increment_and_format_counter')
+Book.add_method('gnc_book_memory_usage', 'memory_usage')
 
 #Functions that return Account
 Book.get_root_account = method_function_returns_instance(
@@ -721,6 +722,7 @@ GncCommodityTable.add_methods_with_prefix('gnc_commodity_table_')
 commoditytable_dict =   {
                             'lookup' : GncCommodity,
                             'lookup_unique' : GncCommodity,
+                            'lookup_cusip' : GncCommodity,
                             'find_full' : GncCommodity,
                             'insert' : GncCommodity,
                             'add_namespace': GncCommodityNamespace,
@@ -858,6 +860,73 @@ methods_return_instance_lists(
                        })
 Account.name = property( Account.GetName, Account.SetName )
 
+def _split_columns(columns):
+    """Wrap the bytearrays of gnc_account_split_columns and
+    gnc_query_split_columns in memoryviews, which numpy.frombuffer and
+    array.array take without a copy: the int64 columns cast to 'q', the
+    reconcile flags to 'c' and the GUID columns left as 16 bytes per
+    split, e.g. numpy.frombuffer(columns['account_guid'], dtype='V16')."""
+    for name in ('date_posted', 'value_num', 'value_denom',
+                 'amount_num', 'amount_denom'):
+        columns[name] = memoryview(columns[name]).cast('q')
+    for name in ('split_guid', 'transaction_guid', 'account_guid'):
+        columns[name] = memoryview(columns[name])
+    columns['reconcile'] = memoryview(columns['reconcile']).cast('c')
+    return columns
+
+def _account_get_split_columns(self, include_children=False):
+    """The splits of the account, and of its descendants too if
+    include_children, as columns filled in a single call rather than
+    one Split object per split.
+
+    Returns:
+        a dict of date_posted, value_num, value_denom, amount_num,
+        amount_denom, split_guid, transaction_guid, account_guid and
+        reconcile as memoryviews (see _split_columns), and description
+        and memo as lists of str, in the order the splits are in the
+        account.
+    """
+    return _split_columns(gnucash_core_c.gnc_account_split_columns(
+        self.instance, include_children))
+
+Account.GetSplitColumns = _account_get_split_columns
+
+from gnucash.gnucash_core_c import \
+    GNC_PORTFOLIO_BASIS_LOTS, GNC_PORTFOLIO_BASIS_AVERAGE, \
+    GNC_PORTFOLIO_BASIS_FIFO, GNC_PORTFOLIO_BASIS_LIFO
+
+def get_portfolio_holdings(accounts, date, currency,
+                           method=GNC_PORTFOLIO_BASIS_LOTS,
+                           fees_in_basis=True):
+    """Work out what each of accounts holds at date, what it cost and
+    the gains and income it brought, in one pass over its splits.
+
+    Args:
+        accounts: a sequence of Account
+        date: the holdings are after the splits up to and including it
+        currency: the GncCommodity the amounts of money are in
+        method: one of the GNC_PORTFOLIO_BASIS_* constants
+        fees_in_basis: whether brokerage adds to the cost of purchases
+
+    Returns:
+        a list with a dict per account, whose keys are the fields of
+        GncPortfolioHolding in gnc-portfolio.h. The accounts and
+        commodities are Account and GncCommodity, the amounts GncNumeric.
+    """
+    holdings = []
+    for item in gnucash_core_c.gnc_portfolio_get_holdings_list(
+            accounts, date, currency.instance, method, fees_in_basis):
+        holding = { 'account': Account(instance=item.account),
+                    'commodity': GncCommodity(instance=item.commodity),
+                    'currency': GncCommodity(instance=item.currency),
+                    'have_price': bool(item.have_price) }
+        for name in ('units', 'basis', 'value', 'realized_gain',
+                     'unrealized_gain', 'income', 'brokerage',
+                     'money_in', 'money_out'):
+            holding[name] = GncNumeric(instance=getattr(item, name))
+        holdings.append(holding)
+    return holdings
+
 #GUID
 GUID.add_methods_with_prefix('guid_')
 GUID.add_method('xaccAccountLookup', 'AccountLookup')
@@ -929,6 +998,13 @@ Query.add_method('qof_query_add_guid_list_match', 'add_guid_list_match')
 Query.add_method('qof_query_add_guid_match', 'add_guid_match')
 Query.add_method('qof_query_destroy', 'destroy')
 
+def _query_run_split_columns(self):
+    """Run the query, which must search for splits, and return the
+    splits found as columns, as Account.GetSplitColumns does."""
+    return _split_columns(gnucash_core_c.gnc_query_split_columns(self.instance))
+
+Query.run_split_columns = _query_run_split_columns
+
 class QueryStringPredicate(GnuCashCoreClass):
     pass
 
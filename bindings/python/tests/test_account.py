@@ -1,7 +1,7 @@
 from unittest import main
-from datetime import datetime
+from datetime import datetime, timedelta
 from gnucash import Book, Account, Split, GncCommodity, GncNumeric, \
-    Transaction
+    Transaction, Query, get_portfolio_holdings, GNC_PORTFOLIO_BASIS_FIFO
 
 from test_book import BookSession
 
@@ -66,5 +66,76 @@ class TestAccount(AccountSession):
         self.account.ScrubLots()
         self.assertEqual(len(self.account.GetLotList()),1)
 
+    def trade(self, other, when, units, value):
+        tx = Transaction(self.book)
+        tx.BeginEdit()
+        tx.SetCurrency(self.currency)
+        tx.SetDatePostedSecs(when)
+        for account, amount, val in ((self.account, units, value),
+                                     (other, -value, -value)):
+            split = Split(self.book)
+            split.SetParent(tx)
+            split.SetAccount(account)
+            split.SetAmount(GncNumeric(amount))
+            split.SetValue(GncNumeric(val))
+        tx.CommitEdit()
+
+    def test_portfolio_holdings(self):
+        abc = GncCommodity(self.book, 'ABC Fund',
+            'COMMODITY','ABC','ABC',100000)
+        self.table.insert(abc)
+        self.account.SetCommodity(abc)
+        other = Account(self.book)
+        other.SetCommodity(self.currency)
+
+        bought = datetime.now() - timedelta(days=2)
+        self.trade(other, bought, 10, 100)
+        self.trade(other, bought + timedelta(days=1), -4, -60)
+
+        holdings = get_portfolio_holdings([self.account], datetime.now(),
+                                          self.currency,
+                                          GNC_PORTFOLIO_BASIS_FIFO)
+        self.assertEqual(1, len(holdings))
+        holding = holdings[0]
+        self.assertEqual(self.account.GetGUID().to_string(),
+                         holding['account'].GetGUID().to_string())
+        self.assertTrue(holding['units'].equal(GncNumeric(6)))
+        self.assertTrue(holding['basis'].equal(GncNumeric(60)))
+        self.assertTrue(holding['realized_gain'].equal(GncNumeric(20)))
+        self.assertTrue(holding['money_out'].equal(GncNumeric(60)))
+        self.assertFalse(holding['have_price'])
+
+    def test_split_columns(self):
+        self.account.SetCommodity(self.currency)
+        other = Account(self.book)
+        other.SetCommodity(self.currency)
+        when = datetime.now() - timedelta(days=2)
+        self.trade(other, when, 10, 10)
+        self.trade(other, when + timedelta(days=1), -4, -4)
+
+        columns = self.account.GetSplitColumns()
+        self.assertEqual(2, len(columns['description']))
+        self.assertEqual([10.0, -4.0],
+                         [num / denom for num, denom in
+                          zip(columns['amount_num'], columns['amount_denom'])])
+        self.assertEqual([10.0, -4.0],
+                         [num / denom for num, denom in
+                          zip(columns['value_num'], columns['value_denom'])])
+        self.assertEqual(self.account.GetGUID().to_string(),
+                         bytes(columns['account_guid'][16:32]).hex())
+        self.assertEqual(32, len(columns['split_guid']))
+        self.assertEqual([b'n', b'n'], list(columns['reconcile']))
+        self.assertEqual(['', ''], columns['memo'])
+        self.assertLess(columns['date_posted'][0], columns['date_posted'][1])
+
+        query = Query()
+        query.search_for("Split")
+        query.set_book(self.book)
+        columns = query.run_split_columns()
+        self.assertEqual(4, len(columns['memo']))
+        self.assertEqual(0, sum(columns['amount_num'][i] // columns['amount_denom'][i]
+                                for i in range(4)))
+        query.destroy()
+
 if __name__ == '__main__':
     main()
@@ -1,6 +1,6 @@
 from unittest import TestCase, main
 
-from gnucash import Session
+from gnucash import Session, Account
 
 class BookSession(TestCase):
     def setUp(self):
@@ -13,5 +13,24 @@ class TestBook(BookSession):
     def test_markclosed(self):
         self.ses.end()
 
+    def test_memory_usage(self):
+        root = self.book.get_root_account()
+        acc = Account(self.book)
+        acc.SetName("Checking")
+        acc.SetCommodity(self.currency)
+        root.append_child(acc)
+
+        usage = self.book.memory_usage()
+        self.assertEqual(usage['Book']['count'], 1)
+        self.assertEqual(usage['Account']['count'], 2)
+        self.assertGreater(usage['Account']['instance_bytes'], 0)
+        self.assertGreaterEqual(usage['Account']['total_bytes'],
+                                usage['Account']['instance_bytes'])
+        self.assertGreater(usage['string cache']['count'], 0)
+
+        report = self.book.memory_report()
+        self.assertIn('Account', report)
+        self.assertIn('string cache', report)
+
 if __name__ == '__main__':
     main()
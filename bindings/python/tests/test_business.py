@@ -5,7 +5,8 @@ from datetime import datetime, timezone, timedelta
 from gnucash import Account, \
     ACCT_TYPE_RECEIVABLE, ACCT_TYPE_INCOME, ACCT_TYPE_BANK, \
     GncNumeric
-from gnucash.gnucash_business import Vendor, Employee, Customer, Job, Invoice, Entry
+from gnucash.gnucash_business import Vendor, Employee, Customer, Job, Invoice, Entry, \
+    post_invoices_to_account
 
 from test_book import BookSession
 
@@ -67,6 +68,32 @@ class TestBusiness(BusinessSession):
                          self.invoice.GetDatePosted().astimezone(timezone.utc))
         self.assertTrue( self.invoice.IsPosted() )
 
+    def test_post_list(self):
+        invoices = []
+        for i in range(3):
+            invoice = Invoice(self.book, 'ListID%d' % i, self.currency,
+                              self.customer)
+            invoice.SetDateOpened(self.today)
+            entry = Entry(self.book)
+            entry.SetDate(self.today)
+            entry.SetQuantity(GncNumeric(1))
+            entry.SetInvAccount(self.income)
+            entry.SetInvPrice(GncNumeric(10 * (i + 1)))
+            invoice.AddEntry(entry)
+            invoices.append(invoice)
+        # Already posted, so not posted again
+        invoices.append(self.invoice)
+
+        txns = post_invoices_to_account(invoices, self.receivable,
+                                        self.today, self.today, "")
+        self.assertEqual(4, len(txns))
+        self.assertIsNone(txns[3])
+        for invoice, txn in zip(invoices[:3], txns):
+            self.assertTrue(invoice.IsPosted())
+            self.assertTrue(txn.Equal(invoice.GetPostedTxn(),
+                                      True, False, False, False))
+        self.assertTrue(GncNumeric(160).equal(self.receivable.GetBalance()))
+
     def test_owner(self):
         OWNER = self.invoice.GetOwner()
         self.assertTrue( self.customer.Equal( OWNER ) )
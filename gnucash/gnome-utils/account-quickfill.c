@@ -192,7 +192,11 @@ build_shared_quickfill (QofBook* book, Account* root, const char* key,
     gnc_account_foreach_descendant (root, load_shared_qf_cb, qfb);
     qfb->load_list_store = FALSE;
 
-    qfb->listener = qof_event_register_handler (listen_for_account_events, qfb);
+    qfb->listener =
+        qof_event_register_filtered_handler (GNC_ID_ACCOUNT,
+                                             QOF_EVENT_MODIFY | QOF_EVENT_ADD |
+                                             QOF_EVENT_REMOVE,
+                                             listen_for_account_events, qfb);
 
     qof_book_set_data_fin (book, key, qfb, shared_quickfill_destroy);
 
@@ -38,6 +38,7 @@
 
 #define GNC_PREF_AUTOSAVE_SHOW_EXPLANATION "autosave-show-explanation"
 #define GNC_PREF_AUTOSAVE_INTERVAL         "autosave-interval-minutes"
+#define GNC_PREF_AUTOSAVE_IN_BACKGROUND    "autosave-in-background"
 #define AUTOSAVE_SOURCE_ID "autosave_source_id"
 
 #ifdef G_LOG_DOMAIN
@@ -201,6 +202,12 @@ static gboolean autosave_timeout_cb(gpointer user_data)
     {
         g_debug("autosave_timeout_cb: Really trigger auto-save now.\n");
 
+        /* Saving in the background needs no progress bar. */
+        if (gnc_prefs_get_bool(GNC_PREFS_GROUP_GENERAL,
+                               GNC_PREF_AUTOSAVE_IN_BACKGROUND) &&
+            gnc_file_save_in_background (GTK_WINDOW (toplevel)))
+            return FALSE;
+
         /* Timeout has passed - save the file. */
         if (GNC_IS_MAIN_WINDOW(toplevel))
             gnc_main_window_set_progressbar_window( GNC_MAIN_WINDOW( toplevel ) );
@@ -283,6 +283,29 @@ gnc_cm_event_handler (QofInstance *entity,
         gnc_gui_refresh_internal (FALSE);
 }
 
+/* The changes collected during an event batch, each instance with all
+ * the events it saw, count as if its events had come one by one. */
+static void
+gnc_cm_batch_handler (GList *batch, gpointer user_data)
+{
+    GList *node;
+
+    for (node = batch; node; node = node->next)
+    {
+        QofEventBatchEntry *entry = node->data;
+
+        add_event (&changes, &entry->guid, entry->events, TRUE);
+        if (g_strcmp0 (entry->type, GNC_ID_SPLIT) == 0)
+            add_event_type (&changes, GNC_ID_TRANS, QOF_EVENT_MODIFY, TRUE);
+        else
+            add_event_type (&changes, entry->type, entry->events, TRUE);
+        got_events = TRUE;
+    }
+
+    if (got_events && suspend_counter == 0)
+        gnc_gui_refresh_internal (FALSE);
+}
+
 static gint handler_id;
 
 void
@@ -300,7 +323,8 @@ gnc_component_manager_init (void)
     changes_backup.event_masks = g_hash_table_new (g_str_hash, g_str_equal);
     changes_backup.entity_events = guid_hash_table_new ();
 
-    handler_id = qof_event_register_handler (gnc_cm_event_handler, NULL);
+    handler_id = qof_event_register_batch_handler (gnc_cm_event_handler,
+                                                   gnc_cm_batch_handler, NULL);
 }
 
 void
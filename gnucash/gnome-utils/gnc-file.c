@@ -403,6 +403,11 @@ show_session_error (GtkWindow *parent,
         gnc_error_dialog (parent, fmt, displayname);
         break;
 
+    case ERR_BACKEND_CANCELLED:
+        fmt = _("The operation on %s was cancelled.");
+        gnc_info_dialog (parent, fmt, displayname);
+        break;
+
     case ERR_FILEIO_FILE_BAD_READ:
         fmt = _("There was an error reading the file. "
                 "Do you want to continue?");
@@ -1104,9 +1109,9 @@ RESTART:
     }
 
     // Fix account color slots being set to 'Not Set', should run once on a book
-    qof_event_suspend();
+    qof_event_begin_batch();
     xaccAccountScrubColorNotSet (gnc_get_current_book());
-    qof_event_resume();
+    qof_event_end_batch();
 
     return TRUE;
 }
@@ -1433,6 +1438,57 @@ gnc_file_save (GtkWindow *parent)
     LEAVE (" ");
 }
 
+static void
+gnc_file_background_save_done (QofSession *session, QofBackendError io_err,
+                               gpointer user_data)
+{
+    GtkWindow *parent = GTK_WINDOW (gnc_ui_get_main_window (NULL));
+
+    ENTER (" ");
+    if (ERR_BACKEND_NO_ERR != io_err)
+    {
+        show_session_error (parent, io_err, qof_session_get_url (session),
+                            GNC_FILE_DIALOG_SAVE);
+        LEAVE ("error %d", io_err);
+        return;
+    }
+
+    xaccReopenLog();
+    gnc_add_history (session);
+    gnc_hook_run(HOOK_BOOK_SAVED, session);
+    LEAVE (" ");
+}
+
+gboolean
+gnc_file_save_in_background (GtkWindow *parent)
+{
+    QofSession *session;
+    gboolean started;
+
+    ENTER (" ");
+    if (!gnc_current_session_exist ())
+    {
+        LEAVE ("no session");
+        return FALSE;
+    }
+
+    session = gnc_get_current_session ();
+    if (!strlen (qof_session_get_url (session)) ||
+        qof_book_is_readonly (qof_session_get_book (session)))
+    {
+        LEAVE ("needs gnc_file_save");
+        return FALSE;
+    }
+
+    gnc_set_busy_cursor (NULL, TRUE);
+    started = qof_session_save_in_background (session,
+                                              gnc_file_background_save_done,
+                                              NULL);
+    gnc_unset_busy_cursor (NULL);
+    LEAVE ("%s", started ? "started" : "not started");
+    return started;
+}
+
 /* Note: this dialog will only be used when dbi is not enabled
  *       paths used in it always refer to files and are
  *       never db uris. See gnc_file_do_save_as for that.
@@ -131,6 +131,12 @@ void gnc_file_new (GtkWindow *parent);
 gboolean gnc_file_open (GtkWindow *parent);
 void gnc_file_export(GtkWindow *parent);
 void gnc_file_save (GtkWindow *parent);
+/** Save the current session with the data written out on a worker thread,
+ * so that the book can be edited meanwhile.  Errors are shown once the
+ * save has ended.
+ * @return FALSE if the save wasn't started, e.g. because the backend can't
+ * save in the background; call gnc_file_save() then. */
+gboolean gnc_file_save_in_background (GtkWindow *parent);
 void gnc_file_save_as (GtkWindow *parent);
 void gnc_file_do_export(GtkWindow *parent, const char* filename);
 void gnc_file_do_save_as(GtkWindow *parent, const char* filename);
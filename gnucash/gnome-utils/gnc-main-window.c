@@ -1396,6 +1396,9 @@ gnc_main_window_quit(GncMainWindow *window)
     if (gnc_current_session_exist())
     {
         session = gnc_get_current_session();
+        /* Let a background save end first, so that what was changed while
+         * it ran (or what it failed to save) is asked about. */
+        qof_session_finish_background_save (session);
         needs_save =
             qof_book_session_not_saved(qof_session_get_book(session)) &&
             !gnc_file_save_in_progress();
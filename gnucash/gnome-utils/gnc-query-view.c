@@ -614,38 +614,39 @@ gnc_query_view_refresh_selected (GNCQueryView *qview, GList *old_entry)
     GtkTreeModel     *model;
     GtkTreeIter       iter;
     GtkTreeSelection *selection;
+    GHashTable       *old_entries;
     GList            *node;
     gboolean          valid;
 
     g_return_if_fail (qview != NULL);
     g_return_if_fail (GNC_IS_QUERY_VIEW (qview));
 
+    if (old_entry == NULL)
+        return;
+
     model = gtk_tree_view_get_model (GTK_TREE_VIEW (qview));
     selection = gtk_tree_view_get_selection (GTK_TREE_VIEW (qview));
 
-    if(g_list_length (old_entry) > 0)
+    /* Walk the liststore once, rather than once per old entry */
+    old_entries = g_hash_table_new (NULL, NULL);
+    for (node = old_entry; node; node = node->next)
+        g_hash_table_add (old_entries, node->data);
+
+    valid = gtk_tree_model_get_iter_first (model, &iter);
+
+    while (valid)
     {
-        /* Walk the list of old entries */
-        for(node = old_entry; node; node = node->next)
-        {
-            gpointer pointer;
+        gpointer pointer;
 
-            valid = gtk_tree_model_get_iter_first (model, &iter);
+        // Walk through the liststore, reading each row
+        gtk_tree_model_get (model, &iter, 0, &pointer, -1);
 
-            while (valid)
-            {
-                // Walk through the liststore, reading each row
-                gtk_tree_model_get (model, &iter, 0, &pointer, -1);
-
-                if(pointer == node->data)
-                {
-                    gtk_tree_selection_select_iter (selection, &iter);
-                    break;
-                }
-                valid = gtk_tree_model_iter_next (model, &iter);
-            }
-        }
+        if (g_hash_table_contains (old_entries, pointer))
+            gtk_tree_selection_select_iter (selection, &iter);
+
+        valid = gtk_tree_model_iter_next (model, &iter);
     }
+    g_hash_table_destroy (old_entries);
 }
 
 
@@ -495,6 +495,31 @@ _format_conditional_date(const GDate *date, char *date_buf, int buf_max_length)
     }
 }
 
+static void
+gsltma_set_row(GncSxListTreeModelAdapter *model, GtkTreeIter *iter,
+               GncSxInstances *instances)
+{
+    gchar *frequency_str;
+    char last_occur_date_buf[MAX_DATE_LENGTH+1];
+    char next_occur_date_buf[MAX_DATE_LENGTH+1];
+
+    frequency_str = recurrenceListToCompactString(gnc_sx_get_schedule(instances->sx));
+
+    _format_conditional_date(xaccSchedXactionGetLastOccurDate(instances->sx),
+                             last_occur_date_buf, MAX_DATE_LENGTH);
+    _format_conditional_date(&instances->next_instance_date,
+                             next_occur_date_buf, MAX_DATE_LENGTH);
+
+    gtk_tree_store_set(model->orig, iter,
+                       SXLTMA_COL_NAME, xaccSchedXactionGetName(instances->sx),
+                       SXLTMA_COL_ENABLED, xaccSchedXactionGetEnabled(instances->sx),
+                       SXLTMA_COL_FREQUENCY, frequency_str,
+                       SXLTMA_COL_LAST_OCCUR, last_occur_date_buf,
+                       SXLTMA_COL_NEXT_OCCUR, next_occur_date_buf,
+                       -1);
+    g_free(frequency_str);
+}
+
 static void
 gsltma_populate_tree_store(GncSxListTreeModelAdapter *model)
 {
@@ -503,54 +528,94 @@ gsltma_populate_tree_store(GncSxListTreeModelAdapter *model)
 
     for (list = model->instances->sx_instance_list; list != NULL; list = list->next)
     {
-        GncSxInstances *instances = (GncSxInstances*)list->data;
-        gchar *frequency_str;
-        char last_occur_date_buf[MAX_DATE_LENGTH+1];
-        char next_occur_date_buf[MAX_DATE_LENGTH+1];
+        gtk_tree_store_append(model->orig, &iter, NULL);
+        gsltma_set_row(model, &iter, (GncSxInstances*)list->data);
+    }
+}
 
-        frequency_str = recurrenceListToCompactString(gnc_sx_get_schedule(instances->sx));
+static void
+gsltma_repopulate_tree_store(GncSxListTreeModelAdapter *model)
+{
+    gtk_tree_store_clear(model->orig);
+    gsltma_populate_tree_store(model);
+}
+
+/* The rows of the store are in the order of the model's instances, see
+ * gsltma_get_sx_instances_from_orig_iter().  Find the row and the
+ * instances of sx if the store has a row for each of the instances,
+ * which it hasn't if another handler of the model's signal changed the
+ * list first. */
+static gboolean
+gsltma_find_sx_row(GncSxListTreeModelAdapter *model, SchedXaction *sx,
+                   GtkTreeIter *iter, GncSxInstances **instances)
+{
+    GList *list = model->instances->sx_instance_list;
+    gint n_rows = gtk_tree_model_iter_n_children(GTK_TREE_MODEL(model->orig), NULL);
+    gint index;
 
-        _format_conditional_date(xaccSchedXactionGetLastOccurDate(instances->sx),
-                                 last_occur_date_buf, MAX_DATE_LENGTH);
-        _format_conditional_date(&instances->next_instance_date,
-                                 next_occur_date_buf, MAX_DATE_LENGTH);
+    if (n_rows != (gint)g_list_length(list))
+        return FALSE;
 
-        gtk_tree_store_append(model->orig, &iter, NULL);
-        gtk_tree_store_set(model->orig, &iter,
-                           SXLTMA_COL_NAME, xaccSchedXactionGetName(instances->sx),
-                           SXLTMA_COL_ENABLED, xaccSchedXactionGetEnabled(instances->sx),
-                           SXLTMA_COL_FREQUENCY, frequency_str,
-                           SXLTMA_COL_LAST_OCCUR, last_occur_date_buf,
-                           SXLTMA_COL_NEXT_OCCUR, next_occur_date_buf,
-                           -1);
-        g_free(frequency_str);
+    for (index = 0; list != NULL; list = list->next, index++)
+    {
+        if (((GncSxInstances*)list->data)->sx == sx)
+        {
+            *instances = (GncSxInstances*)list->data;
+            return gtk_tree_model_iter_nth_child(GTK_TREE_MODEL(model->orig),
+                                                 iter, NULL, index);
+        }
     }
+    return FALSE;
 }
 
 static void
 gsltma_added_cb(GncSxInstanceModel *instances, SchedXaction *sx_added, gpointer user_data)
 {
     GncSxListTreeModelAdapter *model = GNC_SX_LIST_TREE_MODEL_ADAPTER(user_data);
-    gtk_tree_store_clear(model->orig);
-    gsltma_populate_tree_store(model);
+    GList *last = g_list_last(instances->sx_instance_list);
+    GtkTreeIter iter;
+
+    /* The model appends the new instances to its list. */
+    if (last && ((GncSxInstances*)last->data)->sx == sx_added &&
+        gtk_tree_model_iter_n_children(GTK_TREE_MODEL(model->orig), NULL) + 1
+        == (gint)g_list_length(instances->sx_instance_list))
+    {
+        gtk_tree_store_append(model->orig, &iter, NULL);
+        gsltma_set_row(model, &iter, (GncSxInstances*)last->data);
+    }
+    else
+        gsltma_repopulate_tree_store(model);
 }
 
 static void
 gsltma_updated_cb(GncSxInstanceModel *instances, SchedXaction *sx_updated, gpointer user_data)
 {
     GncSxListTreeModelAdapter *model = GNC_SX_LIST_TREE_MODEL_ADAPTER(user_data);
+    GncSxInstances *sx_instances;
+    GtkTreeIter iter;
+
     gnc_sx_instance_model_update_sx_instances(instances, sx_updated);
-    gtk_tree_store_clear(model->orig);
-    gsltma_populate_tree_store(model);
+
+    if (gsltma_find_sx_row(model, sx_updated, &iter, &sx_instances))
+        gsltma_set_row(model, &iter, sx_instances);
+    else
+        gsltma_repopulate_tree_store(model);
 }
 
 static void
 gsltma_removing_cb(GncSxInstanceModel *instances, SchedXaction *sx_removing, gpointer user_data)
 {
     GncSxListTreeModelAdapter *model = GNC_SX_LIST_TREE_MODEL_ADAPTER(user_data);
+    GncSxInstances *sx_instances;
+    GtkTreeIter iter;
+    gboolean found;
+
+    found = gsltma_find_sx_row(model, sx_removing, &iter, &sx_instances);
     gnc_sx_instance_model_remove_sx_instances(instances, sx_removing);
-    gtk_tree_store_clear(model->orig);
-    gsltma_populate_tree_store(model);
+    if (found)
+        gtk_tree_store_remove(model->orig, &iter);
+    else
+        gsltma_repopulate_tree_store(model);
 }
 
 GncSxListTreeModelAdapter*
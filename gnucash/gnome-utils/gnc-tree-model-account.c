@@ -39,6 +39,7 @@
 #include "gnc-engine.h"
 #include "gnc-event.h"
 #include "gnc-gobject-utils.h"
+#include "gnc-pricedb.h"
 #include "gnc-ui-balances.h"
 #include "gnc-ui-util.h"
 
@@ -90,6 +91,8 @@ static void gnc_tree_model_account_event_handler (QofInstance *entity,
         QofEventId event_type,
         GncTreeModelAccount *model,
         GncEventData *ed);
+static void gnc_tree_model_account_batch_handler (GList *changes,
+        GncTreeModelAccount *model);
 
 /** The instance private data for an account tree model. */
 typedef struct GncTreeModelAccountPrivate
@@ -101,8 +104,96 @@ typedef struct GncTreeModelAccountPrivate
 
     GHashTable *account_values_hash;
 
+    /* The report currency balances, computed in the background. */
+    struct ReportBalances *report_balances;
+    guint report_generation;  /**< Bumped whenever balances may change. */
+    guint report_kinds;       /**< The kinds of balance asked for. */
+    guint report_idle_id;
+    gboolean report_running;
+
 } GncTreeModelAccountPrivate;
 
+/** The cached column values of one account, found by its guid.  The
+ *  balances are formatted once and then handed out until the account
+ *  or one of its descendants changes. */
+typedef struct
+{
+    GncGUID guid;       /**< The key in the hash table. */
+    guint64 cached;     /**< Bit n is set if values[n] is cached. */
+    gchar *values[GNC_TREE_MODEL_ACCOUNT_NUM_COLUMNS];
+} AccountCachedValues;
+
+G_STATIC_ASSERT (GNC_TREE_MODEL_ACCOUNT_NUM_COLUMNS <= 64);
+
+/** The balances behind the report currency columns. */
+typedef enum
+{
+    REPORT_PRESENT,
+    REPORT_BALANCE,
+    REPORT_CLEARED,
+    REPORT_RECONCILED,
+    REPORT_FUTURE_MIN,
+    NUM_REPORT_KINDS
+} ReportBalanceKind;
+
+static const xaccGetBalanceFn report_balance_fns[NUM_REPORT_KINDS] =
+{
+    xaccAccountGetPresentBalance,
+    xaccAccountGetBalance,
+    xaccAccountGetClearedBalance,
+    xaccAccountGetReconciledBalance,
+    xaccAccountGetProjectedMinimumBalance,
+};
+
+/** One account's balances, in its own commodity as collected, then
+ *  converted to the report currency and summed over its subtree. */
+typedef struct
+{
+    GncGUID guid;
+    const gnc_commodity *commodity;
+    gint parent;        /**< The index of the parent's row, or -1. */
+    gnc_numeric own[NUM_REPORT_KINDS];
+    gnc_numeric converted[NUM_REPORT_KINDS];
+    gnc_numeric subtree[NUM_REPORT_KINDS];
+} ReportBalanceRow;
+
+/** The report currency balances of all the accounts of the model.
+ *  They are collected and the exchange rates looked up on the main
+ *  thread; converting and adding them up is left to a worker, which
+ *  touches nothing else. */
+typedef struct ReportBalances
+{
+    GArray *rows;               /**< Parents before their children. */
+    GHashTable *index;          /**< guid -> row, once computed. */
+    GNCPriceTable *prices;
+    const gnc_commodity *currency;
+    guint generation;
+    guint kinds;
+} ReportBalances;
+
+/* Shown instead of a report currency balance not computed yet, and
+ * after one that is being computed again. */
+#define REPORT_BALANCE_PENDING "\u2026"
+
+static void report_balances_free (gpointer data);
+
+static void
+free_cached_values (gpointer data)
+{
+    AccountCachedValues *entry = data;
+
+    for (gint col = 0; col < GNC_TREE_MODEL_ACCOUNT_NUM_COLUMNS; col++)
+        g_free (entry->values[col]);
+    g_free (entry);
+}
+
+static GHashTable *
+new_cached_values_hash (void)
+{
+    return g_hash_table_new_full (guid_hash_to_guint, guid_g_hash_table_equal,
+                                  NULL, free_cached_values);
+}
+
 #define GNC_TREE_MODEL_ACCOUNT_GET_PRIVATE(o)  \
    ((GncTreeModelAccountPrivate*)g_type_instance_get_private ((GTypeInstance*)o, GNC_TYPE_TREE_MODEL_ACCOUNT))
 
@@ -131,8 +222,7 @@ gnc_tree_model_account_update_color (gpointer gsettings, gchar *key, gpointer us
 
     // destroy/recreate the cached account value hash to force update
     g_hash_table_destroy (priv->account_values_hash);
-    priv->account_values_hash = g_hash_table_new_full (g_str_hash, g_str_equal,
-                                                       g_free, g_free);
+    priv->account_values_hash = new_cached_values_hash ();
 
     use_red = gnc_prefs_get_bool (GNC_PREFS_GROUP_GENERAL, GNC_PREF_NEGATIVE_IN_RED);
 
@@ -198,8 +288,7 @@ gnc_tree_model_account_init (GncTreeModelAccount *model)
         priv->negative_color = NULL;
 
     // create the account values cache hash
-    priv->account_values_hash = g_hash_table_new_full (g_str_hash, g_str_equal,
-                                                       g_free, g_free);
+    priv->account_values_hash = new_cached_values_hash ();
 
     gnc_prefs_register_cb (GNC_PREFS_GROUP_GENERAL, GNC_PREF_NEGATIVE_IN_RED,
                            gnc_tree_model_account_update_color,
@@ -255,6 +344,14 @@ gnc_tree_model_account_dispose (GObject *object)
     // destroy the cached account values
     g_hash_table_destroy (priv->account_values_hash);
 
+    if (priv->report_idle_id)
+    {
+        g_source_remove (priv->report_idle_id);
+        priv->report_idle_id = 0;
+    }
+    report_balances_free (priv->report_balances);
+    priv->report_balances = NULL;
+
     gnc_prefs_remove_cb_by_func (GNC_PREFS_GROUP_GENERAL, GNC_PREF_NEGATIVE_IN_RED,
                                  gnc_tree_model_account_update_color,
                                  model);
@@ -296,8 +393,10 @@ gnc_tree_model_account_new (Account *root)
     priv->book = gnc_get_current_book();
     priv->root = root;
 
-    priv->event_handler_id = qof_event_register_handler
-                             ((QofEventHandler)gnc_tree_model_account_event_handler, model);
+    priv->event_handler_id = qof_event_register_batch_handler
+                             ((QofEventHandler)gnc_tree_model_account_event_handler,
+                              (QofEventBatchHandler)gnc_tree_model_account_batch_handler,
+                              model);
 
     LEAVE("model %p", model);
     return GTK_TREE_MODEL(model);
@@ -586,6 +685,34 @@ gnc_tree_model_account_compute_period_balance (GncTreeModelAccount *model,
     return g_strdup(xaccPrintAmount (b3, gnc_account_print_info (acct, TRUE)));
 }
 
+/* The color column that goes with a balance column, or -1.  Both come
+ * from the same balance, so computing one gives the other. */
+static gint
+balance_color_column (gint column)
+{
+    switch (column)
+    {
+    case GNC_TREE_MODEL_ACCOUNT_COL_PRESENT:
+        return GNC_TREE_MODEL_ACCOUNT_COL_COLOR_PRESENT;
+    case GNC_TREE_MODEL_ACCOUNT_COL_BALANCE:
+        return GNC_TREE_MODEL_ACCOUNT_COL_COLOR_BALANCE;
+    case GNC_TREE_MODEL_ACCOUNT_COL_BALANCE_PERIOD:
+        return GNC_TREE_MODEL_ACCOUNT_COL_COLOR_BALANCE_PERIOD;
+    case GNC_TREE_MODEL_ACCOUNT_COL_CLEARED:
+        return GNC_TREE_MODEL_ACCOUNT_COL_COLOR_CLEARED;
+    case GNC_TREE_MODEL_ACCOUNT_COL_RECONCILED:
+        return GNC_TREE_MODEL_ACCOUNT_COL_COLOR_RECONCILED;
+    case GNC_TREE_MODEL_ACCOUNT_COL_FUTURE_MIN:
+        return GNC_TREE_MODEL_ACCOUNT_COL_COLOR_FUTURE_MIN;
+    case GNC_TREE_MODEL_ACCOUNT_COL_TOTAL:
+        return GNC_TREE_MODEL_ACCOUNT_COL_COLOR_TOTAL;
+    case GNC_TREE_MODEL_ACCOUNT_COL_TOTAL_PERIOD:
+        return GNC_TREE_MODEL_ACCOUNT_COL_COLOR_TOTAL_PERIOD;
+    default:
+        return -1;
+    }
+}
+
 static gboolean
 row_changed_foreach_func (GtkTreeModel *model, GtkTreePath  *path,
                           GtkTreeIter  *iter, gpointer user_data)
@@ -603,8 +730,8 @@ gnc_tree_model_account_clear_cache (GncTreeModelAccount *model)
 
         // destroy the cached account values and recreate
         g_hash_table_destroy (priv->account_values_hash);
-        priv->account_values_hash = g_hash_table_new_full (g_str_hash, g_str_equal,
-                                                           g_free, g_free);
+        priv->account_values_hash = new_cached_values_hash ();
+        priv->report_generation++;
 
         gtk_tree_model_foreach (GTK_TREE_MODEL(model), row_changed_foreach_func, NULL);
     }
@@ -614,11 +741,13 @@ static void
 clear_account_cached_values (GncTreeModelAccount *model, GHashTable *hash, Account *account)
 {
     GtkTreeIter iter;
-    gchar acct_guid_str[GUID_ENCODING_LENGTH + 1];
 
     if (!account)
         return;
 
+    g_hash_table_remove (hash, xaccAccountGetGUID (account));
+    GNC_TREE_MODEL_ACCOUNT_GET_PRIVATE(model)->report_generation++;
+
     // make sure tree view sees the change
     if (gnc_tree_model_account_get_iter_from_account (model, account, &iter))
     {
@@ -627,17 +756,6 @@ clear_account_cached_values (GncTreeModelAccount *model, GHashTable *hash, Accou
         gtk_tree_model_row_changed (GTK_TREE_MODEL(model), path, &iter);
         gtk_tree_path_free (path);
     }
-
-    guid_to_string_buff (xaccAccountGetGUID (account), acct_guid_str);
-
-    // loop over the columns and remove any found
-    for (gint col = 0; col <= GNC_TREE_MODEL_ACCOUNT_NUM_COLUMNS; col++)
-    {
-        gchar *key = g_strdup_printf ("%s,%d", acct_guid_str, col);
-
-        g_hash_table_remove (hash, key);
-        g_free (key);
-    }
 }
 
 static void
@@ -666,26 +784,19 @@ gnc_tree_model_account_get_cached_value (GncTreeModelAccount *model, Account *ac
                                          gint column, gchar **cached_string)
 {
     GncTreeModelAccountPrivate *priv = GNC_TREE_MODEL_ACCOUNT_GET_PRIVATE(model);
-    gchar acct_guid_str[GUID_ENCODING_LENGTH + 1];
-    gchar *key = NULL;
-    gpointer value;
-    gboolean found;
+    AccountCachedValues *entry;
 
     if ((!priv->account_values_hash) || (!account))
         return FALSE;
 
-    guid_to_string_buff (xaccAccountGetGUID (account), acct_guid_str);
-    key = g_strdup_printf ("%s,%d", acct_guid_str, column);
-
-    found = g_hash_table_lookup_extended (priv->account_values_hash, key,
-                                          NULL, &value);
-
-     if (found)
-         *cached_string = g_strdup (value);
+    entry = g_hash_table_lookup (priv->account_values_hash,
+                                 xaccAccountGetGUID (account));
 
-    g_free (key);
+    if (!entry || !(entry->cached & (G_GUINT64_CONSTANT (1) << column)))
+        return FALSE;
 
-    return found;
+    *cached_string = g_strdup (entry->values[column]);
+    return TRUE;
 }
 
 static void
@@ -693,22 +804,316 @@ gnc_tree_model_account_set_cached_value (GncTreeModelAccount *model, Account *ac
                                          gint column, GValue *value)
 {
     GncTreeModelAccountPrivate *priv = GNC_TREE_MODEL_ACCOUNT_GET_PRIVATE(model);
+    AccountCachedValues *entry;
+    guint64 bit = G_GUINT64_CONSTANT (1) << column;
 
     if ((!priv->account_values_hash) || (!account))
         return;
 
     // only interested in string values
-    if (G_VALUE_HOLDS_STRING(value))
+    if (!G_VALUE_HOLDS_STRING(value))
+        return;
+
+    entry = g_hash_table_lookup (priv->account_values_hash,
+                                 xaccAccountGetGUID (account));
+    if (!entry)
+    {
+        entry = g_new0 (AccountCachedValues, 1);
+        entry->guid = *xaccAccountGetGUID (account);
+        g_hash_table_insert (priv->account_values_hash, &entry->guid, entry);
+    }
+    else if (entry->cached & bit)
+        g_free (entry->values[column]);
+
+    entry->values[column] = g_value_dup_string (value);
+    entry->cached |= bit;
+}
+
+static void
+report_balances_free (gpointer data)
+{
+    ReportBalances *rb = data;
+
+    if (!rb)
+        return;
+    if (rb->index)
+        g_hash_table_destroy (rb->index);
+    g_array_free (rb->rows, TRUE);
+    gnc_price_table_destroy (rb->prices);
+    g_free (rb);
+}
+
+static void
+collect_report_rows (ReportBalances *rb, Account *account, gint parent)
+{
+    ReportBalanceRow row = { 0 };
+    GList *children, *node;
+    gint index;
+
+    row.guid = *xaccAccountGetGUID (account);
+    row.commodity = xaccAccountGetCommodity (account);
+    row.parent = parent;
+    for (gint kind = 0; kind < NUM_REPORT_KINDS; kind++)
+        row.own[kind] = (rb->kinds & (1 << kind)) ?
+                        report_balance_fns[kind] (account) :
+                        gnc_numeric_zero ();
+    g_array_append_val (rb->rows, row);
+    index = rb->rows->len - 1;
+
+    children = gnc_account_get_children (account);
+    for (node = children; node; node = node->next)
+        collect_report_rows (rb, node->data, index);
+    g_list_free (children);
+}
+
+/* Convert and add up the balances the way
+ * xaccAccountGet*BalanceInCurrency() does.  Runs on a worker. */
+static void
+report_balances_thread (GTask *task, gpointer source_object,
+                        gpointer task_data, GCancellable *cancellable)
+{
+    ReportBalances *rb = task_data;
+    gint fraction = gnc_commodity_get_fraction (rb->currency);
+    guint i;
+
+    for (i = 0; i < rb->rows->len; i++)
     {
-        gchar acct_guid_str[GUID_ENCODING_LENGTH + 1];
-        const gchar *str = g_value_get_string (value);
-        gchar *key = NULL;
+        ReportBalanceRow *row = &g_array_index (rb->rows, ReportBalanceRow, i);
 
-        guid_to_string_buff (xaccAccountGetGUID (account), acct_guid_str);
-        key = g_strdup_printf ("%s,%d", acct_guid_str, column);
+        for (gint kind = 0; kind < NUM_REPORT_KINDS; kind++)
+        {
+            if (gnc_numeric_zero_p (row->own[kind]) ||
+                gnc_commodity_equiv (row->commodity, rb->currency))
+                row->converted[kind] = row->own[kind];
+            else
+                row->converted[kind] =
+                    gnc_price_table_convert_balance (rb->prices, row->own[kind],
+                                                     row->commodity, 0);
+            row->subtree[kind] = row->converted[kind];
+        }
+    }
 
-        g_hash_table_insert (priv->account_values_hash, key, g_strdup (str));
+    /* Every row comes after its parent, so going backwards each subtree
+     * is complete before it's added to its parent. */
+    for (i = rb->rows->len; i-- > 0;)
+    {
+        ReportBalanceRow *row = &g_array_index (rb->rows, ReportBalanceRow, i);
+        ReportBalanceRow *parent;
+
+        if (row->parent < 0)
+            continue;
+        parent = &g_array_index (rb->rows, ReportBalanceRow, row->parent);
+        for (gint kind = 0; kind < NUM_REPORT_KINDS; kind++)
+            parent->subtree[kind] = gnc_numeric_add (parent->subtree[kind],
+                                                     row->subtree[kind], fraction,
+                                                     GNC_HOW_RND_ROUND_HALF_UP);
     }
+
+    g_task_return_pointer (task, rb, report_balances_free);
+}
+
+static gboolean report_balances_have_column (GncTreeModelAccount *model,
+                                             const GncGUID *guid);
+static void gnc_tree_model_account_queue_report_balances (GncTreeModelAccount *model);
+
+static void
+report_balances_done (GObject *source_object, GAsyncResult *result,
+                      gpointer user_data)
+{
+    GncTreeModelAccount *model = GNC_TREE_MODEL_ACCOUNT(source_object);
+    GncTreeModelAccountPrivate *priv = GNC_TREE_MODEL_ACCOUNT_GET_PRIVATE(model);
+    ReportBalances *rb = g_task_propagate_pointer (G_TASK(result), NULL);
+    guint i;
+
+    priv->report_running = FALSE;
+
+    // the model has been disposed of meanwhile
+    if (!rb || !priv->event_handler_id)
+    {
+        report_balances_free (rb);
+        return;
+    }
+
+    rb->index = g_hash_table_new (guid_hash_to_guint, guid_g_hash_table_equal);
+    for (i = 0; i < rb->rows->len; i++)
+    {
+        ReportBalanceRow *row = &g_array_index (rb->rows, ReportBalanceRow, i);
+        g_hash_table_insert (rb->index, &row->guid, row);
+    }
+    report_balances_free (priv->report_balances);
+    priv->report_balances = rb;
+    DEBUG("computed report balances of %u accounts", rb->rows->len);
+
+    // redraw the rows showing a pending or stale balance
+    for (i = 0; i < rb->rows->len; i++)
+    {
+        ReportBalanceRow *row = &g_array_index (rb->rows, ReportBalanceRow, i);
+        Account *account;
+        GtkTreeIter iter;
+
+        if (report_balances_have_column (model, &row->guid))
+            continue;
+        account = xaccAccountLookup (&row->guid, priv->book);
+        if (account &&
+            gnc_tree_model_account_get_iter_from_account (model, account, &iter))
+        {
+            GtkTreePath *path = gtk_tree_model_get_path (GTK_TREE_MODEL(model), &iter);
+
+            gtk_tree_model_row_changed (GTK_TREE_MODEL(model), path, &iter);
+            gtk_tree_path_free (path);
+        }
+    }
+
+    // things changed while they were computed
+    if (rb->generation != priv->report_generation ||
+        (priv->report_kinds & ~rb->kinds))
+        gnc_tree_model_account_queue_report_balances (model);
+}
+
+static gboolean
+report_balances_idle_cb (gpointer user_data)
+{
+    GncTreeModelAccount *model = user_data;
+    GncTreeModelAccountPrivate *priv = GNC_TREE_MODEL_ACCOUNT_GET_PRIVATE(model);
+    ReportBalances *rb;
+    CommodityList *commodities = NULL;
+    time64 latest = INT64_MAX;
+    GTask *task;
+    guint i;
+
+    priv->report_idle_id = 0;
+    if (!priv->root)
+        return FALSE;
+
+    rb = g_new0 (ReportBalances, 1);
+    rb->rows = g_array_new (FALSE, FALSE, sizeof (ReportBalanceRow));
+    rb->currency = gnc_default_report_currency ();
+    rb->generation = priv->report_generation;
+    rb->kinds = priv->report_kinds;
+
+    collect_report_rows (rb, priv->root, -1);
+
+    for (i = 0; i < rb->rows->len; i++)
+    {
+        ReportBalanceRow *row = &g_array_index (rb->rows, ReportBalanceRow, i);
+
+        if (row->commodity && !gnc_commodity_equiv (row->commodity, rb->currency))
+            commodities = g_list_prepend (commodities, (gpointer)row->commodity);
+    }
+    rb->prices = gnc_pricedb_build_price_table (gnc_pricedb_get_db (priv->book),
+                                                commodities, &latest, 1,
+                                                rb->currency);
+    g_list_free (commodities);
+
+    priv->report_running = TRUE;
+    task = g_task_new (model, NULL, report_balances_done, NULL);
+    g_task_set_task_data (task, rb, NULL);
+    g_task_run_in_thread (task, report_balances_thread);
+    g_object_unref (task);
+
+    return FALSE;
+}
+
+/* Have the report currency balances computed again from the main loop,
+ * unless they already are being computed. */
+static void
+gnc_tree_model_account_queue_report_balances (GncTreeModelAccount *model)
+{
+    GncTreeModelAccountPrivate *priv = GNC_TREE_MODEL_ACCOUNT_GET_PRIVATE(model);
+
+    if (priv->report_running || priv->report_idle_id)
+        return;
+    priv->report_idle_id = g_idle_add (report_balances_idle_cb, model);
+}
+
+/* The kind of balance shown by a report currency column, and whether it
+ * includes the subaccounts; -1 for the other columns. */
+static gint
+report_column_kind (gint column, gboolean *subtree)
+{
+    *subtree = TRUE;
+    switch (column)
+    {
+    case GNC_TREE_MODEL_ACCOUNT_COL_PRESENT_REPORT:
+        return REPORT_PRESENT;
+    case GNC_TREE_MODEL_ACCOUNT_COL_BALANCE_REPORT:
+        *subtree = FALSE;
+        return REPORT_BALANCE;
+    case GNC_TREE_MODEL_ACCOUNT_COL_TOTAL_REPORT:
+        return REPORT_BALANCE;
+    case GNC_TREE_MODEL_ACCOUNT_COL_CLEARED_REPORT:
+        return REPORT_CLEARED;
+    case GNC_TREE_MODEL_ACCOUNT_COL_RECONCILED_REPORT:
+        return REPORT_RECONCILED;
+    case GNC_TREE_MODEL_ACCOUNT_COL_FUTURE_MIN_REPORT:
+        return REPORT_FUTURE_MIN;
+    default:
+        return -1;
+    }
+}
+
+/* Whether an up to date report currency balance of the account is in the
+ * cache of column values, i.e. the row doesn't show stale ones. */
+static gboolean
+report_balances_have_column (GncTreeModelAccount *model, const GncGUID *guid)
+{
+    GncTreeModelAccountPrivate *priv = GNC_TREE_MODEL_ACCOUNT_GET_PRIVATE(model);
+    AccountCachedValues *entry = g_hash_table_lookup (priv->account_values_hash, guid);
+    gboolean subtree;
+
+    if (!entry)
+        return FALSE;
+    for (gint col = 0; col < GNC_TREE_MODEL_ACCOUNT_NUM_COLUMNS; col++)
+        if (report_column_kind (col, &subtree) >= 0 &&
+            (entry->cached & (G_GUINT64_CONSTANT (1) << col)))
+            return TRUE;
+    return FALSE;
+}
+
+/* Set value to the report currency balance of the column.  The balances
+ * are computed in the background, so if they are out of date this starts
+ * computing them again and sets the last one known, marked as stale, or
+ * just the mark.  Returns whether the value is up to date. */
+static gboolean
+gnc_tree_model_account_set_report_balance (GncTreeModelAccount *model,
+                                           Account *account, gint column,
+                                           GValue *value)
+{
+    GncTreeModelAccountPrivate *priv = GNC_TREE_MODEL_ACCOUNT_GET_PRIVATE(model);
+    ReportBalances *rb = priv->report_balances;
+    ReportBalanceRow *row = NULL;
+    gnc_commodity *currency = gnc_default_report_currency ();
+    gboolean subtree, fresh;
+    gint kind = report_column_kind (column, &subtree);
+    gnc_numeric balance;
+    const gchar *string;
+
+    priv->report_kinds |= 1 << kind;
+    if (rb && (rb->kinds & (1 << kind)) &&
+        gnc_commodity_equiv (rb->currency, currency))
+        row = g_hash_table_lookup (rb->index, xaccAccountGetGUID (account));
+
+    fresh = row && rb->generation == priv->report_generation;
+    if (!fresh)
+        gnc_tree_model_account_queue_report_balances (model);
+
+    if (!row)
+    {
+        g_value_set_static_string (value, REPORT_BALANCE_PENDING);
+        return FALSE;
+    }
+
+    balance = subtree ? row->subtree[kind] : row->converted[kind];
+    if (gnc_reverse_balance (account))
+        balance = gnc_numeric_neg (balance);
+    string = xaccPrintAmount (balance, gnc_commodity_print_info (currency, TRUE));
+
+    if (fresh)
+        g_value_set_string (value, string);
+    else
+        g_value_take_string (value, g_strconcat (string, " ",
+                                                 REPORT_BALANCE_PENDING, NULL));
+    return fresh;
 }
 
 static void
@@ -723,6 +1128,8 @@ gnc_tree_model_account_get_value (GtkTreeModel *tree_model,
     gboolean negative; /* used to set "deficit style" also known as red numbers */
     gchar *string;
     gchar *cached_string = NULL;
+    gint color_column;
+    gboolean cacheable = TRUE;
 
     time64 last_date;
 
@@ -782,9 +1189,8 @@ gnc_tree_model_account_get_value (GtkTreeModel *tree_model,
         break;
     case GNC_TREE_MODEL_ACCOUNT_COL_PRESENT_REPORT:
         g_value_init (value, G_TYPE_STRING);
-        string = gnc_ui_account_get_print_report_balance (xaccAccountGetPresentBalanceInCurrency,
-                 account, TRUE, &negative);
-        g_value_take_string (value, string);
+        cacheable = gnc_tree_model_account_set_report_balance (model, account,
+                                                               column, value);
         break;
     case GNC_TREE_MODEL_ACCOUNT_COL_COLOR_PRESENT:
         g_value_init (value, G_TYPE_STRING);
@@ -802,9 +1208,8 @@ gnc_tree_model_account_get_value (GtkTreeModel *tree_model,
         break;
     case GNC_TREE_MODEL_ACCOUNT_COL_BALANCE_REPORT:
         g_value_init (value, G_TYPE_STRING);
-        string = gnc_ui_account_get_print_report_balance (xaccAccountGetBalanceInCurrency,
-                 account, FALSE, &negative);
-        g_value_take_string (value, string);
+        cacheable = gnc_tree_model_account_set_report_balance (model, account,
+                                                               column, value);
         break;
     case GNC_TREE_MODEL_ACCOUNT_COL_COLOR_BALANCE:
         g_value_init (value, G_TYPE_STRING);
@@ -833,9 +1238,8 @@ gnc_tree_model_account_get_value (GtkTreeModel *tree_model,
         break;
     case GNC_TREE_MODEL_ACCOUNT_COL_CLEARED_REPORT:
         g_value_init (value, G_TYPE_STRING);
-        string = gnc_ui_account_get_print_report_balance (xaccAccountGetClearedBalanceInCurrency,
-                 account, TRUE, &negative);
-        g_value_take_string (value, string);
+        cacheable = gnc_tree_model_account_set_report_balance (model, account,
+                                                               column, value);
         break;
     case GNC_TREE_MODEL_ACCOUNT_COL_COLOR_CLEARED:
         g_value_init (value, G_TYPE_STRING);
@@ -853,9 +1257,8 @@ gnc_tree_model_account_get_value (GtkTreeModel *tree_model,
         break;
     case GNC_TREE_MODEL_ACCOUNT_COL_RECONCILED_REPORT:
         g_value_init (value, G_TYPE_STRING);
-        string = gnc_ui_account_get_print_report_balance (xaccAccountGetReconciledBalanceInCurrency,
-                 account, TRUE, &negative);
-        g_value_take_string (value, string);
+        cacheable = gnc_tree_model_account_set_report_balance (model, account,
+                                                               column, value);
         break;
     case GNC_TREE_MODEL_ACCOUNT_COL_RECONCILED_DATE:
         g_value_init (value, G_TYPE_STRING);
@@ -879,9 +1282,8 @@ gnc_tree_model_account_get_value (GtkTreeModel *tree_model,
         break;
     case GNC_TREE_MODEL_ACCOUNT_COL_FUTURE_MIN_REPORT:
         g_value_init (value, G_TYPE_STRING);
-        string = gnc_ui_account_get_print_report_balance (xaccAccountGetProjectedMinimumBalanceInCurrency,
-                 account, TRUE, &negative);
-        g_value_take_string (value, string);
+        cacheable = gnc_tree_model_account_set_report_balance (model, account,
+                                                               column, value);
         break;
     case GNC_TREE_MODEL_ACCOUNT_COL_COLOR_FUTURE_MIN:
         g_value_init (value, G_TYPE_STRING);
@@ -899,9 +1301,8 @@ gnc_tree_model_account_get_value (GtkTreeModel *tree_model,
         break;
     case GNC_TREE_MODEL_ACCOUNT_COL_TOTAL_REPORT:
         g_value_init (value, G_TYPE_STRING);
-        string = gnc_ui_account_get_print_report_balance (xaccAccountGetBalanceInCurrency,
-                 account, TRUE, &negative);
-        g_value_take_string (value, string);
+        cacheable = gnc_tree_model_account_set_report_balance (model, account,
+                                                               column, value);
         break;
     case GNC_TREE_MODEL_ACCOUNT_COL_COLOR_TOTAL:
         g_value_init (value, G_TYPE_STRING);
@@ -968,7 +1369,20 @@ gnc_tree_model_account_get_value (GtkTreeModel *tree_model,
     }
 
     // save the value to the account values cache
-    gnc_tree_model_account_set_cached_value (model, account, column, value);
+    if (cacheable)
+        gnc_tree_model_account_set_cached_value (model, account, column, value);
+
+    // and the color of the balance, which was computed along with it
+    color_column = balance_color_column (column);
+    if (color_column >= 0)
+    {
+        GValue color = G_VALUE_INIT;
+
+        g_value_init (&color, G_TYPE_STRING);
+        gnc_tree_model_account_set_color (model, negative, &color);
+        gnc_tree_model_account_set_cached_value (model, account, color_column, &color);
+        g_value_unset (&color);
+    }
 
     LEAVE(" ");
 }
@@ -1458,6 +1872,8 @@ gnc_tree_model_account_event_handler (QofInstance *entity,
         return;
     }
 
+    QOF_TRACE_BEGIN (refresh);
+
     /* clear the cached model values for account */
     if (event_type != QOF_EVENT_ADD)
         gnc_tree_model_account_clear_cached_values (model, account);
@@ -1524,8 +1940,63 @@ gnc_tree_model_account_event_handler (QofInstance *entity,
         return;
     }
 
+    QOF_TRACE_END (refresh, "tree-model", "account row refresh");
     if (path)
         gtk_tree_path_free (path);
     LEAVE(" ");
     return;
 }
+
+/** This function is the handler for the batches of changes collected
+ *  by the engine during a bulk operation.  The position of added and
+ *  removed accounts isn't part of a batch, so only the accounts still
+ *  in the tree are refreshed.  Clearing their cached values also tells
+ *  the views about the changed rows and their parents' totals.
+ *
+ *  @internal
+ *
+ *  @param changes A list of QofEventBatchEntry.
+ *
+ *  @param model A pointer to the account tree model.
+ */
+static void
+gnc_tree_model_account_batch_handler (GList *changes,
+                                      GncTreeModelAccount *model)
+{
+    GncTreeModelAccountPrivate *priv;
+    GList *node;
+
+    g_return_if_fail (model);    /* Required */
+
+    ENTER("model %p, %d changes", model, g_list_length (changes));
+    priv = GNC_TREE_MODEL_ACCOUNT_GET_PRIVATE(model);
+    QOF_TRACE_BEGIN (refresh);
+
+    for (node = changes; node; node = node->next)
+    {
+        QofEventBatchEntry *entry = node->data;
+        Account *account;
+
+        /* Forget the values of accounts destroyed during the batch. */
+        if (!entry->entity && g_strcmp0 (entry->type, GNC_ID_ACCOUNT) == 0)
+        {
+            g_hash_table_remove (priv->account_values_hash, &entry->guid);
+            continue;
+        }
+        if (!entry->entity || !GNC_IS_ACCOUNT(entry->entity))
+            continue;
+        if (entry->book != priv->book)
+            continue;
+        if (!(entry->events & (QOF_EVENT_MODIFY | QOF_EVENT_ADD)))
+            continue;
+
+        account = GNC_ACCOUNT(entry->entity);
+        if (gnc_account_get_root (account) != priv->root)
+            continue;
+
+        DEBUG("refresh account %p (%s)", account, xaccAccountGetName (account));
+        gnc_tree_model_account_clear_cached_values (model, account);
+    }
+    QOF_TRACE_END (refresh, "tree-model", "account batch refresh");
+    LEAVE(" ");
+}
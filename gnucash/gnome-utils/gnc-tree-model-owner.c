@@ -263,8 +263,10 @@ gnc_tree_model_owner_new (GncOwnerType owner_type)
     priv->owner_type = owner_type;
     priv->owner_list = gncBusinessGetOwnerList (priv->book, gncOwnerTypeToQofIdType(owner_type), TRUE);
 
-    priv->event_handler_id = qof_event_register_handler
-                             ((QofEventHandler)gnc_tree_model_owner_event_handler, model);
+    priv->event_handler_id = qof_event_register_filtered_handler
+                             (gncOwnerTypeToQofIdType(owner_type),
+                              QOF_EVENT_ADD | QOF_EVENT_REMOVE | QOF_EVENT_MODIFY,
+                              (QofEventHandler)gnc_tree_model_owner_event_handler, model);
 
     LEAVE("model %p", model);
     return GTK_TREE_MODEL (model);
@@ -1133,8 +1133,6 @@ gnc_tree_model_price_get_iter_from_price (GncTreeModelPrice *model,
         GtkTreeIter *iter)
 {
     GncTreeModelPricePrivate *priv;
-    gnc_commodity *commodity;
-    GList *list;
     gint n;
 
     ENTER("model %p, price %p, iter %p", model, price, iter);
@@ -1143,24 +1141,17 @@ gnc_tree_model_price_get_iter_from_price (GncTreeModelPrice *model,
     g_return_val_if_fail ((iter != NULL), FALSE);
 
     priv = GNC_TREE_MODEL_PRICE_GET_PRIVATE(model);
-    commodity = gnc_price_get_commodity(price);
-    if (commodity == NULL)
+    if (gnc_price_get_commodity(price) == NULL)
     {
         LEAVE("no commodity");
         return FALSE;
     }
 
-    list = gnc_pricedb_get_prices(priv->price_db, commodity, NULL);
-    if (list == NULL)
-    {
-        LEAVE("empty list");
-        return FALSE;
-    }
-
-    n = g_list_index(list, price);
+    /* The same numbering as gnc_pricedb_nth_price, found in the price's
+     * series instead of in a copy of all the commodity's prices. */
+    n = gnc_pricedb_nth_price_index(priv->price_db, price);
     if (n == -1)
     {
-        gnc_price_list_destroy(list);
         LEAVE("not in list");
         return FALSE;
     }
@@ -1169,7 +1160,6 @@ gnc_tree_model_price_get_iter_from_price (GncTreeModelPrice *model,
     iter->user_data  = ITER_IS_PRICE;
     iter->user_data2 = price;
     iter->user_data3 = GINT_TO_POINTER(n);
-    gnc_price_list_destroy(list);
     LEAVE("iter %s", iter_to_string(model, iter));
     return TRUE;
 }
@@ -1490,7 +1480,6 @@ gnc_tree_model_price_do_deletions (gpointer price_db)
 
             /* Remove the path. */
             gnc_tree_model_price_row_delete(data->model, data->path);
-            gnc_pricedb_nth_price_reset_cache (price_db);
 
             gtk_tree_path_free(data->path);
             g_free(data);
@@ -1616,7 +1605,6 @@ gnc_tree_model_price_event_handler (QofInstance *entity,
     case QOF_EVENT_ADD:
         /* Tell the filters/views where the new price was added. */
         DEBUG("add %s", name);
-        gnc_pricedb_nth_price_reset_cache (priv->price_db);
         gnc_tree_model_price_row_add (model, &iter);
         break;
 
@@ -91,6 +91,7 @@ static void gtm_sr_increment_stamp (GncTreeModelSplitReg *model);
 
 static void gtm_sr_insert_trans (GncTreeModelSplitReg *model, Transaction *trans, gboolean before);
 static void gtm_sr_delete_trans (GncTreeModelSplitReg *model, Transaction *trans);
+static void gtm_sr_free_full_tlist (GncTreeModelSplitRegPrivate *priv);
 
 /** Component Manager Callback ******************************************/
 static void gnc_tree_model_split_reg_event_handler (QofInstance *entity, QofEventId event_type, GncTreeModelSplitReg *model, GncEventData *ed);
@@ -101,7 +102,8 @@ struct GncTreeModelSplitRegPrivate
     QofBook *book;                   // GNC Book
     Account *anchor;                 // Account of register
 
-    GList *full_tlist;               // List of unique transactions derived from the query slist in same order
+    GPtrArray *full_tlist;           // Array of unique transactions derived from the query slist in same order
+    GHashTable *full_tlist_pos;      // Position in full_tlist, plus one, of each transaction
     GList *tlist;                    // List of unique transactions derived from the full_tlist to display in same order
     gint   tlist_start;              // The position of the first transaction in tlist in the full_tlist
 
@@ -425,8 +427,7 @@ gnc_tree_model_split_reg_dispose (GObject *object)
     priv->tlist = NULL;
 
     /* Free the full_tlist */
-    g_list_free (priv->full_tlist);
-    priv->full_tlist = NULL;
+    gtm_sr_free_full_tlist (priv);
 
     /* Free the blank split */
     priv->bsplit = NULL;
@@ -547,70 +548,137 @@ gtm_sr_remove_all_rows (GncTreeModelSplitReg *model)
     g_list_free (rr_list);
 }
 
+/* The full_tlist is indexed by position, rather than walked, as the
+ * register only ever shows a window of NUM_OF_TRANS*3 transactions of it
+ * and moves that a block at a time, however long the account is. */
 static void
-gtm_sr_reg_load (GncTreeModelSplitReg *model, GncTreeModelSplitRegUpdate model_update, gint num_of_rows)
+gtm_sr_free_full_tlist (GncTreeModelSplitRegPrivate *priv)
 {
-    GncTreeModelSplitRegPrivate *priv;
-    GList *node;
-    gint rows = 0;
+    if (priv->full_tlist)
+        g_ptr_array_free (priv->full_tlist, TRUE);
+    priv->full_tlist = NULL;
 
-    priv = model->priv;
+    if (priv->full_tlist_pos)
+        g_hash_table_destroy (priv->full_tlist_pos);
+    priv->full_tlist_pos = NULL;
+}
 
-    if (model_update == VIEW_HOME)
-    {
-        priv->tlist_start = 0;
 
-        for (node = g_list_nth (priv->full_tlist, priv->tlist_start); node; node = node->next)
-        {
-            Transaction *trans = node->data;
+static gint
+gtm_sr_full_tlist_length (GncTreeModelSplitRegPrivate *priv)
+{
+    return priv->full_tlist ? priv->full_tlist->len : 0;
+}
 
-            priv->tlist = g_list_append (priv->tlist, trans);
-            rows++;
 
-            if (rows == num_of_rows)
-                break;
-        } 
-    }
-    
-    if (model_update == VIEW_END)
-    {
-        priv->tlist_start = g_list_length (priv->full_tlist) - num_of_rows;
+/* Return the transaction at position in the full_tlist, or NULL. */
+static Transaction *
+gtm_sr_full_tlist_nth (GncTreeModelSplitRegPrivate *priv, gint position)
+{
+    if (position < 0 || position >= gtm_sr_full_tlist_length (priv))
+        return NULL;
 
-        for (node = g_list_nth (priv->full_tlist, priv->tlist_start); node; node = node->next)
-        {
-            Transaction *trans = node->data;
+    return g_ptr_array_index (priv->full_tlist, position);
+}
 
-            priv->tlist = g_list_append (priv->tlist, trans);
-            rows++;
 
-            if (rows == num_of_rows)
-                break;
-        } 
-    }
+/* Build the full_tlist of the unique transactions of slist, in the order of
+ * their first split, and the blank transaction, in sort_direction. */
+static void
+gtm_sr_build_full_tlist (GncTreeModelSplitReg *model, GList *slist)
+{
+    GncTreeModelSplitRegPrivate *priv = model->priv;
+    GHashTable *seen = g_hash_table_new (g_direct_hash, g_direct_equal);
+    GList *snode;
+    guint i;
 
-    if (model_update == VIEW_GOTO)
+    gtm_sr_free_full_tlist (priv);
+    priv->full_tlist = g_ptr_array_new ();
+
+    /* Get the unique transactions from the slist */
+    for (snode = slist; snode; snode = snode->next)
     {
-        priv->tlist_start = num_of_rows - NUM_OF_TRANS*1.5;
+        Transaction *trans = xaccSplitGetParent (snode->data);
 
-        for (node = g_list_nth (priv->full_tlist, priv->tlist_start); node; node = node->next)
+        if (g_hash_table_add (seen, trans))
+            g_ptr_array_add (priv->full_tlist, trans);
+    }
+    g_hash_table_destroy (seen);
+
+    /* Add the blank transaction to the full_tlist */
+    g_ptr_array_add (priv->full_tlist, priv->btrans);
+
+    if (model->sort_direction != GTK_SORT_ASCENDING)
+    {
+        /* Reverse the full_tlist */
+        for (i = 0; i < priv->full_tlist->len / 2; i++)
         {
-            Transaction *trans = node->data;
+            guint j = priv->full_tlist->len - 1 - i;
+            gpointer tmp = g_ptr_array_index (priv->full_tlist, i);
 
-            priv->tlist = g_list_append (priv->tlist, trans);
-            rows++;
+            g_ptr_array_index (priv->full_tlist, i) = g_ptr_array_index (priv->full_tlist, j);
+            g_ptr_array_index (priv->full_tlist, j) = tmp;
+        }
+    }
 
-            if (rows == (NUM_OF_TRANS*3))
-                break;
-        } 
+    /* The blank transaction may have been in the slist, so its first
+     * position is the one that counts. */
+    priv->full_tlist_pos = g_hash_table_new (g_direct_hash, g_direct_equal);
+    for (i = 0; i < priv->full_tlist->len; i++)
+    {
+        gpointer trans = g_ptr_array_index (priv->full_tlist, i);
+
+        if (!g_hash_table_contains (priv->full_tlist_pos, trans))
+            g_hash_table_insert (priv->full_tlist_pos, trans, GINT_TO_POINTER (i + 1));
     }
 }
 
 
+/* Set the tlist to num_of_rows transactions of the full_tlist from start. */
+static void
+gtm_sr_reg_load_rows (GncTreeModelSplitReg *model, gint start, gint num_of_rows)
+{
+    GncTreeModelSplitRegPrivate *priv = model->priv;
+    GList *rows = NULL;
+    gint end, i;
+
+    if (start < 0)
+        start = 0;
+
+    end = MIN (start + num_of_rows, gtm_sr_full_tlist_length (priv));
+
+    for (i = end - 1; i >= start; i--)
+        rows = g_list_prepend (rows, g_ptr_array_index (priv->full_tlist, i));
+
+    priv->tlist_start = start;
+    priv->tlist = g_list_concat (priv->tlist, rows);
+}
+
+
+static void
+gtm_sr_reg_load (GncTreeModelSplitReg *model, GncTreeModelSplitRegUpdate model_update, gint num_of_rows)
+{
+    GncTreeModelSplitRegPrivate *priv;
+
+    priv = model->priv;
+
+    if (model_update == VIEW_HOME)
+        gtm_sr_reg_load_rows (model, 0, num_of_rows);
+
+    if (model_update == VIEW_END)
+        gtm_sr_reg_load_rows (model, gtm_sr_full_tlist_length (priv) - num_of_rows, num_of_rows);
+
+    if (model_update == VIEW_GOTO)
+        gtm_sr_reg_load_rows (model, num_of_rows - NUM_OF_TRANS*1.5, NUM_OF_TRANS*3);
+}
+
+
 /* Load the model with unique transactions based on a GList of splits */
 void
 gnc_tree_model_split_reg_load (GncTreeModelSplitReg *model, GList *slist, Account *default_account)
 {
     GncTreeModelSplitRegPrivate *priv;
+    gint num_of_trans;
 
     ENTER("#### Load ModelSplitReg = %p and slist length is %d ####", model, g_list_length (slist));
 
@@ -618,54 +686,37 @@ gnc_tree_model_split_reg_load (GncTreeModelSplitReg *model, GList *slist, Accoun
 
     /* Clear the treeview */
     gtm_sr_remove_all_rows (model);
-    priv->full_tlist = NULL;
+    g_list_free (priv->tlist);
     priv->tlist = NULL;
 
     if (model->current_trans == NULL)
         model->current_trans = priv->btrans;
 
-    if (model->sort_direction == GTK_SORT_ASCENDING)
-    {
-        /* Get a list of Unique Transactions from an slist */
-        priv->full_tlist = xaccSplitListGetUniqueTransactions (slist);
-
-        /* Add the blank transaction to the full_tlist */
-        priv->full_tlist = g_list_append (priv->full_tlist, priv->btrans);
-    }
-    else
-    {
-        /* Get a list of Unique Transactions from an slist */
-        priv->full_tlist = xaccSplitListGetUniqueTransactions (slist);
-
-        /* Add the blank transaction to the full_tlist */
-        priv->full_tlist = g_list_append (priv->full_tlist, priv->btrans);
-
-        /* Reverse the full_tlist */
-        priv->full_tlist = g_list_reverse (priv->full_tlist);
-    }
+    gtm_sr_build_full_tlist (model, slist);
 
     // Update the scrollbar
     gnc_tree_model_split_reg_sync_scrollbar (model);
 
-    model->number_of_trans_in_full_tlist = g_list_length (priv->full_tlist);
+    num_of_trans = gtm_sr_full_tlist_length (priv);
+    model->number_of_trans_in_full_tlist = num_of_trans;
 
-    if (g_list_length (priv->full_tlist) < NUM_OF_TRANS*3)
+    if (num_of_trans < NUM_OF_TRANS*3)
     {
         // Copy the full_tlist to tlist
-        priv->tlist = g_list_copy (priv->full_tlist);
+        gtm_sr_reg_load_rows (model, 0, num_of_trans);
     }
     else
     {
         if (model->position_of_trans_in_full_tlist < (NUM_OF_TRANS*3))
             gtm_sr_reg_load (model, VIEW_HOME, NUM_OF_TRANS*3);
-        else if (model->position_of_trans_in_full_tlist > g_list_length (priv->full_tlist) - (NUM_OF_TRANS*3))
+        else if (model->position_of_trans_in_full_tlist > num_of_trans - (NUM_OF_TRANS*3))
             gtm_sr_reg_load (model, VIEW_END, NUM_OF_TRANS*3);
         else
             gtm_sr_reg_load (model, VIEW_GOTO, model->position_of_trans_in_full_tlist);
     }
 
     PINFO("#### Register for Account '%s' has %d transactions and %d splits and tlist is %d ####",
-          default_account ? xaccAccountGetName (default_account) : "NULL", g_list_length (priv->full_tlist), g_list_length (slist), g_list_length (priv->tlist));
+          default_account ? xaccAccountGetName (default_account) : "NULL", num_of_trans, g_list_length (slist), g_list_length (priv->tlist));
 
     /* Update the completion model liststores */
     g_idle_add ((GSourceFunc) gnc_tree_model_split_reg_update_completion, model);
@@ -681,15 +732,17 @@ void
 gnc_tree_model_split_reg_move (GncTreeModelSplitReg *model, GncTreeModelSplitRegUpdate model_update)
 {
     GncTreeModelSplitRegPrivate *priv;
-    GList *inode, *dnode;
-    gint rows = 0;
+    Transaction *trans;
+    gint num_of_trans;
     gint icount = 0;
     gint dcount = 0;
+    gint i;
 
     priv = model->priv;
+    num_of_trans = gtm_sr_full_tlist_length (priv);
 
     // if list is not long enough, return
-    if (g_list_length (priv->full_tlist) < NUM_OF_TRANS*3)
+    if (num_of_trans < NUM_OF_TRANS*3)
         return;
 
     if ((model_update == VIEW_UP) && (model->current_row < NUM_OF_TRANS) && (priv->tlist_start > 0))
@@ -710,34 +763,21 @@ gnc_tree_model_split_reg_move (GncTreeModelSplitReg *model, GncTreeModelSplitReg
         priv->tlist_start = iblock_start;
 
         // Insert at the front end
-        for (inode = g_list_nth (priv->full_tlist, iblock_end); inode; inode = inode->prev)
+        for (i = iblock_end; i >= iblock_start; i--)
         {
-            Transaction *trans = inode->data;
-
-            gtm_sr_insert_trans (model, trans, TRUE);
-
-            rows++;
-
-            if (rows == icount)
-                break;
+            if ((trans = gtm_sr_full_tlist_nth (priv, i)))
+                gtm_sr_insert_trans (model, trans, TRUE);
         }
-        rows = 0;
         // Delete at the back end
-        for (dnode = g_list_nth (priv->full_tlist, dblock_end); dnode; dnode = dnode->prev)
+        for (i = dblock_end; i >= dblock_start; i--)
         {
-            Transaction *trans = dnode->data;
-
-            gtm_sr_delete_trans (model, trans);
-
-            rows++;
-
-            if (rows == dcount)
-                break;
+            if ((trans = gtm_sr_full_tlist_nth (priv, i)))
+                gtm_sr_delete_trans (model, trans);
         }
         g_signal_emit_by_name (model, "refresh_view");
     }
 
-    if ((model_update == VIEW_DOWN) && (model->current_row > NUM_OF_TRANS*2) && (priv->tlist_start < (g_list_length (priv->full_tlist) - NUM_OF_TRANS*3 )))
+    if ((model_update == VIEW_DOWN) && (model->current_row > NUM_OF_TRANS*2) && (priv->tlist_start < (num_of_trans - NUM_OF_TRANS*3 )))
     {
         gint dblock_end = 0;
         gint iblock_start = priv->tlist_start + NUM_OF_TRANS*3;
@@ -747,8 +787,8 @@ gnc_tree_model_split_reg_move (GncTreeModelSplitReg *model, GncTreeModelSplitReg
         if (iblock_start < 0)
             iblock_start = 0;
 
-        if (iblock_end > g_list_length (priv->full_tlist))
-            iblock_end = g_list_length (priv->full_tlist) - 1;
+        if (iblock_end >= num_of_trans)
+            iblock_end = num_of_trans - 1;
 
         icount = iblock_end - iblock_start + 1;
 
@@ -758,29 +798,16 @@ gnc_tree_model_split_reg_move (GncTreeModelSplitReg *model, GncTreeModelSplitReg
         priv->tlist_start = dblock_end;
 
         // Insert at the back end
-        for (inode = g_list_nth (priv->full_tlist, iblock_start); inode; inode = inode->next)
+        for (i = iblock_start; i <= iblock_end; i++)
         {
-            Transaction *trans = inode->data;
-
-            gtm_sr_insert_trans (model, trans, FALSE);
-
-            rows++;
-
-            if (rows == icount)
-                break;
+            if ((trans = gtm_sr_full_tlist_nth (priv, i)))
+                gtm_sr_insert_trans (model, trans, FALSE);
         }
-        rows = 0;
         // Delete at the front end
-        for (dnode = g_list_nth (priv->full_tlist, dblock_start); dnode; dnode = dnode->next)
+        for (i = dblock_start; i < dblock_end; i++)
         {
-            Transaction *trans = dnode->data;
-
-            gtm_sr_delete_trans (model, trans);
-
-            rows++;
-
-            if (rows == dcount)
-                break;
+            if ((trans = gtm_sr_full_tlist_nth (priv, i)))
+                gtm_sr_delete_trans (model, trans);
         }
         g_signal_emit_by_name (model, "refresh_view");
     }
@@ -792,20 +819,15 @@ Transaction *
 gnc_tree_model_split_reg_get_first_trans (GncTreeModelSplitReg *model)
 {
     GncTreeModelSplitRegPrivate *priv;
-    GList *node;
     Transaction *trans;
 
     priv = model->priv;
 
-    node = g_list_first (priv->full_tlist);
-
-    trans = node->data;
+    trans = gtm_sr_full_tlist_nth (priv, 0);
 
     if (trans == priv->btrans)
-    {
-        node = g_list_last (priv->full_tlist);
-        trans = node->data;
-    }
+        trans = gtm_sr_full_tlist_nth (priv, gtm_sr_full_tlist_length (priv) - 1);
+
     return trans;
 }
 
@@ -833,29 +855,22 @@ gnc_tree_model_split_reg_get_tooltip (GncTreeModelSplitReg *model, gint position
     Transaction *trans;
     char date_text[MAX_DATE_LENGTH + 1];
     const gchar *desc_text;
-    GList *node;
 
     memset (date_text, 0, sizeof(date_text));
     priv = model->priv;
 
-    node = g_list_nth (priv->full_tlist, position);
-    if (node == NULL)
+    trans = gtm_sr_full_tlist_nth (priv, position);
+    if (trans == NULL)
        return g_strconcat ("Error", NULL);
+    else if (trans == priv->btrans)
+       return g_strconcat ("Blank Transaction", NULL);
     else
     {
-        trans = node->data;
-        if (trans == NULL)
-           return g_strconcat ("Error", NULL);
-        else if (trans == priv->btrans)
-           return g_strconcat ("Blank Transaction", NULL);
-        else
-        {
-            time64 t = xaccTransRetDatePosted (trans);
-            qof_print_date_buff (date_text, MAX_DATE_LENGTH, t);
-            desc_text = xaccTransGetDescription (trans);
-            model->current_trans = trans;
-            return g_strconcat (date_text, "\n", desc_text, NULL);
-        }
+        time64 t = xaccTransRetDatePosted (trans);
+        qof_print_date_buff (date_text, MAX_DATE_LENGTH, t);
+        desc_text = xaccTransGetDescription (trans);
+        model->current_trans = trans;
+        return g_strconcat (date_text, "\n", desc_text, NULL);
     }
 }
 
@@ -865,15 +880,15 @@ void
 gnc_tree_model_split_reg_set_current_trans_by_position (GncTreeModelSplitReg *model, gint position)
 {
     GncTreeModelSplitRegPrivate *priv;
-    GList *node;
+    Transaction *trans;
 
     priv = model->priv;
 
-    node = g_list_nth (priv->full_tlist, position);
-    if (node == NULL)
-        node = g_list_last (priv->full_tlist);
+    trans = gtm_sr_full_tlist_nth (priv, position);
+    if (trans == NULL)
+        trans = gtm_sr_full_tlist_nth (priv, gtm_sr_full_tlist_length (priv) - 1);
 
-    model->current_trans = node->data;
+    model->current_trans = trans;
 }
 
 
@@ -885,7 +900,10 @@ gnc_tree_model_split_reg_sync_scrollbar (GncTreeModelSplitReg *model)
 
     priv = model->priv;
 
-    model->position_of_trans_in_full_tlist = g_list_index (priv->full_tlist, model->current_trans);
+    if (priv->full_tlist_pos)
+        model->position_of_trans_in_full_tlist = GPOINTER_TO_INT (g_hash_table_lookup (priv->full_tlist_pos, model->current_trans)) - 1;
+    else
+        model->position_of_trans_in_full_tlist = -1;
 
     g_signal_emit_by_name (model, "scroll_sync");
 }
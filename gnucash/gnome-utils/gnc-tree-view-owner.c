@@ -661,7 +661,9 @@ gnc_tree_view_owner_refilter (GncTreeViewOwner *view)
 
     s_model = gtk_tree_view_get_model(GTK_TREE_VIEW(view));
     f_model = gtk_tree_model_sort_get_model(GTK_TREE_MODEL_SORT(s_model));
+    QOF_TRACE_BEGIN (refilter);
     gtk_tree_model_filter_refilter (GTK_TREE_MODEL_FILTER (f_model));
+    QOF_TRACE_END (refilter, "tree-model", "owner refilter");
 }
 
 /************************************************************/
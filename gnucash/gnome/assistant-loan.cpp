@@ -2041,6 +2041,27 @@ loan_rev_hash_free_date_keys( gpointer key, gpointer val, gpointer user_data )
 }
 
 
+static
+gboolean
+loan_rev_eval_formula( GncExpression *exp, int i, gnc_numeric *val )
+{
+    guint n = gnc_expression_get_num_variables( exp ), j;
+    gint islot = gnc_expression_get_variable_slot( exp, "i" );
+    gnc_numeric *values = g_new( gnc_numeric, MAX( n, 1 ) );
+    gboolean ok;
+
+    /* Any variable but the payment number is zero, as it is to
+     * gnc_exp_parser_parse_separate_vars. */
+    for ( j = 0; j < n; j++ )
+        values[j] = gnc_numeric_zero();
+    if ( islot >= 0 )
+        values[islot] = gnc_numeric_create( i, 1 );
+
+    ok = gnc_expression_evaluate( exp, values, val );
+    g_free( values );
+    return ok;
+}
+
 static
 void
 loan_rev_recalc_schedule( LoanAssistantData *ldd )
@@ -2062,18 +2083,28 @@ loan_rev_recalc_schedule( LoanAssistantData *ldd )
     /* Do the master repayment */
     {
         GDate curDate, nextDate;
-        GString *pmtFormula, *ppmtFormula, *ipmtFormula;
-        int i;
-        GHashTable *ivar;
+        GString *formulas[3];
+        GncExpression *exps[3];
+        static const char *names[3] = { "pmt", "ppmt", "ipmt" };
+        int i, k;
+
+        for ( k = 0; k < 3; k++ )
+            formulas[k] = g_string_sized_new( 64 );
+        loan_get_pmt_formula( ldd, formulas[0] );
+        loan_get_ppmt_formula( ldd, formulas[1] );
+        loan_get_ipmt_formula( ldd, formulas[2] );
+
+        /* The formulas are the same for every payment but for its
+         * number i, so they are only parsed once. */
+        for ( k = 0; k < 3; k++ )
+        {
+            char *eloc = NULL;
 
-        pmtFormula = g_string_sized_new( 64 );
-        loan_get_pmt_formula( ldd, pmtFormula );
-        ppmtFormula = g_string_sized_new( 64 );
-        loan_get_ppmt_formula( ldd, ppmtFormula );
-        ipmtFormula = g_string_sized_new( 64 );
-        loan_get_ipmt_formula( ldd, ipmtFormula );
+            exps[k] = gnc_exp_parser_compile( formulas[k]->str, &eloc );
+            if ( exps[k] == NULL )
+                PERR( "%s Parsing error at %s", names[k], eloc );
+        }
 
-        ivar = g_hash_table_new( g_str_hash, g_str_equal );
         g_date_clear( &curDate, 1 );
         curDate = start;
         g_date_subtract_days( &curDate, 1 );
@@ -2087,9 +2118,7 @@ loan_rev_recalc_schedule( LoanAssistantData *ldd )
                 recurrenceListNextInstance(ldd->ld.repayment_schedule,
                                            &curDate, &nextDate))
         {
-            gnc_numeric ival;
             gnc_numeric val;
-            char *eloc;
             rowNumData =
                 (gnc_numeric*)g_hash_table_lookup( repayment_schedule,
                                                    &curDate );
@@ -2112,42 +2141,27 @@ loan_rev_recalc_schedule( LoanAssistantData *ldd )
 
             /* evaluate the expressions given the correct
              * sequence number i */
-            ival = gnc_numeric_create( i, 1 );
-            g_hash_table_insert( ivar, (gpointer) "i", &ival );
-
-            if ( ! gnc_exp_parser_parse_separate_vars(
-                        pmtFormula->str, &val, &eloc, ivar ) )
-            {
-                PERR( "pmt Parsing error at %s", eloc );
-                continue;
-            }
-            val = gnc_numeric_convert( val, 100, GNC_HOW_RND_ROUND_HALF_UP );
-            rowNumData[0] = val;
-
-            if ( ! gnc_exp_parser_parse_separate_vars(
-                        ppmtFormula->str, &val, &eloc, ivar ) )
-            {
-                PERR( "ppmt Parsing error at %s", eloc );
-                continue;
-            }
-            val = gnc_numeric_convert( val, 100, GNC_HOW_RND_ROUND_HALF_UP );
-            rowNumData[1] = val;
-
-            if ( ! gnc_exp_parser_parse_separate_vars(
-                        ipmtFormula->str, &val, &eloc, ivar ) )
+            for ( k = 0; k < 3; k++ )
             {
-                PERR( "ipmt Parsing error at %s", eloc );
-                continue;
+                if ( exps[k] == NULL )
+                    break;
+                if ( ! loan_rev_eval_formula( exps[k], i, &val ) )
+                {
+                    PERR( "%s evaluation error: %s", names[k],
+                          gnc_exp_parser_error_string() );
+                    break;
+                }
+                val = gnc_numeric_convert( val, 100, GNC_HOW_RND_ROUND_HALF_UP );
+                rowNumData[k] = val;
             }
-            val = gnc_numeric_convert( val, 100, GNC_HOW_RND_ROUND_HALF_UP );
-            rowNumData[2] = val;
         }
 
-        g_string_free( ipmtFormula, TRUE );
-        g_string_free( ppmtFormula, TRUE );
-        g_string_free( pmtFormula, TRUE );
-
-        g_hash_table_destroy( ivar );
+        for ( k = 0; k < 3; k++ )
+        {
+            if ( exps[k] )
+                gnc_expression_free( exps[k] );
+            g_string_free( formulas[k], TRUE );
+        }
     }
 
     /* Process any other enabled payments. */
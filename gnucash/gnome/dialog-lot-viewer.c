@@ -95,6 +95,26 @@ enum split_cols
 #define GNC_PREF_HPOS   "hpane-position"
 #define GNC_PREF_VPOS   "vpane-position"
 
+/* Working out the columns of every lot, or of every split of a big lot,
+ * takes long, so only the first rows of the lists are filled right away
+ * and the rest from the main loop, a chunk at a time. */
+#define LV_FILL_CHUNK 250
+
+typedef struct _LVSplitFill LVSplitFill;
+
+struct _LVSplitFill
+{
+    GNCLotViewer  * lv;
+    GtkListStore  * store;
+    /* The splits of the list, some of them still to be added from the
+     * next one on.  They are kept by GUID as they may go meanwhile. */
+    GArray        * pending;
+    guint           pending_pos;
+    gboolean        is_business_lot;
+    gnc_numeric     baln;
+    guint           idle_id;
+};
+
 struct _GNCLotViewer
 {
     GtkWidget     * window;
@@ -119,10 +139,18 @@ struct _GNCLotViewer
 
     Account       * account;
     GNCLot        * selected_lot;
+
+    /* The lot rows whose columns are still to be worked out */
+    GArray        * pending_lots;
+    guint           pending_lots_pos;
+    guint           lots_idle_id;
+
+    LVSplitFill     split_in_lot_fill;
+    LVSplitFill     split_free_fill;
 };
 
 static void gnc_lot_viewer_fill (GNCLotViewer *lv);
-static void gnc_split_viewer_fill (GNCLotViewer *lv, GtkListStore *store, SplitList *split_list);
+static void gnc_split_viewer_fill (GNCLotViewer *lv, LVSplitFill *fill, SplitList *split_list);
 
 /* ======================================================================== */
 /* Callback prototypes */
@@ -195,7 +223,7 @@ lv_show_splits_in_lot (GNCLotViewer *lv)
     if (NULL == lot) return;
 
     split_list = gnc_lot_get_split_list (lot);
-    gnc_split_viewer_fill(lv, lv->split_in_lot_store, split_list);
+    gnc_split_viewer_fill(lv, &lv->split_in_lot_fill, split_list);
 }
 
 /* ======================================================================== */
@@ -204,7 +232,7 @@ lv_show_splits_in_lot (GNCLotViewer *lv)
 static void
 lv_clear_splits_in_lot (GNCLotViewer *lv)
 {
-    gtk_list_store_clear (lv->split_in_lot_store);
+    gnc_split_viewer_fill(lv, &lv->split_in_lot_fill, NULL);
 }
 
 /* ======================================================================== */
@@ -216,9 +244,6 @@ lv_show_splits_free (GNCLotViewer *lv)
     SplitList *split_list, *node;
     SplitList *filtered_list = NULL;
 
-    /* cleanup */
-    gtk_list_store_clear (lv->split_free_store);
-
     /* get splits */
     split_list = xaccAccountGetSplitList(lv->account);
 
@@ -228,12 +253,14 @@ lv_show_splits_free (GNCLotViewer *lv)
         Split *split = node->data;
         if (NULL == xaccSplitGetLot(split))
         {
-            filtered_list = g_list_append(filtered_list, split);
+            filtered_list = g_list_prepend(filtered_list, split);
         }
     }
+    filtered_list = g_list_reverse (filtered_list);
 
     /* display list */
-    gnc_split_viewer_fill(lv, lv->split_free_store, filtered_list);
+    gnc_split_viewer_fill(lv, &lv->split_free_fill, filtered_list);
+    g_list_free (filtered_list);
 }
 
 /* ======================================================================== */
@@ -336,6 +363,123 @@ lv_unselect_row (GNCLotViewer *lv)
 /* ======================================================================== */
 /* Populate the lot list view */
 
+static void
+lv_fill_lot_row (GNCLotViewer *lv, GtkTreeIter *iter, GNCLot *lot)
+{
+    GtkListStore *store = lv->lot_store;
+    char type_buff[200];
+    char baln_buff[200];
+    char gain_buff[200];
+    Split *esplit = gnc_lot_get_earliest_split (lot);
+    Transaction *etrans = xaccSplitGetParent (esplit);
+    time64 open_date = xaccTransGetDate (etrans);
+    gnc_numeric amt_baln = gnc_lot_get_balance (lot);
+    gnc_commodity *currency = find_first_currency (lot);
+    gnc_numeric gains_baln = get_realized_gains (lot, currency);
+
+    /* Part of invoice */
+    type_buff[0] = '\0';
+    if ( NULL != gncInvoiceGetInvoiceFromLot(lot) )
+    {
+        snprintf(type_buff, 200, "I");
+    }
+    gtk_list_store_set(store, iter, LOT_COL_TYPE, type_buff, -1);
+
+    /* Opening date */
+    gtk_list_store_set(store, iter, LOT_COL_OPEN, open_date, -1);
+
+    /* Closing date */
+    if (gnc_lot_is_closed (lot))
+    {
+        Split *fsplit = gnc_lot_get_latest_split (lot);
+        Transaction *ftrans = xaccSplitGetParent (fsplit);
+        time64 close_date = xaccTransGetDate (ftrans);
+
+        gtk_list_store_set(store, iter, LOT_COL_CLOSE, close_date, -1);
+    }
+    else
+    {
+        gtk_list_store_set(store, iter, LOT_COL_CLOSE, G_MAXINT64, -1);
+    }
+
+    /* Title */
+    gtk_list_store_set(store, iter, LOT_COL_TITLE, gnc_lot_get_title(lot), -1);
+
+    /* Amount */
+    xaccSPrintAmount (baln_buff, amt_baln,
+                      gnc_account_print_info (lv->account, TRUE));
+    gtk_list_store_set(store, iter, LOT_COL_BALN, baln_buff, -1);
+    gtk_list_store_set(store, iter, LOT_COL_BALN_DOUBLE, gnc_numeric_to_double (amt_baln), -1);
+
+    /* Capital Gains/Losses Appreciation/Depreciation */
+    xaccSPrintAmount (gain_buff, gains_baln,
+                      gnc_commodity_print_info (currency, TRUE));
+    gtk_list_store_set(store, iter, LOT_COL_GAINS, gain_buff, -1);
+    gtk_list_store_set(store, iter, LOT_COL_GAINS_DOUBLE, gnc_numeric_to_double (gains_baln), -1);
+}
+
+static void
+lv_cancel_pending_lots (GNCLotViewer *lv)
+{
+    if (lv->lots_idle_id)
+    {
+        g_source_remove (lv->lots_idle_id);
+        lv->lots_idle_id = 0;
+    }
+    if (lv->pending_lots)
+    {
+        g_array_free (lv->pending_lots, TRUE);
+        lv->pending_lots = NULL;
+    }
+    lv->pending_lots_pos = 0;
+}
+
+/* Work out the columns of up to count of the pending lot rows and
+ * return whether any are left.  The rows stay put, as list store iters
+ * persist, until the store is cleared, which cancels them first. */
+static gboolean
+lv_fill_pending_lots (GNCLotViewer *lv, guint count)
+{
+    GtkTreeModel *model = GTK_TREE_MODEL(lv->lot_store);
+    guint end;
+
+    if (!lv->pending_lots)
+        return FALSE;
+
+    end = lv->pending_lots->len - lv->pending_lots_pos > count ?
+          lv->pending_lots_pos + count : lv->pending_lots->len;
+
+    for (; lv->pending_lots_pos < end; lv->pending_lots_pos++)
+    {
+        GtkTreeIter *iter = &g_array_index (lv->pending_lots, GtkTreeIter,
+                                            lv->pending_lots_pos);
+        GNCLot *lot;
+
+        gtk_tree_model_get(model, iter, LOT_COL_PNTR, &lot, -1);
+        lv_fill_lot_row (lv, iter, lot);
+    }
+
+    if (lv->pending_lots_pos < lv->pending_lots->len)
+        return TRUE;
+
+    g_array_free (lv->pending_lots, TRUE);
+    lv->pending_lots = NULL;
+    lv->pending_lots_pos = 0;
+    return FALSE;
+}
+
+static gboolean
+lv_pending_lots_idle_cb (gpointer user_data)
+{
+    GNCLotViewer *lv = user_data;
+
+    if (lv_fill_pending_lots (lv, LV_FILL_CHUNK))
+        return TRUE;
+
+    lv->lots_idle_id = 0;
+    return FALSE;
+}
+
 static void
 gnc_lot_viewer_fill (GNCLotViewer *lv)
 {
@@ -346,6 +490,7 @@ gnc_lot_viewer_fill (GNCLotViewer *lv)
     GtkTreeIter iter;
     GtkTreeSelection *selection;
     gboolean found = FALSE;
+    gboolean only_open;
 
     lot_list = xaccAccountGetLotList (lv->account);
 
@@ -354,23 +499,18 @@ gnc_lot_viewer_fill (GNCLotViewer *lv)
         gtk_tree_model_get(model, &iter, LOT_COL_PNTR, &selected_lot, -1);
 
     /* Crazy. Should update in place if possible. */
+    lv_cancel_pending_lots (lv);
     gtk_list_store_clear (lv->lot_store);
 
+    /* Only the rows are added now, their columns are worked out below */
+    only_open = gtk_toggle_button_get_active(lv->only_show_open_lots_checkbutton);
+    lv->pending_lots = g_array_new (FALSE, FALSE, sizeof (GtkTreeIter));
     for (node = lot_list; node; node = node->next)
     {
-        char type_buff[200];
-        char baln_buff[200];
-        char gain_buff[200];
         GNCLot *lot = node->data;
-        Split *esplit = gnc_lot_get_earliest_split (lot);
-        Transaction *etrans = xaccSplitGetParent (esplit);
-        time64 open_date = xaccTransGetDate (etrans);
-        gnc_numeric amt_baln = gnc_lot_get_balance (lot);
-        gnc_commodity *currency = find_first_currency (lot);
-        gnc_numeric gains_baln = get_realized_gains (lot, currency);
 
         /* Skip closed lots when only open should be shown */
-        if (TRUE == gtk_toggle_button_get_active(lv->only_show_open_lots_checkbutton) && gnc_lot_is_closed (lot))
+        if (only_open && gnc_lot_is_closed (lot))
         {
             continue;
         }
@@ -378,51 +518,15 @@ gnc_lot_viewer_fill (GNCLotViewer *lv)
         store = lv->lot_store;
         gtk_list_store_append(store, &iter);
 
-        /* Part of invoice */
-        type_buff[0] = '\0';
-        if ( NULL != gncInvoiceGetInvoiceFromLot(lot) )
-        {
-            snprintf(type_buff, 200, "I");
-        }
-        gtk_list_store_set(store, &iter, LOT_COL_TYPE, type_buff, -1);
-
-        /* Opening date */
-        gtk_list_store_set(store, &iter, LOT_COL_OPEN, open_date, -1);
-
-        /* Closing date */
-        if (gnc_lot_is_closed (lot))
-        {
-            Split *fsplit = gnc_lot_get_latest_split (lot);
-            Transaction *ftrans = xaccSplitGetParent (fsplit);
-            time64 close_date = xaccTransGetDate (ftrans);
-
-            gtk_list_store_set(store, &iter, LOT_COL_CLOSE, close_date, -1);
-        }
-        else
-        {
-            gtk_list_store_set(store, &iter, LOT_COL_CLOSE, G_MAXINT64, -1);
-        }
-
-        /* Title */
-        gtk_list_store_set(store, &iter, LOT_COL_TITLE, gnc_lot_get_title(lot), -1);
-
-        /* Amount */
-        xaccSPrintAmount (baln_buff, amt_baln,
-                          gnc_account_print_info (lv->account, TRUE));
-        gtk_list_store_set(store, &iter, LOT_COL_BALN, baln_buff, -1);
-        gtk_list_store_set(store, &iter, LOT_COL_BALN_DOUBLE, gnc_numeric_to_double (amt_baln), -1);
-
-        /* Capital Gains/Losses Appreciation/Depreciation */
-        xaccSPrintAmount (gain_buff, gains_baln,
-                          gnc_commodity_print_info (currency, TRUE));
-        gtk_list_store_set(store, &iter, LOT_COL_GAINS, gain_buff, -1);
-        gtk_list_store_set(store, &iter, LOT_COL_GAINS_DOUBLE, gnc_numeric_to_double (gains_baln), -1);
-
         /* Self-reference */
         gtk_list_store_set(store, &iter, LOT_COL_PNTR, lot, -1);
+        g_array_append_val (lv->pending_lots, iter);
     }
     g_list_free(lot_list);
 
+    if (lv_fill_pending_lots (lv, LV_FILL_CHUNK))
+        lv->lots_idle_id = g_idle_add (lv_pending_lots_idle_cb, lv);
+
     /* re-select the row that the user had previously selected,
      * if possible. */
     if (selected_lot)
@@ -489,95 +593,173 @@ lv_can_remove_split_from_lot(Split * split, GNCLot * lot)
 /* ======================================================================== */
 /* Populate a split list view */
 
+/* Add a split as the row at position pos of a split list */
 static void
-gnc_split_viewer_fill (GNCLotViewer *lv, GtkListStore *store, SplitList *split_list)
+lv_fill_split_row (LVSplitFill *fill, Split *split, guint pos)
 {
-    SplitList *node;
+    GNCLotViewer *lv = fill->lv;
+    GtkListStore *store = fill->store;
     GtkTreeIter iter;
-    gboolean is_business_lot = FALSE;
-    gnc_numeric baln = gnc_numeric_zero();
+    char amtbuff[200];
+    char valbuff[200];
+    char gainbuff[200];
+    char balnbuff[200];
+    gnc_commodity *currency;
+    Transaction *trans = xaccSplitGetParent (split);
+    time64 date = xaccTransGetDate (trans);
+    gnc_numeric amnt, valu, gains;
+
+    /* Do not show gains splits, however do show empty business splits */
+    if (!fill->is_business_lot && gnc_numeric_zero_p (xaccSplitGetAmount(split))) return;
+
+    gtk_list_store_append(store, &iter);
+
+    /* Date */
+    gtk_list_store_set (store, &iter, SPLIT_COL_DATE, date, -1);
+
+    /* Num  - retrieve number based on book option */
+    gtk_list_store_set (store, &iter, SPLIT_COL_NUM,
+                        gnc_get_num_action (trans, split), -1);
+
+    /* Description */
+    gtk_list_store_set (store, &iter, SPLIT_COL_DESCRIPTION, xaccTransGetDescription (trans), -1);
+
+    /* Amount */
+    amnt = xaccSplitGetAmount (split);
+    xaccSPrintAmount (amtbuff, amnt,
+                      gnc_account_print_info (lv->account, TRUE));
+    gtk_list_store_set (store, &iter, SPLIT_COL_AMOUNT, amtbuff, -1);
+    gtk_list_store_set (store, &iter, SPLIT_COL_AMOUNT_DOUBLE, gnc_numeric_to_double (amnt), -1);
+
+    /* Value.
+     * For non-business accounts which are part of a lot,
+     * invert the sign on the first. */
+    currency = xaccTransGetCurrency (trans);
+    valu = xaccSplitGetValue (split);
+    if (lv->selected_lot && !fill->is_business_lot && (pos != 0))
+            valu = gnc_numeric_neg (valu);
+    xaccSPrintAmount (valbuff, valu,
+                      gnc_commodity_print_info (currency, TRUE));
+    gtk_list_store_set (store, &iter, SPLIT_COL_VALUE, valbuff, -1);
+    gtk_list_store_set (store, &iter, SPLIT_COL_VALUE_DOUBLE, gnc_numeric_to_double (valu), -1);
+
+    /* Gains. Blank if none. */
+    gains = xaccSplitGetCapGains (split);
+    if (gnc_numeric_zero_p(gains))
+    {
+        gainbuff[0] = 0;
+    }
+    else
+    {
+        xaccSPrintAmount (gainbuff, gains,
+                          gnc_commodity_print_info (currency, TRUE));
+    }
+    gtk_list_store_set (store, &iter, SPLIT_COL_GAIN_LOSS, gainbuff, -1);
+    gtk_list_store_set (store, &iter, SPLIT_COL_GAIN_LOSS_DOUBLE, gnc_numeric_to_double (gains), -1);
 
-    if (lv->selected_lot)
-        is_business_lot = xaccAccountIsAPARType (xaccAccountGetType (gnc_lot_get_account (lv->selected_lot)));
+    /* Balance of Gains */
+    fill->baln = gnc_numeric_add_fixed (fill->baln, amnt);
+    if (gnc_numeric_zero_p(fill->baln))
+    {
+        balnbuff[0] = 0;
+    }
+    else
+    {
+        xaccSPrintAmount (balnbuff, fill->baln,
+                          gnc_account_print_info (lv->account, TRUE));
+    }
+    gtk_list_store_set (store, &iter, SPLIT_COL_BALANCE, balnbuff, -1);
+    gtk_list_store_set (store, &iter, SPLIT_COL_BALANCE_DOUBLE, gnc_numeric_to_double (fill->baln), -1);
 
-    gtk_list_store_clear (lv->split_in_lot_store);
-    for (node = split_list; node; node = node->next)
+    /* Self-reference */
+    gtk_list_store_set(store, &iter, SPLIT_COL_PNTR, split, -1);
+}
+
+static void
+lv_cancel_pending_splits (LVSplitFill *fill)
+{
+    if (fill->idle_id)
     {
-        Split *split = node->data;
-        char amtbuff[200];
-        char valbuff[200];
-        char gainbuff[200];
-        char balnbuff[200];
-        gnc_commodity *currency;
-        Transaction *trans = xaccSplitGetParent (split);
-        time64 date = xaccTransGetDate (trans);
-        gnc_numeric amnt, valu, gains;
-
-        /* Do not show gains splits, however do show empty business splits */
-        if (!is_business_lot && gnc_numeric_zero_p (xaccSplitGetAmount(split))) continue;
+        g_source_remove (fill->idle_id);
+        fill->idle_id = 0;
+    }
+    if (fill->pending)
+    {
+        g_array_free (fill->pending, TRUE);
+        fill->pending = NULL;
+    }
+    fill->pending_pos = 0;
+}
 
-        gtk_list_store_append(store, &iter);
+/* Add up to count of the pending splits and return whether any are
+ * left.  The running balance goes on from the splits added before. */
+static gboolean
+lv_fill_pending_splits (LVSplitFill *fill, guint count)
+{
+    QofBook *book = gnc_account_get_book (fill->lv->account);
+    guint end;
 
-        /* Date */
-        gtk_list_store_set (store, &iter, SPLIT_COL_DATE, date, -1);
+    if (!fill->pending)
+        return FALSE;
 
-        /* Num  - retrieve number based on book option */
-        gtk_list_store_set (store, &iter, SPLIT_COL_NUM,
-                            gnc_get_num_action (trans, split), -1);
+    end = fill->pending->len - fill->pending_pos > count ?
+          fill->pending_pos + count : fill->pending->len;
 
-        /* Description */
-        gtk_list_store_set (store, &iter, SPLIT_COL_DESCRIPTION, xaccTransGetDescription (trans), -1);
+    for (; fill->pending_pos < end; fill->pending_pos++)
+    {
+        GncGUID *guid = &g_array_index (fill->pending, GncGUID,
+                                        fill->pending_pos);
+        Split *split = xaccSplitLookup (guid, book);
 
-        /* Amount */
-        amnt = xaccSplitGetAmount (split);
-        xaccSPrintAmount (amtbuff, amnt,
-                          gnc_account_print_info (lv->account, TRUE));
-        gtk_list_store_set (store, &iter, SPLIT_COL_AMOUNT, amtbuff, -1);
-        gtk_list_store_set (store, &iter, SPLIT_COL_AMOUNT_DOUBLE, gnc_numeric_to_double (amnt), -1);
-
-        /* Value.
-         * For non-business accounts which are part of a lot,
-         * invert the sign on the first. */
-        currency = xaccTransGetCurrency (trans);
-        valu = xaccSplitGetValue (split);
-        if (lv->selected_lot && !is_business_lot && (node != split_list))
-                valu = gnc_numeric_neg (valu);
-        xaccSPrintAmount (valbuff, valu,
-                          gnc_commodity_print_info (currency, TRUE));
-        gtk_list_store_set (store, &iter, SPLIT_COL_VALUE, valbuff, -1);
-        gtk_list_store_set (store, &iter, SPLIT_COL_VALUE_DOUBLE, gnc_numeric_to_double (valu), -1);
+        /* It may have been deleted in the meantime. */
+        if (split)
+            lv_fill_split_row (fill, split, fill->pending_pos);
+    }
 
-        /* Gains. Blank if none. */
-        gains = xaccSplitGetCapGains (split);
-        if (gnc_numeric_zero_p(gains))
-        {
-            gainbuff[0] = 0;
-        }
-        else
-        {
-            xaccSPrintAmount (gainbuff, gains,
-                              gnc_commodity_print_info (currency, TRUE));
-        }
-        gtk_list_store_set (store, &iter, SPLIT_COL_GAIN_LOSS, gainbuff, -1);
-        gtk_list_store_set (store, &iter, SPLIT_COL_GAIN_LOSS_DOUBLE, gnc_numeric_to_double (gains), -1);
+    if (fill->pending_pos < fill->pending->len)
+        return TRUE;
 
-        /* Balance of Gains */
-        baln = gnc_numeric_add_fixed (baln, amnt);
-        if (gnc_numeric_zero_p(baln))
-        {
-            balnbuff[0] = 0;
-        }
-        else
-        {
-            xaccSPrintAmount (balnbuff, baln,
-                              gnc_account_print_info (lv->account, TRUE));
-        }
-        gtk_list_store_set (store, &iter, SPLIT_COL_BALANCE, balnbuff, -1);
-        gtk_list_store_set (store, &iter, SPLIT_COL_BALANCE_DOUBLE, gnc_numeric_to_double (baln), -1);
+    g_array_free (fill->pending, TRUE);
+    fill->pending = NULL;
+    fill->pending_pos = 0;
+    return FALSE;
+}
 
-        /* Self-reference */
-        gtk_list_store_set(store, &iter, SPLIT_COL_PNTR, split, -1);
-    }
+static gboolean
+lv_pending_splits_idle_cb (gpointer user_data)
+{
+    LVSplitFill *fill = user_data;
+
+    if (lv_fill_pending_splits (fill, LV_FILL_CHUNK))
+        return TRUE;
+
+    fill->idle_id = 0;
+    return FALSE;
+}
+
+static void
+gnc_split_viewer_fill (GNCLotViewer *lv, LVSplitFill *fill, SplitList *split_list)
+{
+    SplitList *node;
+
+    lv_cancel_pending_splits (fill);
+    gtk_list_store_clear (fill->store);
+
+    fill->is_business_lot = FALSE;
+    if (lv->selected_lot)
+        fill->is_business_lot = xaccAccountIsAPARType (xaccAccountGetType (gnc_lot_get_account (lv->selected_lot)));
+    fill->baln = gnc_numeric_zero();
+
+    if (!split_list)
+        return;
+
+    fill->pending = g_array_sized_new (FALSE, FALSE, sizeof (GncGUID),
+                                       g_list_length (split_list));
+    for (node = split_list; node; node = node->next)
+        g_array_append_val (fill->pending, *xaccSplitGetGUID (node->data));
+
+    if (lv_fill_pending_splits (fill, LV_FILL_CHUNK))
+        fill->idle_id = g_idle_add (lv_pending_splits_idle_cb, fill);
 }
 
 /* ======================================================================== */
@@ -681,6 +863,9 @@ lv_window_destroy_cb (GtkWidget *object, gpointer user_data)
 {
     GNCLotViewer *lv = user_data;
     gnc_unregister_gui_component_by_data (LOT_VIEWER_CM_CLASS, lv);
+    lv_cancel_pending_lots (lv);
+    lv_cancel_pending_splits (&lv->split_in_lot_fill);
+    lv_cancel_pending_splits (&lv->split_free_fill);
     g_free (lv);
 }
 
@@ -1000,6 +1185,11 @@ lv_init_split_views (GNCLotViewer *lv)
 {
     lv->split_free_store = lv_init_split_view (lv, lv->split_free_view);
     lv->split_in_lot_store = lv_init_split_view (lv, lv->split_in_lot_view);
+
+    lv->split_free_fill.lv = lv;
+    lv->split_free_fill.store = lv->split_free_store;
+    lv->split_in_lot_fill.lv = lv;
+    lv->split_in_lot_fill.store = lv->split_in_lot_store;
 }
 
 static void
@@ -257,10 +257,7 @@ gnc_prices_dialog_load_view (GtkTreeView *view, GNCPriceDB *pdb)
 
             if (num > 0)
             {
-                PriceList *list = gnc_pricedb_get_prices (pdb, tmp_commodity, NULL);
-                GList *node = g_list_last (list);
-                GNCPrice *price = (GNCPrice*)node->data;
-                time64 price_time = gnc_price_get_time64 (price);
+                time64 price_time = gnc_pricedb_get_oldest_price_time (pdb, tmp_commodity);
                 const gchar *name_str = gnc_commodity_get_printname (tmp_commodity);
                 gchar *date_str, *num_str;
                 if (oldest > price_time)
@@ -276,7 +273,6 @@ gnc_prices_dialog_load_view (GtkTreeView *view, GNCPriceDB *pdb)
 
                 g_free (date_str);
                 g_free (num_str);
-                gnc_price_unref (price);
             }
             commodity_list = g_list_next (commodity_list);
         }
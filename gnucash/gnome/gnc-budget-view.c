@@ -82,6 +82,13 @@ static QofLogModule log_module = GNC_MOD_BUDGET;
 
 typedef struct GncBudgetViewPrivate GncBudgetViewPrivate;
 
+/* A cached total of one top level account, for one period. */
+typedef struct
+{
+    gboolean    valid;
+    gnc_numeric value;
+} BudgetTotal;
+
 struct _GncBudgetView
 {
     GtkBox w;
@@ -134,6 +141,10 @@ static void gbv_selection_changed_cb (GtkTreeSelection *selection,
 #endif
 static void gbv_treeview_resized_cb (GtkWidget *widget, GtkAllocation *allocation,
                                      GncBudgetView *budget_view);
+static void gbv_totals_cache_invalidate (GncBudgetView *budget_view, Account *account,
+                                         gint period_num);
+static void gbv_totals_cache_event_handler (QofInstance *entity, QofEventId event_type,
+                                            gpointer user_data, gpointer event_data);
 static gnc_numeric gbv_get_accumulated_budget_amount (GncBudget *budget,
                                      Account *account, guint period_num);
 
@@ -151,6 +162,10 @@ static gnc_numeric gbv_get_accumulated_budget_amount (GncBudget *budget,
         @param totals_col_list List of columns in the totals_tree_view
         @param total_col The totals column on the right of all the accounts.
         @param fd No idea what this does.
+        @param totals_cache The budget amount of each top level account for
+               each period, and for the whole budget, in totals_currency.
+        @param editing_account The account whose amount the view itself is
+               setting, if any.
 */
 struct GncBudgetViewPrivate
 {
@@ -173,6 +188,13 @@ struct GncBudgetViewPrivate
 
     GtkCellRenderer *temp_cr;
     GtkCellEditable *temp_ce;
+
+    BudgetTotal     *totals_cache;
+    gint             totals_cache_accounts;
+    gint             totals_cache_periods;
+    gnc_commodity   *totals_currency;
+    gint             totals_event_handler_id;
+    Account         *editing_account;
 };
 
 G_DEFINE_TYPE_WITH_PRIVATE(GncBudgetView, gnc_budget_view, GTK_TYPE_BOX)
@@ -202,6 +224,8 @@ gnc_budget_view_new (GncBudget *budget, AccountFilterDialog *fd)
     priv->total_col = NULL;
     priv->show_account_code = FALSE;
     priv->show_account_desc = FALSE;
+    priv->totals_event_handler_id =
+        qof_event_register_handler (gbv_totals_cache_event_handler, budget_view);
     gbv_create_widget (budget_view);
 
     LEAVE("new budget view %p", budget_view);
@@ -304,6 +328,10 @@ gnc_budget_view_finalize (GObject *object)
     gnc_prefs_remove_cb_by_func (GNC_PREFS_GROUP_GENERAL, GNC_PREF_NEGATIVE_IN_RED,
                                  gbv_update_use_red, budget_view);
 
+    if (priv->totals_event_handler_id)
+        qof_event_unregister_handler (priv->totals_event_handler_id);
+    g_free (priv->totals_cache);
+
     G_OBJECT_CLASS(gnc_budget_view_parent_class)->finalize (object);
     LEAVE(" ");
 }
@@ -1259,6 +1287,8 @@ budget_col_edited (Account *account, GtkTreeViewColumn *col,
     budget_view = GNC_BUDGET_VIEW(g_object_get_data (G_OBJECT(col), "budget_view"));
     priv = GNC_BUDGET_VIEW_GET_PRIVATE(budget_view);
 
+    /* Only the totals of this account's top level account change. */
+    priv->editing_account = account;
     if (new_text && *new_text == '\0')
         gnc_budget_unset_account_period_value (priv->budget, account, period_num);
     else
@@ -1268,6 +1298,120 @@ budget_col_edited (Account *account, GtkTreeViewColumn *col,
         gnc_budget_set_account_period_value (priv->budget, account, period_num,
                                              numeric);
     }
+    priv->editing_account = NULL;
+    gbv_totals_cache_invalidate (budget_view, account, period_num);
+}
+
+/** \brief Forget cached totals of the totals tree.
+
+ With an account, only the totals of its top level account for period_num,
+ and for the whole budget, are forgotten; they are all the account's amount
+ can change.  Without one, all of them are.
+*/
+static void
+gbv_totals_cache_invalidate (GncBudgetView *budget_view, Account *account,
+                             gint period_num)
+{
+    GncBudgetViewPrivate *priv = GNC_BUDGET_VIEW_GET_PRIVATE(budget_view);
+    Account *top = account;
+    gint index = -1;
+
+    if (!priv->totals_cache)
+        return;
+
+    if (account)
+    {
+        while (top && gnc_account_get_parent (top) != priv->rootAcct)
+            top = gnc_account_get_parent (top);
+        if (top)
+            index = gnc_account_child_index (priv->rootAcct, top);
+    }
+
+    if (index < 0 || index >= priv->totals_cache_accounts ||
+        period_num < 0 || period_num >= priv->totals_cache_periods)
+    {
+        g_free (priv->totals_cache);
+        priv->totals_cache = NULL;
+        return;
+    }
+
+    /* The first entry of an account is for the whole budget. */
+    index *= priv->totals_cache_periods + 1;
+    priv->totals_cache[index].valid = FALSE;
+    priv->totals_cache[index + period_num + 1].valid = FALSE;
+}
+
+/** \brief Keep the totals cache up to date with the book.
+
+ The amounts the view sets itself are handled by budget_col_edited.  Any
+ other change to the budget, and any change to the accounts or prices
+ the totals are made of, throws the cache away.
+*/
+static void
+gbv_totals_cache_event_handler (QofInstance *entity, QofEventId event_type,
+                                gpointer user_data, gpointer event_data)
+{
+    GncBudgetView *budget_view = user_data;
+    GncBudgetViewPrivate *priv = GNC_BUDGET_VIEW_GET_PRIVATE(budget_view);
+
+    if (!priv->totals_cache || !entity)
+        return;
+
+    if (GNC_IS_BUDGET(entity))
+    {
+        if (GNC_BUDGET(entity) != priv->budget || priv->editing_account)
+            return;
+    }
+    else if (!GNC_IS_ACCOUNT(entity) && !GNC_IS_PRICE(entity))
+        return;
+
+    gbv_totals_cache_invalidate (budget_view, NULL, -1);
+}
+
+/** \brief Return the budget amount of a top level account in the totals
+ currency, for a period or, with period_num -1, for the whole budget.
+*/
+static gnc_numeric
+gbv_get_top_account_total (GncBudgetView *budget_view, gint index,
+                           gint period_num, gnc_commodity *total_currency)
+{
+    GncBudgetViewPrivate *priv = GNC_BUDGET_VIEW_GET_PRIVATE(budget_view);
+    gint num_accounts = gnc_account_n_children (priv->rootAcct);
+    gint num_periods = gnc_budget_get_num_periods (priv->budget);
+    Account *account;
+    BudgetTotal *entry;
+
+    if (!priv->totals_cache || priv->totals_cache_accounts != num_accounts ||
+        priv->totals_cache_periods != num_periods ||
+        priv->totals_currency != total_currency)
+    {
+        g_free (priv->totals_cache);
+        priv->totals_cache = g_new0 (BudgetTotal, num_accounts * (num_periods + 1));
+        priv->totals_cache_accounts = num_accounts;
+        priv->totals_cache_periods = num_periods;
+        priv->totals_currency = total_currency;
+    }
+
+    entry = &priv->totals_cache[index * (num_periods + 1) + period_num + 1];
+    if (entry->valid)
+        return entry->value;
+
+    account = gnc_account_nth_child (priv->rootAcct, index);
+    if (period_num < 0)
+        entry->value = bgv_get_total_for_account (account, priv->budget, total_currency);
+    else
+    {
+        GNCPriceDB *pdb = gnc_pricedb_get_db (gnc_get_current_book ());
+
+        entry->value = gbv_get_accumulated_budget_amount (priv->budget, account, period_num);
+        entry->value = gnc_pricedb_convert_balance_nearest_price_t64 (
+                           pdb, entry->value, gnc_account_get_currency_or_parent (account),
+                           total_currency,
+                           gnc_budget_get_period_start_date (priv->budget, period_num));
+    }
+    entry->valid = TRUE;
+
+    return entry->value;
 }
 
 /** \brief Function to find the total in a column of budget provided and
@@ -1297,8 +1441,7 @@ totals_col_source (GtkTreeViewColumn *col, GtkCellRenderer *cell,
     gint i;
     gint num_top_accounts;
     gboolean neg;
-    GNCPriceDB *pdb;
-    gnc_commodity *total_currency, *currency;
+    gnc_commodity *total_currency;
     gnc_numeric total = gnc_numeric_zero ();
 
     budget_view = GNC_BUDGET_VIEW(user_data);
@@ -1307,7 +1450,6 @@ totals_col_source (GtkTreeViewColumn *col, GtkCellRenderer *cell,
     gtk_tree_model_get (s_model, s_iter, 1, &row_type, -1);
     period_num = GPOINTER_TO_INT(g_object_get_data (G_OBJECT(col), "period_num"));
 
-    pdb = gnc_pricedb_get_db (gnc_get_current_book ());
     total_currency = gnc_default_currency ();
     num_top_accounts = gnc_account_n_children (priv->rootAcct);
 
@@ -1318,7 +1460,6 @@ totals_col_source (GtkTreeViewColumn *col, GtkCellRenderer *cell,
         GNCAccountType acctype;
 
         account  = gnc_account_nth_child (priv->rootAcct, i);
-        currency = gnc_account_get_currency_or_parent (account);
         acctype = xaccAccountGetType (account);
 
         if (gnc_using_unreversed_budgets (gnc_account_get_book (account)))
@@ -1382,19 +1523,7 @@ totals_col_source (GtkTreeViewColumn *col, GtkCellRenderer *cell,
             }
         }
         // find the total for this account
-
-        if (period_num < 0)
-        {
-            value = bgv_get_total_for_account (account, priv->budget, total_currency);
-        }
-        else
-        {
-            value = gbv_get_accumulated_budget_amount (priv->budget, account, period_num);
-
-            value = gnc_pricedb_convert_balance_nearest_price_t64 (
-                        pdb, value, currency, total_currency,
-                        gnc_budget_get_period_start_date (priv->budget, period_num));
-        }
+        value = gbv_get_top_account_total (budget_view, i, period_num, total_currency);
 
         if (neg)
             value = gnc_numeric_neg (value);
@@ -94,6 +94,8 @@ static void gnc_main_window_cmd_tools_imap_editor (GtkAction *action, GncMainWin
 static void gnc_main_window_cmd_tools_trans_doclink (GtkAction *action, GncMainWindowActionData *data);
 static void gnc_main_window_cmd_tools_commodity_editor (GtkAction *action, GncMainWindowActionData *data);
 static void gnc_main_window_cmd_help_totd (GtkAction *action, GncMainWindowActionData *data);
+static void gnc_main_window_cmd_extensions_counters (GtkAction *action, GncMainWindowActionData *data);
+static void gnc_main_window_cmd_extensions_memory (GtkAction *action, GncMainWindowActionData *data);
 
 
 
@@ -218,6 +220,19 @@ static GtkActionEntry gnc_plugin_actions [] =
         G_CALLBACK (gnc_main_window_cmd_tools_trans_doclink)
     },
 
+    /* Extensions menu */
+
+    {
+        "ExtensionsCountersAction", NULL, N_("Engine _Counters"), NULL,
+        N_("Show the engine's counters and timers"),
+        G_CALLBACK (gnc_main_window_cmd_extensions_counters)
+    },
+    {
+        "ExtensionsMemoryAction", NULL, N_("Book _Memory"), NULL,
+        N_("Show the objects in the book and the approximate memory they take"),
+        G_CALLBACK (gnc_main_window_cmd_extensions_memory)
+    },
+
     /* Help menu */
 
     {
@@ -663,5 +678,40 @@ gnc_main_window_cmd_help_totd (GtkAction *action, GncMainWindowActionData *data)
     gnc_totd_dialog(GTK_WINDOW(data->window), FALSE);
 }
 
+static void
+gnc_main_window_cmd_extensions_counters (GtkAction *action, GncMainWindowActionData *data)
+{
+    gchar *report;
+
+    g_return_if_fail (data != NULL);
+
+    if (!qof_counters_enabled ())
+    {
+        gnc_info_dialog (GTK_WINDOW (data->window), "%s",
+                         _("This build doesn't collect engine counters. "
+                           "Configure it with ENABLE_INSTRUMENTATION to turn them on."));
+        return;
+    }
+
+    report = qof_counter_report ();
+    gnc_info_dialog (GTK_WINDOW (data->window), "%s", report);
+    g_free (report);
+}
+
+static void
+gnc_main_window_cmd_extensions_memory (GtkAction *action, GncMainWindowActionData *data)
+{
+    gchar *report;
+
+    g_return_if_fail (data != NULL);
+
+    if (!gnc_current_session_exist ())
+        return;
+
+    report = qof_book_memory_report (gnc_get_current_book ());
+    gnc_info_dialog (GTK_WINDOW (data->window), "%s", report);
+    g_free (report);
+}
+
 /** @} */
 /** @} */
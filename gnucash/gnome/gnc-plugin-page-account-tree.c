@@ -1638,6 +1638,10 @@ gnc_plugin_page_account_tree_cmd_delete_account (GtkAction *action, GncPluginPag
     if (account == NULL)
         return;
 
+    /* The splits to move or delete include any still in the database. */
+    if (qof_book_get_archive_date (gnc_get_current_book ()) != G_MININT64)
+        qof_session_ensure_all_data_loaded (gnc_get_current_session ());
+
     memset (&adopt, 0, sizeof (adopt));
     /* If the account has objects referring to it, show the list - the account can't be deleted until these
        references are dealt with. */
@@ -2079,8 +2083,8 @@ gnc_plugin_page_account_tree_cmd_scrub_all (GtkAction *action, GncPluginPageAcco
                                             G_CALLBACK(scrub_kp_handler), NULL);
     gnc_window_set_progressbar_window (window);
 
-    xaccAccountTreeScrubOrphans (root, gnc_window_show_progress);
-    xaccAccountTreeScrubImbalance (root, gnc_window_show_progress);
+    /* Only what changed since the last time, after the first. */
+    xaccBookScrubChanged (gnc_get_current_book (), gnc_window_show_progress);
     // XXX: Lots/capital gains scrubbing is disabled
     if (g_getenv("GNC_AUTO_SCRUB_LOTS") != NULL)
         xaccAccountTreeScrubLots(root);
@@ -1443,6 +1443,7 @@ gnc_plugin_page_report_reload_cb( GtkAction *action, GncPluginPageReport *report
     DEBUG( "reload-redraw" );
     dirty_report = scm_c_eval_string("gnc:report-set-dirty?!");
     scm_call_2(dirty_report, priv->cur_report, SCM_BOOL_T);
+    gnc_report_cache_remove (priv->cur_report);
 
     /* now queue the fact that we need to reload this report */
 
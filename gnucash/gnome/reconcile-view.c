@@ -60,6 +60,8 @@ static void gnc_reconcile_view_init (GNCReconcileView *view);
 static void gnc_reconcile_view_class_init (GNCReconcileViewClass *klass);
 static void gnc_reconcile_view_finalize (GObject *object);
 static gpointer gnc_reconcile_view_is_reconciled (gpointer item, gpointer user_data);
+static void gnc_reconcile_view_toggle_split (GNCReconcileView *view, Split *split);
+static void grv_balance_hash_helper (gpointer key, gpointer value, gpointer user_data);
 static void gnc_reconcile_view_line_toggled (GNCQueryView *qview, gpointer item, gpointer user_data);
 static void gnc_reconcile_view_double_click_entry (GNCQueryView *qview, gpointer item, gpointer user_data);
 static void gnc_reconcile_view_row_selected (GNCQueryView *qview, gpointer item, gpointer user_data);
@@ -378,7 +380,7 @@ gnc_reconcile_view_new (Account *account, GNCReconcileViewType type,
 
             if (recn == CREC &&
         gnc_difftime (trans_date, statement_date_day_end) <= 0)
-        g_hash_table_insert (view->reconciled, split, split);
+                gnc_reconcile_view_toggle_split (view, split);
         }
     }
 
@@ -398,6 +400,7 @@ gnc_reconcile_view_init (GNCReconcileView *view)
                 qof_book_use_split_action_for_num_field(gnc_get_current_book());
 
     view->reconciled = g_hash_table_new (NULL, NULL);
+    view->reconciled_total = gnc_numeric_zero ();
     view->account = NULL;
     view->sibling = NULL;
 
@@ -493,10 +496,20 @@ gnc_reconcile_view_toggle_split (GNCReconcileView *view, Split *split)
 
     current = g_hash_table_lookup (view->reconciled, split);
 
+    /* Keep the total up to date as we go, rather than adding up all the
+     * reconciled splits every time the balance is shown. */
     if (current == NULL)
+    {
         g_hash_table_insert (view->reconciled, split, split);
+        view->reconciled_total = gnc_numeric_add_fixed (view->reconciled_total,
+                                                        xaccSplitGetAmount (split));
+    }
     else
+    {
         g_hash_table_remove (view->reconciled, split);
+        view->reconciled_total = gnc_numeric_sub_fixed (view->reconciled_total,
+                                                        xaccSplitGetAmount (split));
+    }
 }
 
 
@@ -581,6 +594,7 @@ gnc_reconcile_view_set_list ( GNCReconcileView  *view, gboolean reconcile)
     gboolean           toggled;
     GList             *node;
     GList             *list_of_rows;
+    Split             *last_toggled = NULL;
 
     model =  gtk_tree_view_get_model (GTK_TREE_VIEW (qview));
     selection = gtk_tree_view_get_selection (GTK_TREE_VIEW (qview));
@@ -599,10 +613,18 @@ gnc_reconcile_view_set_list ( GNCReconcileView  *view, gboolean reconcile)
             gtk_list_store_set (GTK_LIST_STORE (model), &iter, REC_RECN, reconcile, -1);
 
             if(reconcile != toggled)
-                gnc_reconcile_view_toggle (view, entry);
+            {
+                gnc_reconcile_view_toggle_split (view, entry);
+                last_toggled = entry;
+            }
         }
         gtk_tree_path_free(node->data);
     }
+    /* Tell the window once, so that toggling thousands of splits doesn't
+     * recalculate its balances thousands of times. */
+    if (last_toggled)
+        g_signal_emit (G_OBJECT (view),
+                       reconcile_view_signals[TOGGLE_RECONCILED], 0, last_toggled);
     // Out of site toggles on selected rows may not appear correctly drawn so
     // queue a draw for the treeview widget
     gtk_widget_queue_draw (GTK_WIDGET(qview));
@@ -752,14 +774,12 @@ gnc_reconcile_view_is_reconciled (gpointer item, gpointer user_data)
  * Args: view - view to refresh                                     *
  * Returns: nothing                                                 *
 \********************************************************************/
-static void
+static gboolean
 grv_refresh_helper (gpointer key, gpointer value, gpointer user_data)
 {
-    GNCReconcileView *view = user_data;
-    GNCQueryView *qview = GNC_QUERY_VIEW (view);
+    GHashTable *in_view = user_data;
 
-    if (!gnc_query_view_item_in_view (qview, key))
-        g_hash_table_remove (view->reconciled, key);
+    return !g_hash_table_contains (in_view, key);
 }
 
 void
@@ -789,7 +809,28 @@ gnc_reconcile_view_refresh (GNCReconcileView *view)
 
     /* Now verify that everything in the reconcile hash is still in qview */
     if (view->reconciled)
-        g_hash_table_foreach (view->reconciled, grv_refresh_helper, view);
+    {
+        GHashTable *in_view = g_hash_table_new (NULL, NULL);
+        GtkTreeModel *model = gtk_tree_view_get_model (GTK_TREE_VIEW (qview));
+        GtkTreeIter iter;
+        gboolean valid = gtk_tree_model_get_iter_first (model, &iter);
+
+        while (valid)
+        {
+            gpointer entry;
+
+            gtk_tree_model_get (model, &iter, REC_POINTER, &entry, -1);
+            g_hash_table_add (in_view, entry);
+            valid = gtk_tree_model_iter_next (model, &iter);
+        }
+        g_hash_table_foreach_remove (view->reconciled, grv_refresh_helper, in_view);
+        g_hash_table_destroy (in_view);
+
+        /* The amounts may have been edited too, so start the total again. */
+        view->reconciled_total = gnc_numeric_zero ();
+        g_hash_table_foreach (view->reconciled, grv_balance_hash_helper,
+                              &view->reconciled_total);
+    }
 }
 
 
@@ -820,9 +861,7 @@ gnc_reconcile_view_reconciled_balance (GNCReconcileView *view)
     if (view->reconciled == NULL)
         return total;
 
-    g_hash_table_foreach (view->reconciled, grv_balance_hash_helper, &total);
-
-    return gnc_numeric_abs (total);
+    return gnc_numeric_abs (view->reconciled_total);
 }
 
 
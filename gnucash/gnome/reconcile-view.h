@@ -59,6 +59,7 @@ struct GNCReconcileView
     GNCQueryView         qview;
 
     GHashTable          *reconciled;
+    gnc_numeric          reconciled_total; /* Sum of the reconciled amounts */
     Account             *account;
     GList               *column_list;
 
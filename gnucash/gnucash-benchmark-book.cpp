@@ -0,0 +1,586 @@
+/*
+ * gnucash-benchmark-book.cpp -- Made-up books for gnucash-benchmarks
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, contact:
+ *
+ * Free Software Foundation           Voice:  +1-617-542-5942
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org
+ */
+#include <config.h>
+
+#include "gnucash-benchmark-book.hpp"
+
+extern "C" {
+#include <Account.h>
+#include <Transaction.h>
+#include <gnc-commodity.h>
+#include <gnc-date.h>
+#include <gnc-lot.h>
+#include <gnc-pricedb.h>
+#include <gncCustomer.h>
+#include <gncEntry.h>
+#include <gncInvoice.h>
+#include <gncOwner.h>
+#include <gncVendor.h>
+}
+
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+const char *payees[] =
+{
+    "Grocery Store", "Gas Station", "Pharmacy", "Hardware Store",
+    "Restaurant", "Coffee Shop", "Book Shop", "Electricity Company",
+    "Phone Company", "Bakery", "Cinema", "Train Tickets",
+};
+
+const char *expense_names[] =
+{
+    "Groceries", "Auto", "Medical", "Household", "Dining", "Utilities",
+    "Phone", "Books", "Entertainment", "Travel", "Clothes", "Gifts",
+};
+
+constexpr time64 one_day = 24 * 60 * 60;
+constexpr int years = 10;
+
+/* A purchase of a stock not all sold yet. */
+struct Parcel
+{
+    GNCLot *lot;
+    int64_t units;
+};
+
+struct Stock
+{
+    gnc_commodity *commodity;
+    Account *account;
+    int64_t price_cents;
+    std::deque<Parcel> parcels;
+};
+
+class BookMaker
+{
+public:
+    BookMaker (QofBook *book, size_t n_splits, unsigned seed);
+    Gnucash::BenchmarkBookStats make (void);
+
+private:
+    /* Uniformly from lo to hi.  Not with a std::uniform_int_distribution,
+     * whose results differ between standard libraries. */
+    int64_t random (int64_t lo, int64_t hi)
+    { return lo + static_cast<int64_t>(m_rng () % (hi - lo + 1)); }
+    gnc_numeric cents (int64_t n) { return gnc_numeric_create (n, 100); }
+
+    Account *add_account (Account *parent, const std::string& name,
+                          GNCAccountType type, gnc_commodity *commodity);
+    void make_commodities_and_accounts (void);
+    void make_owners (void);
+    void make_prices (void);
+    void add_price (std::vector<GNCPrice*>& prices, gnc_commodity *commodity,
+                    time64 date, int64_t value_cents);
+
+    time64 now (void) const;
+    Transaction *begin_trans (const char *description, gnc_commodity *currency);
+    Split *add_split (Transaction *trans, Account *account,
+                      gnc_numeric amount, gnc_numeric value);
+    void commit (Transaction *trans);
+    void add_transfer (Account *from, Account *to, int64_t value_cents,
+                       const char *description);
+
+    void add_expense (void);
+    void add_salary (void);
+    void add_trade (void);
+    void add_dividend (void);
+    void add_euro_transfer (void);
+    void add_invoice (bool bill);
+    void add_payment (bool bill);
+
+    QofBook *m_book;
+    size_t m_n_splits;
+    std::mt19937 m_rng;
+    size_t m_splits = 0;
+    time64 m_start, m_end;
+
+    gnc_commodity *m_usd, *m_eur, *m_gbp;
+    int64_t m_eur_cents = 110;  /* in USD */
+    std::vector<Stock> m_stocks;
+    std::vector<Account*> m_expenses;
+    Account *m_checking, *m_savings, *m_euro_bank, *m_euro_expense,
+            *m_card, *m_receivable, *m_payable, *m_salary, *m_dividends,
+            *m_sales, *m_services, *m_taxes, *m_fees, *m_supplies;
+    std::vector<GncCustomer*> m_customers;
+    std::vector<GncVendor*> m_vendors;
+    std::deque<GncInvoice*> m_unpaid_invoices, m_unpaid_bills;
+    size_t m_n_invoices = 0, m_n_prices = 0;
+};
+
+BookMaker::BookMaker (QofBook *book, size_t n_splits, unsigned seed)
+    : m_book (book), m_n_splits (n_splits), m_rng (seed)
+{
+    m_end = gnc_time64_get_today_end ();
+    m_start = gnc_time64_get_day_start (m_end - years * 365 * one_day);
+}
+
+Account *
+BookMaker::add_account (Account *parent, const std::string& name,
+                        GNCAccountType type, gnc_commodity *commodity)
+{
+    auto account = xaccMallocAccount (m_book);
+
+    /* Left in edit until the book is made, so that the splits are only
+     * sorted and the balances worked out once. */
+    xaccAccountBeginEdit (account);
+    xaccAccountSetName (account, name.c_str());
+    xaccAccountSetType (account, type);
+    xaccAccountSetCommodity (account, commodity);
+    gnc_account_append_child (parent, account);
+    return account;
+}
+
+void
+BookMaker::make_commodities_and_accounts (void)
+{
+    auto table = gnc_commodity_table_get_table (m_book);
+    m_usd = gnc_commodity_table_lookup (table, GNC_COMMODITY_NS_CURRENCY, "USD");
+    m_eur = gnc_commodity_table_lookup (table, GNC_COMMODITY_NS_CURRENCY, "EUR");
+    m_gbp = gnc_commodity_table_lookup (table, GNC_COMMODITY_NS_CURRENCY, "GBP");
+
+    auto root = gnc_book_get_root_account (m_book);
+    auto assets = add_account (root, "Assets", ACCT_TYPE_ASSET, m_usd);
+    auto liabilities = add_account (root, "Liabilities", ACCT_TYPE_LIABILITY, m_usd);
+    auto income = add_account (root, "Income", ACCT_TYPE_INCOME, m_usd);
+    auto expenses = add_account (root, "Expenses", ACCT_TYPE_EXPENSE, m_usd);
+    add_account (root, "Equity", ACCT_TYPE_EQUITY, m_usd);
+
+    m_checking = add_account (assets, "Checking Account", ACCT_TYPE_BANK, m_usd);
+    m_savings = add_account (assets, "Savings Account", ACCT_TYPE_BANK, m_usd);
+    m_euro_bank = add_account (assets, "Euro Account", ACCT_TYPE_BANK, m_eur);
+    m_receivable = add_account (assets, "Accounts Receivable",
+                                ACCT_TYPE_RECEIVABLE, m_usd);
+    auto brokerage = add_account (assets, "Brokerage", ACCT_TYPE_ASSET, m_usd);
+    m_card = add_account (liabilities, "Credit Card", ACCT_TYPE_CREDIT, m_usd);
+    m_payable = add_account (liabilities, "Accounts Payable",
+                             ACCT_TYPE_PAYABLE, m_usd);
+    m_salary = add_account (income, "Salary", ACCT_TYPE_INCOME, m_usd);
+    m_dividends = add_account (income, "Dividends", ACCT_TYPE_INCOME, m_usd);
+    m_sales = add_account (income, "Sales", ACCT_TYPE_INCOME, m_usd);
+    m_services = add_account (income, "Services", ACCT_TYPE_INCOME, m_usd);
+    m_taxes = add_account (expenses, "Taxes", ACCT_TYPE_EXPENSE, m_usd);
+    m_fees = add_account (expenses, "Brokerage Fees", ACCT_TYPE_EXPENSE, m_usd);
+    m_supplies = add_account (expenses, "Supplies", ACCT_TYPE_EXPENSE, m_usd);
+    m_euro_expense = add_account (expenses, "Euro Travel", ACCT_TYPE_EXPENSE,
+                                  m_eur);
+
+    /* A group of expense accounts for every 100k splits */
+    auto n_groups = 1 + m_n_splits / 100000;
+    for (size_t i = 0; i < n_groups; ++i)
+    {
+        auto group = n_groups == 1 ? expenses :
+                     add_account (expenses, "Group " + std::to_string (i + 1),
+                                  ACCT_TYPE_EXPENSE, m_usd);
+        for (auto name : expense_names)
+            m_expenses.push_back (add_account (group, name, ACCT_TYPE_EXPENSE,
+                                               m_usd));
+    }
+
+    /* And a stock for every 50k splits */
+    auto n_stocks = 5 + m_n_splits / 50000;
+    for (size_t i = 0; i < n_stocks; ++i)
+    {
+        auto symbol = "STK" + std::to_string (i + 1);
+        auto name = "Stock " + std::to_string (i + 1) + " Inc.";
+        auto commodity = gnc_commodity_new (m_book, name.c_str(),
+                                            i % 2 ? "NYSE" : "NASDAQ",
+                                            symbol.c_str(), "", 1);
+        gnc_commodity_table_insert (table, commodity);
+        auto account = add_account (brokerage, name, ACCT_TYPE_STOCK, commodity);
+        m_stocks.push_back ({ commodity, account, random (1000, 20000), {} });
+    }
+}
+
+void
+BookMaker::make_owners (void)
+{
+    auto n_customers = 20 + m_n_splits / 500;
+    auto n_vendors = 10 + m_n_splits / 2000;
+
+    for (size_t i = 0; i < n_customers; ++i)
+    {
+        auto id = std::to_string (i + 1);
+        auto customer = gncCustomerCreate (m_book);
+        gncCustomerBeginEdit (customer);
+        gncCustomerSetID (customer, id.c_str());
+        gncCustomerSetName (customer, ("Customer " + id).c_str());
+        gncCustomerSetCurrency (customer, m_usd);
+        gncCustomerCommitEdit (customer);
+        m_customers.push_back (customer);
+    }
+    for (size_t i = 0; i < n_vendors; ++i)
+    {
+        auto id = std::to_string (i + 1);
+        auto vendor = gncVendorCreate (m_book);
+        gncVendorBeginEdit (vendor);
+        gncVendorSetID (vendor, id.c_str());
+        gncVendorSetName (vendor, ("Vendor " + id).c_str());
+        gncVendorSetCurrency (vendor, m_usd);
+        gncVendorCommitEdit (vendor);
+        m_vendors.push_back (vendor);
+    }
+}
+
+void
+BookMaker::add_price (std::vector<GNCPrice*>& prices, gnc_commodity *commodity,
+                      time64 date, int64_t value_cents)
+{
+    auto price = gnc_price_create (m_book);
+
+    gnc_price_begin_edit (price);
+    gnc_price_set_commodity (price, commodity);
+    gnc_price_set_currency (price, m_usd);
+    gnc_price_set_time64 (price, date);
+    gnc_price_set_source (price, PRICE_SOURCE_FQ);
+    gnc_price_set_typestr (price, PRICE_TYPE_LAST);
+    gnc_price_set_value (price, cents (value_cents));
+    gnc_price_commit_edit (price);
+    prices.push_back (price);
+}
+
+/* Weekly prices of the stocks and the foreign currencies, walking at
+ * random.  The trades use the latest price. */
+void
+BookMaker::make_prices (void)
+{
+    std::vector<GNCPrice*> prices;
+    auto gbp_cents = int64_t{130};
+
+    for (auto date = m_start; date <= m_end; date += 7 * one_day)
+    {
+        for (auto& stock : m_stocks)
+        {
+            stock.price_cents += stock.price_cents * random (-20, 22) / 1000;
+            if (stock.price_cents < 100)
+                stock.price_cents = 100;
+            add_price (prices, stock.commodity, date, stock.price_cents);
+        }
+        m_eur_cents = std::max<int64_t> (90, m_eur_cents + random (-1, 1));
+        gbp_cents = std::max<int64_t> (100, gbp_cents + random (-1, 1));
+        add_price (prices, m_eur, date, m_eur_cents);
+        add_price (prices, m_gbp, date, gbp_cents);
+    }
+
+    auto pdb = gnc_pricedb_get_db (m_book);
+    m_n_prices = gnc_pricedb_add_prices (pdb, prices.data(), prices.size());
+    for (auto price : prices)
+        gnc_price_unref (price);
+}
+
+/* The date of the next transaction, so that the book fills the years
+ * evenly. */
+time64
+BookMaker::now (void) const
+{
+    auto span = static_cast<double>(m_end - m_start);
+    return m_start + static_cast<time64>(span * m_splits / m_n_splits);
+}
+
+Transaction *
+BookMaker::begin_trans (const char *description, gnc_commodity *currency)
+{
+    auto trans = xaccMallocTransaction (m_book);
+
+    xaccTransBeginEdit (trans);
+    xaccTransSetCurrency (trans, currency);
+    xaccTransSetDatePostedSecsNormalized (trans, now ());
+    xaccTransSetDateEnteredSecs (trans, now ());
+    xaccTransSetDescription (trans, description);
+    return trans;
+}
+
+Split *
+BookMaker::add_split (Transaction *trans, Account *account,
+                      gnc_numeric amount, gnc_numeric value)
+{
+    auto split = xaccMallocSplit (m_book);
+
+    xaccSplitSetParent (split, trans);
+    xaccSplitSetAccount (split, account);
+    xaccSplitSetAmount (split, amount);
+    xaccSplitSetValue (split, value);
+    return split;
+}
+
+void
+BookMaker::commit (Transaction *trans)
+{
+    m_splits += xaccTransCountSplits (trans);
+    xaccTransCommitEdit (trans);
+}
+
+void
+BookMaker::add_transfer (Account *from, Account *to, int64_t value_cents,
+                         const char *description)
+{
+    auto trans = begin_trans (description, m_usd);
+
+    add_split (trans, to, cents (value_cents), cents (value_cents));
+    add_split (trans, from, cents (-value_cents), cents (-value_cents));
+    commit (trans);
+}
+
+void
+BookMaker::add_expense (void)
+{
+    /* The first accounts are used most */
+    auto n = static_cast<int64_t>(m_expenses.size());
+    auto account = m_expenses[random (0, n - 1) * random (0, n - 1) / n];
+    auto from = random (0, 9) < 6 ? m_checking : m_card;
+    auto payee = payees[random (0, G_N_ELEMENTS (payees) - 1)];
+
+    add_transfer (from, account, random (100, 20000), payee);
+}
+
+void
+BookMaker::add_salary (void)
+{
+    auto gross = random (300000, 600000);
+    auto tax = gross * random (20, 35) / 100;
+    auto trans = begin_trans ("Salary", m_usd);
+
+    add_split (trans, m_checking, cents (gross - tax), cents (gross - tax));
+    add_split (trans, m_taxes, cents (tax), cents (tax));
+    add_split (trans, m_salary, cents (-gross), cents (-gross));
+    commit (trans);
+}
+
+/* A purchase, in a lot of its own, or a sale of part of the oldest
+ * purchase not sold yet, with brokerage half of the time. */
+void
+BookMaker::add_trade (void)
+{
+    auto& stock = m_stocks[random (0, m_stocks.size() - 1)];
+    auto sell = !stock.parcels.empty() && random (0, 2) == 0;
+    auto units = sell ? random (1, stock.parcels.front().units) : random (1, 100);
+    auto value = units * stock.price_cents;
+    auto fee = random (0, 1) ? random (495, 1995) : 0;
+    auto trans = begin_trans (sell ? "Sell" : "Buy", m_usd);
+    auto cash = sell ? value - fee : -value - fee;
+
+    auto split = add_split (trans, stock.account,
+                            gnc_numeric_create (sell ? -units : units, 1),
+                            cents (sell ? -value : value));
+    add_split (trans, m_checking, cents (cash), cents (cash));
+    if (fee)
+        add_split (trans, m_fees, cents (fee), cents (fee));
+    commit (trans);
+
+    if (sell)
+    {
+        auto& parcel = stock.parcels.front();
+        gnc_lot_add_split (parcel.lot, split);
+        parcel.units -= units;
+        if (!parcel.units)
+            stock.parcels.pop_front ();
+    }
+    else
+    {
+        auto lot = gnc_lot_new (m_book);
+        gnc_lot_add_split (lot, split);
+        stock.parcels.push_back ({ lot, units });
+    }
+}
+
+void
+BookMaker::add_dividend (void)
+{
+    const auto& stock = m_stocks[random (0, m_stocks.size() - 1)];
+    auto trans = begin_trans (gnc_commodity_get_mnemonic (stock.commodity),
+                              m_usd);
+    auto amount = random (1000, 50000);
+
+    add_split (trans, m_checking, cents (amount), cents (amount));
+    add_split (trans, m_dividends, cents (-amount), cents (-amount));
+    commit (trans);
+}
+
+/* Dollars to the euro account, at the latest rate, or a euro expense. */
+void
+BookMaker::add_euro_transfer (void)
+{
+    if (random (0, 1))
+    {
+        auto trans = begin_trans ("To the euro account", m_usd);
+        auto value = random (10000, 100000);
+
+        add_split (trans, m_euro_bank, cents (value * 100 / m_eur_cents),
+                   cents (value));
+        add_split (trans, m_checking, cents (-value), cents (-value));
+        commit (trans);
+    }
+    else
+    {
+        auto trans = begin_trans ("Hotel", m_eur);
+        auto value = random (5000, 50000);
+
+        add_split (trans, m_euro_expense, cents (value), cents (value));
+        add_split (trans, m_euro_bank, cents (-value), cents (-value));
+        commit (trans);
+    }
+}
+
+void
+BookMaker::add_invoice (bool bill)
+{
+    GncOwner owner;
+    auto invoice = gncInvoiceCreate (m_book);
+    auto id = std::to_string (++m_n_invoices);
+
+    if (bill)
+        gncOwnerInitVendor (&owner, m_vendors[random (0, m_vendors.size() - 1)]);
+    else
+        gncOwnerInitCustomer (&owner,
+                              m_customers[random (0, m_customers.size() - 1)]);
+
+    gncInvoiceBeginEdit (invoice);
+    gncInvoiceSetID (invoice, id.c_str());
+    gncInvoiceSetOwner (invoice, &owner);
+    gncInvoiceSetCurrency (invoice, m_usd);
+    gncInvoiceSetDateOpened (invoice, now ());
+    for (auto n_entries = random (1, 3); n_entries; --n_entries)
+    {
+        auto entry = gncEntryCreate (m_book);
+        gncEntrySetDate (entry, now ());
+        gncEntrySetDateEntered (entry, now ());
+        gncEntrySetQuantity (entry, gnc_numeric_create (random (1, 10), 1));
+        if (bill)
+        {
+            gncEntrySetDescription (entry, "Office supplies");
+            gncEntrySetBillAccount (entry, m_supplies);
+            gncEntrySetBillPrice (entry, cents (random (500, 20000)));
+            gncBillAddEntry (invoice, entry);
+        }
+        else
+        {
+            auto service = random (0, 1);
+            gncEntrySetDescription (entry, service ? "Consulting" : "Widgets");
+            gncEntrySetInvAccount (entry, service ? m_services : m_sales);
+            gncEntrySetInvPrice (entry, cents (random (1000, 50000)));
+            gncInvoiceAddEntry (invoice, entry);
+        }
+    }
+    gncInvoiceCommitEdit (invoice);
+
+    auto trans = gncInvoicePostToAccount (invoice, bill ? m_payable : m_receivable,
+                                          now (), now () + 30 * one_day,
+                                          nullptr, TRUE, FALSE);
+    if (!trans)
+        return;
+    m_splits += xaccTransCountSplits (trans);
+    (bill ? m_unpaid_bills : m_unpaid_invoices).push_back (invoice);
+}
+
+/* Pay the oldest unpaid invoice or bill in full. */
+void
+BookMaker::add_payment (bool bill)
+{
+    auto& unpaid = bill ? m_unpaid_bills : m_unpaid_invoices;
+
+    if (unpaid.empty())
+    {
+        add_invoice (bill);
+        return;
+    }
+
+    auto invoice = unpaid.front();
+    unpaid.pop_front ();
+
+    auto lots = g_list_prepend (nullptr, gncInvoiceGetPostedLot (invoice));
+    auto total = gncInvoiceGetTotal (invoice);
+    gncOwnerApplyPaymentSecs (gncInvoiceGetOwner (invoice), nullptr, lots,
+                              bill ? m_payable : m_receivable, m_checking,
+                              total, gnc_numeric_create (1, 1), now (),
+                              "Payment", nullptr, FALSE);
+    g_list_free (lots);
+    m_splits += 2;
+}
+
+Gnucash::BenchmarkBookStats
+BookMaker::make (void)
+{
+    Gnucash::BenchmarkBookStats stats;
+
+    qof_event_suspend ();
+    make_commodities_and_accounts ();
+    make_owners ();
+    make_prices ();
+
+    while (m_splits < m_n_splits)
+    {
+        auto kind = random (0, 99);
+        if (kind < 50)
+            add_expense ();
+        else if (kind < 54)
+            add_transfer (m_checking, m_card, random (10000, 200000),
+                          "Credit card payment");
+        else if (kind < 57)
+            add_transfer (m_checking, m_savings, random (10000, 100000),
+                          "Savings");
+        else if (kind < 64)
+            add_salary ();
+        else if (kind < 76)
+            add_trade ();
+        else if (kind < 81)
+            add_dividend ();
+        else if (kind < 84)
+            add_euro_transfer ();
+        else if (kind < 90)
+            add_invoice (kind >= 88);
+        else
+            add_payment (kind >= 97);
+    }
+
+    auto root = gnc_book_get_root_account (m_book);
+    auto accounts = gnc_account_get_descendants (root);
+    for (auto node = accounts; node; node = node->next)
+        xaccAccountCommitEdit (static_cast<Account*>(node->data));
+    stats.accounts = g_list_length (accounts);
+    g_list_free (accounts);
+    qof_event_resume ();
+
+    auto count = [this](QofIdTypeConst type)
+    { return qof_collection_count (qof_book_get_collection (m_book, type)); };
+    stats.splits = count (GNC_ID_SPLIT);
+    stats.transactions = count (GNC_ID_TRANS);
+    stats.commodities = m_stocks.size();
+    stats.prices = m_n_prices;
+    stats.lots = count (GNC_ID_LOT);
+    stats.customers = m_customers.size();
+    stats.vendors = m_vendors.size();
+    stats.invoices = m_n_invoices;
+    return stats;
+}
+
+}
+
+Gnucash::BenchmarkBookStats
+Gnucash::make_benchmark_book (QofBook *book, size_t n_splits, unsigned seed)
+{
+    return BookMaker (book, n_splits, seed).make ();
+}
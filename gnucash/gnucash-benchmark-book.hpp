@@ -0,0 +1,60 @@
+/*
+ * gnucash-benchmark-book.hpp -- Made-up books for gnucash-benchmarks
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, contact:
+ *
+ * Free Software Foundation           Voice:  +1-617-542-5942
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org
+ */
+
+#ifndef GNUCASH_BENCHMARK_BOOK_HPP
+#define GNUCASH_BENCHMARK_BOOK_HPP
+
+#include <cstddef>
+
+extern "C" {
+#include <qof.h>
+}
+
+namespace Gnucash {
+
+    /** What make_benchmark_book() put in the book. */
+    struct BenchmarkBookStats
+    {
+        size_t splits = 0;
+        size_t transactions = 0;
+        size_t accounts = 0;
+        size_t commodities = 0;
+        size_t prices = 0;
+        size_t lots = 0;
+        size_t customers = 0;
+        size_t vendors = 0;
+        size_t invoices = 0;
+    };
+
+    /** Fill the empty book with a household-and-small-business book of
+     *  about n_splits splits over the ten years up to today: bank and
+     *  credit card spending, salaries, trades in a number of stocks with
+     *  a lot for each purchase, dividends, invoices to customers and
+     *  bills from vendors and their payments, and weekly prices of the
+     *  stocks and foreign currencies.  The number of stocks, expense
+     *  accounts, customers and vendors grows with n_splits.  The same
+     *  seed makes the same book, but for the dates moving with the day
+     *  it's made on, so that reports with their default dates see it.
+     */
+    BenchmarkBookStats make_benchmark_book (QofBook *book, size_t n_splits,
+                                            unsigned seed);
+}
+#endif
@@ -33,17 +33,30 @@
 
 extern "C" {
 #include <gnc-engine-guile.h>
+#include <gnc-book-archive.h>
 #include <gnc-prefs.h>
 #include <gnc-prefs-utils.h>
 #include <gnc-gnome-utils.h>
 #include <gnc-report.h>
 #include <gnc-session.h>
+#include <gnc-uri-utils.h>
+#include <gnc-ui-util.h>
 #include <qoflog.h>
+#include <csv-transactions-writer.h>
+#include <glib/gstdio.h>
+#ifdef G_OS_UNIX
+#include <gio/gio.h>
+#include <gio/gunixsocketaddress.h>
+#include <sys/stat.h>
+#endif
 }
 
+#include <gnc-datetime.hpp>
 #include <boost/locale.hpp>
+#include <algorithm>
 #include <fstream>
 #include <iostream>
+#include <sstream>
 
 namespace bl = boost::locale;
 
@@ -142,9 +155,9 @@ report_session_percentage (const char *message, double percent)
  */
 struct run_report_args {
     const std::string& file_to_load;
-    const std::string& run_report;
+    const std::vector<std::string>& run_reports;
     const std::string& export_type;
-    const std::string& output_file;
+    const std::vector<std::string>& output_files;
 };
 
 static inline void
@@ -161,6 +174,122 @@ write_report_file (const char *html, const char* file)
     // ofs destructor will close the file
 }
 
+static inline void
+write_report_output (const char *output, const std::string& output_file)
+{
+    if (!output_file.empty())
+        write_report_file (output, output_file.c_str());
+    else
+        std::cout << output << std::endl;
+}
+
+/* Run one report of the loaded book into output, or set error. */
+static bool
+report_output (SCM report, SCM type, std::string& output, std::string& error)
+{
+    if (scm_is_true (type))
+    {
+        SCM retval = scm_call_2 (scm_c_eval_string ("gnc:cmdline-template-export"),
+                                 report, type);
+        SCM query_result = scm_c_eval_string ("gnc:html-document?");
+        SCM get_export_string = scm_c_eval_string ("gnc:html-document-export-string");
+        SCM get_export_error = scm_c_eval_string ("gnc:html-document-export-error");
+
+        error = _("This report must be upgraded to \
+return a document object with export-string or export-error.");
+        if (scm_is_false (scm_call_1 (query_result, retval)))
+            return false;
+
+        SCM export_string = scm_call_1 (get_export_string, retval);
+        SCM export_error = scm_call_1 (get_export_error, retval);
+
+        if (scm_is_string (export_string))
+        {
+            auto str = scm_to_utf8_string (export_string);
+            output = str;
+            free (str);
+            return true;
+        }
+        else if (scm_is_string (export_error))
+        {
+            auto err = scm_to_utf8_string (export_error);
+            error = err;
+            free (err);
+        }
+        return false;
+    }
+
+    SCM id = scm_call_1 (scm_c_eval_string ("gnc:cmdline-get-report-id"), report);
+
+    if (scm_is_false (id))
+    {
+        error = _("The report doesn't match a unique report.");
+        return false;
+    }
+    char *html = nullptr, *errmsg = nullptr;
+
+    auto ok = gnc_run_report_with_error_handling (scm_to_int(id), &html, &errmsg);
+    if (ok)
+        output = html;
+    else if (errmsg)
+        error = errmsg;
+    g_free (html);
+    g_free (errmsg);
+    /* The report made for the run isn't needed after it. */
+    gnc_report_remove_by_id (scm_to_int(id));
+    return ok;
+}
+
+/* Run one report of the loaded book, to output_file or stdout.  An
+ * HTML report run to a file is written as it's rendered. */
+/* Print the profile of the report just run, if it was profiled. */
+static void
+print_report_profile (void)
+{
+    if (!gnc_report_get_profiling ())
+        return;
+
+    auto profile = gnc_report_get_last_profile ();
+    if (profile)
+        std::cerr << profile;
+    g_free (profile);
+}
+
+static bool
+run_one_report (SCM report, SCM type, const std::string& output_file)
+{
+    std::string output, error;
+
+    if (scm_is_false (type) && !output_file.empty())
+    {
+        SCM id = scm_call_1 (scm_c_eval_string ("gnc:cmdline-get-report-id"), report);
+        if (scm_is_false (id))
+            return false;
+
+        char *errmsg = nullptr;
+        auto ok = gnc_run_report_to_file_with_error_handling (scm_to_int(id),
+                                                              output_file.c_str(),
+                                                              &errmsg);
+        if (!ok)
+            std::cerr << (errmsg ? errmsg : "") << std::endl;
+        g_free (errmsg);
+        gnc_report_remove_by_id (scm_to_int(id));
+        print_report_profile ();
+        return ok;
+    }
+
+    auto ok = report_output (report, type, output, error);
+    if (scm_is_false (type))
+        print_report_profile ();
+    if (!ok)
+    {
+        std::cerr << error << std::endl;
+        return false;
+    }
+    write_report_output (output.c_str(), output_file);
+    return true;
+}
+
 static void
 scm_run_report (void *data,
                 [[maybe_unused]] int argc, [[maybe_unused]] char **argv)
@@ -168,6 +297,24 @@ scm_run_report (void *data,
     auto args = static_cast<run_report_args*>(data);
 
     scm_c_eval_string("(debug-set! stack 200000)");
+
+    gnc_prefs_init ();
+    qof_event_suspend ();
+
+    auto datafile = args->file_to_load.c_str();
+    PINFO ("Loading datafile %s...\n", datafile);
+
+    auto session = gnc_get_current_session ();
+    if (!session)
+        scm_cleanup_and_exit_with_failure (session);
+
+    qof_session_begin (session, datafile, SESSION_READ_ONLY);
+    if (qof_session_get_error (session) != ERR_BACKEND_NO_ERR)
+        scm_cleanup_and_exit_with_failure (session);
+
+    /* Read the file while the report modules load. */
+    auto load = qof_session_load_async (session, nullptr, nullptr);
+
     scm_c_use_module ("gnucash utilities");
     scm_c_use_module ("gnucash app-utils");
     scm_c_use_module ("gnucash reports");
@@ -175,13 +322,8 @@ scm_run_report (void *data,
     gnc_report_init ();
     // load_system_config();
     // load_user_config();
-    gnc_prefs_init ();
-    qof_event_suspend ();
 
-    auto datafile = args->file_to_load.c_str();
     auto check_report_cmd = scm_c_eval_string ("gnc:cmdline-check-report");
-    auto get_report_cmd = scm_c_eval_string ("gnc:cmdline-get-report-id");
-    auto run_export_cmd = scm_c_eval_string ("gnc:cmdline-template-export");
     /* We generally insist on using scm_from_utf8_string() throughout GnuCash
      * because all GUI-sourced strings and all file-sourced strings are encoded
      * that way. In this case, though, the input is coming from a shell window
@@ -189,100 +331,53 @@ scm_run_report (void *data,
      * so it's necessary here to allow guile to read the locale and interpret
      * the input in that encoding.
      */
-    auto report = scm_from_locale_string (args->run_report.c_str());
     auto type = !args->export_type.empty() ?
                 scm_from_locale_string (args->export_type.c_str()) : SCM_BOOL_F;
+    std::vector<SCM> reports;
 
-    if (scm_is_false (scm_call_2 (check_report_cmd, report, type)))
-        scm_cleanup_and_exit_with_failure (nullptr);
-
-    PINFO ("Loading datafile %s...\n", datafile);
-
-    auto session = gnc_get_current_session ();
-    if (!session)
-        scm_cleanup_and_exit_with_failure (session);
-
-    qof_session_begin (session, datafile, SESSION_READ_ONLY);
-    if (qof_session_get_error (session) != ERR_BACKEND_NO_ERR)
-        scm_cleanup_and_exit_with_failure (session);
-
-    qof_session_load (session, report_session_percentage);
-    if (qof_session_get_error (session) != ERR_BACKEND_NO_ERR)
-        scm_cleanup_and_exit_with_failure (session);
-
-    char *output;
-
-    if (!args->export_type.empty())
+    /* Check all the reports before waiting for the book, so that a
+     * misspelt name in a batch fails at once. */
+    for (const auto& name : args->run_reports)
     {
-        SCM retval = scm_call_2 (run_export_cmd, report, type);
-        SCM query_result = scm_c_eval_string ("gnc:html-document?");
-        SCM get_export_string = scm_c_eval_string ("gnc:html-document-export-string");
-        SCM get_export_error = scm_c_eval_string ("gnc:html-document-export-error");
-
-        if (scm_is_false (scm_call_1 (query_result, retval)))
+        auto report = scm_from_locale_string (name.c_str());
+        if (scm_is_false (scm_call_2 (check_report_cmd, report, type)))
         {
-            std::cerr << _("This report must be upgraded to \
-return a document object with export-string or export-error.") << std::endl;
-            scm_cleanup_and_exit_with_failure (nullptr);
-        }
-
-        SCM export_string = scm_call_1 (get_export_string, retval);
-        SCM export_error = scm_call_1 (get_export_error, retval);
-
-        if (scm_is_string (export_string))
-        {
-            output = scm_to_utf8_string (export_string);
-            if (!args->output_file.empty())
-            {
-                write_report_file(output, args->output_file.c_str());
-            }
-            else
+            if (load)
             {
-                std::cout << output << std::endl;
+                qof_session_load_cancel (load);
+                qof_session_load_finish (load);
             }
-        }
-        else if (scm_is_string (export_error))
-        {
-            auto err = scm_to_utf8_string (export_error);
-            std::cerr << err << std::endl;
-            scm_cleanup_and_exit_with_failure (nullptr);
-        }
-        else
-        {
-            std::cerr << _("This report must be upgraded to \
-return a document object with export-string or export-error.") << std::endl;
             scm_cleanup_and_exit_with_failure (nullptr);
         }
+        reports.push_back (scm_gc_protect_object (report));
     }
-    else
-    {
-        SCM id = scm_call_1(get_report_cmd, report);
 
-        if (scm_is_false (id))
-            scm_cleanup_and_exit_with_failure (nullptr);
-        char *html, *errmsg;
+    if (load)
+        qof_session_load_finish (load);
+    else
+        qof_session_load (session, report_session_percentage);
+    if (qof_session_get_error (session) != ERR_BACKEND_NO_ERR)
+        scm_cleanup_and_exit_with_failure (session);
 
-        if (gnc_run_report_with_error_handling (scm_to_int(id), &html, &errmsg))
-        {
-            if (!args->output_file.empty())
-            {
-                write_report_file(html, args->output_file.c_str());
-            }
-            else
-            {
-                std::cout << html << std::endl;
-            }
-        }
-        else
+    /* The book is loaded once; the reports run one after the other. */
+    auto failed = 0;
+    for (size_t i = 0; i < reports.size(); ++i)
+    {
+        const auto& output_file = i < args->output_files.size() ?
+                                  args->output_files[i] : empty_string;
+        PINFO ("Running report %s...", args->run_reports[i].c_str());
+        if (!run_one_report (reports[i], type, output_file))
         {
-            std::cerr << errmsg << std::endl;
+            PERR ("Report %s failed.", args->run_reports[i].c_str());
+            failed++;
         }
+        scm_gc_unprotect_object (reports[i]);
     }
 
     qof_session_destroy (session);
 
     qof_event_resume ();
-    gnc_shutdown (0);
+    gnc_shutdown (failed ? 1 : 0);
     return;
 }
 
@@ -341,6 +436,294 @@ scm_report_list ([[maybe_unused]] void *data,
     return;
 }
 
+struct serve_args {
+    const std::string& file_to_load;
+    const std::string& socket_path;
+};
+
+#ifdef G_OS_UNIX
+/* A string that changes when the file of a book does, empty if the book
+ * isn't a file.  The server loads the book again when it changes. */
+static std::string
+book_file_stamp (const std::string& uri)
+{
+    std::string stamp;
+    if (!gnc_uri_is_file_uri (uri.c_str()))
+        return stamp;
+
+    auto path = gnc_uri_get_path (uri.c_str());
+    GStatBuf sb;
+    if (g_stat (path, &sb) == 0)
+        stamp = std::to_string (sb.st_mtime) + " " + std::to_string (sb.st_size);
+    g_free (path);
+    return stamp;
+}
+
+static bool
+serve_load_book (const std::string& uri)
+{
+    PINFO ("Loading datafile %s...", uri.c_str());
+    gnc_clear_current_session ();
+    gnc_report_cache_flush ();
+
+    auto session = gnc_get_current_session ();
+    qof_session_begin (session, uri.c_str(), SESSION_READ_ONLY);
+    if (qof_session_get_error (session) == ERR_BACKEND_NO_ERR)
+        qof_session_load (session, nullptr);
+    if (qof_session_get_error (session) == ERR_BACKEND_NO_ERR)
+        return true;
+
+    PERR ("Session Error on %s: %s", uri.c_str(),
+          qof_session_get_error_message (session));
+    gnc_clear_current_session ();
+    return false;
+}
+
+/* Answer one request of the server: a command, a space and its argument.
+ * Returns whether it succeeded, with the answer or the error in reply. */
+static bool
+serve_request (const std::string& request, std::string& reply, bool& quit)
+{
+    auto space = request.find (' ');
+    auto command = request.substr (0, space);
+    auto arg = space == std::string::npos ? empty_string : request.substr (space + 1);
+    auto root = gnc_book_get_root_account (gnc_get_current_book ());
+
+    if (command == "run" || command == "export")
+    {
+        SCM type = SCM_BOOL_F;
+        if (command == "export")
+        {
+            space = arg.find (' ');
+            if (space == std::string::npos)
+            {
+                reply = "export takes an export type and a report";
+                return false;
+            }
+            type = scm_from_utf8_string (arg.substr (0, space).c_str());
+            arg = arg.substr (space + 1);
+        }
+        auto report = scm_from_utf8_string (arg.c_str());
+        if (scm_is_false (scm_call_2 (scm_c_eval_string ("gnc:cmdline-check-report"),
+                                      report, type)))
+        {
+            reply = "no unique report named " + arg;
+            return false;
+        }
+        return report_output (report, type, reply, reply);
+    }
+    else if (command == "accounts")
+    {
+        auto accounts = gnc_account_get_descendants_sorted (root);
+        std::ostringstream names;
+        for (auto node = accounts; node; node = node->next)
+        {
+            auto name = gnc_account_get_full_name (GNC_ACCOUNT (node->data));
+            names << name << "\n";
+            g_free (name);
+        }
+        g_list_free (accounts);
+        reply = names.str();
+        return true;
+    }
+    else if (command == "balance")
+    {
+        auto acc = gnc_account_lookup_by_full_name (root, arg.c_str());
+        if (!acc)
+        {
+            reply = "no account named " + arg;
+            return false;
+        }
+        auto balance = xaccAccountGetBalanceInCurrency (acc, nullptr, TRUE);
+        reply = std::string (xaccPrintAmount (balance, gnc_account_print_info (acc, TRUE)))
+            + "\n";
+        return true;
+    }
+    else if (command == "memory")
+    {
+        auto report = qof_book_memory_report (gnc_get_current_book ());
+        reply = report;
+        g_free (report);
+        return true;
+    }
+    else if (command == "quit")
+    {
+        quit = true;
+        return true;
+    }
+    reply = "unknown command " + command;
+    return false;
+}
+
+/* How long a client may take to send its request or read the answer,
+ * in seconds; the server answers one at a time. */
+#define SERVE_CLIENT_TIMEOUT 10
+/* Failed accepts in a row before the server gives up, and the longest
+ * wait between them, in microseconds. */
+#define SERVE_MAX_ACCEPT_FAILURES 10
+#define SERVE_MAX_ACCEPT_BACKOFF (5 * G_USEC_PER_SEC)
+
+struct serve_state {
+    const std::string& uri;
+    std::string stamp;
+    bool loaded;
+    bool quit;
+};
+
+/* Read one request line from connection and answer it: "OK" and the
+ * answer, or "ERROR" and the message, on a line of its own.  The book
+ * is loaded again first if its file changed or "reload" is asked.  A
+ * client that stays idle is dropped after SERVE_CLIENT_TIMEOUT. */
+static void
+serve_connection (GSocketConnection *connection, serve_state& state)
+{
+    g_socket_set_timeout (g_socket_connection_get_socket (connection),
+                          SERVE_CLIENT_TIMEOUT);
+    auto in = g_data_input_stream_new (
+        g_io_stream_get_input_stream (G_IO_STREAM (connection)));
+    auto out = g_io_stream_get_output_stream (G_IO_STREAM (connection));
+    GError *error = nullptr;
+    auto line = g_data_input_stream_read_line_utf8 (in, nullptr, nullptr, &error);
+    std::string request{line ? line : ""}, reply;
+    auto ok = false;
+
+    if (!line)
+        reply = error ? error->message : "empty request";
+    else
+    {
+        auto stamp = book_file_stamp (state.uri);
+        if (request == "reload" || stamp != state.stamp || !state.loaded)
+        {
+            state.stamp = stamp;
+            state.loaded = serve_load_book (state.uri);
+        }
+        if (!state.loaded)
+            reply = "failed to load " + state.uri;
+        else if (request == "reload")
+            ok = true;
+        else
+        {
+            PINFO ("Request %s", line);
+            ok = serve_request (request, reply, state.quit);
+        }
+    }
+
+    if (!ok)
+    {
+        /* Keep the message on the one line of the reply. */
+        std::replace (reply.begin(), reply.end(), '\n', ' ');
+        std::replace (reply.begin(), reply.end(), '\r', ' ');
+    }
+    auto head = ok ? std::string ("OK\n") : "ERROR " + reply + "\n";
+    g_output_stream_write_all (out, head.c_str(), head.size(), nullptr, nullptr, nullptr);
+    if (ok)
+        g_output_stream_write_all (out, reply.c_str(), reply.size(), nullptr, nullptr, nullptr);
+    g_io_stream_close (G_IO_STREAM (connection), nullptr, nullptr);
+
+    g_clear_error (&error);
+    g_free (line);
+    g_object_unref (in);
+}
+#endif
+
+static void
+scm_serve (void *data,
+           [[maybe_unused]] int argc, [[maybe_unused]] char **argv)
+{
+    auto args = static_cast<serve_args*>(data);
+#ifdef G_OS_UNIX
+    scm_c_eval_string("(debug-set! stack 200000)");
+
+    gnc_prefs_init ();
+    qof_event_suspend ();
+
+    scm_c_use_module ("gnucash utilities");
+    scm_c_use_module ("gnucash app-utils");
+    scm_c_use_module ("gnucash reports");
+    gnc_report_init ();
+
+    serve_state state{args->file_to_load, book_file_stamp (args->file_to_load),
+                      false, false};
+    state.loaded = serve_load_book (state.uri);
+    if (!state.loaded)
+        scm_cleanup_and_exit_with_failure (nullptr);
+
+    auto path = args->socket_path.c_str();
+    GStatBuf statbuf;
+    /* Replace a socket left behind by an earlier server, nothing else. */
+    if (g_lstat (path, &statbuf) == 0)
+    {
+        if (!S_ISSOCK (statbuf.st_mode))
+        {
+            PERR ("%s exists and isn't a socket", path);
+            std::cerr << bl::format (bl::translate ("{1} exists and isn't a socket."))
+                % path << "\n";
+            scm_cleanup_and_exit_with_failure (nullptr);
+        }
+        g_unlink (path);
+    }
+    auto address = g_unix_socket_address_new (path);
+    auto listener = g_socket_listener_new ();
+    GError *error = nullptr;
+    /* Only the user running the server may talk to it; the socket is
+     * created with these permissions so there is no window before a
+     * chmod. */
+    auto old_mask = umask (0077);
+    auto listening = g_socket_listener_add_address (listener, address,
+                                                    G_SOCKET_TYPE_STREAM,
+                                                    G_SOCKET_PROTOCOL_DEFAULT,
+                                                    nullptr, nullptr, &error);
+    umask (old_mask);
+    if (!listening)
+    {
+        PERR ("Can't listen on %s: %s", path, error->message);
+        std::cerr << bl::format (bl::translate ("Can't listen on {1}: {2}"))
+            % path % error->message << "\n";
+        g_error_free (error);
+        scm_cleanup_and_exit_with_failure (nullptr);
+    }
+    g_object_unref (address);
+    PINFO ("Serving %s on %s", state.uri.c_str(), path);
+
+    auto failures = 0;
+    while (!state.quit)
+    {
+        auto connection = g_socket_listener_accept (listener, nullptr, nullptr,
+                                                    &error);
+        if (!connection)
+        {
+            PERR ("Accepting a connection failed: %s", error->message);
+            g_clear_error (&error);
+            /* A lasting error (too many open files, the socket gone)
+             * mustn't turn into a busy loop. */
+            if (++failures == SERVE_MAX_ACCEPT_FAILURES)
+            {
+                std::cerr << bl::translate ("The server stopped after "
+                                            "repeated errors accepting "
+                                            "connections.") << "\n";
+                break;
+            }
+            g_usleep (MIN (G_USEC_PER_SEC / 10 << failures,
+                           SERVE_MAX_ACCEPT_BACKOFF));
+            continue;
+        }
+        failures = 0;
+        serve_connection (connection, state);
+        g_object_unref (connection);
+    }
+
+    g_socket_listener_close (listener);
+    g_object_unref (listener);
+    g_unlink (path);
+    gnc_clear_current_session ();
+    qof_event_resume ();
+    gnc_shutdown (failures ? 1 : 0);
+#else
+    std::cerr << bl::translate ("The server isn't available on this platform.") << "\n";
+    gnc_shutdown (1);
+#endif
+}
+
 int
 Gnucash::add_quotes (const bo_str& uri)
 {
@@ -350,17 +733,240 @@ Gnucash::add_quotes (const bo_str& uri)
     return 0;
 }
 
+static void
+report_session_error (QofSession *session, const char *uri)
+{
+    auto error{qof_session_get_error (session)};
+    if (error == ERR_BACKEND_NO_ERR)
+        return;
+    if (error == ERR_BACKEND_LOCKED)
+        PERR ("%s is locked, won't open.", uri);
+    else if (error == ERR_BACKEND_STORE_EXISTS)
+        PERR ("%s already exists, won't overwrite it.", uri);
+    else
+        PERR ("Session Error %d on %s: %s", error, uri,
+              qof_session_get_error_message (session));
+}
+
+int
+Gnucash::convert_book (const bo_str& file_to_load, const bo_str& target_uri)
+{
+    if (!file_to_load || file_to_load->empty () ||
+        !target_uri || target_uri->empty ())
+        return 1;
+
+    gnc_prefs_init ();
+    qof_event_suspend ();
+
+    auto source = qof_session_new (qof_book_new ());
+    qof_session_begin (source, file_to_load->c_str (), SESSION_READ_ONLY);
+    auto ok = (qof_session_get_error (source) == ERR_BACKEND_NO_ERR);
+    if (!ok)
+        report_session_error (source, file_to_load->c_str ());
+
+    auto target = qof_session_new (qof_book_new ());
+    if (ok)
+    {
+        qof_session_begin (target, target_uri->c_str (), SESSION_NEW_STORE);
+        ok = (qof_session_get_error (target) == ERR_BACKEND_NO_ERR);
+        if (!ok)
+            report_session_error (target, target_uri->c_str ());
+    }
+
+    if (ok)
+    {
+        PINFO ("Converting %s to %s...", file_to_load->c_str (),
+               target_uri->c_str ());
+        ok = qof_session_stream (source, target, report_session_percentage);
+        if (!ok)
+        {
+            report_session_error (source, file_to_load->c_str ());
+            report_session_error (target, target_uri->c_str ());
+        }
+    }
+
+    qof_session_destroy (target);
+    qof_session_destroy (source);
+    qof_event_resume ();
+
+    if (!ok)
+        std::cerr << bl::format (bl::translate ("Failed to convert {1} to {2}."))
+            % *file_to_load % *target_uri << "\n";
+    return ok ? 0 : 1;
+}
+
+int
+Gnucash::archive_book (const bo_str& file_to_load, const bo_str& archive_uri,
+                       const bo_str& before)
+{
+    if (!file_to_load || file_to_load->empty () ||
+        !archive_uri || archive_uri->empty () || !before)
+        return 1;
+
+    time64 before_time;
+    try
+    {
+        before_time = static_cast<time64>(GncDateTime (GncDate (*before, "y-m-d"),
+                                                       DayPart::start));
+    }
+    catch (const std::exception&)
+    {
+        std::cerr << bl::format (bl::translate ("{1} isn't a date like 2015-01-01."))
+            % *before << "\n";
+        return 1;
+    }
+
+    gnc_prefs_init ();
+    qof_event_suspend ();
+
+    auto session = gnc_get_current_session ();
+    qof_session_begin (session, file_to_load->c_str (), SESSION_NORMAL_OPEN);
+    auto ok = (qof_session_get_error (session) == ERR_BACKEND_NO_ERR);
+    if (ok)
+    {
+        qof_session_load (session, nullptr);
+        ok = (qof_session_get_error (session) == ERR_BACKEND_NO_ERR);
+    }
+    if (ok)
+    {
+        /* The transactions to move may still be in the database. */
+        qof_session_ensure_all_data_loaded (session);
+        ok = (qof_session_get_error (session) == ERR_BACKEND_NO_ERR);
+    }
+    if (!ok)
+        report_session_error (session, file_to_load->c_str ());
+
+    auto moved = -1;
+    if (ok)
+    {
+        PINFO ("Archiving %s before %s to %s...", file_to_load->c_str (),
+               before->c_str (), archive_uri->c_str ());
+        moved = gnc_book_archive_transactions (qof_session_get_book (session),
+                                               archive_uri->c_str (),
+                                               before_time);
+        ok = (moved >= 0);
+    }
+    if (ok)
+    {
+        qof_session_save (session, nullptr);
+        ok = (qof_session_get_error (session) == ERR_BACKEND_NO_ERR);
+        if (!ok)
+            report_session_error (session, file_to_load->c_str ());
+    }
+
+    gnc_clear_current_session ();
+    qof_event_resume ();
+
+    if (ok)
+        std::cout << bl::format (bl::translate ("Moved {1} transactions to {2}."))
+            % moved % *archive_uri << "\n";
+    else
+        std::cerr << bl::format (bl::translate ("Failed to archive {1} to {2}."))
+            % *file_to_load % *archive_uri << "\n";
+    return ok ? 0 : 1;
+}
+
+int
+Gnucash::export_csv (const bo_str& file_to_load, const bo_str& csv_file,
+                     const std::vector<std::string>& account_names,
+                     bool simple_layout)
+{
+    if (!file_to_load || file_to_load->empty () ||
+        !csv_file || csv_file->empty ())
+        return 1;
+
+    gnc_prefs_init ();
+    qof_event_suspend ();
+
+    /* The writer formats amounts for the current book. */
+    auto session = gnc_get_current_session ();
+    qof_session_begin (session, file_to_load->c_str (), SESSION_READ_ONLY);
+    auto ok = (qof_session_get_error (session) == ERR_BACKEND_NO_ERR);
+    if (ok)
+    {
+        qof_session_load (session, nullptr);
+        ok = (qof_session_get_error (session) == ERR_BACKEND_NO_ERR);
+    }
+    if (!ok)
+        report_session_error (session, file_to_load->c_str ());
+
+    GList *accounts = nullptr;
+    auto root = gnc_book_get_root_account (qof_session_get_book (session));
+    if (ok && account_names.empty ())
+        accounts = gnc_account_get_descendants_sorted (root);
+    for (auto it = account_names.rbegin (); ok && it != account_names.rend (); ++it)
+    {
+        auto acc = gnc_account_lookup_by_full_name (root, it->c_str ());
+        if (acc)
+            accounts = g_list_prepend (accounts, acc);
+        else
+        {
+            std::cerr << bl::format (bl::translate ("No account named {1}."))
+                % *it << "\n";
+            ok = false;
+        }
+    }
+
+    if (ok)
+    {
+        CsvTransactionsFormat format{",", FALSE, simple_layout};
+        PINFO ("Exporting %s to %s...", file_to_load->c_str (),
+               csv_file->c_str ());
+        ok = csv_transactions_write_accounts (csv_file->c_str (), accounts,
+                                              G_MININT64, G_MAXINT64, &format);
+        if (!ok)
+            std::cerr << bl::format (bl::translate ("Failed to write {1}."))
+                % *csv_file << "\n";
+    }
+
+    g_list_free (accounts);
+    gnc_clear_current_session ();
+    qof_event_resume ();
+    return ok ? 0 : 1;
+}
+
+int
+Gnucash::memory_report (const bo_str& file_to_load)
+{
+    if (!file_to_load || file_to_load->empty ())
+        return 1;
+
+    gnc_prefs_init ();
+    qof_event_suspend ();
+
+    auto session = gnc_get_current_session ();
+    qof_session_begin (session, file_to_load->c_str (), SESSION_READ_ONLY);
+    auto ok = (qof_session_get_error (session) == ERR_BACKEND_NO_ERR);
+    if (ok)
+    {
+        qof_session_load (session, nullptr);
+        ok = (qof_session_get_error (session) == ERR_BACKEND_NO_ERR);
+    }
+    if (ok)
+    {
+        auto report = qof_book_memory_report (qof_session_get_book (session));
+        std::cout << report;
+        g_free (report);
+    }
+    else
+        report_session_error (session, file_to_load->c_str ());
+
+    gnc_clear_current_session ();
+    qof_event_resume ();
+    return ok ? 0 : 1;
+}
+
 int
 Gnucash::run_report (const bo_str& file_to_load,
-                     const bo_str& run_report,
+                     const std::vector<std::string>& run_reports,
                      const bo_str& export_type,
-                     const bo_str& output_file)
+                     const std::vector<std::string>& output_files)
 {
     auto args = run_report_args { file_to_load ? *file_to_load : empty_string,
-                                  run_report ? *run_report : empty_string,
+                                  run_reports,
                                   export_type ? *export_type : empty_string,
-                                  output_file ? *output_file : empty_string };
-    if (run_report && !run_report->empty())
+                                  output_files };
+    if (!run_reports.empty())
         scm_boot_guile (0, nullptr, scm_run_report, &args);
 
     return 0;
@@ -384,3 +990,15 @@ Gnucash::report_list (void)
     scm_boot_guile (0, nullptr, scm_report_list, NULL);
     return 0;
 }
+
+int
+Gnucash::serve (const bo_str& file_to_load, const bo_str& socket_path)
+{
+    if (!file_to_load || file_to_load->empty () ||
+        !socket_path || socket_path->empty ())
+        return 1;
+
+    auto args = serve_args { *file_to_load, *socket_path };
+    scm_boot_guile (0, nullptr, scm_serve, &args);
+    return 0;
+}
@@ -26,6 +26,7 @@
 #define GNUCASH_COMMANDS_HPP
 
 #include <string>
+#include <vector>
 #include <boost/optional.hpp>
 
 using bo_str = boost::optional <std::string>;
@@ -33,11 +34,19 @@ using bo_str = boost::optional <std::string>;
 namespace Gnucash {
 
     int add_quotes (const bo_str& uri);
+    int archive_book (const bo_str& file_to_load, const bo_str& archive_uri,
+                      const bo_str& before);
+    int convert_book (const bo_str& file_to_load, const bo_str& target_uri);
+    int export_csv (const bo_str& file_to_load, const bo_str& csv_file,
+                    const std::vector<std::string>& account_names,
+                    bool simple_layout);
+    int memory_report (const bo_str& file_to_load);
     int run_report (const bo_str& file_to_load,
-                    const bo_str& run_report,
+                    const std::vector<std::string>& run_reports,
                     const bo_str& export_type,
-                    const bo_str& output_file);
+                    const std::vector<std::string>& output_files);
     int report_list (void);
+    int serve (const bo_str& file_to_load, const bo_str& socket_path);
     int report_show (const bo_str& file_to_load,
                      const bo_str& run_report);
 }
@@ -50,6 +50,7 @@ extern "C" {
 
 #include <boost/algorithm/string.hpp>
 #include <boost/locale.hpp>
+#include <cstdlib>
 #include <iostream>
 #include <string>
 #include <vector>
@@ -536,7 +537,9 @@ Gnucash::CoreApp::add_common_program_options (void)
         ("logto", bpo::value (&m_log_to_filename),
          _("File to log into; defaults to \"/tmp/gnucash.trace\"; can be \"stderr\" or \"stdout\"."))
         ("gsettings-prefix", bpo::value (&m_gsettings_prefix),
-         _("Set the prefix for gsettings schemas for gsettings queries. This can be useful to have a different settings tree while debugging."));
+         _("Set the prefix for gsettings schemas for gsettings queries. This can be useful to have a different settings tree while debugging."))
+        ("trace", bpo::value (&m_trace_to_filename),
+         _("Write a timeline of loading and saving, transaction commits, event handlers, register loads, account tree refreshes and report runs to this file as Chrome trace events, to open in chrome://tracing or ui.perfetto.dev. Also done when the GNC_TRACE environment variable names a file."));
 
     bpo::options_description hidden_options(_("Hidden Options"));
     hidden_options.add_options()
@@ -564,6 +567,12 @@ Gnucash::CoreApp::start (void)
         g_print("\n\n%s\n", userdata_migration_msg);
 
     gnc_log_init (m_log_flags, m_log_to_filename);
+
+    auto trace_file = m_trace_to_filename ? m_trace_to_filename->c_str () :
+        g_getenv ("GNC_TRACE");
+    if (trace_file && *trace_file && qof_trace_start (trace_file))
+        std::atexit ([]{ qof_trace_stop (); });
+
     gnc_engine_init (0, NULL);
 
     /* Write some locale details to the log to simplify debugging */
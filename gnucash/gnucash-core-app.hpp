@@ -65,6 +65,7 @@ private:
     bool m_debug = false;
     bool m_extra = false;
     boost::optional <std::string> m_gsettings_prefix;
+    boost::optional <std::string> m_trace_to_filename;
     std::vector <std::string> m_log_flags;
 
     char *sys_locale = nullptr;
@@ -0,0 +1,521 @@
+/*******************************************************************\
+ * csv-transactions-writer.c -- Write transactions to a CSV file    *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+\********************************************************************/
+/** @file csv-transactions-writer.c
+    @brief Write transactions to a CSV file without a user interface
+*/
+#include "config.h"
+
+#include <string.h>
+#include <glib/gi18n.h>
+#include <glib/gstdio.h>
+
+#include "gnc-commodity.h"
+#include "gnc-ui-util.h"
+#include "Query.h"
+#include "Transaction.h"
+#include "engine-helpers.h"
+#include "qofbookslots.h"
+
+#include "csv-transactions-writer.h"
+
+/* This static indicates the debugging module that this .o belongs to. */
+static QofLogModule log_module = G_LOG_DOMAIN;
+
+/* CSV spec requires CRLF line endings. Tweak the end-of-line string so this
+ * true for each platform */
+#ifdef G_OS_WIN32
+# define EOLSTR "\n"
+#else
+# define EOLSTR "\r\n"
+#endif
+
+/* The size of the buffer the file is written through */
+#define WRITE_BUFFER_SIZE (256 * 1024)
+
+typedef struct
+{
+    const CsvTransactionsFormat *format;
+    const gchar *end_sep;
+    gchar       *mid_sep;
+    FILE        *fh;
+    /* The line being built, reused for every line */
+    GString     *line;
+    /* The transactions already written */
+    GHashTable  *written;
+    gboolean     failed;
+} CsvWriter;
+
+
+/*******************************************************
+ * write_line
+ *
+ * write the line built so far to the file and start
+ * the next one
+ *******************************************************/
+static void
+write_line (CsvWriter *w)
+{
+    if (!w->failed &&
+        fwrite (w->line->str, 1, w->line->len, w->fh) != w->line->len)
+        w->failed = TRUE;
+    g_string_truncate (w->line, 0);
+}
+
+/*******************************************************
+ * append_field
+ *
+ * Append the field string, doubling any " in it, and
+ * quote it if it contains the separator, a new line
+ * or a " and the fields aren't all quoted anyway.
+ *******************************************************/
+static void
+append_field (CsvWriter *w, const gchar *string_in)
+{
+    const gchar *start, *quote;
+    gboolean need_quote;
+
+    if (!string_in)
+        string_in = "";
+
+    need_quote = (!w->format->use_quotes &&
+                  (strstr (string_in, w->format->separator) ||
+                   strchr (string_in, '\n') || strchr (string_in, '"')));
+
+    if (need_quote)
+        g_string_append_c (w->line, '"');
+    for (start = string_in; (quote = strchr (start, '"')); start = quote + 1)
+    {
+        g_string_append_len (w->line, start, quote - start + 1);
+        g_string_append_c (w->line, '"');
+    }
+    g_string_append (w->line, start);
+    if (need_quote)
+        g_string_append_c (w->line, '"');
+}
+
+/* Append a field and the separator after it */
+static void
+add_field (CsvWriter *w, const gchar *string_in)
+{
+    append_field (w, string_in);
+    g_string_append (w->line, w->mid_sep);
+}
+
+/* Append the last field and end the line */
+static void
+add_last_field (CsvWriter *w, const gchar *string_in)
+{
+    append_field (w, string_in);
+    g_string_append (w->line, w->end_sep);
+    g_string_append (w->line, EOLSTR);
+}
+
+/******************** Helper functions *********************/
+
+// Transaction Date
+static void
+add_date (CsvWriter *w, Transaction *trans)
+{
+    char date[MAX_DATE_LENGTH + 1];
+    memset (date, 0, sizeof(date));
+    qof_print_date_buff (date, MAX_DATE_LENGTH, xaccTransGetDate (trans));
+    g_string_append (w->line, w->end_sep);
+    g_string_append (w->line, date);
+    g_string_append (w->line, w->mid_sep);
+}
+
+// Transaction GUID
+static void
+add_guid (CsvWriter *w, Transaction *trans)
+{
+    char guid[GUID_ENCODING_LENGTH + 1];
+    guid_to_string_buff (xaccTransGetGUID (trans), guid);
+    g_string_append (w->line, guid);
+    g_string_append (w->line, w->mid_sep);
+}
+
+// Reconcile Date
+static void
+add_reconcile_date (CsvWriter *w, Split *split)
+{
+    if (xaccSplitGetReconcile (split) == YREC)
+    {
+        time64 t = xaccSplitGetDateReconciled (split);
+        char str_rec_date[MAX_DATE_LENGTH + 1];
+        memset (str_rec_date, 0, sizeof(str_rec_date));
+        qof_print_date_buff (str_rec_date, MAX_DATE_LENGTH, t);
+        g_string_append (w->line, str_rec_date);
+    }
+    g_string_append (w->line, w->mid_sep);
+}
+
+// Account Name short or Long
+static void
+add_account_name (CsvWriter *w, Split *split, gboolean full)
+{
+    Account *account = xaccSplitGetAccount (split);
+    if (full)
+    {
+        gchar *name = gnc_account_get_full_name (account);
+        add_field (w, name);
+        g_free (name);
+    }
+    else
+        add_field (w, xaccAccountGetName (account));
+}
+
+// Void reason
+static void
+add_void_reason (CsvWriter *w, Transaction *trans)
+{
+    if (xaccTransGetVoidStatus (trans))
+        add_field (w, xaccTransGetVoidReason (trans));
+    else
+        g_string_append (w->line, w->mid_sep);
+}
+
+// Full Category Path or Not
+static void
+add_category (CsvWriter *w, Split *split, gboolean full)
+{
+    if (full)
+    {
+        gchar *cat = xaccSplitGetCorrAccountFullName (split);
+        add_field (w, cat);
+        g_free (cat);
+    }
+    else
+        add_field (w, xaccSplitGetCorrAccountName (split));
+}
+
+// Amount with Symbol or not
+static void
+add_amount (CsvWriter *w, Split *split, gboolean t_void, gboolean symbol)
+{
+    gnc_numeric amount = t_void ? xaccSplitVoidFormerAmount (split)
+                                : xaccSplitGetAmount (split);
+    add_field (w, xaccPrintAmount (amount,
+                                   gnc_split_amount_print_info (split, symbol)));
+}
+
+// Share Price / Conversion factor
+static void
+add_rate (CsvWriter *w, Split *split, gboolean t_void)
+{
+    gnc_commodity *curr = xaccAccountGetCommodity (xaccSplitGetAccount (split));
+    gnc_numeric rate = t_void ? gnc_numeric_zero () : xaccSplitGetSharePrice (split);
+    add_last_field (w, xaccPrintAmount (rate, gnc_default_price_print_info (curr)));
+}
+
+// Share Price / Conversion factor
+static void
+add_price (CsvWriter *w, Split *split, gboolean t_void)
+{
+    gnc_commodity *curr = xaccAccountGetCommodity (xaccSplitGetAccount (split));
+    gnc_numeric price;
+
+    if (t_void)
+        price = gnc_numeric_div (xaccSplitVoidFormerValue (split), xaccSplitVoidFormerAmount (split), GNC_DENOM_AUTO,
+                                 GNC_HOW_DENOM_SIGFIGS(6) | GNC_HOW_RND_ROUND_HALF_UP);
+    else
+        price = xaccSplitGetSharePrice (split);
+
+    add_last_field (w, xaccPrintAmount (price, gnc_default_price_print_info (curr)));
+}
+
+/******************************************************************************/
+
+static void
+make_simple_trans_line (CsvWriter *w, Transaction *trans, Split *split)
+{
+    gboolean t_void = xaccTransGetVoidStatus (trans);
+
+    add_date (w, trans);
+    add_account_name (w, split, TRUE);
+    add_field (w, xaccTransGetNum (trans));
+    add_field (w, xaccTransGetDescription (trans));
+    add_category (w, split, TRUE);
+    add_field (w, gnc_get_reconcile_str (xaccSplitGetReconcile (split)));
+    add_amount (w, split, t_void, TRUE);
+    add_amount (w, split, t_void, FALSE);
+    add_rate (w, split, t_void);
+}
+
+static void
+make_split_part (CsvWriter *w, Split *split, gboolean t_void)
+{
+    add_field (w, xaccSplitGetAction (split));
+    add_field (w, xaccSplitGetMemo (split));
+    add_account_name (w, split, TRUE);
+    add_account_name (w, split, FALSE);
+    add_amount (w, split, t_void, TRUE);
+    add_amount (w, split, t_void, FALSE);
+    add_field (w, gnc_get_reconcile_str (xaccSplitGetReconcile (split)));
+    add_reconcile_date (w, split);
+    add_price (w, split, t_void);
+}
+
+static void
+make_complex_trans_line (CsvWriter *w, Transaction *trans, Split *split)
+{
+    add_date (w, trans);
+    add_guid (w, trans);
+    add_field (w, xaccTransGetNum (trans));
+    add_field (w, xaccTransGetDescription (trans));
+    add_field (w, xaccTransGetNotes (trans));
+    add_field (w, gnc_commodity_get_unique_name (xaccTransGetCurrency (trans)));
+    add_void_reason (w, trans);
+    make_split_part (w, split, xaccTransGetVoidStatus (trans));
+}
+
+static void
+make_complex_split_line (CsvWriter *w, Transaction *trans, Split *split)
+{
+    /* Pure split lines don't have any transaction information,
+     * so start with empty fields for all transaction columns.
+     */
+    g_string_append (w->line, w->end_sep);
+    for (int i = 0; i < 7; i++)
+        g_string_append (w->line, w->mid_sep);
+    make_split_part (w, split, xaccTransGetVoidStatus (trans));
+}
+
+static void
+write_header (CsvWriter *w)
+{
+    gboolean num_action = qof_book_use_split_action_for_num_field (gnc_get_current_book());
+    const gchar *simple_cols[] =
+    {
+        /* Translators: The following symbols will build the *
+         * header line of exported CSV files:                */
+        _("Date"), _("Account Name"),
+        (num_action ? _("Transaction Number") : _("Number")),
+        _("Description"), _("Full Category Path"), _("Reconcile"),
+        _("Amount With Sym"), _("Amount Num."), _("Rate/Price"), NULL
+    };
+    const gchar *complex_cols[] =
+    {
+        _("Date"), _("Transaction ID"),
+        (num_action ? _("Transaction Number") : _("Number")),
+        _("Description"), _("Notes"), _("Commodity/Currency"), _("Void Reason"),
+        (num_action ? _("Number/Action") : _("Action")), _("Memo"),
+        _("Full Account Name"), _("Account Name"),
+        _("Amount With Sym"), _("Amount Num."),
+        _("Reconcile"), _("Reconcile Date"), _("Rate/Price"), NULL
+    };
+    const gchar **cols = w->format->simple_layout ? simple_cols : complex_cols;
+
+    g_string_append (w->line, w->end_sep);
+    for (int i = 0; cols[i]; i++)
+    {
+        if (i)
+            g_string_append (w->line, w->mid_sep);
+        g_string_append (w->line, cols[i]);
+    }
+    g_string_append (w->line, w->end_sep);
+    g_string_append (w->line, EOLSTR);
+    DEBUG("Header String: %s", w->line->str);
+    write_line (w);
+}
+
+/*******************************************************
+ * write_splits
+ *
+ * write the transactions of a list of splits, skipping
+ * those already written
+ *******************************************************/
+static void
+write_splits (CsvWriter *w, GList *splits)
+{
+    for (GList *node = splits; node && !w->failed; node = node->next)
+    {
+        Split       *split = node->data;
+        Transaction *trans = xaccSplitGetParent (split);
+
+        // Look for trans already exported
+        if (g_hash_table_contains (w->written, trans))
+            continue;
+
+        // Look for blank split
+        if (xaccSplitGetAccount (split) == NULL)
+            continue;
+
+        // This will be a simple layout equivalent to a single line register view.
+        if (w->format->simple_layout)
+        {
+            make_simple_trans_line (w, trans, split);
+            write_line (w);
+            continue;
+        }
+
+        // Complex Transaction Line.
+        make_complex_trans_line (w, trans, split);
+        write_line (w);
+
+        /* Loop through the list of splits for the Transaction */
+        for (GList *s_node = xaccTransGetSplitList (trans);
+             s_node && !w->failed; s_node = s_node->next)
+        {
+            // base split is already written on the trans_line
+            if (s_node->data == split)
+                continue;
+
+            // Complex Split Line.
+            make_complex_split_line (w, trans, s_node->data);
+            write_line (w);
+        }
+        g_hash_table_add (w->written, trans);
+    }
+}
+
+static gboolean
+writer_open (CsvWriter *w, const gchar *file_name,
+             const CsvTransactionsFormat *format)
+{
+    memset (w, 0, sizeof (CsvWriter));
+    w->format = format;
+
+    /* Set up separators */
+    if (format->use_quotes)
+    {
+        w->end_sep = "\"";
+        w->mid_sep = g_strconcat ("\"", format->separator, "\"", NULL);
+    }
+    else
+    {
+        w->end_sep = "";
+        w->mid_sep = g_strdup (format->separator);
+    }
+
+    DEBUG("File name is : %s", file_name);
+    w->fh = g_fopen (file_name, "w");
+    if (!w->fh)
+    {
+        g_free (w->mid_sep);
+        return FALSE;
+    }
+    setvbuf (w->fh, NULL, _IOFBF, WRITE_BUFFER_SIZE);
+
+    w->line = g_string_sized_new (1024);
+    w->written = g_hash_table_new (g_direct_hash, g_direct_equal);
+    write_header (w);
+    return TRUE;
+}
+
+static gboolean
+writer_close (CsvWriter *w)
+{
+    if (fclose (w->fh) != 0)
+        w->failed = TRUE;
+    g_hash_table_destroy (w->written);
+    g_string_free (w->line, TRUE);
+    g_free (w->mid_sep);
+    return !w->failed;
+}
+
+gboolean
+csv_transactions_write_accounts (const gchar *file_name, GList *accounts,
+                                 time64 start_time, time64 end_time,
+                                 const CsvTransactionsFormat *format)
+{
+    CsvWriter w;
+    Query *query;
+    GSList *p1, *p2;
+    GHashTable *by_account;
+
+    g_return_val_if_fail (file_name && format, FALSE);
+
+    ENTER("");
+    if (!writer_open (&w, file_name, format))
+    {
+        LEAVE("couldn't open %s", file_name);
+        return FALSE;
+    }
+
+    if (!accounts)
+    {
+        LEAVE("no accounts");
+        return writer_close (&w);
+    }
+
+    /* One query for all the accounts */
+    query = qof_query_create_for (GNC_ID_SPLIT);
+    qof_query_set_book (query, gnc_get_current_book());
+
+    /* Sort by transaction date */
+    p1 = g_slist_prepend (NULL, TRANS_DATE_POSTED);
+    p1 = g_slist_prepend (p1, SPLIT_TRANS);
+    p2 = g_slist_prepend (NULL, QUERY_DEFAULT_SORT);
+    qof_query_set_sort_order (query, p1, p2, NULL);
+
+    xaccQueryAddAccountMatch (query, accounts, QOF_GUID_MATCH_ANY, QOF_QUERY_AND);
+    xaccQueryAddDateMatchTT (query, TRUE, start_time, TRUE, end_time, QOF_QUERY_AND);
+
+    /* Split the sorted result by account, so that each account's splits
+     * still come out together and in date order. */
+    by_account = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL,
+                                        (GDestroyNotify)g_list_free);
+    for (GList *node = qof_query_run (query); node; node = node->next)
+    {
+        Account *acc = xaccSplitGetAccount (node->data);
+        GList *splits = g_hash_table_lookup (by_account, acc);
+        g_hash_table_steal (by_account, acc);
+        g_hash_table_insert (by_account, acc, g_list_prepend (splits, node->data));
+    }
+
+    /* Go through list of accounts */
+    for (GList *ptr = accounts; ptr && !w.failed; ptr = g_list_next (ptr))
+    {
+        Account *acc = ptr->data;
+        GList *splits = g_hash_table_lookup (by_account, acc);
+        DEBUG("Account being processed is : %s", xaccAccountGetName (acc));
+        if (!splits)
+            continue;
+        g_hash_table_steal (by_account, acc);
+        splits = g_list_reverse (splits);
+        write_splits (&w, splits);
+        g_list_free (splits);
+    }
+    g_hash_table_destroy (by_account);
+    qof_query_destroy (query);
+
+    LEAVE("");
+    return writer_close (&w);
+}
+
+gboolean
+csv_transactions_write_query (const gchar *file_name, Query *query,
+                              const CsvTransactionsFormat *format)
+{
+    CsvWriter w;
+
+    g_return_val_if_fail (file_name && query && format, FALSE);
+
+    ENTER("");
+    if (!writer_open (&w, file_name, format))
+    {
+        LEAVE("couldn't open %s", file_name);
+        return FALSE;
+    }
+    write_splits (&w, qof_query_run (query));
+    LEAVE("");
+    return writer_close (&w);
+}
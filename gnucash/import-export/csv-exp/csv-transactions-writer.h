@@ -0,0 +1,82 @@
+/*******************************************************************\
+ * csv-transactions-writer.h -- Write transactions to a CSV file    *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+\********************************************************************/
+/** @file csv-transactions-writer.h
+    @brief Write transactions to a CSV file without a user interface
+
+    This is the part of the CSV transaction export that doesn't need
+    GTK, so that gnucash-cli can run it as well as the export assistant.
+    Every row is built in one reused buffer and written through a large
+    stdio buffer, so a big export is limited by the disk rather than by
+    memory allocation.
+*/
+
+#ifndef CSV_TRANSACTIONS_WRITER_H
+#define CSV_TRANSACTIONS_WRITER_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <glib.h>
+#include "Account.h"
+#include "Query.h"
+
+/** How the rows of the file are laid out. */
+typedef struct
+{
+    /** The text between two fields. */
+    const gchar *separator;
+    /** Put every field in double quotes, rather than only those that
+     *  need them. */
+    gboolean     use_quotes;
+    /** One line per split in the exported accounts, like a basic ledger,
+     *  rather than a line per transaction followed by one per split. */
+    gboolean     simple_layout;
+} CsvTransactionsFormat;
+
+/** Write the transactions with a split in any of accounts that were
+ *  posted between start_time and end_time to file_name.  The splits are
+ *  found with a single query.  They are written grouped by account in
+ *  the order of the list, and by date within each account.  A
+ *  transaction touching several of the accounts is only written once.
+ *
+ *  @return FALSE if the file couldn't be written.
+ */
+gboolean csv_transactions_write_accounts (const gchar *file_name,
+                                          GList *accounts,
+                                          time64 start_time, time64 end_time,
+                                          const CsvTransactionsFormat *format);
+
+/** Write the transactions of the splits found by query, in its order,
+ *  to file_name, as for exporting what a register shows.  The query
+ *  belongs to the caller.
+ *
+ *  @return FALSE if the file couldn't be written.
+ */
+gboolean csv_transactions_write_query (const gchar *file_name, Query *query,
+                                       const CsvTransactionsFormat *format);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
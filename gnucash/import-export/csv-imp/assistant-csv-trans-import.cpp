@@ -189,6 +189,7 @@ public:
     void preview_handle_save_del_sensitivity (GtkComboBox* combo);
     void preview_split_column (int col, int offset);
     void preview_refresh_table ();
+    void preview_refresh_line_states ();
     void preview_refresh ();
     void preview_validate_settings ();
 
@@ -211,6 +212,8 @@ private:
     GtkWidget* preview_cbox_factory (GtkTreeModel* model, uint32_t colnum);
     /* helper function to set rendering parameters for preview data columns */
     void preview_style_column (uint32_t col_num, GtkTreeModel* model);
+    /* helper function to bring the column headers and base account in line with the importer */
+    void preview_refresh_headers ();
     /* helper function to check for a valid filename as opposed to a directory */
     bool check_for_valid_filename ();
 
@@ -963,7 +966,7 @@ void CsvImpTransAssist::preview_update_skipped_rows ()
     gtk_adjustment_set_upper (adj, tx_imp->m_parsed_lines.size()
             - tx_imp->skip_end_lines() - 1);
 
-    preview_refresh_table ();
+    preview_refresh_line_states ();
 }
 
 void CsvImpTransAssist::preview_multi_split (bool multi)
@@ -1086,7 +1089,7 @@ void CsvImpTransAssist::preview_update_account ()
 {;
     auto acct = gnc_account_sel_get_account( GNC_ACCOUNT_SEL(acct_selector) );
     tx_imp->base_account(acct);
-    preview_refresh_table ();
+    preview_refresh_line_states ();
 }
 
 
@@ -1128,7 +1131,7 @@ void
 CsvImpTransAssist::preview_update_date_format ()
 {
     tx_imp->date_format (gtk_combo_box_get_active (GTK_COMBO_BOX(date_format_combo)));
-    preview_refresh_table ();
+    preview_refresh_line_states ();
 }
 
 
@@ -1136,7 +1139,7 @@ void
 CsvImpTransAssist::preview_update_currency_format ()
 {
     tx_imp->currency_format (gtk_combo_box_get_active (GTK_COMBO_BOX(currency_format_combo)));
-    preview_refresh_table ();
+    preview_refresh_line_states ();
 }
 
 static gboolean
@@ -1146,6 +1149,13 @@ csv_imp_preview_queue_rebuild_table (CsvImpTransAssist *assist)
     return false;
 }
 
+static gboolean
+csv_imp_preview_queue_refresh_line_states (CsvImpTransAssist *assist)
+{
+    assist->preview_refresh_line_states ();
+    return false;
+}
+
 /* Internally used enum to access the columns in the comboboxes
  * the user can click to set a type for each column of the data
  */
@@ -1179,10 +1189,12 @@ void CsvImpTransAssist::preview_update_col_type (GtkComboBox* cbox)
     auto col_num = GPOINTER_TO_UINT (g_object_get_data (G_OBJECT(cbox), "col-num"));
     tx_imp->set_column_type (col_num, new_col_type);
 
-    /* Delay rebuilding our data table to avoid critical warnings due to
+    /* Delay updating our data table to avoid critical warnings due to
      * pending events still acting on them after this event is processed.
+     * The cell data didn't change, so only the row states and column
+     * headers need refreshing.
      */
-    g_idle_add ((GSourceFunc)csv_imp_preview_queue_rebuild_table, this);
+    g_idle_add ((GSourceFunc)csv_imp_preview_queue_refresh_line_states, this);
 
 }
 
@@ -1598,13 +1610,25 @@ void CsvImpTransAssist::preview_refresh_table ()
         ntcols = gtk_tree_view_append_column (treeview, col);
     }
 
+    /* Release our reference for the store to allow proper memory management. */
+    g_object_unref (store);
+
     /* Reset column attributes as they are undefined after recreating the model */
+    preview_refresh_headers ();
+}
+
+/* Restyles the preview columns, which also updates the column type
+ * comboboxes in their headers, and syncs the base account selector.
+ */
+void CsvImpTransAssist::preview_refresh_headers ()
+{
+    auto columns = gtk_tree_view_get_columns (treeview);
+    auto ntcols = g_list_length(columns);
+    g_list_free (columns);
+
     auto combostore = make_column_header_model (tx_imp->multi_split());
     for (uint32_t i = 0; i < ntcols; i++)
         preview_style_column (i, combostore);
-
-    /* Release our reference for the stores to allow proper memory management. */
-    g_object_unref (store);
     g_object_unref (combostore);
 
     /* Also reset the base account combo box as it's value may have changed due to column changes here */
@@ -1621,6 +1645,56 @@ void CsvImpTransAssist::preview_refresh_table ()
     gtk_widget_show_all (GTK_WIDGET(treeview));
 }
 
+/* Updates the error and skip decorations of the preview table after a change
+ * that can't have altered the cell data, such as a new column type or date
+ * format.  Only the rows whose state changed are touched, which keeps this
+ * quick on large files.  If the table doesn't match the parsed data, it is
+ * rebuilt instead.
+ */
+void CsvImpTransAssist::preview_refresh_line_states ()
+{
+    auto model = gtk_tree_view_get_model (treeview);
+    auto ncols = PREV_N_FIXED_COLS + tx_imp->column_types().size();
+    if (!model || !GTK_IS_LIST_STORE(model) ||
+        static_cast<size_t>(gtk_tree_model_get_n_columns (model)) != ncols ||
+        static_cast<size_t>(gtk_tree_model_iter_n_children (model, nullptr)) !=
+            tx_imp->m_parsed_lines.size())
+    {
+        preview_refresh_table ();
+        return;
+    }
+
+    preview_validate_settings ();
+
+    auto store = GTK_LIST_STORE(model);
+    GtkTreeIter iter;
+    auto valid = gtk_tree_model_get_iter_first (model, &iter);
+    for (auto& parse_line : tx_imp->m_parsed_lines)
+    {
+        if (!valid)
+            break;
+
+        auto& err_msg = std::get<PL_ERROR>(parse_line);
+        auto skip = std::get<PL_SKIP>(parse_line);
+        gchar *shown_err = nullptr;
+        gboolean shown_skip = false;
+        gtk_tree_model_get (model, &iter,
+                PREV_COL_ERROR, &shown_err,
+                PREV_COL_STRIKE, &shown_skip, -1);
+
+        /* Skipped lines show no error, see preview_row_fill_state_cells */
+        auto want_err = (skip || err_msg.empty()) ? nullptr : err_msg.c_str();
+        if (static_cast<bool>(shown_skip) != skip ||
+            g_strcmp0 (shown_err, want_err) != 0)
+            preview_row_fill_state_cells (store, &iter, err_msg, skip);
+        g_free (shown_err);
+
+        valid = gtk_tree_model_iter_next (model, &iter);
+    }
+
+    preview_refresh_headers ();
+}
+
 /* Update the preview page based on the current state of the importer.
  * Should be called when settings are changed.
  */
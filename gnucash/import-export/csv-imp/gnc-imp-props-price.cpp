@@ -286,7 +286,14 @@ std::string GncImportPrice::verify_essentials (void)
         return std::string();
 }
 
-Result GncImportPrice::create_price (QofBook* book, GNCPriceDB *pdb, bool over)
+time64 GncImportPrice::get_time ()
+{
+    if (!m_date)
+        return INT64_MAX;
+    return static_cast<time64>(GncDateTime(*m_date, DayPart::neutral));
+}
+
+GNCPrice* GncImportPrice::make_price (QofBook* book)
 {
     /* Gently refuse to create the price if the basics are not set correctly
      * This should have been tested before calling this function though!
@@ -295,16 +302,53 @@ Result GncImportPrice::create_price (QofBook* book, GNCPriceDB *pdb, bool over)
     if (!check.empty())
     {
         PWARN ("Refusing to create price because essentials not set properly: %s", check.c_str());
-        return FAILED;
+        return nullptr;
     }
 
-    auto date = static_cast<time64>(GncDateTime(*m_date, DayPart::neutral));
-
+    auto date = get_time();
     auto amount = *m_amount;
+
+    char date_str [MAX_DATE_LENGTH + 1];
+    memset (date_str, 0, sizeof(date_str));
+    qof_print_date_buff (date_str, MAX_DATE_LENGTH, date);
+    DEBUG("Date is %s, Commodity from is '%s', Currency is '%s', "
+          "Amount is %s", date_str,
+          gnc_commodity_get_fullname (*m_from_commodity),
+          gnc_commodity_get_fullname (*m_to_currency),
+          amount.to_string().c_str());
+
+    GNCPrice *price = gnc_price_create (book);
+    gnc_price_begin_edit (price);
+
+    gnc_price_set_commodity (price, *m_from_commodity);
+    gnc_price_set_currency (price, *m_to_currency);
+
+    int scu = gnc_commodity_get_fraction (*m_to_currency);
+    auto amount_conv = amount.convert<RoundType::half_up>(scu * COMMODITY_DENOM_MULT);
+
+    gnc_price_set_value (price, static_cast<gnc_numeric>(amount_conv));
+
+    gnc_price_set_time64 (price, date);
+    gnc_price_set_source (price, PRICE_SOURCE_USER_PRICE);
+    gnc_price_set_typestr (price, PRICE_TYPE_LAST);
+    gnc_price_commit_edit (price);
+
+    return price;
+}
+
+Result GncImportPrice::create_price (QofBook* book, GNCPriceDB *pdb, bool over)
+{
+    auto check = verify_essentials();
+    if (!check.empty())
+    {
+        PWARN ("Refusing to create price because essentials not set properly: %s", check.c_str());
+        return FAILED;
+    }
+
     Result ret_val = ADDED;
 
     GNCPrice *old_price = gnc_pricedb_lookup_day_t64 (pdb, *m_from_commodity,
-                                                      *m_to_currency, date);
+                                                      *m_to_currency, get_time());
 
     // Should old price be over written
     if ((old_price != nullptr) && (over == true))
@@ -316,33 +360,11 @@ Result GncImportPrice::create_price (QofBook* book, GNCPriceDB *pdb, bool over)
         ret_val = REPLACED;
     }
 
-    char date_str [MAX_DATE_LENGTH + 1];
-    memset (date_str, 0, sizeof(date_str));
-    qof_print_date_buff (date_str, MAX_DATE_LENGTH, date);
-    DEBUG("Date is %s, Commodity from is '%s', Currency is '%s', "
-          "Amount is %s", date_str,
-          gnc_commodity_get_fullname (*m_from_commodity),
-          gnc_commodity_get_fullname (*m_to_currency),
-          amount.to_string().c_str());
     // Create the new price
     if (old_price == nullptr)
     {
         DEBUG("Create");
-        GNCPrice *price = gnc_price_create (book);
-        gnc_price_begin_edit (price);
-
-        gnc_price_set_commodity (price, *m_from_commodity);
-        gnc_price_set_currency (price, *m_to_currency);
-
-        int scu = gnc_commodity_get_fraction (*m_to_currency);
-        auto amount_conv = amount.convert<RoundType::half_up>(scu * COMMODITY_DENOM_MULT);
-
-        gnc_price_set_value (price, static_cast<gnc_numeric>(amount_conv));
-
-        gnc_price_set_time64 (price, date);
-        gnc_price_set_source (price, PRICE_SOURCE_USER_PRICE);
-        gnc_price_set_typestr (price, PRICE_TYPE_LAST);
-        gnc_price_commit_edit (price);
+        GNCPrice *price = make_price (book);
 
         bool perr = gnc_pricedb_add_price (pdb, price);
 
@@ -93,7 +93,14 @@ public:
     void set_currency_format (int currency_format) { m_currency_format = currency_format ;}
     void reset (GncPricePropType prop_type);
     std::string verify_essentials (void);
+    /** Add this price to pdb on its own, checking pdb for a price on the
+     *  same day first. */
     Result create_price (QofBook* book, GNCPriceDB *pdb, bool over);
+    /** Create the price without adding it to a pricedb. The caller owns the
+     *  returned reference; nullptr if the essentials aren't set. */
+    GNCPrice* make_price (QofBook* book);
+    /** The time the price will be recorded at, INT64_MAX without a date. */
+    time64 get_time ();
 
     gnc_commodity* get_from_commodity () { if (m_from_commodity) return *m_from_commodity; else return nullptr; }
     void set_from_commodity (gnc_commodity* comm) { if (comm) m_from_commodity = comm; else m_from_commodity = boost::none; }
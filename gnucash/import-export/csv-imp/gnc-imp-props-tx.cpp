@@ -112,11 +112,13 @@ GncNumeric parse_amount (const std::string &str, int currency_format)
     if (str.empty())
         return GncNumeric{};
 
-    /* Strings otherwise containing not digits will be considered invalid */
-    if(!boost::regex_search(str, boost::regex("[0-9]")))
+    /* Strings otherwise containing not digits will be considered invalid.
+     * The regexes are compiled once; using them is safe from any thread. */
+    static const boost::regex digit ("[0-9]");
+    if(!boost::regex_search(str, digit))
         throw std::invalid_argument (_("Value doesn't appear to contain a valid number."));
 
-    auto expr = boost::make_u32regex("[[:Sc:]]");
+    static const auto expr = boost::make_u32regex("[[:Sc:]]");
     std::string str_no_symbols = boost::u32regex_replace(str, expr, "");
 
     /* Convert based on user chosen currency format */
@@ -206,11 +208,13 @@ static GncNumeric parse_price (const std::string &str)
     if (str.empty())
         return GncNumeric{};
 
-    /* Strings otherwise containing not digits will be considered invalid */
-    if(!boost::regex_search(str, boost::regex("[0-9]")))
+    /* Strings otherwise containing not digits will be considered invalid.
+     * The regexes are compiled once; using them is safe from any thread. */
+    static const boost::regex digit ("[0-9]");
+    if(!boost::regex_search(str, digit))
         throw std::invalid_argument (_("Value doesn't appear to contain a valid number."));
 
-    auto expr = boost::make_u32regex("[[:Sc:]]");
+    static const auto expr = boost::make_u32regex("[[:Sc:]]");
     std::string str_no_symbols = boost::u32regex_replace(str, expr, "");
 
     /* Convert based on user chosen currency format */
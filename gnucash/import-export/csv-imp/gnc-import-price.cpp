@@ -36,8 +36,10 @@ extern "C" {
 }
 
 #include <algorithm>
+#include <cstdlib>
 #include <exception>
 #include <iostream>
+#include <map>
 #include <memory>
 #include <string>
 #include <tuple>
@@ -554,7 +556,8 @@ static void price_properties_verify_essentials (std::vector<parse_line_t>::itera
         throw std::invalid_argument(error_message);
 }
 
-void GncPriceImport::create_price (std::vector<parse_line_t>::iterator& parsed_line)
+std::shared_ptr<GncImportPrice>
+GncPriceImport::complete_price_props (std::vector<parse_line_t>::iterator& parsed_line)
 {
     StrVec line;
     std::string error_message;
@@ -563,7 +566,7 @@ void GncPriceImport::create_price (std::vector<parse_line_t>::iterator& parsed_l
     std::tie(line, error_message, price_props, skip_line) = *parsed_line;
 
     if (skip_line)
-        return;
+        return nullptr;
 
     error_message.clear();
 
@@ -601,34 +604,97 @@ void GncPriceImport::create_price (std::vector<parse_line_t>::iterator& parsed_l
         }
     }
 
-    /* If column parsing was successful, convert price properties into a price. */
     try
     {
         price_properties_verify_essentials (parsed_line);
-
-        QofBook* book = gnc_get_current_book();
-        GNCPriceDB *pdb = gnc_pricedb_get_db (book);
-
-        /* If all went well, add this price to the list. */
-        auto price_created = price_props->create_price (book, pdb, m_over_write);
-        if (price_created == ADDED)
-            m_prices_added++;
-        else if (price_created == DUPLICATED)
-            m_prices_duplicated++;
-        else if (price_created == REPLACED)
-            m_prices_replaced++;
     }
     catch (const std::invalid_argument& e)
     {
         error_message = e.what();
         PINFO("User warning: %s", error_message.c_str());
+        return nullptr;
+    }
+    return price_props;
+}
+
+namespace
+{
+using PricePtr = std::unique_ptr<GNCPrice, decltype(&gnc_price_unref)>;
+
+/* The prices of one commodity pair by day, both those already in the
+ * pricedb, in either direction as gnc_pricedb_lookup_day_t64 finds them,
+ * and those this import will add. */
+struct PriceSnapshot
+{
+    struct Entry
+    {
+        time64 time;
+        GNCPrice* price;
+        /* Position in the import's list of new prices, or -1 for a price
+         * that was there before. */
+        int pending;
+    };
+
+    PriceSnapshot (GNCPriceDB* pdb, gnc_commodity* from, gnc_commodity* to)
+    {
+        m_lists[0] = gnc_pricedb_get_prices (pdb, from, to);
+        m_lists[1] = gnc_pricedb_get_prices (pdb, to, from);
+        for (auto list : m_lists)
+            for (auto node = list; node; node = node->next)
+            {
+                auto price = static_cast<GNCPrice*>(node->data);
+                add (gnc_price_get_time64 (price), price, -1);
+            }
+    }
+    ~PriceSnapshot ()
+    {
+        for (auto list : m_lists)
+            gnc_price_list_destroy (list);
+    }
+    PriceSnapshot (const PriceSnapshot&) = delete;
+    PriceSnapshot& operator= (const PriceSnapshot&) = delete;
+
+    void add (time64 time, GNCPrice* price, int pending)
+    {
+        m_by_day.emplace (time64CanonicalDayTime (time), Entry{time, price, pending});
+    }
+
+    /* The price nearest to time on the same day, preferring the older one
+     * of two as near, like lookup_nearest_in_time. */
+    std::multimap<time64, Entry>::iterator find_same_day (time64 time)
+    {
+        auto range = m_by_day.equal_range (time64CanonicalDayTime (time));
+        auto best = m_by_day.end();
+        for (auto it = range.first; it != range.second; ++it)
+        {
+            if (best == m_by_day.end())
+            {
+                best = it;
+                continue;
+            }
+            auto diff = std::llabs (it->second.time - time);
+            auto best_diff = std::llabs (best->second.time - time);
+            if (diff < best_diff ||
+                (diff == best_diff && it->second.time < best->second.time))
+                best = it;
+        }
+        return best;
     }
+
+    std::multimap<time64, Entry> m_by_day;
+    PriceList* m_lists[2];
+};
 }
 
 /** Creates a list of prices from parsed data. The parsed data
  * will first be validated. If any errors are found in lines that are marked
  * for processing (ie not marked to skip) this function will
  * throw an error.
+ *
+ * Rather than looking up and adding every price on its own, the existing
+ * prices of each commodity pair are fetched once and checked for same-day
+ * duplicates in memory. The new prices are then added to the pricedb with a
+ * single gnc_pricedb_add_prices call.
  * @param skip_errors true skip over lines with errors
  * @exception throws std::invalid_argument if data validation or processing fails.
  */
@@ -643,6 +709,14 @@ void GncPriceImport::create_prices ()
     m_prices_duplicated = 0;
     m_prices_replaced = 0;
 
+    QofBook* book = gnc_get_current_book();
+    GNCPriceDB *pdb = gnc_pricedb_get_db (book);
+
+    std::map<std::pair<gnc_commodity*, gnc_commodity*>,
+             std::unique_ptr<PriceSnapshot>> snapshots;
+    std::vector<PricePtr> new_prices;
+    std::vector<GNCPrice*> old_prices;
+
     /* Iterate over all parsed lines */
     for (auto parsed_lines_it = m_parsed_lines.begin();
             parsed_lines_it != m_parsed_lines.end();
@@ -653,8 +727,63 @@ void GncPriceImport::create_prices ()
             continue;
 
         /* Should not throw anymore, otherwise verify needs revision */
-        create_price (parsed_lines_it);
+        auto price_props = complete_price_props (parsed_lines_it);
+        if (!price_props)
+            continue;
+
+        auto from = price_props->get_from_commodity();
+        auto to = price_props->get_to_currency();
+        auto& snapshot = snapshots[std::make_pair (from, to)];
+        if (!snapshot)
+            snapshot.reset (new PriceSnapshot (pdb, from, to));
+
+        auto time = price_props->get_time();
+        auto old_price = snapshot->find_same_day (time);
+        auto have_old = old_price != snapshot->m_by_day.end();
+        if (have_old && !m_over_write)
+        {
+            m_prices_duplicated++;
+            continue;
+        }
+
+        PricePtr price (price_props->make_price (book), gnc_price_unref);
+        if (!price)
+            continue;
+
+        if (have_old)
+        {
+            DEBUG("Over write");
+            auto pending = old_price->second.pending;
+            if (pending >= 0)
+                new_prices[pending].reset();
+            else
+                old_prices.push_back (old_price->second.price);
+            snapshot->m_by_day.erase (old_price);
+            m_prices_replaced++;
+        }
+        else
+            m_prices_added++;
+
+        snapshot->add (time, price.get(), new_prices.size());
+        new_prices.push_back (std::move (price));
     }
+
+    for (auto old_price : old_prices)
+        gnc_pricedb_remove_price (pdb, old_price);
+
+    std::vector<GNCPrice*> batch;
+    batch.reserve (new_prices.size());
+    for (auto& price : new_prices)
+        if (price)
+            batch.push_back (price.get());
+
+    /* The same-day checks have been done above already. */
+    gnc_pricedb_set_bulk_update (pdb, TRUE);
+    auto added = gnc_pricedb_add_prices (pdb, batch.data(), batch.size());
+    gnc_pricedb_set_bulk_update (pdb, FALSE);
+    if (added != batch.size())
+        PWARN ("Only %u of %zu prices could be added", added, batch.size());
+
     PINFO("Number of lines is %d, added %d, duplicated %d, replaced %d",
          (int)m_parsed_lines.size(), m_prices_added, m_prices_duplicated, m_prices_replaced);
 }
@@ -148,11 +148,12 @@ public:
     int  m_prices_replaced;
 
 private:
-    /** A helper function used by create_prices. It will attempt
-     *  to convert a single tokenized line into a price using
-     *  the column types the user has set.
+    /** A helper function used by create_prices. It completes the
+     *  price properties of a single tokenized line with the commodity
+     *  and currency the user selected for the whole file.
+     *  @return The properties, or nullptr if the line can't become a price.
      */
-    void create_price (std::vector<parse_line_t>::iterator& parsed_line);
+    std::shared_ptr<GncImportPrice> complete_price_props (std::vector<parse_line_t>::iterator& parsed_line);
 
     void verify_column_selections (ErrorListPrice& error_msg);
 
@@ -30,13 +30,16 @@ extern "C" {
 #endif
 
 #include <glib/gi18n.h>
+#include <gnc-locale-utils.h>
 }
 
 #include <algorithm>
+#include <atomic>
 #include <exception>
 #include <iostream>
 #include <memory>
 #include <string>
+#include <thread>
 #include <tuple>
 #include <utility>
 #include <vector>
@@ -772,24 +775,27 @@ void GncTxImport::update_pre_trans_props (uint32_t row, uint32_t col, GncTransPr
 
     /* Store the result */
     std::get<PL_PRETRANS>(m_parsed_lines[row]) = trans_props;
+}
 
-    /* For multi-split input data, we need to check whether this line is part of
-     * a transaction that has already been started by a previous line. */
-    if (m_settings.m_multi_split)
+/* A helper function intended to be called only from set_column_type, for
+ * each line in turn after update_pre_trans_props.
+ * For multi-split input data, we need to check whether this line is part of
+ * a transaction that has already been started by a previous line. */
+void GncTxImport::update_pre_trans_parent (uint32_t row)
+{
+    auto trans_props = std::get<PL_PRETRANS>(m_parsed_lines[row]);
+    if (trans_props->is_part_of(m_parent))
     {
-        if (trans_props->is_part_of(m_parent))
-        {
-            /* This line is part of an already started transaction
-             * continue with that one instead to make sure the split from this line
-             * gets added to the proper transaction */
-            std::get<PL_PRETRANS>(m_parsed_lines[row]) = m_parent;
-        }
-        else
-        {
-            /* This line starts a new transaction, set it as parent for
-             * subsequent lines. */
-            m_parent = trans_props;
-        }
+        /* This line is part of an already started transaction
+         * continue with that one instead to make sure the split from this line
+         * gets added to the proper transaction */
+        std::get<PL_PRETRANS>(m_parsed_lines[row]) = m_parent;
+    }
+    else
+    {
+        /* This line starts a new transaction, set it as parent for
+         * subsequent lines. */
+        m_parent = trans_props;
     }
 }
 
@@ -839,6 +845,74 @@ void GncTxImport::update_pre_split_props (uint32_t row, uint32_t col, GncTransPr
 }
 
 
+/* A helper function intended to be called only from set_column_type */
+void GncTxImport::update_line_errors (uint32_t row)
+{
+    auto& parsed_line = m_parsed_lines[row];
+    auto trans_errors = std::get<PL_PRETRANS>(parsed_line)->errors();
+    auto split_errors = std::get<PL_PRESPLIT>(parsed_line)->errors(m_req_mapped_accts);
+    std::get<PL_ERROR>(parsed_line) =
+            trans_errors +
+            (trans_errors.empty() && split_errors.empty() ? std::string() : "\n") +
+            split_errors;
+}
+
+static bool is_trans_prop (GncTransPropType type)
+{
+    return (type > GncTransPropType::NONE) && (type <= GncTransPropType::TRANS_PROPS);
+}
+
+static bool is_split_prop (GncTransPropType type)
+{
+    return (type > GncTransPropType::TRANS_PROPS) && (type <= GncTransPropType::SPLIT_PROPS);
+}
+
+/* Whether values of this type can be parsed on several threads at once.
+ * Accounts and commodities are looked up in the book, and prices are
+ * evaluated by the expression parser, which has global state. */
+static bool parses_in_parallel (GncTransPropType type)
+{
+    switch (type)
+    {
+        case GncTransPropType::COMMODITY:
+        case GncTransPropType::ACCOUNT:
+        case GncTransPropType::TACCOUNT:
+        case GncTransPropType::PRICE:
+            return false;
+        default:
+            return true;
+    }
+}
+
+/* Lines of a file are parsed in chunks of this many on each processor. */
+static const uint32_t parse_chunk_lines = 1024;
+
+/* Call func (row) for every row below n_rows, spreading the rows over as
+ * many threads as there are processors.  func must only touch its own row. */
+template <typename Func> static void
+for_each_row_in_parallel (uint32_t n_rows, Func func)
+{
+    auto n_chunks = (n_rows + parse_chunk_lines - 1) / parse_chunk_lines;
+    auto n_threads = std::min<uint32_t> (MAX (g_get_num_processors (), 1), n_chunks);
+    std::atomic<uint32_t> next_chunk {0};
+    auto work = [&]()
+    {
+        for (uint32_t chunk; (chunk = next_chunk++) < n_chunks;)
+        {
+            auto end = std::min (n_rows, (chunk + 1) * parse_chunk_lines);
+            for (auto row = chunk * parse_chunk_lines; row < end; row++)
+                func (row);
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (uint32_t i = 1; i < n_threads; i++)
+        workers.emplace_back (work);
+    work ();
+    for (auto& worker : workers)
+        worker.join ();
+}
+
 void
 GncTxImport::set_column_type (uint32_t position, GncTransPropType type, bool force)
 {
@@ -864,50 +938,80 @@ GncTxImport::set_column_type (uint32_t position, GncTransPropType type, bool for
 
     /* Update the preparsed data */
     m_parent = nullptr;
-    for (auto parsed_lines_it = m_parsed_lines.begin();
-            parsed_lines_it != m_parsed_lines.end();
-            ++parsed_lines_it)
-    {
-        /* Reset date and currency formats for each trans/split props object
-         * to ensure column updates use the most recent one
-         */
-        std::get<PL_PRETRANS>(*parsed_lines_it)->set_date_format (m_settings.m_date_format);
-        std::get<PL_PRESPLIT>(*parsed_lines_it)->set_date_format (m_settings.m_date_format);
-        std::get<PL_PRESPLIT>(*parsed_lines_it)->set_currency_format (m_settings.m_currency_format);
 
-        uint32_t row = parsed_lines_it - m_parsed_lines.begin();
+    /* In multi-split mode, whether a line continues the transaction of the
+     * line before depends on both lines' transaction properties.  Lines are
+     * linked to their transaction after they're all parsed, unless parsing
+     * depends on the linking, i.e. both column types are transaction
+     * properties (the second update copies the linked transaction). */
+    auto reset_old = (old_type != type);
+    auto link_lines = m_settings.m_multi_split &&
+            ((reset_old && is_trans_prop (old_type)) || is_trans_prop (type));
+    auto in_parallel = parses_in_parallel (type) &&
+            (!reset_old || parses_in_parallel (old_type)) &&
+            !(link_lines && reset_old && is_trans_prop (old_type) && is_trans_prop (type));
+
+    /* Reset date and currency formats for each trans/split props object
+     * to ensure column updates use the most recent one.  The trans props
+     * may be shared between lines, so they aren't left to the workers.
+     */
+    for (auto& parsed_line : m_parsed_lines)
+        std::get<PL_PRETRANS>(parsed_line)->set_date_format (m_settings.m_date_format);
+
+    auto update_line = [&](uint32_t row)
+    {
+        auto& parsed_line = m_parsed_lines[row];
+        std::get<PL_PRESPLIT>(parsed_line)->set_date_format (m_settings.m_date_format);
+        std::get<PL_PRESPLIT>(parsed_line)->set_currency_format (m_settings.m_currency_format);
 
         /* If the column type actually changed, first reset the property
          * represented by the old column type
          */
-        if (old_type != type)
+        if (reset_old)
         {
-            auto old_col = std::get<PL_INPUT>(*parsed_lines_it).size(); // Deliberately out of bounds to trigger a reset!
-            if ((old_type > GncTransPropType::NONE)
-                    && (old_type <= GncTransPropType::TRANS_PROPS))
+            auto old_col = std::get<PL_INPUT>(parsed_line).size(); // Deliberately out of bounds to trigger a reset!
+            if (is_trans_prop (old_type))
+            {
                 update_pre_trans_props (row, old_col, old_type);
-            else if ((old_type > GncTransPropType::TRANS_PROPS)
-                    && (old_type <= GncTransPropType::SPLIT_PROPS))
+                if (link_lines && !in_parallel)
+                    update_pre_trans_parent (row);
+            }
+            else if (is_split_prop (old_type))
                 update_pre_split_props (row, old_col, old_type);
         }
 
         /* Then set the property represented by the new column type */
-        if ((type > GncTransPropType::NONE)
-                && (type <= GncTransPropType::TRANS_PROPS))
+        if (is_trans_prop (type))
+        {
             update_pre_trans_props (row, position, type);
-        else if ((type > GncTransPropType::TRANS_PROPS)
-                && (type <= GncTransPropType::SPLIT_PROPS))
+            if (link_lines && !in_parallel)
+                update_pre_trans_parent (row);
+        }
+        else if (is_split_prop (type))
             update_pre_split_props (row, position, type);
+    };
 
-        /* Report errors if there are any */
-        auto trans_errors = std::get<PL_PRETRANS>(*parsed_lines_it)->errors();
-        auto split_errors = std::get<PL_PRESPLIT>(*parsed_lines_it)->errors(m_req_mapped_accts);
-        std::get<PL_ERROR>(*parsed_lines_it) =
-                trans_errors +
-                (trans_errors.empty() && split_errors.empty() ? std::string() : "\n") +
-                split_errors;
-
+    uint32_t n_rows = m_parsed_lines.size();
+    if (!in_parallel)
+    {
+        for (uint32_t row = 0; row < n_rows; row++)
+        {
+            update_line (row);
+            /* Report errors if there are any */
+            update_line_errors (row);
+        }
+        return;
     }
+
+    /* Make sure the locale data the amount parser uses is set up before
+     * the workers share it. */
+    gnc_localeconv ();
+    for_each_row_in_parallel (n_rows, update_line);
+    if (link_lines)
+        for (uint32_t row = 0; row < n_rows; row++)
+            update_pre_trans_parent (row);
+    /* Report errors if there are any */
+    for_each_row_in_parallel (n_rows, [this](uint32_t row) { update_line_errors (row); });
 }
 
 std::vector<GncTransPropType> GncTxImport::column_types ()
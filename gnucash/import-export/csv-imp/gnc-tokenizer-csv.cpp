@@ -6,10 +6,12 @@
 #include <string>
 #include <algorithm>    // copy
 #include <iterator>     // ostream_operator
+#include <array>
+#include <cstring>
+#include <stdexcept>
+#include <string_view>
 
-#include <boost/tokenizer.hpp>
 #include <boost/locale.hpp>
-#include <boost/algorithm/string.hpp>
 
 extern "C" {
     #include <glib/gi18n.h>
@@ -22,91 +24,183 @@ GncCsvTokenizer::set_separators(const std::string& separators)
 }
 
 
-int GncCsvTokenizer::tokenize()
+/* Each line is split by the rules of boost::escaped_list_separator, once
+ * its stray backslashes and doubled quotes have been rewritten as escapes.
+ * The splitting is done here rather than by boost::tokenizer so that only
+ * separators, quotes and backslashes are looked at one by one; the runs
+ * between them are copied whole, straight from the file's contents. */
+
+using CharSet = std::array<bool, 256>;
+
+static inline bool
+in_set (const CharSet& set, char c)
 {
-    using Tokenizer = boost::tokenizer< boost::escaped_list_separator<char>>;
+    return set[static_cast<unsigned char>(c)];
+}
 
-    boost::escaped_list_separator<char> sep("\\", m_sep_str, "\"");
+static inline const char*
+find_in_set (const char* p, const char* end, const CharSet& set)
+{
+    while (p != end && !in_set (set, *p))
+        ++p;
+    return p;
+}
 
-    StrVec vec;
-    std::string line;
-    std::string buffer;
+/* What boost::trim removes in the classic locale. */
+static inline bool
+is_blank (char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' ||
+        c == '\r';
+}
 
-    bool inside_quotes(false);
-    size_t last_quote(0);
+/* Whether a quote not preceded by a backslash is left open.  That's all that
+ * decides whether a line continues on the next one. */
+static bool
+toggles_quotes (const char* begin, const char* end)
+{
+    auto toggles = false;
+    for (auto p = begin; (p = static_cast<const char*>(
+                              memchr (p, '"', end - p))) != nullptr; ++p)
+        if (p == begin || p[-1] != '\\')
+            toggles = !toggles;
+    return toggles;
+}
 
-    m_tokenized_contents.clear();
-    std::istringstream in_stream(m_utf8_contents);
+/* Make the line valid input for the splitter: a backslash that doesn't start
+ * one of the escapes \\, \" or \n stands for itself, and so does a doubled
+ * quote other than an empty quoted field. */
+static void
+rewrite_escapes (const char* begin, const char* end, const CharSet& seps,
+                 std::string& out)
+{
+    out.clear ();
+    for (auto p = begin; p != end; ++p)
+    {
+        out += *p;
+        if (*p != '\\')
+            continue;
+        if (p + 1 != end && (p[1] == '"' || p[1] == '\\' || p[1] == 'n'))
+            out += *++p;
+        else
+            out += '\\';
+    }
 
-    try
+    for (auto pos = out.find ("\"\""); pos != std::string::npos;
+         pos = out.find ("\"\"", pos + 2))
     {
-        while (std::getline (in_stream, buffer))
-        {
-            // --- deal with line breaks in quoted strings
-            buffer = boost::trim_copy (buffer); // Removes trailing newline and spaces
-            last_quote = buffer.find_first_of('"');
-            while (last_quote != std::string::npos)
-            {
-                if (last_quote == 0) // Test separately because last_quote - 1 would be out of range
-                    inside_quotes = !inside_quotes;
-                else if (buffer[ last_quote - 1 ] != '\\')
-                    inside_quotes = !inside_quotes;
+        auto empty_field = (pos == 0 || in_set (seps, out[pos - 1])) &&
+            (pos + 2 >= out.size () || in_set (seps, out[pos + 2]));
+        if (!empty_field)
+            out[pos] = '\\';
+    }
+}
 
-                last_quote = buffer.find_first_of('"',last_quote+1);
-            }
+/* Split a line as boost::escaped_list_separator ("\\", separators, "\"")
+ * would.  An empty line has no fields at all. */
+static void
+split_line (const char* begin, const char* end, const CharSet& seps,
+            const CharSet& special, StrVec& fields)
+{
+    if (begin == end)
+        return;
 
-            line.append(buffer);
-            if (inside_quotes)
-            {
-                line.append(" ");
-                continue;
-            }
-            // ---
+    std::string field;
+    auto in_quotes = false;
+    for (auto p = begin;;)
+    {
+        auto run_end = find_in_set (p, end, special);
+        field.append (p, run_end);
+        p = run_end;
+        if (p == end)
+            break;
 
-            // Deal with backslashes that are not meant to be escapes
-            // The boost::tokenizer with escaped_list_separator as we use
-            // it would choke on this.
-            auto bs_pos = line.find ('\\');
-            while (bs_pos != std::string::npos)
+        if (*p == '\\')
+        {
+            if (++p == end)
+                throw std::range_error (N_("There was an error parsing the file."));
+            if (*p == 'n')
+                field += '\n';
+            else if (*p == '"' || *p == '\\' || in_set (seps, *p))
+                field += *p;
+            else
+                throw std::range_error (N_("There was an error parsing the file."));
+        }
+        else if (in_set (seps, *p))
+        {
+            if (in_quotes)
+                field += *p;
+            else
             {
-                if ((bs_pos == line.size()) ||                                 // got trailing single backslash
-                    (line.find_first_of ("\"\\n", bs_pos + 1) != bs_pos + 1))  // backslash is not part of known escapes \\, \" or \n
-                    line = line.substr(0, bs_pos) + "\\\\" + line.substr(bs_pos + 1);
-                bs_pos += 2;
-                bs_pos = line.find ('\\', bs_pos);
+                fields.push_back (std::move (field));
+                field.clear ();
             }
+        }
+        else
+            in_quotes = !in_quotes;
+        ++p;
+    }
+    fields.push_back (std::move (field));
+}
+
+int GncCsvTokenizer::tokenize()
+{
+    CharSet seps{}, special{};
+    for (auto c : m_sep_str)
+        seps[static_cast<unsigned char>(c)] = true;
+    special = seps;
+    special['"'] = special['\\'] = true;
+
+    std::string joined, rewritten;
+    StrVec fields;
+    auto inside_quotes = false;
 
-            // Deal with repeated " ("") in strings.
-            // This is commonly used as escape mechanism for double quotes in csv files.
-            // However boost just eats them.
-            bs_pos = line.find ("\"\"");
-            while (bs_pos != std::string::npos)
+    m_tokenized_contents.clear();
+
+    const char* end = m_utf8_contents.data() + m_utf8_contents.size();
+    for (const char* line = m_utf8_contents.data(); line != end;)
+    {
+        auto eol = static_cast<const char*>(memchr (line, '\n', end - line));
+        auto next = eol ? eol + 1 : end;
+        if (!eol)
+            eol = end;
+
+        while (line != eol && is_blank (*line))
+            ++line;
+        while (eol != line && is_blank (eol[-1]))
+            --eol;
+        if (toggles_quotes (line, eol))
+            inside_quotes = !inside_quotes;
+
+        /* A record spread over several lines gets them joined with spaces. */
+        auto rec_begin = line, rec_end = eol;
+        line = next;
+        if (inside_quotes || !joined.empty())
+        {
+            joined.append (rec_begin, rec_end);
+            if (inside_quotes)
             {
-                // Only make changes in case the double quotes are part of a larger field
-                // In other words a field which only contains two double quotes represent an
-                // empty field. We don't need to touch those.
-                // The way to determine whether the double quotes represent an empty string
-                // is by checking whether the character in front or after are either
-                // a field separator or the beginning or end of of the string.
-                if (!(((bs_pos == 0) ||                                          // quotes are at start of line
-                       (m_sep_str.find (line[bs_pos-1]) != std::string::npos))    // quotes preceded by field separator
-                      &&
-                      ((bs_pos + 2 >= line.length()) ||                          // quotes are at end of line
-                       (m_sep_str.find (line[bs_pos+2]) != std::string::npos))))   // quotes followed by field separator
-                    // Only make changes in case the double quotes are not an empty field
-                    line.replace (bs_pos, 2, "\\\"");
-                bs_pos = line.find ("\"\"", bs_pos + 2);
+                joined += ' ';
+                continue;
             }
+            rec_begin = joined.data();
+            rec_end = rec_begin + joined.size();
+        }
 
-            Tokenizer tok(line, sep);
-            vec.assign(tok.begin(),tok.end());
-            m_tokenized_contents.push_back(vec);
-            line.clear();
+        std::string_view record (rec_begin, rec_end - rec_begin);
+        if (record.find ('\\') != record.npos ||
+            record.find ("\"\"") != record.npos)
+        {
+            rewrite_escapes (rec_begin, rec_end, seps, rewritten);
+            rec_begin = rewritten.data();
+            rec_end = rec_begin + rewritten.size();
         }
-    }
-    catch (boost::escaped_list_error &e)
-    {
-        throw (std::range_error N_("There was an error parsing the file."));
+
+        split_line (rec_begin, rec_end, seps, special, fields);
+        m_tokenized_contents.push_back (std::move (fields));
+        fields.clear();
+        fields.reserve (m_tokenized_contents.back().size());
+        joined.clear();
     }
 
     return 0;
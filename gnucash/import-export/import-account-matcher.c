@@ -93,70 +93,238 @@ static AccountPickerDialog* gnc_import_new_account_picker(void)
 }
 
 
+/********************************************************************\
+ * The account online_id index
+ *
+ * Maps the online_ids of a book's accounts to the accounts, so that
+ * finding the account of an imported statement doesn't have to read the
+ * online_id of every account in the tree.  It's built the first time it's
+ * needed; the engine's account events mark it stale when an account's
+ * online_id changes or an account with one is added, removed or destroyed,
+ * and it's rebuilt on the next lookup.  If events were suspended in
+ * between, the changes made meanwhile are unknown and it's rebuilt too.
+\********************************************************************/
+
+#define ACCOUNT_ONLINE_ID_INDEX "gnc-import-account-online-id-index"
+
+typedef struct
+{
+    gchar *online_id;
+    /* where the account comes in a depth first walk of the tree */
+    guint position;
+} AccountOnlineId;
+
+typedef struct
+{
+    QofBook *book;
+    Account *root;
+    gint handler_id;
+    guint dropped_events;
+    gboolean stale;
+    /* online_id without one trailing space -> GPtrArray of the Accounts
+     * having it, in tree order */
+    GHashTable *by_id;
+    /* Account -> AccountOnlineId */
+    GHashTable *by_account;
+} AccountOnlineIdIndex;
+
+static void
+account_online_id_free (gpointer data)
+{
+    AccountOnlineId *entry = data;
+    g_free (entry->online_id);
+    g_free (entry);
+}
+
+static void
+account_online_id_index_add_cb (Account *acct, gpointer data)
+{
+    AccountOnlineIdIndex *index = data;
+    gchar *online_id = (gchar*) gnc_import_get_acc_online_id (acct);
+    AccountOnlineId *entry;
+    GPtrArray *accounts;
+    gchar *key;
+    gsize len;
+
+    if (!online_id || !*online_id)
+    {
+        g_free (online_id);
+        return;
+    }
+
+    entry = g_new (AccountOnlineId, 1);
+    entry->online_id = online_id;
+    entry->position = g_hash_table_size (index->by_account);
+    g_hash_table_insert (index->by_account, acct, entry);
+
+    len = strlen (online_id);
+    if (online_id[len - 1] == ' ')
+        --len;
+    key = g_strndup (online_id, len);
+    accounts = g_hash_table_lookup (index->by_id, key);
+    if (!accounts)
+    {
+        accounts = g_ptr_array_new ();
+        g_hash_table_insert (index->by_id, key, accounts);
+    }
+    else
+        g_free (key);
+    g_ptr_array_add (accounts, acct);
+}
+
+static void
+account_online_id_index_rebuild (AccountOnlineIdIndex *index)
+{
+    g_hash_table_remove_all (index->by_id);
+    g_hash_table_remove_all (index->by_account);
+    index->root = gnc_book_get_root_account (index->book);
+    index->dropped_events = qof_event_get_dropped_count ();
+    index->stale = FALSE;
+    gnc_account_foreach_descendant (index->root,
+                                    account_online_id_index_add_cb, index);
+}
+
+static void
+account_online_id_index_event_cb (QofInstance *entity, QofEventId event_type,
+                                  gpointer handler_data, gpointer event_data)
+{
+    AccountOnlineIdIndex *index = handler_data;
+    AccountOnlineId *entry;
+    gchar *online_id = NULL;
+
+    if (index->stale || qof_instance_get_book (entity) != index->book)
+        return;
+
+    entry = g_hash_table_lookup (index->by_account, entity);
+    if (event_type != QOF_EVENT_DESTROY)
+        online_id = (gchar*) gnc_import_get_acc_online_id (GNC_ACCOUNT (entity));
+    if (online_id && !*online_id)
+    {
+        g_free (online_id);
+        online_id = NULL;
+    }
+
+    /* Most account events are about balances and the like; only those
+     * that change which account has which online_id matter here. */
+    if (event_type == QOF_EVENT_MODIFY)
+        index->stale = g_strcmp0 (entry ? entry->online_id : NULL, online_id) != 0;
+    else
+        index->stale = entry || online_id;
+    g_free (online_id);
+}
+
+static void
+account_online_id_index_destroy (QofBook *book, gpointer key, gpointer data)
+{
+    AccountOnlineIdIndex *index = data;
+
+    qof_event_unregister_handler (index->handler_id);
+    g_hash_table_destroy (index->by_account);
+    g_hash_table_destroy (index->by_id);
+    g_free (index);
+}
+
+/* The book's account online_id index, current up to the last event. */
+static AccountOnlineIdIndex *
+account_online_id_index_get (QofBook *book)
+{
+    AccountOnlineIdIndex *index = qof_book_get_data (book, ACCOUNT_ONLINE_ID_INDEX);
+
+    if (!index)
+    {
+        index = g_new0 (AccountOnlineIdIndex, 1);
+        index->book = book;
+        index->by_id = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+                                              (GDestroyNotify)g_ptr_array_unref);
+        index->by_account = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+                                                   NULL, account_online_id_free);
+        index->handler_id =
+            qof_event_register_filtered_handler (GNC_ID_ACCOUNT,
+                                                 QOF_EVENT_MODIFY |
+                                                 QOF_EVENT_ADD |
+                                                 QOF_EVENT_REMOVE |
+                                                 QOF_EVENT_DESTROY,
+                                                 account_online_id_index_event_cb,
+                                                 index);
+        qof_book_set_data_fin (book, ACCOUNT_ONLINE_ID_INDEX, index,
+                               account_online_id_index_destroy);
+        account_online_id_index_rebuild (index);
+    }
+    else if (index->stale ||
+             index->root != gnc_book_get_root_account (book) ||
+             index->dropped_events != qof_event_get_dropped_count ())
+        account_online_id_index_rebuild (index);
+
+    return index;
+}
+
 /**************************************************
- * test_acct_online_id_match
+ * find_acct_by_online_id
  *
- * test for match of account online_ids.
+ * Find the account whose online_id, ignoring one trailing
+ * space on either, is match->online_id.  Failing that, the
+ * accounts whose online_id is the longest proper prefix of
+ * it are left in match.
  **************************************************/
-static gpointer test_acct_online_id_match(Account *acct, gpointer data)
+static Account *
+find_acct_by_online_id (QofBook *book, AccountOnlineMatch *match)
 {
-    AccountOnlineMatch *match = (AccountOnlineMatch*)data;
-    const char *acct_online_id = gnc_import_get_acc_online_id(acct);
-    int acct_len, match_len;
+    AccountOnlineIdIndex *index = account_online_id_index_get (book);
+    Account *found = NULL;
+    guint found_position = G_MAXUINT;
+    gchar *key;
+    gsize match_len;
 
-    if (acct_online_id == NULL || match->online_id == NULL)
+    if (!match->online_id || !*match->online_id)
         return NULL;
 
-    acct_len = strlen(acct_online_id);
-    match_len = strlen(match->online_id);
-
-    if (acct_online_id[acct_len - 1] == ' ')
-        --acct_len;
-    if (match->online_id[match_len - 1] == ' ')
-        --match_len;
-
-    if (strncmp (acct_online_id, match->online_id, acct_len) == 0)
+    /* Accounts are listed under their online_id less a trailing space, so
+     * both the online_id and the online_id less its trailing space find
+     * the same ones the tree walk did. */
+    key = g_strdup (match->online_id);
+    match_len = strlen (key);
+    for (gint i = 0; i < 2; ++i)
     {
-        if (strncmp(acct_online_id, match->online_id, match_len) == 0)
-            return (gpointer *) acct;
-        if (match->partial_match == NULL)
-        {
-            match->partial_match = acct;
-            ++match->count;
-        }
-        else
+        GPtrArray *accounts = g_hash_table_lookup (index->by_id, key);
+        if (accounts)
         {
-            const char *partial_online_id =
-                gnc_import_get_acc_online_id(match->partial_match);
-            int partial_len = strlen(partial_online_id);
-            if (partial_online_id[partial_len - 1] == ' ')
-                --partial_len;
-            /* Both partial_online_id and acct_online_id are substrings of
-             * match->online_id, but whichever is longer is the better match.
-             * Reset match->count to 1 just in case there was ambiguity on the
-             * shorter partial match.
-             */
-            if (partial_len < acct_len)
-            {
-                match->partial_match = acct;
-                match->count = 1;
-            }
-            /* If they're the same size then there are two accounts with the
-             * same online id and we don't know which one to select. Increment
-             * match->count to dissuade gnc_import_find_account from using
-             * match->online_id and log an error.
-             */
-            else if (partial_len == acct_len)
+            Account *acct = g_ptr_array_index (accounts, 0);
+            AccountOnlineId *entry = g_hash_table_lookup (index->by_account, acct);
+            if (entry->position < found_position)
             {
-                ++match->count;
-                PERR("Accounts %s and %s have the same online-id %s",
-                     gnc_account_get_full_name(match->partial_match),
-                     gnc_account_get_full_name(acct),
-                     partial_online_id);
+                found = acct;
+                found_position = entry->position;
             }
         }
+        if (key[match_len - 1] != ' ')
+            break;
+        key[--match_len] = '\0';
+    }
+    if (found)
+    {
+        g_free (key);
+        return found;
     }
 
+    while (match_len-- > 1)
+    {
+        GPtrArray *accounts;
+
+        key[match_len] = '\0';
+        accounts = g_hash_table_lookup (index->by_id, key);
+        if (!accounts)
+            continue;
+
+        match->partial_match = g_ptr_array_index (accounts, 0);
+        match->count = accounts->len;
+        if (accounts->len > 1)
+            PERR("Accounts %s and %s have the same online-id %s",
+                 gnc_account_get_full_name (g_ptr_array_index (accounts, 0)),
+                 gnc_account_get_full_name (g_ptr_array_index (accounts, 1)),
+                 key);
+        break;
+    }
+    g_free (key);
     return NULL;
 }
 
@@ -421,10 +589,7 @@ Account * gnc_import_select_account(GtkWidget *parent,
     if (account_online_id_value != NULL)
     {
         AccountOnlineMatch match = {NULL, 0, account_online_id_value};
-        retval =
-            gnc_account_foreach_descendant_until(gnc_get_current_root_account (),
-                                                 test_acct_online_id_match,
-                                                 (void*)&match);
+        retval = find_acct_by_online_id (gnc_get_current_book (), &match);
         if (!retval && match.count == 1 &&
             new_account_default_type == ACCT_TYPE_NONE)
             retval = match.partial_match;
@@ -617,6 +617,73 @@ matchmap_store_destination (GncImportMatchMap *matchmap,
 
 
 
+/* The part of a match's score that comes from the amounts */
+static gint
+amount_heuristic (double downloaded_amount, double match_amount,
+                  double fuzzy_amount_difference)
+{
+    if (fabs (downloaded_amount - match_amount) < 1e-6)
+        /* bug#347791: Double type shouldn't be compared for exact
+           equality, so we're using fabs() instead. */
+        /*if (gnc_numeric_equal(xaccSplitGetAmount
+          (new_trans_fsplit),
+          xaccSplitGetAmount(split)))
+          -- gnc_numeric_equal is an expensive function call */
+    {
+        /*DEBUG("heuristics:  probability + 3 (amount)");*/
+        return 3;
+    }
+    else if (fabs (downloaded_amount - match_amount) <=
+             fuzzy_amount_difference)
+    {
+        /* ATM fees are sometimes added directly in the transaction.
+           So you withdraw 100$ and get charged 101,25$ in the same
+           transaction */
+        /*DEBUG("heuristics:  probability + 2 (amount)");*/
+        return 2;
+    }
+    /* If a transaction's amount doesn't match within the
+       threshold, it's very unlikely to be the same transaction
+       so we give it an extra -5 penalty */
+    /* DEBUG("heuristics:  probability - 1 (amount)"); */
+    return -5;
+}
+
+/* The part of a match's score that comes from the dates */
+static gint
+date_heuristic (time64 download_time, time64 match_time)
+{
+    int datediff_day = llabs(match_time - download_time) / 86400;
+    /* Sorry, there are not really functions around at all that
+       provide for less hacky calculation of days of date
+       differences. Whatever. On the other hand, the difference
+       calculation itself will work regardless of month/year
+       turnarounds. */
+    /*DEBUG("diff day %d", datediff_day);*/
+    if (datediff_day == 0)
+    {
+        /*DEBUG("heuristics:  probability + 3 (date)");*/
+        return 3;
+    }
+    else if (datediff_day <= MATCH_DATE_THRESHOLD)
+    {
+        /*DEBUG("heuristics:  probability + 2 (date)");*/
+        return 2;
+    }
+    else if (datediff_day > MATCH_DATE_NOT_THRESHOLD)
+    {
+        /* Extra penalty if that split lies awfully far away from
+           the given one. */
+        /*DEBUG("heuristics:  probability - 5 (date)"); */
+        /* Changed 2005-02-21: Revert the hard-limiting behaviour
+           back to the previous large penalty. (Changed 2004-11-27:
+           The penalty is so high that we can forget about this
+           split anyway and skip the rest of the tests.) */
+        return -5;
+    }
+    return 0;
+}
+
 /** @brief The transaction matching heuristics are here.
  */
 void split_find_match (GNCImportTransInfo * trans_info,
@@ -635,7 +702,6 @@ void split_find_match (GNCImportTransInfo * trans_info,
         gboolean update_proposed;
         double downloaded_split_amount, match_split_amount;
         time64 match_time, download_time;
-        int datediff_day;
         Transaction *new_trans = gnc_import_TransInfo_get_trans (trans_info);
         Split *new_trans_fsplit = gnc_import_TransInfo_get_fsplit (trans_info);
 
@@ -647,66 +713,13 @@ void split_find_match (GNCImportTransInfo * trans_info,
         /*DEBUG(" downloaded_split_amount=%f", downloaded_split_amount);*/
         match_split_amount = gnc_numeric_to_double(xaccSplitGetAmount(split));
         /*DEBUG(" match_split_amount=%f", match_split_amount);*/
-        if (fabs(downloaded_split_amount - match_split_amount) < 1e-6)
-            /* bug#347791: Double type shouldn't be compared for exact
-               equality, so we're using fabs() instead. */
-            /*if (gnc_numeric_equal(xaccSplitGetAmount
-              (new_trans_fsplit),
-              xaccSplitGetAmount(split)))
-              -- gnc_numeric_equal is an expensive function call */
-        {
-            prob = prob + 3;
-            /*DEBUG("heuristics:  probability + 3 (amount)");*/
-        }
-        else if (fabs (downloaded_split_amount - match_split_amount) <=
-                 fuzzy_amount_difference)
-        {
-            /* ATM fees are sometimes added directly in the transaction.
-               So you withdraw 100$ and get charged 101,25$ in the same
-               transaction */
-            prob = prob + 2;
-            /*DEBUG("heuristics:  probability + 2 (amount)");*/
-        }
-        else
-        {
-            /* If a transaction's amount doesn't match within the
-               threshold, it's very unlikely to be the same transaction
-               so we give it an extra -5 penalty */
-            prob = prob - 5;
-            /* DEBUG("heuristics:  probability - 1 (amount)"); */
-        }
+        prob += amount_heuristic (downloaded_split_amount, match_split_amount,
+                                  fuzzy_amount_difference);
 
         /* Date heuristics */
         match_time = xaccTransGetDate (xaccSplitGetParent (split));
         download_time = xaccTransGetDate (new_trans);
-        datediff_day = llabs(match_time - download_time) / 86400;
-        /* Sorry, there are not really functions around at all that
-        	 provide for less hacky calculation of days of date
-        	 differences. Whatever. On the other hand, the difference
-        	 calculation itself will work regardless of month/year
-        	 turnarounds. */
-        /*DEBUG("diff day %d", datediff_day);*/
-        if (datediff_day == 0)
-        {
-            prob = prob + 3;
-            /*DEBUG("heuristics:  probability + 3 (date)");*/
-        }
-        else if (datediff_day <= MATCH_DATE_THRESHOLD)
-        {
-            prob = prob + 2;
-            /*DEBUG("heuristics:  probability + 2 (date)");*/
-        }
-        else if (datediff_day > MATCH_DATE_NOT_THRESHOLD)
-        {
-            /* Extra penalty if that split lies awfully far away from
-               the given one. */
-            prob = prob - 5;
-            /*DEBUG("heuristics:  probability - 5 (date)"); */
-            /* Changed 2005-02-21: Revert the hard-limiting behaviour
-               back to the previous large penalty. (Changed 2004-11-27:
-               The penalty is so high that we can forget about this
-               split anyway and skip the rest of the tests.) */
-        }
+        prob += date_heuristic (download_time, match_time);
 
         /* Check if date and amount are identical */
         update_proposed = (prob < 6);
@@ -829,6 +842,238 @@ void split_find_match (GNCImportTransInfo * trans_info,
     }
 }/* end split_find_match */
 
+/***********************************************************************
+ * Candidate index to speed up split_find_match
+ */
+
+/* The most a match's score can gain from its number, memo and description,
+ * which split_find_match only compares when the imported transaction has
+ * them. */
+static gint
+max_text_heuristics (GNCImportTransInfo *trans_info)
+{
+    Transaction *new_trans = gnc_import_TransInfo_get_trans (trans_info);
+    Split *new_trans_fsplit = gnc_import_TransInfo_get_fsplit (trans_info);
+    const char *num = gnc_get_num_action (new_trans, new_trans_fsplit);
+    const char *memo = xaccSplitGetMemo (new_trans_fsplit);
+    const char *descr = xaccTransGetDescription (new_trans);
+    gint max = 0;
+
+    if (num && *num)
+        max += 4;
+    if (memo && *memo)
+        max += 2;
+    if (descr && *descr)
+        max += 2;
+    return max;
+}
+
+typedef struct
+{
+    Split *split;
+    double amount;
+    time64 date;
+} MatchCandidate;
+
+struct _matchindex
+{
+    double fuzzy_amount_difference;
+    double bucket_width;
+    /* In the order the splits were given, to keep ties in that order */
+    GArray *candidates;
+    /* Positions in candidates, ordered by date */
+    GArray *by_date;
+    /* Amount bucket -> GArray of positions in candidates, ascending */
+    GHashTable *by_amount;
+};
+
+static gint64
+amount_bucket (const GNCImportMatchIndex *index, double amount)
+{
+    return (gint64) floor (amount / index->bucket_width);
+}
+
+static gint
+compare_candidate_dates (gconstpointer a, gconstpointer b, gpointer user_data)
+{
+    GArray *candidates = user_data;
+    time64 date_a = g_array_index (candidates, MatchCandidate,
+                                   *(const guint*)a).date;
+    time64 date_b = g_array_index (candidates, MatchCandidate,
+                                   *(const guint*)b).date;
+    return (date_a > date_b) - (date_a < date_b);
+}
+
+static gint
+compare_positions (gconstpointer a, gconstpointer b)
+{
+    guint pos_a = *(const guint*)a, pos_b = *(const guint*)b;
+    return (pos_a > pos_b) - (pos_a < pos_b);
+}
+
+GNCImportMatchIndex *
+gnc_import_MatchIndex_new (GSList *splits, double fuzzy_amount_difference)
+{
+    GNCImportMatchIndex *index = g_new0 (GNCImportMatchIndex, 1);
+    guint pos = 0;
+
+    index->fuzzy_amount_difference = fuzzy_amount_difference;
+    /* Amounts close enough to score are then at most one bucket apart. */
+    index->bucket_width = MAX (fuzzy_amount_difference, 1.0);
+    index->candidates = g_array_new (FALSE, FALSE, sizeof (MatchCandidate));
+    index->by_date = g_array_new (FALSE, FALSE, sizeof (guint));
+    index->by_amount = g_hash_table_new_full (g_int64_hash, g_int64_equal,
+                                              g_free,
+                                              (GDestroyNotify)g_array_unref);
+
+    for (GSList *node = splits; node; node = g_slist_next (node), ++pos)
+    {
+        MatchCandidate candidate;
+        gint64 bucket;
+        GArray *positions;
+
+        candidate.split = node->data;
+        candidate.amount =
+            gnc_numeric_to_double (xaccSplitGetAmount (candidate.split));
+        candidate.date = xaccTransGetDate (xaccSplitGetParent (candidate.split));
+        g_array_append_val (index->candidates, candidate);
+        g_array_append_val (index->by_date, pos);
+
+        bucket = amount_bucket (index, candidate.amount);
+        positions = g_hash_table_lookup (index->by_amount, &bucket);
+        if (!positions)
+        {
+            gint64 *key = g_new (gint64, 1);
+            *key = bucket;
+            positions = g_array_new (FALSE, FALSE, sizeof (guint));
+            g_hash_table_insert (index->by_amount, key, positions);
+        }
+        g_array_append_val (positions, pos);
+    }
+    g_array_sort_with_data (index->by_date, compare_candidate_dates,
+                            index->candidates);
+    return index;
+}
+
+void
+gnc_import_MatchIndex_delete (GNCImportMatchIndex *index)
+{
+    if (!index)
+        return;
+    g_array_unref (index->candidates);
+    g_array_unref (index->by_date);
+    g_hash_table_destroy (index->by_amount);
+    g_free (index);
+}
+
+/* Whether the candidate at pos could score at least display_threshold,
+ * given the most it can gain from the text heuristics. */
+static gboolean
+candidate_may_match (const GNCImportMatchIndex *index, guint pos,
+                     double amount, time64 date, gint max_text,
+                     gint display_threshold)
+{
+    const MatchCandidate *candidate =
+        &g_array_index (index->candidates, MatchCandidate, pos);
+    return amount_heuristic (amount, candidate->amount,
+                             index->fuzzy_amount_difference) +
+           date_heuristic (date, candidate->date) + max_text >=
+           display_threshold;
+}
+
+void
+gnc_import_MatchIndex_find_matches (GNCImportMatchIndex *index,
+                                    GNCImportTransInfo *trans_info,
+                                    gint display_threshold)
+{
+    static const time64 secs_per_day = 86400;
+    double amount;
+    time64 date, near_start, near_end;
+    gint max_text;
+    GArray *hits;
+    guint lo, hi;
+
+    g_return_if_fail (index && trans_info);
+
+    amount = gnc_numeric_to_double
+        (xaccSplitGetAmount (gnc_import_TransInfo_get_fsplit (trans_info)));
+    date = xaccTransGetDate (gnc_import_TransInfo_get_trans (trans_info));
+    /* Candidates outside this window get the date penalty. */
+    near_start = date - (MATCH_DATE_NOT_THRESHOLD + 1) * secs_per_day;
+    near_end = date + (MATCH_DATE_NOT_THRESHOLD + 1) * secs_per_day;
+    max_text = max_text_heuristics (trans_info);
+    hits = g_array_new (FALSE, FALSE, sizeof (guint));
+    lo = 0;
+    hi = index->by_date->len;
+
+    /* Find the first candidate in the window by date. */
+    while (lo < hi)
+    {
+        guint mid = lo + (hi - lo) / 2;
+        guint pos = g_array_index (index->by_date, guint, mid);
+        if (g_array_index (index->candidates, MatchCandidate, pos).date <= near_start)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    for (guint i = lo; i < index->by_date->len; ++i)
+    {
+        guint pos = g_array_index (index->by_date, guint, i);
+        if (g_array_index (index->candidates, MatchCandidate, pos).date >= near_end)
+            break;
+        if (candidate_may_match (index, pos, amount, date, max_text,
+                                 display_threshold))
+            g_array_append_val (hits, pos);
+    }
+
+    /* Candidates further away can only score with a matching amount,
+     * unless the text heuristics make up for both penalties. */
+    if (max_text - 10 >= display_threshold)
+    {
+        for (guint pos = 0; pos < index->candidates->len; ++pos)
+        {
+            time64 cand_date =
+                g_array_index (index->candidates, MatchCandidate, pos).date;
+            if (cand_date > near_start && cand_date < near_end)
+                continue;
+            g_array_append_val (hits, pos);
+        }
+    }
+    else if (max_text - 2 >= display_threshold)
+    {
+        gint64 bucket = amount_bucket (index, amount);
+        for (gint64 b = bucket - 1; b <= bucket + 1; ++b)
+        {
+            GArray *positions = g_hash_table_lookup (index->by_amount, &b);
+            if (!positions)
+                continue;
+            for (guint i = 0; i < positions->len; ++i)
+            {
+                guint pos = g_array_index (positions, guint, i);
+                time64 cand_date =
+                    g_array_index (index->candidates, MatchCandidate, pos).date;
+                if (cand_date > near_start && cand_date < near_end)
+                    continue;
+                if (candidate_may_match (index, pos, amount, date, max_text,
+                                         display_threshold))
+                    g_array_append_val (hits, pos);
+            }
+        }
+    }
+
+    /* Score them in the order the splits were given, as matching them all
+     * one by one would. */
+    g_array_sort (hits, compare_positions);
+    for (guint i = 0; i < hits->len; ++i)
+    {
+        guint pos = g_array_index (hits, guint, i);
+        split_find_match (trans_info,
+                          g_array_index (index->candidates, MatchCandidate, pos).split,
+                          display_threshold, index->fuzzy_amount_difference);
+    }
+    g_array_unref (hits);
+}
+
 /***********************************************************************
  */
 
@@ -1051,93 +1296,203 @@ gnc_import_process_trans_item (GncImportMatchMap *matchmap,
 }
 
 /********************************************************************\
- * check_trans_online_id() Callback function used by
- * gnc_import_exists_online_id.  Takes pointers to transaction and split,
- * returns 0 if their online_ids  do NOT match, or if the split
- * belongs to the transaction
+ * The online_id index
+ *
+ * Maps each online_id in a book to the transactions carrying it, on the
+ * transaction itself or on one of its splits.  It's built the first time
+ * an import needs it and kept up to date from the engine's events, so
+ * later imports into the same book don't have to read the online_id of
+ * every transaction again.  If events were suspended in between, the
+ * changes made meanwhile are unknown and the index is rebuilt.
 \********************************************************************/
-static gint check_trans_online_id(Transaction *trans1, void *user_data)
+
+#define ONLINE_ID_INDEX "gnc-import-online-id-index"
+
+typedef struct
 {
-    Account *account;
-    Split *split1;
-    Split *split2 = user_data;
-    const gchar *online_id1;
-    const gchar *online_id2;
-
-    account = xaccSplitGetAccount(split2);
-    split1 = xaccTransFindSplitByAccount(trans1, account);
-    if (split1 == split2)
-        return 0;
+    QofBook *book;
+    gint handler_id;
+    guint dropped_events;
+    /* online_id -> GHashTable of the Transactions having it */
+    GHashTable *by_id;
+    /* Transaction -> GPtrArray of the online_ids it's listed under */
+    GHashTable *by_trans;
+} OnlineIdIndex;
 
-    /* hack - we really want to iterate over the _splits_ of the account
-       instead of the transactions */
-    g_assert(split1 != NULL);
+static void
+online_id_index_remove_trans (OnlineIdIndex *index, Transaction *trans)
+{
+    GPtrArray *ids = g_hash_table_lookup (index->by_trans, trans);
+    if (!ids)
+        return;
 
-    if (gnc_import_split_has_online_id(split1))
-        online_id1 = gnc_import_get_split_online_id(split1);
-    else
-        online_id1 = gnc_import_get_trans_online_id(trans1);
+    for (guint i = 0; i < ids->len; ++i)
+    {
+        const gchar *id = g_ptr_array_index (ids, i);
+        GHashTable *transactions = g_hash_table_lookup (index->by_id, id);
+        if (!transactions)
+            continue;
+        g_hash_table_remove (transactions, trans);
+        if (g_hash_table_size (transactions) == 0)
+            g_hash_table_remove (index->by_id, id);
+    }
+    g_hash_table_remove (index->by_trans, trans);
+}
 
-    online_id2 = gnc_import_get_split_online_id(split2);
+static void
+online_id_index_add_id (OnlineIdIndex *index, Transaction *trans,
+                        GPtrArray *ids, gchar *id)
+{
+    GHashTable *transactions;
 
-    if ((online_id1 == NULL) ||
-            (online_id2 == NULL) ||
-            (strcmp(online_id1, online_id2) != 0))
+    if (!id || !*id)
     {
-        return 0;
+        g_free (id);
+        return;
     }
-    else
+
+    transactions = g_hash_table_lookup (index->by_id, id);
+    if (!transactions)
     {
-        /*printf("test_trans_online_id(): Duplicate found\n");*/
-        return 1;
+        transactions = g_hash_table_new (g_direct_hash, g_direct_equal);
+        g_hash_table_insert (index->by_id, g_strdup (id), transactions);
     }
+    g_hash_table_add (transactions, trans);
+    g_ptr_array_add (ids, id);
 }
 
-static gint collect_trans_online_id(Transaction *trans, void *user_data)
+static void
+online_id_index_add_trans (OnlineIdIndex *index, Transaction *trans)
 {
-    Split *split;
-    GHashTable *id_hash = user_data;
-    int i=0;
-    
-    const gchar* online_id = gnc_import_get_trans_online_id (trans);
-    if (online_id)
-        g_hash_table_add (id_hash, (void*) online_id);
+    GPtrArray *ids = g_ptr_array_new_with_free_func (g_free);
 
+    online_id_index_add_id (index, trans, ids,
+                            (gchar*) gnc_import_get_trans_online_id (trans));
     for (GList *splits = xaccTransGetSplitList (trans); splits; splits = splits->next)
+        online_id_index_add_id (index, trans, ids,
+                                (gchar*) gnc_import_get_split_online_id (splits->data));
+
+    if (ids->len)
+        g_hash_table_insert (index->by_trans, trans, ids);
+    else
+        g_ptr_array_unref (ids);
+}
+
+static void
+online_id_index_add_cb (QofInstance *inst, gpointer user_data)
+{
+    online_id_index_add_trans (user_data, GNC_TRANSACTION (inst));
+}
+
+static void
+online_id_index_rebuild (OnlineIdIndex *index)
+{
+    g_hash_table_remove_all (index->by_trans);
+    g_hash_table_remove_all (index->by_id);
+    index->dropped_events = qof_event_get_dropped_count ();
+    qof_collection_foreach (qof_book_get_collection (index->book, GNC_ID_TRANS),
+                            online_id_index_add_cb, index);
+}
+
+static void
+online_id_index_event_cb (QofInstance *entity, QofEventId event_type,
+                          gpointer handler_data, gpointer event_data)
+{
+    OnlineIdIndex *index = handler_data;
+    Transaction *trans = GNC_TRANSACTION (entity);
+
+    if (qof_instance_get_book (entity) != index->book)
+        return;
+
+    /* A transaction's commit re-reads all its splits, which also catches
+     * splits that were moved in or out or changed their online_id. */
+    online_id_index_remove_trans (index, trans);
+    if (event_type != QOF_EVENT_DESTROY)
+        online_id_index_add_trans (index, trans);
+}
+
+static void
+online_id_index_destroy (QofBook *book, gpointer key, gpointer data)
+{
+    OnlineIdIndex *index = data;
+
+    qof_event_unregister_handler (index->handler_id);
+    g_hash_table_destroy (index->by_trans);
+    g_hash_table_destroy (index->by_id);
+    g_free (index);
+}
+
+/* The book's online_id index, current up to the last event. */
+static OnlineIdIndex *
+online_id_index_get (QofBook *book)
+{
+    OnlineIdIndex *index = qof_book_get_data (book, ONLINE_ID_INDEX);
+
+    if (!index)
     {
-        if (gnc_import_split_has_online_id (splits->data))
-            g_hash_table_add(id_hash, (void*) gnc_import_get_split_online_id (splits->data));
+        index = g_new0 (OnlineIdIndex, 1);
+        index->book = book;
+        index->by_id = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+                                              (GDestroyNotify)g_hash_table_destroy);
+        index->by_trans = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+                                                 NULL,
+                                                 (GDestroyNotify)g_ptr_array_unref);
+        index->handler_id =
+            qof_event_register_filtered_handler (GNC_ID_TRANS,
+                                                 QOF_EVENT_CREATE |
+                                                 QOF_EVENT_MODIFY |
+                                                 QOF_EVENT_DESTROY,
+                                                 online_id_index_event_cb,
+                                                 index);
+        qof_book_set_data_fin (book, ONLINE_ID_INDEX, index,
+                               online_id_index_destroy);
+        online_id_index_rebuild (index);
     }
-    return 0;
+    else if (index->dropped_events != qof_event_get_dropped_count ())
+        online_id_index_rebuild (index);
+
+    return index;
 }
 
 /** Checks whether the given transaction's online_id already exists in
   its parent account. */
-gboolean gnc_import_exists_online_id (Transaction *trans, GHashTable* acct_id_hash)
+gboolean gnc_import_exists_online_id (Transaction *trans)
 {
     gboolean online_id_exists = FALSE;
     Account *dest_acct;
     Split *source_split;
+    gchar *source_online_id;
+    GHashTable *transactions;
 
     /* Look for an online_id in the first split */
     source_split = xaccTransGetSplit(trans, 0);
     g_assert(source_split);
 
     // No online id, no point in continuing. We'd crash if we tried.
-    if (!gnc_import_get_split_online_id (source_split))
+    source_online_id = (gchar*) gnc_import_get_split_online_id (source_split);
+    if (!source_online_id || !*source_online_id)
+    {
+        g_free (source_online_id);
         return FALSE;
-    // Create a hash per account of a hash of all transactions IDs. Then the test below will be fast if
-    // we have many transactions to import.
+    }
+
+    /* Any other transaction with a split in the same account that has
+     * the online_id, on itself or on one of its splits, is a duplicate. */
     dest_acct = xaccSplitGetAccount (source_split);
-    if (!g_hash_table_contains (acct_id_hash, dest_acct))
+    transactions = g_hash_table_lookup
+        (online_id_index_get (xaccTransGetBook (trans))->by_id, source_online_id);
+    g_free (source_online_id);
+    if (transactions)
     {
-        GHashTable* new_hash = g_hash_table_new (g_str_hash, g_str_equal);
-        g_hash_table_insert (acct_id_hash, dest_acct, new_hash);
-        xaccAccountForEachTransaction (dest_acct, collect_trans_online_id, new_hash);
+        GHashTableIter iter;
+        gpointer other;
+
+        g_hash_table_iter_init (&iter, transactions);
+        while (!online_id_exists && g_hash_table_iter_next (&iter, &other, NULL))
+            online_id_exists = (other != trans &&
+                                xaccTransFindSplitByAccount (other, dest_acct));
     }
-    online_id_exists = g_hash_table_contains (g_hash_table_lookup (acct_id_hash, dest_acct),
-                                              gnc_import_get_split_online_id (source_split));
-    
+
     /* If it does, abort the process for this transaction, since it is
        already in the system. */
     if (online_id_exists == TRUE)
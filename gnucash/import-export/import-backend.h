@@ -33,6 +33,7 @@
 
 typedef struct _transactioninfo GNCImportTransInfo;
 typedef struct _selected_match_info GNCImportSelectedMatchInfo;
+typedef struct _matchindex GNCImportMatchIndex;
 typedef struct _matchinfo
 {
     Transaction * trans;
@@ -62,9 +63,13 @@ typedef enum _action
  * editing. If a matching online_id exists, the transaction is
  * destroyed (!) and TRUE is returned, otherwise FALSE is returned.
  *
+ * The online_ids of the book are kept in an index that is built on the
+ * first call and then maintained from the engine events, so repeated
+ * checks and later imports don't rescan the account.
+ *
  * @param trans The transaction for which to check for an existing
  * online_id. */
-gboolean gnc_import_exists_online_id (Transaction *trans, GHashTable* acct_id_hash);
+gboolean gnc_import_exists_online_id (Transaction *trans);
 
 /** Evaluates the match between trans_info and split using the provided parameters.
  *
@@ -81,6 +86,30 @@ void split_find_match (GNCImportTransInfo * trans_info,
                        gint display_threshold,
                        double fuzzy_amount_difference);
 
+/** Index the register splits an import may match, so that each imported
+ * transaction is only compared with the splits that can actually score
+ * high enough: those close to it in date, and further away only those
+ * with a similar amount.  The matches found are the same as calling
+ * split_find_match() for every split.
+ *
+ * @param splits The register splits, all in one account.  Matches with
+ * equal scores keep the order of this list.
+ *
+ * @param fuzzy_amount_difference Maximum amount difference to consider the match good.
+ */
+GNCImportMatchIndex *gnc_import_MatchIndex_new (GSList *splits,
+                                                double fuzzy_amount_difference);
+
+/** Evaluate the indexed splits that may match trans_info and add those
+ * scoring at least display_threshold to its list of matches, as
+ * split_find_match() does.
+ */
+void gnc_import_MatchIndex_find_matches (GNCImportMatchIndex *index,
+                                         GNCImportTransInfo *trans_info,
+                                         gint display_threshold);
+
+void gnc_import_MatchIndex_delete (GNCImportMatchIndex *index);
+
 /** Iterates through all splits of the originating account of
  * trans_info. Sorts the resulting list and sets the selected_match
  * and action fields in the trans_info.
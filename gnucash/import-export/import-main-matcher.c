@@ -76,7 +76,6 @@ struct _main_matcher_info
     gboolean add_toggled;     // flag to indicate that add has been toggled to stop selection
     gint id;
     GSList* temp_trans_list;  // Temporary list of imported transactions
-    GHashTable* acct_id_hash; // Hash table, per account, of list of transaction IDs.
     GSList* edited_accounts;  // List of accounts currently edited.
 };
 
@@ -144,14 +143,6 @@ static gboolean query_tooltip_tree_view_cb (GtkWidget *widget, gint x, gint y,
                                             gpointer user_data);
 /* end local prototypes */
 
-static
-gboolean delete_hash (gpointer key, gpointer value, gpointer user_data)
-{
-    // Value is a hash table that needs to be destroyed.
-    g_hash_table_destroy (value);
-    return TRUE;
-}
-
 static void
 update_all_balances (GNCImportMainMatcher *info)
 {
@@ -218,8 +209,6 @@ gnc_gen_trans_list_delete (GNCImportMainMatcher *info)
     // We've deferred balance computations on many accounts. Let's do it now that we're done.
     update_all_balances (info);
 
-    g_hash_table_foreach_remove (info->acct_id_hash, delete_hash, NULL);
-    info->acct_id_hash = NULL;
     g_free (info);
 }
 
@@ -452,12 +441,44 @@ gnc_gen_trans_list_show_all (GNCImportMainMatcher *info)
     gnc_gen_trans_list_show_accounts_column (info);
 }
 
+/* Keep acc open while the matcher's results are processed, so that
+ * its splits are sorted, its balances computed, its changes committed
+ * to the backend and its MODIFY event sent only once, when it's
+ * released by release_account. The value stored tells whether the
+ * balance computation was deferred here. */
+static void
+hold_account (GHashTable *held_accounts, Account *acc)
+{
+    gboolean defer;
+
+    if (!acc || g_hash_table_contains (held_accounts, acc))
+        return;
+
+    xaccAccountBeginEdit (acc);
+    defer = !gnc_account_get_defer_bal_computation (acc);
+    if (defer)
+        gnc_account_set_defer_bal_computation (acc, TRUE);
+    g_hash_table_insert (held_accounts, acc, GINT_TO_POINTER (defer));
+}
+
+static void
+release_account (gpointer key, gpointer value, gpointer user_data)
+{
+    Account *acc = key;
+
+    if (GPOINTER_TO_INT (value))
+        gnc_account_set_defer_bal_computation (acc, FALSE);
+    xaccAccountCommitEdit (acc);
+}
+
 void
 on_matcher_ok_clicked (GtkButton *button, GNCImportMainMatcher *info)
 {
     GtkTreeModel *model;
     GtkTreeIter iter;
     GNCImportTransInfo *trans_info;
+    GHashTable *held_accounts;
+    QofBook *book;
 
     g_assert (info);
 
@@ -474,14 +495,28 @@ on_matcher_ok_clicked (GtkButton *button, GNCImportMainMatcher *info)
     /* Don't run any queries and/or split sorts while processing the matcher
     results. */
     gnc_suspend_gui_refresh ();
+    /* Store the imported transactions in one backend transaction. */
+    book = gnc_get_current_book ();
+    qof_book_begin_batch (book);
+    held_accounts = g_hash_table_new (g_direct_hash, g_direct_equal);
     do
     {
+        GNCImportMatchInfo *selected_match;
+
         gtk_tree_model_get (model, &iter,
                             DOWNLOADED_COL_DATA, &trans_info,
                             -1);
 
         // Note: if there's only 1 split (unbalanced) one will be created with the unbalanced account,
         // and for that account the defer balance will not be set. So things will be slow.
+        hold_account (held_accounts,
+                      xaccSplitGetAccount (gnc_import_TransInfo_get_fsplit (trans_info)));
+        hold_account (held_accounts, gnc_import_TransInfo_get_destacc (trans_info));
+        selected_match = gnc_import_TransInfo_get_selected_match (trans_info);
+        if (selected_match &&
+            gnc_import_TransInfo_get_action (trans_info) != GNCImport_ADD)
+            hold_account (held_accounts,
+                          xaccSplitGetAccount (gnc_import_MatchInfo_get_split (selected_match)));
 
         if (gnc_import_process_trans_item (NULL, trans_info))
         {
@@ -493,6 +528,9 @@ on_matcher_ok_clicked (GtkButton *button, GNCImportMainMatcher *info)
         }
     }
     while (gtk_tree_model_iter_next (model, &iter));
+    g_hash_table_foreach (held_accounts, release_account, NULL);
+    g_hash_table_destroy (held_accounts);
+    qof_book_end_batch (book);
 
     gnc_gen_trans_list_delete (info);
 
@@ -1132,8 +1170,6 @@ gnc_gen_trans_init_view (GNCImportMainMatcher *info,
                       G_CALLBACK(gnc_gen_trans_onButtonPressed_cb), info);
     g_signal_connect (view, "popup-menu",
                       G_CALLBACK(gnc_gen_trans_onPopupMenu_cb), info);
-
-    info->acct_id_hash = g_hash_table_new (g_direct_hash, g_direct_equal);
 }
 
 static void
@@ -1710,7 +1746,7 @@ gnc_gen_trans_list_add_trans_with_ref_id (GNCImportMainMatcher *gui, Transaction
     g_assert (gui);
     g_assert (trans);
 
-    if (gnc_import_exists_online_id (trans, gui->acct_id_hash))
+    if (gnc_import_exists_online_id (trans))
         return;
     else
     {
@@ -1797,20 +1833,6 @@ create_hash_of_potential_matches (GList *candidate_txns,
     return account_hash;
 }
 
-typedef struct _match_struct
-{
-    GNCImportTransInfo* transaction_info;
-    gint display_threshold;
-    double fuzzy_amount;
-} match_struct;
-
-static void
-match_helper (Split* data, match_struct* s)
-{
-    split_find_match (s->transaction_info, data,
-                      s->display_threshold, s->fuzzy_amount);
-}
-
 /* Iterate through the imported transactions selecting matches from the
  * potential match lists in the account hash and update the matcher with the
  * results.
@@ -1824,6 +1846,9 @@ perform_matching (GNCImportMainMatcher *gui, GHashTable *account_hash)
         gnc_import_Settings_get_display_threshold (gui->user_settings);
     double fuzzy_amount =
         gnc_import_Settings_get_fuzzy_amount (gui->user_settings);
+    GHashTable *index_hash =
+        g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL,
+                               (GDestroyNotify)gnc_import_MatchIndex_delete);
 
     for (GSList *imported_txn = gui->temp_trans_list; imported_txn !=NULL;
          imported_txn = g_slist_next (imported_txn))
@@ -1833,10 +1858,17 @@ perform_matching (GNCImportMainMatcher *gui, GHashTable *account_hash)
         gboolean match_selected_manually;
         GNCImportTransInfo* txn_info = imported_txn->data;
         Account *importaccount = xaccSplitGetAccount (gnc_import_TransInfo_get_fsplit (txn_info));
-        match_struct s = {txn_info, display_threshold, fuzzy_amount};
+        GNCImportMatchIndex *index = g_hash_table_lookup (index_hash, importaccount);
 
-        g_slist_foreach (g_hash_table_lookup (account_hash, importaccount),
-                         (GFunc) match_helper, &s);
+        /* Index each account's potential matches the first time one of its
+         * imported transactions needs them. */
+        if (!index)
+        {
+            index = gnc_import_MatchIndex_new
+                (g_hash_table_lookup (account_hash, importaccount), fuzzy_amount);
+            g_hash_table_insert (index_hash, importaccount, index);
+        }
+        gnc_import_MatchIndex_find_matches (index, txn_info, display_threshold);
 
         // Sort the matches, select the best match, and set the action.
         gnc_import_TransInfo_init_matches (txn_info, gui->user_settings);
@@ -1853,6 +1885,7 @@ perform_matching (GNCImportMainMatcher *gui, GHashTable *account_hash)
         gtk_tree_store_append (GTK_TREE_STORE (model), &iter, NULL);
         refresh_model_row (gui, model, &iter, txn_info);
     }
+    g_hash_table_destroy (index_hash);
 }
 
 void
@@ -42,8 +42,10 @@
 #include "qof.h"
 #include "gnc-ui-util.h"
 #include "gnc-gui-query.h"
+#include "gnc-prefs.h"
 
 #define GNC_PREFS_GROUP "dialogs.log-replay"
+#define GNC_PREF_FAST_REPLAY "fast-replay"
 
 /* EFFECTIVE FRIEND FUNCTION */
 void qof_instance_set_guid (gpointer inst, const GncGUID *guid);
@@ -359,14 +361,115 @@ static void dump_split_record(split_record record)
     }
 }
 
-/* File pointer must already be at the beginning of a record */
-static void  process_trans_record(  FILE *log_file)
+/* Where the lines of the log come from: read from the file one at a time,
+ * or, in fast replay, split out of the whole file read at once. */
+typedef struct
 {
+    FILE *file;
     char read_buf[2048];
-    char *read_retval;
+    gchar *contents;
+    gchar *next;
+} LogReader;
+
+static char *
+log_reader_next_line (LogReader *reader)
+{
+    char *line, *end;
+
+    if (reader->file)
+        return fgets (reader->read_buf, sizeof (reader->read_buf), reader->file);
+
+    if (!reader->next || !*reader->next)
+        return NULL;
+    line = reader->next;
+    end = strchr (line, '\n');
+    if (end)
+    {
+        *end = '\0';
+        reader->next = end + 1;
+    }
+    else
+        reader->next = line + strlen (line);
+    return line;
+}
+
+/* In fast replay, a transaction stays open from its first record to the
+ * end of the log, so that all its records are applied to it and it's
+ * committed only once, in a single backend transaction with the events
+ * batched. */
+typedef struct
+{
+    Transaction *trans;
+    gchar *trans_ro;
+} ReplayTrans;
+
+typedef struct
+{
+    /* Transaction -> ReplayTrans */
+    GHashTable *open_trans;
+    /* ReplayTrans, in the order the transactions were opened */
+    GPtrArray *order;
+} ReplayBatch;
+
+static void
+finish_trans (Transaction *trans, gchar *trans_ro)
+{
+    xaccTransScrubCurrency(trans);
+    xaccTransSetReadOnly(trans, trans_ro);
+    xaccTransCommitEdit(trans);
+    g_free(trans_ro);
+}
+
+static void
+replay_batch_hold (ReplayBatch *batch, Transaction *trans, gchar *trans_ro)
+{
+    ReplayTrans *held = g_new (ReplayTrans, 1);
+
+    held->trans = trans;
+    held->trans_ro = trans_ro;
+    g_hash_table_insert (batch->open_trans, trans, held);
+    g_ptr_array_add (batch->order, held);
+}
+
+/* Commit trans now if it's held open, before it's deleted. */
+static void
+replay_batch_release (ReplayBatch *batch, Transaction *trans)
+{
+    ReplayTrans *held = g_hash_table_lookup (batch->open_trans, trans);
+
+    if (!held)
+        return;
+    g_hash_table_remove (batch->open_trans, trans);
+    finish_trans (held->trans, held->trans_ro);
+    held->trans = NULL;
+}
+
+static void
+replay_batch_finish (ReplayBatch *batch)
+{
+    guint i;
+
+    for (i = 0; i < batch->order->len; i++)
+    {
+        ReplayTrans *held = g_ptr_array_index (batch->order, i);
+        if (held->trans)
+            finish_trans (held->trans, held->trans_ro);
+        g_free (held);
+    }
+    g_ptr_array_free (batch->order, TRUE);
+    g_hash_table_destroy (batch->open_trans);
+}
+
+/* Reader must already be at the beginning of a record. The batch is NULL
+ * unless replaying fast. */
+static void  process_trans_record(  LogReader *reader, ReplayBatch *batch)
+{
+    char *read_buf;
     char * trans_ro = NULL;
     const char * record_end_str = "===== END";
     int first_record = TRUE;
+    int trans_held = FALSE;
+    int trans_deleted = FALSE;
     int record_ended = FALSE;
     int split_num = 0;
     split_record record;
@@ -379,15 +482,16 @@ static void  process_trans_record(  FILE *log_file)
 
     while ( record_ended == FALSE)
     {
-        read_retval = fgets(read_buf, sizeof(read_buf), log_file);
-        if (read_retval != NULL &&
+        read_buf = log_reader_next_line (reader);
+        if (read_buf != NULL &&
             strncmp(record_end_str, read_buf, strlen(record_end_str)) != 0) /* If we are not at the end of the record */
         {
             split_num++;
             /*DEBUG("process_trans_record(): Line read: %s%s",read_buf ,"\n");*/
 
             record = interpret_split_record(g_strchomp(read_buf));
-            dump_split_record( record);
+            if (qof_log_check (log_module, QOF_LOG_DEBUG))
+                dump_split_record( record);
             if (record.log_action_present)
             {
                 switch (record.log_action)
@@ -404,6 +508,8 @@ static void  process_trans_record(  FILE *log_file)
                             && first_record == TRUE)
                     {
                         first_record = FALSE;
+                        if (batch)
+                            replay_batch_release (batch, trans);
                         if (xaccTransGetReadOnly(trans))
                         {
                             PWARN("Destroying a read only transaction.");
@@ -411,13 +517,17 @@ static void  process_trans_record(  FILE *log_file)
                         }
                         xaccTransBeginEdit(trans);
                         xaccTransDestroy(trans);
+                        trans_deleted = TRUE;
                     }
                     else if (first_record == TRUE)
                     {
                         PERR("The transaction to delete was not found!");
                     }
                     else
+                    {
                         xaccTransDestroy(trans);
+                        trans_deleted = TRUE;
+                    }
                     break;
                 case LOG_COMMIT:
                     DEBUG("process_trans_record(): Playing back LOG_COMMIT");
@@ -425,7 +535,15 @@ static void  process_trans_record(  FILE *log_file)
                             && first_record == TRUE)
                     {
                         trans = xaccTransLookupDirect (record.trans_guid, book);
-                        if (trans != NULL)
+                        if (trans != NULL && batch &&
+                            g_hash_table_contains (batch->open_trans, trans))
+                        {
+                            /* Its read only reason was saved when it was
+                             * opened by an earlier record. */
+                            DEBUG("process_trans_record(): Transaction is still open");
+                            trans_held = TRUE;
+                        }
+                        else if (trans != NULL)
                         {
                             DEBUG("process_trans_record(): Transaction to be edited was found");
                             xaccTransBeginEdit(trans);
@@ -535,12 +653,12 @@ static void  process_trans_record(  FILE *log_file)
         {
             record_ended = TRUE;
             DEBUG("process_trans_record(): Record ended\n");
-            if (trans != NULL) /*If we played with a transaction, commit it here*/
+            if (trans != NULL && !trans_held) /*If we played with a transaction, commit it here*/
             {
-                xaccTransScrubCurrency(trans);
-                xaccTransSetReadOnly(trans, trans_ro);
-                xaccTransCommitEdit(trans);
-                g_free(trans_ro);
+                if (batch && !trans_deleted)
+                    replay_batch_hold (batch, trans, trans_ro);
+                else
+                    finish_trans (trans, trans_ro);
             }
         }
     }
@@ -550,10 +668,9 @@ void gnc_file_log_replay (GtkWindow *parent)
 {
     char *selected_filename;
     char *default_dir;
-    char read_buf[256];
     char *read_retval;
     GtkFileFilter *filter;
-    FILE *log_file;
+    gboolean fast;
     char * record_start_str = "===== START";
     /* NOTE: This string must match src/engine/TransLog.c (sans newline) */
     char * expected_header_orig = "mod\ttrans_guid\tsplit_guid\ttime_now\t"
@@ -571,6 +688,8 @@ void gnc_file_log_replay (GtkWindow *parent)
     /* Don't log the log replay. This would only result in redundant logs */
     xaccLogDisable();
 
+    fast = gnc_prefs_get_bool (GNC_PREFS_GROUP, GNC_PREF_FAST_REPLAY);
+
     default_dir = gnc_get_default_directory(GNC_PREFS_GROUP);
 
     filter = gtk_file_filter_new();
@@ -602,23 +721,51 @@ void gnc_file_log_replay (GtkWindow *parent)
         }
         else
         {
+            LogReader reader;
+            gboolean opened;
+
+            memset (&reader, 0, sizeof (reader));
             DEBUG("Opening selected file");
-            log_file = g_fopen(selected_filename, "r");
-            if (!log_file || ferror(log_file) != 0)
+            if (fast)
             {
-                int err = errno;
-                perror("File open failed");
-                /* Translators: First argument is the filename,
-                 * second argument is the error.
-                 */
-                gnc_error_dialog(NULL,
-                                 _("Failed to open log file: %s: %s"),
-                                 selected_filename,
-                                 strerror(err));
+                GError *error = NULL;
+
+                /* Read it all at once rather than line by line. */
+                opened = g_file_get_contents (selected_filename,
+                                              &reader.contents, NULL, &error);
+                if (!opened)
+                {
+                    /* Translators: First argument is the filename,
+                     * second argument is the error.
+                     */
+                    gnc_error_dialog(NULL,
+                                     _("Failed to open log file: %s: %s"),
+                                     selected_filename,
+                                     error->message);
+                    g_error_free (error);
+                }
+                reader.next = reader.contents;
             }
             else
             {
-                if ((read_retval = fgets(read_buf, sizeof(read_buf), log_file)) == NULL)
+                reader.file = g_fopen(selected_filename, "r");
+                opened = reader.file && ferror(reader.file) == 0;
+                if (!opened)
+                {
+                    int err = errno;
+                    perror("File open failed");
+                    /* Translators: First argument is the filename,
+                     * second argument is the error.
+                     */
+                    gnc_error_dialog(NULL,
+                                     _("Failed to open log file: %s: %s"),
+                                     selected_filename,
+                                     strerror(err));
+                }
+            }
+            if (opened)
+            {
+                if ((read_retval = log_reader_next_line (&reader)) == NULL)
                 {
                     DEBUG("Read error or EOF");
                     gnc_info_dialog(NULL, "%s",
@@ -626,9 +773,9 @@ void gnc_file_log_replay (GtkWindow *parent)
                 }
                 else
                 {
-                    if (strncmp(expected_header, read_buf, strlen(expected_header)) != 0)
+                    if (strncmp(expected_header, read_retval, strlen(expected_header)) != 0)
                     {
-                        PERR("File header not recognised:\n%s", read_buf);
+                        PERR("File header not recognised:\n%s", read_retval);
                         PERR("Expected:\n%s", expected_header);
                         gnc_error_dialog(NULL, "%s",
                                          _("The log file you selected cannot be read. "
@@ -636,20 +783,37 @@ void gnc_file_log_replay (GtkWindow *parent)
                     }
                     else
                     {
-                        do
+                        QofBook *book = gnc_get_current_book();
+                        ReplayBatch batch;
+
+                        if (fast)
+                        {
+                            qof_event_begin_batch ();
+                            qof_book_begin_batch (book);
+                            batch.open_trans = g_hash_table_new (g_direct_hash,
+                                                                 g_direct_equal);
+                            batch.order = g_ptr_array_new ();
+                        }
+                        while ((read_retval = log_reader_next_line (&reader)) != NULL)
                         {
-                            read_retval = fgets(read_buf, sizeof(read_buf), log_file);
                             /*DEBUG("Chunk read: %s",read_retval);*/
-                            if (read_retval && strncmp(record_start_str, read_buf, strlen(record_start_str)) == 0) /* If a record started */
+                            if (strncmp(record_start_str, read_retval, strlen(record_start_str)) == 0) /* If a record started */
                             {
-                                process_trans_record(log_file);
+                                process_trans_record(&reader, fast ? &batch : NULL);
                             }
                         }
-                        while (feof(log_file) == 0);
+                        if (fast)
+                        {
+                            replay_batch_finish (&batch);
+                            qof_book_end_batch (book);
+                            qof_event_end_batch ();
+                        }
                     }
                 }
-                fclose(log_file);
             }
+            if (reader.file)
+                fclose(reader.file);
+            g_free (reader.contents);
         }
         g_free(selected_filename);
     }
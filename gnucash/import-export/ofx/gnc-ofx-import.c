@@ -76,6 +76,13 @@ typedef struct _ofx_info
     struct OfxStatementData* statement;     // Statement, if any
     gboolean run_reconcile;                 // If TRUE the reconcile window is opened after matching.
     GSList* file_list;                      // List of OFX files to import
+    /* What the transactions of the file being imported resolved to, so
+     * that each account, security and income account is looked up once
+     * instead of for every transaction. */
+    GHashTable* accounts;                   // Online ID -> Account
+    GHashTable* investment_accounts;        // Online ID -> stock Account
+    GHashTable* commodities;                // Security ID -> gnc_commodity
+    GHashTable* income_accounts;            // stock Account -> income Account
 } ofx_info ;
 
 /*
@@ -119,6 +126,51 @@ set_associated_income_account(Account* investment_account,
     xaccAccountCommitEdit(investment_account);
 }
 
+static void
+ofx_info_reset_lookups (ofx_info* info)
+{
+    g_hash_table_remove_all (info->accounts);
+    g_hash_table_remove_all (info->investment_accounts);
+    g_hash_table_remove_all (info->commodities);
+    g_hash_table_remove_all (info->income_accounts);
+}
+
+/* Look up the account for an online ID through the matcher only the
+ * first time it's seen.  IDs without an account aren't remembered, so
+ * one given an account in the meantime is still found. */
+static Account*
+ofx_select_account (ofx_info* info, const gchar* online_id)
+{
+    Account *account = g_hash_table_lookup (info->accounts, online_id);
+
+    if (!account)
+    {
+        account = gnc_import_select_account(gnc_gen_trans_list_widget(info->gnc_ofx_importer_gui),
+                                            online_id,
+                                            0, NULL, NULL, ACCT_TYPE_NONE,
+                                            info->last_import_account, NULL);
+        if (account)
+            g_hash_table_insert (info->accounts, g_strdup (online_id), account);
+    }
+    return account;
+}
+
+static gnc_commodity*
+ofx_select_commodity (ofx_info* info, const gchar* unique_id)
+{
+    gnc_commodity *commodity = g_hash_table_lookup (info->commodities,
+                                                    unique_id);
+
+    if (!commodity)
+    {
+        commodity = gnc_import_select_commodity(unique_id, FALSE, NULL, NULL);
+        if (commodity)
+            g_hash_table_insert (info->commodities, g_strdup (unique_id),
+                                 commodity);
+    }
+    return commodity;
+}
+
 int ofx_proc_statement_cb (struct OfxStatementData data, void * statement_user_data);
 int ofx_proc_security_cb (const struct OfxSecurityData data, void * security_user_data);
 int ofx_proc_transaction_cb (struct OfxTransactionData data, void *user_data);
@@ -431,10 +483,7 @@ int ofx_proc_transaction_cb(struct OfxTransactionData data, void *user_data)
     else
 	gnc_utf8_strip_invalid (data.account_id);
 
-    account = gnc_import_select_account(gnc_gen_trans_list_widget(info->gnc_ofx_importer_gui),
-                                        data.account_id,
-					0, NULL, NULL, ACCT_TYPE_NONE,
-					info->last_import_account, NULL);
+    account = ofx_select_account (info, data.account_id);
     if (account == NULL)
     {
         PERR("Unable to find account for id %s", data.account_id);
@@ -628,10 +677,7 @@ int ofx_proc_transaction_cb(struct OfxTransactionData data, void *user_data)
                data.invtranstype*/
 
             // We have an investment transaction. First select the correct commodity.
-            investment_commodity = gnc_import_select_commodity(data.unique_id,
-                                   FALSE,
-                                   NULL,
-                                   NULL);
+            investment_commodity = ofx_select_commodity (info, data.unique_id);
             if (investment_commodity != NULL)
             {
                 // As we now have the commodity, select the account with that commodity.
@@ -646,15 +692,18 @@ int ofx_proc_transaction_cb(struct OfxTransactionData data, void *user_data)
                 investment_account_onlineid = g_strdup_printf( "%s%s",
 							       data.account_id,
 							       data.unique_id);
-                investment_account = gnc_import_select_account(
-                                     gnc_gen_trans_list_widget(info->gnc_ofx_importer_gui),
-                                     investment_account_onlineid,
-                                     1,
-                                     investment_account_text,
-                                     investment_commodity,
-                                     ACCT_TYPE_STOCK,
-                                     info->last_investment_account,
-                                     NULL);
+                investment_account = g_hash_table_lookup (info->investment_accounts,
+                                                          investment_account_onlineid);
+                if (!investment_account)
+                    investment_account = gnc_import_select_account(
+                                         gnc_gen_trans_list_widget(info->gnc_ofx_importer_gui),
+                                         investment_account_onlineid,
+                                         1,
+                                         investment_account_text,
+                                         investment_commodity,
+                                         ACCT_TYPE_STOCK,
+                                         info->last_investment_account,
+                                         NULL);
                 if (investment_account)
                     info->last_investment_account = investment_account;
 
@@ -744,6 +793,14 @@ int ofx_proc_transaction_cb(struct OfxTransactionData data, void *user_data)
                 {
                     PERR("No investment account found for text: %s\n", investment_account_text);
                 }
+                else
+                {
+                    /* The table takes the online ID. */
+                    g_hash_table_replace (info->investment_accounts,
+                                          investment_account_onlineid,
+                                          investment_account);
+                    investment_account_onlineid = NULL;
+                }
                 g_free (investment_account_text);
                 g_free (investment_account_onlineid);
                 investment_account_text = NULL;
@@ -803,8 +860,11 @@ int ofx_proc_transaction_cb(struct OfxTransactionData data, void *user_data)
                 {
                     DEBUG("Now let's find an account for the destination split");
 
-                    income_account =
-                        get_associated_income_account(investment_account);
+                    income_account = g_hash_table_lookup (info->income_accounts,
+                                                          investment_account);
+                    if (income_account == NULL)
+                        income_account =
+                            get_associated_income_account(investment_account);
 
                     if (income_account == NULL)
                     {
@@ -837,6 +897,10 @@ int ofx_proc_transaction_cb(struct OfxTransactionData data, void *user_data)
                     {
                         DEBUG("Found at least one associated income account");
                     }
+                    if (income_account != NULL)
+                        g_hash_table_insert (info->income_accounts,
+                                             investment_account,
+                                             income_account);
                 }
                 if (income_account != NULL &&
                         data.invtransactiontype == OFX_REINVEST)
@@ -1080,6 +1144,10 @@ gnc_ofx_process_next_file (GtkDialog *dialog, gpointer user_data)
     else
     {
         // Final cleanup.
+        g_hash_table_destroy (info->accounts);
+        g_hash_table_destroy (info->investment_accounts);
+        g_hash_table_destroy (info->commodities);
+        g_hash_table_destroy (info->income_accounts);
         g_free (info);
     }
 }
@@ -1154,6 +1222,7 @@ gnc_file_ofx_import_process_file (ofx_info* info)
     // Reset the reconciliation information.
     info->num_trans_processed = 0;
     info->statement = NULL;
+    ofx_info_reset_lookups (info);
 
     /* Initialize libofx and set the callbacks*/
     ofx_set_statement_cb (libofx_context, ofx_proc_statement_cb, info);
@@ -1258,6 +1327,15 @@ void gnc_file_ofx_import (GtkWindow *parent)
         info->parent = parent;
         info->run_reconcile = FALSE;
         info->file_list = selected_filenames;
+        info->accounts = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                                g_free, NULL);
+        info->investment_accounts = g_hash_table_new_full (g_str_hash,
+                                                           g_str_equal,
+                                                           g_free, NULL);
+        info->commodities = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                                   g_free, NULL);
+        info->income_accounts = g_hash_table_new (g_direct_hash,
+                                                  g_direct_equal);
         // Call the aux import function.
         gnc_file_ofx_import_process_file (info);
     }
@@ -170,3 +170,24 @@ TEST_F(ImportMatcherTest, test_subaccount_match_internal_space)
     ASSERT_NE(nullptr, found);
     EXPECT_STREQ("Cash Management", xaccAccountGetName(found));
 }
+
+TEST_F(ImportMatcherTest, test_match_after_online_id_change)
+{
+    auto bank = gnc_import_select_account(nullptr, "Bank", FALSE, nullptr,
+                                          nullptr, ACCT_TYPE_NONE, nullptr,
+                                          nullptr);
+    ASSERT_NE(nullptr, bank);
+    xaccAccountBeginEdit(bank);
+    qof_instance_set(QOF_INSTANCE(bank), "online-id", "Checking", NULL);
+    qof_instance_set_dirty(QOF_INSTANCE(bank));
+    xaccAccountCommitEdit(bank);
+
+    auto found = gnc_import_select_account(nullptr, "Checking", FALSE, nullptr,
+                                           nullptr, ACCT_TYPE_NONE, nullptr,
+                                           nullptr);
+    EXPECT_EQ(bank, found);
+    found = gnc_import_select_account(nullptr, "Bank", FALSE, nullptr,
+                                      nullptr, ACCT_TYPE_BANK, nullptr,
+                                      nullptr);
+    EXPECT_EQ(nullptr, found);
+}
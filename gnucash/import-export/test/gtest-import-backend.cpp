@@ -61,6 +61,61 @@ qof_log_prettify (const char *name)
     return name;
 }
 
+// fake functions from qofevent.cpp, for the online_id index
+gint
+qof_event_register_filtered_handler (QofIdTypeConst type, QofEventId event_mask,
+                                     QofEventHandler handler, gpointer handler_data)
+{
+    return 1;
+}
+
+void
+qof_event_unregister_handler (gint handler_id)
+{
+}
+
+guint
+qof_event_get_dropped_count (void)
+{
+    return 0;
+}
+
+// fake functions from qofbook.cpp and qofid.cpp
+// there's only the one book, so a single slot of book data will do
+static gpointer fake_book_data = nullptr;
+
+gpointer
+qof_book_get_data (const QofBook *book, const gchar *key)
+{
+    return fake_book_data;
+}
+
+void
+qof_book_set_data_fin (QofBook *book, const gchar *key, gpointer data,
+                       QofBookFinalCB cb)
+{
+    fake_book_data = data;
+}
+
+QofCollection *
+qof_book_get_collection (const QofBook *book, QofIdType entity_type)
+{
+    return nullptr;
+}
+
+void
+qof_collection_foreach (const QofCollection *col, QofInstanceForeachCB cb,
+                        gpointer user_data)
+{
+}
+
+// fake function from qofinstance.cpp
+QofBook *
+qof_instance_get_book (gconstpointer inst)
+{
+    return gnc_get_current_book ();
+}
+
 // fake function from engine-helpers.c
 // this is a slightly modified version of the original function
 const char *
@@ -31,7 +31,8 @@
 (use-modules (gnucash app-utils))
 (use-modules (gnucash gnome-utils))
 (use-modules (srfi srfi-11)
-             (srfi srfi-1))
+             (srfi srfi-1)
+             (srfi srfi-9))
 
 ;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
 
@@ -77,6 +78,71 @@
 (define gnc:*finance-quote-helper*
   (string-append (gnc-path-get-bindir) "/gnc-fq-helper"))
 
+;; The helpers are kept running between "Get Quotes" runs so perl and
+;; Finance::Quote are only loaded once; each one reads requests until its
+;; stdin is closed.  Requests for different quote sources go to different
+;; helpers so the sources are fetched concurrently.
+(define fq-helper-pool-size 4)
+(define fq-helpers '())
+
+(define-record-type <fq-helper>
+  (make-fq-helper process inport errport outport)
+  fq-helper?
+  (process fq-helper-process)
+  (inport fq-helper-inport)
+  (errport fq-helper-errport)
+  (outport fq-helper-outport))
+
+(define (fq-helper-start)
+  (let ((process (gnc-spawn-process-async
+                  (list "perl" "-w" gnc:*finance-quote-helper*) #t)))
+    (and process
+         (make-fq-helper process
+                         (fdes->inport (gnc-process-get-fd process 1))
+                         (fdes->inport (gnc-process-get-fd process 2))
+                         (fdes->outport (gnc-process-get-fd process 0))))))
+
+(define (fq-helper-stop! helper)
+  (set! fq-helpers (delete helper fq-helpers eq?))
+  (gnc-detach-process (fq-helper-process helper) #t))
+
+(define (fq-helper-drain-stderr helper)
+  ;; perl's warnings would eventually fill the pipe and stall a helper
+  ;; that is never restarted, so read them while results are awaited.
+  (let ((port (fq-helper-errport helper)))
+    (let lp ((chars '()))
+      (if (and (char-ready? port) (not (eof-object? (peek-char port))))
+          (lp (cons (read-char port) chars))
+          (unless (null? chars)
+            (gnc:debug "gnc-fq-helper: " (reverse-list->string chars)))))))
+
+(define (fq-helpers-ensure! n)
+  ;; forget helpers that exited since the last run
+  (for-each fq-helper-stop!
+            (remove (lambda (helper)
+                      (gnc-process-is-alive (fq-helper-process helper)))
+                    fq-helpers))
+  (let lp ((missing (- (min n fq-helper-pool-size) (length fq-helpers))))
+    (when (positive? missing)
+      (let ((helper (fq-helper-start)))
+        (when helper
+          (set! fq-helpers (append fq-helpers (list helper)))
+          (lp (1- missing))))))
+  fq-helpers)
+
+(define (fq-helper-send helper request)
+  ;; we need to display the first element (the method, so it won't be
+  ;; quoted) and then write the rest
+  (with-output-to-port (fq-helper-outport helper)
+    (lambda ()
+      (display #\()
+      (display (car request))
+      (display " ")
+      (for-each write (cdr request))
+      (display #\))
+      (newline)
+      (force-output))))
+
 (define (gnc:fq-get-quotes requests)
   ;; requests should be a list where each item is of the form
   ;;
@@ -114,47 +180,116 @@
   ;; 'failed-conversion if the Finance::Quote result for that field
   ;; was unparsable.  See the gnc-fq-helper for more details
   ;; about it's output.
-
-  (let ((quoter #f))
-
-    (define (start-quoter)
-      (set! quoter
-        (gnc-spawn-process-async (list "perl" "-w" gnc:*finance-quote-helper*) #t)))
-
-    (define (get-quotes)
-      (when quoter
-        (map
-         (lambda (request)
-           (catch #t
-             (lambda ()
-               (gnc:debug "handling-request: " request)
-               (and (member (car request) '("currency" "alphavantage" "vanguard"))
-                    (not (getenv "ALPHAVANTAGE_API_KEY"))
-                    (throw 'need-alphavantage-key))
-               ;; we need to display the first element (the method,
-               ;; so it won't be quoted) and then write the rest
-               (with-output-to-port (fdes->outport (gnc-process-get-fd quoter 0))
-                 (lambda ()
-                   (display #\()
-                   (display (car request))
-                   (display " ")
-                   (for-each write (cdr request))
-                   (display #\))
-                   (newline)
-                   (force-output)))
-
-               (let ((results (read (fdes->inport (gnc-process-get-fd quoter 1)))))
-                 (gnc:debug "results: " results)
-                 results))
-             (lambda (key . args) key)))
-         requests)))
-
-    (define (kill-quoter)
-      (when quoter
-        (gnc-detach-process quoter #t)
-        (set! quoter #f)))
-
-    (dynamic-wind start-quoter get-quotes kill-quoter)))
+  ;;
+  ;; Each quote source is handled by one helper from the pool and the
+  ;; results are read as they arrive, reporting progress as each source
+  ;; completes.
+
+  (let* ((results (make-vector (length requests) #f))
+         (sources (delete-duplicates (map car requests)))
+         (remaining (map (lambda (source)
+                           (cons source (count (lambda (r) (equal? (car r) source))
+                                               requests)))
+                         sources))
+         (n-sources (length sources))
+         (n-done 0)
+         (queues '()))
+
+    (define (source-finished! source)
+      (let ((entry (assoc source remaining)))
+        (set-cdr! entry (1- (cdr entry)))
+        (when (zero? (cdr entry))
+          (set! n-done (1+ n-done))
+          (gnc:debug "quotes from " source " done")
+          (gnc-window-show-progress
+           (format #f (G_ "Retrieved quotes from ~a") source)
+           (* 100 (/ n-done n-sources))))))
+
+    (define (finish! index value)
+      (vector-set! results index value)
+      (source-finished! (car (list-ref requests index))))
+
+    (define (queue-request! helper index)
+      (let ((entry (assq helper queues)))
+        (if entry
+            (set-cdr! entry (append (cdr entry) (list index)))
+            (set! queues (append queues (list (list helper index)))))))
+
+    (define (dispatch! helpers)
+      ;; Hand each source's requests to one helper, sources in turn.
+      (let ((source->helper
+             (map cons sources
+                  (map (lambda (i) (list-ref helpers (modulo i (length helpers))))
+                       (iota n-sources)))))
+        (let lp ((requests requests) (index 0))
+          (unless (null? requests)
+            (let ((request (car requests)))
+              (gnc:debug "handling-request: " request)
+              (if (and (member (car request) '("currency" "alphavantage" "vanguard"))
+                       (not (getenv "ALPHAVANTAGE_API_KEY")))
+                  (finish! index 'need-alphavantage-key)
+                  (let ((helper (assoc-ref source->helper (car request))))
+                    (catch #t
+                      (lambda ()
+                        (fq-helper-send helper request)
+                        (queue-request! helper index))
+                      (lambda (key . args)
+                        (finish! index key)))))
+              (lp (cdr requests) (1+ index)))))))
+
+    (define (fail-queue! entry key)
+      (for-each (lambda (index) (finish! index key)) (cdr entry))
+      (set! queues (delete entry queues eq?))
+      (fq-helper-stop! (car entry)))
+
+    (define (read-result! entry)
+      (let* ((helper (car entry))
+             (result (catch #t
+                       (lambda () (read (fq-helper-inport helper)))
+                       (lambda (key . args) key))))
+        (gnc:debug "results: " result)
+        (cond
+         ;; the helper died (e.g. after reporting missing-lib); whatever
+         ;; it still owed us is lost.
+         ((eof-object? result)
+          (fail-queue! entry 'system-error))
+         (else
+          (finish! (cadr entry) result)
+          (set-cdr! entry (cddr entry))
+          (when (null? (cdr entry))
+            (set! queues (delete entry queues eq?)))))))
+
+    (define (collect!)
+      (let lp ()
+        (unless (null? queues)
+          (let* ((inports (map (lambda (entry) (fq-helper-inport (car entry)))
+                               queues))
+                 (errports (map (lambda (entry) (fq-helper-errport (car entry)))
+                                queues))
+                 (ready (catch #t
+                          (lambda ()
+                            (car (select (append inports errports) '() '())))
+                          (lambda (key . args) inports))))
+            (for-each
+             (lambda (port)
+               (let ((entry (find (lambda (e) (eq? (fq-helper-inport (car e)) port))
+                                  queues))
+                     (errentry (find (lambda (e) (eq? (fq-helper-errport (car e)) port))
+                                     queues)))
+                 (cond
+                  (entry (read-result! entry))
+                  (errentry (fq-helper-drain-stderr (car errentry))))))
+             ready)
+            (lp)))))
+
+    (let ((helpers (fq-helpers-ensure! n-sources)))
+      (and (pair? helpers)
+           (begin
+             (gnc-window-show-progress (G_ "Retrieving quotes...") 0)
+             (dispatch! helpers)
+             (collect!)
+             (gnc-window-show-progress "" -1)
+             (vector->list results))))))
 
 (define (gnc:book-add-quotes window book)
 
@@ -394,13 +529,12 @@
       ))
 
   (define (book-add-prices! book prices)
-    (let ((pricedb (gnc-pricedb-get-db book)))
-      (for-each
-       (lambda (price)
-         (when price
-           (gnc-pricedb-add-price pricedb price)
-           (gnc-price-unref price)))
-       prices)))
+    ;; one batch insert, so the price db is committed and announces the
+    ;; change once however many quotes came back.
+    (let ((pricedb (gnc-pricedb-get-db book))
+          (prices (filter identity prices)))
+      (gnc-pricedb-add-price-list pricedb prices)
+      (for-each gnc-price-unref prices)))
 
   (define (show-error msg)
     (gnc:gui-error msg (G_ msg)))
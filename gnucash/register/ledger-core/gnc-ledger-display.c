@@ -74,6 +74,9 @@ struct gnc_ledger_display
     gint number_of_subaccounts;
 
     gint component_id;
+
+    /* The GUIDs of the splits of the last load, in their order. */
+    GArray* loaded_splits;
 };
 
 
@@ -546,6 +549,80 @@ gnc_ledger_display_set_watches (GNCLedgerDisplay* ld, GList* splits)
     }
 }
 
+static void
+record_loaded_splits (GNCLedgerDisplay* ld, GList* splits)
+{
+    GList* node;
+
+    if (!ld->loaded_splits)
+        ld->loaded_splits = g_array_new (FALSE, FALSE, sizeof (GncGUID));
+
+    g_array_set_size (ld->loaded_splits, 0);
+    for (node = splits; node; node = node->next)
+        g_array_append_val (ld->loaded_splits,
+                            *xaccSplitGetGUID (node->data));
+}
+
+static gboolean
+same_as_loaded_splits (GNCLedgerDisplay* ld, GList* splits)
+{
+    GList* node;
+    guint i = 0;
+
+    if (!ld->loaded_splits)
+        return FALSE;
+
+    for (node = splits; node; node = node->next, i++)
+    {
+        if (i >= ld->loaded_splits->len ||
+            !guid_equal (&g_array_index (ld->loaded_splits, GncGUID, i),
+                         xaccSplitGetGUID (node->data)))
+            return FALSE;
+    }
+    return i == ld->loaded_splits->len;
+}
+
+/* When the query still finds the splits of the last load, in the same
+ * order, the register can usually bring the changed transactions up to
+ * date in place instead of being loaded again. */
+static gboolean
+refresh_changed (GNCLedgerDisplay* ld, GHashTable* changes, GList* splits)
+{
+    GHashTable* changed;
+    GHashTableIter iter;
+    gpointer key;
+    QofBook* book = gnc_get_current_book ();
+    gboolean done;
+
+    if (!gnc_split_register_full_refresh_ok (ld->reg))
+        return FALSE;
+
+    if (!same_as_loaded_splits (ld, splits))
+        return FALSE;
+
+    /* The changes are keyed by GncGUID alone, so find out what each one is.
+     * Destroyed entities can't be looked up, but a destroyed split is
+     * missing from the query's result anyway. */
+    changed = g_hash_table_new (g_direct_hash, g_direct_equal);
+    g_hash_table_iter_init (&iter, changes);
+    while (g_hash_table_iter_next (&iter, &key, NULL))
+    {
+        Transaction* trans = xaccTransLookup (key, book);
+
+        if (!trans)
+            trans = xaccSplitGetParent (xaccSplitLookup (key, book));
+        if (trans)
+            g_hash_table_add (changed, trans);
+    }
+
+    ld->loading = TRUE;
+    done = gnc_split_register_refresh_changed (ld->reg, changed);
+    ld->loading = FALSE;
+
+    g_hash_table_destroy (changed);
+    return done;
+}
+
 static void
 refresh_handler (GHashTable* changes, gpointer user_data)
 {
@@ -608,6 +685,12 @@ refresh_handler (GHashTable* changes, gpointer user_data)
      */
     splits = qof_query_run (ld->query);
 
+    if (changes && refresh_changed (ld, changes, splits))
+    {
+        LEAVE ("updated in place");
+        return;
+    }
+
     gnc_ledger_display_set_watches (ld, splits);
 
     gnc_ledger_display_refresh_internal (ld, splits);
@@ -634,6 +717,9 @@ close_handler (gpointer user_data)
     qof_query_destroy (ld->query);
     ld->query = NULL;
 
+    if (ld->loaded_splits)
+        g_array_free (ld->loaded_splits, TRUE);
+
     g_free (ld);
 }
 
@@ -799,6 +885,7 @@ gnc_ledger_display_internal (Account* lead_account, Query* q,
     ld->destroy = NULL;
     ld->get_parent = NULL;
     ld->user_data = NULL;
+    ld->loaded_splits = NULL;
 
     limit = gnc_prefs_get_float (GNC_PREFS_GROUP_GENERAL_REGISTER,
                                  GNC_PREF_MAX_TRANS);
@@ -871,6 +958,7 @@ gnc_ledger_display_refresh_internal (GNCLedgerDisplay* ld, GList* splits)
 
     gnc_split_register_load (ld->reg, splits,
                              gnc_ledger_display_leader (ld));
+    record_loaded_splits (ld, splits);
 
     ld->loading = FALSE;
 }
@@ -30,6 +30,7 @@
 #include "combocell.h"
 #include "gnc-component-manager.h"
 #include "gnc-prefs.h"
+#include "gnc-transaction-quickfill.h"
 #include "gnc-ui.h"
 #include "gnc-warnings.h"
 #include "pricecell.h"
@@ -394,6 +395,10 @@ gnc_split_register_move_cursor (VirtualLocation *p_new_virt_loc,
         return;
     }
 
+    /* The user is moving to a row to edit it, so the completions from
+     * the rest of the book are needed now. */
+    gnc_flush_shared_transaction_quickfills (gnc_get_current_book ());
+
     info = gnc_split_register_get_info (reg);
 
     /* The transaction we are coming from */
@@ -40,6 +40,7 @@
 #include "split-register-p.h"
 #include "engine-helpers.h"
 #include "gnc-prefs.h"
+#include "gnc-transaction-quickfill.h"
 #include "pricecell.h"
 
 
@@ -235,32 +236,25 @@ _find_split_with_parent_txn (gconstpointer a, gconstpointer b)
     return xaccSplitGetParent (split) == txn ? 0 : 1;
 }
 
-static void add_quickfill_completions (TableLayout* layout, Transaction* trans,
-                                       Split* split, gboolean has_last_num)
+/* The description, notes and memo cells complete from the strings of
+ * the whole book, which all the registers share. */
+static void
+gnc_split_register_load_quickfill_cells (SplitRegister* reg)
 {
-    Split* s;
-    int i = 0;
-
-    gnc_quickfill_cell_add_completion (
-        (QuickFillCell*) gnc_table_layout_get_cell (layout, DESC_CELL),
-        xaccTransGetDescription (trans));
-
-    gnc_quickfill_cell_add_completion (
-        (QuickFillCell*) gnc_table_layout_get_cell (layout, NOTES_CELL),
-        xaccTransGetNotes (trans));
-
-    if (!has_last_num)
-        gnc_num_cell_set_last_num (
-            (NumCell*) gnc_table_layout_get_cell (layout, NUM_CELL),
-            gnc_get_num_action (trans, split));
-
-    while ((s = xaccTransGetSplit (trans, i)) != NULL)
-    {
-        gnc_quickfill_cell_add_completion (
-            (QuickFillCell*) gnc_table_layout_get_cell (layout, MEMO_CELL),
-            xaccSplitGetMemo (s));
-        i++;
-    }
+    QofBook* book = gnc_get_current_book();
+
+    gnc_quickfill_cell_use_quickfill_cache (
+        (QuickFillCell*) gnc_table_layout_get_cell (reg->table->layout,
+                                                    DESC_CELL),
+        gnc_get_shared_trans_desc_quickfill (book));
+    gnc_quickfill_cell_use_quickfill_cache (
+        (QuickFillCell*) gnc_table_layout_get_cell (reg->table->layout,
+                                                    NOTES_CELL),
+        gnc_get_shared_trans_notes_quickfill (book));
+    gnc_quickfill_cell_use_quickfill_cache (
+        (QuickFillCell*) gnc_table_layout_get_cell (reg->table->layout,
+                                                    MEMO_CELL),
+        gnc_get_shared_trans_memo_quickfill (book));
 }
 
 static Split*
@@ -392,6 +386,7 @@ gnc_split_register_load (SplitRegister* reg, GList* slist,
     int new_trans_row = -1;
     int new_split_row = -1;
     time64 present, autoreadonly_time = 0;
+    gint64 trace_start;
 
     g_return_if_fail (reg);
     table = reg->table;
@@ -400,6 +395,7 @@ gnc_split_register_load (SplitRegister* reg, GList* slist,
     g_return_if_fail (info);
 
     ENTER ("reg=%p, slist=%p, default_account=%p", reg, slist, default_account);
+    trace_start = qof_trace_now ();
 
     blank_split = xaccSplitLookup (&info->blank_split_guid,
                                    gnc_get_current_book());
@@ -503,6 +499,8 @@ gnc_split_register_load (SplitRegister* reg, GList* slist,
 
     if (info->first_pass)
     {
+        gnc_split_register_load_quickfill_cells (reg);
+
         if (default_account)
         {
             const char* last_num = xaccAccountGetLastNum (default_account);
@@ -648,10 +646,13 @@ gnc_split_register_load (SplitRegister* reg, GList* slist,
             }
         }
 
-        /* If this is the first load of the register,
-         * fill up the quickfill cells. */
-        if (info->first_pass)
-            add_quickfill_completions (reg->table->layout, trans, split, has_last_num);
+        /* If this is the first load of the register, the last num is
+         * that of the latest transaction. */
+        if (info->first_pass && !has_last_num)
+            gnc_num_cell_set_last_num (
+                (NumCell*) gnc_table_layout_get_cell (table->layout,
+                                                      NUM_CELL),
+                gnc_get_num_action (trans, split));
 
         if (trans == find_trans)
             new_trans_row = vcell_loc.virt_row;
@@ -793,12 +794,168 @@ gnc_split_register_load (SplitRegister* reg, GList* slist,
     /* enable callback for cursor user-driven moves */
     gnc_table_control_allow_move (table->control, TRUE);
 
+    if (trace_start)
+    {
+        gchar* detail = g_strdup_printf ("%u splits, %d rows",
+                                         g_list_length (slist),
+                                         table->num_virt_rows);
+        qof_trace_span ("register", "gnc_split_register_load", trace_start,
+                        detail);
+        g_free (detail);
+    }
+
     if (we_own_slist)
         g_list_free (slist);
 
     LEAVE (" ");
 }
 
+/* Check that the rows following the leading row of trans at lead_loc are
+ * still one for each of its splits, in order, and the empty split row, as
+ * gnc_split_register_add_transaction made them. */
+static gboolean
+trans_rows_match (SplitRegister* reg, Transaction* trans,
+                  VirtualCellLocation lead_loc)
+{
+    Table* table = reg->table;
+    VirtualCellLocation vcell_loc = lead_loc;
+    GncGUID* guid;
+    GList* node;
+
+    vcell_loc.virt_row++;
+    for (node = xaccTransGetSplitList (trans); node; node = node->next)
+    {
+        Split* secondary = node->data;
+
+        if (!xaccTransStillHasSplit (trans, secondary)) continue;
+
+        if (gnc_split_register_get_cursor_class (reg, vcell_loc) !=
+            CURSOR_CLASS_SPLIT)
+            return FALSE;
+
+        guid = gnc_table_get_vcell_data (table, vcell_loc);
+        if (!guid || !guid_equal (guid, xaccSplitGetGUID (secondary)))
+            return FALSE;
+
+        vcell_loc.virt_row++;
+    }
+
+    if (gnc_split_register_get_cursor_class (reg, vcell_loc) !=
+        CURSOR_CLASS_SPLIT)
+        return FALSE;
+
+    guid = gnc_table_get_vcell_data (table, vcell_loc);
+    if (!guid || !guid_equal (guid, guid_null()))
+        return FALSE;
+
+    vcell_loc.virt_row++;
+    return (vcell_loc.virt_row >= table->num_virt_rows ||
+            gnc_split_register_get_cursor_class (reg, vcell_loc) ==
+            CURSOR_CLASS_TRANS);
+}
+
+gboolean
+gnc_split_register_refresh_changed (SplitRegister* reg, GHashTable* changed)
+{
+    SRInfo* info;
+    Table* table;
+    Transaction* blank_trans;
+    Transaction* pending_trans;
+    VirtualCellLocation vcell_loc;
+    gboolean use_autoreadonly;
+    time64 present, autoreadonly_time = 0;
+
+    g_return_val_if_fail (reg, FALSE);
+    g_return_val_if_fail (changed, FALSE);
+    table = reg->table;
+    g_return_val_if_fail (table, FALSE);
+    info = gnc_split_register_get_info (reg);
+
+    ENTER ("reg=%p, %u changed transactions", reg, g_hash_table_size (changed));
+
+    if (info->first_pass)
+    {
+        LEAVE ("not loaded yet");
+        return FALSE;
+    }
+
+    /* The transactions the register itself holds open or under the
+     * cursor are set up by the load. */
+    blank_trans = xaccSplitGetParent (gnc_split_register_get_blank_split (reg));
+    pending_trans = xaccTransLookup (&info->pending_trans_guid,
+                                     gnc_get_current_book());
+    if ((blank_trans && g_hash_table_contains (changed, blank_trans)) ||
+        (pending_trans && g_hash_table_contains (changed, pending_trans)))
+    {
+        LEAVE ("blank or pending transaction changed");
+        return FALSE;
+    }
+    if (g_hash_table_contains (changed,
+                               gnc_split_register_get_current_trans (reg)))
+    {
+        LEAVE ("current transaction changed");
+        return FALSE;
+    }
+
+    present = gnc_time64_get_today_end();
+    use_autoreadonly = qof_book_uses_autoreadonly (gnc_get_current_book());
+    if (use_autoreadonly)
+    {
+        GDate* d = qof_book_get_autoreadonly_gdate (gnc_get_current_book());
+        autoreadonly_time = d ? gdate_to_time64 (*d) : 0;
+        g_date_free (d);
+    }
+
+    vcell_loc.virt_col = 0;
+    for (vcell_loc.virt_row = 1; vcell_loc.virt_row < table->num_virt_rows;
+         vcell_loc.virt_row++)
+    {
+        Transaction* trans;
+        Split* split;
+        time64 date;
+
+        if (gnc_split_register_get_cursor_class (reg, vcell_loc) !=
+            CURSOR_CLASS_TRANS)
+            continue;
+
+        split = gnc_split_register_get_split (reg, vcell_loc);
+        trans = xaccSplitGetParent (split);
+        if (!trans || !g_hash_table_contains (changed, trans))
+            continue;
+
+        if (!trans_rows_match (reg, trans, vcell_loc))
+        {
+            LEAVE ("splits of %p changed", trans);
+            return FALSE;
+        }
+
+        /* A changed date that crosses a divider moves the divider. */
+        date = xaccTransGetDate (trans);
+        if (info->show_present_divider &&
+            (date > present) != (table->model->dividing_row >= 0 &&
+                                 vcell_loc.virt_row >= table->model->dividing_row))
+        {
+            LEAVE ("%p crossed the present", trans);
+            return FALSE;
+        }
+        if (info->show_present_divider && use_autoreadonly &&
+            table->model->dividing_row_upper >= 0 &&
+            (date >= autoreadonly_time) !=
+            (vcell_loc.virt_row >= table->model->dividing_row_upper))
+        {
+            LEAVE ("%p crossed the read-only threshold", trans);
+            return FALSE;
+        }
+    }
+
+    /* The rows are as the load left them, and their contents, running
+     * balances included, are read from the engine as they are drawn. */
+    gnc_table_refresh_gui (table, FALSE);
+
+    LEAVE (" ");
+    return TRUE;
+}
+
 /* ===================================================================== */
 
 #define QKEY  "split_reg_shared_quickfill"
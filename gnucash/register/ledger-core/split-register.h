@@ -526,6 +526,25 @@ void gnc_split_register_cancel_cursor_trans_changes (SplitRegister* reg);
 void gnc_split_register_load (SplitRegister* reg, GList* slist,
                               Account* default_account);
 
+/** Brings the rows of changed transactions up to date without reloading
+ *  the register, for when the list of splits it shows is the same as at
+ *  the last load.
+ *
+ *  This succeeds if each of the transactions still has the rows the load
+ *  made for it, and sits on the same side of the dividers.  After that, a
+ *  redraw is all that's needed, since the contents of the rows, running
+ *  balances included, are read from the engine as they are drawn.
+ *
+ *  @param reg a ::SplitRegister
+ *
+ *  @param changed a set of the Transactions that have changed
+ *
+ *  @return FALSE if the register must be loaded again instead, as when the
+ *  splits of a transaction changed or it's the one being edited.
+ */
+gboolean gnc_split_register_refresh_changed (SplitRegister* reg,
+                                             GHashTable* changed);
+
 /** Copy the contents of the current cursor to a split. The split and
  *    transaction that are updated are the ones associated with the
  *    current cursor (register entry) position. If the do_commit flag
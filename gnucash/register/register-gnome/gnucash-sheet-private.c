@@ -43,6 +43,125 @@
 #include "gnucash-style.h"
 #include "gnc-gtk-utils.h"
 
+/* Enough for every cell of a full screen register, even a large one. */
+#define LAYOUT_CACHE_SIZE 2048
+
+typedef struct
+{
+    gchar       *text;
+    gboolean     italic;
+    PangoLayout *layout;
+    GList        lru_link;
+} CellLayout;
+
+static guint
+cell_layout_hash (gconstpointer key)
+{
+    const CellLayout *cl = key;
+    return g_str_hash (cl->text) ^ cl->italic;
+}
+
+static gboolean
+cell_layout_equal (gconstpointer a, gconstpointer b)
+{
+    const CellLayout *cla = a, *clb = b;
+    return cla->italic == clb->italic && g_strcmp0 (cla->text, clb->text) == 0;
+}
+
+static void
+cell_layout_free (gpointer data)
+{
+    CellLayout *cl = data;
+
+    g_object_unref (cl->layout);
+    g_free (cl->text);
+    g_free (cl);
+}
+
+void
+gnucash_sheet_clear_layout_cache (GnucashSheet *sheet)
+{
+    /* The links of the queue are in the cached layouts, so the queue
+     * must let go of them before the layouts are freed. */
+    if (sheet->layout_lru)
+    {
+        g_queue_init (sheet->layout_lru);
+        g_queue_free (sheet->layout_lru);
+    }
+    sheet->layout_lru = NULL;
+
+    if (sheet->layout_cache)
+        g_hash_table_destroy (sheet->layout_cache);
+    sheet->layout_cache = NULL;
+}
+
+/*
+ * Return a layout of text in the sheet's font, made italic if asked,
+ * which belongs to the sheet.  Most of what is drawn on a redraw or a
+ * scroll was drawn the time before, so layouts are kept for the texts
+ * drawn most recently, rather than being made again for every cell
+ * every time.  They are all dropped when the sheet's font changes.
+ */
+static PangoLayout *
+gnucash_sheet_get_cell_layout (GnucashSheet *sheet, const char *text,
+                               gboolean italic)
+{
+    PangoContext *context = gtk_widget_get_pango_context (GTK_WIDGET (sheet));
+    guint serial = pango_context_get_serial (context);
+    CellLayout lookup = { (gchar *) text, italic, NULL, { NULL, NULL, NULL } };
+    CellLayout *cl;
+
+    if (sheet->layout_cache && sheet->layout_serial != serial)
+        gnucash_sheet_clear_layout_cache (sheet);
+
+    if (!sheet->layout_cache)
+    {
+        sheet->layout_cache = g_hash_table_new_full (cell_layout_hash,
+                                                     cell_layout_equal,
+                                                     NULL, cell_layout_free);
+        sheet->layout_lru = g_queue_new ();
+        sheet->layout_serial = serial;
+    }
+
+    cl = g_hash_table_lookup (sheet->layout_cache, &lookup);
+    if (cl)
+    {
+        g_queue_unlink (sheet->layout_lru, &cl->lru_link);
+        g_queue_push_head_link (sheet->layout_lru, &cl->lru_link);
+        return cl->layout;
+    }
+
+    cl = g_new0 (CellLayout, 1);
+    cl->text = g_strdup (text);
+    cl->italic = italic;
+    cl->layout = gtk_widget_create_pango_layout (GTK_WIDGET (sheet), text);
+    cl->lru_link.data = cl;
+
+    // We don't need word wrap or line wrap
+    pango_layout_set_width (cl->layout, -1);
+
+    if (italic)
+    {
+        PangoFontDescription *font =
+            pango_font_description_copy (pango_context_get_font_description (context));
+
+        pango_font_description_set_style (font, PANGO_STYLE_ITALIC);
+        pango_layout_set_font_description (cl->layout, font);
+        pango_font_description_free (font);
+    }
+
+    g_hash_table_add (sheet->layout_cache, cl);
+    g_queue_push_head_link (sheet->layout_lru, &cl->lru_link);
+
+    if (g_queue_get_length (sheet->layout_lru) > LAYOUT_CACHE_SIZE)
+    {
+        GList *oldest = g_queue_pop_tail_link (sheet->layout_lru);
+        g_hash_table_remove (sheet->layout_cache, oldest->data);
+    }
+
+    return cl->layout;
+}
+
 /*
  * Sets virt_row, virt_col to the block coordinates for the
  * block containing pixel (x, y).  Also sets o_x, o_y, to the
@@ -63,27 +182,17 @@ find_block_by_pixel (GnucashSheet *sheet,
     g_return_val_if_fail (y >= 0, NULL);
     g_return_val_if_fail (x >= 0, NULL);
 
-    do
-    {
-        block = gnucash_sheet_get_block (sheet, vc_loc);
-        if (!block)
-            return NULL;
-
-        if (block->visible &&
-                y >= block->origin_y &&
-                y < block->origin_y + block->style->dimensions->height)
-        {
-            if (vcell_loc)
-                vcell_loc->virt_row = vc_loc.virt_row;
-            break;
-        }
-        vc_loc.virt_row++;
-    }
-    while (vc_loc.virt_row < sheet->num_virt_rows);
+    vc_loc.virt_row = gnucash_sheet_y_pixel_to_block (sheet, y);
+    if (vc_loc.virt_row >= sheet->num_virt_rows)
+        return NULL;
 
-    if (vc_loc.virt_row == sheet->num_virt_rows)
+    block = gnucash_sheet_get_block (sheet, vc_loc);
+    if (!block || y < block->origin_y)
         return NULL;
 
+    if (vcell_loc)
+        vcell_loc->virt_row = vc_loc.virt_row;
+
     do
     {
         block = gnucash_sheet_get_block (sheet, vc_loc);
@@ -384,8 +493,7 @@ draw_cell (GnucashSheet *sheet, SheetBlock *block,
     PhysicalCellBorders borders;
     const char *text;
     PangoLayout *layout;
-    PangoContext *context;
-    PangoFontDescription *font;
+    gboolean italic = FALSE;
     PangoRectangle logical_rect;
     GdkRGBA *bg_color, *fg_color;
     GdkRectangle rect;
@@ -493,16 +601,9 @@ draw_cell (GnucashSheet *sheet, SheetBlock *block,
                        table->model->dividing_row_lower, block->style->nrows,
                        fg_color, x, y, width, height);
 
-    layout = gtk_widget_create_pango_layout (GTK_WIDGET (sheet), text);
-
     if (gtk_style_context_has_class (stylectxt, GTK_STYLE_CLASS_VIEW))
         gtk_style_context_remove_class (stylectxt, GTK_STYLE_CLASS_VIEW);
 
-    // We don't need word wrap or line wrap
-    pango_layout_set_width (layout, -1);
-    context = pango_layout_get_context (layout);
-    font = pango_font_description_copy (pango_context_get_font_description (context));
-
 #ifdef READONLY_LINES_WITH_CHANGED_FG_COLOR
     // Are we in a read-only row? Then make the foreground color somewhat less black
     if ((virt_loc.phys_row_offset < block->style->nrows)
@@ -527,9 +628,7 @@ draw_cell (GnucashSheet *sheet, SheetBlock *block,
         // Make text color greyed
         gtk_style_context_add_class (stylectxt, "gnc-class-lighter-grey-mix");
 
-        pango_layout_set_text (layout, text, strlen (text));
-        pango_font_description_set_style (font, PANGO_STYLE_ITALIC);
-        pango_context_set_font_description (context, font);
+        italic = TRUE;
     }
 
     if ((text == NULL) || (*text == '\0'))
@@ -537,6 +636,7 @@ draw_cell (GnucashSheet *sheet, SheetBlock *block,
         goto exit;
     }
 
+    layout = gnucash_sheet_get_cell_layout (sheet, text, italic);
     pango_layout_get_pixel_extents (layout, NULL, &logical_rect);
 
     gnucash_sheet_set_text_bounds (sheet, &rect, x, y, width, height);
@@ -554,11 +654,6 @@ draw_cell (GnucashSheet *sheet, SheetBlock *block,
     cairo_restore (cr);
 
 exit:
-    pango_font_description_set_style (font, PANGO_STYLE_NORMAL);
-    pango_context_set_font_description (context, font);
-    pango_font_description_free (font);
-    g_object_unref (layout);
-
     gtk_style_context_restore (stylectxt);
 }
 
@@ -507,12 +507,32 @@ gnucash_sheet_cursor_move (GnucashSheet *sheet, VirtualLocation virt_loc)
 }
 
 
-static gint
+/* The block offsets are kept by gnucash_sheet_recompute_block_offsets, and
+ * never decrease from row 1 down, a hidden block sharing the origin of the
+ * block after it.  So the row under y is found by a binary search rather
+ * than by walking down from the top, which would make every redraw and
+ * scroll of a long register as slow as its length. */
+gint
 gnucash_sheet_y_pixel_to_block (GnucashSheet *sheet, int y)
 {
     VirtualCellLocation vcell_loc = { 1, 0 };
+    gint low = 1, high = sheet->num_virt_rows - 1;
+
+    /* Find the last row starting at or above y. */
+    while (low < high)
+    {
+        SheetBlock *block;
 
-    for (;
+        vcell_loc.virt_row = low + (high - low + 1) / 2;
+        block = gnucash_sheet_get_block (sheet, vcell_loc);
+        if (block && block->origin_y <= y)
+            low = vcell_loc.virt_row;
+        else
+            high = vcell_loc.virt_row - 1;
+    }
+
+    /* Only hidden rows can lie between it and the visible row containing y. */
+    for (vcell_loc.virt_row = low;
             vcell_loc.virt_row < sheet->num_virt_rows;
             vcell_loc.virt_row++)
     {
@@ -817,6 +837,8 @@ gnucash_sheet_finalize (GObject *object)
     g_hash_table_destroy (sheet->cursor_styles);
     g_hash_table_destroy (sheet->dimensions_hash_table);
 
+    gnucash_sheet_clear_layout_cache (sheet);
+
     if (G_OBJECT_CLASS(sheet_parent_class)->finalize)
         (*G_OBJECT_CLASS(sheet_parent_class)->finalize)(object);
 }
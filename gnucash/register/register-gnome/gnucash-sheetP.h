@@ -104,6 +104,11 @@ struct _GnucashSheet
     gboolean direct_update_cell; /** Indicates that this cell has special operation keys. */
     int pos, bound; /** Corresponds to GtkEditable's current_pos and selection_bound */
 
+    /** The layouts of the texts drawn most recently, most recent first,
+     *  and the PangoContext serial they were made with. */
+    GHashTable *layout_cache;
+    GQueue     *layout_lru;
+    guint       layout_serial;
 };
 
 
@@ -118,11 +123,17 @@ void gnucash_sheet_set_popup (GnucashSheet *sheet, GtkWidget *popup, gpointer da
 void gnucash_sheet_goto_virt_loc (GnucashSheet *sheet, VirtualLocation virt_loc);
 void gnucash_sheet_refresh_from_prefs (GnucashSheet *sheet);
 
+/** The first visible row whose block reaches below y, or num_virt_rows if
+ *  there is none. */
+gint gnucash_sheet_y_pixel_to_block (GnucashSheet *sheet, int y);
+
 gboolean   gnucash_sheet_find_loc_by_pixel (GnucashSheet *sheet, gint x, gint y,
                                            VirtualLocation *vcell_loc);
 gboolean gnucash_sheet_draw_internal (GnucashSheet *sheet, cairo_t *cr,
                                       GtkAllocation *alloc);
 void gnucash_sheet_draw_cursor (GnucashCursor *cursor, cairo_t *cr);
+/** Free the cached cell text layouts. */
+void gnucash_sheet_clear_layout_cache (GnucashSheet *sheet);
 
 /** @} */
 #endif
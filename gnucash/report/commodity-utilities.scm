@@ -22,6 +22,9 @@
 
 (define-module (gnucash report commodity-utilities))
 
+(eval-when (compile load eval expand)
+  (load-extension "libgnc-report" "scm_init_sw_report_module"))
+(use-modules (sw_report))
 (use-modules (gnucash core-utils))
 (use-modules (gnucash engine))
 (use-modules (gnucash utilities))
@@ -773,15 +776,45 @@
 ;; Return a ready-to-use function. Which one to use is determined by
 ;; the value of 'source-option', whose possible values are set in
 ;; gnc:options-add-price-source!.
+;; The exchange alists and price lists below take a pass over all the
+;; splits of the book to make, and the reports of a book mostly ask for
+;; the same ones, so they're kept in the book's snapshots (see
+;; gnc-report.h) under a key of what they depend on, until the book
+;; changes or another one is loaded.
+(define (exchange-snapshot-key source-option report-currency date
+                               commodity-list)
+  (string-join
+   (cons* (symbol->string source-option)
+          (gnc-commodity-get-unique-name report-currency)
+          (number->string date)
+          (map gnc-commodity-get-unique-name commodity-list))
+   "|"))
+
+(define* (shared-exchange-snapshot source-option report-currency date
+                                   thunk #:optional (commodity-list '()))
+  (let* ((key (exchange-snapshot-key source-option report-currency date
+                                     commodity-list))
+         (snapshot (gnc-report-exchange-snapshot-ref key)))
+    (or snapshot
+        (let ((value (thunk)))
+          (gnc-report-exchange-snapshot-store key value)
+          value))))
+
 (define (gnc:case-exchange-fn
          source-option report-currency to-date-tp)
   (case source-option
     ((average-cost) (gnc:make-exchange-function
-                     (gnc:make-exchange-cost-alist
-                      report-currency to-date-tp)))
+                     (shared-exchange-snapshot
+                      source-option report-currency to-date-tp
+                      (lambda ()
+                        (gnc:make-exchange-cost-alist
+                         report-currency to-date-tp)))))
     ((weighted-average) (gnc:make-exchange-function
-                         (gnc:make-exchange-alist
-                          report-currency to-date-tp)))
+                         (shared-exchange-snapshot
+                          source-option report-currency to-date-tp
+                          (lambda ()
+                            (gnc:make-exchange-alist
+                             report-currency to-date-tp)))))
     ((pricedb-latest) gnc:exchange-by-pricedb-latest)
     ((pricedb-nearest) (lambda (foreign domestic)
                          (gnc:exchange-by-pricedb-nearest
@@ -835,15 +868,19 @@
          start-percent delta-percent)
   (case source-option
     ;; Make this the same as gnc:case-exchange-fn
-    ((average-cost) (let* ((exchange-fn (gnc:make-exchange-function
-                                         (gnc:make-exchange-cost-alist
-                                          report-currency to-date-tp))))
+    ((average-cost) (let* ((exchange-fn (gnc:case-exchange-fn
+                                         source-option report-currency
+                                         to-date-tp)))
                       (lambda (foreign domestic date)
                         (exchange-fn foreign domestic))))
     ((weighted-average) (let ((pricealist
-                               (gnc:get-commoditylist-totalavg-prices
-                                commodity-list report-currency to-date-tp
-                                start-percent delta-percent)))
+                               (shared-exchange-snapshot
+                                'totalavg-prices report-currency to-date-tp
+                                (lambda ()
+                                  (gnc:get-commoditylist-totalavg-prices
+                                   commodity-list report-currency to-date-tp
+                                   start-percent delta-percent))
+                                commodity-list)))
                           (gnc:debug "weighted-average pricealist " pricealist)
                           (lambda (foreign domestic date)
                             (gnc:exchange-by-pricealist-nearest
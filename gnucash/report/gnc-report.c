@@ -39,8 +39,11 @@
 
 #include "gnc-filepath-utils.h"
 #include "gnc-guile-utils.h"
+#include "gnc-prefs.h"
 #include "gnc-report.h"
 #include "gnc-engine.h"
+#include "gnc-session.h"
+#include "gnc-uri-utils.h"
 
 extern SCM scm_init_sw_report_module(void);
 
@@ -50,6 +53,25 @@ static QofLogModule log_module = GNC_MOD_GUI;
 static GHashTable *reports = NULL;
 static gint report_next_serial_id = 0;
 
+#define GNC_PREF_CACHE_ON_DISK "cache-on-disk"
+#define REPORT_CACHE_DIR_EXT   ".report-cache"
+
+/* Report output by cache key, see report_cache_key().  "revision"
+ * counts the changes to the books since the cache was started, so that
+ * a change makes all the keys computed before it stale. */
+static GHashTable *report_cache = NULL;
+static guint64 report_cache_revision = 0;
+static gint report_cache_handler_id = 0;
+
+/* Exchange-rate snapshots by key, see gnc_report_exchange_snapshot_ref(),
+ * and the id of the report being run, -1 if none is. */
+static GHashTable *exchange_snapshots = NULL;
+static gint report_running_id = -1;
+
+/* -1 until looked up in the environment. */
+static gint report_profiling = -1;
+static gchar *report_last_profile = NULL;
+
 static gboolean
 try_load_config_array(const gchar *fns[])
 {
@@ -126,6 +148,7 @@ gnc_report_remove_by_id(gint id)
 {
     if (reports)
         g_hash_table_remove(reports, &id);
+    gnc_report_exchange_snapshots_release (id);
 }
 
 SCM gnc_report_find(gint id)
@@ -206,17 +229,433 @@ gnc_reports_get_global(void)
     return reports;
 }
 
+static void
+report_cache_event_handler (QofInstance *ent, QofEventId event_type,
+                            gpointer handler_data, gpointer event_data)
+{
+    report_cache_revision++;
+    if (g_hash_table_size (report_cache))
+        g_hash_table_remove_all (report_cache);
+}
+
+static void
+report_cache_init (void)
+{
+    if (report_cache)
+        return;
+    report_cache = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                          g_free, g_free);
+    report_cache_handler_id = qof_event_register_filtered_handler (
+        NULL, QOF_EVENT_MODIFY | QOF_EVENT_DESTROY |
+              QOF_EVENT_ADD | QOF_EVENT_REMOVE,
+        report_cache_event_handler, NULL);
+}
+
+typedef struct
+{
+    SCM value;
+    guint64 revision;
+    GHashTable *users;          /* ids of the reports using it */
+} ExchangeSnapshot;
+
+static void
+exchange_snapshot_free (gpointer data)
+{
+    ExchangeSnapshot *snapshot = data;
+
+    scm_gc_unprotect_object (snapshot->value);
+    g_hash_table_destroy (snapshot->users);
+    g_free (snapshot);
+}
+
+static void
+exchange_snapshot_use (ExchangeSnapshot *snapshot)
+{
+    if (report_running_id >= 0)
+        g_hash_table_add (snapshot->users, GINT_TO_POINTER (report_running_id));
+}
+
+SCM
+gnc_report_exchange_snapshot_ref (const gchar *key)
+{
+    ExchangeSnapshot *snapshot;
+
+    report_cache_init ();
+    if (!exchange_snapshots || !key)
+        return SCM_BOOL_F;
+
+    snapshot = g_hash_table_lookup (exchange_snapshots, key);
+    if (!snapshot)
+        return SCM_BOOL_F;
+    if (snapshot->revision != report_cache_revision)
+    {
+        DEBUG ("exchange snapshot %s is stale", key);
+        g_hash_table_remove (exchange_snapshots, key);
+        return SCM_BOOL_F;
+    }
+    exchange_snapshot_use (snapshot);
+    return snapshot->value;
+}
+
+void
+gnc_report_exchange_snapshot_store (const gchar *key, SCM value)
+{
+    ExchangeSnapshot *snapshot;
+
+    g_return_if_fail (key);
+    report_cache_init ();
+    if (!exchange_snapshots)
+        exchange_snapshots = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                                    g_free,
+                                                    exchange_snapshot_free);
+
+    snapshot = g_new0 (ExchangeSnapshot, 1);
+    snapshot->value = scm_gc_protect_object (value);
+    snapshot->revision = report_cache_revision;
+    snapshot->users = g_hash_table_new (g_direct_hash, g_direct_equal);
+    exchange_snapshot_use (snapshot);
+    g_hash_table_replace (exchange_snapshots, g_strdup (key), snapshot);
+}
+
+static gboolean
+exchange_snapshot_release (gpointer key, gpointer value, gpointer user_data)
+{
+    ExchangeSnapshot *snapshot = value;
+
+    g_hash_table_remove (snapshot->users, user_data);
+    return g_hash_table_size (snapshot->users) == 0 ||
+           snapshot->revision != report_cache_revision;
+}
+
+void
+gnc_report_exchange_snapshots_release (gint report_id)
+{
+    if (exchange_snapshots)
+        g_hash_table_foreach_remove (exchange_snapshots,
+                                     exchange_snapshot_release,
+                                     GINT_TO_POINTER (report_id));
+}
+
+/* Return the name of the directory beside the current book that the
+ * output of its reports is kept in, or NULL if it isn't kept: the book
+ * isn't a file, it has changes that aren't saved, or the preference is
+ * off.  stamp is set to a string that changes whenever the file does. */
+static gchar *
+report_cache_dir (QofBook *book, gchar **stamp)
+{
+    const gchar *url;
+    gchar *path, *dir = NULL;
+    GStatBuf sb;
+
+    if (!gnc_prefs_get_bool (GNC_PREFS_GROUP_GENERAL_REPORT,
+                             GNC_PREF_CACHE_ON_DISK) ||
+        !gnc_current_session_exist () ||
+        qof_book_session_not_saved (book))
+        return NULL;
+
+    url = qof_session_get_url (gnc_get_current_session ());
+    if (!url || !gnc_uri_is_file_uri (url))
+        return NULL;
+
+    path = gnc_uri_get_path (url);
+    if (g_stat (path, &sb) == 0)
+    {
+        dir = g_strconcat (path, REPORT_CACHE_DIR_EXT, NULL);
+        *stamp = g_strdup_printf ("%" G_GINT64_FORMAT " %" G_GINT64_FORMAT,
+                                  (gint64) sb.st_mtime, (gint64) sb.st_size);
+    }
+    g_free (path);
+    return dir;
+}
+
+/* The key the output of report is cached under: a checksum of
+ * gnc:report-cache-key, the book, the day -- for the reports with
+ * dates relative to today -- and either the revision of the books or,
+ * for the output kept on disk, the file of the book. */
+static gchar *
+report_cache_key (SCM report, gboolean on_disk, const gchar *stamp)
+{
+    QofBook *book = gnc_get_current_book ();
+    gchar *options, *text, *key;
+    gchar guidstr[GUID_ENCODING_LENGTH + 1];
+
+    options = gnc_scm_call_1_to_string (
+        scm_c_eval_string ("gnc:report-cache-key"), report);
+    if (!options)
+        return NULL;
+
+    guid_to_string_buff (qof_book_get_guid (book), guidstr);
+    if (on_disk)
+        text = g_strdup_printf ("%s\n%" G_GINT64_FORMAT "\nfile %s\n%s",
+                                guidstr, gnc_time64_get_today_start (),
+                                stamp, options);
+    else
+        text = g_strdup_printf ("%s\n%" G_GINT64_FORMAT "\nrevision %"
+                                G_GUINT64_FORMAT "\n%s",
+                                guidstr, gnc_time64_get_today_start (),
+                                report_cache_revision, options);
+    key = g_compute_checksum_for_string (G_CHECKSUM_SHA256, text, -1);
+    g_free (text);
+    g_free (options);
+    return key;
+}
+
+/* Look the output of report up, first in memory, then beside the book.
+ * Returns a newly allocated string or NULL.  key is set to the key to
+ * store the output under if it isn't found. */
+static gchar *
+report_cache_lookup (SCM report, gchar **key)
+{
+    QofBook *book = gnc_get_current_book ();
+    gchar *html, *dir, *stamp = NULL;
+
+    report_cache_init ();
+    *key = report_cache_key (report, FALSE, NULL);
+    if (!*key)
+        return NULL;
+
+    html = g_hash_table_lookup (report_cache, *key);
+    if (html)
+        return g_strdup (html);
+
+    dir = report_cache_dir (book, &stamp);
+    if (dir)
+    {
+        gchar *disk_key = report_cache_key (report, TRUE, stamp);
+        gchar *file = disk_key ? g_build_filename (dir, disk_key, NULL) : NULL;
+
+        if (file && g_file_get_contents (file, &html, NULL, NULL))
+        {
+            DEBUG ("report output found in %s", file);
+            g_hash_table_insert (report_cache, g_strdup (*key), g_strdup (html));
+        }
+        g_free (file);
+        g_free (disk_key);
+        g_free (dir);
+        g_free (stamp);
+    }
+    return html;
+}
+
+/* Remove the files of dir that are older than the book, so the cache
+ * only keeps the output for the current file. */
+static void
+report_cache_prune (const gchar *dir, time64 book_mtime)
+{
+    GDir *gdir = g_dir_open (dir, 0, NULL);
+    const gchar *name;
+
+    if (!gdir)
+        return;
+    while ((name = g_dir_read_name (gdir)))
+    {
+        gchar *file = g_build_filename (dir, name, NULL);
+        GStatBuf sb;
+
+        if (g_stat (file, &sb) == 0 && sb.st_mtime < book_mtime)
+            g_unlink (file);
+        g_free (file);
+    }
+    g_dir_close (gdir);
+}
+
+static void
+report_cache_store (SCM report, gchar *key, const gchar *html)
+{
+    QofBook *book = gnc_get_current_book ();
+    gchar *dir, *stamp = NULL;
+
+    g_hash_table_insert (report_cache, key, g_strdup (html));
+
+    dir = report_cache_dir (book, &stamp);
+    if (dir)
+    {
+        gchar *disk_key = report_cache_key (report, TRUE, stamp);
+        GError *error = NULL;
+
+        if (disk_key && g_mkdir_with_parents (dir, 0700) == 0)
+        {
+            gchar *file = g_build_filename (dir, disk_key, NULL);
+
+            report_cache_prune (dir, g_ascii_strtoll (stamp, NULL, 10));
+            if (!g_file_set_contents (file, html, -1, &error))
+            {
+                PWARN ("Unable to keep the report output in %s: %s",
+                       file, error->message);
+                g_error_free (error);
+            }
+            g_free (file);
+        }
+        g_free (disk_key);
+        g_free (dir);
+        g_free (stamp);
+    }
+}
+
+void
+gnc_report_cache_flush (void)
+{
+    if (report_cache)
+        g_hash_table_remove_all (report_cache);
+    if (exchange_snapshots)
+        g_hash_table_remove_all (exchange_snapshots);
+    report_cache_revision++;
+}
+
+void
+gnc_report_cache_remove (SCM report)
+{
+    gchar *key, *dir, *stamp = NULL;
+
+    if (!report_cache || scm_is_false (report))
+        return;
+
+    key = report_cache_key (report, FALSE, NULL);
+    if (key)
+        g_hash_table_remove (report_cache, key);
+    g_free (key);
+
+    dir = report_cache_dir (gnc_get_current_book (), &stamp);
+    if (dir)
+    {
+        key = report_cache_key (report, TRUE, stamp);
+        if (key)
+        {
+            gchar *file = g_build_filename (dir, key, NULL);
+            g_unlink (file);
+            g_free (file);
+        }
+        g_free (key);
+        g_free (dir);
+        g_free (stamp);
+    }
+}
+
+gboolean
+gnc_report_get_profiling (void)
+{
+    if (report_profiling < 0)
+        report_profiling = g_getenv ("GNC_REPORT_PROFILE") != NULL;
+    return report_profiling;
+}
+
+void
+gnc_report_set_profiling (gboolean profiling)
+{
+    report_profiling = profiling ? 1 : 0;
+}
+
+void
+gnc_report_profile_add (const gchar *section, gint64 usecs)
+{
+    qof_counter_add_named (section, usecs);
+    if (qof_trace_enabled ())
+        qof_trace_span ("report", section, g_get_monotonic_time () - usecs,
+                        NULL);
+}
+
+gchar *
+gnc_report_get_last_profile (void)
+{
+    return g_strdup (report_last_profile);
+}
+
+static gint64
+report_profile_start (void)
+{
+    if (!gnc_report_get_profiling ())
+        return 0;
+    qof_counter_reset ();
+    return g_get_monotonic_time ();
+}
+
+/* Log the time spent running report since start, by category and by
+ * counter, and append it to the file GNC_REPORT_PROFILE names, if it
+ * names one. */
+static void
+report_profile_finish (SCM report, gint64 start)
+{
+    const gchar *file = g_getenv ("GNC_REPORT_PROFILE");
+    gchar *name, *categories, *counters, *text;
+    gint64 total;
+
+    if (!start)
+        return;
+
+    total = g_get_monotonic_time () - start;
+    name = gnc_report_name (report);
+    categories = qof_counter_report_categories ();
+    counters = qof_counter_report ();
+    text = g_strdup_printf ("Profile of report %s: %.3f ms in all\n%s\n%s%s\n",
+                            name ? name : "", total / 1000.0,
+                            categories, counters,
+                            qof_counters_enabled () ? "" :
+                            "Engine calls are only timed in builds configured "
+                            "with ENABLE_INSTRUMENTATION.\n");
+    g_message ("%s", text);
+
+    if (file && *file && g_strcmp0 (file, "1") != 0)
+    {
+        FILE *out = g_fopen (file, "a");
+        if (out)
+        {
+            fputs (text, out);
+            fclose (out);
+        }
+        else
+            PWARN ("Unable to write the report profile to %s", file);
+    }
+    g_free (report_last_profile);
+    report_last_profile = text;
+    g_free (counters);
+    g_free (categories);
+    g_free (name);
+}
+
+/* Write the run of report since start, from qof_trace_now(), to the
+ * trace. */
+static void
+report_trace_finish (SCM report, gint64 start)
+{
+    gchar *name;
+
+    if (!start)
+        return;
+    name = gnc_report_name (report);
+    qof_trace_span ("report", "report run", start, name);
+    g_free (name);
+}
+
 gboolean
 gnc_run_report_with_error_handling (gint report_id, gchar ** data, gchar **errmsg)
 {
     SCM report, res, html, captured_error;
+    gchar *key;
+    gint64 profile_start, trace_start;
 
     report = gnc_report_find (report_id);
     g_return_val_if_fail (data, FALSE);
     g_return_val_if_fail (errmsg, FALSE);
     g_return_val_if_fail (!scm_is_false (report), FALSE);
 
+    /* A profiled report always runs, so there's something to measure. */
+    *data = report_cache_lookup (report, &key);
+    if (*data && !gnc_report_get_profiling ())
+    {
+        g_free (key);
+        *errmsg = NULL;
+        return TRUE;
+    }
+    g_free (*data);
+    *data = NULL;
+
+    profile_start = report_profile_start ();
+    trace_start = qof_trace_now ();
+    report_running_id = report_id;
     res = scm_call_1 (scm_c_eval_string ("gnc:render-report"), report);
+    report_running_id = -1;
+    report_trace_finish (report, trace_start);
+    report_profile_finish (report, profile_start);
     html = scm_car (res);
     captured_error = scm_cadr (res);
 
@@ -224,17 +663,72 @@ gnc_run_report_with_error_handling (gint report_id, gchar ** data, gchar **errms
     {
         *data = gnc_scm_to_utf8_string (html);
         *errmsg = NULL;
+        if (key)
+            report_cache_store (report, key, *data);
         return TRUE;
     }
     else
     {
         *errmsg = gnc_scm_to_utf8_string (captured_error);
         *data = NULL;
+        g_free (key);
         PWARN ("Error in report: %s", *errmsg);
         return FALSE;
     }
 }
 
+gboolean
+gnc_run_report_to_file_with_error_handling (gint report_id,
+                                            const gchar *filename,
+                                            gchar **errmsg)
+{
+    SCM report, res, captured_error;
+    gchar *key, *html;
+    GError *error = NULL;
+    gint64 profile_start, trace_start;
+
+    report = gnc_report_find (report_id);
+    g_return_val_if_fail (filename, FALSE);
+    g_return_val_if_fail (errmsg, FALSE);
+    g_return_val_if_fail (!scm_is_false (report), FALSE);
+
+    *errmsg = NULL;
+    html = report_cache_lookup (report, &key);
+    g_free (key);
+    if (html && !gnc_report_get_profiling ())
+    {
+        gboolean ok = g_file_set_contents (filename, html, -1, &error);
+        g_free (html);
+        if (ok)
+            return TRUE;
+        *errmsg = g_strdup (error->message);
+        g_error_free (error);
+        PWARN ("Error writing report: %s", *errmsg);
+        return FALSE;
+    }
+
+    g_free (html);
+
+    profile_start = report_profile_start ();
+    trace_start = qof_trace_now ();
+    report_running_id = report_id;
+    res = scm_call_2 (scm_c_eval_string ("gnc:render-report-to-file"), report,
+                      scm_from_utf8_string (filename));
+    report_running_id = -1;
+    report_trace_finish (report, trace_start);
+    report_profile_finish (report, profile_start);
+    captured_error = scm_cadr (res);
+
+    if (!scm_is_false (scm_car (res)))
+        return TRUE;
+
+    *errmsg = scm_is_string (captured_error) ?
+              gnc_scm_to_utf8_string (captured_error) :
+              g_strdup ("The report could not be rendered.");
+    PWARN ("Error in report: %s", *errmsg);
+    return FALSE;
+}
+
 static void
 error_handler(const char *str)
 {
@@ -244,22 +738,40 @@ error_handler(const char *str)
 gboolean
 gnc_run_report (gint report_id, char ** data)
 {
-    SCM scm_text;
-    gchar *str;
+    SCM scm_text, report;
+    gchar *str, *key = NULL;
 
     PWARN ("gnc_run_report is deprecated. use gnc_run_report_with_error_handling instead.");
 
     g_return_val_if_fail (data != NULL, FALSE);
     *data = NULL;
 
+    report = gnc_report_find (report_id);
+    if (!scm_is_false (report))
+    {
+        *data = report_cache_lookup (report, &key);
+        if (*data)
+        {
+            g_free (key);
+            return TRUE;
+        }
+    }
+
     str = g_strdup_printf("(gnc:report-run %d)", report_id);
+    report_running_id = report_id;
     scm_text = gfec_eval_string(str, error_handler);
+    report_running_id = -1;
     g_free(str);
 
     if (scm_text == SCM_UNDEFINED || !scm_is_string (scm_text))
+    {
+        g_free (key);
         return FALSE;
+    }
 
     *data = gnc_scm_to_utf8_string (scm_text);
+    if (key)
+        report_cache_store (report, key, *data);
 
     return TRUE;
 }
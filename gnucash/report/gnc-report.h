@@ -38,10 +38,25 @@
 void gnc_report_init (void);
 
 
+/** Run a report, with or without error handling.  The output is cached under the report type, the
+ *  options of the report and its stylesheet, the day and the changes
+ *  made to the books; running a report again with nothing of those
+ *  changed returns the output of the last run.  If the preference
+ *  general.report/cache-on-disk is set, the output of the reports run
+ *  while the book has no unsaved changes is kept beside the book file
+ *  too, so they show at once when the book is opened again. */
 gboolean gnc_run_report (gint report_id, char ** data);
 gboolean gnc_run_report_with_error_handling (gint report_id,
                                              gchar **data,
                                              gchar **errmsg);
+/** Run a report into the file filename, writing its markup as it's
+ *  rendered rather than building all of it in memory first: the way to
+ *  run very large reports.  Cached output is written if there is some,
+ *  but the output isn't cached.  On failure *errmsg is set to a newly
+ *  allocated message. */
+gboolean gnc_run_report_to_file_with_error_handling (gint report_id,
+                                                     const gchar *filename,
+                                                     gchar **errmsg);
 gboolean gnc_run_report_id_string (const char * id_string, char **data);
 gboolean gnc_run_report_id_string_with_error_handling (const char * id_string,
                                                        char **data,
@@ -59,6 +74,51 @@ SCM gnc_report_find(gint id);
 void gnc_report_remove_by_id(gint id);
 gint gnc_report_add(SCM report);
 
+/** @name Report profiling
+ *
+ * While profiling, every report run resets the engine counters (see
+ * qof_counter_report()), times the run and logs how long it took in
+ * all, by category of engine call and by counter, including the
+ * Scheme sections the reports time with gnc:report-profile-section.
+ * If the environment variable GNC_REPORT_PROFILE is set profiling is on
+ * from the start, and if it names a file the profiles are appended to
+ * it too.  Profiled reports are always run, never taken from the
+ * cache.
+ * @{ */
+gboolean gnc_report_get_profiling (void);
+void gnc_report_set_profiling (gboolean profiling);
+/** Add usecs microseconds to the counter named section. */
+void gnc_report_profile_add (const gchar *section, gint64 usecs);
+/** Return the profile of the last report run while profiling, or NULL;
+ *  g_free() it. */
+gchar *gnc_report_get_last_profile (void);
+/** @} */
+
+/** @name Exchange-rate snapshots
+ * The exchange rates a report works out from the price database and
+ * the transactions (see gnc:case-exchange-fn) are kept under a key
+ * naming the report currency, the price source and the dates, so that
+ * the other reports of the book asking for the same ones share them.  A
+ * snapshot goes stale when anything in the book changes and is freed
+ * when the last report that used it is removed.
+ * @{ */
+/** Return the snapshot stored under key, or #f if there is none or it
+ *  is stale.  The report being run becomes one of its users. */
+SCM gnc_report_exchange_snapshot_ref (const gchar *key);
+/** Store value under key, for the report being run. */
+void gnc_report_exchange_snapshot_store (const gchar *key, SCM value);
+/** Drop report_id from the users of the snapshots, freeing those left
+ *  with none. */
+void gnc_report_exchange_snapshots_release (gint report_id);
+/** @} */
+
+/** Forget the cached output of report, so that it's run again. */
+void gnc_report_cache_remove (SCM report);
+
+/** Forget the cached output of all reports, e.g. after the book was
+ *  loaded again with the events suspended. */
+void gnc_report_cache_flush (void);
+
 void gnc_reports_flush_global(void);
 GHashTable *gnc_reports_get_global(void);
 
@@ -719,11 +719,16 @@
       ;; ( acct . balance) cells for the given account *and* its
       ;; sub-accounts.
       (define (get-balance-sub acct-balances account)
-        (let ((this-collector (gnc:make-commodity-collector)))
-          (for-each
-           (lambda (acct)
-             (this-collector 'merge (get-balance acct-balances acct) #f))
-           (gnc:accounts-and-all-descendants (list account)))
+        (let ((this-collector (gnc:make-commodity-collector))
+              (descendants (gnc-account-get-descendants-vector account)))
+          (define (merge! acct)
+            (let ((acct-coll (hash-ref acct-balances (gncAccountGetGUID acct))))
+              (when acct-coll
+                (this-collector 'merge acct-coll #f))))
+          (merge! account)
+          (do ((i 0 (1+ i)))
+              ((= i (vector-length descendants)))
+            (merge! (vector-ref descendants i)))
           this-collector))
 
       (let lp ((accounts (if less-p (sort accts less-p) accts))
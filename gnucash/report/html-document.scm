@@ -61,6 +61,8 @@
 (export gnc:html-document?)
 (export gnc:html-document-set-style!)
 (export gnc:html-document-tree-collapse)
+(export gnc:html-document-tree-write)
+(export gnc:html-render-port)
 (export gnc:html-document-render)
 (export gnc:html-document-push-style)
 (export gnc:html-document-pop-style)
@@ -155,20 +157,40 @@
           ((string? e) (cons e accum))
           (else (cons (object->string e) accum)))))
 
-;; first optional argument is "headers?"
-;; returns the html document as a string, I think.
+;; writes a tree of markup, kept in reverse like the one
+;; gnc:html-document-tree-collapse takes, to port in document order.
+(define (gnc:html-document-tree-write tree port)
+  (let lp ((e tree))
+    (cond ((null? e) #t)
+          ((pair? e) (for-each lp (reverse e)))
+          ((string? e) (display e port))
+          (else (display (object->string e) port)))))
+
+;; while a document is rendered to a port, this is the port around the
+;; rendering of each of its objects. a renderer of a large object, like
+;; gnc:html-table-render, may write its markup there as it goes and
+;; return '(), so the markup of all of it is never held at once. it
+;; must bind this to #f around rendering what it contains.
+(define gnc:html-render-port (make-parameter #f))
+
+;; first optional argument is "headers?", second is a port.
+;; returns the html document as a string, or writes it to the port
+;; if one is given.
 (define (gnc:html-document-render doc . rest)
   (let ((stylesheet (gnc:html-document-style-sheet doc))
         (headers? (or (null? rest) (car rest)))
+        (port (and (pair? rest) (pair? (cdr rest)) (cadr rest)))
         (style-text (gnc:html-document-style-text doc)))
 
     (if stylesheet
         ;; if there's a style sheet, let it do the rendering
-        (gnc:html-style-sheet-render stylesheet doc headers?)
+        (gnc:html-style-sheet-render stylesheet doc headers? port)
 
         ;; otherwise, do the trivial render.
         (let* ((retval '())
-               (push (lambda (l) (set! retval (cons l retval))))
+               (push (if port
+                         (lambda (l) (gnc:html-document-tree-write l port))
+                         (lambda (l) (set! retval (cons l retval)))))
                (objs (gnc:html-document-objects doc))
                (title (gnc:html-document-title doc)))
           ;; compile the doc style
@@ -201,7 +223,8 @@
           ;; now render the children
           (for-each
            (lambda (child)
-               (push (gnc:html-object-render child doc)))
+             (push (parameterize ((gnc:html-render-port port))
+                     (gnc:html-object-render child doc))))
            objs)
 
           (when headers?
@@ -212,7 +235,8 @@
           (gnc:html-document-pop-style doc)
           (gnc:html-style-table-uncompile (gnc:html-document-style doc))
 
-          (string-concatenate (gnc:html-document-tree-collapse retval))))))
+          (or port
+              (string-concatenate (gnc:html-document-tree-collapse retval)))))))
 
 
 (define (gnc:html-document-push-style doc style)
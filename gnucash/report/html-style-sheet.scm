@@ -209,7 +209,8 @@
   (let ((newdoc ((gnc:html-style-sheet-renderer sheet) 
                  (gnc:html-style-sheet-options sheet)
                  doc))
-        (headers? (and (pair? rest) (car rest))))
+        (headers? (and (pair? rest) (car rest)))
+        (port (and (pair? rest) (pair? (cdr rest)) (cadr rest))))
 
     ;; Copy values over to stylesheet-produced document.  note that this is a
     ;; bug that should probably better be fixed by having the stylesheets
@@ -238,7 +239,7 @@
     ;; render the ssdocument (using the trivial stylesheet).  since
     ;; the objects from 'doc' are now in newdoc, this renders the whole
     ;; package.
-    (gnc:html-document-render newdoc headers?)))
+    (gnc:html-document-render newdoc headers? port)))
 
 (define (gnc:get-html-style-sheets)
   (sort (map cdr (hash-map->list cons *gnc:_style-sheets_*))
@@ -437,126 +437,131 @@ populate html-table row-wise using gnc:html-table-append-row! instead.")
           (1+ numrows))))))
 
 (define (gnc:html-table-render table doc)
-  (let* ((retval '())
-         (push (lambda (l) (set! retval (cons l retval)))))
-
-    ;; compile the table style to make other compiles faster
-    (gnc:html-style-table-compile (gnc:html-table-style table)
-                                  (gnc:html-document-style-stack doc))
-
-    (gnc:html-document-push-style doc (gnc:html-table-style table))
-    (push (gnc:html-document-markup-start doc "table" #t))
-
-    ;; render the caption
-    (let ((c (gnc:html-table-caption table)))
-      (when c
-        (push (gnc:html-document-markup-start doc "caption" #t))
-        (push (gnc:html-object-render c doc))
-        (push (gnc:html-document-markup-end doc "caption"))))
-
-    ;; the first row is the column headers.  Columns styles apply.
-    ;; compile the col styles with the header style pushed; we'll
-    ;; recompile them later, but this will have the benefit of
-    ;; compiling in the col-header-style.
-    (let ((ch (gnc:html-table-multirow-col-headers table)))
-      (when ch
-        (gnc:html-document-push-style doc (gnc:html-table-col-headers-style table))
-
-        ;; compile the column styles just in case there's something
-        ;; interesting in the table header cells.
-        (hash-for-each
-         (lambda (col style)
-           (when style
-             (gnc:html-style-table-compile
-              style (gnc:html-document-style-stack doc))))
-         (gnc:html-table-col-styles table))
-
-        ;; render the headers
-        (push (gnc:html-document-markup-start doc "thead" #t))
-
-        (for-each
-         (lambda (ch-row)
-           (push (gnc:html-document-markup-start doc "tr" #t))
-           (let lp ((ch-row ch-row) (colnum 0))
-             (unless (null? ch-row)
-               (let* ((hdr (car ch-row))
-                      (table-cell? (gnc:html-table-cell? hdr))
-                      (col-style (gnc:html-table-col-style table colnum)))
-                 (gnc:html-document-push-style doc col-style)
-                 (cond
-                  (table-cell?
-                   (push (gnc:html-object-render hdr doc)))
-                  (else
-                   (push (gnc:html-document-markup-start doc "th" #t))
-                   (push (gnc:html-object-render hdr doc))
-                   (push (gnc:html-document-markup-end doc "th"))))
-                 (gnc:html-document-pop-style doc)
-                 (lp (cdr ch-row)
-                     (+ colnum
-                        (if table-cell? (gnc:html-table-cell-colspan hdr) 1))))))
-           (push (gnc:html-document-markup-end doc "tr")))
-         ch)
-        (push (gnc:html-document-markup-end doc "thead"))
-
-        ;; pop the col header style
-        (gnc:html-document-pop-style doc)))
-
-    ;; recompile the column styles.  We won't worry about the row
-    ;; styles; if they're there, we may lose, but not much, and they
-    ;; will be pretty rare (I think).
-    (hash-for-each
-     (lambda (col style)
-       (when style
-         (gnc:html-style-table-compile style (gnc:html-document-style-stack doc))))
-     (gnc:html-table-col-styles table))
-
-    (push (gnc:html-document-markup-start doc "tbody" #t))
-    ;; now iterate over the rows
-    (let rowloop ((rows (reverse (gnc:html-table-data table))) (rownum 0))
-      (unless (null? rows)
-        (let* ((row (car rows))
-               (rowstyle (gnc:html-table-row-style table rownum))
-               (rowmarkup (or (gnc:html-table-row-markup table rownum) "tr")))
-
-          ;; push the style for this row and write the start tag, then
-          ;; pop it again.
-          (when rowstyle (gnc:html-document-push-style doc rowstyle))
-          (push (gnc:html-document-markup-start doc rowmarkup #t))
-          (when rowstyle (gnc:html-document-pop-style doc))
-
-          ;; write the column data, pushing the right column style
-          ;; each time, then the row style.
-          (let colloop ((cols row) (colnum 0))
-            (unless (null? cols)
-              (let* ((datum (car cols))
-                     (colstyle (gnc:html-table-col-style table colnum)))
-                ;; push col and row styles
-                (when colstyle (gnc:html-document-push-style doc colstyle))
-                (when rowstyle (gnc:html-document-push-style doc rowstyle))
-
-                ;; render the cell contents
-                (unless (gnc:html-table-cell? datum)
-                  (push (gnc:html-document-markup-start doc "td" #t)))
-                (push (gnc:html-object-render datum doc))
-                (unless (gnc:html-table-cell? datum)
-                  (push (gnc:html-document-markup-end doc "td")))
-
-                ;; pop styles
-                (when rowstyle (gnc:html-document-pop-style doc))
-                (when colstyle (gnc:html-document-pop-style doc))
-                (colloop (cdr cols) (1+ colnum)))))
-
-          ;; write the row end tag and pop the row style
-          (when rowstyle (gnc:html-document-push-style doc rowstyle))
-          (push (gnc:html-document-markup-end doc rowmarkup))
-          (when rowstyle (gnc:html-document-pop-style doc))
-
-          (rowloop (cdr rows) (1+ rownum)))))
-    (push (gnc:html-document-markup-end doc "tbody"))
-
-    ;; write the table end tag and pop the table style
-    (push (gnc:html-document-markup-end doc "table"))
-    (gnc:html-document-pop-style doc)
+  ;; a table rendered straight into a document's port writes each row
+  ;; there as soon as it's rendered; see gnc:html-render-port.
+  (let* ((port (gnc:html-render-port))
+         (retval '())
+         (push (if port
+                   (lambda (l) (gnc:html-document-tree-write l port))
+                   (lambda (l) (set! retval (cons l retval))))))
+    (parameterize ((gnc:html-render-port #f))
+      ;; compile the table style to make other compiles faster
+      (gnc:html-style-table-compile (gnc:html-table-style table)
+                                    (gnc:html-document-style-stack doc))
+
+      (gnc:html-document-push-style doc (gnc:html-table-style table))
+      (push (gnc:html-document-markup-start doc "table" #t))
+
+      ;; render the caption
+      (let ((c (gnc:html-table-caption table)))
+        (when c
+          (push (gnc:html-document-markup-start doc "caption" #t))
+          (push (gnc:html-object-render c doc))
+          (push (gnc:html-document-markup-end doc "caption"))))
+
+      ;; the first row is the column headers.  Columns styles apply.
+      ;; compile the col styles with the header style pushed; we'll
+      ;; recompile them later, but this will have the benefit of
+      ;; compiling in the col-header-style.
+      (let ((ch (gnc:html-table-multirow-col-headers table)))
+        (when ch
+          (gnc:html-document-push-style doc (gnc:html-table-col-headers-style table))
+
+          ;; compile the column styles just in case there's something
+          ;; interesting in the table header cells.
+          (hash-for-each
+           (lambda (col style)
+             (when style
+               (gnc:html-style-table-compile
+                style (gnc:html-document-style-stack doc))))
+           (gnc:html-table-col-styles table))
+
+          ;; render the headers
+          (push (gnc:html-document-markup-start doc "thead" #t))
+
+          (for-each
+           (lambda (ch-row)
+             (push (gnc:html-document-markup-start doc "tr" #t))
+             (let lp ((ch-row ch-row) (colnum 0))
+               (unless (null? ch-row)
+                 (let* ((hdr (car ch-row))
+                        (table-cell? (gnc:html-table-cell? hdr))
+                        (col-style (gnc:html-table-col-style table colnum)))
+                   (gnc:html-document-push-style doc col-style)
+                   (cond
+                    (table-cell?
+                     (push (gnc:html-object-render hdr doc)))
+                    (else
+                     (push (gnc:html-document-markup-start doc "th" #t))
+                     (push (gnc:html-object-render hdr doc))
+                     (push (gnc:html-document-markup-end doc "th"))))
+                   (gnc:html-document-pop-style doc)
+                   (lp (cdr ch-row)
+                       (+ colnum
+                          (if table-cell? (gnc:html-table-cell-colspan hdr) 1))))))
+             (push (gnc:html-document-markup-end doc "tr")))
+           ch)
+          (push (gnc:html-document-markup-end doc "thead"))
+
+          ;; pop the col header style
+          (gnc:html-document-pop-style doc)))
+
+      ;; recompile the column styles.  We won't worry about the row
+      ;; styles; if they're there, we may lose, but not much, and they
+      ;; will be pretty rare (I think).
+      (hash-for-each
+       (lambda (col style)
+         (when style
+           (gnc:html-style-table-compile style (gnc:html-document-style-stack doc))))
+       (gnc:html-table-col-styles table))
+
+      (push (gnc:html-document-markup-start doc "tbody" #t))
+      ;; now iterate over the rows
+      (let rowloop ((rows (reverse (gnc:html-table-data table))) (rownum 0))
+        (unless (null? rows)
+          (let* ((row (car rows))
+                 (rowstyle (gnc:html-table-row-style table rownum))
+                 (rowmarkup (or (gnc:html-table-row-markup table rownum) "tr")))
+
+            ;; push the style for this row and write the start tag, then
+            ;; pop it again.
+            (when rowstyle (gnc:html-document-push-style doc rowstyle))
+            (push (gnc:html-document-markup-start doc rowmarkup #t))
+            (when rowstyle (gnc:html-document-pop-style doc))
+
+            ;; write the column data, pushing the right column style
+            ;; each time, then the row style.
+            (let colloop ((cols row) (colnum 0))
+              (unless (null? cols)
+                (let* ((datum (car cols))
+                       (colstyle (gnc:html-table-col-style table colnum)))
+                  ;; push col and row styles
+                  (when colstyle (gnc:html-document-push-style doc colstyle))
+                  (when rowstyle (gnc:html-document-push-style doc rowstyle))
+
+                  ;; render the cell contents
+                  (unless (gnc:html-table-cell? datum)
+                    (push (gnc:html-document-markup-start doc "td" #t)))
+                  (push (gnc:html-object-render datum doc))
+                  (unless (gnc:html-table-cell? datum)
+                    (push (gnc:html-document-markup-end doc "td")))
+
+                  ;; pop styles
+                  (when rowstyle (gnc:html-document-pop-style doc))
+                  (when colstyle (gnc:html-document-pop-style doc))
+                  (colloop (cdr cols) (1+ colnum)))))
+
+            ;; write the row end tag and pop the row style
+            (when rowstyle (gnc:html-document-push-style doc rowstyle))
+            (push (gnc:html-document-markup-end doc rowmarkup))
+            (when rowstyle (gnc:html-document-pop-style doc))
+
+            (rowloop (cdr rows) (1+ rownum)))))
+      (push (gnc:html-document-markup-end doc "tbody"))
+
+      ;; write the table end tag and pop the table style
+      (push (gnc:html-document-markup-end doc "table"))
+      (gnc:html-document-pop-style doc))
     retval))
 
 (define (gnc:html-table-set-last-row-style! table tag . rest)
@@ -43,6 +43,7 @@
 (export gnc:all-report-template-guids)
 (export gnc:custom-report-template-guids)
 (export gnc:define-report)
+(export gnc:define-report-stub)
 (export gnc:delete-report)
 (export gnc:find-report-template)
 (export gnc:is-custom-report-type)
@@ -77,8 +78,12 @@
 (export gnc:report-options)
 (export gnc:report-render-html)
 (export gnc:render-report)
+(export gnc:report-render-to-port)
+(export gnc:render-report-to-file)
 (export gnc:report-run)
 (export gnc:report-serialize)
+(export gnc:report-cache-key)
+(export gnc:report-profile-section)
 (export gnc:report-set-ctext!)
 (export gnc:report-set-dirty?!)
 (export gnc:report-set-editor-widget!)
@@ -91,12 +96,14 @@
 (export gnc:report-template-export-thunk)
 (export gnc:report-template-export-types)
 (export gnc:report-template-has-unique-name?)
+(export gnc:report-template-index-entry)
 (export gnc:report-template-in-menu?)
 (export gnc:report-template-is-custom/template-guid?)
 (export gnc:report-template-menu-name)
 (export gnc:report-template-menu-name/report-guid)
 (export gnc:report-template-menu-path)
 (export gnc:report-template-menu-tip)
+(export gnc:report-template-module)
 (export gnc:report-template-name)
 (export gnc:report-template-new-options)
 (export gnc:report-template-new-options/report-guid)
@@ -144,6 +151,15 @@
 ;; value is the report definition structure.
 (define *gnc:_report-templates_* (make-hash-table 23))
 
+;; The name of the module each report template was defined in, by
+;; report guid.
+(define *gnc:_report-template-modules_* (make-hash-table 23))
+
+;; The stand-ins of report templates whose modules aren't loaded yet,
+;; see gnc:define-report-stub.  The key is the report guid and the value
+;; is the pair of the module name and the stand-in.
+(define *gnc:_report-template-stubs_* (make-hash-table 23))
+
 ;; Define those strings here to make changes easier and avoid typos.
 (define gnc:menuname-reports "Reports/StandardReports")
 (define gnc:menuname-asset-liability (N_ "_Assets & Liabilities"))
@@ -248,12 +264,17 @@ not found.")))
           ((not report-guid)
            (gui-error (string-append rpterr-guid1 report-name rpterr-guid2)))
 
-          ;; dupe: report-guid is a duplicate
-          ((hash-ref *gnc:_report-templates_* report-guid)
+          ;; dupe: report-guid is a duplicate, unless of the stand-in
+          ;; of the report definition, which it replaces
+          ((and (hash-ref *gnc:_report-templates_* report-guid)
+                (not (hash-ref *gnc:_report-template-stubs_* report-guid)))
            (gui-error (string-append rpterr-dupe report-guid)))
 
           ;; good: new report definition, store into report-templates hash
           (else
+           (hash-remove! *gnc:_report-template-stubs_* report-guid)
+           (hash-set! *gnc:_report-template-modules_* report-guid
+                      (module-name (current-module)))
            (hash-set! *gnc:_report-templates_* report-guid report-rec)))))
 
       (((? not-a-field? fld) . _)
@@ -263,6 +284,92 @@ not found.")))
        ((record-modifier <report-template> field) report-rec val)
        (loop rest)))))
 
+;; The fields of a report template that are kept in the index of
+;; report templates, and those that are procedures, which the stand-in
+;; of the template has in place of the template's own.
+(define index-fields
+  '(version name report-guid in-menu? menu-path menu-name menu-tip
+            export-types))
+(define index-procedure-fields
+  '(options-generator options-cleanup-cb options-changed-cb renderer
+                      export-thunk))
+
+(define (gnc:report-template-module report-guid)
+  (hash-ref *gnc:_report-template-modules_* report-guid))
+
+;; What the index of report templates keeps of the template of
+;; report-guid, so that gnc:define-report-stub can make its stand-in
+;; without loading its module: an alist of the module name, the fields
+;; of index-fields and the list of the procedure fields it has.  #f if
+;; its fields can't be written and read back, or it's a custom report.
+(define (gnc:report-template-index-entry report-guid)
+  (define (readable? val)
+    (false-if-exception
+     (equal? val (call-with-input-string
+                     (call-with-output-string (lambda (port) (write val port)))
+                   read))))
+  (let ((templ (hash-ref *gnc:_report-templates_* report-guid)))
+    (and templ
+         (not (hash-ref *gnc:_report-template-stubs_* report-guid))
+         (not (gnc:report-template-parent-type templ))
+         (let ((fields (map (lambda (field)
+                              (cons field ((record-accessor <report-template> field)
+                                           templ)))
+                            index-fields)))
+           (and (every (compose readable? cdr) fields)
+                `((module . ,(gnc:report-template-module report-guid))
+                  ,@fields
+                  (procedures . ,(filter
+                                  (lambda (field)
+                                    ((record-accessor <report-template> field)
+                                     templ))
+                                  index-procedure-fields))))))))
+
+;; The template of report-guid, loading its module first if it has only
+;; a stand-in; #f if the module doesn't define it.
+(define (report-template-load report-guid)
+  (match (hash-ref *gnc:_report-template-stubs_* report-guid)
+    ((module . stub)
+     (gnc:debug "loading report module " module)
+     (catch #t
+       (lambda () (resolve-interface module))
+       (lambda args
+         (gnc:error "report module " module " failed to load: " args)))
+     (let ((templ (hash-ref *gnc:_report-templates_* report-guid)))
+       (cond
+        ((eq? templ stub)
+         (hash-remove! *gnc:_report-template-stubs_* report-guid)
+         (gnc:error "report module " module " doesn't define " report-guid)
+         #f)
+        (else templ))))
+    (#f (hash-ref *gnc:_report-templates_* report-guid))))
+
+;; Define the stand-in of a report template from its entry in the index
+;; of report templates, so that the report can be listed and in menus
+;; without its module.  The procedures of the stand-in load the module,
+;; whose gnc:define-report replaces the stand-in, and call the
+;; template's own.  Nothing is done if the template is already defined.
+(define (gnc:define-report-stub entry)
+  (let ((report-guid (assq-ref entry 'report-guid))
+        (module (assq-ref entry 'module))
+        (stub (make-report-template)))
+    (unless (hash-ref *gnc:_report-templates_* report-guid)
+      (for-each
+       (lambda (field)
+         ((record-modifier <report-template> field) stub (assq-ref entry field)))
+       index-fields)
+      (for-each
+       (lambda (field)
+         (let ((accessor (record-accessor <report-template> field)))
+           ((record-modifier <report-template> field) stub
+            (lambda args
+              (let ((templ (report-template-load report-guid)))
+                (and templ (apply (accessor templ) args)))))))
+       (assq-ref entry 'procedures))
+      (hash-set! *gnc:_report-template-modules_* report-guid module)
+      (hash-set! *gnc:_report-template-stubs_* report-guid (cons module stub))
+      (hash-set! *gnc:_report-templates_* report-guid stub))))
+
 (define (gnc:report-template-new-options/report-guid template-id template-name)
   (let ((templ (hash-ref *gnc:_report-templates_* template-id)))
     (and templ
@@ -541,6 +648,26 @@ not found.")))
     (gnc:report-custom-template report))
    ")"))
 
+;; Everything but the book that the output of a report depends on: its
+;; type and options, the options of its stylesheet and the keys of the
+;; reports it embeds.  gnc_run_report_with_error_handling caches the
+;; output under it.
+(define (gnc:report-cache-key report)
+  (let ((options (gnc:report-options report))
+        (stylesheet (gnc:report-stylesheet report)))
+    (string-append
+     (gnc:report-type report) "\n"
+     (gnc:generate-restore-forms options "options")
+     (if stylesheet
+         (gnc:generate-restore-forms
+          (gnc:html-style-sheet-options stylesheet) "options")
+         "")
+     (string-concatenate
+      (map (lambda (id)
+             (let ((subreport (gnc-report-find id)))
+               (if subreport (gnc:report-cache-key subreport) "")))
+           (or (gnc:report-embedded-list options) '()))))))
+
 ;; Generate guile code required to recreate embedded report instances
 (define (gnc:report-serialize-embedded embedded-reports)
   (let* ((result-string ""))
@@ -736,6 +863,20 @@ not found.")))
 ;; returns the html string.
 ;; Now accepts either an html-doc or finished HTML from the renderer -
 ;; the former requires further processing, the latter is just returned.
+;; calls thunk and returns its result. while reports are profiled (see
+;; gnc-report.h) the time it took is added to the counter name, so that
+;; it shows in the profile of the report.
+(define (gnc:report-profile-section name thunk)
+  (if (gnc-report-get-profiling)
+      (let ((start (get-internal-real-time)))
+        (call-with-values thunk
+          (lambda results
+            (gnc-report-profile-add
+             name (quotient (* (- (get-internal-real-time) start) 1000000)
+                            internal-time-units-per-second))
+            (apply values results))))
+      (thunk)))
+
 (define (gnc:report-render-html report headers?)
   (if (and (not (gnc:report-dirty? report))
            (gnc:report-ctext report))
@@ -744,12 +885,16 @@ not found.")))
         (and template
              (let* ((renderer (gnc:report-template-renderer template))
                     (stylesheet (gnc:report-stylesheet report))
-                    (doc (renderer report))
+                    (doc (gnc:report-profile-section
+                          "scheme.renderer" (lambda () (renderer report))))
                     (html (cond
                            ((string? doc) doc)
                            (else
                             (gnc:html-document-set-style-sheet! doc stylesheet)
-                            (gnc:html-document-render doc headers?)))))
+                            (gnc:report-profile-section
+                             "scheme.html-render"
+                             (lambda ()
+                               (gnc:html-document-render doc headers?)))))))
                (gnc:report-set-ctext! report html) ;; cache the html
                (gnc:report-set-dirty?! report #f)  ;; mark it clean
                html)))))
@@ -761,6 +906,35 @@ not found.")))
   (define (get-report) (gnc:report-render-html report #t))
   (gnc:apply-with-error-handling get-report '()))
 
+;; renders the report to port as it goes, without building its html
+;; string, for reports too large to hold in memory twice. the result
+;; isn't kept as the report's ctext.
+(define (gnc:report-render-to-port report port headers?)
+  (let ((template (hash-ref *gnc:_report-templates_* (gnc:report-type report))))
+    (and template
+         (let* ((renderer (gnc:report-template-renderer template))
+                (stylesheet (gnc:report-stylesheet report))
+                (doc (gnc:report-profile-section
+                      "scheme.renderer" (lambda () (renderer report)))))
+           (cond
+            ((string? doc) (display doc port))
+            (else
+             (gnc:html-document-set-style-sheet! doc stylesheet)
+             (gnc:report-profile-section
+              "scheme.html-render"
+              (lambda () (gnc:html-document-render doc headers? port)))))
+           #t))))
+
+;; render report into the file filename. returns a 2-element list like
+;; gnc:render-report, with #t in place of the html.
+(define (gnc:render-report-to-file report filename)
+  (define (render)
+    (call-with-output-file filename
+      (lambda (port)
+        (set-port-encoding! port "UTF-8")
+        (gnc:report-render-to-port report port #t))))
+  (gnc:apply-with-error-handling render '()))
+
 ;; looks up the report by id and renders it with gnc:report-render-html
 ;; marks the cursor busy during rendering; returns the html
 (define (gnc:report-run id)
@@ -450,12 +450,22 @@
   (define (amount->monetary bal)
     (gnc:make-gnc-monetary (xaccAccountGetCommodity account) (or bal 0)))
   (define balance 0)
-  (map amount->monetary
-       (gnc:account-accumulate-at-dates
-        account dates-list #:split->elt
-        (lambda (s)
-          (if s (set! balance (+ balance (or (split->amount s) 0))))
-          balance))))
+  (if (eq? split->amount xaccSplitGetAmount)
+      ;; plain balances come from the engine's running balances; it
+      ;; counts the splits strictly before each date, we count those
+      ;; on it too.
+      (map amount->monetary
+           (car (xaccAccountsGetBalancesAsOfDatesList
+                 (list account)
+                 (map (lambda (d) (if (< d (expt 2 62)) (1+ d) d))
+                      (sort dates-list <))
+                 #f #f)))
+      (map amount->monetary
+           (gnc:account-accumulate-at-dates
+            account dates-list #:split->elt
+            (lambda (s)
+              (if s (set! balance (+ balance (or (split->amount s) 0))))
+              balance)))))
 
 
 ;; this function will scan through account splitlist, building a list
@@ -42,3 +42,9 @@ gchar* gnc_get_default_report_font_family();
 
 void gnc_saved_reports_backup (void);
 gboolean gnc_saved_reports_write_to_file (const gchar* report_def, gboolean overwrite);
+
+gboolean gnc_report_get_profiling (void);
+void gnc_report_profile_add (const gchar *section, gint64 usecs);
+
+SCM gnc_report_exchange_snapshot_ref (const gchar *key);
+void gnc_report_exchange_snapshot_store (const gchar *key, SCM value);
@@ -26,9 +26,11 @@
 
 (define-module (gnucash report))
 (use-modules (gnucash utilities)) 
+(use-modules (ice-9 match))
 (use-modules (ice-9 regex))
 (use-modules (srfi srfi-1))
 (use-modules (srfi srfi-19))
+(use-modules (srfi srfi-26))
 (use-modules (gnucash core-utils))
 (use-modules (gnucash engine))
 (use-modules (gnucash app-utils))
@@ -55,6 +57,7 @@
 ;; Report uuids used for the category barcharts
 
 (export report-module-loader)
+(export report-module-lazy-loader)
 (export category-barchart-income-uuid)
 (export category-barchart-expense-uuid)
 (export category-barchart-asset-uuid)
@@ -65,6 +68,47 @@
 (define category-barchart-asset-uuid "e9cf815f79db44bcb637d0295093ae3d")
 (define category-barchart-liability-uuid "faf410e8f8da481fbc09e4763da40bcc")
 
+;; Returns a list of files in a directory
+;;
+;; Param:
+;;   dir - directory name
+;;
+;; Return value:
+;;   list of files in the directory
+(define (directory-files dir)
+  (cond
+    ((file-exists? dir)
+     (let ((dir-stream (opendir dir)))
+          (let loop ((fname (readdir dir-stream))
+                     (acc '()))
+                    (cond
+                      ((eof-object? fname)
+                       (closedir dir-stream)
+                       acc)
+                      (else
+                        (loop (readdir dir-stream)
+                              (if (string-suffix? ".scm" fname)
+                                  (cons (string-drop-right fname 4) acc)
+                                  acc)))))))
+    (else
+      (gnc:warn "Can't access " dir ".\nEmpty list will be returned.")
+      '())))
+
+(define (module-prefix-dir mod-prefix)
+  (gnc-build-scm-path (string-join (map symbol->string mod-prefix) "/")))
+
+;; Return a list of symbols representing modules in the directory
+;; matching the prefix
+;;
+;; Return value:
+;;  List of symbols for modules
+(define (get-module-list mod-prefix)
+  (let* ((mod-dir (module-prefix-dir mod-prefix))
+         (mod-list (directory-files mod-dir)))
+        (gnc:debug "mod-dir=" mod-dir)
+        (gnc:debug "dir-files=" mod-list)
+   (map string->symbol mod-list)))
+
 ;; Given a list of module prefixes, load all guile modules with these prefixes
 ;; This assumes the modules are located on the file system in a
 ;; path matching the module prefix
@@ -77,47 +121,6 @@
 ;; This function is non-recursive so it won't
 ;; descend in subdirectories.
 (define (report-module-loader mod-prefix-list)
-
-  ;; Returns a list of files in a directory
-  ;;
-  ;; Param:
-  ;;   dir - directory name
-  ;;
-  ;; Return value:
-  ;;   list of files in the directory
-  (define (directory-files dir)
-    (cond
-      ((file-exists? dir)
-       (let ((dir-stream (opendir dir)))
-            (let loop ((fname (readdir dir-stream))
-                       (acc '()))
-                      (cond
-                        ((eof-object? fname)
-                         (closedir dir-stream)
-                         acc)
-                        (else
-                          (loop (readdir dir-stream)
-                                (if (string-suffix? ".scm" fname)
-                                    (cons (string-drop-right fname 4) acc)
-                                    acc)))))))
-      (else
-        (gnc:warn "Can't access " dir ".\nEmpty list will be returned.")
-        '())))
-
-    ;; Return a list of symbols representing modules in the directory
-    ;; matching the prefix
-    ;;
-    ;; Return value:
-    ;;  List of symbols for modules
-  (define (get-module-list mod-prefix)
-    (let* ((subdir (string-join (map symbol->string mod-prefix) "/"))
-           (mod-dir (gnc-build-scm-path subdir))
-           (mod-list (directory-files mod-dir)))
-          (gnc:debug "rpt-subdir=" subdir)
-          (gnc:debug "mod-dir=" mod-dir)
-          (gnc:debug "dir-files=" mod-list)
-     (map string->symbol mod-list)))
-
   (for-each
     (lambda (mod-prefix)
       (for-each
@@ -129,5 +132,74 @@
         (get-module-list mod-prefix)))
     mod-prefix-list))
 
+;; Like report-module-loader, for the modules of report templates, but
+;; loading them only when one of their reports is first made or its
+;; options or renderer are asked for.  Until then their templates have
+;; stand-ins made from the index of report templates kept in the file
+;; index-name of the user data directory, so that they can be listed and
+;; put in menus.  The index is written after all the modules were loaded
+;; and used while the version of GnuCash, the prefixes and the files of
+;; the modules are the same.  The modules that define no templates or
+;; templates that can't be indexed, the ones that may do more than
+;; define templates, are always loaded.
+(define (report-module-lazy-loader mod-prefix-list index-name)
+  (define index-file (gnc-build-userdata-path index-name))
+  (define modules
+    (append-map
+     (lambda (mod-prefix)
+       (map (lambda (mod-file)
+              (let ((file (string-append (module-prefix-dir mod-prefix) "/"
+                                         (symbol->string mod-file) ".scm")))
+                (list (append mod-prefix (list mod-file))
+                      (and=> (stat file #f) stat:mtime))))
+            (get-module-list mod-prefix)))
+     mod-prefix-list))
+  (define stamp (list gnc:version mod-prefix-list modules))
+
+  (define (use-module module)
+    (module-use! (current-module) (resolve-interface module)))
+
+  (define (read-index)
+    (false-if-exception
+     (and (file-exists? index-file)
+          (call-with-input-file index-file read))))
+
+  (define (write-index)
+    (let* ((module-names (map car modules))
+           (entries (filter-map
+                     (lambda (guid)
+                       (let ((module (gnc:report-template-module guid)))
+                         (and (member module module-names)
+                              (list module (gnc:report-template-index-entry guid)))))
+                     (gnc:all-report-template-guids)))
+           (unindexed (filter-map (match-lambda ((module #f) module) (_ #f))
+                                  entries))
+           (eager (lset-difference
+                   equal? module-names
+                   (lset-difference equal? (map car entries) unindexed))))
+      (catch #t
+        (lambda ()
+          (call-with-output-file index-file
+            (lambda (port)
+              (write (list stamp eager
+                           (filter-map
+                            (match-lambda
+                              ((module entry)
+                               (and (not (member module eager)) entry)))
+                            entries))
+                     port))))
+        (lambda args
+          (gnc:warn "Can't write the index of report templates "
+                    index-file ": " args)))))
+
+  (match (read-index)
+    (((? (cut equal? <> stamp)) eager entries)
+     (gnc:debug "report templates from " index-file)
+     (for-each use-module eager)
+     (for-each gnc:define-report-stub entries))
+    (_
+     (for-each (compose use-module car) modules)
+     (write-index))))
+
 ;; Add hooks when this module is loaded
 (gnc-hook-add-scm-dangler HOOK-SAVE-OPTIONS gnc:save-style-sheet-options)
@@ -44,12 +44,15 @@
 (export gnc:owner-report-create)
 (export gnc:owner-report-create-with-enddate)
 
+;; The report modules are loaded when their reports are first used; the
+;; index of their templates is kept in report-templates-index.
 (let ((loc-spec (if (string-prefix? "de_DE" (gnc-locale-name)) 'de_DE 'us)))
-  (report-module-loader
+  (report-module-lazy-loader
    (list
     '(gnucash reports standard) ; prefix for standard reports included in gnucash
     '(gnucash reports example)  ; rexample for example reports included in gnucash
-    `(gnucash reports locale-specific ,loc-spec))))
+    `(gnucash reports locale-specific ,loc-spec))
+   "report-templates-index"))
 
 (define (gnc:register-report-create account split query journal? ledger-type?
                                     double? title debit-string credit-string)
@@ -77,6 +77,14 @@ exist but have no suitable transactions."))
   (qof-query-set-sort-order query (list SPLIT-TRANS TRANS-DATE-POSTED) '() '())
   (qof-query-set-sort-increasing query #t #t #t))
 
+;; the dates dividing the invoices into the 91+, 61-90, 31-60, 0-30
+;; days and current buckets
+(define (aging-bounds report-date)
+  (let lp ((begindate report-date) (n (- num-buckets 3)))
+    (if (zero? n)
+        (gnc:make-date-list begindate report-date ThirtyDayDelta)
+        (lp (decdate begindate ThirtyDayDelta) (1- n)))))
+
 (define (aging-options-generator options)
   (let* ((add-option
           (lambda (new-option)
@@ -171,9 +179,6 @@ exist but have no suitable transactions."))
     (not (or (eqv? type TXN-TYPE-INVOICE)
              (eqv? type TXN-TYPE-PAYMENT)))))
 
-(define (split-has-owner? split owner)
-  (gncOwnerEqual (gnc:split->owner split) owner))
-
 (define (split-owner-is-invalid? split)
   (not (gncOwnerIsValid (gnc:split->owner split))))
 
@@ -212,6 +217,7 @@ exist but have no suitable transactions."))
          (show-zeros (op-value gnc:pagename-general optname-show-zeros))
          (date-type (op-value gnc:pagename-general optname-date-driver))
          (query (qof-query-create-for-splits))
+         (aging-owners '())
          (document (gnc:make-html-document)))
 
     (define (sort-aging<? a b)
@@ -351,14 +357,33 @@ exist but have no suitable transactions."))
 
            (else
             (let* ((account (car accounts))
-                   (splits-acc-others (list-split splits split-from-acct? account)))
-
-              (let lp ((acc-splits (car splits-acc-others))
+                   (splits-acc-others (list-split splits split-from-acct? account))
+                   (invalid-splits
+                    (fold
+                     (lambda (split invalid-splits)
+                       (cond
+                        ;; txn type != TXN_TYPE_INVOICE or TXN_TYPE_PAYMENT.
+                        ((split-is-not-business? split)
+                         (let ((type (xaccTransGetTxnType (xaccSplitGetParent split))))
+                           (cons (list (format #f (G_ "Invalid Txn Type ~a") type) split)
+                                 invalid-splits)))
+                        ;; some payment splits may have no owner in this
+                        ;; account. skip. see bug 797506.
+                        ((split-owner-is-invalid? split)
+                         (gnc:warn "split " split " has no owner")
+                         (cons (list (G_ "Payment has no owner") split) invalid-splits))
+                        (else invalid-splits)))
+                     invalid-splits (car splits-acc-others))))
+
+              ;; the engine ages the lots of each owner in one pass
+              (let lp ((owners-aging (gncOwnerGetAgingList
+                                      account report-date
+                                      (aging-bounds report-date)
+                                      (not (eq? date-type 'postdate))))
                        (acc-totals (make-list (1+ num-buckets) 0))
-                       (invalid-splits invalid-splits)
                        (owners-and-aging '()))
 
-                (match acc-splits
+                (match owners-aging
                   (()
                    (loop (cdr accounts)
                          (cdr splits-acc-others)
@@ -368,38 +393,16 @@ exist but have no suitable transactions."))
                                    accounts-and-owners))
                          invalid-splits))
 
-                  ;; txn type != TXN_TYPE_INVOICE or TXN_TYPE_PAYMENT.
-                  (((? split-is-not-business? this) . rest)
-                   (let ((type (xaccTransGetTxnType (xaccSplitGetParent this))))
+                  (((owner buckets _) . rest)
+                   (let* ((aging (if receivable buckets (map - buckets)))
+                          (aging-total (apply + aging)))
+                     (set! aging-owners (cons owner aging-owners))
                      (lp rest
-                         acc-totals
-                         (cons (list (format #f (G_ "Invalid Txn Type ~a") type) this)
-                               invalid-splits)
-                         owners-and-aging)))
-
-                  ;; some payment splits may have no owner in this
-                  ;; account. skip. see bug 797506.
-                  (((? split-owner-is-invalid? this) . rest)
-                   (gnc:warn "split " this " has no owner")
-                   (lp rest
-                       acc-totals
-                       (cons (list (G_ "Payment has no owner") this) invalid-splits)
-                       owners-and-aging))
-
-                  ((this . _)
-                   (match-let* ((owner (gnc:split->owner this))
-                                ((owner-splits . other-owner-splits)
-                                 (list-split acc-splits split-has-owner? owner))
-                                (aging (gnc:owner-splits->aging-list
-                                        owner-splits num-buckets report-date
-                                        date-type receivable))
-                                (aging-total (apply + aging)))
-                     (lp other-owner-splits
                          (map + acc-totals (reverse (cons aging-total aging)))
-                         invalid-splits
                          (if (or show-zeros (any (negate zero?) aging))
                              (cons (list owner aging aging-total) owners-and-aging)
                              owners-and-aging)))))))))))))
+    (for-each gncOwnerFree aging-owners)
     (gnc:report-finished)
     document))
 
@@ -752,6 +752,24 @@ HTML Document Title</title></head><body></body>\n\
       )
     (test-end "HTML Table - Table Rendering")
 
+    (test-begin "HTML Table - Rendering to a port")
+    (let ((test-doc (gnc:make-html-document))
+          (test-table (gnc:make-html-table))
+          (inner-table (gnc:make-html-table)))
+      (gnc:html-table-append-row! inner-table '("inner"))
+      (gnc:html-table-set-col-headers! test-table '("A" "B"))
+      (gnc:html-table-append-row! test-table (list "Row 1" inner-table))
+      (gnc:html-table-append-row! test-table '("Row 2" "x"))
+      (gnc:html-document-add-object! test-doc test-table)
+      (gnc:html-document-add-object!
+       test-doc (gnc:make-html-text (gnc:html-markup-p "after")))
+      (test-equal "HTML Table - document written to a port as rendered to a string"
+        (gnc:html-document-render test-doc)
+        (call-with-output-string
+          (lambda (port)
+            (gnc:html-document-render test-doc #t port)))))
+    (test-end "HTML Table - Rendering to a port")
+
     (test-begin "html-table arbitrary row/col modification")
     (let ((doc (gnc:make-html-document))
           (table (gnc:make-html-table)))
@@ -17,6 +17,7 @@
   (test-report-template-getters)
   (test-make-report)
   (test-report)
+  (test-report-stub)
   (test-end "Testing/Temporary/test-report"))
 
 (define test4-guid "54c2fc051af64a08ba2334c2e9179e24")
@@ -221,3 +222,45 @@
     (test-assert "gnc:report-serialize = string"
       (string?
        (gnc:report-serialize report)))))
+
+(define (test-report-stub)
+  (define hello-world '(gnucash reports example hello-world))
+  (define hello-world-guid "898d78ec92854402bf76e20a36d24ade")
+  (test-begin "test-report-stub")
+  (gnc:define-report-stub
+   `((module . ,hello-world)
+     (version . 1)
+     (name . "Hello, World")
+     (report-guid . ,hello-world-guid)
+     (in-menu? . #t)
+     (menu-path . ("_Examples"))
+     (menu-name . "Sample Report with Examples")
+     (menu-tip . "A sample report with examples.")
+     (export-types . #f)
+     (procedures . (options-generator renderer))))
+  (let ((stub (gnc:find-report-template hello-world-guid)))
+    (test-equal "stand-in has the menu name"
+      "Sample Report with Examples"
+      (gnc:report-template-menu-name stub))
+    (test-assert "the module isn't loaded with the stand-in"
+      (not (resolve-module hello-world #f #:ensure #f)))
+    (test-assert "the options of the stand-in are the template's"
+      (gnc:lookup-option (gnc:report-template-new-options stub)
+                         "Hello, World!" "Boolean Option"))
+    (test-assert "the module defines the template in place of the stand-in"
+      (not (eq? stub (gnc:find-report-template hello-world-guid))))
+    (test-equal "the template's module is known"
+      hello-world
+      (gnc:report-template-module hello-world-guid))
+    (test-equal "the index entry of the template"
+      '(options-generator renderer)
+      (assq-ref (gnc:report-template-index-entry hello-world-guid)
+                'procedures))
+    (gnc:define-report-stub
+     `((module . ,hello-world)
+       (report-guid . ,hello-world-guid)
+       (procedures . ())))
+    (test-assert "a stand-in doesn't replace a template"
+      (gnc:report-template-renderer
+       (gnc:find-report-template hello-world-guid))))
+  (test-end "test-report-stub"))
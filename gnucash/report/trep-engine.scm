@@ -154,6 +154,7 @@ in the Options panel."))
   ;; together with the subtotal functions. Each entry:
   ;;  'sortkey             - sort parameter sent via qof-query
   ;;  'split-sortvalue     - function retrieves number/string for comparing splits
+  ;;  'split-table-key     - key the split table sorts and groups on
   ;;  'text                - text displayed in Display tab
   ;;  'tip                 - tooltip displayed in Display tab
   ;;  'renderer-fn         - helper function to select subtotal/subheading renderer
@@ -166,6 +167,7 @@ in the Options panel."))
               (cons 'sortkey (list SPLIT-ACCT-FULLNAME))
               (cons 'split-sortvalue
                     (compose gnc-account-get-full-name xaccSplitGetAccount))
+              (cons 'split-table-key GNC-SPLIT-TABLE-KEY-ACCOUNT-NAME)
               (cons 'text (G_ "Account Name"))
               (cons 'tip (G_ "Sort & subtotal by account name."))
               (cons 'renderer-fn xaccSplitGetAccount))
@@ -173,6 +175,7 @@ in the Options panel."))
         (list 'account-code
               (cons 'sortkey (list SPLIT-ACCOUNT ACCOUNT-CODE-))
               (cons 'split-sortvalue (compose xaccAccountGetCode xaccSplitGetAccount))
+              (cons 'split-table-key GNC-SPLIT-TABLE-KEY-ACCOUNT-CODE)
               (cons 'text (G_ "Account Code"))
               (cons 'tip (G_ "Sort & subtotal by account code."))
               (cons 'renderer-fn xaccSplitGetAccount))
@@ -180,6 +183,7 @@ in the Options panel."))
         (list 'date
               (cons 'sortkey (list SPLIT-TRANS TRANS-DATE-POSTED))
               (cons 'split-sortvalue (compose xaccTransGetDate xaccSplitGetParent))
+              (cons 'split-table-key GNC-SPLIT-TABLE-KEY-DATE)
               (cons 'text (G_ "Date"))
               (cons 'tip (G_ "Sort by date."))
               (cons 'renderer-fn #f))
@@ -187,6 +191,7 @@ in the Options panel."))
         (list 'reconciled-date
               (cons 'sortkey (list SPLIT-DATE-RECONCILED))
               (cons 'split-sortvalue xaccSplitGetDateReconciled)
+              (cons 'split-table-key GNC-SPLIT-TABLE-KEY-RECONCILED-DATE)
               (cons 'text (G_ "Reconciled Date"))
               (cons 'tip (G_ "Sort by the Reconciled Date."))
               (cons 'renderer-fn #f))
@@ -196,6 +201,7 @@ in the Options panel."))
               (cons 'split-sortvalue (lambda (s)
                                        (length (memv (xaccSplitGetReconcile s)
                                                      (map car reconcile-list)))))
+              (cons 'split-table-key GNC-SPLIT-TABLE-KEY-RECONCILED-STATUS)
               (cons 'text (G_ "Reconciled Status"))
               (cons 'tip (G_ "Sort by the Reconciled Status"))
               (cons 'renderer-fn (lambda (s)
@@ -205,6 +211,7 @@ in the Options panel."))
         (list 'register-order
               (cons 'sortkey (list QUERY-DEFAULT-SORT))
               (cons 'split-sortvalue #f)
+              (cons 'split-table-key GNC-SPLIT-TABLE-KEY-REGISTER-ORDER)
               (cons 'text (G_ "Register Order"))
               (cons 'tip (G_ "Sort as in the register."))
               (cons 'renderer-fn #f))
@@ -212,6 +219,7 @@ in the Options panel."))
         (list 'corresponding-acc-name
               (cons 'sortkey (list SPLIT-CORR-ACCT-NAME))
               (cons 'split-sortvalue xaccSplitGetCorrAccountFullName)
+              (cons 'split-table-key GNC-SPLIT-TABLE-KEY-CORR-ACCOUNT-NAME)
               (cons 'text (G_ "Other Account Name"))
               (cons 'tip (G_ "Sort by account transferred from/to's name."))
               (cons 'renderer-fn (compose xaccSplitGetAccount xaccSplitGetOtherSplit)))
@@ -219,6 +227,7 @@ in the Options panel."))
         (list 'corresponding-acc-code
               (cons 'sortkey (list SPLIT-CORR-ACCT-CODE))
               (cons 'split-sortvalue xaccSplitGetCorrAccountCode)
+              (cons 'split-table-key GNC-SPLIT-TABLE-KEY-CORR-ACCOUNT-CODE)
               (cons 'text (G_ "Other Account Code"))
               (cons 'tip (G_ "Sort by account transferred from/to's code."))
               (cons 'renderer-fn (compose xaccSplitGetAccount xaccSplitGetOtherSplit)))
@@ -226,6 +235,7 @@ in the Options panel."))
         (list 'amount
               (cons 'sortkey (list SPLIT-VALUE))
               (cons 'split-sortvalue xaccSplitGetValue)
+              (cons 'split-table-key GNC-SPLIT-TABLE-KEY-AMOUNT)
               (cons 'text (G_ "Amount"))
               (cons 'tip (G_ "Sort by amount."))
               (cons 'renderer-fn #f))
@@ -234,6 +244,7 @@ in the Options panel."))
               (cons 'sortkey (list SPLIT-TRANS TRANS-DESCRIPTION))
               (cons 'split-sortvalue (compose xaccTransGetDescription
                                               xaccSplitGetParent))
+              (cons 'split-table-key GNC-SPLIT-TABLE-KEY-DESCRIPTION)
               (cons 'text (G_ "Description"))
               (cons 'tip (G_ "Sort by description."))
               (cons 'renderer-fn (compose xaccTransGetDescription xaccSplitGetParent)))
@@ -242,6 +253,7 @@ in the Options panel."))
             (list 'number
                   (cons 'sortkey (list SPLIT-ACTION))
                   (cons 'split-sortvalue xaccSplitGetAction)
+                  (cons 'split-table-key GNC-SPLIT-TABLE-KEY-ACTION)
                   (cons 'text (G_ "Number/Action"))
                   (cons 'tip (G_ "Sort by check number/action."))
                   (cons 'renderer-fn #f))
@@ -249,6 +261,7 @@ in the Options panel."))
             (list 'number
                   (cons 'sortkey (list SPLIT-TRANS TRANS-NUM))
                   (cons 'split-sortvalue (compose xaccTransGetNum xaccSplitGetParent))
+                  (cons 'split-table-key GNC-SPLIT-TABLE-KEY-NUMBER)
                   (cons 'text (G_ "Number"))
                   (cons 'tip (G_ "Sort by check/transaction number."))
                   (cons 'renderer-fn #f)))
@@ -256,6 +269,7 @@ in the Options panel."))
         (list 't-number
               (cons 'sortkey (list SPLIT-TRANS TRANS-NUM))
               (cons 'split-sortvalue (compose xaccTransGetNum xaccSplitGetParent))
+              (cons 'split-table-key GNC-SPLIT-TABLE-KEY-NUMBER)
               (cons 'text (G_ "Transaction Number"))
               (cons 'tip (G_ "Sort by transaction number."))
               (cons 'renderer-fn #f))
@@ -263,6 +277,7 @@ in the Options panel."))
         (list 'memo
               (cons 'sortkey (list SPLIT-MEMO))
               (cons 'split-sortvalue xaccSplitGetMemo)
+              (cons 'split-table-key GNC-SPLIT-TABLE-KEY-MEMO)
               (cons 'text (G_ "Memo"))
               (cons 'tip (G_ "Sort by memo."))
               (cons 'renderer-fn xaccSplitGetMemo))
@@ -270,6 +285,7 @@ in the Options panel."))
         (list 'notes
               (cons 'sortkey #f)
               (cons 'split-sortvalue (compose xaccTransGetNotes xaccSplitGetParent))
+              (cons 'split-table-key GNC-SPLIT-TABLE-KEY-NOTES)
               (cons 'text (G_ "Notes"))
               (cons 'tip (G_ "Sort by transaction notes."))
               (cons 'renderer-fn (compose xaccTransGetNotes xaccSplitGetParent)))
@@ -277,6 +293,7 @@ in the Options panel."))
         (list 'none
               (cons 'sortkey '())
               (cons 'split-sortvalue #f)
+              (cons 'split-table-key GNC-SPLIT-TABLE-KEY-NONE)
               (cons 'text (G_ "None"))
               (cons 'tip (G_ "Do not sort."))
               (cons 'renderer-fn #f))))
@@ -301,6 +318,7 @@ in the Options panel."))
   ;; List for date option.
   ;; Defines the different date sorting keys, as an association-list. Each entry:
   ;;  'split-sortvalue     - func retrieves number/string used for comparing splits
+  ;;  'split-table-date    - date grouping the split table sorts and groups on
   ;;  'text                - text displayed in Display tab
   ;;  'tip                 - tooltip displayed in Display tab
   ;;  'renderer-fn         - func retrieves string for subtotal/subheading renderer
@@ -309,21 +327,21 @@ in the Options panel."))
   (list
    (list 'none
          (cons 'split-sortvalue #f)
-         (cons 'date-sortvalue #f)
+         (cons 'split-table-date GNC-SPLIT-TABLE-DATE-NONE)
          (cons 'text (G_ "None"))
          (cons 'tip (G_ "None."))
          (cons 'renderer-fn #f))
 
    (list 'daily
          (cons 'split-sortvalue (lambda (s) (time64-day (split->time64 s))))
-         (cons 'date-sortvalue time64-day)
+         (cons 'split-table-date GNC-SPLIT-TABLE-DATE-DAY)
          (cons 'text (G_ "Daily"))
          (cons 'tip (G_ "Daily."))
          (cons 'renderer-fn (lambda (s) (qof-print-date (split->time64 s)))))
 
    (list 'weekly
          (cons 'split-sortvalue (lambda (s) (time64-week (split->time64 s))))
-         (cons 'date-sortvalue time64-week)
+         (cons 'split-table-date GNC-SPLIT-TABLE-DATE-WEEK)
          (cons 'text (G_ "Weekly"))
          (cons 'tip (G_ "Weekly."))
          (cons 'renderer-fn (compose gnc:date-get-week-year-string
@@ -332,7 +350,7 @@ in the Options panel."))
 
    (list 'monthly
          (cons 'split-sortvalue (lambda (s) (time64-month (split->time64 s))))
-         (cons 'date-sortvalue time64-month)
+         (cons 'split-table-date GNC-SPLIT-TABLE-DATE-MONTH)
          (cons 'text (G_ "Monthly"))
          (cons 'tip (G_ "Monthly."))
          (cons 'renderer-fn (compose gnc:date-get-month-year-string
@@ -341,7 +359,7 @@ in the Options panel."))
 
    (list 'quarterly
          (cons 'split-sortvalue (lambda (s) (time64-quarter (split->time64 s))))
-         (cons 'date-sortvalue time64-quarter)
+         (cons 'split-table-date GNC-SPLIT-TABLE-DATE-QUARTER)
          (cons 'text (G_ "Quarterly"))
          (cons 'tip (G_ "Quarterly."))
          (cons 'renderer-fn (compose gnc:date-get-quarter-year-string
@@ -350,7 +368,7 @@ in the Options panel."))
 
    (list 'yearly
          (cons 'split-sortvalue (lambda (s) (time64-year (split->time64 s))))
-         (cons 'date-sortvalue time64-year)
+         (cons 'split-table-date GNC-SPLIT-TABLE-DATE-YEAR)
          (cons 'text (G_ "Yearly"))
          (cons 'tip (G_ "Yearly."))
          (cons 'renderer-fn (compose gnc:date-get-year-string
@@ -475,6 +493,43 @@ Credit Card, and Income accounts."))
       (keylist-get-info keylist (car item) 'tip)))
    keylist))
 
+(define (vector-filter->list pred vec)
+  ;; the elements of vec for which pred is true, as a list, calling
+  ;; pred on them in order.
+  (let ((len (vector-length vec)))
+    (let lp ((i 0) (result '()))
+      (if (= i len)
+          (reverse! result)
+          (let ((elt (vector-ref vec i)))
+            (lp (1+ i) (if (pred elt) (cons elt result) result)))))))
+
+(define (archive-query-splits query begindate unique?)
+  ;; the splits the query finds in the current book's archive, as a
+  ;; vector, if the report starts before the archive date. the query's
+  ;; book mustn't be set yet. the archive's splits are in its copies of
+  ;; the accounts and commodities, with the same guids and names.
+  (let* ((book (gnc-get-current-book))
+         (archive (and (< begindate (gnc-book-archive-get-date book))
+                       (gnc-book-archive-get-book book))))
+    (if (and archive (not (null? archive)))
+        (let ((q (qof-query-copy query)))
+          (qof-query-set-book q archive)
+          (let ((splits (if unique?
+                            (xaccQueryGetSplitsUniqueTransVector q)
+                            (qof-query-run-vector q))))
+            (qof-query-destroy q)
+            splits))
+        #())))
+
+(define (archive-accounts accounts)
+  ;; the copies of the accounts in the current book's archive
+  (let ((archive (gnc-book-archive-get-book (gnc-get-current-book))))
+    (filter-map
+     (lambda (acc)
+       (let ((copy (xaccAccountLookup (gncAccountGetGUID acc) archive)))
+         (and copy (not (null? copy)) copy)))
+     accounts)))
+
 (define (SUBTOTAL-ENABLED? sortkey split-action?)
   ;; this returns whether sortkey *can* be subtotalled/grouped.
   ;; it checks whether a renderer-fn is defined.
@@ -1076,7 +1131,7 @@ be excluded from periodic reporting.")
 ;; ;;;;;;;;;;;;;;;;;;;;
 ;; Here comes the big function that builds the whole table.
 
-(define (make-split-table splits options custom-calculated-cells
+(define (make-split-table splits split-table options custom-calculated-cells
                           begindate enddate c_account_1)
 
   (define (opt-val section name)
@@ -1808,10 +1863,8 @@ be excluded from periodic reporting.")
              split-values)
 
             (cond
-             ((and primary-subtotal-comparator
-                   (or (not next)
-                       (not (equal? (primary-subtotal-comparator current)
-                                    (primary-subtotal-comparator next)))))
+             ((gnc-split-table-row-ends-group
+               split-table work-done GNC-SPLIT-TABLE-PRIMARY)
               (when secondary-subtotal-comparator
                 (add-subtotal-row (total-string
                                    (render-summary current 'secondary #f))
@@ -1847,10 +1900,8 @@ be excluded from periodic reporting.")
                                   'secondary))))
 
              (else
-              (when (and secondary-subtotal-comparator
-                         (or (not next)
-                             (not (equal? (secondary-subtotal-comparator current)
-                                          (secondary-subtotal-comparator next)))))
+              (when (gnc-split-table-row-ends-group
+                     split-table work-done GNC-SPLIT-TABLE-SECONDARY)
                 (add-subtotal-row (total-string
                                    (render-summary current 'secondary #f))
                                   secondary-subtotal-collectors
@@ -2078,6 +2129,8 @@ warning will be removed in GnuCash 5.0"))
                          (opt-val pagename-filter optname-closing-transactions)
                          'closing-match))
          (splits '())
+         (archived-splits #())
+         (split-table #f)
          (custom-sort? (or (and (memq primary-key DATE-SORTING-TYPES)
                                 (not (eq? primary-date-subtotal 'none)))
                            (and (memq secondary-key DATE-SORTING-TYPES)
@@ -2103,43 +2156,10 @@ warning will be removed in GnuCash 5.0"))
        (else
         (string-contains str transaction-matcher))))
 
-    (define (generic-less? split-X split-Y sortkey date-subtotal-key ascend?)
-      ;; compare splits X and Y, whereby
-      ;; sortkey and date-subtotal-key specify the options used
-      ;; ascend? specifies whether ascending or descending
-      (let* ((comparator-function
-              (if (memq sortkey DATE-SORTING-TYPES)
-                  (let ((date (keylist-get-info
-                               (sortkey-list BOOK-SPLIT-ACTION)
-                               sortkey 'split-sortvalue))
-                        (date-comparator
-                         (keylist-get-info date-subtotal-list
-                                           date-subtotal-key 'date-sortvalue)))
-                    (lambda (s)
-                      (and date-comparator (date-comparator (date s)))))
-                  (or (keylist-get-info (sortkey-list BOOK-SPLIT-ACTION)
-                                        sortkey 'split-sortvalue)
-                      (lambda (s) #f))))
-             (value-of-X (comparator-function split-X))
-             (value-of-Y (comparator-function split-Y))
-             (op (if (string? value-of-X)
-                     (if ascend? gnc:string-locale<? gnc:string-locale>?)
-                     (if ascend? < >))))
-        (and value-of-X (op value-of-X value-of-Y))))
-
-    (define (primary-comparator? X Y)
-      (generic-less? X Y primary-key
-                     primary-date-subtotal
-                     (eq? primary-order 'ascend)))
-
-    (define (secondary-comparator? X Y)
-      (generic-less? X Y secondary-key
-                     secondary-date-subtotal
-                     (eq? secondary-order 'ascend)))
-
-    ;; This will, by default, sort the split list by ascending posted-date.
-    (define (date-comparator? X Y)
-      (generic-less? X Y 'date 'none #t))
+    (define (subtotal? sortkey date-subtotal optname-subtotal)
+      (if (memq sortkey DATE-SORTING-TYPES)
+          (not (eq? date-subtotal 'none))
+          (opt-val pagename-sorting optname-subtotal)))
 
     (define (transaction-filter-match split)
       (or (match? (xaccTransGetDescription (xaccSplitGetParent split)))
@@ -2184,7 +2204,6 @@ warning will be removed in GnuCash 5.0"))
          (gnc:html-render-options-changed options))))
 
      (else
-      (qof-query-set-book query (gnc-get-current-book))
       (xaccQueryAddAccountMatch query c_account_1 QOF-GUID-MATCH-ANY QOF-QUERY-AND)
       (xaccQueryAddClearedMatch query cleared-filter QOF-QUERY-AND)
       (unless split->date
@@ -2201,9 +2220,22 @@ warning will be removed in GnuCash 5.0"))
          query (eq? primary-order 'ascend) (eq? secondary-order 'ascend)
          #t))
 
-      (if (opt-val "__trep" "unique-transactions")
-          (set! splits (xaccQueryGetSplitsUniqueTrans query))
-          (set! splits (qof-query-run query)))
+      ;; Transactions moved to an archive file are found there.
+      (set! archived-splits
+        (gnc:report-profile-section
+         "trep.archive-query"
+         (lambda ()
+           (archive-query-splits query begindate
+                                 (opt-val "__trep" "unique-transactions")))))
+
+      (qof-query-set-book query (gnc-get-current-book))
+      (set! splits
+        (gnc:report-profile-section
+         "trep.query"
+         (lambda ()
+           (if (opt-val "__trep" "unique-transactions")
+               (xaccQueryGetSplitsUniqueTransVector query)
+               (qof-query-run-vector query)))))
 
       (qof-query-destroy query)
 
@@ -2212,31 +2244,60 @@ warning will be removed in GnuCash 5.0"))
       ;; - include/exclude splits to/from selected accounts
       ;; - substring/regex matcher for Transaction Description/Notes/Memo
       ;; - custom-split-filter, a split->bool function for derived reports
+      ;; The query gives a vector, so only the splits kept become a list.
+      ;; The archive's splits are filtered on its copies of the accounts.
       (set! splits
-        (filter
-         (lambda (split)
-           (let* ((trans (xaccSplitGetParent split)))
-             (and (or (not split->date)
-                      (let ((date (split->date split)))
-                        (if date
-                            (<= begindate date enddate)
-                            split->date-include-false?)))
-                  (case filter-mode
-                    ((none) #t)
-                    ((include) (is-filter-member split c_account_2))
-                    ((exclude) (not (is-filter-member split c_account_2))))
-                  (or (string-null? transaction-matcher)
-                      (if transaction-filter-exclude?
-                          (not (transaction-filter-match split))
-                          (transaction-filter-match split)))
-                  (or (not custom-split-filter)
-                      (custom-split-filter split)))))
-         splits))
-
-      (when custom-sort?
-        (set! splits (stable-sort! splits date-comparator?))
-        (set! splits (stable-sort! splits secondary-comparator?))
-        (set! splits (stable-sort! splits primary-comparator?)))
+        (gnc:report-profile-section
+         "trep.filter"
+         (lambda ()
+           (define (keep-split? filter-accounts)
+             (lambda (split)
+               (and (or (not split->date)
+                        (let ((date (split->date split)))
+                          (if date
+                              (<= begindate date enddate)
+                              split->date-include-false?)))
+                    (case filter-mode
+                      ((none) #t)
+                      ((include) (is-filter-member split filter-accounts))
+                      ((exclude) (not (is-filter-member split filter-accounts))))
+                    (or (string-null? transaction-matcher)
+                        (if transaction-filter-exclude?
+                            (not (transaction-filter-match split))
+                            (transaction-filter-match split)))
+                    (or (not custom-split-filter)
+                        (custom-split-filter split)))))
+           (append
+            (if (zero? (vector-length archived-splits))
+                '()
+                (vector-filter->list
+                 (keep-split? (archive-accounts c_account_2))
+                 archived-splits))
+            (vector-filter->list (keep-split? c_account_2) splits)))))
+
+      ;; The split table sorts the splits, unless the query did, and
+      ;; finds where the subtotals go.
+      (set! split-table
+        (gnc:report-profile-section
+         "trep.split-table"
+         (lambda ()
+           (gnc-split-table-new-list
+            splits
+            (keylist-get-info (sortkey-list BOOK-SPLIT-ACTION)
+                              primary-key 'split-table-key)
+            (keylist-get-info date-subtotal-list
+                              primary-date-subtotal 'split-table-date)
+            (eq? primary-order 'ascend)
+            (subtotal? primary-key primary-date-subtotal optname-prime-subtotal)
+            (keylist-get-info (sortkey-list BOOK-SPLIT-ACTION)
+                              secondary-key 'split-table-key)
+            (keylist-get-info date-subtotal-list
+                              secondary-date-subtotal 'split-table-date)
+            (eq? secondary-order 'ascend)
+            (subtotal? secondary-key secondary-date-subtotal optname-sec-subtotal)
+            ;; the query sorted the splits of each book, not both
+            (or custom-sort? (positive? (vector-length archived-splits)))))))
+      (set! splits (gnc-split-table-get-splits split-table))
 
       (cond
        ((null? splits)
@@ -2256,8 +2317,12 @@ warning will be removed in GnuCash 5.0"))
 
        (else
         (let-values (((table grid csvlist)
-                      (make-split-table splits options custom-calculated-cells
-                                        begindate enddate c_account_1)))
+                      (gnc:report-profile-section
+                       "trep.build-table"
+                       (lambda ()
+                         (make-split-table splits split-table options
+                                           custom-calculated-cells
+                                           begindate enddate c_account_1)))))
 
           (gnc:html-document-set-title! document report-title)
 
@@ -2309,7 +2374,9 @@ warning will be removed in GnuCash 5.0"))
                    csvlist)))))
 
              (else
-              (gnc:html-document-set-export-error document csvlist))))))))))
+              (gnc:html-document-set-export-error document csvlist)))))))
+
+      (gnc-split-table-destroy split-table))))
 
     (gnc:report-finished)
 
@@ -32,20 +32,43 @@
 #include "gnc-ui-util.h"
 
 
+/* The text of a node is shared by every node on the way to the end of the
+ * string it came from, so it is allocated once per inserted string and
+ * reference counted. */
+typedef struct
+{
+    guint refs;
+    int len;             /* number of chars in str                */
+    char str[1];
+} QuickFillText;
+
+typedef struct
+{
+    gunichar key;        /* the upper case letter leading to qf   */
+    QuickFill *qf;
+} QuickFillMatch;
+
+/* The tree has a node for every prefix, since the API hands those out,
+ * but a string that shares no more of its letters with any other ends in
+ * a chain of nodes that would all hold that same string.  Such a chain is
+ * kept as a tail, the rest of text to be turned into nodes only when a
+ * lookup or another string goes down that way. */
 struct _QuickFill
 {
-    char *text;          /* the first matching text string     */
-    int len;             /* number of chars in text string     */
-    GHashTable *matches; /* array of children in the tree      */
+    QuickFillText *text;     /* the first matching text string     */
+    const char *tail;        /* the letters of text below, or NULL */
+    guint n_matches;
+    guint max_matches;
+    QuickFillMatch *matches; /* children, sorted by key            */
 };
 
 
 /** PROTOTYPES ******************************************************/
-static void quickfill_insert_recursive (QuickFill *qf, const char *text, int len,
+static void quickfill_insert_recursive (QuickFill *qf, QuickFillText *text,
                                         const char* next_char, QuickFillSort sort);
 
 static void gnc_quickfill_remove_recursive (QuickFill *qf, const gchar *text,
-        gint depth, QuickFillSort sort);
+        const gchar *next_char, QuickFillSort sort);
 
 /* This static indicates the debugging module that this .o belongs to.  */
 static QofLogModule log_module = GNC_MOD_REGISTER;
@@ -53,6 +76,45 @@ static QofLogModule log_module = GNC_MOD_REGISTER;
 /********************************************************************\
 \********************************************************************/
 
+static QuickFillText *
+quickfill_text_new (const char *str, int len)
+{
+    size_t size = strlen (str);
+    QuickFillText *text = g_malloc (sizeof (QuickFillText) + size);
+
+    text->refs = 1;
+    text->len = len;
+    memcpy (text->str, str, size + 1);
+    return text;
+}
+
+static QuickFillText *
+quickfill_text_ref (QuickFillText *text)
+{
+    if (text)
+        text->refs++;
+    return text;
+}
+
+static void
+quickfill_text_unref (QuickFillText *text)
+{
+    if (text && --text->refs == 0)
+        g_free (text);
+}
+
+/* Set qf's text to text, which may be NULL. */
+static void
+quickfill_set_text (QuickFill *qf, QuickFillText *text)
+{
+    quickfill_text_ref (text);
+    quickfill_text_unref (qf->text);
+    qf->text = text;
+}
+
+/********************************************************************\
+\********************************************************************/
+
 QuickFill *
 gnc_quickfill_new (void)
 {
@@ -67,9 +129,10 @@ gnc_quickfill_new (void)
     qf = g_new (QuickFill, 1);
 
     qf->text = NULL;
-    qf->len = 0;
-
-    qf->matches = g_hash_table_new (g_direct_hash, g_direct_equal);
+    qf->tail = NULL;
+    qf->n_matches = 0;
+    qf->max_matches = 0;
+    qf->matches = NULL;
 
     return qf;
 }
@@ -77,11 +140,18 @@ gnc_quickfill_new (void)
 /********************************************************************\
 \********************************************************************/
 
-static gboolean
-destroy_helper (gpointer key, gpointer value, gpointer data)
+static void
+quickfill_clear_matches (QuickFill *qf)
 {
-    gnc_quickfill_destroy (value);
-    return TRUE;
+    guint i;
+
+    for (i = 0; i < qf->n_matches; i++)
+        gnc_quickfill_destroy (qf->matches[i].qf);
+
+    g_free (qf->matches);
+    qf->matches = NULL;
+    qf->n_matches = 0;
+    qf->max_matches = 0;
 }
 
 void
@@ -90,14 +160,9 @@ gnc_quickfill_destroy (QuickFill *qf)
     if (qf == NULL)
         return;
 
-    g_hash_table_foreach (qf->matches, (GHFunc)destroy_helper, NULL);
-    g_hash_table_destroy (qf->matches);
-    qf->matches = NULL;
-
-    if (qf->text)
-        g_free(qf->text);
-    qf->text = NULL;
-    qf->len = 0;
+    quickfill_clear_matches (qf);
+    quickfill_set_text (qf, NULL);
+    qf->tail = NULL;
 
     g_free (qf);
 }
@@ -108,12 +173,9 @@ gnc_quickfill_purge (QuickFill *qf)
     if (qf == NULL)
         return;
 
-    g_hash_table_foreach_remove (qf->matches, destroy_helper, NULL);
-
-    if (qf->text)
-        g_free (qf->text);
-    qf->text = NULL;
-    qf->len = 0;
+    quickfill_clear_matches (qf);
+    quickfill_set_text (qf, NULL);
+    qf->tail = NULL;
 }
 
 /********************************************************************\
@@ -122,10 +184,83 @@ gnc_quickfill_purge (QuickFill *qf)
 const char *
 gnc_quickfill_string (QuickFill *qf)
 {
-    if (qf == NULL)
+    if (qf == NULL || qf->text == NULL)
         return NULL;
 
-    return qf->text;
+    return qf->text->str;
+}
+
+/********************************************************************\
+\********************************************************************/
+
+/* Find the child for key, or where it belongs in the sorted matches. */
+static gboolean
+quickfill_find_match (QuickFill *qf, gunichar key, guint *pos)
+{
+    guint low = 0, high = qf->n_matches;
+
+    while (low < high)
+    {
+        guint mid = low + (high - low) / 2;
+
+        if (qf->matches[mid].key == key)
+        {
+            *pos = mid;
+            return TRUE;
+        }
+        if (qf->matches[mid].key < key)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    *pos = low;
+    return FALSE;
+}
+
+static void
+quickfill_add_match (QuickFill *qf, guint pos, gunichar key, QuickFill *match_qf)
+{
+    if (qf->n_matches == qf->max_matches)
+    {
+        qf->max_matches = qf->max_matches ? 2 * qf->max_matches : 1;
+        qf->matches = g_renew (QuickFillMatch, qf->matches, qf->max_matches);
+    }
+
+    memmove (&qf->matches[pos + 1], &qf->matches[pos],
+             (qf->n_matches - pos) * sizeof (QuickFillMatch));
+    qf->matches[pos].key = key;
+    qf->matches[pos].qf = match_qf;
+    qf->n_matches++;
+}
+
+static void
+quickfill_remove_match (QuickFill *qf, guint pos)
+{
+    qf->n_matches--;
+    memmove (&qf->matches[pos], &qf->matches[pos + 1],
+             (qf->n_matches - pos) * sizeof (QuickFillMatch));
+}
+
+/* Turn the first letter of qf's tail into a node of its own. */
+static void
+quickfill_expand_tail (QuickFill *qf)
+{
+    QuickFill *match_qf;
+    const char *next_char;
+    gunichar key;
+
+    if (qf->tail == NULL)
+        return;
+
+    key = g_unichar_toupper (g_utf8_get_char (qf->tail));
+    next_char = g_utf8_next_char (qf->tail);
+
+    match_qf = gnc_quickfill_new ();
+    quickfill_set_text (match_qf, qf->text);
+    match_qf->tail = *next_char ? next_char : NULL;
+
+    qf->tail = NULL;
+    quickfill_add_match (qf, 0, key, match_qf);
 }
 
 /********************************************************************\
@@ -135,12 +270,23 @@ QuickFill *
 gnc_quickfill_get_char_match (QuickFill *qf, gunichar uc)
 {
     guint key = g_unichar_toupper (uc);
+    guint pos;
 
     if (NULL == qf) return NULL;
 
     DEBUG ("xaccGetQuickFill(): index = %u\n", key);
 
-    return g_hash_table_lookup (qf->matches, GUINT_TO_POINTER (key));
+    if (qf->tail)
+    {
+        if (g_unichar_toupper (g_utf8_get_char (qf->tail)) != key)
+            return NULL;
+        quickfill_expand_tail (qf);
+    }
+
+    if (!quickfill_find_match (qf, key, &pos))
+        return NULL;
+
+    return qf->matches[pos].qf;
 }
 
 /********************************************************************\
@@ -187,14 +333,6 @@ gnc_quickfill_get_string_match (QuickFill *qf, const char *str)
 /********************************************************************\
 \********************************************************************/
 
-static void
-unique_len_helper (gpointer key, gpointer value, gpointer data)
-{
-    QuickFill **qf_p = data;
-
-    *qf_p = value;
-}
-
 QuickFill *
 gnc_quickfill_get_unique_len_match (QuickFill *qf, int *length)
 {
@@ -206,14 +344,12 @@ gnc_quickfill_get_unique_len_match (QuickFill *qf, int *length)
 
     while (1)
     {
-        guint count;
+        quickfill_expand_tail (qf);
 
-        count = g_hash_table_size (qf->matches);
-
-        if (count != 1)
+        if (qf->n_matches != 1)
             break;
 
-        g_hash_table_foreach (qf->matches, unique_len_helper, &qf);
+        qf = qf->matches[0].qf;
 
         if (length != NULL)
             (*length)++;
@@ -229,78 +365,92 @@ void
 gnc_quickfill_insert (QuickFill *qf, const char *text, QuickFillSort sort)
 {
     gchar *normalized_str;
-    int len;
+    QuickFillText *qf_text;
 
     if (NULL == qf) return;
     if (NULL == text) return;
 
 
     normalized_str = g_utf8_normalize (text, -1, G_NORMALIZE_NFC);
-    len = g_utf8_strlen (text, -1);
-    quickfill_insert_recursive (qf, normalized_str, len, normalized_str, sort);
+    qf_text = quickfill_text_new (normalized_str, g_utf8_strlen (text, -1));
     g_free (normalized_str);
+
+    quickfill_insert_recursive (qf, qf_text, qf_text->str, sort);
+    quickfill_text_unref (qf_text);
 }
 
 /********************************************************************\
 \********************************************************************/
 
 static void
-quickfill_insert_recursive (QuickFill *qf, const char *text, int len,
+quickfill_insert_recursive (QuickFill *qf, QuickFillText *text,
                             const char *next_char, QuickFillSort sort)
 {
-    guint key;
-    char *old_text;
+    QuickFillText *old_text;
     QuickFill *match_qf;
-    gunichar key_char_uc;
+    guint key, pos;
 
-    if (qf == NULL)
+    if ((qf == NULL) || (text == NULL))
         return;
 
-    if ((text == NULL) || (*next_char == '\0'))
-        return;
+    for (; *next_char != '\0'; qf = match_qf,
+         next_char = g_utf8_next_char (next_char))
+    {
+        /* The chain below qf gets a branch, so it needs its first node. */
+        quickfill_expand_tail (qf);
 
+        key = g_unichar_toupper (g_utf8_get_char (next_char));
 
-    key_char_uc = g_utf8_get_char (next_char);
-    key = g_unichar_toupper (key_char_uc);
+        if (!quickfill_find_match (qf, key, &pos))
+        {
+            /* Nothing else starts this way, so the rest of the string can
+             * wait as a tail. */
+            const char *rest = g_utf8_next_char (next_char);
+
+            match_qf = gnc_quickfill_new ();
+            quickfill_set_text (match_qf, text);
+            match_qf->tail = *rest ? rest : NULL;
+            quickfill_add_match (qf, pos, key, match_qf);
+            return;
+        }
 
-    match_qf = g_hash_table_lookup (qf->matches, GUINT_TO_POINTER (key));
-    if (match_qf == NULL)
-    {
-        match_qf = gnc_quickfill_new ();
-        g_hash_table_insert (qf->matches, GUINT_TO_POINTER (key), match_qf);
-    }
+        match_qf = qf->matches[pos].qf;
 
-    old_text = match_qf->text;
+        /* A tail stands for nodes with the same text as its own, so it
+         * must be split off before this one's text can change. */
+        quickfill_expand_tail (match_qf);
 
-    switch (sort)
-    {
-    case QUICKFILL_ALPHA:
-        if (old_text && (g_utf8_collate (text, old_text) >= 0))
-            break;
-        /* fall through */
+        old_text = match_qf->text;
 
-    case QUICKFILL_LIFO:
-    default:
-        /* If there's no string there already, just put the new one in. */
-        if (old_text == NULL)
+        switch (sort)
         {
-            match_qf->text = g_strdup(text);
-            match_qf->len = len;
-            break;
-        }
+        case QUICKFILL_ALPHA:
+            if (old_text && (g_utf8_collate (text->str, old_text->str) >= 0))
+                break;
+            /* fall through */
+
+        case QUICKFILL_LIFO:
+        default:
+            /* If there's no string there already, just put the new one in. */
+            if (old_text == NULL)
+            {
+                quickfill_set_text (match_qf, text);
+                break;
+            }
 
-        /* Leave prefixes in place */
-        if ((len > match_qf->len) &&
-                (strncmp(text, old_text, strlen(old_text)) == 0))
-            break;
+            /* Leave prefixes in place */
+            if ((text->len > old_text->len) &&
+                    (strncmp(text->str, old_text->str, strlen(old_text->str)) == 0))
+                break;
 
-        g_free(old_text);
-        match_qf->text = g_strdup(text);
-        match_qf->len = len;
-        break;
-    }
+            /* The same string again needn't take a copy. */
+            if (strcmp (text->str, old_text->str) == 0)
+                break;
 
-    quickfill_insert_recursive (match_qf, text, len, g_utf8_next_char (next_char), sort);
+            quickfill_set_text (match_qf, text);
+            break;
+        }
+    }
 }
 
 /********************************************************************\
@@ -315,87 +465,74 @@ gnc_quickfill_remove (QuickFill *qf, const gchar *text, QuickFillSort sort)
     if (text == NULL) return;
 
     normalized_str = g_utf8_normalize (text, -1, G_NORMALIZE_NFC);
-    gnc_quickfill_remove_recursive (qf, normalized_str, 0, sort);
+    gnc_quickfill_remove_recursive (qf, normalized_str, normalized_str, sort);
     g_free (normalized_str);
 }
 
 /********************************************************************\
 \********************************************************************/
 
-struct _BestText
-{
-    gchar *text;
-    QuickFillSort sort;
-};
-
-static void
-best_text_helper (gpointer key, gpointer value, gpointer user_data)
+/* Pick the text to replace a removed one from among qf's children. */
+static QuickFillText *
+best_child_text (QuickFill *qf, QuickFillSort sort)
 {
-    QuickFill *qf = value;
-    struct _BestText *best = user_data;
+    QuickFillText *best = NULL;
+    guint i;
 
-    if (best->text == NULL)
+    for (i = 0; i < qf->n_matches; i++)
     {
-        /* start with the first text */
-        best->text = qf->text;
+        QuickFillText *text = qf->matches[i].qf->text;
 
+        /* Without any history to go by, the alphabetically first text
+         * is as good as any, whatever the sort. */
+        if (best == NULL || g_utf8_collate (text->str, best->str) < 0)
+            best = text;
     }
-    else if (best->text == QUICKFILL_LIFO)
-    {
-        /* we do not track history, so ignore it */
-        return;
-
-    }
-    else if (g_utf8_collate (qf->text, best->text) < 0)
-    {
-        /* even better text */
-        best->text = qf->text;
-    }
+    return best;
 }
 
-
-
 static void
-gnc_quickfill_remove_recursive (QuickFill *qf, const gchar *text, gint depth,
-                                QuickFillSort sort)
+gnc_quickfill_remove_recursive (QuickFill *qf, const gchar *text,
+                                const gchar *next_char, QuickFillSort sort)
 {
-    QuickFill *match_qf;
-    gchar *child_text;
-    gint child_len;
+    QuickFillText *child_text = NULL;
 
-    child_text = NULL;
-    child_len = 0;
+    if (qf->tail)
+    {
+        /* Below is nothing but qf's own text. */
+        if (qf->text && strcmp (text, qf->text->str) == 0)
+        {
+            quickfill_set_text (qf, NULL);
+            qf->tail = NULL;
+        }
+        return;
+    }
 
-    if (depth < g_utf8_strlen (text, -1))
+    if (*next_char != '\0')
     {
         /* process next letter */
 
-        gchar *key_char;
-        gunichar key_char_uc;
-        guint key;
+        guint key = g_unichar_toupper (g_utf8_get_char (next_char));
+        guint pos;
 
-        key_char = g_utf8_offset_to_pointer (text, depth);
-        key_char_uc = g_utf8_get_char (key_char);
-        key = g_unichar_toupper (key_char_uc);
-
-        match_qf = g_hash_table_lookup (qf->matches, GUINT_TO_POINTER (key));
-        if (match_qf)
+        if (quickfill_find_match (qf, key, &pos))
         {
+            QuickFill *match_qf = qf->matches[pos].qf;
+
             /* remove text from child qf */
-            gnc_quickfill_remove_recursive (match_qf, text, depth + 1, sort);
+            gnc_quickfill_remove_recursive (match_qf, text,
+                                            g_utf8_next_char (next_char), sort);
 
             if (match_qf->text == NULL)
             {
                 /* text was the only word with a prefix up to match_qf */
-                g_hash_table_remove (qf->matches, GUINT_TO_POINTER (key));
+                quickfill_remove_match (qf, pos);
                 gnc_quickfill_destroy (match_qf);
-
             }
             else
             {
                 /* remember remaining best child string */
                 child_text = match_qf->text;
-                child_len = match_qf->len;
             }
         }
     }
@@ -403,47 +540,17 @@ gnc_quickfill_remove_recursive (QuickFill *qf, const gchar *text, gint depth,
     if (qf->text == NULL)
         return;
 
-    if (strcmp (text, qf->text) == 0)
+    if (strcmp (text, qf->text->str) == 0)
     {
         /* the currently best text is about to be removed */
 
-        gchar *best_text = NULL;
-        gint best_len = 0;
-
-        if (child_text != NULL)
-        {
-            /* other children are pretty good as well */
-            best_text = child_text;
-            best_len = child_len;
-
-        }
-        else
-        {
-            if (g_hash_table_size (qf->matches) != 0)
-            {
-                /* otherwise search for another good text */
-                struct _BestText bts;
-                bts.text = NULL;
-                bts.sort = sort;
-
-                g_hash_table_foreach (qf->matches, (GHFunc) best_text_helper, &bts);
-                best_text = bts.text;
-                best_len = (best_text == NULL) ? 0 : g_utf8_strlen (best_text, -1);
-            }
-        }
+        /* other children are pretty good as well, otherwise search for
+         * another good text */
+        if (child_text == NULL)
+            child_text = best_child_text (qf, sort);
 
         /* now replace or clear text */
-        g_free(qf->text);
-        if (best_text != NULL)
-        {
-            qf->text = g_strdup(best_text);
-            qf->len = best_len;
-        }
-        else
-        {
-            qf->text = NULL;
-            qf->len = 0;
-        }
+        quickfill_set_text (qf, child_text);
     }
 }
 
@@ -49,16 +49,42 @@ typedef struct ParserNum
     gnc_numeric value;
 } ParserNum;
 
+/* What a parse leaves behind for the thread that ran it */
+typedef struct ParserThreadState
+{
+    ParseError    last_error;
+    GNCParseError last_gncp_error;
+    const char   *function_error_msg;
+    gboolean      refuse_functions;
+    gboolean      function_refused;
+    /* The expression gnc_exp_parser_compile() is building */
+    GncExpression *compiling;
+} ParserThreadState;
+
 
 /** Static Globals *************************************************/
+/* Parses on other threads read and set the bindings too */
 static GHashTable   *variable_bindings = NULL;
-static ParseError    last_error        = PARSER_NO_ERROR;
-static GNCParseError last_gncp_error   = NO_ERR;
+static GMutex        bindings_mutex;
+static GPrivate      thread_state_key  = G_PRIVATE_INIT (g_free);
 static gboolean      parser_inited     = FALSE;
 
 
 /** Implementations ************************************************/
 
+static ParserThreadState *
+thread_state (void)
+{
+    ParserThreadState *state = g_private_get (&thread_state_key);
+
+    if (!state)
+    {
+        state = g_new0 (ParserThreadState, 1);
+        g_private_set (&thread_state_key, state);
+    }
+    return state;
+}
+
 static gchar *
 gnc_exp_parser_filname (void)
 {
@@ -71,6 +97,16 @@ gnc_exp_parser_init ( void )
     gnc_exp_parser_real_init( TRUE );
 }
 
+void
+gnc_exp_parser_init_once (void)
+{
+    if (!parser_inited)
+        gnc_exp_parser_init ();
+
+    /* The parsers on other threads look them up too */
+    gnc_localeconv ();
+}
+
 void
 gnc_exp_parser_real_init ( gboolean addPredefined )
 {
@@ -144,7 +180,9 @@ gnc_exp_parser_shutdown (void)
 
     filename = gnc_exp_parser_filname();
     key_file = g_key_file_new();
+    g_mutex_lock (&bindings_mutex);
     g_hash_table_foreach (variable_bindings, set_one_key, key_file);
+    g_mutex_unlock (&bindings_mutex);
     g_key_file_set_comment(key_file, GEP_GROUP_NAME, NULL,
                            " Variables are in the form 'name=value'",
                            NULL);
@@ -152,30 +190,26 @@ gnc_exp_parser_shutdown (void)
     g_key_file_free(key_file);
     g_free(filename);
 
+    g_mutex_lock (&bindings_mutex);
     g_hash_table_foreach_remove (variable_bindings, remove_binding, NULL);
     g_hash_table_destroy (variable_bindings);
     variable_bindings = NULL;
+    g_mutex_unlock (&bindings_mutex);
 
-    last_error = PARSER_NO_ERROR;
-    last_gncp_error = NO_ERR;
+    thread_state ()->last_error = PARSER_NO_ERROR;
+    thread_state ()->last_gncp_error = NO_ERR;
 
     parser_inited = FALSE;
 
     gnc_hook_run(HOOK_SAVE_OPTIONS, NULL);
 }
 
-void
-gnc_exp_parser_remove_variable (const char *variable_name)
+static void
+remove_variable_locked (const char *variable_name)
 {
     gpointer key;
     gpointer value;
 
-    if (!parser_inited)
-        return;
-
-    if (variable_name == NULL)
-        return;
-
     if (g_hash_table_lookup_extended (variable_bindings, variable_name,
                                       &key, &value))
     {
@@ -185,6 +219,20 @@ gnc_exp_parser_remove_variable (const char *variable_name)
     }
 }
 
+void
+gnc_exp_parser_remove_variable (const char *variable_name)
+{
+    if (!parser_inited)
+        return;
+
+    if (variable_name == NULL)
+        return;
+
+    g_mutex_lock (&bindings_mutex);
+    remove_variable_locked (variable_name);
+    g_mutex_unlock (&bindings_mutex);
+}
+
 void
 gnc_exp_parser_set_value (const char * variable_name, gnc_numeric value)
 {
@@ -197,14 +245,15 @@ gnc_exp_parser_set_value (const char * variable_name, gnc_numeric value)
     if (!parser_inited)
         gnc_exp_parser_init ();
 
-    gnc_exp_parser_remove_variable (variable_name);
-
     key = g_strdup (variable_name);
 
     pnum = g_new0(ParserNum, 1);
     pnum->value = value;
 
+    g_mutex_lock (&bindings_mutex);
+    remove_variable_locked (variable_name);
     g_hash_table_insert (variable_bindings, key, pnum);
+    g_mutex_unlock (&bindings_mutex);
 }
 
 static void
@@ -243,7 +292,9 @@ make_predefined_variables (void)
 {
     var_store_ptr vars = NULL;
 
+    g_mutex_lock (&bindings_mutex);
     g_hash_table_foreach (variable_bindings, make_predefined_vars_helper, &vars);
+    g_mutex_unlock (&bindings_mutex);
 
     return vars;
 }
@@ -280,11 +331,10 @@ update_variables (var_store_ptr vars)
     }
 }
 
-static char* _function_evaluation_error_msg = NULL;
 static void
 _exception_handler(const char *error_message)
 {
-    _function_evaluation_error_msg = (char*)error_message;
+    thread_state ()->function_error_msg = error_message;
 }
 
 static
@@ -298,6 +348,12 @@ func_op(const char *fname, int argc, void **argv)
     gnc_numeric n, *result;
     GString *realFnName;
 
+    if (thread_state ()->refuse_functions)
+    {
+        thread_state ()->function_refused = TRUE;
+        return NULL;
+    }
+
     realFnName = g_string_sized_new( strlen(fname) + 5 );
     g_string_printf( realFnName, "gnc:%s", fname );
     scmFn = scm_internal_catch(SCM_BOOL_T,
@@ -337,10 +393,10 @@ func_op(const char *fname, int argc, void **argv)
 
     //scmTmp = scm_apply(scmFn, scmArgs , SCM_EOL);
     scmTmp = gfec_apply(scmFn, scmArgs, _exception_handler);
-    if (_function_evaluation_error_msg != NULL)
+    if (thread_state ()->function_error_msg != NULL)
     {
-        PERR("function eval error: [%s]\n", _function_evaluation_error_msg);
-        _function_evaluation_error_msg = NULL;
+        PERR("function eval error: [%s]\n", thread_state ()->function_error_msg);
+        thread_state ()->function_error_msg = NULL;
         return NULL;
     }
 
@@ -387,6 +443,29 @@ trans_numeric(const char *digit_str,
     return pnum;
 }
 
+static gnc_numeric
+numeric_op_value (char op_sym, gnc_numeric left, gnc_numeric right)
+{
+    switch (op_sym)
+    {
+    case ADD_OP:
+        return gnc_numeric_add (left, right,
+                                GNC_DENOM_AUTO, GNC_HOW_DENOM_EXACT);
+    case SUB_OP:
+        return gnc_numeric_sub (left, right,
+                                GNC_DENOM_AUTO, GNC_HOW_DENOM_EXACT);
+    case DIV_OP:
+        return gnc_numeric_div (left, right,
+                                GNC_DENOM_AUTO, GNC_HOW_DENOM_EXACT);
+    case MUL_OP:
+        return gnc_numeric_mul (left, right,
+                                GNC_DENOM_AUTO, GNC_HOW_DENOM_EXACT);
+    case ASN_OP:
+    default:
+        return right;
+    }
+}
+
 static void *
 numeric_ops(char op_sym,
             void *left_value,
@@ -401,28 +480,7 @@ numeric_ops(char op_sym,
 
     result = (op_sym == ASN_OP) ? left : g_new0(ParserNum, 1);
 
-    switch (op_sym)
-    {
-    case ADD_OP:
-        result->value = gnc_numeric_add (left->value, right->value,
-                                         GNC_DENOM_AUTO, GNC_HOW_DENOM_EXACT);
-        break;
-    case SUB_OP:
-        result->value = gnc_numeric_sub (left->value, right->value,
-                                         GNC_DENOM_AUTO, GNC_HOW_DENOM_EXACT);
-        break;
-    case DIV_OP:
-        result->value = gnc_numeric_div (left->value, right->value,
-                                         GNC_DENOM_AUTO, GNC_HOW_DENOM_EXACT);
-        break;
-    case MUL_OP:
-        result->value = gnc_numeric_mul (left->value, right->value,
-                                         GNC_DENOM_AUTO, GNC_HOW_DENOM_EXACT);
-        break;
-    case ASN_OP:
-        result->value = right->value;
-        break;
-    }
+    result->value = numeric_op_value (op_sym, left->value, right->value);
 
     return result;
 }
@@ -486,7 +544,7 @@ gnc_exp_parser_parse( const char * expression, gnc_numeric *value_p,
     if ( !allVarsHaveValues )
     {
         toRet = FALSE;
-        last_gncp_error = VARIABLE_IN_EXP;
+        thread_state ()->last_gncp_error = VARIABLE_IN_EXP;
     }
 
 cleanup:
@@ -502,6 +560,7 @@ gnc_exp_parser_parse_separate_vars (const char * expression,
                                     char **error_loc_p,
                                     GHashTable *varHash )
 {
+    ParserThreadState *state = thread_state ();
     parser_env_ptr pe;
     var_store_ptr vars;
     struct lconv *lc;
@@ -512,8 +571,20 @@ gnc_exp_parser_parse_separate_vars (const char * expression,
     if (expression == NULL)
         return FALSE;
 
+    state->function_refused = FALSE;
     if (!parser_inited)
+    {
+        /* Initializing loads fin.scm */
+        if (state->refuse_functions)
+        {
+            if (error_loc_p != NULL)
+                *error_loc_p = (char *) expression;
+            state->last_error = NOT_A_FUNC;
+            state->function_refused = TRUE;
+            return FALSE;
+        }
         gnc_exp_parser_real_init ( (varHash == NULL) );
+    }
 
     result.variable_name = NULL;
     result.value = NULL;
@@ -543,7 +614,7 @@ gnc_exp_parser_parse_separate_vars (const char * expression,
             if (error_loc_p != NULL)
                 *error_loc_p = (char *) expression;
 
-            last_error = NUMERIC_ERROR;
+            state->last_error = NUMERIC_ERROR;
         }
         else
         {
@@ -559,7 +630,7 @@ gnc_exp_parser_parse_separate_vars (const char * expression,
             if (error_loc_p != NULL)
                 *error_loc_p = NULL;
 
-            last_error = PARSER_NO_ERROR;
+            state->last_error = PARSER_NO_ERROR;
         }
     }
     else
@@ -567,7 +638,7 @@ gnc_exp_parser_parse_separate_vars (const char * expression,
         if (error_loc_p != NULL)
             *error_loc_p = error_loc;
 
-        last_error = get_parse_error (pe);
+        state->last_error = get_parse_error (pe);
     }
 
     if ( varHash != NULL )
@@ -604,15 +675,17 @@ gnc_exp_parser_parse_separate_vars (const char * expression,
 
     exit_parser (pe);
 
-    return last_error == PARSER_NO_ERROR;
+    return state->last_error == PARSER_NO_ERROR;
 }
 
 const char *
 gnc_exp_parser_error_string (void)
 {
-    if ( last_error == PARSER_NO_ERROR )
+    ParserThreadState *state = thread_state ();
+
+    if ( state->last_error == PARSER_NO_ERROR )
     {
-        switch ( last_gncp_error )
+        switch ( state->last_gncp_error )
         {
         default:
         case NO_ERR:
@@ -624,7 +697,7 @@ gnc_exp_parser_error_string (void)
         }
     }
 
-    switch (last_error)
+    switch (state->last_error)
     {
     default:
     case PARSER_NO_ERROR:
@@ -647,3 +720,458 @@ gnc_exp_parser_error_string (void)
         return _("Numeric error");
     }
 }
+
+void
+gnc_exp_parser_refuse_functions (gboolean refuse)
+{
+    thread_state ()->refuse_functions = refuse;
+}
+
+gboolean
+gnc_exp_parser_function_refused (void)
+{
+    return thread_state ()->function_refused;
+}
+
+/** Compiled expressions *******************************************/
+
+/* The parser evaluates as it parses, calling back for every number,
+ * operation and function call.  Compiling runs it with callbacks that
+ * build nodes instead, so that the tree they make up can be evaluated
+ * again and again.  The parser's values are then ExpHandles: it
+ * negates and assigns them in place, which changes the node a handle
+ * has but not the nodes already built from it. */
+
+typedef enum
+{
+    EXP_NODE_CONST,
+    EXP_NODE_SLOT,
+    EXP_NODE_NEG,
+    EXP_NODE_OP,
+    EXP_NODE_FUNC
+} ExpNodeType;
+
+typedef struct ExpNode ExpNode;
+struct ExpNode
+{
+    ExpNodeType type;
+    gnc_numeric value;          /* EXP_NODE_CONST */
+    guint       slot;           /* EXP_NODE_SLOT */
+    char        op;             /* EXP_NODE_OP */
+    char       *name;           /* EXP_NODE_FUNC */
+    guint       n_args;
+    ExpNode   **args;           /* NULL for the string arguments */
+    char      **strings;        /* of EXP_NODE_FUNC, NULL for the others */
+};
+
+typedef struct ExpHandle
+{
+    ExpNode *node;
+} ExpHandle;
+
+struct GncExpression
+{
+    ExpNode   *root;
+    GPtrArray *nodes;           /* all of them, to free */
+    GPtrArray *names;           /* of the variables, by slot */
+    /* What the expression assigns to each variable, NULL if nothing */
+    ExpNode  **assigned;
+    gboolean   has_functions;
+    /* While compiling, the handles the parser has, including those it
+     * loses track of on errors */
+    GHashTable *handles;
+};
+
+static void
+exp_node_free (gpointer data)
+{
+    ExpNode *node = data;
+
+    g_free (node->name);
+    g_free (node->args);
+    if (node->strings)
+    {
+        guint i;
+        for (i = 0; i < node->n_args; i++)
+            g_free (node->strings[i]);
+        g_free (node->strings);
+    }
+    g_free (node);
+}
+
+static ExpNode *
+compile_node (ExpNodeType type, guint n_args)
+{
+    GncExpression *exp = thread_state ()->compiling;
+    ExpNode *node = g_new0 (ExpNode, 1);
+
+    node->type = type;
+    node->n_args = n_args;
+    if (n_args)
+        node->args = g_new0 (ExpNode*, n_args);
+    g_ptr_array_add (exp->nodes, node);
+    return node;
+}
+
+static void *
+compile_handle (ExpNode *node)
+{
+    GncExpression *exp = thread_state ()->compiling;
+    ExpHandle *handle = g_new0 (ExpHandle, 1);
+
+    handle->node = node;
+    g_hash_table_add (exp->handles, handle);
+    return handle;
+}
+
+/* The parser's values can also be the strings of function arguments. */
+static ExpNode *
+compile_handle_node (void *value)
+{
+    GncExpression *exp = thread_state ()->compiling;
+
+    if (!value || !g_hash_table_contains (exp->handles, value))
+        return NULL;
+    return ((ExpHandle*) value)->node;
+}
+
+static void
+compile_free (void *value)
+{
+    GncExpression *exp = thread_state ()->compiling;
+
+    /* Removing a handle frees it */
+    if (!g_hash_table_remove (exp->handles, value))
+        g_free (value);
+}
+
+static void *
+compile_numeric (const char *digit_str,
+                 gchar      *radix_point,
+                 gchar      *group_char,
+                 char      **rstr)
+{
+    GncExpression *exp = thread_state ()->compiling;
+    ExpNode *node;
+    gnc_numeric value;
+
+    if (digit_str == NULL)
+        return NULL;
+
+    /* This is the zero a variable the parser hasn't seen yet starts
+     * with, and the only call without rstr.  The variables become the
+     * slots, in the order the parser lists them. */
+    if (rstr == NULL)
+    {
+        node = compile_node (EXP_NODE_SLOT, 0);
+        node->slot = exp->names->len;
+        g_ptr_array_add (exp->names, NULL);
+        return compile_handle (node);
+    }
+
+    if (!xaccParseAmount (digit_str, TRUE, &value, rstr))
+        return NULL;
+
+    node = compile_node (EXP_NODE_CONST, 0);
+    node->value = value;
+    return compile_handle (node);
+}
+
+static void *
+compile_ops (char op_sym, void *left_value, void *right_value)
+{
+    ExpNode *left = compile_handle_node (left_value);
+    ExpNode *right = compile_handle_node (right_value);
+    ExpNode *node;
+
+    if (!left || !right)
+        return NULL;
+
+    if (op_sym == ASN_OP)
+    {
+        ((ExpHandle*) left_value)->node = right;
+        return left_value;
+    }
+
+    node = compile_node (EXP_NODE_OP, 2);
+    node->op = op_sym;
+    node->args[0] = left;
+    node->args[1] = right;
+    return compile_handle (node);
+}
+
+static void *
+compile_negate (void *value)
+{
+    ExpNode *arg = compile_handle_node (value);
+    ExpNode *node;
+
+    if (!arg)
+        return NULL;
+
+    node = compile_node (EXP_NODE_NEG, 1);
+    node->args[0] = arg;
+    ((ExpHandle*) value)->node = node;
+    return value;
+}
+
+static void *
+compile_func (const char *fname, int argc, void **argv)
+{
+    GncExpression *exp = thread_state ()->compiling;
+    ExpNode *node = compile_node (EXP_NODE_FUNC, argc);
+    int i;
+
+    node->name = g_strdup (fname);
+    node->strings = g_new0 (char*, argc);
+    for (i = 0; i < argc; i++)
+    {
+        var_store *vs = argv[i];
+
+        if (vs->type == VST_STRING)
+            node->strings[i] = g_strdup (vs->value);
+        else if (!(node->args[i] = compile_handle_node (vs->value)))
+            return NULL;
+    }
+    exp->has_functions = TRUE;
+    return compile_handle (node);
+}
+
+GncExpression *
+gnc_exp_parser_compile (const char *expression, char **error_loc_p)
+{
+    ParserThreadState *state = thread_state ();
+    GncExpression *exp;
+    parser_env_ptr pe;
+    var_store_ptr vars;
+    struct lconv *lc;
+    var_store result;
+    char *error_loc;
+    guint i;
+
+    if (expression == NULL)
+        return NULL;
+
+    exp = g_new0 (GncExpression, 1);
+    exp->nodes = g_ptr_array_new_with_free_func (exp_node_free);
+    exp->names = g_ptr_array_new_with_free_func (g_free);
+    exp->handles = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+                                          g_free, NULL);
+    state->compiling = exp;
+
+    result.variable_name = NULL;
+    result.value = NULL;
+    result.next_var = NULL;
+
+    lc = gnc_localeconv ();
+    pe = init_parser (NULL, lc->mon_decimal_point, lc->mon_thousands_sep,
+                      compile_numeric, compile_ops, compile_negate,
+                      compile_free, compile_func);
+
+    error_loc = parse_string (&result, expression, pe);
+    if (error_loc == NULL)
+    {
+        exp->root = compile_handle_node (result.value);
+        if (!exp->root)
+        {
+            error_loc = (char *) expression;
+            state->last_error = NUMERIC_ERROR;
+        }
+        else
+            state->last_error = PARSER_NO_ERROR;
+        if (!result.variable_name)
+            compile_free (result.value);
+    }
+    else
+        state->last_error = get_parse_error (pe);
+
+    if (error_loc == NULL)
+    {
+        exp->assigned = g_new0 (ExpNode*, exp->names->len);
+        for (vars = parser_get_vars (pe), i = 0;
+             vars && i < exp->names->len;
+             vars = vars->next_var, i++)
+        {
+            ExpNode *node = compile_handle_node (vars->value);
+
+            g_ptr_array_index (exp->names, i) = g_strdup (vars->variable_name);
+            if (node && !(node->type == EXP_NODE_SLOT && node->slot == i))
+                exp->assigned[i] = node;
+        }
+    }
+
+    exit_parser (pe);
+    state->compiling = NULL;
+    g_hash_table_destroy (exp->handles);
+    exp->handles = NULL;
+
+    if (error_loc_p != NULL)
+        *error_loc_p = error_loc;
+
+    if (error_loc != NULL)
+    {
+        gnc_expression_free (exp);
+        return NULL;
+    }
+    return exp;
+}
+
+void
+gnc_expression_free (GncExpression *exp)
+{
+    if (!exp)
+        return;
+
+    g_ptr_array_free (exp->nodes, TRUE);
+    g_ptr_array_free (exp->names, TRUE);
+    g_free (exp->assigned);
+    g_free (exp);
+}
+
+guint
+gnc_expression_get_num_variables (const GncExpression *exp)
+{
+    g_return_val_if_fail (exp, 0);
+    return exp->names->len;
+}
+
+const char *
+gnc_expression_get_variable_name (const GncExpression *exp, guint slot)
+{
+    g_return_val_if_fail (exp && slot < exp->names->len, NULL);
+    return g_ptr_array_index (exp->names, slot);
+}
+
+gint
+gnc_expression_get_variable_slot (const GncExpression *exp, const char *name)
+{
+    guint i;
+
+    g_return_val_if_fail (exp && name, -1);
+
+    for (i = 0; i < exp->names->len; i++)
+        if (g_strcmp0 (g_ptr_array_index (exp->names, i), name) == 0)
+            return i;
+    return -1;
+}
+
+static gboolean
+exp_node_eval (const ExpNode *node, const gnc_numeric *values,
+               gnc_numeric *result)
+{
+    gnc_numeric left, right;
+
+    switch (node->type)
+    {
+    case EXP_NODE_CONST:
+        *result = node->value;
+        return TRUE;
+    case EXP_NODE_SLOT:
+        *result = values[node->slot];
+        return TRUE;
+    case EXP_NODE_NEG:
+        if (!exp_node_eval (node->args[0], values, &left))
+            return FALSE;
+        *result = gnc_numeric_neg (left);
+        return TRUE;
+    case EXP_NODE_OP:
+        if (!exp_node_eval (node->args[0], values, &left) ||
+            !exp_node_eval (node->args[1], values, &right))
+            return FALSE;
+        *result = numeric_op_value (node->op, left, right);
+        return TRUE;
+    case EXP_NODE_FUNC:
+    {
+        var_store *args = g_new0 (var_store, node->n_args);
+        gnc_numeric *nums = g_new0 (gnc_numeric, node->n_args);
+        void **argv = g_new0 (void*, node->n_args);
+        gnc_numeric *value = NULL;
+        gboolean ok = TRUE;
+        guint i;
+
+        for (i = 0; ok && i < node->n_args; i++)
+        {
+            argv[i] = &args[i];
+            if (node->strings[i])
+            {
+                args[i].type = VST_STRING;
+                args[i].value = node->strings[i];
+            }
+            else
+            {
+                ok = exp_node_eval (node->args[i], values, &nums[i]);
+                args[i].type = VST_NUMERIC;
+                args[i].value = &nums[i];
+            }
+        }
+        if (ok && (value = func_op (node->name, node->n_args, argv)))
+            *result = *value;
+        else if (ok)
+        {
+            thread_state ()->last_error = NOT_A_FUNC;
+            ok = FALSE;
+        }
+        g_free (value);
+        g_free (argv);
+        g_free (nums);
+        g_free (args);
+        return ok;
+    }
+    }
+    return FALSE;
+}
+
+gboolean
+gnc_expression_evaluate (const GncExpression *exp, gnc_numeric *values,
+                         gnc_numeric *value_p)
+{
+    ParserThreadState *state = thread_state ();
+    gnc_numeric value, *assigned = NULL;
+    guint i;
+
+    g_return_val_if_fail (exp, FALSE);
+    g_return_val_if_fail (values || !exp->names->len, FALSE);
+
+    state->function_refused = FALSE;
+    if (exp->has_functions && !parser_inited)
+    {
+        /* Initializing loads fin.scm */
+        if (state->refuse_functions)
+        {
+            state->last_error = NOT_A_FUNC;
+            state->function_refused = TRUE;
+            return FALSE;
+        }
+        gnc_exp_parser_real_init (FALSE);
+    }
+
+    if (!exp_node_eval (exp->root, values, &value))
+        return FALSE;
+    if (gnc_numeric_check (value))
+    {
+        state->last_error = NUMERIC_ERROR;
+        return FALSE;
+    }
+
+    /* The assignments are all made from the values passed in. */
+    for (i = 0; i < exp->names->len; i++)
+        if (exp->assigned[i])
+        {
+            if (!assigned)
+                assigned = g_new (gnc_numeric, exp->names->len);
+            if (!exp_node_eval (exp->assigned[i], values, &assigned[i]))
+            {
+                g_free (assigned);
+                return FALSE;
+            }
+        }
+    for (i = 0; assigned && i < exp->names->len; i++)
+        if (exp->assigned[i])
+            values[i] = assigned[i];
+    g_free (assigned);
+
+    if (value_p)
+        *value_p = gnc_numeric_reduce (value);
+    state->last_error = PARSER_NO_ERROR;
+    return TRUE;
+}
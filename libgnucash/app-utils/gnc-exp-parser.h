@@ -40,6 +40,11 @@ typedef enum
  */
 void gnc_exp_parser_init (void);
 
+/* Initialize the expression parser as gnc_exp_parser_init() does,
+ * unless it already is. Call it before handing expressions to threads
+ * that refuse functions. */
+void gnc_exp_parser_init_once (void);
+
 /**
  * The real init function, which takes an option to add the pre-defined vars
  * to the variable table.  This option is used by
@@ -89,4 +94,55 @@ gboolean gnc_exp_parser_parse_separate_vars (const char * expression,
  * the problem. Otherwise, return NULL. */
 const char * gnc_exp_parser_error_string (void);
 
+/* The expressions can be parsed on any thread: the error state is kept
+ * per thread and the variable definitions are shared under a lock.
+ * Function calls are evaluated in Guile though, so threads that aren't
+ * in Guile mode must refuse them with this. An expression calling a
+ * function then fails to parse on the calling thread. */
+void gnc_exp_parser_refuse_functions (gboolean refuse);
+
+/* Whether the last parse on the calling thread failed because it
+ * called a function while they were refused. The expression should be
+ * parsed again by a thread in Guile mode. */
+gboolean gnc_exp_parser_function_refused (void);
+
+/**
+ * An expression compiled for evaluating it repeatedly, with other values
+ * of its variables each time. The variables are given slots, numbered
+ * in the order they first appear in the expression, and the values are
+ * passed in an array indexed by slot. Like gnc_exp_parser_parse_separate_vars(),
+ * this doesn't use the variable definitions of the parser.
+ *
+ * Evaluating doesn't change the expression, so threads can share one.
+ **/
+typedef struct GncExpression GncExpression;
+
+/* Compile expression, returning NULL if it doesn't parse. The
+ * error_loc_p and gnc_exp_parser_error_string() are set as
+ * gnc_exp_parser_parse() sets them. Functions are only looked up when
+ * the expression is evaluated. */
+GncExpression * gnc_exp_parser_compile (const char *expression,
+                                        char **error_loc_p);
+
+void gnc_expression_free (GncExpression *exp);
+
+/* The number of variables, i.e. of values evaluating expects. */
+guint gnc_expression_get_num_variables (const GncExpression *exp);
+
+const char * gnc_expression_get_variable_name (const GncExpression *exp,
+                                               guint slot);
+
+/* The slot of the named variable, -1 if the expression hasn't one. */
+gint gnc_expression_get_variable_slot (const GncExpression *exp,
+                                       const char *name);
+
+/* Evaluate the expression with the values of its variables by slot.
+ * On success, return TRUE, the value of the expression in *value_p if
+ * value_p is non-NULL, and the values the expression assigns to
+ * variables in their slots. Otherwise, return FALSE, and
+ * gnc_exp_parser_error_string() tells why. */
+gboolean gnc_expression_evaluate (const GncExpression *exp,
+                                  gnc_numeric *values,
+                                  gnc_numeric *value_p);
+
 #endif
@@ -32,6 +32,17 @@ static QofLogModule log_module = G_LOG_DOMAIN;
 
 /* Keys used for core preferences */
 #define GNC_PREF_FILE_COMPRESSION    "file-compression"
+#define GNC_PREF_FILE_COMPRESSION_ZSTD "file-compression-zstd"
+#define GNC_PREF_FILE_JOURNAL        "file-journal"
+#define GNC_PREF_FILE_SNAPSHOT       "file-snapshot"
+#define GNC_PREF_FILE_ARCHIVE_YEARS  "file-archive-years"
+#define GNC_PREF_SQL_INSERT_ROWS     "sql-insert-rows"
+#define GNC_PREF_SQL_LOAD_ON_DEMAND  "sql-load-on-demand"
+#define GNC_PREF_SQL_ASYNC_COMMIT    "sql-async-commit"
+#define GNC_PREF_SQL_CHANGE_LOG      "sql-change-log"
+#define GNC_PREF_SQLITE_PARANOID     "sqlite-paranoid"
+#define GNC_PREF_SQL_NATIVE_GUIDS    "sql-native-guids"
+#define GNC_PREF_SQL_SLOW_QUERY_MS   "sql-slow-query-ms"
 #define GNC_PREF_RETAIN_TYPE_NEVER   "retain-type-never"
 #define GNC_PREF_RETAIN_TYPE_DAYS    "retain-type-days"
 #define GNC_PREF_RETAIN_TYPE_FOREVER "retain-type-forever"
@@ -68,6 +79,86 @@ file_retain_type_changed_cb(gpointer gsettings, gchar *key, gpointer user_data)
     }
 }
 
+static void
+file_journal_changed_cb(gpointer gsettings, gchar *key, gpointer user_data)
+{
+    if (gnc_prefs_is_set_up())
+        gnc_prefs_set_file_save_journal (gnc_prefs_get_bool (GNC_PREFS_GROUP_GENERAL,
+                                                             GNC_PREF_FILE_JOURNAL));
+}
+
+static void
+file_snapshot_changed_cb(gpointer gsettings, gchar *key, gpointer user_data)
+{
+    if (gnc_prefs_is_set_up())
+        gnc_prefs_set_file_save_snapshot (gnc_prefs_get_bool (GNC_PREFS_GROUP_GENERAL,
+                                                              GNC_PREF_FILE_SNAPSHOT));
+}
+
+static void
+file_archive_years_changed_cb(gpointer gsettings, gchar *key, gpointer user_data)
+{
+    if (gnc_prefs_is_set_up())
+        gnc_prefs_set_file_archive_years (gnc_prefs_get_int (GNC_PREFS_GROUP_GENERAL,
+                                                             GNC_PREF_FILE_ARCHIVE_YEARS));
+}
+
+static void
+sql_insert_rows_changed_cb(gpointer gsettings, gchar *key, gpointer user_data)
+{
+    if (gnc_prefs_is_set_up())
+        gnc_prefs_set_sql_insert_rows (gnc_prefs_get_int (GNC_PREFS_GROUP_GENERAL,
+                                                          GNC_PREF_SQL_INSERT_ROWS));
+}
+
+static void
+sql_load_on_demand_changed_cb(gpointer gsettings, gchar *key, gpointer user_data)
+{
+    if (gnc_prefs_is_set_up())
+        gnc_prefs_set_sql_load_on_demand (gnc_prefs_get_bool (GNC_PREFS_GROUP_GENERAL,
+                                                              GNC_PREF_SQL_LOAD_ON_DEMAND));
+}
+
+static void
+sql_async_commit_changed_cb(gpointer gsettings, gchar *key, gpointer user_data)
+{
+    if (gnc_prefs_is_set_up())
+        gnc_prefs_set_sql_async_commit (gnc_prefs_get_bool (GNC_PREFS_GROUP_GENERAL,
+                                                            GNC_PREF_SQL_ASYNC_COMMIT));
+}
+
+static void
+sql_change_log_changed_cb(gpointer gsettings, gchar *key, gpointer user_data)
+{
+    if (gnc_prefs_is_set_up())
+        gnc_prefs_set_sql_change_log (gnc_prefs_get_bool (GNC_PREFS_GROUP_GENERAL,
+                                                          GNC_PREF_SQL_CHANGE_LOG));
+}
+
+static void
+sqlite_paranoid_changed_cb(gpointer gsettings, gchar *key, gpointer user_data)
+{
+    if (gnc_prefs_is_set_up())
+        gnc_prefs_set_sqlite_paranoid (gnc_prefs_get_bool (GNC_PREFS_GROUP_GENERAL,
+                                                           GNC_PREF_SQLITE_PARANOID));
+}
+
+static void
+sql_native_guids_changed_cb(gpointer gsettings, gchar *key, gpointer user_data)
+{
+    if (gnc_prefs_is_set_up())
+        gnc_prefs_set_sql_native_guids (gnc_prefs_get_bool (GNC_PREFS_GROUP_GENERAL,
+                                                            GNC_PREF_SQL_NATIVE_GUIDS));
+}
+
+static void
+sql_slow_query_ms_changed_cb(gpointer gsettings, gchar *key, gpointer user_data)
+{
+    if (gnc_prefs_is_set_up())
+        gnc_prefs_set_sql_slow_query_ms (gnc_prefs_get_int (GNC_PREFS_GROUP_GENERAL,
+                                                            GNC_PREF_SQL_SLOW_QUERY_MS));
+}
+
 static void
 file_compression_changed_cb(gpointer gsettings, gchar *key, gpointer user_data)
 {
@@ -75,6 +166,8 @@ file_compression_changed_cb(gpointer gsettings, gchar *key, gpointer user_data)
     {
         gboolean file_compression = gnc_prefs_get_bool(GNC_PREFS_GROUP_GENERAL, GNC_PREF_FILE_COMPRESSION);
         gnc_prefs_set_file_save_compressed (file_compression);
+        gnc_prefs_set_file_save_zstd (gnc_prefs_get_bool (GNC_PREFS_GROUP_GENERAL,
+                                                           GNC_PREF_FILE_COMPRESSION_ZSTD));
     }
 }
 
@@ -89,6 +182,16 @@ void gnc_prefs_init (void)
     file_retain_changed_cb (NULL, NULL, NULL);
     file_retain_type_changed_cb (NULL, NULL, NULL);
     file_compression_changed_cb (NULL, NULL, NULL);
+    file_journal_changed_cb (NULL, NULL, NULL);
+    file_snapshot_changed_cb (NULL, NULL, NULL);
+    file_archive_years_changed_cb (NULL, NULL, NULL);
+    sql_insert_rows_changed_cb (NULL, NULL, NULL);
+    sql_load_on_demand_changed_cb (NULL, NULL, NULL);
+    sql_async_commit_changed_cb (NULL, NULL, NULL);
+    sql_change_log_changed_cb (NULL, NULL, NULL);
+    sqlite_paranoid_changed_cb (NULL, NULL, NULL);
+    sql_native_guids_changed_cb (NULL, NULL, NULL);
+    sql_slow_query_ms_changed_cb (NULL, NULL, NULL);
 
     /* Check for invalid retain_type (days)/retain_days (0) combo.
      * This can happen either because a user changed the preferences
@@ -122,6 +225,28 @@ void gnc_prefs_init (void)
                            file_retain_type_changed_cb, NULL);
     gnc_prefs_register_cb (GNC_PREFS_GROUP_GENERAL, GNC_PREF_FILE_COMPRESSION,
                            file_compression_changed_cb, NULL);
+    gnc_prefs_register_cb (GNC_PREFS_GROUP_GENERAL, GNC_PREF_FILE_COMPRESSION_ZSTD,
+                           file_compression_changed_cb, NULL);
+    gnc_prefs_register_cb (GNC_PREFS_GROUP_GENERAL, GNC_PREF_FILE_JOURNAL,
+                           file_journal_changed_cb, NULL);
+    gnc_prefs_register_cb (GNC_PREFS_GROUP_GENERAL, GNC_PREF_FILE_SNAPSHOT,
+                           file_snapshot_changed_cb, NULL);
+    gnc_prefs_register_cb (GNC_PREFS_GROUP_GENERAL, GNC_PREF_FILE_ARCHIVE_YEARS,
+                           file_archive_years_changed_cb, NULL);
+    gnc_prefs_register_cb (GNC_PREFS_GROUP_GENERAL, GNC_PREF_SQL_INSERT_ROWS,
+                           sql_insert_rows_changed_cb, NULL);
+    gnc_prefs_register_cb (GNC_PREFS_GROUP_GENERAL, GNC_PREF_SQL_LOAD_ON_DEMAND,
+                           sql_load_on_demand_changed_cb, NULL);
+    gnc_prefs_register_cb (GNC_PREFS_GROUP_GENERAL, GNC_PREF_SQL_ASYNC_COMMIT,
+                           sql_async_commit_changed_cb, NULL);
+    gnc_prefs_register_cb (GNC_PREFS_GROUP_GENERAL, GNC_PREF_SQL_CHANGE_LOG,
+                           sql_change_log_changed_cb, NULL);
+    gnc_prefs_register_cb (GNC_PREFS_GROUP_GENERAL, GNC_PREF_SQLITE_PARANOID,
+                           sqlite_paranoid_changed_cb, NULL);
+    gnc_prefs_register_cb (GNC_PREFS_GROUP_GENERAL, GNC_PREF_SQL_NATIVE_GUIDS,
+                           sql_native_guids_changed_cb, NULL);
+    gnc_prefs_register_cb (GNC_PREFS_GROUP_GENERAL, GNC_PREF_SQL_SLOW_QUERY_MS,
+                           sql_slow_query_ms_changed_cb, NULL);
 
 }
 
@@ -139,4 +264,26 @@ gnc_prefs_remove_registered (void)
                            file_retain_type_changed_cb, NULL);
     gnc_prefs_remove_cb_by_func (GNC_PREFS_GROUP_GENERAL, GNC_PREF_FILE_COMPRESSION,
                            file_compression_changed_cb, NULL);
+    gnc_prefs_remove_cb_by_func (GNC_PREFS_GROUP_GENERAL, GNC_PREF_FILE_COMPRESSION_ZSTD,
+                           file_compression_changed_cb, NULL);
+    gnc_prefs_remove_cb_by_func (GNC_PREFS_GROUP_GENERAL, GNC_PREF_FILE_JOURNAL,
+                           file_journal_changed_cb, NULL);
+    gnc_prefs_remove_cb_by_func (GNC_PREFS_GROUP_GENERAL, GNC_PREF_FILE_SNAPSHOT,
+                           file_snapshot_changed_cb, NULL);
+    gnc_prefs_remove_cb_by_func (GNC_PREFS_GROUP_GENERAL, GNC_PREF_FILE_ARCHIVE_YEARS,
+                           file_archive_years_changed_cb, NULL);
+    gnc_prefs_remove_cb_by_func (GNC_PREFS_GROUP_GENERAL, GNC_PREF_SQL_INSERT_ROWS,
+                           sql_insert_rows_changed_cb, NULL);
+    gnc_prefs_remove_cb_by_func (GNC_PREFS_GROUP_GENERAL, GNC_PREF_SQL_LOAD_ON_DEMAND,
+                           sql_load_on_demand_changed_cb, NULL);
+    gnc_prefs_remove_cb_by_func (GNC_PREFS_GROUP_GENERAL, GNC_PREF_SQL_ASYNC_COMMIT,
+                           sql_async_commit_changed_cb, NULL);
+    gnc_prefs_remove_cb_by_func (GNC_PREFS_GROUP_GENERAL, GNC_PREF_SQL_CHANGE_LOG,
+                           sql_change_log_changed_cb, NULL);
+    gnc_prefs_remove_cb_by_func (GNC_PREFS_GROUP_GENERAL, GNC_PREF_SQLITE_PARANOID,
+                           sqlite_paranoid_changed_cb, NULL);
+    gnc_prefs_remove_cb_by_func (GNC_PREFS_GROUP_GENERAL, GNC_PREF_SQL_NATIVE_GUIDS,
+                           sql_native_guids_changed_cb, NULL);
+    gnc_prefs_remove_cb_by_func (GNC_PREFS_GROUP_GENERAL, GNC_PREF_SQL_SLOW_QUERY_MS,
+                           sql_slow_query_ms_changed_cb, NULL);
 }
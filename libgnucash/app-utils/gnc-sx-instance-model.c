@@ -699,6 +699,24 @@ _gnc_sx_instance_find_by_sx(GncSxInstances *in_list_instances, SchedXaction *sx_
     return -1;
 }
 
+/* Emit `updated` for sx.  Every consumer calls
+ * gnc_sx_instance_model_update_sx_instances() from its handler, but
+ * the instances only need to be regenerated once, or not at all if
+ * regenerate is FALSE because the SX itself hasn't changed. */
+static void
+gnc_sx_instance_model_emit_updated(GncSxInstanceModel *model, SchedXaction *sx,
+                                   gboolean regenerate)
+{
+    SchedXaction *outer_sx = model->updating_sx;
+    gboolean outer_done = model->updating_sx_done;
+
+    model->updating_sx = sx;
+    model->updating_sx_done = !regenerate;
+    g_signal_emit_by_name(model, "updated", (gpointer)sx);
+    model->updating_sx = outer_sx;
+    model->updating_sx_done = outer_done;
+}
+
 static void
 _gnc_sx_instance_event_handler(QofInstance *ent, QofEventId event_type, gpointer user_data, gpointer evt_data)
 {
@@ -726,7 +744,7 @@ _gnc_sx_instance_event_handler(QofInstance *ent, QofEventId event_type, gpointer
             {
                 if (instances->include_disabled || xaccSchedXactionGetEnabled(sx))
                 {
-                    g_signal_emit_by_name(instances, "updated", (gpointer)sx);
+                    gnc_sx_instance_model_emit_updated(instances, sx, TRUE);
                 }
                 else
                 {
@@ -807,6 +825,13 @@ gnc_sx_instance_model_update_sx_instances(GncSxInstanceModel *model, SchedXactio
     GncSxInstances *existing, *new_instances;
     GList *link;
 
+    if (model->updating_sx == sx)
+    {
+        if (model->updating_sx_done)
+            return;
+        model->updating_sx_done = TRUE;
+    }
+
     link = g_list_find_custom(model->sx_instance_list, sx, (GCompareFunc)_gnc_sx_instance_find_by_sx);
     if (link == NULL)
     {
@@ -823,11 +848,26 @@ gnc_sx_instance_model_update_sx_instances(GncSxInstanceModel *model, SchedXactio
         GList *existing_iter, *new_iter;
         gboolean existing_remain, new_remain;
 
-        // step through the lists pairwise, and retain the existing
-        // instance if the dates align, as soon as they don't stop and
-        // cleanup.
-        existing_iter = existing->instance_list;
+        // drop the existing instances from before the first new one,
+        // e.g. those that have just been created, then step through the
+        // lists pairwise, and retain the existing instance if the dates
+        // align, as soon as they don't stop and cleanup.
         new_iter = new_instances->instance_list;
+        if (new_iter != NULL)
+        {
+            const GDate *first_date = &((GncSxInstance*)new_iter->data)->date;
+
+            while (existing->instance_list != NULL &&
+                   g_date_compare(&((GncSxInstance*)existing->instance_list->data)->date,
+                                  first_date) < 0)
+            {
+                GList *first = existing->instance_list;
+                existing->instance_list = g_list_remove_link(existing->instance_list, first);
+                gnc_sx_instance_free((GncSxInstance*)first->data);
+                g_list_free_1(first);
+            }
+        }
+        existing_iter = existing->instance_list;
         for (; existing_iter != NULL && new_iter != NULL; existing_iter = existing_iter->next, new_iter = new_iter->next)
         {
             GncSxInstance *existing_inst, *new_inst;
@@ -848,6 +888,7 @@ gnc_sx_instance_model_update_sx_instances(GncSxInstanceModel *model, SchedXactio
             // delete excess
             gnc_g_list_cut(&existing->instance_list, existing_iter);
             g_list_foreach(existing_iter, (GFunc)gnc_sx_instance_free, NULL);
+            g_list_free(existing_iter);
         }
 
         if (new_remain)
@@ -860,9 +901,8 @@ gnc_sx_instance_model_update_sx_instances(GncSxInstanceModel *model, SchedXactio
             {
                 GncSxInstance *inst = (GncSxInstance*)new_iter_iter->data;
                 inst->parent = existing;
-                existing->instance_list = g_list_append(existing->instance_list, new_iter_iter->data);
             }
-            g_list_free(new_iter);
+            existing->instance_list = g_list_concat(existing->instance_list, new_iter);
         }
     }
 
@@ -968,8 +1008,20 @@ typedef struct _SxTxnCreationData
     GncSxInstance *instance;
     GList **created_txn_guids;
     GList **creation_errors;
+    /* Template split -> SxSplitValue worked out ahead, or NULL */
+    GHashTable *split_values;
+    /* Whether a formula called a function on a thread refusing them */
+    gboolean refused;
 } SxTxnCreationData;
 
+/* The value of a template split for an instance and the errors its
+ * formulas gave, worked out before creating the transaction. */
+typedef struct
+{
+    gnc_numeric value;
+    GList *errors;
+} SxSplitValue;
+
 static gboolean
 _get_template_split_account(const SchedXaction* sx,
 			    const Split *template_split,
@@ -997,6 +1049,69 @@ _get_template_split_account(const SchedXaction* sx,
     return success;
 }
 
+/* The formulas of the template splits, compiled, by their text.  The
+ * same few are evaluated for every instance, with its own variables.
+ * Each thread has its own, which goes with it. */
+#define SX_FORMULA_CACHE_MAX 1024
+static GPrivate sx_formulas_key =
+    G_PRIVATE_INIT ((GDestroyNotify) g_hash_table_destroy);
+
+static GncExpression *
+sx_formula_compile (const char *formula, char **error_loc)
+{
+    GHashTable *formulas = g_private_get (&sx_formulas_key);
+    GncExpression *exp;
+
+    if (!formulas)
+    {
+        formulas = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+                                          (GDestroyNotify) gnc_expression_free);
+        g_private_set (&sx_formulas_key, formulas);
+    }
+
+    exp = g_hash_table_lookup (formulas, formula);
+    if (exp)
+        return exp;
+
+    exp = gnc_exp_parser_compile (formula, error_loc);
+    if (!exp)
+        return NULL;
+    if (g_hash_table_size (formulas) >= SX_FORMULA_CACHE_MAX)
+        g_hash_table_remove_all (formulas);
+    g_hash_table_insert (formulas, g_strdup (formula), exp);
+    return exp;
+}
+
+/* Evaluate formula as gnc_exp_parser_parse_separate_vars() does with
+ * the values of the variable_bindings, any other variable being zero. */
+static gboolean
+sx_formula_evaluate (const char *formula, GHashTable *variable_bindings,
+                     gnc_numeric *numeric, char **error_loc)
+{
+    GncExpression *exp = sx_formula_compile (formula, error_loc);
+    gnc_numeric *values;
+    guint n, i;
+    gboolean ok;
+
+    if (!exp)
+        return FALSE;
+
+    n = gnc_expression_get_num_variables (exp);
+    values = g_new (gnc_numeric, MAX (n, 1));
+    for (i = 0; i < n; i++)
+    {
+        GncSxVariable *var =
+            g_hash_table_lookup (variable_bindings,
+                                 gnc_expression_get_variable_name (exp, i));
+        values[i] = var ? var->value : gnc_numeric_zero ();
+    }
+
+    ok = gnc_expression_evaluate (exp, values, numeric);
+    *error_loc = ok ? NULL : (char *) formula;
+    g_free (values);
+    return ok;
+}
+
 static void
 _get_sx_formula_value(const SchedXaction* sx,
 		      const Split *template_split,
@@ -1030,15 +1145,20 @@ _get_sx_formula_value(const SchedXaction* sx,
 
     if (formula_str != NULL && strlen(formula_str) != 0)
     {
-        GHashTable *parser_vars = NULL;
+        gboolean ok;
         if (variable_bindings)
         {
-            parser_vars = gnc_sx_instance_get_variables_for_parser(variable_bindings);
+            ok = sx_formula_evaluate (formula_str, variable_bindings,
+                                      numeric, &parseErrorLoc);
         }
-        if (!gnc_exp_parser_parse_separate_vars(formula_str,
-                                                numeric,
-                                                &parseErrorLoc,
-                                                parser_vars))
+        else
+        {
+            ok = gnc_exp_parser_parse_separate_vars (formula_str, numeric,
+                                                     &parseErrorLoc, NULL);
+        }
+        /* A refused function call is left to the thread that can run
+         * it, which reports any error. */
+        if (!ok && !gnc_exp_parser_function_refused ())
         {
             gchar *err = N_("Error parsing SX [%s] key [%s]=formula [%s] at [%s]: %s.");
             REPORT_ERROR(creation_errors, err,
@@ -1048,11 +1168,6 @@ _get_sx_formula_value(const SchedXaction* sx,
                     parseErrorLoc,
                     gnc_exp_parser_error_string());
        }
-
-        if (parser_vars != NULL)
-        {
-            g_hash_table_destroy(parser_vars);
-        }
     }
 }
 
@@ -1086,8 +1201,12 @@ split_apply_formulas (const Split *split, SxTxnCreationData* creation_data)
 
     _get_credit_formula_value(creation_data->instance, split, &credit_num,
                               creation_data->creation_errors);
+    if (gnc_exp_parser_function_refused ())
+        creation_data->refused = TRUE;
     _get_debit_formula_value(creation_data->instance, split, &debit_num,
                              creation_data->creation_errors);
+    if (gnc_exp_parser_function_refused ())
+        creation_data->refused = TRUE;
 
     final = gnc_numeric_sub_fixed(debit_num, credit_num);
 
@@ -1102,6 +1221,34 @@ split_apply_formulas (const Split *split, SxTxnCreationData* creation_data)
     return final;
 }
 
+static void
+sx_split_value_free (gpointer data)
+{
+    SxSplitValue *split_value = data;
+
+    g_list_free_full (split_value->errors, g_free);
+    g_free (split_value);
+}
+
+/* The template split's value for the instance, taken from the ones
+ * worked out ahead if it was, with its errors. */
+static gnc_numeric
+sx_split_value (const Split *template_split, SxTxnCreationData *creation_data)
+{
+    SxSplitValue *split_value = NULL;
+
+    if (creation_data->split_values)
+        split_value = g_hash_table_lookup (creation_data->split_values,
+                                           template_split);
+    if (!split_value)
+        return split_apply_formulas (template_split, creation_data);
+
+    *creation_data->creation_errors =
+        g_list_concat (*creation_data->creation_errors, split_value->errors);
+    split_value->errors = NULL;
+    return split_value->value;
+}
+
 static void
 split_apply_exchange_rate (Split *split, GHashTable *bindings,
                            gnc_commodity *first_cmdty,
@@ -1285,8 +1432,8 @@ create_each_transaction_helper(Transaction *template_txn, void *user_data)
         xaccSplitSetAccount(copying_split, split_acct);
 
         {
-            gnc_numeric final = split_apply_formulas(template_split,
-                                                     creation_data);
+            gnc_numeric final = sx_split_value(template_split,
+                                               creation_data);
             xaccSplitSetValue(copying_split, final);
             g_debug("value is %s for memo split '%s'",
                     gnc_numeric_to_string (final),
@@ -1312,18 +1459,22 @@ create_each_transaction_helper(Transaction *template_txn, void *user_data)
 
     xaccTransCommitEdit(new_txn);
 
+    /* Prepended; gnc_sx_instance_model_effect_change puts them in order. */
     if (creation_data->created_txn_guids != NULL)
     {
         *creation_data->created_txn_guids
-            = g_list_append(*(creation_data->created_txn_guids),
-                            (gpointer)xaccTransGetGUID(new_txn));
+            = g_list_prepend(*(creation_data->created_txn_guids),
+                             (gpointer)xaccTransGetGUID(new_txn));
     }
 
     return FALSE;
 }
 
 static void
-create_transactions_for_instance(GncSxInstance *instance, GList **created_txn_guids, GList **creation_errors)
+create_transactions_for_instance(GncSxInstance *instance,
+                                 GHashTable *split_values,
+                                 GList **created_txn_guids,
+                                 GList **creation_errors)
 {
     SxTxnCreationData creation_data;
     Account *sx_template_account;
@@ -1333,14 +1484,190 @@ create_transactions_for_instance(GncSxInstance *instance, GList **created_txn_gu
     creation_data.instance = instance;
     creation_data.created_txn_guids = created_txn_guids;
     creation_data.creation_errors = creation_errors;
+    creation_data.split_values = split_values;
+    creation_data.refused = FALSE;
     /* Don't update the GUI for every transaction, it can really slow things
-     * down.
+     * down.  The caller's event batch hands the changes on at its end.
      */
-    qof_event_suspend();
+    qof_event_begin_batch();
     xaccAccountForEachTransaction(sx_template_account,
                                   create_each_transaction_helper,
                                   &creation_data);
-    qof_event_resume();
+    qof_event_end_batch();
+}
+
+/* Fewer instances than this for each thread aren't worth starting it. */
+#define SX_CREATE_INSTANCES_PER_THREAD 8
+
+/* An instance gnc_sx_instance_model_effect_change creates, with the
+ * values of its template splits when they were worked out ahead and
+ * the errors creating it gave. */
+typedef struct
+{
+    GncSxInstance *instance;
+    GList *template_splits;
+    GHashTable *split_values;
+    GList *errors;
+} SxCreateTask;
+
+/* The share of the instances to work out of one thread */
+typedef struct
+{
+    SxCreateTask *tasks;
+    guint n_tasks;
+    gboolean refuse_functions;
+} SxCreateRun;
+
+static gpointer
+evaluate_split_values_thread (gpointer data)
+{
+    SxCreateRun *run = data;
+    guint i;
+
+    /* Only the calling thread may call into Guile; the instances whose
+     * formulas need it are evaluated while creating them. */
+    gnc_exp_parser_refuse_functions (run->refuse_functions);
+    for (i = 0; i < run->n_tasks; i++)
+    {
+        SxCreateTask *task = &run->tasks[i];
+        SxTxnCreationData creation_data = { task->instance, NULL, NULL,
+                                            NULL, FALSE };
+        GList *node;
+
+        task->split_values = g_hash_table_new_full (NULL, NULL, NULL,
+                                                    sx_split_value_free);
+        for (node = task->template_splits; node; node = node->next)
+        {
+            SxSplitValue *split_value = g_new0 (SxSplitValue, 1);
+
+            creation_data.creation_errors = &split_value->errors;
+            split_value->value = split_apply_formulas (node->data,
+                                                       &creation_data);
+            g_hash_table_insert (task->split_values, node->data, split_value);
+        }
+        if (creation_data.refused)
+        {
+            g_hash_table_destroy (task->split_values);
+            task->split_values = NULL;
+        }
+    }
+    gnc_exp_parser_refuse_functions (FALSE);
+    return NULL;
+}
+
+/* Work out the template splits' values of the tasks on as many threads
+ * as are worth it.  Each instance has its own variables and the engine
+ * is only read, so they can be left to worker threads; with one thread
+ * there's nothing to gain and they're evaluated as the transactions are
+ * created. */
+static void
+evaluate_split_values (SxCreateTask *tasks, guint n_tasks)
+{
+    guint n_threads, i;
+    SxCreateRun *runs;
+    GThread **threads;
+
+    n_threads = MIN ((guint) g_get_num_processors (),
+                     n_tasks / SX_CREATE_INSTANCES_PER_THREAD);
+    if (n_threads < 2)
+        return;
+
+    gnc_exp_parser_init_once ();
+    /* Sort the template split lists here, not on the threads. */
+    for (i = 0; i < n_tasks; i++)
+        tasks[i].template_splits = xaccAccountGetSplitList
+            (gnc_sx_get_template_transaction_account (tasks[i].instance->parent->sx));
+
+    runs = g_new0 (SxCreateRun, n_threads);
+    threads = g_new0 (GThread*, n_threads);
+    for (i = 0; i < n_threads; i++)
+    {
+        guint first = n_tasks * i / n_threads;
+
+        runs[i].tasks = tasks + first;
+        runs[i].n_tasks = n_tasks * (i + 1) / n_threads - first;
+        runs[i].refuse_functions = i > 0;
+    }
+    for (i = 1; i < n_threads; i++)
+        threads[i] = g_thread_new ("sx_create", evaluate_split_values_thread,
+                                   &runs[i]);
+    evaluate_split_values_thread (&runs[0]);
+    for (i = 1; i < n_threads; i++)
+        g_thread_join (threads[i]);
+
+    g_free (threads);
+    g_free (runs);
+}
+
+/* The instances gnc_sx_instance_model_effect_change will create, in the
+ * order it comes to them. */
+static GArray *
+sx_instances_to_create (GncSxInstanceModel *model, gboolean auto_create_only)
+{
+    GArray *tasks = g_array_new (FALSE, TRUE, sizeof (SxCreateTask));
+    GList *iter;
+
+    for (iter = model->sx_instance_list; iter != NULL; iter = iter->next)
+    {
+        GncSxInstances *instances = (GncSxInstances*)iter->data;
+        GList *instance_iter;
+        gboolean sx_is_auto_create;
+
+        xaccSchedXactionGetAutoCreate(instances->sx, &sx_is_auto_create, NULL);
+        for (instance_iter = instances->instance_list; instance_iter != NULL; instance_iter = instance_iter->next)
+        {
+            GncSxInstance *inst = (GncSxInstance*)instance_iter->data;
+
+            if (auto_create_only && !sx_is_auto_create)
+            {
+                if (inst->state != SX_INSTANCE_STATE_TO_CREATE)
+                    break;
+                continue;
+            }
+            if (inst->state == SX_INSTANCE_STATE_TO_CREATE)
+            {
+                SxCreateTask task = { inst, NULL, NULL, NULL };
+                g_array_append_val (tasks, task);
+            }
+        }
+    }
+    return tasks;
+}
+
+/* Create the transactions of all the instances in one event batch, so
+ * that the registers refresh once at its end instead of for each
+ * transaction, after working out their values on several threads.
+ * Returns the tasks by instance. */
+static GHashTable *
+create_transactions_for_instances (GArray *tasks, GList **created_txn_guids)
+{
+    GHashTable *by_instance = g_hash_table_new (NULL, NULL);
+    GList *created = NULL;
+    guint i;
+
+    evaluate_split_values ((SxCreateTask*) tasks->data, tasks->len);
+
+    qof_event_begin_batch ();
+    for (i = 0; i < tasks->len; i++)
+    {
+        SxCreateTask *task = &g_array_index (tasks, SxCreateTask, i);
+
+        create_transactions_for_instance (task->instance, task->split_values,
+                                          created_txn_guids ? &created : NULL,
+                                          &task->errors);
+        if (task->split_values)
+        {
+            g_hash_table_destroy (task->split_values);
+            task->split_values = NULL;
+        }
+        g_hash_table_insert (by_instance, task->instance, task);
+    }
+    qof_event_end_batch ();
+
+    if (created_txn_guids)
+        *created_txn_guids = g_list_concat (*created_txn_guids,
+                                            g_list_reverse (created));
+    return by_instance;
 }
 
 void
@@ -1350,13 +1677,25 @@ gnc_sx_instance_model_effect_change(GncSxInstanceModel *model,
                                     GList **creation_errors)
 {
     GList *iter;
+    QofBook *book = gnc_get_current_book ();
+    GArray *tasks;
+    GHashTable *tasks_by_instance;
+    guint i;
 
-    if (qof_book_is_readonly(gnc_get_current_book()))
+    if (qof_book_is_readonly(book))
     {
         /* Is the book read-only? Then don't change anything here. */
         return;
     }
 
+    qof_book_begin_batch (book);
+    /* The transactions are all created first.  The SXes' own changes
+     * below aren't batched, since this model follows them through its
+     * event handler. */
+    tasks = sx_instances_to_create (model, auto_create_only);
+    tasks_by_instance = create_transactions_for_instances
+        (tasks, created_transaction_guids);
+
     for (iter = model->sx_instance_list; iter != NULL; iter = iter->next)
     {
         GList *instance_iter;
@@ -1417,9 +1756,28 @@ gnc_sx_instance_model_effect_change(GncSxInstanceModel *model,
                     increment_sx_state(inst, &last_occur_date, &instance_count, &remain_occur_count);
                     break;
                 case SX_INSTANCE_STATE_TO_CREATE:
-                    create_transactions_for_instance (inst,
-                                                      created_transaction_guids,
-                                                      &instance_errors);
+                {
+                    SxCreateTask *task = g_hash_table_lookup (tasks_by_instance,
+                                                              inst);
+                    if (task)
+                    {
+                        instance_errors = task->errors;
+                        task->errors = NULL;
+                    }
+                    else
+                    {
+                        /* Not one of those created above; do it now. */
+                        GList *created = NULL;
+                        create_transactions_for_instance (inst, NULL,
+                                                          &created,
+                                                          &instance_errors);
+                        if (created_transaction_guids)
+                            *created_transaction_guids =
+                                g_list_concat (*created_transaction_guids,
+                                               g_list_reverse (created));
+                        else
+                            g_list_free (created);
+                    }
                     if (instance_errors == NULL)
                     {
                         increment_sx_state (inst, &last_occur_date,
@@ -1432,6 +1790,7 @@ gnc_sx_instance_model_effect_change(GncSxInstanceModel *model,
                         *creation_errors = g_list_concat (*creation_errors,
                                                           instance_errors);
                     break;
+                }
                 case SX_INSTANCE_STATE_REMINDER:
                     // do nothing
                     // assert no non-remind instances after this?
@@ -1446,6 +1805,13 @@ gnc_sx_instance_model_effect_change(GncSxInstanceModel *model,
         gnc_sx_set_instance_count(instances->sx, instance_count);
         xaccSchedXactionSetRemOccur(instances->sx, remain_occur_count);
     }
+    qof_book_end_batch (book);
+
+    g_hash_table_destroy (tasks_by_instance);
+    for (i = 0; i < tasks->len; i++)
+        g_list_free_full (g_array_index (tasks, SxCreateTask, i).errors,
+                          g_free);
+    g_array_free (tasks, TRUE);
 }
 
 void
@@ -1487,7 +1853,7 @@ gnc_sx_instance_model_change_instance_state(GncSxInstanceModel *model,
         }
     }
 
-    g_signal_emit_by_name(model, "updated", (gpointer)instance->parent->sx);
+    gnc_sx_instance_model_emit_updated(model, instance->parent->sx, FALSE);
 }
 
 void
@@ -1500,7 +1866,7 @@ gnc_sx_instance_model_set_variable(GncSxInstanceModel *model,
     if (gnc_numeric_equal(variable->value, *new_value))
         return;
     variable->value = *new_value;
-    g_signal_emit_by_name(model, "updated", (gpointer)instance->parent->sx);
+    gnc_sx_instance_model_emit_updated(model, instance->parent->sx, FALSE);
 }
 
 static void
@@ -1618,14 +1984,50 @@ GHashTable* gnc_g_hash_new_guid_numeric()
                                   NULL, gnc_numeric_free);
 }
 
+#define SX_CASHFLOW_CACHE "gnc-sx-cashflow-cache"
+/* Fewer SXes than this for each thread aren't worth starting it. */
+#define SX_CASHFLOW_SXES_PER_THREAD 8
+/* The date ranges remembered for an SX before they are all dropped */
+#define SX_CASHFLOW_MAX_RANGES 512
+
 typedef struct
 {
     GHashTable *hash;
     GList **creation_errors;
     const SchedXaction *sx;
     gnc_numeric count;
+    /* Whether a formula called a function on a thread refusing them */
+    gboolean refused;
 } SxCashflowData;
 
+/* One account's part in the cash flow of an SX, with the commodity the
+ * account had then. */
+typedef struct
+{
+    GncGUID guid;
+    gnc_commodity *commodity;
+    gnc_numeric amount;
+} SxCashflowAmount;
+
+/* The cash flow of an SX over a date range, and the errors reported
+ * on instantiating it. */
+typedef struct
+{
+    GArray *amounts;
+    GList *errors;
+} SxCashflow;
+
+/* The cash flows of a book's SXes, kept until the SXes or their
+ * template transactions change. */
+typedef struct
+{
+    QofBook *book;
+    /* SX -> GHashTable<range key, SxCashflow*> */
+    GHashTable *sxes;
+    gint listener;
+    guint dropped;
+} SxCashflowCache;
+
 static void add_to_hash_amount(GHashTable* hash, const GncGUID* guid, const gnc_numeric* amount)
 {
     /* Do we have a number belonging to this GUID in the hash? If yes,
@@ -1739,10 +2141,14 @@ create_cashflow_helper(Transaction *template_txn, void *user_data)
 				  &credit_num, creation_data->creation_errors,
 				  "sx-credit-formula", "sx-credit-numeric",
 				  NULL);
+            if (gnc_exp_parser_function_refused ())
+                creation_data->refused = TRUE;
             /* Debit value */
             _get_sx_formula_value(creation_data->sx, template_split,
 				  &debit_num, creation_data->creation_errors,
 				  "sx-debit-formula", "sx-debit-numeric", NULL);
+            if (gnc_exp_parser_function_refused ())
+                creation_data->refused = TRUE;
 
             /* The resulting cash flow number: debit minus credit,
              * multiplied with the count factor. */
@@ -1781,82 +2187,328 @@ create_cashflow_helper(Transaction *template_txn, void *user_data)
 }
 
 static void
-instantiate_cashflow_internal(const SchedXaction* sx,
-                              GHashTable* map,
-                              GList **creation_errors, gint count)
+sx_cashflow_free (gpointer data)
+{
+    SxCashflow *flow = data;
+
+    g_array_free (flow->amounts, TRUE);
+    g_list_free_full (flow->errors, g_free);
+    g_free (flow);
+}
+
+/* Returns NULL if a formula calls a function on a thread that refuses
+ * them. */
+static SxCashflow *
+instantiate_cashflow_internal(const SchedXaction* sx, QofBook *book,
+                              gint count)
 {
     SxCashflowData create_cashflow_data;
-    Account* sx_template_account = gnc_sx_get_template_transaction_account(sx);
+    Account* sx_template_account;
+    SxCashflow *flow = g_new0 (SxCashflow, 1);
+    GHashTableIter iter;
+    gpointer key, value;
 
+    flow->amounts = g_array_new (FALSE, FALSE, sizeof (SxCashflowAmount));
+    if (count <= 0)
+        return flow;
+
+    sx_template_account = gnc_sx_get_template_transaction_account(sx);
     if (!sx_template_account)
     {
         g_critical("Huh? No template account for the SX %s", xaccSchedXactionGetName(sx));
-        return;
+        return flow;
     }
 
     if (!xaccSchedXactionGetEnabled(sx))
     {
         g_debug("Skipping non-enabled SX [%s]",
                 xaccSchedXactionGetName(sx));
-        return;
+        return flow;
     }
 
-    create_cashflow_data.hash = map;
-    create_cashflow_data.creation_errors = creation_errors;
+    create_cashflow_data.hash = gnc_g_hash_new_guid_numeric ();
+    create_cashflow_data.creation_errors = &flow->errors;
     create_cashflow_data.sx = sx;
     create_cashflow_data.count = gnc_numeric_create(count, 1);
+    create_cashflow_data.refused = FALSE;
 
     /* The cash flow numbers are in the transactions of the template
      * account, so run this foreach on the transactions. */
     xaccAccountForEachTransaction(sx_template_account,
                                   create_cashflow_helper,
                                   &create_cashflow_data);
+
+    g_hash_table_iter_init (&iter, create_cashflow_data.hash);
+    while (g_hash_table_iter_next (&iter, &key, &value))
+    {
+        SxCashflowAmount amount;
+
+        amount.guid = *(const GncGUID*) key;
+        amount.commodity =
+            xaccAccountGetCommodity (xaccAccountLookup (key, book));
+        amount.amount = *(gnc_numeric*) value;
+        g_array_append_val (flow->amounts, amount);
+    }
+    g_hash_table_destroy (create_cashflow_data.hash);
+
+    if (create_cashflow_data.refused)
+    {
+        sx_cashflow_free (flow);
+        return NULL;
+    }
+    return flow;
+}
+
+/* Whether the accounts of a cached cash flow are still there, in the
+ * same commodity. */
+static gboolean
+sx_cashflow_valid (const SxCashflow *flow, QofBook *book)
+{
+    guint i;
+
+    for (i = 0; i < flow->amounts->len; i++)
+    {
+        const SxCashflowAmount *amount =
+            &g_array_index (flow->amounts, SxCashflowAmount, i);
+        Account *acct = xaccAccountLookup (&amount->guid, book);
+
+        if (!acct || xaccAccountGetCommodity (acct) != amount->commodity)
+            return FALSE;
+    }
+    return TRUE;
+}
+
+static void
+sx_cashflow_cache_event_cb (QofInstance *ent, QofEventId event_type,
+                            gpointer user_data, gpointer event_data)
+{
+    SxCashflowCache *cache = user_data;
+    Account *acct = NULL;
+
+    if (!ent || qof_instance_get_book (ent) != cache->book)
+        return;
+
+    /* The template transactions of the SXes are in the accounts below
+     * the template root; any change to them can be to any SX. */
+    if (GNC_IS_SX (ent))
+        g_hash_table_remove (cache->sxes, ent);
+    else if (GNC_IS_ACCOUNT (ent))
+        acct = GNC_ACCOUNT (ent);
+    else if (GNC_IS_SPLIT (ent))
+        acct = xaccSplitGetAccount (GNC_SPLIT (ent));
+    else if (GNC_IS_TRANSACTION (ent))
+    {
+        Split *split = xaccTransGetSplit (GNC_TRANSACTION (ent), 0);
+        acct = split ? xaccSplitGetAccount (split) : NULL;
+    }
+
+    if (acct &&
+        gnc_account_get_root (acct) == gnc_book_get_template_root (cache->book))
+        g_hash_table_remove_all (cache->sxes);
+}
+
+static void
+sx_cashflow_cache_destroy (QofBook *book, gpointer key, gpointer user_data)
+{
+    SxCashflowCache *cache = user_data;
+
+    qof_event_unregister_handler (cache->listener);
+    g_hash_table_destroy (cache->sxes);
+    g_free (cache);
+}
+
+static SxCashflowCache *
+sx_cashflow_cache (QofBook *book)
+{
+    SxCashflowCache *cache = qof_book_get_data (book, SX_CASHFLOW_CACHE);
+
+    if (!cache)
+    {
+        cache = g_new0 (SxCashflowCache, 1);
+        cache->book = book;
+        cache->sxes = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+                                             NULL,
+                                             (GDestroyNotify) g_hash_table_destroy);
+        cache->listener =
+            qof_event_register_handler (sx_cashflow_cache_event_cb, cache);
+        cache->dropped = qof_event_get_dropped_count ();
+        qof_book_set_data_fin (book, SX_CASHFLOW_CACHE, cache,
+                               sx_cashflow_cache_destroy);
+    }
+    else if (qof_event_get_dropped_count () != cache->dropped)
+    {
+        /* Some changes went by unseen. */
+        g_hash_table_remove_all (cache->sxes);
+        cache->dropped = qof_event_get_dropped_count ();
+    }
+    return cache;
 }
 
 typedef struct
 {
-    GHashTable *hash;
-    GList **creation_errors;
+    const SchedXaction *sx;
+    SxCashflow *flow;
+    gboolean cached;
+} SxCashflowTask;
+
+/* The share of the SXes to instantiate of one thread */
+typedef struct
+{
+    SxCashflowTask **tasks;
+    guint n_tasks;
+    QofBook *book;
     const GDate *range_start;
     const GDate *range_end;
-} SxAllCashflow;
+    gboolean refuse_functions;
+} SxCashflowRun;
 
-static void instantiate_cashflow_cb(gpointer data, gpointer _user_data)
+static gpointer
+instantiate_cashflow_thread (gpointer data)
 {
-    const SchedXaction* sx = (const SchedXaction*) data;
-    SxAllCashflow* userdata = (SxAllCashflow*) _user_data;
-    gint count;
-
-    g_assert(sx);
-    g_assert(userdata);
+    SxCashflowRun *run = data;
+    guint i;
 
-    /* How often does this particular SX occur in the date range? */
-    count = gnc_sx_get_num_occur_daterange(sx, userdata->range_start,
-                                           userdata->range_end);
-    if (count > 0)
+    /* Only the calling thread may call into Guile; the SXes whose
+     * formulas need it are left to it. */
+    gnc_exp_parser_refuse_functions (run->refuse_functions);
+    for (i = 0; i < run->n_tasks; i++)
     {
-        /* If it occurs at least once, calculate ("instantiate") its
-         * cash flow and add it to the result
-         * g_hash<GUID,gnc_numeric> */
-        instantiate_cashflow_internal(sx,
-                                      userdata->hash,
-                                      userdata->creation_errors,
-                                      count);
+        SxCashflowTask *task = run->tasks[i];
+
+        /* How often does this particular SX occur in the date range? */
+        gint count = gnc_sx_get_num_occur_daterange (task->sx,
+                                                     run->range_start,
+                                                     run->range_end);
+        task->flow = instantiate_cashflow_internal (task->sx, run->book,
+                                                    count);
     }
+    gnc_exp_parser_refuse_functions (FALSE);
+    return NULL;
 }
 
 void gnc_sx_all_instantiate_cashflow(GList *all_sxes,
                                      const GDate *range_start, const GDate *range_end,
                                      GHashTable* map, GList **creation_errors)
 {
-    SxAllCashflow userdata;
-    userdata.hash = map;
-    userdata.creation_errors = creation_errors;
-    userdata.range_start = range_start;
-    userdata.range_end = range_end;
+    QofBook *book = gnc_get_current_book ();
+    SxCashflowCache *cache = sx_cashflow_cache (book);
+    guint n_sxes = g_list_length (all_sxes), n_todo = 0, n_threads, i;
+    SxCashflowTask *tasks = g_new0 (SxCashflowTask, n_sxes);
+    SxCashflowTask **todo = g_new (SxCashflowTask*, n_sxes);
+    SxCashflowRun *runs;
+    GThread **threads;
+    gint64 range = 0;
+    gboolean cacheable = g_date_valid (range_start) && g_date_valid (range_end);
+    GList *node;
+
+    if (cacheable)
+        range = (gint64) g_date_get_julian (range_start) << 32 |
+                g_date_get_julian (range_end);
+
+    for (node = all_sxes, i = 0; node; node = node->next, i++)
+    {
+        SxCashflowTask *task = &tasks[i];
+        GHashTable *ranges;
+
+        task->sx = node->data;
+        g_assert (task->sx);
+        ranges = cacheable ? g_hash_table_lookup (cache->sxes, task->sx) : NULL;
+        if (ranges)
+            task->flow = g_hash_table_lookup (ranges, &range);
+        if (task->flow && sx_cashflow_valid (task->flow, book))
+            task->cached = TRUE;
+        else
+        {
+            task->flow = NULL;
+            todo[n_todo++] = task;
+        }
+    }
+
+    /* Every SX is instantiated on its own, with its own hash and list of
+     * errors, so they can be left to worker threads; the engine is
+     * only read. */
+    n_threads = MIN ((guint) g_get_num_processors (),
+                     n_todo / SX_CASHFLOW_SXES_PER_THREAD);
+    n_threads = MAX (n_threads, 1);
+    if (n_threads > 1)
+        gnc_exp_parser_init_once ();
+
+    runs = g_new0 (SxCashflowRun, n_threads);
+    threads = g_new0 (GThread*, n_threads);
+    for (i = 0; i < n_threads; i++)
+    {
+        guint first = n_todo * i / n_threads;
+
+        runs[i].tasks = todo + first;
+        runs[i].n_tasks = n_todo * (i + 1) / n_threads - first;
+        runs[i].book = book;
+        runs[i].range_start = range_start;
+        runs[i].range_end = range_end;
+        runs[i].refuse_functions = i > 0;
+    }
+    for (i = 1; i < n_threads; i++)
+        threads[i] = g_thread_new ("sx_cashflow", instantiate_cashflow_thread,
+                                   &runs[i]);
+    instantiate_cashflow_thread (&runs[0]);
+    for (i = 1; i < n_threads; i++)
+        g_thread_join (threads[i]);
+
+    /* Add up the cash flows in the order of the SXes, instantiating
+     * those the threads couldn't here. */
+    for (i = 0; i < n_sxes; i++)
+    {
+        SxCashflowTask *task = &tasks[i];
+        SxCashflowRun retry = runs[0];
+        guint j;
+
+        if (!task->flow)
+        {
+            retry.tasks = &task;
+            retry.n_tasks = 1;
+            instantiate_cashflow_thread (&retry);
+        }
+
+        for (j = 0; j < task->flow->amounts->len; j++)
+        {
+            SxCashflowAmount *amount =
+                &g_array_index (task->flow->amounts, SxCashflowAmount, j);
+            Account *acct = xaccAccountLookup (&amount->guid, book);
+
+            if (acct)
+                add_to_hash_amount (map, xaccAccountGetGUID (acct),
+                                    &amount->amount);
+        }
+        if (creation_errors)
+            for (node = task->flow->errors; node; node = node->next)
+                *creation_errors = g_list_append (*creation_errors,
+                                                  g_strdup (node->data));
+
+        if (task->cached)
+            continue;
+        if (cacheable && qof_instance_get_book (task->sx) == book)
+        {
+            GHashTable *ranges = g_hash_table_lookup (cache->sxes, task->sx);
+            gint64 *key = g_new (gint64, 1);
+
+            if (!ranges)
+            {
+                ranges = g_hash_table_new_full (g_int64_hash, g_int64_equal,
+                                                g_free, sx_cashflow_free);
+                g_hash_table_insert (cache->sxes, (gpointer) task->sx, ranges);
+            }
+            else if (g_hash_table_size (ranges) >= SX_CASHFLOW_MAX_RANGES)
+                g_hash_table_remove_all (ranges);
+            *key = range;
+            g_hash_table_replace (ranges, key, task->flow);
+        }
+        else
+            sx_cashflow_free (task->flow);
+    }
 
-    /* The work is done in the callback for each SX */
-    g_list_foreach(all_sxes, instantiate_cashflow_cb, &userdata);
+    g_free (threads);
+    g_free (runs);
+    g_free (todo);
+    g_free (tasks);
 }
 
 
@@ -48,6 +48,10 @@ typedef struct _GncSxInstanceModel
 
     /* private */
     gint qof_event_handler_id;
+    /* The SX whose `updated` signal is being emitted, and whether its
+     * instances have been regenerated since. */
+    SchedXaction *updating_sx;
+    gboolean updating_sx_done;
 
     /* signals */
     /* void (*added)(SchedXaction *sx); // gpointer user_data */
@@ -132,6 +136,13 @@ GncSxInstanceModel* gnc_sx_get_instances(const GDate *range_end, gboolean includ
  * consumers are probably going to call this in response to seeing the
  * "update" signal, unless they need to be doing something else like
  * finishing an iteration over an existing GncSxInstances*.
+ *
+ * Instances dated before the first one of the new sequence are dropped,
+ * and the rest are kept, with their states and variable values, for as
+ * long as their dates agree with the new sequence.  Within the handlers
+ * of one "updated" signal only the first call does the work, and none
+ * does if the signal was only for a change of instance state or
+ * variable value.
  **/
 void gnc_sx_instance_model_update_sx_instances(GncSxInstanceModel *model, SchedXaction *sx);
 void gnc_sx_instance_model_remove_sx_instances(GncSxInstanceModel *model, SchedXaction *sx);
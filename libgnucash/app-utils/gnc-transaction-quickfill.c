@@ -0,0 +1,298 @@
+/********************************************************************\
+ * gnc-transaction-quickfill.c -- Create transaction text quick-fills *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ *                                                                  *
+\********************************************************************/
+
+#include <config.h>
+#include "gnc-transaction-quickfill.h"
+#include "gnc-engine.h"
+#include "Transaction.h"
+
+/* This static indicates the debugging module that this .o belongs to. */
+static QofLogModule log_module = GNC_MOD_REGISTER;
+
+#define TRANS_QF_KEY "gnc-transaction-quickfill"
+
+/* Filling the quickfills takes much longer than loading a register, and
+ * nothing needs them until the user starts typing, so they are filled
+ * from the main loop a chunk of transactions at a time. */
+#define TRANS_QF_CHUNK 250
+
+typedef struct
+{
+    QuickFill *desc_qf;
+    QuickFill *notes_qf;
+    QuickFill *memo_qf;
+    QofBook *book;
+    gint  listener;
+    /* The events dropped as of the last fill; if more have been, the
+     * commits they were for never reached the listener. */
+    guint dropped;
+    /* The transactions still to be added, oldest first, and the next
+     * one to add. */
+    GArray *pending;
+    guint pending_pos;
+    guint idle_id;
+} TransQF;
+
+static void
+add_transaction (TransQF *qfb, Transaction *trans)
+{
+    Split *split;
+    int i = 0;
+
+    gnc_quickfill_insert (qfb->desc_qf, xaccTransGetDescription (trans),
+                          QUICKFILL_LIFO);
+    gnc_quickfill_insert (qfb->notes_qf, xaccTransGetNotes (trans),
+                          QUICKFILL_LIFO);
+    while ((split = xaccTransGetSplit (trans, i++)) != NULL)
+        gnc_quickfill_insert (qfb->memo_qf, xaccSplitGetMemo (split),
+                              QUICKFILL_LIFO);
+}
+
+static void
+cancel_pending (TransQF *qfb)
+{
+    if (qfb->idle_id)
+    {
+        g_source_remove (qfb->idle_id);
+        qfb->idle_id = 0;
+    }
+    if (qfb->pending)
+    {
+        g_array_free (qfb->pending, TRUE);
+        qfb->pending = NULL;
+    }
+    qfb->pending_pos = 0;
+}
+
+/* Add up to count of the pending transactions and return whether any
+ * are left. */
+static gboolean
+add_pending (TransQF *qfb, guint count)
+{
+    guint end;
+
+    if (!qfb->pending)
+        return FALSE;
+
+    end = qfb->pending->len - qfb->pending_pos > count ?
+          qfb->pending_pos + count : qfb->pending->len;
+
+    for (; qfb->pending_pos < end; qfb->pending_pos++)
+    {
+        GncGUID *guid = &g_array_index (qfb->pending, GncGUID,
+                                        qfb->pending_pos);
+        Transaction *trans = xaccTransLookup (guid, qfb->book);
+
+        /* It may have been deleted in the meantime. */
+        if (trans)
+            add_transaction (qfb, trans);
+    }
+
+    if (qfb->pending_pos < qfb->pending->len)
+        return TRUE;
+
+    /* The idle source, if any, goes when it next finds nothing to do. */
+    g_array_free (qfb->pending, TRUE);
+    qfb->pending = NULL;
+    qfb->pending_pos = 0;
+    return FALSE;
+}
+
+static gboolean
+pending_idle_cb (gpointer user_data)
+{
+    TransQF *qfb = user_data;
+
+    if (add_pending (qfb, TRANS_QF_CHUNK))
+        return TRUE;
+
+    /* Returning FALSE removes the source. */
+    qfb->idle_id = 0;
+    return FALSE;
+}
+
+static void
+collect_trans_cb (QofInstance *inst, gpointer user_data)
+{
+    g_ptr_array_add (user_data, inst);
+}
+
+static gint
+trans_order_cb (gconstpointer a, gconstpointer b)
+{
+    return xaccTransOrder (*(Transaction * const *)a,
+                           *(Transaction * const *)b);
+}
+
+/* Queue all the transactions of the book, oldest first, so that the
+ * latest use of a string is the last one added. */
+static void
+queue_all_transactions (TransQF *qfb)
+{
+    QofCollection *col = qof_book_get_collection (qfb->book, GNC_ID_TRANS);
+    GPtrArray *all = g_ptr_array_sized_new (qof_collection_count (col));
+    guint i;
+
+    cancel_pending (qfb);
+    qfb->dropped = qof_event_get_dropped_count ();
+
+    qof_collection_foreach (col, collect_trans_cb, all);
+    g_ptr_array_sort (all, trans_order_cb);
+
+    qfb->pending = g_array_sized_new (FALSE, FALSE, sizeof (GncGUID),
+                                      all->len);
+    for (i = 0; i < all->len; i++)
+        g_array_append_val (qfb->pending,
+                            *xaccTransGetGUID (g_ptr_array_index (all, i)));
+    g_ptr_array_free (all, TRUE);
+
+    DEBUG ("queued %u transactions", qfb->pending->len);
+    if (qfb->pending->len)
+        qfb->idle_id = g_idle_add (pending_idle_cb, qfb);
+}
+
+/* Add the strings of a committed transaction.  Whatever is still pending
+ * is older, so it goes in first. */
+static void
+commit_trans (TransQF *qfb, Transaction *trans)
+{
+    if (qof_instance_get_book (trans) != qfb->book ||
+        qof_instance_get_destroying (trans))
+        return;
+
+    add_pending (qfb, G_MAXUINT);
+    add_transaction (qfb, trans);
+}
+
+static void
+listen_for_trans_events (QofInstance *entity, QofEventId event_type,
+                         gpointer user_data, gpointer event_data)
+{
+    /* Transactions generate a MODIFY event when they are committed. */
+    if (!(event_type & QOF_EVENT_MODIFY) || !GNC_IS_TRANSACTION (entity))
+        return;
+
+    commit_trans (user_data, GNC_TRANSACTION (entity));
+}
+
+static void
+listen_for_trans_batch (GList *changes, gpointer user_data)
+{
+    GList *node;
+
+    for (node = changes; node; node = node->next)
+    {
+        QofEventBatchEntry *change = node->data;
+
+        if (change->entity && (change->events & QOF_EVENT_MODIFY) &&
+            GNC_IS_TRANSACTION (change->entity))
+            commit_trans (user_data, GNC_TRANSACTION (change->entity));
+    }
+}
+
+static void
+shared_quickfill_destroy (QofBook *book, gpointer key, gpointer user_data)
+{
+    TransQF *qfb = user_data;
+
+    cancel_pending (qfb);
+    gnc_quickfill_destroy (qfb->desc_qf);
+    gnc_quickfill_destroy (qfb->notes_qf);
+    gnc_quickfill_destroy (qfb->memo_qf);
+    qof_event_unregister_handler (qfb->listener);
+    g_free (qfb);
+}
+
+static TransQF *
+build_shared_quickfill (QofBook *book)
+{
+    TransQF *result = g_new0 (TransQF, 1);
+
+    result->desc_qf = gnc_quickfill_new ();
+    result->notes_qf = gnc_quickfill_new ();
+    result->memo_qf = gnc_quickfill_new ();
+    result->book = book;
+
+    queue_all_transactions (result);
+
+    result->listener =
+        qof_event_register_batch_handler (listen_for_trans_events,
+                                          listen_for_trans_batch, result);
+
+    qof_book_set_data_fin (book, TRANS_QF_KEY, result,
+                           shared_quickfill_destroy);
+
+    return result;
+}
+
+static TransQF *
+get_shared_quickfill (QofBook *book)
+{
+    TransQF *qfb;
+
+    g_assert (book);
+
+    qfb = qof_book_get_data (book, TRANS_QF_KEY);
+
+    if (!qfb)
+        qfb = build_shared_quickfill (book);
+    else if (qof_event_get_dropped_count () != qfb->dropped)
+    {
+        /* Some commits went by unseen; adding everything again puts
+         * their strings in, in the right order. */
+        PINFO ("events were dropped, refilling");
+        queue_all_transactions (qfb);
+    }
+
+    return qfb;
+}
+
+QuickFill *
+gnc_get_shared_trans_desc_quickfill (QofBook *book)
+{
+    return get_shared_quickfill (book)->desc_qf;
+}
+
+QuickFill *
+gnc_get_shared_trans_notes_quickfill (QofBook *book)
+{
+    return get_shared_quickfill (book)->notes_qf;
+}
+
+QuickFill *
+gnc_get_shared_trans_memo_quickfill (QofBook *book)
+{
+    return get_shared_quickfill (book)->memo_qf;
+}
+
+void
+gnc_flush_shared_transaction_quickfills (QofBook *book)
+{
+    TransQF *qfb;
+
+    if (!book)
+        return;
+
+    qfb = qof_book_get_data (book, TRANS_QF_KEY);
+    if (qfb)
+        add_pending (qfb, G_MAXUINT);
+}
@@ -0,0 +1,74 @@
+/********************************************************************\
+ * gnc-transaction-quickfill.h -- Create transaction text quick-fills *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ *                                                                  *
+\********************************************************************/
+/** @addtogroup QuickFill Auto-complete typed user input.
+   @{
+*/
+/** Similar to the @ref Account_QuickFill account name quickfill, we
+ * create cached quickfills of the descriptions, notes and split memos
+ * of all the transactions in a book, so that every register can share
+ * them instead of building its own.
+*/
+
+#ifndef GNC_TRANSACTION_QUICKFILL_H
+#define GNC_TRANSACTION_QUICKFILL_H
+
+#include "qof.h"
+#include "QuickFill.h"
+
+/** Create/fetch the quickfill of transaction descriptions.
+ *
+ *  The three quickfills of a book are created together, on the first
+ *  call of any of these functions, and are stored with the QofBook.
+ *  They are destroyed with it.  Their strings are added oldest
+ *  transaction first, so that with QUICKFILL_LIFO the latest use of a
+ *  string is the one offered.  Only some of them are added at once;
+ *  the rest follow from the main loop, or on
+ *  gnc_flush_shared_transaction_quickfills().
+ *
+ *  This code listens to transaction commit events and adds the new
+ *  strings of the committed transaction.  Strings are never removed,
+ *  as other transactions may still use them.
+ *
+ * \param book The book
+ *
+ * \return The shared QuickFill object.
+ */
+QuickFill * gnc_get_shared_trans_desc_quickfill (QofBook *book);
+
+/** Create/fetch the quickfill of transaction notes, as for
+ *  gnc_get_shared_trans_desc_quickfill(). */
+QuickFill * gnc_get_shared_trans_notes_quickfill (QofBook *book);
+
+/** Create/fetch the quickfill of split memos, as for
+ *  gnc_get_shared_trans_desc_quickfill(). */
+QuickFill * gnc_get_shared_trans_memo_quickfill (QofBook *book);
+
+/** Add whatever strings of the book's transactions are still waiting
+ *  to go into its shared quickfills, so that they are complete before
+ *  the user starts typing.  Does nothing if the quickfills haven't been
+ *  created. */
+void gnc_flush_shared_transaction_quickfills (QofBook *book);
+
+#endif
+
+/** @} */
+/** @} */
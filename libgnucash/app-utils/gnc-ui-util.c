@@ -1538,6 +1538,134 @@ gnc_integral_print_info (void)
     return info;
 }
 
+/* The first character of each of the locale's separators and its
+ * grouping, for monetary and other amounts.  gnc_localeconv() reads the
+ * locale only once, so these are set up the first time too. */
+typedef struct
+{
+    char decimal_point[8];
+    char thousands_sep[8];
+    const char *grouping;
+} PrintSeparators;
+
+static void
+set_first_char (char *dest, const char *src)
+{
+    gsize len = *src ? g_utf8_next_char (src) - src : 0;
+
+    if (len >= 8)
+        len = 0;
+    memcpy (dest, src, len);
+    dest[len] = '\0';
+}
+
+static const PrintSeparators *
+gnc_print_separators (gboolean monetary)
+{
+    static PrintSeparators separators[2];
+    static gboolean got_them = FALSE;
+
+    if (!got_them)
+    {
+        struct lconv *lc = gnc_localeconv ();
+
+        set_first_char (separators[0].decimal_point, lc->decimal_point);
+        set_first_char (separators[0].thousands_sep, lc->thousands_sep);
+        separators[0].grouping = lc->grouping;
+        set_first_char (separators[1].decimal_point, lc->mon_decimal_point);
+        set_first_char (separators[1].thousands_sep, lc->mon_thousands_sep);
+        separators[1].grouping = lc->mon_grouping;
+        got_them = TRUE;
+    }
+    return &separators[monetary ? 1 : 0];
+}
+
+/* The n for a denominator of 10^n, or -1 for any other. */
+static int
+decimal_denom_places (gint64 denom)
+{
+    int places;
+
+    for (places = 0; places <= maximum_decimals; places++)
+        if (pow_10[places] == denom)
+            return places;
+    return -1;
+}
+
+/* Print num / 10^places, num >= 0, straight from its digits.  This is
+ * what PrintAmountInternal would print for it when there's nothing to
+ * round off, without going through gnc_numeric arithmetic or
+ * allocating. */
+static int
+PrintDecimalAmount (char *buf, gint64 num, int places,
+                    const GNCPrintAmountInfo *info)
+{
+    const PrintSeparators *seps = gnc_print_separators (info->monetary);
+    gint64 whole = num / pow_10[places];
+    gint64 fraction = num % pow_10[places];
+    /* 19 digits and up to 18 separators of up to 7 bytes each. */
+    char temp_buf[160];
+    char *temp_ptr = temp_buf + sizeof (temp_buf);
+    const char *group = seps->grouping;
+    gsize sep_len = strlen (seps->thousands_sep);
+    int group_count = 0;
+    int num_decimal_places;
+    char *buf_ptr;
+
+    /* The whole part, from its last digit back. */
+    do
+    {
+        *--temp_ptr = '0' + whole % 10;
+        whole /= 10;
+
+        if (whole && info->use_separators && *group != CHAR_MAX &&
+            ++group_count == *group)
+        {
+            temp_ptr -= sep_len;
+            memcpy (temp_ptr, seps->thousands_sep, sep_len);
+            group_count = 0;
+            /* A null char repeats the last group size indefinitely. */
+            if (group[1] != '\0')
+                group++;
+        }
+    }
+    while (whole);
+
+    buf_ptr = buf;
+    memcpy (buf_ptr, temp_ptr, temp_buf + sizeof (temp_buf) - temp_ptr);
+    buf_ptr += temp_buf + sizeof (temp_buf) - temp_ptr;
+
+    /* Drop the fraction's trailing zeros down to the minimum places. */
+    num_decimal_places = places;
+    while (num_decimal_places > info->min_decimal_places && fraction % 10 == 0)
+    {
+        fraction /= 10;
+        num_decimal_places--;
+    }
+    if (num_decimal_places < info->min_decimal_places)
+        num_decimal_places = info->min_decimal_places;
+
+    if (num_decimal_places > 0)
+    {
+        int digits = MIN (num_decimal_places, places);
+        int i;
+
+        buf_ptr = g_stpcpy (buf_ptr, seps->decimal_point);
+        for (i = digits - 1; i >= 0; i--)
+        {
+            buf_ptr[i] = '0' + fraction % 10;
+            fraction /= 10;
+        }
+        buf_ptr += digits;
+        /* And pad it up to them. */
+        for (; digits < num_decimal_places; digits++)
+            *buf_ptr++ = '0';
+    }
+    *buf_ptr = '\0';
+
+    return buf_ptr - buf;
+}
+
 /* Utility function for printing non-negative amounts */
 static int
 PrintAmountInternal(char *buf, gnc_numeric val, const GNCPrintAmountInfo *info)
@@ -1559,6 +1687,18 @@ PrintAmountInternal(char *buf, gnc_numeric val, const GNCPrintAmountInfo *info)
         return 0;
     }
 
+    /* Amounts in a decimal commodity's own fraction, as nearly all are,
+     * can be printed digit by digit if they have no more places than
+     * force_fit allows. */
+    if (val.denom > 0 && val.num != G_MININT64)
+    {
+        int places = decimal_denom_places (val.denom);
+
+        if (places >= 0 &&
+            (!info->force_fit || places <= info->max_decimal_places))
+            return PrintDecimalAmount (buf, ABS (val.num), places, info);
+    }
+
     /* Print the absolute value, but remember sign */
     value_is_negative = gnc_numeric_negative_p (val);
     val = gnc_numeric_abs (val);
@@ -1768,6 +1908,79 @@ PrintAmountInternal(char *buf, gnc_numeric val, const GNCPrintAmountInfo *info)
     return strlen(buf);
 }
 
+/* Registers, account trees and reports print column after column of
+ * amounts in the same commodity, so keep the symbol of the last one
+ * instead of looking up its user symbol in the KVP for each of them.
+ * Amounts are printed on report threads too, so each thread keeps its
+ * own; any commodity event makes them all stale.  The mnemonic is
+ * checked as well in case the commodity was destroyed and another one
+ * allocated in its place while events were suspended. */
+typedef struct
+{
+    const gnc_commodity *commodity;
+    const char *mnemonic;
+    gchar *symbol;
+    gint generation;
+} SymbolCache;
+
+static void
+symbol_cache_free (gpointer data)
+{
+    SymbolCache *cache = data;
+
+    g_free (cache->symbol);
+    g_free (cache);
+}
+
+static GPrivate symbol_cache_key = G_PRIVATE_INIT (symbol_cache_free);
+static gint symbol_cache_generation = 0;
+
+static void
+symbol_cache_event_cb (QofInstance *entity, QofEventId event_type,
+                       gpointer user_data, gpointer event_data)
+{
+    if (GNC_IS_COMMODITY (entity))
+        g_atomic_int_inc (&symbol_cache_generation);
+}
+
+static void
+symbol_cache_init (void)
+{
+    static gsize registered = 0;
+
+    if (g_once_init_enter (&registered))
+    {
+        qof_event_register_handler (symbol_cache_event_cb, NULL);
+        g_once_init_leave (&registered, 1);
+    }
+}
+
+static const char *
+gnc_print_amount_symbol (const gnc_commodity *commodity)
+{
+    const char *mnemonic = gnc_commodity_get_mnemonic (commodity);
+    gint generation = g_atomic_int_get (&symbol_cache_generation);
+    SymbolCache *cache = g_private_get (&symbol_cache_key);
+
+    if (!cache)
+    {
+        symbol_cache_init ();
+        cache = g_new0 (SymbolCache, 1);
+        g_private_set (&symbol_cache_key, cache);
+    }
+    else if (commodity == cache->commodity &&
+             mnemonic == cache->mnemonic &&
+             generation == cache->generation)
+        return cache->symbol;
+
+    g_free (cache->symbol);
+    cache->commodity = commodity;
+    cache->mnemonic = mnemonic;
+    cache->generation = generation;
+    cache->symbol = g_strdup (gnc_commodity_get_nice_symbol (commodity));
+    return cache->symbol;
+}
+
 /**
  * @param bufp Should be at least 64 chars.
  **/
@@ -1810,7 +2023,7 @@ xaccSPrintAmount (char * bufp, gnc_numeric val, GNCPrintAmountInfo info)
 
     if (info.commodity && info.use_symbol)
     {
-        currency_symbol = gnc_commodity_get_nice_symbol (info.commodity);
+        currency_symbol = gnc_print_amount_symbol (info.commodity);
         if (!gnc_commodity_is_iso (info.commodity))
         {
             cs_precedes  = FALSE;
@@ -2643,6 +2856,7 @@ gnc_auto_decimal_init (void)
 void
 gnc_ui_util_init (void)
 {
+    symbol_cache_init ();
     gnc_configure_account_separator ();
     gnc_auto_decimal_init();
 
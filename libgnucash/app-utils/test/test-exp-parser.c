@@ -77,6 +77,39 @@ _add_fail_test (const char *test_name, const char *exp, int expected_error_offse
     tests = g_list_append (tests, node);
 }
 
+/* Evaluating the compiled expression must give what parsing it does. */
+static void
+run_compiled_test (TestNode *node)
+{
+    GncExpression *exp = gnc_exp_parser_compile (node->exp, NULL);
+    gnc_numeric result, *values;
+    guint n, i;
+
+    if (!exp)
+    {
+        failure_args (node->test_name, node->file, node->line,
+                      "compiling \"%s\" failed", node->exp);
+        return;
+    }
+
+    n = gnc_expression_get_num_variables (exp);
+    values = g_new (gnc_numeric, MAX (n, 1));
+    for (i = 0; i < n; i++)
+        values[i] = gnc_numeric_zero ();
+
+    if (!gnc_expression_evaluate (exp, values, &result))
+        failure_args (node->test_name, node->file, node->line,
+                      "evaluating compiled \"%s\" failed", node->exp);
+    else if (!gnc_numeric_equal (result, node->expected_result))
+        failure_args (node->test_name, node->file, node->line,
+                      "wrong compiled result");
+    else
+        success (node->test_name);
+
+    g_free (values);
+    gnc_expression_free (exp);
+}
+
 static void
 run_parser_test (TestNode *node)
 {
@@ -121,6 +154,7 @@ run_parser_test (TestNode *node)
             failure_args (node->test_name, node->file, node->line, "wrong result");
             return;
         }
+        run_compiled_test (node);
     }
     else if (node->expected_error_offset != -1)
     {
@@ -246,12 +280,85 @@ test_variable_expressions()
     success("variable found");
 }
 
+static void
+test_compiled_expressions (void)
+{
+    GncExpression *exp;
+    gnc_numeric values[2], num;
+    char *errLoc = NULL;
+
+    exp = gnc_exp_parser_compile ("b = a * 3 - b", &errLoc);
+    do_test (exp != NULL && errLoc == NULL, "compiling");
+    if (!exp)
+        return;
+    do_test (gnc_expression_get_num_variables (exp) == 2, "two variables");
+    do_test (gnc_expression_get_variable_slot (exp, "b") == 0 &&
+             gnc_expression_get_variable_slot (exp, "a") == 1 &&
+             gnc_expression_get_variable_slot (exp, "c") == -1,
+             "slots in the order of appearance");
+
+    values[0] = gnc_numeric_create (1, 1);
+    values[1] = gnc_numeric_create (2, 1);
+    do_test (gnc_expression_evaluate (exp, values, &num) &&
+             gnc_numeric_equal (num, gnc_numeric_create (5, 1)) &&
+             gnc_numeric_equal (values[0], num), "first evaluation");
+
+    values[1] = gnc_numeric_create (7, 1);
+    do_test (gnc_expression_evaluate (exp, values, &num) &&
+             gnc_numeric_equal (num, gnc_numeric_create (16, 1)),
+             "evaluating again with other values");
+
+    values[1] = gnc_numeric_error (GNC_ERROR_ARG);
+    do_test (!gnc_expression_evaluate (exp, values, &num),
+             "an unset variable is an error");
+    gnc_expression_free (exp);
+
+    errLoc = NULL;
+    do_test (gnc_exp_parser_compile ("1 + ", &errLoc) == NULL &&
+             errLoc != NULL, "a syntax error doesn't compile");
+    success ("compiled expressions");
+}
+
+static gpointer
+refusing_thread (gpointer data)
+{
+    gnc_numeric num;
+
+    gnc_exp_parser_refuse_functions (TRUE);
+    do_test (gnc_exp_parser_parse ("1 + 2", &num, NULL) &&
+             gnc_numeric_equal (num, gnc_numeric_create (3, 1)),
+             "arithmetic on a thread refusing functions");
+    do_test (!gnc_exp_parser_function_refused (), "nothing was refused");
+    do_test (!gnc_exp_parser_parse ("plus(1 : 2)", &num, NULL),
+             "a function call on a thread refusing them");
+    do_test (gnc_exp_parser_function_refused (), "the call was refused");
+    return NULL;
+}
+
+static void
+test_refused_functions (void)
+{
+    gnc_numeric num;
+
+    gnc_exp_parser_init_once ();
+    scm_c_eval_string ("(define (gnc:plus a b) (+ a b))");
+    g_thread_join (g_thread_new ("refusing", refusing_thread, NULL));
+
+    do_test (gnc_exp_parser_parse ("plus(1 : 2)", &num, NULL) &&
+             gnc_numeric_equal (num, gnc_numeric_create (3, 1)),
+             "the same call on this thread");
+    do_test (!gnc_exp_parser_function_refused (), "which doesn't refuse it");
+    gnc_exp_parser_shutdown ();
+}
+
 static void
 real_main (void *closure, int argc, char **argv)
 {
     /* set_should_print_success (TRUE); */
     test_parser();
     test_variable_expressions();
+    test_compiled_expressions();
+    test_refused_functions();
     print_test_results();
     exit(get_rv());
 }
@@ -254,9 +254,36 @@ test_book_use_book_currency( Fixture *fixture, gconstpointer pData )
     qof_book_commit_edit (fixture->book); */
 }
 
+static void
+test_print_amount_symbol (Fixture *fixture, gconstpointer pData)
+{
+    gnc_commodity *foo = gnc_commodity_new (fixture->book, "Foo Inc.",
+                                            "NASDAQ", "FOO", "", 100);
+    gnc_commodity *bar = gnc_commodity_new (fixture->book, "Bar Inc.",
+                                            "NASDAQ", "BAR", "", 100);
+    GNCPrintAmountInfo info = gnc_commodity_print_info (foo, TRUE);
+    gnc_numeric one = gnc_numeric_create (100, 100);
+
+    g_assert (g_str_has_suffix (xaccPrintAmount (one, info), " FOO"));
+    /* The same symbol comes back for the next amount... */
+    g_assert (g_str_has_suffix (xaccPrintAmount (one, info), " FOO"));
+    /* ...until the commodity's symbol is changed. */
+    gnc_commodity_set_user_symbol (foo, "F$");
+    g_assert (g_str_has_suffix (xaccPrintAmount (one, info), " F$"));
+
+    info = gnc_commodity_print_info (bar, TRUE);
+    g_assert (g_str_has_suffix (xaccPrintAmount (one, info), " BAR"));
+    info = gnc_commodity_print_info (foo, TRUE);
+    g_assert (g_str_has_suffix (xaccPrintAmount (one, info), " F$"));
+
+    gnc_commodity_destroy (bar);
+    gnc_commodity_destroy (foo);
+}
+
 void
 test_suite_gnc_ui_util (void)
 {
     GNC_TEST_ADD( suitename, "use book-currency", Fixture, NULL, setup, test_book_use_book_currency, teardown );
+    GNC_TEST_ADD( suitename, "print amount symbol", Fixture, NULL, setup, test_print_amount_symbol, teardown );
 
 }
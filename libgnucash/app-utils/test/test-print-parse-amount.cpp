@@ -30,8 +30,11 @@ extern "C"
 #include "test-engine-stuff.h"
 #include "test-stuff.h"
 #include <unittest-support.h>
+#include "gnc-locale-utils.h"
 }
 
+#include <string>
+
 static void
 test_num_print_info (gnc_numeric n, GNCPrintAmountInfo print_info, int line)
 {
@@ -108,6 +111,53 @@ test_num (gnc_numeric n)
     }
 }
 
+static void
+test_decimal_amount (gint64 num, gint64 denom, int min_dp, int max_dp,
+                     gboolean force_fit, const char *expected, int line)
+{
+    GNCPrintAmountInfo print_info;
+    auto dp = gnc_localeconv ()->decimal_point;
+    std::string want {expected};
+    auto pos = want.find ('.');
+
+    if (pos != std::string::npos)
+        want.replace (pos, 1, dp, g_utf8_next_char (dp) - dp);
+
+    print_info.commodity = NULL;
+    print_info.min_decimal_places = min_dp;
+    print_info.max_decimal_places = max_dp;
+    print_info.use_separators = 0;
+    print_info.use_symbol = 0;
+    print_info.use_locale = 1;
+    print_info.monetary = 0;
+    print_info.force_fit = force_fit;
+    print_info.round = force_fit;
+
+    auto s = xaccPrintAmount (gnc_numeric_create (num, denom), print_info);
+    do_test_args (want == s, "decimal amount", __FILE__, __LINE__,
+                  "num: %" G_GINT64_FORMAT "/%" G_GINT64_FORMAT
+                  ", expected %s, got %s (line %d)",
+                  num, denom, want.c_str (), s, line);
+}
+
+static void
+run_decimal_tests (void)
+{
+    test_decimal_amount (123456789, 100, 2, 2, FALSE, "1234567.89", __LINE__);
+    test_decimal_amount (500, 100, 2, 2, FALSE, "5.00", __LINE__);
+    test_decimal_amount (500, 100, 0, 2, FALSE, "5", __LINE__);
+    test_decimal_amount (510, 100, 0, 2, FALSE, "5.1", __LINE__);
+    test_decimal_amount (5, 1000, 0, 2, FALSE, "0.005", __LINE__);
+    test_decimal_amount (7, 1, 2, 2, FALSE, "7.00", __LINE__);
+    test_decimal_amount (12, 10, 3, 3, FALSE, "1.200", __LINE__);
+    test_decimal_amount (0, 100, 0, 2, FALSE, "0", __LINE__);
+    test_decimal_amount (0, 100, 2, 2, FALSE, "0.00", __LINE__);
+    /* More places than force_fit allows are rounded off as before. */
+    test_decimal_amount (12345, 1000, 2, 2, TRUE, "12.35", __LINE__);
+    test_decimal_amount (12345, 1000, 2, 3, TRUE, "12.345", __LINE__);
+    test_decimal_amount (1, 3, 0, 2, FALSE, "1/3", __LINE__);
+}
+
 #define IS_VALID_NUM(n,m)                                               \
     if (gnc_numeric_check(n)) {                                         \
         do_test_args(gnc_numeric_check(n) == GNC_ERROR_OVERFLOW,        \
@@ -162,6 +212,7 @@ run_tests (void)
 int
 main (int argc, char **argv)
 {
+    run_decimal_tests ();
     run_tests ();
     print_test_results ();
     exit (get_rv ());
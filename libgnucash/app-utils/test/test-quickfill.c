@@ -0,0 +1,269 @@
+/********************************************************************
+ * test-quickfill.c: GLib g_test test suite for QuickFill.c.         *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, you can retrieve it from        *
+ * https://www.gnu.org/licenses/old-licenses/gpl-2.0.html            *
+ * or contact:                                                      *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ ********************************************************************/
+
+#include <config.h>
+#include <glib.h>
+#include <unittest-support.h>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+#include "../QuickFill.h"
+
+static const gchar *suitename = "/app-utils/quickfill";
+void test_suite_quickfill (void);
+
+static const char *
+match_string (QuickFill *qf, const char *prefix)
+{
+    return gnc_quickfill_string (gnc_quickfill_get_string_match (qf, prefix));
+}
+
+static void
+test_lifo (void)
+{
+    QuickFill *qf = gnc_quickfill_new ();
+
+    gnc_quickfill_insert (qf, "Grocery Store", QUICKFILL_LIFO);
+    gnc_quickfill_insert (qf, "Gas Station", QUICKFILL_LIFO);
+
+    g_assert_cmpstr (match_string (qf, "G"), ==, "Gas Station");
+    g_assert_cmpstr (match_string (qf, "gr"), ==, "Grocery Store");
+    g_assert_cmpstr (match_string (qf, "GAS STATION"), ==, "Gas Station");
+    g_assert_null (gnc_quickfill_get_string_match (qf, "Gx"));
+    g_assert_null (gnc_quickfill_get_string_match (qf, "Gas Stations"));
+
+    /* A longer string doesn't displace its own prefix. */
+    gnc_quickfill_insert (qf, "Gas Station North", QUICKFILL_LIFO);
+    g_assert_cmpstr (match_string (qf, "Gas"), ==, "Gas Station");
+    g_assert_cmpstr (match_string (qf, "Gas Station N"), ==,
+                     "Gas Station North");
+
+    gnc_quickfill_insert (qf, "Grocer", QUICKFILL_LIFO);
+    g_assert_cmpstr (match_string (qf, "Gro"), ==, "Grocer");
+    g_assert_cmpstr (match_string (qf, "Grocery"), ==, "Grocery Store");
+
+    gnc_quickfill_destroy (qf);
+}
+
+static void
+test_alpha (void)
+{
+    QuickFill *qf = gnc_quickfill_new ();
+
+    gnc_quickfill_insert (qf, "Rent", QUICKFILL_ALPHA);
+    gnc_quickfill_insert (qf, "Refund", QUICKFILL_ALPHA);
+    gnc_quickfill_insert (qf, "Restaurant", QUICKFILL_ALPHA);
+
+    g_assert_cmpstr (match_string (qf, "Re"), ==, "Refund");
+    g_assert_cmpstr (match_string (qf, "Ren"), ==, "Rent");
+    g_assert_cmpstr (match_string (qf, "Res"), ==, "Restaurant");
+
+    gnc_quickfill_destroy (qf);
+}
+
+static void
+test_unique_len (void)
+{
+    QuickFill *qf = gnc_quickfill_new ();
+    QuickFill *match;
+    int len;
+
+    gnc_quickfill_insert (qf, "The Book", QUICKFILL_LIFO);
+    gnc_quickfill_insert (qf, "The Movie", QUICKFILL_LIFO);
+
+    match = gnc_quickfill_get_unique_len_match (qf, &len);
+    g_assert_cmpint (len, ==, 4);
+    g_assert_cmpstr (gnc_quickfill_string (
+                         gnc_quickfill_get_char_match (match, 'b')), ==,
+                     "The Book");
+
+    match = gnc_quickfill_get_string_match (qf, "The B");
+    match = gnc_quickfill_get_unique_len_match (match, &len);
+    g_assert_cmpint (len, ==, 3);
+    g_assert_cmpstr (gnc_quickfill_string (match), ==, "The Book");
+    g_assert_null (gnc_quickfill_get_char_match (match, 'x'));
+
+    gnc_quickfill_destroy (qf);
+}
+
+static void
+test_utf8 (void)
+{
+    QuickFill *qf = gnc_quickfill_new ();
+
+    gnc_quickfill_insert (qf, "Café", QUICKFILL_LIFO);
+    gnc_quickfill_insert (qf, "Ärzte", QUICKFILL_LIFO);
+
+    g_assert_cmpstr (match_string (qf, "CAFÉ"), ==, "Café");
+    g_assert_cmpstr (match_string (qf, "ä"), ==, "Ärzte");
+    g_assert_null (gnc_quickfill_get_string_match (qf, "Cafe"));
+
+    gnc_quickfill_destroy (qf);
+}
+
+static void
+test_remove (void)
+{
+    QuickFill *qf = gnc_quickfill_new ();
+
+    gnc_quickfill_insert (qf, "Salary", QUICKFILL_LIFO);
+    gnc_quickfill_insert (qf, "Savings", QUICKFILL_LIFO);
+    gnc_quickfill_insert (qf, "Salad Bar", QUICKFILL_LIFO);
+
+    gnc_quickfill_remove (qf, "Salad Bar", QUICKFILL_LIFO);
+    g_assert_cmpstr (match_string (qf, "Sal"), ==, "Salary");
+    g_assert_null (gnc_quickfill_get_string_match (qf, "Salad"));
+
+    gnc_quickfill_remove (qf, "Savings", QUICKFILL_LIFO);
+    g_assert_cmpstr (match_string (qf, "S"), ==, "Salary");
+    g_assert_null (gnc_quickfill_get_string_match (qf, "Sav"));
+
+    /* Removing what isn't there changes nothing. */
+    gnc_quickfill_remove (qf, "Sal", QUICKFILL_LIFO);
+    g_assert_cmpstr (match_string (qf, "Sal"), ==, "Salary");
+
+    gnc_quickfill_remove (qf, "Salary", QUICKFILL_LIFO);
+    g_assert_null (gnc_quickfill_get_string_match (qf, "S"));
+
+    gnc_quickfill_insert (qf, "Salary", QUICKFILL_LIFO);
+    g_assert_cmpstr (match_string (qf, "S"), ==, "Salary");
+
+    gnc_quickfill_purge (qf);
+    g_assert_null (gnc_quickfill_get_string_match (qf, "S"));
+
+    gnc_quickfill_destroy (qf);
+}
+
+/* The benchmarks only run in perf mode, i.e. with -m perf. */
+
+#define BENCH_STRINGS 200000
+
+static gchar **
+bench_descriptions (void)
+{
+    static const char *words[] =
+    {
+        "Grocery", "Store", "Rent", "Payment", "Salary", "Transfer",
+        "Coffee", "Shop", "Gas", "Station", "Online", "Order",
+        "Restaurant", "Insurance", "Phone", "Bill"
+    };
+    GRand *rand = g_rand_new_with_seed (42);
+    gchar **strings = g_new (gchar*, BENCH_STRINGS + 1);
+    int i;
+
+    for (i = 0; i < BENCH_STRINGS; i++)
+        strings[i] = g_strdup_printf ("%s %s %s #%d",
+                                      words[g_rand_int_range (rand, 0, 16)],
+                                      words[g_rand_int_range (rand, 0, 16)],
+                                      words[g_rand_int_range (rand, 0, 16)],
+                                      g_rand_int_range (rand, 0, 5000));
+    strings[BENCH_STRINGS] = NULL;
+    g_rand_free (rand);
+    return strings;
+}
+
+static gsize
+allocated_bytes (void)
+{
+#if defined (__GLIBC__) && __GLIBC_PREREQ (2, 33)
+    return mallinfo2 ().uordblks;
+#elif defined (__GLIBC__)
+    return mallinfo ().uordblks;
+#else
+    return 0;
+#endif
+}
+
+static void
+test_bench_insert (void)
+{
+    gchar **strings = bench_descriptions ();
+    QuickFill *qf;
+    gsize before;
+    double elapsed;
+    int i;
+
+    before = allocated_bytes ();
+    g_test_timer_start ();
+    qf = gnc_quickfill_new ();
+    for (i = 0; strings[i]; i++)
+        gnc_quickfill_insert (qf, strings[i], QUICKFILL_LIFO);
+    elapsed = g_test_timer_elapsed ();
+    g_test_minimized_result (elapsed, "Inserted %d descriptions in %g s",
+                             BENCH_STRINGS, elapsed);
+#ifdef __GLIBC__
+    g_test_minimized_result ((allocated_bytes () - before) / 1e6,
+                             "The QuickFill took %g MB",
+                             (allocated_bytes () - before) / 1e6);
+#endif
+
+    gnc_quickfill_destroy (qf);
+    g_strfreev (strings);
+}
+
+static void
+test_bench_match (void)
+{
+    gchar **strings = bench_descriptions ();
+    QuickFill *qf = gnc_quickfill_new ();
+    double elapsed;
+    int i;
+
+    for (i = 0; strings[i]; i++)
+        gnc_quickfill_insert (qf, strings[i], QUICKFILL_LIFO);
+
+    /* Type out each string as a user would, a letter at a time. */
+    g_test_timer_start ();
+    for (i = 0; i < BENCH_STRINGS; i += 100)
+    {
+        glong len = g_utf8_strlen (strings[i], -1), n;
+
+        for (n = 1; n <= len; n++)
+            g_assert_nonnull (gnc_quickfill_get_string_len_match (qf,
+                                                                  strings[i],
+                                                                  n));
+    }
+    elapsed = g_test_timer_elapsed ();
+    g_test_minimized_result (elapsed, "Matched %d typed descriptions in %g s",
+                             BENCH_STRINGS / 100, elapsed);
+
+    gnc_quickfill_destroy (qf);
+    g_strfreev (strings);
+}
+
+void
+test_suite_quickfill (void)
+{
+    GNC_TEST_ADD_FUNC (suitename, "lifo", test_lifo);
+    GNC_TEST_ADD_FUNC (suitename, "alpha", test_alpha);
+    GNC_TEST_ADD_FUNC (suitename, "unique len", test_unique_len);
+    GNC_TEST_ADD_FUNC (suitename, "utf8", test_utf8);
+    GNC_TEST_ADD_FUNC (suitename, "remove", test_remove);
+
+    if (g_test_perf ())
+    {
+        GNC_TEST_ADD_FUNC (suitename, "bench insert", test_bench_insert);
+        GNC_TEST_ADD_FUNC (suitename, "bench match", test_bench_match);
+    }
+}
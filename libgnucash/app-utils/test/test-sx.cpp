@@ -23,7 +23,9 @@ extern "C"
 #include <config.h>
 #include <stdlib.h>
 #include <glib.h>
+#include "Account.h"
 #include "SX-book.h"
+#include "Transaction.h"
 #include "gnc-date.h"
 #include "gnc-sx-instance-model.h"
 #include "gnc-ui-util.h"
@@ -213,6 +215,124 @@ test_state_changes()
     remove_sx(foo);
 }
 
+/* Once an instance has been created, updating the model drops it and
+ * keeps the rest as they were. */
+static void
+test_update_trims_instances()
+{
+    SchedXaction *foo;
+    GDate *start, *end;
+    GncSxInstanceModel *model;
+    GncSxInstances *insts;
+    GncSxInstance *second, *last;
+
+    start = g_date_new();
+    gnc_gdate_set_today (start);
+
+    end = g_date_new();
+    gnc_gdate_set_today (end);
+    g_date_add_days(end, 3);
+
+    foo = add_daily_sx("foo", start, NULL, NULL);
+    model = gnc_sx_get_instances(end, TRUE);
+    insts = (GncSxInstances*)g_list_nth_data(model->sx_instance_list, 0);
+    do_test(g_list_length(insts->instance_list) == 4, "4 instances");
+
+    second = _nth_instance(insts, 1);
+    last = _nth_instance(insts, 3);
+    gnc_sx_instance_model_change_instance_state(model, second, SX_INSTANCE_STATE_IGNORED);
+
+    xaccSchedXactionSetLastOccurDate(foo, start);
+    gnc_sx_instance_model_update_sx_instances(model, foo);
+
+    do_test(g_list_length(insts->instance_list) == 3, "the created one is gone");
+    do_test(_nth_instance(insts, 0) == second, "the rest are kept");
+    do_test(_nth_instance(insts, 2) == last, "up to the last one");
+    do_test(second->state == SX_INSTANCE_STATE_IGNORED, "with their state");
+
+    g_object_unref(model);
+    g_date_free(start);
+    g_date_free(end);
+    remove_sx(foo);
+}
+
+static gboolean
+cashflow_is(GList *sxes, const GDate *start, const GDate *end,
+            Account *acct, gint64 amount)
+{
+    GHashTable *map = gnc_g_hash_new_guid_numeric();
+    gnc_numeric *flow;
+    gboolean result;
+
+    gnc_sx_all_instantiate_cashflow(sxes, start, end, map, NULL);
+    flow = (gnc_numeric*)g_hash_table_lookup(map, xaccAccountGetGUID(acct));
+    result = flow && gnc_numeric_equal(*flow, gnc_numeric_create(amount, 1));
+    g_hash_table_destroy(map);
+    return result;
+}
+
+/* The cash flows are remembered per date range until the template
+ * transaction changes. */
+static void
+test_cashflow_cache()
+{
+    QofBook *book = gnc_get_current_book();
+    gnc_commodity *usd =
+        gnc_commodity_table_lookup(gnc_commodity_table_get_table(book),
+                                   GNC_COMMODITY_NS_CURRENCY, "USD");
+    Account *acct = xaccMallocAccount(book);
+    Account *root = gnc_book_get_root_account(book);
+    GDate start, end, later;
+    SchedXaction *sx;
+    Transaction *txn;
+    Split *split;
+    GList *sxes;
+    gnc_numeric debit = gnc_numeric_create(10, 1);
+
+    xaccAccountBeginEdit(acct);
+    xaccAccountSetCommodity(acct, usd);
+    gnc_account_append_child(root, acct);
+    xaccAccountCommitEdit(acct);
+
+    g_date_clear(&start, 1);
+    gnc_gdate_set_today(&start);
+    end = start;
+    g_date_add_days(&end, 2);
+    later = end;
+    g_date_add_days(&later, 2);
+
+    sx = add_daily_sx("cashflow", &start, NULL, NULL);
+    sxes = g_list_prepend(NULL, sx);
+
+    txn = xaccMallocTransaction(book);
+    xaccTransBeginEdit(txn);
+    xaccTransSetCurrency(txn, usd);
+    split = xaccMallocSplit(book);
+    xaccSplitSetParent(split, txn);
+    xaccSplitSetAccount(split, gnc_sx_get_template_transaction_account(sx));
+    qof_instance_set(QOF_INSTANCE(split),
+                     "sx-account", xaccAccountGetGUID(acct),
+                     "sx-debit-numeric", &debit,
+                     NULL);
+    xaccTransCommitEdit(txn);
+
+    do_test(cashflow_is(sxes, &start, &end, acct, 30), "three days of debits");
+    do_test(cashflow_is(sxes, &start, &end, acct, 30), "the same again");
+    do_test(cashflow_is(sxes, &start, &later, acct, 50), "over another range");
+
+    debit = gnc_numeric_create(20, 1);
+    xaccTransBeginEdit(txn);
+    qof_instance_set(QOF_INSTANCE(split), "sx-debit-numeric", &debit, NULL);
+    xaccTransCommitEdit(txn);
+    do_test(cashflow_is(sxes, &start, &end, acct, 60), "the changed template");
+
+    xaccTransBeginEdit(txn);
+    xaccTransDestroy(txn);
+    xaccTransCommitEdit(txn);
+    g_list_free(sxes);
+    remove_sx(sx);
+}
+
 int
 main(int argc, char **argv)
 {
@@ -228,6 +348,8 @@ main(int argc, char **argv)
     }
     test_basic();
     test_state_changes();
+    test_update_trims_instances();
+    test_cashflow_cache();
 
     print_test_results();
     exit(get_rv());
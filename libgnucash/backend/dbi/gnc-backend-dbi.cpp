@@ -374,6 +374,49 @@ error_handler<DbType::DBI_SQLITE> (dbi_conn conn, void* user_data)
         dbi_be->set_dbi_error (ERR_BACKEND_MISC, 0, false);
 }
 
+/* The tuned profile keeps a write-ahead log, which is synced only at
+ * checkpoints: a crash can lose the last few commits but not corrupt the
+ * file.  The paranoid one is SQLite's default rollback journal synced on
+ * every commit, and no memory-mapped I/O. */
+static const char* sqlite_tuned_pragmas[] =
+{
+    "PRAGMA journal_mode=WAL",
+    "PRAGMA synchronous=NORMAL",
+    "PRAGMA cache_size=-65536",     /* 64 MiB */
+    "PRAGMA mmap_size=268435456",   /* 256 MiB */
+    "PRAGMA temp_store=MEMORY",
+    nullptr
+};
+
+static const char* sqlite_paranoid_pragmas[] =
+{
+    "PRAGMA journal_mode=DELETE",
+    "PRAGMA synchronous=FULL",
+    "PRAGMA mmap_size=0",
+    nullptr
+};
+
+static void
+set_sqlite_pragmas (dbi_conn conn)
+{
+    auto pragmas = gnc_prefs_get_sqlite_paranoid () ?
+        sqlite_paranoid_pragmas : sqlite_tuned_pragmas;
+    for (auto pragma = pragmas; *pragma; ++pragma)
+    {
+        auto result = dbi_conn_query (conn, *pragma);
+        if (result)
+        {
+            dbi_result_free (result);
+        }
+        else
+        {
+            const char* errmsg;
+            int err = dbi_conn_error (conn, &errmsg);
+            PWARN ("Unable to set %s %d : %s", *pragma, err, errmsg);
+        }
+    }
+}
+
 template <> void
 GncDbiBackend<DbType::DBI_SQLITE>::session_begin(QofSession* session,
                                                  const char* new_uri,
@@ -463,6 +506,10 @@ GncDbiBackend<DbType::DBI_SQLITE>::session_begin(QofSession* session,
         return;
     }
 
+    /* Before the connection takes its lock: SQLite won't change the
+     * journal mode inside a transaction. */
+    set_sqlite_pragmas (conn);
+
     try
     {
         connect(new GncDbiSqlConnection(DbType::DBI_SQLITE,
@@ -965,6 +1012,7 @@ GncDbiBackend<Type>::safe_sync (QofBook* book)
     g_return_if_fail (book != nullptr);
 
     ENTER ("book=%p, primary=%p", book, m_book);
+    wait_for_commits ();
     if (!conn->begin_transaction())
     {
         LEAVE("Failed to obtain a transaction.");
@@ -1008,6 +1056,7 @@ GncDbiBackend<DbType::DBI_MYSQL>::safe_sync (QofBook* book)
     g_return_if_fail (book != nullptr);
 
     ENTER ("book=%p, primary=%p", book, m_book);
+    wait_for_commits ();
     if (!conn->table_operation (TableOpType::backup))
     {
         set_error(ERR_BACKEND_SERVER_ERR);
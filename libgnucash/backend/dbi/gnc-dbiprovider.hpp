@@ -47,6 +47,13 @@ public:
                                 const GncSqlColumnInfo& info) = 0;
     virtual StrVec get_index_list (dbi_conn conn) = 0;
     virtual void drop_index(dbi_conn conn, const std::string& index) = 0;
+    /** Make the INSERT statement sql update the row with the same value of
+     * the primary key column instead, if there is one. */
+    virtual void make_upsert(std::string& sql, const std::string& key,
+                             const StrVec& columns) = 0;
+    /** Whether append_col_def() gives BCT_GUID columns a type of their own
+     * rather than text. */
+    virtual bool has_native_guids() const noexcept = 0;
 };
 
 using GncDbiProviderPtr = std::unique_ptr<GncDbiProvider>;
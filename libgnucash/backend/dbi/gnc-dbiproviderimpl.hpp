@@ -27,6 +27,7 @@ extern "C"
 {
 #include <config.h>
 }
+#include <cstring>
 #include <string>
 #include <algorithm>
 #include <vector>
@@ -46,6 +47,9 @@ public:
     void append_col_def(std::string& ddl, const GncSqlColumnInfo& info);
     StrVec get_index_list (dbi_conn conn);
     void drop_index(dbi_conn conn, const std::string& index);
+    void make_upsert(std::string& sql, const std::string& key,
+                     const StrVec& columns);
+    bool has_native_guids() const noexcept;
 };
 
 template <DbType T> GncDbiProviderPtr
@@ -73,7 +77,7 @@ GncDbiProviderImpl<DbType::DBI_SQLITE>::append_col_def(std::string& ddl,
         type_name = "float8";
     }
     else if (info.m_type == BCT_STRING || info.m_type == BCT_DATE
-              || info.m_type == BCT_DATETIME)
+              || info.m_type == BCT_DATETIME || info.m_type == BCT_GUID)
     {
         type_name = "text";
     }
@@ -120,7 +124,7 @@ GncDbiProviderImpl<DbType::DBI_MYSQL>::append_col_def (std::string& ddl,
     {
         type_name = "double";
     }
-    else if (info.m_type == BCT_STRING)
+    else if (info.m_type == BCT_STRING || info.m_type == BCT_GUID)
     {
         type_name = "varchar";
     }
@@ -138,7 +142,8 @@ GncDbiProviderImpl<DbType::DBI_MYSQL>::append_col_def (std::string& ddl,
         type_name = "";
     }
     ddl += info.m_name + " " + type_name;
-    if (info.m_size != 0 && info.m_type == BCT_STRING)
+    if (info.m_size != 0 &&
+        (info.m_type == BCT_STRING || info.m_type == BCT_GUID))
     {
         ddl += "(" + std::to_string(info.m_size) + ")";
     }
@@ -191,6 +196,10 @@ GncDbiProviderImpl<DbType::DBI_PGSQL>::append_col_def (std::string& ddl,
     {
         type_name = "varchar";
     }
+    else if (info.m_type == BCT_GUID)
+    {
+        type_name = "uuid";
+    }
     else if (info.m_type == BCT_DATE)
     {
         type_name = "date";
@@ -387,4 +396,72 @@ GncDbiProviderImpl<DbType::DBI_MYSQL>::drop_index (dbi_conn conn, const std::str
     if (result)
         dbi_result_free (result);
 }
+
+/* INSERT ... ON CONFLICT needs SQLite 3.24, but replacing the whole row
+ * does the same here: every column is given and nothing refers to the rows
+ * with foreign keys. */
+template<> void
+GncDbiProviderImpl<DbType::DBI_SQLITE>::make_upsert(std::string& sql,
+                                                     const std::string& key,
+                                                     const StrVec& columns)
+{
+    sql.insert (strlen ("INSERT"), " OR REPLACE");
+}
+
+template<> void
+GncDbiProviderImpl<DbType::DBI_MYSQL>::make_upsert(std::string& sql,
+                                                    const std::string& key,
+                                                    const StrVec& columns)
+{
+    sql += " ON DUPLICATE KEY UPDATE ";
+    if (columns.empty())
+        sql += key + "=" + key;
+    for (const auto& col : columns)
+    {
+        if (&col != &columns.front())
+            sql += ",";
+        sql += col + "=VALUES(" + col + ")";
+    }
+}
+
+template<> void
+GncDbiProviderImpl<DbType::DBI_PGSQL>::make_upsert(std::string& sql,
+                                                    const std::string& key,
+                                                    const StrVec& columns)
+{
+    sql += " ON CONFLICT (" + key + ")";
+    if (columns.empty())
+    {
+        sql += " DO NOTHING";
+        return;
+    }
+    sql += " DO UPDATE SET ";
+    for (const auto& col : columns)
+    {
+        if (&col != &columns.front())
+            sql += ",";
+        sql += col + "=EXCLUDED." + col;
+    }
+}
+
+/* MySQL's BINARY(16) and SQLite's BLOB would need GUID literals in a
+ * different form from the text ones queries are built with, while
+ * PostgreSQL reads the text into a uuid column as it is. */
+template<> bool
+GncDbiProviderImpl<DbType::DBI_SQLITE>::has_native_guids() const noexcept
+{
+    return false;
+}
+
+template<> bool
+GncDbiProviderImpl<DbType::DBI_MYSQL>::has_native_guids() const noexcept
+{
+    return false;
+}
+
+template<> bool
+GncDbiProviderImpl<DbType::DBI_PGSQL>::has_native_guids() const noexcept
+{
+    return true;
+}
 #endif //__GNC_DBISQLPROVIDERIMPL_HPP__
@@ -29,9 +29,14 @@ extern "C"
 #include <gnc-locale-utils.h>
 }
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
 #include <string>
 #include <regex>
 #include <sstream>
+#include <thread>
 
 #include "gnc-dbisqlconnection.hpp"
 
@@ -40,6 +45,8 @@ static QofLogModule log_module = G_LOG_DOMAIN;
 #include "gnc-dbiproviderimpl.hpp"
 
 static const unsigned int DBI_MAX_CONN_ATTEMPTS = 5;
+/* How many extra connections prefetch() opens at most. */
+static const size_t DBI_MAX_PREFETCH_CONNS = 4;
 const std::string lock_table = "gnclock";
 
 /* --------------------------------------------------------- */
@@ -69,14 +76,13 @@ GncDbiSqlStatement::add_where_cond(QofIdTypeConst type_name,
                                    const PairVec& col_values)
 {
     m_sql += " WHERE ";
-    for (auto colpair : col_values)
+    for (auto const& colpair : col_values)
     {
-        if (colpair != *col_values.begin())
+        if (&colpair != &col_values.front())
             m_sql += " AND ";
-        if (colpair.second == "NULL")
-            m_sql += colpair.first + " IS " + colpair.second;
-        else
-            m_sql += colpair.first + " = " + colpair.second;
+        m_sql += colpair.first;
+        m_sql += colpair.second == "NULL" ? " IS " : " = ";
+        m_sql += colpair.second;
     }
 }
 
@@ -249,6 +255,8 @@ GncDbiSqlConnection::check_and_rollback_failed_save()
 
 GncDbiSqlConnection::~GncDbiSqlConnection()
 {
+    end_prefetch();
+    m_stats.dump();
     if (m_conn)
     {
         unlock_database();
@@ -257,20 +265,124 @@ GncDbiSqlConnection::~GncDbiSqlConnection()
     }
 }
 
+/* Open another connection to the same database with the same options.  It
+ * gets no error handler: its callers only care whether a query worked. */
+static dbi_conn
+clone_connection (dbi_conn conn)
+{
+    auto clone = dbi_conn_open (dbi_conn_get_driver (conn));
+    if (clone == nullptr)
+        return nullptr;
+    for (auto option = dbi_conn_get_option_list (conn, nullptr);
+         option != nullptr; option = dbi_conn_get_option_list (conn, option))
+    {
+        auto value = dbi_conn_get_option (conn, option);
+        if (value != nullptr)
+            dbi_conn_set_option (clone, option, value);
+        else
+            dbi_conn_set_option_numeric (clone, option,
+                                         dbi_conn_get_option_numeric (conn,
+                                                                      option));
+    }
+    if (dbi_conn_connect (clone) < 0)
+    {
+        dbi_conn_close (clone);
+        return nullptr;
+    }
+    return clone;
+}
+
+void
+GncDbiSqlConnection::prefetch (const std::vector<std::string>& queries) noexcept
+{
+    /* A local SQLite file gains nothing from more connections. */
+    if (queries.empty() || !m_prefetch_conns.empty() ||
+        strcmp (dbi_driver_get_name (dbi_conn_get_driver (m_conn)),
+                "sqlite3") == 0)
+        return;
+
+    auto num_conns = std::min (queries.size(), DBI_MAX_PREFETCH_CONNS);
+    while (m_prefetch_conns.size() < num_conns)
+    {
+        auto conn = clone_connection (m_conn);
+        if (conn == nullptr)
+            break;
+        m_prefetch_conns.push_back (conn);
+    }
+    if (m_prefetch_conns.empty())
+    {
+        PWARN ("Couldn't open any connection to prefetch with.");
+        return;
+    }
+
+    /* Each worker takes the next query not yet run and also fetches all of
+     * its rows, so that libdbi has decoded them before the loaders look. */
+    std::vector<dbi_result> results (queries.size(), nullptr);
+    std::atomic<size_t> next{0};
+    auto worker = [&queries, &results, &next](dbi_conn conn)
+    {
+        for (auto index = next++; index < queries.size(); index = next++)
+        {
+            auto result = dbi_conn_query (conn, queries[index].c_str());
+            while (result && dbi_result_next_row (result));
+            results[index] = result;
+        }
+    };
+
+    auto locale = gnc_push_locale (LC_NUMERIC, "C");
+    std::vector<std::thread> workers;
+    for (auto conn : m_prefetch_conns)
+        workers.emplace_back (worker, conn);
+    for (auto& thread : workers)
+        thread.join();
+    gnc_pop_locale (LC_NUMERIC, locale);
+
+    for (size_t index = 0; index < queries.size(); ++index)
+    {
+        if (results[index] == nullptr)
+            DEBUG ("Prefetching %s failed\n", queries[index].c_str());
+        else if (!m_prefetched.emplace (queries[index], results[index]).second)
+            dbi_result_free (results[index]);
+    }
+}
+
+void
+GncDbiSqlConnection::end_prefetch () noexcept
+{
+    for (auto& prefetched : m_prefetched)
+        dbi_result_free (prefetched.second);
+    m_prefetched.clear();
+    for (auto conn : m_prefetch_conns)
+        dbi_conn_close (conn);
+    m_prefetch_conns.clear();
+}
+
 GncSqlResultPtr
 GncDbiSqlConnection::execute_select_statement (const GncSqlStatementPtr& stmt)
     noexcept
 {
     dbi_result result;
 
+    auto prefetched = m_prefetched.find (stmt->to_sql());
+    if (prefetched != m_prefetched.end())
+    {
+        DEBUG ("SQL (prefetched): %s\n", stmt->to_sql());
+        result = prefetched->second;
+        m_prefetched.erase (prefetched);
+        return GncSqlResultPtr(new GncDbiSqlResult (this, result));
+    }
+
     DEBUG ("SQL: %s\n", stmt->to_sql());
     auto locale = gnc_push_locale (LC_NUMERIC, "C");
+    auto start = std::chrono::steady_clock::now();
     do
     {
         init_error ();
         result = dbi_conn_query (m_conn, stmt->to_sql());
     }
     while (m_retry);
+    m_stats.record (stmt->to_sql(), result ? dbi_result_get_numrows (result) : 0,
+                    std::chrono::steady_clock::now() - start);
     if (result == nullptr)
     {
         PERR ("Error executing SQL %s\n", stmt->to_sql());
@@ -290,12 +402,16 @@ GncDbiSqlConnection::execute_nonselect_statement (const GncSqlStatementPtr& stmt
     dbi_result result;
 
     DEBUG ("SQL: %s\n", stmt->to_sql());
+    auto start = std::chrono::steady_clock::now();
     do
     {
         init_error ();
         result = dbi_conn_query (m_conn, stmt->to_sql());
     }
     while (m_retry);
+    m_stats.record (stmt->to_sql(),
+                    result ? dbi_result_get_numrows_affected (result) : 0,
+                    std::chrono::steady_clock::now() - start);
     if (result == nullptr && m_last_error)
     {
         PERR ("Error executing SQL %s\n", stmt->to_sql());
@@ -489,7 +605,7 @@ create_index_ddl (const GncSqlConnection* conn, const std::string& index_name,
     {
         if (table_row != *col_table.begin())
         {
-            ddl =+ ", ";
+            ddl += ", ";
         }
         ddl += table_row->name();
     }
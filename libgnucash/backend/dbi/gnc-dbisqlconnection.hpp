@@ -24,11 +24,13 @@
 #define _GNC_DBISQLCONNECTION_HPP_
 
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include <gnc-sql-connection.hpp>
 #include "gnc-backend-dbi.hpp"
 #include "gnc-dbisqlresult.hpp"
+#include "gnc-dbisqlstats.hpp"
 #include "gnc-dbiprovider.hpp"
 #include "gnc-backend-dbi.h"
 
@@ -60,6 +62,11 @@ public:
     bool add_columns_to_table (const std::string&, const ColVec&)
         const noexcept override;
     std::string quote_string (const std::string&) const noexcept override;
+    void make_upsert (std::string& sql, const std::string& key,
+                      const StrVec& columns) const noexcept override
+    {
+        m_provider->make_upsert (sql, key, columns);
+    }
     int dberror() const noexcept override {
         return dbi_conn_error(m_conn, nullptr); }
     QofBackend* qbe () const noexcept { return m_qbe; }
@@ -80,6 +87,14 @@ public:
      */
     bool verify() noexcept override;
     bool retry_connection(const char* msg) noexcept override;
+    /** Run the queries on up to four extra connections at once.  Does
+     * nothing for SQLite. */
+    void prefetch (const std::vector<std::string>&) noexcept override;
+    void end_prefetch () noexcept override;
+    bool has_native_guids () const noexcept override
+    {
+        return m_provider->has_native_guids ();
+    }
 
     bool table_operation (TableOpType op) noexcept;
     std::string add_columns_ddl(const std::string& table_name,
@@ -109,6 +124,13 @@ private:
     bool m_retry;
     unsigned int m_sql_savepoint;
     bool m_readonly; 
+    /** The extra connections prefetch() opened, kept open until
+     * end_prefetch() because closing them frees their results. */
+    std::vector<dbi_conn> m_prefetch_conns;
+    /** The results of prefetch() not yet executed, by SQL text. */
+    std::unordered_map<std::string, dbi_result> m_prefetched;
+    /** What the statements executed so far cost, for the log. */
+    GncDbiSqlStats m_stats;
     bool lock_database(bool break_lock);
     void unlock_database();
     bool rename_table(const std::string& old_name, const std::string& new_name);
@@ -142,9 +142,16 @@ GncDbiSqlResult::IteratorImpl::get_double_at_col(const char* col) const
 
 std::string
 GncDbiSqlResult::IteratorImpl::get_string_at_col(const char* col) const
+{
+    return std::string{get_string_view_at_col (col)};
+}
+
+/* libdbi hands out its own copy of the field, so there's nothing to copy
+ * here. */
+std::string_view
+GncDbiSqlResult::IteratorImpl::get_string_view_at_col(const char* col) const
 {
     auto type = dbi_result_get_field_type (m_inst->m_dbi_result, col);
-    dbi_result_get_field_attribs (m_inst->m_dbi_result, col);
     if(type != DBI_TYPE_STRING)
         throw (std::invalid_argument{"Requested string from non-string column."});
     auto strval = dbi_result_get_string(m_inst->m_dbi_result, col);
@@ -152,8 +159,7 @@ GncDbiSqlResult::IteratorImpl::get_string_at_col(const char* col) const
     {
         throw (std::invalid_argument{"Column empty."});
     }
-    auto retval =  std::string{strval};
-    return retval;
+    return strval;
 }
 time64
 GncDbiSqlResult::IteratorImpl::get_time64_at_col (const char* col) const
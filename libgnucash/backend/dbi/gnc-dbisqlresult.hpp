@@ -57,6 +57,7 @@ protected:
         virtual double get_float_at_col (const char* col) const;
         virtual double get_double_at_col (const char* col) const;
         virtual std::string get_string_at_col (const char* col)const;
+        virtual std::string_view get_string_view_at_col (const char* col) const;
         virtual time64 get_time64_at_col (const char* col) const;
         virtual bool is_col_null(const char* col) const noexcept
         {
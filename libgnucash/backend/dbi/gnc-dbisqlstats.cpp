@@ -0,0 +1,193 @@
+/********************************************************************
+ * gnc-dbisqlstats.cpp: Time the statements a connection executes.  *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+\********************************************************************/
+
+extern "C"
+{
+#include <config.h>
+#include <gnc-prefs.h>
+#include <qof.h>
+}
+
+#include <algorithm>
+#include <cctype>
+#include <vector>
+
+#include "gnc-dbisqlstats.hpp"
+
+static QofLogModule log_module = G_LOG_DOMAIN;
+
+/* Statements are logged as slow with at most this much of their text. */
+static const int max_logged_sql = 1024;
+
+using std::chrono::duration_cast;
+using std::chrono::microseconds;
+
+static double
+to_ms (SqlDuration d)
+{
+    return std::chrono::duration<double, std::milli> (d).count ();
+}
+
+static bool
+is_identifier_char (char c)
+{
+    return std::isalnum (static_cast<unsigned char> (c)) || c == '_';
+}
+
+/* Append a placeholder, folding it into an immediately preceding one so that
+ * lists of literals, as in IN (...) or a row of values, come out as one. */
+static void
+add_placeholder (std::string& out)
+{
+    auto len = out.size ();
+    if (len >= 3 && out.compare (len - 3, 3, "?, ") == 0)
+        out.resize (len - 2);
+    else if (len >= 2 && out.compare (len - 2, 2, "?,") == 0)
+        out.resize (len - 1);
+    else
+        out += '?';
+}
+
+std::string
+GncDbiSqlStats::normalize (const char* sql)
+{
+    std::string out;
+    /* Where the open parentheses start in out, and the extent of the last
+     * complete top-level group, to fold the rows of a multi-row INSERT. */
+    std::vector<size_t> opens;
+    size_t group_start = std::string::npos, group_end = std::string::npos;
+
+    for (auto p = sql; *p; ++p)
+    {
+        if (*p == '\'')
+        {
+            /* Doubled quotes escape a quote, and MySQL also allows \'. */
+            for (++p; *p; ++p)
+            {
+                if (*p == '\\' && p[1])
+                    ++p;
+                else if (*p == '\'' && p[1] == '\'')
+                    ++p;
+                else if (*p == '\'')
+                    break;
+            }
+            add_placeholder (out);
+            if (!*p)
+                break;
+        }
+        else if (std::isdigit (static_cast<unsigned char> (*p)) &&
+                 (out.empty () || !is_identifier_char (out.back ())))
+        {
+            while (std::isdigit (static_cast<unsigned char> (p[1])) ||
+                   p[1] == '.')
+                ++p;
+            add_placeholder (out);
+        }
+        else if (*p == '(')
+        {
+            opens.push_back (out.size ());
+            out += *p;
+        }
+        else if (*p == ')' && !opens.empty ())
+        {
+            auto start = opens.back ();
+            opens.pop_back ();
+            out += *p;
+            if (!opens.empty ())
+                continue;
+            auto len = out.size () - start;
+            auto sep = start - group_end;
+            if (group_end != std::string::npos && (sep == 1 || sep == 2) &&
+                out.compare (group_end, sep, ", ", sep) == 0 &&
+                len == group_end - group_start &&
+                out.compare (start, len, out, group_start, len) == 0)
+                out.resize (group_end);
+            else
+            {
+                group_start = start;
+                group_end = out.size ();
+            }
+        }
+        else
+            out += *p;
+    }
+    return out;
+}
+
+void
+GncDbiSqlStats::record (const char* sql, uint64_t rows, SqlDuration elapsed)
+{
+    auto slow_ms = gnc_prefs_get_sql_slow_query_ms ();
+    if (slow_ms > 0 && elapsed >= std::chrono::milliseconds (slow_ms))
+        PWARN ("Slow SQL, %.1f ms, %" G_GUINT64_FORMAT " rows: %.*s",
+               to_ms (elapsed), rows, max_logged_sql, sql);
+
+    if (!qof_log_check (log_module, QOF_LOG_INFO))
+        return;
+
+    auto& entry = m_entries[normalize (sql)];
+    ++entry.count;
+    entry.rows += rows;
+    entry.total += elapsed;
+    entry.max = std::max (entry.max, elapsed);
+    auto us = duration_cast<microseconds> (elapsed).count ();
+    auto bucket = std::upper_bound (bucket_limits.begin (),
+                                    bucket_limits.end (), us);
+    ++entry.histogram[bucket - bucket_limits.begin ()];
+}
+
+void
+GncDbiSqlStats::dump ()
+{
+    if (m_entries.empty ())
+        return;
+
+    using EntryRef = std::pair<const std::string, Entry>*;
+    std::vector<EntryRef> sorted;
+    SqlDuration total{};
+    for (auto& entry : m_entries)
+    {
+        sorted.push_back (&entry);
+        total += entry.second.total;
+    }
+    std::sort (sorted.begin (), sorted.end (),
+               [](EntryRef a, EntryRef b)
+               { return a->second.total > b->second.total; });
+
+    PINFO ("%zu kinds of SQL statement took %.1f ms. Calls, rows, total ms, "
+           "max ms, calls under 0.1/1/10/100/1000 ms and slower:",
+           m_entries.size (), to_ms (total));
+    for (auto entry : sorted)
+    {
+        auto& e = entry->second;
+        std::string histogram;
+        for (auto count : e.histogram)
+        {
+            if (!histogram.empty ())
+                histogram += '/';
+            histogram += std::to_string (count);
+        }
+        PINFO ("%" G_GUINT64_FORMAT ", %" G_GUINT64_FORMAT ", %.1f, %.1f, %s: %s",
+               e.count, e.rows, to_ms (e.total), to_ms (e.max),
+               histogram.c_str (), entry->first.c_str ());
+    }
+    m_entries.clear ();
+}
@@ -0,0 +1,75 @@
+/********************************************************************
+ * gnc-dbisqlstats.hpp: Time the statements a connection executes.  *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+\********************************************************************/
+
+#ifndef __GNC_DBISQLSTATS_HPP__
+#define __GNC_DBISQLSTATS_HPP__
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+using SqlDuration = std::chrono::steady_clock::duration;
+
+/**
+ * Gathers how often each kind of statement ran, how many rows it returned
+ * or changed and how long it took, for tuning a database server and for
+ * reporting regressions.  Statements are grouped by their text with every
+ * literal replaced by ?, so that all the lookups of one object type count as
+ * one statement.
+ *
+ * Statistics are only gathered while the gnc.backend.dbi log module is at
+ * the info level, and written to the log at that level by dump().
+ * Independently of that, a statement slower than the sql-slow-query-ms
+ * preference is logged as a warning as soon as it finishes.
+ */
+class GncDbiSqlStats
+{
+public:
+    GncDbiSqlStats() = default;
+    GncDbiSqlStats(const GncDbiSqlStats&) = delete;
+    GncDbiSqlStats& operator=(const GncDbiSqlStats&) = delete;
+    /** Account for one execution of sql. */
+    void record (const char* sql, uint64_t rows, SqlDuration elapsed);
+    /** Log the statistics gathered so far, the slowest statements in total
+     * first, and forget them. */
+    void dump ();
+    /** The text under which sql's statistics are kept. */
+    static std::string normalize (const char* sql);
+
+private:
+    /* Upper bounds of the histogram's buckets in microseconds; the last
+     * bucket takes everything slower. */
+    static constexpr std::array<int64_t, 5> bucket_limits
+    { 100, 1000, 10000, 100000, 1000000 };
+    struct Entry
+    {
+        uint64_t count = 0;
+        uint64_t rows = 0;
+        SqlDuration total{};
+        SqlDuration max{};
+        std::array<uint64_t, bucket_limits.size() + 1> histogram{};
+    };
+    std::unordered_map<std::string, Entry> m_entries;
+};
+
+#endif //__GNC_DBISQLSTATS_HPP__
@@ -363,7 +363,7 @@ test_conn_index_functions (QofBackend* qof_be)
 
     auto index_list = conn->provider()->get_index_list (dbi_be->conn);
     g_test_message ("Returned from index list\n");
-    g_assert_cmpint (index_list.size(), == , 4);
+    g_assert_cmpint (index_list.size(), == , 5);
     for (auto index : index_list)
     {
         const char* errmsg;
@@ -569,6 +569,69 @@ cleanup:
     qof_session_destroy (sess);
 }
 
+/* A transaction one session changes in the database is reloaded by
+ * another that reads the change log. */
+static void
+test_dbi_change_log (Fixture* fixture, gconstpointer pData)
+{
+    auto url = (const gchar*)pData;
+    auto msg = "[GncDbiSqlConnection::unlock_database()] There was no lock entry in the Lock table";
+    auto log_domain = nullptr;
+    auto loglevel = static_cast<GLogLevelFlags> (G_LOG_LEVEL_WARNING |
+                                                 G_LOG_FLAG_FATAL);
+    TestErrorStruct* check = test_error_struct_new (log_domain, loglevel, msg);
+    fixture->hdlrs = test_log_set_fatal_handler (fixture->hdlrs, check,
+                                                 (GLogFunc)test_checked_handler);
+    if (fixture->filename)
+        url = fixture->filename;
+    gnc_prefs_set_sql_change_log (TRUE);
+
+    auto writer = qof_session_new (qof_book_new ());
+    qof_session_begin (writer, url, SESSION_NEW_OVERWRITE);
+    g_assert_cmpint (qof_session_get_error (writer), == , ERR_BACKEND_NO_ERR);
+    qof_session_swap_data (fixture->session, writer);
+    qof_book_mark_session_dirty (qof_session_get_book (writer));
+    qof_session_save (writer, NULL);
+    g_assert_cmpint (qof_session_get_error (writer), == , ERR_BACKEND_NO_ERR);
+
+    auto reader = qof_session_new (qof_book_new ());
+    qof_session_begin (reader, url, SESSION_READ_ONLY);
+    qof_session_load (reader, NULL);
+    g_assert_cmpint (qof_session_get_error (reader), == , ERR_BACKEND_NO_ERR);
+    g_assert (!qof_session_events_pending (reader));
+
+    Transaction* tx = nullptr;
+    qof_collection_foreach (qof_book_get_collection (qof_session_get_book (writer),
+                                                     GNC_ID_TRANS),
+                            [](QofInstance* inst, gpointer data)
+                            {
+                                *static_cast<Transaction**>(data) =
+                                    GNC_TRANSACTION (inst);
+                            }, &tx);
+    g_assert (tx != nullptr);
+    auto guid = *qof_instance_get_guid (QOF_INSTANCE (tx));
+    xaccTransBeginEdit (tx);
+    xaccTransSetDescription (tx, "Changed elsewhere");
+    xaccTransCommitEdit (tx);
+    g_assert_cmpint (qof_session_get_error (writer), == , ERR_BACKEND_NO_ERR);
+
+    g_assert (qof_session_events_pending (reader));
+    qof_session_process_events (reader);
+    g_assert_cmpint (qof_session_get_error (reader), == , ERR_BACKEND_NO_ERR);
+    auto reloaded = xaccTransLookup (&guid, qof_session_get_book (reader));
+    g_assert (reloaded != nullptr);
+    g_assert_cmpstr (xaccTransGetDescription (reloaded), == ,
+                     "Changed elsewhere");
+    g_assert_cmpint (xaccTransCountSplits (reloaded), == , 2);
+    g_assert (!qof_session_events_pending (reader));
+
+    gnc_prefs_set_sql_change_log (FALSE);
+    qof_session_end (reader);
+    qof_session_destroy (reader);
+    qof_session_end (writer);
+    qof_session_destroy (writer);
+}
+
 static void
 test_dbi_business_store_and_reload (Fixture* fixture, gconstpointer pData)
 {
@@ -648,6 +711,8 @@ create_dbi_test_suite (const char* dbm_name, const char* url)
                   test_dbi_safe_save, teardown);
     GNC_TEST_ADD (subsuite, "version_control", Fixture, url, setup_memory,
                   test_dbi_version_control, teardown);
+    GNC_TEST_ADD (subsuite, "change_log", Fixture, url, setup_memory,
+                  test_dbi_change_log, teardown);
     GNC_TEST_ADD (subsuite, "business_store_and_reload", Fixture, url,
                   setup_business, test_dbi_version_control, teardown);
     g_free (subsuite);
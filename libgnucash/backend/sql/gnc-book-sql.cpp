@@ -160,6 +160,7 @@ load_single_book (GncSqlBackend* sql_be, GncSqlRow& row)
     qof_book_begin_edit (pBook);
     gnc_sql_load_object (sql_be, row, GNC_ID_BOOK, pBook, col_table);
     gnc_sql_slots_load (sql_be, QOF_INSTANCE (pBook));
+    qof_book_features_changed (pBook);
     qof_book_commit_edit (pBook);
 
     qof_instance_mark_clean (QOF_INSTANCE (pBook));
@@ -49,6 +49,11 @@ extern "C"
 #include "gnc-slots-sql.h"
 #include "gnc-recurrence-sql.h"
 
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
 #define BUDGET_TABLE "budgets"
 #define TABLE_VERSION 1
 #define AMOUNTS_TABLE "budget_amounts"
@@ -191,33 +196,68 @@ set_amount (gpointer pObj, gnc_numeric value)
 
 /*----------------------------------------------------------------*/
 /**
- * Loads the budget amounts for a budget.
+ * Loads the amounts of every budget with one query, and records them as
+ * the ones in the database.
  *
  * @param sql_be SQL backend
- * @param budget Budget
  */
-static void
-load_budget_amounts (GncSqlBackend* sql_be, GncBudget* budget)
+void
+GncSqlBudgetBackend::load_amounts (GncSqlBackend* sql_be)
 {
     gchar guid_buf[GUID_ENCODING_LENGTH + 1];
+    GncBudget* budget = NULL;
+    AmountMap* saved = NULL;
+    GncGUID budget_guid = *guid_null ();
 
     g_return_if_fail (sql_be != NULL);
-    g_return_if_fail (budget != NULL);
 
-    (void)guid_to_string_buff (qof_instance_get_guid (QOF_INSTANCE (budget)),
-                               guid_buf);
-    auto sql = g_strdup_printf ("SELECT * FROM %s WHERE budget_guid='%s'",
-                                AMOUNTS_TABLE, guid_buf);
+    m_saved_amounts.clear ();
+    std::string sql("SELECT * FROM " AMOUNTS_TABLE " ORDER BY budget_guid");
     auto stmt = sql_be->create_statement_from_sql(sql);
-    g_free (sql);
-    if (stmt != nullptr)
+    if (stmt == nullptr)
+        return;
+
+    auto result = sql_be->execute_select_statement(stmt);
+    for (auto row : *result)
     {
-        auto result = sql_be->execute_select_statement(stmt);
-        budget_amount_info_t info = { budget, NULL, 0 };
+        GncGUID row_budget, row_account;
+        try
+        {
+            row_budget = row.get_guid_at_col ("budget_guid");
+            row_account = row.get_guid_at_col ("account_guid");
+        }
+        catch (std::invalid_argument&)
+        {
+            continue;
+        }
+
+        /* The rows come by budget, so each is edited once. */
+        if (!guid_equal (&row_budget, &budget_guid))
+        {
+            if (budget)
+                gnc_budget_commit_edit (budget);
+            budget_guid = row_budget;
+            budget = gnc_budget_lookup (&budget_guid, sql_be->book());
+            if (budget)
+            {
+                gnc_budget_begin_edit (budget);
+                guid_to_string_buff (&budget_guid, guid_buf);
+                saved = &m_saved_amounts[guid_buf];
+            }
+        }
+        if (!budget)
+            continue;
 
-        for (auto row : *result)
-            gnc_sql_load_object (sql_be, row, NULL, &info, budget_amounts_col_table);
+        budget_amount_info_t info = { budget, NULL, 0 };
+        gnc_sql_load_object (sql_be, row, NULL, &info, budget_amounts_col_table);
+        guid_to_string_buff (&row_account, guid_buf);
+        (*saved)[{guid_buf, info.period_num}] = info.account ?
+            gnc_budget_get_account_period_value (budget, info.account,
+                                                 info.period_num) :
+            gnc_numeric_zero ();
     }
+    if (budget)
+        gnc_budget_commit_edit (budget);
 }
 
 /**
@@ -246,48 +286,129 @@ delete_budget_amounts (GncSqlBackend* sql_be, GncBudget* budget)
 }
 
 /**
- * Saves the budget amounts for a budget.
+ * Deletes some of the budget amounts of an account.
  *
  * @param sql_be SQL backend
- * @param budget Budget
+ * @param budget_guid The budget's GUID as a string
+ * @param account_guid The account's GUID as a string
+ * @param periods The periods of the amounts
  */
 static gboolean
-save_budget_amounts (GncSqlBackend* sql_be, GncBudget* budget)
+delete_account_amounts (GncSqlBackend* sql_be, const std::string& budget_guid,
+                        const std::string& account_guid,
+                        const std::vector<guint>& periods)
+{
+    std::stringstream sql;
+    sql << "DELETE FROM " << AMOUNTS_TABLE << " WHERE budget_guid='" <<
+        budget_guid << "' AND account_guid='" << account_guid <<
+        "' AND period_num IN (";
+    for (auto it = periods.begin(); it != periods.end(); ++it)
+        sql << (it == periods.begin() ? "" : ",") << *it;
+    sql << ")";
+    auto stmt = sql_be->create_statement_from_sql(sql.str());
+    return stmt != nullptr && sql_be->execute_nonselect_statement(stmt) != -1;
+}
+
+static inline bool
+same_amount (gnc_numeric a, gnc_numeric b)
 {
-    GList* descendants;
-    GList* node;
-    budget_amount_info_t info;
-    guint num_periods;
+    return a.num == b.num && a.denom == b.denom;
+}
+
+/**
+ * Saves the budget amounts for a budget.  When the amounts in the
+ * database are known, only the ones that were added, changed or unset
+ * since are written: a changed amount is deleted and inserted again.
+ * Otherwise they are all deleted and inserted.  The inserts are sent
+ * several rows to a statement.
+ *
+ * @param sql_be SQL backend
+ * @param budget Budget
+ * @param is_infant Whether the budget is new, so has no amounts saved
+ */
+bool
+GncSqlBudgetBackend::save_amounts (GncSqlBackend* sql_be, GncBudget* budget,
+                                   bool is_infant)
+{
+    gchar guid_buf[GUID_ENCODING_LENGTH + 1];
+    std::map<std::string, std::vector<guint>> deletes;
+    std::vector<budget_amount_info_t> inserts;
+    AmountMap amounts;
     gboolean is_ok = TRUE;
 
     g_return_val_if_fail (sql_be != NULL, FALSE);
     g_return_val_if_fail (budget != NULL, FALSE);
 
-    // Delete the amounts, then save
-    delete_budget_amounts (sql_be, budget);
+    guid_to_string_buff (qof_instance_get_guid (QOF_INSTANCE (budget)),
+                         guid_buf);
+    std::string budget_guid{guid_buf};
+    const AmountMap* saved = NULL;
+    if (!sql_be->pristine() && !is_infant)
+    {
+        auto saved_it = m_saved_amounts.find (budget_guid);
+        if (saved_it != m_saved_amounts.end ())
+            saved = &saved_it->second;
+        else
+            is_ok = delete_budget_amounts (sql_be, budget);
+    }
 
-    info.budget = budget;
-    num_periods = gnc_budget_get_num_periods (budget);
-    descendants = gnc_account_get_descendants (gnc_book_get_root_account (
-                                                   sql_be->book()));
-    for (node = descendants; node != NULL && is_ok; node = g_list_next (node))
+    auto num_periods = gnc_budget_get_num_periods (budget);
+    auto descendants = gnc_account_get_descendants (gnc_book_get_root_account (
+                                                        sql_be->book()));
+    for (auto node = descendants; node != NULL; node = g_list_next (node))
     {
-        guint i;
+        auto account = GNC_ACCOUNT (node->data);
+        guid_to_string_buff (xaccAccountGetGUID (account), guid_buf);
+        std::string account_guid{guid_buf};
 
-        info.account = GNC_ACCOUNT (node->data);
-        for (i = 0; i < num_periods && is_ok; i++)
+        for (guint i = 0; i < num_periods; i++)
         {
-            if (gnc_budget_is_account_period_value_set (budget, info.account, i))
+            if (!gnc_budget_is_account_period_value_set (budget, account, i))
+                continue;
+
+            auto value = gnc_budget_get_account_period_value (budget, account, i);
+            auto key = std::make_pair (account_guid, i);
+            amounts.emplace (key, value);
+            if (saved)
             {
-                info.period_num = i;
-                is_ok = sql_be->do_db_operation(OP_DB_INSERT, AMOUNTS_TABLE,
-                                                "", &info,
-                                                 budget_amounts_col_table);
+                auto it = saved->find (key);
+                if (it != saved->end () && same_amount (it->second, value))
+                    continue;
+                if (it != saved->end ())
+                    deletes[account_guid].push_back (i);
             }
+            inserts.push_back ({budget, account, i});
         }
     }
     g_list_free (descendants);
 
+    if (saved)
+    {
+        for (auto const& entry : *saved)
+            if (!amounts.count (entry.first))
+                deletes[entry.first.first].push_back (entry.first.second);
+    }
+
+    for (auto it = deletes.begin (); is_ok && it != deletes.end (); ++it)
+        is_ok = delete_account_amounts (sql_be, budget_guid, it->first,
+                                        it->second);
+
+    if (is_ok && !inserts.empty ())
+    {
+        std::vector<gpointer> rows;
+        rows.reserve (inserts.size ());
+        for (auto& info : inserts)
+            rows.push_back (&info);
+        is_ok = sql_be->do_db_bulk_insert (AMOUNTS_TABLE, "", rows,
+                                           budget_amounts_col_table);
+    }
+
+    /* After a failure the database's amounts aren't known any more. */
+    if (is_ok)
+        m_saved_amounts[budget_guid] = std::move (amounts);
+    else
+        m_saved_amounts.erase (budget_guid);
+
     return is_ok;
 }
 /*----------------------------------------------------------------*/
@@ -312,7 +433,6 @@ load_single_budget (GncSqlBackend* sql_be, GncSqlRow& row)
 
     gnc_budget_begin_edit (pBudget);
     gnc_sql_load_object (sql_be, row, GNC_ID_BUDGET, pBudget, col_table);
-    load_budget_amounts (sql_be, pBudget);
     r = gnc_sql_recurrence_load (sql_be, gnc_budget_get_guid (pBudget));
     if (r != NULL)
     {
@@ -334,6 +454,7 @@ GncSqlBudgetBackend::load_all (GncSqlBackend* sql_be)
     auto result = sql_be->execute_select_statement(stmt);
     for (auto row : *result)
         load_single_budget (sql_be, row);
+    load_amounts (sql_be);
 
     std::string pkey(col_table[0]->name());
     sql = "SELECT DISTINCT ";
@@ -400,7 +521,7 @@ GncSqlBudgetBackend::commit (GncSqlBackend* sql_be, QofInstance* inst)
         guid = qof_instance_get_guid (inst);
         if (!qof_instance_get_destroying (inst))
         {
-            is_ok = save_budget_amounts (sql_be, pBudget);
+            is_ok = save_amounts (sql_be, pBudget, is_infant);
             if (is_ok)
             {
                 is_ok = gnc_sql_recurrence_save (sql_be, guid,
@@ -414,6 +535,7 @@ GncSqlBudgetBackend::commit (GncSqlBackend* sql_be, QofInstance* inst)
         else
         {
             is_ok = delete_budget_amounts (sql_be, pBudget);
+            m_saved_amounts.erase (gnc::GUID{*guid}.to_string ());
             if (is_ok)
             {
                 is_ok = gnc_sql_recurrence_delete (sql_be, guid);
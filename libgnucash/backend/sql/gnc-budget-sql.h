@@ -29,11 +29,23 @@
 #ifndef GNC_BUDGET_SQL_H
 #define GNC_BUDGET_SQL_H
 
+extern "C"
+{
+#include "gnc-budget.h"
+}
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
 #include "gnc-sql-object-backend.hpp"
 
 class GncSqlBudgetBackend : public GncSqlObjectBackend
 {
 public:
+    /** A budget's amounts by account GUID and period. */
+    using AmountMap = std::map<std::pair<std::string, guint>, gnc_numeric>;
+
     GncSqlBudgetBackend();
     void load_all(GncSqlBackend*) override;
     void create_tables(GncSqlBackend*) override;
@@ -41,6 +53,11 @@ public:
     bool write(GncSqlBackend*) override;
 private:
     static void save(QofInstance*, void*);
+    void load_amounts(GncSqlBackend*);
+    bool save_amounts(GncSqlBackend*, GncBudget*, bool is_infant);
+    /** The amounts of each budget, by its GUID, as they are in the
+     * database, so that a commit writes only those that changed. */
+    std::unordered_map<std::string, AmountMap> m_saved_amounts;
 };
 
 #endif /* GNC_BUDGET_SQL_H */
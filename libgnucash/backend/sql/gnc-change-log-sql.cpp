@@ -0,0 +1,214 @@
+/********************************************************************
+ * gnc-change-log-sql.cpp: Share changes between sessions           *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+\********************************************************************/
+
+#include <guid.hpp>
+extern "C"
+{
+#include <config.h>
+
+#include <glib.h>
+
+#include "qof.h"
+#include "Account.h"
+#include "Transaction.h"
+#include "gnc-commodity.h"
+}
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "gnc-sql-connection.hpp"
+#include "gnc-sql-backend.hpp"
+#include "gnc-sql-object-backend.hpp"
+#include "gnc-sql-column-table-entry.hpp"
+#include "gnc-sql-result.hpp"
+#include "gnc-transaction-sql.h"
+
+#include "gnc-change-log-sql.h"
+
+static QofLogModule log_module = G_LOG_DOMAIN;
+
+#define TABLE_NAME "changes"
+#define TABLE_VERSION 1
+#define CHANGE_LOG_TYPE "ChangeLog"
+#define OBJ_TYPE_MAX_LEN 40
+
+/* Rows older than this are deleted when a session first writes to the
+ * log; a session that hasn't looked at the log for so long misses them. */
+#define CHANGE_LOG_KEEP_SECS (24 * 60 * 60)
+/* How long after a row was first read a row below it may still turn up,
+ * because the database transaction that added it was committed later. */
+#define CHANGE_LOG_SETTLE_SECS 60
+
+static const EntryVec col_table
+({
+    gnc_sql_make_table_entry<CT_INT>(
+        "id", 0, COL_PKEY | COL_NNUL | COL_AUTOINC),
+    gnc_sql_make_table_entry<CT_STRING>("obj_type", OBJ_TYPE_MAX_LEN,
+                                        COL_NNUL),
+    gnc_sql_make_table_entry<CT_GUID>("obj_guid", 0, COL_NNUL),
+    gnc_sql_make_table_entry<CT_GUID>("session_guid", 0, COL_NNUL),
+    gnc_sql_make_table_entry<CT_INT64>("changed", 0, COL_NNUL)
+});
+
+/* The log isn't part of the book: no instance has its type, so the default
+ * commit() and write() are never called, and only record() adds rows. */
+GncSqlChangeLogBackend::GncSqlChangeLogBackend() :
+    GncSqlObjectBackend(TABLE_VERSION, CHANGE_LOG_TYPE, TABLE_NAME, col_table),
+    m_session{guid_new_return ()} {}
+
+void
+GncSqlChangeLogBackend::load_all (GncSqlBackend* sql_be)
+{
+    g_return_if_fail (sql_be != NULL);
+
+    m_seen.clear ();
+    m_types.clear ();
+    m_transactions.clear ();
+    m_floor = 0;
+
+    auto stmt = sql_be->create_statement_from_sql ("SELECT MAX(id) AS id FROM "
+                                                   TABLE_NAME);
+    if (stmt == nullptr)
+        return;
+    auto result = sql_be->execute_select_statement (stmt);
+    if (result == nullptr)
+        return;
+    for (auto row : *result)
+        if (!row.is_col_null ("id"))
+            m_floor = row.get_int_at_col ("id");
+    delete result;
+}
+
+bool
+GncSqlChangeLogBackend::record (GncSqlBackend* sql_be, QofInstance* inst)
+{
+    g_return_val_if_fail (sql_be != NULL, false);
+    g_return_val_if_fail (inst != NULL, false);
+
+    if (!GNC_IS_TRANSACTION (inst) && !GNC_IS_ACCOUNT (inst) &&
+        !GNC_IS_COMMODITY (inst))
+        return true;
+
+    auto now = gnc_time (nullptr);
+    if (!m_pruned)
+    {
+        auto sql = std::string ("DELETE FROM " TABLE_NAME " WHERE changed < ")
+            + std::to_string (now - CHANGE_LOG_KEEP_SECS);
+        auto stmt = sql_be->create_statement_from_sql (sql);
+        if (stmt == nullptr || sql_be->execute_nonselect_statement (stmt) == -1)
+            return false;
+        m_pruned = true;
+    }
+
+    auto sql = std::string ("INSERT INTO " TABLE_NAME
+                            " (obj_type, obj_guid, session_guid, changed)"
+                            " VALUES ('") + inst->e_type + "', '" +
+        gnc::GUID (*qof_instance_get_guid (inst)).to_string () + "', '" +
+        gnc::GUID (m_session).to_string () + "', " + std::to_string (now) + ")";
+    auto stmt = sql_be->create_statement_from_sql (sql);
+    return stmt != nullptr && sql_be->execute_nonselect_statement (stmt) != -1;
+}
+
+/* Rows are read by id, but ids are handed out as rows are added and the
+ * rows only show up when their database transactions are committed, which
+ * needn't be in the same order.  So the rows above the floor are read
+ * again each time, and the floor only passes a row once it was read a
+ * while ago. */
+bool
+GncSqlChangeLogBackend::poll (GncSqlBackend* sql_be)
+{
+    g_return_val_if_fail (sql_be != NULL, false);
+
+    auto sql = std::string ("SELECT id, obj_type, obj_guid FROM " TABLE_NAME
+                            " WHERE id > ") + std::to_string (m_floor) +
+        " AND session_guid <> '" + gnc::GUID (m_session).to_string () + "'";
+    auto stmt = sql_be->create_statement_from_sql (sql);
+    if (stmt == nullptr)
+        return !m_transactions.empty ();
+    auto result = sql_be->execute_select_statement (stmt);
+    if (result == nullptr)
+        return !m_transactions.empty ();
+
+    auto now = gnc_time (nullptr);
+    for (auto row : *result)
+    {
+        auto id = row.get_int_at_col ("id");
+        if (!m_seen.emplace (id, now).second)
+            continue;
+
+        GncGUID guid;
+        try
+        {
+            guid = row.get_guid_at_col ("obj_guid");
+        }
+        catch (std::invalid_argument&)
+        {
+            PWARN ("Change %" G_GINT64_FORMAT " has no valid GUID", id);
+            continue;
+        }
+        auto type = row.get_string_at_col ("obj_type");
+        if (type != GNC_ID_TRANS)
+            m_types.insert (type);
+        else if (std::none_of (m_transactions.begin (), m_transactions.end (),
+                               [&guid](const GncGUID& other)
+                               { return guid_equal (&guid, &other); }))
+            m_transactions.push_back (guid);
+    }
+    delete result;
+
+    while (!m_seen.empty () &&
+           m_seen.begin ()->second + CHANGE_LOG_SETTLE_SECS < now)
+    {
+        m_floor = m_seen.begin ()->first;
+        m_seen.erase (m_seen.begin ());
+    }
+    return !m_types.empty () || !m_transactions.empty ();
+}
+
+void
+GncSqlChangeLogBackend::apply (GncSqlBackend* sql_be)
+{
+    g_return_if_fail (sql_be != NULL);
+
+    /* Accounts refer to their commodities and splits to their accounts. */
+    for (auto type : {GNC_ID_COMMODITY, GNC_ID_ACCOUNT})
+    {
+        if (m_types.count (type) == 0)
+            continue;
+        auto obe = sql_be->get_object_backend (type);
+        if (obe)
+            obe->load_all (sql_be);
+    }
+    m_types.clear ();
+
+    std::vector<GncGUID> reload, in_edit;
+    for (const auto& guid : m_transactions)
+    {
+        auto tx = xaccTransLookup (&guid, sql_be->book ());
+        if (tx && xaccTransIsOpen (tx))
+            in_edit.push_back (guid);
+        else
+            reload.push_back (guid);
+    }
+    gnc_sql_transaction_reload (sql_be, reload);
+    m_transactions = std::move (in_edit);
+}
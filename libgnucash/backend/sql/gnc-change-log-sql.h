@@ -0,0 +1,78 @@
+/********************************************************************
+ * gnc-change-log-sql.h: Share changes between sessions             *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+\********************************************************************/
+/** @file gnc-change-log-sql.h
+ *  @brief Note changes in the database for other sessions to load
+ *
+ * Each session with the "sql-change-log" preference adds a row to the
+ * changes table for every transaction, account and commodity it writes,
+ * and reads the rows the other sessions added since it last looked.
+ */
+
+#ifndef GNC_CHANGE_LOG_SQL_H
+#define GNC_CHANGE_LOG_SQL_H
+
+extern "C"
+{
+#include "qof.h"
+}
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "gnc-sql-object-backend.hpp"
+
+class GncSqlChangeLogBackend : public GncSqlObjectBackend
+{
+public:
+    GncSqlChangeLogBackend();
+    /** Skips the changes already in the log, which the load has. */
+    void load_all(GncSqlBackend*) override;
+    /**
+     * Note in the log that inst was written, within its commit.
+     * @return true if successful or inst isn't of a type the log keeps.
+     */
+    bool record(GncSqlBackend* sql_be, QofInstance* inst);
+    /**
+     * Read the changes the other sessions logged since the last poll().
+     * @return true if there are changes for apply() to load.
+     */
+    bool poll(GncSqlBackend* sql_be);
+    /**
+     * Load the commodities, accounts and transactions poll() found changed.
+     * A transaction being edited is left for the next apply().  Must be
+     * called with the backend loading, so that nothing is written back.
+     */
+    void apply(GncSqlBackend* sql_be);
+
+private:
+    GncGUID m_session;      /**< Tells this session's rows from the others */
+    bool m_pruned = false;  /**< The log's old rows were deleted */
+    /** Every row above it was read; see poll() for why that isn't simply
+     * the highest id read. */
+    int64_t m_floor = 0;
+    /** The rows above m_floor already read, with when they were first. */
+    std::map<int64_t, time64> m_seen;
+    std::set<std::string> m_types;       /**< Changed types but transactions */
+    std::vector<GncGUID> m_transactions; /**< Changed transactions */
+};
+
+#endif /* GNC_CHANGE_LOG_SQL_H */
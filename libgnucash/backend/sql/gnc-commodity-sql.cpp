@@ -170,8 +170,7 @@ GncSqlCommodityBackend::load_all (GncSqlBackend* sql_be)
 }
 /* ================================================================= */
 static gboolean
-do_commit_commodity (GncSqlBackend* sql_be, QofInstance* inst,
-                     gboolean force_insert)
+do_commit_commodity (GncSqlBackend* sql_be, QofInstance* inst)
 {
     const GncGUID* guid;
     gboolean is_infant;
@@ -183,13 +182,15 @@ do_commit_commodity (GncSqlBackend* sql_be, QofInstance* inst,
     {
         op = OP_DB_DELETE;
     }
-    else if (sql_be->pristine() || is_infant || force_insert)
+    else if (sql_be->pristine())
     {
         op = OP_DB_INSERT;
     }
     else
     {
-        op = OP_DB_UPDATE;
+        /* Commodities are saved when something first refers to them, so
+         * whether this one is in the database yet isn't known. */
+        op = OP_DB_UPSERT;
     }
     is_ok = sql_be->do_db_operation(op, COMMODITIES_TABLE, GNC_ID_COMMODITY,
                                     inst, col_table);
@@ -217,8 +218,7 @@ GncSqlCommodityBackend::commit (GncSqlBackend* sql_be, QofInstance* inst)
     g_return_val_if_fail (sql_be != NULL, FALSE);
     g_return_val_if_fail (inst != NULL, FALSE);
     g_return_val_if_fail (GNC_IS_COMMODITY (inst), FALSE);
-    auto in_be = instance_in_db(sql_be, inst);
-    return do_commit_commodity (sql_be, inst, !in_be);
+    return do_commit_commodity (sql_be, inst);
 }
 
 /* ----------------------------------------------------------------- */
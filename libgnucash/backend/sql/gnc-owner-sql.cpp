@@ -165,7 +165,7 @@ GncSqlColumnTableEntryImpl<CT_OWNERREF>::add_to_table(ColVec& vec) const noexcep
     vec.emplace_back(std::move(info));
 /* Buf isn't leaking, it belongs to ColVec now. */
     buf = g_strdup_printf ("%s_guid", m_col_name);
-    GncSqlColumnInfo info2(buf, BCT_STRING, GUID_ENCODING_LENGTH, false, false,
+    GncSqlColumnInfo info2(buf, BCT_GUID, GUID_ENCODING_LENGTH, false, false,
                            m_flags & COL_PKEY, m_flags & COL_NNUL);
     vec.emplace_back(std::move(info2));
 }
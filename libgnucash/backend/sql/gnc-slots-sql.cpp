@@ -42,6 +42,8 @@ extern "C"
 
 #include <string>
 #include <sstream>
+#include <cstring>
+#include <cstdint>
 
 #include "gnc-sql-connection.hpp"
 #include "gnc-sql-backend.hpp"
@@ -219,7 +221,7 @@ set_slot_from_value (slot_info_t* pInfo, KvpValue* pValue)
     case FRAME:
     {
         auto key = get_key (pInfo);
-        pInfo->pKvpFrame->set ({key}, pValue);
+        pInfo->pKvpFrame->set (key.c_str (), pValue);
         break;
     }
     case LIST:
@@ -238,7 +240,7 @@ set_slot_from_value (slot_info_t* pInfo, KvpValue* pValue)
             frame->set_path ({path, key}, pValue);
         }
         else
-            frame->set ({key}, pValue);
+            frame->set (key.c_str (), pValue);
         break;
     }
     }
@@ -458,7 +460,7 @@ set_guid_val (gpointer pObject,  gpointer pValue)
 
         slots_load_info (newInfo);
         pValue = new KvpValue {newInfo->pList};
-        pInfo->pKvpFrame->set ({key.c_str()}, pValue);
+        pInfo->pKvpFrame->set (key.c_str (), pValue);
 	delete newInfo;
         break;
     }
@@ -481,7 +483,7 @@ set_guid_val (gpointer pObject,  gpointer pValue)
         default:
         {
             auto key = get_key (pInfo);
-            pInfo->pKvpFrame->set ({key.c_str()}, new KvpValue {newFrame});
+            pInfo->pKvpFrame->set (key.c_str (), new KvpValue {newFrame});
             break;
         }
         }
@@ -646,6 +648,140 @@ save_slot (const char* key, KvpValue* value, slot_info_t & slot_info)
     }
 }
 
+/* The instance's idata holds a digest of the slots last written to or read
+ * from the database, so that committing an object whose slots haven't
+ * changed doesn't delete and rewrite every one of its slot rows.  0 means
+ * the saved slots aren't known. */
+static const guint32 slots_unknown = 0;
+static const guint32 slots_empty = 1;
+
+/* 32-bit FNV-1a */
+static void
+digest_bytes (guint32& digest, const void* data, size_t len)
+{
+    auto bytes = static_cast<const unsigned char*> (data);
+    for (size_t i = 0; i < len; ++i)
+    {
+        digest ^= bytes[i];
+        digest *= 16777619u;
+    }
+}
+
+template <typename T> static void
+digest_scalar (guint32& digest, T val)
+{
+    digest_bytes (digest, &val, sizeof (val));
+}
+
+static void
+digest_string (guint32& digest, const char* str)
+{
+    size_t len = str ? strlen (str) : 0;
+    digest_scalar (digest, len);
+    if (len)
+        digest_bytes (digest, str, len);
+}
+
+static void digest_frame (guint32& digest, const KvpFrame* frame);
+
+static void
+digest_value (guint32& digest, const KvpValue* value)
+{
+    auto type = value->get_type ();
+    digest_scalar (digest, static_cast<int> (type));
+    switch (type)
+    {
+    case KvpValue::Type::INT64:
+        digest_scalar (digest, value->get<int64_t> ());
+        break;
+    case KvpValue::Type::DOUBLE:
+        digest_scalar (digest, value->get<double> ());
+        break;
+    case KvpValue::Type::NUMERIC:
+    {
+        auto num = value->get<gnc_numeric> ();
+        digest_scalar (digest, num.num);
+        digest_scalar (digest, num.denom);
+    }
+    break;
+    case KvpValue::Type::STRING:
+        digest_string (digest, value->get<const char*> ());
+        break;
+    case KvpValue::Type::GUID:
+    {
+        auto guid = value->get<GncGUID*> ();
+        if (guid)
+            digest_bytes (digest, guid->reserved, GUID_DATA_SIZE);
+    }
+    break;
+    case KvpValue::Type::TIME64:
+        digest_scalar (digest, value->get<Time64> ().t);
+        break;
+    case KvpValue::Type::GDATE:
+    {
+        auto date = value->get<GDate> ();
+        digest_scalar (digest, g_date_valid (&date) ?
+                       g_date_get_julian (&date) : 0);
+    }
+    break;
+    case KvpValue::Type::GLIST:
+    {
+        auto list = value->get<GList*> ();
+        digest_scalar (digest, g_list_length (list));
+        for (auto node = list; node; node = node->next)
+            digest_value (digest, static_cast<KvpValue*> (node->data));
+    }
+    break;
+    case KvpValue::Type::FRAME:
+        digest_frame (digest, value->get<KvpFrame*> ());
+        break;
+    default:
+        break;
+    }
+}
+
+static void
+digest_frame (guint32& digest, const KvpFrame* frame)
+{
+    if (frame != nullptr)
+        frame->for_each_slot_temp ([&digest](const char* key, KvpValue* value)
+                                   {
+                                       digest_string (digest, key);
+                                       digest_value (digest, value);
+                                   });
+    /* No key is this long, so it marks the end of a nested frame. */
+    digest_scalar (digest, SIZE_MAX);
+}
+
+static guint32
+slots_digest (QofInstance* inst)
+{
+    auto frame = qof_instance_get_slots (inst);
+    if (frame == nullptr || frame->empty ())
+        return slots_empty;
+
+    guint32 digest = 2166136261u;
+    digest_frame (digest, frame);
+    /* Keep clear of the two reserved values. */
+    return digest > slots_empty ? digest : digest + 2;
+}
+
+void
+gnc_sql_slots_set_persisted (QofInstance* inst)
+{
+    g_return_if_fail (inst != NULL);
+
+    qof_instance_set_idata (inst, slots_digest (inst));
+}
+
+void
+gnc_sql_slots_forget_persisted (QofInstance* inst)
+{
+    g_return_if_fail (inst != NULL);
+
+    qof_instance_set_idata (inst, slots_unknown);
+}
+
 gboolean
 gnc_sql_slots_save (GncSqlBackend* sql_be, const GncGUID* guid, gboolean is_infant,
                     QofInstance* inst)
@@ -658,9 +794,12 @@ gnc_sql_slots_save (GncSqlBackend* sql_be, const GncGUID* guid, gboolean is_infa
     g_return_val_if_fail (guid != NULL, FALSE);
     g_return_val_if_fail (pFrame != NULL, FALSE);
 
+    auto digest = slots_digest (inst);
     // If this is not saving into a new db, clear out the old saved slots first
     if (!sql_be->pristine() && !is_infant)
     {
+        if (qof_instance_get_idata (inst) == digest)
+            return TRUE;
         (void)gnc_sql_slots_delete (sql_be, guid);
     }
 
@@ -668,6 +807,7 @@ gnc_sql_slots_save (GncSqlBackend* sql_be, const GncGUID* guid, gboolean is_infa
     slot_info.guid = guid;
     pFrame->for_each_slot_temp (save_slot, slot_info);
 
+    qof_instance_set_idata (inst, slot_info.is_ok ? digest : slots_unknown);
     return slot_info.is_ok;
 }
 
@@ -760,6 +900,7 @@ gnc_sql_slots_load (GncSqlBackend* sql_be, QofInstance* inst)
     info.context = NONE;
 
     slots_load_info (&info);
+    gnc_sql_slots_set_persisted (inst);
 }
 
 static void
@@ -797,51 +938,28 @@ load_obj_guid (const GncSqlBackend* sql_be, GncSqlRow& row)
 
 static void
 load_slot_for_list_item (GncSqlBackend* sql_be, GncSqlRow& row,
-                         QofCollection* coll)
+                         QofInstance* inst)
 {
     slot_info_t slot_info = { NULL, NULL, TRUE, NULL, KvpValue::Type::INVALID,
                               NULL, FRAME, NULL, "" };
-    const GncGUID* guid;
-    QofInstance* inst;
 
     g_return_if_fail (sql_be != NULL);
-    g_return_if_fail (coll != NULL);
-
-    guid = load_obj_guid (sql_be, row);
-    g_assert (guid != NULL);
-    inst = qof_collection_lookup_entity (coll, guid);
+    g_return_if_fail (inst != NULL);
 
     slot_info.be = sql_be;
     slot_info.pKvpFrame = qof_instance_get_slots (inst);
     slot_info.context = NONE;
 
     gnc_sql_load_object (sql_be, row, TABLE_NAME, &slot_info, col_table);
-
-
 }
 
-static void
-load_slot_for_book_object (GncSqlBackend* sql_be, GncSqlRow& row,
-                           BookLookupFn lookup_fn)
+std::string
+gnc_sql_slots_sql_for_subquery (const std::string& subquery)
 {
-    slot_info_t slot_info = { NULL, NULL, TRUE, NULL, KvpValue::Type::INVALID,
-                              NULL, FRAME, NULL, "" };
-    const GncGUID* guid;
-    QofInstance* inst;
-
-    g_return_if_fail (sql_be != NULL);
-    g_return_if_fail (lookup_fn != NULL);
-
-    guid = load_obj_guid (sql_be, row);
-    g_return_if_fail (guid != NULL);
-    inst = lookup_fn (guid, sql_be->book());
-    if (inst == NULL) return; /* Silently bail if the guid isn't loaded yet. */
-
-    slot_info.be = sql_be;
-    slot_info.pKvpFrame = qof_instance_get_slots (inst);
-    slot_info.path.clear();
-
-    gnc_sql_load_object (sql_be, row, TABLE_NAME, &slot_info, col_table);
+    std::string pkey(obj_guid_col_table[0]->name());
+    std::string sql("SELECT * FROM " TABLE_NAME " WHERE ");
+    sql += pkey + " IN (" + subquery + ") ORDER BY " + pkey;
+    return sql;
 }
 
 /**
@@ -858,13 +976,12 @@ void gnc_sql_slots_load_for_sql_subquery (GncSqlBackend* sql_be,
                                           BookLookupFn lookup_fn)
 {
     g_return_if_fail (sql_be != NULL);
+    g_return_if_fail (lookup_fn != NULL);
 
     // Ignore empty subquery
     if (subquery.empty()) return;
 
-    std::string pkey(obj_guid_col_table[0]->name());
-    std::string sql("SELECT * FROM " TABLE_NAME " WHERE ");
-    sql += pkey + " IN (" + subquery + ")";
+    auto sql = gnc_sql_slots_sql_for_subquery (subquery);
 
     // Execute the query and load the slots
     auto stmt = sql_be->create_statement_from_sql(sql);
@@ -874,11 +991,77 @@ void gnc_sql_slots_load_for_sql_subquery (GncSqlBackend* sql_be,
         return;
     }
     auto result = sql_be->execute_select_statement(stmt);
+    GncGUID last_guid = *guid_null();
+    QofInstance* inst = nullptr;
     for (auto row : *result)
-        load_slot_for_book_object (sql_be, row, lookup_fn);
+    {
+        auto guid = load_obj_guid (sql_be, row);
+        if (!guid_equal (guid, &last_guid))
+        {
+            last_guid = *guid;
+            inst = lookup_fn (guid, sql_be->book());
+        }
+        /* Silently skip objects that aren't loaded yet. */
+        if (inst != nullptr)
+            load_slot_for_list_item (sql_be, row, inst);
+    }
     delete result;
 }
 
+/* Keep each IN list to a size every provider accepts. */
+static const size_t max_guids_per_query = 500;
+
+void
+gnc_sql_slots_load_for_instancevec (GncSqlBackend* sql_be,
+                                    const InstanceVec& instances)
+{
+    g_return_if_fail (sql_be != NULL);
+
+    if (instances.empty()) return;
+
+    auto coll = qof_instance_get_collection (instances.front());
+    std::string pkey(obj_guid_col_table[0]->name());
+    for (auto begin = instances.begin(); begin != instances.end();)
+    {
+        auto count = MIN (max_guids_per_query,
+                          static_cast<size_t>(instances.end() - begin));
+        InstanceVec chunk{begin, begin + count};
+        begin += count;
+
+        std::stringstream sql;
+        sql << "SELECT * FROM " TABLE_NAME " WHERE " << pkey << " IN (";
+        gnc_sql_append_guids_to_sql (sql, chunk);
+        sql << ") ORDER BY " << pkey;
+
+        auto stmt = sql_be->create_statement_from_sql(sql.str());
+        if (stmt == nullptr)
+        {
+            PERR ("stmt == NULL, SQL = '%s'\n", sql.str().c_str());
+            return;
+        }
+        auto result = sql_be->execute_select_statement(stmt);
+
+        /* The rows come grouped by object, so look each one up only once. */
+        GncGUID last_guid = *guid_null();
+        QofInstance* inst = nullptr;
+        for (auto row : *result)
+        {
+            auto guid = load_obj_guid (sql_be, row);
+            if (!guid_equal (guid, &last_guid))
+            {
+                last_guid = *guid;
+                inst = qof_collection_lookup_entity (coll, guid);
+            }
+            if (inst != nullptr)
+                load_slot_for_list_item (sql_be, row, inst);
+        }
+        delete result;
+    }
+
+    for (auto inst : instances)
+        gnc_sql_slots_set_persisted (inst);
+}
+
 /* ================================================================= */
 void
 GncSqlSlotsBackend::create_tables (GncSqlBackend* sql_be)
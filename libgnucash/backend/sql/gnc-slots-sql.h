@@ -92,6 +92,47 @@ void gnc_sql_slots_load_for_sql_subquery (GncSqlBackend* sql_be,
                                           const std::string subquery,
                                           BookLookupFn lookup_fn);
 
+/**
+ * gnc_sql_slots_sql_for_subquery - The SELECT statement that
+ * gnc_sql_slots_load_for_sql_subquery executes for a subquery.
+ *
+ * @param subquery Subquery SQL string
+ * @return The SQL statement
+ */
+std::string gnc_sql_slots_sql_for_subquery (const std::string& subquery);
+
+/**
+ * gnc_sql_slots_load_for_instancevec - Loads slots for all of the instances,
+ * which must all be in the same collection, with one query per 500 of
+ * them rather than one per instance.
+ *
+ * @param sql_be SQL backend
+ * @param instances The instances whose slots are to be loaded
+ */
+void gnc_sql_slots_load_for_instancevec (GncSqlBackend* sql_be,
+                                         const InstanceVec& instances);
+
+/**
+ * gnc_sql_slots_set_persisted - Records that the instance's slots are the
+ * ones in the db, so that gnc_sql_slots_save can skip rewriting them as
+ * long as they stay the same.  gnc_sql_slots_load and
+ * gnc_sql_slots_load_for_instancevec do this themselves; callers of
+ * gnc_sql_slots_load_for_sql_subquery must do it for the instances whose
+ * slots they know to be completely loaded.
+ *
+ * @param inst The QofInstance owning the slots.
+ */
+void gnc_sql_slots_set_persisted (QofInstance* inst);
+
+/**
+ * gnc_sql_slots_forget_persisted - Makes the next gnc_sql_slots_save for the
+ * instance rewrite its slots, e.g. after the commit that saved them was
+ * rolled back.
+ *
+ * @param inst The QofInstance owning the slots.
+ */
+void gnc_sql_slots_forget_persisted (QofInstance* inst);
+
 void gnc_sql_init_slots_handler (void);
 
 #endif /* GNC_SLOTS_SQL_H */
@@ -32,13 +32,17 @@ extern "C"
 #include <gncTaxTable.h>
 #include <gncInvoice.h>
 #include <gnc-pricedb.h>
+#include <gnc-features.h>
+#include <gnc-book-archive.h>
 }
 
 #include <algorithm>
 #include <cassert>
+#include <cstring>
 
 #include "gnc-sql-connection.hpp"
 #include "gnc-sql-backend.hpp"
+#include "gnc-sql-commit-writer.hpp"
 #include "gnc-sql-object-backend.hpp"
 #include "gnc-sql-column-table-entry.hpp"
 #include "gnc-sql-result.hpp"
@@ -46,6 +50,7 @@ extern "C"
 #include "gnc-account-sql.h"
 #include "gnc-book-sql.h"
 #include "gnc-budget-sql.h"
+#include "gnc-change-log-sql.h"
 #include "gnc-commodity-sql.h"
 #include "gnc-lots-sql.h"
 #include "gnc-price-sql.h"
@@ -69,6 +74,11 @@ static QofLogModule log_module = G_LOG_DOMAIN;
 #define MAX_TABLE_NAME_LEN 50
 #define TABLE_COL_NAME "table_name"
 #define VERSION_COL_NAME "table_version"
+/* The versions table entry recording that GUID columns have a native type. */
+#define NATIVE_GUIDS_VERSION_NAME "Gnucash-Native-GUIDs"
+/* How many commits may wait for the background writer before committing
+ * waits for it too. */
+#define MAX_QUEUED_COMMITS 64
 
 using StrVec = std::vector<std::string>;
 
@@ -82,19 +92,84 @@ static EntryVec version_table
 
 GncSqlBackend::GncSqlBackend(GncSqlConnection *conn, QofBook* book) :
     QofBackend {}, m_conn{conn}, m_book{book}, m_loading{false},
-    m_in_query{false}, m_is_pristine_db{false}
+    m_in_query{false}, m_is_pristine_db{false},
+    m_change_log{std::make_shared<GncSqlChangeLogBackend>()}
 {
+    m_backend_registry.register_backend(m_change_log);
     if (conn != nullptr)
         connect (conn);
 }
 
+GncSqlBackend::~GncSqlBackend() = default;
+
 void
 GncSqlBackend::connect(GncSqlConnection *conn) noexcept
 {
+    if (m_writer)
+    {
+        wait_for_commits();
+        m_writer.reset();
+    }
     if (m_conn != nullptr && m_conn != conn)
         delete m_conn;
     finalize_version_info();
+    m_saved_commodities.clear();
     m_conn = conn;
+    if (m_conn != nullptr && gnc_prefs_get_sql_async_commit())
+        m_writer.reset(new GncSqlCommitWriter(m_conn, MAX_QUEUED_COMMITS));
+}
+
+/* The objects whose commits failed were already marked clean, so the best
+ * that can be done is to say so and leave the book dirty. */
+static void
+report_writer_failure (QofBook* book)
+{
+    PERR ("Committed objects failed to be written to the database");
+    if (book)
+        qof_book_mark_session_dirty (book);
+    gnc_engine_signal_commit_error (ERR_BACKEND_SERVER_ERR);
+}
+
+bool
+GncSqlBackend::wait_for_commits() const noexcept
+{
+    if (!m_writer || m_writer->flush())
+        return true;
+    report_writer_failure (m_book);
+    return false;
+}
+
+/* A deferred commit that has to read from the database can't leave its
+ * statements to the writer any more: they're run here, in the commit's
+ * own database transaction, after everything the writer still has. */
+bool
+GncSqlBackend::stop_deferring() const noexcept
+{
+    wait_for_commits();
+    if (!m_deferring)
+        return true;
+
+    m_deferring = false;
+    auto statements = std::move (m_deferred);
+    m_deferred.clear();
+    if (!m_conn->begin_transaction ())
+    {
+        PERR ("begin_transaction failed\n");
+        m_commit_failed = true;
+        return false;
+    }
+    for (const auto& sql : statements)
+    {
+        auto stmt = m_conn->create_statement_from_sql (sql);
+        if (stmt == nullptr || m_conn->execute_nonselect_statement (stmt) == -1)
+        {
+            PERR ("SQL error: %s\n", sql.c_str());
+            (void)m_conn->rollback_transaction ();
+            m_commit_failed = true;
+            return false;
+        }
+    }
+    return true;
 }
 
 GncSqlStatementPtr
@@ -112,6 +187,9 @@ GncSqlBackend::create_statement_from_sql(const std::string& str) const noexcept
 GncSqlResultPtr
 GncSqlBackend::execute_select_statement(const GncSqlStatementPtr& stmt) const noexcept
 {
+    /* The query may look for rows that are still held back. */
+    flush_inserts ();
+    stop_deferring ();
     auto result = m_conn ? m_conn->execute_select_statement(stmt) : nullptr;
     if (result == nullptr)
     {
@@ -124,7 +202,18 @@ GncSqlBackend::execute_select_statement(const GncSqlStatementPtr& stmt) const no
 int
 GncSqlBackend::execute_nonselect_statement(const GncSqlStatementPtr& stmt) const noexcept
 {
-    int result = m_conn ? m_conn->execute_nonselect_statement(stmt) : -1;
+    flush_inserts ();
+    if (m_deferring)
+    {
+        m_deferred.emplace_back (stmt->to_sql());
+        return 0;
+    }
+    int result = -1;
+    if (m_conn && !m_commit_failed)
+    {
+        wait_for_commits ();
+        result = m_conn->execute_nonselect_statement(stmt);
+    }
     if (result == -1)
     {
         PERR ("SQL error: %s\n", stmt->to_sql());
@@ -142,6 +231,16 @@ GncSqlBackend::quote_string(const std::string& str) const noexcept
     return m_conn->quote_string(str);
 }
 
+/* Give the columns of a database without native GUIDs the text type they
+ * always had. */
+static void
+store_guids_as_text (ColVec& info_vec)
+{
+    for (auto& info : info_vec)
+        if (info.m_type == BCT_GUID)
+            info.m_type = BCT_STRING;
+}
+
 bool
 GncSqlBackend::create_table(const std::string& table_name,
                             const EntryVec& col_table) const noexcept
@@ -154,6 +253,8 @@ GncSqlBackend::create_table(const std::string& table_name,
     {
         table_row->add_to_table (info_vec);
     }
+    if (!m_native_guids)
+        store_guids_as_text (info_vec);
     return m_conn->create_table (table_name, info_vec);
 
 }
@@ -173,9 +274,33 @@ GncSqlBackend::create_index(const std::string& index_name,
                             const EntryVec& col_table) const noexcept
 {
     g_return_val_if_fail (m_conn != nullptr, false);
+    if (m_defer_indexes)
+    {
+        m_deferred_indexes.push_back ({index_name, table_name, col_table});
+        return true;
+    }
     return m_conn->create_index(index_name, table_name, col_table);
 }
 
+bool
+GncSqlBackend::create_deferred_indexes() noexcept
+{
+    g_return_val_if_fail (m_conn != nullptr, false);
+
+    auto is_ok = true;
+    m_defer_indexes = false;
+    for (auto const& index : m_deferred_indexes)
+    {
+        if (!m_conn->create_index (index.name, index.table, index.columns))
+        {
+            PERR ("Unable to create index %s\n", index.name.c_str());
+            is_ok = false;
+        }
+    }
+    m_deferred_indexes.clear ();
+    return is_ok;
+}
+
 bool
 GncSqlBackend::add_columns_to_table(const std::string& table_name,
                                     const EntryVec& col_table) const noexcept
@@ -188,6 +313,8 @@ GncSqlBackend::add_columns_to_table(const std::string& table_name,
     {
         table_row->add_to_table (info_vec);
     }
+    if (!m_native_guids)
+        store_guids_as_text (info_vec);
     return m_conn->add_columns_to_table(table_name, info_vec);
 }
 
@@ -223,6 +350,34 @@ static const StrVec fixed_load_order
 static const StrVec business_fixed_load_order =
 { GNC_ID_BILLTERM, GNC_ID_TAXTABLE, GNC_ID_INVOICE };
 
+/* Objects whose load_all() reads their whole table and then its slots, the
+ * two queries that prefetch_queries() asks for.  None of them depends on
+ * another's rows to be fetched, only to be inserted into the engine. */
+static const StrVec prefetch_load_types =
+{
+    GNC_ID_COMMODITY, GNC_ID_ACCOUNT, GNC_ID_LOT, GNC_ID_PRICE, GNC_ID_BUDGET,
+    GNC_ID_SCHEDXACTION, GNC_ID_BILLTERM, GNC_ID_TAXTABLE, GNC_ID_INVOICE,
+    GNC_ID_ENTRY, GNC_ID_CUSTOMER, GNC_ID_EMPLOYEE, GNC_ID_JOB, GNC_ID_ORDER,
+    GNC_ID_VENDOR
+};
+
+std::vector<std::string>
+GncSqlBackend::prefetch_queries () const
+{
+    std::vector<std::string> queries;
+    for (auto type : prefetch_load_types)
+    {
+        auto obe = m_backend_registry.get_object_backend (type);
+        if (!obe || obe->table_name ().empty ())
+            continue;
+        auto& table = obe->table_name ();
+        queries.push_back ("SELECT * FROM " + table);
+        queries.push_back (gnc_sql_slots_sql_for_subquery (
+                               "SELECT DISTINCT guid FROM " + table));
+    }
+    return queries;
+}
+
 void
 GncSqlBackend::ObjectBackendRegistry::load_remaining(GncSqlBackend* sql_be)
 {
@@ -279,6 +434,8 @@ GncSqlBackend::load (QofBook* book, QofBackendLoadType loadType)
 
     ENTER ("sql_be=%p, book=%p", this, book);
 
+    wait_for_commits ();
+
     m_loading = TRUE;
 
     if (loadType == LOAD_TYPE_INITIAL_LOAD)
@@ -286,13 +443,33 @@ GncSqlBackend::load (QofBook* book, QofBackendLoadType loadType)
         assert (m_book == nullptr);
         m_book = book;
 
+        /* Leave all transactions in the database until they're needed, or
+         * those of closed years. */
+        auto on_demand = gnc_prefs_get_sql_load_on_demand ();
+        auto archive_years = gnc_prefs_get_file_archive_years ();
+        if (archive_years > 0 && !on_demand)
+        {
+            GDate* date = gnc_g_date_new_today ();
+            qof_book_set_archive_date (book,
+                                       gnc_dmy2time64 (1, 1, g_date_get_year (date) -
+                                                       archive_years + 1));
+            g_date_free (date);
+        }
+
         auto num_types = m_backend_registry.size();
         auto num_done = 0;
 
+        /* Fetch the tables of the objects that are loaded in full all at
+         * once, which on a remote server is much faster than waiting for
+         * each in turn. */
+        m_conn->prefetch (prefetch_queries ());
+
         /* Load any initial stuff. Some of this needs to happen in a certain order */
         for (auto type : fixed_load_order)
         {
             num_done++;
+            if (on_demand && type == GNC_ID_TRANS)
+                continue;
             auto obe = m_backend_registry.get_object_backend(type);
             if (obe)
             {
@@ -316,6 +493,18 @@ GncSqlBackend::load (QofBook* book, QofBackendLoadType loadType)
                                        nullptr);
 
         m_backend_registry.load_remaining(this);
+        m_conn->end_prefetch ();
+
+        /* Those left in the database below add to these. */
+        gnc_book_archive_set_start_balances (book);
+
+        if (on_demand)
+        {
+            gnc_sql_transaction_set_pending_balances (this);
+            m_txns_pending = true;
+        }
+        else if (qof_book_get_archive_date (book) != G_MININT64)
+            gnc_sql_transaction_set_archive_balances (this);
 
         gnc_account_foreach_descendant(root, (AccountCb)xaccAccountCommitEdit,
                                        nullptr);
@@ -323,17 +512,25 @@ GncSqlBackend::load (QofBook* book, QofBackendLoadType loadType)
     else if (loadType == LOAD_TYPE_LOAD_ALL)
     {
         // Load all transactions
-        auto obe = m_backend_registry.get_object_backend (GNC_ID_TRANS);
-        obe->load_all (this);
+        if (qof_book_get_archive_date (m_book) != G_MININT64)
+        {
+            gnc_sql_transaction_load_archived (this);
+        }
+        else
+        {
+            auto obe = m_backend_registry.get_object_backend (GNC_ID_TRANS);
+            obe->load_all (this);
+        }
+        m_txns_pending = false;
     }
 
     m_loading = FALSE;
-    std::for_each(m_postload_commodities.begin(), m_postload_commodities.end(),
-                 [](gnc_commodity* comm) {
-                      gnc_commodity_begin_edit(comm);
-                      gnc_commodity_commit_edit(comm);
-                  });
-    m_postload_commodities.clear();
+    commit_postload_commodities();
+
+    /* Older versions would write splits without updating the balances. */
+    if (loadType == LOAD_TYPE_INITIAL_LOAD &&
+        gnc_sql_transaction_balances_maintained (this))
+        gnc_features_set_used (book, GNC_FEATURE_SQL_ACCOUNT_BALANCES);
 
     /* Mark the sessoion as clean -- though it should never be marked
      * dirty with this backend
@@ -461,18 +658,96 @@ GncSqlBackend::sync(QofBook* book)
     g_return_if_fail (book != NULL);
     g_return_if_fail (m_conn != nullptr);
 
-    reset_version_info();
     ENTER ("book=%p, sql_be->book=%p", book, m_book);
+    auto is_ok = begin_sync (book);
+    finish_sync (book, is_ok);
+    LEAVE ("book=%p", book);
+}
+
+bool
+GncSqlBackend::begin_stream(QofBook* book)
+{
+    g_return_val_if_fail (book != NULL, false);
+    g_return_val_if_fail (m_conn != nullptr, false);
+
+    ENTER ("book=%p", book);
+    if (!begin_sync (book))
+    {
+        finish_sync (book, false);
+        LEAVE ("failed");
+        return false;
+    }
+    /* The streaming backend commits what it reads; that mustn't write it
+     * again, nor must destroying what stream_instance() wrote delete it. */
+    m_loading = TRUE;
+    LEAVE ("");
+    return true;
+}
+
+bool
+GncSqlBackend::stream_instance(QofInstance* inst)
+{
+    g_return_val_if_fail (GNC_IS_TRANSACTION (inst), false);
+
+    auto obe = m_backend_registry.get_object_backend(GNC_ID_TRANS);
+    write_objects_t data{this, true, obe.get()};
+    write_tx (GNC_TRANSACTION (inst), &data);
+    if (data.is_ok && !m_insert_failed)
+        return true;
+    /* Keeps end_stream() from committing a book with this missing. */
+    set_error (ERR_BACKEND_SERVER_ERR);
+    return false;
+}
+
+bool
+GncSqlBackend::end_stream(QofBook* book, bool complete)
+{
+    g_return_val_if_fail (book != NULL, false);
+
+    ENTER ("book=%p, complete=%d", book, complete);
+    m_loading = FALSE;
+    auto is_ok = finish_sync (book, complete && !check_error ());
+    LEAVE ("");
+    return is_ok;
+}
+
+/* Prepare the database for sync(): empty tables, without their indexes,
+ * and an open transaction for writing the book. */
+bool
+GncSqlBackend::begin_sync(QofBook* book) noexcept
+{
+    wait_for_commits ();
+    m_saved_commodities.clear();
+    reset_version_info();
     update_progress(101.0);
 
+    /* A new database is the only chance to choose the GUID columns' type. */
+    m_native_guids = gnc_prefs_get_sql_native_guids () &&
+        m_conn->has_native_guids ();
+    if (m_native_guids)
+    {
+        set_table_version (NATIVE_GUIDS_VERSION_NAME, 1);
+        gnc_features_set_used (book, GNC_FEATURE_SQL_NATIVE_GUIDS);
+    }
+
     /* Create new tables */
     m_is_pristine_db = true;
+    m_defer_indexes = true;
     create_tables();
+    auto is_ok = gnc_sql_transaction_create_balances (this, book);
 
-    /* Save all contents */
     m_book = book;
-    auto is_ok = m_conn->begin_transaction();
+    is_ok = is_ok && m_conn->begin_transaction();
+    m_rows_per_insert = MAX (gnc_prefs_get_sql_insert_rows (), 1);
+    m_insert_failed = false;
+    return is_ok;
+}
 
+/* Write what's in the book to the database begin_sync() prepared, or when
+ * is_ok is false just abandon it. */
+bool
+GncSqlBackend::finish_sync(QofBook* book, bool is_ok) noexcept
+{
     // FIXME: should write the set of commodities that are used
     // write_commodities(sql_be, book);
     if (is_ok)
@@ -502,9 +777,30 @@ GncSqlBackend::sync(QofBook* book)
             std::get<1>(entry)->write (this);
     }
     if (is_ok)
+    {
+        is_ok = flush_inserts () && !m_insert_failed;
+    }
+    if (is_ok)
+    {
+        is_ok = gnc_sql_transaction_fill_balances (this);
+    }
+    m_rows_per_insert = 1;
+    m_pending_inserts.clear ();
+    if (is_ok)
     {
         is_ok = m_conn->commit_transaction();
     }
+    /* After the commit, as in MySQL CREATE INDEX would commit the
+     * transaction itself. */
+    if (is_ok)
+    {
+        is_ok = create_deferred_indexes();
+    }
+    else
+    {
+        m_defer_indexes = false;
+        m_deferred_indexes.clear ();
+    }
     if (is_ok)
     {
         m_is_pristine_db = false;
@@ -520,7 +816,7 @@ GncSqlBackend::sync(QofBook* book)
         m_conn->rollback_transaction ();
     }
     finish_progress();
-    LEAVE ("book=%p", book);
+    return is_ok;
 }
 
 /* ================================================================= */
@@ -544,12 +840,96 @@ GncSqlBackend::rollback(QofInstance* inst)
     //LEAVE ("");
 }
 
+/* The objects created while loading are already in the database, so they
+ * are loaded like at the start: without committing them or telling anyone
+ * about them.  Dropping the events also gets query caches refreshed. */
+void
+GncSqlBackend::load_pending (const std::vector<Account*>& accounts)
+{
+    m_loading = TRUE;
+    qof_event_suspend ();
+    gnc_sql_transaction_load_pending (this, accounts);
+    qof_event_resume ();
+    m_loading = FALSE;
+}
+
+void
+GncSqlBackend::load_on_demand (QofInstance* inst)
+{
+    g_return_if_fail (inst != NULL);
+
+    /* Nothing is pending during the initial load. */
+    if (!m_txns_pending || m_loading || !GNC_IS_ACCOUNT (inst))
+        return;
+    load_pending ({GNC_ACCOUNT (inst)});
+}
+
+void
+GncSqlBackend::load_for_query (QofBook* book, QofQuery* query)
+{
+    g_return_if_fail (query != NULL);
+
+    if (m_loading || book != m_book)
+        return;
+    auto archived = gnc_sql_transaction_query_reaches_archive (this, query);
+    if (!m_txns_pending && !archived)
+        return;
+    m_loading = TRUE;
+    qof_event_suspend ();
+    if (archived)
+        gnc_sql_transaction_load_archived (this);
+    if (m_txns_pending)
+        gnc_sql_transaction_load_for_query (this, query);
+    qof_event_resume ();
+    m_loading = FALSE;
+}
+
+bool
+GncSqlBackend::events_pending ()
+{
+    if (!gnc_prefs_get_sql_change_log () || m_conn == nullptr ||
+        m_book == nullptr || m_loading || m_in_batch)
+        return false;
+    if (m_txns_pending || qof_book_get_archive_date (m_book) != G_MININT64)
+        return false;
+    return m_change_log->poll (this);
+}
+
+/* As during the initial load, nothing loaded is written back. */
+bool
+GncSqlBackend::process_events ()
+{
+    g_return_val_if_fail (m_book != nullptr, false);
+
+    m_loading = TRUE;
+    m_change_log->apply (this);
+    m_loading = FALSE;
+    /* Left for a session that may write to fix up, as on loading. */
+    if (qof_book_is_readonly (m_book))
+        m_postload_commodities.clear ();
+    else
+        commit_postload_commodities ();
+    qof_book_mark_session_saved (m_book);
+    return false;
+}
+
 void
 GncSqlBackend::commodity_for_postload_processing(gnc_commodity* commodity)
 {
     m_postload_commodities.push_back(commodity);
 }
 
+void
+GncSqlBackend::commit_postload_commodities() noexcept
+{
+    std::for_each(m_postload_commodities.begin(), m_postload_commodities.end(),
+                 [](gnc_commodity* comm) {
+                      gnc_commodity_begin_edit(comm);
+                      gnc_commodity_commit_edit(comm);
+                  });
+    m_postload_commodities.clear();
+}
+
 GncSqlObjectBackendPtr
 GncSqlBackend::get_object_backend(const std::string& type) const noexcept
 {
@@ -571,19 +951,24 @@ GncSqlBackend::commit (QofInstance* inst)
     g_return_if_fail (inst != NULL);
     g_return_if_fail (m_conn != nullptr);
 
-    if (qof_book_is_readonly(m_book))
-    {
-        set_error (ERR_BACKEND_READONLY);
-        (void)m_conn->rollback_transaction ();
-        return;
-    }
+    if (m_writer && m_writer->failed ())
+        report_writer_failure (m_book);
+
     /* During initial load where objects are being created, don't commit
-    anything, but do mark the object as clean. */
+    anything, but do mark the object as clean.  The same goes for loading
+    other sessions' changes, which a read-only session does too. */
     if (m_loading)
     {
         qof_instance_mark_clean (inst);
         return;
     }
+    if (qof_book_is_readonly(m_book))
+    {
+        set_error (ERR_BACKEND_READONLY);
+        wait_for_commits ();
+        (void)m_conn->rollback_transaction ();
+        return;
+    }
 
     // The engine has a PriceDB object but it isn't in the database
     if (strcmp (inst->e_type, "PriceDB") == 0)
@@ -609,7 +994,10 @@ GncSqlBackend::commit (QofInstance* inst)
         return;
     }
 
-    if (!m_conn->begin_transaction ())
+    if (is_destroying && GNC_IS_COMMODITY (inst))
+        m_saved_commodities.erase (GNC_COMMODITY (inst));
+
+    if (!begin_commit ())
     {
         PERR ("begin_transaction failed\n");
         LEAVE ("Rolled back - database transaction begin error");
@@ -620,11 +1008,15 @@ GncSqlBackend::commit (QofInstance* inst)
 
     auto obe = m_backend_registry.get_object_backend(std::string{inst->e_type});
     if (obe != nullptr)
-        is_ok = obe->commit(this, inst);
+    {
+        is_ok = obe->commit(this, inst) && !m_commit_failed;
+        if (is_ok && gnc_prefs_get_sql_change_log())
+            is_ok = m_change_log->record(this, inst) && !m_commit_failed;
+    }
     else
     {
         PERR ("Unknown object type '%s'\n", inst->e_type);
-        (void)m_conn->rollback_transaction ();
+        rollback_commit ();
 
         // Don't let unknown items still mark the book as being dirty
         qof_book_mark_session_saved(m_book);
@@ -635,14 +1027,17 @@ GncSqlBackend::commit (QofInstance* inst)
     if (!is_ok)
     {
         // Error - roll it back
-        (void)m_conn->rollback_transaction();
+        rollback_commit ();
+        /* The commodities it saved may be gone again, and so may its slots. */
+        m_saved_commodities.clear ();
+        gnc_sql_slots_forget_persisted (inst);
 
         // This *should* leave things marked dirty
         LEAVE ("Rolled back - database error");
         return;
     }
 
-    (void)m_conn->commit_transaction ();
+    end_commit ();
 
     qof_book_mark_session_saved(m_book);
     qof_instance_mark_clean (inst);
@@ -650,6 +1045,77 @@ GncSqlBackend::commit (QofInstance* inst)
     LEAVE ("");
 }
 
+/* With a background writer, a commit outside a batch only collects its
+ * statements, for end_commit() to pass them on; see stop_deferring() for
+ * the commits that can't.  Within a batch the commits go straight into the
+ * batch's database transaction. */
+bool
+GncSqlBackend::begin_commit () noexcept
+{
+    m_commit_failed = false;
+    if (m_writer && !m_in_batch)
+    {
+        m_deferring = true;
+        m_deferred.clear();
+        return true;
+    }
+    wait_for_commits ();
+    return m_conn->begin_transaction ();
+}
+
+void
+GncSqlBackend::rollback_commit () noexcept
+{
+    if (m_deferring)
+    {
+        m_deferring = false;
+        m_deferred.clear();
+    }
+    else if (!m_commit_failed)
+        (void)m_conn->rollback_transaction ();
+    m_commit_failed = false;
+}
+
+void
+GncSqlBackend::end_commit () noexcept
+{
+    if (m_deferring)
+    {
+        m_deferring = false;
+        m_writer->push (std::move (m_deferred));
+        m_deferred.clear();
+    }
+    else
+        (void)m_conn->commit_transaction ();
+}
+
+void
+GncSqlBackend::begin_batch ()
+{
+    g_return_if_fail (m_conn != nullptr);
+    if (m_in_batch || m_loading || qof_book_is_readonly (m_book))
+        return;
+    wait_for_commits ();
+    m_in_batch = m_conn->begin_transaction ();
+    if (!m_in_batch)
+        PERR ("begin_transaction failed, committing unbatched");
+}
+
+void
+GncSqlBackend::end_batch ()
+{
+    if (!m_in_batch)
+        return;
+    m_in_batch = false;
+    g_return_if_fail (m_conn != nullptr);
+    if (!m_conn->commit_transaction ())
+    {
+        /* The batch's commits already marked their instances clean. */
+        PERR ("commit of the batch transaction failed");
+        qof_book_mark_session_dirty (m_book);
+    }
+}
+
 
 /**
  * Sees if the version table exists, and if it does, loads the info into
@@ -673,6 +1139,7 @@ GncSqlBackend::init_version_info() noexcept
             unsigned int version = row.get_int_at_col (VERSION_COL_NAME);
             m_versions.push_back(std::make_pair(name, version));
         }
+        m_native_guids = get_table_version (NATIVE_GUIDS_VERSION_NAME) > 0;
     }
     else
     {
@@ -852,6 +1319,8 @@ GncSqlBackend::do_db_operation (E_DB_OPERATION op, const char* table_name,
     switch(op)
     {
         case  OP_DB_INSERT:
+        if (m_rows_per_insert > 1)
+            return queue_insert (table_name, obj_name, pObject, table);
         stmt = build_insert_statement (table_name, obj_name, pObject, table);
         break;
         case OP_DB_UPDATE:
@@ -860,6 +1329,9 @@ GncSqlBackend::do_db_operation (E_DB_OPERATION op, const char* table_name,
         case OP_DB_DELETE:
         stmt = build_delete_statement (table_name, obj_name, pObject, table);
         break;
+        case OP_DB_UPSERT:
+        stmt = build_upsert_statement (table_name, obj_name, pObject, table);
+        break;
     }
     if (stmt == nullptr)
         return false;
@@ -870,11 +1342,63 @@ bool
 GncSqlBackend::save_commodity(gnc_commodity* comm) noexcept
 {
     if (comm == nullptr) return false;
+    /* Every transaction commit gets here with its currency, so remember
+     * which commodities are in the database instead of asking it. */
+    if (m_saved_commodities.count (comm))
+        return true;
     QofInstance* inst = QOF_INSTANCE(comm);
     auto obe = m_backend_registry.get_object_backend(std::string(inst->e_type));
+    auto is_ok = true;
     if (obe && !obe->instance_in_db(this, inst))
-        return obe->commit(this, inst);
-    return true;
+        is_ok = obe->commit(this, inst);
+    if (is_ok)
+        m_saved_commodities.insert (comm);
+    return is_ok;
+}
+
+/* The statements below are built by appending to a reserved string
+ * rather than through an ostringstream: they are made once per object
+ * saved, and the stream's locale-aware formatting buys nothing for text
+ * that is already formatted. */
+static size_t
+values_length (const PairVec& values)
+{
+    size_t length = 0;
+    for (auto const& col_value : values)
+        length += col_value.first.size () + col_value.second.size () + 2;
+    return length;
+}
+
+static void
+append_list (std::string& sql, const PairVec& values,
+             std::string PairVec::value_type::* member)
+{
+    sql += '(';
+    for (auto const& col_value : values)
+    {
+        if (&col_value != &values.front ())
+            sql += ',';
+        sql += col_value.*member;
+    }
+    sql += ')';
+}
+
+static std::string
+insert_columns (const PairVec& values)
+{
+    std::string sql;
+    sql.reserve (values_length (values));
+    append_list (sql, values, &PairVec::value_type::first);
+    return sql;
+}
+
+static std::string
+insert_row (const PairVec& values)
+{
+    std::string sql;
+    sql.reserve (values_length (values));
+    append_list (sql, values, &PairVec::value_type::second);
+    return sql;
 }
 
 GncSqlStatementPtr
@@ -883,34 +1407,162 @@ GncSqlBackend::build_insert_statement (const char* table_name,
                                        gpointer pObject,
                                        const EntryVec& table) const noexcept
 {
-    GncSqlStatementPtr stmt;
-    PairVec col_values;
-    std::ostringstream sql;
+    g_return_val_if_fail (table_name != nullptr, nullptr);
+    g_return_val_if_fail (obj_name != nullptr, nullptr);
+    g_return_val_if_fail (pObject != nullptr, nullptr);
+    PairVec values{get_object_values(obj_name, pObject, table)};
+
+    std::string sql{"INSERT INTO "};
+    sql.reserve (32 + strlen (table_name) + values_length (values));
+    sql += table_name;
+    append_list (sql, values, &PairVec::value_type::first);
+    sql += " VALUES";
+    append_list (sql, values, &PairVec::value_type::second);
+
+    return create_statement_from_sql(sql);
+}
 
+GncSqlStatementPtr
+GncSqlBackend::build_upsert_statement (const char* table_name,
+                                       QofIdTypeConst obj_name,
+                                       gpointer pObject,
+                                       const EntryVec& table) const noexcept
+{
     g_return_val_if_fail (table_name != nullptr, nullptr);
     g_return_val_if_fail (obj_name != nullptr, nullptr);
     g_return_val_if_fail (pObject != nullptr, nullptr);
+    g_return_val_if_fail (m_conn != nullptr, nullptr);
     PairVec values{get_object_values(obj_name, pObject, table)};
+    g_return_val_if_fail (!values.empty(), nullptr);
+
+    std::string sql{"INSERT INTO "};
+    sql.reserve (32 + strlen (table_name) + 2 * values_length (values));
+    sql += table_name;
+    append_list (sql, values, &PairVec::value_type::first);
+    sql += " VALUES";
+    append_list (sql, values, &PairVec::value_type::second);
+
+    /* The first column is the primary key. */
+    std::vector<std::string> columns;
+    columns.reserve (values.size());
+    for (auto it = values.begin() + 1; it != values.end(); ++it)
+        columns.push_back (it->first);
+    m_conn->make_upsert (sql, values.front().first, columns);
+
+    return create_statement_from_sql(sql);
+}
 
-    sql << "INSERT INTO " << table_name <<"(";
-    for (auto const& col_value : values)
+/* Hold the row back to be sent with others for the same table in one
+ * multi-row INSERT. */
+bool
+GncSqlBackend::queue_insert (const char* table_name, QofIdTypeConst obj_name,
+                             gpointer pObject,
+                             const EntryVec& table) const noexcept
+{
+    PairVec values{get_object_values(obj_name, pObject, table)};
+    auto columns = insert_columns (values);
+    auto& pending = m_pending_inserts[table_name];
+
+    if (!pending.rows.empty () && pending.columns != columns)
     {
-        if (col_value != *values.begin())
-            sql << ",";
-        sql << col_value.first;
+        /* Rows in one statement must have the same columns. */
+        if (!flush_inserts ())
+            return false;
     }
+    pending.columns = std::move (columns);
+    pending.rows.push_back (insert_row (values));
+    if (pending.rows.size () >= m_rows_per_insert)
+        return flush_inserts ();
+    return true;
+}
 
-    sql << ") VALUES(";
-    for (auto col_value : values)
+/* Send the rows queue_insert() held back.  Called before any other
+ * statement, so that it sees the database as if every insert had been
+ * done at once.  A failure is also remembered for sync() to find, as
+ * the statement that caused the flush can't report it. */
+bool
+GncSqlBackend::flush_inserts () const noexcept
+{
+    auto is_ok = true;
+    for (auto& entry : m_pending_inserts)
     {
-        if (col_value != *values.begin())
-            sql << ",";
-        sql << col_value.second;
+        auto& pending = entry.second;
+        if (pending.rows.empty ())
+            continue;
+
+        auto length = 32 + entry.first.size () + pending.columns.size ();
+        for (auto const& row : pending.rows)
+            length += row.size () + 1;
+
+        std::string sql{"INSERT INTO "};
+        sql.reserve (length);
+        sql += entry.first;
+        sql += pending.columns;
+        sql += " VALUES";
+        for (auto const& row : pending.rows)
+        {
+            if (&row != &pending.rows.front ())
+                sql += ',';
+            sql += row;
+        }
+        pending.rows.clear ();
+
+        auto stmt = create_statement_from_sql (sql);
+        if (stmt == nullptr || !m_conn ||
+            m_conn->execute_nonselect_statement (stmt) == -1)
+        {
+            PERR ("SQL error: %s\n", stmt ? stmt->to_sql () : "");
+            qof_backend_set_error ((QofBackend*)this, ERR_BACKEND_SERVER_ERR);
+            m_insert_failed = true;
+            is_ok = false;
+        }
     }
-    sql << ")";
+    return is_ok;
+}
 
-    stmt = create_statement_from_sql(sql.str());
-    return stmt;
+bool
+GncSqlBackend::do_db_bulk_insert (const char* table_name,
+                                  QofIdTypeConst obj_name,
+                                  const std::vector<gpointer>& objects,
+                                  const EntryVec& table) const noexcept
+{
+    g_return_val_if_fail (table_name != nullptr, false);
+    g_return_val_if_fail (obj_name != nullptr, false);
+
+    /* sync() already holds rows back for multi-row INSERTs. */
+    if (m_rows_per_insert > 1)
+    {
+        for (auto object : objects)
+            if (!queue_insert (table_name, obj_name, object, table))
+                return false;
+        return true;
+    }
+
+    size_t rows_per_insert = MAX (gnc_prefs_get_sql_insert_rows (), 1);
+    for (auto it = objects.begin (); it != objects.end ();)
+    {
+        auto end = it + MIN (rows_per_insert, size_t(objects.end () - it));
+        std::string sql{"INSERT INTO "};
+        sql += table_name;
+        for (auto row = it; row != end; ++row)
+        {
+            PairVec values{get_object_values (obj_name, *row, table)};
+            if (row == it)
+            {
+                sql += insert_columns (values);
+                sql += " VALUES";
+            }
+            else
+                sql += ',';
+            sql += insert_row (values);
+        }
+        it = end;
+
+        auto stmt = create_statement_from_sql (sql);
+        if (stmt == nullptr || execute_nonselect_statement (stmt) == -1)
+            return false;
+    }
+    return true;
 }
 
 GncSqlStatementPtr
@@ -918,9 +1570,6 @@ GncSqlBackend::build_update_statement(const gchar* table_name,
                                       QofIdTypeConst obj_name, gpointer pObject,
                                       const EntryVec& table) const noexcept
 {
-    GncSqlStatementPtr stmt;
-    std::ostringstream sql;
-
     g_return_val_if_fail (table_name != nullptr, nullptr);
     g_return_val_if_fail (obj_name != nullptr, nullptr);
     g_return_val_if_fail (pObject != nullptr, nullptr);
@@ -929,17 +1578,21 @@ GncSqlBackend::build_update_statement(const gchar* table_name,
     PairVec values{get_object_values (obj_name, pObject, table)};
 
     // Create the SQL statement
-    sql <<  "UPDATE " << table_name << " SET ";
+    std::string sql{"UPDATE "};
+    sql.reserve (32 + strlen (table_name) + values_length (values));
+    sql += table_name;
+    sql += " SET ";
 
     for (auto const& col_value : values)
     {
-        if (col_value != *values.begin())
-            sql << ",";
-        sql << col_value.first << "=" <<
-            col_value.second;
+        if (&col_value != &values.front ())
+            sql += ',';
+        sql += col_value.first;
+        sql += '=';
+        sql += col_value.second;
     }
 
-    stmt = create_statement_from_sql(sql.str());
+    auto stmt = create_statement_from_sql(sql);
     /* We want our where condition to be just the first column and
      * value, i.e. the guid of the object.
      */
@@ -954,14 +1607,13 @@ GncSqlBackend::build_delete_statement(const gchar* table_name,
                                       gpointer pObject,
                                       const EntryVec& table) const noexcept
 {
-    std::ostringstream sql;
-
     g_return_val_if_fail (table_name != nullptr, nullptr);
     g_return_val_if_fail (obj_name != nullptr, nullptr);
     g_return_val_if_fail (pObject != nullptr, nullptr);
 
-    sql << "DELETE FROM " << table_name;
-    auto stmt = create_statement_from_sql (sql.str());
+    std::string sql{"DELETE FROM "};
+    sql += table_name;
+    auto stmt = create_statement_from_sql (sql);
 
     /* WHERE */
     PairVec values;
@@ -31,7 +31,10 @@ extern "C"
 }
 #include <memory>
 #include <exception>
+#include <map>
+#include <set>
 #include <sstream>
+#include <string>
 #include <vector>
 #include <qof-backend.hpp>
 
@@ -43,6 +46,8 @@ using GncSqlObjectBackendPtr = std::shared_ptr<GncSqlObjectBackend>;
 using OBEEntry = std::tuple<std::string, GncSqlObjectBackendPtr>;
 using OBEVec = std::vector<OBEEntry>;
 class GncSqlConnection;
+class GncSqlCommitWriter;
+class GncSqlChangeLogBackend;
 class GncSqlStatement;
 using GncSqlStatementPtr = std::unique_ptr<GncSqlStatement>;
 class GncSqlResult;
@@ -55,18 +60,27 @@ typedef enum
 {
     OP_DB_INSERT,
     OP_DB_UPDATE,
-    OP_DB_DELETE
+    OP_DB_DELETE,
+    OP_DB_UPSERT    /**< Insert, or update the row already there */
 } E_DB_OPERATION;
 
 /**
  *
  * Main SQL backend structure.
+ *
+ * With the "sql-change-log" preference each commit of a transaction,
+ * account or commodity is noted in the database's change log, and
+ * events_pending() reads the changes other sessions on the database noted,
+ * which process_events() loads.  libdbi doesn't expose PostgreSQL's
+ * notifications, so the log is polled, and it works the same with every
+ * database.  The lock still admits one writer per book; the others are
+ * those opened read-only or despite the lock.
  */
 class GncSqlBackend : public QofBackend
 {
 public:
     GncSqlBackend(GncSqlConnection *conn, QofBook* book);
-    virtual ~GncSqlBackend() = default;
+    virtual ~GncSqlBackend();
     /**
      * Load the contents of an SQL database into a book.
      *
@@ -79,6 +93,13 @@ public:
      * @param book Book to be saved
      */
     void sync(QofBook*) override;
+    /**
+     * Fill a new database with a book as another backend reads it.  Only
+     * transactions are streamed; the rest is written by end_stream().
+     */
+    bool begin_stream(QofBook*) override;
+    bool stream_instance(QofInstance*) override;
+    bool end_stream(QofBook*, bool complete) override;
     /**
      * An object is about to be edited.
      *
@@ -97,9 +118,37 @@ public:
      * @param inst Object being edited
      */
     void rollback(QofInstance*) override;
+    /**
+     * Load the transactions of an account whose splits are pending.
+     *
+     * @param inst The account
+     */
+    void load_on_demand(QofInstance*) override;
+    /**
+     * Load the pending transactions a query could find.
+     */
+    void load_for_query(QofBook*, QofQuery*) override;
+    /**
+     * Whether other sessions logged changes this one hasn't loaded.  Only
+     * with the "sql-change-log" preference, and not while transactions
+     * are left in the database: their accounts' starting balances would
+     * have to follow.
+     */
+    bool events_pending() override;
+    /**
+     * Load the changes events_pending() found.
+     */
+    bool process_events() override;
+    /**
+     * Run the commits up to end_batch() in one database transaction; each
+     * commit becomes a savepoint within it.
+     */
+    void begin_batch() override;
+    void end_batch() override;
     /** Connect the backend to a GncSqlConnection.
      * Sets up version info. Calling with nullptr clears the connection and
-     * destroys the version info.
+     * destroys the version info.  Commits still being written in the
+     * background are written to the old connection first.
      */
     void connect(GncSqlConnection *conn) noexcept;
     /**
@@ -157,6 +206,13 @@ public:
     bool create_index(const std::string& index_name,
                       const std::string& table_name,
                       const EntryVec& col_table) const noexcept;
+    /**
+     * Creates the indexes create_index() held back while sync() filled the
+     * new tables.
+     *
+     * @return TRUE if successful, FALSE if unsuccessful
+     */
+    bool create_deferred_indexes() noexcept;
     /**
      * Adds one or more columns to an existing table.
      *
@@ -226,6 +282,19 @@ public:
     bool do_db_operation (E_DB_OPERATION op, const char* table_name,
                           QofIdTypeConst obj_name, gpointer pObject,
                           const EntryVec& table) const noexcept;
+    /**
+     * Inserts a row for each of the objects, with as many rows to a
+     * statement as the sql-insert-rows preference allows.
+     *
+     * @param table_name SQL table name
+     * @param obj_name QOF object type name
+     * @param objects The objects, all of the same type
+     * @param table DB table description
+     * @return TRUE if successful, FALSE if not
+     */
+    bool do_db_bulk_insert (const char* table_name, QofIdTypeConst obj_name,
+                            const std::vector<gpointer>& objects,
+                            const EntryVec& table) const noexcept;
     /**
      * Ensure that a commodity referenced in another object is in fact saved
      * in the database.
@@ -237,8 +306,20 @@ public:
     QofBook* book() const noexcept { return m_book; }
     void set_loading(bool loading) noexcept { m_loading = loading; }
     bool pristine() const noexcept { return m_is_pristine_db; }
+    /** Whether the database keeps GUIDs in columns of a type of its own
+     * instead of as text. */
+    bool native_guids() const noexcept { return m_native_guids; }
     void update_progress(double pct) const noexcept;
     void finish_progress() const noexcept;
+    /**
+     * Wait until the commits being written in the background are in the
+     * database.  Everything but commit() does this before using the
+     * connection.
+     *
+     * @return false if any of them failed, which is also reported as
+     * ERR_BACKEND_SERVER_ERR.
+     */
+    bool wait_for_commits() const noexcept;
 
 protected:
     GncSqlConnection* m_conn = nullptr;  /**< SQL connection */
@@ -246,6 +327,14 @@ protected:
     bool m_loading;        /**< We are performing an initial load */
     bool m_in_query;       /**< We are processing a query */
     bool m_is_pristine_db; /**< Are we saving to a new pristine db? */
+    bool m_in_batch = false; /**< A batch transaction is open */
+    bool m_native_guids = false; /**< BCT_GUID columns keep their type */
+    /** Transactions were left in the database, to be loaded on demand */
+    bool m_txns_pending = false;
+    /** Rows per INSERT statement while sync() fills a new database; 1
+     * outside it.  Rows are held back per table until there are this
+     * many, or until any other statement is run. */
+    size_t m_rows_per_insert = 1;
     const char* m_time_format = nullptr; /**< Server-specific date-time string format */
     VersionVec m_versions;    /**< Version number for each table */
 private:
@@ -254,10 +343,26 @@ private:
     bool write_transactions();
     bool write_template_transactions();
     bool write_schedXactions();
+    void load_pending(const std::vector<Account*>& accounts);
+    std::vector<std::string> prefetch_queries() const;
+    bool begin_sync(QofBook*) noexcept;
+    bool finish_sync(QofBook*, bool is_ok) noexcept;
+    bool begin_commit() noexcept;
+    void rollback_commit() noexcept;
+    void end_commit() noexcept;
+    bool stop_deferring() const noexcept;
+    void commit_postload_commodities() noexcept;
     GncSqlStatementPtr build_insert_statement (const char* table_name,
                                                QofIdTypeConst obj_name,
                                                gpointer pObject,
                                                const EntryVec& table) const noexcept;
+    bool queue_insert (const char* table_name, QofIdTypeConst obj_name,
+                       gpointer pObject, const EntryVec& table) const noexcept;
+    bool flush_inserts () const noexcept;
+    GncSqlStatementPtr build_upsert_statement (const char* table_name,
+                                               QofIdTypeConst obj_name,
+                                               gpointer pObject,
+                                               const EntryVec& table) const noexcept;
     GncSqlStatementPtr build_update_statement (const gchar* table_name,
                                                QofIdTypeConst obj_name,
                                                gpointer pObject,
@@ -287,7 +392,38 @@ private:
         OBEVec m_registry;
     };
     ObjectBackendRegistry m_backend_registry;
+    /* Also in m_backend_registry, which creates and reads its table. */
+    std::shared_ptr<GncSqlChangeLogBackend> m_change_log;
     std::vector<gnc_commodity*> m_postload_commodities;
+    /* The commodities save_commodity() has found or put in the database. */
+    std::set<const gnc_commodity*> m_saved_commodities;
+    /* The rows queue_insert() is holding back, by table. */
+    struct PendingInserts
+    {
+        std::string columns;
+        std::vector<std::string> rows;
+    };
+    mutable std::map<std::string, PendingInserts> m_pending_inserts;
+    /* Indexes sync() creates only after filling their tables, which is
+     * faster than updating them row by row. */
+    struct DeferredIndex
+    {
+        std::string name;
+        std::string table;
+        EntryVec columns;
+    };
+    bool m_defer_indexes = false;
+    mutable std::vector<DeferredIndex> m_deferred_indexes;
+    mutable bool m_insert_failed = false;
+    /* Writes commits in the background when the "sql-async-commit"
+     * preference was set on connecting.  While m_deferring, commit()
+     * collects its statements in m_deferred for it instead of running
+     * them.  m_commit_failed stops a commit after its database
+     * transaction had to be rolled back. */
+    std::unique_ptr<GncSqlCommitWriter> m_writer;
+    mutable bool m_deferring = false;
+    mutable std::vector<std::string> m_deferred;
+    mutable bool m_commit_failed = false;
 };
 
 #endif //__GNC_SQL_BACKEND_HPP__
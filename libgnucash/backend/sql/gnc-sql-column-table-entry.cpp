@@ -110,7 +110,7 @@ GncSqlColumnTableEntry::add_objectref_guid_to_query (QofIdTypeConst obj_name,
 void
 GncSqlColumnTableEntry::add_objectref_guid_to_table (ColVec& vec) const noexcept
 {
-    GncSqlColumnInfo info{*this, BCT_STRING, GUID_ENCODING_LENGTH, FALSE};
+    GncSqlColumnInfo info{*this, BCT_GUID, GUID_ENCODING_LENGTH, FALSE};
     vec.emplace_back(std::move(info));
 }
 
@@ -127,8 +127,8 @@ GncSqlColumnTableEntryImpl<CT_STRING>::load (const GncSqlBackend* sql_be,
 
     try
     {
-        auto s = row.get_string_at_col (m_col_name);
-        set_parameter(pObject, s.c_str(), get_setter(obj_name), m_gobj_param_name);
+        auto s = row.get_string_view_at_col (m_col_name);
+        set_parameter(pObject, s.data(), get_setter(obj_name), m_gobj_param_name);
     }
     catch (std::invalid_argument&) {}
 }
@@ -326,28 +326,25 @@ GncSqlColumnTableEntryImpl<CT_GUID>::load (const GncSqlBackend* sql_be,
 {
 
     GncGUID guid;
-    const GncGUID* pGuid;
 
     g_return_if_fail (pObject != NULL);
     g_return_if_fail (m_gobj_param_name != nullptr || get_setter(obj_name) != nullptr);
 
-    std::string str;
     try
     {
-        str = row.get_string_at_col(m_col_name);
+        guid = row.get_guid_at_col (m_col_name);
     }
     catch (std::invalid_argument&)
     {
         return;
     }
-    if (string_to_guid (str.c_str(), &guid))
-        set_parameter(pObject, &guid, get_setter(obj_name), m_gobj_param_name);
+    set_parameter(pObject, &guid, get_setter(obj_name), m_gobj_param_name);
 }
 
 template<> void
 GncSqlColumnTableEntryImpl<CT_GUID>::add_to_table(ColVec& vec) const noexcept
 {
-    GncSqlColumnInfo info{*this, BCT_STRING, GUID_ENCODING_LENGTH, FALSE};
+    GncSqlColumnInfo info{*this, BCT_GUID, GUID_ENCODING_LENGTH, FALSE};
     vec.emplace_back(std::move(info));
 }
 
@@ -565,15 +562,16 @@ GncSqlColumnTableEntryImpl<CT_NUMERIC>::load (const GncSqlBackend* sql_be,
     g_return_if_fail (pObject != NULL);
     g_return_if_fail (m_gobj_param_name != nullptr || get_setter(obj_name) != nullptr);
     gnc_numeric n;
+    /* Column names are far shorter than this; build them without
+     * allocating for every row. */
+    char buf[128];
     try
     {
-        auto buf = g_strdup_printf ("%s_num", m_col_name);
+        g_snprintf (buf, sizeof (buf), "%s_num", m_col_name);
         auto num = row.get_int_at_col (buf);
-        g_free (buf);
-        buf = g_strdup_printf ("%s_denom", m_col_name);
+        g_snprintf (buf, sizeof (buf), "%s_denom", m_col_name);
         auto denom = row.get_int_at_col (buf);
         n = gnc_numeric_create (num, denom);
-        g_free (buf);
     }
     catch (std::invalid_argument&)
     {
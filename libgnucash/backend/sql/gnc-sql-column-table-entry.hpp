@@ -52,7 +52,9 @@ typedef enum
     BCT_INT64,
     BCT_DATE,
     BCT_DOUBLE,
-    BCT_DATETIME
+    BCT_DATETIME,
+    BCT_GUID        /**< A GncGUID, stored as text unless the database has
+                     * native GUIDs, see GncSqlBackend::native_guids() */
 } GncSqlBasicColumnType;
 
 enum ColumnFlags : int
@@ -191,15 +193,11 @@ public:
 
             try
             {
-                GncGUID guid;
-                auto val = row.get_string_at_col (m_col_name);
-                if (string_to_guid (val.c_str(), &guid))
-                {
-                    auto target = get_ref(&guid);
-                    if (target != nullptr)
-                        set_parameter (pObject, target, get_setter(obj_name),
-                                       m_gobj_param_name);
-                }
+                auto guid = row.get_guid_at_col (m_col_name);
+                auto target = get_ref(&guid);
+                if (target != nullptr)
+                    set_parameter (pObject, target, get_setter(obj_name),
+                                   m_gobj_param_name);
             }
             catch (std::invalid_argument&) {}
         }
@@ -0,0 +1,126 @@
+/***********************************************************************\
+ * gnc-sql-commit-writer.cpp: Run SQL commits in a thread.             *
+ *                                                                     *
+ * This program is free software; you can redistribute it and/or       *
+ * modify it under the terms of the GNU General Public License as      *
+ * published by the Free Software Foundation; either version 2 of      *
+ * the License, or (at your option) any later version.                 *
+ *                                                                     *
+ * This program is distributed in the hope that it will be useful,     *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of      *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the       *
+ * GNU General Public License for more details.                        *
+ *                                                                     *
+ * You should have received a copy of the GNU General Public License   *
+ * along with this program; if not, contact:                           *
+ *                                                                     *
+ * Free Software Foundation           Voice:  +1-617-542-5942          *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652          *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                      *
+\***********************************************************************/
+
+extern "C"
+{
+#include <config.h>
+#include <qof.h>
+}
+#include "gnc-sql-commit-writer.hpp"
+#include "gnc-sql-connection.hpp"
+
+static QofLogModule log_module = G_LOG_DOMAIN;
+
+GncSqlCommitWriter::GncSqlCommitWriter(GncSqlConnection* conn,
+                                       size_t max_queued) :
+    m_conn{conn}, m_max_queued{max_queued > 0 ? max_queued : 1}
+{
+    m_thread = std::thread ([this] { run (); });
+}
+
+GncSqlCommitWriter::~GncSqlCommitWriter()
+{
+    {
+        std::lock_guard<std::mutex> lock (m_mutex);
+        m_stop = true;
+    }
+    m_cond.notify_all ();
+    m_thread.join ();
+    if (m_failed)
+        PERR ("Committed objects weren't all written to the database");
+}
+
+void
+GncSqlCommitWriter::push(std::vector<std::string>&& statements)
+{
+    if (statements.empty())
+        return;
+    std::unique_lock<std::mutex> lock (m_mutex);
+    m_cond.wait (lock, [this] { return m_queue.size() < m_max_queued; });
+    m_queue.push_back (std::move (statements));
+    lock.unlock ();
+    m_cond.notify_all ();
+}
+
+bool
+GncSqlCommitWriter::flush()
+{
+    std::unique_lock<std::mutex> lock (m_mutex);
+    m_cond.wait (lock, [this] { return m_queue.empty() && !m_busy; });
+    auto ok = !m_failed;
+    m_failed = false;
+    return ok;
+}
+
+bool
+GncSqlCommitWriter::failed()
+{
+    std::lock_guard<std::mutex> lock (m_mutex);
+    auto failed = m_failed;
+    m_failed = false;
+    return failed;
+}
+
+void
+GncSqlCommitWriter::run()
+{
+    std::unique_lock<std::mutex> lock (m_mutex);
+    while (true)
+    {
+        m_cond.wait (lock, [this] { return m_stop || !m_queue.empty(); });
+        if (m_queue.empty())
+            break;
+        auto statements = std::move (m_queue.front());
+        m_queue.pop_front ();
+        m_busy = true;
+        lock.unlock ();
+        m_cond.notify_all ();
+
+        auto ok = write (statements);
+
+        lock.lock ();
+        m_busy = false;
+        if (!ok)
+            m_failed = true;
+        m_cond.notify_all ();
+    }
+}
+
+bool
+GncSqlCommitWriter::write(const std::vector<std::string>& statements)
+{
+    if (!m_conn->begin_transaction ())
+    {
+        PERR ("begin_transaction failed\n");
+        return false;
+    }
+    for (const auto& sql : statements)
+    {
+        auto stmt = m_conn->create_statement_from_sql (sql);
+        if (stmt == nullptr || m_conn->execute_nonselect_statement (stmt) == -1)
+        {
+            PERR ("SQL error: %s\n", sql.c_str());
+            (void)m_conn->rollback_transaction ();
+            return false;
+        }
+    }
+    return m_conn->commit_transaction ();
+}
@@ -0,0 +1,79 @@
+/***********************************************************************\
+ * gnc-sql-commit-writer.hpp: Run SQL commits in a thread.             *
+ *                                                                     *
+ * This program is free software; you can redistribute it and/or       *
+ * modify it under the terms of the GNU General Public License as      *
+ * published by the Free Software Foundation; either version 2 of      *
+ * the License, or (at your option) any later version.                 *
+ *                                                                     *
+ * This program is distributed in the hope that it will be useful,     *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of      *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the       *
+ * GNU General Public License for more details.                        *
+ *                                                                     *
+ * You should have received a copy of the GNU General Public License   *
+ * along with this program; if not, contact:                           *
+ *                                                                     *
+ * Free Software Foundation           Voice:  +1-617-542-5942          *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652          *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                      *
+\***********************************************************************/
+
+#ifndef __GNC_SQL_COMMIT_WRITER_HPP__
+#define __GNC_SQL_COMMIT_WRITER_HPP__
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class GncSqlConnection;
+
+/**
+ * Runs the statements of committed objects on a thread of its own, so that
+ * committing doesn't wait for the database.  Each commit's statements are
+ * run in order in a database transaction of their own, and the commits in
+ * the order they were pushed.
+ *
+ * The writer uses its owner's connection, which the owner must not use
+ * itself until flush() has returned.
+ */
+class GncSqlCommitWriter
+{
+public:
+    /** @param max_queued The number of commits push() lets wait before it
+     * blocks until the writer catches up. */
+    GncSqlCommitWriter(GncSqlConnection* conn, size_t max_queued);
+    /** Writes whatever is still queued before returning. */
+    ~GncSqlCommitWriter();
+    GncSqlCommitWriter(const GncSqlCommitWriter&) = delete;
+    GncSqlCommitWriter& operator=(const GncSqlCommitWriter&) = delete;
+
+    /** Queue the statements of one commit. */
+    void push(std::vector<std::string>&& statements);
+    /** Wait until every queued commit has been written.
+     * @return false if any commit failed since the last call to flush() or
+     * failed(). */
+    bool flush();
+    /** Whether any commit failed since the last call to flush() or
+     * failed(), without waiting. */
+    bool failed();
+
+private:
+    void run();
+    bool write(const std::vector<std::string>& statements);
+
+    GncSqlConnection* m_conn;
+    size_t m_max_queued;
+    std::deque<std::vector<std::string>> m_queue;
+    bool m_busy = false;
+    bool m_stop = false;
+    bool m_failed = false;
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    std::thread m_thread;
+};
+
+#endif //__GNC_SQL_COMMIT_WRITER_HPP__
@@ -89,6 +89,16 @@ public:
         const noexcept = 0;
     virtual std::string quote_string (const std::string&)
         const noexcept = 0;
+    /** Turn an INSERT statement into one that updates the row instead if
+     * one with the same primary key exists.
+     *
+     * @param sql The INSERT statement, changed in place
+     * @param key The primary key column
+     * @param columns The other inserted columns, to be updated
+     */
+    virtual void make_upsert (std::string& sql, const std::string& key,
+                              const std::vector<std::string>& columns)
+        const noexcept = 0;
     /** Get the connection error value.
      * If not 0 will normally be meaningless outside of implementation code.
      */
@@ -97,7 +107,18 @@ public:
                            bool retry) noexcept = 0;
     virtual bool verify() noexcept = 0;
     virtual bool retry_connection(const char* msg) noexcept = 0;
-
+    /** Run SELECT statements ahead of time, concurrently if the connection
+     * can, so that executing one of them later returns the stored result
+     * instead of querying the database again.  What isn't fetched is simply
+     * queried when it's executed.  Does nothing by default.
+     */
+    virtual void prefetch (const std::vector<std::string>&) noexcept {}
+    /** Drop the prefetched results that weren't used.  No result of an
+     * earlier prefetch may be alive. */
+    virtual void end_prefetch () noexcept {}
+    /** Whether the database can keep BCT_GUID columns in a GUID type of its
+     * own rather than as text.  Queries still give GUIDs as quoted hex. */
+    virtual bool has_native_guids () const noexcept { return false; }
 };
 
 
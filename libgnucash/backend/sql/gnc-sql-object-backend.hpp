@@ -90,6 +90,11 @@ public:
      * @return m_type_name.
      */
     const char* type () const noexcept { return m_type_name.c_str(); }
+    /**
+     * Return the name of the table holding the objects, or an empty string if
+     * there's none.
+     */
+    const std::string& table_name () const noexcept { return m_table_name; }
     /**
      * Compare a version with the compiled version (m_version).
      * @return true if they match.
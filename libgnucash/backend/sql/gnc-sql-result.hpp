@@ -29,7 +29,9 @@ extern "C"
 #include <qof.h>
 }
 #include <cstdint>
+#include <stdexcept>
 #include <string>
+#include <string_view>
 #include <vector>
 
 class GncSqlRow;
@@ -55,6 +57,7 @@ protected:
         virtual double get_float_at_col (const char* col) const = 0;
         virtual double get_double_at_col (const char* col) const = 0;
         virtual std::string get_string_at_col (const char* col) const = 0;
+        virtual std::string_view get_string_view_at_col (const char* col) const = 0;
         virtual time64 get_time64_at_col (const char* col) const = 0;
         virtual bool is_col_null (const char* col) const noexcept = 0;
     };
@@ -94,6 +97,17 @@ public:
         return m_iter->get_double_at_col (col); }
     std::string get_string_at_col (const char* col) const {
         return m_iter->get_string_at_col (col); }
+    /** The column's text without copying it.  The view points into the
+     * result, is NUL-terminated and is only valid until the row advances. */
+    std::string_view get_string_view_at_col (const char* col) const {
+        return m_iter->get_string_view_at_col (col); }
+    /** Decode a GUID column straight from the result's text. */
+    GncGUID get_guid_at_col (const char* col) const {
+        GncGUID guid;
+        if (!string_to_guid (get_string_view_at_col (col).data(), &guid))
+            throw (std::invalid_argument{"Requested GUID from non-GUID column."});
+        return guid;
+    }
     time64 get_time64_at_col (const char* col) const {
         return m_iter->get_time64_at_col (col); }
     bool is_col_null (const char* col) const noexcept {
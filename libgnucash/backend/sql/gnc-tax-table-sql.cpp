@@ -246,7 +246,8 @@ load_taxtable_entries (GncSqlBackend* sql_be, GncTaxTable* tt)
 
 static void
 load_single_taxtable (GncSqlBackend* sql_be, GncSqlRow& row,
-                      TaxTblParentGuidVec& l_tt_needing_parents)
+                      TaxTblParentGuidVec& l_tt_needing_parents,
+                      InstanceVec& instances)
 {
     const GncGUID* guid;
     GncTaxTable* tt;
@@ -260,7 +261,7 @@ load_single_taxtable (GncSqlBackend* sql_be, GncSqlRow& row,
         tt = gncTaxTableCreate (sql_be->book());
     }
     gnc_sql_load_object (sql_be, row, GNC_ID_TAXTABLE, tt, tt_col_table);
-    gnc_sql_slots_load (sql_be, QOF_INSTANCE (tt));
+    instances.push_back (QOF_INSTANCE (tt));
     load_taxtable_entries (sql_be, tt);
 
     /* If the tax table doesn't have a parent, it might be because it hasn't
@@ -294,9 +295,11 @@ GncSqlTaxTableBackend::load_all (GncSqlBackend* sql_be)
     auto stmt = sql_be->create_statement_from_sql(sql.str());
     auto result = sql_be->execute_select_statement(stmt);
     TaxTblParentGuidVec tt_needing_parents;
+    InstanceVec instances;
 
     for (auto row : *result)
-        load_single_taxtable (sql_be, row, tt_needing_parents);
+        load_single_taxtable (sql_be, row, tt_needing_parents, instances);
+    gnc_sql_slots_load_for_instancevec (sql_be, instances);
 
     /* While there are items on the list of taxtables needing parents,
        try to see if the parent has now been loaded.  Theory says that if
@@ -43,16 +43,19 @@ extern "C"
 #include "engine-helpers.h"
 #include "gnc-commodity.h"
 #include "gnc-engine.h"
+#include <gnc-features.h>
+#include <gnc-book-archive.h>
 
 #ifdef S_SPLINT_S
 #include "splint-defs.h"
 #endif
 }
 
+#include <map>
+#include <set>
 #include <string>
-#include <sstream>
+#include <cmath>
 
-#include "escape.h"
 
 #include <gnc-datetime.hpp>
 #include "gnc-sql-connection.hpp"
@@ -70,7 +73,9 @@ static QofLogModule log_module = G_LOG_DOMAIN;
 #define TRANSACTION_TABLE "transactions"
 #define TX_TABLE_VERSION 4
 #define SPLIT_TABLE "splits"
-#define SPLIT_TABLE_VERSION 5
+#define SPLIT_TABLE_VERSION 6
+#define BALANCE_TABLE "account_balances"
+#define BALANCE_TABLE_VERSION 1
 
 struct split_info_t : public write_objects_t
 {
@@ -141,6 +146,42 @@ static const EntryVec tx_guid_col_table
     gnc_sql_make_table_entry<CT_GUID>("tx_guid", 0, 0, "guid"),
 };
 
+/* Indexes and the queries they serve:
+ *  tx_post_date_index (transactions.post_date): the archive and date
+ *    range selectors of lazy loading and of translated queries.
+ *  splits_tx_guid_index (splits.tx_guid): loading the splits, and
+ *    through them the slots, of a set of transactions.
+ *  splits_account_guid_index (splits.account_guid): queries matching
+ *    on the account alone.
+ *  splits_account_tx_index (splits.account_guid, splits.tx_guid): the
+ *    "SELECT DISTINCT tx_guid FROM splits WHERE account_guid IN (...)"
+ *    subqueries that load an account's transactions on demand, answered
+ *    from the index without reading the split rows.
+ * Slots are fetched by obj_guid, which slots_guid_index covers. */
+static const EntryVec account_tx_guid_col_table
+{
+    gnc_sql_make_table_entry<CT_ACCOUNTREF>("account_guid", 0, COL_NNUL,
+                                            "account"),
+    gnc_sql_make_table_entry<CT_GUID>("tx_guid", 0, 0, "guid"),
+};
+
+/* The sums of the split quantities of each account by reconcile state.
+ * Splits are summed per denominator so that the sums stay exact. */
+static const EntryVec balance_col_table
+{
+    gnc_sql_make_table_entry<CT_GUID>("account_guid", 0, COL_NNUL),
+    gnc_sql_make_table_entry<CT_STRING>("reconcile_state", 1, COL_NNUL),
+    gnc_sql_make_table_entry<CT_INT64>("quantity_denom", 0, COL_NNUL),
+    gnc_sql_make_table_entry<CT_INT64>("quantity_num", 0, COL_NNUL),
+};
+
+static const EntryVec balance_key_col_table
+{
+    gnc_sql_make_table_entry<CT_GUID>("account_guid", 0, COL_NNUL),
+    gnc_sql_make_table_entry<CT_STRING>("reconcile_state", 1, COL_NNUL),
+    gnc_sql_make_table_entry<CT_INT64>("quantity_denom", 0, COL_NNUL),
+};
+
 GncSqlTransBackend::GncSqlTransBackend() :
     GncSqlObjectBackend(TX_TABLE_VERSION, GNC_ID_TRANS,
                         TRANSACTION_TABLE, tx_col_table) {}
@@ -385,6 +426,30 @@ query_transactions (GncSqlBackend* sql_be, std::string selector)
         }
         gnc_sql_slots_load_for_sql_subquery (sql_be, selector,
 					     (BookLookupFn)xaccTransLookup);
+
+        /* These transactions and their splits are new, so the slots just
+         * loaded are all they have in the db. */
+        for (auto instance : instances)
+        {
+            gnc_sql_slots_set_persisted (instance);
+            for (auto node = xaccTransGetSplitList (GNC_TRANSACTION(instance));
+                 node; node = node->next)
+                gnc_sql_slots_set_persisted (QOF_INSTANCE(node->data));
+        }
+    }
+
+    /* Accounts whose transactions are loaded on demand have their
+     * unloaded splits in their starting balances. */
+    for (auto instance : instances)
+    {
+        for (auto node = xaccTransGetSplitList (GNC_TRANSACTION(instance));
+             node; node = node->next)
+        {
+            auto split = GNC_SPLIT(node->data);
+            auto acct = xaccSplitGetAccount (split);
+            if (acct && gnc_account_get_splits_pending (acct))
+                gnc_account_remove_start_balance_split (acct, split);
+        }
     }
 
     // Commit all of the transactions
@@ -450,6 +515,10 @@ GncSqlSplitBackend::create_tables (GncSqlBackend* sql_be)
                                    m_table_name.c_str(),
                                    account_guid_col_table))
             PERR ("Unable to create index\n");
+        if (!sql_be->create_index("splits_account_tx_index",
+                                   m_table_name.c_str(),
+                                   account_tx_guid_col_table))
+            PERR ("Unable to create index\n");
     }
     else if (version < SPLIT_TABLE_VERSION)
     {
@@ -458,21 +527,144 @@ GncSqlSplitBackend::create_tables (GncSqlBackend* sql_be)
            1->2: 64 bit int handling
            3->4: Split reconcile date can be NULL
            4->5: Use DATETIME instead of TIMESTAMP in MySQL
+           5->6: Add splits_account_tx_index
         */
-        sql_be->upgrade_table(m_table_name.c_str(), split_col_table);
-        if (!sql_be->create_index("splits_tx_guid_index",
-                                   m_table_name.c_str(),
-                                   tx_guid_col_table))
-            PERR ("Unable to create index\n");
-        if (!sql_be->create_index("splits_account_guid_index",
+        if (version < 5)
+        {
+            sql_be->upgrade_table(m_table_name.c_str(), split_col_table);
+            if (!sql_be->create_index("splits_tx_guid_index",
+                                       m_table_name.c_str(),
+                                       tx_guid_col_table))
+                PERR ("Unable to create index\n");
+            if (!sql_be->create_index("splits_account_guid_index",
+                                       m_table_name.c_str(),
+                                       account_guid_col_table))
+                PERR ("Unable to create index\n");
+        }
+        if (!sql_be->create_index("splits_account_tx_index",
                                    m_table_name.c_str(),
-                                   account_guid_col_table))
+                                   account_tx_guid_col_table))
             PERR ("Unable to create index\n");
         sql_be->set_table_version (m_table_name.c_str(), m_version);
         PINFO ("Splits table upgraded from version %d to version %d\n", version,
                m_version);
     }
 }
+/* ================================================================= */
+/* Books using GNC_FEATURE_SQL_ACCOUNT_BALANCES keep the balance table up
+ * to date with every split written, in the same database transaction, so
+ * that opening them with their transactions left in the database needn't
+ * read the splits.  The feature keeps versions that don't maintain the
+ * table from opening the book. */
+
+bool
+gnc_sql_transaction_balances_maintained (const GncSqlBackend* sql_be)
+{
+    g_return_val_if_fail (sql_be != NULL, false);
+
+    return sql_be->get_table_version (BALANCE_TABLE) > 0;
+}
+
+static bool
+execute_balance_sql (GncSqlBackend* sql_be, const std::string& sql)
+{
+    auto stmt = sql_be->create_statement_from_sql (sql);
+    if (stmt == nullptr || sql_be->execute_nonselect_statement (stmt) == -1)
+    {
+        PERR ("SQL error: %s\n", sql.c_str());
+        return false;
+    }
+    return true;
+}
+
+/* Add the quantities of the written splits matching condition, a
+ * condition on "x", to their balances, or subtract them.  The splits'
+ * own rows supply the values, so that subtracting before a split is
+ * rewritten takes away exactly what adding had put in. */
+static bool
+update_balances (GncSqlBackend* sql_be, const std::string& condition,
+                 bool subtract)
+{
+    const std::string match{" FROM " SPLIT_TABLE " x WHERE " + condition +
+            " AND x.account_guid = " BALANCE_TABLE ".account_guid"
+            " AND x.reconcile_state = " BALANCE_TABLE ".reconcile_state"
+            " AND x.quantity_denom = " BALANCE_TABLE ".quantity_denom"};
+
+    if (!subtract)
+    {
+        std::string sql{"INSERT INTO " BALANCE_TABLE
+                " (account_guid, reconcile_state, quantity_denom, quantity_num)"
+                " SELECT DISTINCT x.account_guid, x.reconcile_state,"
+                " x.quantity_denom, 0 FROM " SPLIT_TABLE " x WHERE "};
+        sql += condition + " AND NOT EXISTS (SELECT 1 FROM " BALANCE_TABLE
+            " b WHERE b.account_guid = x.account_guid"
+            " AND b.reconcile_state = x.reconcile_state"
+            " AND b.quantity_denom = x.quantity_denom)";
+        if (!execute_balance_sql (sql_be, sql))
+            return false;
+    }
+
+    std::string sql{"UPDATE " BALANCE_TABLE " SET quantity_num = quantity_num "};
+    sql += subtract ? "-" : "+";
+    sql += " (SELECT SUM(x.quantity_num)" + match + ") WHERE EXISTS (SELECT 1" +
+        match + ")";
+    return execute_balance_sql (sql_be, sql);
+}
+
+static std::string
+split_condition (const char* col, const QofInstance* inst)
+{
+    return std::string{"x."} + col + " = '" +
+        gnc::GUID(*qof_instance_get_guid (inst)).to_string() + "'";
+}
+
+static bool
+fill_balances (GncSqlBackend* sql_be)
+{
+    return execute_balance_sql (sql_be, "DELETE FROM " BALANCE_TABLE) &&
+        execute_balance_sql (sql_be, "INSERT INTO " BALANCE_TABLE
+                             " (account_guid, reconcile_state, quantity_denom,"
+                             " quantity_num) SELECT account_guid,"
+                             " reconcile_state, quantity_denom,"
+                             " SUM(quantity_num) FROM " SPLIT_TABLE
+                             " GROUP BY account_guid, reconcile_state,"
+                             " quantity_denom");
+}
+
+static bool
+create_balance_table (GncSqlBackend* sql_be)
+{
+    if (!sql_be->create_table (BALANCE_TABLE, balance_col_table))
+        return false;
+    if (!sql_be->create_index ("account_balances_key_index", BALANCE_TABLE,
+                               balance_key_col_table))
+        PERR ("Unable to create index\n");
+    return true;
+}
+
+bool
+gnc_sql_transaction_create_balances (GncSqlBackend* sql_be, QofBook* book)
+{
+    g_return_val_if_fail (sql_be != NULL, false);
+    g_return_val_if_fail (book != NULL, false);
+
+    if (gnc_sql_transaction_balances_maintained (sql_be) ||
+        !gnc_features_check_used (book, GNC_FEATURE_SQL_ACCOUNT_BALANCES))
+        return true;
+    return create_balance_table (sql_be) &&
+        sql_be->set_table_version (BALANCE_TABLE, BALANCE_TABLE_VERSION);
+}
+
+bool
+gnc_sql_transaction_fill_balances (GncSqlBackend* sql_be)
+{
+    g_return_val_if_fail (sql_be != NULL, false);
+
+    if (!gnc_sql_transaction_balances_maintained (sql_be))
+        return true;
+    return fill_balances (sql_be);
+}
+
 /* ================================================================= */
 /**
  * Callback function to delete slots for a split
@@ -512,6 +704,10 @@ delete_splits (GncSqlBackend* sql_be, Transaction* pTx)
     g_return_val_if_fail (sql_be != NULL, FALSE);
     g_return_val_if_fail (pTx != NULL, FALSE);
 
+    if (gnc_sql_transaction_balances_maintained (sql_be) &&
+        !update_balances (sql_be, split_condition ("tx_guid", QOF_INSTANCE (pTx)),
+                          true))
+        return FALSE;
     if (!sql_be->do_db_operation(OP_DB_DELETE, SPLIT_TABLE,
                                  SPLIT_TABLE, pTx, tx_guid_col_table))
     {
@@ -564,8 +760,19 @@ GncSqlSplitBackend::commit (GncSqlBackend* sql_be, QofInstance* inst)
         qof_instance_set_guid (inst, guid);
     }
 
-    is_ok = sql_be->do_db_operation(op, SPLIT_TABLE, GNC_ID_SPLIT,
-                                    inst, split_col_table);
+    /* A new database gets its balances once all the splits are in it. */
+    auto balances = !sql_be->pristine() &&
+        gnc_sql_transaction_balances_maintained (sql_be);
+    auto condition = balances ? split_condition ("guid", inst) : "";
+    is_ok = !balances || op == OP_DB_INSERT ||
+        update_balances (sql_be, condition, true);
+
+    if (is_ok)
+        is_ok = sql_be->do_db_operation(op, SPLIT_TABLE, GNC_ID_SPLIT,
+                                        inst, split_col_table);
+
+    if (is_ok && balances && op != OP_DB_DELETE)
+        is_ok = update_balances (sql_be, condition, false);
 
     if (is_ok && !qof_instance_get_destroying (inst))
     {
@@ -705,8 +912,59 @@ void gnc_sql_transaction_load_tx_for_account (GncSqlBackend* sql_be,
     query_transactions (sql_be, sql);
 }
 
+/* A condition selecting the transactions posted before the archive date,
+ * or the rest of them, which includes those without a posted date. */
+static std::string
+archive_selector (time64 archive_date, bool archived,
+                  const std::string& table = "")
+{
+    std::string col(table.empty() ? "" : table + ".");
+    col += tx_col_table[3]->name();     //post_date
+    GncDateTime time(archive_date);
+    std::string date("'" + time.format_iso8601() + "'");
+    if (archived)
+        return col + " < " + date;
+    return "(" + col + " >= " + date + " OR " + col + " IS NULL)";
+}
+
+/* ----------------------------------------------------------------- */
+typedef struct
+{
+    gnc_numeric balance;
+    gnc_numeric noclosing_balance;
+    gnc_numeric cleared_balance;
+    gnc_numeric reconciled_balance;
+} archive_balances_t;
+
+/* The balances of the splits left in the database, on top of those of the
+ * ones moved to an archive file. */
+static void
+set_start_balances (Account* acct, const archive_balances_t& bal)
+{
+    archive_balances_t archived;
+    gnc_account_get_archived_balances (acct, &archived.balance,
+                                       &archived.cleared_balance,
+                                       &archived.reconciled_balance,
+                                       &archived.noclosing_balance);
+    auto add = [](gnc_numeric a, gnc_numeric b)
+    {
+        return gnc_numeric_add (a, b, GNC_DENOM_AUTO, GNC_HOW_DENOM_LCD);
+    };
+    gnc_account_set_start_balance (acct, add (bal.balance, archived.balance));
+    gnc_account_set_start_noclosing_balance (acct,
+                                             add (bal.noclosing_balance,
+                                                  archived.noclosing_balance));
+    gnc_account_set_start_cleared_balance (acct,
+                                           add (bal.cleared_balance,
+                                                archived.cleared_balance));
+    gnc_account_set_start_reconciled_balance (acct,
+                                              add (bal.reconciled_balance,
+                                                   archived.reconciled_balance));
+}
+
 /**
- * Loads all transactions.  This might be used during a save-as operation to ensure that
+ * Loads all transactions, or, if the book has an archive date, those posted
+ * since then.  This might be used during a save-as operation to ensure that
  * all data is in memory and ready to be saved.
  *
  * @param sql_be SQL backend
@@ -717,173 +975,378 @@ GncSqlTransBackend::load_all (GncSqlBackend* sql_be)
     g_return_if_fail (sql_be != NULL);
 
     auto root = gnc_book_get_root_account (sql_be->book());
+    auto archive_date = qof_book_get_archive_date (sql_be->book());
     gnc_account_foreach_descendant(root, (AccountCb)xaccAccountBeginEdit,
                                    nullptr);
-    query_transactions (sql_be, "");
-    gnc_account_foreach_descendant(root, (AccountCb)xaccAccountCommitEdit,
-                                   nullptr);
-}
-
-static void
-convert_query_comparison_to_sql (QofQueryPredData* pPredData,
-                                 gboolean isInverted, std::stringstream& sql)
-{
-    if (pPredData->how == QOF_COMPARE_LT
-        || (isInverted && pPredData->how == QOF_COMPARE_GTE))
-        sql << "<";
-    else if (pPredData->how == QOF_COMPARE_LTE
-             || (isInverted && pPredData->how == QOF_COMPARE_GT))
-        sql << "<=";
-    else if (pPredData->how == QOF_COMPARE_EQUAL
-             || (isInverted && pPredData->how == QOF_COMPARE_NEQ))
-        sql << "=";
-    else if (pPredData->how == QOF_COMPARE_GT
-             || (isInverted && pPredData->how == QOF_COMPARE_LTE))
-        sql << ">";
-    else if (pPredData->how == QOF_COMPARE_GTE
-             || (isInverted && pPredData->how == QOF_COMPARE_LT))
-        sql << ">=";
-    else if (pPredData->how == QOF_COMPARE_NEQ
-             || (isInverted && pPredData->how == QOF_COMPARE_EQUAL))
-        sql <<  "~=";
+    if (archive_date == G_MININT64)
+        query_transactions (sql_be, "");
     else
+        query_transactions (sql_be, archive_selector (archive_date, false));
+
+    /* Nothing is left for the accounts loading on demand. */
+    auto zero = gnc_numeric_zero ();
+    archive_balances_t none {zero, zero, zero, zero};
+    auto accounts = gnc_account_get_descendants (root);
+    for (auto node = accounts; node; node = node->next)
     {
-        PERR ("Unknown comparison type\n");
-        sql << "??";
+        auto acct = GNC_ACCOUNT (node->data);
+        if (!gnc_account_get_splits_pending (acct))
+            continue;
+        gnc_account_set_splits_pending (acct, FALSE);
+        set_start_balances (acct, none);
     }
+    g_list_free (accounts);
+    gnc_account_foreach_descendant(root, (AccountCb)xaccAccountCommitEdit,
+                                   nullptr);
 }
 
-static void
-convert_query_term_to_sql (const GncSqlBackend* sql_be, const gchar* fieldName,
-                           QofQueryTerm* pTerm, std::stringstream& sql)
+/* ----------------------------------------------------------------- */
+/* Translating split and transaction queries to SQL.
+ *
+ * A query term becomes a condition on a row of
+ * transactions t LEFT JOIN splits s which holds for at least every row
+ * whose split (or, for a transaction query, whose transaction) the term
+ * matches.  Only an exact condition, one that holds for no other rows, may
+ * be negated for an inverted term.  An empty condition holds for every row;
+ * it's what a term translates to when it can't be expressed in SQL, and
+ * loading a few transactions too many is harmless because the query is
+ * still run on them in memory afterwards.
+ */
+struct sql_condition_t
 {
-    QofQueryPredData* pPredData;
-    gboolean isInverted;
+    std::string sql;
+    bool exact;
+};
 
-    g_return_if_fail (pTerm != NULL);
+static const sql_condition_t any_row {"", false};
 
-    pPredData = qof_query_term_get_pred_data (pTerm);
-    isInverted = qof_query_term_is_inverted (pTerm);
+/* The columns of the parameter paths of a split query.  A transaction
+ * query's parameter paths are those following SPLIT_TRANS. */
+static const std::vector<std::pair<std::vector<const char*>, const char*>>
+query_columns
+{
+    {{SPLIT_TRANS, TRANS_DATE_POSTED}, "t.post_date"},
+    {{SPLIT_TRANS, TRANS_DATE_ENTERED}, "t.enter_date"},
+    {{SPLIT_TRANS, TRANS_DESCRIPTION}, "t.description"},
+    {{SPLIT_TRANS, TRANS_NUM}, "t.num"},
+    {{SPLIT_TRANS, QOF_PARAM_GUID}, "t.guid"},
+    {{SPLIT_TRANS, TRANS_SPLITLIST, SPLIT_ACCOUNT_GUID}, "t.splits"},
+    {{QOF_PARAM_GUID}, "s.guid"},
+    {{SPLIT_ACCOUNT, QOF_PARAM_GUID}, "s.account_guid"},
+    {{SPLIT_MEMO}, "s.memo"},
+    {{SPLIT_ACTION}, "s.action"},
+    {{SPLIT_RECONCILE}, "s.reconcile_state"},
+    {{SPLIT_DATE_RECONCILED}, "s.reconcile_date"},
+    {{SPLIT_VALUE}, "s.value"},
+    {{SPLIT_AMOUNT}, "s.quantity"},
+};
 
-    if (g_strcmp0 (pPredData->type_name, QOF_TYPE_GUID) == 0)
+static const char*
+query_column (GSList* path, bool trans_query)
+{
+    for (const auto& entry : query_columns)
     {
-        query_guid_t guid_data = (query_guid_t)pPredData;
-        GList* guid_entry;
-        sql << "(" << fieldName;
-
-        switch (guid_data->options)
+        auto param = entry.first.begin();
+        if (trans_query)
         {
-        case QOF_GUID_MATCH_ANY:
-            sql << (isInverted ? " NOT IN (" : " IN (");
-            break;
-
-        case QOF_GUID_MATCH_NONE:
-            sql << (isInverted ? " IN (" : " NOT IN (");
-            break;
-
-        default:
-            PERR ("Unexpected GncGUID match type: %d\n", guid_data->options);
+            if (g_strcmp0 (*param, SPLIT_TRANS) != 0)
+                continue;
+            ++param;
         }
+        auto node = path;
+        for (; node && param != entry.first.end(); node = node->next, ++param)
+            if (g_strcmp0 (static_cast<const char*>(node->data), *param) != 0)
+                break;
+        if (!node && param == entry.first.end())
+            return entry.second;
+    }
+    return nullptr;
+}
 
-        for (guid_entry = guid_data->guids; guid_entry != NULL;
-             guid_entry = guid_entry->next)
-        {
-            gchar guid_buf[GUID_ENCODING_LENGTH + 1];
+static std::string
+guid_list_sql (GList* guids)
+{
+    std::string sql("(");
+    for (auto node = guids; node; node = node->next)
+    {
+        if (node != guids)
+            sql += ",";
+        sql += "'" + gnc::GUID(*static_cast<GncGUID*>(node->data)).to_string()
+            + "'";
+    }
+    return sql + ")";
+}
 
-            if (guid_entry != guid_data->guids) sql << ",";
-            (void)guid_to_string_buff (static_cast<GncGUID*> (guid_entry->data),
-                                       guid_buf);
-            sql << guid_buf;
-        }
-        sql << "))";
+static sql_condition_t
+guid_condition (const char* column, query_guid_t data)
+{
+    std::string col(column);
+    if (col == "t.splits")
+    {
+        /* The accounts of a transaction's splits are matched against all of
+         * the GUIDs; each transaction with a split in any of the accounts
+         * will do. */
+        if (data->options != QOF_GUID_MATCH_ALL || !data->guids)
+            return any_row;
+        return {"t.guid IN (SELECT tx_guid FROM " SPLIT_TABLE
+                " WHERE account_guid IN " + guid_list_sql (data->guids) + ")",
+                false};
+    }
+    switch (data->options)
+    {
+    case QOF_GUID_MATCH_ANY:
+        if (!data->guids)
+            return {"1=0", true};
+        return {col + " IN " + guid_list_sql (data->guids), true};
+    case QOF_GUID_MATCH_NONE:
+        if (!data->guids)
+            return any_row;
+        return {col + " NOT IN " + guid_list_sql (data->guids), true};
+    default:
+        return any_row;
+    }
+}
 
+static sql_condition_t
+char_condition (const char* column, query_char_t data)
+{
+    if (!data->char_list || !*data->char_list)
+        return any_row;
+    if (data->options != QOF_CHAR_MATCH_ANY &&
+        data->options != QOF_CHAR_MATCH_NONE)
+        return any_row;
+
+    std::string sql(column);
+    sql += data->options == QOF_CHAR_MATCH_NONE ? " NOT IN (" : " IN (";
+    for (auto c = data->char_list; *c; ++c)
+    {
+        if (c != data->char_list)
+            sql += ",";
+        if (!g_ascii_isalnum (*c))
+            return any_row;
+        sql += "'";
+        sql += *c;
+        sql += "'";
     }
-    else if (g_strcmp0 (pPredData->type_name, QOF_TYPE_CHAR) == 0)
+    return {sql + ")", true};
+}
+
+/* Only what matches can be selected: matching regular expressions and
+ * negated matches are left to the in-memory query.  Case-insensitive
+ * matching is pushed down only for ASCII patterns, which LOWER() folds
+ * the same way on every server; the query's Unicode case folding can also
+ * make a few compatibility characters such as ligatures match, and rows
+ * with those are missed. */
+static sql_condition_t
+string_condition (GncSqlBackend* sql_be, const char* column,
+                  query_string_t data, bool inverted)
+{
+    auto how = data->pd.how;
+    auto negated = how == QOF_COMPARE_NEQ || how == QOF_COMPARE_NCONTAINS;
+    if (data->is_regex || negated != inverted || !data->matchstring)
+        return any_row;
+
+    std::string pattern(data->matchstring);
+    std::string col(column);
+    if (data->options == QOF_STRING_MATCH_CASEINSENSITIVE)
     {
-        query_char_t char_data = (query_char_t)pPredData;
-        int i;
+        for (auto c : pattern)
+            if (c & 0x80)
+                return any_row;
+        auto folded = g_ascii_strdown (pattern.c_str(), -1);
+        pattern = folded;
+        g_free (folded);
+        col = "LOWER(" + col + ")";
+    }
 
-        if (isInverted) sql <<  "NOT(";
-        if (char_data->options == QOF_CHAR_MATCH_NONE) sql << "NOT ";
-        sql << "(";
-        for (i = 0; char_data->char_list[i] != '\0'; i++)
-        {
-            if (i != 0) sql << " OR ";
-            sql << fieldName << " = '" << char_data->char_list[i] << "'";
-        }
-        sql << ") ";
-        if (isInverted) sql << ") ";
+    if (how == QOF_COMPARE_EQUAL || how == QOF_COMPARE_NEQ)
+    {
+        if (pattern.empty())
+            return {"(" + col + " = '' OR " + column + " IS NULL)", false};
+        return {col + " = " + sql_be->quote_string (pattern), false};
     }
-    else if (g_strcmp0 (pPredData->type_name, QOF_TYPE_STRING) == 0)
+    if (pattern.empty())
+        return any_row;
+
+    std::string like("%");
+    for (auto c : pattern)
     {
-        query_string_t string_data = (query_string_t)pPredData;
-        sqlEscape* escape = sqlEscape_new ();
+        if (c == '!' || c == '%' || c == '_')
+            like += '!';
+        like += c;
+    }
+    like += "%";
+    return {col + " LIKE " + sql_be->quote_string (like) + " ESCAPE '!'",
+            false};
+}
 
-        if (isInverted ||  pPredData->how == QOF_COMPARE_NEQ)
-            sql << "NOT(";
-        sql << fieldName;
-        if (string_data->is_regex ||
-            string_data->options == QOF_STRING_MATCH_CASEINSENSITIVE)
-        {
-            PWARN ("String is_regex || option = QOF_STRING_MATCH_INSENSITIVE\n");
-        }
-//          sql << " ~" ;
-//      } else {
-        sql << " =";
-//      }
-//      if( string_data->options == QOF_STRING_MATCH_CASEINSENSITIVE ) {
-//          sql+= "*";
-//      }
-        sql << "'" << sqlEscapeString (escape, string_data->matchstring) << "'";
-        if (pPredData->how == QOF_COMPARE_NEQ) sql << ")";
-        if (isInverted) sql << ")";
-        sqlEscape_destroy (escape);
+static std::string
+double_sql (double val)
+{
+    char buf[G_ASCII_DTOSTR_BUF_SIZE];
+    return g_ascii_dtostr (buf, sizeof (buf), val);
+}
 
+/* The query compares the absolute value of the split's value or amount,
+ * and calls amounts within 1/10000 of each other equal.  The comparison is
+ * done in floating point here and so widened a little. */
+static sql_condition_t
+numeric_condition (const char* column, query_numeric_t data, bool inverted)
+{
+    if (inverted || data->pd.how == QOF_COMPARE_NEQ)
+        return any_row;
+
+    std::string num(std::string(column) + "_num");
+    std::string denom(std::string(column) + "_denom");
+    std::string sql;
+    if (data->options == QOF_NUMERIC_MATCH_CREDIT)
+        sql = num + " <= 0 AND ";
+    else if (data->options == QOF_NUMERIC_MATCH_DEBIT)
+        sql = num + " >= 0 AND ";
+
+    auto amount = gnc_numeric_to_double (data->amount);
+    auto slack = 1e-9 * MAX (1.0, fabs (amount));
+    std::string val("ABS(1.0 * " + num + " / " + denom + ")");
+    switch (data->pd.how)
+    {
+    case QOF_COMPARE_LT:
+        sql += val + " < " + double_sql (amount + slack);
+        break;
+    case QOF_COMPARE_LTE:
+        sql += val + " <= " + double_sql (amount + slack);
+        break;
+    case QOF_COMPARE_GT:
+        sql += val + " > " + double_sql (amount - slack);
+        break;
+    case QOF_COMPARE_GTE:
+        sql += val + " >= " + double_sql (amount - slack);
+        break;
+    case QOF_COMPARE_EQUAL:
+        amount = fabs (amount);
+        slack += 1e-4;
+        sql += val + " BETWEEN " + double_sql (amount - slack) + " AND " +
+            double_sql (amount + slack);
+        break;
+    default:
+        return any_row;
     }
-    else
+    return {"(" + sql + ")", false};
+}
+
+/* Times are compared with the query's date, or for QOF_DATE_MATCH_DAY with
+ * the start or end of its day.  A missing time is read as 0. */
+static sql_condition_t
+date_condition (const char* column, query_date_t data, bool inverted)
+{
+    if (inverted || data->pd.how == QOF_COMPARE_NEQ)
+        return any_row;
+
+    auto by_day = data->options == QOF_DATE_MATCH_DAY;
+    auto start = by_day ? gnc_time64_get_day_start (data->date) : data->date;
+    auto end = by_day ? gnc_time64_get_day_end (data->date) : data->date;
+    auto time_sql = [](time64 t)
     {
-        sql << "(" << fieldName;
-        convert_query_comparison_to_sql (pPredData, isInverted, sql);
+        return "'" + GncDateTime(t).format_iso8601() + "'";
+    };
 
-        if (strcmp (pPredData->type_name, QOF_TYPE_NUMERIC) == 0)
-        {
-            query_numeric_t pData = (query_numeric_t)pPredData;
-            sql << gnc_numeric_to_double (pData->amount);
-        }
-        else if (g_strcmp0 (pPredData->type_name, QOF_TYPE_DATE) == 0)
-        {
-            query_date_t date_data = (query_date_t)pPredData;
+    std::string col(column);
+    std::string sql;
+    switch (data->pd.how)
+    {
+    case QOF_COMPARE_LT:
+        sql = col + " < " + time_sql (start);
+        break;
+    case QOF_COMPARE_LTE:
+        sql = col + " <= " + time_sql (end);
+        break;
+    case QOF_COMPARE_GT:
+        sql = col + " > " + time_sql (end);
+        break;
+    case QOF_COMPARE_GTE:
+        sql = col + " >= " + time_sql (start);
+        break;
+    case QOF_COMPARE_EQUAL:
+        sql = col + " BETWEEN " + time_sql (start) + " AND " + time_sql (end);
+        break;
+    default:
+        return any_row;
+    }
+    return {"(" + sql + " OR " + col + " IS NULL)", false};
+}
 
-            GncDateTime time(date_data->date);
-            sql << time.format_iso8601();
-        }
-        else if (strcmp (pPredData->type_name, QOF_TYPE_INT32) == 0)
-        {
-            query_int32_t pData = (query_int32_t)pPredData;
-            sql << pData->val;
-        }
-        else if (strcmp (pPredData->type_name, QOF_TYPE_INT64) == 0)
-        {
-            query_int64_t pData = (query_int64_t)pPredData;
-            sql << pData->val;
-        }
-        else if (strcmp (pPredData->type_name, QOF_TYPE_DOUBLE) == 0)
-        {
-            query_double_t pData = (query_double_t)pPredData;
-            sql << pData->val;
-        }
-        else if (strcmp (pPredData->type_name, QOF_TYPE_BOOLEAN) == 0)
-        {
-            query_boolean_t pData = (query_boolean_t)pPredData;
-            sql << pData->val;
-        }
-        else
+static sql_condition_t
+convert_query_term_to_sql (GncSqlBackend* sql_be, QofQueryTerm* term,
+                           bool trans_query)
+{
+    g_return_val_if_fail (term != NULL, any_row);
+
+    auto column = query_column (qof_query_term_get_param_path (term),
+                                trans_query);
+    if (!column)
+        return any_row;
+
+    auto inverted = qof_query_term_is_inverted (term);
+    auto pred_data = qof_query_term_get_pred_data (term);
+    auto type = pred_data->type_name;
+    sql_condition_t cond = any_row;
+    if (g_strcmp0 (column, "t.splits") == 0 &&
+        g_strcmp0 (type, QOF_TYPE_GUID) != 0)
+        return any_row;
+    if (g_strcmp0 (type, QOF_TYPE_GUID) == 0)
+        cond = guid_condition (column, (query_guid_t)pred_data);
+    else if (g_strcmp0 (type, QOF_TYPE_CHAR) == 0)
+        cond = char_condition (column, (query_char_t)pred_data);
+    else if (g_strcmp0 (type, QOF_TYPE_STRING) == 0)
+        return string_condition (sql_be, column, (query_string_t)pred_data,
+                                 inverted);
+    else if (g_strcmp0 (type, QOF_TYPE_NUMERIC) == 0 ||
+             g_strcmp0 (type, QOF_TYPE_DEBCRED) == 0)
+        return numeric_condition (column, (query_numeric_t)pred_data,
+                                  inverted);
+    else if (g_strcmp0 (type, QOF_TYPE_DATE) == 0)
+        return date_condition (column, (query_date_t)pred_data, inverted);
+
+    if (!inverted)
+        return cond;
+    if (!cond.exact)
+        return any_row;
+    if (cond.sql.empty())
+        return {"1=0", true};
+    return {"NOT (" + cond.sql + ")", true};
+}
+
+/* The condition on transactions t LEFT JOIN splits s selecting at least the
+ * rows a split or transaction query matches, or an empty one if that
+ * could be any. */
+static std::string
+query_condition (GncSqlBackend* sql_be, QofQuery* query)
+{
+    auto trans_query = g_strcmp0 (qof_query_get_search_for (query),
+                                  GNC_ID_TRANS) == 0;
+    std::string sql;
+    for (auto or_node = qof_query_get_terms (query); or_node;
+         or_node = or_node->next)
+    {
+        std::string and_sql;
+        for (auto and_node = static_cast<GList*>(or_node->data); and_node;
+             and_node = and_node->next)
         {
-            PERR ("Unknown query predicate type: %s\n", pPredData->type_name);
+            auto cond = convert_query_term_to_sql (sql_be,
+                                                   static_cast<QofQueryTerm*>(and_node->data),
+                                                   trans_query);
+            if (cond.sql.empty())
+                continue;
+            if (!and_sql.empty())
+                and_sql += " AND ";
+            and_sql += cond.sql;
         }
-
-        sql << ")";
+        if (and_sql.empty())
+            return "";
+        if (!sql.empty())
+            sql += " OR ";
+        sql += "(" + and_sql + ")";
     }
+    return sql;
 }
 
 typedef struct
@@ -945,6 +1408,517 @@ static const EntryVec acct_balances_col_table
                                          (QofSetterFunc)set_acct_bal_balance),
 };
 
+/* Closing transactions are flagged in their slots. */
+static const char* closing_txns_sql = "SELECT obj_guid FROM slots "
+    "WHERE name = 'book_closing' AND int64_val <> 0";
+
+using BalanceMap = std::map<Account*, archive_balances_t>;
+
+static archive_balances_t&
+account_balances (BalanceMap& balances, Account* acct)
+{
+    auto zero = gnc_numeric_zero ();
+    return balances.emplace (acct,
+                             archive_balances_t {zero, zero, zero, zero}).first->second;
+}
+
+static void
+add_to_balances (BalanceMap& balances, Account* acct, char reconcile_state,
+                 gnc_numeric amount, bool closing)
+{
+    auto& bal = account_balances (balances, acct);
+    auto add = [amount](gnc_numeric& sum)
+    {
+        sum = gnc_numeric_add (sum, amount, GNC_DENOM_AUTO,
+                               GNC_HOW_DENOM_LCD);
+    };
+    add (bal.balance);
+    if (!closing)
+        add (bal.noclosing_balance);
+    if (reconcile_state != NREC)
+        add (bal.cleared_balance);
+    if (reconcile_state == YREC || reconcile_state == FREC)
+        add (bal.reconciled_balance);
+}
+
+/* Call func with the transaction guid and the account, reconcile state and
+ * quantity of each split matching condition whose transaction isn't loaded.
+ * Summing them here rather than with SUM(), which some databases return as
+ * a decimal, keeps the amounts exact whatever their denominators. */
+template <typename F> static void
+for_each_unloaded_split (GncSqlBackend* sql_be, const std::string& condition,
+                         F func)
+{
+    auto book = sql_be->book();
+    const std::string sskey(split_col_table[1]->name()); //tx_guid
+    const std::string tpkey(tx_col_table[0]->name());    //guid
+    std::string sql("SELECT " SPLIT_TABLE "." + sskey + " AS " + sskey);
+    for (auto col : {"account_guid", "reconcile_state", "quantity_num",
+                     "quantity_denom"})
+        sql += std::string(", " SPLIT_TABLE ".") + col + " AS " + col;
+    sql += " FROM " SPLIT_TABLE " INNER JOIN " TRANSACTION_TABLE " ON "
+        SPLIT_TABLE "." + sskey + " = " TRANSACTION_TABLE "." + tpkey;
+    if (!condition.empty())
+        sql += " WHERE " + condition;
+    auto stmt = sql_be->create_statement_from_sql (sql);
+    auto result = sql_be->execute_select_statement (stmt);
+
+    for (auto row : *result)
+    {
+        std::string_view tx_guid;
+        GncGUID guid;
+        try
+        {
+            tx_guid = row.get_string_view_at_col (sskey.c_str());
+            guid = row.get_guid_at_col (sskey.c_str());
+        }
+        catch (std::invalid_argument&)
+        {
+            continue;
+        }
+
+        /* Transactions loaded anyway, e.g. because a lot or an invoice
+         * refers to them, are already in their accounts' balances. */
+        if (xaccTransLookup (&guid, book))
+            continue;
+
+        single_acct_balance_t split_bal {sql_be, nullptr, NREC,
+                                         gnc_numeric_zero ()};
+        gnc_sql_load_object (sql_be, row, nullptr, &split_bal,
+                             acct_balances_col_table);
+        if (split_bal.acct != nullptr)
+            func (tx_guid, split_bal);
+    }
+    delete result;
+}
+
+/* The balances of all the splits that aren't loaded, from the maintained
+ * table: its sums, which count every split in every balance, less the
+ * loaded splits, and with the unloaded closing splits taken out of the
+ * noclosing balances. */
+static void
+sum_maintained_balances (GncSqlBackend* sql_be, BalanceMap& balances)
+{
+    auto stmt = sql_be->create_statement_from_sql ("SELECT account_guid, "
+                                                   "reconcile_state, "
+                                                   "quantity_num, "
+                                                   "quantity_denom FROM "
+                                                   BALANCE_TABLE);
+    auto result = sql_be->execute_select_statement (stmt);
+    for (auto row : *result)
+    {
+        single_acct_balance_t bal {sql_be, nullptr, NREC, gnc_numeric_zero ()};
+        gnc_sql_load_object (sql_be, row, nullptr, &bal,
+                             acct_balances_col_table);
+        if (bal.acct != nullptr)
+            add_to_balances (balances, bal.acct, bal.reconcile_state,
+                             bal.balance, false);
+    }
+    delete result;
+
+    auto root = gnc_book_get_root_account (sql_be->book());
+    auto accounts = gnc_account_get_descendants (root);
+    for (auto node = accounts; node; node = node->next)
+    {
+        auto acct = GNC_ACCOUNT (node->data);
+        for (auto snode = xaccAccountGetSplitList (acct); snode;
+             snode = snode->next)
+        {
+            auto split = GNC_SPLIT (snode->data);
+            add_to_balances (balances, acct, xaccSplitGetReconcile (split),
+                             gnc_numeric_neg (xaccSplitGetAmount (split)),
+                             false);
+        }
+    }
+    g_list_free (accounts);
+
+    for_each_unloaded_split (sql_be, SPLIT_TABLE ".tx_guid IN (" +
+                             std::string{closing_txns_sql} + ")",
+                             [&balances](std::string_view,
+                                         const single_acct_balance_t& bal)
+                             {
+                                 auto& sum = account_balances (balances, bal.acct);
+                                 sum.noclosing_balance =
+                                     gnc_numeric_sub (sum.noclosing_balance,
+                                                      bal.balance, GNC_DENOM_AUTO,
+                                                      GNC_HOW_DENOM_LCD);
+                             });
+}
+
+/* Set the starting balances to the sums of the splits of the transactions
+ * matching condition, or of all of them if it's empty, that aren't loaded. */
+static void
+set_unloaded_balances (GncSqlBackend* sql_be, const std::string& condition)
+{
+    BalanceMap balances;
+
+    if (condition.empty() && gnc_sql_transaction_balances_maintained (sql_be))
+    {
+        sum_maintained_balances (sql_be, balances);
+    }
+    else
+    {
+        std::set<std::string, std::less<>> closing;
+        auto stmt = sql_be->create_statement_from_sql (closing_txns_sql);
+        auto result = sql_be->execute_select_statement (stmt);
+        for (auto row : *result)
+        {
+            try
+            {
+                closing.insert (row.get_string_at_col ("obj_guid"));
+            }
+            catch (std::invalid_argument&) {}
+        }
+        delete result;
+
+        for_each_unloaded_split (sql_be, condition,
+                                 [&balances, &closing](std::string_view tx_guid,
+                                                       const single_acct_balance_t& bal)
+                                 {
+                                     add_to_balances (balances, bal.acct,
+                                                      bal.reconcile_state,
+                                                      bal.balance,
+                                                      closing.find (tx_guid) !=
+                                                      closing.end());
+                                 });
+    }
+
+    for (const auto& entry : balances)
+        set_start_balances (entry.first, entry.second);
+    PINFO ("Set unloaded balances of %zu accounts", balances.size());
+}
+
+void
+gnc_sql_transaction_set_archive_balances (GncSqlBackend* sql_be)
+{
+    g_return_if_fail (sql_be != NULL);
+
+    auto archive_date = qof_book_get_archive_date (sql_be->book());
+    g_return_if_fail (archive_date != G_MININT64);
+
+    set_unloaded_balances (sql_be, archive_selector (archive_date, true,
+                                                     TRANSACTION_TABLE));
+}
+
+void
+gnc_sql_transaction_set_pending_balances (GncSqlBackend* sql_be)
+{
+    g_return_if_fail (sql_be != NULL);
+
+    /* Start keeping the balances in the database, so that the next time
+     * they needn't be summed from the splits. */
+    if (!gnc_sql_transaction_balances_maintained (sql_be) &&
+        !qof_book_is_readonly (sql_be->book()))
+    {
+        /* It's only maintained once it has a version. */
+        if (create_balance_table (sql_be) && fill_balances (sql_be))
+            sql_be->set_table_version (BALANCE_TABLE, BALANCE_TABLE_VERSION);
+        else
+            PWARN ("Unable to set up the " BALANCE_TABLE " table");
+    }
+    set_unloaded_balances (sql_be, "");
+    auto root = gnc_book_get_root_account (sql_be->book());
+    auto accounts = gnc_account_get_descendants (root);
+    for (auto node = accounts; node; node = node->next)
+        gnc_account_set_splits_pending (GNC_ACCOUNT (node->data), TRUE);
+    g_list_free (accounts);
+}
+
+void
+gnc_sql_transaction_load_pending (GncSqlBackend* sql_be,
+                                  const std::vector<Account*>& accounts)
+{
+    g_return_if_fail (sql_be != NULL);
+
+    std::vector<Account*> pending;
+    for (auto acct : accounts)
+        if (gnc_account_get_splits_pending (acct))
+            pending.push_back (acct);
+    if (pending.empty())
+        return;
+
+    const std::string stkey(split_col_table[1]->name()); //tx_guid
+    const std::string sakey(split_col_table[2]->name()); //account_guid
+    std::string sql("(SELECT DISTINCT ");
+    sql += stkey + " FROM " SPLIT_TABLE " WHERE " + sakey + " IN (";
+    for (auto acct : pending)
+    {
+        if (acct != pending.front())
+            sql += ",";
+        sql += "'" + gnc::GUID(*qof_instance_get_guid (acct)).to_string() + "'";
+    }
+    sql += "))";
+
+    auto root = gnc_book_get_root_account (sql_be->book());
+    gnc_account_foreach_descendant(root, (AccountCb)xaccAccountBeginEdit,
+                                   nullptr);
+    query_transactions (sql_be, sql);
+    /* The loaded splits were taken out of the starting balances again, so
+     * these are zero now anyway. */
+    auto zero = gnc_numeric_zero ();
+    archive_balances_t none {zero, zero, zero, zero};
+    for (auto acct : pending)
+    {
+        gnc_account_set_splits_pending (acct, FALSE);
+        set_start_balances (acct, none);
+    }
+    gnc_account_foreach_descendant(root, (AccountCb)xaccAccountCommitEdit,
+                                   nullptr);
+    PINFO ("Loaded the transactions of %zu accounts", pending.size());
+}
+
+/* Loads the transactions of the pending accounts which have a row of
+ * transactions t LEFT JOIN splits s meeting the condition.  The accounts
+ * stay pending, as they may have other transactions. */
+static void
+load_matching (GncSqlBackend* sql_be, const std::string& condition,
+               const std::vector<Account*>& accounts)
+{
+    std::vector<Account*> pending;
+    for (auto acct : accounts)
+        if (gnc_account_get_splits_pending (acct))
+            pending.push_back (acct);
+    if (pending.empty())
+        return;
+
+    std::string sql("(SELECT DISTINCT t.guid FROM " TRANSACTION_TABLE " t"
+                    " LEFT JOIN " SPLIT_TABLE " s ON s.tx_guid = t.guid"
+                    " WHERE (");
+    sql += condition + ")";
+    if (pending.size() < accounts.size())
+    {
+        /* The transactions of the other accounts are loaded already. */
+        sql += " AND t.guid IN (SELECT tx_guid FROM " SPLIT_TABLE
+            " WHERE account_guid IN (";
+        for (auto acct : pending)
+        {
+            if (acct != pending.front())
+                sql += ",";
+            sql += "'" + gnc::GUID(*qof_instance_get_guid (acct)).to_string() +
+                "'";
+        }
+        sql += "))";
+    }
+    sql += ")";
+
+    auto root = gnc_book_get_root_account (sql_be->book());
+    gnc_account_foreach_descendant(root, (AccountCb)xaccAccountBeginEdit,
+                                   nullptr);
+    query_transactions (sql_be, sql);
+    gnc_account_foreach_descendant(root, (AccountCb)xaccAccountCommitEdit,
+                                   nullptr);
+}
+
+/* The accounts a term limits a split query to, if it does. */
+static bool
+term_account_guids (QofQueryTerm* term, std::vector<GncGUID>& guids)
+{
+    if (qof_query_term_is_inverted (term))
+        return false;
+    auto pred_data = qof_query_term_get_pred_data (term);
+    if (g_strcmp0 (pred_data->type_name, QOF_TYPE_GUID) != 0)
+        return false;
+
+    auto path = qof_query_term_get_param_path (term);
+    auto guid_data = (query_guid_t)pred_data;
+    auto path_is = [path](std::initializer_list<const char*> params)
+    {
+        auto node = path;
+        for (auto param : params)
+        {
+            if (!node || g_strcmp0 ((const char*)node->data, param) != 0)
+                return false;
+            node = node->next;
+        }
+        return node == nullptr;
+    };
+    if (!(guid_data->options == QOF_GUID_MATCH_ANY &&
+          path_is ({SPLIT_ACCOUNT, QOF_PARAM_GUID})) &&
+        !(guid_data->options == QOF_GUID_MATCH_ALL &&
+          path_is ({SPLIT_TRANS, TRANS_SPLITLIST, SPLIT_ACCOUNT_GUID})))
+        return false;
+
+    for (auto node = guid_data->guids; node; node = node->next)
+        guids.push_back (*static_cast<GncGUID*>(node->data));
+    return true;
+}
+
+void
+gnc_sql_transaction_load_for_query (GncSqlBackend* sql_be, QofQuery* query)
+{
+    g_return_if_fail (sql_be != NULL);
+    g_return_if_fail (query != NULL);
+
+    auto search_for = qof_query_get_search_for (query);
+    if (g_strcmp0 (search_for, GNC_ID_SPLIT) != 0 &&
+        g_strcmp0 (search_for, GNC_ID_TRANS) != 0)
+        return;
+
+    /* A split query each of whose alternatives is limited to some accounts
+     * needs all of their transactions; for anything else just the ones its
+     * SQL translation selects are loaded. */
+    std::vector<GncGUID> guids;
+    auto terms = qof_query_get_terms (query);
+    auto limited = terms != nullptr && g_strcmp0 (search_for, GNC_ID_SPLIT) == 0;
+    for (auto or_node = terms; or_node && limited; or_node = or_node->next)
+    {
+        auto found = false;
+        for (auto and_node = static_cast<GList*>(or_node->data); and_node;
+             and_node = and_node->next)
+        {
+            if (term_account_guids (static_cast<QofQueryTerm*>(and_node->data),
+                                    guids))
+            {
+                found = true;
+                break;
+            }
+        }
+        limited = found;
+    }
+
+    std::vector<Account*> accounts;
+    if (limited)
+    {
+        for (const auto& guid : guids)
+        {
+            auto acct = xaccAccountLookup (&guid, sql_be->book());
+            if (acct)
+                accounts.push_back (acct);
+        }
+        gnc_sql_transaction_load_pending (sql_be, accounts);
+        return;
+    }
+
+    auto root = gnc_book_get_root_account (sql_be->book());
+    auto descendants = gnc_account_get_descendants (root);
+    for (auto node = descendants; node; node = node->next)
+        accounts.push_back (GNC_ACCOUNT (node->data));
+    g_list_free (descendants);
+
+    auto condition = query_condition (sql_be, query);
+    if (condition.empty())
+        gnc_sql_transaction_load_pending (sql_be, accounts);
+    else
+        load_matching (sql_be, condition, accounts);
+}
+
+/* The earliest date posted an alternative of the query can match, or
+ * G_MAXINT64 if it has no date posted terms: going by date_condition. */
+static time64
+clause_earliest_date (GList* and_terms, bool trans_query)
+{
+    auto earliest = G_MAXINT64;
+    auto lower = G_MININT64;
+    for (auto node = and_terms; node; node = node->next)
+    {
+        auto term = static_cast<QofQueryTerm*>(node->data);
+        auto pred_data = qof_query_term_get_pred_data (term);
+        if (qof_query_term_is_inverted (term) ||
+            g_strcmp0 (pred_data->type_name, QOF_TYPE_DATE) != 0 ||
+            g_strcmp0 (query_column (qof_query_term_get_param_path (term),
+                                     trans_query), "t.post_date") != 0)
+            continue;
+
+        auto data = (query_date_t)pred_data;
+        auto by_day = data->options == QOF_DATE_MATCH_DAY;
+        auto start = by_day ? gnc_time64_get_day_start (data->date) : data->date;
+        auto end = by_day ? gnc_time64_get_day_end (data->date) : data->date;
+        switch (pred_data->how)
+        {
+        case QOF_COMPARE_GT:
+            lower = MAX (lower, end);
+            break;
+        case QOF_COMPARE_GTE:
+        case QOF_COMPARE_EQUAL:
+            lower = MAX (lower, start);
+            break;
+        case QOF_COMPARE_LT:
+        case QOF_COMPARE_LTE:
+            break;
+        default:
+            continue;
+        }
+        earliest = lower;
+    }
+    return earliest;
+}
+
+bool
+gnc_sql_transaction_query_reaches_archive (GncSqlBackend* sql_be,
+                                           QofQuery* query)
+{
+    g_return_val_if_fail (sql_be != NULL, false);
+    g_return_val_if_fail (query != NULL, false);
+
+    auto archive_date = qof_book_get_archive_date (sql_be->book());
+    if (archive_date == G_MININT64)
+        return false;
+
+    auto search_for = qof_query_get_search_for (query);
+    if (g_strcmp0 (search_for, GNC_ID_SPLIT) != 0 &&
+        g_strcmp0 (search_for, GNC_ID_TRANS) != 0)
+        return false;
+
+    auto trans_query = g_strcmp0 (search_for, GNC_ID_TRANS) == 0;
+    for (auto or_node = qof_query_get_terms (query); or_node;
+         or_node = or_node->next)
+        if (clause_earliest_date (static_cast<GList*>(or_node->data),
+                                  trans_query) < archive_date)
+            return true;
+    return false;
+}
+
+void
+gnc_sql_transaction_load_archived (GncSqlBackend* sql_be)
+{
+    g_return_if_fail (sql_be != NULL);
+
+    auto book = sql_be->book();
+    auto archive_date = qof_book_get_archive_date (book);
+    if (archive_date == G_MININT64)
+        return;
+
+    auto root = gnc_book_get_root_account (book);
+    auto zero = gnc_numeric_zero ();
+    archive_balances_t none {zero, zero, zero, zero};
+    gnc_account_foreach_descendant(root, (AccountCb)xaccAccountBeginEdit,
+                                   nullptr);
+    query_transactions (sql_be, archive_selector (archive_date, true));
+    auto accounts = gnc_account_get_descendants (root);
+    for (auto node = accounts; node; node = node->next)
+        set_start_balances (GNC_ACCOUNT (node->data), none);
+    g_list_free (accounts);
+    gnc_account_foreach_descendant(root, (AccountCb)xaccAccountCommitEdit,
+                                   nullptr);
+    qof_book_set_archive_date (book, G_MININT64);
+}
+
+void
+gnc_sql_transaction_reload (GncSqlBackend* sql_be,
+                            const std::vector<GncGUID>& guids)
+{
+    g_return_if_fail (sql_be != NULL);
+
+    if (guids.empty ())
+        return;
+    std::string selector ("(");
+    for (const auto& guid : guids)
+    {
+        /* Loading skips the transactions the book already has. */
+        auto tx = xaccTransLookup (&guid, sql_be->book());
+        if (tx)
+        {
+            xaccTransBeginEdit (tx);
+            xaccTransDestroy (tx);
+            xaccTransCommitEdit (tx);
+        }
+        if (selector.size () > 1)
+            selector += ",";
+        selector += "'" + gnc::GUID (guid).to_string () + "'";
+    }
+    query_transactions (sql_be, selector + ")");
+}
+
 /* ----------------------------------------------------------------- */
 template<> void
 GncSqlColumnTableEntryImpl<CT_TXREF>::load (const GncSqlBackend* sql_be,
@@ -35,6 +35,8 @@ extern "C"
 #include "qof.h"
 #include "Account.h"
 }
+#include <vector>
+
 class GncSqlTransBackend : public GncSqlObjectBackend
 {
 public:
@@ -61,6 +63,106 @@ public:
  */
 void gnc_sql_transaction_load_tx_for_account (GncSqlBackend* sql_be,
                                               Account* account);
+
+/**
+ * Sets each account's starting balances to the sum of its splits in the
+ * transactions posted before the book's archive date that weren't loaded.
+ *
+ * @param sql_be SQL backend
+ */
+void gnc_sql_transaction_set_archive_balances (GncSqlBackend* sql_be);
+
+/**
+ * Sets each account's starting balances to the sum of all of its splits
+ * that aren't loaded, and flags its splits as pending, so that its
+ * transactions are loaded when they're first needed.
+ *
+ * @param sql_be SQL backend
+ */
+void gnc_sql_transaction_set_pending_balances (GncSqlBackend* sql_be);
+
+/**
+ * Whether the database keeps the sums of the split quantities of each
+ * account, updated whenever a split is written.
+ *
+ * @param sql_be SQL backend
+ */
+bool gnc_sql_transaction_balances_maintained (const GncSqlBackend* sql_be);
+
+/**
+ * Creates the table of account balances in a new database if the book
+ * uses GNC_FEATURE_SQL_ACCOUNT_BALANCES.
+ *
+ * @param sql_be SQL backend
+ * @param book The book about to be written
+ * @return true if successful, false if the table couldn't be created
+ */
+bool gnc_sql_transaction_create_balances (GncSqlBackend* sql_be, QofBook* book);
+
+/**
+ * Fills the table of account balances, if there is one, from the splits
+ * written to a new database.
+ *
+ * @param sql_be SQL backend
+ * @return true if successful, false on error
+ */
+bool gnc_sql_transaction_fill_balances (GncSqlBackend* sql_be);
+
+/**
+ * Loads the transactions of those of the accounts whose splits are
+ * pending, and clears the flag and their starting balances.
+ *
+ * @param sql_be SQL backend
+ * @param accounts Accounts
+ */
+void gnc_sql_transaction_load_pending (GncSqlBackend* sql_be,
+                                       const std::vector<Account*>& accounts);
+
+/**
+ * Loads the pending transactions the query could find: all of those of the
+ * accounts a split query is limited to, or else the ones selected by the
+ * query's translation to SQL, which matches dates, amounts, strings,
+ * account and transaction GUIDs and reconcile states.
+ *
+ * @param sql_be SQL backend
+ * @param query The query about to be run
+ */
+void gnc_sql_transaction_load_for_query (GncSqlBackend* sql_be,
+                                         QofQuery* query);
+
+/**
+ * Whether the query asks for dates posted before the book's archive date,
+ * so that the transactions left in the database must be loaded before it
+ * runs.  A query without a date posted term doesn't: like an unfiltered
+ * register it only sees the loaded transactions after the starting
+ * balances.
+ *
+ * @param sql_be SQL backend
+ * @param query The query about to be run
+ */
+bool gnc_sql_transaction_query_reaches_archive (GncSqlBackend* sql_be,
+                                                QofQuery* query);
+
+/**
+ * Loads the transactions posted before the book's archive date, clears
+ * the starting balances standing in for them and the archive date.
+ *
+ * @param sql_be SQL backend
+ */
+void gnc_sql_transaction_load_archived (GncSqlBackend* sql_be);
+
+/**
+ * Replaces the transactions the book has with these GUIDs by what the
+ * database has now, and loads those it has and the book hasn't.  The
+ * backend must be loading, so that destroying them doesn't reach the
+ * database.
+ *
+ * @param sql_be SQL backend
+ * @param guids The transactions' GUIDs
+ */
+void gnc_sql_transaction_reload (GncSqlBackend* sql_be,
+                                 const std::vector<GncGUID>& guids);
+
 typedef struct
 {
     Account* acct;
@@ -72,6 +72,8 @@ protected:
             { return 1.0; }
             virtual std::string get_string_at_col (const char* col)const
             { return std::string{"foo"}; }
+            virtual std::string_view get_string_view_at_col (const char* col) const
+            { return "foo"; }
             virtual time64 get_time64_at_col (const char* col) const
             { return 1466270857LL; }
             virtual bool is_col_null(const char* col) const noexcept
@@ -117,6 +119,9 @@ public:
         const noexcept override { return false; }
     virtual std::string quote_string (const std::string& str)
         const noexcept override { return std::string{str}; }
+    void make_upsert (std::string&, const std::string&,
+                      const std::vector<std::string>&)
+        const noexcept override {}
     int dberror() const noexcept override { return 0; }
     void set_error(QofBackendError error, unsigned int repeat, bool retry) noexcept override { return; }
     bool verify() noexcept override { return true; }
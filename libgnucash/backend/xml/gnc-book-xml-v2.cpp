@@ -135,6 +135,7 @@ book_slots_handler (xmlNodePtr node, gpointer book_pdata)
     /* the below works only because the get is gaurenteed to return
      * a frame, even if its empty */
     success = dom_tree_create_instance_slots (node, QOF_INSTANCE (book));
+    qof_book_features_changed (book);
 
     g_return_val_if_fail (success, FALSE);
 
@@ -73,6 +73,21 @@ gnc_lot_dom_tree_create (GNCLot* lot)
     return ret;
 }
 
+void
+gnc_lot_to_xml_stream (GncXmlWriter& writer, GNCLot* lot)
+{
+    ENTER ("(lot=%p)", lot);
+    writer.start_element (gnc_lot_string);
+    writer.add_attribute ("version", lot_version_string);
+
+    guid_to_xml_stream (writer, lot_id_string, gnc_lot_get_guid (lot));
+    qof_instance_slots_to_xml_stream (writer, lot_slots_string,
+                                      QOF_INSTANCE (lot));
+
+    writer.end_element ();
+    LEAVE ("");
+}
+
 /* =================================================================== */
 
 struct lot_pdata
@@ -513,3 +513,64 @@ gnc_pricedb_dom_tree_create (GNCPriceDB* db)
 {
     return gnc_pricedb_to_dom_tree (BAD_CAST "gnc:pricedb", db);
 }
+
+/* Whether gnc_price_to_dom_tree can represent the price.  One that it
+ * can't makes gnc_pricedb_dom_tree_create give up on the whole db. */
+static gboolean
+price_is_xml_writable (GNCPrice* price, gpointer data)
+{
+    auto count = static_cast<guint*> (data);
+    auto commodity = gnc_price_get_commodity (price);
+    auto currency = gnc_price_get_currency (price);
+
+    if (! (commodity && currency)) return FALSE;
+    if (! (gnc_commodity_get_namespace (commodity) &&
+           gnc_commodity_get_mnemonic (commodity))) return FALSE;
+    if (! (gnc_commodity_get_namespace (currency) &&
+           gnc_commodity_get_mnemonic (currency))) return FALSE;
+    if (gnc_price_get_time64 (price) == INT64_MAX) return FALSE;
+
+    ++*count;
+    return TRUE;
+}
+
+/** Whether gnc_pricedb_dom_tree_create would return a tree for db, in
+ * which case each of its prices can be written with
+ * gnc_price_to_xml_stream inside a <gnc:pricedb version="1"> element. */
+gboolean
+gnc_pricedb_xml_writable (GNCPriceDB* db)
+{
+    guint count = 0;
+
+    return gnc_pricedb_foreach_price (db, price_is_xml_writable, &count, FALSE)
+           && count > 0;
+}
+
+void
+gnc_price_to_xml_stream (GncXmlWriter& writer, GNCPrice* price)
+{
+    const gchar* typestr, *sourcestr;
+    gnc_numeric value;
+
+    writer.start_element ("price");
+
+    guid_to_xml_stream (writer, "price:id", gnc_price_get_guid (price));
+    commodity_ref_to_xml_stream (writer, "price:commodity",
+                                 gnc_price_get_commodity (price));
+    commodity_ref_to_xml_stream (writer, "price:currency",
+                                 gnc_price_get_currency (price));
+    time64_to_xml_stream (writer, "price:time", gnc_price_get_time64 (price));
+
+    sourcestr = gnc_price_get_source_string (price);
+    if (sourcestr && (strlen (sourcestr) != 0))
+        text_to_xml_stream (writer, "price:source", sourcestr);
+
+    typestr = gnc_price_get_typestr (price);
+    if (typestr && (strlen (typestr) != 0))
+        text_to_xml_stream (writer, "price:type", typestr);
+
+    value = gnc_price_get_value (price);
+    gnc_numeric_to_xml_stream (writer, "price:value", &value);
+
+    writer.end_element ();
+}
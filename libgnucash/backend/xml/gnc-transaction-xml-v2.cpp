@@ -48,6 +48,9 @@ extern "C"
 
 #include "sixtp-dom-parsers.h"
 
+/* This static indicates the debugging module that this .o belongs to.  */
+static QofLogModule log_module = GNC_MOD_IO;
+
 const gchar* transaction_version_string = "2.0.0";
 
 static void
@@ -192,12 +195,89 @@ gnc_transaction_dom_tree_create (Transaction* trn)
     return ret;
 }
 
+static void
+split_to_xml_stream (GncXmlWriter& writer, const gchar* tag, Split* spl)
+{
+    writer.start_element (tag);
+
+    guid_to_xml_stream (writer, "split:id", xaccSplitGetGUID (spl));
+
+    auto memo = xaccSplitGetMemo (spl);
+    if (memo && *memo)
+        writer.text_element ("split:memo", memo);
+
+    auto action = xaccSplitGetAction (spl);
+    if (action && *action)
+        writer.text_element ("split:action", action);
+
+    char tmp[2];
+    tmp[0] = xaccSplitGetReconcile (spl);
+    tmp[1] = '\0';
+    writer.text_element ("split:reconciled-state", tmp);
+
+    auto reconciled = xaccSplitGetDateReconciled (spl);
+    if (reconciled)
+        time64_to_xml_stream (writer, "split:reconcile-date", reconciled);
+
+    auto value = xaccSplitGetValue (spl);
+    gnc_numeric_to_xml_stream (writer, "split:value", &value);
+
+    auto amount = xaccSplitGetAmount (spl);
+    gnc_numeric_to_xml_stream (writer, "split:quantity", &amount);
+
+    guid_to_xml_stream (writer, "split:account",
+                        xaccAccountGetGUID (xaccSplitGetAccount (spl)));
+
+    auto lot = xaccSplitGetLot (spl);
+    if (lot)
+        guid_to_xml_stream (writer, "split:lot", gnc_lot_get_guid (lot));
+
+    qof_instance_slots_to_xml_stream (writer, "split:slots",
+                                      QOF_INSTANCE (spl));
+    writer.end_element ();
+}
+
+void
+gnc_transaction_to_xml_stream (GncXmlWriter& writer, Transaction* trn)
+{
+    writer.start_element ("gnc:transaction");
+    writer.add_attribute ("version", transaction_version_string);
+
+    guid_to_xml_stream (writer, "trn:id", xaccTransGetGUID (trn));
+
+    commodity_ref_to_xml_stream (writer, "trn:currency",
+                                 xaccTransGetCurrency (trn));
+
+    auto num = xaccTransGetNum (trn);
+    if (num && *num)
+        writer.text_element ("trn:num", num);
+
+    time64_to_xml_stream (writer, "trn:date-posted",
+                          xaccTransRetDatePosted (trn));
+    time64_to_xml_stream (writer, "trn:date-entered",
+                          xaccTransRetDateEntered (trn));
+
+    auto description = xaccTransGetDescription (trn);
+    if (description)
+        writer.text_element ("trn:description", description);
+
+    qof_instance_slots_to_xml_stream (writer, "trn:slots", QOF_INSTANCE (trn));
+
+    writer.start_element ("trn:splits");
+    for (auto n = xaccTransGetSplitList (trn); n; n = n->next)
+        split_to_xml_stream (writer, "trn:split", static_cast<Split*> (n->data));
+    writer.end_element ();
+
+    writer.end_element ();
+}
+
 /***********************************************************************/
 
 struct split_pdata
 {
     Split* split;
     QofBook* book;
+    guint seen;                 /* SPL_SEEN_* flags, SAX parser only */
 };
 
 static inline gboolean
@@ -405,6 +485,7 @@ struct trans_pdata
 {
     Transaction* trans;
     QofBook* book;
+    guint seen;                 /* TRN_SEEN_* flags, SAX parser only */
 };
 
 static inline gboolean
@@ -572,77 +653,782 @@ struct dom_tree_handler trn_dom_handlers[] =
     { NULL, NULL, 0, 0 },
 };
 
+Transaction*
+dom_tree_to_transaction (xmlNodePtr node, QofBook* book)
+{
+    Transaction* trn;
+    gboolean successful;
+    struct trans_pdata pdata;
+
+    g_return_val_if_fail (node, NULL);
+    g_return_val_if_fail (book, NULL);
+
+    trn = xaccMallocTransaction (book);
+    g_return_val_if_fail (trn, NULL);
+    xaccTransBeginEdit (trn);
+
+    pdata.trans = trn;
+    pdata.book = book;
+
+    successful = dom_tree_generic_parse (node, trn_dom_handlers, &pdata);
+
+    xaccTransCommitEdit (trn);
+
+    if (!successful)
+    {
+        xmlElemDump (stdout, NULL, node);
+        xaccTransBeginEdit (trn);
+        xaccTransDestroy (trn);
+        xaccTransCommitEdit (trn);
+        trn = NULL;
+    }
+
+    return trn;
+}
+
+/***********************************************************************/
+/* Event-driven <gnc:transaction> parser.
+
+   Instead of collecting each transaction into a DOM tree and walking
+   it with trn_dom_handlers, the transaction and its splits are created
+   when their start tags are seen and filled in as each child element
+   ends.  Only the slots, whose shape is open-ended, are still gathered
+   into a (small) DOM tree for dom_tree_create_instance_slots.  The
+   checks and fallbacks mirror the DOM handlers above, which remain in
+   use by dom_tree_to_transaction.
+*/
+
+enum
+{
+    TRN_SEEN_ID           = 1 << 0,
+    TRN_SEEN_DATE_POSTED  = 1 << 1,
+    TRN_SEEN_DATE_ENTERED = 1 << 2,
+    TRN_SEEN_SPLITS       = 1 << 3,
+    TRN_SEEN_REQUIRED     = (TRN_SEEN_ID | TRN_SEEN_DATE_POSTED |
+                             TRN_SEEN_DATE_ENTERED | TRN_SEEN_SPLITS)
+};
+
+enum
+{
+    SPL_SEEN_ID           = 1 << 0,
+    SPL_SEEN_RECONCILED   = 1 << 1,
+    SPL_SEEN_VALUE        = 1 << 2,
+    SPL_SEEN_QUANTITY     = 1 << 3,
+    SPL_SEEN_ACCOUNT      = 1 << 4,
+    SPL_SEEN_REQUIRED     = (SPL_SEEN_ID | SPL_SEEN_RECONCILED |
+                             SPL_SEEN_VALUE | SPL_SEEN_QUANTITY |
+                             SPL_SEEN_ACCOUNT)
+};
+
+/* Return the text of the one child element called tag, or NULL if it
+   is missing or repeated. */
+static const gchar*
+sax_child_chars (GSList* data_from_children, const gchar* tag)
+{
+    const gchar* ret = NULL;
+    GSList* lp;
+
+    for (lp = data_from_children; lp; lp = lp->next)
+    {
+        sixtp_child_result* cr = (sixtp_child_result*) lp->data;
+
+        if (cr->type != SIXTP_CHILD_RESULT_NODE ||
+            g_strcmp0 (cr->tag, tag) != 0)
+            continue;
+
+        if (ret)
+        {
+            PERR ("more than one %s node found.", tag);
+            return NULL;
+        }
+        ret = (const gchar*) cr->data;
+    }
+    return ret;
+}
+
+static time64
+sax_children_to_time64 (GSList* data_from_children, const gchar* tag)
+{
+    const gchar* text = sax_child_chars (data_from_children, "ts:date");
+    time64 time = INT64_MAX;
+
+    if (text)
+        time = gnc_iso8601_to_time64_gmt (text);
+    else
+        PERR ("no usable ts:date node found.");
+
+    if (!dom_tree_valid_time64 (time, BAD_CAST tag)) time = 0;
+    return time;
+}
+
+static void
+sax_chars_to_guid (GSList* data_from_children, GncGUID* guid)
+{
+    gchar* txt = concatenate_child_result_chars (data_from_children);
+
+    if (!txt || !string_to_guid (txt, guid))
+        PERR ("couldn't parse GncGUID");
+
+    g_free (txt);
+}
+
+static gnc_numeric
+sax_chars_to_gnc_numeric (GSList* data_from_children)
+{
+    gchar* txt = concatenate_child_result_chars (data_from_children);
+    gnc_numeric num;
+
+    if (!txt || !string_to_gnc_numeric (txt, &num))
+        num = gnc_numeric_zero ();
+
+    g_free (txt);
+    return num;
+}
+
 static gboolean
-gnc_transaction_end_handler (gpointer data_for_children,
+sax_discard_end_handler (gpointer data_for_children,
+                         GSList* data_from_children, GSList* sibling_data,
+                         gpointer parent_data, gpointer global_data,
+                         gpointer* result, const gchar* tag)
+{
+    xmlFreeNode ((xmlNodePtr) data_for_children);
+    return TRUE;
+}
+
+/* <ts:date> holder, e.g. <trn:date-posted>.  Like dom_tree_to_time64,
+   any other element inside it is ignored. */
+static sixtp*
+sax_time64_parser_new (sixtp_end_handler ender)
+{
+    sixtp* top_level;
+
+    if (! (top_level = sixtp_set_any (sixtp_new (), FALSE,
+                                      SIXTP_END_HANDLER_ID, ender,
+                                      SIXTP_NO_MORE_HANDLERS)))
+    {
+        return NULL;
+    }
+
+    if (!sixtp_add_some_sub_parsers (
+            top_level, TRUE,
+            "ts:date", simple_chars_only_parser_new (NULL),
+            SIXTP_MAGIC_CATCHER,
+            sixtp_dom_subtree_parser_new (sax_discard_end_handler),
+            NULL, NULL))
+    {
+        return NULL;
+    }
+
+    return top_level;
+}
+
+/***********************************************************************/
+/* <trn:split> */
+
+static inline gboolean
+sax_set_spl_string (GSList* data_from_children, gpointer parent_data,
+                    void (*func) (Split* spl, const char* txt))
+{
+    struct split_pdata* pdata = static_cast<decltype (pdata)> (parent_data);
+    gchar* txt;
+
+    g_return_val_if_fail (pdata, FALSE);
+
+    txt = concatenate_child_result_chars (data_from_children);
+    g_return_val_if_fail (txt, FALSE);
+
+    func (pdata->split, txt);
+
+    g_free (txt);
+    return TRUE;
+}
+
+static gboolean
+spl_sax_id_end_handler (gpointer data_for_children,
+                        GSList* data_from_children, GSList* sibling_data,
+                        gpointer parent_data, gpointer global_data,
+                        gpointer* result, const gchar* tag)
+{
+    struct split_pdata* pdata = static_cast<decltype (pdata)> (parent_data);
+    GncGUID guid = *xaccSplitGetGUID (pdata->split);
+
+    sax_chars_to_guid (data_from_children, &guid);
+    xaccSplitSetGUID (pdata->split, &guid);
+    pdata->seen |= SPL_SEEN_ID;
+    return TRUE;
+}
+
+static gboolean
+spl_sax_memo_end_handler (gpointer data_for_children,
+                          GSList* data_from_children, GSList* sibling_data,
+                          gpointer parent_data, gpointer global_data,
+                          gpointer* result, const gchar* tag)
+{
+    return sax_set_spl_string (data_from_children, parent_data,
+                               xaccSplitSetMemo);
+}
+
+static gboolean
+spl_sax_action_end_handler (gpointer data_for_children,
+                            GSList* data_from_children, GSList* sibling_data,
+                            gpointer parent_data, gpointer global_data,
+                            gpointer* result, const gchar* tag)
+{
+    return sax_set_spl_string (data_from_children, parent_data,
+                               xaccSplitSetAction);
+}
+
+static gboolean
+spl_sax_reconciled_state_end_handler (gpointer data_for_children,
+                                      GSList* data_from_children,
+                                      GSList* sibling_data,
+                                      gpointer parent_data,
+                                      gpointer global_data,
+                                      gpointer* result, const gchar* tag)
+{
+    struct split_pdata* pdata = static_cast<decltype (pdata)> (parent_data);
+    gchar* txt = concatenate_child_result_chars (data_from_children);
+
+    pdata->seen |= SPL_SEEN_RECONCILED;
+    g_return_val_if_fail (txt, FALSE);
+
+    xaccSplitSetReconcile (pdata->split, txt[0]);
+
+    g_free (txt);
+    return TRUE;
+}
+
+static gboolean
+spl_sax_reconcile_date_end_handler (gpointer data_for_children,
+                                    GSList* data_from_children,
+                                    GSList* sibling_data,
+                                    gpointer parent_data,
+                                    gpointer global_data,
+                                    gpointer* result, const gchar* tag)
+{
+    struct split_pdata* pdata = static_cast<decltype (pdata)> (parent_data);
+
+    xaccSplitSetDateReconciledSecs (pdata->split,
+                                    sax_children_to_time64 (data_from_children,
+                                                            tag));
+    return TRUE;
+}
+
+static gboolean
+spl_sax_value_end_handler (gpointer data_for_children,
+                           GSList* data_from_children, GSList* sibling_data,
+                           gpointer parent_data, gpointer global_data,
+                           gpointer* result, const gchar* tag)
+{
+    struct split_pdata* pdata = static_cast<decltype (pdata)> (parent_data);
+
+    xaccSplitSetValue (pdata->split,
+                       sax_chars_to_gnc_numeric (data_from_children));
+    pdata->seen |= SPL_SEEN_VALUE;
+    return TRUE;
+}
+
+static gboolean
+spl_sax_quantity_end_handler (gpointer data_for_children,
+                              GSList* data_from_children, GSList* sibling_data,
+                              gpointer parent_data, gpointer global_data,
+                              gpointer* result, const gchar* tag)
+{
+    struct split_pdata* pdata = static_cast<decltype (pdata)> (parent_data);
+
+    xaccSplitSetAmount (pdata->split,
+                        sax_chars_to_gnc_numeric (data_from_children));
+    pdata->seen |= SPL_SEEN_QUANTITY;
+    return TRUE;
+}
+
+static gboolean
+spl_sax_account_end_handler (gpointer data_for_children,
                              GSList* data_from_children, GSList* sibling_data,
                              gpointer parent_data, gpointer global_data,
                              gpointer* result, const gchar* tag)
 {
-    Transaction* trn = NULL;
-    xmlNodePtr tree = (xmlNodePtr)data_for_children;
-    gxpf_data* gdata = (gxpf_data*)global_data;
+    struct split_pdata* pdata = static_cast<decltype (pdata)> (parent_data);
+    GncGUID id = *guid_null ();
+    Account* account;
+
+    pdata->seen |= SPL_SEEN_ACCOUNT;
+    sax_chars_to_guid (data_from_children, &id);
 
-    if (parent_data)
+    account = xaccAccountLookup (&id, pdata->book);
+    if (!account && gnc_transaction_xml_v2_testing &&
+        !guid_equal (&id, guid_null ()))
     {
-        return TRUE;
+        account = xaccMallocAccount (pdata->book);
+        xaccAccountSetGUID (account, &id);
+        xaccAccountSetCommoditySCU (account,
+                                    xaccSplitGetAmount (pdata->split).denom);
     }
 
-    /* OK.  For some messed up reason this is getting called again with a
-       NULL tag.  So we ignore those cases */
-    if (!tag)
+    xaccAccountInsertSplit (account, pdata->split);
+    return TRUE;
+}
+
+static gboolean
+spl_sax_lot_end_handler (gpointer data_for_children,
+                         GSList* data_from_children, GSList* sibling_data,
+                         gpointer parent_data, gpointer global_data,
+                         gpointer* result, const gchar* tag)
+{
+    struct split_pdata* pdata = static_cast<decltype (pdata)> (parent_data);
+    GncGUID id = *guid_null ();
+    GNCLot* lot;
+
+    sax_chars_to_guid (data_from_children, &id);
+
+    lot = gnc_lot_lookup (&id, pdata->book);
+    if (!lot && gnc_transaction_xml_v2_testing &&
+        !guid_equal (&id, guid_null ()))
     {
+        lot = gnc_lot_new (pdata->book);
+        gnc_lot_set_guid (lot, id);
+    }
+
+    gnc_lot_add_split (lot, pdata->split);
+    return TRUE;
+}
+
+static gboolean
+spl_sax_slots_end_handler (gpointer data_for_children,
+                           GSList* data_from_children, GSList* sibling_data,
+                           gpointer parent_data, gpointer global_data,
+                           gpointer* result, const gchar* tag)
+{
+    struct split_pdata* pdata = static_cast<decltype (pdata)> (parent_data);
+    xmlNodePtr tree = (xmlNodePtr) data_for_children;
+    gboolean successful;
+
+    successful = dom_tree_create_instance_slots (tree,
+                                                 QOF_INSTANCE (pdata->split));
+    xmlFreeNode (tree);
+
+    g_return_val_if_fail (successful, FALSE);
+    return TRUE;
+}
+
+static gboolean
+spl_sax_start_handler (GSList* sibling_data, gpointer parent_data,
+                       gpointer global_data, gpointer* data_for_children,
+                       gpointer* result, const gchar* tag, gchar** attrs)
+{
+    struct trans_pdata* tdata = static_cast<decltype (tdata)> (parent_data);
+    struct split_pdata* pdata;
+
+    g_return_val_if_fail (tdata, FALSE);
+
+    pdata = g_new0 (struct split_pdata, 1);
+    pdata->book = tdata->book;
+    pdata->split = xaccMallocSplit (pdata->book);
+    *data_for_children = pdata;
+
+    return TRUE;
+}
+
+static gboolean
+spl_sax_end_handler (gpointer data_for_children,
+                     GSList* data_from_children, GSList* sibling_data,
+                     gpointer parent_data, gpointer global_data,
+                     gpointer* result, const gchar* tag)
+{
+    struct trans_pdata* tdata = static_cast<decltype (tdata)> (parent_data);
+    struct split_pdata* pdata =
+        static_cast<decltype (pdata)> (data_for_children);
+    Split* spl;
+    gboolean successful;
+
+    g_return_val_if_fail (pdata, FALSE);
+
+    spl = pdata->split;
+    successful = (pdata->seen & SPL_SEEN_REQUIRED) == SPL_SEEN_REQUIRED;
+    g_free (pdata);
+
+    /* As with dom_tree_to_split, a bad split is dropped rather than
+       taking the whole transaction down with it. */
+    if (!successful)
+    {
+        PERR ("didn't find all of the expected tags in the input");
+        xaccSplitDestroy (spl);
         return TRUE;
     }
 
-    g_return_val_if_fail (tree, FALSE);
+    xaccTransAppendSplit (tdata->trans, spl);
+    return TRUE;
+}
+
+static void
+spl_sax_fail_handler (gpointer data_for_children,
+                      GSList* data_from_children, GSList* sibling_data,
+                      gpointer parent_data, gpointer global_data,
+                      gpointer* result, const gchar* tag)
+{
+    struct split_pdata* pdata =
+        static_cast<decltype (pdata)> (data_for_children);
+
+    if (!pdata) return;
 
-    trn = dom_tree_to_transaction (tree,
-                                   static_cast<QofBook*> (gdata->bookdata));
-    if (trn != NULL)
+    xaccSplitDestroy (pdata->split);
+    g_free (pdata);
+}
+
+static sixtp*
+gnc_split_sax_parser_new (void)
+{
+    sixtp* top_level;
+
+    if (! (top_level =
+               sixtp_set_any (sixtp_new (), FALSE,
+                              SIXTP_START_HANDLER_ID, spl_sax_start_handler,
+                              SIXTP_END_HANDLER_ID, spl_sax_end_handler,
+                              SIXTP_FAIL_HANDLER_ID, spl_sax_fail_handler,
+                              SIXTP_NO_MORE_HANDLERS)))
+    {
+        return NULL;
+    }
+
+    if (!sixtp_add_some_sub_parsers (
+            top_level, TRUE,
+            "split:id", restore_char_generator (spl_sax_id_end_handler),
+            "split:memo", restore_char_generator (spl_sax_memo_end_handler),
+            "split:action",
+            restore_char_generator (spl_sax_action_end_handler),
+            "split:reconciled-state",
+            restore_char_generator (spl_sax_reconciled_state_end_handler),
+            "split:reconcile-date",
+            sax_time64_parser_new (spl_sax_reconcile_date_end_handler),
+            "split:value", restore_char_generator (spl_sax_value_end_handler),
+            "split:quantity",
+            restore_char_generator (spl_sax_quantity_end_handler),
+            "split:account",
+            restore_char_generator (spl_sax_account_end_handler),
+            "split:lot", restore_char_generator (spl_sax_lot_end_handler),
+            "split:slots",
+            sixtp_dom_subtree_parser_new (spl_sax_slots_end_handler),
+            NULL, NULL))
+    {
+        return NULL;
+    }
+
+    return top_level;
+}
+
+/***********************************************************************/
+/* <gnc:transaction> */
+
+static inline gboolean
+sax_set_tran_string (GSList* data_from_children, gpointer parent_data,
+                     void (*func) (Transaction* trn, const char* txt))
+{
+    struct trans_pdata* pdata = static_cast<decltype (pdata)> (parent_data);
+    gchar* txt;
+
+    g_return_val_if_fail (pdata, FALSE);
+
+    txt = concatenate_child_result_chars (data_from_children);
+    g_return_val_if_fail (txt, FALSE);
+
+    func (pdata->trans, txt);
+
+    g_free (txt);
+    return TRUE;
+}
+
+static gboolean
+trn_sax_id_end_handler (gpointer data_for_children,
+                        GSList* data_from_children, GSList* sibling_data,
+                        gpointer parent_data, gpointer global_data,
+                        gpointer* result, const gchar* tag)
+{
+    struct trans_pdata* pdata = static_cast<decltype (pdata)> (parent_data);
+    GncGUID guid = *xaccTransGetGUID (pdata->trans);
+
+    sax_chars_to_guid (data_from_children, &guid);
+    xaccTransSetGUID (pdata->trans, &guid);
+    pdata->seen |= TRN_SEEN_ID;
+    return TRUE;
+}
+
+static gboolean
+trn_sax_currency_end_handler (gpointer data_for_children,
+                              GSList* data_from_children, GSList* sibling_data,
+                              gpointer parent_data, gpointer global_data,
+                              gpointer* result, const gchar* tag)
+{
+    struct trans_pdata* pdata = static_cast<decltype (pdata)> (parent_data);
+    const gchar* space = sax_child_chars (data_from_children, "cmdty:space");
+    const gchar* id = sax_child_chars (data_from_children, "cmdty:id");
+    gnc_commodity* ref = NULL;
+
+    if (space && id)
     {
-        gdata->cb (tag, gdata->parsedata, trn);
+        gchar* space_str = g_strstrip (g_strdup (space));
+        gchar* id_str = g_strstrip (g_strdup (id));
+
+        ref = gnc_commodity_table_lookup (
+                  gnc_commodity_table_get_table (pdata->book),
+                  space_str, id_str);
+        if (!ref)
+            PERR ("unknown commodity %s::%s", space_str, id_str);
+
+        g_free (space_str);
+        g_free (id_str);
     }
 
+    xaccTransSetCurrency (pdata->trans, ref);
+    return TRUE;
+}
+
+static gboolean
+trn_sax_num_end_handler (gpointer data_for_children,
+                         GSList* data_from_children, GSList* sibling_data,
+                         gpointer parent_data, gpointer global_data,
+                         gpointer* result, const gchar* tag)
+{
+    return sax_set_tran_string (data_from_children, parent_data,
+                                xaccTransSetNum);
+}
+
+static gboolean
+trn_sax_date_posted_end_handler (gpointer data_for_children,
+                                 GSList* data_from_children,
+                                 GSList* sibling_data,
+                                 gpointer parent_data, gpointer global_data,
+                                 gpointer* result, const gchar* tag)
+{
+    struct trans_pdata* pdata = static_cast<decltype (pdata)> (parent_data);
+
+    xaccTransSetDatePostedSecs (pdata->trans,
+                                sax_children_to_time64 (data_from_children,
+                                                        tag));
+    pdata->seen |= TRN_SEEN_DATE_POSTED;
+    return TRUE;
+}
+
+static gboolean
+trn_sax_date_entered_end_handler (gpointer data_for_children,
+                                  GSList* data_from_children,
+                                  GSList* sibling_data,
+                                  gpointer parent_data, gpointer global_data,
+                                  gpointer* result, const gchar* tag)
+{
+    struct trans_pdata* pdata = static_cast<decltype (pdata)> (parent_data);
+
+    xaccTransSetDateEnteredSecs (pdata->trans,
+                                 sax_children_to_time64 (data_from_children,
+                                                         tag));
+    pdata->seen |= TRN_SEEN_DATE_ENTERED;
+    return TRUE;
+}
+
+static gboolean
+trn_sax_description_end_handler (gpointer data_for_children,
+                                 GSList* data_from_children,
+                                 GSList* sibling_data,
+                                 gpointer parent_data, gpointer global_data,
+                                 gpointer* result, const gchar* tag)
+{
+    return sax_set_tran_string (data_from_children, parent_data,
+                                xaccTransSetDescription);
+}
+
+static gboolean
+trn_sax_slots_end_handler (gpointer data_for_children,
+                           GSList* data_from_children, GSList* sibling_data,
+                           gpointer parent_data, gpointer global_data,
+                           gpointer* result, const gchar* tag)
+{
+    struct trans_pdata* pdata = static_cast<decltype (pdata)> (parent_data);
+    xmlNodePtr tree = (xmlNodePtr) data_for_children;
+    gboolean successful;
+
+    successful = dom_tree_create_instance_slots (tree,
+                                                 QOF_INSTANCE (pdata->trans));
     xmlFreeNode (tree);
 
-    return trn != NULL;
+    g_return_val_if_fail (successful, FALSE);
+    return TRUE;
 }
 
-Transaction*
-dom_tree_to_transaction (xmlNodePtr node, QofBook* book)
+/* <trn:splits> just hands the transaction on to each <trn:split>. */
+static gboolean
+trn_sax_splits_start_handler (GSList* sibling_data, gpointer parent_data,
+                              gpointer global_data,
+                              gpointer* data_for_children, gpointer* result,
+                              const gchar* tag, gchar** attrs)
 {
+    g_return_val_if_fail (parent_data, FALSE);
+    *data_for_children = parent_data;
+    return TRUE;
+}
+
+static gboolean
+trn_sax_splits_end_handler (gpointer data_for_children,
+                            GSList* data_from_children, GSList* sibling_data,
+                            gpointer parent_data, gpointer global_data,
+                            gpointer* result, const gchar* tag)
+{
+    struct trans_pdata* pdata = static_cast<decltype (pdata)> (parent_data);
+
+    pdata->seen |= TRN_SEEN_SPLITS;
+    return TRUE;
+}
+
+static gboolean
+gnc_transaction_start_handler (GSList* sibling_data, gpointer parent_data,
+                               gpointer global_data,
+                               gpointer* data_for_children, gpointer* result,
+                               const gchar* tag, gchar** attrs)
+{
+    gxpf_data* gdata = (gxpf_data*)global_data;
+    struct trans_pdata* pdata;
+    QofBook* book = static_cast<QofBook*> (gdata->bookdata);
+
+    g_return_val_if_fail (book, FALSE);
+
+    pdata = g_new0 (struct trans_pdata, 1);
+    pdata->book = book;
+    pdata->trans = xaccMallocTransaction (book);
+    xaccTransBeginEdit (pdata->trans);
+    *data_for_children = pdata;
+
+    return TRUE;
+}
+
+static gboolean
+gnc_transaction_end_handler (gpointer data_for_children,
+                             GSList* data_from_children, GSList* sibling_data,
+                             gpointer parent_data, gpointer global_data,
+                             gpointer* result, const gchar* tag)
+{
+    struct trans_pdata* pdata =
+        static_cast<decltype (pdata)> (data_for_children);
+    gxpf_data* gdata = (gxpf_data*)global_data;
     Transaction* trn;
     gboolean successful;
-    struct trans_pdata pdata;
 
-    g_return_val_if_fail (node, NULL);
-    g_return_val_if_fail (book, NULL);
-
-    trn = xaccMallocTransaction (book);
-    g_return_val_if_fail (trn, NULL);
-    xaccTransBeginEdit (trn);
+    /* When this parser is the top level one, its end handler is run once
+       more at the end of the document with a NULL tag.  Ignore that. */
+    if (!tag)
+    {
+        return TRUE;
+    }
 
-    pdata.trans = trn;
-    pdata.book = book;
+    g_return_val_if_fail (pdata, FALSE);
 
-    successful = dom_tree_generic_parse (node, trn_dom_handlers, &pdata);
+    trn = pdata->trans;
+    successful = (pdata->seen & TRN_SEEN_REQUIRED) == TRN_SEEN_REQUIRED;
+    g_free (pdata);
 
     xaccTransCommitEdit (trn);
 
     if (!successful)
     {
-        xmlElemDump (stdout, NULL, node);
+        PERR ("didn't find all of the expected tags in the input");
         xaccTransBeginEdit (trn);
         xaccTransDestroy (trn);
         xaccTransCommitEdit (trn);
-        trn = NULL;
+        return FALSE;
     }
 
-    return trn;
+    gdata->cb (tag, gdata->parsedata, trn);
+    return TRUE;
+}
+
+static void
+gnc_transaction_fail_handler (gpointer data_for_children,
+                              GSList* data_from_children, GSList* sibling_data,
+                              gpointer parent_data, gpointer global_data,
+                              gpointer* result, const gchar* tag)
+{
+    struct trans_pdata* pdata =
+        static_cast<decltype (pdata)> (data_for_children);
+
+    if (!pdata) return;
+
+    xaccTransDestroy (pdata->trans);
+    xaccTransCommitEdit (pdata->trans);
+    g_free (pdata);
 }
 
 sixtp*
 gnc_transaction_sixtp_parser_create (void)
 {
-    return sixtp_dom_parser_new (gnc_transaction_end_handler, NULL, NULL);
+    sixtp* top_level;
+    sixtp* currency_pr;
+    sixtp* splits_pr;
+
+    if (! (top_level =
+               sixtp_set_any (sixtp_new (), FALSE,
+                              SIXTP_START_HANDLER_ID,
+                              gnc_transaction_start_handler,
+                              SIXTP_END_HANDLER_ID,
+                              gnc_transaction_end_handler,
+                              SIXTP_FAIL_HANDLER_ID,
+                              gnc_transaction_fail_handler,
+                              SIXTP_NO_MORE_HANDLERS)))
+    {
+        return NULL;
+    }
+
+    if (! (currency_pr =
+               sixtp_set_any (sixtp_new (), FALSE,
+                              SIXTP_END_HANDLER_ID,
+                              trn_sax_currency_end_handler,
+                              SIXTP_NO_MORE_HANDLERS)) ||
+        !sixtp_add_some_sub_parsers (
+            currency_pr, TRUE,
+            "cmdty:space", simple_chars_only_parser_new (NULL),
+            "cmdty:id", simple_chars_only_parser_new (NULL),
+            SIXTP_MAGIC_CATCHER,
+            sixtp_dom_subtree_parser_new (sax_discard_end_handler),
+            NULL, NULL))
+    {
+        sixtp_destroy (top_level);
+        return NULL;
+    }
+
+    if (! (splits_pr =
+               sixtp_set_any (sixtp_new (), FALSE,
+                              SIXTP_START_HANDLER_ID,
+                              trn_sax_splits_start_handler,
+                              SIXTP_END_HANDLER_ID,
+                              trn_sax_splits_end_handler,
+                              SIXTP_NO_MORE_HANDLERS)) ||
+        !sixtp_add_sub_parser (splits_pr, "trn:split",
+                               gnc_split_sax_parser_new ()))
+    {
+        sixtp_destroy (currency_pr);
+        sixtp_destroy (top_level);
+        return NULL;
+    }
+
+    if (!sixtp_add_some_sub_parsers (
+            top_level, TRUE,
+            "trn:id", restore_char_generator (trn_sax_id_end_handler),
+            "trn:currency", currency_pr,
+            "trn:num", restore_char_generator (trn_sax_num_end_handler),
+            "trn:date-posted",
+            sax_time64_parser_new (trn_sax_date_posted_end_handler),
+            "trn:date-entered",
+            sax_time64_parser_new (trn_sax_date_entered_end_handler),
+            "trn:description",
+            restore_char_generator (trn_sax_description_end_handler),
+            "trn:slots",
+            sixtp_dom_subtree_parser_new (trn_sax_slots_end_handler),
+            "trn:splits", splits_pr,
+            NULL, NULL))
+    {
+        return NULL;
+    }
+
+    /* So that the parser also copes with being handed a whole file whose
+       top element is the transaction, as the tests do; the DOM parser's
+       catch-all used to take care of that. */
+    sixtp_add_sub_parser (top_level, "gnc:transaction", top_level);
+
+    return top_level;
 }
@@ -33,12 +33,17 @@ extern "C"
 
 #include <gnc-engine.h> //for GNC_MOD_BACKEND
 #include <gnc-uri-utils.h>
+#include <gnc-book-archive.h>
 #include <TransLog.h>
+#include <Transaction.h>
+#include <Account.h>
+#include <SX-book.h>
 #include <gnc-prefs.h>
 
 }
 
 #include <sstream>
+#include <system_error>
 
 #include "gnc-xml-backend.hpp"
 #include "gnc-backend-xml.h"
@@ -49,6 +54,9 @@ extern "C"
 #define FILE_URI_PREFIX "file://"
 static QofLogModule log_module = GNC_MOD_BACKEND;
 
+/* Past this size the journal is folded into the data file at the next save. */
+constexpr gint64 journal_compact_size = 8 * 1024 * 1024;
+
 bool
 GncXmlBackend::check_path (const char* fullpath, bool create)
 {
@@ -129,6 +137,8 @@ GncXmlBackend::session_begin(QofSession* session, const char* new_uri,
                     mode == SESSION_NEW_STORE || mode == SESSION_NEW_OVERWRITE))
         return;
     m_dirname = g_path_get_dirname (m_fullpath.c_str());
+    m_journal = m_fullpath + ".journal";
+    m_snapshot = m_fullpath + ".snapshot";
 
 
 
@@ -153,9 +163,17 @@ GncXmlBackend::session_begin(QofSession* session, const char* new_uri,
     }
 }
 
+GncXmlBackend::~GncXmlBackend()
+{
+    finish_background_sync ();
+    finish_remove_old_files ();
+}
+
 void
 GncXmlBackend::session_end()
 {
+    finish_background_sync ();
+    finish_remove_old_files ();
     if (m_book && qof_book_is_readonly (m_book))
     {
         set_error(ERR_BACKEND_READONLY);
@@ -188,6 +206,10 @@ GncXmlBackend::session_end()
     m_fullpath.clear();
     m_lockfile.clear();
     m_linkfile.clear();
+    m_journal.clear();
+    m_snapshot.clear();
+    m_journal_ok = false;
+    m_journal_pending.clear();
 }
 
 static QofBookFileType
@@ -225,6 +247,7 @@ GncXmlBackend::load(QofBook* book, QofBackendLoadType loadType)
 
     QofBackendError error;
 
+    finish_background_sync ();
     if (loadType != LOAD_TYPE_INITIAL_LOAD) return;
 
     error = ERR_BACKEND_NO_ERR;
@@ -241,6 +264,8 @@ GncXmlBackend::load(QofBook* book, QofBackendLoadType loadType)
             PWARN ("Syntax error in Xml File %s", m_fullpath.c_str());
             error = ERR_FILEIO_PARSE_ERROR;
         }
+        else if (!replay_journal ())
+            error = ERR_FILEIO_PARSE_ERROR;
         break;
 
     case GNC_BOOK_XML2_FILE_NO_ENCODING:
@@ -286,14 +311,43 @@ GncXmlBackend::load(QofBook* book, QofBackendLoadType loadType)
     {
         set_error(error);
     }
+    else
+    {
+        /* Stand in for the transactions moved to an archive file. */
+        gnc_book_archive_set_start_balances (book);
+    }
 
     /* We just got done loading, it can't possibly be dirty !! */
     qof_book_mark_session_saved (book);
 }
 
+/* Only plain version 2 files can be streamed: a journal could change
+ * transactions already written, and older files are read some other way. */
+bool
+GncXmlBackend::load_streaming(QofBook* book, QofBackend* target)
+{
+    finish_background_sync ();
+    if (determine_file_type (m_fullpath) != GNC_BOOK_XML2_FILE ||
+        g_file_test (m_journal.c_str(), G_FILE_TEST_EXISTS))
+        return false;
+
+    m_book = book;
+    if (!qof_session_stream_from_xml_file_v2 (this, book, target))
+    {
+        PWARN ("Syntax error in Xml File %s", m_fullpath.c_str());
+        set_error (ERR_FILEIO_PARSE_ERROR);
+    }
+    /* Nothing was replayed, so there's nothing the journal could add to. */
+    m_journal_pending.clear ();
+    m_journal_ok = false;
+    qof_book_mark_session_saved (book);
+    return true;
+}
+
 void
 GncXmlBackend::sync(QofBook* book)
 {
+    finish_background_sync ();
         /* We make an important assumption here, that we might want to change
      * in the future: when the user says 'save', we really save the one,
      * the only, the current open book, and nothing else. In any case the plans
@@ -310,6 +364,9 @@ GncXmlBackend::sync(QofBook* book)
         return;
     }
 
+    if (write_to_journal ())
+        return;
+
     write_to_file (true);
     remove_old_files();
 }
@@ -317,10 +374,160 @@ GncXmlBackend::sync(QofBook* book)
 void
 GncXmlBackend::commit(QofInstance* instance)
 {
+    if (m_journal_ok)
+    {
+        /* Splits are written with their transaction, which is committed
+         * along with them. */
+        if (GNC_IS_TRANSACTION (instance))
+            m_journal_pending.insert (*qof_instance_get_guid (instance));
+        else if (!GNC_IS_SPLIT (instance) &&
+                 (qof_instance_is_dirty (instance) ||
+                  qof_instance_get_destroying (instance)))
+            m_journal_ok = false;
+    }
+
     if (qof_instance_is_dirty(instance))
         qof_instance_mark_clean(instance);
 }
 
+/* Template transactions are written with the scheduled transactions,
+ * not on their own. */
+static bool
+is_template_transaction (Transaction* trans)
+{
+    auto split = xaccTransGetSplit (trans, 0);
+    auto acc = split ? xaccSplitGetAccount (split) : nullptr;
+    return acc && gnc_account_get_root (acc) ==
+        gnc_book_get_template_root (xaccTransGetBook (trans));
+}
+
+/* Instances changed without being committed, which would never reach
+ * the journal.  Those still being edited don't count: they're committed
+ * later. */
+static GList*
+get_uncommitted_instances (QofBook* book)
+{
+    GList* uncommitted = nullptr;
+    auto dirty = qof_book_get_dirty_instances (book);
+    for (auto node = dirty; node; node = node->next)
+    {
+        auto inst = QOF_INSTANCE (node->data);
+        if (qof_instance_get_editlevel (inst) > 0)
+            continue;
+        if (GNC_IS_SPLIT (inst))
+        {
+            auto trans = xaccSplitGetParent (GNC_SPLIT (inst));
+            if (trans && xaccTransIsOpen (trans))
+                continue;
+        }
+        uncommitted = g_list_prepend (uncommitted, inst);
+    }
+    g_list_free (dirty);
+    return uncommitted;
+}
+
+/* Save by appending the transactions committed since the last save to
+ * the journal rather than writing the whole book.  Returns false if the
+ * whole book must be written instead: journaling is off, something other
+ * than transactions changed, or the journal is due to be compacted. */
+bool
+GncXmlBackend::write_to_journal ()
+{
+    if (!m_journal_ok || m_journal_pending.empty () ||
+        !gnc_prefs_get_file_save_journal ())
+        return false;
+
+    GStatBuf statbuf;
+    if (g_stat (m_journal.c_str(), &statbuf) == 0 &&
+        statbuf.st_size > journal_compact_size)
+        return false;
+
+    auto uncommitted = get_uncommitted_instances (m_book);
+    if (uncommitted)
+    {
+        g_list_free (uncommitted);
+        return false;
+    }
+
+    GList* guids = nullptr;
+    for (const auto& guid : m_journal_pending)
+    {
+        auto trans = xaccTransLookup (&guid, m_book);
+        if (trans && is_template_transaction (trans))
+        {
+            g_list_free (guids);
+            return false;
+        }
+        guids = g_list_prepend (guids, const_cast<GncGUID*> (&guid));
+    }
+
+    ENTER (" book=%p journal=%s", m_book, m_journal.c_str());
+    auto success = gnc_book_append_to_xml_journal (m_book, m_journal.c_str(),
+                                                   m_fullpath.c_str(), guids);
+    g_list_free (guids);
+    if (!success)
+    {
+        /* What did get written is superseded by the full write. */
+        PWARN ("Unable to append to journal %s, writing the whole book",
+               m_journal.c_str());
+        m_journal_ok = false;
+        LEAVE ("");
+        return false;
+    }
+
+    LEAVE (" appended %zu transactions", m_journal_pending.size ());
+    m_journal_pending.clear ();
+    qof_book_mark_session_saved (m_book);
+    return true;
+}
+
+/* Apply the journal left by earlier sessions to the book just loaded.
+ * Returns false if the journal can't be used: it's then left where it is
+ * for the user to look at and the load fails, because saving the book
+ * without it would lose the changes it holds. */
+bool
+GncXmlBackend::replay_journal ()
+{
+    m_journal_pending.clear ();
+    m_journal_ok = false;
+
+    if (!g_file_test (m_journal.c_str(), G_FILE_TEST_EXISTS))
+    {
+        m_journal_ok = true;
+        return true;
+    }
+
+    switch (gnc_book_replay_xml_journal (m_book, m_journal.c_str(),
+                                         m_fullpath.c_str()))
+    {
+    case GNC_JOURNAL_REPLAYED:
+        m_journal_ok = true;
+        return true;
+    case GNC_JOURNAL_BAD:
+        PWARN ("Unable to replay journal %s", m_journal.c_str());
+        return false;
+    case GNC_JOURNAL_STALE:
+        break;
+    }
+
+    /* The data file was written after the journal, so it already holds
+     * the journal's changes or replaced them.  Move the journal out of the
+     * way, the next save writes the whole book.  Leave it alone if the
+     * file was opened read-only. */
+    if (m_lockfile.empty())
+        return true;
+    auto timestamp = gnc_date_timestamp ();
+    auto rejected = m_fullpath + "." + timestamp + ".journal";
+    g_free (timestamp);
+    if (g_rename (m_journal.c_str(), rejected.c_str()) != 0)
+        PWARN ("unable to rename journal %s: %s", m_journal.c_str(),
+               g_strerror (errno) ? g_strerror (errno) : "");
+    else
+        PWARN ("Moved stale journal %s to %s", m_journal.c_str(),
+               rejected.c_str());
+    return true;
+}
+
 bool
 GncXmlBackend::save_may_clobber_data()
 {
@@ -334,6 +541,7 @@ GncXmlBackend::save_may_clobber_data()
 void
 GncXmlBackend::export_coa(QofBook* book)
 {
+    finish_background_sync ();
     auto out = fopen(m_fullpath.c_str(), "w");
     if (out == NULL)
     {
@@ -345,26 +553,10 @@ GncXmlBackend::export_coa(QofBook* book)
     fclose(out);
 }
 
-bool
-GncXmlBackend::write_to_file (bool make_backup)
+/* Name the temporary file a save writes next to the data file. */
+char*
+GncXmlBackend::make_temp_name ()
 {
-    QofBackendError be_err;
-
-    ENTER (" book=%p file=%s", m_book, m_fullpath.c_str());
-
-    if (m_book && qof_book_is_readonly (m_book))
-    {
-        /* Are we read-only? Don't continue in this case. */
-        set_error(ERR_BACKEND_READONLY);
-        LEAVE ("");
-        return FALSE;
-    }
-
-    /* If the book is 'clean', recently saved, then don't save again. */
-    /* XXX this is currently broken due to faulty 'Save As' logic. */
-    /* if (FALSE == qof_book_session_not_saved (book)) return FALSE; */
-
-
     auto tmp_name = g_new (char, strlen (m_fullpath.c_str()) + 12);
     strcpy (tmp_name, m_fullpath.c_str());
     strcat (tmp_name, ".tmp-XXXXXX");
@@ -379,143 +571,403 @@ GncXmlBackend::write_to_file (bool make_backup)
         g_free (tmp_name);
         set_error(ERR_BACKEND_MISC);
         set_message("Failed to make temp file");
-        LEAVE ("");
-        return FALSE;
+        return nullptr;
     }
+    return tmp_name;
+}
 
-    if (make_backup)
+static GncXmlCompression
+save_compression ()
+{
+    if (!gnc_prefs_get_file_save_compressed ())
+        return GNC_XML_COMPRESSION_NONE;
+    return gnc_prefs_get_file_save_zstd () ?
+        GNC_XML_COMPRESSION_ZSTD : GNC_XML_COMPRESSION_GZIP;
+}
+
+/* The helpers below also run on the background sync's thread, so they
+ * report failures in err and msg instead of on the backend. */
+
+/* Clean up after failing to write tmp_name. */
+static void
+remove_failed_temp_file (const char* tmp_name, QofBackendError& err,
+                         std::string& msg)
+{
+    if (g_unlink (tmp_name) != 0)
     {
-        if (!backup_file ())
+        switch (errno)
         {
-            g_free (tmp_name);
-            LEAVE ("");
-            return FALSE;
+        case ENOENT:     /* tmp_name doesn't exist?  Assume "RO" error */
+        case EACCES:
+        case EPERM:
+        case ENOSYS:
+        case EROFS:
+            err = ERR_BACKEND_READONLY;
+            break;
+        default:
+            err = ERR_BACKEND_MISC;
+            break;
         }
+        PWARN ("unable to unlink temp_filename %s: %s",
+               tmp_name ? tmp_name : "(null)",
+               g_strerror (errno) ? g_strerror (errno) : "");
+        /* already in an error just flow on through */
     }
+    else
+    {
+        /* Use a generic write error code */
+        err = ERR_FILEIO_WRITE_ERROR;
+        msg = std::string{"Unable to write to temp file "} +
+            (tmp_name ? tmp_name : "NULL");
+    }
+}
 
-    if (gnc_book_write_to_xml_file_v2 (m_book, tmp_name,
-                                       gnc_prefs_get_file_save_compressed ()))
+/* Put the fully written tmp_name in place of the data file fullpath,
+ * which is moved to backup unless that's empty. */
+static bool
+replace_data_file (const std::string& fullpath, const char* tmp_name,
+                   const std::string& backup, QofBackendError& err,
+                   std::string& msg)
+{
+    /* Record the file's permissions before g_unlinking it */
+    GStatBuf statbuf;
+    auto rc = g_stat (fullpath.c_str(), &statbuf);
+    if (rc == 0)
     {
-        /* Record the file's permissions before g_unlinking it */
-        GStatBuf statbuf;
-        auto rc = g_stat (m_fullpath.c_str(), &statbuf);
-        if (rc == 0)
-        {
-            /* We must never chmod the file /dev/null */
-            g_assert (g_strcmp0 (tmp_name, "/dev/null") != 0);
+        /* We must never chmod the file /dev/null */
+        g_assert (g_strcmp0 (tmp_name, "/dev/null") != 0);
 
-            /* Use the permissions from the original data file */
-            if (g_chmod (tmp_name, statbuf.st_mode) != 0)
-            {
-                /* set_error(ERR_BACKEND_PERM); */
-                /* set_message("Failed to chmod filename %s", tmp_name ); */
-                /* Even if the chmod did fail, the save
-                   nevertheless completed successfully. It is
-                   therefore wrong to signal the ERR_BACKEND_PERM
-                   error here which implies that the saving itself
-                   failed. Instead, we simply ignore this. */
-                PWARN ("unable to chmod filename %s: %s",
-                       tmp_name ? tmp_name : "(null)",
-                       g_strerror (errno) ? g_strerror (errno) : "");
-#if VFAT_DOESNT_SUCK  /* chmod always fails on vfat/samba fs */
-                /* g_free(tmp_name); */
-                /* return FALSE; */
-#endif
-            }
-#ifdef HAVE_CHOWN
-            /* Don't try to change the owner. Only root can do
-               that. */
-            if (chown (tmp_name, -1, statbuf.st_gid) != 0)
-            {
-                /* set_error(ERR_BACKEND_PERM); */
-                /* set_message("Failed to chown filename %s", tmp_name ); */
-                /* A failed chown doesn't mean that the saving itself
-                failed. So don't abort with an error here! */
-                PWARN ("unable to chown filename %s: %s",
-                       tmp_name ? tmp_name : "(null)",
-                       strerror (errno) ? strerror (errno) : "");
-#if VFAT_DOESNT_SUCK /* chown always fails on vfat fs */
-                /* g_free(tmp_name);
-                return FALSE; */
-#endif
-            }
-#endif
-        }
-        if (g_unlink (m_fullpath.c_str()) != 0 && errno != ENOENT)
+        /* Use the permissions from the original data file */
+        if (g_chmod (tmp_name, statbuf.st_mode) != 0)
         {
-            set_error(ERR_BACKEND_READONLY);
-            PWARN ("unable to unlink filename %s: %s",
-                   m_fullpath.empty() ? "(null)" : m_fullpath.c_str(),
+            /* Even if the chmod did fail, the save
+               nevertheless completed successfully. It is
+               therefore wrong to signal the ERR_BACKEND_PERM
+               error here which implies that the saving itself
+               failed. Instead, we simply ignore this. */
+            PWARN ("unable to chmod filename %s: %s",
+                   tmp_name ? tmp_name : "(null)",
                    g_strerror (errno) ? g_strerror (errno) : "");
-            g_free (tmp_name);
-            LEAVE ("");
-            return FALSE;
         }
-        if (!link_or_make_backup (tmp_name, m_fullpath))
+#ifdef HAVE_CHOWN
+        /* Don't try to change the owner. Only root can do
+           that. */
+        if (chown (tmp_name, -1, statbuf.st_gid) != 0)
         {
-            set_error(ERR_FILEIO_BACKUP_ERROR);
-            std::string msg{"Failed to make backup file "};
-            set_message(msg + (m_fullpath.empty() ? "NULL" : m_fullpath));
-            g_free (tmp_name);
-            LEAVE ("");
-            return FALSE;
+            /* A failed chown doesn't mean that the saving itself
+            failed. So don't abort with an error here! */
+            PWARN ("unable to chown filename %s: %s",
+                   tmp_name ? tmp_name : "(null)",
+                   strerror (errno) ? strerror (errno) : "");
         }
-        if (g_unlink (tmp_name) != 0)
+#endif
+    }
+    /* Moving the old data file aside makes it the backup without
+     * copying it, even where hard links aren't supported. */
+    if (!backup.empty ())
+    {
+        if (g_rename (fullpath.c_str(), backup.c_str()) != 0)
         {
-            set_error(ERR_BACKEND_PERM);
-            PWARN ("unable to unlink temp filename %s: %s",
-                   tmp_name ? tmp_name : "(null)",
+            err = ERR_FILEIO_BACKUP_ERROR;
+            PWARN ("unable to make file backup from %s to %s: %s",
+                   fullpath.c_str(), backup.c_str(),
                    g_strerror (errno) ? g_strerror (errno) : "");
+            msg = std::string{"Failed to make backup file "} + backup;
+            g_unlink (tmp_name);
+            return false;
+        }
+    }
+    else if (g_unlink (fullpath.c_str()) != 0 && errno != ENOENT)
+    {
+        err = ERR_BACKEND_READONLY;
+        PWARN ("unable to unlink filename %s: %s",
+               fullpath.empty() ? "(null)" : fullpath.c_str(),
+               g_strerror (errno) ? g_strerror (errno) : "");
+        return false;
+    }
+    if (g_rename (tmp_name, fullpath.c_str()) != 0)
+    {
+        err = ERR_FILEIO_WRITE_ERROR;
+        PWARN ("unable to rename %s to %s: %s", tmp_name, fullpath.c_str(),
+               g_strerror (errno) ? g_strerror (errno) : "");
+        msg = std::string{"Unable to rename temp file "} + tmp_name;
+        return false;
+    }
+    return true;
+}
+
+/* Bring the journal and snapshot up to date with the data file just
+ * written.  Returns whether the journal is gone, so that one can be
+ * started afresh. */
+static bool
+data_file_replaced (const std::string& fullpath, const std::string& journal,
+                    const std::string& snapshot,
+                    GncXmlCompression compression)
+{
+    /* The data file now holds everything the journal did.  A journal
+     * that can't be removed would be stamped for the old data file,
+     * so don't append to it. */
+    auto journal_removed = g_unlink (journal.c_str()) == 0 || errno == ENOENT;
+    if (!journal_removed)
+        PWARN ("unable to unlink journal %s: %s", journal.c_str(),
+               g_strerror (errno) ? g_strerror (errno) : "");
+
+    /* Any snapshot is of the old data file now.  Replace it, or
+     * remove it rather than leave it to be hashed and rejected. */
+    if (compression != GNC_XML_COMPRESSION_NONE &&
+        gnc_prefs_get_file_save_snapshot ())
+    {
+        if (!gnc_book_write_xml_snapshot (fullpath.c_str(), snapshot.c_str()))
+            PWARN ("unable to write snapshot %s", snapshot.c_str());
+    }
+    else if (g_unlink (snapshot.c_str()) != 0 && errno != ENOENT)
+    {
+        PWARN ("unable to unlink snapshot %s: %s", snapshot.c_str(),
+               g_strerror (errno) ? g_strerror (errno) : "");
+    }
+    return journal_removed;
+}
+
+static void
+mark_book_saved (QofBook* book)
+{
+    /* Whatever was changed without a commit is in the data file too. */
+    auto uncommitted = get_uncommitted_instances (book);
+    for (auto node = uncommitted; node; node = node->next)
+        qof_instance_mark_clean (QOF_INSTANCE (node->data));
+    g_list_free (uncommitted);
+
+    qof_book_mark_session_saved (book);
+}
+
+bool
+GncXmlBackend::write_to_file (bool make_backup)
+{
+    QofBackendError err = ERR_BACKEND_NO_ERR;
+    std::string msg;
+
+    ENTER (" book=%p file=%s", m_book, m_fullpath.c_str());
+
+    /* Don't let the last save's cleanup race this one's backup. */
+    finish_remove_old_files ();
+
+    if (m_book && qof_book_is_readonly (m_book))
+    {
+        /* Are we read-only? Don't continue in this case. */
+        set_error(ERR_BACKEND_READONLY);
+        LEAVE ("");
+        return FALSE;
+    }
+
+    /* If the book is 'clean', recently saved, then don't save again. */
+    /* XXX this is currently broken due to faulty 'Save As' logic. */
+    /* if (FALSE == qof_book_session_not_saved (book)) return FALSE; */
+
+    auto tmp_name = make_temp_name ();
+    if (!tmp_name)
+    {
+        LEAVE ("");
+        return FALSE;
+    }
+
+    std::string backup;
+    if (make_backup)
+    {
+        if (!backup_file (backup))
+        {
             g_free (tmp_name);
             LEAVE ("");
             return FALSE;
         }
+    }
+
+    auto compression = save_compression ();
+    if (!gnc_book_write_to_xml_file_v2 (m_book, tmp_name, compression))
+    {
+        remove_failed_temp_file (tmp_name, err, msg);
+        set_error(err);
+        if (!msg.empty ())
+            set_message(std::move (msg));
         g_free (tmp_name);
+        LEAVE ("");
+        return FALSE;
+    }
 
-        /* Since we successfully saved the book,
-         * we should mark it clean. */
-        qof_book_mark_session_saved (m_book);
-        LEAVE (" successful save of book=%p to file=%s", m_book,
-               m_fullpath.c_str());
-        return TRUE;
+    if (!replace_data_file (m_fullpath, tmp_name, backup, err, msg))
+    {
+        set_error(err);
+        if (!msg.empty ())
+            set_message(std::move (msg));
+        g_free (tmp_name);
+        LEAVE ("");
+        return FALSE;
     }
-    else
+    g_free (tmp_name);
+
+    m_journal_pending.clear ();
+    m_journal_ok = data_file_replaced (m_fullpath, m_journal, m_snapshot,
+                                       compression);
+
+    /* Since we successfully saved the book,
+     * we should mark it clean. */
+    mark_book_saved (m_book);
+    LEAVE (" successful save of book=%p to file=%s", m_book,
+           m_fullpath.c_str());
+    return TRUE;
+}
+
+/* Write the book uncompressed to a new file in the temporary directory,
+ * named in spool even if writing it fails. */
+bool
+GncXmlBackend::write_spool_file (std::string& spool)
+{
+    GError* error = nullptr;
+    gchar* name = nullptr;
+    auto fd = g_file_open_tmp ("gnucash-save-XXXXXX.xml", &name, &error);
+    if (fd < 0)
     {
-        if (g_unlink (tmp_name) != 0)
-        {
-            switch (errno)
-            {
-            case ENOENT:     /* tmp_name doesn't exist?  Assume "RO" error */
-            case EACCES:
-            case EPERM:
-            case ENOSYS:
-            case EROFS:
-                be_err = ERR_BACKEND_READONLY;
-                break;
-            default:
-                be_err = ERR_BACKEND_MISC;
-                break;
-            }
-            set_error(be_err);
-            PWARN ("unable to unlink temp_filename %s: %s",
-                   tmp_name ? tmp_name : "(null)",
-                   g_strerror (errno) ? g_strerror (errno) : "");
-            /* already in an error just flow on through */
-        }
+        PWARN ("unable to make a spool file: %s", error->message);
+        g_error_free (error);
+        return false;
+    }
+    spool = name;
+    g_free (name);
+
+    auto out = fdopen (fd, "wb");
+    if (!out)
+    {
+        close (fd);
+        return false;
+    }
+    auto success = gnc_book_write_to_xml_filehandle_v2 (m_book, out);
+    if (fclose (out) != 0)
+        success = FALSE;
+    return success;
+}
+
+/* A background sync writes the book out on the calling thread, straight
+ * to the temporary file if it isn't to be compressed and to a spool file
+ * otherwise.  The thread then compresses the spool file into the
+ * temporary file, if need be, and replaces the data file with it.  The
+ * book is marked saved as soon as it's been written out; should the
+ * rest fail, finish_background_sync() marks it dirty again. */
+bool
+GncXmlBackend::begin_background_sync (QofBook* book,
+                                      std::function<void()> done)
+{
+    finish_background_sync ();
+    if (m_book == nullptr) m_book = book;
+    if (book != m_book || qof_book_is_readonly (m_book))
+        return false;
+
+    ENTER (" book=%p file=%s", m_book, m_fullpath.c_str());
+    if (write_to_journal ())
+    {
+        done ();
+        LEAVE (" journaled");
+        return true;
+    }
+
+    finish_remove_old_files ();
+    std::string backup, spool;
+    auto tmp_name = make_temp_name ();
+    if (!tmp_name || !backup_file (backup))
+    {
+        g_free (tmp_name);
+        done ();
+        LEAVE ("");
+        return true;
+    }
+
+    auto compression = save_compression ();
+    auto written = compression == GNC_XML_COMPRESSION_NONE ?
+        gnc_book_write_to_xml_file_v2 (m_book, tmp_name, compression) :
+        write_spool_file (spool);
+    if (!written)
+    {
+        QofBackendError err = ERR_BACKEND_NO_ERR;
+        std::string msg;
+        if (spool.empty ())
+            remove_failed_temp_file (tmp_name, err, msg);
         else
         {
-            /* Use a generic write error code */
-            set_error(ERR_FILEIO_WRITE_ERROR);
-            std::string msg{"Unable to write to temp file "};
-            set_message(msg + (tmp_name ? tmp_name : "NULL"));
+            g_unlink (spool.c_str());
+            err = ERR_FILEIO_WRITE_ERROR;
+            msg = "Unable to write to spool file " + spool;
         }
+        set_error(err);
+        if (!msg.empty ())
+            set_message(std::move (msg));
         g_free (tmp_name);
+        done ();
         LEAVE ("");
-        return FALSE;
+        return true;
+    }
+
+    /* Changes from here on aren't in the file, so they can't go into a
+     * journal for it either. */
+    m_journal_pending.clear ();
+    m_journal_ok = false;
+    mark_book_saved (m_book);
+
+    m_background_err = ERR_BACKEND_NO_ERR;
+    m_background_msg.clear ();
+    m_background_journal_removed = false;
+    m_background_pending = true;
+    auto work = [this, tmp_name, backup, spool, compression, done] {
+        if (!spool.empty ())
+        {
+            if (!gnc_xml_write_compressed_copy (spool.c_str(), tmp_name,
+                                                compression))
+                remove_failed_temp_file (tmp_name, m_background_err,
+                                         m_background_msg);
+            g_unlink (spool.c_str());
+        }
+        if (m_background_err == ERR_BACKEND_NO_ERR &&
+            replace_data_file (m_fullpath, tmp_name, backup,
+                               m_background_err, m_background_msg))
+            m_background_journal_removed =
+                data_file_replaced (m_fullpath, m_journal, m_snapshot,
+                                    compression);
+        g_free (tmp_name);
+        done ();
+    };
+    try
+    {
+        m_background_sync = std::thread (work);
+    }
+    catch (const std::system_error& err)
+    {
+        PWARN ("can't start the save thread: %s", err.what ());
+        work ();
     }
-    g_free (tmp_name);
     LEAVE ("");
-    return TRUE;
+    return true;
+}
+
+void
+GncXmlBackend::finish_background_sync ()
+{
+    if (!m_background_pending)
+        return;
+    if (m_background_sync.joinable ())
+        m_background_sync.join ();
+    m_background_pending = false;
+
+    if (m_background_err != ERR_BACKEND_NO_ERR)
+    {
+        set_error(m_background_err);
+        if (!m_background_msg.empty ())
+            set_message(std::move (m_background_msg));
+        /* The book wasn't saved after all. */
+        qof_book_mark_session_dirty (m_book);
+        return;
+    }
+
+    /* A journal may be started only if nothing changed during the save. */
+    m_journal_ok = m_background_journal_removed &&
+        !qof_book_session_not_saved (m_book);
+    remove_old_files ();
 }
 
 static bool
@@ -738,13 +1190,17 @@ GncXmlBackend::get_file_lock ()
 #endif /* ifndef G_OS_WIN32 */
 }
 
+/* Make the binary-format backup, if there is one to make, and name the
+ * backup write_to_file() should move the data file to.  backup is left
+ * empty if there's no data file yet. */
 bool
-GncXmlBackend::backup_file()
+GncXmlBackend::backup_file(std::string& backup)
 {
     GStatBuf statbuf;
 
     auto datafile = m_fullpath.c_str();
 
+    backup.clear ();
     auto rc = g_stat (datafile, &statbuf);
     if (rc)
         return (errno == ENOENT);
@@ -761,30 +1217,43 @@ GncXmlBackend::backup_file()
     }
 
     auto timestamp = gnc_date_timestamp ();
-    auto backup = m_fullpath + "." + timestamp + GNC_DATAFILE_EXT;
+    backup = m_fullpath + "." + timestamp + GNC_DATAFILE_EXT;
     g_free (timestamp);
 
-    return link_or_make_backup (datafile, backup);
+    /* Renaming would replace a backup made in the same second. */
+    if (g_file_test (backup.c_str(), G_FILE_TEST_EXISTS))
+    {
+        set_error(ERR_FILEIO_BACKUP_ERROR);
+        PWARN ("backup file %s already exists", backup.c_str());
+        return false;
+    }
+    return true;
 }
 
-/*
- * Clean up any lock files from prior crashes, and clean up old
- * backup and log files.
- */
-
-void
-GncXmlBackend::remove_old_files ()
+/* The settings remove_old_files() gives its worker, so that the worker
+ * touches neither the backend nor the preferences. */
+struct OldFilesCleanup
 {
-    GStatBuf lockstatbuf, statbuf;
-
-    if (g_stat (m_lockfile.c_str(), &lockstatbuf) != 0)
-        return;
+    std::string dirname;
+    std::string fullpath;
+    std::string linkfile;
+    time_t lock_mtime;
+    gint retention_policy;
+    gint retention_days;
+    time64 now;
+};
+
+/* Runs on the cleanup thread, so it records what it removed in removed
+ * instead of logging it. */
+static void
+remove_old_files_in (const OldFilesCleanup& c, std::vector<std::string>& removed)
+{
+    GStatBuf statbuf;
 
-    auto dir = g_dir_open (m_dirname.c_str(), 0, NULL);
+    auto dir = g_dir_open (c.dirname.c_str(), 0, NULL);
     if (!dir)
         return;
 
-    auto now = gnc_time (NULL);
     const char* dent;
     while ((dent = g_dir_read_name (dir)) != NULL)
     {
@@ -797,17 +1266,17 @@ GncXmlBackend::remove_old_files ()
                g_str_has_suffix (dent, GNC_LOGFILE_EXT)))
             continue;
 
-        name = g_build_filename (m_dirname.c_str(), dent, (gchar*)NULL);
+        name = g_build_filename (c.dirname.c_str(), dent, (gchar*)NULL);
 
         /* Only evaluate files associated with the current data file. */
-        if (!g_str_has_prefix (name, m_fullpath.c_str()))
+        if (!g_str_has_prefix (name, c.fullpath.c_str()))
         {
             g_free (name);
             continue;
         }
 
         /* Never remove the current data file itself */
-        if (g_strcmp0 (name, m_fullpath.c_str()) == 0)
+        if (g_strcmp0 (name, c.fullpath.c_str()) == 0)
         {
             g_free (name);
             continue;
@@ -817,13 +1286,13 @@ GncXmlBackend::remove_old_files ()
         if (g_str_has_suffix (name, ".LNK"))
         {
             /* Is a lock file. Skip the active lock file */
-            if ((g_strcmp0 (name, m_linkfile.c_str()) != 0) &&
+            if ((g_strcmp0 (name, c.linkfile.c_str()) != 0) &&
                 /* Only delete lock files older than the active one */
                 (g_stat (name, &statbuf) == 0) &&
-                (statbuf.st_mtime < lockstatbuf.st_mtime))
+                (statbuf.st_mtime < c.lock_mtime) &&
+                g_unlink (name) == 0)
             {
-                PINFO ("remove stale lock file: %s", name);
-                g_unlink (name);
+                removed.emplace_back (name);
             }
 
             g_free (name);
@@ -844,7 +1313,7 @@ GncXmlBackend::remove_old_files ()
              * juggling, but considering the above tests, this should always
              * be safe */
             regex_t pattern;
-            gchar* stamp_start = name + strlen (m_fullpath.c_str());
+            gchar* stamp_start = name + strlen (c.fullpath.c_str());
             gchar* expression = g_strdup_printf ("^\\.[[:digit:]]{14}(\\%s|\\%s|\\.xac)$",
                                                  GNC_DATAFILE_EXT, GNC_LOGFILE_EXT);
             gboolean got_date_stamp = FALSE;
@@ -867,13 +1336,13 @@ GncXmlBackend::remove_old_files ()
         /* The file is a backup or log file. Check the user's retention preference
          * to determine if we should keep it or not
          */
-        if (gnc_prefs_get_file_retention_policy () == XML_RETAIN_NONE)
+        if (c.retention_policy == XML_RETAIN_NONE)
         {
-            PINFO ("remove stale file: %s  - reason: preference XML_RETAIN_NONE", name);
-            g_unlink (name);
+            if (g_unlink (name) == 0)
+                removed.emplace_back (name);
         }
-        else if ((gnc_prefs_get_file_retention_policy () == XML_RETAIN_DAYS) &&
-                 (gnc_prefs_get_file_retention_days () > 0))
+        else if ((c.retention_policy == XML_RETAIN_DAYS) &&
+                 (c.retention_days > 0))
         {
             int days;
 
@@ -883,16 +1352,59 @@ GncXmlBackend::remove_old_files ()
                 g_free (name);
                 continue;
             }
-            days = (int) (difftime (now, statbuf.st_mtime) / 86400);
+            days = (int) (difftime (c.now, statbuf.st_mtime) / 86400);
 
-            PINFO ("file retention = %d days", gnc_prefs_get_file_retention_days ());
-            if (days >= gnc_prefs_get_file_retention_days ())
-            {
-                PINFO ("remove stale file: %s  - reason: more than %d days old", name, days);
-                g_unlink (name);
-            }
+            if (days >= c.retention_days && g_unlink (name) == 0)
+                removed.emplace_back (name);
         }
         g_free (name);
     }
     g_dir_close (dir);
 }
+
+/*
+ * Clean up any lock files from prior crashes, and clean up old
+ * backup and log files.  Scanning the directory can be slow on a
+ * network share, so it's done on a thread that the next save, or the end
+ * of the session, waits for.
+ */
+
+void
+GncXmlBackend::remove_old_files ()
+{
+    GStatBuf lockstatbuf;
+
+    finish_remove_old_files ();
+    if (g_stat (m_lockfile.c_str(), &lockstatbuf) != 0)
+        return;
+
+    OldFilesCleanup cleanup {m_dirname, m_fullpath, m_linkfile,
+                             lockstatbuf.st_mtime,
+                             gnc_prefs_get_file_retention_policy (),
+                             gnc_prefs_get_file_retention_days (),
+                             gnc_time (NULL)};
+    PINFO ("file retention policy %d, %d days", cleanup.retention_policy,
+           cleanup.retention_days);
+    try
+    {
+        m_cleanup = std::thread ([this, cleanup] {
+            remove_old_files_in (cleanup, m_removed_files);
+        });
+    }
+    catch (const std::system_error& err)
+    {
+        PWARN ("can't start the cleanup thread: %s", err.what ());
+        remove_old_files_in (cleanup, m_removed_files);
+        finish_remove_old_files ();
+    }
+}
+
+void
+GncXmlBackend::finish_remove_old_files ()
+{
+    if (m_cleanup.joinable ())
+        m_cleanup.join ();
+    for (const auto& name : m_removed_files)
+        PINFO ("removed stale file: %s", name.c_str());
+    m_removed_files.clear ();
+}
@@ -24,8 +24,19 @@ extern "C"
 }
 
 #include <string>
+#include <set>
+#include <thread>
+#include <vector>
 #include <qof-backend.hpp>
 
+struct GncGUIDLess
+{
+    bool operator()(const GncGUID& a, const GncGUID& b) const
+    {
+        return guid_compare (&a, &b) < 0;
+    }
+};
+
 class GncXmlBackend : public QofBackend
 {
 public:
@@ -34,26 +45,36 @@ public:
     GncXmlBackend operator=(const GncXmlBackend&) = delete;
     GncXmlBackend(const GncXmlBackend&&) = delete;
     GncXmlBackend operator=(const GncXmlBackend&&) = delete;
-    ~GncXmlBackend() = default;
+    ~GncXmlBackend();
     void session_begin(QofSession* session, const char* new_uri,
                        SessionOpenMode mode) override;
     void session_end() override;
     void load(QofBook* book, QofBackendLoadType loadType) override;
+    bool load_streaming(QofBook* book, QofBackend* target) override;
     /* The XML backend isn't able to do anything with individual instances. */
     void export_coa(QofBook*) override;
     void sync(QofBook* book) override;
     void safe_sync(QofBook* book) override { sync(book); } // XML sync is inherently safe.
+    bool begin_background_sync(QofBook* book,
+                               std::function<void()> done) override;
+    void finish_background_sync() override;
     void commit(QofInstance* instance) override;
     const char * get_filename() { return m_fullpath.c_str(); }
+    const char * get_snapshot_filename() { return m_snapshot.c_str(); }
     QofBook* get_book() { return m_book; }
 
 private:
     bool save_may_clobber_data();
     bool get_file_lock();
     bool link_or_make_backup(const std::string& orig, const std::string& bkup);
-    bool backup_file();
+    bool backup_file(std::string& backup);
+    char* make_temp_name();
     bool write_to_file(bool make_backup);
+    bool write_spool_file(std::string& spool);
+    bool write_to_journal();
+    bool replay_journal();
     void remove_old_files();
+    void finish_remove_old_files();
     void write_accounts(QofBook* book);
     bool check_path(const char* fullpath, bool create);
 
@@ -61,6 +82,27 @@ private:
     std::string m_lockfile;
     std::string m_linkfile;
     int m_lockfd;
+    /* Append-only sidecar holding the transactions saved since the data
+     * file was last written; see write_to_journal(). */
+    std::string m_journal;
+    /* The data file and the journal together hold the book as last saved,
+     * so changes committed since can be appended.  Cleared by changes
+     * that only a full write records. */
+    bool m_journal_ok = false;
+    std::set<GncGUID, GncGUIDLess> m_journal_pending;
+    /* Decompressed copy of a compressed data file, loaded instead of it
+     * while it still matches; see gnc_book_write_xml_snapshot(). */
+    std::string m_snapshot;
+    /* Runs remove_old_files() after a save; joined before the next one. */
+    std::thread m_cleanup;
+    std::vector<std::string> m_removed_files;
+    /* The thread finishing a background sync, and what it found.  Only
+     * the thread uses the m_background_* results until it's joined. */
+    std::thread m_background_sync;
+    bool m_background_pending = false;
+    QofBackendError m_background_err = ERR_BACKEND_NO_ERR;
+    std::string m_background_msg;
+    bool m_background_journal_removed = false;
 
     QofBook* m_book = nullptr;  /* The primary, main open book */
 };
@@ -0,0 +1,172 @@
+/********************************************************************
+ * gnc-xml-writer.cpp: Stream XML elements without building a DOM.  *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+\********************************************************************/
+extern "C"
+{
+#include <config.h>
+#include <glib.h>
+}
+
+#include "gnc-xml-helper.h"
+#include "gnc-xml-writer.hpp"
+
+/* libxml2 stops indenting deeper than this many levels (MAX_INDENT / 2
+ * in xmlsave.c), so we do too. */
+static const size_t max_indent_level = 30;
+
+void
+GncXmlWriter::indent (size_t level)
+{
+    m_buf.append (2 * MIN (level, max_indent_level), ' ');
+}
+
+void
+GncXmlWriter::begin_child ()
+{
+    if (m_open.empty ())
+        return;
+
+    auto& parent = m_open.back ();
+    g_return_if_fail (parent.second != Content::text);
+    if (parent.second == Content::none)
+    {
+        m_buf += ">\n";
+        parent.second = Content::elements;
+    }
+    indent (m_level + m_open.size ());
+}
+
+void
+GncXmlWriter::start_element (const char* tag)
+{
+    begin_child ();
+    m_buf += '<';
+    m_buf += tag;
+    m_open.emplace_back (tag, Content::none);
+}
+
+void
+GncXmlWriter::add_attribute (const char* name, const char* value)
+{
+    g_return_if_fail (!m_open.empty () &&
+                      m_open.back ().second == Content::none);
+
+    m_buf += ' ';
+    m_buf += name;
+    m_buf += "=\"";
+    m_buf += value;
+    m_buf += '"';
+}
+
+void
+GncXmlWriter::add_text (const char* text)
+{
+    g_return_if_fail (!m_open.empty () &&
+                      m_open.back ().second != Content::elements);
+
+    if (m_open.back ().second == Content::none)
+    {
+        m_buf += '>';
+        m_open.back ().second = Content::text;
+    }
+    append_escaped (text);
+}
+
+void
+GncXmlWriter::end_element ()
+{
+    g_return_if_fail (!m_open.empty ());
+
+    auto element = m_open.back ();
+    m_open.pop_back ();
+    if (element.second == Content::none)
+        m_buf += "/>";
+    else
+    {
+        if (element.second == Content::elements)
+            indent (m_level + m_open.size ());
+        m_buf += "</";
+        m_buf += element.first;
+        m_buf += '>';
+    }
+
+    if (!m_open.empty ())
+        m_buf += '\n';
+}
+
+void
+GncXmlWriter::text_element (const char* tag, const char* text)
+{
+    start_element (tag);
+    if (text)
+        add_text (text);
+    end_element ();
+}
+
+void
+GncXmlWriter::append_escaped (const char* text)
+{
+    gchar* copy = nullptr;
+
+    /* Almost everything is valid UTF-8; only copy what checked_char_cast
+     * has to rewrite. */
+    if (!g_utf8_validate (text, -1, nullptr))
+        text = copy = reinterpret_cast<gchar*> (checked_char_cast (g_strdup (text)));
+
+    for (auto p = text; *p; ++p)
+    {
+        switch (*p)
+        {
+        case '<':
+            m_buf += "&lt;";
+            break;
+        case '>':
+            m_buf += "&gt;";
+            break;
+        case '&':
+            m_buf += "&amp;";
+            break;
+        case '\r':
+            m_buf += "&#13;";
+            break;
+        case '\t':
+        case '\n':
+            m_buf += *p;
+            break;
+        default:
+            /* checked_char_cast's replacement for control characters */
+            m_buf += (*p > 0 && *p < 0x20) ? '?' : *p;
+            break;
+        }
+    }
+
+    g_free (copy);
+}
+
+gboolean
+GncXmlWriter::write (FILE* out)
+{
+    g_return_val_if_fail (m_open.empty (), FALSE);
+
+    auto written = fwrite (m_buf.data (), 1, m_buf.size (), out);
+    auto ok = (written == m_buf.size ());
+    m_buf.clear ();
+    return ok;
+}
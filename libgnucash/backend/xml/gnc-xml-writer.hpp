@@ -0,0 +1,82 @@
+/********************************************************************
+ * gnc-xml-writer.hpp: Stream XML elements without building a DOM.  *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+\********************************************************************/
+
+#ifndef __GNC_XML_WRITER_HPP__
+#define __GNC_XML_WRITER_HPP__
+
+extern "C"
+{
+#include <stdio.h>
+#include <glib.h>
+}
+
+#include <string>
+#include <vector>
+
+/** Formats XML straight into a text buffer, laid out byte for byte the
+ * way xmlElemDump lays out the equivalent tree: every element whose
+ * children are all elements gets its children on their own lines,
+ * indented two spaces per level, and text-only elements stay on one line.
+ *
+ * The *_to_xml_stream functions use it to write the bulk of a book
+ * without allocating an xmlNode for every field.  Attribute values are
+ * written as given, so they must not need escaping; element text is
+ * sanitized with the same rules as checked_char_cast and then escaped.
+ */
+class GncXmlWriter
+{
+public:
+    /** @param level The nesting depth of the first element written, for
+     * callers that write the enclosing element themselves. */
+    explicit GncXmlWriter (int level = 0) : m_level{level} {}
+
+    /** Open an element.  The tag isn't copied and must outlive the matching
+     * end_element().  Attributes may be added until its first content. */
+    void start_element (const char* tag);
+    void add_attribute (const char* name, const char* value);
+    /** Give the innermost open element text content.  It can then have no
+     * child elements, and is closed without indentation. */
+    void add_text (const char* text);
+    /** Close the innermost open element, as <tag/> if it had no content. */
+    void end_element ();
+    /** Write <tag>text</tag>.  An empty string gives <tag></tag>, a NULL
+     * one <tag/>, matching xmlNewTextChild. */
+    void text_element (const char* tag, const char* text);
+    void empty_element (const char* tag) { text_element (tag, nullptr); }
+
+    const std::string& str () const { return m_buf; }
+    void clear () { m_buf.clear (); }
+    /** Write the buffered text to out and clear it. */
+    gboolean write (FILE* out);
+
+private:
+    enum class Content { none, elements, text };
+
+    void begin_child ();
+    void indent (size_t level);
+    void append_escaped (const char* text);
+
+    std::string m_buf;
+    std::vector<std::pair<const char*, Content>> m_open;
+    int m_level;
+};
+
+#endif /* __GNC_XML_WRITER_HPP__ */
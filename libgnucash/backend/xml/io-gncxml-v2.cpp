@@ -35,6 +35,7 @@ extern "C"
 #undef _UWIN
 #endif
 #include <windows.h>
+#include <io.h>
 #endif
 #include <glib.h>
 #include <glib/gstdio.h>
@@ -43,7 +44,14 @@ extern "C"
 #ifdef HAVE_UNISTD_H
 # include <unistd.h>
 #endif
+#ifdef HAVE_SYS_MMAN_H
+# include <sys/mman.h>
+# include <sys/stat.h>
+#endif
 #include <zlib.h>
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
 #include <errno.h>
 
 #include "gnc-engine.h"
@@ -94,6 +102,7 @@ typedef struct
     gint fd;
     gchar* filename;
     gchar* perms;
+    GncXmlCompression compression;
     gboolean compress;
 } gz_thread_params_t;
 
@@ -107,6 +116,7 @@ struct file_backend
     sixtp*          parser;
     FILE*           out;
     QofBook*        book;
+    GncXmlWriter*   writer;
 };
 
 static std::vector<GncXmlDataType_t> backend_registry;
@@ -124,9 +134,9 @@ gnc_v2_book_version_string;        /* see gnc-book-xml-v2 */
 
 /* Forward declarations */
 static FILE* try_gz_open (const char* filename, const char* perms,
-                          gboolean use_gzip,
+                          GncXmlCompression compression,
                           gboolean compress);
-static gboolean is_gzipped_file (const gchar* name);
+static GncXmlCompression compressed_file_type (const gchar* name);
 static gboolean wait_for_gzip (FILE* file);
 
 static void
@@ -301,6 +311,43 @@ add_transaction_local (sixtp_gdv2* data, Transaction* trn)
     return TRUE;
 }
 
+/* Lots and invoices are read after the transactions in them, so a
+ * transaction that could belong to one has to be kept until the end. */
+static gboolean
+transaction_can_stream (Transaction* trn)
+{
+    if (xaccTransGetTxnType (trn) == TXN_TYPE_INVOICE)
+        return FALSE;
+    for (auto node = xaccTransGetSplitList (trn); node; node = node->next)
+        if (xaccSplitGetLot (GNC_SPLIT (node->data)))
+            return FALSE;
+    return TRUE;
+}
+
+/* Hand trn to the backend being streamed to and get rid of it.  After a
+ * failure the remaining transactions are just kept, and the stream is
+ * abandoned at the end. */
+static void
+stream_transaction_local (sixtp_gdv2* data, Transaction* trn)
+{
+    if (data->stream_failed || !transaction_can_stream (trn))
+        return;
+
+    /* What xaccAccountTreeScrubSplits would do once the book is read. */
+    xaccTransScrubSplits (trn);
+    if (!data->stream_to->stream_instance (QOF_INSTANCE (trn)))
+    {
+        char guidstr[GUID_ENCODING_LENGTH + 1];
+        guid_to_string_buff (qof_instance_get_guid (trn), guidstr);
+        PERR ("Failed to write transaction %s", guidstr);
+        data->stream_failed = TRUE;
+        return;
+    }
+    xaccTransBeginEdit (trn);
+    xaccTransDestroy (trn);
+    xaccTransCommitEdit (trn);
+}
+
 static gboolean
 add_schedXaction_local (sixtp_gdv2* data, SchedXaction* sx)
 {
@@ -376,6 +423,30 @@ counter (const GncXmlDataType_t& data, file_backend* be_data)
     /* XXX: should we do anything with this counter? */
 }
 
+/* Presize a collection from the file's count-data, so that loading its
+ * entities doesn't repeatedly grow its table. */
+static void
+reserve_collection (QofBook* book, QofIdType type, gint64 count)
+{
+    if (!book || count <= 0 || count > G_MAXUINT)
+        return;
+    qof_collection_reserve (qof_book_get_collection (book, type), count);
+}
+
+/* Presize the string cache for the names and descriptions the counted
+ * transactions, accounts and commodities will insert.  Nothing is cached
+ * between the count-data elements, so each call can simply ask for the
+ * running total. */
+static void
+reserve_string_cache (const load_counter& counter)
+{
+    gint64 count = (gint64)counter.transactions_total +
+        3 * (gint64)counter.accounts_total +
+        3 * (gint64)counter.commodities_total;
+    if (count > 0 && count <= G_MAXUINT)
+        qof_string_cache_reserve (count);
+}
+
 static gboolean
 gnc_counter_end_handler (gpointer data_for_children,
                          GSList* data_from_children, GSList* sibling_data,
@@ -415,10 +486,16 @@ gnc_counter_end_handler (gpointer data_for_children,
     else if (g_strcmp0 (type, "transaction") == 0)
     {
         sixdata->counter.transactions_total = val;
+        /* Every transaction has at least two splits. */
+        reserve_collection (sixdata->book, GNC_ID_TRANS, val);
+        reserve_collection (sixdata->book, GNC_ID_SPLIT, 2 * val);
+        reserve_string_cache (sixdata->counter);
     }
     else if (g_strcmp0 (type, "account") == 0)
     {
         sixdata->counter.accounts_total = val;
+        reserve_collection (sixdata->book, GNC_ID_ACCOUNT, val);
+        reserve_string_cache (sixdata->counter);
     }
     else if (g_strcmp0 (type, "book") == 0)
     {
@@ -427,18 +504,23 @@ gnc_counter_end_handler (gpointer data_for_children,
     else if (g_strcmp0 (type, "commodity") == 0)
     {
         sixdata->counter.commodities_total = val;
+        reserve_collection (sixdata->book, GNC_ID_COMMODITY, val);
+        reserve_string_cache (sixdata->counter);
     }
     else if (g_strcmp0 (type, "schedxaction") == 0)
     {
         sixdata->counter.schedXactions_total = val;
+        reserve_collection (sixdata->book, GNC_ID_SCHEDXACTION, val);
     }
     else if (g_strcmp0 (type, "budget") == 0)
     {
         sixdata->counter.budgets_total = val;
+        reserve_collection (sixdata->book, GNC_ID_BUDGET, val);
     }
     else if (g_strcmp0 (type, "price") == 0)
     {
         sixdata->counter.prices_total = val;
+        reserve_collection (sixdata->book, GNC_ID_PRICE, val);
     }
     else
     {
@@ -460,6 +542,11 @@ gnc_counter_end_handler (gpointer data_for_children,
              * in this tag, so just let the error pass. */
             ret = TRUE;
         }
+        else
+        {
+            /* The business objects count themselves by their QofIdType. */
+            reserve_collection (sixdata->book, type, val);
+        }
     }
 
     g_free (strval);
@@ -583,6 +670,8 @@ book_callback (const char* tag, gpointer globaldata, gpointer data)
     else if (g_strcmp0 (tag, TRANSACTION_TAG) == 0)
     {
         add_transaction_local (gd, (Transaction*)data);
+        if (gd->stream_to)
+            stream_transaction_local (gd, (Transaction*)data);
     }
     else if (g_strcmp0 (tag, SCHEDXACTION_TAG) == 0)
     {
@@ -691,11 +780,399 @@ gnc_sixtp_gdv2_new (
     return gd;
 }
 
+#ifdef HAVE_SYS_MMAN_H
+/* How much of a mapped book is handed to the parser at a time.  Feeding
+ * it in slices rather than all at once keeps libxml2 from copying the
+ * whole file into its own input buffer. */
+#define MAPPED_PARSE_CHUNK (1024 * 1024)
+
+typedef struct
+{
+    const char* map;
+    gsize size;
+    gboolean ok;
+} mapped_push_data;
+
+static void
+parse_mapped_push_handler (xmlParserCtxtPtr xml_context,
+                           mapped_push_data* push_data)
+{
+    gsize offset = 0;
+
+    while (offset < push_data->size)
+    {
+        int len = MIN (push_data->size - offset, MAPPED_PARSE_CHUNK);
+        if (xmlParseChunk (xml_context, push_data->map + offset, len, 0) != 0)
+            return;
+        offset += len;
+    }
+
+    push_data->ok = (xmlParseChunk (xml_context, "", 0, 1) == 0);
+}
+
+/* Parse an uncompressed book straight out of a read-only mapping of the
+ * file, which saves the read() calls and the copy into stdio's buffer.
+ * Returns FALSE, leaving *retval alone, if the file can't be mapped; the
+ * caller then reads it through a FILE* as before.
+ *
+ * The session lock keeps other GnuCash instances from truncating the
+ * file under us, which would otherwise fault the mapping. */
+static gboolean
+parse_mapped_file (sixtp* top_parser, const char* filename,
+                   sixtp_gdv2* gd, QofBook* book, gboolean* retval)
+{
+    struct stat statbuf;
+    mapped_push_data push_data;
+    gpointer parse_result = NULL;
+    gxpf_data gpdata;
+    void* map;
+    int fd;
+
+    fd = g_open (filename, O_RDONLY, 0);
+    if (fd == -1)
+        return FALSE;
+
+    if (fstat (fd, &statbuf) != 0 || !S_ISREG (statbuf.st_mode) ||
+        statbuf.st_size <= 0 || (guint64) statbuf.st_size > G_MAXSIZE)
+    {
+        close (fd);
+        return FALSE;
+    }
+
+    map = mmap (NULL, statbuf.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close (fd);
+    if (map == MAP_FAILED)
+    {
+        PINFO ("Unable to map %s: %s", filename, g_strerror (errno));
+        return FALSE;
+    }
+#ifdef MADV_SEQUENTIAL
+    madvise (map, statbuf.st_size, MADV_SEQUENTIAL);
+#endif
+
+    push_data.map = static_cast<const char*> (map);
+    push_data.size = statbuf.st_size;
+    push_data.ok = FALSE;
+
+    gpdata.cb = generic_callback;
+    gpdata.parsedata = gd;
+    gpdata.bookdata = book;
+
+    *retval = sixtp_parse_push (top_parser,
+                                (sixtp_push_handler) parse_mapped_push_handler,
+                                &push_data, NULL, &gpdata, &parse_result)
+              && push_data.ok;
+
+    munmap (map, statbuf.st_size);
+    return TRUE;
+}
+
+/* A snapshot is a cache of a compressed book's decompressed XML, which
+ * can be mapped and parsed without running the decompressor.  It starts
+ * with a fixed header, all integers little-endian:
+ *
+ *   0  magic "GNCSNAP\n"
+ *   8  guint32 format version
+ *  12  guint32 header size, i.e. the offset of the XML
+ *  16  guint64 size of the book file it was made from
+ *  24  gint64  modification time of that file
+ *  32  guint64 size of the XML
+ *  40  SHA-256 of the book file
+ *  72  SHA-256 of the XML
+ *
+ * A snapshot is only used while the book file still has that size, time
+ * and hash, and the XML still has its hash. */
+#define SNAPSHOT_MAGIC "GNCSNAP\n"
+#define SNAPSHOT_VERSION 1
+#define SNAPSHOT_HEADER_SIZE 104
+#define SNAPSHOT_HASH_SIZE 32
+#define SNAPSHOT_IO_CHUNK (64 * 1024)
+
+typedef struct
+{
+    guint64 book_size;
+    gint64 book_mtime;
+    guint64 xml_size;
+    guint8 book_hash[SNAPSHOT_HASH_SIZE];
+    guint8 xml_hash[SNAPSHOT_HASH_SIZE];
+} snapshot_header;
+
+static void
+snapshot_header_to_bytes (const snapshot_header* header, guint8* bytes)
+{
+    guint32 u32;
+    guint64 u64;
+
+    memcpy (bytes, SNAPSHOT_MAGIC, 8);
+    u32 = GUINT32_TO_LE (SNAPSHOT_VERSION);
+    memcpy (bytes + 8, &u32, 4);
+    u32 = GUINT32_TO_LE (SNAPSHOT_HEADER_SIZE);
+    memcpy (bytes + 12, &u32, 4);
+    u64 = GUINT64_TO_LE (header->book_size);
+    memcpy (bytes + 16, &u64, 8);
+    u64 = GUINT64_TO_LE ((guint64) header->book_mtime);
+    memcpy (bytes + 24, &u64, 8);
+    u64 = GUINT64_TO_LE (header->xml_size);
+    memcpy (bytes + 32, &u64, 8);
+    memcpy (bytes + 40, header->book_hash, SNAPSHOT_HASH_SIZE);
+    memcpy (bytes + 72, header->xml_hash, SNAPSHOT_HASH_SIZE);
+}
+
+static gboolean
+snapshot_header_from_bytes (const guint8* bytes, snapshot_header* header)
+{
+    guint32 u32;
+    guint64 u64;
+
+    if (memcmp (bytes, SNAPSHOT_MAGIC, 8) != 0)
+        return FALSE;
+    memcpy (&u32, bytes + 8, 4);
+    if (GUINT32_FROM_LE (u32) != SNAPSHOT_VERSION)
+        return FALSE;
+    memcpy (&u32, bytes + 12, 4);
+    if (GUINT32_FROM_LE (u32) != SNAPSHOT_HEADER_SIZE)
+        return FALSE;
+    memcpy (&u64, bytes + 16, 8);
+    header->book_size = GUINT64_FROM_LE (u64);
+    memcpy (&u64, bytes + 24, 8);
+    header->book_mtime = (gint64) GUINT64_FROM_LE (u64);
+    memcpy (&u64, bytes + 32, 8);
+    header->xml_size = GUINT64_FROM_LE (u64);
+    memcpy (header->book_hash, bytes + 40, SNAPSHOT_HASH_SIZE);
+    memcpy (header->xml_hash, bytes + 72, SNAPSHOT_HASH_SIZE);
+    return TRUE;
+}
+
+static gboolean
+hash_file (const char* filename, guint8* digest)
+{
+    GChecksum* checksum;
+    gsize digest_len = SNAPSHOT_HASH_SIZE;
+    char* buf;
+    size_t len;
+    gboolean ok;
+    FILE* file;
+
+    file = g_fopen (filename, "rb");
+    if (file == NULL)
+        return FALSE;
+
+    checksum = g_checksum_new (G_CHECKSUM_SHA256);
+    buf = static_cast<char*> (g_malloc (SNAPSHOT_IO_CHUNK));
+    while ((len = fread (buf, 1, SNAPSHOT_IO_CHUNK, file)) > 0)
+        g_checksum_update (checksum, (const guchar*) buf, len);
+    ok = !ferror (file);
+    fclose (file);
+
+    g_checksum_get_digest (checksum, digest, &digest_len);
+    g_checksum_free (checksum);
+    g_free (buf);
+    return ok;
+}
+
+/* Parse the book from the snapshot of filename, if there is one that is
+ * still good for it.  Returns FALSE, leaving *retval alone and the book
+ * untouched, if there isn't; the caller then parses the book itself. */
+static gboolean
+parse_snapshot_file (sixtp* top_parser, const char* filename,
+                     const char* snapshot, sixtp_gdv2* gd, QofBook* book,
+                     gboolean* retval)
+{
+    snapshot_header header;
+    struct stat statbuf;
+    GStatBuf book_stat;
+    mapped_push_data push_data;
+    gpointer parse_result = NULL;
+    gxpf_data gpdata;
+    guint8 digest[SNAPSHOT_HASH_SIZE];
+    gsize digest_len = SNAPSHOT_HASH_SIZE;
+    GChecksum* checksum;
+    const char* reason = NULL;
+    char* map;
+    int fd;
+
+    if (!snapshot || g_stat (filename, &book_stat) != 0)
+        return FALSE;
+
+    fd = g_open (snapshot, O_RDONLY, 0);
+    if (fd == -1)
+        return FALSE;
+
+    if (fstat (fd, &statbuf) != 0 || !S_ISREG (statbuf.st_mode) ||
+        statbuf.st_size <= SNAPSHOT_HEADER_SIZE ||
+        (guint64) statbuf.st_size > G_MAXSIZE)
+    {
+        close (fd);
+        return FALSE;
+    }
+
+    map = static_cast<char*> (mmap (NULL, statbuf.st_size, PROT_READ,
+                                    MAP_PRIVATE, fd, 0));
+    close (fd);
+    if (map == MAP_FAILED)
+        return FALSE;
+
+    /* Check the cheap stamps before hashing anything. */
+    if (!snapshot_header_from_bytes ((const guint8*) map, &header))
+        reason = "unknown format";
+    else if (header.xml_size != (guint64) statbuf.st_size - SNAPSHOT_HEADER_SIZE)
+        reason = "truncated";
+    else if (header.book_size != (guint64) book_stat.st_size ||
+             header.book_mtime != (gint64) book_stat.st_mtime)
+        reason = "stale";
+    else if (!hash_file (filename, digest) ||
+             memcmp (digest, header.book_hash, SNAPSHOT_HASH_SIZE) != 0)
+        reason = "stale";
+
+    if (!reason)
+    {
+#ifdef MADV_SEQUENTIAL
+        madvise (map, statbuf.st_size, MADV_SEQUENTIAL);
+#endif
+        checksum = g_checksum_new (G_CHECKSUM_SHA256);
+        g_checksum_update (checksum, (const guchar*) map + SNAPSHOT_HEADER_SIZE,
+                           header.xml_size);
+        g_checksum_get_digest (checksum, digest, &digest_len);
+        g_checksum_free (checksum);
+        if (memcmp (digest, header.xml_hash, SNAPSHOT_HASH_SIZE) != 0)
+            reason = "corrupt";
+    }
+
+    if (reason)
+    {
+        PINFO ("Not using snapshot %s: %s", snapshot, reason);
+        munmap (map, statbuf.st_size);
+        return FALSE;
+    }
+
+    PINFO ("Loading %s from snapshot %s", filename, snapshot);
+    push_data.map = map + SNAPSHOT_HEADER_SIZE;
+    push_data.size = header.xml_size;
+    push_data.ok = FALSE;
+
+    gpdata.cb = generic_callback;
+    gpdata.parsedata = gd;
+    gpdata.bookdata = book;
+
+    *retval = sixtp_parse_push (top_parser,
+                                (sixtp_push_handler) parse_mapped_push_handler,
+                                &push_data, NULL, &gpdata, &parse_result)
+              && push_data.ok;
+
+    munmap (map, statbuf.st_size);
+    return TRUE;
+}
+
+gboolean
+gnc_book_write_xml_snapshot (const char* book_file, const char* snapshot)
+{
+    snapshot_header header;
+    guint8 header_bytes[SNAPSHOT_HEADER_SIZE] = {0};
+    GStatBuf book_stat;
+    GChecksum* checksum;
+    gsize digest_len = SNAPSHOT_HASH_SIZE;
+    GncXmlCompression compression;
+    gboolean success = TRUE;
+    FILE* in;
+    FILE* out;
+    gchar* tmp_name;
+    char* buf;
+    size_t len;
+    int fd;
+
+    g_return_val_if_fail (book_file && snapshot, FALSE);
+
+    if (g_stat (book_file, &book_stat) != 0 ||
+        !hash_file (book_file, header.book_hash))
+        return FALSE;
+    header.book_size = book_stat.st_size;
+    header.book_mtime = book_stat.st_mtime;
+
+    tmp_name = g_strconcat (snapshot, ".tmp-XXXXXX", NULL);
+    fd = g_mkstemp (tmp_name);
+    if (fd == -1)
+    {
+        g_free (tmp_name);
+        return FALSE;
+    }
+    out = fdopen (fd, "wb");
+    if (out == NULL)
+    {
+        close (fd);
+        g_unlink (tmp_name);
+        g_free (tmp_name);
+        return FALSE;
+    }
+
+    compression = compressed_file_type (book_file);
+    in = try_gz_open (book_file, "r", compression, FALSE);
+    if (in == NULL)
+    {
+        fclose (out);
+        g_unlink (tmp_name);
+        g_free (tmp_name);
+        return FALSE;
+    }
+
+    /* The header goes in last, once the XML's size and hash are known. */
+    if (fwrite (header_bytes, 1, SNAPSHOT_HEADER_SIZE, out) != SNAPSHOT_HEADER_SIZE)
+        success = FALSE;
+
+    checksum = g_checksum_new (G_CHECKSUM_SHA256);
+    buf = static_cast<char*> (g_malloc (SNAPSHOT_IO_CHUNK));
+    header.xml_size = 0;
+    while (success && (len = fread (buf, 1, SNAPSHOT_IO_CHUNK, in)) > 0)
+    {
+        g_checksum_update (checksum, (const guchar*) buf, len);
+        header.xml_size += len;
+        if (fwrite (buf, 1, len, out) != len)
+            success = FALSE;
+    }
+    if (ferror (in))
+        success = FALSE;
+    fclose (in);
+    if (compression != GNC_XML_COMPRESSION_NONE && !wait_for_gzip (in))
+        success = FALSE;
+    g_checksum_get_digest (checksum, header.xml_hash, &digest_len);
+    g_checksum_free (checksum);
+    g_free (buf);
+
+    /* No fsync: a snapshot lost or cut short by a crash won't match its
+     * hashes and is simply ignored. */
+    snapshot_header_to_bytes (&header, header_bytes);
+    if (success && (fseek (out, 0, SEEK_SET) != 0 ||
+                    fwrite (header_bytes, 1, SNAPSHOT_HEADER_SIZE, out) !=
+                    SNAPSHOT_HEADER_SIZE))
+        success = FALSE;
+    if (fclose (out) != 0)
+        success = FALSE;
+
+    if (success && g_rename (tmp_name, snapshot) != 0)
+    {
+        PWARN ("unable to rename %s to %s: %s", tmp_name, snapshot,
+               g_strerror (errno));
+        success = FALSE;
+    }
+    if (!success)
+        g_unlink (tmp_name);
+    g_free (tmp_name);
+    return success;
+}
+#else
+gboolean
+gnc_book_write_xml_snapshot (const char* book_file, const char* snapshot)
+{
+    /* Snapshots are only read through a mapping, so there is no point in
+     * writing one that this build couldn't use. */
+    return FALSE;
+}
+#endif
+
 static gboolean
 qof_session_load_from_xml_file_v2_full (
     GncXmlBackend* xml_be, QofBook* book,
     sixtp_push_handler push_handler, gpointer push_user_data,
-    QofBookFileType type)
+    QofBookFileType type, QofBackend* stream_to)
 {
     Account* root;
     sixtp_gdv2* gd;
@@ -708,6 +1185,7 @@ qof_session_load_from_xml_file_v2_full (
 
     gd = gnc_sixtp_gdv2_new (book, FALSE, file_rw_feedback,
                              xml_be->get_percentage());
+    gd->stream_to = stream_to;
 
     top_parser = sixtp_new ();
     main_parser = sixtp_new ();
@@ -796,20 +1274,32 @@ qof_session_load_from_xml_file_v2_full (
          */
          const char* filename = xml_be->get_filename();
         FILE* file;
-        gboolean is_compressed = is_gzipped_file (filename);
-        file = try_gz_open (filename, "r", is_compressed, FALSE);
-        if (file == NULL)
-        {
-            PWARN ("Unable to open file %s", filename);
-            retval = FALSE;
-        }
+        GncXmlCompression compression = compressed_file_type (filename);
+        gboolean mapped = FALSE;
+#ifdef HAVE_SYS_MMAN_H
+        if (compression == GNC_XML_COMPRESSION_NONE)
+            mapped = parse_mapped_file (top_parser, filename, gd, book, &retval);
         else
+            mapped = parse_snapshot_file (top_parser, filename,
+                                          xml_be->get_snapshot_filename(),
+                                          gd, book, &retval);
+#endif
+        if (!mapped)
         {
-            retval = gnc_xml_parse_fd (top_parser, file,
-                                       generic_callback, gd, book);
-            fclose (file);
-            if (is_compressed)
-                wait_for_gzip (file);
+            file = try_gz_open (filename, "r", compression, FALSE);
+            if (file == NULL)
+            {
+                PWARN ("Unable to open file %s", filename);
+                retval = FALSE;
+            }
+            else
+            {
+                retval = gnc_xml_parse_fd (top_parser, file,
+                                           generic_callback, gd, book);
+                fclose (file);
+                if (compression != GNC_XML_COMPRESSION_NONE)
+                    wait_for_gzip (file);
+            }
         }
     }
 
@@ -871,7 +1361,16 @@ gboolean
 qof_session_load_from_xml_file_v2 (GncXmlBackend* xml_be, QofBook* book,
                                    QofBookFileType type)
 {
-    return qof_session_load_from_xml_file_v2_full (xml_be, book, NULL, NULL, type);
+    return qof_session_load_from_xml_file_v2_full (xml_be, book, NULL, NULL,
+                                                   type, NULL);
+}
+
+gboolean
+qof_session_stream_from_xml_file_v2 (GncXmlBackend* xml_be, QofBook* book,
+                                     QofBackend* target)
+{
+    return qof_session_load_from_xml_file_v2_full (xml_be, book, NULL, NULL,
+                                                   GNC_BOOK_XML2_FILE, target);
 }
 
 /***********************************************************************/
@@ -1094,73 +1593,56 @@ write_commodities (FILE* out, QofBook* book, sixtp_gdv2* gd)
 }
 
 static gboolean
-write_pricedb (FILE* out, QofBook* book, sixtp_gdv2* gd)
+write_one_price (GNCPrice* price, gpointer data)
 {
-    xmlNodePtr node;
-    xmlNodePtr parent;
-    xmlOutputBufferPtr outbuf;
+    struct file_backend* be_data = static_cast<decltype (be_data)> (data);
 
-    parent = gnc_pricedb_dom_tree_create (gnc_pricedb_get_db (book));
+    /* Write two spaces since the writer doesn't indent the first line */
+    if (fputs ("  ", be_data->out) < 0)
+        return FALSE;
+    gnc_price_to_xml_stream (*be_data->writer, price);
+    if (!be_data->writer->write (be_data->out) || fputs ("\n", be_data->out) < 0)
+        return FALSE;
 
-    if (!parent)
-    {
-        return TRUE;
-    }
+    be_data->gd->counter.prices_loaded += 1;
+    sixtp_run_callback (be_data->gd, "prices");
+    return TRUE;
+}
 
-    /* Write out the parent pricedb tag then loop to write out each price.
-       We do it this way instead of just calling xmlElemDump so that we can
-       increment the progress bar as we go. */
+static gboolean
+write_pricedb (FILE* out, QofBook* book, sixtp_gdv2* gd)
+{
+    GNCPriceDB* db = gnc_pricedb_get_db (book);
+    struct file_backend be_data;
+    GncXmlWriter writer (1);
 
-    if (fprintf (out, "<%s version=\"%s\">\n", parent->name,
-                 xmlGetProp (parent, BAD_CAST "version")) < 0)
-        return FALSE;
+    /* Write the prices one at a time rather than building the whole
+       gnc:pricedb tree first, so that we can increment the progress bar
+       as we go.  A db the tree couldn't represent was never written. */
+    if (!gnc_pricedb_xml_writable (db))
+        return TRUE;
 
-    /* We create our own output buffer so we can call xmlNodeDumpOutput to get
-       the indentation correct. */
-    outbuf = xmlOutputBufferCreateFile (out, NULL);
-    if (outbuf == NULL)
-    {
-        xmlFreeNode (parent);
+    if (fprintf (out, "<%s version=\"1\">\n", PRICEDB_TAG) < 0)
         return FALSE;
-    }
-
-    for (node = parent->children; node; node = node->next)
-    {
-        /* Write two spaces since xmlNodeDumpOutput doesn't indent the first line */
-        xmlOutputBufferWrite (outbuf, 2, "  ");
-        xmlNodeDumpOutput (outbuf, NULL, node, 1, 1, NULL);
-        /* It also doesn't terminate the last line */
-        xmlOutputBufferWrite (outbuf, 1, "\n");
-        if (ferror (out))
-            break;
-        gd->counter.prices_loaded += 1;
-        sixtp_run_callback (gd, "prices");
-    }
-
-    xmlOutputBufferClose (outbuf);
 
-    if (ferror (out) || fprintf (out, "</%s>\n", parent->name) < 0)
-    {
-        xmlFreeNode (parent);
+    be_data.out = out;
+    be_data.gd = gd;
+    be_data.writer = &writer;
+    if (!gnc_pricedb_foreach_price (db, write_one_price, &be_data, TRUE))
         return FALSE;
-    }
 
-    xmlFreeNode (parent);
-    return TRUE;
+    return fprintf (out, "</%s>\n", PRICEDB_TAG) >= 0;
 }
 
 static int
 xml_add_trn_data (Transaction* t, gpointer data)
 {
     struct file_backend* be_data = static_cast<decltype (be_data)> (data);
-    xmlNodePtr node;
 
-    node = gnc_transaction_dom_tree_create (t);
+    gnc_transaction_to_xml_stream (*be_data->writer, t);
 
-    xmlElemDump (be_data->out, NULL, node);
-    xmlFreeNode (node);
-
-    if (ferror (be_data->out) || fprintf (be_data->out, "\n") < 0)
+    if (!be_data->writer->write (be_data->out) ||
+        fprintf (be_data->out, "\n") < 0)
         return -1;
 
     be_data->gd->counter.transactions_loaded++;
@@ -1172,9 +1654,11 @@ static gboolean
 write_transactions (FILE* out, QofBook* book, sixtp_gdv2* gd)
 {
     struct file_backend be_data;
+    GncXmlWriter writer;
 
     be_data.out = out;
     be_data.gd = gd;
+    be_data.writer = &writer;
     return 0 ==
            xaccAccountTreeForEachTransaction (gnc_book_get_root_account (book),
                                               xml_add_trn_data,
@@ -1186,9 +1670,11 @@ write_template_transaction_data (FILE* out, QofBook* book, sixtp_gdv2* gd)
 {
     Account* ra;
     struct file_backend be_data;
+    GncXmlWriter writer;
 
     be_data.out = out;
     be_data.gd = gd;
+    be_data.writer = &writer;
 
     ra = gnc_book_get_template_root (book);
     if (gnc_account_n_descendants (ra) > 0)
@@ -1379,113 +1865,516 @@ gnc_book_write_accounts_to_xml_filehandle_v2 (QofBackend* qof_be, QofBook* book,
     return success;
 }
 
-#define BUFLEN 4096
+/* Chunk size for moving data between the (de)compression thread and
+ * the pipe, and zlib's own file buffer.  Larger chunks mean fewer
+ * system calls and thread wakeups per megabyte on either side. */
+#define GZ_CHUNK_LEN (64 * 1024)
+
+/* How far, in bytes, one end of the pipe may run ahead of the other.
+ * The default capacity is only a few pages, so without this the
+ * inflate thread stalls whenever the parser is busy building objects
+ * (and the writer whenever deflate is busy) and the two stages end up
+ * taking turns instead of overlapping. */
+#define GZ_PIPE_LEN (1024 * 1024)
+
+/* Parallel gzip compression, in the manner of pigz.  The stream is cut
+ * into GZ_BLOCK_LEN blocks that are deflated independently on a thread
+ * pool.  Each block is primed with the last 32 KiB of the one before
+ * it, so the ratio hardly suffers, and ends on a byte boundary through
+ * Z_SYNC_FLUSH, so the pieces can simply be written one after the
+ * other.  The result is a single ordinary gzip member. */
+#define GZ_BLOCK_LEN (128 * 1024)
+#define GZ_DICT_LEN (32 * 1024)
 
-/* Compress or decompress function that is to be run in a separate thread.
- * Returns 1 on success or 0 otherwise, stuffed into a pointer type. */
-static gpointer
-gz_thread_func (gz_thread_params_t* params)
+typedef struct
 {
-    gchar buffer[BUFLEN];
-    gssize bytes;
-    gint gzval;
-    gzFile file;
-    gint success = 1;
+    guchar* in;
+    gsize in_len;
+    guchar dict[GZ_DICT_LEN];
+    gsize dict_len;
+    guchar* out;
+    gsize out_len;
+    guint32 crc;
+    gboolean done;
+    gboolean ok;
+} gz_block_t;
 
-#ifdef G_OS_WIN32
-    {
-        gchar* conv_name = g_win32_locale_filename_from_utf8 (params->filename);
-        gchar* perms;
+typedef struct
+{
+    GMutex mutex;
+    GCond cond;
+} gz_deflate_sync_t;
 
-        if (!conv_name)
+static void
+gz_block_free (gz_block_t* block)
+{
+    g_free (block->in);
+    g_free (block->out);
+    g_free (block);
+}
+
+/* Thread pool function: deflate one block and flag it as done. */
+static void
+gz_deflate_block (gz_block_t* block, gz_deflate_sync_t* sync)
+{
+    z_stream strm;
+    gsize size;
+    gint zval;
+
+    memset (&strm, 0, sizeof (strm));
+    zval = deflateInit2 (&strm, Z_DEFAULT_COMPRESSION, Z_DEFLATED,
+                         -MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
+    if (zval == Z_OK)
+    {
+        if (block->dict_len)
+            deflateSetDictionary (&strm, block->dict, block->dict_len);
+
+        size = deflateBound (&strm, block->in_len) + 16;
+        block->out = static_cast<guchar*> (g_malloc (size));
+        strm.next_in = block->in;
+        strm.avail_in = block->in_len;
+        strm.next_out = block->out;
+        strm.avail_out = size;
+
+        /* The flush marker isn't covered by deflateBound, so allow for
+         * running out of room, however unlikely. */
+        do
         {
-            g_warning ("Could not convert '%s' to system codepage",
-                       params->filename);
-            success = 0;
-            goto cleanup_gz_thread_func;
+            if (strm.avail_out == 0)
+            {
+                block->out = static_cast<guchar*> (g_realloc (block->out,
+                                                              2 * size));
+                strm.next_out = block->out + size;
+                strm.avail_out = size;
+                size *= 2;
+            }
+            zval = deflate (&strm, Z_SYNC_FLUSH);
         }
+        while (zval == Z_OK && strm.avail_out == 0);
 
-        if (strchr (params->perms, 'b'))
-            perms = g_strdup (params->perms);
-        else
-            perms = g_strdup_printf ("%cb%s", *params->perms, params->perms + 1);
-
-        file = gzopen (conv_name, perms);
-        g_free (perms);
-        g_free (conv_name);
+        block->out_len = size - strm.avail_out;
+        deflateEnd (&strm);
     }
-#else /* !G_OS_WIN32 */
-    file = gzopen (params->filename, params->perms);
-#endif /* G_OS_WIN32 */
+    block->crc = crc32 (0L, block->in, block->in_len);
 
-    if (file == NULL)
+    g_mutex_lock (&sync->mutex);
+    block->ok = (zval == Z_OK);
+    block->done = TRUE;
+    g_cond_broadcast (&sync->cond);
+    g_mutex_unlock (&sync->mutex);
+}
+
+static gboolean
+gz_write_bytes (FILE* file, const void* bytes, gsize len,
+                const gchar* filename)
+{
+    if (len && fwrite (bytes, 1, len, file) != len)
     {
-        g_warning ("Child threads gzopen failed");
-        success = 0;
-        goto cleanup_gz_thread_func;
+        g_warning ("Could not write the compressed file '%s'. The error is '%s' (errno %d)",
+                   filename, g_strerror (errno) ? g_strerror (errno) : "", errno);
+        return FALSE;
     }
+    return TRUE;
+}
 
-    if (params->compress)
+/* Read everything from params->fd and write it to params->filename as
+ * gzip, deflating on all available cores.  Blocks are written in order
+ * as they complete; at most twice as many as there are threads are in
+ * flight, which bounds the memory used. */
+static gboolean
+gz_deflate_parallel (gz_thread_params_t* params)
+{
+    static const guchar header[10] =
+    {
+        0x1f, 0x8b, Z_DEFLATED, 0,  /* magic, method, no flags */
+        0, 0, 0, 0,                 /* no modification time */
+        0, 0xff                     /* no extra flags, unknown OS */
+    };
+    /* An empty final block, which is all deflate would emit on Z_FINISH
+     * once everything has been flushed. */
+    static const guchar last_block[2] = { 0x03, 0x00 };
+    gz_deflate_sync_t sync;
+    GThreadPool* pool;
+    GQueue pending = G_QUEUE_INIT;
+    guint n_threads = MAX (g_get_num_processors (), 1);
+    guchar dict[GZ_DICT_LEN];
+    gsize dict_len = 0;
+    guint32 crc = crc32 (0L, Z_NULL, 0);
+    guint32 isize = 0;
+    guchar trailer[8];
+    gboolean eof = FALSE;
+    gboolean success = TRUE;
+    FILE* file;
+
+    file = g_fopen (params->filename, "wb");
+    if (file == NULL)
+    {
+        g_warning ("Could not open the compressed file '%s'. The error is '%s' (errno %d)",
+                   params->filename,
+                   g_strerror (errno) ? g_strerror (errno) : "", errno);
+        return FALSE;
+    }
+
+    g_mutex_init (&sync.mutex);
+    g_cond_init (&sync.cond);
+    pool = g_thread_pool_new ((GFunc) gz_deflate_block, &sync, n_threads,
+                              FALSE, NULL);
+
+    success = gz_write_bytes (file, header, sizeof (header), params->filename);
+
+    while (success && !eof)
     {
-        while (success)
+        gz_block_t* block = g_new0 (gz_block_t, 1);
+        block->in = static_cast<guchar*> (g_malloc (GZ_BLOCK_LEN));
+
+        while (block->in_len < GZ_BLOCK_LEN)
         {
-            bytes = read (params->fd, buffer, BUFLEN);
+            gssize bytes = read (params->fd, block->in + block->in_len,
+                                 GZ_BLOCK_LEN - block->in_len);
             if (bytes > 0)
+                block->in_len += bytes;
+            else if (bytes == 0)
+                eof = TRUE;
+            else if (errno == EINTR)
+                continue;
+            else
             {
-                if (gzwrite (file, buffer, bytes) <= 0)
-                {
-                    gint errnum;
-                    const gchar* error = gzerror (file, &errnum);
-                    g_warning ("Could not write the compressed file '%s'. The error is: '%s' (%d)",
-                               params->filename, error, errnum);
-                    success = 0;
-                }
+                g_warning ("Could not read from pipe. The error is '%s' (errno %d)",
+                           g_strerror (errno) ? g_strerror (errno) : "", errno);
+                success = FALSE;
             }
-            else if (bytes == 0)
+            if (bytes <= 0)
+                break;
+        }
+
+        if (!success || block->in_len == 0)
+        {
+            gz_block_free (block);
+            break;
+        }
+
+        memcpy (block->dict, dict, dict_len);
+        block->dict_len = dict_len;
+        dict_len = MIN (block->in_len, GZ_DICT_LEN);
+        memcpy (dict, block->in + block->in_len - dict_len, dict_len);
+
+        g_queue_push_tail (&pending, block);
+        g_thread_pool_push (pool, block, NULL);
+
+        /* Write out finished blocks, waiting for the oldest one only
+         * when enough are queued up behind it. */
+        while (!g_queue_is_empty (&pending))
+        {
+            gz_block_t* head =
+                static_cast<gz_block_t*> (g_queue_peek_head (&pending));
+
+            g_mutex_lock (&sync.mutex);
+            if (!eof && !head->done &&
+                g_queue_get_length (&pending) < 2 * n_threads)
             {
+                g_mutex_unlock (&sync.mutex);
                 break;
             }
-            else
+            while (!head->done)
+                g_cond_wait (&sync.cond, &sync.mutex);
+            g_mutex_unlock (&sync.mutex);
+
+            g_queue_pop_head (&pending);
+            if (success && !head->ok)
             {
-                g_warning ("Could not read from pipe. The error is '%s' (errno %d)",
-                           g_strerror (errno) ? g_strerror (errno) : "", errno);
-                success = 0;
+                g_warning ("Could not compress data for the file '%s'",
+                           params->filename);
+                success = FALSE;
             }
+            if (success)
+                success = gz_write_bytes (file, head->out, head->out_len,
+                                          params->filename);
+            crc = crc32_combine (crc, head->crc, head->in_len);
+            isize += head->in_len;
+            gz_block_free (head);
         }
     }
-    else
+
+    /* Wait for anything still being compressed after a failure. */
+    g_thread_pool_free (pool, FALSE, TRUE);
+    g_queue_foreach (&pending, (GFunc) gz_block_free, NULL);
+    g_queue_clear (&pending);
+    g_mutex_clear (&sync.mutex);
+    g_cond_clear (&sync.cond);
+
+    for (guint i = 0; i < 4; i++)
+    {
+        trailer[i] = (crc >> (8 * i)) & 0xff;
+        trailer[i + 4] = (isize >> (8 * i)) & 0xff;
+    }
+
+    if (success)
+        success = gz_write_bytes (file, last_block, sizeof (last_block),
+                                  params->filename)
+            && gz_write_bytes (file, trailer, sizeof (trailer),
+                               params->filename);
+
+    if (fclose (file) != 0)
+    {
+        g_warning ("Could not close the compressed file '%s'. The error is '%s' (errno %d)",
+                   params->filename,
+                   g_strerror (errno) ? g_strerror (errno) : "", errno);
+        success = FALSE;
+    }
+
+    return success;
+}
+
+#ifdef HAVE_ZSTD
+/* Read everything from params->fd and write it to params->filename as a
+ * single zstd frame.  libzstd spreads the work over several threads by
+ * itself if it was built with multithreading; otherwise that request is
+ * silently ignored. */
+static gboolean
+zstd_compress_stream (gz_thread_params_t* params)
+{
+    size_t in_len = ZSTD_CStreamInSize ();
+    size_t out_len = ZSTD_CStreamOutSize ();
+    char* in_buf;
+    char* out_buf;
+    ZSTD_CCtx* cctx;
+    gboolean success = TRUE;
+    gboolean eof = FALSE;
+    FILE* file;
+
+    file = g_fopen (params->filename, "wb");
+    if (file == NULL)
+    {
+        g_warning ("Could not open the compressed file '%s'. The error is '%s' (errno %d)",
+                   params->filename,
+                   g_strerror (errno) ? g_strerror (errno) : "", errno);
+        return FALSE;
+    }
+
+    in_buf = static_cast<char*> (g_malloc (in_len));
+    out_buf = static_cast<char*> (g_malloc (out_len));
+    cctx = ZSTD_createCCtx ();
+    ZSTD_CCtx_setParameter (cctx, ZSTD_c_compressionLevel, ZSTD_CLEVEL_DEFAULT);
+    ZSTD_CCtx_setParameter (cctx, ZSTD_c_checksumFlag, 1);
+    ZSTD_CCtx_setParameter (cctx, ZSTD_c_nbWorkers, g_get_num_processors ());
+
+    while (success && !eof)
+    {
+        gssize bytes = read (params->fd, in_buf, in_len);
+        ZSTD_EndDirective mode = ZSTD_e_continue;
+        gboolean finished = FALSE;
+
+        if (bytes < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            g_warning ("Could not read from pipe. The error is '%s' (errno %d)",
+                       g_strerror (errno) ? g_strerror (errno) : "", errno);
+            success = FALSE;
+            break;
+        }
+        if (bytes == 0)
+        {
+            eof = TRUE;
+            mode = ZSTD_e_end;
+        }
+
+        ZSTD_inBuffer input = { in_buf, static_cast<size_t> (bytes), 0 };
+        while (success && !finished)
+        {
+            ZSTD_outBuffer output = { out_buf, out_len, 0 };
+            size_t remaining = ZSTD_compressStream2 (cctx, &output, &input, mode);
+            if (ZSTD_isError (remaining))
+            {
+                g_warning ("Could not compress data for the file '%s': %s",
+                           params->filename, ZSTD_getErrorName (remaining));
+                success = FALSE;
+                break;
+            }
+            success = gz_write_bytes (file, out_buf, output.pos,
+                                      params->filename);
+            finished = eof ? remaining == 0 : input.pos == input.size;
+        }
+    }
+
+    ZSTD_freeCCtx (cctx);
+    g_free (in_buf);
+    g_free (out_buf);
+
+    if (fclose (file) != 0)
+    {
+        g_warning ("Could not close the compressed file '%s'. The error is '%s' (errno %d)",
+                   params->filename,
+                   g_strerror (errno) ? g_strerror (errno) : "", errno);
+        success = FALSE;
+    }
+
+    return success;
+}
+
+/* Decompress params->filename into params->fd. */
+static gboolean
+zstd_decompress_stream (gz_thread_params_t* params)
+{
+    size_t in_len = ZSTD_DStreamInSize ();
+    size_t out_len = ZSTD_DStreamOutSize ();
+    size_t last = 0;
+    size_t num_read;
+    char* in_buf;
+    char* out_buf;
+    ZSTD_DCtx* dctx;
+    gboolean success = TRUE;
+    FILE* file;
+
+    file = g_fopen (params->filename, "rb");
+    if (file == NULL)
     {
-        while (success)
+        g_warning ("Could not open the compressed file '%s'. The error is '%s' (errno %d)",
+                   params->filename,
+                   g_strerror (errno) ? g_strerror (errno) : "", errno);
+        return FALSE;
+    }
+
+    in_buf = static_cast<char*> (g_malloc (in_len));
+    out_buf = static_cast<char*> (g_malloc (out_len));
+    dctx = ZSTD_createDCtx ();
+
+    while (success && (num_read = fread (in_buf, 1, in_len, file)) > 0)
+    {
+        ZSTD_inBuffer input = { in_buf, num_read, 0 };
+        while (success && input.pos < input.size)
         {
-            gzval = gzread (file, buffer, BUFLEN);
-            if (gzval > 0)
+            ZSTD_outBuffer output = { out_buf, out_len, 0 };
+            last = ZSTD_decompressStream (dctx, &output, &input);
+            if (ZSTD_isError (last))
             {
-                if (
+                g_warning ("Could not read from compressed file '%s'. The error is: '%s'",
+                           params->filename, ZSTD_getErrorName (last));
+                success = FALSE;
+            }
+            else if (output.pos &&
 #if COMPILER(MSVC)
-                    _write
+                     _write
 #else
-                    write
+                     write
 #endif
-                    (params->fd, buffer, gzval) < 0)
-                {
-                    g_warning ("Could not write to pipe. The error is '%s' (%d)",
-                               g_strerror (errno) ? g_strerror (errno) : "", errno);
-                    success = 0;
-                }
-            }
-            else if (gzval == 0)
+                     (params->fd, out_buf, output.pos) < 0)
             {
-                break;
+                g_warning ("Could not write to pipe. The error is '%s' (%d)",
+                           g_strerror (errno) ? g_strerror (errno) : "", errno);
+                success = FALSE;
             }
-            else
+        }
+    }
+
+    if (success && (ferror (file) || last != 0))
+    {
+        g_warning ("Could not read from compressed file '%s'. The file is truncated.",
+                   params->filename);
+        success = FALSE;
+    }
+
+    ZSTD_freeDCtx (dctx);
+    g_free (in_buf);
+    g_free (out_buf);
+    fclose (file);
+
+    return success;
+}
+#endif /* HAVE_ZSTD */
+
+/* Compress or decompress function that is to be run in a separate thread.
+ * Returns 1 on success or 0 otherwise, stuffed into a pointer type. */
+static gpointer
+gz_thread_func (gz_thread_params_t* params)
+{
+    gchar* buffer = static_cast<gchar*> (g_malloc (GZ_CHUNK_LEN));
+    gint gzval;
+    gzFile file;
+    gint success = 1;
+
+#ifdef HAVE_ZSTD
+    if (params->compression == GNC_XML_COMPRESSION_ZSTD)
+    {
+        if (params->compress)
+            success = zstd_compress_stream (params) ? 1 : 0;
+        else
+            success = zstd_decompress_stream (params) ? 1 : 0;
+        goto cleanup_gz_thread_func;
+    }
+#endif
+
+    if (params->compress)
+    {
+        success = gz_deflate_parallel (params) ? 1 : 0;
+        goto cleanup_gz_thread_func;
+    }
+
+#ifdef G_OS_WIN32
+    {
+        gchar* conv_name = g_win32_locale_filename_from_utf8 (params->filename);
+        gchar* perms;
+
+        if (!conv_name)
+        {
+            g_warning ("Could not convert '%s' to system codepage",
+                       params->filename);
+            success = 0;
+            goto cleanup_gz_thread_func;
+        }
+
+        if (strchr (params->perms, 'b'))
+            perms = g_strdup (params->perms);
+        else
+            perms = g_strdup_printf ("%cb%s", *params->perms, params->perms + 1);
+
+        file = gzopen (conv_name, perms);
+        g_free (perms);
+        g_free (conv_name);
+    }
+#else /* !G_OS_WIN32 */
+    file = gzopen (params->filename, params->perms);
+#endif /* G_OS_WIN32 */
+
+    if (file == NULL)
+    {
+        g_warning ("Child threads gzopen failed");
+        success = 0;
+        goto cleanup_gz_thread_func;
+    }
+
+    gzbuffer (file, GZ_CHUNK_LEN);
+
+    while (success)
+    {
+        gzval = gzread (file, buffer, GZ_CHUNK_LEN);
+        if (gzval > 0)
+        {
+            if (
+#if COMPILER(MSVC)
+                _write
+#else
+                write
+#endif
+                (params->fd, buffer, gzval) < 0)
             {
-                gint errnum;
-                const gchar* error = gzerror (file, &errnum);
-                g_warning ("Could not read from compressed file '%s'. The error is: '%s' (%d)",
-                           params->filename, error, errnum);
+                g_warning ("Could not write to pipe. The error is '%s' (%d)",
+                           g_strerror (errno) ? g_strerror (errno) : "", errno);
                 success = 0;
             }
         }
+        else if (gzval == 0)
+        {
+            break;
+        }
+        else
+        {
+            gint errnum;
+            const gchar* error = gzerror (file, &errnum);
+            g_warning ("Could not read from compressed file '%s'. The error is: '%s' (%d)",
+                       params->filename, error, errnum);
+            success = 0;
+        }
     }
 
     if ((gzval = gzclose (file)) != Z_OK)
@@ -1496,6 +2385,7 @@ gz_thread_func (gz_thread_params_t* params)
     }
 
 cleanup_gz_thread_func:
+    g_free (buffer);
     close (params->fd);
     g_free (params->filename);
     g_free (params->perms);
@@ -1505,15 +2395,31 @@ cleanup_gz_thread_func:
 }
 
 static FILE*
-try_gz_open (const char* filename, const char* perms, gboolean use_gzip,
-             gboolean compress)
+try_gz_open (const char* filename, const char* perms,
+             GncXmlCompression compression, gboolean compress)
 {
-    if (strstr (filename, ".gz.") != NULL) /* its got a temp extension */
-        use_gzip = TRUE;
+    if (compression == GNC_XML_COMPRESSION_NONE &&
+        strstr (filename, ".gz.") != NULL) /* its got a temp extension */
+        compression = GNC_XML_COMPRESSION_GZIP;
 
-    if (!use_gzip)
+    if (compression == GNC_XML_COMPRESSION_NONE)
         return g_fopen (filename, perms);
 
+#ifndef HAVE_ZSTD
+    if (compression == GNC_XML_COMPRESSION_ZSTD)
+    {
+        if (!compress)
+        {
+            g_warning ("'%s' is zstd compressed, but this build has no zstd support.",
+                       filename);
+            return NULL;
+        }
+        PWARN ("No zstd support in this build, writing '%s' with gzip.",
+               filename);
+        compression = GNC_XML_COMPRESSION_GZIP;
+    }
+#endif
+
     {
         int filedes[2];
         GThread* thread;
@@ -1531,10 +2437,16 @@ try_gz_open (const char* filename, const char* perms, gboolean use_gzip,
             return g_fopen (filename, perms);
         }
 
+#ifdef F_SETPIPE_SZ
+        /* Best effort; the pipe works either way, just with less slack. */
+        fcntl (filedes[0], F_SETPIPE_SZ, GZ_PIPE_LEN);
+#endif
+
         params = g_new (gz_thread_params_t, 1);
         params->fd = filedes[compress ? 0 : 1];
         params->filename = g_strdup (filename);
         params->perms = g_strdup (perms);
+        params->compression = compression;
         params->compress = compress;
 
         thread = g_thread_new ("xml_thread", (GThreadFunc) gz_thread_func,
@@ -1592,12 +2504,12 @@ gboolean
 gnc_book_write_to_xml_file_v2 (
     QofBook* book,
     const char* filename,
-    gboolean compress)
+    GncXmlCompression compression)
 {
     FILE* out;
     gboolean success = TRUE;
 
-    out = try_gz_open (filename, "w", compress, TRUE);
+    out = try_gz_open (filename, "w", compression, TRUE);
 
     /* Try to write as much as possible */
     if (!out
@@ -1609,13 +2521,455 @@ gnc_book_write_to_xml_file_v2 (
         success = FALSE;
 
     /* Optionally wait for parallel compression threads */
-    if (out && compress)
+    if (out && compression != GNC_XML_COMPRESSION_NONE)
         if (!wait_for_gzip (out))
             success = FALSE;
 
     return success;
 }
 
+gboolean
+gnc_xml_write_compressed_copy (const char* xml_file, const char* filename,
+                               GncXmlCompression compression)
+{
+    gboolean success = TRUE;
+
+    auto in = g_fopen (xml_file, "rb");
+    if (!in)
+        return FALSE;
+    auto out = try_gz_open (filename, "w", compression, TRUE);
+    if (!out)
+    {
+        fclose (in);
+        return FALSE;
+    }
+
+    auto buffer = static_cast<char*> (g_malloc (GZ_CHUNK_LEN));
+    size_t count;
+    while ((count = fread (buffer, 1, GZ_CHUNK_LEN, in)) > 0)
+    {
+        if (fwrite (buffer, 1, count, out) != count)
+        {
+            success = FALSE;
+            break;
+        }
+    }
+    if (ferror (in))
+        success = FALSE;
+    g_free (buffer);
+    fclose (in);
+
+    if (fclose (out))
+        success = FALSE;
+    if (compression != GNC_XML_COMPRESSION_NONE && !wait_for_gzip (out))
+        success = FALSE;
+
+    return success;
+}
+
+/***********************************************************************/
+/* The journal holds the transactions changed since the data file was
+ * last written, one record per transaction saved: the record carries the
+ * transaction's GUID and its new state, or nothing if it was deleted.
+ * The root element is never closed so that records can simply be
+ * appended; the reader closes it after the last complete record.
+ */
+#define JOURNAL_TAG "gnc-journal"
+#define JOURNAL_RECORD_TAG "jrn:record"
+#define JOURNAL_RECORD_END "</" JOURNAL_RECORD_TAG ">\n"
+#define JOURNAL_GUID_ATTR "jrn:guid"
+#define JOURNAL_BOOK_SIZE_ATTR "jrn:book-size"
+#define JOURNAL_BOOK_MTIME_ATTR "jrn:book-mtime"
+
+static gboolean
+write_journal_header (FILE* out, const GStatBuf* book_stat)
+{
+    return fprintf (out, "<?xml version=\"1.0\" encoding=\"utf-8\" ?>\n") >= 0
+           && fprintf (out, "<" JOURNAL_TAG) >= 0
+           && gnc_xml2_write_namespace_decl (out, "gnc")
+           && gnc_xml2_write_namespace_decl (out, "jrn")
+           && gnc_xml2_write_namespace_decl (out, "cmdty")
+           && gnc_xml2_write_namespace_decl (out, "slot")
+           && gnc_xml2_write_namespace_decl (out, "split")
+           && gnc_xml2_write_namespace_decl (out, "trn")
+           && gnc_xml2_write_namespace_decl (out, "ts")
+           && fprintf (out, "\n     " JOURNAL_BOOK_SIZE_ATTR "=\"%" G_GINT64_FORMAT
+                       "\" " JOURNAL_BOOK_MTIME_ATTR "=\"%" G_GINT64_FORMAT "\">\n",
+                       (gint64) book_stat->st_size,
+                       (gint64) book_stat->st_mtime) >= 0;
+}
+
+gboolean
+gnc_book_append_to_xml_journal (QofBook* book, const char* journal,
+                                const char* book_file, GList* guids)
+{
+    GStatBuf statbuf;
+    gboolean is_new;
+    gboolean success = TRUE;
+    GncXmlWriter writer;
+    FILE* out;
+
+    g_return_val_if_fail (book && journal && book_file, FALSE);
+
+    is_new = g_stat (journal, &statbuf) != 0;
+    if (is_new && g_stat (book_file, &statbuf) != 0)
+        return FALSE;
+
+    out = g_fopen (journal, "ab");
+    if (out == NULL)
+        return FALSE;
+
+    if (is_new && !write_journal_header (out, &statbuf))
+        success = FALSE;
+
+    for (GList* node = guids; success && node; node = node->next)
+    {
+        auto guid = static_cast<const GncGUID*> (node->data);
+        auto trans = xaccTransLookup (guid, book);
+        gchar guidstr[GUID_ENCODING_LENGTH + 1];
+
+        guid_to_string_buff (guid, guidstr);
+        if (fprintf (out, "<" JOURNAL_RECORD_TAG " " JOURNAL_GUID_ATTR "=\"%s\">\n",
+                     guidstr) < 0)
+        {
+            success = FALSE;
+            break;
+        }
+
+        if (trans && !qof_instance_get_destroying (trans))
+        {
+            gnc_transaction_to_xml_stream (writer, trans);
+            if (!writer.write (out) || fprintf (out, "\n") < 0)
+            {
+                success = FALSE;
+                break;
+            }
+        }
+
+        if (fprintf (out, JOURNAL_RECORD_END) < 0)
+            success = FALSE;
+    }
+
+    if (fflush (out) != 0)
+        success = FALSE;
+#ifdef G_OS_WIN32
+    if (success && _commit (fileno (out)) != 0)
+        success = FALSE;
+#else
+    if (success && fsync (fileno (out)) != 0)
+        success = FALSE;
+#endif
+    if (fclose (out) != 0)
+        success = FALSE;
+
+    return success;
+}
+
+static gboolean
+journal_stamp_matches (const gchar* header, const char* book_file)
+{
+    const gchar* size_attr = strstr (header, JOURNAL_BOOK_SIZE_ATTR "=\"");
+    const gchar* mtime_attr = strstr (header, JOURNAL_BOOK_MTIME_ATTR "=\"");
+    GStatBuf statbuf;
+
+    if (!size_attr || !mtime_attr || g_stat (book_file, &statbuf) != 0)
+        return FALSE;
+
+    size_attr += strlen (JOURNAL_BOOK_SIZE_ATTR "=\"");
+    mtime_attr += strlen (JOURNAL_BOOK_MTIME_ATTR "=\"");
+    return g_ascii_strtoll (size_attr, NULL, 10) == (gint64) statbuf.st_size
+           && g_ascii_strtoll (mtime_attr, NULL, 10) == (gint64) statbuf.st_mtime;
+}
+
+/* Replaying keeps only the last record of each transaction.  The whole
+ * journal is parsed into DOM trees and checked before the book is
+ * touched, so a journal that can't be read leaves the book as loaded.
+ * Only then are all the transactions that have records destroyed, so
+ * that a split that moved between transactions is never in two of them
+ * at once, and the last state of each rebuilt from its tree. */
+typedef struct
+{
+    GHashTable* records;  /* GncGUID* -> xmlNodePtr of the last record,
+                           * NULL if the transaction was deleted */
+    GncGUID guid;         /* of the record being parsed */
+    xmlNodePtr tree;      /* its transaction, if there is one yet */
+} journal_replay_data;
+
+static gboolean
+journal_record_start_handler (GSList* sibling_data, gpointer parent_data,
+                              gpointer global_data,
+                              gpointer* data_for_children, gpointer* result,
+                              const gchar* tag, gchar** attrs)
+{
+    gxpf_data* gdata = (gxpf_data*)global_data;
+    auto replay = static_cast<journal_replay_data*> (gdata->parsedata);
+    gboolean have_guid = FALSE;
+
+    for (gchar** attr = attrs; attr && attr[0]; attr += 2)
+        if (g_strcmp0 (attr[0], JOURNAL_GUID_ATTR) == 0 && attr[1])
+            have_guid = string_to_guid (attr[1], &replay->guid);
+
+    if (!have_guid)
+    {
+        PERR ("journal record without a transaction guid");
+        return FALSE;
+    }
+    replay->tree = NULL;
+    return TRUE;
+}
+
+static gboolean
+journal_record_end_handler (gpointer data_for_children,
+                            GSList* data_from_children, GSList* sibling_data,
+                            gpointer parent_data, gpointer global_data,
+                            gpointer* result, const gchar* tag)
+{
+    gxpf_data* gdata = (gxpf_data*)global_data;
+    auto replay = static_cast<journal_replay_data*> (gdata->parsedata);
+
+    /* A later record replaces an earlier one, which frees its tree. */
+    g_hash_table_replace (replay->records, guid_copy (&replay->guid),
+                          replay->tree);
+    replay->tree = NULL;
+    return TRUE;
+}
+
+static gboolean
+journal_transaction_end_handler (gpointer data_for_children,
+                                 GSList* data_from_children,
+                                 GSList* sibling_data,
+                                 gpointer parent_data, gpointer global_data,
+                                 gpointer* result, const gchar* tag)
+{
+    xmlNodePtr tree = (xmlNodePtr)data_for_children;
+    gxpf_data* gdata = (gxpf_data*)global_data;
+    auto replay = static_cast<journal_replay_data*> (gdata->parsedata);
+
+    if (parent_data)
+        return TRUE;
+
+    /* OK.  For some messed up reason this is getting called again with a
+       NULL tag.  So we ignore those cases */
+    if (!tag)
+        return TRUE;
+
+    g_return_val_if_fail (tree, FALSE);
+
+    if (replay->tree)
+    {
+        PERR ("journal record with more than one transaction");
+        xmlFreeNode (tree);
+        return FALSE;
+    }
+    replay->tree = tree;
+    return TRUE;
+}
+
+/* Check that the transaction in tree is the one its record is for and
+ * that all of its splits are in accounts of the book: the journal only
+ * records transactions, never the accounts they use. */
+static gboolean
+journal_record_valid (const GncGUID* guid, xmlNodePtr tree, QofBook* book)
+{
+    gboolean have_id = FALSE;
+
+    for (xmlNodePtr node = tree->xmlChildrenNode; node; node = node->next)
+    {
+        if (g_strcmp0 ("trn:id", (char*)node->name) == 0)
+        {
+            GncGUID* id = dom_tree_to_guid (node);
+            have_id = id && guid_equal (id, guid);
+            guid_free (id);
+            if (!have_id)
+                return FALSE;
+        }
+        else if (g_strcmp0 ("trn:splits", (char*)node->name) == 0)
+        {
+            for (xmlNodePtr split = node->xmlChildrenNode; split;
+                 split = split->next)
+            {
+                if (g_strcmp0 ("trn:split", (char*)split->name))
+                    continue;
+                for (xmlNodePtr child = split->xmlChildrenNode; child;
+                     child = child->next)
+                {
+                    if (g_strcmp0 ("split:account", (char*)child->name))
+                        continue;
+                    GncGUID* id = dom_tree_to_guid (child);
+                    gboolean found = id && xaccAccountLookup (id, book);
+                    guid_free (id);
+                    if (!found)
+                        return FALSE;
+                }
+            }
+        }
+    }
+    return have_id;
+}
+
+GncJournalReplay
+gnc_book_replay_xml_journal (QofBook* book, const char* journal,
+                             const char* book_file)
+{
+    gchar* contents = NULL;
+    gsize length = 0;
+    GError* error = NULL;
+    gchar* header;
+    gchar* header_end;
+    gchar* last_record;
+    gsize keep;
+    gboolean stamp_ok;
+    GString* doc;
+    sixtp* top_parser;
+    sixtp* journal_parser;
+    sixtp* record_parser;
+    journal_replay_data replay;
+    gxpf_data gpdata;
+    gpointer parse_result = NULL;
+    GHashTableIter iter;
+    gpointer key, value;
+    GncJournalReplay status = GNC_JOURNAL_REPLAYED;
+
+    g_return_val_if_fail (book && journal && book_file, GNC_JOURNAL_BAD);
+
+    if (!g_file_get_contents (journal, &contents, &length, &error))
+    {
+        PWARN ("Unable to read journal %s: %s", journal, error->message);
+        g_error_free (error);
+        return GNC_JOURNAL_BAD;
+    }
+
+    header = strstr (contents, "<" JOURNAL_TAG);
+    header_end = header ? strchr (header, '>') : NULL;
+    if (!header_end)
+    {
+        PWARN ("%s is not a journal", journal);
+        g_free (contents);
+        return GNC_JOURNAL_BAD;
+    }
+    ++header_end;
+
+    gchar saved = *header_end;
+    *header_end = '\0';
+    stamp_ok = journal_stamp_matches (header, book_file);
+    *header_end = saved;
+    if (!stamp_ok)
+    {
+        PWARN ("Journal %s was not written for the current %s",
+               journal, book_file);
+        g_free (contents);
+        return GNC_JOURNAL_STALE;
+    }
+
+    /* Anything after the last complete record was cut short. */
+    last_record = g_strrstr_len (header_end, contents + length - header_end,
+                                 JOURNAL_RECORD_END);
+    keep = last_record ? last_record - contents + strlen (JOURNAL_RECORD_END)
+                       : header_end - contents;
+    if (keep < length)
+        PWARN ("Ignoring an incomplete record at the end of %s", journal);
+
+    doc = g_string_new_len (contents, keep);
+    g_string_append (doc, "</" JOURNAL_TAG ">\n");
+    g_free (contents);
+
+    top_parser = sixtp_new ();
+    journal_parser = sixtp_new ();
+    record_parser = sixtp_set_any (sixtp_new (), FALSE,
+                                   SIXTP_START_HANDLER_ID,
+                                   journal_record_start_handler,
+                                   SIXTP_END_HANDLER_ID,
+                                   journal_record_end_handler,
+                                   SIXTP_NO_MORE_HANDLERS);
+    if (!sixtp_add_some_sub_parsers (
+            top_parser, TRUE,
+            JOURNAL_TAG, journal_parser,
+            NULL, NULL)
+        || !sixtp_add_some_sub_parsers (
+            journal_parser, TRUE,
+            JOURNAL_RECORD_TAG, record_parser,
+            NULL, NULL)
+        || !sixtp_add_some_sub_parsers (
+            record_parser, TRUE,
+            TRANSACTION_TAG,
+            sixtp_dom_parser_new (journal_transaction_end_handler, NULL, NULL),
+            NULL, NULL))
+    {
+        /* A failed sixtp_add_some_sub_parsers has already destroyed
+         * the parser it was given, so top_parser can't be trusted. */
+        g_string_free (doc, TRUE);
+        return GNC_JOURNAL_BAD;
+    }
+
+    replay.records = g_hash_table_new_full (guid_hash_to_guint,
+                                            guid_g_hash_table_equal,
+                                            (GDestroyNotify) guid_free,
+                                            (GDestroyNotify) xmlFreeNode);
+    replay.tree = NULL;
+    gpdata.cb = NULL;
+    gpdata.parsedata = &replay;
+    gpdata.bookdata = book;
+    if (!sixtp_parse_buffer (top_parser, doc->str, doc->len,
+                             NULL, &gpdata, &parse_result))
+    {
+        PWARN ("Unable to parse journal %s", journal);
+        status = GNC_JOURNAL_BAD;
+    }
+    xmlFreeNode (replay.tree);
+    sixtp_destroy (top_parser);
+    g_string_free (doc, TRUE);
+
+    g_hash_table_iter_init (&iter, replay.records);
+    while (status == GNC_JOURNAL_REPLAYED &&
+           g_hash_table_iter_next (&iter, &key, &value))
+    {
+        if (value && !journal_record_valid (static_cast<GncGUID*> (key),
+                                            static_cast<xmlNodePtr> (value),
+                                            book))
+        {
+            PWARN ("Journal %s has a transaction that doesn't fit the book",
+                   journal);
+            status = GNC_JOURNAL_BAD;
+        }
+    }
+
+    if (status == GNC_JOURNAL_REPLAYED)
+    {
+        xaccLogDisable ();
+        xaccDisableDataScrubbing ();
+
+        g_hash_table_iter_init (&iter, replay.records);
+        while (g_hash_table_iter_next (&iter, &key, &value))
+        {
+            auto trans = xaccTransLookup (static_cast<GncGUID*> (key), book);
+            if (trans)
+            {
+                xaccTransBeginEdit (trans);
+                xaccTransDestroy (trans);
+                xaccTransCommitEdit (trans);
+            }
+        }
+
+        g_hash_table_iter_init (&iter, replay.records);
+        while (g_hash_table_iter_next (&iter, &key, &value))
+        {
+            if (value &&
+                !dom_tree_to_transaction (static_cast<xmlNodePtr> (value), book))
+            {
+                PWARN ("Unable to replay a transaction from journal %s",
+                       journal);
+                status = GNC_JOURNAL_BAD;
+            }
+        }
+
+        xaccEnableDataScrubbing ();
+        xaccLogEnable ();
+    }
+
+    g_hash_table_destroy (replay.records);
+    return status;
+}
+
 /*
  * Have to pass in the backend as this routine needs the temporary
  * backend for file export, not the real backend which could be
@@ -1650,36 +3004,98 @@ gnc_book_write_accounts_to_xml_file_v2 (QofBackend* qof_be, QofBook* book,
 }
 
 /***********************************************************************/
-static gboolean
-is_gzipped_file (const gchar* name)
+static GncXmlCompression
+compressed_file_type (const gchar* name)
 {
-    unsigned char buf[2];
+    unsigned char buf[4];
+    ssize_t num_read;
     int fd = g_open (name, O_RDONLY, 0);
 
     if (fd == -1)
     {
-        return FALSE;
+        return GNC_XML_COMPRESSION_NONE;
     }
 
-    if (read (fd, buf, 2) != 2)
+    num_read = read (fd, buf, 4);
+    close (fd);
+
+    if (num_read >= 2 && buf[0] == 037 && buf[1] == 0213)
     {
-        close (fd);
-        return FALSE;
+        return GNC_XML_COMPRESSION_GZIP;
     }
-    close (fd);
 
-    if (buf[0] == 037 && buf[1] == 0213)
+    /* zstd frame magic, 0xFD2FB528 little-endian */
+    if (num_read == 4 && buf[0] == 0x28 && buf[1] == 0xb5 &&
+        buf[2] == 0x2f && buf[3] == 0xfd)
     {
-        return TRUE;
+        return GNC_XML_COMPRESSION_ZSTD;
     }
 
-    return FALSE;
+    return GNC_XML_COMPRESSION_NONE;
 }
 
-QofBookFileType
-gnc_is_xml_data_file_v2 (const gchar* name, gboolean* with_encoding)
+#ifdef HAVE_ZSTD
+/* Decompress just enough of a zstd file to sniff its first chunk. */
+static int
+zstd_read_head (const gchar* name, char* head, size_t head_len)
 {
-    if (is_gzipped_file (name))
+    size_t in_len = ZSTD_DStreamInSize ();
+    char* in_buf;
+    ZSTD_DCtx* dctx;
+    ZSTD_outBuffer output = { head, head_len, 0 };
+    FILE* file = g_fopen (name, "rb");
+    size_t num_read;
+
+    if (file == NULL)
+        return -1;
+
+    in_buf = static_cast<char*> (g_malloc (in_len));
+    dctx = ZSTD_createDCtx ();
+    while (output.pos < output.size &&
+           (num_read = fread (in_buf, 1, in_len, file)) > 0)
+    {
+        ZSTD_inBuffer input = { in_buf, num_read, 0 };
+        while (input.pos < input.size && output.pos < output.size)
+            if (ZSTD_isError (ZSTD_decompressStream (dctx, &output, &input)))
+            {
+                output.pos = 0;
+                goto done;
+            }
+    }
+
+done:
+    ZSTD_freeDCtx (dctx);
+    g_free (in_buf);
+    fclose (file);
+    return output.pos;
+}
+#endif
+
+static QofBookFileType
+sniff_xml_data_file (const gchar* name, gboolean* with_encoding)
+{
+    GncXmlCompression compression = compressed_file_type (name);
+
+    if (compression == GNC_XML_COMPRESSION_ZSTD)
+    {
+#ifdef HAVE_ZSTD
+        char first_chunk[256];
+        int num_read = zstd_read_head (name, first_chunk,
+                                       sizeof (first_chunk) - 1);
+
+        if (num_read < 1)
+            return GNC_BOOK_NOT_OURS;
+
+        first_chunk[num_read] = '\0';
+        return gnc_is_our_first_xml_chunk (first_chunk, with_encoding);
+#else
+        PWARN ("'%s' is zstd compressed, but this build has no zstd support.",
+               name);
+        return GNC_BOOK_NOT_OURS;
+#endif
+    }
+
+    if (compression == GNC_XML_COMPRESSION_GZIP)
     {
         gzFile file = NULL;
         char first_chunk[256];
@@ -1714,6 +3130,64 @@ gnc_is_xml_data_file_v2 (const gchar* name, gboolean* with_encoding)
     return (gnc_is_our_xml_file (name, with_encoding));
 }
 
+/* Opening a book probes its type several times over: the provider's
+ * type_check, then load, then every sync.  Remember the last answer
+ * for as long as the file is the same one, so that only the first of
+ * them has to open and decompress it.  A rewritten file has a new inode
+ * or mtime. */
+struct xml_sniff_cache
+{
+    std::string name;
+    gint64 size;
+    gint64 mtime;
+    guint64 inode;
+    QofBookFileType type;
+    gboolean with_encoding;
+};
+static xml_sniff_cache sniff_cache;
+G_LOCK_DEFINE_STATIC (sniff_cache);
+
+QofBookFileType
+gnc_is_xml_data_file_v2 (const gchar* name, gboolean* with_encoding)
+{
+    GStatBuf statbuf;
+    QofBookFileType type;
+    gboolean encoding = FALSE;
+
+    g_return_val_if_fail (name, GNC_BOOK_NOT_OURS);
+
+    if (g_stat (name, &statbuf) != 0)
+        return sniff_xml_data_file (name, with_encoding);
+
+    G_LOCK (sniff_cache);
+    if (sniff_cache.name == name && sniff_cache.size == statbuf.st_size &&
+        sniff_cache.mtime == statbuf.st_mtime &&
+        sniff_cache.inode == statbuf.st_ino)
+    {
+        type = sniff_cache.type;
+        encoding = sniff_cache.with_encoding;
+        G_UNLOCK (sniff_cache);
+        if (with_encoding)
+            *with_encoding = encoding;
+        return type;
+    }
+    G_UNLOCK (sniff_cache);
+
+    type = sniff_xml_data_file (name, &encoding);
+    if (with_encoding)
+        *with_encoding = encoding;
+
+    /* Don't remember failures: the caller may want errno from the open. */
+    if (type != GNC_BOOK_NOT_OURS)
+    {
+        G_LOCK (sniff_cache);
+        sniff_cache = {name, statbuf.st_size, statbuf.st_mtime,
+                       statbuf.st_ino, type, encoding};
+        G_UNLOCK (sniff_cache);
+    }
+    return type;
+}
+
 
 static void
 replace_character_references (gchar* string)
@@ -1805,11 +3279,11 @@ gnc_xml2_find_ambiguous (const gchar* filename, GList* encodings,
     GHashTable* processed = NULL;
     gint n_impossible = 0;
     GError* error = NULL;
-    gboolean is_compressed;
+    GncXmlCompression compression;
     gboolean clean_return = FALSE;
 
-    is_compressed = is_gzipped_file (filename);
-    file = try_gz_open (filename, "r", is_compressed, FALSE);
+    compression = compressed_file_type (filename);
+    file = try_gz_open (filename, "r", compression, FALSE);
     if (file == NULL)
     {
         PWARN ("Unable to open file %s", filename);
@@ -1992,7 +3466,7 @@ cleanup_find_ambs:
     if (file)
     {
         fclose (file);
-        if (is_compressed)
+        if (compression != GNC_XML_COMPRESSION_NONE)
             wait_for_gzip (file);
     }
 
@@ -2014,11 +3488,11 @@ parse_with_subst_push_handler (xmlParserCtxtPtr xml_context,
     GIConv ascii = (GIConv) - 1;
     GString* output = NULL;
     GError* error = NULL;
-    gboolean is_compressed;
+    GncXmlCompression compression;
 
     filename = push_data->filename;
-    is_compressed = is_gzipped_file (filename);
-    file = try_gz_open (filename, "r", is_compressed, FALSE);
+    compression = compressed_file_type (filename);
+    file = try_gz_open (filename, "r", compression, FALSE);
     if (file == NULL)
     {
         PWARN ("Unable to open file %s", filename);
@@ -2132,7 +3606,7 @@ cleanup_push_handler:
     if (file)
     {
         fclose (file);
-        if (is_compressed)
+        if (compression != GNC_XML_COMPRESSION_NONE)
             wait_for_gzip (file);
     }
 }
@@ -2149,7 +3623,7 @@ gnc_xml2_parse_with_subst (GncXmlBackend* xml_be, QofBook* book, GHashTable* sub
 
     success = qof_session_load_from_xml_file_v2_full (
                   xml_be, book, (sixtp_push_handler) parse_with_subst_push_handler,
-                  push_data, GNC_BOOK_XML2_FILE);
+                  push_data, GNC_BOOK_XML2_FILE, NULL);
     g_free (push_data);
 
     if (success)
@@ -87,11 +87,77 @@ typedef struct
 /** read in an account group from a file */
 gboolean qof_session_load_from_xml_file_v2 (GncXmlBackend*, QofBook*,
                                             QofBookFileType);
+/** read in a version 2 file, writing the transactions nothing else in the
+ * book refers to to target and destroying them as they're read */
+gboolean qof_session_stream_from_xml_file_v2 (GncXmlBackend*, QofBook*,
+                                              QofBackend* target);
+
+/** How gnc_book_write_to_xml_file_v2 compresses the file.  Loading
+ * recognizes either kind by its magic bytes. */
+typedef enum
+{
+    GNC_XML_COMPRESSION_NONE,
+    GNC_XML_COMPRESSION_GZIP,
+    GNC_XML_COMPRESSION_ZSTD,   /**< falls back to gzip if built without zstd */
+} GncXmlCompression;
 
 /* write all book info to a file */
 gboolean gnc_book_write_to_xml_filehandle_v2 (QofBook* book, FILE* fh);
 gboolean gnc_book_write_to_xml_file_v2 (QofBook* book, const char* filename,
-                                        gboolean compress);
+                                        GncXmlCompression compression);
+/** Write the uncompressed book in xml_file to filename, compressed.  Uses
+ * neither the engine nor the backend, so it can run on any thread. */
+gboolean gnc_xml_write_compressed_copy (const char* xml_file,
+                                        const char* filename,
+                                        GncXmlCompression compression);
+
+/** Append the current state of the transactions whose GUIDs are in
+ * @a guids to the journal file @a journal, creating it if needed.  A
+ * transaction that is no longer in @a book is recorded as deleted.  A
+ * new journal is stamped with the size and modification time of
+ * @a book_file, the data file it amends, so that it is never replayed
+ * over some other version of that file.  The journal is flushed to disk
+ * before returning.
+ *
+ * @param guids A GList of GncGUID*.
+ * @return TRUE if every record was written.
+ */
+gboolean gnc_book_append_to_xml_journal (QofBook* book, const char* journal,
+                                         const char* book_file, GList* guids);
+
+typedef enum
+{
+    GNC_JOURNAL_REPLAYED,       /**< the journal is now part of the book */
+    GNC_JOURNAL_STALE,          /**< it was written for another version of
+                                 * the data file; the book is untouched */
+    GNC_JOURNAL_BAD,            /**< it can't be read or parsed or doesn't
+                                 * fit the book */
+} GncJournalReplay;
+
+/** Replay @a journal, written by gnc_book_append_to_xml_journal, into
+ * @a book, which must have just been loaded from @a book_file.  A record
+ * that was cut short, e.g. by a crash while writing it, is ignored.
+ *
+ * The whole journal is parsed and checked before @a book is changed.
+ * Only if the engine still rejects one of its transactions is
+ * GNC_JOURNAL_BAD returned with @a book partly replayed, so a bad
+ * journal must fail the load rather than be set aside.
+ */
+GncJournalReplay gnc_book_replay_xml_journal (QofBook* book,
+                                              const char* journal,
+                                              const char* book_file);
+
+/** Write a snapshot of the compressed book @a book_file to @a snapshot:
+ * its decompressed XML behind a header stamped with the book file's size,
+ * modification time and SHA-256, so that loading the book can map and
+ * parse the snapshot instead of decompressing the file.  A snapshot that
+ * no longer matches its book file is ignored.
+ *
+ * @return TRUE if the snapshot was written.  Always FALSE on platforms
+ * without mmap, which can't load snapshots.
+ */
+gboolean gnc_book_write_xml_snapshot (const char* book_file,
+                                      const char* snapshot);
 
 /** write just the commodities and accounts to a file */
 gboolean gnc_book_write_accounts_to_xml_filehandle_v2 (QofBackend* be,
@@ -40,17 +40,16 @@ write_one_account (FILE* out,
                    sixtp_gdv2* gd,
                    gboolean allow_incompat)
 {
-    xmlNodePtr accnode;
+    GncXmlWriter writer;
 
-    accnode =
-        gnc_account_dom_tree_create (account, gd && gd->exporting, allow_incompat);
+    gnc_account_to_xml_stream (writer, account, gd && gd->exporting,
+                               allow_incompat);
 
-    xmlElemDump (out, NULL, accnode);
-    xmlFreeNode (accnode);
+    auto written = writer.write (out);
 
     g_return_val_if_fail(gd, FALSE);
 
-    if (ferror (out) || fprintf (out, "\n") < 0)
+    if (!written || fprintf (out, "\n") < 0)
         return FALSE;
 
     gd->counter.accounts_loaded++;
@@ -336,3 +336,230 @@ qof_instance_slots_to_dom_tree (const char* tag, const QofInstance* inst)
     frame->for_each_slot_temp (&add_kvp_slot, ret);
     return ret;
 }
+
+/***********************************************************************/
+/* Streaming generators */
+
+gboolean
+text_to_xml_stream (GncXmlWriter& writer, const char* tag, const char* str)
+{
+    g_return_val_if_fail (tag, FALSE);
+    g_return_val_if_fail (str, FALSE);
+    /* xmlNodeAddContent ignores an empty string, leaving <tag/>. */
+    writer.text_element (tag, *str ? str : nullptr);
+    return TRUE;
+}
+
+gboolean
+int_to_xml_stream (GncXmlWriter& writer, const char* tag, gint64 val)
+{
+    char text[24];
+
+    g_snprintf (text, sizeof (text), "%" G_GINT64_FORMAT, val);
+    return text_to_xml_stream (writer, tag, text);
+}
+
+gboolean
+guid_to_xml_stream (GncXmlWriter& writer, const char* tag, const GncGUID* gid)
+{
+    char guid_str[GUID_ENCODING_LENGTH + 1];
+
+    if (!guid_to_string_buff (gid, guid_str))
+    {
+        PERR ("guid_to_string_buff failed\n");
+        return FALSE;
+    }
+
+    writer.start_element (tag);
+    writer.add_attribute ("type", "guid");
+    writer.add_text (guid_str);
+    writer.end_element ();
+    return TRUE;
+}
+
+gboolean
+commodity_ref_to_xml_stream (GncXmlWriter& writer, const char* tag,
+                             const gnc_commodity* c)
+{
+    g_return_val_if_fail (c, FALSE);
+
+    auto name_space = gnc_commodity_get_namespace (c);
+    auto mnemonic = gnc_commodity_get_mnemonic (c);
+    if (!name_space || !mnemonic)
+        return FALSE;
+
+    writer.start_element (tag);
+    writer.text_element ("cmdty:space", name_space);
+    writer.text_element ("cmdty:id", mnemonic);
+    writer.end_element ();
+    return TRUE;
+}
+
+/* The ts:date text time64_to_dom_tree writes, or an empty string where it
+ * gives up. */
+static std::string
+time64_to_xml_date (time64 time)
+{
+    g_return_val_if_fail (time != INT64_MAX, "");
+    auto date_str = GncDateTime(time).format_iso8601();
+    if (!date_str.empty())
+        date_str += " +0000";
+    return date_str;
+}
+
+gboolean
+time64_to_xml_stream (GncXmlWriter& writer, const char* tag, time64 time)
+{
+    auto date_str = time64_to_xml_date (time);
+    if (date_str.empty())
+        return FALSE;
+
+    writer.start_element (tag);
+    writer.text_element ("ts:date", date_str.c_str());
+    writer.end_element ();
+    return TRUE;
+}
+
+gboolean
+gnc_numeric_to_xml_stream (GncXmlWriter& writer, const char* tag,
+                           const gnc_numeric* num)
+{
+    gchar* numstr;
+
+    g_return_val_if_fail (num, FALSE);
+
+    numstr = gnc_numeric_to_string (*num);
+    g_return_val_if_fail (numstr, FALSE);
+
+    writer.text_element (tag, numstr);
+    g_free (numstr);
+    return TRUE;
+}
+
+static void
+typed_text_to_xml_stream (GncXmlWriter& writer, const char* tag,
+                          const char* type, const char* text)
+{
+    writer.start_element (tag);
+    writer.add_attribute ("type", type);
+    if (text)
+        writer.add_text (text);
+    writer.end_element ();
+}
+
+static void add_kvp_slot_to_xml_stream (const char* key, KvpValue* value,
+                                        GncXmlWriter& writer);
+
+static void
+add_kvp_value_to_xml_stream (GncXmlWriter& writer, const char* tag,
+                             KvpValue* val)
+{
+    switch (val->get_type ())
+    {
+    case KvpValue::Type::INT64:
+    {
+        char text[24];
+        g_snprintf (text, sizeof (text), "%" G_GINT64_FORMAT,
+                    val->get<int64_t> ());
+        typed_text_to_xml_stream (writer, tag, "integer", text);
+        break;
+    }
+    case KvpValue::Type::DOUBLE:
+    {
+        auto text = double_to_string (val->get<double> ());
+        typed_text_to_xml_stream (writer, tag, "double", text);
+        g_free (text);
+        break;
+    }
+    case KvpValue::Type::NUMERIC:
+    {
+        auto text = gnc_numeric_to_string (val->get<gnc_numeric> ());
+        typed_text_to_xml_stream (writer, tag, "numeric", text);
+        g_free (text);
+        break;
+    }
+    case KvpValue::Type::STRING:
+        typed_text_to_xml_stream (writer, tag, "string",
+                                  val->get<const char*> ());
+        break;
+    case KvpValue::Type::GUID:
+    {
+        gchar guidstr[GUID_ENCODING_LENGTH + 1];
+        guid_to_string_buff (val->get<GncGUID*> (), guidstr);
+        typed_text_to_xml_stream (writer, tag, "guid", guidstr);
+        break;
+    }
+    /* Note: The type attribute must remain 'timespec' to maintain
+     * compatibility.
+     */
+    case KvpValue::Type::TIME64:
+    {
+        auto date_str = time64_to_xml_date (val->get<Time64> ().t);
+        if (date_str.empty())
+            break;
+        writer.start_element (tag);
+        writer.add_attribute ("type", "timespec");
+        writer.text_element ("ts:date", date_str.c_str());
+        writer.end_element ();
+        break;
+    }
+    case KvpValue::Type::GDATE:
+    {
+        auto d = val->get<GDate> ();
+        char date_str[512] = "";
+        g_date_strftime (date_str, sizeof (date_str), "%Y-%m-%d", &d);
+        writer.start_element (tag);
+        writer.add_attribute ("type", "gdate");
+        writer.text_element ("gdate", date_str);
+        writer.end_element ();
+        break;
+    }
+    case KvpValue::Type::GLIST:
+        writer.start_element (tag);
+        writer.add_attribute ("type", "list");
+        for (auto cursor = val->get<GList*> (); cursor; cursor = cursor->next)
+        {
+            auto val = static_cast<KvpValue*> (cursor->data);
+            add_kvp_value_to_xml_stream (writer, "slot:value", val);
+        }
+        writer.end_element ();
+        break;
+    case KvpValue::Type::FRAME:
+    {
+        writer.start_element (tag);
+        writer.add_attribute ("type", "frame");
+        auto frame = val->get<KvpFrame*> ();
+        if (frame)
+            frame->for_each_slot_temp (&add_kvp_slot_to_xml_stream, writer);
+        writer.end_element ();
+        break;
+    }
+    default:
+        writer.empty_element (tag);
+        break;
+    }
+}
+
+static void
+add_kvp_slot_to_xml_stream (const char* key, KvpValue* value,
+                            GncXmlWriter& writer)
+{
+    writer.start_element ("slot");
+    writer.text_element ("slot:key", key);
+    add_kvp_value_to_xml_stream (writer, "slot:value", value);
+    writer.end_element ();
+}
+
+gboolean
+qof_instance_slots_to_xml_stream (GncXmlWriter& writer, const char* tag,
+                                  const QofInstance* inst)
+{
+    KvpFrame* frame = qof_instance_get_slots (inst);
+    if (!frame || frame->empty())
+        return FALSE;
+
+    writer.start_element (tag);
+    frame->for_each_slot_temp (&add_kvp_slot_to_xml_stream, writer);
+    writer.end_element ();
+    return TRUE;
+}
@@ -34,6 +34,7 @@ extern "C"
 }
 
 #include "gnc-xml-helper.h"
+#include "gnc-xml-writer.hpp"
 
 xmlNodePtr text_to_dom_tree (const char* tag, const char* str);
 xmlNodePtr int_to_dom_tree (const char* tag, gint64 val);
@@ -50,4 +51,22 @@ xmlNodePtr recurrence_to_dom_tree (const gchar* tag, const Recurrence* r);
 
 gchar* double_to_string (double value);
 
+/* Streaming counterparts of the generators above: each writes exactly what
+ * xmlElemDump would print for the tree its *_dom_tree twin returns, and
+ * returns FALSE, having written nothing, where the twin returns NULL. */
+gboolean text_to_xml_stream (GncXmlWriter& writer, const char* tag,
+                             const char* str);
+gboolean int_to_xml_stream (GncXmlWriter& writer, const char* tag, gint64 val);
+gboolean guid_to_xml_stream (GncXmlWriter& writer, const char* tag,
+                             const GncGUID* gid);
+gboolean commodity_ref_to_xml_stream (GncXmlWriter& writer, const char* tag,
+                                      const gnc_commodity* c);
+gboolean time64_to_xml_stream (GncXmlWriter& writer, const char* tag,
+                               time64 time);
+gboolean gnc_numeric_to_xml_stream (GncXmlWriter& writer, const char* tag,
+                                    const gnc_numeric* num);
+gboolean qof_instance_slots_to_xml_stream (GncXmlWriter& writer,
+                                           const char* tag,
+                                           const QofInstance* inst);
+
 #endif /* _SIXTP_DOM_GENERATORS_H_ */
@@ -35,4 +35,13 @@ sixtp* sixtp_dom_parser_new (sixtp_end_handler ender,
                              sixtp_result_handler cleanup_result_by_default_func,
                              sixtp_result_handler cleanup_result_on_fail_func);
 
+/* Create a parser that turns just the element it is registered for
+   into a DOM tree, so that an otherwise event-driven parser can hand
+   a small subtree (slots, say) to the dom_tree_* converters.  Unlike
+   sixtp_dom_parser_new, parent_data may be anything: the ender gets
+   the tree in data_for_children, the enclosing parser's data in
+   parent_data, and must xmlFreeNode the tree itself.
+*/
+sixtp* sixtp_dom_subtree_parser_new (sixtp_end_handler ender);
+
 #endif /* _SIXTP_PARSERS_H_ */
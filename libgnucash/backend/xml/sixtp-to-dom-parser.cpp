@@ -35,6 +35,26 @@ extern "C"
 
 static xmlNsPtr global_namespace = NULL;
 
+static void
+dom_set_attributes (xmlNodePtr thing, gchar** attrs)
+{
+    gchar** atptr = attrs;
+
+    if (attrs == NULL)
+        return;
+
+    while (*atptr != 0)
+    {
+        gchar* attr0 = g_strdup (atptr[0]);
+        gchar* attr1 = g_strdup (atptr[1]);
+        xmlSetProp (thing, checked_char_cast (attr0),
+                    checked_char_cast (attr1));
+        g_free (attr0);
+        g_free (attr1);
+        atptr += 2;
+    }
+}
+
 /* Don't pass anything in the data_for_children value to this
    function.  It'll cause a segfault */
 static gboolean dom_start_handler (
@@ -43,7 +63,6 @@ static gboolean dom_start_handler (
     gchar** attrs)
 {
     xmlNodePtr thing;
-    gchar** atptr = attrs;
 
     if (parent_data == NULL)
     {
@@ -61,19 +80,7 @@ static gboolean dom_start_handler (
     }
     *data_for_children = thing;
 
-    if (attrs != NULL)
-    {
-        while (*atptr != 0)
-        {
-            gchar* attr0 = g_strdup (atptr[0]);
-            gchar* attr1 = g_strdup (atptr[1]);
-            xmlSetProp (thing, checked_char_cast (attr0),
-                        checked_char_cast (attr1));
-            g_free (attr0);
-            g_free (attr1);
-            atptr += 2;
-        }
-    }
+    dom_set_attributes (thing, attrs);
     return TRUE;
 }
 
@@ -141,3 +148,75 @@ sixtp_dom_parser_new (sixtp_end_handler ender,
 
     return top_level;
 }
+
+/* The root of a subtree parser always starts a fresh tree, whatever the
+   enclosing parser handed down as parent_data, and keeps it in
+   data_for_children so the ender can find its owner in parent_data. */
+static gboolean
+dom_subtree_start_handler (GSList* sibling_data, gpointer parent_data,
+                           gpointer global_data, gpointer* data_for_children,
+                           gpointer* result, const gchar* tag, gchar** attrs)
+{
+    xmlNodePtr thing = xmlNewNode (global_namespace, BAD_CAST tag);
+
+    dom_set_attributes (thing, attrs);
+    *data_for_children = thing;
+    return TRUE;
+}
+
+static void
+dom_subtree_fail_handler (gpointer data_for_children,
+                          GSList* data_from_children,
+                          GSList* sibling_data,
+                          gpointer parent_data,
+                          gpointer global_data,
+                          gpointer* result,
+                          const gchar* tag)
+{
+    if (data_for_children)
+        xmlFreeNode (static_cast<xmlNodePtr> (data_for_children));
+}
+
+static gboolean
+dom_subtree_child_end_handler (gpointer data_for_children,
+                               GSList* data_from_children,
+                               GSList* sibling_data,
+                               gpointer parent_data,
+                               gpointer global_data,
+                               gpointer* result,
+                               const gchar* tag)
+{
+    return TRUE;
+}
+
+sixtp*
+sixtp_dom_subtree_parser_new (sixtp_end_handler ender)
+{
+    sixtp* top_level;
+    sixtp* children;
+
+    g_return_val_if_fail (ender, NULL);
+
+    if (! (top_level =
+               sixtp_set_any (sixtp_new (), FALSE,
+                              SIXTP_START_HANDLER_ID, dom_subtree_start_handler,
+                              SIXTP_CHARACTERS_HANDLER_ID, dom_chars_handler,
+                              SIXTP_END_HANDLER_ID, ender,
+                              SIXTP_FAIL_HANDLER_ID, dom_subtree_fail_handler,
+                              SIXTP_NO_MORE_HANDLERS)))
+    {
+        return NULL;
+    }
+
+    /* Everything below the root has a parent node in parent_data, which
+       is exactly what the plain DOM parser expects. */
+    if (! (children = sixtp_dom_parser_new (dom_subtree_child_end_handler,
+                                            NULL, NULL)) ||
+        !sixtp_add_sub_parser (top_level, SIXTP_MAGIC_CATCHER, children))
+    {
+        sixtp_destroy (top_level);
+        return NULL;
+    }
+
+    return top_level;
+}
@@ -68,6 +68,10 @@ struct sixtp_gdv2
     countCallbackFn countCallback;
     QofBePercentageFunc gui_display_fn;
     gboolean exporting;
+    /* Where to write the transactions nothing else refers to as they're
+     * read, so that they needn't be kept; NULL to keep them all. */
+    QofBackend* stream_to;
+    gboolean stream_failed;
 };
 typedef struct _sixtp_child_result sixtp_child_result;
 
@@ -105,6 +105,20 @@ write_dom_node_to_file (xmlNodePtr node, int fd)
     fclose (out);
 }
 
+gboolean
+equals_node_dump_vs_string (xmlNodePtr node, int level, const std::string& str)
+{
+    xmlBufferPtr buf = xmlBufferCreate ();
+    gboolean ret;
+
+    xmlNodeDump (buf, NULL, node, level, 1);
+    ret = str.compare (0, std::string::npos,
+                       reinterpret_cast<const char*> (xmlBufferContent (buf)),
+                       xmlBufferLength (buf)) == 0;
+    xmlBufferFree (buf);
+    return ret;
+}
+
 gboolean
 print_dom_tree (gpointer data_for_children, GSList* data_from_children,
                 GSList* sibling_data, gpointer parent_data,
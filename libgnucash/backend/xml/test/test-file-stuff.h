@@ -34,6 +34,7 @@ extern "C"
 #include <gnc-xml-helper.h>
 #include <io-gncxml-gen.h>
 #include <sixtp.h>
+#include <string>
 
 #ifndef __KVP_FRAME
 typedef struct KvpFrameImpl KvpFrame;
@@ -60,6 +61,9 @@ gboolean equals_node_val_vs_kvp_frame (xmlNodePtr node, const KvpFrame* frm);
 gboolean equals_node_val_vs_date (xmlNodePtr node, time64);
 gboolean equals_node_val_vs_int (xmlNodePtr node, gint64 val);
 gboolean equals_node_val_vs_boolean (xmlNodePtr node, gboolean val);
+/* Whether str is exactly what xmlElemDump prints for node at level. */
+gboolean equals_node_dump_vs_string (xmlNodePtr node, int level,
+                                     const std::string& str);
 
 void
 test_files_in_dir (int argc, char** argv, gxpf_callback cb,
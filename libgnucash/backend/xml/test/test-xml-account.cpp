@@ -270,6 +270,17 @@ test_account (int i, Account* test_act)
         success ("account_xml");
     }
 
+    {
+        GncXmlWriter writer;
+        gnc_account_to_xml_stream (writer, test_act, FALSE, TRUE);
+        if (!equals_node_dump_vs_string (test_node, 0, writer.str ()))
+            failure_args ("account_xml_stream", __FILE__, __LINE__,
+                          "streamed account differs from dom tree:\n%s",
+                          writer.str ().c_str ());
+        else
+            success ("account_xml_stream");
+    }
+
     filename1 = g_strdup_printf ("test_file_XXXXXX");
 
     fd = g_mkstemp (filename1);
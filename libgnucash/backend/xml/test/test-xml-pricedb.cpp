@@ -63,6 +63,20 @@ test_add_pricedb (const char* tag, gpointer globaldata, gpointer data)
     return TRUE;
 }
 
+static gboolean
+test_price_stream (GNCPrice* price, gpointer data)
+{
+    auto node = static_cast<xmlNodePtr*> (data);
+    GncXmlWriter writer (1);
+
+    gnc_price_to_xml_stream (writer, price);
+    if (!*node || !equals_node_dump_vs_string (*node, 1, writer.str ()))
+        return FALSE;
+
+    *node = (*node)->next;
+    return TRUE;
+}
+
 static void
 test_db (GNCPriceDB* db)
 {
@@ -83,6 +97,17 @@ test_db (GNCPriceDB* db)
     if (!db)
         return;
 
+    {
+        xmlNodePtr child = test_node->xmlChildrenNode;
+        if (!gnc_pricedb_xml_writable (db) ||
+            !gnc_pricedb_foreach_price (db, test_price_stream, &child, TRUE) ||
+            child)
+            failure_args ("pricedb_xml_stream", __FILE__, __LINE__,
+                          "streamed prices differ from dom tree");
+        else
+            success ("pricedb_xml_stream");
+    }
+
     filename1 = g_strdup_printf ("test_file_XXXXXX");
 
     fd = g_mkstemp (filename1);
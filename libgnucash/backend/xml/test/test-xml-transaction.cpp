@@ -344,6 +344,7 @@ struct tran_data_struct
     Transaction* trn;
     Transaction* new_trn;
     gnc_commodity* com;
+    xmlNodePtr node;
     int value;
 };
 typedef struct tran_data_struct tran_data;
@@ -365,6 +366,30 @@ test_add_transaction (const char* tag, gpointer globaldata, gpointer data)
                        "%d", gdata->value))
         retval = FALSE;
 
+    /* The DOM conversion is still used for template transactions and
+       must agree with the event-driven parser. */
+    {
+        Transaction* dom_trn = dom_tree_to_transaction (gdata->node, book);
+
+        if (!do_test_args (dom_trn != NULL,
+                           "dom_tree_to_transaction",
+                           __FILE__, __LINE__, "%d", gdata->value))
+            retval = FALSE;
+        else
+        {
+            xaccTransBeginEdit (dom_trn);
+            xaccTransSetCurrency (dom_trn, gdata->com);
+            xaccTransCommitEdit (dom_trn);
+
+            if (!do_test_args (xaccTransEqual (trans, dom_trn,
+                                               TRUE, TRUE, TRUE, FALSE),
+                               "dom_tree_to_transaction",
+                               __FILE__, __LINE__, "%d", gdata->value))
+                retval = FALSE;
+            really_get_rid_of_transaction (dom_trn);
+        }
+    }
+
     gdata->new_trn = trans;
 
     return retval;
@@ -441,6 +466,18 @@ test_transaction (void)
             success_args ("transaction_xml", __FILE__, __LINE__, "%d", i);
         }
 
+        {
+            GncXmlWriter writer;
+            gnc_transaction_to_xml_stream (writer, ran_trn);
+            if (!equals_node_dump_vs_string (test_node, 0, writer.str ()))
+                failure_args ("transaction_xml_stream", __FILE__, __LINE__,
+                              "streamed transaction differs from dom tree:\n%s",
+                              writer.str ().c_str ());
+            else
+                success_args ("transaction_xml_stream", __FILE__, __LINE__,
+                              "%d", i);
+        }
+
         filename1 = g_strdup_printf ("test_file_XXXXXX");
 
         fd = g_mkstemp (filename1);
@@ -480,6 +517,7 @@ test_transaction (void)
                                (GLogFunc)test_checked_handler, &check);
             data.trn = ran_trn;
             data.com = com;
+            data.node = test_node;
             data.value = i;
             parser = gnc_transaction_sixtp_parser_create ();
 
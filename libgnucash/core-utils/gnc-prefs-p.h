@@ -112,4 +112,9 @@ typedef struct
 
 extern PrefsBackend *prefsbackend;
 
+/** Forget the values gnc_prefs_get_bool, _int and _enum have kept and
+ *  the callbacks that keep them up to date, e.g. before changing
+ *  prefsbackend. */
+void gnc_prefs_cache_reset (void);
+
 #endif /* GNC_PREFS_P_H_ */
@@ -32,6 +32,17 @@ static gchar *namespace_regexp    = NULL;
 static gboolean is_debugging      = FALSE;
 static gboolean extras_enabled    = FALSE;
 static gboolean use_compression   = TRUE; // This is also the default in the prefs backend
+static gboolean use_zstd          = FALSE; // This is also the default in the prefs backend
+static gboolean use_journal       = FALSE; // This is also the default in the prefs backend
+static gboolean use_snapshot      = FALSE; // This is also the default in the prefs backend
+static gint file_archive_years    = 0;    // This is also the default in the prefs backend
+static gint sql_insert_rows       = 100;  // This is also the default in the prefs backend
+static gboolean sql_load_on_demand = FALSE; // This is also the default in the prefs backend
+static gboolean sql_async_commit  = FALSE; // This is also the default in the prefs backend
+static gboolean sql_change_log    = FALSE; // This is also the default in the prefs backend
+static gboolean sqlite_paranoid   = FALSE; // This is also the default in the prefs backend
+static gboolean sql_native_guids  = FALSE; // This is also the default in the prefs backend
+static gint sql_slow_query_ms     = 0;    // This is also the default in the prefs backend
 static gint file_retention_policy = 1;    // 1 = "days", the default in the prefs backend
 static gint file_retention_days   = 30;   // This is also the default in the prefs backend
 
@@ -43,6 +54,216 @@ static gulong reg_negative_color_pref_id;
 
 PrefsBackend *prefsbackend = NULL;
 
+/* The values read by gnc_prefs_get_bool, _int and _enum, which the
+ * registers and account trees ask for over and over.  Each is read from
+ * the backend once and forgotten when the backend says it changed or
+ * it's set through here.  A value is only kept if the backend will say
+ * when it changes. */
+typedef enum
+{
+    PREFS_CACHE_BOOL = 1 << 0,
+    PREFS_CACHE_INT  = 1 << 1,
+    PREFS_CACHE_ENUM = 1 << 2,
+} PrefsCacheType;
+
+typedef struct
+{
+    gulong handler_id;
+    guint valid;
+    gboolean bool_value;
+    gint int_value;
+    gint enum_value;
+} PrefsCacheEntry;
+
+/* group -> (pref_name -> PrefsCacheEntry) */
+static GHashTable *prefs_cache = NULL;
+/* group -> gulong* handler id of prefs_cache_group_changed */
+static GHashTable *prefs_cache_groups = NULL;
+G_LOCK_DEFINE_STATIC (prefs_cache);
+
+static void
+prefs_cache_changed (gpointer settings, gchar *key, gpointer user_data)
+{
+    PrefsCacheEntry *entry = user_data;
+
+    G_LOCK (prefs_cache);
+    entry->valid = 0;
+    G_UNLOCK (prefs_cache);
+}
+
+static void
+prefs_cache_forget (const gchar *group, const gchar *pref_name);
+
+/* Any preference of a group changed; user_data is the group. */
+static void
+prefs_cache_group_changed (gpointer settings, gchar *key, gpointer user_data)
+{
+    prefs_cache_forget (user_data, key);
+}
+
+/* Call with the lock held.  Creates the entry if create is TRUE. */
+static PrefsCacheEntry *
+prefs_cache_lookup (const gchar *group, const gchar *pref_name,
+                    gboolean create)
+{
+    GHashTable *prefs;
+    PrefsCacheEntry *entry;
+
+    if (!prefs_cache)
+        prefs_cache = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+                                             (GDestroyNotify) g_hash_table_unref);
+    prefs = g_hash_table_lookup (prefs_cache, group);
+    if (!prefs)
+    {
+        if (!create)
+            return NULL;
+        prefs = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+        g_hash_table_insert (prefs_cache, g_strdup (group), prefs);
+    }
+    entry = g_hash_table_lookup (prefs, pref_name);
+    if (!entry && create)
+    {
+        entry = g_new0 (PrefsCacheEntry, 1);
+        if (prefsbackend->register_cb)
+            entry->handler_id = (prefsbackend->register_cb) (group, pref_name,
+                                                             prefs_cache_changed,
+                                                             entry);
+        g_hash_table_insert (prefs, g_strdup (pref_name), entry);
+    }
+    return entry;
+}
+
+static gboolean
+prefs_cache_usable (const gchar *group, const gchar *pref_name)
+{
+    return group && pref_name && *pref_name;
+}
+
+static void
+prefs_cache_forget (const gchar *group, const gchar *pref_name)
+{
+    PrefsCacheEntry *entry;
+
+    if (!prefs_cache_usable (group, pref_name))
+        return;
+    G_LOCK (prefs_cache);
+    entry = prefs_cache_lookup (group, pref_name, FALSE);
+    if (entry)
+        entry->valid = 0;
+    G_UNLOCK (prefs_cache);
+}
+
+static void
+prefs_cache_forget_entry (gpointer key, gpointer value, gpointer user_data)
+{
+    ((PrefsCacheEntry*)value)->valid = 0;
+}
+
+static void
+prefs_cache_forget_group (gpointer key, gpointer value, gpointer user_data)
+{
+    g_hash_table_foreach (value, prefs_cache_forget_entry, NULL);
+}
+
+static void
+prefs_cache_forget_all (const gchar *group)
+{
+    GHashTable *prefs;
+
+    G_LOCK (prefs_cache);
+    if (prefs_cache && group)
+    {
+        prefs = g_hash_table_lookup (prefs_cache, group);
+        if (prefs)
+            prefs_cache_forget_group (NULL, prefs, NULL);
+    }
+    else if (prefs_cache)
+        g_hash_table_foreach (prefs_cache, prefs_cache_forget_group, NULL);
+    G_UNLOCK (prefs_cache);
+}
+
+static void
+prefs_cache_remove_group (gpointer key, gpointer value, gpointer user_data)
+{
+    GHashTableIter iter;
+    gpointer entry;
+
+    g_hash_table_iter_init (&iter, value);
+    while (g_hash_table_iter_next (&iter, NULL, &entry))
+        if (((PrefsCacheEntry*)entry)->handler_id && prefsbackend &&
+            prefsbackend->remove_cb_by_id)
+            (prefsbackend->remove_cb_by_id) (key,
+                                             ((PrefsCacheEntry*)entry)->handler_id);
+}
+
+static void
+prefs_cache_remove_group_handler (gpointer key, gpointer value,
+                                  gpointer user_data)
+{
+    if (*(gulong*)value && prefsbackend && prefsbackend->remove_cb_by_id)
+        (prefsbackend->remove_cb_by_id) (key, *(gulong*)value);
+}
+
+void
+gnc_prefs_cache_reset (void)
+{
+    G_LOCK (prefs_cache);
+    if (prefs_cache)
+    {
+        g_hash_table_foreach (prefs_cache, prefs_cache_remove_group, NULL);
+        g_hash_table_destroy (prefs_cache);
+        prefs_cache = NULL;
+    }
+    if (prefs_cache_groups)
+    {
+        g_hash_table_foreach (prefs_cache_groups,
+                              prefs_cache_remove_group_handler, NULL);
+        g_hash_table_destroy (prefs_cache_groups);
+        prefs_cache_groups = NULL;
+    }
+    G_UNLOCK (prefs_cache);
+}
+
+/* The backend calls a preference's callbacks in the order they were
+ * registered, so the cache has to hear of a change before anyone who
+ * might read the new value: make its entry, and so its own callback,
+ * before registering theirs. */
+static void
+prefs_cache_prepare (const gchar *group, const gchar *pref_name)
+{
+    if (!prefs_cache_usable (group, pref_name))
+        return;
+    G_LOCK (prefs_cache);
+    prefs_cache_lookup (group, pref_name, TRUE);
+    G_UNLOCK (prefs_cache);
+}
+
+/* The same for a callback on the whole group: one more callback on the
+ * group forgets whichever of its preferences changed. */
+static void
+prefs_cache_prepare_group (const gchar *group)
+{
+    gchar *key;
+    gulong *handler_id;
+
+    if (!group || !prefsbackend->register_group_cb)
+        return;
+    G_LOCK (prefs_cache);
+    if (!prefs_cache_groups)
+        prefs_cache_groups = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                                    g_free, g_free);
+    if (!g_hash_table_lookup (prefs_cache_groups, group))
+    {
+        key = g_strdup (group);
+        handler_id = g_new0 (gulong, 1);
+        g_hash_table_insert (prefs_cache_groups, key, handler_id);
+        *handler_id = (prefsbackend->register_group_cb) (key,
+                                                         prefs_cache_group_changed,
+                                                         key);
+    }
+    G_UNLOCK (prefs_cache);
+}
+
 const gchar *
 gnc_prefs_get_namespace_regexp(void)
 {
@@ -95,6 +316,138 @@ gnc_prefs_set_file_save_compressed(gboolean compressed)
     use_compression = compressed;
 }
 
+gboolean
+gnc_prefs_get_file_save_zstd(void)
+{
+    return use_zstd;
+}
+
+void
+gnc_prefs_set_file_save_zstd(gboolean zstd)
+{
+    use_zstd = zstd;
+}
+
+gboolean
+gnc_prefs_get_file_save_journal(void)
+{
+    return use_journal;
+}
+
+void
+gnc_prefs_set_file_save_journal(gboolean journal)
+{
+    use_journal = journal;
+}
+
+gboolean
+gnc_prefs_get_file_save_snapshot(void)
+{
+    return use_snapshot;
+}
+
+void
+gnc_prefs_set_file_save_snapshot(gboolean snapshot)
+{
+    use_snapshot = snapshot;
+}
+
+gint
+gnc_prefs_get_file_archive_years(void)
+{
+    return file_archive_years;
+}
+
+void
+gnc_prefs_set_file_archive_years(gint years)
+{
+    file_archive_years = years;
+}
+
+gint
+gnc_prefs_get_sql_insert_rows(void)
+{
+    return sql_insert_rows;
+}
+
+void
+gnc_prefs_set_sql_insert_rows(gint rows)
+{
+    sql_insert_rows = rows;
+}
+
+gboolean
+gnc_prefs_get_sql_load_on_demand(void)
+{
+    return sql_load_on_demand;
+}
+
+void
+gnc_prefs_set_sql_load_on_demand(gboolean on_demand)
+{
+    sql_load_on_demand = on_demand;
+}
+
+gboolean
+gnc_prefs_get_sql_async_commit(void)
+{
+    return sql_async_commit;
+}
+
+void
+gnc_prefs_set_sql_async_commit(gboolean async)
+{
+    sql_async_commit = async;
+}
+
+gboolean
+gnc_prefs_get_sql_change_log(void)
+{
+    return sql_change_log;
+}
+
+void
+gnc_prefs_set_sql_change_log(gboolean change_log)
+{
+    sql_change_log = change_log;
+}
+
+gboolean
+gnc_prefs_get_sqlite_paranoid(void)
+{
+    return sqlite_paranoid;
+}
+
+void
+gnc_prefs_set_sqlite_paranoid(gboolean paranoid)
+{
+    sqlite_paranoid = paranoid;
+}
+
+gboolean
+gnc_prefs_get_sql_native_guids(void)
+{
+    return sql_native_guids;
+}
+
+void
+gnc_prefs_set_sql_native_guids(gboolean native)
+{
+    sql_native_guids = native;
+}
+
+gint
+gnc_prefs_get_sql_slow_query_ms(void)
+{
+    return sql_slow_query_ms;
+}
+
+void
+gnc_prefs_set_sql_slow_query_ms(gint ms)
+{
+    sql_slow_query_ms = ms;
+}
+
 gint
 gnc_prefs_get_file_retention_policy(void)
 {
@@ -131,7 +484,10 @@ gulong gnc_prefs_register_cb (const char *group,
                               gpointer user_data)
 {
     if (prefsbackend && prefsbackend->register_cb)
+    {
+        prefs_cache_prepare (group, pref_name);
         return (prefsbackend->register_cb) (group, pref_name, func, user_data);
+    }
     else
     {
         g_warning ("no preferences backend loaded, or the backend doesn't define register_cb, returning 0");
@@ -163,7 +519,10 @@ guint gnc_prefs_register_group_cb (const gchar *group,
                                    gpointer user_data)
 {
     if (prefsbackend && prefsbackend->register_group_cb)
+    {
+        prefs_cache_prepare_group (group);
         return (prefsbackend->register_group_cb) (group, func, user_data);
+    }
     else
         return 0;
 }
@@ -191,20 +550,58 @@ void gnc_prefs_bind (const gchar *group,
 gboolean gnc_prefs_get_bool (const gchar *group,
                              /*@ null @*/ const gchar *pref_name)
 {
-    if (prefsbackend && prefsbackend->get_bool)
+    PrefsCacheEntry *entry;
+    gboolean value;
+
+    if (!(prefsbackend && prefsbackend->get_bool))
+        return FALSE;
+    if (!prefs_cache_usable (group, pref_name))
         return (prefsbackend->get_bool) (group, pref_name);
+
+    G_LOCK (prefs_cache);
+    entry = prefs_cache_lookup (group, pref_name, TRUE);
+    if (entry->valid & PREFS_CACHE_BOOL)
+        value = entry->bool_value;
     else
-        return FALSE;
+    {
+        value = (prefsbackend->get_bool) (group, pref_name);
+        if (entry->handler_id)
+        {
+            entry->bool_value = value;
+            entry->valid |= PREFS_CACHE_BOOL;
+        }
+    }
+    G_UNLOCK (prefs_cache);
+    return value;
 }
 
 
 gint gnc_prefs_get_int (const gchar *group,
                         const gchar *pref_name)
 {
-    if (prefsbackend && prefsbackend->get_int)
+    PrefsCacheEntry *entry;
+    gint value;
+
+    if (!(prefsbackend && prefsbackend->get_int))
+        return 0;
+    if (!prefs_cache_usable (group, pref_name))
         return (prefsbackend->get_int) (group, pref_name);
+
+    G_LOCK (prefs_cache);
+    entry = prefs_cache_lookup (group, pref_name, TRUE);
+    if (entry->valid & PREFS_CACHE_INT)
+        value = entry->int_value;
     else
-        return 0;
+    {
+        value = (prefsbackend->get_int) (group, pref_name);
+        if (entry->handler_id)
+        {
+            entry->int_value = value;
+            entry->valid |= PREFS_CACHE_INT;
+        }
+    }
+    G_UNLOCK (prefs_cache);
+    return value;
 }
 
 
@@ -242,10 +639,29 @@ gchar *gnc_prefs_get_string (const gchar *group,
 gint gnc_prefs_get_enum (const gchar *group,
                          const gchar *pref_name)
 {
-    if (prefsbackend && prefsbackend->get_enum)
+    PrefsCacheEntry *entry;
+    gint value;
+
+    if (!(prefsbackend && prefsbackend->get_enum))
+        return 0;
+    if (!prefs_cache_usable (group, pref_name))
         return (prefsbackend->get_enum) (group, pref_name);
+
+    G_LOCK (prefs_cache);
+    entry = prefs_cache_lookup (group, pref_name, TRUE);
+    if (entry->valid & PREFS_CACHE_ENUM)
+        value = entry->enum_value;
     else
-        return 0;
+    {
+        value = (prefsbackend->get_enum) (group, pref_name);
+        if (entry->handler_id)
+        {
+            entry->enum_value = value;
+            entry->valid |= PREFS_CACHE_ENUM;
+        }
+    }
+    G_UNLOCK (prefs_cache);
+    return value;
 }
 
 void
@@ -278,10 +694,12 @@ gboolean gnc_prefs_set_bool (const gchar *group,
                              const gchar *pref_name,
                              gboolean value)
 {
+    gboolean result = FALSE;
+
     if (prefsbackend && prefsbackend->set_bool)
-        return (prefsbackend->set_bool) (group, pref_name, value);
-    else
-        return FALSE;
+        result = (prefsbackend->set_bool) (group, pref_name, value);
+    prefs_cache_forget (group, pref_name);
+    return result;
 }
 
 
@@ -289,10 +707,12 @@ gboolean gnc_prefs_set_int (const gchar *group,
                             const gchar *pref_name,
                             gint value)
 {
+    gboolean result = FALSE;
+
     if (prefsbackend && prefsbackend->set_int)
-        return (prefsbackend->set_int) (group, pref_name, value);
-    else
-        return FALSE;
+        result = (prefsbackend->set_int) (group, pref_name, value);
+    prefs_cache_forget (group, pref_name);
+    return result;
 }
 
 
@@ -309,10 +729,12 @@ gboolean gnc_prefs_set_float (const gchar *group,
                               const gchar *pref_name,
                               gdouble value)
 {
+    gboolean result = FALSE;
+
     if (prefsbackend && prefsbackend->set_float)
-        return (prefsbackend->set_float) (group, pref_name, value);
-    else
-        return FALSE;
+        result = (prefsbackend->set_float) (group, pref_name, value);
+    prefs_cache_forget (group, pref_name);
+    return result;
 }
 
 
@@ -320,10 +742,12 @@ gboolean gnc_prefs_set_string (const gchar *group,
                                const gchar *pref_name,
                                const gchar *value)
 {
+    gboolean result = FALSE;
+
     if (prefsbackend && prefsbackend->set_string)
-        return (prefsbackend->set_string) (group, pref_name, value);
-    else
-        return FALSE;
+        result = (prefsbackend->set_string) (group, pref_name, value);
+    prefs_cache_forget (group, pref_name);
+    return result;
 }
 
 
@@ -331,10 +755,12 @@ gboolean gnc_prefs_set_enum (const gchar *group,
                              const gchar *pref_name,
                              gint value)
 {
+    gboolean result = FALSE;
+
     if (prefsbackend && prefsbackend->set_enum)
-        return (prefsbackend->set_enum) (group, pref_name, value);
-    else
-        return FALSE;
+        result = (prefsbackend->set_enum) (group, pref_name, value);
+    prefs_cache_forget (group, pref_name);
+    return result;
 }
 
 
@@ -351,10 +777,12 @@ gboolean gnc_prefs_set_value (const gchar *group,
                               const gchar *pref_name,
                               GVariant *value)
 {
+    gboolean result = FALSE;
+
     if (prefsbackend && prefsbackend->set_value)
-        return (prefsbackend->set_value) (group, pref_name, value);
-    else
-        return FALSE;
+        result = (prefsbackend->set_value) (group, pref_name, value);
+    prefs_cache_forget (group, pref_name);
+    return result;
 }
 
 
@@ -363,12 +791,14 @@ void gnc_prefs_reset (const gchar *group,
 {
     if (prefsbackend && prefsbackend->reset)
         (prefsbackend->reset) (group, pref_name);
+    prefs_cache_forget (group, pref_name);
 }
 
 void gnc_prefs_reset_group (const gchar *group)
 {
     if (prefsbackend && prefsbackend->reset_group)
         (prefsbackend->reset_group) (group);
+    prefs_cache_forget_all (group);
 }
 
 gboolean gnc_prefs_is_set_up (void)
@@ -386,6 +816,8 @@ void gnc_prefs_unblock_all (void)
 {
     if (prefsbackend && prefsbackend->unblock_all)
         (prefsbackend->unblock_all) ();
+    /* Changes while the callbacks were blocked weren't seen. */
+    prefs_cache_forget_all (NULL);
 }
 
 gulong gnc_prefs_get_reg_auto_raise_lists_id (void)
@@ -109,6 +109,61 @@ void gnc_prefs_set_extra(gboolean enabled);
 gboolean gnc_prefs_get_file_save_compressed(void);
 void gnc_prefs_set_file_save_compressed(gboolean compressed);
 
+/** Whether a compressed data file should use zstd rather than gzip.
+ *  Only meaningful when gnc_prefs_get_file_save_compressed is TRUE. */
+gboolean gnc_prefs_get_file_save_zstd(void);
+void gnc_prefs_set_file_save_zstd(gboolean zstd);
+
+/** Whether saving an XML data file may append the changed transactions
+ *  to a journal next to it instead of rewriting the whole file. */
+gboolean gnc_prefs_get_file_save_journal(void);
+void gnc_prefs_set_file_save_journal(gboolean journal);
+
+/** Whether saving a compressed XML data file also writes an uncompressed
+ *  snapshot of it for faster loading. */
+gboolean gnc_prefs_get_file_save_snapshot(void);
+void gnc_prefs_set_file_save_snapshot(gboolean snapshot);
+
+/** How many calendar years of transactions, the current one included,
+ *  to load when opening a database; 0 loads them all. */
+gint gnc_prefs_get_file_archive_years(void);
+void gnc_prefs_set_file_archive_years(gint years);
+
+/** How many rows to write with each INSERT statement when saving a whole
+ *  book to a database; 1 writes them one at a time. */
+gint gnc_prefs_get_sql_insert_rows(void);
+void gnc_prefs_set_sql_insert_rows(gint rows);
+
+/** Whether to leave the transactions in a database until an account's
+ *  splits are first needed, rather than loading them all on opening it. */
+gboolean gnc_prefs_get_sql_load_on_demand(void);
+void gnc_prefs_set_sql_load_on_demand(gboolean on_demand);
+
+/** Whether to write committed objects to a database from a background
+ *  thread rather than waiting for each of them. */
+gboolean gnc_prefs_get_sql_async_commit(void);
+void gnc_prefs_set_sql_async_commit(gboolean async);
+
+/** Whether to note each change written to a database in its change log,
+ *  and to load the changes other sessions noted there. */
+gboolean gnc_prefs_get_sql_change_log(void);
+void gnc_prefs_set_sql_change_log(gboolean change_log);
+
+/** Whether to open SQLite files with a synchronous rollback journal
+ *  rather than the faster write-ahead log. */
+gboolean gnc_prefs_get_sqlite_paranoid(void);
+void gnc_prefs_set_sqlite_paranoid(gboolean paranoid);
+
+/** Whether to give GUID columns a native type, where the database has
+ *  one, when saving a book to a new database. */
+gboolean gnc_prefs_get_sql_native_guids(void);
+void gnc_prefs_set_sql_native_guids(gboolean native);
+
+/** How many milliseconds an SQL statement may take before it is logged as
+ *  slow; 0 logs none. */
+gint gnc_prefs_get_sql_slow_query_ms(void);
+void gnc_prefs_set_sql_slow_query_ms(gint ms);
+
 gint gnc_prefs_get_file_retention_policy(void);
 void gnc_prefs_set_file_retention_policy(gint policy);
 
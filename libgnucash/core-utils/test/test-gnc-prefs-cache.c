@@ -0,0 +1,254 @@
+/********************************************************************
+ * test-gnc-prefs-cache.c: Tests of the cache of preference values. *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+\********************************************************************/
+
+#include <config.h>
+#include <glib.h>
+#include <gnc-prefs.h>
+#include <gnc-prefs-p.h>
+
+/* A backend keeping one boolean and one integer preference, counting
+ * its reads and holding on to the change callbacks it was given.  Like
+ * GSettings it calls them in the order they were registered, whether
+ * they are for one preference or the whole group. */
+typedef void (*ChangedFunc) (gpointer settings, gchar *key, gpointer user_data);
+
+#define MAX_CALLBACKS 8
+
+typedef struct
+{
+    const gchar *pref_name;     /* NULL for the whole group */
+    ChangedFunc func;
+    gpointer user_data;
+} Callback;
+
+static const gchar *pref_names[] = { "flag", "count" };
+static gboolean bool_value;
+static gint int_value;
+static guint reads;
+static Callback callbacks[MAX_CALLBACKS];
+static guint n_callbacks;
+static gulong next_id;
+static gboolean give_ids;
+
+static gulong
+add_callback (const gchar *pref_name, gpointer func, gpointer user_data)
+{
+    g_assert_cmpuint (n_callbacks, <, MAX_CALLBACKS);
+    callbacks[n_callbacks].pref_name = pref_name;
+    callbacks[n_callbacks].func = func;
+    callbacks[n_callbacks].user_data = user_data;
+    n_callbacks++;
+    return ++next_id;
+}
+
+static gulong
+fake_register_cb (const char *group, const gchar *pref_name, gpointer func,
+                  gpointer user_data)
+{
+    gint which = g_strcmp0 (pref_name, "flag") == 0 ? 0 : 1;
+
+    if (!give_ids)
+        return 0;
+    return add_callback (pref_names[which], func, user_data);
+}
+
+static guint
+fake_register_group_cb (const gchar *group, gpointer func, gpointer user_data)
+{
+    return add_callback (NULL, func, user_data);
+}
+
+static void
+fake_remove_cb_by_id (const gchar *group, guint id)
+{
+}
+
+static gboolean
+fake_get_bool (const gchar *group, const gchar *pref_name)
+{
+    reads++;
+    return bool_value;
+}
+
+static gint
+fake_get_int (const gchar *group, const gchar *pref_name)
+{
+    reads++;
+    return int_value;
+}
+
+static gboolean
+fake_set_bool (const gchar *group, const gchar *pref_name, gboolean value)
+{
+    bool_value = value;
+    return TRUE;
+}
+
+/* Another process changing the setting: no call through gnc-prefs. */
+static void
+external_change (gint which)
+{
+    gchar *key = g_strdup (pref_names[which]);
+
+    for (guint i = 0; i < n_callbacks; i++)
+        if (!callbacks[i].pref_name ||
+            callbacks[i].pref_name == pref_names[which])
+            callbacks[i].func (NULL, key, callbacks[i].user_data);
+    g_free (key);
+}
+
+static PrefsBackend fake_backend;
+
+static void
+setup (gconstpointer data)
+{
+    fake_backend.register_cb = fake_register_cb;
+    fake_backend.register_group_cb = fake_register_group_cb;
+    fake_backend.remove_cb_by_id = fake_remove_cb_by_id;
+    fake_backend.get_bool = fake_get_bool;
+    fake_backend.get_int = fake_get_int;
+    fake_backend.set_bool = fake_set_bool;
+    prefsbackend = &fake_backend;
+    bool_value = FALSE;
+    int_value = 3;
+    reads = 0;
+    next_id = 0;
+    n_callbacks = 0;
+    give_ids = GPOINTER_TO_INT (data);
+    gnc_prefs_cache_reset ();
+}
+
+static void
+teardown (void)
+{
+    gnc_prefs_cache_reset ();
+    prefsbackend = NULL;
+}
+
+static void
+test_cached (void)
+{
+    setup (GINT_TO_POINTER (TRUE));
+    g_assert_false (gnc_prefs_get_bool ("group", "flag"));
+    g_assert_cmpint (gnc_prefs_get_int ("group", "count"), ==, 3);
+    g_assert_cmpuint (reads, ==, 2);
+
+    g_assert_false (gnc_prefs_get_bool ("group", "flag"));
+    g_assert_cmpint (gnc_prefs_get_int ("group", "count"), ==, 3);
+    g_assert_cmpuint (reads, ==, 2);
+    /* Another name in the group is a value of its own. */
+    gnc_prefs_get_bool ("other-group", "flag");
+    g_assert_cmpuint (reads, ==, 3);
+    teardown ();
+}
+
+static void
+test_changed (void)
+{
+    setup (GINT_TO_POINTER (TRUE));
+    gnc_prefs_get_bool ("group", "flag");
+    gnc_prefs_get_int ("group", "count");
+
+    int_value = 7;
+    g_assert_cmpint (gnc_prefs_get_int ("group", "count"), ==, 3);
+    external_change (1);
+    g_assert_cmpint (gnc_prefs_get_int ("group", "count"), ==, 7);
+    g_assert_cmpuint (reads, ==, 3);
+
+    gnc_prefs_set_bool ("group", "flag", TRUE);
+    g_assert_true (gnc_prefs_get_bool ("group", "flag"));
+    g_assert_cmpuint (reads, ==, 4);
+
+    int_value = 9;
+    gnc_prefs_reset_group ("group");
+    g_assert_cmpint (gnc_prefs_get_int ("group", "count"), ==, 9);
+    g_assert_cmpuint (reads, ==, 5);
+    teardown ();
+}
+
+static void
+test_no_notification (void)
+{
+    setup (GINT_TO_POINTER (FALSE));
+    gnc_prefs_get_bool ("group", "flag");
+    bool_value = TRUE;
+    g_assert_true (gnc_prefs_get_bool ("group", "flag"));
+    g_assert_cmpuint (reads, ==, 2);
+    teardown ();
+}
+
+/* Callbacks registered before the value is first read get the new one
+ * when they're told of the change. */
+static gint seen_count;
+static gboolean seen_flag;
+
+static void
+read_count (gpointer settings, gchar *key, gpointer user_data)
+{
+    seen_count = gnc_prefs_get_int ("group", "count");
+}
+
+static void
+read_flag (gpointer settings, gchar *key, gpointer user_data)
+{
+    seen_flag = gnc_prefs_get_bool ("group", "flag");
+}
+
+static void
+test_callback_registered_first (void)
+{
+    setup (GINT_TO_POINTER (TRUE));
+    gnc_prefs_register_cb ("group", "count", read_count, NULL);
+    g_assert_cmpint (gnc_prefs_get_int ("group", "count"), ==, 3);
+
+    int_value = 7;
+    external_change (1);
+    g_assert_cmpint (seen_count, ==, 7);
+    teardown ();
+}
+
+static void
+test_group_callback_registered_first (void)
+{
+    setup (GINT_TO_POINTER (TRUE));
+    gnc_prefs_register_group_cb ("group", read_flag, NULL);
+    g_assert_false (gnc_prefs_get_bool ("group", "flag"));
+
+    bool_value = TRUE;
+    external_change (0);
+    g_assert_true (seen_flag);
+    teardown ();
+}
+
+int
+main (int argc, char *argv[])
+{
+    g_test_init (&argc, &argv, NULL);
+    g_test_add_func ("/core-utils/gnc-prefs/cache/cached", test_cached);
+    g_test_add_func ("/core-utils/gnc-prefs/cache/changed", test_changed);
+    g_test_add_func ("/core-utils/gnc-prefs/cache/no notification",
+                     test_no_notification);
+    g_test_add_func ("/core-utils/gnc-prefs/cache/callback registered first",
+                     test_callback_registered_first);
+    g_test_add_func ("/core-utils/gnc-prefs/cache/group callback registered first",
+                     test_group_callback_registered_first);
+    return g_test_run ();
+}
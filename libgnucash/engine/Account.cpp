@@ -35,7 +35,7 @@ extern "C" {
 #include <stdint.h>
 #include <string.h>
 
-#include "AccountP.h"
+#include "AccountP.hpp"
 #include "Split.h"
 #include "Transaction.h"
 #include "TransactionP.h"
@@ -44,17 +44,22 @@ extern "C" {
 #include "gnc-lot.h"
 #include "gnc-pricedb.h"
 #include "qofinstance-p.h"
+#include "qof-backend.hpp"
 #include "gnc-features.h"
 #include "guid.hpp"
 
 #include <numeric>
 #include <map>
+#include <unordered_map>
+#include <algorithm>
 
 static QofLogModule log_module = GNC_MOD_ACCOUNT;
 
 /* The Canonical Account Separator.  Pre-Initialized. */
 static gchar account_separator[8] = ".";
 static gunichar account_uc_separator = ':';
+/* Changed with the separator, to invalidate the cached full names. */
+static guint account_separator_generation = 0;
 
 static bool imap_convert_bayes_to_flat_run = false;
 
@@ -71,7 +76,12 @@ static const std::string AB_ACCOUNT_UID("account-uid");
 static const std::string AB_BANK_CODE("bank-code");
 static const std::string AB_TRANS_RETRIEVAL("trans-retrieval");
 
+/* The same paths for the hot getters, which needn't build a Path per call. */
+static const QofKvpPath online_id_path {1, {"online_id"}};
+static const QofKvpPath assoc_income_account_path {1, {"ofx/associated-income-account"}};
+
 static gnc_numeric GetBalanceAsOfDate (Account *acc, time64 date, gboolean ignclosing);
+static void imap_bayes_index_free (Account *acc);
 
 using FinalProbabilityVec=std::vector<std::pair<std::string, int32_t>>;
 using ProbabilityVec=std::vector<std::pair<std::string, struct AccountProbability>>;
@@ -217,12 +227,14 @@ gnc_set_account_separator (const gchar *separator)
     {
         account_uc_separator = ':';
         strcpy(account_separator, ":");
+        account_separator_generation++;
         return;
     }
 
     account_uc_separator = uc;
     count = g_unichar_to_utf8(uc, account_separator);
     account_separator[count] = '\0';
+    account_separator_generation++;
 }
 
 gchar *gnc_account_name_violations_errmsg (const gchar *separator, GList* invalid_account_names)
@@ -302,6 +314,259 @@ mark_account (Account *acc)
     qof_instance_set_dirty(&acc->inst);
 }
 
+static bool
+split_order_less (const Split *a, const Split *b)
+{
+    return xaccSplitOrder (a, b) < 0;
+}
+
+/* The fields xaccSplitOrder compares first, read once per split when
+ * sorting a whole account instead of through xaccTransOrder for every
+ * comparison. */
+struct SplitSortKey
+{
+    Split *split;
+    size_t index;               /* into the description keys */
+    time64 date_posted;
+    time64 date_entered;
+    int trans_num;
+    int action_num;
+    gboolean is_closing;
+    gboolean use_action;        /* num comes from the split's action */
+};
+
+/* Sort splits as xaccSplitOrder would.  Splits tied on date, num and
+ * entered date are compared by the collation keys of their
+ * transactions' descriptions, made only for those, and any still tied
+ * by xaccSplitOrder itself. */
+static void
+account_sort_splits (SplitsVec& splits, QofBook *book)
+{
+    gboolean action_for_num = book &&
+        qof_book_use_split_action_for_num_field (book);
+    std::vector<SplitSortKey> keys;
+    std::vector<gchar*> desc_keys (splits.size (), nullptr);
+
+    keys.reserve (splits.size ());
+    for (auto split : splits)
+    {
+        auto trans = split->parent;
+        if (!trans)
+        {
+            /* Only xaccSplitOrder knows where these go. */
+            std::sort (splits.begin(), splits.end(), split_order_less);
+            return;
+        }
+        keys.push_back ({split, keys.size (), trans->date_posted,
+                         trans->date_entered, atoi (trans->num),
+                         split->action ? atoi (split->action) : 0,
+                         xaccTransGetIsClosingTxn (trans),
+                         action_for_num && split->action});
+    }
+
+    auto desc_key = [&desc_keys](const SplitSortKey& k)
+    {
+        auto& key = desc_keys[k.index];
+        if (!key)
+        {
+            auto desc = k.split->parent->description;
+            key = g_utf8_collate_key (desc ? desc : "", -1);
+        }
+        return key;
+    };
+    std::sort (keys.begin(), keys.end(),
+               [&desc_key](const SplitSortKey& a, const SplitSortKey& b)
+               {
+                   if (a.date_posted != b.date_posted)
+                       return a.date_posted < b.date_posted;
+                   if (a.is_closing != b.is_closing)
+                       return a.is_closing < b.is_closing;
+                   auto use_action = a.use_action && b.use_action;
+                   auto na = use_action ? a.action_num : a.trans_num;
+                   auto nb = use_action ? b.action_num : b.trans_num;
+                   if (na != nb)
+                       return na < nb;
+                   if (a.date_entered != b.date_entered)
+                       return a.date_entered < b.date_entered;
+                   if (a.split->parent != b.split->parent)
+                   {
+                       auto result = strcmp (desc_key (a), desc_key (b));
+                       if (result)
+                           return result < 0;
+                   }
+                   return xaccSplitOrder (a.split, b.split) < 0;
+               });
+
+    std::transform (keys.begin(), keys.end(), splits.begin(),
+                    [](const SplitSortKey& k) { return k.split; });
+    std::for_each (desc_keys.begin(), desc_keys.end(), g_free);
+}
+
+/* Put the account's split list in the order of its, already sorted,
+ * splits.  It holds the same splits, so only the node's data need to
+ * be set. */
+static void
+account_order_split_list (AccountPrivate *priv)
+{
+    GList *node = priv->split_list;
+
+    if (g_list_length (priv->split_list) != priv->splits.size ())
+    {
+        priv->split_list = g_list_sort (priv->split_list,
+                                        (GCompareFunc)xaccSplitOrder);
+        return;
+    }
+    for (auto split : priv->splits)
+    {
+        node->data = split;
+        node = node->next;
+    }
+}
+
+/* In concurrent read mode several readers may fill the caches below
+ * (running balances, split lists, subtree balances, full names) at the
+ * same time; they take turns. The writer never competes with them. */
+class AccountCacheLock
+{
+public:
+    AccountCacheLock () { qof_engine_cache_lock (); }
+    ~AccountCacheLock () { qof_engine_cache_unlock (); }
+    AccountCacheLock (const AccountCacheLock&) = delete;
+    AccountCacheLock& operator= (const AccountCacheLock&) = delete;
+};
+
+/* Forget the cached subtree balances of the account and its ancestors. */
+static void
+account_clear_subtree_balances (AccountPrivate *priv)
+{
+    while (priv)
+    {
+        priv->subtree_balances.clear ();
+        priv = priv->parent ? GET_PRIVATE (priv->parent) : NULL;
+    }
+}
+
+/* Mark the running balances of the splits from index pos onwards as
+ * needing to be recomputed. */
+static void
+account_set_balance_dirty_from (AccountPrivate *priv, size_t pos)
+{
+    priv->balance_dirty = TRUE;
+    priv->balance_dirty_from = std::min (priv->balance_dirty_from, pos);
+    account_clear_subtree_balances (priv);
+}
+
+/* Forget the cached full names of the account and its descendants. */
+static void
+account_clear_full_names (Account *acc)
+{
+    AccountPrivate *priv = GET_PRIVATE(acc);
+
+    g_free (priv->full_name);
+    priv->full_name = NULL;
+    for (GList *node = priv->children; node; node = node->next)
+        account_clear_full_names (static_cast<Account*>(node->data));
+}
+
+/* Forget the order of the account's children. */
+static void
+account_clear_sorted_children (AccountPrivate *priv)
+{
+    g_list_free (priv->sorted_children);
+    priv->sorted_children = NULL;
+}
+
+/* The account's name, code or type changed, and with it maybe its place
+ * among its siblings. */
+static void
+account_order_changed (Account *acc)
+{
+    AccountPrivate *priv = GET_PRIVATE(acc);
+
+    if (priv->parent)
+        account_clear_sorted_children (GET_PRIVATE(priv->parent));
+}
+
+/* Book-wide index of the accounts by name and by code.  The lookup
+ * functions use it to find their candidates without walking the tree.
+ * Accounts with an empty name or code aren't indexed under it. */
+struct AccountLookupIndex
+{
+    std::unordered_multimap<std::string, Account*> by_name;
+    std::unordered_multimap<std::string, Account*> by_code;
+};
+
+#define ACCOUNT_LOOKUP_INDEX "gnc-account-lookup-index"
+
+static void
+account_lookup_index_free (QofBook *book, gpointer key, gpointer data)
+{
+    delete static_cast<AccountLookupIndex*>(data);
+}
+
+/* Return the index of the book, creating it if needed, or NULL if the
+ * book is being destroyed. */
+static AccountLookupIndex*
+account_lookup_index (QofBook *book)
+{
+    if (!book || qof_book_shutting_down (book))
+        return nullptr;
+
+    auto index = static_cast<AccountLookupIndex*>(qof_book_get_data (book, ACCOUNT_LOOKUP_INDEX));
+    if (!index)
+    {
+        index = new AccountLookupIndex;
+        qof_book_set_data_fin (book, ACCOUNT_LOOKUP_INDEX, index,
+                               account_lookup_index_free);
+    }
+    return index;
+}
+
+static void
+account_index_insert (std::unordered_multimap<std::string, Account*>& map,
+                      const char *key, Account *acc)
+{
+    if (key && *key)
+        map.emplace (key, acc);
+}
+
+static void
+account_index_erase (std::unordered_multimap<std::string, Account*>& map,
+                     const char *key, Account *acc)
+{
+    if (!key || !*key)
+        return;
+    auto range = map.equal_range (key);
+    for (auto it = range.first; it != range.second; ++it)
+        if (it->second == acc)
+        {
+            map.erase (it);
+            return;
+        }
+}
+
+static void
+account_index_add (Account *acc)
+{
+    auto index = account_lookup_index (gnc_account_get_book (acc));
+    if (!index)
+        return;
+    AccountPrivate *priv = GET_PRIVATE(acc);
+    account_index_insert (index->by_name, priv->accountName, acc);
+    account_index_insert (index->by_code, priv->accountCode, acc);
+}
+
+static void
+account_index_remove (Account *acc)
+{
+    auto index = account_lookup_index (gnc_account_get_book (acc));
+    if (!index)
+        return;
+    AccountPrivate *priv = GET_PRIVATE(acc);
+    account_index_erase (index->by_name, priv->accountName, acc);
+    account_index_erase (index->by_code, priv->accountCode, acc);
+}
+
 /********************************************************************\
 \********************************************************************/
 
@@ -327,6 +592,9 @@ gnc_account_init(Account* acc)
 
     priv->policy = xaccGetFIFOPolicy();
     priv->lots = NULL;
+    new (&priv->open_lots) decltype (priv->open_lots) ();
+    new (&priv->lot_seqs) decltype (priv->lot_seqs) ();
+    priv->next_lot_seq = 0;
 
     priv->commodity = NULL;
     priv->commodity_scu = 0;
@@ -341,9 +609,20 @@ gnc_account_init(Account* acc)
     priv->starting_cleared_balance = gnc_numeric_zero();
     priv->starting_reconciled_balance = gnc_numeric_zero();
     priv->balance_dirty = FALSE;
-
-    priv->splits = NULL;
+    priv->balance_dirty_from = 0;
+
+    new (&priv->subtree_balances) std::vector<SubtreeBalance> ();
+    new (&priv->splits) SplitsVec ();
+    priv->splits_hash = g_hash_table_new (g_direct_hash, g_direct_equal);
+    priv->split_list = NULL;
+    priv->split_list_sort_dirty = FALSE;
+    priv->splits_pending = FALSE;
     priv->sort_dirty = FALSE;
+    priv->full_name = NULL;
+    priv->full_name_generation = 0;
+    priv->name_collate_key = NULL;
+    priv->sorted_children = NULL;
+    priv->imap_bayes_index = NULL;
 }
 
 static void
@@ -355,6 +634,19 @@ gnc_account_dispose (GObject *acctp)
 static void
 gnc_account_finalize(GObject* acctp)
 {
+    AccountPrivate *priv = GET_PRIVATE(acctp);
+
+    priv->splits.~SplitsVec();
+    priv->subtree_balances.~vector();
+    priv->open_lots.~map();
+    priv->lot_seqs.~unordered_map();
+    g_free (priv->full_name);
+    g_free (priv->name_collate_key);
+    g_list_free (priv->sorted_children);
+    imap_bayes_index_free (GNC_ACCOUNT (acctp));
+    g_hash_table_destroy (priv->splits_hash);
+    g_list_free (priv->split_list);
+
     G_OBJECT_CLASS(gnc_account_parent_class)->finalize(acctp);
 }
 
@@ -489,10 +781,10 @@ gnc_account_get_property (GObject         *object,
         qof_instance_get_path_kvp (QOF_INSTANCE (account), value, {KEY_LOT_MGMT, "next-id"});
         break;
     case PROP_ONLINE_ACCOUNT:
-        qof_instance_get_path_kvp (QOF_INSTANCE (account), value, {KEY_ONLINE_ID});
+        qof_instance_get_kvp_at (QOF_INSTANCE (account), value, &online_id_path);
         break;
     case PROP_OFX_INCOME_ACCOUNT:
-        qof_instance_get_path_kvp (QOF_INSTANCE (account), value, {KEY_ASSOC_INCOME_ACCOUNT});
+        qof_instance_get_kvp_at (QOF_INSTANCE (account), value, &assoc_income_account_path);
         break;
     case PROP_AB_ACCOUNT_ID:
         qof_instance_get_path_kvp (QOF_INSTANCE (account), value, {AB_KEY, AB_ACCOUNT_ID});
@@ -641,16 +933,48 @@ gnc_account_set_property (GObject         *object,
     }
 }
 
+static void
+gnc_account_add_memory_usage (const QofInstance *inst, QofMemoryUsage *usage)
+{
+    auto priv = GET_PRIVATE (inst);
+
+    usage->instance_bytes += sizeof (AccountPrivate);
+    qof_memory_usage_add_list (usage, priv->children);
+    qof_memory_usage_add_list (usage, priv->split_list);
+    qof_memory_usage_add_list (usage, priv->lots);
+    usage->other_bytes += priv->splits.capacity () * sizeof (Split*) +
+        priv->subtree_balances.capacity () * sizeof (SubtreeBalance);
+    if (priv->splits_hash)
+        usage->other_bytes += g_hash_table_size (priv->splits_hash) *
+            (2 * sizeof (gpointer) + sizeof (guint));
+    /* Map nodes hold their value, and three links and a colour, or a
+     * link and a cached hash. */
+    usage->other_bytes +=
+        priv->open_lots.size () * (sizeof (decltype (priv->open_lots)::value_type) +
+                                   4 * sizeof (void*)) +
+        priv->lot_seqs.bucket_count () * sizeof (void*) +
+        priv->lot_seqs.size () * (sizeof (decltype (priv->lot_seqs)::value_type) +
+                                  sizeof (void*) + sizeof (size_t));
+    if (priv->full_name)
+        usage->other_bytes += strlen (priv->full_name) + 1;
+    if (priv->name_collate_key)
+        usage->other_bytes += strlen (priv->name_collate_key) + 1;
+    qof_memory_usage_add_list (usage, priv->sorted_children);
+}
+
 static void
 gnc_account_class_init (AccountClass *klass)
 {
     GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+    QofInstanceClass *qof_class = QOF_INSTANCE_CLASS (klass);
 
     gobject_class->dispose = gnc_account_dispose;
     gobject_class->finalize = gnc_account_finalize;
     gobject_class->set_property = gnc_account_set_property;
     gobject_class->get_property = gnc_account_get_property;
 
+    qof_class->add_memory_usage = gnc_account_add_memory_usage;
+
     g_object_class_install_property
     (gobject_class,
      PROP_NAME,
@@ -1268,6 +1592,7 @@ xaccCloneAccount(const Account *from, QofBook *book)
     priv->accountName = static_cast<char*>(qof_string_cache_insert(from_priv->accountName));
     priv->accountCode = static_cast<char*>(qof_string_cache_insert(from_priv->accountCode));
     priv->description = static_cast<char*>(qof_string_cache_insert(from_priv->description));
+    account_index_add (ret);
 
     qof_instance_copy_kvp (QOF_INSTANCE (ret), QOF_INSTANCE (from));
 
@@ -1313,6 +1638,7 @@ xaccFreeAccountChildren (Account *acc)
     if (priv->children)
         g_list_free(priv->children);
     priv->children = NULL;
+    account_clear_sorted_children (priv);
 }
 
 /* The xaccFreeAccount() routine releases memory associated with the
@@ -1352,33 +1678,33 @@ xaccFreeAccount (Account *acc)
         }
         g_list_free (priv->lots);
         priv->lots = NULL;
+        priv->open_lots.clear ();
+        priv->lot_seqs.clear ();
     }
 
     /* Next, clean up the splits */
     /* NB there shouldn't be any splits by now ... they should
      * have been all been freed by CommitEdit().  We can remove this
      * check once we know the warning isn't occurring any more. */
-    if (priv->splits)
+    if (!priv->splits.empty())
     {
-        GList *slist;
         PERR (" instead of calling xaccFreeAccount(), please call \n"
               " xaccAccountBeginEdit(); xaccAccountDestroy(); \n");
 
         qof_instance_reset_editlevel(acc);
 
-        slist = g_list_copy(priv->splits);
-        for (lp = slist; lp; lp = lp->next)
+        auto slist = priv->splits;
+        for (auto s : slist)
         {
-            Split *s = (Split *) lp->data;
             g_assert(xaccSplitGetAccount(s) == acc);
             xaccSplitDestroy (s);
         }
-        g_list_free(slist);
-/* Nothing here (or in xaccAccountCommitEdit) NULLs priv->splits, so this asserts every time.
-        g_assert(priv->splits == NULL);
+/* Nothing here (or in xaccAccountCommitEdit) clears priv->splits, so this asserts every time.
+        g_assert(priv->splits.empty());
 */
     }
 
+    account_index_remove (acc);
     qof_string_cache_remove(priv->accountName);
     qof_string_cache_remove(priv->accountCode);
     qof_string_cache_remove(priv->description);
@@ -1389,6 +1715,9 @@ xaccFreeAccount (Account *acc)
 
     priv->parent = nullptr;
     priv->children = nullptr;
+    account_clear_sorted_children (priv);
+    g_free (priv->name_collate_key);
+    priv->name_collate_key = nullptr;
 
     priv->balance  = gnc_numeric_zero();
     priv->noclosing_balance = gnc_numeric_zero();
@@ -1465,7 +1794,7 @@ xaccAccountCommitEdit (Account *acc)
     priv = GET_PRIVATE(acc);
     if (qof_instance_get_destroying(acc))
     {
-        GList *lp, *slist;
+        GList *lp;
         QofCollection *col;
 
         qof_instance_increase_editlevel(acc);
@@ -1482,18 +1811,16 @@ xaccAccountCommitEdit (Account *acc)
            themselves will be destroyed by the transaction code */
         if (!qof_book_shutting_down(book))
         {
-            slist = g_list_copy(priv->splits);
-            for (lp = slist; lp; lp = lp->next)
-            {
-                Split *s = static_cast<Split *>(lp->data);
+            auto slist = priv->splits;
+            for (auto s : slist)
                 xaccSplitDestroy (s);
-            }
-            g_list_free(slist);
         }
         else
         {
-            g_list_free(priv->splits);
-            priv->splits = NULL;
+            priv->splits.clear();
+            g_hash_table_remove_all (priv->splits_hash);
+            g_list_free (priv->split_list);
+            priv->split_list = NULL;
         }
 
         /* It turns out there's a case where this assertion does not hold:
@@ -1501,7 +1828,7 @@ xaccAccountCommitEdit (Account *acc)
            deleting all the splits in it.  The splits will just get
            recreated and put right back into the same account!
 
-           g_assert(priv->splits == NULL || qof_book_shutting_down(acc->inst.book));
+           g_assert(priv->splits.empty() || qof_book_shutting_down(acc->inst.book));
         */
 
         if (!qof_book_shutting_down(book))
@@ -1518,6 +1845,8 @@ xaccAccountCommitEdit (Account *acc)
         }
         g_list_free(priv->lots);
         priv->lots = NULL;
+        priv->open_lots.clear ();
+        priv->lot_seqs.clear ();
 
         qof_instance_set_dirty(&acc->inst);
         qof_instance_decrease_editlevel(acc);
@@ -1804,36 +2133,27 @@ xaccAccountEqual(const Account *aa, const Account *ab, gboolean check_guids)
     /* no parent; always compare downwards. */
 
     {
-        GList *la = priv_aa->splits;
-        GList *lb = priv_ab->splits;
+        const auto& la = priv_aa->splits;
+        const auto& lb = priv_ab->splits;
 
-        if ((la && !lb) || (!la && lb))
+        if (la.empty() != lb.empty())
         {
             PWARN ("only one has splits");
             return FALSE;
         }
 
-        if (la && lb)
+        if (la.size() != lb.size())
         {
-            /* presume that the splits are in the same order */
-            while (la && lb)
-            {
-                Split *sa = (Split *) la->data;
-                Split *sb = (Split *) lb->data;
-
-                if (!xaccSplitEqual(sa, sb, check_guids, TRUE, FALSE))
-                {
-                    PWARN ("splits differ");
-                    return(FALSE);
-                }
-
-                la = la->next;
-                lb = lb->next;
-            }
+            PWARN ("number of splits differs");
+            return(FALSE);
+        }
 
-            if ((la != NULL) || (lb != NULL))
+        /* presume that the splits are in the same order */
+        for (auto sa = la.begin(), sb = lb.begin(); sa != la.end(); ++sa, ++sb)
+        {
+            if (!xaccSplitEqual(*sa, *sb, check_guids, TRUE, FALSE))
             {
-                PWARN ("number of splits differs");
+                PWARN ("splits differ");
                 return(FALSE);
             }
         }
@@ -1875,7 +2195,52 @@ gnc_account_set_balance_dirty (Account *acc)
         return;
 
     priv = GET_PRIVATE(acc);
-    priv->balance_dirty = TRUE;
+    account_set_balance_dirty_from (priv, 0);
+}
+
+void
+gnc_account_split_changed (Account *acc, Split *split)
+{
+    AccountPrivate *priv;
+
+    g_return_if_fail(GNC_IS_ACCOUNT(acc));
+    g_return_if_fail(GNC_IS_SPLIT(split));
+
+    if (qof_instance_get_destroying(acc))
+        return;
+
+    priv = GET_PRIVATE(acc);
+    if (!g_hash_table_contains (priv->splits_hash, split))
+        return;
+
+    /* The order is going to be rebuilt anyway, so recompute everything
+     * after that. */
+    if (priv->sort_dirty || qof_instance_get_editlevel(acc) > 0)
+    {
+        priv->sort_dirty = TRUE;
+        account_set_balance_dirty_from (priv, 0);
+        return;
+    }
+
+    /* Edits are usually to recent splits, so look from the end. */
+    auto& splits = priv->splits;
+    auto rpos = std::find (splits.rbegin(), splits.rend(), split);
+    auto pos = std::next (rpos).base();
+    size_t index = pos - splits.begin();
+
+    /* Other splits of the same transaction may be out of place too, so
+     * the rest of the vector can't be searched for the new position.
+     * If every changed split is still in order with its neighbours the
+     * vector is still sorted. */
+    if ((pos != splits.begin() && split_order_less (split, *(pos - 1))) ||
+        (pos + 1 != splits.end() && split_order_less (*(pos + 1), split)))
+    {
+        priv->sort_dirty = TRUE;
+        priv->split_list_sort_dirty = priv->split_list != NULL;
+        index = 0;
+    }
+
+    account_set_balance_dirty_from (priv, index);
 }
 
 void gnc_account_set_defer_bal_computation (Account *acc, gboolean defer)
@@ -1908,25 +2273,31 @@ gboolean
 gnc_account_insert_split (Account *acc, Split *s)
 {
     AccountPrivate *priv;
-    GList *node;
 
     g_return_val_if_fail(GNC_IS_ACCOUNT(acc), FALSE);
     g_return_val_if_fail(GNC_IS_SPLIT(s), FALSE);
 
     priv = GET_PRIVATE(acc);
-    node = g_list_find(priv->splits, s);
-    if (node)
+    if (!g_hash_table_add (priv->splits_hash, s))
         return FALSE;
 
-    if (qof_instance_get_editlevel(acc) == 0)
+    if (qof_instance_get_editlevel(acc) == 0 && !priv->sort_dirty)
     {
-        priv->splits = g_list_insert_sorted(priv->splits, s,
-                                            (GCompareFunc)xaccSplitOrder);
+        auto pos = std::lower_bound (priv->splits.begin(), priv->splits.end(),
+                                     s, split_order_less);
+        account_set_balance_dirty_from (priv, pos - priv->splits.begin());
+        priv->splits.insert (pos, s);
+        if (priv->split_list)
+            priv->split_list = g_list_insert_sorted (priv->split_list, s,
+                                                     (GCompareFunc)xaccSplitOrder);
     }
     else
     {
-        priv->splits = g_list_prepend(priv->splits, s);
+        priv->splits.push_back (s);
+        if (priv->split_list)
+            priv->split_list = g_list_prepend (priv->split_list, s);
         priv->sort_dirty = TRUE;
+        account_set_balance_dirty_from (priv, 0);
     }
 
     //FIXME: find better event
@@ -1934,7 +2305,6 @@ gnc_account_insert_split (Account *acc, Split *s)
     /* Also send an event based on the account */
     qof_event_gen(&acc->inst, GNC_EVENT_ITEM_ADDED, s);
 
-    priv->balance_dirty = TRUE;
 //  DRH: Should the below be added? It is present in the delete path.
 //  xaccAccountRecomputeBalance(acc);
     return TRUE;
@@ -1944,23 +2314,26 @@ gboolean
 gnc_account_remove_split (Account *acc, Split *s)
 {
     AccountPrivate *priv;
-    GList *node;
 
     g_return_val_if_fail(GNC_IS_ACCOUNT(acc), FALSE);
     g_return_val_if_fail(GNC_IS_SPLIT(s), FALSE);
 
     priv = GET_PRIVATE(acc);
-    node = g_list_find(priv->splits, s);
-    if (NULL == node)
+    if (!g_hash_table_remove (priv->splits_hash, s))
         return FALSE;
 
-    priv->splits = g_list_delete_link(priv->splits, node);
+    /* Splits are most often removed from the end of the register. */
+    auto pos = std::next (std::find (priv->splits.rbegin(),
+                                     priv->splits.rend(), s)).base();
+    account_set_balance_dirty_from (priv, pos - priv->splits.begin());
+    priv->splits.erase (pos);
+    if (priv->split_list)
+        priv->split_list = g_list_remove (priv->split_list, s);
     //FIXME: find better event type
     qof_event_gen(&acc->inst, QOF_EVENT_MODIFY, NULL);
     // And send the account-based event, too
     qof_event_gen(&acc->inst, GNC_EVENT_ITEM_REMOVED, s);
 
-    priv->balance_dirty = TRUE;
     xaccAccountRecomputeBalance(acc);
     return TRUE;
 }
@@ -1972,12 +2345,18 @@ xaccAccountSortSplits (Account *acc, gboolean force)
 
     g_return_if_fail(GNC_IS_ACCOUNT(acc));
 
+    AccountCacheLock lock;
     priv = GET_PRIVATE(acc);
     if (!priv->sort_dirty || (!force && qof_instance_get_editlevel(acc) > 0))
         return;
-    priv->splits = g_list_sort(priv->splits, (GCompareFunc)xaccSplitOrder);
+    QOF_TIMER_START (sort, "account.sort-splits");
+    account_sort_splits (priv->splits, qof_instance_get_book (acc));
+    if (priv->split_list)
+        account_order_split_list (priv);
+    priv->split_list_sort_dirty = FALSE;
     priv->sort_dirty = FALSE;
-    priv->balance_dirty = TRUE;
+    account_set_balance_dirty_from (priv, 0);
+    QOF_TIMER_STOP (sort);
 }
 
 static void
@@ -2086,6 +2465,16 @@ gnc_account_set_policy (Account *acc, GNCPolicy *policy)
 /********************************************************************\
 \********************************************************************/
 
+static void
+account_forget_lot (AccountPrivate *priv, GNCLot *lot)
+{
+    auto seq = priv->lot_seqs.find (lot);
+    if (seq == priv->lot_seqs.end())
+        return;
+    priv->open_lots.erase (seq->second);
+    priv->lot_seqs.erase (seq);
+}
+
 void
 xaccAccountRemoveLot (Account *acc, GNCLot *lot)
 {
@@ -2099,6 +2488,7 @@ xaccAccountRemoveLot (Account *acc, GNCLot *lot)
 
     ENTER ("(acc=%p, lot=%p)", acc, lot);
     priv->lots = g_list_remove(priv->lots, lot);
+    account_forget_lot (priv, lot);
     qof_event_gen (QOF_INSTANCE(lot), QOF_EVENT_REMOVE, NULL);
     qof_event_gen (&acc->inst, QOF_EVENT_MODIFY, NULL);
     LEAVE ("(acc=%p, lot=%p)", acc, lot);
@@ -2128,10 +2518,13 @@ xaccAccountInsertLot (Account *acc, GNCLot *lot)
         old_acc = lot_account;
         opriv = GET_PRIVATE(old_acc);
         opriv->lots = g_list_remove(opriv->lots, lot);
+        account_forget_lot (opriv, lot);
     }
 
     priv = GET_PRIVATE(acc);
     priv->lots = g_list_prepend(priv->lots, lot);
+    priv->lot_seqs[lot] = ++priv->next_lot_seq;
+    priv->open_lots[priv->next_lot_seq] = lot;
     gnc_lot_set_account(lot, acc);
 
     /* Don't move the splits to the new account.  The caller will do this
@@ -2145,29 +2538,69 @@ xaccAccountInsertLot (Account *acc, GNCLot *lot)
     LEAVE ("(acc=%p, lot=%p)", acc, lot);
 }
 
-/********************************************************************\
-\********************************************************************/
-static void
-xaccPreSplitMove (Split *split, gpointer dummy)
+guint64
+gnc_account_get_lot_seq (const Account *acc, GNCLot *lot)
 {
-    xaccTransBeginEdit (xaccSplitGetParent (split));
+    g_return_val_if_fail(GNC_IS_ACCOUNT(acc), 0);
+
+    auto priv = GET_PRIVATE(acc);
+    auto seq = priv->lot_seqs.find (lot);
+    return seq != priv->lot_seqs.end() ? seq->second : 0;
 }
 
-static void
-xaccPostSplitMove (Split *split, Account *accto)
+void
+gnc_account_lot_maybe_open (Account *acc, GNCLot *lot)
 {
-    Transaction *trans;
+    AccountPrivate *priv;
+
+    g_return_if_fail(GNC_IS_ACCOUNT(acc));
 
-    xaccSplitSetAccount(split, accto);
-    xaccSplitSetAmount(split, split->amount);
-    trans = xaccSplitGetParent (split);
-    xaccTransCommitEdit (trans);
+    priv = GET_PRIVATE(acc);
+    auto seq = priv->lot_seqs.find (lot);
+    if (seq != priv->lot_seqs.end())
+        priv->open_lots[seq->second] = lot;
 }
 
+gpointer
+gnc_account_foreach_open_lot (Account *acc,
+                              gpointer (*proc)(GNCLot *lot, void *data),
+                              void *data)
+{
+    AccountPrivate *priv;
+    std::vector<GNCLot*> lots;
+    gpointer result = NULL;
+
+    g_return_val_if_fail(GNC_IS_ACCOUNT(acc), NULL);
+    g_return_val_if_fail(proc, NULL);
+
+    /* Drop the lots found to be closed since they were last visited;
+     * they come back through gnc_account_lot_maybe_open. */
+    priv = GET_PRIVATE(acc);
+    lots.reserve (priv->open_lots.size());
+    for (auto it = priv->open_lots.begin(); it != priv->open_lots.end();)
+    {
+        if (gnc_lot_is_closed (it->second))
+        {
+            it = priv->open_lots.erase (it);
+            continue;
+        }
+        lots.push_back (it->second);
+        ++it;
+    }
+
+    for (auto lot : lots)
+        if ((result = proc (lot, data)))
+            break;
+
+    return result;
+}
+
+/********************************************************************\
+\********************************************************************/
 void
 xaccAccountMoveAllSplits (Account *accfrom, Account *accto)
 {
-    AccountPrivate *from_priv;
+    AccountPrivate *from_priv, *to_priv;
 
     /* errors */
     g_return_if_fail(GNC_IS_ACCOUNT(accfrom));
@@ -2175,40 +2608,72 @@ xaccAccountMoveAllSplits (Account *accfrom, Account *accto)
 
     /* optimizations */
     from_priv = GET_PRIVATE(accfrom);
-    if (!from_priv->splits || accfrom == accto)
+    if (from_priv->splits.empty() || accfrom == accto)
         return;
 
     /* check for book mix-up */
     g_return_if_fail (qof_instance_books_equal(accfrom, accto));
     ENTER ("(accfrom=%p, accto=%p)", accfrom, accto);
+    to_priv = GET_PRIVATE(accto);
 
+    auto book = gnc_account_get_book (accfrom);
+    qof_book_begin_batch (book);
     xaccAccountBeginEdit(accfrom);
     xaccAccountBeginEdit(accto);
-    /* Begin editing both accounts and all transactions in accfrom. */
-    g_list_foreach(from_priv->splits, (GFunc)xaccPreSplitMove, NULL);
-
-    /* Concatenate accfrom's lists of splits and lots to accto's lists. */
-    //to_priv->splits = g_list_concat(to_priv->splits, from_priv->splits);
-    //to_priv->lots = g_list_concat(to_priv->lots, from_priv->lots);
 
-    /* Set appropriate flags. */
-    //from_priv->balance_dirty = TRUE;
-    //from_priv->sort_dirty = FALSE;
-    //to_priv->balance_dirty = TRUE;
-    //to_priv->sort_dirty = TRUE;
+    /* Move the whole container at once rather than removing and
+     * inserting one split at a time: both sides are put in order and
+     * merged, and the split commits below then find each split
+     * already in accto.
+     */
+    xaccAccountSortSplits (accfrom, TRUE);
+    xaccAccountSortSplits (accto, TRUE);
+    SplitsVec moved;
+    moved.swap (from_priv->splits);
+    g_hash_table_remove_all (from_priv->splits_hash);
+    g_list_free (from_priv->split_list);
+    from_priv->split_list = NULL;
+    account_set_balance_dirty_from (from_priv, 0);
+
+    SplitsVec merged;
+    merged.reserve (to_priv->splits.size() + moved.size());
+    std::merge (to_priv->splits.begin(), to_priv->splits.end(),
+                moved.begin(), moved.end(), std::back_inserter (merged),
+                split_order_less);
+    to_priv->splits.swap (merged);
+    auto merged_size = to_priv->splits.size();
+    g_list_free (to_priv->split_list);
+    to_priv->split_list = NULL;
+    account_set_balance_dirty_from (to_priv, 0);
 
     /*
      * Change each split's account back pointer to accto.
      * Convert each split's amount to accto's commodity.
      * Commit to editing each transaction.
      */
-    g_list_foreach(from_priv->splits, (GFunc)xaccPostSplitMove, (gpointer)accto);
+    for (auto s : moved)
+    {
+        auto trans = xaccSplitGetParent (s);
+        xaccTransBeginEdit (trans);
+        g_hash_table_add (to_priv->splits_hash, s);
+        s->acc = accto;
+        s->orig_acc = accto;
+        xaccSplitSetAmount (s, s->amount);
+        xaccTransCommitEdit (trans);
+    }
+
+    /* The transaction commits flag accto for re-sorting because it is
+     * being edited, but unless one of them added a split of its own the
+     * merge has already put it in order. */
+    if (to_priv->splits.size() == merged_size)
+        to_priv->sort_dirty = FALSE;
 
     /* Finally empty accfrom. */
-    g_assert(from_priv->splits == NULL);
+    g_assert(from_priv->splits.empty());
     g_assert(from_priv->lots == NULL);
     xaccAccountCommitEdit(accfrom);
     xaccAccountCommitEdit(accto);
+    qof_book_end_batch (book);
 
     LEAVE ("(accfrom=%p, accto=%p)", accfrom, accto);
 }
@@ -2250,26 +2715,43 @@ xaccAccountRecomputeBalance (Account * acc)
     gnc_numeric  noclosing_balance;
     gnc_numeric  cleared_balance;
     gnc_numeric  reconciled_balance;
-    GList *lp;
 
     if (NULL == acc) return;
 
+    AccountCacheLock lock;
     priv = GET_PRIVATE(acc);
     if (qof_instance_get_editlevel(acc) > 0) return;
     if (!priv->balance_dirty || priv->defer_bal_computation) return;
     if (qof_instance_get_destroying(acc)) return;
     if (qof_book_shutting_down(qof_instance_get_book(acc))) return;
 
-    balance            = priv->starting_balance;
-    noclosing_balance  = priv->starting_noclosing_balance;
-    cleared_balance    = priv->starting_cleared_balance;
-    reconciled_balance = priv->starting_reconciled_balance;
+    QOF_TIMER_START (recompute, "account.recompute-balance");
+    /* Resume the running sums from the last split that is still
+     * correct, if there is one. */
+    auto& splits = priv->splits;
+    size_t start = std::min (priv->balance_dirty_from, splits.size());
+    if (start == 0)
+    {
+        balance            = priv->starting_balance;
+        noclosing_balance  = priv->starting_noclosing_balance;
+        cleared_balance    = priv->starting_cleared_balance;
+        reconciled_balance = priv->starting_reconciled_balance;
+    }
+    else
+    {
+        Split *prev = splits[start - 1];
+        balance            = prev->balance;
+        noclosing_balance  = prev->noclosing_balance;
+        cleared_balance    = prev->cleared_balance;
+        reconciled_balance = prev->reconciled_balance;
+    }
 
-    PINFO ("acct=%s starting baln=%" G_GINT64_FORMAT "/%" G_GINT64_FORMAT,
-           priv->accountName, balance.num, balance.denom);
-    for (lp = priv->splits; lp; lp = lp->next)
+    PINFO ("acct=%s starting at split %zu baln=%" G_GINT64_FORMAT "/%"
+           G_GINT64_FORMAT, priv->accountName, start,
+           balance.num, balance.denom);
+    for (auto it = splits.begin() + start; it != splits.end(); ++it)
     {
-        Split *split = (Split *) lp->data;
+        Split *split = *it;
         gnc_numeric amt = xaccSplitGetAmount (split);
 
         balance = gnc_numeric_add_fixed(balance, amt);
@@ -2301,6 +2783,9 @@ xaccAccountRecomputeBalance (Account * acc)
     priv->cleared_balance = cleared_balance;
     priv->reconciled_balance = reconciled_balance;
     priv->balance_dirty = FALSE;
+    priv->balance_dirty_from = splits.size();
+    account_clear_subtree_balances (priv);
+    QOF_TIMER_STOP (recompute);
 }
 
 /********************************************************************\
@@ -2323,6 +2808,19 @@ static int revorder[NUM_ACCOUNT_TYPES] =
 };
 
 
+/* Comparing the collation keys of two names orders them as
+ * g_utf8_collate would without it having to normalize and transform
+ * both for every comparison. */
+static const gchar *
+account_name_collate_key (const Account *acc)
+{
+    AccountPrivate *priv = GET_PRIVATE(acc);
+
+    if (!priv->name_collate_key)
+        priv->name_collate_key = g_utf8_collate_key (priv->accountName, -1);
+    return priv->name_collate_key;
+}
+
 int
 xaccAccountOrder (const Account *aa, const Account *ab)
 {
@@ -2370,7 +2868,11 @@ xaccAccountOrder (const Account *aa, const Account *ab)
     /* otherwise, sort on accountName strings */
     da = priv_aa->accountName;
     db = priv_ab->accountName;
-    result = safe_utf8_collate(da, db);
+    if (da && *da && db && *db)
+        result = strcmp (account_name_collate_key (aa),
+                         account_name_collate_key (ab));
+    else
+        result = safe_utf8_collate(da, db);
     if (result)
         return result;
 
@@ -2403,7 +2905,9 @@ xaccAccountSetType (Account *acc, GNCAccountType tip)
 
     xaccAccountBeginEdit(acc);
     priv->type = tip;
-    priv->balance_dirty = TRUE; /* new type may affect balance computation */
+    account_order_changed (acc);
+    /* new type may affect balance computation */
+    account_set_balance_dirty_from (priv, 0);
     mark_account(acc);
     xaccAccountCommitEdit(acc);
 }
@@ -2423,7 +2927,13 @@ xaccAccountSetName (Account *acc, const char *str)
         return;
 
     xaccAccountBeginEdit(acc);
+    account_index_remove (acc);
     priv->accountName = qof_string_cache_replace(priv->accountName, str);
+    g_free (priv->name_collate_key);
+    priv->name_collate_key = NULL;
+    account_index_add (acc);
+    account_clear_full_names (acc);
+    account_order_changed (acc);
     mark_account (acc);
     xaccAccountCommitEdit(acc);
 }
@@ -2442,7 +2952,10 @@ xaccAccountSetCode (Account *acc, const char *str)
         return;
 
     xaccAccountBeginEdit(acc);
+    account_index_remove (acc);
     priv->accountCode = qof_string_cache_replace(priv->accountCode, str ? str : "");
+    account_index_add (acc);
+    account_order_changed (acc);
     mark_account (acc);
     xaccAccountCommitEdit(acc);
 }
@@ -2497,10 +3010,9 @@ set_kvp_string_tag (Account *acc, const char *tag, const char *value)
 static const char*
 get_kvp_string_tag (const Account *acc, const char *tag)
 {
-    GValue v = G_VALUE_INIT;
     if (acc == NULL || tag == NULL) return NULL;
-    qof_instance_get_path_kvp (QOF_INSTANCE (acc), &v, {tag});
-    return G_VALUE_HOLDS_STRING (&v) ? g_value_get_string (&v) : NULL;
+    QofKvpPath path {1, {tag}};
+    return qof_instance_get_kvp_string_at (QOF_INSTANCE (acc), &path);
 }
 
 void
@@ -2555,7 +3067,6 @@ void
 xaccAccountSetCommodity (Account * acc, gnc_commodity * com)
 {
     AccountPrivate *priv;
-    GList *lp;
 
     /* errors */
     g_return_if_fail(GNC_IS_ACCOUNT(acc));
@@ -2573,10 +3084,10 @@ xaccAccountSetCommodity (Account * acc, gnc_commodity * com)
     priv->commodity_scu = gnc_commodity_get_fraction(com);
     priv->non_standard_scu = FALSE;
 
-    /* iterate over splits */
-    for (lp = priv->splits; lp; lp = lp->next)
+    /* iterate over a copy of the splits, committing may touch the account */
+    auto splits = priv->splits;
+    for (auto s : splits)
     {
-        Split *s = (Split *) lp->data;
         Transaction *trans = xaccSplitGetParent (s);
 
         xaccTransBeginEdit (trans);
@@ -2585,7 +3096,7 @@ xaccAccountSetCommodity (Account * acc, gnc_commodity * com)
     }
 
     priv->sort_dirty = TRUE;  /* Not needed. */
-    priv->balance_dirty = TRUE;
+    account_set_balance_dirty_from (priv, 0);
     mark_account (acc);
 
     xaccAccountCommitEdit(acc);
@@ -2730,14 +3241,19 @@ gnc_account_append_child (Account *new_parent, Account *child)
             PWARN ("reparenting accounts across books is not correctly supported\n");
 
             qof_event_gen (&child->inst, QOF_EVENT_DESTROY, NULL);
+            account_index_remove (child);
             col = qof_book_get_collection (qof_instance_get_book(new_parent),
                                            GNC_ID_ACCOUNT);
             qof_collection_insert_entity (col, &child->inst);
+            account_index_add (child);
             qof_event_gen (&child->inst, QOF_EVENT_CREATE, NULL);
         }
     }
     cpriv->parent = new_parent;
     ppriv->children = g_list_append(ppriv->children, child);
+    account_clear_sorted_children (ppriv);
+    account_clear_subtree_balances (ppriv);
+    account_clear_full_names (child);
     qof_instance_set_dirty(&new_parent->inst);
     qof_instance_set_dirty(&child->inst);
 
@@ -2778,12 +3294,15 @@ gnc_account_remove_child (Account *parent, Account *child)
     ed.idx = g_list_index(ppriv->children, child);
 
     ppriv->children = g_list_remove(ppriv->children, child);
+    account_clear_sorted_children (ppriv);
+    account_clear_subtree_balances (ppriv);
 
     /* Now send the event. */
     qof_event_gen(&child->inst, QOF_EVENT_REMOVE, &ed);
 
     /* clear the account's parent pointer after REMOVE event generation. */
     cpriv->parent = NULL;
+    account_clear_full_names (child);
 
     qof_event_gen (&parent->inst, QOF_EVENT_MODIFY, NULL);
 }
@@ -2826,19 +3345,25 @@ gnc_account_get_children (const Account *account)
     return g_list_copy(GET_PRIVATE(account)->children);
 }
 
+/* The account's children in xaccAccountOrder, owned by the account. */
+static GList *
+account_sorted_children (const Account *account)
+{
+    AccountPrivate *priv = GET_PRIVATE(account);
+
+    if (!priv->sorted_children && priv->children)
+        priv->sorted_children = g_list_sort (g_list_copy (priv->children),
+                                             (GCompareFunc)xaccAccountOrder);
+    return priv->sorted_children;
+}
+
 GList *
 gnc_account_get_children_sorted (const Account *account)
 {
-    AccountPrivate *priv;
-
     /* errors */
     g_return_val_if_fail(GNC_IS_ACCOUNT(account), NULL);
 
-    /* optimizations */
-    priv = GET_PRIVATE(account);
-    if (!priv->children)
-        return NULL;
-    return g_list_sort(g_list_copy(priv->children), (GCompareFunc)xaccAccountOrder);
+    return g_list_copy (account_sorted_children (account));
 }
 
 gint
@@ -2942,30 +3467,54 @@ gnc_account_get_descendants (const Account *account)
     return descendants;
 }
 
+/* Prepend the account's descendants in sorted order to list, which is
+ * being built in reverse. */
+static GList *
+account_prepend_descendants_sorted (const Account *account, GList *list)
+{
+    for (GList *child = account_sorted_children (account); child;
+         child = g_list_next(child))
+    {
+        list = g_list_prepend (list, child->data);
+        list = account_prepend_descendants_sorted (static_cast<Account const *>(child->data),
+                                                   list);
+    }
+    return list;
+}
+
 GList *
 gnc_account_get_descendants_sorted (const Account *account)
 {
-    AccountPrivate *priv;
-    GList *child, *children, *descendants;
-
     /* errors */
     g_return_val_if_fail(GNC_IS_ACCOUNT(account), NULL);
 
-    /* optimizations */
-    priv = GET_PRIVATE(account);
-    if (!priv->children)
-        return NULL;
+    return g_list_reverse (account_prepend_descendants_sorted (account, NULL));
+}
 
-    descendants = NULL;
-    children = g_list_sort(g_list_copy(priv->children), (GCompareFunc)xaccAccountOrder);
-    for (child = children; child; child = g_list_next(child))
+/* Look up the descendants of parent indexed under key.  Returns FALSE
+ * if the index can't tell, otherwise sets found to the only one, or to
+ * NULL if there is none.  If there are several, only the tree walk
+ * knows which of them the lookup functions have always returned. */
+static gboolean
+account_index_lookup (const Account *parent,
+                      std::unordered_multimap<std::string, Account*> AccountLookupIndex::*map,
+                      const char *key, Account **found)
+{
+    auto index = account_lookup_index (gnc_account_get_book (parent));
+    if (!index || !*key)
+        return FALSE;
+
+    *found = nullptr;
+    auto range = (index->*map).equal_range (key);
+    for (auto it = range.first; it != range.second; ++it)
     {
-        descendants = g_list_append(descendants, child->data);
-        descendants = g_list_concat(descendants,
-                gnc_account_get_descendants_sorted(static_cast<Account const *>(child->data)));
+        if (it->second == parent || !xaccAccountHasAncestor (it->second, parent))
+            continue;
+        if (*found)
+            return FALSE;
+        *found = it->second;
     }
-    g_list_free(children);
-    return descendants;
+    return TRUE;
 }
 
 Account *
@@ -2978,6 +3527,9 @@ gnc_account_lookup_by_name (const Account *parent, const char * name)
     g_return_val_if_fail(GNC_IS_ACCOUNT(parent), NULL);
     g_return_val_if_fail(name, NULL);
 
+    if (account_index_lookup (parent, &AccountLookupIndex::by_name, name, &result))
+        return result;
+
     /* first, look for accounts hanging off the current node */
     ppriv = GET_PRIVATE(parent);
     for (node = ppriv->children; node; node = node->next)
@@ -3011,6 +3563,9 @@ gnc_account_lookup_by_code (const Account *parent, const char * code)
     g_return_val_if_fail(GNC_IS_ACCOUNT(parent), NULL);
     g_return_val_if_fail(code, NULL);
 
+    if (account_index_lookup (parent, &AccountLookupIndex::by_code, code, &result))
+        return result;
+
     /* first, look for accounts hanging off the current node */
     ppriv = GET_PRIVATE(parent);
     for (node = ppriv->children; node; node = node->next)
@@ -3094,6 +3649,38 @@ gnc_account_lookup_by_full_name_helper (const Account *parent,
     return NULL;
 }
 
+/* The same as gnc_account_lookup_by_full_name_helper, but checking the
+ * path of the accounts the index has under the last name.  Returns
+ * FALSE if the index can't tell, see account_index_lookup. */
+static gboolean
+account_index_lookup_full_name (const Account *root, gchar **names,
+                                Account **found)
+{
+    auto index = account_lookup_index (gnc_account_get_book (root));
+    guint depth = g_strv_length (names);
+    if (!index || depth == 0 || !*names[depth - 1])
+        return FALSE;
+
+    *found = nullptr;
+    auto range = index->by_name.equal_range (names[depth - 1]);
+    for (auto it = range.first; it != range.second; ++it)
+    {
+        const Account *acc = it->second;
+        guint level = depth;
+        while (level > 0 && acc && acc != root &&
+               g_strcmp0 (GET_PRIVATE(acc)->accountName, names[level - 1]) == 0)
+        {
+            acc = GET_PRIVATE(acc)->parent;
+            --level;
+        }
+        if (level > 0 || acc != root)
+            continue;
+        if (*found)
+            return FALSE;
+        *found = it->second;
+    }
+    return TRUE;
+}
 
 Account *
 gnc_account_lookup_by_full_name (const Account *any_acc,
@@ -3115,7 +3702,8 @@ gnc_account_lookup_by_full_name (const Account *any_acc,
         rpriv = GET_PRIVATE(root);
     }
     names = g_strsplit(name, gnc_get_account_separator_string(), -1);
-    found = gnc_account_lookup_by_full_name_helper(root, names);
+    if (!account_index_lookup_full_name (root, names, &found))
+        found = gnc_account_lookup_by_full_name_helper(root, names);
     g_strfreev(names);
     return found;
 }
@@ -3218,52 +3806,47 @@ xaccAccountGetName (const Account *acc)
     return GET_PRIVATE(acc)->accountName;
 }
 
-gchar *
-gnc_account_get_full_name(const Account *account)
+const gchar *
+gnc_account_get_full_name_const (const Account *account)
 {
     AccountPrivate *priv;
-    const Account *a;
-    char *fullname;
-    gchar **names;
-    int level;
 
     /* So much for hardening the API. Too many callers to this function don't
      * bother to check if they have a non-NULL pointer before calling. */
     if (NULL == account)
-        return g_strdup("");
+        return "";
 
     /* errors */
-    g_return_val_if_fail(GNC_IS_ACCOUNT(account), g_strdup(""));
+    g_return_val_if_fail(GNC_IS_ACCOUNT(account), "");
 
     /* optimizations */
     priv = GET_PRIVATE(account);
     if (!priv->parent)
-        return g_strdup("");
-
-    /* Figure out how much space is needed by counting the nodes up to
-     * the root. */
-    level = 0;
-    for (a = account; a; a = priv->parent)
-    {
-        priv = GET_PRIVATE(a);
-        level++;
-    }
-
-    /* Get all the pointers in the right order. The root node "entry"
-     * becomes the terminating NULL pointer for the array of strings. */
-    names = (gchar **)g_malloc(level * sizeof(gchar *));
-    names[--level] = NULL;
-    for (a = account; level > 0; a = priv->parent)
-    {
-        priv = GET_PRIVATE(a);
-        names[--level] = priv->accountName;
-    }
+        return "";
+
+    AccountCacheLock lock;
+    if (priv->full_name &&
+        priv->full_name_generation == account_separator_generation)
+        return priv->full_name;
+
+    /* Build the full name from the parent's, which is cached in turn.
+     * The root account doesn't take part in the name. */
+    g_free (priv->full_name);
+    if (!GET_PRIVATE(priv->parent)->parent)
+        priv->full_name = g_strdup (priv->accountName);
+    else
+        priv->full_name = g_strconcat (gnc_account_get_full_name_const (priv->parent),
+                                       account_separator, priv->accountName,
+                                       NULL);
+    priv->full_name_generation = account_separator_generation;
 
-    /* Build the full name */
-    fullname =  g_strjoinv(account_separator, names);
-    g_free(names);
+    return priv->full_name ? priv->full_name : "";
+}
 
-    return fullname;
+gchar *
+gnc_account_get_full_name(const Account *account)
+{
+    return g_strdup (gnc_account_get_full_name_const (account));
 }
 
 const char *
@@ -3386,7 +3969,7 @@ gnc_account_set_start_balance (Account *acc, const gnc_numeric start_baln)
 
     priv = GET_PRIVATE(acc);
     priv->starting_balance = start_baln;
-    priv->balance_dirty = TRUE;
+    account_set_balance_dirty_from (priv, 0);
 }
 
 void
@@ -3399,7 +3982,7 @@ gnc_account_set_start_cleared_balance (Account *acc,
 
     priv = GET_PRIVATE(acc);
     priv->starting_cleared_balance = start_baln;
-    priv->balance_dirty = TRUE;
+    account_set_balance_dirty_from (priv, 0);
 }
 
 void
@@ -3412,7 +3995,72 @@ gnc_account_set_start_reconciled_balance (Account *acc,
 
     priv = GET_PRIVATE(acc);
     priv->starting_reconciled_balance = start_baln;
-    priv->balance_dirty = TRUE;
+    account_set_balance_dirty_from (priv, 0);
+}
+
+void
+gnc_account_set_start_noclosing_balance (Account *acc,
+                                         const gnc_numeric start_baln)
+{
+    AccountPrivate *priv;
+
+    g_return_if_fail(GNC_IS_ACCOUNT(acc));
+
+    priv = GET_PRIVATE(acc);
+    priv->starting_noclosing_balance = start_baln;
+    account_set_balance_dirty_from (priv, 0);
+}
+
+void
+gnc_account_set_splits_pending (Account *acc, gboolean pending)
+{
+    g_return_if_fail(GNC_IS_ACCOUNT(acc));
+    GET_PRIVATE(acc)->splits_pending = pending;
+}
+
+gboolean
+gnc_account_get_splits_pending (const Account *acc)
+{
+    g_return_val_if_fail(GNC_IS_ACCOUNT(acc), FALSE);
+    return GET_PRIVATE(acc)->splits_pending;
+}
+
+void
+gnc_account_remove_start_balance_split (Account *acc, const Split *split)
+{
+    AccountPrivate *priv;
+
+    g_return_if_fail(GNC_IS_ACCOUNT(acc));
+    g_return_if_fail(split);
+
+    priv = GET_PRIVATE(acc);
+    auto amount = xaccSplitGetAmount (split);
+    auto reconciled = xaccSplitGetReconcile (split);
+    auto trans = xaccSplitGetParent (split);
+    auto sub = [amount](gnc_numeric& balance)
+    {
+        balance = gnc_numeric_sub (balance, amount, GNC_DENOM_AUTO,
+                                   GNC_HOW_DENOM_LCD);
+    };
+    sub (priv->starting_balance);
+    if (!trans || !xaccTransGetIsClosingTxn (trans))
+        sub (priv->starting_noclosing_balance);
+    if (reconciled != NREC)
+        sub (priv->starting_cleared_balance);
+    if (reconciled == YREC || reconciled == FREC)
+        sub (priv->starting_reconciled_balance);
+    account_set_balance_dirty_from (priv, 0);
+}
+
+/* Have the backend load the splits it left out of the initial load. */
+static void
+account_load_pending_splits (const Account *acc)
+{
+    if (!GET_PRIVATE(acc)->splits_pending)
+        return;
+    auto be = qof_book_get_backend (gnc_account_get_book (acc));
+    if (be)
+        be->load_on_demand (QOF_INSTANCE (acc));
 }
 
 gnc_numeric
@@ -3440,7 +4088,6 @@ gnc_numeric
 xaccAccountGetProjectedMinimumBalance (const Account *acc)
 {
     AccountPrivate *priv;
-    GList *node;
     time64 today;
     gnc_numeric lowest = gnc_numeric_zero ();
     int seen_a_transaction = 0;
@@ -3449,9 +4096,9 @@ xaccAccountGetProjectedMinimumBalance (const Account *acc)
 
     priv = GET_PRIVATE(acc);
     today = gnc_time64_get_today_end();
-    for (node = g_list_last(priv->splits); node; node = node->prev)
+    for (auto it = priv->splits.rbegin(); it != priv->splits.rend(); ++it)
     {
-        Split *split = static_cast<Split*>(node->data);
+        Split *split = *it;
 
         if (!seen_a_transaction)
         {
@@ -3474,32 +4121,39 @@ xaccAccountGetProjectedMinimumBalance (const Account *acc)
 /********************************************************************\
 \********************************************************************/
 
+/* Return the last split posted before date, or NULL if there is none.
+ * The splits must be sorted, which orders them by date posted first. */
+static Split*
+account_find_latest_split_before (Account *acc, time64 date)
+{
+    const auto& splits = GET_PRIVATE(acc)->splits;
+    auto pos = std::partition_point (splits.begin(), splits.end(),
+                                     [date](const Split *s)
+    {
+        return xaccTransGetDate (xaccSplitGetParent (s)) < date;
+    });
+    return pos == splits.begin() ? nullptr : *(pos - 1);
+}
+
 static gnc_numeric
 GetBalanceAsOfDate (Account *acc, time64 date, gboolean ignclosing)
 {
-    /* Ideally this could use xaccAccountForEachSplit, but
-     * it doesn't exist yet and I'm uncertain of exactly how
-     * it would work at this time, since it differs from
-     * xaccAccountForEachTransaction by using gpointer return
-     * values rather than gints.
-     */
-    Split *latest = nullptr;
+    Split *latest;
 
     g_return_val_if_fail(GNC_IS_ACCOUNT(acc), gnc_numeric_zero());
 
     xaccAccountSortSplits (acc, TRUE); /* just in case, normally a noop */
     xaccAccountRecomputeBalance (acc); /* just in case, normally a noop */
 
-    for (GList *lp = GET_PRIVATE(acc)->splits; lp; lp = lp->next)
+    latest = account_find_latest_split_before (acc, date);
+    if (!latest)
     {
-        if (xaccTransGetDate (xaccSplitGetParent ((Split *)lp->data)) >= date)
-            break;
-        latest = (Split *)lp->data;
+        /* Nonzero only if the backend left out the earlier splits. */
+        auto priv = GET_PRIVATE(acc);
+        return ignclosing ? priv->starting_noclosing_balance :
+            priv->starting_balance;
     }
 
-    if (!latest)
-        return gnc_numeric_zero();
-
     if (ignclosing)
         return xaccSplitGetNoclosingBalance (latest);
     else
@@ -3525,9 +4179,8 @@ xaccAccountGetReconciledBalanceAsOfDate (Account *acc, time64 date)
 
     g_return_val_if_fail(GNC_IS_ACCOUNT(acc), gnc_numeric_zero());
 
-    for (GList *node = GET_PRIVATE(acc)->splits; node; node = node->next)
+    for (auto split : GET_PRIVATE(acc)->splits)
     {
-        Split *split = (Split*) node->data;
         if ((xaccSplitGetReconcile (split) == YREC) &&
             (xaccSplitGetDateReconciled (split) <= date))
             balance = gnc_numeric_add_fixed (balance, xaccSplitGetAmount (split));
@@ -3648,6 +4301,82 @@ xaccAccountGetXxxBalanceAsOfDateInCurrency(Account *acc, time64 date,
                acc, fn(acc, date), priv->commodity, report_commodity);
 }
 
+/* The present and projected minimum balances depend on the current
+ * time, so only the balances below are worth remembering. */
+static gboolean
+subtree_balance_cacheable (xaccGetBalanceFn fn)
+{
+    return fn == xaccAccountGetBalance ||
+        fn == xaccAccountGetClearedBalance ||
+        fn == xaccAccountGetReconciledBalance;
+}
+
+/* Upper bound on the number of cached subtree balances of an account,
+ * so that e.g. a report asking for the balance on every day of a year
+ * doesn't make the lookup slow. */
+#define MAX_SUBTREE_BALANCES 32
+
+/*
+ * Return the balance described by key, which should have its price
+ * generation set, for acc and all its descendants.  The balances of
+ * the children's subtrees are computed (and cached) first, and the
+ * result is cached in acc until one of the balances in the subtree or
+ * a price changes.
+ */
+static gnc_numeric
+account_get_subtree_balance (const Account *acc, const SubtreeBalance& key)
+{
+    AccountCacheLock lock;
+    AccountPrivate *priv = GET_PRIVATE(acc);
+    auto& cache = priv->subtree_balances;
+    auto entry = std::find_if (cache.begin(), cache.end(),
+                               [&key](const SubtreeBalance& sb)
+                               {
+                                   return sb.fn == key.fn &&
+                                       sb.date_fn == key.date_fn &&
+                                       sb.date == key.date &&
+                                       sb.report_commodity == key.report_commodity;
+                               });
+    if (entry != cache.end() &&
+        entry->price_generation == key.price_generation)
+        return entry->balance;
+
+    gnc_numeric balance;
+    if (key.fn)
+        balance = xaccAccountGetXxxBalanceInCurrency (acc, key.fn,
+                                                      key.report_commodity);
+    else
+        balance = xaccAccountGetXxxBalanceAsOfDateInCurrency (
+                      const_cast<Account*>(acc), key.date, key.date_fn,
+                      key.report_commodity);
+
+    for (GList *node = priv->children; node; node = node->next)
+    {
+        auto child = static_cast<const Account*>(node->data);
+        balance = gnc_numeric_add (balance,
+                                   account_get_subtree_balance (child, key),
+                                   gnc_commodity_get_fraction (key.report_commodity),
+                                   GNC_HOW_RND_ROUND_HALF_UP);
+    }
+
+    if (entry == cache.end())
+    {
+        if (cache.size() >= MAX_SUBTREE_BALANCES)
+            cache.clear();
+        entry = cache.insert (cache.end(), key);
+    }
+    entry->price_generation = key.price_generation;
+    entry->balance = balance;
+    return balance;
+}
+
+static guint
+account_price_generation (const Account *acc)
+{
+    GNCPriceDB *pdb = gnc_pricedb_get_db (gnc_account_get_book (acc));
+    return pdb ? gnc_pricedb_get_generation (pdb) : 0;
+}
+
 /*
  * Data structure used to pass various arguments into the following fn.
  */
@@ -3656,8 +4385,6 @@ typedef struct
     const gnc_commodity *currency;
     gnc_numeric balance;
     xaccGetBalanceFn fn;
-    xaccGetBalanceAsOfDateFn asOfDateFn;
-    time64 date;
 } CurrencyBalance;
 
 
@@ -3680,23 +4407,6 @@ xaccAccountBalanceHelper (Account *acc, gpointer data)
                                    GNC_HOW_RND_ROUND_HALF_UP);
 }
 
-static void
-xaccAccountBalanceAsOfDateHelper (Account *acc, gpointer data)
-{
-    CurrencyBalance *cb = static_cast<CurrencyBalance*>(data);
-    gnc_numeric balance;
-
-    g_return_if_fail (cb->asOfDateFn && cb->currency);
-
-    balance = xaccAccountGetXxxBalanceAsOfDateInCurrency (
-                  acc, cb->date, cb->asOfDateFn, cb->currency);
-    cb->balance = gnc_numeric_add (cb->balance, balance,
-                                   gnc_commodity_get_fraction (cb->currency),
-                                   GNC_HOW_RND_ROUND_HALF_UP);
-}
-
-
-
 /*
  * Common function that iterates recursively over all accounts below
  * the specified account.  It uses xaccAccountBalanceHelper to sum up
@@ -3706,6 +4416,8 @@ xaccAccountBalanceAsOfDateHelper (Account *acc, gpointer data)
  *
  * If 'report_commodity' is NULL, just use the account's commodity.
  * If 'include_children' is FALSE, this function doesn't recurse at all.
+ * Subtree balances not depending on the current time come from the
+ * cache in the accounts, see account_get_subtree_balance.
  */
 static gnc_numeric
 xaccAccountGetXxxBalanceInCurrencyRecursive (const Account *acc,
@@ -3721,6 +4433,14 @@ xaccAccountGetXxxBalanceInCurrencyRecursive (const Account *acc,
     if (!report_commodity)
         return gnc_numeric_zero();
 
+    if (include_children && subtree_balance_cacheable (fn))
+    {
+        SubtreeBalance key = { fn, NULL, 0, report_commodity,
+                               account_price_generation (acc),
+                               gnc_numeric_zero () };
+        return account_get_subtree_balance (acc, key);
+    }
+
     balance = xaccAccountGetXxxBalanceInCurrency (acc, fn, report_commodity);
 
     /* If needed, sum up the children converting to the *requested*
@@ -3731,10 +4451,10 @@ xaccAccountGetXxxBalanceInCurrencyRecursive (const Account *acc,
         /* MSVC compiler: Somehow, the struct initialization containing a
            gnc_numeric doesn't work. As an exception, we hand-initialize
            that member afterwards. */
-        CurrencyBalance cb = { report_commodity, { 0 }, fn, NULL, 0 };
+        CurrencyBalance cb = { report_commodity, { 0 }, fn };
         cb.balance = balance;
 #else
-        CurrencyBalance cb = { report_commodity, balance, fn, NULL, 0 };
+        CurrencyBalance cb = { report_commodity, balance, fn };
 #endif
 
         gnc_account_foreach_descendant (acc, xaccAccountBalanceHelper, &cb);
@@ -3757,27 +4477,17 @@ xaccAccountGetXxxBalanceAsOfDateInCurrencyRecursive (
     if (!report_commodity)
         return gnc_numeric_zero();
 
-    balance = xaccAccountGetXxxBalanceAsOfDateInCurrency(
-                  acc, date, fn, report_commodity);
-
-    /* If needed, sum up the children converting to the *requested*
-       commodity. */
     if (include_children)
     {
-#ifdef _MSC_VER
-        /* MSVC compiler: Somehow, the struct initialization containing a
-           gnc_numeric doesn't work. As an exception, we hand-initialize
-           that member afterwards. */
-        CurrencyBalance cb = { report_commodity, 0, NULL, fn, date };
-        cb.balance = balance;
-#else
-        CurrencyBalance cb = { report_commodity, balance, NULL, fn, date };
-#endif
-
-        gnc_account_foreach_descendant (acc, xaccAccountBalanceAsOfDateHelper, &cb);
-        balance = cb.balance;
+        SubtreeBalance key = { NULL, fn, date, report_commodity,
+                               account_price_generation (acc),
+                               gnc_numeric_zero () };
+        return account_get_subtree_balance (acc, key);
     }
 
+    balance = xaccAccountGetXxxBalanceAsOfDateInCurrency(
+                  acc, date, fn, report_commodity);
+
     return balance;
 }
 
@@ -3877,6 +4587,214 @@ xaccAccountGetNoclosingBalanceChangeForPeriod (Account *acc, time64 t1,
     return gnc_numeric_sub(b2, b1, GNC_DENOM_AUTO, GNC_HOW_DENOM_FIXED);
 }
 
+/*
+ * Add the balances of acc as of each of the ascending dates, converted
+ * to report_commodity, to balances.  The splits are walked only once,
+ * picking up the running balance of the last split before each date.
+ */
+static void
+account_add_balances_as_of_dates (Account *acc,
+                                  const std::vector<time64>& dates,
+                                  const gnc_commodity *report_commodity,
+                                  gboolean ignclosing,
+                                  std::vector<gnc_numeric>& balances)
+{
+    AccountPrivate *priv = GET_PRIVATE(acc);
+
+    xaccAccountSortSplits (acc, TRUE); /* just in case, normally a noop */
+    xaccAccountRecomputeBalance (acc); /* just in case, normally a noop */
+
+    auto pos = priv->splits.cbegin();
+    auto end = priv->splits.cend();
+    Split *latest = nullptr;
+    for (size_t i = 0; i < dates.size(); ++i)
+    {
+        while (pos != end && xaccTransGetDate (xaccSplitGetParent (*pos)) < dates[i])
+            latest = *pos++;
+        if (!latest)
+            continue;
+
+        gnc_numeric balance = ignclosing ? xaccSplitGetNoclosingBalance (latest) :
+            xaccSplitGetBalance (latest);
+        balance = xaccAccountConvertBalanceToCurrency (acc, balance,
+                                                       priv->commodity,
+                                                       report_commodity);
+        balances[i] = gnc_numeric_add (balances[i], balance,
+                                       gnc_commodity_get_fraction (report_commodity),
+                                       GNC_HOW_RND_ROUND_HALF_UP);
+    }
+}
+
+static std::vector<gnc_numeric>
+GetBalanceChangesForPeriods (Account *acc, const std::vector<time64>& boundaries,
+                             gboolean recurse, gboolean ignclosing)
+{
+    std::vector<gnc_numeric> changes;
+
+    g_return_val_if_fail (GNC_IS_ACCOUNT(acc), changes);
+    g_return_val_if_fail (std::is_sorted (boundaries.begin(), boundaries.end()),
+                          changes);
+    if (boundaries.size() < 2)
+        return changes;
+
+    changes.resize (boundaries.size() - 1, gnc_numeric_zero());
+    auto report_commodity = xaccAccountGetCommodity (acc);
+    if (!report_commodity)
+        return changes;
+
+    std::vector<gnc_numeric> balances (boundaries.size(), gnc_numeric_zero());
+    account_add_balances_as_of_dates (acc, boundaries, report_commodity,
+                                      ignclosing, balances);
+    if (recurse)
+    {
+        GList *descendants = gnc_account_get_descendants (acc);
+        for (GList *node = descendants; node; node = node->next)
+            account_add_balances_as_of_dates (static_cast<Account*>(node->data),
+                                              boundaries, report_commodity,
+                                              ignclosing, balances);
+        g_list_free (descendants);
+    }
+
+    for (size_t i = 0; i < changes.size(); ++i)
+        changes[i] = gnc_numeric_sub (balances[i + 1], balances[i],
+                                      GNC_DENOM_AUTO, GNC_HOW_DENOM_FIXED);
+    return changes;
+}
+
+std::vector<gnc_numeric>
+xaccAccountGetBalanceChangesForPeriods (Account *acc,
+                                        const std::vector<time64>& boundaries,
+                                        gboolean recurse)
+{
+    return GetBalanceChangesForPeriods (acc, boundaries, recurse, FALSE);
+}
+
+std::vector<gnc_numeric>
+xaccAccountGetNoclosingBalanceChangesForPeriods (Account *acc,
+                                                 const std::vector<time64>& boundaries,
+                                                 gboolean recurse)
+{
+    return GetBalanceChangesForPeriods (acc, boundaries, recurse, TRUE);
+}
+
+using BalanceRow = std::vector<gnc_numeric>;
+using BalanceRows = std::unordered_map<const Account*, BalanceRow>;
+
+/* The balances of acc alone as of each of the sorted dates, in its
+ * commodity, walking its splits once. */
+static const BalanceRow&
+account_balance_row_as_of_dates (Account *acc, const time64 *dates,
+                                 guint n_dates, BalanceRows& rows)
+{
+    auto found = rows.find (acc);
+    if (found != rows.end())
+        return found->second;
+
+    xaccAccountSortSplits (acc, TRUE); /* just in case, normally a noop */
+    xaccAccountRecomputeBalance (acc); /* just in case, normally a noop */
+
+    auto priv = GET_PRIVATE(acc);
+    const auto& splits = priv->splits;
+    BalanceRow row (n_dates);
+    size_t pos = 0;
+    for (guint i = 0; i < n_dates; i++)
+    {
+        while (pos < splits.size() &&
+               xaccTransGetDate (xaccSplitGetParent (splits[pos])) < dates[i])
+            pos++;
+        row[i] = pos ? xaccSplitGetBalance (splits[pos - 1]) :
+            priv->starting_balance;
+    }
+    return rows.emplace (acc, std::move (row)).first->second;
+}
+
+/* Add the balances of acc, and of its descendants if include_children,
+ * to sums, converted to commodity, or to the currency of rates if that
+ * isn't NULL. */
+static void
+account_add_subtree_balances_as_of_dates (Account *acc, const time64 *dates,
+                                          guint n_dates,
+                                          gboolean include_children,
+                                          const GNCPriceTable *rates,
+                                          const guint *rate_index,
+                                          const gnc_commodity *commodity,
+                                          BalanceRows& rows, gnc_numeric *sums)
+{
+    auto own_commodity = xaccAccountGetCommodity (acc);
+    BalanceRow subtree (account_balance_row_as_of_dates (acc, dates, n_dates,
+                                                         rows));
+
+    for (guint i = 0; i < n_dates; i++)
+        if (rates)
+            subtree[i] = gnc_price_table_convert_balance (rates, subtree[i],
+                                                          own_commodity,
+                                                          rate_index[i]);
+        else
+            subtree[i] = xaccAccountConvertBalanceToCurrency (acc, subtree[i],
+                                                              own_commodity,
+                                                              commodity);
+
+    /* Sum the subtree as account_get_subtree_balance() does, rounding
+     * each child's subtree to the commodity. */
+    if (include_children)
+        for (auto node = GET_PRIVATE(acc)->children; node; node = node->next)
+            account_add_subtree_balances_as_of_dates (GNC_ACCOUNT (node->data),
+                                                      dates, n_dates, TRUE,
+                                                      rates, rate_index,
+                                                      commodity, rows,
+                                                      subtree.data());
+
+    for (guint i = 0; i < n_dates; i++)
+        sums[i] = gnc_numeric_add (sums[i], subtree[i],
+                                   gnc_commodity_get_fraction (commodity),
+                                   GNC_HOW_RND_ROUND_HALF_UP);
+}
+
+void
+xaccAccountsGetBalancesAsOfDates (AccountList *accounts, const time64 *dates,
+                                  guint n_dates, gboolean include_children,
+                                  const GNCPriceTable *rates,
+                                  gnc_numeric *balances)
+{
+    BalanceRows rows;
+    std::vector<guint> rate_index (n_dates);
+
+    g_return_if_fail (n_dates == 0 || (dates && balances));
+
+    if (rates)
+        for (guint i = 0; i < n_dates; i++)
+            rate_index[i] = gnc_price_table_date_index (rates, dates[i]);
+
+    for (auto node = accounts; node; node = node->next, balances += n_dates)
+    {
+        auto acc = GNC_ACCOUNT (node->data);
+        const gnc_commodity *commodity;
+
+        std::fill (balances, balances + n_dates, gnc_numeric_zero ());
+        if (!acc)
+            continue;
+
+        /* Without children, the unconverted balance is the one
+         * xaccAccountGetBalanceAsOfDate() gives. */
+        if (!include_children && !rates)
+        {
+            const auto& row = account_balance_row_as_of_dates (acc, dates,
+                                                               n_dates, rows);
+            std::copy (row.begin(), row.end(), balances);
+            continue;
+        }
+
+        commodity = rates ? gnc_price_table_get_currency (rates) :
+            xaccAccountGetCommodity (acc);
+        if (!commodity)
+            continue;
+        account_add_subtree_balances_as_of_dates (acc, dates, n_dates,
+                                                  include_children, rates,
+                                                  rate_index.data(), commodity,
+                                                  rows, balances);
+    }
+}
+
 
 /********************************************************************\
 \********************************************************************/
@@ -3895,8 +4813,33 @@ xaccAccountGetNoclosingBalanceChangeForPeriod (Account *acc, time64 t1,
 SplitList *
 xaccAccountGetSplitList (const Account *acc)
 {
+    AccountPrivate *priv;
+
     g_return_val_if_fail(GNC_IS_ACCOUNT(acc), NULL);
+    account_load_pending_splits (acc);
+    AccountCacheLock lock;
     xaccAccountSortSplits((Account*)acc, FALSE);  // normally a noop
+    priv = GET_PRIVATE(acc);
+    if (!priv->split_list)
+    {
+        for (auto it = priv->splits.rbegin(); it != priv->splits.rend(); ++it)
+            priv->split_list = g_list_prepend (priv->split_list, *it);
+    }
+    else if (priv->split_list_sort_dirty && !priv->sort_dirty)
+    {
+        account_order_split_list (priv);
+    }
+    priv->split_list_sort_dirty = FALSE;
+    return priv->split_list;
+}
+
+const SplitsVec&
+xaccAccountGetSplits (const Account *acc)
+{
+    static const SplitsVec empty;
+    g_return_val_if_fail (GNC_IS_ACCOUNT(acc), empty);
+    account_load_pending_splits (acc);
+    xaccAccountSortSplits ((Account*)acc, FALSE);  // normally a noop
     return GET_PRIVATE(acc)->splits;
 }
 
@@ -3911,7 +4854,8 @@ xaccAccountGetSplitList(account) == NULL instead. To test descendants \
 as well, use gnc_account_and_descendants_empty.");
     g_return_val_if_fail(GNC_IS_ACCOUNT(acc), 0);
 
-    nr = g_list_length(xaccAccountGetSplitList(acc));
+    account_load_pending_splits (acc);
+    nr = GET_PRIVATE(acc)->splits.size();
     if (include_children && (gnc_account_n_children(acc) != 0))
     {
         for (i=0; i < gnc_account_n_children(acc); i++)
@@ -3925,7 +4869,8 @@ as well, use gnc_account_and_descendants_empty.");
 gboolean gnc_account_and_descendants_empty (Account *acc)
 {
     g_return_val_if_fail (GNC_IS_ACCOUNT (acc), FALSE);
-    if (xaccAccountGetSplitList (acc)) return FALSE;
+    account_load_pending_splits (acc);
+    if (!GET_PRIVATE(acc)->splits.empty()) return FALSE;
     auto empty = TRUE;
     auto *children = gnc_account_get_children (acc);
     for (auto *n = children; n && empty; n = n->next)
@@ -3950,19 +4895,23 @@ xaccAccountFindOpenLots (const Account *acc,
                          gpointer user_data, GCompareFunc sort_func)
 {
     AccountPrivate *priv;
-    GList *lot_list;
     GList *retval = NULL;
 
     g_return_val_if_fail(GNC_IS_ACCOUNT(acc), NULL);
 
     priv = GET_PRIVATE(acc);
-    for (lot_list = priv->lots; lot_list; lot_list = lot_list->next)
+    for (auto it = priv->open_lots.begin(); it != priv->open_lots.end();)
     {
-        GNCLot *lot = static_cast<GNCLot*>(lot_list->data);
+        GNCLot *lot = it->second;
 
-        /* If this lot is closed, then ignore it */
+        /* If this lot is closed, then ignore it, and don't look at it
+         * again until it may have been opened. */
         if (gnc_lot_is_closed (lot))
+        {
+            it = priv->open_lots.erase (it);
             continue;
+        }
+        ++it;
 
         if (match_func && !(match_func)(lot, user_data))
             continue;
@@ -5005,7 +5954,6 @@ finder_help_function(const Account *acc, const char *description,
                      Split **split, Transaction **trans )
 {
     AccountPrivate *priv;
-    GList *slp;
 
     /* First, make sure we set the data to NULL BEFORE we start */
     if (split) *split = NULL;
@@ -5018,9 +5966,9 @@ finder_help_function(const Account *acc, const char *description,
      * list is in date order, and the most recent matches should be
      * returned!?  */
     priv = GET_PRIVATE(acc);
-    for (slp = g_list_last(priv->splits); slp; slp = slp->prev)
+    for (auto it = priv->splits.rbegin(); it != priv->splits.rend(); ++it)
     {
-        Split *lsplit = static_cast<Split*>(slp->data);
+        Split *lsplit = *it;
         Transaction *ltrans = xaccSplitGetParent(lsplit);
 
         if (g_strcmp0 (description, xaccTransGetDescription (ltrans)) == 0)
@@ -5137,8 +6085,8 @@ gnc_account_merge_children (Account *parent)
             gnc_account_merge_children (acc_a);
 
             /* consolidate transactions */
-            while (priv_b->splits)
-                xaccSplitSetAccount (static_cast <Split*> (priv_b->splits->data), acc_a);
+            while (!priv_b->splits.empty())
+                xaccSplitSetAccount (priv_b->splits.front(), acc_a);
 
             /* move back one before removal. next iteration around the loop
              * will get the node after node_b */
@@ -5180,7 +6128,13 @@ xaccAccountBeginStagedTransactionTraversals (const Account *account)
     if (!account)
         return;
     priv = GET_PRIVATE(account);
-    xaccSplitsBeginStagedTransactionTraversals(priv->splits);
+    for (auto s : priv->splits)
+    {
+        Transaction *trans = s->parent;
+
+        if (trans)
+            trans->marker = 0;
+    }
 }
 
 gboolean
@@ -5197,16 +6151,11 @@ xaccTransactionTraverse (Transaction *trans, int stage)
     return FALSE;
 }
 
-static void do_one_split (Split *s, gpointer data)
-{
-    Transaction *trans = s->parent;
-    trans->marker = 0;
-}
-
 static void do_one_account (Account *account, gpointer data)
 {
     AccountPrivate *priv = GET_PRIVATE(account);
-    g_list_foreach(priv->splits, (GFunc)do_one_split, NULL);
+    for (auto s : priv->splits)
+        s->parent->marker = 0;
 }
 
 /* Replacement for xaccGroupBeginStagedTransactionTraversals */
@@ -5227,24 +6176,21 @@ xaccAccountStagedTransactionTraversal (const Account *acc,
                                        void *cb_data)
 {
     AccountPrivate *priv;
-    GList *split_p;
-    GList *next;
     Transaction *trans;
-    Split *s;
     int retval;
 
     if (!acc) return 0;
 
+    account_load_pending_splits (acc);
     priv = GET_PRIVATE(acc);
-    for (split_p = priv->splits; split_p; split_p = next)
+    /* Walk a copy of the splits, just in case some naughty thunk adds
+     * or removes splits in this account, and skip any that a thunk has
+     * removed in the meantime. */
+    auto splits = priv->splits;
+    for (auto s : splits)
     {
-        /* Get the next element in the split list now, just in case some
-         * naughty thunk destroys the one we're using. This reduces, but
-         * does not eliminate, the possibility of undefined results if
-         * a thunk removes splits from this account. */
-        next = g_list_next(split_p);
-
-        s = static_cast <Split*> (split_p->data);
+        if (!g_hash_table_contains (priv->splits_hash, s))
+            continue;
         trans = s->parent;
         if (trans && (trans->marker < stage))
         {
@@ -5267,9 +6213,8 @@ gnc_account_tree_staged_transaction_traversal (const Account *acc,
         void *cb_data)
 {
     const AccountPrivate *priv;
-    GList *acc_p, *split_p;
+    GList *acc_p;
     Transaction *trans;
-    Split *s;
     int retval;
 
     if (!acc) return 0;
@@ -5284,9 +6229,11 @@ gnc_account_tree_staged_transaction_traversal (const Account *acc,
     }
 
     /* Now this account */
-    for (split_p = priv->splits; split_p; split_p = g_list_next(split_p))
+    auto splits = priv->splits;
+    for (auto s : splits)
     {
-        s = static_cast <Split*> (split_p->data);
+        if (!g_hash_table_contains (priv->splits_hash, s))
+            continue;
         trans = s->parent;
         if (trans && (trans->marker < stage))
         {
@@ -5447,26 +6394,87 @@ struct TokenAccountsInfo
     int64_t total_count;
 };
 
-/** holds an account guid and its corresponding integer probability
-  the integer probability is some factor of 10
+/** The bayesian import map of an account by token, which would otherwise
+ * need a scan of all the account's slots for each token looked up.  It
+ * mirrors the KVP slots "import-map-bayes/<token>/<account guid>", the
+ * accounts of each token in the same (GUID) order.
  */
-struct AccountInfo
+struct ImapBayesIndex
 {
-    std::string account_guid;
-    int32_t probability;
+    std::unordered_map<std::string, TokenAccountsInfo> tokens;
 };
 
 static void
-build_token_info(char const * suffix, KvpValue * value, TokenAccountsInfo & tokenInfo)
+build_imap_bayes_index (char const * suffix, KvpValue * value, ImapBayesIndex & index)
+{
+    /* The suffix is "/<token>/<account guid>" */
+    auto len = strlen (suffix);
+    if (len < GUID_ENCODING_LENGTH + 2 || suffix[0] != '/' ||
+        suffix[len - GUID_ENCODING_LENGTH - 1] != '/')
+        return;
+    std::string token {suffix + 1, len - GUID_ENCODING_LENGTH - 2};
+    auto& tokenInfo = index.tokens[token];
+    tokenInfo.total_count += value->get<int64_t>();
+    tokenInfo.accounts.emplace_back(AccountTokenCount{std::string{suffix + len - GUID_ENCODING_LENGTH},
+                                                      value->get<int64_t>()});
+}
+
+static ImapBayesIndex &
+get_imap_bayes_index (Account *acc)
 {
-    if (strlen(suffix) == GUID_ENCODING_LENGTH)
+    auto priv = GET_PRIVATE (acc);
+    if (!priv->imap_bayes_index)
     {
-        tokenInfo.total_count += value->get<int64_t>();
-        /*By convention, the key ends with the account GUID.*/
-        tokenInfo.accounts.emplace_back(AccountTokenCount{std::string{suffix}, value->get<int64_t>()});
+        priv->imap_bayes_index = new ImapBayesIndex;
+        qof_instance_foreach_slot_prefix (QOF_INSTANCE (acc), IMAP_FRAME_BAYES,
+                                          &build_imap_bayes_index,
+                                          *priv->imap_bayes_index);
     }
+    return *priv->imap_bayes_index;
+}
+
+/* Drop the index when the map has been changed behind its back; it is
+ * rebuilt on the next lookup. */
+static void
+imap_bayes_index_free (Account *acc)
+{
+    auto priv = GET_PRIVATE (acc);
+    delete priv->imap_bayes_index;
+    priv->imap_bayes_index = nullptr;
 }
 
+/* Count one more occurrence of token for the account with guid_string,
+ * as change_imap_entry does in the KVP slots. */
+static void
+imap_bayes_index_add (Account *acc, std::string const & token,
+                      char const * guid_string)
+{
+    auto priv = GET_PRIVATE (acc);
+    if (!priv->imap_bayes_index)
+        return;
+    auto& tokenInfo = priv->imap_bayes_index->tokens[token];
+    auto& accounts = tokenInfo.accounts;
+    auto pos = std::lower_bound (accounts.begin(), accounts.end(), guid_string,
+                                 [](AccountTokenCount const & a, char const * guid)
+                                 {
+                                     return a.account_guid < guid;
+                                 });
+    if (pos != accounts.end() && pos->account_guid == guid_string)
+        ++pos->token_count;
+    else
+        accounts.insert (pos, AccountTokenCount{guid_string, 1});
+    ++tokenInfo.total_count;
+}
+
+/** holds an account guid and its corresponding integer probability
+  the integer probability is some factor of 10
+ */
+struct AccountInfo
+{
+    std::string account_guid;
+    int32_t probability;
+};
+
 /** We scale the probability values by probability_factor.
   ie. with probability_factor of 100000, 10% would be
   0.10 * 100000 = 10000 */
@@ -5504,13 +6512,17 @@ static ProbabilityVec
 get_first_pass_probabilities(GncImportMatchMap * imap, GList * tokens)
 {
     ProbabilityVec ret;
+    auto const & index = get_imap_bayes_index (imap->acc);
     /* find the probability for each account that contains any of the tokens
      * in the input tokens list. */
     for (auto current_token = tokens; current_token; current_token = current_token->next)
     {
-        TokenAccountsInfo tokenInfo{};
-        auto path = std::string{IMAP_FRAME_BAYES "/"} + static_cast <char const *> (current_token->data) + "/";
-        qof_instance_foreach_slot_prefix (QOF_INSTANCE (imap->acc), path, &build_token_info, tokenInfo);
+        if (!current_token->data)
+            continue;
+        auto token_entry = index.tokens.find (static_cast <char const *> (current_token->data));
+        if (token_entry == index.tokens.end())
+            continue;
+        auto const & tokenInfo = token_entry->second;
         for (auto const & current_account_token : tokenInfo.accounts)
         {
             auto item = std::find_if(ret.begin(), ret.end(), [&current_account_token]
@@ -5638,6 +6650,7 @@ convert_imap_account_bayes_to_flat (Account *acc)
     if (!flat_imap.size ())
         return false;
     xaccAccountBeginEdit(acc);
+    imap_bayes_index_free (acc);
     frame->set({IMAP_FRAME_BAYES}, nullptr);
     std::for_each(flat_imap.begin(), flat_imap.end(),
                   [&frame] (FlatKvpEntry const & entry) {
@@ -5806,6 +6819,8 @@ gnc_account_imap_add_account_bayes (GncImportMatchMap *imap,
         auto path = std::string {IMAP_FRAME_BAYES} + '/' + static_cast<char*>(current_token->data) + '/' + guid_string;
         /* change the imap entry for the account */
         change_imap_entry (imap, path, token_count);
+        imap_bayes_index_add (imap->acc, static_cast<char*>(current_token->data),
+                              guid_string);
     }
     /* free up the account fullname and guid string */
     qof_instance_set_dirty (QOF_INSTANCE (imap->acc));
@@ -5950,6 +6965,7 @@ gnc_account_delete_map_entry (Account *acc, char *head, char *category,
         if (qof_instance_has_path_slot (QOF_INSTANCE (acc), path))
         {
             xaccAccountBeginEdit (acc);
+            imap_bayes_index_free (acc);
             if (empty)
                 qof_instance_slot_path_delete_if_empty (QOF_INSTANCE(acc), path);
             else
@@ -5969,6 +6985,7 @@ gnc_account_delete_all_bayes_maps (Account *acc)
     {
         auto slots = qof_instance_get_slots_prefix (QOF_INSTANCE (acc), IMAP_FRAME_BAYES);
         if (!slots.size()) return;
+        imap_bayes_index_free (acc);
         for (auto const & entry : slots)
         {
              qof_instance_slot_path_delete (QOF_INSTANCE (acc), {entry.first});
@@ -355,6 +355,24 @@ void gnc_account_set_start_cleared_balance (Account *acc,
 void gnc_account_set_start_reconciled_balance (Account *acc,
         const gnc_numeric start_baln);
 
+/** This function will set the starting commodity balance of this
+ *  account, not counting book closing transactions.  Like the other
+ *  starting balances, it is for backends that return only the splits
+ *  after some date. */
+void gnc_account_set_start_noclosing_balance (Account *acc,
+        const gnc_numeric start_baln);
+
+/** Flag that the backend hasn't loaded all of the account's splits, and
+ *  that its starting balances sum up the ones it left out.  The first
+ *  call that needs the whole list, e.g. xaccAccountGetSplitList(), then
+ *  has the backend load them; the backend clears the flag. */
+void gnc_account_set_splits_pending (Account *acc, gboolean pending);
+gboolean gnc_account_get_splits_pending (const Account *acc);
+
+/** Take a split that a backend has just loaded out of the starting
+ *  balances that stood in for it. */
+void gnc_account_remove_start_balance_split (Account *acc, const Split *split);
+
 /** Tell the account that the running balances may be incorrect and
  *  need to be recomputed.
  *
@@ -449,6 +467,15 @@ void xaccAccountSortSplits (Account *acc, gboolean force);
  */
 gchar * gnc_account_get_full_name (const Account *account);
 
+/** Return the fully qualified name of the account, like
+ * gnc_account_get_full_name(), without copying it.
+ *
+ * The string belongs to the account, which caches it. It is only valid
+ * until the account or one of its ancestors is renamed or moved, or the
+ * account separator is changed; copy it if it must be kept longer.
+ */
+const gchar * gnc_account_get_full_name_const (const Account *account);
+
 /** Retrieve the gains account used by this account for the indicated
  * currency, creating and recording a new one if necessary.
  *
@@ -621,6 +648,36 @@ gnc_numeric xaccAccountGetNoclosingBalanceChangeForPeriod (
 gnc_numeric xaccAccountGetBalanceChangeForPeriod (
     Account *acc, time64 date1, time64 date2, gboolean recurse);
 
+/** Compute the balances of a list of accounts as of each of a list of
+ *  dates in one pass over the splits of each account, for reports that
+ *  would otherwise ask xaccAccountGetBalanceAsOfDateInCurrency() for
+ *  every account and date. The splits of an account that is in the
+ *  subtree of several of the accounts are only walked once.
+ *
+ *  @param accounts The accounts, one row of balances each.
+ *
+ *  @param dates The dates, in ascending order.
+ *
+ *  @param n_dates The number of dates, the columns of balances.
+ *
+ *  @param include_children Whether the balance of an account includes
+ *  those of its descendants.
+ *
+ *  @param rates If not NULL, an exchange-rate table from
+ *  gnc_pricedb_build_price_table() to convert all the balances to its
+ *  report currency, at its latest date not after each date. Otherwise
+ *  each balance is in the commodity of its account, the descendants'
+ *  converted to it as xaccAccountGetBalanceAsOfDateInCurrency() does.
+ *
+ *  @param balances Filled with the balance of account i as of date j at
+ *  index i * n_dates + j.
+ */
+void xaccAccountsGetBalancesAsOfDates (AccountList *accounts,
+                                       const time64 *dates, guint n_dates,
+                                       gboolean include_children,
+                                       const struct gnc_price_table_s *rates,
+                                       gnc_numeric *balances);
+
 /** @} */
 
 /** @name Account Children and Parents.
@@ -0,0 +1,75 @@
+/********************************************************************\
+ * Account.hpp -- C++ interface to the Account engine API           *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ *                                                                  *
+\********************************************************************/
+
+/** @addtogroup Engine
+    @{ */
+/** @addtogroup Account
+    @{ */
+/** @file Account.hpp
+ *  @brief C++ accessors for the Account structure.
+ */
+
+#ifndef GNC_ACCOUNT_HPP
+#define GNC_ACCOUNT_HPP
+
+#include <vector>
+
+#include "Account.h"
+
+using SplitsVec = std::vector<Split*>;
+
+/** Return the account's splits in sort order.
+ *
+ *  The vector is owned by the account and is only valid until the
+ *  account's splits are next changed; copy it if the walk may add,
+ *  remove or re-sort splits in this account.
+ */
+const SplitsVec& xaccAccountGetSplits (const Account *account);
+
+/** Return the changes of the account's balance over consecutive periods.
+ *
+ *  This is the same as calling xaccAccountGetBalanceChangeForPeriod
+ *  for each pair of adjacent boundaries, but each account's splits are
+ *  walked only once.
+ *
+ *  @param account The account.
+ *  @param boundaries The period boundaries, in ascending order.
+ *  @param recurse Whether to include the balances of the subaccounts,
+ *  converted to the account's commodity.
+ *  @return One balance change for each period, boundaries.size() - 1
+ *  in all, or an empty vector if there are fewer than two boundaries.
+ */
+std::vector<gnc_numeric>
+xaccAccountGetBalanceChangesForPeriods (Account *account,
+                                        const std::vector<time64>& boundaries,
+                                        gboolean recurse);
+
+/** As xaccAccountGetBalanceChangesForPeriods, but ignoring closing
+ *  entries like xaccAccountGetNoclosingBalanceChangeForPeriod. */
+std::vector<gnc_numeric>
+xaccAccountGetNoclosingBalanceChangesForPeriods (Account *account,
+                                                 const std::vector<time64>& boundaries,
+                                                 gboolean recurse);
+
+#endif /* GNC_ACCOUNT_HPP */
+/** @} */
+/** @} */
@@ -49,85 +49,9 @@ extern "C" {
 
 /** STRUCTS *********************************************************/
 
-/** This is the data that describes an account.
- *
- * This is the *private* header for the account structure.
- * No one outside of the engine should ever include this file.
-*/
-
-/** \struct Account */
-typedef struct AccountPrivate
-{
-    /* The accountName is an arbitrary string assigned by the user.
-     * It is intended to a short, 5 to 30 character long string that
-     * is displayed by the GUI as the account mnemonic.
-     */
-    char *accountName;
-
-    /* The accountCode is an arbitrary string assigned by the user.
-     * It is intended to be reporting code that is a synonym for the
-     * accountName. Typically, it will be a numeric value that follows
-     * the numbering assignments commonly used by accountants, such
-     * as 100, 200 or 600 for top-level accounts, and 101, 102..  etc.
-     * for detail accounts.
-     */
-    char *accountCode;
-
-    /* The description is an arbitrary string assigned by the user.
-     * It is intended to be a longer, 1-5 sentence description of what
-     * this account is all about.
-     */
-    char *description;
-
-    /* The type field is the account type, picked from the enumerated
-     * list that includes ACCT_TYPE_BANK, ACCT_TYPE_STOCK,
-     * ACCT_TYPE_CREDIT, ACCT_TYPE_INCOME, etc.  Its intended use is to
-     * be a hint to the GUI as to how to display and format the
-     * transaction data.
-     */
-    GNCAccountType type;
-
-    /*
-     * The commodity field denotes the kind of 'stuff' stored
-     * in this account.  The 'amount' field of a split indicates
-     * how much of the 'stuff' there is.
-     */
-    gnc_commodity * commodity;
-    int commodity_scu;
-    gboolean non_standard_scu;
-
-    /* The parent and children pointers are used to implement an account
-     * hierarchy, of accounts that have sub-accounts ("detail accounts").
-     */
-    Account *parent;    /* back-pointer to parent */
-    GList *children;    /* list of sub-accounts */
-
-    /* protected data - should only be set by backends */
-    gnc_numeric starting_balance;
-    gnc_numeric starting_noclosing_balance;
-    gnc_numeric starting_cleared_balance;
-    gnc_numeric starting_reconciled_balance;
-
-    /* cached parameters */
-    gnc_numeric balance;
-    gnc_numeric noclosing_balance;
-    gnc_numeric cleared_balance;
-    gnc_numeric reconciled_balance;
-
-    gboolean balance_dirty;     /* balances in splits incorrect */
-
-    GList *splits;              /* list of split pointers */
-    gboolean sort_dirty;        /* sort order of splits is bad */
-
-    LotList   *lots;		/* list of lot pointers */
-    GNCPolicy *policy;		/* Cached pointer to policy method */
-
-    /* The "mark" flag can be used by the user to mark this account
-     * in any way desired.  Handy for specialty traversals of the
-     * account tree. */
-    short mark;
-    gboolean defer_bal_computation;
-} AccountPrivate;
+/* The account's private data is defined in AccountP.hpp because it
+ * holds C++ containers. */
+typedef struct AccountPrivate AccountPrivate;
 
 struct account_s
 {
@@ -142,6 +66,29 @@ void xaccAccountSetGUID (Account *account, const GncGUID *guid);
 /* Register Accounts with the engine */
 gboolean xaccAccountRegister (void);
 
+/* Tell the account that one of its splits has been modified.  The
+ * split is moved if its sort position changed, and the running
+ * balances are marked stale from the split onwards only, so that the
+ * next xaccAccountRecomputeBalance need not start from the beginning.
+ * Splits not yet inserted in the account are ignored. */
+void gnc_account_split_changed (Account *acc, Split *split);
+
+/* The sequence number the account gave the lot when it was added,
+ * higher for the lots added later, 0 if the lot isn't one of its own.
+ * xaccAccountFindOpenLots finds lots in the reverse of that order. */
+guint64 gnc_account_get_lot_seq (const Account *acc, GNCLot *lot);
+
+/* Tell the account that the lot may no longer be closed, after a change
+ * to its splits. */
+void gnc_account_lot_maybe_open (Account *acc, GNCLot *lot);
+
+/* Like xaccAccountForEachLot, but skipping the lots known to be closed
+ * without looking at them again, which matters for accounts with many
+ * closed lots. The lots are visited in the same order. */
+gpointer gnc_account_foreach_open_lot (Account *acc,
+                                       gpointer (*proc)(GNCLot *lot, void *data),
+                                       void *data);
+
 /* Structure for accessing static functions for testing */
 typedef struct
 {
@@ -0,0 +1,181 @@
+/********************************************************************\
+ * AccountP.hpp -- Account engine-private data structure            *
+ * Copyright (C) 1997 Robin D. Clark                                *
+ * Copyright (C) 1997-2002, Linas Vepstas <linas@linas.org>         *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ *                                                                  *
+\********************************************************************/
+
+/** @file AccountP.hpp
+ *
+ * This is the *private* definition of the account structure.
+ * No one outside of the engine should ever include this file.
+ *
+ * The rest of the private account API, which is also usable from C,
+ * is in AccountP.h.
+ */
+
+#ifndef XACC_ACCOUNT_P_HPP
+#define XACC_ACCOUNT_P_HPP
+
+#include "AccountP.h"
+#include "Account.hpp"
+#include "gnc-lot.h"
+
+#include <map>
+#include <unordered_map>
+
+struct ImapBayesIndex;
+
+/** A balance of an account together with all its descendants, in a
+ * report commodity, as computed by the *BalanceInCurrency functions. */
+struct SubtreeBalance
+{
+    xaccGetBalanceFn fn;              /* NULL for as-of-date balances */
+    xaccGetBalanceAsOfDateFn date_fn;
+    time64 date;
+    const gnc_commodity *report_commodity;
+    guint price_generation;           /* of the pricedb used to convert */
+    gnc_numeric balance;
+};
+
+/** This is the data that describes an account.
+ *
+ * This is the *private* header for the account structure.
+ * No one outside of the engine should ever include this file.
+*/
+
+/** \struct Account */
+struct AccountPrivate
+{
+    /* The accountName is an arbitrary string assigned by the user.
+     * It is intended to a short, 5 to 30 character long string that
+     * is displayed by the GUI as the account mnemonic.
+     */
+    char *accountName;
+
+    /* The accountCode is an arbitrary string assigned by the user.
+     * It is intended to be reporting code that is a synonym for the
+     * accountName. Typically, it will be a numeric value that follows
+     * the numbering assignments commonly used by accountants, such
+     * as 100, 200 or 600 for top-level accounts, and 101, 102..  etc.
+     * for detail accounts.
+     */
+    char *accountCode;
+
+    /* The description is an arbitrary string assigned by the user.
+     * It is intended to be a longer, 1-5 sentence description of what
+     * this account is all about.
+     */
+    char *description;
+
+    /* The type field is the account type, picked from the enumerated
+     * list that includes ACCT_TYPE_BANK, ACCT_TYPE_STOCK,
+     * ACCT_TYPE_CREDIT, ACCT_TYPE_INCOME, etc.  Its intended use is to
+     * be a hint to the GUI as to how to display and format the
+     * transaction data.
+     */
+    GNCAccountType type;
+
+    /*
+     * The commodity field denotes the kind of 'stuff' stored
+     * in this account.  The 'amount' field of a split indicates
+     * how much of the 'stuff' there is.
+     */
+    gnc_commodity * commodity;
+    int commodity_scu;
+    gboolean non_standard_scu;
+
+    /* The parent and children pointers are used to implement an account
+     * hierarchy, of accounts that have sub-accounts ("detail accounts").
+     */
+    Account *parent;    /* back-pointer to parent */
+    GList *children;    /* list of sub-accounts */
+
+    /* protected data - should only be set by backends */
+    gnc_numeric starting_balance;
+    gnc_numeric starting_noclosing_balance;
+    gnc_numeric starting_cleared_balance;
+    gnc_numeric starting_reconciled_balance;
+
+    /* cached parameters */
+    gnc_numeric balance;
+    gnc_numeric noclosing_balance;
+    gnc_numeric cleared_balance;
+    gnc_numeric reconciled_balance;
+
+    gboolean balance_dirty;     /* balances in splits incorrect */
+    /* Index of the first split whose running balances are stale; the
+     * splits before it can be used to resume the sums. */
+    size_t balance_dirty_from;
+
+    /* Cached balances of this account's subtree.  They are dropped
+     * here and in every ancestor when one of the balances changes or the
+     * tree is rearranged. */
+    std::vector<SubtreeBalance> subtree_balances;
+
+    /* Cached result of gnc_account_get_full_name_const, NULL if not
+     * computed yet.  Dropped for the whole subtree when the account is
+     * renamed or moved; stale once the account separator has changed
+     * since full_name_generation. */
+    gchar *full_name;
+    guint full_name_generation;
+
+    /* g_utf8_collate_key of accountName for xaccAccountOrder, NULL if
+     * not computed yet.  Dropped when the account is renamed. */
+    gchar *name_collate_key;
+    /* The children in xaccAccountOrder, NULL if not sorted yet.  Dropped
+     * when a child is added or removed or its name, code or type
+     * changes. */
+    GList *sorted_children;
+
+    /* The bayesian import map in the account's KVP, compiled for
+     * lookups by token when first used.  NULL if not built yet. */
+    ImapBayesIndex *imap_bayes_index;
+
+    SplitsVec splits;           /* the account's splits */
+    /* The backend hasn't loaded all of the splits yet; the starting
+     * balances stand in for those it left out. */
+    gboolean splits_pending;
+    GHashTable *splits_hash;    /* the same splits, for membership tests */
+    gboolean sort_dirty;        /* sort order of splits is bad */
+
+    /* The GList handed out by xaccAccountGetSplitList.  Callers may walk
+     * it while they add or remove splits, so once it has been created it
+     * is kept up to date alongside splits instead of being rebuilt.  It
+     * is re-sorted when handed out if a split was moved in splits. */
+    GList *split_list;
+    gboolean split_list_sort_dirty;
+
+    LotList   *lots;		/* list of lot pointers */
+    /* The lots that aren't known to be closed, by insertion number,
+     * latest first so that they are visited in the order of lots. */
+    std::map<guint64, GNCLot*, std::greater<guint64>> open_lots;
+    std::unordered_map<GNCLot*, guint64> lot_seqs;
+    guint64 next_lot_seq;
+    GNCPolicy *policy;		/* Cached pointer to policy method */
+
+    /* The "mark" flag can be used by the user to mark this account
+     * in any way desired.  Handy for specialty traversals of the
+     * account tree. */
+    short mark;
+    gboolean defer_bal_computation;
+};
+
+#endif /* XACC_ACCOUNT_P_HPP */
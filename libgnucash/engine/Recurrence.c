@@ -381,20 +381,158 @@ recurrenceNextInstance(const Recurrence *r, const GDate *ref, GDate *next)
     }
 }
 
+/* The instance in the month k periods after the start date's, its day
+   aligned as in step 2 of recurrenceNextInstance(). For the monthly
+   period types. */
+static void
+recurrence_month_instance(const Recurrence *r, guint k, GDate *date)
+{
+    const GDate *start = &r->start;
+    guint months = k * r->mult * (r->ptype == PERIOD_YEAR ? 12 : 1);
+    guint dim;
+
+    g_date_clear(date, 1);
+    g_date_set_dmy(date, 1, g_date_get_month(start), g_date_get_year(start));
+    g_date_add_months(date, months);
+
+    dim = g_date_get_days_in_month(g_date_get_month(date),
+                                   g_date_get_year(date));
+    if (r->ptype == PERIOD_LAST_WEEKDAY || r->ptype == PERIOD_NTH_WEEKDAY)
+        g_date_add_days(date, nth_weekday_compare(start, date, r->ptype));
+    else if (r->ptype == PERIOD_END_OF_MONTH || g_date_get_day(start) >= dim)
+        g_date_set_day(date, dim);
+    else
+        g_date_set_day(date, g_date_get_day(start));
+
+    adjust_for_weekend(r->ptype, r->wadj, date);
+}
+
+static gboolean
+is_monthly(PeriodType pt)
+{
+    return (pt == PERIOD_YEAR || pt == PERIOD_MONTH ||
+            pt == PERIOD_NTH_WEEKDAY || pt == PERIOD_LAST_WEEKDAY ||
+            pt == PERIOD_END_OF_MONTH);
+}
+
 /* Zero-based index */
 void
 recurrenceNthInstance(const Recurrence *r, guint n, GDate *date)
 {
     GDate ref;
-    guint i;
+    guint i, k;
+
+    g_return_if_fail(r);
+    g_return_if_fail(date);
+
+    *date = ref = r->start;
+    if (n == 0 || !g_date_valid(&r->start))
+        return;
+
+    /* Every instance is a whole number of periods from the start, so
+       rather than stepping through them all, compute the nth. */
+    switch (r->ptype)
+    {
+    case PERIOD_WEEK:
+        g_date_add_days(date, 7 * n * r->mult);
+        return;
+    case PERIOD_DAY:
+        g_date_add_days(date, n * r->mult);
+        return;
+    case PERIOD_ONCE:
+        g_date_clear(date, 1);
+        return;
+    default:
+        break;
+    }
+
+    /* The first instance or two after the start of a monthly recurrence
+       may be the start moved off a weekend; once one is the instance of
+       some month, the nth is that many months on. */
+    for (i = 1; i <= 3 && is_monthly(r->ptype); i++)
+    {
+        recurrenceNextInstance(r, &ref, date);
+        if (i == n)
+            return;
+        for (k = 0; k < 3; k++)
+        {
+            GDate aligned;
+
+            recurrence_month_instance(r, k, &aligned);
+            if (g_date_compare(&aligned, date) == 0)
+            {
+                recurrence_month_instance(r, k + n - i, date);
+                return;
+            }
+        }
+        ref = *date;
+    }
 
-    for (*date = ref = r->start, i = 0; i < n; i++)
+    for (i = (i == 1 ? 0 : i - 1); i < n; i++)
     {
         recurrenceNextInstance(r, &ref, date);
         ref = *date;
     }
 }
 
+guint
+recurrenceFirstInstanceOnOrAfter(const Recurrence *r, const GDate *date,
+                                 GDate *instance)
+{
+    const GDate *start;
+    GDate nth, prev;
+    guint n = 0, period;
+
+    g_return_val_if_fail(r, 0);
+    g_return_val_if_fail(date && g_date_valid(date), 0);
+
+    start = &r->start;
+    nth = *start;
+    if (g_date_valid(start) && g_date_compare(date, start) > 0)
+    {
+        switch (r->ptype)
+        {
+        case PERIOD_WEEK:
+        case PERIOD_DAY:
+            period = r->mult * (r->ptype == PERIOD_WEEK ? 7 : 1);
+            n = (g_date_days_between(start, date) + period - 1) / period;
+            recurrenceNthInstance(r, n, &nth);
+            break;
+        case PERIOD_ONCE:
+            n = 1;
+            g_date_clear(&nth, 1);
+            break;
+        default:
+            if (!is_monthly(r->ptype))
+            {
+                PERR("Invalid period type");
+                break;
+            }
+            /* Start from the number of whole periods between the months
+               and move to the instance itself, at most a few away. */
+            period = r->mult * (r->ptype == PERIOD_YEAR ? 12 : 1);
+            n = (12 * (g_date_get_year(date) - g_date_get_year(start)) +
+                 g_date_get_month(date) - g_date_get_month(start)) / period;
+            recurrenceNthInstance(r, n, &nth);
+            while (g_date_compare(&nth, date) < 0)
+                recurrenceNthInstance(r, ++n, &nth);
+            while (n > 0)
+            {
+                recurrenceNthInstance(r, n - 1, &prev);
+                if (g_date_compare(&prev, date) < 0)
+                    break;
+                nth = prev;
+                n--;
+            }
+            break;
+        }
+    }
+
+    if (instance)
+        *instance = nth;
+    return n;
+}
+
 time64
 recurrenceGetPeriodTime(const Recurrence *r, guint period_num, gboolean end)
 {
@@ -131,9 +131,17 @@ WeekendAdjust recurrenceGetWeekendAdjust(const Recurrence *r);
 void recurrenceNextInstance(const Recurrence *r, const GDate *refDate,
                             GDate *nextDate);
 
-/* Zero-based.  n == 1 gets the instance after the start date. */
+/* Zero-based.  n == 1 gets the instance after the start date.  Takes
+   the same time for any n. */
 void recurrenceNthInstance(const Recurrence *r, guint n, GDate *date);
 
+/* The zero-based number of the first instance on or after 'date', as
+   for recurrenceNthInstance(), also putting the instance itself in
+   'instance' if that isn't NULL.  For a PERIOD_ONCE recurrence whose
+   date has passed the instance is invalid. */
+guint recurrenceFirstInstanceOnOrAfter(const Recurrence *r, const GDate *date,
+                                       GDate *instance);
+
 /* Get a time corresponding to the beginning (or end if 'end' is true)
    of the nth instance of the recurrence. Also zero-based. */
 time64 recurrenceGetPeriodTime(const Recurrence *r, guint n, gboolean end);
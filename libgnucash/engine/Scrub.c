@@ -79,19 +79,283 @@ gnc_get_ongoing_scrub (void)
 }
 
 /* ================================================================ */
+/* The tree scrubs first look for the transactions needing repair and
+ * then repair them.  The search only reads the engine, so for large
+ * trees it is split over worker threads, each taking a run of accounts
+ * with about the same number of splits.  The checks below mustn't call
+ * anything that caches, logs or allocates engine objects; the repairs
+ * run afterwards on the calling thread.  A check may flag transactions
+ * that turn out to be fine, never the reverse. */
+
+static void TransScrubOrphansFast (Transaction *trans, Account *root);
+
+typedef gboolean (*TransScrubCheck) (const Transaction *trans,
+                                     gboolean use_trading);
+
+typedef struct
+{
+    GList **split_lists;
+    guint n_lists;
+    TransScrubCheck check;
+    gboolean use_trading;
+    GPtrArray *found;
+} ScrubSearch;
+
+/* Below this many splits the search isn't worth a thread. */
+#define SCRUB_SPLITS_PER_THREAD 20000
+
+static gboolean
+trans_has_split (const Transaction *trans, const Split *split)
+{
+    return split->parent == trans &&
+           !qof_instance_get_destroying (QOF_INSTANCE (split));
+}
+
+static gboolean
+trans_has_orphans (const Transaction *trans, gboolean use_trading)
+{
+    GList *node;
+    for (node = trans->splits; node; node = node->next)
+    {
+        Split *split = node->data;
+        if (trans_has_split (trans, split) && !split->acc)
+            return TRUE;
+    }
+    return FALSE;
+}
+
+/* Mirrors the conditions acted on by TransScrubOrphansFast,
+ * xaccTransScrubCurrency and xaccTransScrubImbalance. */
+static gboolean
+trans_needs_imbalance_scrub (const Transaction *trans, gboolean use_trading)
+{
+    gnc_commodity *currency = trans->common_currency;
+    gnc_numeric imbal = gnc_numeric_zero ();
+    GList *node;
+
+    if (!currency || !gnc_commodity_is_currency (currency))
+        return TRUE;
+
+    for (node = trans->splits; node; node = node->next)
+    {
+        Split *split = node->data;
+        gnc_commodity *commodity;
+        int scu;
+
+        if (!trans_has_split (trans, split))
+            continue;
+        if (!split->acc)
+            return TRUE;
+        if (gnc_numeric_check (split->amount) ||
+            gnc_numeric_check (split->value))
+            return TRUE;
+
+        commodity = xaccAccountGetCommodity (split->acc);
+        if (!commodity)
+            return TRUE;
+        if (gnc_commodity_equiv (commodity, currency))
+        {
+            scu = MIN (xaccAccountGetCommoditySCU (split->acc),
+                       gnc_commodity_get_fraction (currency));
+            if (!gnc_numeric_same (split->amount, split->value, scu,
+                                   GNC_HOW_RND_ROUND_HALF_UP))
+                return TRUE;
+        }
+        /* Trading account balances are left to xaccTransIsBalanced. */
+        if (use_trading &&
+            (!gnc_commodity_equiv (commodity, currency) ||
+             !gnc_numeric_equal (split->amount, split->value)))
+            return TRUE;
+
+        imbal = gnc_numeric_add (imbal, split->value,
+                                 GNC_DENOM_AUTO, GNC_HOW_DENOM_EXACT);
+    }
+    return !gnc_numeric_zero_p (imbal);
+}
+
+/* Mirrors the conditions acted on by xaccTransScrubCurrency. */
+static gboolean
+trans_needs_currency_scrub (const Transaction *trans, gboolean use_trading)
+{
+    gnc_commodity *currency = trans->common_currency;
+
+    if (!currency || !gnc_commodity_is_currency (currency))
+        return TRUE;
+    return trans_has_orphans (trans, use_trading);
+}
+
+/* Mirrors the conditions acted on by xaccSplitScrub, for a split that
+ * has an account. */
+static gboolean
+split_needs_scrub (const Split *split)
+{
+    gnc_commodity *currency = split->parent->common_currency;
+    gnc_commodity *commodity;
+    int scu;
+
+    if (gnc_numeric_check (split->amount) ||
+        gnc_numeric_check (split->value))
+        return TRUE;
+
+    commodity = xaccAccountGetCommodity (split->acc);
+    if (!commodity)
+        return TRUE;
+    if (!gnc_commodity_equiv (commodity, currency))
+        return FALSE;
+
+    scu = MIN (xaccAccountGetCommoditySCU (split->acc),
+               gnc_commodity_get_fraction (currency));
+    return !gnc_numeric_same (split->amount, split->value, scu,
+                              GNC_HOW_RND_ROUND_HALF_UP);
+}
+
+static gboolean
+trans_has_split_to_scrub (const Transaction *trans, gboolean use_trading)
+{
+    GList *node;
+    for (node = trans->splits; node; node = node->next)
+    {
+        Split *split = node->data;
+        if (trans_has_split (trans, split) && split->acc &&
+            split_needs_scrub (split))
+            return TRUE;
+    }
+    return FALSE;
+}
+
+static gpointer
+scrub_search_thread (gpointer data)
+{
+    ScrubSearch *search = data;
+    guint i;
+
+    for (i = 0; i < search->n_lists; i++)
+    {
+        GList *node;
+        for (node = search->split_lists[i]; node; node = node->next)
+        {
+            Transaction *trans = ((Split*)node->data)->parent;
+            if (abort_now) return NULL;
+            if (trans && search->check (trans, search->use_trading))
+                g_ptr_array_add (search->found, trans);
+        }
+    }
+    return NULL;
+}
+
+/* Returns the transactions of the splits in acc and its descendants
+ * that fail check, each once, in account and split order. */
+static GList *
+scrub_tree_search (Account *acc, TransScrubCheck check)
+{
+    GList *accounts = gnc_account_get_descendants (acc);
+    guint n_accounts, n_threads, n_searches = 0, i, start = 0;
+    guint64 total_splits = 0, taken = 0;
+    GList **split_lists, *node, *retval = NULL;
+    guint *split_counts;
+    ScrubSearch *searches;
+    GThread **threads;
+    GHashTable *seen;
+    gboolean use_trading =
+        qof_book_use_trading_accounts (gnc_account_get_book (acc));
+
+    accounts = g_list_prepend (accounts, acc);
+    n_accounts = g_list_length (accounts);
+    split_lists = g_new (GList*, n_accounts);
+    split_counts = g_new (guint, n_accounts);
+    for (node = accounts, i = 0; node; node = node->next, i++)
+    {
+        split_lists[i] = xaccAccountGetSplitList (node->data);
+        split_counts[i] = g_list_length (split_lists[i]);
+        total_splits += split_counts[i];
+    }
+    g_list_free (accounts);
+
+    n_threads = MIN ((guint64)g_get_num_processors (),
+                     total_splits / SCRUB_SPLITS_PER_THREAD);
+    n_threads = MAX (n_threads, 1);
+    searches = g_new0 (ScrubSearch, n_threads);
+    threads = g_new0 (GThread*, n_threads);
+
+    /* Cut the accounts into runs of about total_splits / n_threads. */
+    for (i = 0; i < n_accounts; i++)
+    {
+        taken += split_counts[i];
+        if (i + 1 < n_accounts &&
+            (n_searches + 1 == n_threads ||
+             taken < total_splits * (n_searches + 1) / n_threads))
+            continue;
+        searches[n_searches].split_lists = split_lists + start;
+        searches[n_searches].n_lists = i + 1 - start;
+        searches[n_searches].check = check;
+        searches[n_searches].use_trading = use_trading;
+        searches[n_searches].found = g_ptr_array_new ();
+        start = i + 1;
+        n_searches++;
+    }
+
+    for (i = 1; i < n_searches; i++)
+        threads[i] = g_thread_new ("scrub_search", scrub_search_thread,
+                                   &searches[i]);
+    if (n_searches)
+        scrub_search_thread (&searches[0]);
+
+    seen = g_hash_table_new (g_direct_hash, g_direct_equal);
+    for (i = 0; i < n_searches; i++)
+    {
+        guint j;
+        if (threads[i])
+            g_thread_join (threads[i]);
+        for (j = 0; j < searches[i].found->len; j++)
+        {
+            gpointer trans = g_ptr_array_index (searches[i].found, j);
+            if (g_hash_table_add (seen, trans))
+                retval = g_list_prepend (retval, trans);
+        }
+        g_ptr_array_free (searches[i].found, TRUE);
+    }
+    g_hash_table_destroy (seen);
+    g_free (threads);
+    g_free (searches);
+    g_free (split_counts);
+    g_free (split_lists);
+
+    return g_list_reverse (retval);
+}
 
 void
 xaccAccountTreeScrubOrphans (Account *acc, QofPercentageFunc percentagefunc)
 {
+    const char *message = _( "Fixing orphans: %u of %u");
+    GList *node, *transactions;
+    guint total, current = 0;
+    Account *root;
+
     if (!acc) return;
 
     if (abort_now)
         (percentagefunc)(NULL, -1.0);
 
     scrub_depth ++;
-    xaccAccountScrubOrphans (acc, percentagefunc);
-    gnc_account_foreach_descendant(acc,
-                                   (AccountCb)xaccAccountScrubOrphans, percentagefunc);
+    root = gnc_account_get_root (acc);
+    transactions = scrub_tree_search (acc, trans_has_orphans);
+    total = g_list_length (transactions);
+    PINFO ("Found %u transactions with orphans", total);
+    for (node = transactions; node; node = node->next)
+    {
+        if (current % 10 == 0)
+        {
+            char *progress_msg = g_strdup_printf (message, current, total);
+            (percentagefunc)(progress_msg, (100 * current) / total);
+            g_free (progress_msg);
+        }
+        if (abort_now) break;
+
+        TransScrubOrphansFast (node->data, root);
+        current++;
+    }
+    g_list_free (transactions);
+    (percentagefunc)(NULL, -1.0);
     scrub_depth--;
 }
 
@@ -201,11 +465,33 @@ xaccTransScrubOrphans (Transaction *trans)
 void
 xaccAccountTreeScrubSplits (Account *account)
 {
+    GList *node, *transactions;
+
     if (!account) return;
 
-    xaccAccountScrubSplits (account);
-    gnc_account_foreach_descendant(account,
-                                   (AccountCb)xaccAccountScrubSplits, NULL);
+    scrub_depth++;
+    transactions = scrub_tree_search (account, trans_has_split_to_scrub);
+    PINFO ("Found %u transactions with splits to scrub",
+           g_list_length (transactions));
+    for (node = transactions; node; node = node->next)
+    {
+        Transaction *trans = node->data;
+        GList *snode;
+        if (abort_now) break;
+
+        /* Only the splits in the tree, as xaccAccountScrubSplits would. */
+        for (snode = trans->splits; snode; snode = snode->next)
+        {
+            Split *split = snode->data;
+            if (split->acc &&
+                (split->acc == account ||
+                 xaccAccountHasAncestor (split->acc, account)) &&
+                split_needs_scrub (split))
+                xaccSplitScrub (split);
+        }
+    }
+    g_list_free (transactions);
+    scrub_depth--;
 }
 
 void
@@ -324,15 +610,39 @@ xaccSplitScrub (Split *split)
 void
 xaccAccountTreeScrubImbalance (Account *acc, QofPercentageFunc percentagefunc)
 {
+    const char *message = _( "Fixing imbalances: %u of %u");
+    GList *node, *transactions;
+    guint total, current = 0;
+    Account *root;
+
     if (!acc) return;
 
     if (abort_now)
         (percentagefunc)(NULL, -1.0);
 
     scrub_depth++;
-    xaccAccountScrubImbalance (acc, percentagefunc);
-    gnc_account_foreach_descendant(acc,
-                                   (AccountCb)xaccAccountScrubImbalance, percentagefunc);
+    root = gnc_account_get_root (acc);
+    transactions = scrub_tree_search (acc, trans_needs_imbalance_scrub);
+    total = g_list_length (transactions);
+    PINFO ("Found %u transactions to check for imbalance", total);
+    for (node = transactions; node; node = node->next)
+    {
+        Transaction *trans = node->data;
+        if (current % 10 == 0)
+        {
+            char *progress_msg = g_strdup_printf (message, current, total);
+            (percentagefunc)(progress_msg, (100 * current) / total);
+            g_free (progress_msg);
+        }
+        if (abort_now) break;
+
+        TransScrubOrphansFast (trans, root);
+        xaccTransScrubCurrency (trans);
+        xaccTransScrubImbalance (trans, root, NULL);
+        current++;
+    }
+    g_list_free (transactions);
+    (percentagefunc)(NULL, -1.0);
     scrub_depth--;
 }
 
@@ -1275,13 +1585,6 @@ xaccAccountDeleteOldData (Account *account)
     xaccAccountCommitEdit (account);
 }
 
-static int
-scrub_trans_currency_helper (Transaction *t, gpointer data)
-{
-    xaccTransScrubCurrency (t);
-    return 0;
-}
-
 static void
 scrub_account_commodity_helper (Account *account, gpointer data)
 {
@@ -1294,9 +1597,19 @@ scrub_account_commodity_helper (Account *account, gpointer data)
 void
 xaccAccountTreeScrubCommodities (Account *acc)
 {
+    GList *node, *transactions;
+
     if (!acc) return;
     scrub_depth++;
-    xaccAccountTreeForEachTransaction (acc, scrub_trans_currency_helper, NULL);
+    transactions = scrub_tree_search (acc, trans_needs_currency_scrub);
+    PINFO ("Found %u transactions to check for currency",
+           g_list_length (transactions));
+    for (node = transactions; node; node = node->next)
+    {
+        if (abort_now) break;
+        xaccTransScrubCurrency (node->data);
+    }
+    g_list_free (transactions);
 
     scrub_account_commodity_helper (acc, NULL);
     gnc_account_foreach_descendant (acc, scrub_account_commodity_helper, NULL);
@@ -1491,4 +1804,141 @@ xaccTransScrubPostedDate (Transaction *trans)
     }
 }
 
+/* ================================================================ */
+/* Transactions changed since the book was last scrubbed in this session.
+ * They're followed through the transaction events; nothing is kept in
+ * the book itself, so a book just loaded is always scrubbed in full the
+ * first time.  An event dropped while events were suspended, as they
+ * are while loading or in an event batch, may have been a change that
+ * wasn't seen, so then the whole tree is scrubbed again too. */
+
+#define SCRUB_CHANGES_KEY "gnc-scrub-changes"
+
+typedef struct
+{
+    GHashTable *changed;
+    /* The book was scrubbed before the changes in the table were made. */
+    gboolean scrubbed;
+    /* qof_event_get_dropped_count() when it was */
+    guint dropped_events;
+} ScrubChanges;
+
+static gint scrub_changes_handler_id = 0;
+
+static void
+scrub_changes_free (QofBook *book, gpointer key, gpointer data)
+{
+    ScrubChanges *changes = data;
+    g_hash_table_destroy (changes->changed);
+    g_free (changes);
+}
+
+static ScrubChanges *
+get_scrub_changes (QofBook *book)
+{
+    ScrubChanges *changes = qof_book_get_data (book, SCRUB_CHANGES_KEY);
+
+    if (changes)
+        return changes;
+
+    changes = g_new0 (ScrubChanges, 1);
+    changes->changed = g_hash_table_new (g_direct_hash, g_direct_equal);
+    qof_book_set_data_fin (book, SCRUB_CHANGES_KEY, changes,
+                           scrub_changes_free);
+    return changes;
+}
+
+/* Only notes the transaction: the book isn't touched while the event is
+ * being handed out. */
+static void
+scrub_changes_handler (QofInstance *ent, QofEventId event_type,
+                       gpointer handler_data, gpointer event_data)
+{
+    ScrubChanges *changes;
+    QofBook *book;
+
+    if (!GNC_IS_TRANSACTION (ent))
+        return;
+    book = qof_instance_get_book (ent);
+    if (!book || qof_book_shutting_down (book))
+        return;
+
+    changes = qof_book_get_data (book, SCRUB_CHANGES_KEY);
+    /* Until its first scrub the whole book will be scrubbed anyway. */
+    if (!changes || !changes->scrubbed)
+        return;
+    if (event_type & QOF_EVENT_DESTROY)
+        g_hash_table_remove (changes->changed, ent);
+    else if (event_type & (QOF_EVENT_CREATE | QOF_EVENT_MODIFY))
+        g_hash_table_add (changes->changed, ent);
+}
+
+void
+xaccScrubTrackChanges (void)
+{
+    if (scrub_changes_handler_id == 0)
+        scrub_changes_handler_id =
+            qof_event_register_handler (scrub_changes_handler, NULL);
+}
+
+void
+xaccBookScrubChanged (QofBook *book, QofPercentageFunc percentagefunc)
+{
+    const char *message = _( "Checking changed transactions: %u of %u");
+    ScrubChanges *changes;
+    Account *root;
+    GList *node, *transactions;
+    guint total, current = 0;
+
+    g_return_if_fail (book);
+
+    xaccScrubTrackChanges ();
+    changes = get_scrub_changes (book);
+    root = gnc_book_get_root_account (book);
+    if (!root) return;
+
+    scrub_depth++;
+    if (!changes->scrubbed ||
+        changes->dropped_events != qof_event_get_dropped_count ())
+    {
+        PINFO ("No complete record of the changes, scrubbing the whole tree");
+        xaccAccountTreeScrubOrphans (root, percentagefunc);
+        xaccAccountTreeScrubSplits (root);
+        xaccAccountTreeScrubImbalance (root, percentagefunc);
+    }
+    else
+    {
+        transactions = g_hash_table_get_keys (changes->changed);
+        total = g_list_length (transactions);
+        PINFO ("Scrubbing %u changed transactions", total);
+        for (node = transactions; node; node = node->next)
+        {
+            Transaction *trans = node->data;
+            if (current % 10 == 0)
+            {
+                char *progress_msg = g_strdup_printf (message, current, total);
+                (percentagefunc)(progress_msg, (100 * current) / total);
+                g_free (progress_msg);
+            }
+            if (abort_now) break;
+
+            xaccTransScrubOrphans (trans);
+            xaccTransScrubSplits (trans);
+            xaccTransScrubImbalance (trans, root, NULL);
+            current++;
+        }
+        g_list_free (transactions);
+        (percentagefunc)(NULL, -1.0);
+    }
+    scrub_depth--;
+
+    if (abort_now)
+        return;
+
+    /* The scrubs' own changes have been seen to already. */
+    g_hash_table_remove_all (changes->changed);
+    changes->scrubbed = TRUE;
+    changes->dropped_events = qof_event_get_dropped_count ();
+}
+
 /* ==================== END OF FILE ==================== */
@@ -122,6 +122,14 @@ void xaccTransScrubImbalance (Transaction *trans, Account *root,
 void xaccAccountScrubImbalance (Account *acc, QofPercentageFunc percentagefunc);
 void xaccAccountTreeScrubImbalance (Account *acc, QofPercentageFunc percentagefunc);
 
+/** The xaccBookScrubChanged() method runs the orphan, split and
+ *    imbalance scrubs over only the transactions created or changed
+ *    since it last ran on the book in this session.  The first run on a
+ *    book scrubs the whole account tree, as does a run after events
+ *    were suspended, since changes made then weren't seen.
+ */
+void xaccBookScrubChanged (QofBook *book, QofPercentageFunc percentagefunc);
+
 /** The xaccTransScrubCurrency method fixes transactions without a
  * common_currency by looking for the most commonly used currency
  * among all the splits in the transaction.  If this fails it falls
@@ -37,5 +37,8 @@ Account * xaccScrubUtilityGetOrMakeAccount (Account *root,
         gnc_commodity * currency, const char *accname,
         GNCAccountType acctype, gboolean placeholder);
 
+/* Start following transaction changes for xaccBookScrubChanged. */
+void xaccScrubTrackChanges (void);
+
 
 #endif /* XACC_SCRUB_P_H */
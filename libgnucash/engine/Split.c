@@ -56,6 +56,8 @@
 #include "gnc-lot.h"
 #include "gnc-event.h"
 #include "qofinstance-p.h"
+#include "qofquerycore-p.h"
+#include "qof-text-index.h"
 
 const char *void_former_amt_str = "void-former-amount";
 const char *void_former_val_str = "void-former-value";
@@ -72,6 +74,12 @@ static QofLogModule log_module = GNC_MOD_ENGINE;
 #define GNC_SX_DEBIT_NUMERIC         "debit-numeric"
 #define GNC_SX_SHARES                "shares"
 
+/* Paths of the slots read by the hot getters below. */
+static const QofKvpPath online_id_path = {1, {"online_id"}};
+static const QofKvpPath gains_split_path = {1, {"gains-split"}};
+static const QofKvpPath gains_source_path = {1, {"gains-source"}};
+static const QofKvpPath split_type_path = {1, {"split-type"}};
+
 enum
 {
     PROP_0,
@@ -202,13 +210,13 @@ gnc_split_get_property(GObject         *object,
             qof_instance_get_kvp (QOF_INSTANCE (split), value, 2, GNC_SX_ID, GNC_SX_SHARES);
             break;
         case PROP_ONLINE_ACCOUNT:
-            qof_instance_get_kvp (QOF_INSTANCE (split), value, 1, "online_id");
+            qof_instance_get_kvp_at (QOF_INSTANCE (split), value, &online_id_path);
             break;
         case PROP_GAINS_SPLIT:
-            qof_instance_get_kvp (QOF_INSTANCE (split), value, 1, "gains-split");
+            qof_instance_get_kvp_at (QOF_INSTANCE (split), value, &gains_split_path);
             break;
         case PROP_GAINS_SOURCE:
-            qof_instance_get_kvp (QOF_INSTANCE (split), value, 1, "gains-source");
+            qof_instance_get_kvp_at (QOF_INSTANCE (split), value, &gains_source_path);
             break;
         default:
             G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
@@ -687,12 +695,87 @@ xaccSplitDump (const Split *split, const char *tag)
 }
 #endif
 
+/********************************************************************\
+ * Memo index
+ * A trigram index of the memos of the splits of a book, for the query
+ * index on SPLIT_MEMO.  It is made when a query first needs it and
+ * then kept up to date as the memos are set, committed or rolled back
+ * and the splits freed.
+\********************************************************************/
+
+#define SPLIT_MEMO_INDEX "gnc-split-memo-index"
+
+static void
+split_memo_index_free (QofBook *book, gpointer key, gpointer data)
+{
+    qof_text_index_destroy (data);
+}
+
+static void
+split_memo_index_add_cb (QofInstance *inst, gpointer data)
+{
+    Split *split = GNC_SPLIT (inst);
+    qof_text_index_set (data, split, split->memo);
+}
+
+/* Return the memo index of the book, making it if needed, or NULL if
+ * the book is being destroyed. */
+static QofTextIndex *
+split_memo_index (QofBook *book)
+{
+    QofTextIndex *index;
+
+    if (!book || qof_book_shutting_down (book))
+        return NULL;
+
+    index = qof_book_get_data (book, SPLIT_MEMO_INDEX);
+    if (!index)
+    {
+        index = qof_text_index_new ();
+        qof_collection_foreach (qof_book_get_collection (book, GNC_ID_SPLIT),
+                                split_memo_index_add_cb, index);
+        qof_book_set_data_fin (book, SPLIT_MEMO_INDEX, index,
+                               split_memo_index_free);
+    }
+    return index;
+}
+
+/* The memo index of the split's book, if it has been made */
+static QofTextIndex *
+split_memo_index_lookup (const Split *split)
+{
+    QofBook *book = qof_instance_get_book (split);
+
+    if (!book || qof_book_shutting_down (book))
+        return NULL;
+    return qof_book_get_data (book, SPLIT_MEMO_INDEX);
+}
+
+void
+xaccSplitTextIndexUpdate (Split *split)
+{
+    QofTextIndex *index = split_memo_index_lookup (split);
+
+    if (index)
+        qof_text_index_set (index, split, split->memo);
+}
+
+static gboolean
+split_query_index_by_memo (QofBook *book, GSList *pred_data,
+                           QofInstanceForeachCB cb, gpointer user_data)
+{
+    QofTextIndex *index = split_memo_index (book);
+    return index && qof_text_index_lookup (index, pred_data, cb, user_data);
+}
+
 /********************************************************************\
 \********************************************************************/
 
 void
 xaccFreeSplit (Split *split)
 {
+    QofTextIndex *memo_index;
+
     if (!split) return;
 
     /* Debug double-free's */
@@ -701,6 +784,9 @@ xaccFreeSplit (Split *split)
         PERR ("double-free %p", split);
         return;
     }
+    memo_index = split_memo_index_lookup (split);
+    if (memo_index)
+        qof_text_index_remove (memo_index, split);
     CACHE_REMOVE(split->memo);
     CACHE_REMOVE(split->action);
 
@@ -726,9 +812,8 @@ xaccFreeSplit (Split *split)
 void mark_split (Split *s)
 {
     if (s->acc)
-    {
-        g_object_set(s->acc, "sort-dirty", TRUE, "balance-dirty", TRUE, NULL);
-    }
+        gnc_account_split_changed (s->acc, s);
+    xaccTransClearImbalanceCache (s->parent);
 
     /* set dirty flag on lot too. */
     if (s->lot) gnc_lot_set_closed_unknown(s->lot);
@@ -957,6 +1042,9 @@ xaccSplitCommitEdit(Split *s)
     if (!qof_instance_is_dirty(QOF_INSTANCE(s)))
         return;
 
+    if (!qof_instance_get_destroying(s))
+        xaccSplitTextIndexUpdate (s);
+
     orig_acc = s->orig_acc;
 
     if (GNC_IS_ACCOUNT(s->acc))
@@ -1017,7 +1105,7 @@ xaccSplitCommitEdit(Split *s)
 
     if (acc)
     {
-        g_object_set(acc, "sort-dirty", TRUE, "balance-dirty", TRUE, NULL);
+        gnc_account_split_changed (acc, s);
         xaccAccountRecomputeBalance(acc);
     }
 }
@@ -1074,8 +1162,7 @@ void
 xaccSplitDetermineGainStatus (Split *split)
 {
     Split *other;
-    GValue v = G_VALUE_INIT;
-    GncGUID *guid = NULL;
+    const GncGUID *guid = NULL;
 
     if (GAINS_STATUS_UNKNOWN != split->gains) return;
 
@@ -1087,9 +1174,7 @@ xaccSplitDetermineGainStatus (Split *split)
         return;
     }
 
-    qof_instance_get_kvp (QOF_INSTANCE (split), &v, 1, "gains-source");
-    if (G_VALUE_HOLDS_BOXED (&v))
-        guid = (GncGUID*)g_value_get_boxed (&v);
+    guid = qof_instance_get_kvp_guid_at (QOF_INSTANCE (split), &gains_source_path);
     if (!guid)
     {
         // CHECKME: We leave split->gains_split alone.  Is that correct?
@@ -1205,6 +1290,7 @@ qofSplitSetAmount (Split *split, gnc_numeric amt)
     {
         split->amount = amt;
     }
+    if (split->lot) gnc_lot_set_closed_unknown (split->lot);
 }
 
 /* The amount of the split in the _account's_ commodity. */
@@ -1240,6 +1326,7 @@ qofSplitSetValue (Split *split, gnc_numeric amt)
     g_return_if_fail(split);
     split->value = gnc_numeric_convert(amt,
                                        get_currency_denom(split), GNC_HOW_RND_ROUND_HALF_UP);
+    xaccTransClearImbalanceCache (split->parent);
     g_assert(gnc_numeric_check (split->value) != GNC_ERROR_OK);
 }
 
@@ -1469,6 +1556,7 @@ xaccSplitDestroy (Split *split)
     ed.idx = xaccTransGetSplitIndex(trans, split);
     qof_instance_set_dirty(QOF_INSTANCE(split));
     qof_instance_set_destroying(split, TRUE);
+    xaccTransClearImbalanceCache (trans);
     qof_event_gen(&trans->inst, GNC_EVENT_ITEM_REMOVED, &ed);
     xaccTransCommitEdit(trans);
 
@@ -1629,25 +1717,18 @@ xaccSplitGetCorrAccountCode(const Split *sa)
     return xaccAccountGetCode(other_split->acc);
 }
 
-/* TODO: It's not too hard to make this function avoid the malloc/free. */
 int
 xaccSplitCompareAccountFullNames(const Split *sa, const Split *sb)
 {
     Account *aa, *ab;
-    char *full_a, *full_b;
-    int retval;
     if (!sa && !sb) return 0;
     if (!sa) return -1;
     if (!sb) return 1;
 
     aa = sa->acc;
     ab = sb->acc;
-    full_a = gnc_account_get_full_name(aa);
-    full_b = gnc_account_get_full_name(ab);
-    retval = g_utf8_collate(full_a, full_b);
-    g_free(full_a);
-    g_free(full_b);
-    return retval;
+    return g_utf8_collate(gnc_account_get_full_name_const(aa),
+                          gnc_account_get_full_name_const(ab));
 }
 
 
@@ -1713,6 +1794,7 @@ xaccSplitSetMemo (Split *split, const char *memo)
     xaccTransBeginEdit (split->parent);
 
     CACHE_REPLACE(split->memo, memo);
+    xaccSplitTextIndexUpdate (split);
     qof_instance_set_dirty(QOF_INSTANCE(split));
     xaccTransCommitEdit(split->parent);
 
@@ -1839,6 +1921,8 @@ xaccSplitSetParent(Split *s, Transaction *t)
         qof_event_gen(&old_trans->inst, GNC_EVENT_ITEM_REMOVED, &ed);
     }
     s->parent = t;
+    xaccTransClearImbalanceCache (old_trans);
+    xaccTransClearImbalanceCache (t);
 
     xaccTransCommitEdit(old_trans);
     qof_instance_set_dirty(QOF_INSTANCE(s));
@@ -1956,13 +2040,10 @@ xaccSplitGetBook (const Split *split)
 const char *
 xaccSplitGetType(const Split *s)
 {
-    GValue v = G_VALUE_INIT;
     const char *split_type = NULL;
 
     if (!s) return NULL;
-    qof_instance_get_kvp (QOF_INSTANCE (s), &v, 1, "split-type");
-    if (G_VALUE_HOLDS_STRING (&v))
-        split_type = g_value_get_string (&v);
+    split_type = qof_instance_get_kvp_string_at (QOF_INSTANCE (s), &split_type_path);
     return split_type ? split_type : "normal";
 }
 
@@ -2233,6 +2314,89 @@ qofSplitSetAccount(Split *s, QofInstance *ent)
     xaccSplitSetAccount(s, acc);
 }
 
+/* Query indexes.  The splits of an account are its own list of them,
+ * kept in date order; those of transactions come from the transaction
+ * indexes. */
+static gboolean
+split_query_index_by_account (QofBook *book, GSList *pred_data,
+                              QofInstanceForeachCB cb, gpointer user_data)
+{
+    query_guid_t pdata = NULL;
+    GList *node, *snode;
+    GSList *pnode;
+
+    /* Every split that matches is in one of the accounts of a
+     * MATCH_ANY term */
+    for (pnode = pred_data; pnode && !pdata; pnode = pnode->next)
+        if (((query_guid_t)pnode->data)->options == QOF_GUID_MATCH_ANY)
+            pdata = pnode->data;
+    if (!pdata)
+        return FALSE;
+
+    for (node = pdata->guids; node; node = node->next)
+    {
+        Account *acc = xaccAccountLookup (node->data, book);
+        if (!acc)
+            continue;
+        for (snode = xaccAccountGetSplitList (acc); snode; snode = snode->next)
+            cb (QOF_INSTANCE (snode->data), user_data);
+    }
+    return TRUE;
+}
+
+typedef struct
+{
+    QofInstanceForeachCB cb;
+    gpointer user_data;
+} SplitQueryIndexData;
+
+static void
+split_query_index_trans_cb (QofInstance *inst, gpointer data)
+{
+    SplitQueryIndexData *sqd = data;
+    GList *node;
+
+    for (node = xaccTransGetSplitList (GNC_TRANSACTION (inst)); node;
+         node = node->next)
+        sqd->cb (QOF_INSTANCE (node->data), sqd->user_data);
+}
+
+static gboolean
+split_query_index_by_date (QofBook *book, GSList *pred_data,
+                           QofInstanceForeachCB cb, gpointer user_data)
+{
+    SplitQueryIndexData sqd = { cb, user_data };
+    return xaccTransQueryIndexByDate (book, pred_data,
+                                      split_query_index_trans_cb, &sqd);
+}
+
+static gboolean
+split_query_index_by_num (QofBook *book, GSList *pred_data,
+                          QofInstanceForeachCB cb, gpointer user_data)
+{
+    SplitQueryIndexData sqd = { cb, user_data };
+    return xaccTransQueryIndexByNum (book, pred_data,
+                                     split_query_index_trans_cb, &sqd);
+}
+
+static gboolean
+split_query_index_by_description (QofBook *book, GSList *pred_data,
+                                  QofInstanceForeachCB cb, gpointer user_data)
+{
+    SplitQueryIndexData sqd = { cb, user_data };
+    return xaccTransQueryIndexByDescription (book, pred_data,
+                                             split_query_index_trans_cb, &sqd);
+}
+
+static gboolean
+split_query_index_by_notes (QofBook *book, GSList *pred_data,
+                            QofInstanceForeachCB cb, gpointer user_data)
+{
+    SplitQueryIndexData sqd = { cb, user_data };
+    return xaccTransQueryIndexByNotes (book, pred_data,
+                                       split_query_index_trans_cb, &sqd);
+}
+
 gboolean xaccSplitRegister (void)
 {
     static const QofParam params[] =
@@ -2325,6 +2489,32 @@ gboolean xaccSplitRegister (void)
         };
 
     qof_class_register (GNC_ID_SPLIT, (QofSortFunc)xaccSplitOrder, params);
+    /* The most selective first, see qof_query_register_index() */
+    qof_query_register_index (GNC_ID_SPLIT,
+                              qof_query_build_param_list (SPLIT_ACCOUNT,
+                                                          QOF_PARAM_GUID, NULL),
+                              split_query_index_by_account);
+    qof_query_register_index (GNC_ID_SPLIT,
+                              qof_query_build_param_list (SPLIT_TRANS,
+                                                          TRANS_NUM, NULL),
+                              split_query_index_by_num);
+    qof_query_register_index (GNC_ID_SPLIT,
+                              qof_query_build_param_list (SPLIT_TRANS,
+                                                          TRANS_DATE_POSTED, NULL),
+                              split_query_index_by_date);
+    /* The text indexes can't answer every string term, so they come
+     * after those that always can. */
+    qof_query_register_index (GNC_ID_SPLIT,
+                              qof_query_build_param_list (SPLIT_MEMO, NULL),
+                              split_query_index_by_memo);
+    qof_query_register_index (GNC_ID_SPLIT,
+                              qof_query_build_param_list (SPLIT_TRANS,
+                                                          TRANS_DESCRIPTION, NULL),
+                              split_query_index_by_description);
+    qof_query_register_index (GNC_ID_SPLIT,
+                              qof_query_build_param_list (SPLIT_TRANS,
+                                                          TRANS_NOTES, NULL),
+                              split_query_index_by_notes);
     qof_class_register (SPLIT_ACCT_FULLNAME,
                         (QofSortFunc)xaccSplitCompareAccountFullNames, NULL);
     qof_class_register (SPLIT_CORR_ACCT_NAME,
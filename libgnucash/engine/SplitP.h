@@ -158,6 +158,10 @@ void xaccSplitUnvoid(Split *split);
 void xaccSplitCommitEdit(Split *s);
 void xaccSplitRollbackEdit(Split *s);
 
+/* Bring the split's entry in the memo index of its book up to date,
+ * if there is one. */
+void xaccSplitTextIndexUpdate (Split *split);
+
 /* Compute the value of a list of splits in the given currency,
  * excluding the skip_me split. */
 gnc_numeric xaccSplitsComputeValue (GList *splits, const Split * skip_me,
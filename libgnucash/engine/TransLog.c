@@ -89,6 +89,159 @@ static FILE * trans_log = NULL; /**< current log file handle */
 static char * trans_log_name = NULL; /**< current log file name */
 static char * log_base_name = NULL;
 
+/* The records are formatted by xaccTransWriteLog into a ring buffer and
+ * written out by a thread of their own, so that a commit doesn't wait
+ * for the disk.  The writer picks them up as soon as they're there,
+ * hands them to the OS right away and syncs the file to the disk at
+ * most every LOG_FSYNC_INTERVAL.  A commit only waits when the ring is
+ * full; records are never dropped. */
+#define LOG_RING_SIZE (256 * 1024)
+#define LOG_FSYNC_INTERVAL G_USEC_PER_SEC
+
+static GMutex log_mutex;
+/* Held by xaccTransWriteLog while it formats and pushes a record.  The
+ * wait for room in log_ring_push releases log_mutex, so that can't keep
+ * the other callers from reusing log_record or pushing their records
+ * into the middle of this one. */
+static GMutex log_record_mutex;
+static GCond log_data_cond;   /**< signalled when there's data to write */
+static GCond log_space_cond;  /**< signalled when there's room in the ring */
+static char * log_ring = NULL;
+static gsize log_ring_start = 0; /**< where the oldest byte is */
+static gsize log_ring_len = 0;   /**< how many bytes are waiting */
+static gboolean log_stopping = FALSE;
+static GThread * log_writer = NULL;
+static GString * log_record = NULL; /**< the record being formatted */
+
+/* Formatting a time is slow compared to the rest, and a transaction's
+ * splits and consecutive records mostly show the same times, so the
+ * last one formatted is remembered. */
+typedef struct
+{
+    gboolean valid;
+    time64 time;
+    char buf[100];
+} LogTimeCache;
+
+static LogTimeCache now_cache, entered_cache, posted_cache, reconciled_cache;
+
+static const char *
+log_format_time (LogTimeCache *cache, time64 t)
+{
+    if (!cache->valid || cache->time != t)
+    {
+        gnc_time64_to_iso8601_buff (t, cache->buf);
+        cache->time = t;
+        cache->valid = TRUE;
+    }
+    return cache->buf;
+}
+
+static void
+log_append_int64 (GString *str, gint64 n)
+{
+    char buf[24];
+    char *p = buf + sizeof (buf);
+    guint64 u = n < 0 ? -(guint64) n : (guint64) n;
+
+    do
+    {
+        *--p = '0' + u % 10;
+        u /= 10;
+    }
+    while (u);
+    if (n < 0)
+        *--p = '-';
+    g_string_append_len (str, p, buf + sizeof (buf) - p);
+}
+
+static inline void
+log_append_field (GString *str, const char *text)
+{
+    if (text)
+        g_string_append (str, text);
+    g_string_append_c (str, '\t');
+}
+
+/* Copy len bytes of data into the ring, waiting for room as need be.
+ * Called with log_record_mutex and log_mutex held. */
+static void
+log_ring_push (const char *data, gsize len)
+{
+    while (len)
+    {
+        gsize end, chunk;
+
+        while (log_ring_len == LOG_RING_SIZE)
+            g_cond_wait (&log_space_cond, &log_mutex);
+
+        end = (log_ring_start + log_ring_len) % LOG_RING_SIZE;
+        chunk = MIN (len, LOG_RING_SIZE - log_ring_len);
+        chunk = MIN (chunk, LOG_RING_SIZE - end);
+        memcpy (log_ring + end, data, chunk);
+        log_ring_len += chunk;
+        data += chunk;
+        len -= chunk;
+        g_cond_signal (&log_data_cond);
+    }
+}
+
+static gpointer
+log_writer_thread (gpointer data)
+{
+    FILE *file = data;
+    char *out = g_malloc (LOG_RING_SIZE);
+    gint64 last_sync = g_get_monotonic_time ();
+    gboolean unsynced = FALSE;
+
+    g_mutex_lock (&log_mutex);
+    while (TRUE)
+    {
+        gsize len, first;
+
+        while (log_ring_len == 0 && !log_stopping)
+        {
+            if (!unsynced)
+                g_cond_wait (&log_data_cond, &log_mutex);
+            else if (!g_cond_wait_until (&log_data_cond, &log_mutex,
+                                         last_sync + LOG_FSYNC_INTERVAL))
+                break;
+        }
+        if (log_ring_len == 0 && log_stopping)
+            break;
+
+        len = log_ring_len;
+        first = MIN (len, LOG_RING_SIZE - log_ring_start);
+        memcpy (out, log_ring + log_ring_start, first);
+        memcpy (out + first, log_ring, len - first);
+        log_ring_start = (log_ring_start + len) % LOG_RING_SIZE;
+        log_ring_len = 0;
+        g_cond_broadcast (&log_space_cond);
+        g_mutex_unlock (&log_mutex);
+
+        if (len)
+        {
+            if (fwrite (out, 1, len, file) != len || fflush (file) != 0)
+                PERR ("Error writing the transaction log: %s",
+                      g_strerror (errno));
+            unsynced = TRUE;
+        }
+        if (unsynced &&
+            g_get_monotonic_time () - last_sync >= LOG_FSYNC_INTERVAL)
+        {
+            g_fsync (fileno (file));
+            last_sync = g_get_monotonic_time ();
+            unsynced = FALSE;
+        }
+
+        g_mutex_lock (&log_mutex);
+    }
+    g_mutex_unlock (&log_mutex);
+
+    g_free (out);
+    return NULL;
+}
+
 /********************************************************************\
 \********************************************************************/
 
@@ -202,6 +355,15 @@ xaccOpenLog (void)
              "notes\tmemo\taction\treconciled\t"
              "amount\tvalue\tdate_reconciled\n");
     fprintf (trans_log, "-----------------\n");
+    fflush (trans_log);
+
+    if (!log_ring)
+        log_ring = g_malloc (LOG_RING_SIZE);
+    if (!log_record)
+        log_record = g_string_sized_new (4096);
+    log_ring_start = log_ring_len = 0;
+    log_stopping = FALSE;
+    log_writer = g_thread_new ("gnc-translog", log_writer_thread, trans_log);
 }
 
 /********************************************************************\
@@ -211,7 +373,17 @@ void
 xaccCloseLog (void)
 {
     if (!trans_log) return;
+
+    /* Let the writer empty the ring before it stops. */
+    g_mutex_lock (&log_mutex);
+    log_stopping = TRUE;
+    g_cond_signal (&log_data_cond);
+    g_mutex_unlock (&log_mutex);
+    g_thread_join (log_writer);
+    log_writer = NULL;
+
     fflush (trans_log);
+    g_fsync (fileno (trans_log));
     fclose (trans_log);
     trans_log = NULL;
 }
@@ -226,7 +398,8 @@ xaccTransWriteLog (Transaction *trans, char flag)
     char trans_guid_str[GUID_ENCODING_LENGTH + 1];
     char split_guid_str[GUID_ENCODING_LENGTH + 1];
     const char *trans_notes;
-    char dnow[100], dent[100], dpost[100], drecn[100];
+    const char *dnow, *dent, *dpost;
+    GString *rec;
 
     if (!gen_logs)
     {
@@ -235,16 +408,21 @@ xaccTransWriteLog (Transaction *trans, char flag)
     }
     if (!trans_log) return;
 
-    gnc_time64_to_iso8601_buff (gnc_time(NULL), dnow);
-    gnc_time64_to_iso8601_buff (trans->date_entered, dent);
-    gnc_time64_to_iso8601_buff (trans->date_posted, dpost);
+    /* One caller at a time formats into the record buffer and the time
+     * caches and pushes its record whole. */
+    g_mutex_lock (&log_record_mutex);
+    rec = log_record;
+    g_string_truncate (rec, 0);
+
+    dnow = log_format_time (&now_cache, gnc_time(NULL));
+    dent = log_format_time (&entered_cache, trans->date_entered);
+    dpost = log_format_time (&posted_cache, trans->date_posted);
     guid_to_string_buff (xaccTransGetGUID(trans), trans_guid_str);
     trans_notes = xaccTransGetNotes(trans);
-    fprintf (trans_log, "===== START\n");
+    g_string_append (rec, "===== START\n");
 
     for (node = trans->splits; node; node = node->next)
     {
-        time64 time;
         Split *split = node->data;
         const char * accname = "";
         char acc_guid_str[GUID_ENCODING_LENGTH + 1];
@@ -261,43 +439,50 @@ xaccTransWriteLog (Transaction *trans, char flag)
             acc_guid_str[0] = '\0';
         }
 
-        gnc_time64_to_iso8601_buff (split->date_reconciled, drecn);
-
         guid_to_string_buff (xaccSplitGetGUID(split), split_guid_str);
         amt = xaccSplitGetAmount (split);
         val = xaccSplitGetValue (split);
 
         /* use tab-separated fields */
-        fprintf (trans_log,
-                 "%c\t%s\t%s\t%s\t%s\t%s\t%s\t%s\t%s\t"
-                 "%s\t%s\t%s\t%s\t%c\t%" G_GINT64_FORMAT "/%" G_GINT64_FORMAT "\t%" G_GINT64_FORMAT "/%" G_GINT64_FORMAT "\t%s\n",
-                 flag,
-                 trans_guid_str, split_guid_str,  /* trans+split make up unique id */
-                 /* Note that the next three strings always exist,
-                 		* so we don't need to test them. */
-                 dnow,
-                 dent,
-                 dpost,
-                 acc_guid_str,
-                 accname ? accname : "",
-                 trans->num ? trans->num : "",
-                 trans->description ? trans->description : "",
-                 trans_notes ? trans_notes : "",
-                 split->memo ? split->memo : "",
-                 split->action ? split->action : "",
-                 split->reconciled,
-                 gnc_numeric_num(amt),
-                 gnc_numeric_denom(amt),
-                 gnc_numeric_num(val),
-                 gnc_numeric_denom(val),
-                 /* The next string always exists. No need to test it. */
-                 drecn);
+        g_string_append_c (rec, flag);
+        g_string_append_c (rec, '\t');
+        log_append_field (rec, trans_guid_str);
+        log_append_field (rec, split_guid_str);  /* trans+split make up unique id */
+        /* Note that the next three strings always exist,
+         * so we don't need to test them. */
+        log_append_field (rec, dnow);
+        log_append_field (rec, dent);
+        log_append_field (rec, dpost);
+        log_append_field (rec, acc_guid_str);
+        log_append_field (rec, accname);
+        log_append_field (rec, trans->num);
+        log_append_field (rec, trans->description);
+        log_append_field (rec, trans_notes);
+        log_append_field (rec, split->memo);
+        log_append_field (rec, split->action);
+        g_string_append_c (rec, split->reconciled);
+        g_string_append_c (rec, '\t');
+        log_append_int64 (rec, gnc_numeric_num(amt));
+        g_string_append_c (rec, '/');
+        log_append_int64 (rec, gnc_numeric_denom(amt));
+        g_string_append_c (rec, '\t');
+        log_append_int64 (rec, gnc_numeric_num(val));
+        g_string_append_c (rec, '/');
+        log_append_int64 (rec, gnc_numeric_denom(val));
+        g_string_append_c (rec, '\t');
+        /* The next string always exists. No need to test it. */
+        g_string_append (rec, log_format_time (&reconciled_cache,
+                                               split->date_reconciled));
+        g_string_append_c (rec, '\n');
     }
 
-    fprintf (trans_log, "===== END\n");
+    g_string_append (rec, "===== END\n");
 
-    /* get data out to the disk */
-    fflush (trans_log);
+    /* hand it to the writer, which gets it out to the disk */
+    g_mutex_lock (&log_mutex);
+    log_ring_push (rec->str, rec->len);
+    g_mutex_unlock (&log_mutex);
+    g_mutex_unlock (&log_record_mutex);
 }
 
 /************************ END OF ************************************\
@@ -34,6 +34,25 @@
     There are some simple command-line tools that will read a log
     and replay it.
 
+    So that logging doesn't slow down every commit, the records are
+    formatted into a bounded in-memory ring and written out by a
+    thread of their own. What this means for recovery:
+
+    - A record is complete before it goes into the ring and the
+      writer only ever appends, so the log holds the records in
+      commit order. Only the last one can be cut short, as before.
+    - The writer hands every record to the operating system as soon
+      as it is in the ring. If GnuCash itself crashes, only the
+      records still in the ring at that moment are lost, normally
+      none or the last few.
+    - The file is synced to the disk at most a second after a write,
+      and when the log is closed. If the system crashes or loses
+      power, up to about a second of records may be lost.
+    - A commit waits, rather than losing records, while the ring is
+      full because the disk can't keep up.
+    - xaccCloseLog(), which gnc_engine_shutdown() calls, writes out
+      everything before it returns.
+
     @{ */
 /** @file TransLog.h
     @brief API for the transaction logger
@@ -47,6 +66,8 @@
 #include "Transaction.h"
 
 void    xaccOpenLog (void);
+/** Close the log, first writing out and syncing every record that
+ *  was passed to xaccTransWriteLog(). */
 void    xaccCloseLog (void);
 void    xaccReopenLog (void);
 
@@ -43,6 +43,7 @@
 
 #include "AccountP.h"
 #include "Scrub.h"
+#include "ScrubP.h"
 #include "Scrub3.h"
 #include "TransactionP.h"
 #include "SplitP.h"
@@ -56,6 +57,8 @@
 #include "SchedXaction.h"
 #include "gncBusiness.h"
 #include <qofinstance-p.h>
+#include "qofquerycore-p.h"
+#include "qof-text-index.h"
 #include "gncInvoice.h"
 #include "gncOwner.h"
 
@@ -184,6 +187,16 @@ const char *doclink_uri_str = "assoc_uri"; // this is the old name for the docum
 #define TRANS_REVERSED_BY        "reversed-by"
 #define GNC_SX_FROM              "from-sched-xaction"
 
+/* Paths of the slots read by the hot getters below. */
+static const QofKvpPath notes_path = {1, {"notes"}};
+static const QofKvpPath doclink_path = {1, {"assoc_uri"}};
+static const QofKvpPath void_reason_path = {1, {"void-reason"}};
+static const QofKvpPath void_time_path = {1, {"void-time"}};
+static const QofKvpPath date_posted_path = {1, {TRANS_DATE_POSTED}};
+static const QofKvpPath date_due_path = {1, {TRANS_DATE_DUE_KVP}};
+static const QofKvpPath txn_type_path = {1, {TRANS_TXN_TYPE_KVP}};
+static const QofKvpPath read_only_path = {1, {TRANS_READ_ONLY_REASON}};
+
 #define ISO_DATELENGTH 32 /* length of an iso 8601 date string. */
 
 /* This static indicates the debugging module that this .o belongs to.  */
@@ -274,6 +287,8 @@ gnc_transaction_init(Transaction* trans)
     trans->readonly_reason = NULL;
     trans->reason_cache_valid = FALSE;
     trans->isClosingTxn_cached = -1;
+    trans->cached_imbalance = gnc_numeric_zero ();
+    trans->imbalance_cache_valid = FALSE;
     LEAVE (" ");
 }
 
@@ -391,16 +406,29 @@ gnc_transaction_set_property(GObject* object,
     }
 }
 
+static void
+gnc_transaction_add_memory_usage(const QofInstance* inst, QofMemoryUsage* usage)
+{
+    const Transaction* trans = GNC_TRANSACTION(inst);
+
+    qof_memory_usage_add_list(usage, trans->splits);
+    if (trans->readonly_reason)
+        usage->other_bytes += strlen(trans->readonly_reason) + 1;
+}
+
 static void
 gnc_transaction_class_init(TransactionClass* klass)
 {
     GObjectClass* gobject_class = G_OBJECT_CLASS(klass);
+    QofInstanceClass* qof_class = QOF_INSTANCE_CLASS(klass);
 
     gobject_class->dispose = gnc_transaction_dispose;
     gobject_class->finalize = gnc_transaction_finalize;
     gobject_class->set_property = gnc_transaction_set_property;
     gobject_class->get_property = gnc_transaction_get_property;
 
+    qof_class->add_memory_usage = gnc_transaction_add_memory_usage;
+
     g_object_class_install_property
     (gobject_class,
      PROP_NUM,
@@ -485,6 +513,390 @@ gnc_transaction_class_init(TransactionClass* klass)
                           G_PARAM_READWRITE));
 }
 
+/********************************************************************\
+ * Query indexes
+ * Book-wide indexes of the transactions by date posted and by number,
+ * used by the query indexes registered in xaccTransRegister and by the
+ * split ones built on them.  They're made when a query first needs
+ * them and thrown away whenever a transaction is created, committed,
+ * rolled back or freed or its date posted or number is set.
+\********************************************************************/
+
+typedef struct
+{
+    GPtrArray *by_date;         /* Transaction*, sorted by date posted */
+    GHashTable *by_num;         /* number -> GList of Transaction* */
+} TransQueryIndex;
+
+#define TRANS_QUERY_INDEX "gnc-trans-query-index"
+
+static void
+trans_query_index_clear (TransQueryIndex *index)
+{
+    if (index->by_date)
+        g_ptr_array_free (index->by_date, TRUE);
+    index->by_date = NULL;
+    if (index->by_num)
+        g_hash_table_destroy (index->by_num);
+    index->by_num = NULL;
+}
+
+static void
+trans_query_index_free (QofBook *book, gpointer key, gpointer data)
+{
+    trans_query_index_clear (data);
+    g_free (data);
+}
+
+/* Return the index of the book, creating it if needed, or NULL if the
+ * book is being destroyed.  The caller holds the engine's cache lock,
+ * as concurrent readers may create and fill the index at the same time;
+ * only the writer clears it. */
+static TransQueryIndex *
+trans_query_index (QofBook *book)
+{
+    TransQueryIndex *index;
+
+    if (!book || qof_book_shutting_down (book))
+        return NULL;
+
+    index = qof_book_get_data (book, TRANS_QUERY_INDEX);
+    if (!index)
+    {
+        index = g_new0 (TransQueryIndex, 1);
+        qof_book_set_data_fin (book, TRANS_QUERY_INDEX, index,
+                               trans_query_index_free);
+    }
+    return index;
+}
+
+static void
+trans_query_index_invalidate (const Transaction *trans)
+{
+    QofBook *book = qof_instance_get_book (trans);
+    TransQueryIndex *index;
+
+    if (!book || qof_book_shutting_down (book))
+        return;
+    index = qof_book_get_data (book, TRANS_QUERY_INDEX);
+    if (index)
+        trans_query_index_clear (index);
+}
+
+static void
+trans_query_index_add_cb (QofInstance *inst, gpointer data)
+{
+    g_ptr_array_add (data, inst);
+}
+
+static gint
+trans_query_index_date_cmp (gconstpointer a, gconstpointer b)
+{
+    const Transaction *ta = *(Transaction * const *)a;
+    const Transaction *tb = *(Transaction * const *)b;
+
+    if (ta->date_posted < tb->date_posted) return -1;
+    if (ta->date_posted > tb->date_posted) return 1;
+    return 0;
+}
+
+static void
+trans_query_index_num_cb (QofInstance *inst, gpointer data)
+{
+    Transaction *trans = GNC_TRANSACTION (inst);
+    const char *num = trans->num ? trans->num : "";
+    GList *list = g_hash_table_lookup (data, num);
+
+    /* Keep the head, it's the value in the table */
+    if (list)
+        g_list_insert (list, trans, 1);
+    else
+        g_hash_table_insert (data, g_strdup (num),
+                             g_list_prepend (NULL, trans));
+}
+
+/* Narrow [*min, *max] down to the dates posted that can satisfy pd.
+ * Day matches compare the days, so their bounds cover the whole day. */
+static void
+trans_query_date_bounds (const QofQueryPredData *pd, time64 *min, time64 *max)
+{
+    const query_date_t pdata = (const query_date_t)pd;
+    time64 lo = pdata->date, hi = pdata->date;
+
+    if (pdata->options == QOF_DATE_MATCH_DAY)
+    {
+        lo = gnc_time64_get_day_start (pdata->date);
+        hi = gnc_time64_get_day_end (pdata->date);
+    }
+
+    switch (pd->how)
+    {
+    case QOF_COMPARE_LT:
+    case QOF_COMPARE_LTE:
+        *max = MIN (*max, hi);
+        break;
+    case QOF_COMPARE_GT:
+    case QOF_COMPARE_GTE:
+        *min = MAX (*min, lo);
+        break;
+    case QOF_COMPARE_EQUAL:
+        *min = MAX (*min, lo);
+        *max = MIN (*max, hi);
+        break;
+    default:
+        break;
+    }
+}
+
+gboolean
+xaccTransQueryIndexByDate (QofBook *book, GSList *pred_data,
+                           QofInstanceForeachCB cb, gpointer user_data)
+{
+    TransQueryIndex *index;
+    time64 min = G_MININT64, max = G_MAXINT64;
+    guint lo, hi, i;
+    GSList *node;
+    GPtrArray *by_date;
+
+    for (node = pred_data; node; node = node->next)
+    {
+        const QofQueryPredData *pd = node->data;
+        if (g_strcmp0 (pd->type_name, QOF_TYPE_DATE))
+            return FALSE;
+        trans_query_date_bounds (pd, &min, &max);
+    }
+
+    qof_engine_cache_lock ();
+    index = trans_query_index (book);
+    if (index && min <= max && !index->by_date)
+    {
+        QofCollection *col = qof_book_get_collection (book, GNC_ID_TRANS);
+        by_date = g_ptr_array_sized_new (qof_collection_count (col));
+        qof_collection_foreach (col, trans_query_index_add_cb, by_date);
+        g_ptr_array_sort (by_date, trans_query_index_date_cmp);
+        index->by_date = by_date;
+    }
+    by_date = index ? index->by_date : NULL;
+    qof_engine_cache_unlock ();
+    if (!index)
+        return FALSE;
+    if (min > max)
+        return TRUE;
+
+    /* Find the first transaction posted on or after min */
+    lo = 0;
+    hi = by_date->len;
+    while (lo < hi)
+    {
+        guint mid = lo + (hi - lo) / 2;
+        Transaction *trans = g_ptr_array_index (by_date, mid);
+        if (trans->date_posted < min)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    for (i = lo; i < by_date->len; i++)
+    {
+        Transaction *trans = g_ptr_array_index (by_date, i);
+        if (trans->date_posted > max)
+            break;
+        cb (QOF_INSTANCE (trans), user_data);
+    }
+    return TRUE;
+}
+
+static gboolean trans_text_index_query (QofBook *book, const char *param,
+                                        GSList *pred_data,
+                                        QofInstanceForeachCB cb,
+                                        gpointer user_data);
+
+gboolean
+xaccTransQueryIndexByNum (QofBook *book, GSList *pred_data,
+                          QofInstanceForeachCB cb, gpointer user_data)
+{
+    TransQueryIndex *index;
+    GHashTable *by_num;
+    const char *num = NULL;
+    GSList *node;
+    GList *list;
+
+    /* Only a case sensitive match of the whole number can be looked up
+     * here, the text index has the rest. */
+    for (node = pred_data; node && !num; node = node->next)
+    {
+        const query_string_t pdata = node->data;
+        if (!g_strcmp0 (pdata->pd.type_name, QOF_TYPE_STRING) &&
+            pdata->pd.how == QOF_COMPARE_EQUAL &&
+            pdata->options == QOF_STRING_MATCH_NORMAL && !pdata->is_regex)
+            num = pdata->matchstring;
+    }
+    if (!num)
+        return trans_text_index_query (book, TRANS_NUM, pred_data,
+                                       cb, user_data);
+
+    qof_engine_cache_lock ();
+    index = trans_query_index (book);
+    if (index && !index->by_num)
+    {
+        QofCollection *col = qof_book_get_collection (book, GNC_ID_TRANS);
+        by_num = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+                                        (GDestroyNotify)g_list_free);
+        qof_collection_foreach (col, trans_query_index_num_cb, by_num);
+        index->by_num = by_num;
+    }
+    by_num = index ? index->by_num : NULL;
+    qof_engine_cache_unlock ();
+    if (!by_num)
+        return FALSE;
+
+    for (list = g_hash_table_lookup (by_num, num); list; list = list->next)
+        cb (QOF_INSTANCE (list->data), user_data);
+    return TRUE;
+}
+
+/********************************************************************\
+ * Text indexes
+ * Trigram indexes of the descriptions, notes and numbers of the
+ * transactions of a book, for the string terms of searches like those
+ * of the Find Transaction dialog.  They are made when a query first
+ * needs them, but unlike the indexes above they aren't thrown away on
+ * every commit: they are kept up to date as the strings are set,
+ * committed or rolled back and the transactions freed.
+\********************************************************************/
+
+typedef struct
+{
+    QofTextIndex *description;
+    QofTextIndex *notes;
+    QofTextIndex *num;
+} TransTextIndex;
+
+#define TRANS_TEXT_INDEX "gnc-trans-text-index"
+
+static void
+trans_text_index_free (QofBook *book, gpointer key, gpointer data)
+{
+    TransTextIndex *index = data;
+
+    qof_text_index_destroy (index->description);
+    qof_text_index_destroy (index->notes);
+    qof_text_index_destroy (index->num);
+    g_free (index);
+}
+
+static void
+trans_text_index_set (TransTextIndex *index, Transaction *trans)
+{
+    qof_text_index_set (index->description, trans, trans->description);
+    qof_text_index_set (index->notes, trans, xaccTransGetNotes (trans));
+    qof_text_index_set (index->num, trans, trans->num);
+}
+
+static void
+trans_text_index_add_cb (QofInstance *inst, gpointer data)
+{
+    trans_text_index_set (data, GNC_TRANSACTION (inst));
+}
+
+/* Return the text indexes of the book, making them if needed, or NULL
+ * if the book is being destroyed. */
+static TransTextIndex *
+trans_text_index (QofBook *book)
+{
+    TransTextIndex *index;
+
+    if (!book || qof_book_shutting_down (book))
+        return NULL;
+
+    index = qof_book_get_data (book, TRANS_TEXT_INDEX);
+    if (!index)
+    {
+        index = g_new0 (TransTextIndex, 1);
+        index->description = qof_text_index_new ();
+        index->notes = qof_text_index_new ();
+        index->num = qof_text_index_new ();
+        qof_collection_foreach (qof_book_get_collection (book, GNC_ID_TRANS),
+                                trans_text_index_add_cb, index);
+        qof_book_set_data_fin (book, TRANS_TEXT_INDEX, index,
+                               trans_text_index_free);
+    }
+    return index;
+}
+
+/* The text indexes of the transaction's book, if they have been made */
+static TransTextIndex *
+trans_text_index_of (const Transaction *trans)
+{
+    QofBook *book = qof_instance_get_book (trans);
+
+    if (!book || qof_book_shutting_down (book))
+        return NULL;
+    return qof_book_get_data (book, TRANS_TEXT_INDEX);
+}
+
+static void
+trans_text_index_update (Transaction *trans)
+{
+    TransTextIndex *index = trans_text_index_of (trans);
+
+    if (index)
+        trans_text_index_set (index, trans);
+}
+
+static void
+trans_text_index_remove (Transaction *trans)
+{
+    TransTextIndex *index = trans_text_index_of (trans);
+
+    if (!index)
+        return;
+    qof_text_index_remove (index->description, trans);
+    qof_text_index_remove (index->notes, trans);
+    qof_text_index_remove (index->num, trans);
+}
+
+static gboolean
+trans_text_index_query (QofBook *book, const char *param,
+                        GSList *pred_data, QofInstanceForeachCB cb,
+                        gpointer user_data)
+{
+    TransTextIndex *index;
+    QofTextIndex *text_index;
+
+    /* Concurrent readers may make the indexes at the same time. */
+    qof_engine_cache_lock ();
+    index = trans_text_index (book);
+    qof_engine_cache_unlock ();
+    if (!index)
+        return FALSE;
+
+    if (!g_strcmp0 (param, TRANS_DESCRIPTION))
+        text_index = index->description;
+    else if (!g_strcmp0 (param, TRANS_NOTES))
+        text_index = index->notes;
+    else
+        text_index = index->num;
+
+    return qof_text_index_lookup (text_index, pred_data, cb, user_data);
+}
+
+gboolean
+xaccTransQueryIndexByDescription (QofBook *book, GSList *pred_data,
+                                  QofInstanceForeachCB cb, gpointer user_data)
+{
+    return trans_text_index_query (book, TRANS_DESCRIPTION, pred_data,
+                                   cb, user_data);
+}
+
+gboolean
+xaccTransQueryIndexByNotes (QofBook *book, GSList *pred_data,
+                            QofInstanceForeachCB cb, gpointer user_data)
+{
+    return trans_text_index_query (book, TRANS_NOTES, pred_data,
+                                   cb, user_data);
+}
+
 /********************************************************************\
  * xaccInitTransaction
  * Initialize a transaction structure
@@ -495,6 +907,8 @@ xaccInitTransaction (Transaction * trans, QofBook *book)
 {
     ENTER ("trans=%p", trans);
     qof_instance_init_data (&trans->inst, GNC_ID_TRANS, book);
+    trans_query_index_invalidate (trans);
+    xaccScrubTrackChanges ();
     LEAVE (" ");
 }
 
@@ -761,6 +1175,7 @@ xaccTransCopyFromClipBoard(const Transaction *from_trans, Transaction *to_trans,
     FOR_EACH_SPLIT(to_trans, xaccSplitDestroy(s));
     g_list_free(to_trans->splits);
     to_trans->splits = NULL;
+    xaccTransClearImbalanceCache (to_trans);
 
     xaccTransSetCurrency(to_trans, xaccTransGetCurrency(from_trans));
     xaccTransSetDescription(to_trans, xaccTransGetDescription(from_trans));
@@ -806,6 +1221,10 @@ xaccFreeTransaction (Transaction *trans)
         LEAVE (" ");
         return;
     }
+    trans_text_index_remove (trans);
+    /* The destroy event handlers may have run queries that rebuilt the
+     * query indexes with this transaction still in them. */
+    trans_query_index_invalidate (trans);
 
     /* free up the destination splits */
     for (node = trans->splits; node; node = node->next)
@@ -1045,6 +1464,7 @@ xaccTransGetImbalanceValue (const Transaction * trans)
 {
     gnc_numeric imbal = gnc_numeric_zero();
     if (!trans) return imbal;
+    if (trans->imbalance_cache_valid) return trans->cached_imbalance;
 
     ENTER("(trans=%p)", trans);
     /* Could use xaccSplitsComputeValue, except that we want to use
@@ -1052,10 +1472,18 @@ xaccTransGetImbalanceValue (const Transaction * trans)
     FOR_EACH_SPLIT(trans, imbal =
                        gnc_numeric_add(imbal, xaccSplitGetValue(s),
                                        GNC_DENOM_AUTO, GNC_HOW_DENOM_EXACT));
+    ((Transaction*)trans)->cached_imbalance = imbal;
+    ((Transaction*)trans)->imbalance_cache_valid = TRUE;
     LEAVE("(trans=%p) imbal=%s", trans, gnc_num_dbg_to_string(imbal));
     return imbal;
 }
 
+void
+xaccTransClearImbalanceCache (Transaction *trans)
+{
+    if (trans) trans->imbalance_cache_valid = FALSE;
+}
+
 MonetaryList *
 xaccTransGetImbalance (const Transaction * trans)
 {
@@ -1073,6 +1501,18 @@ xaccTransGetImbalance (const Transaction * trans)
 
     trading_accts = xaccTransUseTradingAccounts (trans);
 
+    /* Without trading accounts the imbalance is just the value imbalance. */
+    if (!trading_accts)
+    {
+        imbal_value = xaccTransGetImbalanceValue (trans);
+        if (!gnc_numeric_zero_p (imbal_value))
+            imbal_list = gnc_monetary_list_add_value (imbal_list,
+                                                      trans->common_currency,
+                                                      imbal_value);
+        LEAVE("(trans=%p), imbal=%p", trans, imbal_list);
+        return imbal_list;
+    }
+
     /* If using trading accounts and there is at least one split that is not
        in the transaction currency or a split that has a price or exchange
        rate other than 1, then compute the balance in each commodity in the
@@ -1419,6 +1859,7 @@ xaccTransSetCurrency (Transaction *trans, gnc_commodity *curr)
     xaccTransBeginEdit(trans);
 
     trans->common_currency = curr;
+    xaccTransClearImbalanceCache (trans);
     if (old_curr != NULL && trans->splits != NULL)
     {
         gnc_numeric rate = find_new_rate(trans, curr);
@@ -1651,6 +2092,12 @@ xaccTransCommitEdit (Transaction *trans)
         return;
     }
 
+    QOF_TIMER_START (commit, "transaction.commit-edit");
+    QOF_TRACE_BEGIN (commit);
+    xaccTransClearImbalanceCache (trans);
+    trans_query_index_invalidate (trans);
+    trans_text_index_update (trans);
+
     /* We increment this for the duration of the call
      * so other functions don't result in a recursive
      * call to xaccTransCommitEdit. */
@@ -1700,6 +2147,8 @@ xaccTransCommitEdit (Transaction *trans)
                           trans_on_error,
                           (void (*) (QofInstance *)) trans_cleanup_commit,
                           (void (*) (QofInstance *)) do_destroy);
+    QOF_TRACE_END (commit, "engine", "xaccTransCommitEdit");
+    QOF_TIMER_STOP (commit);
     LEAVE ("(trans=%p)", trans);
 }
 
@@ -1746,8 +2195,10 @@ xaccTransRollbackEdit (Transaction *trans)
     SWAP(trans->description, orig->description);
     trans->date_entered = orig->date_entered;
     trans->date_posted = orig->date_posted;
+    trans_query_index_invalidate (trans);
     SWAP(trans->common_currency, orig->common_currency);
     qof_instance_swap_kvp (QOF_INSTANCE (trans), QOF_INSTANCE (orig));
+    trans_text_index_update (trans);
 
     /* The splits at the front of trans->splits are exactly the same
        splits as in the original, but some of them may have changed, so
@@ -1772,11 +2223,14 @@ xaccTransRollbackEdit (Transaction *trans)
             xaccSplitRollbackEdit(s);
             SWAP(s->action, so->action);
             SWAP(s->memo, so->memo);
+            xaccSplitTextIndexUpdate (s);
 	    qof_instance_copy_kvp (QOF_INSTANCE (s), QOF_INSTANCE (so));
             s->reconciled = so->reconciled;
             s->amount = so->amount;
             s->value = so->value;
             s->lot = so->lot;
+            /* The lot may have cached the abandoned amount. */
+            if (s->lot) gnc_lot_set_closed_unknown (s->lot);
             s->gains_split = so->gains_split;
             //SET_GAINS_A_VDIRTY(s);
             s->date_reconciled = so->date_reconciled;
@@ -1810,6 +2264,7 @@ xaccTransRollbackEdit (Transaction *trans)
     g_list_free(slist);
     g_list_free(orig->splits);
     orig->splits = NULL;
+    xaccTransClearImbalanceCache (trans);
 
     /* Now that the engine copy is back to its original version,
      * get the backend to fix it in the database */
@@ -1954,6 +2409,7 @@ xaccTransSetDateInternal(Transaction *trans, time64 *dadate, time64 val)
     }
 #endif
     *dadate = val;
+    trans_query_index_invalidate (trans);
     qof_instance_set_dirty(QOF_INSTANCE(trans));
     mark_trans(trans);
     xaccTransCommitEdit(trans);
@@ -2131,6 +2587,8 @@ xaccTransSetNum (Transaction *trans, const char *xnum)
     xaccTransBeginEdit(trans);
 
     CACHE_REPLACE(trans->num, xnum);
+    trans_query_index_invalidate (trans);
+    trans_text_index_update (trans);
     qof_instance_set_dirty(QOF_INSTANCE(trans));
     mark_trans(trans);  /* Dirty balance of every account in trans */
     xaccTransCommitEdit(trans);
@@ -2151,6 +2609,7 @@ xaccTransSetDescription (Transaction *trans, const char *desc)
     xaccTransBeginEdit(trans);
 
     CACHE_REPLACE(trans->description, desc);
+    trans_text_index_update (trans);
     qof_instance_set_dirty(QOF_INSTANCE(trans));
     xaccTransCommitEdit(trans);
 }
@@ -2191,6 +2650,7 @@ xaccTransSetNotes (Transaction *trans, const char *notes)
     xaccTransBeginEdit(trans);
 
     qof_instance_set_kvp (QOF_INSTANCE (trans), &v, 1, trans_notes_str);
+    trans_text_index_update (trans);
     qof_instance_set_dirty(QOF_INSTANCE(trans));
     xaccTransCommitEdit(trans);
 }
@@ -2349,23 +2809,15 @@ xaccTransGetDescription (const Transaction *trans)
 const char *
 xaccTransGetDocLink (const Transaction *trans)
 {
-    GValue v = G_VALUE_INIT;
     if (!trans) return NULL;
-    qof_instance_get_kvp (QOF_INSTANCE (trans), &v, 1, doclink_uri_str);
-    if (G_VALUE_HOLDS_STRING (&v))
-         return g_value_get_string (&v);
-    return NULL;
+    return qof_instance_get_kvp_string_at (QOF_INSTANCE (trans), &doclink_path);
 }
 
 const char *
 xaccTransGetNotes (const Transaction *trans)
 {
-    GValue v = G_VALUE_INIT;
     if (!trans) return NULL;
-    qof_instance_get_kvp (QOF_INSTANCE (trans), &v, 1, trans_notes_str);
-    if (G_VALUE_HOLDS_STRING (&v))
-         return g_value_get_string (&v);
-    return NULL;
+    return qof_instance_get_kvp_string_at (QOF_INSTANCE (trans), &notes_path);
 }
 
 gboolean
@@ -2421,9 +2873,12 @@ xaccTransGetDatePostedGDate (const Transaction *trans)
          * from there because it doesn't suffer from time zone
          * shifts. */
         GValue v = G_VALUE_INIT;
-        qof_instance_get_kvp (QOF_INSTANCE (trans), &v, 1, TRANS_DATE_POSTED);
+        qof_instance_get_kvp_at (QOF_INSTANCE (trans), &v, &date_posted_path);
         if (G_VALUE_HOLDS_BOXED (&v))
+        {
              result = *(GDate*)g_value_get_boxed (&v);
+             g_value_unset (&v);
+        }
         if (! g_date_valid (&result) || gdate_to_time64 (result) == INT64_MAX)
         {
              /* Well, this txn doesn't have a valid GDate saved in a slot.
@@ -2456,7 +2911,7 @@ xaccTransRetDateDue(const Transaction *trans)
     time64 ret = 0;
     GValue v = G_VALUE_INIT;
     if (!trans) return 0;
-    qof_instance_get_kvp (QOF_INSTANCE (trans), &v, 1, TRANS_DATE_DUE_KVP);
+    qof_instance_get_kvp_at (QOF_INSTANCE (trans), &v, &date_due_path);
     if (G_VALUE_HOLDS_BOXED (&v))
     {
         ret = ((Time64*)g_value_get_boxed (&v))->t;
@@ -2471,12 +2926,9 @@ char
 xaccTransGetTxnType (const Transaction *trans)
 {
     const char *s = NULL;
-    GValue v = G_VALUE_INIT;
 
     if (!trans) return TXN_TYPE_NONE;
-    qof_instance_get_kvp (QOF_INSTANCE (trans), &v, 1, TRANS_TXN_TYPE_KVP);
-    if (G_VALUE_HOLDS_STRING (&v))
-         s = g_value_get_string (&v);
+    s = qof_instance_get_kvp_string_at (QOF_INSTANCE (trans), &txn_type_path);
     if (s && strlen (s) == 1)
         return *s;
 
@@ -2491,19 +2943,13 @@ xaccTransGetReadOnly (Transaction *trans)
 
     if (!trans->reason_cache_valid)
     {
-        GValue v = G_VALUE_INIT;
-        qof_instance_get_kvp (QOF_INSTANCE(trans), &v, 1, TRANS_READ_ONLY_REASON);
-
         /* Clear possible old cache value first */
         g_free (trans->readonly_reason);
-        trans->readonly_reason = NULL;
 
         /* Then set the new one */
-        if (G_VALUE_HOLDS_STRING (&v))
-        {
-            trans->readonly_reason = g_value_dup_string (&v);
-            g_value_unset (&v);
-        }
+        trans->readonly_reason =
+            g_strdup (qof_instance_get_kvp_string_at (QOF_INSTANCE (trans),
+                                                      &read_only_path));
         trans->reason_cache_valid = TRUE;
     }
     return trans->readonly_reason;
@@ -2724,38 +3170,28 @@ gboolean
 xaccTransGetVoidStatus(const Transaction *trans)
 {
     const char *s = NULL;
-    GValue v = G_VALUE_INIT;
     g_return_val_if_fail(trans, FALSE);
 
-    qof_instance_get_kvp (QOF_INSTANCE (trans), &v, 1, void_reason_str);
-    if (G_VALUE_HOLDS_STRING (&v))
-         s = g_value_get_string (&v);
+    s = qof_instance_get_kvp_string_at (QOF_INSTANCE (trans), &void_reason_path);
     return s && strlen(s);
 }
 
 const char *
 xaccTransGetVoidReason(const Transaction *trans)
 {
-    GValue v = G_VALUE_INIT;
     g_return_val_if_fail(trans, FALSE);
 
-    qof_instance_get_kvp (QOF_INSTANCE (trans), &v, 1, void_reason_str);
-    if (G_VALUE_HOLDS_STRING (&v))
-         return g_value_get_string (&v);
-    return NULL;
+    return qof_instance_get_kvp_string_at (QOF_INSTANCE (trans), &void_reason_path);
 }
 
 time64
 xaccTransGetVoidTime(const Transaction *tr)
 {
-    GValue v = G_VALUE_INIT;
     const char *s = NULL;
     time64 void_time = 0;
 
     g_return_val_if_fail(tr, void_time);
-    qof_instance_get_kvp (QOF_INSTANCE (tr), &v, 1, void_time_str);
-    if (G_VALUE_HOLDS_STRING (&v))
-        s = g_value_get_string (&v);
+    s = qof_instance_get_kvp_string_at (QOF_INSTANCE (tr), &void_time_path);
     if (s)
         return gnc_iso8601_to_time64_gmt (s);
     return void_time;
@@ -2944,14 +3380,19 @@ xaccTransFindSplitByAccount(const Transaction *trans, const Account *acc)
 /* QofObject function implementation */
 
 static void
-destroy_tx_on_book_close(QofInstance *ent, gpointer data)
+free_tx_on_book_close(QofInstance *ent, gpointer data)
 {
     Transaction* tx = GNC_TRANSACTION(ent);
 
-    xaccTransDestroy(tx);
+    xaccFreeTransaction(tx);
 }
 
 /** Handles book end - frees all transactions from the book
+ *
+ * The whole book is going away: the accounts have already let go of
+ * their splits and the lots won't look at theirs, so the transactions
+ * and splits are freed without the edit cycle, events, balance updates
+ * or backend commits that xaccTransDestroy would cost.
  *
  * @param book Book being closed
  */
@@ -2961,7 +3402,7 @@ gnc_transaction_book_end(QofBook* book)
     QofCollection *col;
 
     col = qof_book_get_collection(book, GNC_ID_TRANS);
-    qof_collection_foreach(col, destroy_tx_on_book_close, NULL);
+    qof_collection_foreach(col, free_tx_on_book_close, NULL);
 }
 
 #ifdef _MSC_VER
@@ -3078,6 +3519,18 @@ gboolean xaccTransRegister (void)
         };
 
     qof_class_register (GNC_ID_TRANS, (QofSortFunc)xaccTransOrder, params);
+    qof_query_register_index (GNC_ID_TRANS,
+                              qof_query_build_param_list (TRANS_DATE_POSTED, NULL),
+                              xaccTransQueryIndexByDate);
+    qof_query_register_index (GNC_ID_TRANS,
+                              qof_query_build_param_list (TRANS_NUM, NULL),
+                              xaccTransQueryIndexByNum);
+    qof_query_register_index (GNC_ID_TRANS,
+                              qof_query_build_param_list (TRANS_DESCRIPTION, NULL),
+                              xaccTransQueryIndexByDescription);
+    qof_query_register_index (GNC_ID_TRANS,
+                              qof_query_build_param_list (TRANS_NOTES, NULL),
+                              xaccTransQueryIndexByNotes);
 
     return qof_object_register (&trans_object_def);
 }
@@ -124,6 +124,12 @@ struct transaction_s
      * cached from the KVP value because it is queried a lot. Tri-state value: -1
      * = uninitialized; 0 = FALSE, 1 = TRUE. */
     gint isClosingTxn_cached;
+
+    /* Cached sum of the split values, as returned by
+     * xaccTransGetImbalanceValue; valid if imbalance_cache_valid is set.
+     * It's cleared whenever a split is added, removed or revalued. */
+    gnc_numeric cached_imbalance;
+    gboolean imbalance_cache_valid;
 };
 
 struct _TransactionClass
@@ -158,6 +164,23 @@ gint32 xaccTransGetVersion (const Transaction*);
 /* Code to register Transaction type with the engine */
 gboolean xaccTransRegister (void);
 
+/* The query indexes of the transactions by date posted, number,
+ *    description and notes, see QofQueryIndexFunc.  The split
+ *    indexes on the same parameters of their transaction use them too.
+ */
+gboolean xaccTransQueryIndexByDate (QofBook *book, GSList *pred_data,
+                                    QofInstanceForeachCB cb,
+                                    gpointer user_data);
+gboolean xaccTransQueryIndexByNum (QofBook *book, GSList *pred_data,
+                                   QofInstanceForeachCB cb,
+                                   gpointer user_data);
+gboolean xaccTransQueryIndexByDescription (QofBook *book, GSList *pred_data,
+                                           QofInstanceForeachCB cb,
+                                           gpointer user_data);
+gboolean xaccTransQueryIndexByNotes (QofBook *book, GSList *pred_data,
+                                     QofInstanceForeachCB cb,
+                                     gpointer user_data);
+
 /* The xaccTransactionGetBackend() subroutine will find the
  *    persistent-data storage backend associated with this
  *    transaction.
@@ -179,6 +202,8 @@ void xaccEnableDataScrubbing(void);
 void xaccDisableDataScrubbing(void);
 
 void xaccTransRemoveSplit (Transaction *trans, const Split *split);
+/* Forget the cached imbalance after changing the splits or their values. */
+void xaccTransClearImbalanceCache (Transaction *trans);
 void check_open (const Transaction *trans);
 
 /* Structure for accessing static functions for testing */
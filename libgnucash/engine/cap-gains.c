@@ -69,6 +69,7 @@ ToDo:
 #include "gnc-lot.h"
 #include "policy.h"
 #include "policy-p.h"
+#include "qofinstance-p.h"
 
 static QofLogModule log_module = GNC_MOD_LOT;
 
@@ -182,7 +183,7 @@ xaccAccountFindOpenLot (Account *acc, gnc_numeric sign,
     if (gnc_numeric_positive_p(sign)) es.numeric_pred = gnc_numeric_negative_p;
     else es.numeric_pred = gnc_numeric_positive_p;
 
-    xaccAccountForEachLot (acc, finder_helper, &es);
+    gnc_account_foreach_open_lot (acc, finder_helper, &es);
     return es.lot;
 }
 
@@ -481,21 +482,20 @@ xaccSplitAssign (Split *split)
 Split *
 xaccSplitGetCapGainsSplit (const Split *split)
 {
-    GncGUID *gains_guid;
+    static const QofKvpPath gains_split_path = {1, {"gains-split"}};
+    const GncGUID *gains_guid;
     Split *gains_split;
 
     if (!split) return NULL;
 
-    qof_instance_get (QOF_INSTANCE (split),
-                      "gains-split", &gains_guid,
-                      NULL);
+    gains_guid = qof_instance_get_kvp_guid_at (QOF_INSTANCE (split),
+                                               &gains_split_path);
     if (!gains_guid) return NULL;
 
     /* Both splits will be in the same collection, so search there. */
     gains_split = (Split*) qof_collection_lookup_entity (
                       qof_instance_get_collection(split), gains_guid);
     PINFO ("split=%p has gains-split=%p", split, gains_split);
-    guid_free (gains_guid);
     return gains_split;
 }
 
@@ -504,21 +504,20 @@ xaccSplitGetCapGainsSplit (const Split *split)
 Split *
 xaccSplitGetGainsSourceSplit (const Split *split)
 {
-    GncGUID *source_guid;
+    static const QofKvpPath gains_source_path = {1, {"gains-source"}};
+    const GncGUID *source_guid;
     Split *source_split;
 
     if (!split) return NULL;
 
-    qof_instance_get (QOF_INSTANCE (split),
-                      "gains-source", &source_guid,
-                      NULL);
+    source_guid = qof_instance_get_kvp_guid_at (QOF_INSTANCE (split),
+                                                &gains_source_path);
     if (!source_guid) return NULL;
 
     /* Both splits will be in the same collection, so search there. */
     source_split = (Split*) qof_collection_lookup_entity(
                        qof_instance_get_collection(split), source_guid);
     PINFO ("split=%p has source-split=%p", split, source_split);
-    guid_free (source_guid);
     return source_split;
 }
 
@@ -0,0 +1,580 @@
+/********************************************************************\
+ * gnc-book-archive.c -- moving old transactions to an archive file *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ *                                                                  *
+\********************************************************************/
+
+#include <config.h>
+#include <glib.h>
+
+#include "Account.h"
+#include "Transaction.h"
+#include "gnc-book-archive.h"
+#include "gnc-commodity.h"
+#include "gnc-engine.h"
+#include "gnc-features.h"
+#include "gnc-pricedb.h"
+#include "gnc-uri-utils.h"
+#include "qofinstance-p.h"
+
+static QofLogModule log_module = GNC_MOD_ENGINE;
+
+#define GNC_BOOK_ARCHIVE "gnc-book-archive"
+
+/* The slots of books and accounts, in the "archive-file" frame. */
+#define ARCHIVE_FRAME "archive-file"
+#define ARCHIVE_URI "uri"
+#define ARCHIVE_DATE "date"
+#define ARCHIVE_BALANCE "balance"
+#define ARCHIVE_CLEARED "cleared-balance"
+#define ARCHIVE_RECONCILED "reconciled-balance"
+#define ARCHIVE_NOCLOSING "noclosing-balance"
+
+typedef struct
+{
+    gnc_numeric balance;
+    gnc_numeric cleared;
+    gnc_numeric reconciled;
+    gnc_numeric noclosing;
+} ArchivedBalances;
+
+static gnc_numeric
+get_numeric_slot (const Account *acc, const char *name)
+{
+    GValue v = G_VALUE_INIT;
+    gnc_numeric result = gnc_numeric_zero ();
+
+    qof_instance_get_kvp (QOF_INSTANCE (acc), &v, 2, ARCHIVE_FRAME, name);
+    if (G_VALUE_HOLDS_BOXED (&v) && g_value_get_boxed (&v))
+        result = *(gnc_numeric*)g_value_get_boxed (&v);
+    g_value_unset (&v);
+    return result;
+}
+
+static void
+set_numeric_slot (Account *acc, const char *name, gnc_numeric value)
+{
+    GValue v = G_VALUE_INIT;
+
+    g_value_init (&v, GNC_TYPE_NUMERIC);
+    g_value_set_boxed (&v, &value);
+    qof_instance_set_kvp (QOF_INSTANCE (acc), &v, 2, ARCHIVE_FRAME, name);
+    g_value_unset (&v);
+}
+
+void
+gnc_account_get_archived_balances (const Account *acc, gnc_numeric *balance,
+                                   gnc_numeric *cleared,
+                                   gnc_numeric *reconciled,
+                                   gnc_numeric *noclosing)
+{
+    g_return_if_fail (GNC_IS_ACCOUNT (acc));
+
+    if (balance)
+        *balance = get_numeric_slot (acc, ARCHIVE_BALANCE);
+    if (cleared)
+        *cleared = get_numeric_slot (acc, ARCHIVE_CLEARED);
+    if (reconciled)
+        *reconciled = get_numeric_slot (acc, ARCHIVE_RECONCILED);
+    if (noclosing)
+        *noclosing = get_numeric_slot (acc, ARCHIVE_NOCLOSING);
+}
+
+gchar *
+gnc_book_archive_get_uri (QofBook *book)
+{
+    GValue v = G_VALUE_INIT;
+    gchar *uri = NULL;
+
+    g_return_val_if_fail (book, NULL);
+
+    qof_instance_get_kvp (QOF_INSTANCE (book), &v, 2, ARCHIVE_FRAME,
+                          ARCHIVE_URI);
+    if (G_VALUE_HOLDS_STRING (&v))
+        uri = g_value_dup_string (&v);
+    g_value_unset (&v);
+    return uri;
+}
+
+time64
+gnc_book_archive_get_date (QofBook *book)
+{
+    GValue v = G_VALUE_INIT;
+    time64 date = G_MININT64;
+
+    g_return_val_if_fail (book, G_MININT64);
+
+    qof_instance_get_kvp (QOF_INSTANCE (book), &v, 2, ARCHIVE_FRAME,
+                          ARCHIVE_DATE);
+    if (G_VALUE_HOLDS_INT64 (&v))
+        date = g_value_get_int64 (&v);
+    g_value_unset (&v);
+    return date;
+}
+
+static void
+set_start_balances (Account *acc, gpointer data)
+{
+    ArchivedBalances bal;
+
+    gnc_account_get_archived_balances (acc, &bal.balance, &bal.cleared,
+                                       &bal.reconciled, &bal.noclosing);
+    gnc_account_set_start_balance (acc, bal.balance);
+    gnc_account_set_start_cleared_balance (acc, bal.cleared);
+    gnc_account_set_start_reconciled_balance (acc, bal.reconciled);
+    gnc_account_set_start_noclosing_balance (acc, bal.noclosing);
+}
+
+void
+gnc_book_archive_set_start_balances (QofBook *book)
+{
+    gchar *uri;
+
+    g_return_if_fail (book);
+
+    /* Leave the starting balances alone in the usual case. */
+    uri = gnc_book_archive_get_uri (book);
+    if (!uri)
+        return;
+    g_free (uri);
+
+    gnc_account_foreach_descendant (gnc_book_get_root_account (book),
+                                    set_start_balances, NULL);
+}
+
+/* The archive's twin of from and of its ancestors, copied the first time.
+ * The twins keep the GncGUIDs of the originals. */
+static Account *
+archive_account (const Account *from, QofBook *archive)
+{
+    Account *to = xaccAccountLookup (xaccAccountGetGUID (from), archive);
+    Account *parent;
+
+    if (to)
+        return to;
+
+    parent = gnc_account_get_parent (from);
+    if (parent)
+        parent = archive_account (parent, archive);
+
+    to = xaccCloneAccount (from, archive);
+    xaccAccountBeginEdit (to);
+    qof_instance_set_guid (to, qof_instance_get_guid (from));
+    /* An archive has no archive of its own. */
+    qof_instance_slot_delete (QOF_INSTANCE (to), ARCHIVE_FRAME);
+    if (parent)
+        gnc_account_append_child (parent, to);
+    else
+        gnc_book_set_root_account (archive, to);
+    xaccAccountCommitEdit (to);
+    return to;
+}
+
+static void
+archive_split (Split *from, Transaction *parent, QofBook *archive)
+{
+    Split *to = xaccMallocSplit (archive);
+    Account *from_acc = xaccSplitGetAccount (from);
+
+    qof_instance_set_guid (to, qof_instance_get_guid (from));
+    qof_instance_copy_kvp (QOF_INSTANCE (to), QOF_INSTANCE (from));
+    xaccSplitSetMemo (to, xaccSplitGetMemo (from));
+    xaccSplitSetAction (to, xaccSplitGetAction (from));
+    xaccSplitSetReconcile (to, xaccSplitGetReconcile (from));
+    xaccSplitSetDateReconciledSecs (to, xaccSplitGetDateReconciled (from));
+    xaccSplitSetParent (to, parent);
+    if (from_acc)
+        xaccSplitSetAccount (to, archive_account (from_acc, archive));
+    xaccSplitSetAmount (to, xaccSplitGetAmount (from));
+    xaccSplitSetValue (to, xaccSplitGetValue (from));
+}
+
+static void
+archive_transaction (Transaction *from, QofBook *archive)
+{
+    Transaction *to;
+    GList *node;
+
+    /* Already there from an earlier, interrupted run. */
+    if (xaccTransLookup (qof_instance_get_guid (from), archive))
+        return;
+
+    to = xaccMallocTransaction (archive);
+    xaccTransBeginEdit (to);
+    qof_instance_set_guid (to, qof_instance_get_guid (from));
+    qof_instance_copy_kvp (QOF_INSTANCE (to), QOF_INSTANCE (from));
+    xaccTransSetCurrency (to, gnc_commodity_obtain_twin (xaccTransGetCurrency (from),
+                                                         archive));
+    xaccTransSetDatePostedSecs (to, xaccTransRetDatePosted (from));
+    xaccTransSetDateEnteredSecs (to, xaccTransRetDateEntered (from));
+    xaccTransSetNum (to, xaccTransGetNum (from));
+    xaccTransSetDescription (to, xaccTransGetDescription (from));
+    for (node = xaccTransGetSplitList (from); node; node = node->next)
+        archive_split (node->data, to, archive);
+    xaccTransCommitEdit (to);
+}
+
+typedef struct
+{
+    QofBook *archive;
+    time64 before;
+} ArchivePriceData;
+
+static gboolean
+archive_price (GNCPrice *from, gpointer data)
+{
+    ArchivePriceData *apd = data;
+    GNCPrice *to;
+
+    if (gnc_price_get_time64 (from) >= apd->before ||
+        gnc_price_lookup (qof_instance_get_guid (from), apd->archive))
+        return TRUE;
+
+    to = gnc_price_create (apd->archive);
+    gnc_price_begin_edit (to);
+    qof_instance_set_guid (to, qof_instance_get_guid (from));
+    gnc_price_set_commodity (to, gnc_commodity_obtain_twin (gnc_price_get_commodity (from),
+                                                            apd->archive));
+    gnc_price_set_currency (to, gnc_commodity_obtain_twin (gnc_price_get_currency (from),
+                                                           apd->archive));
+    gnc_price_set_time64 (to, gnc_price_get_time64 (from));
+    gnc_price_set_source (to, gnc_price_get_source (from));
+    gnc_price_set_typestr (to, gnc_price_get_typestr (from));
+    gnc_price_set_value (to, gnc_price_get_value (from));
+    gnc_price_commit_edit (to);
+    gnc_pricedb_add_price (gnc_pricedb_get_db (apd->archive), to);
+    gnc_price_unref (to);
+    return TRUE;
+}
+
+typedef struct
+{
+    Account *root;
+    time64 before;
+    GList *transactions;
+} CollectData;
+
+/* Whether trans can go: posted before the date, in the book's accounts
+ * rather than the scheduled transactions' templates, and not tied to a
+ * lot, an invoice or a payment. */
+static gboolean
+can_archive (Transaction *trans, const CollectData *cd)
+{
+    GList *node;
+
+    if (xaccTransRetDatePosted (trans) >= cd->before ||
+        xaccTransIsOpen (trans) ||
+        xaccTransGetTxnType (trans) != TXN_TYPE_NONE)
+        return FALSE;
+
+    for (node = xaccTransGetSplitList (trans); node; node = node->next)
+    {
+        Split *split = node->data;
+        Account *acc = xaccSplitGetAccount (split);
+
+        if (xaccSplitGetLot (split) || !acc ||
+            gnc_account_get_root (acc) != cd->root)
+            return FALSE;
+    }
+    return TRUE;
+}
+
+static void
+collect_transaction (QofInstance *inst, gpointer data)
+{
+    CollectData *cd = data;
+    Transaction *trans = GNC_TRANSACTION (inst);
+
+    if (can_archive (trans, cd))
+        cd->transactions = g_list_prepend (cd->transactions, trans);
+}
+
+static gpointer
+account_pending (Account *acc, gpointer data)
+{
+    return gnc_account_get_splits_pending (acc) ? acc : NULL;
+}
+
+static gboolean
+report_session_error (QofSession *session, const gchar *uri)
+{
+    QofBackendError err = qof_session_get_error (session);
+
+    if (err == ERR_BACKEND_NO_ERR)
+        return FALSE;
+    PERR ("Archive %s: %s", uri, qof_session_get_error_message (session));
+    return TRUE;
+}
+
+/* Copy the transactions, with what they refer to, and the prices before
+ * the date to the archive at uri and save it. */
+static gboolean
+write_archive (QofBook *book, const gchar *uri, gboolean exists,
+               GList *transactions, time64 before)
+{
+    QofSession *session;
+    QofBook *archive;
+    ArchivePriceData apd;
+    gboolean ok = FALSE;
+    GList *node;
+
+    /* Nobody but us knows about the archive's book, and the copies must
+     * be exact, so no scrubbing. */
+    qof_event_suspend ();
+    xaccDisableDataScrubbing ();
+
+    session = qof_session_new (qof_book_new ());
+    qof_session_begin (session, uri,
+                       exists ? SESSION_NORMAL_OPEN : SESSION_NEW_STORE);
+    if (report_session_error (session, uri))
+        goto done;
+    if (exists)
+    {
+        qof_session_load (session, NULL);
+        if (report_session_error (session, uri))
+            goto done;
+        qof_session_ensure_all_data_loaded (session);
+    }
+
+    archive = qof_session_get_book (session);
+    archive_account (gnc_book_get_root_account (book), archive);
+    for (node = transactions; node; node = node->next)
+        archive_transaction (node->data, archive);
+    apd.archive = archive;
+    apd.before = before;
+    gnc_pricedb_foreach_price (gnc_pricedb_get_db (book), archive_price,
+                               &apd, FALSE);
+
+    qof_session_save (session, NULL);
+    ok = !report_session_error (session, uri);
+
+done:
+    qof_session_end (session);
+    qof_session_destroy (session);
+    xaccEnableDataScrubbing ();
+    qof_event_resume ();
+    return ok;
+}
+
+static void
+add_to_archived_balances (GHashTable *balances, Split *split)
+{
+    Account *acc = xaccSplitGetAccount (split);
+    gnc_numeric amount = xaccSplitGetAmount (split);
+    char reconciled = xaccSplitGetReconcile (split);
+    ArchivedBalances *bal = g_hash_table_lookup (balances, acc);
+
+    if (!bal)
+    {
+        bal = g_new (ArchivedBalances, 1);
+        bal->balance = bal->cleared = bal->reconciled = bal->noclosing =
+            gnc_numeric_zero ();
+        g_hash_table_insert (balances, acc, bal);
+    }
+
+#define ADD(b) (b) = gnc_numeric_add ((b), amount, GNC_DENOM_AUTO, \
+                                      GNC_HOW_DENOM_LCD)
+    /* As xaccAccountRecomputeBalance() counts them. */
+    ADD (bal->balance);
+    if (!xaccTransGetIsClosingTxn (xaccSplitGetParent (split)))
+        ADD (bal->noclosing);
+    if (reconciled != NREC)
+        ADD (bal->cleared);
+    if (reconciled == YREC || reconciled == FREC)
+        ADD (bal->reconciled);
+#undef ADD
+}
+
+static void
+store_archived_balances (gpointer key, gpointer value, gpointer data)
+{
+    Account *acc = key;
+    ArchivedBalances *add = value;
+    ArchivedBalances bal;
+
+    gnc_account_get_archived_balances (acc, &bal.balance, &bal.cleared,
+                                       &bal.reconciled, &bal.noclosing);
+#define ADD(b) bal.b = gnc_numeric_add (bal.b, add->b, GNC_DENOM_AUTO, \
+                                        GNC_HOW_DENOM_LCD)
+    ADD (balance);
+    ADD (cleared);
+    ADD (reconciled);
+    ADD (noclosing);
+#undef ADD
+
+    xaccAccountBeginEdit (acc);
+    set_numeric_slot (acc, ARCHIVE_BALANCE, bal.balance);
+    set_numeric_slot (acc, ARCHIVE_CLEARED, bal.cleared);
+    set_numeric_slot (acc, ARCHIVE_RECONCILED, bal.reconciled);
+    set_numeric_slot (acc, ARCHIVE_NOCLOSING, bal.noclosing);
+    set_start_balances (acc, NULL);
+    qof_instance_set_dirty (QOF_INSTANCE (acc));
+    xaccAccountCommitEdit (acc);
+}
+
+static void
+set_book_archive (QofBook *book, const gchar *uri, time64 before)
+{
+    GValue v = G_VALUE_INIT;
+
+    qof_book_begin_edit (book);
+    g_value_init (&v, G_TYPE_STRING);
+    g_value_set_string (&v, uri);
+    qof_instance_set_kvp (QOF_INSTANCE (book), &v, 2, ARCHIVE_FRAME,
+                          ARCHIVE_URI);
+    g_value_unset (&v);
+
+    g_value_init (&v, G_TYPE_INT64);
+    g_value_set_int64 (&v, MAX (before, gnc_book_archive_get_date (book)));
+    qof_instance_set_kvp (QOF_INSTANCE (book), &v, 2, ARCHIVE_FRAME,
+                          ARCHIVE_DATE);
+    g_value_unset (&v);
+    qof_instance_set_dirty (QOF_INSTANCE (book));
+    qof_book_commit_edit (book);
+
+    gnc_features_set_used (book, GNC_FEATURE_ARCHIVE_FILE);
+}
+
+gint
+gnc_book_archive_transactions (QofBook *book, const gchar *uri, time64 before)
+{
+    CollectData cd;
+    GHashTable *balances;
+    gchar *archive_uri, *old_uri;
+    gint n_moved = -1;
+    GList *node;
+
+    g_return_val_if_fail (book, -1);
+    g_return_val_if_fail (uri, -1);
+
+    ENTER ("book=%p, uri=%s", book, uri);
+    cd.root = gnc_book_get_root_account (book);
+    if (qof_book_is_readonly (book) || !cd.root)
+    {
+        PWARN ("The book can't be archived");
+        LEAVE ("");
+        return -1;
+    }
+    /* Archiving what wasn't loaded would lose it, or count it twice. */
+    if (qof_book_get_archive_date (book) != G_MININT64 ||
+        gnc_account_foreach_descendant_until (cd.root, account_pending, NULL))
+    {
+        PWARN ("Not all of the book's transactions are loaded");
+        LEAVE ("");
+        return -1;
+    }
+
+    archive_uri = gnc_uri_normalize_uri (uri, FALSE);
+    old_uri = gnc_book_archive_get_uri (book);
+    if (old_uri && g_strcmp0 (old_uri, archive_uri))
+    {
+        PWARN ("The book's archive is %s, not %s", old_uri, archive_uri);
+        goto done;
+    }
+
+    cd.before = before;
+    cd.transactions = NULL;
+    qof_collection_foreach (qof_book_get_collection (book, GNC_ID_TRANS),
+                            collect_transaction, &cd);
+    if (!write_archive (book, archive_uri, old_uri != NULL, cd.transactions,
+                        before))
+    {
+        g_list_free (cd.transactions);
+        goto done;
+    }
+
+    balances = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL,
+                                      g_free);
+    n_moved = 0;
+    for (node = cd.transactions; node; node = node->next)
+    {
+        Transaction *trans = node->data;
+        GList *split_node;
+
+        for (split_node = xaccTransGetSplitList (trans); split_node;
+             split_node = split_node->next)
+            add_to_archived_balances (balances, split_node->data);
+        xaccTransBeginEdit (trans);
+        xaccTransDestroy (trans);
+        xaccTransCommitEdit (trans);
+        n_moved++;
+    }
+    g_list_free (cd.transactions);
+    g_hash_table_foreach (balances, store_archived_balances, NULL);
+    g_hash_table_destroy (balances);
+    set_book_archive (book, archive_uri, before);
+
+done:
+    g_free (old_uri);
+    g_free (archive_uri);
+    LEAVE ("moved %d", n_moved);
+    return n_moved;
+}
+
+static void
+close_archive (QofBook *book, gpointer key, gpointer data)
+{
+    QofSession *session = data;
+
+    qof_session_end (session);
+    qof_session_destroy (session);
+}
+
+QofBook *
+gnc_book_archive_get_book (QofBook *book)
+{
+    QofSession *session;
+    gchar *uri;
+
+    g_return_val_if_fail (book, NULL);
+
+    session = qof_book_get_data (book, GNC_BOOK_ARCHIVE);
+    if (session)
+        return qof_session_get_book (session);
+
+    uri = gnc_book_archive_get_uri (book);
+    if (!uri)
+        return NULL;
+
+    ENTER ("uri=%s", uri);
+    /* The archive's objects aren't news to anyone watching book. */
+    qof_event_suspend ();
+    session = qof_session_new (qof_book_new ());
+    qof_session_begin (session, uri, SESSION_READ_ONLY);
+    if (!report_session_error (session, uri))
+    {
+        qof_session_load (session, NULL);
+        if (!report_session_error (session, uri))
+            qof_session_ensure_all_data_loaded (session);
+    }
+    qof_event_resume ();
+
+    if (qof_session_get_error (session) != ERR_BACKEND_NO_ERR)
+    {
+        qof_session_destroy (session);
+        g_free (uri);
+        LEAVE ("failed");
+        return NULL;
+    }
+    qof_book_mark_readonly (qof_session_get_book (session));
+    qof_book_set_data_fin (book, GNC_BOOK_ARCHIVE, session, close_archive);
+    g_free (uri);
+    LEAVE ("");
+    return qof_session_get_book (session);
+}
@@ -0,0 +1,122 @@
+/********************************************************************\
+ * gnc-book-archive.h -- moving old transactions to an archive file *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ *                                                                  *
+\********************************************************************/
+/** @addtogroup Engine
+    @{ */
+/** @addtogroup Archive Book Archives
+ *
+ * A book's transactions up to some date can be moved to an archive: a
+ * second GnuCash file or database, XML or SQL, holding them together
+ * with copies of their accounts and commodities and of the prices up
+ * to that date.  The working book then only has to load, scrub and
+ * keep the balances of the newer ones.
+ *
+ * In their place each account keeps the sums of its archived splits
+ * in its KVP, which the backends make its starting balances on every
+ * load (see gnc_account_set_start_balance()), so its balances stay the
+ * same.  The book records the archive's URI and date; code that needs
+ * the old transactions, like a report of earlier years, can open the
+ * archive with gnc_book_archive_get_book().
+ *
+ * Of the reports only the transaction report and those built on it do:
+ * they also run their query over the archive when they start before
+ * gnc_book_archive_get_date().  Reports of balances need nothing more,
+ * as the starting balances include the archived splits; the other
+ * reports listing splits, like the general journal and the register
+ * report, only show the working book's.  The archive's splits are in its
+ * own copies of the accounts and commodities, so their amounts can't be
+ * converted with the working book's prices.
+ *
+ * Transactions that belong to lots, invoices or payments stay in the
+ * working book, since the lots and business objects would otherwise
+ * be split between the two.
+ @{ */
+
+/** @file gnc-book-archive.h
+ */
+
+#ifndef GNC_BOOK_ARCHIVE_H
+#define GNC_BOOK_ARCHIVE_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include "qof.h"
+#include "Account.h"
+
+/** Move the transactions of book posted before a date to its archive.
+ *
+ * The archive is created at uri the first time; later calls must give
+ * the same uri and add to it.  The archive is saved before anything is
+ * taken from book, whose changes are then committed as usual.  All of
+ * the book's transactions must be loaded, see
+ * qof_session_ensure_all_data_loaded().
+ *
+ * @param book The working book.
+ * @param uri The archive's file name or URI.
+ * @param before Transactions posted before this are moved.
+ *
+ * @return The number of transactions moved, or -1 if the archive
+ * couldn't be opened or saved or book can't be archived, in which case
+ * book is unchanged.
+ */
+gint gnc_book_archive_transactions (QofBook *book, const gchar *uri,
+                                    time64 before);
+
+/** The URI of book's archive, to be freed with g_free(), or NULL if it
+ *  has none. */
+gchar *gnc_book_archive_get_uri (QofBook *book);
+
+/** The date before which book's transactions were moved to its archive,
+ *  or G_MININT64 if it has none. */
+time64 gnc_book_archive_get_date (QofBook *book);
+
+/** Open book's archive read-only the first time it's asked for.
+ *
+ * The archive stays open until book is destroyed.
+ *
+ * @return The archive's book, or NULL if book has no archive or it
+ * couldn't be loaded.
+ */
+QofBook *gnc_book_archive_get_book (QofBook *book);
+
+/** The sums of the account's splits that were moved to the archive:
+ *  its balance, cleared, reconciled and no-closing balance.  Any of the
+ *  pointers may be NULL. */
+void gnc_account_get_archived_balances (const Account *acc,
+                                        gnc_numeric *balance,
+                                        gnc_numeric *cleared,
+                                        gnc_numeric *reconciled,
+                                        gnc_numeric *noclosing);
+
+/** Make the archived balances of each of book's accounts its starting
+ *  balances.  For backends, once they have loaded the accounts. */
+void gnc_book_archive_set_start_balances (QofBook *book);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* GNC_BOOK_ARCHIVE_H */
+/** @} */
+/** @} */
@@ -0,0 +1,163 @@
+/********************************************************************\
+ * gnc-book-snapshot.c -- read-only copies of a book for background *
+ *                        work                                      *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ *                                                                  *
+\********************************************************************/
+
+#include <config.h>
+#include <glib.h>
+
+#include "Account.h"
+#include "Transaction.h"
+#include "TransactionP.h"
+#include "gnc-book-snapshot.h"
+#include "gnc-commodity.h"
+#include "gnc-engine.h"
+#include "gnc-pricedb.h"
+#include "qofinstance-p.h"
+
+static QofLogModule log_module = GNC_MOD_ENGINE;
+
+#define GNC_BOOK_SNAPSHOT "gnc-book-snapshot"
+
+static Account *
+snapshot_account (const Account *from, Account *parent, QofBook *snapshot)
+{
+    Account *to = xaccCloneAccount (from, snapshot);
+    GList *children, *node;
+
+    xaccAccountBeginEdit (to);
+    qof_instance_set_guid (to, qof_instance_get_guid (from));
+    if (parent)
+        gnc_account_append_child (parent, to);
+    xaccAccountCommitEdit (to);
+
+    children = gnc_account_get_children (from);
+    for (node = children; node; node = node->next)
+        snapshot_account (node->data, to, snapshot);
+    g_list_free (children);
+    return to;
+}
+
+static void
+snapshot_split (Split *from, Transaction *parent, QofBook *snapshot)
+{
+    Split *to = xaccMallocSplit (snapshot);
+    Account *from_acc = xaccSplitGetAccount (from);
+
+    qof_instance_set_guid (to, qof_instance_get_guid (from));
+    qof_instance_copy_kvp (QOF_INSTANCE (to), QOF_INSTANCE (from));
+    xaccSplitSetMemo (to, xaccSplitGetMemo (from));
+    xaccSplitSetAction (to, xaccSplitGetAction (from));
+    xaccSplitSetReconcile (to, xaccSplitGetReconcile (from));
+    xaccSplitSetDateReconciledSecs (to, xaccSplitGetDateReconciled (from));
+    xaccSplitSetParent (to, parent);
+    if (from_acc)
+        xaccSplitSetAccount (to, xaccAccountLookup (xaccAccountGetGUID (from_acc),
+                                                    snapshot));
+    xaccSplitSetAmount (to, xaccSplitGetAmount (from));
+    xaccSplitSetValue (to, xaccSplitGetValue (from));
+}
+
+static void
+snapshot_transaction (QofInstance *inst, gpointer data)
+{
+    Transaction *from = GNC_TRANSACTION (inst);
+    QofBook *snapshot = data;
+    Transaction *to = xaccMallocTransaction (snapshot);
+    GList *node;
+
+    xaccTransBeginEdit (to);
+    qof_instance_set_guid (to, qof_instance_get_guid (from));
+    qof_instance_copy_kvp (QOF_INSTANCE (to), QOF_INSTANCE (from));
+    xaccTransSetCurrency (to, gnc_commodity_obtain_twin (xaccTransGetCurrency (from),
+                                                         snapshot));
+    xaccTransSetDatePostedSecs (to, xaccTransRetDatePosted (from));
+    xaccTransSetDateEnteredSecs (to, xaccTransRetDateEntered (from));
+    xaccTransSetNum (to, xaccTransGetNum (from));
+    xaccTransSetDescription (to, xaccTransGetDescription (from));
+    for (node = xaccTransGetSplitList (from); node; node = node->next)
+        snapshot_split (node->data, to, snapshot);
+    xaccTransCommitEdit (to);
+}
+
+static gboolean
+snapshot_price (GNCPrice *from, gpointer data)
+{
+    QofBook *snapshot = data;
+    GNCPrice *to = gnc_price_create (snapshot);
+
+    gnc_price_begin_edit (to);
+    qof_instance_set_guid (to, qof_instance_get_guid (from));
+    gnc_price_set_commodity (to, gnc_commodity_obtain_twin (gnc_price_get_commodity (from),
+                                                            snapshot));
+    gnc_price_set_currency (to, gnc_commodity_obtain_twin (gnc_price_get_currency (from),
+                                                           snapshot));
+    gnc_price_set_time64 (to, gnc_price_get_time64 (from));
+    gnc_price_set_source (to, gnc_price_get_source (from));
+    gnc_price_set_typestr (to, gnc_price_get_typestr (from));
+    gnc_price_set_value (to, gnc_price_get_value (from));
+    gnc_price_commit_edit (to);
+    gnc_pricedb_add_price (gnc_pricedb_get_db (snapshot), to);
+    gnc_price_unref (to);
+    return TRUE;
+}
+
+QofBook *
+gnc_book_snapshot_new (QofBook *book)
+{
+    QofBook *snapshot;
+    Account *root;
+
+    g_return_val_if_fail (book, NULL);
+
+    ENTER ("book=%p", book);
+    /* Nobody but the caller knows about the new book yet, so there's
+     * nothing to tell; and the copies must be exact, so no scrubbing. */
+    qof_event_suspend ();
+    xaccDisableDataScrubbing ();
+
+    snapshot = qof_book_new ();
+    root = gnc_book_get_root_account (book);
+    if (root)
+        gnc_book_set_root_account (snapshot,
+                                   snapshot_account (root, NULL, snapshot));
+
+    qof_collection_foreach (qof_book_get_collection (book, GNC_ID_TRANS),
+                            snapshot_transaction, snapshot);
+    gnc_pricedb_foreach_price (gnc_pricedb_get_db (book), snapshot_price,
+                               snapshot, FALSE);
+
+    qof_book_set_data (snapshot, GNC_BOOK_SNAPSHOT, book);
+    qof_book_mark_readonly (snapshot);
+    qof_book_mark_session_saved (snapshot);
+
+    xaccEnableDataScrubbing ();
+    qof_event_resume ();
+    LEAVE ("snapshot=%p", snapshot);
+    return snapshot;
+}
+
+gboolean
+gnc_book_is_snapshot (const QofBook *book)
+{
+    if (!book) return FALSE;
+    return qof_book_get_data ((QofBook*)book, GNC_BOOK_SNAPSHOT) != NULL;
+}
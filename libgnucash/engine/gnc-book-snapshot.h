@@ -0,0 +1,75 @@
+/********************************************************************\
+ * gnc-book-snapshot.h -- read-only copies of a book for background *
+ *                        work                                      *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ *                                                                  *
+\********************************************************************/
+/** @addtogroup Engine
+    @{ */
+/** @addtogroup Snapshot Book Snapshots
+ * A snapshot is a separate, read-only book holding a copy of the
+ * ledger of another book as it was when the snapshot was taken: the
+ * account tree, the transactions with their splits and the prices,
+ * together with the commodities they use.  Every copied instance keeps
+ * the GncGUID of its original, so the usual lookup functions
+ * (e.g. xaccAccountLookup()) map between the two books.
+ *
+ * Nothing is shared with the live book except the cached strings, so
+ * once it's made a snapshot can be handed to a worker thread, e.g. for
+ * a report, an export or balance computations, while the user keeps
+ * editing the live book.  The worker must be the only user of the
+ * snapshot and must only read from it.  Taking and destroying the
+ * snapshot (with qof_book_destroy()) have to happen on the main thread.
+ *
+ * Lots, scheduled transactions, budgets and the business objects are
+ * not copied.
+ @{ */
+
+/** @file gnc-book-snapshot.h
+ */
+
+#ifndef GNC_BOOK_SNAPSHOT_H
+#define GNC_BOOK_SNAPSHOT_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include "qof.h"
+
+/** Take a snapshot of book.
+ *
+ * @param book The book to copy.
+ *
+ * @return A new read-only book, to be freed with qof_book_destroy(),
+ * or NULL if book is NULL.
+ */
+QofBook * gnc_book_snapshot_new (QofBook *book);
+
+/** Report whether book was made by gnc_book_snapshot_new(). */
+gboolean gnc_book_is_snapshot (const QofBook *book);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* GNC_BOOK_SNAPSHOT_H */
+/** @} */
+/** @} */
@@ -71,8 +71,26 @@ typedef struct GncBudgetPrivate
 
     /* Number of periods */
     guint  num_periods;
+
+    /* The amounts of each account, by the account's GUID, as read from
+     * the KVP, so that looking one up doesn't mean building its path. */
+    GHashTable *acct_hash;
 } GncBudgetPrivate;
 
+typedef struct
+{
+    gboolean    value_is_set;
+    gnc_numeric value;
+} PeriodData;
+
+/* One account's amounts for every period of the budget.  */
+typedef struct
+{
+    GncGUID     guid;
+    guint       num_periods;
+    PeriodData  periods[];
+} AcctPeriodData;
+
 #define GET_PRIVATE(o) \
     ((GncBudgetPrivate*)g_type_instance_get_private((GTypeInstance*)o, GNC_TYPE_BUDGET))
 
@@ -95,6 +113,9 @@ gnc_budget_init(GncBudget* budget)
     priv->description = CACHE_INSERT("");
 
     priv->num_periods = 12;
+    priv->acct_hash = g_hash_table_new_full (guid_hash_to_guint,
+                                             guid_g_hash_table_equal,
+                                             NULL, g_free);
     date = gnc_g_date_new_today ();
     g_date_subtract_days(date, g_date_get_day(date) - 1);
     recurrenceSet(&priv->recurrence, 1, PERIOD_MONTH, date, WEEKEND_ADJ_NONE);
@@ -110,6 +131,9 @@ gnc_budget_dispose (GObject *budgetp)
 static void
 gnc_budget_finalize(GObject* budgetp)
 {
+    GncBudgetPrivate* priv = GET_PRIVATE(budgetp);
+
+    g_hash_table_destroy (priv->acct_hash);
     G_OBJECT_CLASS(gnc_budget_parent_class)->finalize(budgetp);
 }
 
@@ -181,16 +205,38 @@ gnc_budget_set_property( GObject* object,
     }
 }
 
+static void
+gnc_budget_add_memory_usage(const QofInstance* inst, QofMemoryUsage* usage)
+{
+    GncBudgetPrivate* priv = GET_PRIVATE(inst);
+
+    usage->instance_bytes += sizeof(GncBudgetPrivate);
+    if (priv->acct_hash)
+    {
+        GHashTableIter iter;
+        gpointer value;
+
+        g_hash_table_iter_init(&iter, priv->acct_hash);
+        while (g_hash_table_iter_next(&iter, NULL, &value))
+            usage->other_bytes += 2 * sizeof(gpointer) + sizeof(guint) +
+                sizeof(AcctPeriodData) +
+                ((AcctPeriodData*)value)->num_periods * sizeof(PeriodData);
+    }
+}
+
 static void
 gnc_budget_class_init(GncBudgetClass* klass)
 {
     GObjectClass* gobject_class = G_OBJECT_CLASS(klass);
+    QofInstanceClass* qof_class = QOF_INSTANCE_CLASS(klass);
 
     gobject_class->dispose = gnc_budget_dispose;
     gobject_class->finalize = gnc_budget_finalize;
     gobject_class->get_property = gnc_budget_get_property;
     gobject_class->set_property = gnc_budget_set_property;
 
+    qof_class->add_memory_usage = gnc_budget_add_memory_usage;
+
     g_object_class_install_property(
         gobject_class,
         PROP_NAME,
@@ -458,6 +504,8 @@ gnc_budget_set_num_periods(GncBudget* budget, guint num_periods)
 
     gnc_budget_begin_edit(budget);
     priv->num_periods = num_periods;
+    /* The cached rows are as long as the old number of periods. */
+    g_hash_table_remove_all (priv->acct_hash);
     qof_instance_set_dirty(&budget->inst);
     gnc_budget_commit_edit(budget);
 
@@ -481,6 +529,66 @@ make_period_path (const Account *account, guint period_num, char *path1, char *p
     g_sprintf (path2, "%d", period_num);
 }
 
+/* Read one amount from the KVP, returning whether it is set. */
+static gboolean
+get_kvp_period_value (const GncBudget *budget, const Account *account,
+                      guint period_num, gnc_numeric *value)
+{
+    gnc_numeric *numeric = NULL;
+    gchar path_part_one [GUID_ENCODING_LENGTH + 1];
+    gchar path_part_two [GNC_BUDGET_MAX_NUM_PERIODS_DIGITS];
+    GValue v = G_VALUE_INIT;
+
+    make_period_path (account, period_num, path_part_one, path_part_two);
+    qof_instance_get_kvp (QOF_INSTANCE (budget), &v, 2, path_part_one, path_part_two);
+    if (G_VALUE_HOLDS_BOXED (&v))
+        numeric = (gnc_numeric*)g_value_get_boxed (&v);
+
+    *value = numeric ? *numeric : gnc_numeric_zero ();
+    return (numeric != NULL);
+}
+
+/* Return the cached amounts of account, reading them all from the KVP
+ * the first time.  The KVP stays the record; every setter below updates
+ * both. */
+static AcctPeriodData *
+get_acct_period_data (const GncBudget *budget, const Account *account)
+{
+    GncBudgetPrivate *priv = GET_PRIVATE(budget);
+    const GncGUID *guid = xaccAccountGetGUID (account);
+    AcctPeriodData *data = g_hash_table_lookup (priv->acct_hash, guid);
+    guint i;
+
+    if (data)
+        return data;
+
+    data = g_malloc (sizeof (AcctPeriodData) +
+                     priv->num_periods * sizeof (PeriodData));
+    data->guid = *guid;
+    data->num_periods = priv->num_periods;
+    for (i = 0; i < data->num_periods; i++)
+        data->periods[i].value_is_set =
+            get_kvp_period_value (budget, account, i, &data->periods[i].value);
+
+    g_hash_table_insert (priv->acct_hash, &data->guid, data);
+    return data;
+}
+
+/* Update the cached amount, if the account's amounts are cached. */
+static void
+set_cached_period_value (GncBudget *budget, const Account *account,
+                         guint period_num, const gnc_numeric *val)
+{
+    AcctPeriodData *data = g_hash_table_lookup (GET_PRIVATE(budget)->acct_hash,
+                                                xaccAccountGetGUID (account));
+
+    if (!data || period_num >= data->num_periods)
+        return;
+
+    data->periods[period_num].value_is_set = (val != NULL);
+    data->periods[period_num].value = val ? *val : gnc_numeric_zero ();
+}
+
 /* period_num is zero-based */
 /* What happens when account is deleted, after we have an entry for it? */
 void
@@ -496,6 +604,7 @@ gnc_budget_unset_account_period_value(GncBudget *budget, const Account *account,
 
     gnc_budget_begin_edit(budget);
     qof_instance_set_kvp (QOF_INSTANCE (budget), NULL, 2, path_part_one, path_part_two);
+    set_cached_period_value (budget, account, period_num, NULL);
     qof_instance_set_dirty(&budget->inst);
     gnc_budget_commit_edit(budget);
 
@@ -527,13 +636,17 @@ gnc_budget_set_account_period_value(GncBudget *budget, const Account *account,
 
     gnc_budget_begin_edit(budget);
     if (gnc_numeric_check(val))
+    {
         qof_instance_set_kvp (QOF_INSTANCE (budget), NULL, 2, path_part_one, path_part_two);
+        set_cached_period_value (budget, account, period_num, NULL);
+    }
     else
     {
         GValue v = G_VALUE_INIT;
         g_value_init (&v, GNC_TYPE_NUMERIC);
         g_value_set_boxed (&v, &val);
         qof_instance_set_kvp (QOF_INSTANCE (budget), &v, 2, path_part_one, path_part_two);
+        set_cached_period_value (budget, account, period_num, &val);
     }
     qof_instance_set_dirty(&budget->inst);
     gnc_budget_commit_edit(budget);
@@ -550,19 +663,17 @@ gnc_budget_is_account_period_value_set(const GncBudget *budget,
                                        const Account *account,
                                        guint period_num)
 {
-    GValue v = G_VALUE_INIT;
-    gchar path_part_one [GUID_ENCODING_LENGTH + 1];
-    gchar path_part_two [GNC_BUDGET_MAX_NUM_PERIODS_DIGITS];
-    gconstpointer ptr = NULL;
+    AcctPeriodData *data;
+    gnc_numeric value;
 
     g_return_val_if_fail(GNC_IS_BUDGET(budget), FALSE);
     g_return_val_if_fail(account, FALSE);
 
-    make_period_path (account, period_num, path_part_one, path_part_two);
-    qof_instance_get_kvp (QOF_INSTANCE (budget), &v, 2, path_part_one, path_part_two);
-    if (G_VALUE_HOLDS_BOXED (&v))
-        ptr = g_value_get_boxed (&v);
-    return (ptr != NULL);
+    data = get_acct_period_data (budget, account);
+    if (period_num < data->num_periods)
+        return data->periods[period_num].value_is_set;
+
+    return get_kvp_period_value (budget, account, period_num, &value);
 }
 
 gnc_numeric
@@ -570,22 +681,18 @@ gnc_budget_get_account_period_value(const GncBudget *budget,
                                     const Account *account,
                                     guint period_num)
 {
-    gnc_numeric *numeric = NULL;
-    gchar path_part_one [GUID_ENCODING_LENGTH + 1];
-    gchar path_part_two [GNC_BUDGET_MAX_NUM_PERIODS_DIGITS];
-    GValue v = G_VALUE_INIT;
+    AcctPeriodData *data;
+    gnc_numeric value;
 
     g_return_val_if_fail(GNC_IS_BUDGET(budget), gnc_numeric_zero());
     g_return_val_if_fail(account, gnc_numeric_zero());
 
-    make_period_path (account, period_num, path_part_one, path_part_two);
-    qof_instance_get_kvp (QOF_INSTANCE (budget), &v, 2, path_part_one, path_part_two);
-    if (G_VALUE_HOLDS_BOXED (&v))
-        numeric = (gnc_numeric*)g_value_get_boxed (&v);
+    data = get_acct_period_data (budget, account);
+    if (period_num < data->num_periods)
+        return data->periods[period_num].value;
 
-    if (numeric)
-        return *numeric;
-    return gnc_numeric_zero();
+    get_kvp_period_value (budget, account, period_num, &value);
+    return value;
 }
 
 
@@ -99,6 +99,8 @@ struct _GncCommodityClass
 
 static void commodity_free(gnc_commodity * cm);
 static void gnc_commodity_set_default_symbol(gnc_commodity *, const char *);
+static void commodity_table_index_cusip(gnc_commodity_table *table,
+                                        gnc_commodity *cm, gboolean add);
 
 struct gnc_commodity_namespace_s
 {
@@ -119,8 +121,23 @@ struct gnc_commodity_table_s
 {
     GHashTable * ns_table;
     GList      * ns_list;
+
+    /* Every commodity of every namespace by CommodityKey, so that a
+     * lookup is one probe that needs no string built. */
+    GHashTable * cm_index;
+    /* The commodities with a CUSIP, ISIN or other code, by the code. */
+    GHashTable * cusip_index;
 };
 
+/* The key of the table's cm_index.  The namespace needn't be
+ * NUL-terminated, so that lookups by unique name can point into it. */
+typedef struct
+{
+    const char * name_space;
+    gsize        ns_len;
+    const char * mnemonic;
+} CommodityKey;
+
 struct gnc_new_iso_code
 {
     const char *old_code;
@@ -784,16 +801,32 @@ gnc_commodity_set_property (GObject         *object,
         break;
     }
 }
+static void
+gnc_commodity_add_memory_usage(const QofInstance* inst, QofMemoryUsage* usage)
+{
+    gnc_commodityPrivate* priv = GET_PRIVATE(inst);
+
+    usage->instance_bytes += sizeof(gnc_commodityPrivate);
+    /* The other strings are in the string cache. */
+    if (priv->printname)
+        usage->other_bytes += strlen(priv->printname) + 1;
+    if (priv->unique_name)
+        usage->other_bytes += strlen(priv->unique_name) + 1;
+}
+
 static void
 gnc_commodity_class_init(struct _GncCommodityClass* klass)
 {
     GObjectClass *gobject_class = G_OBJECT_CLASS(klass);
+    QofInstanceClass *qof_class = QOF_INSTANCE_CLASS(klass);
 
     gobject_class->dispose = gnc_commodity_dispose;
     gobject_class->finalize = gnc_commodity_finalize;
     gobject_class->set_property = gnc_commodity_set_property;
     gobject_class->get_property = gnc_commodity_get_property;
 
+    qof_class->add_memory_usage = gnc_commodity_add_memory_usage;
+
     g_object_class_install_property(gobject_class,
                                     PROP_NAMESPACE,
                                     g_param_spec_object ("namespace",
@@ -1308,15 +1341,25 @@ gnc_commodity_set_cusip(gnc_commodity * cm,
                         const char * cusip)
 {
     gnc_commodityPrivate* priv;
+    gnc_commodity_table *table;
+    gboolean in_table;
 
     if (!cm) return;
 
     priv = GET_PRIVATE(cm);
     if (priv->cusip == cusip) return;
 
+    table = gnc_commodity_table_get_table (qof_instance_get_book (&cm->inst));
+    in_table = priv->name_space &&
+        gnc_commodity_table_lookup (table, priv->name_space->name,
+                                    priv->mnemonic) == cm;
     gnc_commodity_begin_edit(cm);
+    if (in_table)
+        commodity_table_index_cusip (table, cm, FALSE);
     CACHE_REMOVE (priv->cusip);
     priv->cusip = CACHE_INSERT (cusip);
+    if (in_table)
+        commodity_table_index_cusip (table, cm, TRUE);
     mark_commodity_dirty(cm);
     gnc_commodity_commit_edit(cm);
 }
@@ -1732,6 +1775,145 @@ gnc_commodity_table_map_namespace(const char * name_space)
     return name_space;
 }
 
+/********************************************************************
+ * The table's flat index
+ ********************************************************************/
+
+static guint
+commodity_key_hash (gconstpointer key)
+{
+    const CommodityKey *k = key;
+    const char *p;
+    guint h = 5381;
+    gsize i;
+
+    for (i = 0; i < k->ns_len; i++)
+        h = (h << 5) + h + (guchar)k->name_space[i];
+    h = (h << 5) + h + ':';
+    for (p = k->mnemonic; *p; p++)
+        h = (h << 5) + h + (guchar)*p;
+    return h;
+}
+
+static gboolean
+commodity_key_equal (gconstpointer a, gconstpointer b)
+{
+    const CommodityKey *ka = a, *kb = b;
+
+    return ka->ns_len == kb->ns_len &&
+        memcmp (ka->name_space, kb->name_space, ka->ns_len) == 0 &&
+        strcmp (ka->mnemonic, kb->mnemonic) == 0;
+}
+
+/* The keys stored in the index point at the namespace's name and at a
+ * reference to the mnemonic in the string cache, like the namespace's
+ * cm_table does. */
+static void
+commodity_key_free (gpointer key)
+{
+    CACHE_REMOVE (((CommodityKey*)key)->mnemonic);
+    g_free (key);
+}
+
+static gboolean
+ns_len_is (const char *name_space, gsize ns_len, const char *name)
+{
+    return strlen (name) == ns_len && memcmp (name_space, name, ns_len) == 0;
+}
+
+static gnc_commodity *
+commodity_table_lookup_key (const gnc_commodity_table *table,
+                            const char *name_space, gsize ns_len,
+                            const char *mnemonic)
+{
+    CommodityKey key;
+    unsigned int i;
+
+    if (ns_len_is (name_space, ns_len, GNC_COMMODITY_NS_ISO))
+    {
+        name_space = GNC_COMMODITY_NS_CURRENCY;
+        ns_len = strlen (name_space);
+    }
+    /*
+     * Backward compatibility support for currencies that have
+     * recently changed.
+     */
+    if (ns_len_is (name_space, ns_len, GNC_COMMODITY_NS_CURRENCY))
+    {
+        for (i = 0; i < GNC_NEW_ISO_CODES; i++)
+        {
+            if (strcmp(mnemonic, gnc_new_iso_codes[i].old_code) == 0)
+            {
+                mnemonic = gnc_new_iso_codes[i].new_code;
+                break;
+            }
+        }
+    }
+    key.name_space = name_space;
+    key.ns_len = ns_len;
+    key.mnemonic = mnemonic;
+    return g_hash_table_lookup (table->cm_index, &key);
+}
+
+static void
+commodity_table_index (gnc_commodity_table *table,
+                       gnc_commodity_namespace *nsp, gnc_commodity *cm)
+{
+    CommodityKey *key = g_new (CommodityKey, 1);
+
+    key->name_space = nsp->name;
+    key->ns_len = strlen (nsp->name);
+    key->mnemonic = CACHE_INSERT (GET_PRIVATE(cm)->mnemonic);
+    g_hash_table_insert (table->cm_index, key, cm);
+    commodity_table_index_cusip (table, cm, TRUE);
+}
+
+static void
+commodity_table_unindex (gnc_commodity_table *table,
+                         gnc_commodity_namespace *nsp, gnc_commodity *cm)
+{
+    CommodityKey key;
+
+    key.name_space = nsp->name;
+    key.ns_len = strlen (nsp->name);
+    key.mnemonic = GET_PRIVATE(cm)->mnemonic;
+    g_hash_table_remove (table->cm_index, &key);
+    commodity_table_index_cusip (table, cm, FALSE);
+}
+
+/* Adds cm to or removes it from the table's index of codes.  When
+ * several commodities have the same code the first one inserted is
+ * found, and when it's removed the next one of the others. */
+static void
+commodity_table_index_cusip (gnc_commodity_table *table, gnc_commodity *cm,
+                             gboolean add)
+{
+    const char *cusip = GET_PRIVATE(cm)->cusip;
+    GList *ns_node, *node;
+
+    if (!table || !cusip || !*cusip)
+        return;
+    if (add)
+    {
+        if (!g_hash_table_contains (table->cusip_index, cusip))
+            g_hash_table_insert (table->cusip_index, CACHE_INSERT (cusip), cm);
+        return;
+    }
+    if (g_hash_table_lookup (table->cusip_index, cusip) != cm)
+        return;
+    g_hash_table_remove (table->cusip_index, cusip);
+    for (ns_node = table->ns_list; ns_node; ns_node = ns_node->next)
+        for (node = ((gnc_commodity_namespace*)ns_node->data)->cm_list;
+             node; node = node->next)
+            if (node->data != cm &&
+                g_strcmp0 (GET_PRIVATE(node->data)->cusip, cusip) == 0)
+            {
+                g_hash_table_insert (table->cusip_index, CACHE_INSERT (cusip),
+                                     node->data);
+                return;
+            }
+}
+
 /********************************************************************
  * gnc_commodity_table_new
  * make a new commodity table
@@ -1743,6 +1925,11 @@ gnc_commodity_table_new(void)
     gnc_commodity_table * retval = g_new0(gnc_commodity_table, 1);
     retval->ns_table = g_hash_table_new(&g_str_hash, &g_str_equal);
     retval->ns_list = NULL;
+    retval->cm_index = g_hash_table_new_full(commodity_key_hash,
+                                             commodity_key_equal,
+                                             commodity_key_free, NULL);
+    retval->cusip_index = g_hash_table_new_full(g_str_hash, g_str_equal,
+                                                qof_string_cache_remove, NULL);
     return retval;
 }
 
@@ -1821,36 +2008,10 @@ gnc_commodity *
 gnc_commodity_table_lookup(const gnc_commodity_table * table,
                            const char * name_space, const char * mnemonic)
 {
-    gnc_commodity_namespace * nsp = NULL;
-    unsigned int i;
-
     if (!table || !name_space || !mnemonic) return NULL;
 
-    nsp = gnc_commodity_table_find_namespace(table, name_space);
-
-    if (nsp)
-    {
-        /*
-         * Backward compatibility support for currencies that have
-         * recently changed.
-         */
-        if (nsp->iso4217)
-        {
-            for (i = 0; i < GNC_NEW_ISO_CODES; i++)
-            {
-                if (strcmp(mnemonic, gnc_new_iso_codes[i].old_code) == 0)
-                {
-                    mnemonic = gnc_new_iso_codes[i].new_code;
-                    break;
-                }
-            }
-        }
-        return g_hash_table_lookup(nsp->cm_table, (gpointer)mnemonic);
-    }
-    else
-    {
-        return NULL;
-    }
+    return commodity_table_lookup_key (table, name_space, strlen (name_space),
+                                       mnemonic);
 }
 
 /********************************************************************
@@ -1862,28 +2023,30 @@ gnc_commodity *
 gnc_commodity_table_lookup_unique(const gnc_commodity_table *table,
                                   const char * unique_name)
 {
-    char *name_space;
-    char *mnemonic;
-    gnc_commodity *commodity;
+    const char *mnemonic;
 
     if (!table || !unique_name) return NULL;
 
-    name_space = g_strdup (unique_name);
-    mnemonic = strstr (name_space, "::");
+    mnemonic = strstr (unique_name, "::");
     if (!mnemonic)
-    {
-        g_free (name_space);
         return NULL;
-    }
 
-    *mnemonic = '\0';
-    mnemonic += 2;
+    return commodity_table_lookup_key (table, unique_name,
+                                       mnemonic - unique_name, mnemonic + 2);
+}
 
-    commodity = gnc_commodity_table_lookup (table, name_space, mnemonic);
+/********************************************************************
+ * gnc_commodity_table_lookup_cusip
+ * locate a commodity by its CUSIP, ISIN or other code.
+ ********************************************************************/
 
-    g_free (name_space);
+gnc_commodity *
+gnc_commodity_table_lookup_cusip(const gnc_commodity_table *table,
+                                 const char * cusip)
+{
+    if (!table || !cusip || !*cusip) return NULL;
 
-    return commodity;
+    return g_hash_table_lookup (table->cusip_index, cusip);
 }
 
 /********************************************************************
@@ -1897,12 +2060,24 @@ gnc_commodity_table_find_full(const gnc_commodity_table * table,
                               const char * fullname)
 {
     gnc_commodity * retval = NULL;
+    gnc_commodity_namespace * nsp;
     GList         * all;
     GList         * iterator;
 
     if (!fullname || (fullname[0] == '\0'))
         return NULL;
 
+    /* Walk the namespace's own list rather than a copy. */
+    if (g_strcmp0 (name_space, GNC_COMMODITY_NS_NONCURRENCY) != 0)
+    {
+        nsp = gnc_commodity_table_find_namespace (table, name_space);
+        for (iterator = nsp ? nsp->cm_list : NULL; iterator;
+             iterator = iterator->next)
+            if (!strcmp (fullname, gnc_commodity_get_printname (iterator->data)))
+                return iterator->data;
+        return NULL;
+    }
+
     all = gnc_commodity_table_get_commodities(table, name_space);
 
     for (iterator = all; iterator; iterator = iterator->next)
@@ -1996,6 +2171,7 @@ gnc_commodity_table_insert(gnc_commodity_table * table,
                         CACHE_INSERT(priv->mnemonic),
                         (gpointer)comm);
     nsp->cm_list = g_list_append(nsp->cm_list, comm);
+    commodity_table_index (table, nsp, comm);
 
     qof_event_gen (&comm->inst, QOF_EVENT_ADD, NULL);
     LEAVE ("(table=%p, comm=%p)", table, comm);
@@ -2025,6 +2201,7 @@ gnc_commodity_table_remove(gnc_commodity_table * table,
     if (c != comm) return;
 
     qof_event_gen (&comm->inst, QOF_EVENT_REMOVE, NULL);
+    commodity_table_unindex (table, priv->name_space, comm);
 
     nsp = gnc_commodity_table_find_namespace(table, ns_name);
     if (!nsp) return;
@@ -2352,11 +2529,19 @@ ns_helper(gpointer key, gpointer value, gpointer user_data)
     return TRUE;
 }
 
+static gboolean
+key_in_namespace(gpointer key, gpointer value, gpointer user_data)
+{
+    return ((CommodityKey*)key)->name_space ==
+        ((gnc_commodity_namespace*)user_data)->name;
+}
+
 void
 gnc_commodity_table_delete_namespace(gnc_commodity_table * table,
                                      const char * name_space)
 {
     gnc_commodity_namespace * ns;
+    GList *node;
 
     if (!table) return;
 
@@ -2368,10 +2553,15 @@ gnc_commodity_table_delete_namespace(gnc_commodity_table * table,
     g_hash_table_remove(table->ns_table, name_space);
     table->ns_list = g_list_remove(table->ns_list, ns);
 
+    for (node = ns->cm_list; node; node = node->next)
+        commodity_table_index_cusip (table, node->data, FALSE);
     g_list_free(ns->cm_list);
     ns->cm_list = NULL;
 
     g_hash_table_foreach_remove(ns->cm_table, ns_helper, NULL);
+    /* Destroying the commodities took them out of cm_index, unless
+     * they were being edited. */
+    g_hash_table_foreach_remove(table->cm_index, key_in_namespace, ns);
     g_hash_table_destroy(ns->cm_table);
     CACHE_REMOVE(ns->name);
 
@@ -2455,6 +2645,8 @@ gnc_commodity_table_destroy(gnc_commodity_table * t)
     t->ns_list = NULL;
     g_hash_table_destroy(t->ns_table);
     t->ns_table = NULL;
+    g_hash_table_destroy(t->cm_index);
+    g_hash_table_destroy(t->cusip_index);
     LEAVE ("table=%p", t);
     g_free(t);
 }
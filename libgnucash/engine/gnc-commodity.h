@@ -740,12 +740,23 @@ gnc_commodity_table * gnc_commodity_table_get_table(QofBook *book);
 /** @name Commodity Table Lookup functions
 @{
 */
+/** Look up a commodity by namespace and mnemonic, and by unique name,
+ *  "NAMESPACE::MNEMONIC".  Both are a single probe of the table's index
+ *  that allocates nothing, so they suit importers looking up a commodity
+ *  per row. */
 gnc_commodity * gnc_commodity_table_lookup(const gnc_commodity_table * table,
         const char * commodity_namespace,
         const char * mnemonic);
 gnc_commodity *
 gnc_commodity_table_lookup_unique(const gnc_commodity_table *table,
                                   const char * unique_name);
+/** Look up a commodity by its CUSIP, ISIN or other identifying code, as
+ *  set with gnc_commodity_set_cusip().  If several commodities have the
+ *  code, the first one put in the table is returned.
+ *  @return The commodity or NULL if none has the code. */
+gnc_commodity *
+gnc_commodity_table_lookup_cusip(const gnc_commodity_table *table,
+                                 const char * cusip);
 gnc_commodity * gnc_commodity_table_find_full(const gnc_commodity_table * t,
         const char * commodity_namespace,
         const char * fullname);
@@ -47,7 +47,10 @@ extern "C"
 #endif
 }
 
+#include <algorithm>
+#include <atomic>
 #include <cinttypes>
+#include <vector>
 #include <unicode/calendar.h>
 
 #include "gnc-date.h"
@@ -118,7 +121,7 @@ gnc_localtime_r (const time64 *secs, struct tm* time)
 {
     try
     {
-        *time = static_cast<struct tm>(GncDateTime(*secs));
+        *time = GncDateTime::local_tm(*secs);
         return time;
     }
     catch(std::invalid_argument&)
@@ -232,9 +235,7 @@ gnc_mktime (struct tm* time)
     try
     {
         normalize_struct_tm (time);
-        GncDateTime gncdt(*time);
-        *time = static_cast<struct tm>(gncdt);
-        return static_cast<time64>(gncdt);
+        return GncDateTime::local_time64(*time);
     }
     catch(std::invalid_argument&)
     {
@@ -375,13 +376,70 @@ gnc_date_string_to_monthformat(const char *fmt_str, GNCDateMonthFormat *format)
     return FALSE;
 }
 
+/* The register formats the date of every visible row on each redraw and
+ * reports do it for every split, so keep the text of the days most
+ * recently printed in each thread. Only formats that print nothing but
+ * the date can be shared by every time on a day; anything else is
+ * formatted for each call. The whole memo is dropped when the date format
+ * preference changes.
+ */
+static std::atomic<unsigned> date_format_generation{1};
+
+struct FormattedDay
+{
+    unsigned generation;
+    int day;
+    std::string format;
+    std::string text;
+};
+
+static bool
+format_is_date_only (const char* format)
+{
+    for (auto c = format; *c; ++c)
+    {
+        if (*c != '%')
+            continue;
+        while (c[1] == 'E' || c[1] == 'O' || c[1] == '-' || c[1] == '#')
+            ++c;
+        if (!c[1] || !strchr ("aAbBCdDeFgGhjmnuUVwWxyY%", c[1]))
+            return false;
+        ++c;
+    }
+    return true;
+}
+
+static const std::string&
+format_local_date (time64 time, const char* format)
+{
+    static thread_local FormattedDay memo[256];
+    static thread_local std::string scratch;
+    if (!format_is_date_only (format))
+    {
+        scratch = GncDateTime(time).format(format);
+        return scratch;
+    }
+    auto tm = GncDateTime::local_tm(time);
+    auto day = (tm.tm_year + 1900) * 512 + tm.tm_yday;
+    auto& entry = memo[static_cast<unsigned>(day) % G_N_ELEMENTS(memo)];
+    auto generation = date_format_generation.load(std::memory_order_relaxed);
+    if (entry.generation != generation || entry.day != day ||
+        entry.format != format)
+    {
+        entry.text = GncDateTime(time).format(format);
+        entry.format = format;
+        entry.day = day;
+        entry.generation = generation;
+    }
+    return entry.text;
+}
+
 char*
 gnc_print_time64(time64 time, const char* format)
 {
     try
     {
-        GncDateTime gncdt(time);
-        auto sstr = gncdt.format(format);
+        const auto& sstr = format_local_date(time, format);
         //ugly C allocation so that the ptr can be freed at the other end
         char* cstr = static_cast<char*>(malloc(sstr.length() + 1));
         memset(cstr, 0, sstr.length() + 1);
@@ -441,6 +499,7 @@ QofDateFormat qof_date_format_get (void)
 
 void qof_date_format_set(QofDateFormat df)
 {
+    ++date_format_generation;
     if (df >= DATE_FORMAT_FIRST && df <= DATE_FORMAT_LAST)
     {
         prevQofDateFormat = dateFormat;
@@ -584,8 +643,7 @@ qof_print_date_buff (char * buff, const size_t len, time64 t)
 
     try
     {
-        GncDateTime gncdt(t);
-        std::string str = gncdt.format(qof_date_format_get_string(dateFormat));
+        const auto& str = format_local_date(t, qof_date_format_get_string(dateFormat));
         strncpy(buff, str.c_str(), len);
         if (str.length() >= len)
             buff[len - 1] = '\0';
@@ -1654,6 +1712,115 @@ gnc_gdate_set_prev_fiscal_year_end (GDate *date,
     g_date_subtract_years(date, 1);
 }
 
+/* ================================================= */
+
+static void
+gnc_gdate_set_period_start (GDate *date, GncDatePeriod period,
+                            const GDate *fy_end)
+{
+    switch (period)
+    {
+    case GNC_DATE_PERIOD_MONTH:
+        gnc_gdate_set_month_start (date);
+        break;
+    case GNC_DATE_PERIOD_QUARTER:
+        gnc_gdate_set_quarter_start (date);
+        break;
+    case GNC_DATE_PERIOD_YEAR:
+        gnc_gdate_set_year_start (date);
+        break;
+    case GNC_DATE_PERIOD_FISCAL_YEAR:
+        gnc_gdate_set_fiscal_year_start (date, fy_end);
+        break;
+    }
+}
+
+static void
+gnc_gdate_set_period_end (GDate *date, GncDatePeriod period,
+                          const GDate *fy_end)
+{
+    switch (period)
+    {
+    case GNC_DATE_PERIOD_MONTH:
+        gnc_gdate_set_month_end (date);
+        break;
+    case GNC_DATE_PERIOD_QUARTER:
+        gnc_gdate_set_quarter_end (date);
+        break;
+    case GNC_DATE_PERIOD_YEAR:
+        gnc_gdate_set_year_end (date);
+        break;
+    case GNC_DATE_PERIOD_FISCAL_YEAR:
+        gnc_gdate_set_fiscal_year_end (date, fy_end);
+        break;
+    }
+}
+
+time64*
+gnc_date_period_starts (time64 start, time64 end, GncDatePeriod period,
+                        const GDate *fy_end, size_t *count)
+{
+    g_return_val_if_fail (count, nullptr);
+    *count = 0;
+    g_return_val_if_fail (period != GNC_DATE_PERIOD_FISCAL_YEAR || fy_end,
+                          nullptr);
+    g_return_val_if_fail (period >= GNC_DATE_PERIOD_MONTH &&
+                          period <= GNC_DATE_PERIOD_FISCAL_YEAR, nullptr);
+
+    auto date = time64_to_gdate (start);
+    auto last = time64_to_gdate (end);
+    if (g_date_compare (&date, &last) > 0)
+        return nullptr;
+
+    std::vector<time64> starts;
+    gnc_gdate_set_period_start (&date, period, fy_end);
+    while (g_date_compare (&date, &last) <= 0)
+    {
+        starts.push_back (gnc_time64_get_day_start_gdate (&date));
+        /* The next period starts the day after this one ends, which spares
+         * adding months to days that not every month has. */
+        gnc_gdate_set_period_end (&date, period, fy_end);
+        g_date_add_days (&date, 1);
+    }
+    starts.push_back (gnc_time64_get_day_start_gdate (&date));
+
+    auto result = g_new (time64, starts.size());
+    std::copy (starts.begin(), starts.end(), result);
+    *count = starts.size();
+    return result;
+}
+
+void
+gnc_date_bucket_times (const time64 *boundaries, size_t n_boundaries,
+                       const time64 *times, size_t n_times, gint *buckets)
+{
+    g_return_if_fail (times || !n_times);
+    g_return_if_fail (buckets || !n_times);
+    g_return_if_fail (boundaries || !n_boundaries);
+
+    for (size_t i = 0; i < n_times; ++i)
+    {
+        auto time = times[i];
+        if (!n_boundaries || time < boundaries[0])
+        {
+            buckets[i] = -1;
+            continue;
+        }
+        /* Narrow [base, base + len) to the last boundary <= time. The
+         * halving is unconditional and the choice of half is a select, so
+         * the compiler can emit it without unpredictable branches. */
+        auto base = boundaries;
+        auto len = n_boundaries;
+        while (len > 1)
+        {
+            auto half = len / 2;
+            base = (base[half] <= time) ? base + half : base;
+            len -= half;
+        }
+        buckets[i] = static_cast<gint>(base - boundaries);
+    }
+}
+
 Testfuncs*
 gnc_date_load_funcs (void)
 {
@@ -817,6 +817,68 @@ void gnc_gdate_set_prev_fiscal_year_end (GDate *date, const GDate *year_end);
 
 //@}
 
+/* ======================================================== */
+
+/** \name Period Boundaries and Bucketing */
+// @{
+
+/** The kinds of period that gnc_date_period_starts() can generate. */
+typedef enum
+{
+    GNC_DATE_PERIOD_MONTH,
+    GNC_DATE_PERIOD_QUARTER,
+    GNC_DATE_PERIOD_YEAR,
+    GNC_DATE_PERIOD_FISCAL_YEAR,
+} GncDatePeriod;
+
+/** Compute the start times of the successive periods covering the days
+ *  from start to end. The first entry is the start of the period
+ *  containing start; the last is the start of the period following the
+ *  one containing end, so that entries i and i + 1 bracket period i.
+ *  For example, months from 2003-09-24 to 2003-11-02 give the starts of
+ *  2003-09-01, 2003-10-01, 2003-11-01 and 2003-12-01.
+ *
+ *  @param start A time on the first day to cover.
+ *
+ *  @param end A time on the last day to cover.
+ *
+ *  @param period The kind of period.
+ *
+ *  @param year_end For GNC_DATE_PERIOD_FISCAL_YEAR, a GDate containing
+ *  the last month and day of the fiscal year, e.g. from
+ *  gnc_accounting_period_fiscal_end(). The year field is ignored, as is
+ *  the argument for the other kinds of period.
+ *
+ *  @param count Set to the number of entries returned.
+ *
+ *  @return A newly allocated array of time64 which the caller must
+ *  g_free, or NULL with count set to 0 if end is before start. */
+time64* gnc_date_period_starts (time64 start, time64 end, GncDatePeriod period,
+                                const GDate *year_end, size_t *count);
+
+/** Find the bucket of each of a set of times, where bucket i runs from
+ *  boundaries[i] up to but not including boundaries[i + 1] and the last
+ *  bucket is open-ended, as with the result of gnc_date_period_starts().
+ *  Times before boundaries[0] go in bucket -1. Each time is placed with
+ *  a branch-free binary search, so neither array's order affects the
+ *  cost, though the boundaries must be sorted.
+ *
+ *  @param boundaries The sorted bucket boundaries.
+ *
+ *  @param n_boundaries The number of boundaries.
+ *
+ *  @param times The times to place.
+ *
+ *  @param n_times The number of times.
+ *
+ *  @param buckets An array of at least n_times entries to receive the
+ *  bucket index of each time. */
+void gnc_date_bucket_times (const time64 *boundaries, size_t n_boundaries,
+                            const time64 *times, size_t n_times,
+                            gint *buckets);
+
+//@}
+
 //@}
 #ifdef __cplusplus
 }
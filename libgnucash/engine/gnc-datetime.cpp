@@ -34,6 +34,8 @@ extern "C"
 #include <boost/regex.hpp>
 #include <libintl.h>
 #include <locale.h>
+#include <atomic>
+#include <cctype>
 #include <map>
 #include <memory>
 #include <iostream>
@@ -213,16 +215,151 @@ LDT_from_struct_tm(const struct tm tm)
 
 using TD = boost::posix_time::time_duration;
 
+/* Bumped whenever tzp changes, invalidating every thread's offset cache. */
+static std::atomic<unsigned> tzp_generation{1};
+
 void
 _set_tzp(TimeZoneProvider& new_tzp)
 {
     tzp = &new_tzp;
+    ++tzp_generation;
 }
 
 void
 _reset_tzp()
 {
     tzp = &ltzp;
+    ++tzp_generation;
+}
+
+/* Local time conversion cache.
+ *
+ * Converting between time64 and local broken-down time with boost::local_time
+ * means looking up the zone for the year and building a local_date_time,
+ * which is far more work than the arithmetic once the UTC offset is known.
+ * Each thread therefore remembers the offset in effect for recently used UTC
+ * days. Days with a DST or other offset change, and times outside of the
+ * supported range, still take the boost path.
+ */
+static constexpr time64 seconds_per_day = 86400;
+
+struct LocalOffset
+{
+    unsigned generation;
+    time64 day;
+    long offset;
+    int isdst;
+    bool uniform;       // The offset doesn't change during the day.
+};
+
+static constexpr size_t local_offset_cache_size = 1024;
+static thread_local LocalOffset local_offset_cache[local_offset_cache_size];
+
+static inline time64
+floor_div(time64 a, time64 b)
+{
+    return a / b - (a % b < 0 ? 1 : 0);
+}
+
+static const LocalOffset&
+local_offset_for_day(time64 day)
+{
+    auto generation = tzp_generation.load(std::memory_order_relaxed);
+    auto& entry = local_offset_cache[static_cast<uint64_t>(day) %
+                                     local_offset_cache_size];
+    if (entry.generation == generation && entry.day == day)
+        return entry;
+    entry = {generation, day, 0, 0, false};
+    try
+    {
+        GncDateTime first(day * seconds_per_day);
+        GncDateTime last(day * seconds_per_day + seconds_per_day - 1);
+        auto first_tm = static_cast<struct tm>(first);
+        auto last_tm = static_cast<struct tm>(last);
+        entry.offset = first.offset();
+        entry.isdst = first_tm.tm_isdst;
+        entry.uniform = entry.offset == last.offset() &&
+            entry.isdst == last_tm.tm_isdst;
+    }
+    catch (const std::invalid_argument&)
+    {
+    }
+    return entry;
+}
+
+/* The offset in effect throughout the UTC day containing time and the days
+ * either side of it, so that a local time near it can only map to one time64.
+ */
+static bool
+stable_local_offset(time64 time, const LocalOffset*& result)
+{
+    auto day = floor_div(time, seconds_per_day);
+    auto& entry = local_offset_for_day(day);
+    if (!entry.uniform)
+        return false;
+    for (auto other : {day - 1, day + 1})
+    {
+        auto& neighbor = local_offset_for_day(other);
+        if (!neighbor.uniform || neighbor.offset != entry.offset ||
+            neighbor.isdst != entry.isdst)
+            return false;
+    }
+    result = &entry;
+    return true;
+}
+
+/* Days since 1970-01-01 in the proleptic Gregorian calendar and back, after
+ * Howard Hinnant's chrono-compatible low-level date algorithms.
+ */
+static time64
+days_from_civil(time64 year, unsigned month, unsigned day)
+{
+    year -= month <= 2;
+    auto era = floor_div(year, 400);
+    auto yoe = static_cast<unsigned>(year - era * 400);
+    auto doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    auto doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + static_cast<time64>(doe) - 719468;
+}
+
+static void
+civil_from_days(time64 days, int& year, unsigned& month, unsigned& day)
+{
+    days += 719468;
+    auto era = floor_div(days, 146097);
+    auto doe = static_cast<unsigned>(days - era * 146097);
+    auto yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    auto doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    auto mp = (5 * doy + 2) / 153;
+    day = doy - (153 * mp + 2) / 5 + 1;
+    month = mp < 10 ? mp + 3 : mp - 9;
+    year = static_cast<int>(yoe + era * 400 + (month <= 2));
+}
+
+/* Fill a struct tm the way GncDateTime's conversion does for a local time of
+ * local_secs seconds from the epoch. */
+static struct tm
+local_tm_from_seconds(time64 local_secs, const LocalOffset& local_offset)
+{
+    struct tm tm{};
+    auto days = floor_div(local_secs, seconds_per_day);
+    auto secs = static_cast<int>(local_secs - days * seconds_per_day);
+    int year;
+    unsigned month, day;
+    civil_from_days(days, year, month, day);
+    tm.tm_year = year - 1900;
+    tm.tm_mon = static_cast<int>(month) - 1;
+    tm.tm_mday = static_cast<int>(day);
+    tm.tm_hour = secs / 3600;
+    tm.tm_min = secs % 3600 / 60;
+    tm.tm_sec = secs % 60;
+    tm.tm_wday = static_cast<int>((days % 7 + 11) % 7); // 1970-01-01 was a Thursday.
+    tm.tm_yday = static_cast<int>(days - days_from_civil(year, 1, 1));
+    tm.tm_isdst = local_offset.isdst;
+#if HAVE_STRUCT_TM_GMTOFF
+    tm.tm_gmtoff = local_offset.offset;
+#endif
+    return tm;
 }
 
 class GncDateTimeImpl
@@ -545,6 +682,93 @@ GncDateTimeImpl::timestamp()
 
 /* Member function definitions for GncDateImpl.
  */
+
+/* Split str into the day, month and year fields named by fmt without going
+ * through the format's regex, for the shapes that make up nearly all
+ * imported dates: three runs of digits separated by runs of "-/.' ", or a
+ * single run of digits with two-digit days and months and a four-digit
+ * year. Yearless formats also accept two runs, or four or more digits.
+ *
+ * The regex would parse any string accepted here into the same fields;
+ * return false for anything else so that the caller can use it instead.
+ */
+static inline char
+field_name (const std::string& fmt, size_t field)
+{
+    // The third field of a yearless format can only be a year.
+    return 2 * field < fmt.size() ? fmt[2 * field] : 'y';
+}
+
+static bool
+parse_date_fields (const std::string& str, const std::string& fmt,
+                   int& year, int& month, int& day, bool& has_year)
+{
+    constexpr size_t max_digits = 9; // So that nothing overflows an int.
+    const char* separators = "-/.' ";
+    size_t start[3], len[3];
+    size_t nfields = 0;
+    for (size_t pos = 0; pos < str.size();)
+    {
+        if (nfields == 3 || !isdigit(static_cast<unsigned char>(str[pos])))
+            return false;
+        start[nfields] = pos;
+        while (pos < str.size() && isdigit(static_cast<unsigned char>(str[pos])))
+            ++pos;
+        len[nfields] = pos - start[nfields];
+        if (len[nfields++] > max_digits)
+            return false;
+        auto sep_end = str.find_first_not_of(separators, pos);
+        if (sep_end == pos)
+            return false;
+        if (sep_end == std::string::npos)
+        {
+            if (pos != str.size())
+                return false; // Trailing separators.
+            break;
+        }
+        pos = sep_end;
+    }
+
+    auto fmt_has_year = (fmt.find('y') != std::string::npos);
+    if (nfields == 1)
+    {
+        /* Split the run of digits into fixed-width fields. */
+        auto digits = len[0];
+        if (fmt_has_year ? digits != 8 : digits < 4 || digits > 4 + max_digits)
+            return false;
+        nfields = fmt_has_year || digits > 4 ? 3 : 2;
+        for (size_t i = 0, pos = 0; i < nfields; ++i)
+        {
+            start[i] = pos;
+            len[i] = field_name (fmt, i) == 'y' ? digits - 4 : 2;
+            pos += len[i];
+        }
+    }
+    else if (nfields == 2 ? fmt_has_year : nfields != 3)
+        return false;
+
+    has_year = (nfields == 3);
+    for (size_t i = 0; i < nfields; ++i)
+    {
+        auto value = 0;
+        for (auto c = str.cbegin() + start[i]; c != str.cbegin() + start[i] + len[i]; ++c)
+            value = value * 10 + (*c - '0');
+        switch (field_name (fmt, i))
+        {
+        case 'y':
+            year = value;
+            break;
+        case 'm':
+            month = value;
+            break;
+        default:
+            day = value;
+            break;
+        }
+    }
+    return true;
+}
+
 GncDateImpl::GncDateImpl(const std::string str, const std::string fmt) :
     m_greg(boost::gregorian::day_clock::local_day()) /* Temporarily initialized to today, will be used and adjusted in the code below */
 {
@@ -553,23 +777,40 @@ GncDateImpl::GncDateImpl(const std::string str, const std::string fmt) :
     if (iter == GncDate::c_formats.cend())
         throw std::invalid_argument(N_("Unknown date format specifier passed as argument."));
 
-    boost::regex r(iter->m_re);
-    boost::smatch what;
-    if(!boost::regex_search(str, what, r))  // regex didn't find a match
-        throw std::invalid_argument (N_("Value can't be parsed into a date using the selected date format."));
-
-    // Bail out if a year was found with a yearless format specifier
     auto fmt_has_year = (fmt.find('y') != std::string::npos);
-    if (!fmt_has_year && (what.length("YEAR") != 0))
+    int year = 0, month = 0, day = 0;
+    bool has_year = false;
+    if (!parse_date_fields (str, fmt, year, month, day, has_year))
+    {
+        /* Compiling the regexes is the expensive part so only do it once. */
+        static const std::vector<boost::regex> format_regexes = []() {
+            std::vector<boost::regex> regexes;
+            for (const auto& format : GncDate::c_formats)
+                regexes.emplace_back(format.m_re);
+            return regexes;
+        }();
+        const auto& r = format_regexes[iter - GncDate::c_formats.cbegin()];
+        boost::smatch what;
+        if(!boost::regex_search(str, what, r))  // regex didn't find a match
+            throw std::invalid_argument (N_("Value can't be parsed into a date using the selected date format."));
+
+        // Bail out if a year was found with a yearless format specifier
+        has_year = (what.length("YEAR") != 0);
+        if (!fmt_has_year && has_year)
+            throw std::invalid_argument (N_("Value appears to contain a year while the selected format forbids this."));
+        if (fmt_has_year)
+            year = std::stoi (what.str("YEAR"));
+        month = std::stoi (what.str("MONTH"));
+        day = std::stoi (what.str("DAY"));
+    }
+
+    else if (!fmt_has_year && has_year)
         throw std::invalid_argument (N_("Value appears to contain a year while the selected format forbids this."));
 
-    int year;
     if (fmt_has_year)
     {
-        /* The input dates have a year, so use that one */
-        year = std::stoi (what.str("YEAR"));
-
-        /* We assume two-digit years to be in the range 1969 - 2068. */
+        /* The input dates have a year, so use that one. We assume
+         * two-digit years to be in the range 1969 - 2068. */
         if (year < 69)
                 year += 2000;
         else if (year < 100)
@@ -578,9 +819,7 @@ GncDateImpl::GncDateImpl(const std::string str, const std::string fmt) :
     else /* The input dates have no year, so use current year */
         year = m_greg.year(); // Can use m_greg here as it was already initialized in the initializer list earlier
 
-    m_greg = Date(year,
-                  static_cast<Month>(std::stoi (what.str("MONTH"))),
-                  std::stoi (what.str("DAY")));
+    m_greg = Date(year, static_cast<Month>(month), day);
 }
 
 ymd
@@ -686,6 +925,46 @@ GncDateTime::timestamp()
     return GncDateTimeImpl::timestamp();
 }
 
+struct tm
+GncDateTime::local_tm(time64 time)
+{
+    if (time >= MINTIME && time <= MAXTIME)
+    {
+        auto& local_offset = local_offset_for_day(floor_div(time, seconds_per_day));
+        if (local_offset.uniform)
+            return local_tm_from_seconds(time + local_offset.offset,
+                                         local_offset);
+    }
+    return static_cast<struct tm>(GncDateTime(time));
+}
+
+time64
+GncDateTime::local_time64(struct tm& tm)
+{
+    auto local_secs =
+        days_from_civil(tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday) *
+        seconds_per_day + tm.tm_hour * 3600 + tm.tm_min * 60 + tm.tm_sec;
+    const LocalOffset *guess, *local_offset;
+    /* The offset is only known to apply once it's confirmed for the UTC
+     * day it gives; the neighboring days must agree, too, or the local
+     * time could be ambiguous or skipped. */
+    if (local_secs >= MINTIME && local_secs <= MAXTIME &&
+        stable_local_offset(local_secs, guess))
+    {
+        auto time = local_secs - guess->offset;
+        if (time >= MINTIME && time <= MAXTIME &&
+            stable_local_offset(time, local_offset) &&
+            local_offset->offset == guess->offset)
+        {
+            tm = local_tm_from_seconds(local_secs, *local_offset);
+            return time;
+        }
+    }
+    GncDateTime gncdt(tm);
+    tm = static_cast<struct tm>(gncdt);
+    return static_cast<time64>(gncdt);
+}
+
 /* GncDate */
 GncDate::GncDate() : m_impl{new GncDateImpl} {}
 GncDate::GncDate(int year, int month, int day) :
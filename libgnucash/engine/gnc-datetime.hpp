@@ -156,7 +156,24 @@ public:
  *  @return a std::string in the format YYYYMMDDHHMMSS.
  */
     static std::string timestamp();
-    
+/** Convert a time64 to a struct tm in the current timezone.
+ *  Equivalent to static_cast<struct tm>(GncDateTime(time)), but the UTC
+ *  offsets of recently used days are cached per thread so that most
+ *  conversions need only integer arithmetic.
+ *  @param time Seconds from the POSIX epoch.
+ *  @return struct tm representing the local time.
+ *  @exception std::invalid_argument if the year is outside the constraints.
+ */
+    static struct tm local_tm(time64 time);
+/** Convert a normalized struct tm in the current timezone to a time64,
+ *  filling in its remaining fields the way local_tm() would. Equivalent to
+ *  constructing a GncDateTime from tm but uses the same cache as local_tm().
+ *  @param tm A struct tm with all fields within their normal ranges.
+ *  @return Seconds from the POSIX epoch.
+ *  @exception std::invalid_argument if the year is outside the constraints.
+ */
+    static time64 local_time64(struct tm& tm);
+
 private:
     std::unique_ptr<GncDateTimeImpl> m_impl;
 };
@@ -52,6 +52,9 @@ static gncFeature known_features[] =
     { GNC_FEATURE_BUDGET_UNREVERSED, "Store budget amounts unreversed (i.e. natural) signs (requires at least Gnucash 3.8)"},
     { GNC_FEATURE_BUDGET_SHOW_EXTRA_ACCOUNT_COLS, "Show extra account columns in the Budget View (requires at least Gnucash 3.8)"},
     { GNC_FEATURE_EQUITY_TYPE_OPENING_BALANCE, GNC_FEATURE_EQUITY_TYPE_OPENING_BALANCE " (requires at least Gnucash 4.3)" },
+    { GNC_FEATURE_SQL_ACCOUNT_BALANCES, "Keep the balance of each account in a table of SQL databases, updated with every split (requires at least Gnucash 4.5)" },
+    { GNC_FEATURE_SQL_NATIVE_GUIDS, "Store GUIDs in PostgreSQL databases as uuid rather than text (requires at least Gnucash 4.5)" },
+    { GNC_FEATURE_ARCHIVE_FILE, "Old transactions moved to an archive file, with their sums kept as the accounts' starting balances (requires at least Gnucash 4.5)" },
     { NULL },
 };
 
@@ -68,11 +71,39 @@ static void gnc_features_init ()
     if (features_table)
         return;
 
+    /* Each known feature maps to its entry, whose index in
+     * known_features is its bit in the book's cached feature mask. */
+    G_STATIC_ASSERT (G_N_ELEMENTS (known_features) - 1 <= 64);
     features_table = g_hash_table_new (g_str_hash, g_str_equal);
     for (i = 0; known_features[i].key; i++)
         g_hash_table_insert (features_table,
-                             g_strdup (known_features[i].key),
-                             g_strdup (known_features[i].desc));
+                             (gpointer)known_features[i].key,
+                             &known_features[i]);
+}
+
+static void gnc_features_add_to_mask (gpointer pkey, gpointer value,
+                                      gpointer data)
+{
+    gncFeature *known = g_hash_table_lookup (features_table, pkey);
+    if (known)
+        *(guint64*)data |= G_GUINT64_CONSTANT(1) << (known - known_features);
+}
+
+/* The bitmask of the known features used by the book, rebuilt from its
+ * "features" frame when it has changed since the last time. */
+static guint64 gnc_features_get_mask (QofBook *book)
+{
+    if (!book->cached_features_isvalid)
+    {
+        GHashTable *features_used = qof_book_get_features (book);
+        guint64 mask = 0;
+
+        g_hash_table_foreach (features_used, &gnc_features_add_to_mask, &mask);
+        g_hash_table_unref (features_used);
+        book->cached_features = mask;
+        book->cached_features_isvalid = TRUE;
+    }
+    return book->cached_features;
 }
 
 static void gnc_features_test_one(gpointer pkey, gpointer value,
@@ -138,7 +169,7 @@ gchar *gnc_features_test_unknown (QofBook *book)
 
 void gnc_features_set_used (QofBook *book, const gchar *feature)
 {
-    const gchar *description;
+    gncFeature *known;
 
     g_return_if_fail (book);
     g_return_if_fail (feature);
@@ -146,14 +177,14 @@ void gnc_features_set_used (QofBook *book, const gchar *feature)
     gnc_features_init();
 
     /* Can't set an unknown feature */
-    description = g_hash_table_lookup (features_table, feature);
-    if (!description)
+    known = g_hash_table_lookup (features_table, feature);
+    if (!known)
     {
         PWARN("Tried to set unknown feature as used.");
         return;
     }
 
-    qof_book_set_feature (book, feature, description);
+    qof_book_set_feature (book, feature, known->desc);
 }
 
 struct CheckFeature
@@ -174,10 +205,21 @@ static void gnc_features_check_feature_cb (gpointer pkey, gpointer value,
 
 gboolean gnc_features_check_used (QofBook *book, const gchar * feature)
 {
-    GHashTable *features_used = qof_book_get_features (book);
+    GHashTable *features_used;
     struct CheckFeature check_data = {feature, FALSE};
+    gncFeature *known;
+
+    g_return_val_if_fail (book, FALSE);
     /* Setup the known_features hash table */
     gnc_features_init();
+
+    known = feature ? g_hash_table_lookup (features_table, feature) : NULL;
+    if (known)
+        return (gnc_features_get_mask (book) >>
+                (known - known_features)) & 1;
+
+    /* A feature of a later version can only be found in the frame. */
+    features_used = qof_book_get_features (book);
     g_hash_table_foreach (features_used, &gnc_features_check_feature_cb, &check_data);
     g_hash_table_unref (features_used);
     return check_data.found;
@@ -56,6 +56,9 @@ extern "C" {
 #define GNC_FEATURE_BUDGET_UNREVERSED "Use natural signs in budget amounts"
 #define GNC_FEATURE_BUDGET_SHOW_EXTRA_ACCOUNT_COLS "Show extra account columns in the Budget View"
 #define GNC_FEATURE_EQUITY_TYPE_OPENING_BALANCE "Use a dedicated opening balance account identified by an 'equity-type' slot"
+#define GNC_FEATURE_SQL_ACCOUNT_BALANCES "Account balances kept in SQL databases"
+#define GNC_FEATURE_SQL_NATIVE_GUIDS "GUIDs stored natively in SQL databases"
+#define GNC_FEATURE_ARCHIVE_FILE "Transactions moved to an archive file"
 
 /** @} */
 
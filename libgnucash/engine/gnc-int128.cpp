@@ -62,6 +62,18 @@ namespace {
     {
         return leg & nummask;
     }
+/* GCC and Clang provide a native 128-bit integer on 64-bit targets; where
+ * it's available multiplication and division use it instead of Knuth's
+ * algorithms on 32-bit sublegs.
+ */
+#ifdef __SIZEOF_INT128__
+#define GNC_INT128_NATIVE 1
+    __extension__ typedef unsigned __int128 native_uint128;
+    static inline native_uint128 to_native(uint64_t hi, uint64_t lo)
+    {
+        return (static_cast<native_uint128>(hi) << GncInt128::legbits) | lo;
+    }
+#endif
 }
 
 GncInt128::GncInt128 () : m_hi {0}, m_lo {0}{}
@@ -526,6 +538,21 @@ GncInt128::operator*= (const GncInt128& b) noexcept
         return *this;
     }
 
+#ifdef GNC_INT128_NATIVE
+    /* The bit count check above bounds the product to 126 bits, so the
+     * native multiply can't wrap; hi or bhi is 0, which makes it one or
+     * two hardware multiplies. */
+    auto product = to_native(hi, m_lo) * to_native(bhi, b.m_lo);
+    if ((product >> 64) > nummask)
+    {
+        flags |= overflow;
+        m_hi = set_flags(m_hi, flags);
+        return *this;
+    }
+    m_lo = static_cast<uint64_t>(product);
+    m_hi = set_flags(static_cast<uint64_t>(product >> 64), flags);
+    return *this;
+#else
 /* This is Knuth's "classical" multi-precision multiplication algorithm
  * truncated to a GncInt128 result with the loop unrolled for clarity and with
  * overflow and zero checks beforehand to save time. See Donald Knuth, "The Art
@@ -587,6 +614,7 @@ GncInt128::operator*= (const GncInt128& b) noexcept
     }
     m_hi = set_flags(hi, flags);
     return *this;
+#endif
 }
 
 namespace {
@@ -632,7 +660,7 @@ div_multi_leg (uint64_t* u, size_t m, uint64_t* v, size_t n,
         }
         else
             carry = UINT64_C(0);
-        assert (v[i] < sublegmask);
+        assert (v[i] <= sublegmask);
     }
     assert (carry == UINT64_C(0));
     for (int j = m - n; j >= 0; j--) //D3
@@ -649,48 +677,44 @@ div_multi_leg (uint64_t* u, size_t m, uint64_t* v, size_t n,
             rhat += v[n - 1];
         }
         carry = UINT64_C(0);
-        uint64_t borrow {};
+        int64_t borrow {};
         for (size_t k = 0; k < n; ++k) //D4
         {
             auto subend = qhat * v[k] + carry;
             carry = subend >> sublegbits;
-            subend &= sublegmask;
-            if (u[j + k] >= subend)
-            {
-                u[j + k] = u[j + k] - subend;
-                borrow = UINT64_C(0);
-            }
-            else
-            {
-                if (u[j + k + 1] > 0)
-                    --u[j + k + 1];
-                else
-                    ++borrow;
-                u[j + k] = u[j + k] + sublegmask + 1 - subend;
-                u[j + k] &= sublegmask;
-            }
+            auto diff = static_cast<int64_t>(u[j + k]) -
+                static_cast<int64_t>(subend & sublegmask) - borrow;
+            u[j + k] = static_cast<uint64_t>(diff) & sublegmask;
+            borrow = diff < 0 ? 1 : 0;
         }
-        u[j + n] -= carry;
+        auto diff = static_cast<int64_t>(u[j + n]) -
+            static_cast<int64_t>(carry) - borrow;
+        u[j + n] = static_cast<uint64_t>(diff) & sublegmask;
         qv[j] = qhat;
-        if (borrow) //D5
+        if (diff < 0) //D5
         { //D6
             --qv[j];
             carry = UINT64_C(0);
             for (size_t k = 0; k < n; ++k)
             {
                 u[j + k] += v[k] + carry;
-                if (u[j + k] > sublegmask)
-                {
-                    carry = u[j + k] >> sublegbits;
-                    u[j + k] &= sublegmask;
-                }
+                carry = u[j + k] >> sublegbits;
+                u[j + k] &= sublegmask;
             }
-            u[j + n] += carry;
+            u[j + n] = (u[j + n] + carry) & sublegmask;
         }
     }//D7
     q = GncInt128 ((qv[3] << sublegbits) + qv[2], (qv[1] << sublegbits) + qv[0]);
+    /* D8: Unnormalize the remainder. It has to be done on the sublegs
+     * because before the division it may be too big for a GncInt128. */
+    carry = UINT64_C(0);
+    for (int i = n - 1; i >= 0; --i)
+    {
+        auto cur = (carry << sublegbits) + u[i];
+        u[i] = cur / d;
+        carry = cur % d;
+    }
     r = GncInt128 ((u[3] << sublegbits) + u[2], (u[1] << sublegbits) + u[0]);
-    r /= d;
     if (negative) q = -q;
     if (rnegative) r = -r;
 }
@@ -793,6 +817,17 @@ GncInt128::div (const GncInt128& b, GncInt128& q, GncInt128& r) const noexcept
         return;
     }
 
+#ifdef GNC_INT128_NATIVE
+    auto dividend = to_native(hi, m_lo);
+    auto divisor = to_native(bhi, b.m_lo);
+    auto quotient = dividend / divisor;
+    auto remainder = dividend % divisor;
+    /* Neither can be larger than the dividend, so they can't overflow. */
+    q.m_lo = static_cast<uint64_t>(quotient);
+    q.m_hi = set_flags(static_cast<uint64_t>(quotient >> 64), qflags);
+    r.m_lo = static_cast<uint64_t>(remainder);
+    r.m_hi = set_flags(static_cast<uint64_t>(remainder >> 64), rflags);
+#else
     uint64_t u[sublegs + 2] {(m_lo & sublegmask), (m_lo >> sublegbits),
             (hi & sublegmask), (hi >> sublegbits), 0, 0};
     uint64_t v[sublegs] {(b.m_lo & sublegmask), (b.m_lo >> sublegbits),
@@ -805,6 +840,7 @@ GncInt128::div (const GncInt128& b, GncInt128& q, GncInt128& r) const noexcept
         return div_single_leg (u, m, v[0], q, r);
 
     return div_multi_leg (u, m, v, n, q, r);
+#endif
 }
 
 GncInt128&
@@ -92,6 +92,10 @@ typedef struct GNCLotPrivate
     signed char is_closed;
 #define LOT_CLOSED_UNKNOWN (-1)
 
+    /* Cached sum of the split amounts, valid unless balance_dirty is set. */
+    gnc_numeric balance;
+    gboolean balance_dirty;
+
     /* traversal marker, handy for preventing recursion */
     unsigned char marker;
 } GNCLotPrivate;
@@ -116,6 +120,8 @@ gnc_lot_init(GNCLot* lot)
     priv->splits = NULL;
     priv->cached_invoice = NULL;
     priv->is_closed = LOT_CLOSED_UNKNOWN;
+    priv->balance = gnc_numeric_zero();
+    priv->balance_dirty = TRUE;
     priv->marker = 0;
 }
 
@@ -186,6 +192,8 @@ gnc_lot_set_property (GObject* object,
     {
     case PROP_IS_CLOSED:
         priv->is_closed = g_value_get_int(value);
+        if (priv->is_closed != TRUE && priv->account)
+            gnc_account_lot_maybe_open (priv->account, lot);
         break;
     case PROP_MARKER:
         priv->marker = g_value_get_int(value);
@@ -205,16 +213,28 @@ gnc_lot_set_property (GObject* object,
      }
 }
 
+static void
+gnc_lot_add_memory_usage(const QofInstance* inst, QofMemoryUsage* usage)
+{
+    GNCLotPrivate* priv = GET_PRIVATE(inst);
+
+    usage->instance_bytes += sizeof(GNCLotPrivate);
+    qof_memory_usage_add_list(usage, priv->splits);
+}
+
 static void
 gnc_lot_class_init(GNCLotClass* klass)
 {
     GObjectClass* gobject_class = G_OBJECT_CLASS(klass);
+    QofInstanceClass* qof_class = QOF_INSTANCE_CLASS(klass);
 
     gobject_class->dispose = gnc_lot_dispose;
     gobject_class->finalize = gnc_lot_finalize;
     gobject_class->get_property = gnc_lot_get_property;
     gobject_class->set_property = gnc_lot_set_property;
 
+    qof_class->add_memory_usage = gnc_lot_add_memory_usage;
+
     g_object_class_install_property(
         gobject_class,
         PROP_IS_CLOSED,
@@ -282,18 +302,23 @@ gnc_lot_free(GNCLot* lot)
     if (!lot) return;
 
     ENTER ("(lot=%p)", lot);
-    qof_event_gen (QOF_INSTANCE(lot), QOF_EVENT_DESTROY, NULL);
-
     priv = GET_PRIVATE(lot);
-    for (node = priv->splits; node; node = node->next)
+
+    /* When the book is closing the splits and accounts are already gone. */
+    if (!qof_book_shutting_down (qof_instance_get_book (lot)))
     {
-        Split *s = node->data;
-        s->lot = NULL;
+        qof_event_gen (QOF_INSTANCE(lot), QOF_EVENT_DESTROY, NULL);
+        for (node = priv->splits; node; node = node->next)
+        {
+            Split *s = node->data;
+            s->lot = NULL;
+        }
+
+        if (priv->account && !qof_instance_get_destroying(priv->account))
+            xaccAccountRemoveLot (priv->account, lot);
     }
     g_list_free (priv->splits);
-
-    if (priv->account && !qof_instance_get_destroying(priv->account))
-        xaccAccountRemoveLot (priv->account, lot);
+    priv->splits = NULL;
 
     priv->account = NULL;
     priv->is_closed = TRUE;
@@ -413,9 +438,39 @@ gnc_lot_set_closed_unknown(GNCLot* lot)
     {
         priv = GET_PRIVATE(lot);
         priv->is_closed = LOT_CLOSED_UNKNOWN;
+        priv->balance_dirty = TRUE;
+        if (priv->account)
+            gnc_account_lot_maybe_open (priv->account, lot);
     }
 }
 
+/* Adjust the cached balance by the amount of a split entering or leaving
+ * the lot, or drop the cache if it can't be adjusted. */
+static void
+gnc_lot_adjust_balance (GNCLot *lot, gnc_numeric amount)
+{
+    GNCLotPrivate* priv = GET_PRIVATE(lot);
+    gnc_numeric baln;
+
+    if (priv->balance_dirty)
+    {
+        gnc_lot_set_closed_unknown (lot);
+        return;
+    }
+
+    baln = gnc_numeric_add_fixed (priv->balance, amount);
+    if (gnc_numeric_check (baln) != GNC_ERROR_OK)
+    {
+        gnc_lot_set_closed_unknown (lot);
+        return;
+    }
+
+    priv->balance = baln;
+    priv->is_closed = gnc_numeric_zero_p (baln) && priv->splits;
+    if (!priv->is_closed && priv->account)
+        gnc_account_lot_maybe_open (priv->account, lot);
+}
+
 SplitList *
 gnc_lot_get_split_list (const GNCLot *lot)
 {
@@ -499,9 +554,17 @@ gnc_lot_get_balance (GNCLot *lot)
     if (!priv->splits)
     {
         priv->is_closed = FALSE;
+        priv->balance = zero;
+        priv->balance_dirty = FALSE;
         return zero;
     }
 
+    if (!priv->balance_dirty)
+    {
+        priv->is_closed = gnc_numeric_equal (priv->balance, zero);
+        return priv->balance;
+    }
+
     /* Sum over splits; because they all belong to same account
      * they will have same denominator.
      */
@@ -523,6 +586,8 @@ gnc_lot_get_balance (GNCLot *lot)
         priv->is_closed = FALSE;
     }
 
+    priv->balance = baln;
+    priv->balance_dirty = FALSE;
     return baln;
 }
 
@@ -622,8 +687,8 @@ gnc_lot_add_split (GNCLot *lot, Split *split)
 
     priv->splits = g_list_append (priv->splits, split);
 
-    /* for recomputation of is-closed */
-    priv->is_closed = LOT_CLOSED_UNKNOWN;
+    /* keep the cached balance and is-closed in step */
+    gnc_lot_adjust_balance (lot, split->amount);
     gnc_lot_commit_edit(lot);
 
     qof_event_gen (QOF_INSTANCE(lot), QOF_EVENT_MODIFY, NULL);
@@ -634,15 +699,20 @@ void
 gnc_lot_remove_split (GNCLot *lot, Split *split)
 {
     GNCLotPrivate* priv;
+    GList *node;
     if (!lot || !split) return;
     priv = GET_PRIVATE(lot);
 
     ENTER ("(lot=%p, split=%p)", lot, split);
     gnc_lot_begin_edit(lot);
     qof_instance_set_dirty(QOF_INSTANCE(lot));
-    priv->splits = g_list_remove (priv->splits, split);
+    node = g_list_find (priv->splits, split);
+    priv->splits = g_list_delete_link (priv->splits, node);
     xaccSplitSetLot(split, NULL);
-    priv->is_closed = LOT_CLOSED_UNKNOWN;   /* force an is-closed computation */
+    if (node)
+        gnc_lot_adjust_balance (lot, gnc_numeric_neg (split->amount));
+    else
+        gnc_lot_set_closed_unknown (lot);
 
     if (NULL == priv->splits)
     {
@@ -693,7 +763,8 @@ destroy_lot_on_book_close(QofInstance *ent, gpointer data)
 {
     GNCLot* lot = GNC_LOT(ent);
 
-    gnc_lot_destroy(lot);
+    /* No need for the edit cycle and backend commit, just free it. */
+    gnc_lot_free(lot);
 }
 
 static void
@@ -136,7 +136,9 @@ void gnc_lot_set_cached_invoice(GNCLot* lot, GncInvoice *invoice);
 
 /** The gnc_lot_get_balance() routine returns the balance of the lot.
  *    The commodity in which this balance is expressed is the commodity
- *    of the account. */
+ *    of the account.  The balance is cached; adding or removing a split
+ *    adjusts it, and changing a split's amount causes it to be summed
+ *    again on the next call. */
 gnc_numeric gnc_lot_get_balance (GNCLot *);
 
 /** The gnc_lot_get_balance_before routine computes both the balance and
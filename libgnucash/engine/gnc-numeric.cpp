@@ -39,6 +39,8 @@ extern "C"
 #include <boost/regex.hpp>
 #include <boost/locale/encoding_utf.hpp>
 #include <sstream>
+#include <algorithm>
+#include <vector>
 #include <cstdlib>
 
 #include "gnc-numeric.hpp"
@@ -47,24 +49,6 @@ extern "C"
 static QofLogModule log_module = "qof";
 
 static const uint8_t max_leg_digits{17};
-static const int64_t pten[] = { 1, 10, 100, 1000, 10000, 100000, 1000000,
-                               10000000, 100000000, 1000000000,
-                               INT64_C(10000000000), INT64_C(100000000000),
-                               INT64_C(1000000000000), INT64_C(10000000000000),
-                               INT64_C(100000000000000),
-                               INT64_C(10000000000000000),
-                               INT64_C(100000000000000000),
-                               INT64_C(1000000000000000000)};
-#define POWTEN_OVERFLOW -5
-
-int64_t
-powten (unsigned int exp)
-{
-    if (exp > max_leg_digits)
-        exp = max_leg_digits;
-    return pten[exp];
-}
-
 GncNumeric::GncNumeric(GncRational rr)
 {
     /* Can't use isValid here because we want to throw different exceptions. */
@@ -81,6 +65,23 @@ GncNumeric::GncNumeric(GncRational rr)
     m_den = static_cast<int64_t>(rr.denom());
 }
 
+GNCNumericErrorCode
+GncNumeric::from_rational(GncRational rr, GncNumeric& result) noexcept
+{
+    if (!rr.valid())
+        return GNC_ERROR_OVERFLOW;
+    if (rr.is_big())
+    {
+        if (rr.reduce(rr) != GNC_ERROR_OK ||
+            rr.round_to_numeric(rr) != GNC_ERROR_OK ||
+            !rr.valid() || rr.is_big())
+            return GNC_ERROR_OVERFLOW;
+    }
+    result.m_num = static_cast<int64_t>(rr.num());
+    result.m_den = static_cast<int64_t>(rr.denom());
+    return GNC_ERROR_OK;
+}
+
 GncNumeric::GncNumeric(double d) : m_num(0), m_den(1)
 {
     static uint64_t max_leg_value{INT64_C(1000000000000000000)};
@@ -178,8 +179,21 @@ GncNumeric::GncNumeric(const std::string& str, bool autoround)
         auto neg = (m[1].length() && m[1].str()[0] == '-');
         GncInt128 high((neg && m[1].length() > 1) || (!neg && m[1].length()) ?
                        stoll(m[1].str()) : 0);
-        GncInt128 low(stoll(m[2].str()));
-        int64_t d = powten(m[2].str().length());
+        auto frac = m[2].str();
+        /* powten's largest denominator, 10^18, holds 18 decimal places. */
+        if (frac.length() > 18)
+        {
+            if (!autoround)
+            {
+                std::ostringstream errmsg;
+                errmsg << "Decimal string " << m[1].str() << "." << frac
+                       << " has more decimal places than a GncNumeric can hold.";
+                throw std::overflow_error(errmsg.str());
+            }
+            frac.resize(18);
+        }
+        GncInt128 low(stoll(frac));
+        int64_t d = powten(frac.length());
         GncInt128 n = high * d + (neg ? -low : low);
 
         if (!autoround && n.isBig())
@@ -269,24 +283,55 @@ GncNumeric::reduce() const noexcept
 
 GncNumeric::round_param
 GncNumeric::prepare_conversion(int64_t new_denom) const
+{
+    round_param params;
+    if (prepare_conversion(new_denom, params) != GNC_ERROR_OK)
+        throw std::overflow_error("Conversion overflow");
+    return params;
+}
+
+GNCNumericErrorCode
+GncNumeric::prepare_conversion(int64_t new_denom,
+                               round_param& params) const noexcept
 {
     if (new_denom == m_den || new_denom == GNC_DENOM_AUTO)
-        return {m_num, m_den, 0};
-    GncRational conversion(new_denom, m_den);
-    auto red_conv = conversion.reduce();
+    {
+        params = {m_num, m_den, 0};
+        return GNC_ERROR_OK;
+    }
+    /* Converting between decimal denominators, or any pair where one
+     * divides the other, needs neither a GCD nor 128-bit arithmetic. */
+    if (new_denom > 0 && m_den > 0)
+    {
+        if (new_denom % m_den == 0)
+        {
+            int64_t new_num;
+            if (!__builtin_mul_overflow (m_num, new_denom / m_den, &new_num))
+            {
+                params = {new_num, 1, 0};
+                return GNC_ERROR_OK;
+            }
+        }
+        else if (m_den % new_denom == 0)
+        {
+            auto divisor = m_den / new_denom;
+            params = {m_num / divisor, divisor, m_num % divisor};
+            return GNC_ERROR_OK;
+        }
+    }
+    GncRational red_conv;
+    if (GncRational(new_denom, m_den).reduce(red_conv) != GNC_ERROR_OK)
+        return GNC_ERROR_OVERFLOW;
     GncInt128 old_num(m_num);
     auto new_num = old_num * red_conv.num();
     auto rem = new_num % red_conv.denom();
     new_num /= red_conv.denom();
-    if (new_num.isBig())
-    {
-        GncRational rr(new_num, new_denom);
-        GncNumeric nn(rr);
-        rr = rr.convert<RoundType::truncate>(new_denom);
-        return {static_cast<int64_t>(rr.num()), new_denom, 0};
-    }
-    return {static_cast<int64_t>(new_num),
-            static_cast<int64_t>(red_conv.denom()), static_cast<int64_t>(rem)};
+    /* The converted numerator doesn't fit in an int64_t. */
+    if (!new_num.valid() || new_num.isBig())
+        return GNC_ERROR_OVERFLOW;
+    params = {static_cast<int64_t>(new_num),
+              static_cast<int64_t>(red_conv.denom()), static_cast<int64_t>(rem)};
+    return GNC_ERROR_OK;
 }
 
 int64_t
@@ -320,11 +365,11 @@ GncNumeric::to_string() const noexcept
 bool
 GncNumeric::is_decimal() const noexcept
 {
-    for (unsigned pwr = 0; pwr < max_leg_digits && m_den >= pten[pwr]; ++pwr)
+    for (unsigned pwr = 0; pwr < max_leg_digits && m_den >= powten(pwr); ++pwr)
     {
-        if (m_den == pten[pwr])
+        if (m_den == powten(pwr))
             return true;
-        if (m_den % pten[pwr])
+        if (m_den % powten(pwr))
             return false;
     }
     return false;
@@ -486,8 +531,83 @@ operator/(GncNumeric a, GncNumeric b)
     return static_cast<GncNumeric>(rr);
 }
 
-template <typename T, typename I> T
-convert(T num, I new_denom, int how)
+GNCNumericErrorCode
+add(GncNumeric a, GncNumeric b, GncNumeric& result) noexcept
+{
+    if (a.num() == 0)
+    {
+        result = b;
+        return GNC_ERROR_OK;
+    }
+    if (b.num() == 0)
+    {
+        result = a;
+        return GNC_ERROR_OK;
+    }
+    GncRational rr;
+    auto err = add(GncRational(a), GncRational(b), rr);
+    if (err != GNC_ERROR_OK)
+        return err;
+    return GncNumeric::from_rational(rr, result);
+}
+
+GNCNumericErrorCode
+subtract(GncNumeric a, GncNumeric b, GncNumeric& result) noexcept
+{
+    return add(a, -b, result);
+}
+
+GNCNumericErrorCode
+multiply(GncNumeric a, GncNumeric b, GncNumeric& result) noexcept
+{
+    if (a.num() == 0 || b.num() == 0)
+    {
+        result = GncNumeric();
+        return GNC_ERROR_OK;
+    }
+    GncRational rr;
+    auto err = multiply(GncRational(a), GncRational(b), rr);
+    if (err != GNC_ERROR_OK)
+        return err;
+    return GncNumeric::from_rational(rr, result);
+}
+
+GNCNumericErrorCode
+divide(GncNumeric a, GncNumeric b, GncNumeric& result) noexcept
+{
+    if (a.num() == 0)
+    {
+        result = GncNumeric();
+        return GNC_ERROR_OK;
+    }
+    if (b.num() == 0)
+        return GNC_ERROR_OVERFLOW;
+    GncRational rr;
+    auto err = divide(GncRational(a), GncRational(b), rr);
+    if (err != GNC_ERROR_OK)
+        return err;
+    return GncNumeric::from_rational(rr, result);
+}
+
+static inline GNCNumericErrorCode
+reduce(GncNumeric& num) noexcept
+{
+    num = num.reduce();
+    return GNC_ERROR_OK;
+}
+
+static inline GNCNumericErrorCode
+reduce(GncRational& num) noexcept
+{
+    return num.reduce(num);
+}
+
+/* Convert num as specified by the C API's denom and how arguments, storing
+ * the result in num. Errors are returned rather than thrown so that the C
+ * wrappers below don't need exception handlers.
+ */
+template <typename T, typename I> GNCNumericErrorCode
+convert(T& num, I new_denom, int how) noexcept
 {
     auto rtype = static_cast<RoundType>(how & GNC_NUMERIC_RND_MASK);
     unsigned int figs = GNC_HOW_GET_SIGFIGS(how);
@@ -495,50 +615,54 @@ convert(T num, I new_denom, int how)
     auto dtype = static_cast<DenomType>(how & GNC_NUMERIC_DENOM_MASK);
     bool sigfigs = dtype == DenomType::sigfigs;
     if (dtype == DenomType::reduce)
-        num = num.reduce();
+    {
+        auto err = reduce(num);
+        if (err != GNC_ERROR_OK)
+            return err;
+    }
 
     switch (rtype)
     {
         case RoundType::floor:
             if (sigfigs)
-                return num.template convert_sigfigs<RoundType::floor>(figs);
+                return num.template convert_sigfigs<RoundType::floor>(figs, num);
             else
-                return num.template convert<RoundType::floor>(new_denom);
+                return num.template convert<RoundType::floor>(new_denom, num);
         case RoundType::ceiling:
             if (sigfigs)
-                return num.template convert_sigfigs<RoundType::ceiling>(figs);
+                return num.template convert_sigfigs<RoundType::ceiling>(figs, num);
             else
-                return num.template convert<RoundType::ceiling>(new_denom);
+                return num.template convert<RoundType::ceiling>(new_denom, num);
         case RoundType::truncate:
             if (sigfigs)
-                return num.template convert_sigfigs<RoundType::truncate>(figs);
+                return num.template convert_sigfigs<RoundType::truncate>(figs, num);
             else
-                return num.template convert<RoundType::truncate>(new_denom);
+                return num.template convert<RoundType::truncate>(new_denom, num);
         case RoundType::promote:
             if (sigfigs)
-                return num.template convert_sigfigs<RoundType::promote>(figs);
+                return num.template convert_sigfigs<RoundType::promote>(figs, num);
             else
-                return num.template convert<RoundType::promote>(new_denom);
+                return num.template convert<RoundType::promote>(new_denom, num);
         case RoundType::half_down:
             if (sigfigs)
-                return num.template convert_sigfigs<RoundType::half_down>(figs);
+                return num.template convert_sigfigs<RoundType::half_down>(figs, num);
             else
-                return num.template convert<RoundType::half_down>(new_denom);
+                return num.template convert<RoundType::half_down>(new_denom, num);
         case RoundType::half_up:
             if (sigfigs)
-                return num.template convert_sigfigs<RoundType::half_up>(figs);
+                return num.template convert_sigfigs<RoundType::half_up>(figs, num);
             else
-                return num.template convert<RoundType::half_up>(new_denom);
+                return num.template convert<RoundType::half_up>(new_denom, num);
         case RoundType::bankers:
             if (sigfigs)
-                return num.template convert_sigfigs<RoundType::bankers>(figs);
+                return num.template convert_sigfigs<RoundType::bankers>(figs, num);
             else
-                return num.template convert<RoundType::bankers>(new_denom);
+                return num.template convert<RoundType::bankers>(new_denom, num);
         case RoundType::never:
             if (sigfigs)
-                return num.template convert_sigfigs<RoundType::never>(figs);
+                return num.template convert_sigfigs<RoundType::never>(figs, num);
             else
-                return num.template convert<RoundType::never>(new_denom);
+                return num.template convert<RoundType::never>(new_denom, num);
         default:
             /* round-truncate just returns the numerator unchanged. The old
              * gnc-numeric convert had no "default" behavior at rounding that
@@ -546,9 +670,9 @@ convert(T num, I new_denom, int how)
              * run the rest of the conversion code.
              */
             if (sigfigs)
-                return num.template convert_sigfigs<RoundType::truncate>(figs);
+                return num.template convert_sigfigs<RoundType::truncate>(figs, num);
             else
-                return num.template convert<RoundType::truncate>(new_denom);
+                return num.template convert<RoundType::truncate>(new_denom, num);
 
     }
 }
@@ -734,69 +858,81 @@ gnc_numeric_same(gnc_numeric a, gnc_numeric b, gint64 denom,
     return(gnc_numeric_equal(aconv, bconv));
 }
 
-static int64_t
-denom_lcd(gnc_numeric a, gnc_numeric b, int64_t denom, int how)
+static GNCNumericErrorCode
+denom_lcd(gnc_numeric a, gnc_numeric b, int64_t& denom, int how) noexcept
 {
     if (denom == GNC_DENOM_AUTO &&
         (how & GNC_NUMERIC_DENOM_MASK) == GNC_HOW_DENOM_LCD)
     {
         GncInt128 ad(a.denom), bd(b.denom);
-        denom = static_cast<int64_t>(ad.lcm(bd));
+        auto lcd = ad.lcm(bd);
+        if (!lcd.valid() || lcd.isBig())
+            return GNC_ERROR_OVERFLOW;
+        denom = static_cast<int64_t>(lcd);
     }
-    return denom;
+    return GNC_ERROR_OK;
 }
 
-/* *******************************************************************
- *  gnc_numeric_add
- ********************************************************************/
-
-gnc_numeric
-gnc_numeric_add(gnc_numeric a, gnc_numeric b,
-                gint64 denom, gint how)
+/* Apply one of the non-throwing arithmetic functions to a and b and convert
+ * the result as specified by denom and how. Exact results are computed in
+ * 128 bits with GncRational; everything else with GncNumeric, which rounds
+ * results that don't fit.
+ */
+template <typename Op> static gnc_numeric
+numeric_binary_op(gnc_numeric a, gnc_numeric b, gint64 denom, gint how, Op op)
 {
     if (gnc_numeric_check(a) || gnc_numeric_check(b))
     {
         return gnc_numeric_error(GNC_ERROR_ARG);
     }
-    denom = denom_lcd(a, b, denom, how);
-    try
-    {
-        if ((how & GNC_NUMERIC_DENOM_MASK) != GNC_HOW_DENOM_EXACT)
-        {
-            GncNumeric an (a), bn (b);
-            GncNumeric sum = an + bn;
-            return static_cast<gnc_numeric>(convert(sum, denom, how));
-        }
-        GncRational ar(a), br(b);
-        auto sum = ar + br;
-        if (denom == GNC_DENOM_AUTO &&
-            (how & GNC_NUMERIC_RND_MASK) != GNC_HOW_RND_NEVER)
-            return static_cast<gnc_numeric>(sum.round_to_numeric());
-        sum = convert(sum, denom, how);
-        if (sum.is_big() || !sum.valid())
-            return gnc_numeric_error(GNC_ERROR_OVERFLOW);
-        return static_cast<gnc_numeric>(sum);
-    }
-    catch (const std::overflow_error& err)
-    {
-        PWARN("%s", err.what());
-        return gnc_numeric_error(GNC_ERROR_OVERFLOW);
-    }
-    catch (const std::invalid_argument& err)
-    {
-        PWARN("%s", err.what());
-        return gnc_numeric_error(GNC_ERROR_ARG);
-    }
-    catch (const std::underflow_error& err)
+    auto err = denom_lcd(a, b, denom, how);
+    if (err == GNC_ERROR_OK &&
+        (how & GNC_NUMERIC_DENOM_MASK) != GNC_HOW_DENOM_EXACT)
     {
-        PWARN("%s", err.what());
-        return gnc_numeric_error(GNC_ERROR_OVERFLOW);
+        GncNumeric result;
+        err = op(GncNumeric(a), GncNumeric(b), result);
+        if (err == GNC_ERROR_OK)
+            err = convert(result, denom, how);
+        if (err == GNC_ERROR_OK)
+            return static_cast<gnc_numeric>(result);
     }
-    catch (const std::domain_error& err)
+    else if (err == GNC_ERROR_OK)
     {
-        PWARN("%s", err.what());
-        return gnc_numeric_error(GNC_ERROR_REMAINDER);
+        GncRational result;
+        err = op(GncRational(a), GncRational(b), result);
+        if (err == GNC_ERROR_OK)
+        {
+            if (denom == GNC_DENOM_AUTO &&
+                (how & GNC_NUMERIC_RND_MASK) != GNC_HOW_RND_NEVER)
+                err = result.round_to_numeric(result);
+            else
+                err = convert(result, denom, how);
+        }
+        if (err == GNC_ERROR_OK)
+        {
+            if (result.is_big() || !result.valid())
+                return gnc_numeric_error(GNC_ERROR_OVERFLOW);
+            return static_cast<gnc_numeric>(result);
+        }
     }
+    PWARN("%s", gnc_numeric_errorCode_to_string(err));
+    return gnc_numeric_error(err);
+}
+
+/* *******************************************************************
+ *  gnc_numeric_add
+ ********************************************************************/
+
+gnc_numeric
+gnc_numeric_add(gnc_numeric a, gnc_numeric b,
+                gint64 denom, gint how)
+{
+    gnc_numeric sum;
+    if (gnc_numeric_same_denom_add (a, b, denom, how, FALSE, &sum))
+        return sum;
+    return numeric_binary_op (a, b, denom, how,
+                              [](auto x, auto y, auto& r)
+                              { return add (x, y, r); });
 }
 
 /* *******************************************************************
@@ -808,49 +944,116 @@ gnc_numeric_sub(gnc_numeric a, gnc_numeric b,
                 gint64 denom, gint how)
 {
     gnc_numeric nb;
-    if (gnc_numeric_check(a) || gnc_numeric_check(b))
-    {
-        return gnc_numeric_error(GNC_ERROR_ARG);
-    }
-    denom = denom_lcd(a, b, denom, how);
-    try
-    {
-        if ((how & GNC_NUMERIC_DENOM_MASK) != GNC_HOW_DENOM_EXACT)
+    gnc_numeric diff;
+    if (gnc_numeric_same_denom_add (a, b, denom, how, TRUE, &diff))
+        return diff;
+    return numeric_binary_op (a, b, denom, how,
+                              [](auto x, auto y, auto& r)
+                              { return subtract (x, y, r); });
+}
+
+/* *******************************************************************
+ *  gnc_numeric_sum_array
+ ********************************************************************/
+
+/* The number of leading values sharing the first one's denominator. */
+static size_t
+same_denom_run (const gnc_numeric *values, size_t n)
+{
+    size_t run = 1;
+    if (values[0].denom <= 0)
+        return run;
+    while (run < n && values[run].denom == values[0].denom)
+        ++run;
+    return run;
+}
+
+/* Sum the numerators of a run of values with the same denominator.
+ * Each numerator is split into a signed high and an unsigned low 32 bit
+ * half; neither half's sum can overflow for fewer than 2^31 values, so
+ * the inner loop needs no overflow checks or branches and the compiler
+ * can vectorize it. Only the per-chunk totals go through GncInt128.
+ */
+static gnc_numeric
+sum_run (const gnc_numeric *values, size_t n)
+{
+    static constexpr size_t chunk = size_t{1} << 30;
+    static const GncInt128 high_unit {INT64_C(1) << 32};
+    if (n == 1)
+        return values[0];
+
+    GncInt128 total;
+    for (size_t start = 0; start < n; start += chunk)
+    {
+        auto end = std::min (n, start + chunk);
+        int64_t high = 0;
+        uint64_t low = 0;
+        for (size_t i = start; i < end; ++i)
         {
-            GncNumeric an (a), bn (b);
-            auto sum = an - bn;
-            return static_cast<gnc_numeric>(convert(sum, denom, how));
+            high += values[i].num >> 32;
+            low += static_cast<uint64_t>(values[i].num) & UINT64_C(0xffffffff);
         }
-        GncRational ar(a), br(b);
-        auto sum = ar - br;
-        if (denom == GNC_DENOM_AUTO &&
-            (how & GNC_NUMERIC_RND_MASK) != GNC_HOW_RND_NEVER)
-            return static_cast<gnc_numeric>(sum.round_to_numeric());
-        sum = convert(sum, denom, how);
-        if (sum.is_big() || !sum.valid())
-            return gnc_numeric_error(GNC_ERROR_OVERFLOW);
-        return static_cast<gnc_numeric>(sum);
+        total += GncInt128 {high} * high_unit + GncInt128 {low};
     }
-    catch (const std::overflow_error& err)
-    {
-        PWARN("%s", err.what());
-        return gnc_numeric_error(GNC_ERROR_OVERFLOW);
-    }
-    catch (const std::invalid_argument& err)
+
+    if (!total.isBig())
+        return gnc_numeric_create (static_cast<int64_t>(total), values[0].denom);
+    GncNumeric sum;
+    auto err = GncNumeric::from_rational ({total, GncInt128 {values[0].denom}},
+                                          sum);
+    if (err != GNC_ERROR_OK)
     {
-        PWARN("%s", err.what());
-        return gnc_numeric_error(GNC_ERROR_ARG);
+        PWARN("%s", gnc_numeric_errorCode_to_string(err));
+        return gnc_numeric_error(err);
     }
-    catch (const std::underflow_error& err)
+    return static_cast<gnc_numeric>(sum);
+}
+
+gnc_numeric
+gnc_numeric_sum_array (const gnc_numeric *values, gsize n)
+{
+    gnc_numeric total = gnc_numeric_zero ();
+
+    g_return_val_if_fail (values || n == 0, gnc_numeric_error (GNC_ERROR_ARG));
+    for (size_t i = 0; i < n; )
     {
-        PWARN("%s", err.what());
-        return gnc_numeric_error(GNC_ERROR_OVERFLOW);
+        auto run = same_denom_run (values + i, n - i);
+        total = gnc_numeric_add_fixed (total, sum_run (values + i, run));
+        if (gnc_numeric_check (total))
+            break;
+        i += run;
     }
-    catch (const std::domain_error& err)
-    {
-        PWARN("%s", err.what());
-        return gnc_numeric_error(GNC_ERROR_REMAINDER);
+    return total;
+}
+
+gsize
+gnc_numeric_sum_array_by_denom (const gnc_numeric *values, gsize n,
+                                gnc_numeric *sums)
+{
+    /* The denominators the totals started with; a total which
+     * overflowed into another denominator stays in its slot. */
+    std::vector<int64_t> denoms;
+
+    g_return_val_if_fail (values || n == 0, 0);
+    g_return_val_if_fail (sums || n == 0, 0);
+    for (size_t i = 0; i < n; )
+    {
+        auto run = same_denom_run (values + i, n - i);
+        auto sum = sum_run (values + i, run);
+        auto slot = std::find (denoms.begin(), denoms.end(), values[i].denom);
+        if (slot == denoms.end())
+        {
+            sums[denoms.size()] = sum;
+            denoms.push_back (values[i].denom);
+        }
+        else
+        {
+            auto& total = sums[slot - denoms.begin()];
+            total = gnc_numeric_add_fixed (total, sum);
+        }
+        i += run;
     }
+    return denoms.size();
 }
 
 /* *******************************************************************
@@ -861,49 +1064,9 @@ gnc_numeric
 gnc_numeric_mul(gnc_numeric a, gnc_numeric b,
                 gint64 denom, gint how)
 {
-    if (gnc_numeric_check(a) || gnc_numeric_check(b))
-    {
-        return gnc_numeric_error(GNC_ERROR_ARG);
-    }
-    denom = denom_lcd(a, b, denom, how);
-    try
-    {
-        if ((how & GNC_NUMERIC_DENOM_MASK) != GNC_HOW_DENOM_EXACT)
-        {
-            GncNumeric an (a), bn (b);
-            auto prod = an * bn;
-            return static_cast<gnc_numeric>(convert(prod, denom, how));
-        }
-        GncRational ar(a), br(b);
-        auto prod = ar * br;
-        if (denom == GNC_DENOM_AUTO &&
-            (how & GNC_NUMERIC_RND_MASK) != GNC_HOW_RND_NEVER)
-            return static_cast<gnc_numeric>(prod.round_to_numeric());
-        prod = convert(prod, denom, how);
-        if (prod.is_big() || !prod.valid())
-            return gnc_numeric_error(GNC_ERROR_OVERFLOW);
-        return static_cast<gnc_numeric>(prod);
-     }
-    catch (const std::overflow_error& err)
-    {
-        PWARN("%s", err.what());
-        return gnc_numeric_error(GNC_ERROR_OVERFLOW);
-    }
-    catch (const std::invalid_argument& err)
-    {
-        PWARN("%s", err.what());
-        return gnc_numeric_error(GNC_ERROR_ARG);
-    }
-    catch (const std::underflow_error& err)
-    {
-        PWARN("%s", err.what());
-        return gnc_numeric_error(GNC_ERROR_OVERFLOW);
-    }
-    catch (const std::domain_error& err)
-    {
-        PWARN("%s", err.what());
-        return gnc_numeric_error(GNC_ERROR_REMAINDER);
-    }
+    return numeric_binary_op (a, b, denom, how,
+                              [](auto x, auto y, auto& r)
+                              { return multiply (x, y, r); });
 }
 
 
@@ -915,49 +1078,14 @@ gnc_numeric
 gnc_numeric_div(gnc_numeric a, gnc_numeric b,
                 gint64 denom, gint how)
 {
-    if (gnc_numeric_check(a) || gnc_numeric_check(b))
-    {
-        return gnc_numeric_error(GNC_ERROR_ARG);
-    }
-    denom = denom_lcd(a, b, denom, how);
-    try
-    {
-        if ((how & GNC_NUMERIC_DENOM_MASK) != GNC_HOW_DENOM_EXACT)
-        {
-            GncNumeric an (a), bn (b);
-            auto quot = an / bn;
-            return static_cast<gnc_numeric>(convert(quot, denom, how));
-        }
-        GncRational ar(a), br(b);
-        auto quot = ar / br;
-        if (denom == GNC_DENOM_AUTO &&
-            (how & GNC_NUMERIC_RND_MASK) != GNC_HOW_RND_NEVER)
-            return static_cast<gnc_numeric>(quot.round_to_numeric());
-        quot =  static_cast<gnc_numeric>(convert(quot, denom, how));
-        if (quot.is_big() || !quot.valid())
-            return gnc_numeric_error(GNC_ERROR_OVERFLOW);
-        return static_cast<gnc_numeric>(quot);
-    }
-    catch (const std::overflow_error& err)
-    {
-        PWARN("%s", err.what());
-        return gnc_numeric_error(GNC_ERROR_OVERFLOW);
-    }
-    catch (const std::invalid_argument& err)
-    {
-        PWARN("%s", err.what());
-        return gnc_numeric_error(GNC_ERROR_ARG);
-    }
-    catch (const std::underflow_error& err) //Divide by zero
-    {
-        PWARN("%s", err.what());
-        return gnc_numeric_error(GNC_ERROR_OVERFLOW);
-    }
-    catch (const std::domain_error& err)
-    {
-        PWARN("%s", err.what());
-        return gnc_numeric_error(GNC_ERROR_REMAINDER);
-    }
+    auto quot = numeric_binary_op (a, b, denom, how,
+                                   [](auto x, auto y, auto& r)
+                                   { return divide (x, y, r); });
+    /* Exact quotients have always been returned with a positive denominator. */
+    if (quot.denom < 0 &&
+        (how & GNC_NUMERIC_DENOM_MASK) == GNC_HOW_DENOM_EXACT)
+        return static_cast<gnc_numeric>(GncRational(quot));
+    return quot;
 }
 
 /* *******************************************************************
@@ -1000,18 +1128,11 @@ gnc_numeric_convert(gnc_numeric in, int64_t denom, int how)
 {
     if (gnc_numeric_check(in))
         return in;
-    try
-    {
-        return convert(GncNumeric(in), denom, how);
-    }
-    catch (const std::overflow_error& err)
-    {
-        return gnc_numeric_error(GNC_ERROR_OVERFLOW);
-    }
-    catch (const std::underflow_error& err)
-    {
-        return gnc_numeric_error(GNC_ERROR_OVERFLOW);
-    }
+    GncNumeric num (in);
+    auto err = convert(num, denom, how);
+    if (err != GNC_ERROR_OK)
+        return gnc_numeric_error(err);
+    return static_cast<gnc_numeric>(num);
 }
 
 
@@ -1133,7 +1254,13 @@ double_to_gnc_numeric(double in, gint64 denom, gint how)
     try
     {
         GncNumeric an(in);
-        return convert(an, denom, how);
+        auto err = convert(an, denom, how);
+        if (err != GNC_ERROR_OK)
+        {
+            PWARN("%s", gnc_numeric_errorCode_to_string(err));
+            return gnc_numeric_error(err);
+        }
+        return static_cast<gnc_numeric>(an);
     }
     catch (const std::overflow_error& err)
     {
@@ -423,6 +423,49 @@ gnc_numeric gnc_numeric_neg(gnc_numeric a);
  * returned value is "|a/b|". */
 gnc_numeric gnc_numeric_abs(gnc_numeric a);
 
+#ifndef SWIG
+/** @cond
+ * The common case of adding or subtracting amounts in one commodity:
+ * both operands have the same positive denominator, the result keeps
+ * it, and the numerators don't overflow. Stores the result and returns
+ * TRUE when that applies; otherwise returns FALSE and the caller must
+ * use the general rational arithmetic.
+ */
+static inline gboolean
+gnc_numeric_same_denom_add (gnc_numeric a, gnc_numeric b, gint64 denom,
+                            gint how, gboolean subtract, gnc_numeric *result)
+{
+    gint64 num;
+    gint dtype = how & GNC_NUMERIC_DENOM_MASK;
+
+    if (a.denom != b.denom || a.denom <= 0)
+        return FALSE;
+    if (denom != GNC_DENOM_AUTO && denom != a.denom)
+        return FALSE;
+    if (dtype != GNC_HOW_DENOM_FIXED && dtype != GNC_HOW_DENOM_LCD)
+        return FALSE;
+#if defined(__GNUC__) || defined(__clang__)
+    if (subtract ? __builtin_sub_overflow (a.num, b.num, &num) :
+                   __builtin_add_overflow (a.num, b.num, &num))
+        return FALSE;
+#else
+    if (subtract ? (b.num < 0 ? a.num > G_MAXINT64 + b.num :
+                                a.num < G_MININT64 + b.num) :
+                   (b.num > 0 ? a.num > G_MAXINT64 - b.num :
+                                a.num < G_MININT64 - b.num))
+        return FALSE;
+    num = subtract ? a.num - b.num : a.num + b.num;
+#endif
+    /* GncNumeric can't represent the negation of G_MININT64. */
+    if (num == G_MININT64)
+        return FALSE;
+    result->num = num;
+    result->denom = a.denom;
+    return TRUE;
+}
+/** @endcond */
+#endif
+
 /**
  * Shortcut for common case: gnc_numeric_add(a, b, GNC_DENOM_AUTO,
  *                        GNC_HOW_DENOM_FIXED | GNC_HOW_RND_NEVER);
@@ -430,6 +473,10 @@ gnc_numeric gnc_numeric_abs(gnc_numeric a);
 static inline
 gnc_numeric gnc_numeric_add_fixed(gnc_numeric a, gnc_numeric b)
 {
+    gnc_numeric sum;
+    if (gnc_numeric_same_denom_add (a, b, GNC_DENOM_AUTO,
+                                    GNC_HOW_DENOM_FIXED, FALSE, &sum))
+        return sum;
     return gnc_numeric_add(a, b, GNC_DENOM_AUTO,
                            GNC_HOW_DENOM_FIXED | GNC_HOW_RND_NEVER);
 }
@@ -441,9 +488,41 @@ gnc_numeric gnc_numeric_add_fixed(gnc_numeric a, gnc_numeric b)
 static inline
 gnc_numeric gnc_numeric_sub_fixed(gnc_numeric a, gnc_numeric b)
 {
+    gnc_numeric diff;
+    if (gnc_numeric_same_denom_add (a, b, GNC_DENOM_AUTO,
+                                    GNC_HOW_DENOM_FIXED, TRUE, &diff))
+        return diff;
     return gnc_numeric_sub(a, b, GNC_DENOM_AUTO,
                            GNC_HOW_DENOM_FIXED | GNC_HOW_RND_NEVER);
 }
+
+/**
+ * Adds up the n amounts in values. The result is that of adding them
+ * one at a time with gnc_numeric_add_fixed(), but runs of values with
+ * the same denominator are summed in a single pass and only fall back
+ * to 128-bit arithmetic if their total overflows 64 bits. Intermediate
+ * totals may exceed 64 bits as long as the final one doesn't.
+ *
+ * @param values The amounts to add.
+ * @param n The number of amounts in values.
+ * @return The total, zero for an empty array or an error value as
+ * gnc_numeric_add_fixed() would return it.
+ */
+gnc_numeric gnc_numeric_sum_array (const gnc_numeric *values, gsize n);
+
+/**
+ * As gnc_numeric_sum_array(), but keeping a separate total for each
+ * denominator, for amounts in several commodities that are summed
+ * separately. The totals are stored in the order in which their
+ * denominators first occur in values.
+ *
+ * @param values The amounts to add.
+ * @param n The number of amounts in values.
+ * @param sums Receives the totals; it must have room for n of them.
+ * @return The number of totals stored in sums.
+ */
+gsize gnc_numeric_sum_array_by_denom (const gnc_numeric *values, gsize n,
+                                      gnc_numeric *sums);
 /** @} */
 
 
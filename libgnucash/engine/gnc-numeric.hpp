@@ -48,6 +48,9 @@ class GncRational;
  * * Failure to convert a number as specified by the arguments to convert() will
  * raise a std::domain_error.
  *
+ * The functions taking a result reference instead report failure by returning
+ * a GNCNumericErrorCode and never throw.
+ *
  * Rounding Policy: GncNumeric provides a convert() member function that object
  * amount and value setters (and *only* those functions!) should call to set a
  * number which is represented in the commodity's SCU. Since SCUs are seldom 18
@@ -87,6 +90,16 @@ public:
      * \param rr A GncRational.
      */
     GncNumeric(GncRational rr);
+    /**
+     * Non-throwing equivalent of the GncRational constructor.
+     *
+     * \param rr A GncRational.
+     * \param result Receives the rounded GncNumeric.
+     * \return GNC_ERROR_OVERFLOW if rr is invalid or can't be rounded to
+     * fit, GNC_ERROR_OK otherwise.
+     */
+    static GNCNumericErrorCode from_rational(GncRational rr,
+                                             GncNumeric& result) noexcept;
     /**
      * gnc_numeric constructor, used for interfacing old code. This function
      * should not be used outside of gnc-numeric.cpp.
@@ -199,6 +212,34 @@ public:
         return GncNumeric(round(params.num, params.den,
                                 params.rem, RT2T<RT>()), new_denom);
     }
+    /**
+     * Non-throwing convert().
+     *
+     * \param new_denom The new denominator to convert the fraction to.
+     * \param result Receives the converted GncNumeric; it may be *this.
+     * \return GNC_ERROR_OVERFLOW if the result doesn't fit,
+     * GNC_ERROR_REMAINDER if RoundType::never was specified and rounding is
+     * required, GNC_ERROR_OK otherwise.
+     */
+    template <RoundType RT>
+    GNCNumericErrorCode convert(int64_t new_denom,
+                                GncNumeric& result) const noexcept
+    {
+        round_param params;
+        auto err = prepare_conversion(new_denom, params);
+        if (err != GNC_ERROR_OK)
+            return err;
+        if (new_denom == GNC_DENOM_AUTO)
+            new_denom = m_den;
+        if (params.rem == 0)
+            result = GncNumeric(params.num, new_denom);
+        else if constexpr (RT == RoundType::never)
+            return GNC_ERROR_REMAINDER;
+        else
+            result = GncNumeric(round(params.num, params.den,
+                                      params.rem, RT2T<RT>()), new_denom);
+        return GNC_ERROR_OK;
+    }
 
     /**
      * Convert with the specified sigfigs. The resulting denominator depends on
@@ -223,6 +264,33 @@ public:
         return GncNumeric(round(params.num, params.den,
                                 params.rem, RT2T<RT>()), new_denom);
     }
+    /**
+     * Non-throwing convert_sigfigs().
+     *
+     * @param figs The number of digits to use for the numerator.
+     * @param result Receives the converted GncNumeric; it may be *this.
+     * @return As for the non-throwing convert().
+     */
+    template <RoundType RT>
+    GNCNumericErrorCode convert_sigfigs(unsigned int figs,
+                                        GncNumeric& result) const noexcept
+    {
+        auto new_denom(sigfigs_denom(figs));
+        round_param params;
+        auto err = prepare_conversion(new_denom, params);
+        if (err != GNC_ERROR_OK)
+            return err;
+        if (new_denom == 0) //It had better not, but just in case...
+            new_denom = 1;
+        if (params.rem == 0)
+            result = GncNumeric(params.num, new_denom);
+        else if constexpr (RT == RoundType::never)
+            return GNC_ERROR_REMAINDER;
+        else
+            result = GncNumeric(round(params.num, params.den,
+                                      params.rem, RT2T<RT>()), new_denom);
+        return GNC_ERROR_OK;
+    }
     /**
      * Return a string representation of the GncNumeric. See operator<< for
      * details.
@@ -277,6 +345,8 @@ private:
      * finish computing a GncNumeric with the new denominator.
      */
     round_param prepare_conversion(int64_t new_denom) const;
+    GNCNumericErrorCode prepare_conversion(int64_t new_denom,
+                                           round_param& params) const noexcept;
     int64_t m_num;
     int64_t m_den;
 };
@@ -333,6 +403,26 @@ inline GncNumeric operator/(int64_t a, GncNumeric b)
     return b / GncNumeric(a, 1);
 }
 /** @} */
+/**
+ * \defgroup gnc_numeric_checked_arithmetic
+ * @{
+ * Non-throwing versions of the arithmetic operators, rounding the same way.
+ *
+ * \param a The right-side operand
+ * \param b The left-side operand
+ * \param result Receives the computed GncNumeric; untouched on failure.
+ * \return GNC_ERROR_OVERFLOW if the result can't be represented or b is zero
+ * in a division, GNC_ERROR_OK otherwise.
+ */
+GNCNumericErrorCode add(GncNumeric a, GncNumeric b,
+                        GncNumeric& result) noexcept;
+GNCNumericErrorCode subtract(GncNumeric a, GncNumeric b,
+                             GncNumeric& result) noexcept;
+GNCNumericErrorCode multiply(GncNumeric a, GncNumeric b,
+                             GncNumeric& result) noexcept;
+GNCNumericErrorCode divide(GncNumeric a, GncNumeric b,
+                           GncNumeric& result) noexcept;
+/** @} */
 /**
  * std::stream output operator. Uses standard integer operator<< so should obey
  * locale rules. Numbers are presented as integers if the denominator is 1, as a
@@ -426,9 +516,23 @@ inline bool operator!=(int64_t a, GncNumeric b) { return cmp(a, b) != 0; }
 /** @} */
 /**
  * Convenience function to quickly return 10**digits.
- * \param digits The desired exponent. Maximum value is 17.
+ * \param digits The desired exponent. Maximum value is 18, the largest
+ * power of ten an int64_t holds.
  * \return 10**digits
  */
-int64_t powten(unsigned int digits);
+constexpr int64_t
+powten(unsigned int digits)
+{
+    constexpr int64_t pten[] {1, 10, 100, 1000, 10000, 100000, 1000000,
+                              10000000, 100000000, 1000000000,
+                              INT64_C(10000000000), INT64_C(100000000000),
+                              INT64_C(1000000000000), INT64_C(10000000000000),
+                              INT64_C(100000000000000),
+                              INT64_C(1000000000000000),
+                              INT64_C(10000000000000000),
+                              INT64_C(100000000000000000),
+                              INT64_C(1000000000000000000)};
+    return pten[digits < 18 ? digits : 18];
+}
 
 #endif // __GNC_NUMERIC_HPP__
@@ -0,0 +1,476 @@
+/********************************************************************\
+ * gnc-portfolio.cpp -- holdings, basis and gains of investment     *
+ *                      accounts for reports                        *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ *                                                                  *
+\********************************************************************/
+
+extern "C"
+{
+#include <config.h>
+#include <glib.h>
+
+#include "Account.h"
+#include "Transaction.h"
+#include "cap-gains.h"
+#include "gnc-lot.h"
+#include "gnc-portfolio.h"
+#include "gnc-pricedb.h"
+}
+
+#include <unordered_set>
+#include <vector>
+
+static QofLogModule log_module = GNC_MOD_LOT;
+
+/* Units bought together, and what they cost. */
+struct Parcel
+{
+    GNCLot *lot;
+    gnc_numeric units;
+    gnc_numeric cost;
+};
+
+class PortfolioBuilder
+{
+public:
+    PortfolioBuilder (Account *account, gnc_commodity *currency,
+                      GncPortfolioBasis method, gboolean fees_in_basis);
+    void add_transaction (Transaction *trans);
+    void finish (GncPortfolioHolding *holding, time64 date);
+
+private:
+    gnc_numeric convert (gnc_numeric value, Transaction *trans) const;
+    gnc_numeric money_add (gnc_numeric a, gnc_numeric b) const
+    {
+        return gnc_numeric_add (a, b, m_currency_frac, GNC_HOW_RND_ROUND_HALF_UP);
+    }
+    /* a * num / denom, rounded to the currency. */
+    gnc_numeric money_part (gnc_numeric a, gnc_numeric num,
+                            gnc_numeric denom) const;
+    gnc_numeric total_units () const;
+    gnc_numeric total_cost () const;
+    void buy (GNCLot *lot, gnc_numeric units, gnc_numeric cost);
+    void sell (GNCLot *lot, gnc_numeric units, gnc_numeric value);
+    Parcel *lot_parcel (GNCLot *lot);
+    void rescale_units (gnc_numeric units);
+    void rescale_cost (gnc_numeric value);
+
+    Account *m_account;
+    gnc_commodity *m_currency;
+    int m_currency_frac;
+    int m_units_frac;
+    GncPortfolioBasis m_method;
+    gboolean m_fees_in_basis;
+    GNCPriceDB *m_pricedb;
+    std::vector<Parcel> m_parcels;
+    gnc_numeric m_realized_gain = gnc_numeric_zero ();
+    gnc_numeric m_income = gnc_numeric_zero ();
+    gnc_numeric m_brokerage = gnc_numeric_zero ();
+    gnc_numeric m_money_in = gnc_numeric_zero ();
+    gnc_numeric m_money_out = gnc_numeric_zero ();
+};
+
+PortfolioBuilder::PortfolioBuilder (Account *account, gnc_commodity *currency,
+                                    GncPortfolioBasis method,
+                                    gboolean fees_in_basis) :
+    m_account {account}, m_currency {currency},
+    m_currency_frac {gnc_commodity_get_fraction (currency)},
+    m_units_frac {xaccAccountGetCommoditySCU (account)},
+    m_method {method}, m_fees_in_basis {fees_in_basis},
+    m_pricedb {gnc_pricedb_get_db (gnc_account_get_book (account))}
+{
+}
+
+gnc_numeric
+PortfolioBuilder::convert (gnc_numeric value, Transaction *trans) const
+{
+    auto trans_currency = xaccTransGetCurrency (trans);
+
+    if (gnc_numeric_zero_p (value) ||
+        gnc_commodity_equiv (trans_currency, m_currency))
+        return value;
+    return gnc_pricedb_convert_balance_nearest_price_t64 (m_pricedb, value,
+                                                          trans_currency,
+                                                          m_currency,
+                                                          xaccTransGetDate (trans));
+}
+
+gnc_numeric
+PortfolioBuilder::money_part (gnc_numeric a, gnc_numeric num,
+                              gnc_numeric denom) const
+{
+    auto ratio = gnc_numeric_div (num, denom, GNC_DENOM_AUTO,
+                                  GNC_HOW_DENOM_REDUCE | GNC_HOW_RND_NEVER);
+    if (gnc_numeric_check (ratio))
+        ratio = gnc_numeric_div (num, denom, GNC_DENOM_AUTO,
+                                 GNC_HOW_DENOM_SIGFIGS (12) | GNC_HOW_RND_ROUND_HALF_UP);
+    return gnc_numeric_mul (a, ratio, m_currency_frac, GNC_HOW_RND_ROUND_HALF_UP);
+}
+
+gnc_numeric
+PortfolioBuilder::total_units () const
+{
+    auto total = gnc_numeric_zero ();
+    for (const auto& parcel : m_parcels)
+        total = gnc_numeric_add (total, parcel.units, GNC_DENOM_AUTO,
+                                 GNC_HOW_DENOM_EXACT);
+    return total;
+}
+
+gnc_numeric
+PortfolioBuilder::total_cost () const
+{
+    auto total = gnc_numeric_zero ();
+    for (const auto& parcel : m_parcels)
+        total = money_add (total, parcel.cost);
+    return total;
+}
+
+Parcel *
+PortfolioBuilder::lot_parcel (GNCLot *lot)
+{
+    for (auto& parcel : m_parcels)
+        if (parcel.lot == lot)
+            return &parcel;
+    return nullptr;
+}
+
+void
+PortfolioBuilder::buy (GNCLot *lot, gnc_numeric units, gnc_numeric cost)
+{
+    Parcel *parcel = nullptr;
+
+    if (m_method == GNC_PORTFOLIO_BASIS_LOTS)
+        parcel = lot_parcel (lot);
+    else if (m_method == GNC_PORTFOLIO_BASIS_AVERAGE && !m_parcels.empty())
+        parcel = &m_parcels.front();
+
+    if (!parcel)
+    {
+        m_parcels.push_back ({lot, units, cost});
+        return;
+    }
+    parcel->units = gnc_numeric_add (parcel->units, units, GNC_DENOM_AUTO,
+                                     GNC_HOW_DENOM_EXACT);
+    parcel->cost = money_add (parcel->cost, cost);
+}
+
+/* Take units, whose sign is opposite to that of the parcels, for value,
+ * realizing the gain.  Any units left over once the parcels are empty
+ * start a parcel of the other sign. */
+void
+PortfolioBuilder::sell (GNCLot *lot, gnc_numeric units, gnc_numeric value)
+{
+    auto left = units;
+    auto cost_taken = gnc_numeric_zero ();
+
+    while (!gnc_numeric_zero_p (left))
+    {
+        Parcel *parcel = nullptr;
+        if (m_method == GNC_PORTFOLIO_BASIS_LOTS)
+            parcel = lot_parcel (lot);
+        else if (m_method == GNC_PORTFOLIO_BASIS_LIFO)
+            parcel = m_parcels.empty() ? nullptr : &m_parcels.back();
+        else
+            parcel = m_parcels.empty() ? nullptr : &m_parcels.front();
+
+        if (!parcel || gnc_numeric_zero_p (parcel->units) ||
+            gnc_numeric_positive_p (parcel->units) ==
+            gnc_numeric_positive_p (left))
+        {
+            /* Selling short, or more than was bought. */
+            auto rest = money_part (value, left, units);
+            value = gnc_numeric_sub (value, rest, m_currency_frac,
+                                     GNC_HOW_RND_ROUND_HALF_UP);
+            if (parcel && gnc_numeric_zero_p (parcel->units))
+            {
+                parcel->units = left;
+                parcel->cost = money_add (parcel->cost, rest);
+            }
+            else
+                m_parcels.push_back ({lot, left, rest});
+            break;
+        }
+
+        auto remains = gnc_numeric_add (parcel->units, left, GNC_DENOM_AUTO,
+                                        GNC_HOW_DENOM_EXACT);
+        if (gnc_numeric_zero_p (remains) ||
+            gnc_numeric_positive_p (remains) != gnc_numeric_positive_p (parcel->units))
+        {
+            /* The whole parcel goes. */
+            cost_taken = money_add (cost_taken, parcel->cost);
+            left = remains;
+            if (m_method == GNC_PORTFOLIO_BASIS_LOTS ||
+                m_method == GNC_PORTFOLIO_BASIS_AVERAGE)
+            {
+                parcel->units = gnc_numeric_zero ();
+                parcel->cost = gnc_numeric_zero ();
+            }
+            else if (m_method == GNC_PORTFOLIO_BASIS_LIFO)
+                m_parcels.pop_back();
+            else
+                m_parcels.erase (m_parcels.begin());
+        }
+        else
+        {
+            auto cost = money_part (parcel->cost, gnc_numeric_neg (left),
+                                    parcel->units);
+            cost_taken = money_add (cost_taken, cost);
+            parcel->cost = gnc_numeric_sub (parcel->cost, cost, m_currency_frac,
+                                            GNC_HOW_RND_ROUND_HALF_UP);
+            parcel->units = remains;
+            left = gnc_numeric_zero ();
+        }
+    }
+
+    /* What the units brought less what they cost; the value of a sale is
+     * negative and the cost of what it took positive. */
+    m_realized_gain = gnc_numeric_sub (m_realized_gain,
+                                       money_add (value, cost_taken),
+                                       m_currency_frac,
+                                       GNC_HOW_RND_ROUND_HALF_UP);
+}
+
+/* A stock split or merger: units more or fewer at the same cost. */
+void
+PortfolioBuilder::rescale_units (gnc_numeric units)
+{
+    auto held = total_units ();
+
+    if (gnc_numeric_zero_p (held))
+    {
+        m_parcels.push_back ({nullptr, units, gnc_numeric_zero ()});
+        return;
+    }
+    auto ratio = gnc_numeric_div (gnc_numeric_add (held, units, GNC_DENOM_AUTO,
+                                                   GNC_HOW_DENOM_EXACT),
+                                  held, GNC_DENOM_AUTO, GNC_HOW_DENOM_REDUCE);
+    for (auto& parcel : m_parcels)
+        parcel.units = gnc_numeric_mul (parcel.units, ratio, m_units_frac,
+                                        GNC_HOW_RND_ROUND_HALF_UP);
+}
+
+/* A spin-off or return of capital: the same units at another cost. */
+void
+PortfolioBuilder::rescale_cost (gnc_numeric value)
+{
+    auto cost = total_cost ();
+
+    if (gnc_numeric_zero_p (cost))
+    {
+        m_realized_gain = gnc_numeric_sub (m_realized_gain, value,
+                                           m_currency_frac,
+                                           GNC_HOW_RND_ROUND_HALF_UP);
+        return;
+    }
+    auto new_cost = money_add (cost, value);
+    for (auto& parcel : m_parcels)
+        parcel.cost = money_part (parcel.cost, new_cost, cost);
+}
+
+void
+PortfolioBuilder::add_transaction (Transaction *trans)
+{
+    auto income = gnc_numeric_zero ();
+    auto brokerage = gnc_numeric_zero ();
+    auto units_bought = gnc_numeric_zero ();
+    auto value_bought = gnc_numeric_zero ();
+    auto units_traded = gnc_numeric_zero ();
+    std::vector<Split*> own;
+
+    for (auto node = xaccTransGetSplitList (trans); node; node = node->next)
+    {
+        auto split = static_cast<Split*>(node->data);
+        auto account = xaccSplitGetAccount (split);
+
+        /* The lot engine's record of a gain: this works it out itself. */
+        if (xaccSplitGetGainsSourceSplit (split))
+            return;
+
+        if (account == m_account)
+        {
+            auto units = xaccSplitGetAmount (split);
+            own.push_back (split);
+            units_traded = gnc_numeric_add (units_traded, gnc_numeric_abs (units),
+                                            GNC_DENOM_AUTO, GNC_HOW_DENOM_EXACT);
+            if (gnc_numeric_positive_p (units) &&
+                gnc_numeric_positive_p (xaccSplitGetValue (split)))
+                units_bought = gnc_numeric_add (units_bought, units,
+                                                GNC_DENOM_AUTO, GNC_HOW_DENOM_EXACT);
+            continue;
+        }
+
+        switch (xaccAccountGetType (account))
+        {
+        case ACCT_TYPE_EXPENSE:
+        {
+            /* Units given to charity aren't brokerage. */
+            auto other = xaccSplitGetOtherSplit (split);
+            if (!other || xaccSplitGetAccount (other) != m_account)
+                brokerage = money_add (brokerage,
+                                       convert (xaccSplitGetValue (split), trans));
+            break;
+        }
+        case ACCT_TYPE_INCOME:
+            income = gnc_numeric_sub (income,
+                                      convert (xaccSplitGetValue (split), trans),
+                                      m_currency_frac, GNC_HOW_RND_ROUND_HALF_UP);
+            break;
+        default:
+            break;
+        }
+    }
+
+    m_income = money_add (m_income, income);
+    m_brokerage = money_add (m_brokerage, brokerage);
+
+    auto fees = gnc_numeric_zero ();
+    if (m_fees_in_basis && gnc_numeric_positive_p (brokerage) &&
+        gnc_numeric_positive_p (units_bought))
+        fees = money_part (brokerage, units_bought, units_traded);
+
+    for (auto split : own)
+    {
+        auto units = xaccSplitGetAmount (split);
+        auto value = convert (xaccSplitGetValue (split), trans);
+        auto lot = m_method == GNC_PORTFOLIO_BASIS_LOTS ?
+            xaccSplitGetLot (split) : nullptr;
+
+        if (gnc_numeric_zero_p (units) && gnc_numeric_zero_p (value))
+            continue;
+
+        if (gnc_numeric_zero_p (value) && !lot)
+        {
+            rescale_units (units);
+            continue;
+        }
+
+        if (gnc_numeric_zero_p (units))
+        {
+            if (gnc_numeric_negative_p (value))
+                m_money_out = gnc_numeric_sub (m_money_out, value, m_currency_frac,
+                                               GNC_HOW_RND_ROUND_HALF_UP);
+            rescale_cost (value);
+            continue;
+        }
+
+        auto held = total_units ();
+        if (m_method == GNC_PORTFOLIO_BASIS_LOTS)
+        {
+            auto parcel = lot_parcel (lot);
+            held = parcel ? parcel->units : gnc_numeric_zero ();
+        }
+        if (gnc_numeric_zero_p (held) ||
+            gnc_numeric_positive_p (held) == gnc_numeric_positive_p (units))
+        {
+            auto cost = value;
+            if (gnc_numeric_positive_p (units) && !gnc_numeric_zero_p (fees))
+                cost = money_add (cost, money_part (fees, units, units_bought));
+            if (gnc_numeric_positive_p (cost))
+                value_bought = money_add (value_bought, cost);
+            buy (lot, units, cost);
+        }
+        else
+        {
+            if (gnc_numeric_negative_p (value))
+                m_money_out = gnc_numeric_sub (m_money_out, value, m_currency_frac,
+                                               GNC_HOW_RND_ROUND_HALF_UP);
+            sell (lot, units, value);
+        }
+    }
+
+    /* Reinvested income isn't money put in. */
+    if (gnc_numeric_positive_p (income) && gnc_numeric_positive_p (value_bought))
+    {
+        value_bought = gnc_numeric_sub (value_bought, income, m_currency_frac,
+                                        GNC_HOW_RND_ROUND_HALF_UP);
+        if (gnc_numeric_negative_p (value_bought))
+            value_bought = gnc_numeric_zero ();
+    }
+    m_money_in = money_add (m_money_in, value_bought);
+}
+
+void
+PortfolioBuilder::finish (GncPortfolioHolding *holding, time64 date)
+{
+    auto commodity = xaccAccountGetCommodity (m_account);
+
+    holding->account = m_account;
+    holding->commodity = commodity;
+    holding->currency = m_currency;
+    holding->units = total_units ();
+    holding->basis = total_cost ();
+    if (gnc_commodity_equiv (commodity, m_currency))
+        holding->value = holding->units;
+    else
+        holding->value = gnc_pricedb_convert_balance_nearest_price_t64 (
+            m_pricedb, holding->units, commodity, m_currency, date);
+    holding->value = gnc_numeric_convert (holding->value, m_currency_frac,
+                                          GNC_HOW_RND_ROUND_HALF_UP);
+    holding->have_price = gnc_numeric_zero_p (holding->units) ||
+        !gnc_numeric_zero_p (holding->value);
+    holding->realized_gain = m_realized_gain;
+    holding->unrealized_gain = holding->have_price ?
+        gnc_numeric_sub (holding->value, holding->basis, m_currency_frac,
+                         GNC_HOW_RND_ROUND_HALF_UP) : gnc_numeric_zero ();
+    holding->income = m_income;
+    holding->brokerage = m_brokerage;
+    holding->money_in = m_money_in;
+    holding->money_out = m_money_out;
+}
+
+GList *
+gnc_portfolio_get_holdings (GList *accounts, time64 date,
+                            gnc_commodity *currency, GncPortfolioBasis method,
+                            gboolean fees_in_basis)
+{
+    GList *holdings = NULL;
+
+    g_return_val_if_fail (currency, NULL);
+
+    for (auto node = accounts; node; node = node->next)
+    {
+        auto account = static_cast<Account*>(node->data);
+        PortfolioBuilder builder {account, currency, method, fees_in_basis};
+        std::unordered_set<Transaction*> seen;
+
+        for (auto snode = xaccAccountGetSplitList (account); snode;
+             snode = snode->next)
+        {
+            auto trans = xaccSplitGetParent (static_cast<Split*>(snode->data));
+            if (xaccTransGetDate (trans) > date)
+                break;
+            if (seen.insert (trans).second)
+                builder.add_transaction (trans);
+        }
+
+        auto holding = g_new0 (GncPortfolioHolding, 1);
+        builder.finish (holding, date);
+        holdings = g_list_prepend (holdings, holding);
+    }
+    PINFO ("%d holdings", g_list_length (holdings));
+    return g_list_reverse (holdings);
+}
+
+void
+gnc_portfolio_holdings_free (GList *holdings)
+{
+    g_list_free_full (holdings, g_free);
+}
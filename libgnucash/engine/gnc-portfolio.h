@@ -0,0 +1,134 @@
+/********************************************************************\
+ * gnc-portfolio.h -- holdings, basis and gains of investment       *
+ *                    accounts for reports                          *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ *                                                                  *
+\********************************************************************/
+/** @addtogroup Engine
+    @{ */
+/** @addtogroup Portfolio Portfolio Holdings
+ * The holding of an account at a date: the units of its commodity held,
+ * what they cost, what they're worth and the gains and income they
+ * brought, as the portfolio reports show them.  All the splits of the
+ * account up to the date are gone through once, in date order.
+ *
+ * Every split that buys units adds a parcel of units at its value.
+ * Every split that sells units takes them from the parcels, and the
+ * difference between its value and the cost of the units taken is a
+ * realized gain.  A split with units and no value (a stock split or
+ * merger) changes the units of all the parcels, leaving their cost; one
+ * with value and no units (a spin-off or return of capital) changes
+ * their cost, leaving the units.  Which parcels a sale takes from
+ * depends on the basis method:
+ *
+ * - GNC_PORTFOLIO_BASIS_LOTS: each lot of the account is a parcel, and a
+ *   sale takes from the lot it's assigned to, so that the gains follow
+ *   the lots that the account's lot policy (policy.h) or the user made.
+ *   Splits that aren't in a lot share one parcel at their average cost.
+ * - GNC_PORTFOLIO_BASIS_AVERAGE: a single parcel at the average cost.
+ * - GNC_PORTFOLIO_BASIS_FIFO, GNC_PORTFOLIO_BASIS_LIFO: a parcel per
+ *   purchase, sales taking from the earliest or the latest.
+ *
+ * The gains splits that the lot engine makes (cap-gains.h) are left out,
+ * since the gains are worked out here, and so are the income splits of
+ * their transactions.
+ *
+ * All the amounts of money are in the currency they're asked in.  The
+ * values of transactions in other currencies are converted at the price
+ * nearest their date; the value of the holding is at the price nearest
+ * the date of the holding.
+ @{ */
+
+/** @file gnc-portfolio.h
+ */
+
+#ifndef GNC_PORTFOLIO_H
+#define GNC_PORTFOLIO_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include "qof.h"
+#include "Account.h"
+#include "gnc-commodity.h"
+
+/** How the cost of the units sold is found. */
+typedef enum
+{
+    GNC_PORTFOLIO_BASIS_LOTS,
+    GNC_PORTFOLIO_BASIS_AVERAGE,
+    GNC_PORTFOLIO_BASIS_FIFO,
+    GNC_PORTFOLIO_BASIS_LIFO,
+} GncPortfolioBasis;
+
+typedef struct
+{
+    Account *account;
+    gnc_commodity *commodity;   /**< the commodity of the account */
+    gnc_commodity *currency;    /**< of all the amounts of money below */
+    gnc_numeric units;          /**< held at the date */
+    gnc_numeric basis;          /**< cost of the units held */
+    gnc_numeric value;          /**< worth of the units held */
+    gboolean have_price;        /**< FALSE if there was no price to find
+                                     value with; it is zero then */
+    gnc_numeric realized_gain;
+    gnc_numeric unrealized_gain;/**< value less basis, zero without
+                                     a price */
+    gnc_numeric income;         /**< from income accounts in the
+                                     transactions of the account */
+    gnc_numeric brokerage;      /**< to expense accounts in them */
+    gnc_numeric money_in;       /**< the value of the units bought */
+    gnc_numeric money_out;      /**< the value of the units sold and of
+                                     spin-offs */
+} GncPortfolioHolding;
+
+/** Work out the holding of each of accounts at date.
+ *
+ * @param accounts The accounts, which needn't hold the same commodity.
+ *
+ * @param date The holdings are at the end of the splits posted up to
+ * and including it.
+ *
+ * @param currency The currency of the amounts of money.
+ *
+ * @param method How the cost of units sold is found.
+ *
+ * @param fees_in_basis If TRUE, the brokerage of purchases becomes part
+ * of the cost of the units bought; in a transaction that buys and sells,
+ * in proportion to the units bought.
+ *
+ * @return A list of GncPortfolioHolding, one per account in the order of
+ * accounts, to be freed with gnc_portfolio_holdings_free().
+ */
+GList * gnc_portfolio_get_holdings (GList *accounts, time64 date,
+                                    gnc_commodity *currency,
+                                    GncPortfolioBasis method,
+                                    gboolean fees_in_basis);
+
+void gnc_portfolio_holdings_free (GList *holdings);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* GNC_PORTFOLIO_H */
+/** @} */
+/** @} */
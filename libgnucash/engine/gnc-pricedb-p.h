@@ -58,6 +58,10 @@ struct gnc_price_db_s
     GHashTable *commodity_hash;
     gboolean bulk_update;		 /* TRUE while reading XML file, etc. */
     gboolean reset_nth_price_cache;
+    guint generation;            /* bumped whenever the prices change */
+    GHashTable *conversion_paths; /* intermediates for indirect conversions */
+    GHashTable *counterparts;    /* commodity -> set of commodities it has
+                                  * a price series with, either way */
 };
 
 struct _GncPriceDBClass
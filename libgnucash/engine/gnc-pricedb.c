@@ -40,10 +40,12 @@ static gboolean remove_price(GNCPriceDB *db, GNCPrice *p, gboolean cleanup);
 static GNCPrice *lookup_nearest_in_time(GNCPriceDB *db, const gnc_commodity *c,
                                         const gnc_commodity *currency,
                                         time64 t, gboolean sameday);
-static gboolean
-pricedb_pricelist_traversal(GNCPriceDB *db,
-                            gboolean (*f)(GList *p, gpointer user_data),
-                            gpointer user_data);
+static void pricedb_series_added(GNCPriceDB *db, gnc_commodity *c,
+                                 gnc_commodity *currency);
+static void pricedb_series_removed(GNCPriceDB *db, gnc_commodity *c,
+                                   gnc_commodity *currency);
+static GHashTable *pricedb_get_counterparts(GNCPriceDB *db,
+                                            const gnc_commodity *c);
 
 enum
 {
@@ -105,6 +107,9 @@ gnc_price_init(GNCPrice* price)
     price->value = gnc_numeric_zero();
     price->type = NULL;
     price->source = PRICE_SOURCE_INVALID;
+    /* Prices almost never carry slots and a large database holds a great
+     * many of them, so don't keep an empty frame around for each one. */
+    qof_instance_release_empty_slots (QOF_INSTANCE (price));
 }
 
 /* Array of char constants for converting price-source enums. Be sure to keep in
@@ -461,6 +466,8 @@ static void
 gnc_price_set_dirty (GNCPrice *p)
 {
     qof_instance_set_dirty(&p->inst);
+    if (p->db)
+        p->db->generation++;
     qof_event_gen(&p->inst, QOF_EVENT_MODIFY, NULL);
 }
 
@@ -822,15 +829,170 @@ gnc_price_list_equal(PriceList *prices1, PriceList *prices2)
     return TRUE;
 }
 
+/* ==================================================================== */
+/* Price series
+
+   The prices for one commodity/currency pair are kept in a GArray of
+   PriceSeriesEntry sorted from oldest to newest, which is the exact
+   reverse of the PriceList order defined by compare_prices_by_date.
+   The price's time is stored next to the pointer so that the binary
+   searches don't have to dereference every GNCPrice they probe.
+ */
+
+typedef struct
+{
+    time64 time;
+    GNCPrice *price;
+} PriceSeriesEntry;
+
+typedef GArray PriceSeries;
+
+#define price_series_entry(series, i) \
+    (&g_array_index ((series), PriceSeriesEntry, (i)))
+
+static PriceSeries *
+price_series_new (void)
+{
+    return g_array_new (FALSE, FALSE, sizeof (PriceSeriesEntry));
+}
+
+static void
+price_series_destroy (PriceSeries *series)
+{
+    guint i;
+
+    if (!series) return;
+    for (i = 0; i < series->len; i++)
+        gnc_price_unref (price_series_entry (series, i)->price);
+    g_array_free (series, TRUE);
+}
+
+/* Returns the number of entries older than t, or if upper is TRUE the
+ * number of entries not newer than t. */
+static guint
+price_series_bisect (const PriceSeries *series, time64 t, gboolean upper)
+{
+    guint lo = 0, hi = series->len;
+
+    while (lo < hi)
+    {
+        guint mid = lo + (hi - lo) / 2;
+        time64 mid_t = price_series_entry (series, mid)->time;
+        if (mid_t < t || (upper && mid_t == t))
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+/* Same test as gnc_price_list_insert's, but only prices within a couple
+ * of days of p can fall on its day so only those are compared. */
+static gboolean
+price_series_is_duplicate (const PriceSeries *series, GNCPrice *p)
+{
+    const time64 window = 2 * 24 * 60 * 60;
+    time64 t = gnc_price_get_time64 (p);
+    PriceListIsDuplStruct dupl = { p, FALSE };
+    guint i;
+
+    for (i = price_series_bisect (series, t - window, FALSE);
+         i < series->len && !dupl.isDupl; i++)
+    {
+        PriceSeriesEntry *entry = price_series_entry (series, i);
+        if (entry->time > t + window)
+            break;
+        price_list_is_duplicate (entry->price, &dupl);
+    }
+    return dupl.isDupl;
+}
+
+static gboolean
+price_series_insert (PriceSeries *series, GNCPrice *p, gboolean check_dupl)
+{
+    PriceSeriesEntry entry;
+    guint pos, end;
+
+    if (!series || !p) return FALSE;
+    gnc_price_ref (p);
+
+    if (check_dupl && price_series_is_duplicate (series, p))
+        return TRUE;
+
+    entry.time = gnc_price_get_time64 (p);
+    entry.price = p;
+
+    /* Prices with the same time are ordered by GUID; there are rarely
+     * more than one or two of them. */
+    pos = price_series_bisect (series, entry.time, FALSE);
+    end = price_series_bisect (series, entry.time, TRUE);
+    while (pos < end &&
+           compare_prices_by_date (p, price_series_entry (series, pos)->price) <= 0)
+        ++pos;
+
+    g_array_insert_val (series, pos, entry);
+    return TRUE;
+}
+
+/* Returns the index of p in the series, or -1 if it isn't there. */
+static gint
+price_series_find (const PriceSeries *series, const GNCPrice *p)
+{
+    time64 t = gnc_price_get_time64 (p);
+    guint i;
+
+    for (i = price_series_bisect (series, t, FALSE); i < series->len; i++)
+    {
+        PriceSeriesEntry *entry = price_series_entry (series, i);
+        if (entry->price == p)
+            return i;
+        if (entry->time != t)
+            break;
+    }
+
+    /* Not where its time says it should be, so look everywhere. */
+    for (i = 0; i < series->len; i++)
+        if (price_series_entry (series, i)->price == p)
+            return i;
+    return -1;
+}
+
+static gboolean
+price_series_remove (PriceSeries *series, GNCPrice *p)
+{
+    gint i;
+
+    if (!series || !p) return FALSE;
+
+    i = price_series_find (series, p);
+    if (i < 0) return FALSE;
+
+    g_array_remove_index (series, i);
+    gnc_price_unref (p);
+    return TRUE;
+}
+
+/* Returns the series as a newest-first PriceList. The prices are not
+ * reffed so free the result with g_list_free. */
+static PriceList *
+price_series_to_list (const PriceSeries *series)
+{
+    PriceList *list = NULL;
+    guint i;
+
+    for (i = 0; i < series->len; i++)
+        list = g_list_prepend (list, price_series_entry (series, i)->price);
+    return list;
+}
+
 /* ==================================================================== */
 /* GNCPriceDB functions
 
    Structurally a GNCPriceDB contains a hash mapping price commodities
    (of type gnc_commodity*) to hashes mapping price currencies (of
-   type gnc_commodity*) to GNCPrice lists (see gnc-pricedb.h for a
-   description of GNCPrice lists).  The top-level key is the commodity
-   you want the prices for, and the second level key is the commodity
-   that the value is expressed in terms of.
+   type gnc_commodity*) to price series (see above).  The top-level
+   key is the commodity you want the prices for, and the second level
+   key is the commodity that the value is expressed in terms of.
  */
 
 /* GObject Initialization */
@@ -840,6 +1002,7 @@ static void
 gnc_pricedb_init(GNCPriceDB* pdb)
 {
     pdb->reset_nth_price_cache = FALSE;
+    pdb->generation = 0;
 }
 
 static void
@@ -882,6 +1045,8 @@ gnc_pricedb_create(QofBook * book)
 
     result->commodity_hash = g_hash_table_new(NULL, NULL);
     g_return_val_if_fail (result->commodity_hash, NULL);
+    result->counterparts = g_hash_table_new_full (NULL, NULL, NULL,
+                                                  (GDestroyNotify) g_hash_table_destroy);
     return result;
 }
 
@@ -890,18 +1055,13 @@ destroy_pricedb_currency_hash_data(gpointer key,
                                    gpointer data,
                                    gpointer user_data)
 {
-    GList *price_list = (GList *) data;
-    GList *node;
-    GNCPrice *p;
-
-    for (node = price_list; node; node = node->next)
-    {
-        p = node->data;
+    PriceSeries *series = (PriceSeries *) data;
+    guint i;
 
-        p->db = NULL;
-    }
+    for (i = 0; i < series->len; i++)
+        price_series_entry (series, i)->price->db = NULL;
 
-    gnc_price_list_destroy(price_list);
+    price_series_destroy (series);
 }
 
 static void
@@ -929,6 +1089,11 @@ gnc_pricedb_destroy(GNCPriceDB *db)
     }
     g_hash_table_destroy (db->commodity_hash);
     db->commodity_hash = NULL;
+    if (db->conversion_paths)
+        g_hash_table_destroy (db->conversion_paths);
+    db->conversion_paths = NULL;
+    g_hash_table_destroy (db->counterparts);
+    db->counterparts = NULL;
     /* qof_instance_release (&db->inst); */
     g_object_unref(db);
 }
@@ -939,6 +1104,13 @@ gnc_pricedb_set_bulk_update(GNCPriceDB *db, gboolean bulk_update)
     db->bulk_update = bulk_update;
 }
 
+guint
+gnc_pricedb_get_generation(GNCPriceDB *db)
+{
+    g_return_val_if_fail (db, 0);
+    return db->generation;
+}
+
 /* ==================================================================== */
 /* This is kind of weird, the way its done.  Each collection of prices
  * for a given commodity should get its own guid, be its own entity, etc.
@@ -1011,7 +1183,7 @@ pricedb_equal_foreach_pricelist(gpointer key, gpointer val, gpointer user_data)
 {
     GNCPriceDBEqualData *equal_data = user_data;
     gnc_commodity *currency = key;
-    GList *price_list1 = val;
+    GList *price_list1 = price_series_to_list (val);
     GList *price_list2;
 
     price_list2 = gnc_pricedb_get_prices (equal_data->db2,
@@ -1021,6 +1193,7 @@ pricedb_equal_foreach_pricelist(gpointer key, gpointer val, gpointer user_data)
     if (!gnc_price_list_equal (price_list1, price_list2))
         equal_data->equal = FALSE;
 
+    g_list_free (price_list1);
     gnc_price_list_destroy (price_list2);
 }
 
@@ -1070,7 +1243,7 @@ add_price(GNCPriceDB *db, GNCPrice *p)
 {
     /* This function will use p, adding a ref, so treat p as read-only
        if this function succeeds. */
-    GList *price_list;
+    PriceSeries *series;
     gnc_commodity *commodity;
     gnc_commodity *currency;
     GHashTable *currency_hash;
@@ -1131,21 +1304,22 @@ add_price(GNCPriceDB *db, GNCPrice *p)
         g_hash_table_insert(db->commodity_hash, commodity, currency_hash);
     }
 
-    price_list = g_hash_table_lookup(currency_hash, currency);
-    if (!gnc_price_list_insert(&price_list, p, !db->bulk_update))
+    series = g_hash_table_lookup(currency_hash, currency);
+    if (!series)
     {
-        LEAVE ("gnc_price_list_insert failed");
-        return FALSE;
+        series = price_series_new ();
+        g_hash_table_insert(currency_hash, currency, series);
+        pricedb_series_added (db, commodity, currency);
     }
 
-    if (!price_list)
+    if (!price_series_insert(series, p, !db->bulk_update))
     {
-        LEAVE (" no price list");
+        LEAVE ("price_series_insert failed");
         return FALSE;
     }
 
-    g_hash_table_insert(currency_hash, currency, price_list);
     p->db = db;
+    db->generation++;
 
     qof_event_gen (&p->inst, QOF_EVENT_ADD, NULL);
 
@@ -1188,6 +1362,223 @@ gnc_pricedb_add_price(GNCPriceDB *db, GNCPrice *p)
     return TRUE;
 }
 
+/* gnc_pricedb_add_prices() sorts the batch by commodity, currency and
+ * series order so that each series is merged with one run of it. */
+typedef struct
+{
+    GNCPrice *price;
+    guint index;                /* position in the caller's array */
+} PriceBatchEntry;
+
+static gint
+compare_price_batch_entries (gconstpointer a, gconstpointer b)
+{
+    const PriceBatchEntry *ea = a, *eb = b;
+    guintptr com_a = (guintptr) ea->price->commodity;
+    guintptr com_b = (guintptr) eb->price->commodity;
+    guintptr cur_a = (guintptr) ea->price->currency;
+    guintptr cur_b = (guintptr) eb->price->currency;
+
+    if (com_a != com_b) return com_a < com_b ? -1 : 1;
+    if (cur_a != cur_b) return cur_a < cur_b ? -1 : 1;
+    return compare_prices_by_date (eb->price, ea->price);
+}
+
+/* Applies add_price's same-day rule to the batch prices run[0..len), which
+ * all fall on one day, as if they were added in array order: a price
+ * replaces the one already there unless that one has a better source.
+ * The losers are cleared, and a price already in the db that loses is
+ * removed from it. */
+static void
+price_batch_resolve_day (GNCPriceDB *db, PriceBatchEntry *run, guint len)
+{
+    GNCPrice *first = run[0].price;
+    GNCPrice *old_price = gnc_pricedb_lookup_day_t64 (db, first->commodity,
+                                                      first->currency,
+                                                      first->tmspec);
+    PriceBatchEntry *winner = NULL;
+    GNCPrice *current = old_price;
+    guint done;
+
+    for (done = 0; done < len; done++)
+    {
+        PriceBatchEntry *next = NULL;
+        guint i;
+
+        for (i = 0; i < len; i++)
+            if (run[i].price && (!next || run[i].index < next->index) &&
+                (!winner || run[i].index > winner->index))
+                next = &run[i];
+        if (!next) break;
+
+        if (current && next->price->source > current->source)
+        {
+            next->price = NULL;
+            continue;
+        }
+        if (winner)
+            winner->price = NULL;
+        winner = next;
+        current = next->price;
+    }
+
+    if (old_price && winner)
+        gnc_pricedb_remove_price (db, old_price);
+    gnc_price_unref (old_price);
+}
+
+static guint
+price_batch_merge_series (GNCPriceDB *db, PriceBatchEntry *run, guint len)
+{
+    gnc_commodity *commodity, *currency;
+    GHashTable *currency_hash;
+    PriceSeries *series, *merged;
+    guint i = 0, j = 0, added = 0;
+    gboolean is_new;
+
+    /* The same-day checks may have rejected the whole run. */
+    while (j < len && !run[j].price)
+        ++j;
+    if (j == len) return 0;
+    commodity = run[j].price->commodity;
+    currency = run[j].price->currency;
+
+    currency_hash = g_hash_table_lookup (db->commodity_hash, commodity);
+    if (!currency_hash)
+    {
+        currency_hash = g_hash_table_new (NULL, NULL);
+        g_hash_table_insert (db->commodity_hash, commodity, currency_hash);
+    }
+    series = g_hash_table_lookup (currency_hash, currency);
+    if (!series)
+        series = price_series_new ();
+
+    merged = g_array_sized_new (FALSE, FALSE, sizeof (PriceSeriesEntry),
+                                series->len + len);
+    while (i < series->len || j < len)
+    {
+        PriceSeriesEntry entry;
+
+        if (j < len && !run[j].price)
+        {
+            ++j;
+            continue;
+        }
+        if (j >= len ||
+            (i < series->len &&
+             compare_prices_by_date (run[j].price,
+                                     price_series_entry (series, i)->price) <= 0))
+        {
+            entry = *price_series_entry (series, i++);
+        }
+        else
+        {
+            GNCPrice *p = run[j++].price;
+            gnc_price_ref (p);
+            p->db = db;
+            entry.time = p->tmspec;
+            entry.price = p;
+            ++added;
+        }
+        g_array_append_val (merged, entry);
+    }
+
+    is_new = series->len == 0;
+    g_array_free (series, TRUE);
+    if (merged->len)
+    {
+        g_hash_table_insert (currency_hash, currency, merged);
+        if (is_new)
+            pricedb_series_added (db, commodity, currency);
+    }
+    else
+        g_array_free (merged, TRUE);
+    return added;
+}
+
+guint
+gnc_pricedb_add_prices (GNCPriceDB *db, GNCPrice **prices, guint n_prices)
+{
+    GArray *batch;
+    guint i, start, added = 0;
+
+    if (!db || !prices || !db->commodity_hash) return 0;
+    ENTER ("db=%p, n_prices=%u bulk_update=%d", db, n_prices, db->bulk_update);
+
+    batch = g_array_sized_new (FALSE, FALSE, sizeof (PriceBatchEntry), n_prices);
+    for (i = 0; i < n_prices; i++)
+    {
+        GNCPrice *p = prices[i];
+        PriceBatchEntry entry = { p, i };
+
+        if (!p) continue;
+        if (!qof_instance_books_equal (db, p))
+        {
+            PERR ("attempted to mix up prices across different books");
+            continue;
+        }
+        if (!p->commodity || !p->currency)
+        {
+            PWARN ("price %p has no commodity or currency", p);
+            continue;
+        }
+        g_array_append_val (batch, entry);
+    }
+    g_array_sort (batch, compare_price_batch_entries);
+
+    for (start = 0; start < batch->len;)
+    {
+        PriceBatchEntry *run = &g_array_index (batch, PriceBatchEntry, start);
+        guint len = 1;
+
+        while (start + len < batch->len &&
+               run[len].price->commodity == run[0].price->commodity &&
+               run[len].price->currency == run[0].price->currency)
+            ++len;
+
+        if (!db->bulk_update)
+        {
+            guint day_start = 0;
+            while (day_start < len)
+            {
+                time64 day = time64CanonicalDayTime (run[day_start].price->tmspec);
+                guint day_len = 1;
+                while (day_start + day_len < len &&
+                       time64CanonicalDayTime (run[day_start + day_len].price->tmspec) == day)
+                    ++day_len;
+                price_batch_resolve_day (db, run + day_start, day_len);
+                day_start += day_len;
+            }
+        }
+
+        added += price_batch_merge_series (db, run, len);
+        start += len;
+    }
+
+    if (added)
+    {
+        db->generation++;
+        db->reset_nth_price_cache = TRUE;
+        gnc_pricedb_begin_edit (db);
+        qof_instance_set_dirty (&db->inst);
+        gnc_pricedb_commit_edit (db);
+        qof_event_gen (&db->inst, QOF_EVENT_MODIFY, NULL);
+
+        /* Announce each price as add_price does, now that the whole batch
+         * is in the db; the price tree model only follows price events. */
+        for (i = 0; i < batch->len; i++)
+        {
+            GNCPrice *p = g_array_index (batch, PriceBatchEntry, i).price;
+            if (p)
+                qof_event_gen (&p->inst, QOF_EVENT_ADD, NULL);
+        }
+    }
+    g_array_free (batch, TRUE);
+
+    LEAVE ("db=%p, added=%u", db, added);
+    return added;
+}
+
 /* remove_price() is a utility; its only function is to remove the price
  * from the double-hash tables.
  */
@@ -1195,7 +1586,7 @@ gnc_pricedb_add_price(GNCPriceDB *db, GNCPrice *p)
 static gboolean
 remove_price(GNCPriceDB *db, GNCPrice *p, gboolean cleanup)
 {
-    GList *price_list;
+    PriceSeries *series;
     gnc_commodity *commodity;
     gnc_commodity *currency;
     GHashTable *currency_hash;
@@ -1231,24 +1622,20 @@ remove_price(GNCPriceDB *db, GNCPrice *p, gboolean cleanup)
     }
 
     qof_event_gen (&p->inst, QOF_EVENT_REMOVE, NULL);
-    price_list = g_hash_table_lookup(currency_hash, currency);
+    series = g_hash_table_lookup(currency_hash, currency);
     gnc_price_ref(p);
-    if (!gnc_price_list_remove(&price_list, p))
-    {
-        gnc_price_unref(p);
-        LEAVE (" cannot remove price list");
-        return FALSE;
-    }
+    price_series_remove(series, p);
 
-    /* if the price list is empty, then remove this currency from the
+    /* if the price series is empty, then remove this currency from the
        commodity hash */
-    if (price_list)
-    {
-        g_hash_table_insert(currency_hash, currency, price_list);
-    }
-    else
+    if (!series || series->len == 0)
     {
         g_hash_table_remove(currency_hash, currency);
+        if (series)
+        {
+            price_series_destroy(series);
+            pricedb_series_removed (db, commodity, currency);
+        }
 
         if (cleanup)
         {
@@ -1264,6 +1651,7 @@ remove_price(GNCPriceDB *db, GNCPrice *p, gboolean cleanup)
         }
     }
 
+    db->generation++;
     gnc_price_unref(p);
     LEAVE ("db=%p, pr=%p", db, p);
     return TRUE;
@@ -1308,118 +1696,23 @@ typedef struct
     gboolean delete_fq;
     gboolean delete_user;
     gboolean delete_app;
-    GSList *list;
+    PriceRemoveKeepOptions keep;
+    GDate *fiscal_end_date;
+    GDateMonth fiscal_month_start;
+    guint candidates;
+    guint removed;
 } remove_info;
 
 static gboolean
-check_one_price_date (GNCPrice *price, gpointer user_data)
-{
-    remove_info *data = user_data;
-    PriceSource source;
-    time64 time;
-
-    ENTER("price %p (%s), data %p", price,
-          gnc_commodity_get_mnemonic(gnc_price_get_commodity(price)),
-          user_data);
-
-    source = gnc_price_get_source (price);
-
-    if ((source == PRICE_SOURCE_FQ) && data->delete_fq)
-        PINFO ("Delete Quote Source");
-    else if ((source == PRICE_SOURCE_USER_PRICE) && data->delete_user)
-        PINFO ("Delete User Source");
-    else if ((source != PRICE_SOURCE_FQ) && (source != PRICE_SOURCE_USER_PRICE) && data->delete_app)
-        PINFO ("Delete App Source");
-    else
-    {
-        LEAVE("Not a matching source");
-        return TRUE;
-    }
-
-    time = gnc_price_get_time64 (price);
-    {
-        gchar buf[40];
-        gnc_time64_to_iso8601_buff(time, buf);
-        DEBUG("checking date %s", buf);
-    }
-    if (time < data->cutoff)
-    {
-        data->list = g_slist_prepend(data->list, price);
-        DEBUG("will delete");
-    }
-    LEAVE(" ");
-    return TRUE;
-}
-
-static void
-pricedb_remove_foreach_pricelist (gpointer key,
-                                  gpointer val,
-                                  gpointer user_data)
-{
-    GList *price_list = (GList *) val;
-    GList *node = price_list;
-    remove_info *data = (remove_info *) user_data;
-
-    ENTER("key %p, value %p, data %p", key, val, user_data);
-
-    /* now check each item in the list */
-    g_list_foreach(node, (GFunc)check_one_price_date, data);
-
-    LEAVE(" ");
-}
-
-static gint
-compare_prices_by_commodity_date (gconstpointer a, gconstpointer b)
-{
-    time64 time_a, time_b;
-    gnc_commodity *comma;
-    gnc_commodity *commb;
-    gnc_commodity *curra;
-    gnc_commodity *currb;
-    gint result;
-
-    if (!a && !b) return 0;
-    /* nothing is always less than something */
-    if (!a) return -1;
-    if (!b) return 1;
-
-    comma = gnc_price_get_commodity ((GNCPrice *) a);
-    commb = gnc_price_get_commodity ((GNCPrice *) b);
-
-    if (!gnc_commodity_equal(comma, commb))
-        return gnc_commodity_compare(comma, commb);
-
-    curra = gnc_price_get_currency ((GNCPrice *) a);
-    currb = gnc_price_get_currency ((GNCPrice *) b);
-
-    if (!gnc_commodity_equal(curra, currb))
-        return gnc_commodity_compare(curra, currb);
-
-    time_a = gnc_price_get_time64((GNCPrice *) a);
-    time_b = gnc_price_get_time64((GNCPrice *) b);
-
-    /* Note we return -1 if time_b is before time_a. */
-    result = time64_cmp(time_b, time_a);
-    if (result) return result;
-
-    /* For a stable sort */
-    return guid_compare (gnc_price_get_guid((GNCPrice *) a),
-                         gnc_price_get_guid((GNCPrice *) b));
-}
-
-static gboolean
-price_commodity_and_currency_equal (GNCPrice *a, GNCPrice *b)
+price_source_is_removable (GNCPrice *price, const remove_info *data)
 {
-    gboolean ret_comm = FALSE;
-    gboolean ret_curr = FALSE;
-
-    if (gnc_commodity_equal (gnc_price_get_commodity(a), gnc_price_get_commodity (b)))
-        ret_comm = TRUE;
-
-    if (gnc_commodity_equal (gnc_price_get_currency(a), gnc_price_get_currency (b)))
-        ret_curr = TRUE;
+    PriceSource source = gnc_price_get_source (price);
 
-    return (ret_comm && ret_curr);
+    if (source == PRICE_SOURCE_FQ)
+        return data->delete_fq;
+    if (source == PRICE_SOURCE_USER_PRICE)
+        return data->delete_user;
+    return data->delete_app;
 }
 
 static void
@@ -1445,24 +1738,6 @@ gnc_pricedb_remove_old_prices_pinfo (GNCPrice *price, gboolean keep_message)
         PINFO("Keep price date is invalid");
 }
 
-static void
-clone_price (GNCPrice **price, GNCPrice *source_price)
-{
-    QofBook *book;
-
-    if (!source_price) return;
-    if (price == NULL) return;
-
-    book = qof_instance_get_book (QOF_INSTANCE(source_price));
-
-    if (*price)
-        gnc_price_unref (*price);
-
-    *price = gnc_price_clone (source_price, book);
-
-    gnc_pricedb_remove_old_prices_pinfo (source_price, TRUE);
-}
-
 static gint
 roundUp (gint numToRound, gint multiple)
 {
@@ -1489,113 +1764,109 @@ get_fiscal_quarter (GDate *date, GDateMonth fiscal_start)
     return q;
 }
 
+/* Returns a value identifying the period of the price's date that the keep
+ * option retains one price for. */
+static gint
+price_keep_period (GNCPrice *price, const remove_info *data)
+{
+    GDate price_date = time64_to_gdate (gnc_price_get_time64 (price));
+
+    switch (data->keep)
+    {
+    case PRICE_REMOVE_KEEP_LAST_PERIOD:
+    {
+        GDate fiscal_end = price_date;
+        gnc_gdate_set_fiscal_year_end (&fiscal_end, data->fiscal_end_date);
+        return g_date_get_year (&fiscal_end);
+    }
+    case PRICE_REMOVE_KEEP_LAST_QUARTERLY:
+        return get_fiscal_quarter (&price_date, data->fiscal_month_start);
+    case PRICE_REMOVE_KEEP_LAST_MONTHLY:
+        return g_date_get_month (&price_date);
+    case PRICE_REMOVE_KEEP_LAST_WEEKLY:
+        return g_date_get_iso8601_week_of_year (&price_date);
+    default:
+        return 0;
+    }
+}
+
+/* Detach a price that has already been dropped from its series and have
+ * the backend delete it. */
 static void
-gnc_pricedb_process_removal_list (GNCPriceDB *db, GDate *fiscal_end_date,
-                                  remove_info data, PriceRemoveKeepOptions keep)
+pricedb_release_removed_price (GNCPrice *p)
 {
-    GSList *item;
-    gboolean save_first_price = FALSE;
-    gint saved_test_value = 0, next_test_value = 0;
-    GNCPrice *cloned_price = NULL;
-    GDateMonth fiscal_month_start;
-    GDate *tmp_date = g_date_new_dmy (g_date_get_day (fiscal_end_date),
-                                      g_date_get_month (fiscal_end_date),
-                                      g_date_get_year (fiscal_end_date));
+    gnc_pricedb_remove_old_prices_pinfo (p, FALSE);
+    qof_event_gen (&p->inst, QOF_EVENT_REMOVE, NULL);
 
-    // get the fiscal start month
-    g_date_subtract_months (tmp_date, 12);
-    fiscal_month_start = g_date_get_month (tmp_date) + 1;
-    g_date_free (tmp_date);
+    gnc_price_begin_edit (p);
+    qof_instance_set_destroying (p, TRUE);
+    gnc_price_commit_edit (p);
+    p->db = NULL;
+    gnc_price_unref (p);
+}
 
-    // sort the list by commodity / currency / date
-    data.list = g_slist_sort (data.list, compare_prices_by_commodity_date);
+/* Compact one series in a single pass. Only the prices older than the
+ * cutoff are candidates; walking them newest first, the first one seen
+ * keeps its period and every later one in the same period is dropped.
+ * Returns TRUE when the series ended up empty (and has been destroyed) so
+ * it can be used with g_hash_table_foreach_remove. */
+static gboolean
+pricedb_compact_series (gpointer key, gpointer val, gpointer user_data)
+{
+    gnc_commodity *currency = key;
+    PriceSeries *series = val;
+    remove_info *data = user_data;
+    guint start = price_series_bisect (series, data->cutoff, FALSE);
+    guint i, dst = start;
+    gboolean have_period = FALSE;
+    gint kept_period = 0;
+    gnc_commodity *commodity = NULL;
 
-    /* Now run this external list deleting prices */
-    for (item = data.list; item; item = g_slist_next(item))
+    for (i = start; i-- > 0;)
     {
-        GDate saved_price_date;
-        GDate next_price_date;
+        PriceSeriesEntry entry = *price_series_entry (series, i);
+        gboolean drop = FALSE;
 
-        // Keep None
-        if (keep == PRICE_REMOVE_KEEP_NONE)
-        {
-            gnc_pricedb_remove_old_prices_pinfo (item->data, FALSE);
-            gnc_pricedb_remove_price (db, item->data);
-            continue;
-        }
+        if (!commodity)
+            commodity = gnc_price_get_commodity (entry.price);
 
-        save_first_price = !price_commodity_and_currency_equal (item->data, cloned_price); // Not Equal
-        if (save_first_price == TRUE)
+        if (price_source_is_removable (entry.price, data))
         {
-            clone_price (&cloned_price, item->data);
-            continue;
-        }
-
-        // get the price dates
-        saved_price_date = time64_to_gdate (gnc_price_get_time64 (cloned_price));
-        next_price_date = time64_to_gdate (gnc_price_get_time64 (item->data));
-
-        // Keep last price in fiscal year
-        if (keep == PRICE_REMOVE_KEEP_LAST_PERIOD && save_first_price == FALSE)
-        {
-            GDate *saved_fiscal_end = g_date_new_dmy (g_date_get_day (&saved_price_date),
-                                                      g_date_get_month (&saved_price_date),
-                                                      g_date_get_year (&saved_price_date));
-
-            GDate *next_fiscal_end = g_date_new_dmy (g_date_get_day (&next_price_date),
-                                                     g_date_get_month (&next_price_date),
-                                                     g_date_get_year (&next_price_date));
-
-            gnc_gdate_set_fiscal_year_end (saved_fiscal_end, fiscal_end_date);
-            gnc_gdate_set_fiscal_year_end (next_fiscal_end, fiscal_end_date);
-
-            saved_test_value = g_date_get_year (saved_fiscal_end);
-            next_test_value = g_date_get_year (next_fiscal_end);
-
-            PINFO("Keep last price in fiscal year");
-
-            g_date_free (saved_fiscal_end);
-            g_date_free (next_fiscal_end);
-        }
-
-        // Keep last price in fiscal quarter
-        if (keep == PRICE_REMOVE_KEEP_LAST_QUARTERLY && save_first_price == FALSE)
-        {
-            saved_test_value = get_fiscal_quarter (&saved_price_date, fiscal_month_start);
-            next_test_value = get_fiscal_quarter (&next_price_date, fiscal_month_start);
-
-            PINFO("Keep last price in fiscal quarter");
+            data->candidates++;
+            if (data->keep == PRICE_REMOVE_KEEP_NONE)
+                drop = TRUE;
+            else
+            {
+                gint period = price_keep_period (entry.price, data);
+                if (have_period && period == kept_period)
+                    drop = TRUE;
+                else
+                {
+                    have_period = TRUE;
+                    kept_period = period;
+                    gnc_pricedb_remove_old_prices_pinfo (entry.price, TRUE);
+                }
+            }
         }
 
-        // Keep last price of every month
-        if (keep == PRICE_REMOVE_KEEP_LAST_MONTHLY && save_first_price == FALSE)
-        {
-            saved_test_value = g_date_get_month (&saved_price_date);
-            next_test_value = g_date_get_month (&next_price_date);
+        if (drop)
+            pricedb_release_removed_price (entry.price);
+        else
+            *price_series_entry (series, --dst) = entry;
+    }
 
-            PINFO("Keep last price of every month");
-        }
+    if (dst == 0)
+        return FALSE;
 
-        // Keep last price of every week
-        if (keep == PRICE_REMOVE_KEEP_LAST_WEEKLY && save_first_price == FALSE)
-        {
-            saved_test_value = g_date_get_iso8601_week_of_year (&saved_price_date);
-            next_test_value = g_date_get_iso8601_week_of_year (&next_price_date);
+    g_array_remove_range (series, 0, dst);
+    data->removed += dst;
 
-            PINFO("Keep last price of every week");
-        }
+    if (series->len > 0)
+        return FALSE;
 
-        // Now compare the values
-        if (saved_test_value == next_test_value)
-        {
-            gnc_pricedb_remove_old_prices_pinfo (item->data, FALSE);
-            gnc_pricedb_remove_price (db, item->data);
-        }
-        else
-            clone_price (&cloned_price, item->data);
-    }
-    if (cloned_price)
-        gnc_price_unref (cloned_price);
+    price_series_destroy (series);
+    pricedb_series_removed (data->db, commodity, currency);
+    return TRUE;
 }
 
 gboolean
@@ -1605,63 +1876,78 @@ gnc_pricedb_remove_old_prices (GNCPriceDB *db, GList *comm_list,
                               PriceRemoveKeepOptions keep)
 {
     remove_info data;
+    GDate default_end_date, start_date;
     GList *node;
     char datebuff[MAX_DATE_LENGTH + 1];
     memset (datebuff, 0, sizeof(datebuff));
 
-    data.db = db;
-    data.cutoff = cutoff;
-    data.list = NULL;
-    data.delete_fq = FALSE;
-    data.delete_user = FALSE;
-    data.delete_app = FALSE;
+    g_return_val_if_fail (db != NULL, FALSE);
 
     ENTER("Remove Prices for Source %d, keeping %d", source, keep);
 
-    // setup the source options
-    if (source & PRICE_REMOVE_SOURCE_APP)
-        data.delete_app = TRUE;
+    // Check for a valid fiscal end of year date
+    if (fiscal_end_date == NULL || g_date_valid (fiscal_end_date) == FALSE)
+    {
+        GDate *today = gnc_g_date_new_today ();
+        g_date_clear (&default_end_date, 1);
+        g_date_set_dmy (&default_end_date, 31, 12, g_date_get_year (today));
+        g_date_free (today);
+        if (fiscal_end_date)
+            *fiscal_end_date = default_end_date;
+        else
+            fiscal_end_date = &default_end_date;
+    }
+
+    data.db = db;
+    data.cutoff = cutoff;
+    data.delete_fq = (source & PRICE_REMOVE_SOURCE_FQ) != 0;
+    data.delete_user = (source & PRICE_REMOVE_SOURCE_USER) != 0;
+    data.delete_app = (source & PRICE_REMOVE_SOURCE_APP) != 0;
+    data.keep = keep;
+    data.fiscal_end_date = fiscal_end_date;
+    data.candidates = 0;
+    data.removed = 0;
 
-    if (source & PRICE_REMOVE_SOURCE_FQ)
-        data.delete_fq = TRUE;
+    // get the fiscal start month
+    start_date = *fiscal_end_date;
+    g_date_subtract_months (&start_date, 12);
+    data.fiscal_month_start = g_date_get_month (&start_date) + 1;
 
-    if (source & PRICE_REMOVE_SOURCE_USER)
-        data.delete_user = TRUE;
+    qof_print_date_buff (datebuff, sizeof(datebuff), cutoff);
+    DEBUG("Cutoff date is %s", datebuff);
 
-    // Walk the list of commodities
+    /* Removing a long history price by price floods the event handlers,
+     * so collect the changes and publish them once at the end. */
+    qof_event_begin_batch ();
     for (node = g_list_first (comm_list); node; node = g_list_next (node))
     {
-        GHashTable *currencies_hash = g_hash_table_lookup (db->commodity_hash, node->data);
-        g_hash_table_foreach (currencies_hash, pricedb_remove_foreach_pricelist, &data);
-    }
+        GHashTable *currency_hash = db->commodity_hash ?
+            g_hash_table_lookup (db->commodity_hash, node->data) : NULL;
+        if (!currency_hash)
+            continue;
 
-    if (data.list == NULL)
-    {
-        LEAVE("Empty price list");
-        return FALSE;
+        g_hash_table_foreach_remove (currency_hash, pricedb_compact_series,
+                                     &data);
+        if (g_hash_table_size (currency_hash) == 0)
+        {
+            g_hash_table_remove (db->commodity_hash, node->data);
+            g_hash_table_destroy (currency_hash);
+        }
     }
-    qof_print_date_buff (datebuff, sizeof(datebuff), cutoff);
-    DEBUG("Number of Prices in list is %d, Cutoff date is %s",
-          g_slist_length (data.list), datebuff);
+    qof_event_end_batch ();
 
-    // Check for a valid fiscal end of year date
-    if (fiscal_end_date == NULL)
+    if (data.removed)
     {
-        GDateYear year_now = g_date_get_year (gnc_g_date_new_today ());
-        fiscal_end_date = g_date_new ();
-        g_date_set_dmy (fiscal_end_date, 31, 12, year_now);
-    }
-    else if (g_date_valid (fiscal_end_date) == FALSE)
-    {
-        GDateYear year_now = g_date_get_year (gnc_g_date_new_today ());
-        g_date_clear (fiscal_end_date, 1);
-        g_date_set_dmy (fiscal_end_date, 31, 12, year_now);
+        db->generation++;
+        db->reset_nth_price_cache = TRUE;
+        gnc_pricedb_begin_edit (db);
+        qof_instance_set_dirty (&db->inst);
+        gnc_pricedb_commit_edit (db);
+        qof_event_gen (&db->inst, QOF_EVENT_MODIFY, NULL);
     }
-    gnc_pricedb_process_removal_list (db, fiscal_end_date, data, keep);
 
-    g_slist_free (data.list);
-    LEAVE(" ");
-    return TRUE;
+    LEAVE("%u candidates, %u removed", data.candidates, data.removed);
+    return data.candidates > 0;
 }
 
 /* ==================================================================== */
@@ -1675,28 +1961,30 @@ hash_values_helper(gpointer key, gpointer value, gpointer data)
     GList ** l = data;
     if (*l)
     {
-        GList *new_l;
-        new_l = pricedb_price_list_merge(*l, value);
+        GList *new_l, *value_l = price_series_to_list (value);
+        new_l = pricedb_price_list_merge(*l, value_l);
         g_list_free (*l);
+        g_list_free (value_l);
         *l = new_l;
     }
     else
-        *l = g_list_copy (value);
+        *l = price_series_to_list (value);
 }
 
 static PriceList *
 price_list_from_hashtable (GHashTable *hash, const gnc_commodity *currency)
 {
-    GList *price_list = NULL, *result = NULL ;
+    PriceSeries *series;
+    GList *result = NULL;
     if (currency)
     {
-        price_list = g_hash_table_lookup(hash, currency);
-        if (!price_list)
+        series = g_hash_table_lookup(hash, currency);
+        if (!series)
         {
             LEAVE (" no price list");
             return NULL;
         }
-        result = g_list_copy (price_list);
+        result = price_series_to_list (series);
     }
     else
     {
@@ -1747,11 +2035,13 @@ pricedb_get_prices_internal(GNCPriceDB *db, const gnc_commodity *commodity,
     PriceList *forward_list = NULL, *reverse_list = NULL;
     g_return_val_if_fail (db != NULL, NULL);
     g_return_val_if_fail (commodity != NULL, NULL);
+    QOF_TIMER_START (prices, "pricedb.get-prices");
     forward_hash = g_hash_table_lookup(db->commodity_hash, commodity);
     if (currency && bidi)
         reverse_hash = g_hash_table_lookup(db->commodity_hash, currency);
     if (!forward_hash && !reverse_hash)
     {
+        QOF_TIMER_STOP (prices);
         LEAVE (" no currency hash");
         return NULL;
     }
@@ -1782,27 +2072,75 @@ pricedb_get_prices_internal(GNCPriceDB *db, const gnc_commodity *commodity,
         }
     }
 
+    QOF_TIMER_STOP (prices);
     return forward_list;
 }
 
+static PriceSeries *
+pricedb_get_series (GNCPriceDB *db, const gnc_commodity *commodity,
+                    const gnc_commodity *currency)
+{
+    GHashTable *currency_hash;
+
+    if (!db->commodity_hash) return NULL;
+    currency_hash = g_hash_table_lookup (db->commodity_hash, commodity);
+    if (!currency_hash) return NULL;
+    return g_hash_table_lookup (currency_hash, currency);
+}
+
+/* Finds the prices either side of t among the prices of c in currency and
+ * of currency in c: *before is set to the latest price not newer than t
+ * and *after to the earliest one newer than t, or NULL if there isn't
+ * one. The result is the same as walking the newest-first list from
+ * pricedb_get_prices_internal(db, c, currency, TRUE) but costs two binary
+ * searches per direction instead of a merge and a walk. */
+static void
+pricedb_bracket_time (GNCPriceDB *db, const gnc_commodity *c,
+                      const gnc_commodity *currency, time64 t,
+                      GNCPrice **before, GNCPrice **after)
+{
+    PriceSeries *series[2];
+    guint i;
+
+    *before = *after = NULL;
+    series[0] = pricedb_get_series (db, c, currency);
+    series[1] = pricedb_get_series (db, currency, c);
+
+    for (i = 0; i < G_N_ELEMENTS (series); i++)
+    {
+        guint k;
+
+        if (!series[i]) continue;
+        k = price_series_bisect (series[i], t, TRUE);
+        if (k > 0)
+        {
+            GNCPrice *p = price_series_entry (series[i], k - 1)->price;
+            if (!*before || compare_prices_by_date (p, *before) < 0)
+                *before = p;
+        }
+        if (k < series[i]->len)
+        {
+            GNCPrice *p = price_series_entry (series[i], k)->price;
+            if (!*after || compare_prices_by_date (p, *after) > 0)
+                *after = p;
+        }
+    }
+}
+
 GNCPrice *gnc_pricedb_lookup_latest(GNCPriceDB *db,
                           const gnc_commodity *commodity,
                           const gnc_commodity *currency)
 {
-    GList *price_list;
-    GNCPrice *result;
+    GNCPrice *result, *after;
 
     if (!db || !commodity || !currency) return NULL;
     ENTER ("db=%p commodity=%p currency=%p", db, commodity, currency);
+    QOF_COUNT ("pricedb.lookup-latest");
 
-    price_list = pricedb_get_prices_internal(db, commodity, currency, TRUE);
-    if (!price_list) return NULL;
-    /* This works magically because prices are inserted in date-sorted
-     * order, and the latest date always comes first. So return the
-     * first in the list.  */
-    result = price_list->data;
+    /* Nothing can be newer than INT64_MAX, so the latest price not newer
+     * than it is the latest price. */
+    pricedb_bracket_time (db, commodity, currency, INT64_MAX, &result, &after);
     gnc_price_ref(result);
-    g_list_free (price_list);
     LEAVE("price is %p", result);
     return result;
 }
@@ -1815,68 +2153,82 @@ typedef struct
 } UsesCommodity;
 
 /* price_list_scan_any_currency is the helper function used with
- * pricedb_pricelist_traversal by the "any_currency" price lookup functions. It
+ * pricedb_scan_any_currency by the "any_currency" price lookup functions. It
  * builds a list of prices that are either to or from the commodity "com".
  * The resulting list will include the last price newer than "t" and the first
- * price older than "t".  All other prices will be ignored.  Since in the most
- * common cases we will be looking for recent prices which are at the front of
- * the various price lists, this is considerably faster than concatenating all
- * the relevant price lists and sorting the result.
+ * price older than "t".  All other prices will be ignored.  Since each price
+ * series is sorted by time the two prices are found with a binary search,
+ * which is considerably faster than concatenating all the relevant price
+ * lists and sorting the result.
 */
 
 static gboolean
-price_list_scan_any_currency(GList *price_list, gpointer data)
+price_list_scan_any_currency(PriceSeries *series, gpointer data)
 {
     UsesCommodity *helper = (UsesCommodity*)data;
-    GList *node = price_list;
+    GNCPrice *price;
     gnc_commodity *com;
     gnc_commodity *cur;
+    guint k;
 
-    if (!price_list)
+    if (!series || series->len == 0)
         return TRUE;
 
-    com = gnc_price_get_commodity(node->data);
-    cur = gnc_price_get_currency(node->data);
+    price = price_series_entry (series, 0)->price;
+    com = gnc_price_get_commodity(price);
+    cur = gnc_price_get_currency(price);
 
-    /* if this price list isn't for the commodity we are interested in,
+    /* if this price series isn't for the commodity we are interested in,
        ignore it. */
     if (com != helper->com && cur != helper->com)
         return TRUE;
 
-    /* The price list is sorted in decreasing order of time.  Find the first
+    /* The series is sorted in increasing order of time.  Find the last
        price on it that is older than the requested time and add it and the
-       previous price to the result list. */
-    while (node != NULL)
+       following price to the result list. */
+    k = price_series_bisect (series, helper->t, FALSE);
+    if (k > 0)
     {
-        GNCPrice *price = node->data;
-        time64 price_t = gnc_price_get_time64(price);
-        if (price_t < helper->t)
+        /* If there is a following price add it to the results. */
+        if (k < series->len)
         {
-            /* If there is a previous price add it to the results. */
-            if (node->prev)
-            {
-                GNCPrice *prev_price = node->prev->data;
-                gnc_price_ref(prev_price);
-                *helper->list = g_list_prepend(*helper->list, prev_price);
-            }
-            /* Add the first price before the desired time */
-            gnc_price_ref(price);
-            *helper->list = g_list_prepend(*helper->list, price);
-            /* No point in looking further, they will all be older */
-            break;
-        }
-        else if (node->next == NULL)
-        {
-            /* The last price is later than given time, add it */
-            gnc_price_ref(price);
-            *helper->list = g_list_prepend(*helper->list, price);
+            GNCPrice *next_price = price_series_entry (series, k)->price;
+            gnc_price_ref(next_price);
+            *helper->list = g_list_prepend(*helper->list, next_price);
         }
-        node = node->next;
+        /* Add the first price before the desired time */
+        price = price_series_entry (series, k - 1)->price;
     }
+    /* Otherwise every price is later than the given time, add the
+       oldest. */
+    gnc_price_ref(price);
+    *helper->list = g_list_prepend(*helper->list, price);
 
     return TRUE;
 }
 
+/* Runs price_list_scan_any_currency over just the series that involve
+ * helper->com instead of every series in the database. */
+static void
+pricedb_scan_any_currency (GNCPriceDB *db, UsesCommodity *helper)
+{
+    GHashTable *others = pricedb_get_counterparts (db, helper->com);
+    GHashTableIter iter;
+    gpointer other;
+
+    if (!others) return;
+    g_hash_table_iter_init (&iter, others);
+    while (g_hash_table_iter_next (&iter, &other, NULL))
+    {
+        PriceSeries *series = pricedb_get_series (db, helper->com, other);
+        if (series)
+            price_list_scan_any_currency (series, helper);
+        series = pricedb_get_series (db, other, helper->com);
+        if (series)
+            price_list_scan_any_currency (series, helper);
+    }
+}
+
 static gboolean
 is_in_list (GList *list, const gnc_commodity *c)
 {
@@ -2039,7 +2391,7 @@ gnc_pricedb_lookup_nearest_in_time_any_currency_t64(GNCPriceDB *db,
     if (!db || !commodity) return NULL;
     ENTER ("db=%p commodity=%p", db, commodity);
 
-    pricedb_pricelist_traversal(db, price_list_scan_any_currency, &helper);
+    pricedb_scan_any_currency(db, &helper);
     prices = g_list_sort(prices, compare_prices_by_date);
     result = nearest_to(prices, commodity, t);
     gnc_price_list_destroy(prices);
@@ -2059,8 +2411,7 @@ gnc_pricedb_lookup_latest_before_any_currency_t64(GNCPriceDB *db,
     if (!db || !commodity) return NULL;
     ENTER ("db=%p commodity=%p", db, commodity);
 
-    pricedb_pricelist_traversal(db, price_list_scan_any_currency,
-                                       &helper);
+    pricedb_scan_any_currency(db, &helper);
     prices = g_list_sort(prices, compare_prices_by_date);
     result = latest_before(prices, commodity, t);
     gnc_price_list_destroy(prices);
@@ -2077,7 +2428,7 @@ gnc_pricedb_has_prices(GNCPriceDB *db,
                        const gnc_commodity *commodity,
                        const gnc_commodity *currency)
 {
-    GList *price_list;
+    PriceSeries *series;
     GHashTable *currency_hash;
     gint size;
 
@@ -2092,8 +2443,8 @@ gnc_pricedb_has_prices(GNCPriceDB *db,
 
     if (currency)
     {
-        price_list = g_hash_table_lookup(currency_hash, currency);
-        if (price_list)
+        series = g_hash_table_lookup(currency_hash, currency);
+        if (series)
         {
             LEAVE("yes");
             return TRUE;
@@ -2137,9 +2488,9 @@ static void
 price_count_helper(gpointer key, gpointer value, gpointer data)
 {
     int *result = data;
-    GList *price_list = value;
+    PriceSeries *series = value;
 
-    *result += g_list_length(price_list);
+    *result += series->len;
 }
 
 int
@@ -2162,30 +2513,13 @@ gnc_pricedb_num_prices(GNCPriceDB *db,
     return result;
 }
 
-/* Helper function for combining the price lists in gnc_pricedb_nth_price. */
-static void
-list_combine (gpointer element, gpointer data)
-{
-    GList *list = *(GList**)data;
-    if (list == NULL)
-        *(GList**)data = g_list_copy (element);
-    else
-    {
-        GList *new_list = g_list_concat ((GList *)list, g_list_copy (element));
-        *(GList**)data = new_list;
-    }
-}
-
 /* This function is used by gnc-tree-model-price.c for iterating through the
  * prices when building or filtering the pricedb dialog's
  * GtkTreeView. gtk-tree-view-price.c sorts the results after it has obtained
- * the values so there's nothing gained by sorting. However, for very large
- * collections of prices in multiple currencies (here commodity is the one being
- * priced and currency the one in which the price is denominated; note that they
- * may both be currencies or not) just concatenating the price lists together
- * can be expensive because the recieving list must be traversed to obtain its
- * end. To avoid that cost n times we cache the commodity and merged price list.
- * Since this is a GUI-driven function there is no concern about concurrency.
+ * the values so there's nothing gained by sorting. The commodity's prices are
+ * numbered as if its price series, each newest first, were concatenated in
+ * the currency hash's order, so the nth one is found by skipping whole series
+ * instead of building and walking a list of them all.
  */
 
 GNCPrice *
@@ -2193,9 +2527,6 @@ gnc_pricedb_nth_price (GNCPriceDB *db,
                        const gnc_commodity *c,
                        const int n)
 {
-    static const gnc_commodity *last_c = NULL;
-    static GList *prices = NULL;
-
     GNCPrice *result = NULL;
     GHashTable *currency_hash;
     g_return_val_if_fail (GNC_IS_COMMODITY (c), NULL);
@@ -2203,34 +2534,79 @@ gnc_pricedb_nth_price (GNCPriceDB *db,
     if (!db || !c || n < 0) return NULL;
     ENTER ("db=%p commodity=%s index=%d", db, gnc_commodity_get_mnemonic(c), n);
 
-    if (last_c && prices && last_c == c && db->reset_nth_price_cache == FALSE)
+    currency_hash = g_hash_table_lookup (db->commodity_hash, c);
+    if (currency_hash)
     {
-        result = g_list_nth_data (prices, n);
-        LEAVE ("price=%p", result);
-        return result;
+        GHashTableIter iter;
+        gpointer value;
+        guint i = n;
+
+        g_hash_table_iter_init (&iter, currency_hash);
+        while (g_hash_table_iter_next (&iter, NULL, &value))
+        {
+            PriceSeries *series = value;
+            if (i < series->len)
+            {
+                result = price_series_entry (series, series->len - 1 - i)->price;
+                break;
+            }
+            i -= series->len;
+        }
     }
 
-    last_c = c;
+    LEAVE ("price=%p", result);
+    return result;
+}
 
-    if (prices)
-    {
-        g_list_free (prices);
-        prices = NULL;
+gint
+gnc_pricedb_nth_price_index (GNCPriceDB *db, GNCPrice *p)
+{
+    GHashTable *currency_hash;
+    GHashTableIter iter;
+    gpointer key, value;
+    const gnc_commodity *currency;
+    gint offset = 0;
+
+    if (!db || !p) return -1;
+    currency_hash = g_hash_table_lookup (db->commodity_hash,
+                                         gnc_price_get_commodity (p));
+    if (!currency_hash) return -1;
+
+    currency = gnc_price_get_currency (p);
+    g_hash_table_iter_init (&iter, currency_hash);
+    while (g_hash_table_iter_next (&iter, &key, &value))
+    {
+        PriceSeries *series = value;
+        if (key == currency)
+        {
+            gint i = price_series_find (series, p);
+            return i < 0 ? -1 : offset + (gint) series->len - 1 - i;
+        }
+        offset += series->len;
     }
+    return -1;
+}
 
-    db->reset_nth_price_cache = FALSE;
+time64
+gnc_pricedb_get_oldest_price_time (GNCPriceDB *db, const gnc_commodity *c)
+{
+    GHashTable *currency_hash;
+    GHashTableIter iter;
+    gpointer value;
+    time64 oldest = G_MAXINT64;
 
+    if (!db || !c) return oldest;
     currency_hash = g_hash_table_lookup (db->commodity_hash, c);
-    if (currency_hash)
+    if (!currency_hash) return oldest;
+
+    g_hash_table_iter_init (&iter, currency_hash);
+    while (g_hash_table_iter_next (&iter, NULL, &value))
     {
-        GList *currencies = g_hash_table_get_values (currency_hash);
-        g_list_foreach (currencies, list_combine, &prices);
-        result = g_list_nth_data (prices, n);
-        g_list_free (currencies);
+        PriceSeries *series = value;
+        if (series->len && price_series_entry (series, 0)->time < oldest)
+            oldest = price_series_entry (series, 0)->time;
     }
-
-    LEAVE ("price=%p", result);
-    return result;
+    return oldest;
 }
 
 void
@@ -2255,27 +2631,17 @@ gnc_pricedb_lookup_at_time64(GNCPriceDB *db,
                              const gnc_commodity *currency,
                              time64 t)
 {
-    GList *price_list;
-    GList *item = NULL;
+    GNCPrice *before, *after;
 
     if (!db || !c || !currency) return NULL;
     ENTER ("db=%p commodity=%p currency=%p", db, c, currency);
-    price_list = pricedb_get_prices_internal (db, c, currency, TRUE);
-    item = price_list;
-    while (item)
+    pricedb_bracket_time (db, c, currency, t, &before, &after);
+    if (before && gnc_price_get_time64(before) == t)
     {
-        GNCPrice *p = item->data;
-        time64 price_time = gnc_price_get_time64(p);
-        if (price_time == t)
-        {
-            gnc_price_ref(p);
-            g_list_free (price_list);
-            LEAVE("price is %p", p);
-            return p;
-        }
-        item = item->next;
+        gnc_price_ref(before);
+        LEAVE("price is %p", before);
+        return before;
     }
-    g_list_free (price_list);
     LEAVE (" ");
     return NULL;
 }
@@ -2287,36 +2653,21 @@ lookup_nearest_in_time(GNCPriceDB *db,
                        time64 t,
                        gboolean sameday)
 {
-    GList *price_list;
     GNCPrice *current_price = NULL;
     GNCPrice *next_price = NULL;
     GNCPrice *result = NULL;
-    GList *item = NULL;
 
     if (!db || !c || !currency) return NULL;
     if (t == INT64_MAX) return NULL;
     ENTER ("db=%p commodity=%p currency=%p", db, c, currency);
-    price_list = pricedb_get_prices_internal (db, c, currency, TRUE);
-    if (!price_list) return NULL;
-    item = price_list;
+    QOF_COUNT ("pricedb.lookup-nearest");
 
-    /* default answer */
-    current_price = item->data;
-
-    /* find the first candidate past the one we want.  Remember that
-       prices are in most-recent-first order. */
-    while (!next_price && item)
-    {
-        GNCPrice *p = item->data;
-        time64 price_time = gnc_price_get_time64(p);
-        if (price_time <= t)
-        {
-            next_price = item->data;
-            break;
-        }
-        current_price = item->data;
-        item = item->next;
-    }
+    /* next_price is the latest price not newer than t and current_price
+       the earliest one after it, or next_price again if there's none. */
+    pricedb_bracket_time (db, c, currency, t, &next_price, &current_price);
+    if (!current_price)
+        current_price = next_price;
+    if (!current_price) return NULL;
 
     if (current_price)      /* How can this be null??? */
     {
@@ -2388,7 +2739,6 @@ lookup_nearest_in_time(GNCPriceDB *db,
     }
 
     gnc_price_ref(result);
-    g_list_free (price_list);
     LEAVE (" ");
     return result;
 }
@@ -2409,28 +2759,13 @@ gnc_pricedb_lookup_latest_before_t64 (GNCPriceDB *db,
                                       gnc_commodity *currency,
                                       time64 t)
 {
-    GList *price_list;
     GNCPrice *current_price = NULL;
-    /*  GNCPrice *next_price = NULL;
-        GNCPrice *result = NULL;*/
-    GList *item = NULL;
-    time64 price_time;
+    GNCPrice *next_price = NULL;
 
     if (!db || !c || !currency) return NULL;
     ENTER ("db=%p commodity=%p currency=%p", db, c, currency);
-    price_list = pricedb_get_prices_internal (db, c, currency, TRUE);
-    if (!price_list) return NULL;
-    item = price_list;
-    do
-    {
-        price_time = gnc_price_get_time64 (item->data);
-        if (price_time <= t)
-            current_price = item->data;
-        item = item->next;
-    }
-    while (price_time > t && item);
+    pricedb_bracket_time (db, c, currency, t, &current_price, &next_price);
     gnc_price_ref(current_price);
-    g_list_free (price_list);
     LEAVE (" ");
     return current_price;
 }
@@ -2442,48 +2777,164 @@ typedef struct
     GNCPrice *to;
 } PriceTuple;
 
-static PriceTuple
-extract_common_prices (PriceList *from_prices, PriceList *to_prices,
-                       const gnc_commodity *from, const gnc_commodity *to)
+/* Indirect conversions go through a commodity that has prices with both
+ * ends.  Which commodities qualify depends only on which price series
+ * exist, so the candidates for each (from, to) pair are cached in
+ * db->conversion_paths and thrown away whenever a series involving
+ * either end is created or destroyed.
+ */
+typedef struct
+{
+    const gnc_commodity *from;
+    const gnc_commodity *to;
+} ConversionPathKey;
+
+static guint
+conversion_path_key_hash (gconstpointer key)
+{
+    const ConversionPathKey *k = key;
+    return g_direct_hash (k->from) * 31 + g_direct_hash (k->to);
+}
+
+static gboolean
+conversion_path_key_equal (gconstpointer a, gconstpointer b)
+{
+    const ConversionPathKey *ka = a, *kb = b;
+    return ka->from == kb->from && ka->to == kb->to;
+}
+
+static void
+conversion_path_free (gpointer data)
+{
+    g_list_free (data);
+}
+
+typedef struct
+{
+    const gnc_commodity *c;
+    const gnc_commodity *currency;
+} ConversionPathInvalidate;
+
+static gboolean
+conversion_path_uses (gpointer key, gpointer value, gpointer user_data)
+{
+    const ConversionPathKey *k = key;
+    const ConversionPathInvalidate *inv = user_data;
+    return k->from == inv->c || k->from == inv->currency ||
+        k->to == inv->c || k->to == inv->currency;
+}
+
+static void
+pricedb_invalidate_conversion_paths (GNCPriceDB *db, const gnc_commodity *c,
+                                     const gnc_commodity *currency)
 {
-    PriceTuple retval = {NULL, NULL};
-    GList *from_node = NULL, *to_node = NULL;
-    GNCPrice *from_price, *to_price;
+    ConversionPathInvalidate inv = { c, currency };
+
+    if (!db->conversion_paths) return;
+    g_hash_table_foreach_remove (db->conversion_paths,
+                                 conversion_path_uses, &inv);
+}
 
-    for (from_node = from_prices; from_node != NULL;
-         from_node = g_list_next(from_node))
+static void
+pricedb_add_counterpart (GNCPriceDB *db, gnc_commodity *c, gnc_commodity *other)
+{
+    GHashTable *others = g_hash_table_lookup (db->counterparts, c);
+    if (!others)
     {
-        for (to_node = to_prices; to_node != NULL;
-             to_node = g_list_next(to_node))
-        {
-            gnc_commodity *to_com, *to_cur;
-            gnc_commodity *from_com, *from_cur;
-            to_price = GNC_PRICE(to_node->data);
-            from_price = GNC_PRICE(from_node->data);
-            to_com = gnc_price_get_commodity (to_price);
-            to_cur = gnc_price_get_currency (to_price);
-            from_com = gnc_price_get_commodity (from_price);
-            from_cur = gnc_price_get_currency (from_price);
-            if (((to_com == from_com || to_com == from_cur) &&
-                 (to_com != from && to_com != to)) ||
-                ((to_cur == from_com || to_cur == from_cur) &&
-                 (to_cur != from && to_cur != to)))
-                break;
-            to_price = NULL;
-            from_price = NULL;
-        }
-        if (to_price != NULL && from_price != NULL)
-            break;
+        others = g_hash_table_new (NULL, NULL);
+        g_hash_table_insert (db->counterparts, c, others);
     }
-    if (from_price == NULL || to_price == NULL)
-        return retval;
-    gnc_price_ref(from_price);
-    gnc_price_ref(to_price);
-    retval.from = from_price;
-    retval.to = to_price;
-    return retval;
+    g_hash_table_add (others, other);
+}
+
+static void
+pricedb_remove_counterpart (GNCPriceDB *db, gnc_commodity *c,
+                            gnc_commodity *other)
+{
+    GHashTable *others = g_hash_table_lookup (db->counterparts, c);
+    if (!others) return;
+    g_hash_table_remove (others, other);
+    if (g_hash_table_size (others) == 0)
+        g_hash_table_remove (db->counterparts, c);
+}
+
+/* Every creation and destruction of a series goes through these two so that
+ * db->counterparts stays in step and stale conversion paths are dropped. */
+static void
+pricedb_series_added (GNCPriceDB *db, gnc_commodity *c,
+                      gnc_commodity *currency)
+{
+    pricedb_invalidate_conversion_paths (db, c, currency);
+    pricedb_add_counterpart (db, c, currency);
+    pricedb_add_counterpart (db, currency, c);
+}
+
+static void
+pricedb_series_removed (GNCPriceDB *db, gnc_commodity *c,
+                        gnc_commodity *currency)
+{
+    pricedb_invalidate_conversion_paths (db, c, currency);
+    /* The pair stays related while there is a series the other way. */
+    if (pricedb_get_series (db, currency, c))
+        return;
+    pricedb_remove_counterpart (db, c, currency);
+    pricedb_remove_counterpart (db, currency, c);
+}
+
+/* Returns the set of commodities that have a price series with c, in
+ * either direction, or NULL if there are none. */
+static GHashTable *
+pricedb_get_counterparts (GNCPriceDB *db, const gnc_commodity *c)
+{
+    if (!db->counterparts) return NULL;
+    return g_hash_table_lookup (db->counterparts, c);
 }
 
+static GList *
+pricedb_conversion_path (GNCPriceDB *db, const gnc_commodity *from,
+                         const gnc_commodity *to)
+{
+    ConversionPathKey lookup = { from, to };
+    ConversionPathKey *key;
+    GHashTable *from_others, *to_others;
+    GHashTableIter iter;
+    gpointer other;
+    GList *path = NULL;
+
+    if (!db->commodity_hash) return NULL;
+    /* Concurrent readers may fill the cache at the same time; only the
+     * writer drops entries, so the returned list stays valid. */
+    qof_engine_cache_lock ();
+    if (!db->conversion_paths)
+        db->conversion_paths =
+            g_hash_table_new_full (conversion_path_key_hash,
+                                   conversion_path_key_equal,
+                                   g_free, conversion_path_free);
+    else if (g_hash_table_lookup_extended (db->conversion_paths, &lookup,
+                                           NULL, (gpointer *) &path))
+    {
+        qof_engine_cache_unlock ();
+        return path;
+    }
+
+    from_others = pricedb_get_counterparts (db, from);
+    to_others = pricedb_get_counterparts (db, to);
+
+    if (from_others && to_others)
+    {
+        g_hash_table_iter_init (&iter, from_others);
+        while (g_hash_table_iter_next (&iter, &other, NULL))
+            if (other != from && other != to &&
+                g_hash_table_contains (to_others, other))
+                path = g_list_prepend (path, other);
+    }
+
+    key = g_new (ConversionPathKey, 1);
+    *key = lookup;
+    g_hash_table_insert (db->conversion_paths, key, path);
+    qof_engine_cache_unlock ();
+    return path;
+}
 
 static gnc_numeric
 convert_price (const gnc_commodity *from, const gnc_commodity *to, PriceTuple tuple)
@@ -2517,33 +2968,58 @@ static gnc_numeric
 indirect_price_conversion (GNCPriceDB *db, const gnc_commodity *from,
                            const gnc_commodity *to, time64 t)
 {
-    GList *from_prices = NULL, *to_prices = NULL;
-    PriceTuple tuple;
+    GList *node;
+    PriceTuple tuple = {NULL, NULL};
     gnc_numeric zero = gnc_numeric_zero();
+    gnc_numeric price;
+    time64 now = gnc_time (NULL);
     if (!from || !to)
         return zero;
-    if (t == INT64_MAX)
-    {
-        from_prices = gnc_pricedb_lookup_latest_any_currency(db, from);
-        /* "to" is often the book currency which may have lots of prices,
-            so avoid getting them if they aren't needed. */
-        if (from_prices)
-            to_prices = gnc_pricedb_lookup_latest_any_currency(db, to);
-    }
-    else
+
+    /* Use the intermediate whose price with "from" comes first in
+     * compare_prices_by_date order, i.e. the most recent one. */
+    for (node = pricedb_conversion_path (db, from, to); node; node = node->next)
     {
-        from_prices = gnc_pricedb_lookup_nearest_in_time_any_currency_t64 (db, from, t);
-        if (from_prices)
-            to_prices = gnc_pricedb_lookup_nearest_in_time_any_currency_t64 (db, to, t);
+        gnc_commodity *via = node->data;
+        GNCPrice *from_price, *to_price;
+
+        if (t == INT64_MAX)
+            from_price = gnc_pricedb_lookup_latest_before_t64 (db, (gnc_commodity*)from, via, now);
+        else
+            from_price = gnc_pricedb_lookup_nearest_in_time64 (db, from, via, t);
+        if (!from_price)
+            continue;
+        if (tuple.from && compare_prices_by_date (from_price, tuple.from) >= 0)
+        {
+            gnc_price_unref (from_price);
+            continue;
+        }
+
+        if (t == INT64_MAX)
+            to_price = gnc_pricedb_lookup_latest_before_t64 (db, (gnc_commodity*)to, via, now);
+        else
+            to_price = gnc_pricedb_lookup_nearest_in_time64 (db, to, via, t);
+        if (!to_price)
+        {
+            gnc_price_unref (from_price);
+            continue;
+        }
+
+        if (tuple.from)
+        {
+            gnc_price_unref (tuple.from);
+            gnc_price_unref (tuple.to);
+        }
+        tuple.from = from_price;
+        tuple.to = to_price;
     }
-    if (!from_prices || !to_prices)
+
+    if (!tuple.from)
         return zero;
-    tuple = extract_common_prices (from_prices, to_prices, from, to);
-    gnc_price_list_destroy (from_prices);
-    gnc_price_list_destroy (to_prices);
-    if (tuple.from)
-        return convert_price (from, to, tuple);
-    return zero;
+    price = convert_price (from, to, tuple);
+    gnc_price_unref (tuple.from);
+    gnc_price_unref (tuple.to);
+    return price;
 }
 
 
@@ -2649,95 +3125,180 @@ gnc_pricedb_convert_balance_nearest_price_t64(GNCPriceDB *pdb,
         (pdb, balance, balance_currency, new_currency, t);
 }
 
-
 /* ==================================================================== */
-/* gnc_pricedb_foreach_price infrastructure
+/* Exchange-rate tables
  */
 
-typedef struct
+struct gnc_price_table_s
 {
-    gboolean ok;
-    gboolean (*func)(GNCPrice *p, gpointer user_data);
-    gpointer user_data;
-} GNCPriceDBForeachData;
+    const gnc_commodity *currency;
+    GHashTable *rows;           /* commodity -> row number, counting from 1 */
+    time64 *dates;
+    guint n_dates;
+    gnc_numeric *rates;         /* one row of n_dates rates per commodity */
+};
 
-static void
-pricedb_foreach_pricelist(gpointer key, gpointer val, gpointer user_data)
+GNCPriceTable *
+gnc_pricedb_build_price_table (GNCPriceDB *db, CommodityList *commodities,
+                               const time64 *dates, guint n_dates,
+                               const gnc_commodity *report_currency)
 {
-    GList *price_list = (GList *) val;
-    GList *node = price_list;
-    GNCPriceDBForeachData *foreach_data = (GNCPriceDBForeachData *) user_data;
+    GNCPriceTable *table;
+    GHashTableIter iter;
+    gpointer key, value;
+    GList *node;
+    guint n_rows = 0;
+
+    g_return_val_if_fail (db && report_currency, NULL);
+    g_return_val_if_fail (dates || n_dates == 0, NULL);
+    ENTER ("db=%p currency=%s dates=%u", db,
+           gnc_commodity_get_mnemonic (report_currency), n_dates);
+
+    table = g_new0 (GNCPriceTable, 1);
+    table->currency = report_currency;
+    table->rows = g_hash_table_new (NULL, NULL);
+    table->n_dates = n_dates;
+    table->dates = g_new (time64, n_dates ? n_dates : 1);
+    if (n_dates)
+        memcpy (table->dates, dates, n_dates * sizeof (time64));
+
+    for (node = commodities; node; node = node->next)
+        if (node->data && !g_hash_table_contains (table->rows, node->data))
+            g_hash_table_insert (table->rows, node->data,
+                                 GUINT_TO_POINTER (++n_rows));
+    table->rates = g_new (gnc_numeric, n_rows * n_dates ? n_rows * n_dates : 1);
+
+    g_hash_table_iter_init (&iter, table->rows);
+    while (g_hash_table_iter_next (&iter, &key, &value))
+    {
+        gnc_numeric *row = table->rates +
+            (GPOINTER_TO_UINT (value) - 1) * n_dates;
+        guint i;
+
+        for (i = 0; i < n_dates; i++)
+        {
+            gnc_numeric rate =
+                gnc_pricedb_get_nearest_price (db, key, report_currency,
+                                               dates[i]);
+            /* the price retrieved may be invalid. see 798015 */
+            row[i] = gnc_numeric_check (rate) ? gnc_numeric_zero () : rate;
+        }
+    }
+
+    LEAVE ("table=%p rows=%u", table, n_rows);
+    return table;
+}
+
+guint
+gnc_price_table_date_index (const GNCPriceTable *table, time64 t)
+{
+    guint lo = 0, hi;
 
-    /* stop traversal when func returns FALSE */
-    while (foreach_data->ok && node)
+    g_return_val_if_fail (table, 0);
+    hi = table->n_dates;
+    while (lo < hi)
     {
-        GNCPrice *p = (GNCPrice *) node->data;
-        foreach_data->ok = foreach_data->func(p, foreach_data->user_data);
-        node = node->next;
+        guint mid = lo + (hi - lo) / 2;
+        if (table->dates[mid] <= t)
+            lo = mid + 1;
+        else
+            hi = mid;
     }
+    return lo ? lo - 1 : 0;
 }
 
-static void
-pricedb_foreach_currencies_hash(gpointer key, gpointer val, gpointer user_data)
+gnc_numeric
+gnc_price_table_get_rate (const GNCPriceTable *table,
+                          const gnc_commodity *commodity, guint date_index)
 {
-    GHashTable *currencies_hash = (GHashTable *) val;
-    g_hash_table_foreach(currencies_hash, pricedb_foreach_pricelist, user_data);
+    guint row;
+
+    g_return_val_if_fail (table, gnc_numeric_zero ());
+    g_return_val_if_fail (date_index < table->n_dates, gnc_numeric_zero ());
+
+    row = GPOINTER_TO_UINT (g_hash_table_lookup (table->rows, commodity));
+    if (row)
+        return table->rates[(row - 1) * table->n_dates + date_index];
+    if (commodity && gnc_commodity_equiv (commodity, table->currency))
+        return gnc_numeric_create (1, 1);
+    return gnc_numeric_zero ();
 }
 
-static gboolean
-unstable_price_traversal(GNCPriceDB *db,
-                         gboolean (*f)(GNCPrice *p, gpointer user_data),
-                         gpointer user_data)
+gnc_numeric
+gnc_price_table_convert_balance (const GNCPriceTable *table,
+                                 gnc_numeric balance,
+                                 const gnc_commodity *balance_currency,
+                                 guint date_index)
 {
-    GNCPriceDBForeachData foreach_data;
+    gnc_numeric rate;
 
-    if (!db || !f) return FALSE;
-    foreach_data.ok = TRUE;
-    foreach_data.func = f;
-    foreach_data.user_data = user_data;
-    if (db->commodity_hash == NULL)
-    {
-        return FALSE;
-    }
-    g_hash_table_foreach(db->commodity_hash,
-                         pricedb_foreach_currencies_hash,
-                         &foreach_data);
+    g_return_val_if_fail (table, gnc_numeric_zero ());
+    if (gnc_numeric_zero_p (balance))
+        return balance;
 
-    return foreach_data.ok;
+    rate = gnc_price_table_get_rate (table, balance_currency, date_index);
+    return gnc_numeric_mul
+        (balance, rate, gnc_commodity_get_fraction (table->currency),
+         GNC_HOW_DENOM_EXACT | GNC_HOW_RND_ROUND);
+}
+
+const gnc_commodity *
+gnc_price_table_get_currency (const GNCPriceTable *table)
+{
+    g_return_val_if_fail (table, NULL);
+    return table->currency;
+}
+
+void
+gnc_price_table_destroy (GNCPriceTable *table)
+{
+    if (!table) return;
+    g_hash_table_destroy (table->rows);
+    g_free (table->dates);
+    g_free (table->rates);
+    g_free (table);
 }
 
-/* foreach_pricelist */
+
+/* ==================================================================== */
+/* gnc_pricedb_foreach_price infrastructure
+ */
+
 typedef struct
 {
     gboolean ok;
-    gboolean (*func)(GList *p, gpointer user_data);
+    gboolean (*func)(GNCPrice *p, gpointer user_data);
     gpointer user_data;
-} GNCPriceListForeachData;
+} GNCPriceDBForeachData;
 
 static void
-pricedb_pricelist_foreach_pricelist(gpointer key, gpointer val, gpointer user_data)
+pricedb_foreach_pricelist(gpointer key, gpointer val, gpointer user_data)
 {
-    GList *price_list = (GList *) val;
-    GNCPriceListForeachData *foreach_data = (GNCPriceListForeachData *) user_data;
-    if (foreach_data->ok)
+    PriceSeries *series = (PriceSeries *) val;
+    GNCPriceDBForeachData *foreach_data = (GNCPriceDBForeachData *) user_data;
+    guint i;
+
+    /* stop traversal when func returns FALSE; newest first as before */
+    for (i = series->len; foreach_data->ok && i-- > 0;)
     {
-        foreach_data->ok = foreach_data->func(price_list, foreach_data->user_data);
+        GNCPrice *p = price_series_entry (series, i)->price;
+        foreach_data->ok = foreach_data->func(p, foreach_data->user_data);
     }
 }
 
 static void
-pricedb_pricelist_foreach_currencies_hash(gpointer key, gpointer val, gpointer user_data)
+pricedb_foreach_currencies_hash(gpointer key, gpointer val, gpointer user_data)
 {
     GHashTable *currencies_hash = (GHashTable *) val;
-    g_hash_table_foreach(currencies_hash, pricedb_pricelist_foreach_pricelist, user_data);
+    g_hash_table_foreach(currencies_hash, pricedb_foreach_pricelist, user_data);
 }
 
 static gboolean
-pricedb_pricelist_traversal(GNCPriceDB *db,
-                         gboolean (*f)(GList *p, gpointer user_data),
+unstable_price_traversal(GNCPriceDB *db,
+                         gboolean (*f)(GNCPrice *p, gpointer user_data),
                          gpointer user_data)
 {
-    GNCPriceListForeachData foreach_data;
+    GNCPriceDBForeachData foreach_data;
 
     if (!db || !f) return FALSE;
     foreach_data.ok = TRUE;
@@ -2748,7 +3309,7 @@ pricedb_pricelist_traversal(GNCPriceDB *db,
         return FALSE;
     }
     g_hash_table_foreach(db->commodity_hash,
-                         pricedb_pricelist_foreach_currencies_hash,
+                         pricedb_foreach_currencies_hash,
                          &foreach_data);
 
     return foreach_data.ok;
@@ -2806,12 +3367,12 @@ stable_price_traversal(GNCPriceDB *db,
         for (j = price_lists; j; j = j->next)
         {
             HashEntry *pricelist_entry = (HashEntry *) j->data;
-            GList *price_list = (GList *) pricelist_entry->value;
-            GList *node;
+            PriceSeries *series = (PriceSeries *) pricelist_entry->value;
+            guint k;
 
-            for (node = (GList *) price_list; node; node = node->next)
+            for (k = series->len; k-- > 0;)
             {
-                GNCPrice *price = (GNCPrice *) node->data;
+                GNCPrice *price = price_series_entry (series, k)->price;
 
                 /* stop traversal when f returns FALSE */
                 if (FALSE == ok) break;
@@ -3031,15 +3592,14 @@ VoidGNCPriceDBForeachData;
 static void
 void_pricedb_foreach_pricelist(gpointer key, gpointer val, gpointer user_data)
 {
-    GList *price_list = (GList *) val;
-    GList *node = price_list;
+    PriceSeries *series = (PriceSeries *) val;
     VoidGNCPriceDBForeachData *foreach_data = (VoidGNCPriceDBForeachData *) user_data;
+    guint i;
 
-    while (node)
+    for (i = series->len; i-- > 0;)
     {
-        GNCPrice *p = (GNCPrice *) node->data;
+        GNCPrice *p = price_series_entry (series, i)->price;
         foreach_data->func(p, foreach_data->user_data);
-        node = node->next;
     }
 }
 
@@ -360,6 +360,16 @@ void gnc_pricedb_commit_edit (GNCPriceDB *);
  */
 void gnc_pricedb_set_bulk_update(GNCPriceDB *db, gboolean bulk_update);
 
+/** @brief Return a counter that changes whenever a price is added to,
+ * removed from or modified in the pricedb.
+ *
+ * Callers caching the result of price conversions can compare it
+ * with the value they saw when they filled the cache.
+ * @param db The pricedb
+ * @return The current generation of the pricedb.
+ */
+guint gnc_pricedb_get_generation(GNCPriceDB *db);
+
 /** @brief Add a price to the pricedb.
  *
  * You may drop your reference to the price (i.e. call unref) after this
@@ -370,6 +380,27 @@ void gnc_pricedb_set_bulk_update(GNCPriceDB *db, gboolean bulk_update);
  */
 gboolean     gnc_pricedb_add_price(GNCPriceDB *db, GNCPrice *p);
 
+/** @brief Add a batch of prices to the pricedb.
+ *
+ * The prices are grouped by commodity and currency and merged into the
+ * stored series in one pass each, which is much faster than adding them one
+ * at a time. Unless bulk update is set the same-day checks of
+ * gnc_pricedb_add_price are applied, as if the prices were added in array
+ * order.
+ *
+ * A QOF_EVENT_MODIFY is generated for the pricedb, then a QOF_EVENT_ADD
+ * for each price that was added once the whole batch is in the db.
+ *
+ * As with gnc_pricedb_add_price you may drop your references to the prices
+ * afterwards.
+ * @param db The pricedb
+ * @param prices The prices to add.
+ * @param n_prices The number of prices.
+ * @return The number of prices added.
+ */
+guint        gnc_pricedb_add_prices(GNCPriceDB *db, GNCPrice **prices,
+                                    guint n_prices);
+
 /** @brief Remove a price from the pricedb and unref the price.
  * @param db The Pricedb
  * @param p The price to remove.
@@ -609,6 +640,56 @@ gnc_pricedb_convert_balance_nearest_price_t64(GNCPriceDB *pdb,
                                               const gnc_commodity *new_currency,
                                               time64 t);
 
+/** @name Exchange-rate tables
+
+    A GNCPriceTable is a snapshot of the rates from a set of commodities to
+    one report currency at each of a list of dates, for reports that need
+    the same conversions over and over. Each rate is the one
+    gnc_pricedb_get_nearest_price would return at build time; later changes
+    to the pricedb are not reflected.
+    @{ */
+typedef struct gnc_price_table_s GNCPriceTable;
+
+/** @brief Build an exchange-rate table.
+ * @param db The pricedb
+ * @param commodities The commodities to convert from
+ * @param dates The dates, in ascending order. INT64_MAX stands for the
+ * latest price as in gnc_pricedb_get_latest_price.
+ * @param n_dates The number of dates
+ * @param report_currency The commodity to convert to
+ * @return A new table to be freed with gnc_price_table_destroy.
+ */
+GNCPriceTable *gnc_pricedb_build_price_table (GNCPriceDB *db,
+                                              CommodityList *commodities,
+                                              const time64 *dates,
+                                              guint n_dates,
+                                              const gnc_commodity *report_currency);
+
+/** @brief Return the index of the latest date in the table not after t, or 0
+ * if t is before all of them. */
+guint gnc_price_table_date_index (const GNCPriceTable *table, time64 t);
+
+/** @brief Return the rate from commodity to the report currency at the date
+ * with index date_index, gnc_numeric_zero if commodity isn't in the table or
+ * no price was available. */
+gnc_numeric gnc_price_table_get_rate (const GNCPriceTable *table,
+                                      const gnc_commodity *commodity,
+                                      guint date_index);
+
+/** @brief Convert a balance to the report currency in the way
+ * gnc_pricedb_convert_balance_nearest_price_t64 does, using the rate at the
+ * date with index date_index. */
+gnc_numeric gnc_price_table_convert_balance (const GNCPriceTable *table,
+                                             gnc_numeric balance,
+                                             const gnc_commodity *balance_currency,
+                                             guint date_index);
+
+/** @brief Return the report currency the table converts to. */
+const gnc_commodity *gnc_price_table_get_currency (const GNCPriceTable *table);
+
+void gnc_price_table_destroy (GNCPriceTable *table);
+/** @} */
+
 typedef gboolean (*GncPriceForeachFunc)(GNCPrice *p, gpointer user_data);
 
 /** @brief Call a GncPriceForeachFunction once for each price in db, until the
@@ -651,8 +732,27 @@ gnc_pricedb_nth_price (GNCPriceDB *db,
                        const gnc_commodity *c,
                        const int n);
 
+/** @brief Get a price's index among its commodity's prices, as counted by
+ * gnc_pricedb_nth_price()
+ * @param db The pricedb
+ * @param p The price
+ * @return The index n for which gnc_pricedb_nth_price() returns p, or -1 if p
+ * isn't in the database
+ */
+gint gnc_pricedb_nth_price_index (GNCPriceDB *db, GNCPrice *p);
+
+/** gnc_pricedb_nth_price() no longer caches anything, so this does nothing
+ * that's needed; it's kept for existing callers. */
 void gnc_pricedb_nth_price_reset_cache (GNCPriceDB *db);
 
+/** @brief Get the time of the oldest price, in any currency, for a commodity
+ * @param db The pricedb
+ * @param c The commodity
+ * @return The oldest price's time, or G_MAXINT64 if there are no prices for c
+ */
+time64 gnc_pricedb_get_oldest_price_time (GNCPriceDB *db,
+                                          const gnc_commodity *c);
+
 /* The following two convenience functions are used to test the xml backend */
 /** @brief Return the number of prices in the database.
  *
@@ -63,16 +63,9 @@ GncRational::is_big() const noexcept
 
 GncRational::operator gnc_numeric () const noexcept
 {
-    if (!valid())
+    if (!valid() || is_big())
         return gnc_numeric_error(GNC_ERROR_OVERFLOW);
-    try
-    {
-        return {static_cast<int64_t>(m_num), static_cast<int64_t>(m_den)};
-    }
-    catch (std::overflow_error&)
-    {
-        return gnc_numeric_error (GNC_ERROR_OVERFLOW);
-    }
+    return {static_cast<int64_t>(m_num), static_cast<int64_t>(m_den)};
 }
 
 GncRational
@@ -142,18 +135,52 @@ GncRational::cmp(GncRational b)
 
 GncRational::round_param
 GncRational::prepare_conversion (GncInt128 new_denom) const
+{
+    round_param params;
+    if (prepare_conversion(new_denom, params) != GNC_ERROR_OK)
+        throw std::overflow_error("Conversion overflow");
+    return params;
+}
+
+GNCNumericErrorCode
+GncRational::prepare_conversion (GncInt128 new_denom,
+                                 round_param& params) const noexcept
 {
     if (new_denom == m_den || new_denom == GNC_DENOM_AUTO)
-        return {m_num, m_den, 0};
-    GncRational conversion(new_denom, m_den);
-    auto red_conv = conversion.reduce();
+    {
+        params = {m_num, m_den, 0};
+        return GNC_ERROR_OK;
+    }
+    /* As in GncNumeric::prepare_conversion, skip the GCD when one
+     * denominator divides the other. */
+    if (new_denom > 0 && m_den > 0 && !(new_denom.isBig() || m_den.isBig()))
+    {
+        if (new_denom % m_den == 0)
+        {
+            auto new_num = m_num * (new_denom / m_den);
+            if (new_num.isOverflow())
+                return GNC_ERROR_OVERFLOW;
+            params = {new_num, 1, 0};
+            return GNC_ERROR_OK;
+        }
+        if (m_den % new_denom == 0)
+        {
+            auto divisor = m_den / new_denom;
+            params = {m_num / divisor, divisor, m_num % divisor};
+            return GNC_ERROR_OK;
+        }
+    }
+    GncRational red_conv;
+    if (GncRational(new_denom, m_den).reduce(red_conv) != GNC_ERROR_OK)
+        return GNC_ERROR_OVERFLOW;
     GncInt128 old_num(m_num);
     auto new_num = old_num * red_conv.num();
     if (new_num.isOverflow())
-        throw std::overflow_error("Conversion overflow");
+        return GNC_ERROR_OVERFLOW;
     auto rem = new_num % red_conv.denom();
     new_num /= red_conv.denom();
-    return {new_num, red_conv.denom(), rem};
+    params = {new_num, red_conv.denom(), rem};
+    return GNC_ERROR_OK;
 }
 
 GncInt128
@@ -178,53 +205,82 @@ GncRational::sigfigs_denom(unsigned figs) const noexcept
 
 GncRational
 GncRational::reduce() const
+{
+    GncRational retval;
+    if (reduce(retval) != GNC_ERROR_OK)
+        throw std::overflow_error("Reduce failed, calculation of gcd overflowed.");
+    return retval;
+}
+
+GNCNumericErrorCode
+GncRational::reduce(GncRational& result) const noexcept
 {
     auto gcd = m_den.gcd(m_num);
     if (gcd.isNan() || gcd.isOverflow())
-        throw std::overflow_error("Reduce failed, calculation of gcd overflowed.");
-    return GncRational(m_num / gcd, m_den / gcd);
+        return GNC_ERROR_OVERFLOW;
+    result = GncRational(m_num / gcd, m_den / gcd);
+    return GNC_ERROR_OK;
 }
 
 GncRational
 GncRational::round_to_numeric() const
+{
+    GncRational retval;
+    if (round_to_numeric(retval) != GNC_ERROR_OK)
+    {
+        std::ostringstream msg;
+        msg << " Cannot be represented as a "
+            << "GncNumeric. Its integer value is too large.\n";
+        throw std::overflow_error(msg.str());
+    }
+    return retval;
+}
+
+GNCNumericErrorCode
+GncRational::round_to_numeric(GncRational& result) const noexcept
 {
     unsigned int ll_bits = GncInt128::legbits;
     if (m_num.isZero())
-        return GncRational(); //Default constructor makes 0/1
+    {
+        result = GncRational(); //Default constructor makes 0/1
+        return GNC_ERROR_OK;
+    }
     if (!(m_num.isBig() || m_den.isBig()))
-        return *this;
+    {
+        result = *this;
+        return GNC_ERROR_OK;
+    }
     if (m_num.abs() > m_den)
     {
         auto quot(m_num / m_den);
         if (quot.isBig())
-        {
-            std::ostringstream msg;
-            msg << " Cannot be represented as a "
-                << "GncNumeric. Its integer value is too large.\n";
-            throw std::overflow_error(msg.str());
-        }
+            return GNC_ERROR_OVERFLOW;
         GncRational new_v;
         while (new_v.num().isZero())
         {
-            try
-            {
-                new_v = convert<RoundType::half_down>(m_den / (m_num.abs() >> ll_bits));
-                if (new_v.is_big())
-                {
-                    --ll_bits;
-                    new_v = GncRational();
-                }
-            }
-            catch(const std::overflow_error& err)
+            auto new_denom = m_den / (m_num.abs() >> ll_bits);
+            /* Once the shifted numerator exceeds m_den the only candidate
+             * left is an integer; don't loop forever on a 0 denominator. */
+            if (new_denom.isZero())
+                new_denom = 1;
+            auto err = convert<RoundType::half_down>(new_denom, new_v);
+            if (err != GNC_ERROR_OK || new_v.is_big())
             {
+                if (new_denom == 1)
+                    return GNC_ERROR_OVERFLOW;
                 --ll_bits;
+                new_v = GncRational();
             }
         }
-        return new_v;
+        result = new_v;
+        return GNC_ERROR_OK;
     }
     auto quot(m_den / m_num);
     if (quot.isBig())
-        return GncRational(); //Smaller than can be represented as a GncNumeric
+    {
+        result = GncRational(); //Smaller than can be represented as a GncNumeric
+        return GNC_ERROR_OK;
+    }
     GncRational new_v;
     while (new_v.num().isZero())
     {
@@ -240,17 +296,20 @@ GncRational::round_to_numeric() const
                 --ll_bits;
                 continue;
             }
-            GncRational new_rational(num, den);
-            return new_rational;
+            result = GncRational(num, den);
+            return GNC_ERROR_OK;
         }
-        new_v = convert<RoundType::half_down>(m_den / divisor);
+        auto err = convert<RoundType::half_down>(m_den / divisor, new_v);
+        if (err != GNC_ERROR_OK)
+            return err;
         if (new_v.is_big())
         {
             --ll_bits;
             new_v = GncRational();
         }
     }
-    return new_v;
+    result = new_v;
+    return GNC_ERROR_OK;
 }
 
 GncRational
@@ -258,11 +317,9 @@ operator+(GncRational a, GncRational b)
 {
     if (!(a.valid() && b.valid()))
         throw std::range_error("Operator+ called with out-of-range operand.");
-    GncInt128 lcm = a.denom().lcm(b.denom());
-    GncInt128 num(a.num() * lcm / a.denom() + b.num() * lcm / b.denom());
-    if (!(lcm.valid() && num.valid()))
+    GncRational retval;
+    if (add(a, b, retval) != GNC_ERROR_OK)
         throw std::overflow_error("Operator+ overflowed.");
-    GncRational retval(num, lcm);
     return retval;
 }
 
@@ -278,10 +335,9 @@ operator*(GncRational a, GncRational b)
 {
     if (!(a.valid() && b.valid()))
         throw std::range_error("Operator* called with out-of-range operand.");
-    GncInt128 num (a.num() * b.num()), den(a.denom() * b.denom());
-    if (!(num.valid() && den.valid()))
+    GncRational retval;
+    if (multiply(a, b, retval) != GNC_ERROR_OK)
         throw std::overflow_error("Operator* overflowed.");
-    GncRational retval(num, den);
     return retval;
 }
 
@@ -290,9 +346,53 @@ operator/(GncRational a, GncRational b)
 {
     if (!(a.valid() && b.valid()))
         throw std::range_error("Operator/ called with out-of-range operand.");
+    if (b.num() == 0)
+        throw std::underflow_error("Divide by 0.");
+    GncRational retval;
+    if (divide(a, b, retval) != GNC_ERROR_OK)
+        throw std::overflow_error("Operator/ overflowed.");
+    return retval;
+}
+
+GNCNumericErrorCode
+add(GncRational a, GncRational b, GncRational& result) noexcept
+{
+    if (!(a.valid() && b.valid()))
+        return GNC_ERROR_ARG;
+    GncInt128 lcm = a.denom().lcm(b.denom());
+    GncInt128 num(a.num() * lcm / a.denom() + b.num() * lcm / b.denom());
+    if (!(lcm.valid() && num.valid()))
+        return GNC_ERROR_OVERFLOW;
+    result = GncRational(num, lcm);
+    return GNC_ERROR_OK;
+}
+
+GNCNumericErrorCode
+subtract(GncRational a, GncRational b, GncRational& result) noexcept
+{
+    return add(a, -b, result);
+}
+
+GNCNumericErrorCode
+multiply(GncRational a, GncRational b, GncRational& result) noexcept
+{
+    if (!(a.valid() && b.valid()))
+        return GNC_ERROR_ARG;
+    GncInt128 num (a.num() * b.num()), den(a.denom() * b.denom());
+    if (!(num.valid() && den.valid()))
+        return GNC_ERROR_OVERFLOW;
+    result = GncRational(num, den);
+    return GNC_ERROR_OK;
+}
+
+GNCNumericErrorCode
+divide(GncRational a, GncRational b, GncRational& result) noexcept
+{
+    if (!(a.valid() && b.valid()))
+        return GNC_ERROR_ARG;
     auto a_num = a.num(), b_num = b.num(), a_den = a.denom(), b_den = b.denom();
     if (b_num == 0)
-        throw std::underflow_error("Divide by 0.");
+        return GNC_ERROR_OVERFLOW;
     if (b_num.isNeg())
     {
         a_num = -a_num;
@@ -303,7 +403,10 @@ operator/(GncRational a, GncRational b)
      * and it's just a_num/b_num.
      */
     if (a_den == b_den)
-        return GncRational(a_num, b_num);
+    {
+        result = GncRational(a_num, b_num);
+        return GNC_ERROR_OK;
+    }
 
     /* Protect against possibly preventable overflow: */
     if (a_num.isBig() || a_den.isBig() ||
@@ -316,6 +419,7 @@ operator/(GncRational a, GncRational b)
 
     GncInt128 num(a_num * b_den), den(a_den * b_num);
     if (!(num.valid() && den.valid()))
-        throw std::overflow_error("Operator/ overflowed.");
-    return GncRational(num, den);
+        return GNC_ERROR_OVERFLOW;
+    result = GncRational(num, den);
+    return GNC_ERROR_OK;
 }
@@ -51,6 +51,9 @@ enum class DenomType;
  * * Failure to convert a number as specified by the arguments to convert() will
  * raise a std::domain_error.
  *
+ * The functions taking a result reference instead report failure by returning
+ * a GNCNumericErrorCode and never throw; the C API uses them so that routine
+ * overflows don't have to unwind the stack.
  */
 
 
@@ -96,6 +99,13 @@ public:
      * @return reduced GncRational
      */
     GncRational reduce() const;
+    /**
+     * Non-throwing reduce().
+     *
+     * @param result Receives the reduced GncRational; it may be *this.
+     * @return GNC_ERROR_OVERFLOW if the gcd overflowed, GNC_ERROR_OK otherwise.
+     */
+    GNCNumericErrorCode reduce(GncRational& result) const noexcept;
     /**
      * Round to fit an int64_t, finding the closest possible approximation.
      *
@@ -103,6 +113,14 @@ public:
      * @return rounded GncRational
      */
     GncRational round_to_numeric() const;
+    /**
+     * Non-throwing round_to_numeric().
+     *
+     * @param result Receives the rounded GncRational; it may be *this.
+     * @return GNC_ERROR_OVERFLOW if the integer value is too big for an
+     * int64_t, GNC_ERROR_OK otherwise.
+     */
+    GNCNumericErrorCode round_to_numeric(GncRational& result) const noexcept;
     /**
      * Convert a GncRational to use a new denominator. If rounding is necessary
      * use the indicated template specification. For example, to use half-up
@@ -149,6 +167,63 @@ public:
                                 params.rem, RT2T<RT>()), new_denom);
     }
 
+    /**
+     * Non-throwing convert().
+     *
+     * \param new_denom The new denominator to convert the fraction to.
+     * \param result Receives the converted GncRational; it may be *this.
+     * \return GNC_ERROR_OVERFLOW if the conversion overflowed,
+     * GNC_ERROR_REMAINDER if RoundType::never was specified and rounding is
+     * required, GNC_ERROR_OK otherwise.
+     */
+    template <RoundType RT>
+    GNCNumericErrorCode convert (GncInt128 new_denom,
+                                 GncRational& result) const noexcept
+    {
+        round_param params;
+        auto err = prepare_conversion(new_denom, params);
+        if (err != GNC_ERROR_OK)
+            return err;
+        if (new_denom == GNC_DENOM_AUTO)
+            new_denom = m_den;
+        if (params.rem == 0)
+            result = GncRational(params.num, new_denom);
+        else if constexpr (RT == RoundType::never)
+            return GNC_ERROR_REMAINDER;
+        else
+            result = GncRational(round(params.num, params.den,
+                                       params.rem, RT2T<RT>()), new_denom);
+        return GNC_ERROR_OK;
+    }
+
+    /**
+     * Non-throwing convert_sigfigs().
+     *
+     * @param figs The number of digits to use for the numerator.
+     * @param result Receives the converted GncRational; it may be *this.
+     * @return As for the non-throwing convert().
+     */
+    template <RoundType RT>
+    GNCNumericErrorCode convert_sigfigs(unsigned int figs,
+                                        GncRational& result) const noexcept
+    {
+        auto new_denom(sigfigs_denom(figs));
+        round_param params;
+        auto err = prepare_conversion(new_denom, params);
+        if (err != GNC_ERROR_OK)
+            return err;
+        if (new_denom == 0)
+            new_denom = 1;
+        if (params.rem == 0)
+            result = GncRational(params.num, new_denom);
+        else if constexpr (RT == RoundType::never)
+            return GNC_ERROR_REMAINDER;
+        else
+            result = GncRational(round(params.num, params.den,
+                                       params.rem, RT2T<RT>()), new_denom);
+        return GNC_ERROR_OK;
+    }
+
     /** Numerator accessor */
     GncInt128 num() const noexcept { return m_num; }
     /** Denominator accessor */
@@ -190,6 +265,8 @@ private:
      * finish computing a GncNumeric with the new denominator.
      */
     round_param prepare_conversion(GncInt128 new_denom) const;
+    GNCNumericErrorCode prepare_conversion(GncInt128 new_denom,
+                                           round_param& params) const noexcept;
     GncInt128 m_num;
     GncInt128 m_den;
 };
@@ -282,4 +359,25 @@ inline std::ostream& operator<<(std::ostream& stream, const GncRational& val) no
     return stream;
 }
 /** @} */
+
+/**
+ * \defgroup gnc_rational_checked_arithmetic
+ * @{
+ * Non-throwing versions of the arithmetic operators.
+ *
+ * \param a The right-side operand
+ * \param b The left-side operand
+ * \param result Receives the computed GncRational; untouched on failure.
+ * \return GNC_ERROR_ARG if an operand is invalid, GNC_ERROR_OVERFLOW if the
+ * computation overflowed or divided by zero, GNC_ERROR_OK otherwise.
+ */
+GNCNumericErrorCode add(GncRational a, GncRational b,
+                        GncRational& result) noexcept;
+GNCNumericErrorCode subtract(GncRational a, GncRational b,
+                             GncRational& result) noexcept;
+GNCNumericErrorCode multiply(GncRational a, GncRational b,
+                             GncRational& result) noexcept;
+GNCNumericErrorCode divide(GncRational a, GncRational b,
+                           GncRational& result) noexcept;
+/** @} */
 #endif //__GNC_RATIONAL_HPP__
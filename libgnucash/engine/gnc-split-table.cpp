@@ -0,0 +1,533 @@
+/********************************************************************\
+ * gnc-split-table.cpp -- sorted and subtotalled tables of splits   *
+ *                        for reports                               *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ *                                                                  *
+\********************************************************************/
+
+extern "C"
+{
+#include <config.h>
+#include <glib.h>
+#include <string.h>
+
+#include "Account.h"
+#include "Query.h"
+#include "Transaction.h"
+#include "gnc-date.h"
+#include "gnc-split-table.h"
+}
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+static QofLogModule log_module = GNC_MOD_ENGINE;
+
+#define N_SORT_LEVELS 2
+
+/* The key of a split at one level, looked up when the table is built. */
+struct SplitTableKey
+{
+    gint64 number = 0;
+    gnc_numeric amount = gnc_numeric_zero ();
+    std::string text;           // for testing groups
+    std::string collate;        // for sorting
+};
+
+static const SplitTableKey no_key;
+
+struct SplitTableRow
+{
+    Split *split;
+    gnc_numeric balance;
+    gint group[GNC_SPLIT_TABLE_TOTAL + 1];
+};
+
+using SplitTableSums = std::vector<gnc_monetary>;
+
+struct SplitTableGroup
+{
+    guint first;
+    guint last;
+    SplitTableSums amounts;
+    SplitTableSums values;
+};
+
+struct GncSplitTable
+{
+    std::vector<SplitTableRow> rows;
+    std::vector<SplitTableGroup> groups[GNC_SPLIT_TABLE_TOTAL + 1];
+};
+
+enum class KeyKind { NONE, ORDER, NUMBER, AMOUNT, TEXT };
+
+static KeyKind
+key_kind (GncSplitTableKey key)
+{
+    switch (key)
+    {
+    case GNC_SPLIT_TABLE_KEY_REGISTER_ORDER:
+        return KeyKind::ORDER;
+    case GNC_SPLIT_TABLE_KEY_DATE:
+    case GNC_SPLIT_TABLE_KEY_RECONCILED_DATE:
+    case GNC_SPLIT_TABLE_KEY_RECONCILED_STATUS:
+        return KeyKind::NUMBER;
+    case GNC_SPLIT_TABLE_KEY_AMOUNT:
+        return KeyKind::AMOUNT;
+    case GNC_SPLIT_TABLE_KEY_ACCOUNT_NAME:
+    case GNC_SPLIT_TABLE_KEY_ACCOUNT_CODE:
+    case GNC_SPLIT_TABLE_KEY_CORR_ACCOUNT_NAME:
+    case GNC_SPLIT_TABLE_KEY_CORR_ACCOUNT_CODE:
+    case GNC_SPLIT_TABLE_KEY_DESCRIPTION:
+    case GNC_SPLIT_TABLE_KEY_NUMBER:
+    case GNC_SPLIT_TABLE_KEY_ACTION:
+    case GNC_SPLIT_TABLE_KEY_MEMO:
+    case GNC_SPLIT_TABLE_KEY_NOTES:
+        return KeyKind::TEXT;
+    default:
+        return KeyKind::NONE;
+    }
+}
+
+static bool
+sort_is_grouped (const GncSplitTableSort& sort)
+{
+    switch (sort.key)
+    {
+    case GNC_SPLIT_TABLE_KEY_NONE:
+    case GNC_SPLIT_TABLE_KEY_REGISTER_ORDER:
+    case GNC_SPLIT_TABLE_KEY_AMOUNT:
+    case GNC_SPLIT_TABLE_KEY_NUMBER:
+    case GNC_SPLIT_TABLE_KEY_ACTION:
+        return false;
+    case GNC_SPLIT_TABLE_KEY_DATE:
+    case GNC_SPLIT_TABLE_KEY_RECONCILED_DATE:
+        return sort.subtotal && sort.date_group != GNC_SPLIT_TABLE_DATE_NONE;
+    default:
+        return sort.subtotal;
+    }
+}
+
+/* The reconciled states in the order they sort in. */
+static gint64
+reconcile_rank (char reconcile)
+{
+    static const char order[] = { VREC, FREC, YREC, CREC, NREC };
+    for (guint i = 0; i < G_N_ELEMENTS (order); i++)
+        if (order[i] == reconcile)
+            return i;
+    return G_N_ELEMENTS (order);
+}
+
+static gint64
+date_group_number (time64 time, GncSplitTableDateGroup group)
+{
+    struct tm tm;
+
+    switch (group)
+    {
+    case GNC_SPLIT_TABLE_DATE_NONE:
+        return time;
+    case GNC_SPLIT_TABLE_DATE_DAY:
+        return gnc_time64_get_day_start (time);
+    case GNC_SPLIT_TABLE_DATE_WEEK:
+    {
+        /* Count the weeks as the reports' gnc:date-to-week does. */
+        gint start = gnc_start_of_week ();
+        double days = gnc_time64_get_day_start (time) / 86400.0;
+        return std::floor ((days - 1 - (start ? start : 1)) / 7);
+    }
+    default:
+        break;
+    }
+
+    if (!gnc_localtime_r (&time, &tm))
+        return 0;
+    switch (group)
+    {
+    case GNC_SPLIT_TABLE_DATE_MONTH:
+        return (gint64)tm.tm_year * 100 + tm.tm_mon;
+    case GNC_SPLIT_TABLE_DATE_QUARTER:
+        return (gint64)tm.tm_year * 10 + tm.tm_mon / 3;
+    default:
+        return tm.tm_year;
+    }
+}
+
+static void
+set_text (SplitTableKey& key, const char *text)
+{
+    gchar *collate;
+
+    key.text = text ? text : "";
+    collate = g_utf8_collate_key (key.text.c_str (), -1);
+    key.collate = collate;
+    g_free (collate);
+}
+
+static SplitTableKey
+split_key (Split *split, const GncSplitTableSort& sort)
+{
+    SplitTableKey key;
+    Transaction *trans = xaccSplitGetParent (split);
+    Account *account = xaccSplitGetAccount (split);
+
+    switch (sort.key)
+    {
+    case GNC_SPLIT_TABLE_KEY_ACCOUNT_NAME:
+        set_text (key, account ? gnc_account_get_full_name_const (account) : NULL);
+        break;
+    case GNC_SPLIT_TABLE_KEY_ACCOUNT_CODE:
+        set_text (key, account ? xaccAccountGetCode (account) : NULL);
+        break;
+    case GNC_SPLIT_TABLE_KEY_DATE:
+        key.number = date_group_number (xaccTransGetDate (trans),
+                                        sort.date_group);
+        break;
+    case GNC_SPLIT_TABLE_KEY_RECONCILED_DATE:
+        key.number = date_group_number (xaccSplitGetDateReconciled (split),
+                                        sort.date_group);
+        break;
+    case GNC_SPLIT_TABLE_KEY_RECONCILED_STATUS:
+        key.number = reconcile_rank (xaccSplitGetReconcile (split));
+        break;
+    case GNC_SPLIT_TABLE_KEY_CORR_ACCOUNT_NAME:
+    {
+        gchar *name = xaccSplitGetCorrAccountFullName (split);
+        set_text (key, name);
+        g_free (name);
+        break;
+    }
+    case GNC_SPLIT_TABLE_KEY_CORR_ACCOUNT_CODE:
+        set_text (key, xaccSplitGetCorrAccountCode (split));
+        break;
+    case GNC_SPLIT_TABLE_KEY_AMOUNT:
+        key.amount = xaccSplitGetValue (split);
+        break;
+    case GNC_SPLIT_TABLE_KEY_DESCRIPTION:
+        set_text (key, xaccTransGetDescription (trans));
+        break;
+    case GNC_SPLIT_TABLE_KEY_NUMBER:
+        set_text (key, xaccTransGetNum (trans));
+        break;
+    case GNC_SPLIT_TABLE_KEY_ACTION:
+        set_text (key, xaccSplitGetAction (split));
+        break;
+    case GNC_SPLIT_TABLE_KEY_MEMO:
+        set_text (key, xaccSplitGetMemo (split));
+        break;
+    case GNC_SPLIT_TABLE_KEY_NOTES:
+        set_text (key, xaccTransGetNotes (trans));
+        break;
+    default:
+        break;
+    }
+    return key;
+}
+
+static int
+key_compare (const SplitTableKey& a, const SplitTableKey& b, Split *sa,
+             Split *sb, KeyKind kind)
+{
+    switch (kind)
+    {
+    case KeyKind::ORDER:
+        return xaccSplitOrder (sa, sb);
+    case KeyKind::NUMBER:
+        return a.number < b.number ? -1 : a.number > b.number;
+    case KeyKind::AMOUNT:
+        return gnc_numeric_compare (a.amount, b.amount);
+    case KeyKind::TEXT:
+        return a.collate.compare (b.collate);
+    default:
+        return 0;
+    }
+}
+
+static bool
+key_equal (const SplitTableKey& a, const SplitTableKey& b, KeyKind kind)
+{
+    if (kind == KeyKind::NUMBER)
+        return a.number == b.number;
+    return a.text == b.text;
+}
+
+static void
+sums_add (SplitTableSums& sums, gnc_commodity *commodity, gnc_numeric value)
+{
+    for (auto& mon : sums)
+        if (gnc_commodity_equiv (mon.commodity, commodity))
+        {
+            mon.value = gnc_numeric_add (mon.value, value, GNC_DENOM_AUTO,
+                                         GNC_HOW_DENOM_EXACT);
+            return;
+        }
+    sums.push_back (gnc_monetary_create (commodity, value));
+}
+
+static MonetaryList *
+sums_to_list (const SplitTableSums& sums)
+{
+    MonetaryList *list = NULL;
+    for (auto mon = sums.rbegin (); mon != sums.rend (); ++mon)
+        list = gnc_monetary_list_add_monetary (list, *mon);
+    return list;
+}
+
+GncSplitTable *
+gnc_split_table_new (GList *splits, const GncSplitTableSort *primary,
+                     const GncSplitTableSort *secondary, gboolean sort)
+{
+    static const GncSplitTableSort no_sort = { GNC_SPLIT_TABLE_KEY_NONE,
+                                               GNC_SPLIT_TABLE_DATE_NONE,
+                                               TRUE, FALSE };
+    const GncSplitTableSort *sorts[N_SORT_LEVELS] = {
+        primary ? primary : &no_sort, secondary ? secondary : &no_sort };
+    KeyKind kinds[N_SORT_LEVELS];
+    bool grouped[N_SORT_LEVELS];
+    std::vector<Split*> split_vec;
+    std::vector<SplitTableKey> keys[N_SORT_LEVELS];
+    std::vector<guint> order;
+    std::unordered_map<Account*, gnc_numeric> balances;
+    auto table = new GncSplitTable;
+
+    for (GList *node = splits; node; node = node->next)
+        split_vec.push_back (static_cast<Split*>(node->data));
+
+    for (guint level = 0; level < N_SORT_LEVELS; level++)
+    {
+        kinds[level] = key_kind (sorts[level]->key);
+        grouped[level] = sort_is_grouped (*sorts[level]);
+        if (kinds[level] == KeyKind::NONE || kinds[level] == KeyKind::ORDER)
+            continue;
+        keys[level].reserve (split_vec.size ());
+        for (auto split : split_vec)
+            keys[level].push_back (split_key (split, *sorts[level]));
+    }
+
+    order.resize (split_vec.size ());
+    std::iota (order.begin (), order.end (), 0);
+    if (sort)
+        std::stable_sort (order.begin (), order.end (),
+                          [&](guint a, guint b)
+                          {
+                              for (guint level = 0; level < N_SORT_LEVELS; level++)
+                              {
+                                  bool have_keys = !keys[level].empty ();
+                                  int cmp = key_compare (
+                                      have_keys ? keys[level][a] : no_key,
+                                      have_keys ? keys[level][b] : no_key,
+                                      split_vec[a], split_vec[b], kinds[level]);
+                                  if (cmp)
+                                      return sorts[level]->ascending ? cmp < 0
+                                                                     : cmp > 0;
+                              }
+                              return false;
+                          });
+
+    table->rows.reserve (order.size ());
+    for (guint row = 0; row < order.size (); row++)
+    {
+        guint index = order[row];
+        Split *split = split_vec[index];
+        Account *account = xaccSplitGetAccount (split);
+        Transaction *trans = xaccSplitGetParent (split);
+        gnc_numeric amount = xaccSplitGetAmount (split);
+        bool new_primary = false;
+        SplitTableRow table_row;
+
+        auto balance = balances.emplace (account, gnc_numeric_zero ()).first;
+        balance->second = gnc_numeric_add (balance->second, amount,
+                                           GNC_DENOM_AUTO, GNC_HOW_DENOM_EXACT);
+        table_row.split = split;
+        table_row.balance = balance->second;
+
+        for (guint level = 0; level <= GNC_SPLIT_TABLE_TOTAL; level++)
+        {
+            auto& groups = table->groups[level];
+            bool new_group;
+
+            if (level < N_SORT_LEVELS && !grouped[level])
+            {
+                table_row.group[level] = -1;
+                continue;
+            }
+            if (level == GNC_SPLIT_TABLE_TOTAL)
+                new_group = groups.empty ();
+            else
+                new_group = row == 0 || new_primary ||
+                    !key_equal (keys[level][order[row - 1]], keys[level][index],
+                                kinds[level]);
+            if (level == GNC_SPLIT_TABLE_PRIMARY)
+                new_primary = new_group;
+
+            if (new_group)
+                groups.push_back ({ row, row, {}, {} });
+            auto& group = groups.back ();
+            group.last = row;
+            sums_add (group.amounts, xaccAccountGetCommodity (account), amount);
+            sums_add (group.values, xaccTransGetCurrency (trans),
+                      xaccSplitGetValue (split));
+            table_row.group[level] = groups.size () - 1;
+        }
+        table->rows.push_back (table_row);
+    }
+
+    DEBUG ("%zu rows, %zu primary and %zu secondary groups",
+           table->rows.size (), table->groups[GNC_SPLIT_TABLE_PRIMARY].size (),
+           table->groups[GNC_SPLIT_TABLE_SECONDARY].size ());
+    return table;
+}
+
+GncSplitTable *
+gnc_split_table_new_from_query (QofQuery *query, gboolean unique_trans,
+                                const GncSplitTableSort *primary,
+                                const GncSplitTableSort *secondary)
+{
+    GncSplitTable *table;
+    GList *splits;
+
+    g_return_val_if_fail (query, NULL);
+
+    if (!unique_trans)
+        return gnc_split_table_new (qof_query_run (query), primary, secondary,
+                                    TRUE);
+
+    splits = xaccQueryGetSplitsUniqueTrans (query);
+    table = gnc_split_table_new (splits, primary, secondary, TRUE);
+    g_list_free (splits);
+    return table;
+}
+
+void
+gnc_split_table_destroy (GncSplitTable *table)
+{
+    delete table;
+}
+
+guint
+gnc_split_table_get_num_rows (const GncSplitTable *table)
+{
+    g_return_val_if_fail (table, 0);
+    return table->rows.size ();
+}
+
+Split *
+gnc_split_table_get_split (const GncSplitTable *table, guint row)
+{
+    g_return_val_if_fail (table && row < table->rows.size (), NULL);
+    return table->rows[row].split;
+}
+
+SplitList *
+gnc_split_table_get_splits (const GncSplitTable *table)
+{
+    SplitList *splits = NULL;
+
+    g_return_val_if_fail (table, NULL);
+
+    for (auto row = table->rows.rbegin (); row != table->rows.rend (); ++row)
+        splits = g_list_prepend (splits, row->split);
+    return splits;
+}
+
+gnc_numeric
+gnc_split_table_get_balance (const GncSplitTable *table, guint row)
+{
+    g_return_val_if_fail (table && row < table->rows.size (),
+                          gnc_numeric_zero ());
+    return table->rows[row].balance;
+}
+
+guint
+gnc_split_table_get_num_groups (const GncSplitTable *table,
+                                GncSplitTableLevel level)
+{
+    g_return_val_if_fail (table && level <= GNC_SPLIT_TABLE_TOTAL, 0);
+    return table->groups[level].size ();
+}
+
+gint
+gnc_split_table_get_group (const GncSplitTable *table, guint row,
+                           GncSplitTableLevel level)
+{
+    g_return_val_if_fail (table && row < table->rows.size () &&
+                          level <= GNC_SPLIT_TABLE_TOTAL, -1);
+    return table->rows[row].group[level];
+}
+
+gboolean
+gnc_split_table_row_starts_group (const GncSplitTable *table, guint row,
+                                  GncSplitTableLevel level)
+{
+    gint group = gnc_split_table_get_group (table, row, level);
+    return group >= 0 && table->groups[level][group].first == row;
+}
+
+gboolean
+gnc_split_table_row_ends_group (const GncSplitTable *table, guint row,
+                                GncSplitTableLevel level)
+{
+    gint group = gnc_split_table_get_group (table, row, level);
+    return group >= 0 && table->groups[level][group].last == row;
+}
+
+static const SplitTableGroup *
+table_group (const GncSplitTable *table, GncSplitTableLevel level, guint group)
+{
+    g_return_val_if_fail (table && level <= GNC_SPLIT_TABLE_TOTAL, NULL);
+    g_return_val_if_fail (group < table->groups[level].size (), NULL);
+    return &table->groups[level][group];
+}
+
+guint
+gnc_split_table_get_group_first_row (const GncSplitTable *table,
+                                     GncSplitTableLevel level, guint group)
+{
+    auto g = table_group (table, level, group);
+    return g ? g->first : 0;
+}
+
+guint
+gnc_split_table_get_group_last_row (const GncSplitTable *table,
+                                    GncSplitTableLevel level, guint group)
+{
+    auto g = table_group (table, level, group);
+    return g ? g->last : 0;
+}
+
+MonetaryList *
+gnc_split_table_get_group_amounts (const GncSplitTable *table,
+                                   GncSplitTableLevel level, guint group)
+{
+    auto g = table_group (table, level, group);
+    return g ? sums_to_list (g->amounts) : NULL;
+}
+
+MonetaryList *
+gnc_split_table_get_group_values (const GncSplitTable *table,
+                                  GncSplitTableLevel level, guint group)
+{
+    auto g = table_group (table, level, group);
+    return g ? sums_to_list (g->values) : NULL;
+}
@@ -0,0 +1,208 @@
+/********************************************************************\
+ * gnc-split-table.h -- sorted and subtotalled tables of splits for *
+ *                      reports                                     *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ *                                                                  *
+\********************************************************************/
+/** @addtogroup Engine
+    @{ */
+/** @addtogroup SplitTable Split Tables
+ * A split table holds the splits a transaction report shows, in the
+ * order it shows them, grouped the way it subtotals them.  The rows
+ * are sorted on a primary and a secondary key, each ascending or
+ * descending; splits that compare equal on both keep the order they
+ * were given in.  Each key which can be grouped on and is asked to be
+ * subtotalled splits the rows into groups of consecutive rows with an
+ * equal key, a change of the primary key also ending the secondary
+ * group.  For every group the table sums the amounts of its splits, by
+ * commodity of their account, and their values, by currency of their
+ * transaction.  The GNC_SPLIT_TABLE_TOTAL level has one group holding
+ * all the rows.
+ *
+ * The keys of all the splits are looked up once when the table is
+ * built, so the sorting and the grouping need no more calls per split.
+ *
+ * The table refers to the splits without holding them; free it before
+ * they're destroyed.
+ @{ */
+
+/** @file gnc-split-table.h
+ */
+
+#ifndef GNC_SPLIT_TABLE_H
+#define GNC_SPLIT_TABLE_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include "qof.h"
+#include "gnc-commodity.h"
+#include "Split.h"
+
+/** The keys a split table can be sorted on. */
+typedef enum
+{
+    GNC_SPLIT_TABLE_KEY_NONE,
+    GNC_SPLIT_TABLE_KEY_ACCOUNT_NAME,       /**< full name of the account */
+    GNC_SPLIT_TABLE_KEY_ACCOUNT_CODE,
+    GNC_SPLIT_TABLE_KEY_DATE,               /**< posted date */
+    GNC_SPLIT_TABLE_KEY_RECONCILED_DATE,
+    GNC_SPLIT_TABLE_KEY_RECONCILED_STATUS,  /**< voided, frozen, reconciled,
+                                                 cleared, then not reconciled */
+    GNC_SPLIT_TABLE_KEY_REGISTER_ORDER,     /**< as xaccSplitOrder() */
+    GNC_SPLIT_TABLE_KEY_CORR_ACCOUNT_NAME,  /**< full name of the other account */
+    GNC_SPLIT_TABLE_KEY_CORR_ACCOUNT_CODE,
+    GNC_SPLIT_TABLE_KEY_AMOUNT,             /**< value of the split */
+    GNC_SPLIT_TABLE_KEY_DESCRIPTION,
+    GNC_SPLIT_TABLE_KEY_NUMBER,             /**< number of the transaction */
+    GNC_SPLIT_TABLE_KEY_ACTION,             /**< action of the split */
+    GNC_SPLIT_TABLE_KEY_MEMO,
+    GNC_SPLIT_TABLE_KEY_NOTES,
+} GncSplitTableKey;
+
+/** How the date keys are grouped.  With GNC_SPLIT_TABLE_DATE_NONE the
+ *  splits are sorted on the time itself and not grouped; otherwise they
+ *  are sorted, and grouped, on the local day, week, month, quarter or
+ *  year of it.  Weeks start on the day gnc_start_of_week() gives. */
+typedef enum
+{
+    GNC_SPLIT_TABLE_DATE_NONE,
+    GNC_SPLIT_TABLE_DATE_DAY,
+    GNC_SPLIT_TABLE_DATE_WEEK,
+    GNC_SPLIT_TABLE_DATE_MONTH,
+    GNC_SPLIT_TABLE_DATE_QUARTER,
+    GNC_SPLIT_TABLE_DATE_YEAR,
+} GncSplitTableDateGroup;
+
+/** The levels of grouping of a split table. */
+typedef enum
+{
+    GNC_SPLIT_TABLE_PRIMARY,
+    GNC_SPLIT_TABLE_SECONDARY,
+    GNC_SPLIT_TABLE_TOTAL,
+} GncSplitTableLevel;
+
+/** How to sort and group on one key.  The splits can't be grouped on
+ *  GNC_SPLIT_TABLE_KEY_NONE, REGISTER_ORDER, AMOUNT, NUMBER or ACTION,
+ *  nor on a date key without date_group, so subtotal is ignored for
+ *  those. */
+typedef struct
+{
+    GncSplitTableKey key;
+    GncSplitTableDateGroup date_group;  /**< for the date keys */
+    gboolean ascending;
+    gboolean subtotal;
+} GncSplitTableSort;
+
+typedef struct GncSplitTable GncSplitTable;
+
+/** Build a table of splits.
+ *
+ * @param splits The splits, which the table doesn't take.
+ *
+ * @param primary How to sort and group on the primary key, or NULL for
+ * none.
+ *
+ * @param secondary The same for the secondary key.
+ *
+ * @param sort If FALSE, the splits are taken to be in order already
+ * and are only grouped; this is for splits that a query sorted.
+ *
+ * @return The table, to be freed with gnc_split_table_destroy().
+ */
+GncSplitTable * gnc_split_table_new (GList *splits,
+                                     const GncSplitTableSort *primary,
+                                     const GncSplitTableSort *secondary,
+                                     gboolean sort);
+
+/** Build a table of the splits matching query, as gnc_split_table_new()
+ *  does.  The sort order of the query doesn't matter.
+ *
+ * @param unique_trans If TRUE, only the first matching split of each
+ * transaction is taken, as with xaccQueryGetSplitsUniqueTrans().
+ */
+GncSplitTable * gnc_split_table_new_from_query (QofQuery *query,
+                                                gboolean unique_trans,
+                                                const GncSplitTableSort *primary,
+                                                const GncSplitTableSort *secondary);
+
+void gnc_split_table_destroy (GncSplitTable *table);
+
+guint gnc_split_table_get_num_rows (const GncSplitTable *table);
+
+Split * gnc_split_table_get_split (const GncSplitTable *table, guint row);
+
+/** Return the splits of the table in its order, in a list the caller
+ *  must g_list_free(). */
+SplitList * gnc_split_table_get_splits (const GncSplitTable *table);
+
+/** Return the running balance of the account of the split of row: the
+ *  sum of the amounts of the splits of that account up to and including
+ *  row, in the order of the table. */
+gnc_numeric gnc_split_table_get_balance (const GncSplitTable *table,
+                                         guint row);
+
+/** Return the number of groups at level, 0 if it isn't grouped. */
+guint gnc_split_table_get_num_groups (const GncSplitTable *table,
+                                      GncSplitTableLevel level);
+
+/** Return the group of row at level, or -1 if the level isn't grouped. */
+gint gnc_split_table_get_group (const GncSplitTable *table, guint row,
+                                GncSplitTableLevel level);
+
+/** Report whether row is the first row of its group at level.  FALSE
+ *  at a level that isn't grouped. */
+gboolean gnc_split_table_row_starts_group (const GncSplitTable *table,
+                                           guint row, GncSplitTableLevel level);
+
+/** Report whether row is the last row of its group at level, i.e. a
+ *  subtotal of that level follows it.  FALSE at a level that isn't
+ *  grouped. */
+gboolean gnc_split_table_row_ends_group (const GncSplitTable *table,
+                                         guint row, GncSplitTableLevel level);
+
+guint gnc_split_table_get_group_first_row (const GncSplitTable *table,
+                                           GncSplitTableLevel level,
+                                           guint group);
+
+guint gnc_split_table_get_group_last_row (const GncSplitTable *table,
+                                          GncSplitTableLevel level,
+                                          guint group);
+
+/** Return the amounts of the splits of group, summed by commodity, in a
+ *  list the caller must free with gnc_monetary_list_free(). */
+MonetaryList * gnc_split_table_get_group_amounts (const GncSplitTable *table,
+                                                  GncSplitTableLevel level,
+                                                  guint group);
+
+/** Return the values of the splits of group, summed by currency, in a
+ *  list the caller must free with gnc_monetary_list_free(). */
+MonetaryList * gnc_split_table_get_group_values (const GncSplitTable *table,
+                                                 GncSplitTableLevel level,
+                                                 guint group);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* GNC_SPLIT_TABLE_H */
+/** @} */
+/** @} */
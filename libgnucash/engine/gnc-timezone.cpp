@@ -277,7 +277,7 @@ TimeZoneProvider::load_windows_default_tz()
 }
 
 TimeZoneProvider::TimeZoneProvider (const std::string& identifier) :
-    m_zone_vector ()
+    m_zone_vector (), m_year_index (), m_first_year (0)
 {
     HKEY key;
     const std::string reg_key =
@@ -289,6 +289,7 @@ TimeZoneProvider::TimeZoneProvider (const std::string& identifier) :
     if (key_name.empty())
     {
         load_windows_default_tz();
+        index_years();
         return;
     }
     std::string subkey = reg_key + key_name;
@@ -308,6 +309,7 @@ TimeZoneProvider::TimeZoneProvider (const std::string& identifier) :
 	this->load_windows_classic_tz (key, names);
     else
 	throw std::invalid_argument ("No data for TZ " + key_name);
+    index_years();
 }
 #elif PLATFORM(POSIX)
 using std::to_string;
@@ -732,14 +734,21 @@ TimeZoneProvider::construct(const std::string& tzname)
     return true;
 }
 
-TimeZoneProvider::TimeZoneProvider(const std::string& tzname) :  m_zone_vector {}
+TimeZoneProvider::TimeZoneProvider(const std::string& tzname) :
+    m_zone_vector {}, m_year_index {}, m_first_year {0}
 {
     if(construct(tzname))
+    {
+        index_years();
         return;
+    }
     DEBUG("%s invalid, trying TZ environment variable.\n", tzname.c_str());
     const char* tz_env = getenv("TZ");
     if(tz_env && construct(tz_env))
+    {
+        index_years();
         return;
+    }
     DEBUG("No valid $TZ, resorting to /etc/localtime.\n");
     try
     {
@@ -751,20 +760,51 @@ TimeZoneProvider::TimeZoneProvider(const std::string& tzname) :  m_zone_vector {
         TZ_Ptr zone(new PTZ("UTC0"));
         m_zone_vector.push_back(std::make_pair(max_year, zone));
     }
+    index_years();
 }
 #endif
 
+/* Build the year -> zone table that get() uses. The zone for a year is
+ * the last one in m_zone_vector starting at or before it, or the first
+ * one if none does, so record the latest vector position starting in
+ * each year and carry it forward.
+ */
+void
+TimeZoneProvider::index_years() noexcept
+{
+    m_year_index.clear();
+    if (m_zone_vector.empty())
+        return;
+    auto bounds = std::minmax_element(m_zone_vector.begin(),
+                                      m_zone_vector.end(),
+                                      [](const TZ_Entry& a, const TZ_Entry& b)
+                                      { return a.first < b.first; });
+    m_first_year = bounds.first->first;
+    auto last_year = bounds.second->first;
+    std::vector<int> latest(last_year - m_first_year + 1, -1);
+    for (unsigned int pos = 0; pos < m_zone_vector.size(); ++pos)
+        latest[m_zone_vector[pos].first - m_first_year] = pos;
+    m_year_index.reserve(latest.size());
+    auto current = 0;
+    for (auto pos : latest)
+    {
+        current = std::max(current, pos);
+        m_year_index.push_back(current);
+    }
+}
+
 
 TZ_Ptr
 TimeZoneProvider::get(int year) const noexcept
 {
     if (m_zone_vector.empty())
         return TZ_Ptr(new PTZ("UTC0"));
-    auto iter = find_if(m_zone_vector.rbegin(), m_zone_vector.rend(),
-			[=](TZ_Entry e) { return e.first <= year; });
-    if (iter == m_zone_vector.rend())
-            return m_zone_vector.front().second;
-    return iter->second;
+    if (year < m_first_year)
+        return m_zone_vector.front().second;
+    auto offset = static_cast<size_t>(year - m_first_year);
+    if (offset >= m_year_index.size())
+        offset = m_year_index.size() - 1;
+    return m_zone_vector[m_year_index[offset]].second;
 }
 
 void
@@ -61,7 +61,13 @@ public:
 private:
     void parse_file(const std::string& tzname);
     bool construct(const std::string& tzname);
+    void index_years() noexcept;
     TZ_Vector m_zone_vector;
+    /* m_year_index[y - m_first_year] is the position in m_zone_vector
+     * of the zone in effect for year y, so that get() needn't search.
+     */
+    std::vector<unsigned int> m_year_index;
+    int m_first_year;
 #if PLATFORM(WINDOWS)
     void load_windows_dynamic_tz(HKEY, time_zone_names);
     void load_windows_classic_tz(HKEY, time_zone_names);
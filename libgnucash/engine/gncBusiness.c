@@ -24,6 +24,7 @@
 #include <config.h>
 
 #include "gncBusiness.h"
+#include "gncBusinessP.h"
 #include "gncOwner.h"
 
 /* The initialization of the business objects is done in
@@ -97,3 +98,148 @@ gboolean gncBusinessIsPaymentAcctType (GNCAccountType type)
     else
         return FALSE;
 }
+
+/* ================================================================== */
+/* ID indexes */
+
+#define ID_INDEXES "gnc-business-id-indexes"
+#define ID_PARAM "id"
+
+typedef struct
+{
+    QofAccessFunc get_id;
+    GHashTable *by_id;          /* ID -> GList of the objects having it */
+    GHashTable *ids;            /* object -> the ID it is indexed under */
+} IDIndex;
+
+static void
+id_index_free (gpointer data)
+{
+    IDIndex *index = data;
+    GHashTableIter iter;
+    gpointer objects;
+
+    /* The lists are replaced whenever their head changes, so the
+     * table can't free them itself */
+    g_hash_table_iter_init (&iter, index->by_id);
+    while (g_hash_table_iter_next (&iter, NULL, &objects))
+        g_list_free (objects);
+    g_hash_table_destroy (index->by_id);
+    g_hash_table_destroy (index->ids);
+    g_free (index);
+}
+
+static void
+id_indexes_free (QofBook *book, gpointer key, gpointer data)
+{
+    g_hash_table_destroy (data);
+}
+
+static void
+id_index_add (IDIndex *index, QofInstance *inst, const char *id)
+{
+    GList *objects;
+
+    if (!id)
+        id = "";
+    objects = g_hash_table_lookup (index->by_id, id);
+    g_hash_table_insert (index->by_id, g_strdup (id),
+                         g_list_prepend (objects, inst));
+    g_hash_table_insert (index->ids, inst, g_strdup (id));
+}
+
+static void
+id_index_remove (IDIndex *index, QofInstance *inst)
+{
+    const char *id = g_hash_table_lookup (index->ids, inst);
+    GList *objects;
+
+    if (!id)
+        return;
+    objects = g_list_remove (g_hash_table_lookup (index->by_id, id), inst);
+    if (objects)
+        g_hash_table_insert (index->by_id, g_strdup (id), objects);
+    else
+        g_hash_table_remove (index->by_id, id);
+    g_hash_table_remove (index->ids, inst);
+}
+
+static void
+id_index_add_cb (QofInstance *inst, gpointer user_data)
+{
+    IDIndex *index = user_data;
+    id_index_add (index, inst, index->get_id (inst, NULL));
+}
+
+/* The ID index of the type_name objects of book, if it has been made,
+ * or made now if make */
+static IDIndex *
+id_index (QofBook *book, QofIdTypeConst type_name, gboolean make)
+{
+    GHashTable *indexes;
+    IDIndex *index;
+    QofAccessFunc get_id;
+
+    if (!book || !type_name || qof_book_shutting_down (book))
+        return NULL;
+
+    indexes = qof_book_get_data (book, ID_INDEXES);
+    index = indexes ? g_hash_table_lookup (indexes, type_name) : NULL;
+    if (index || !make)
+        return index;
+
+    get_id = qof_class_get_parameter_getter (type_name, ID_PARAM);
+    g_return_val_if_fail (get_id, NULL);
+
+    if (!indexes)
+    {
+        indexes = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                         g_free, id_index_free);
+        qof_book_set_data_fin (book, ID_INDEXES, indexes, id_indexes_free);
+    }
+    index = g_new0 (IDIndex, 1);
+    index->get_id = get_id;
+    index->by_id = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                          g_free, NULL);
+    index->ids = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+                                        NULL, g_free);
+    qof_collection_foreach (qof_book_get_collection (book, type_name),
+                            id_index_add_cb, index);
+    g_hash_table_insert (indexes, g_strdup (type_name), index);
+    return index;
+}
+
+GList * gncBusinessLookupID (QofBook *book, QofIdTypeConst type_name,
+                             const char *id)
+{
+    IDIndex *index;
+
+    g_return_val_if_fail (id, NULL);
+
+    index = id_index (book, type_name, TRUE);
+    return index ? g_hash_table_lookup (index->by_id, id) : NULL;
+}
+
+void gncBusinessIDIndexUpdate (QofInstance *inst, const char *id)
+{
+    IDIndex *index;
+
+    if (!inst)
+        return;
+    index = id_index (qof_instance_get_book (inst), inst->e_type, FALSE);
+    if (!index)
+        return;
+    id_index_remove (index, inst);
+    id_index_add (index, inst, id);
+}
+
+void gncBusinessIDIndexRemove (QofInstance *inst)
+{
+    IDIndex *index;
+
+    if (!inst)
+        return;
+    index = id_index (qof_instance_get_book (inst), inst->e_type, FALSE);
+    if (index)
+        id_index_remove (index, inst);
+}
@@ -87,6 +87,16 @@ typedef GList OwnerList;
 OwnerList * gncBusinessGetOwnerList (QofBook *book, QofIdTypeConst type_name,
                                      gboolean all_including_inactive);
 
+/** Returns the objects of the given type_name in the given book whose
+ * ID, i.e. their "id" parameter, is id, in no particular order.
+ *
+ * They are looked up in an index of the IDs of the type, made the first
+ * time and kept up to date as the IDs change, so this is meant for
+ * looking up many IDs in a row, e.g. when importing.  The list belongs
+ * to the index and is only valid until the next change of an ID. */
+GList * gncBusinessLookupID (QofBook *book, QofIdTypeConst type_name,
+                             const char *id);
+
 /** Returns whether the given account type is a valid type to use in
  * business payments. Currently payments are allowed to/from assets,
  * liabilities and equity accounts. */
@@ -0,0 +1,36 @@
+/********************************************************************\
+ * gncBusinessP.h -- Business helper functions, private to the      *
+ *                   engine                                         *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ *                                                                  *
+\********************************************************************/
+
+#ifndef GNC_BUSINESSP_H_
+#define GNC_BUSINESSP_H_
+
+#include "gncBusiness.h"
+
+/* Tell the ID index of the object's type, if it has been made, that
+ * the object now has this ID.  Call it wherever the ID is set. */
+void gncBusinessIDIndexUpdate (QofInstance *inst, const char *id);
+
+/* Drop the object from the ID index of its type, e.g. when freeing it. */
+void gncBusinessIDIndexRemove (QofInstance *inst);
+
+#endif /* GNC_BUSINESSP_H_ */
@@ -38,6 +38,7 @@
 #include "gncBillTermP.h"
 #include "gncInvoice.h"
 #include "gncBusiness.h"
+#include "gncBusinessP.h"
 
 #include "gncCustomer.h"
 #include "gncCustomerP.h"
@@ -312,6 +313,7 @@ GncCustomer *gncCustomerCreate (QofBook *book)
     qof_instance_init_data (&cust->inst, _GNC_MOD_NAME, book);
 
     cust->id = CACHE_INSERT ("");
+    gncBusinessIDIndexUpdate (&cust->inst, cust->id);
     cust->name = CACHE_INSERT ("");
     cust->notes = CACHE_INSERT ("");
     cust->addr = gncAddressCreate (book, &cust->inst);
@@ -346,6 +348,7 @@ static void gncCustomerFree (GncCustomer *cust)
 
     qof_event_gen (&cust->inst, QOF_EVENT_DESTROY, NULL);
 
+    gncBusinessIDIndexRemove (&cust->inst);
     CACHE_REMOVE (cust->id);
     CACHE_REMOVE (cust->name);
     CACHE_REMOVE (cust->notes);
@@ -385,6 +388,7 @@ void gncCustomerSetID (GncCustomer *cust, const char *id)
     if (!cust) return;
     if (!id) return;
     SET_STR(cust, cust->id, id);
+    gncBusinessIDIndexUpdate (&cust->inst, cust->id);
     mark_customer (cust);
     gncCustomerCommitEdit (cust);
 }
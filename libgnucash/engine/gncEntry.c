@@ -37,6 +37,7 @@
 #include "gnc-features.h"
 #include "gncInvoice.h"
 #include "gncOrder.h"
+#include "gncTaxTableP.h"
 
 struct _gncEntry
 {
@@ -87,7 +88,7 @@ struct _gncEntry
     gnc_numeric	i_tax_value_rounded;
     gnc_numeric	i_disc_value;
     gnc_numeric	i_disc_value_rounded;
-    time64	i_taxtable_modtime;
+    guint64	i_taxtable_version;
 
     /* vendor bill */
     gnc_numeric	b_value;
@@ -95,7 +96,7 @@ struct _gncEntry
     GList *	b_tax_values;
     gnc_numeric	b_tax_value;
     gnc_numeric	b_tax_value_rounded;
-    time64	b_taxtable_modtime;
+    guint64	b_taxtable_version;
 };
 
 struct _gncEntryClass
@@ -207,6 +208,27 @@ void mark_entry (GncEntry *entry)
     qof_event_gen (&entry->inst, QOF_EVENT_MODIFY, NULL);
 }
 
+/* Bumped whenever the values of some entry may change, for the totals
+ * that the invoices cache.  Zero is never a generation. */
+static guint64 values_generation = 1;
+
+guint64 gncEntryGetValuesGeneration (void)
+{
+    return values_generation;
+}
+
+void gncEntryBumpValuesGeneration (void)
+{
+    values_generation++;
+}
+
+static inline void
+mark_entry_values (GncEntry *entry)
+{
+    entry->values_dirty = TRUE;
+    values_generation++;
+}
+
 /* ================================================================ */
 
 enum
@@ -553,7 +575,7 @@ void gncEntrySetQuantity (GncEntry *entry, gnc_numeric quantity)
     if (gnc_numeric_eq (entry->quantity, quantity)) return;
     gncEntryBeginEdit (entry);
     entry->quantity = quantity;
-    entry->values_dirty = TRUE;
+    mark_entry_values (entry);
     mark_entry (entry);
     gncEntryCommitEdit (entry);
 }
@@ -564,7 +586,7 @@ void gncEntrySetDocQuantity (GncEntry *entry, gnc_numeric quantity, gboolean is_
     if (gnc_numeric_eq (entry->quantity, (is_cn ? gnc_numeric_neg (quantity) : quantity))) return;
     gncEntryBeginEdit (entry);
     entry->quantity = (is_cn ? gnc_numeric_neg (quantity) : quantity);
-    entry->values_dirty = TRUE;
+    mark_entry_values (entry);
     mark_entry (entry);
     gncEntryCommitEdit (entry);
 }
@@ -587,7 +609,7 @@ void gncEntrySetInvPrice (GncEntry *entry, gnc_numeric price)
     if (gnc_numeric_eq (entry->i_price, price)) return;
     gncEntryBeginEdit (entry);
     entry->i_price = price;
-    entry->values_dirty = TRUE;
+    mark_entry_values (entry);
     mark_entry (entry);
     gncEntryCommitEdit (entry);
 }
@@ -598,7 +620,7 @@ void gncEntrySetInvTaxable (GncEntry *entry, gboolean taxable)
     if (entry->i_taxable == taxable) return;
     gncEntryBeginEdit (entry);
     entry->i_taxable = taxable;
-    entry->values_dirty = TRUE;
+    mark_entry_values (entry);
     mark_entry (entry);
     gncEntryCommitEdit (entry);
 }
@@ -609,7 +631,7 @@ void gncEntrySetInvTaxIncluded (GncEntry *entry, gboolean taxincluded)
     if (entry->i_taxincluded == taxincluded) return;
     gncEntryBeginEdit (entry);
     entry->i_taxincluded = taxincluded;
-    entry->values_dirty = TRUE;
+    mark_entry_values (entry);
     mark_entry (entry);
     gncEntryCommitEdit (entry);
 }
@@ -624,7 +646,7 @@ void gncEntrySetInvTaxTable (GncEntry *entry, GncTaxTable *table)
     if (table)
         gncTaxTableIncRef (table);
     entry->i_tax_table = table;
-    entry->values_dirty = TRUE;
+    mark_entry_values (entry);
     mark_entry (entry);
     gncEntryCommitEdit (entry);
 }
@@ -635,7 +657,7 @@ void gncEntrySetInvDiscount (GncEntry *entry, gnc_numeric discount)
     if (gnc_numeric_eq (entry->i_discount, discount)) return;
     gncEntryBeginEdit (entry);
     entry->i_discount = discount;
-    entry->values_dirty = TRUE;
+    mark_entry_values (entry);
     mark_entry (entry);
     gncEntryCommitEdit (entry);
 }
@@ -647,7 +669,7 @@ void gncEntrySetInvDiscountType (GncEntry *entry, GncAmountType type)
 
     gncEntryBeginEdit (entry);
     entry->i_disc_type = type;
-    entry->values_dirty = TRUE;
+    mark_entry_values (entry);
     mark_entry (entry);
     gncEntryCommitEdit (entry);
 }
@@ -659,7 +681,7 @@ void gncEntrySetInvDiscountHow (GncEntry *entry, GncDiscountHow how)
 
     gncEntryBeginEdit (entry);
     entry->i_disc_how = how;
-    entry->values_dirty = TRUE;
+    mark_entry_values (entry);
     mark_entry (entry);
     gncEntryCommitEdit (entry);
 }
@@ -673,7 +695,7 @@ void qofEntrySetInvDiscType (GncEntry *entry, const char *type_string)
     if (entry->i_disc_type == type) return;
     gncEntryBeginEdit (entry);
     entry->i_disc_type = type;
-    entry->values_dirty = TRUE;
+    mark_entry_values (entry);
     mark_entry (entry);
     gncEntryCommitEdit (entry);
 
@@ -688,7 +710,7 @@ void qofEntrySetInvDiscHow  (GncEntry *entry, const char *type)
     gncEntryDiscountStringToHow(type, &how);
     if (entry->i_disc_how == how) return;
     entry->i_disc_how = how;
-    entry->values_dirty = TRUE;
+    mark_entry_values (entry);
     mark_entry (entry);
     gncEntryCommitEdit (entry);
 }
@@ -711,7 +733,7 @@ void gncEntrySetBillPrice (GncEntry *entry, gnc_numeric price)
     if (gnc_numeric_eq (entry->b_price, price)) return;
     gncEntryBeginEdit (entry);
     entry->b_price = price;
-    entry->values_dirty = TRUE;
+    mark_entry_values (entry);
     mark_entry (entry);
     gncEntryCommitEdit (entry);
 }
@@ -722,7 +744,7 @@ void gncEntrySetBillTaxable (GncEntry *entry, gboolean taxable)
     if (entry->b_taxable == taxable) return;
     gncEntryBeginEdit (entry);
     entry->b_taxable = taxable;
-    entry->values_dirty = TRUE;
+    mark_entry_values (entry);
     mark_entry (entry);
     gncEntryCommitEdit (entry);
 }
@@ -733,7 +755,7 @@ void gncEntrySetBillTaxIncluded (GncEntry *entry, gboolean taxincluded)
     if (entry->b_taxincluded == taxincluded) return;
     gncEntryBeginEdit (entry);
     entry->b_taxincluded = taxincluded;
-    entry->values_dirty = TRUE;
+    mark_entry_values (entry);
     mark_entry (entry);
     gncEntryCommitEdit (entry);
 }
@@ -748,7 +770,7 @@ void gncEntrySetBillTaxTable (GncEntry *entry, GncTaxTable *table)
     if (table)
         gncTaxTableIncRef (table);
     entry->b_tax_table = table;
-    entry->values_dirty = TRUE;
+    mark_entry_values (entry);
     mark_entry (entry);
     gncEntryCommitEdit (entry);
 }
@@ -804,6 +826,8 @@ void gncEntrySetInvoice (GncEntry *entry, GncInvoice *invoice)
     if (entry->invoice == invoice) return;
     gncEntryBeginEdit (entry);
     entry->invoice = invoice;
+    /* Its currency gives the denominator of the values */
+    mark_entry_values (entry);
     mark_entry (entry);
     gncEntryCommitEdit (entry);
 }
@@ -815,6 +839,7 @@ void gncEntrySetBill (GncEntry *entry, GncInvoice *bill)
     if (entry->bill == bill) return;
     gncEntryBeginEdit (entry);
     entry->bill = bill;
+    mark_entry_values (entry);
     mark_entry (entry);
     gncEntryCommitEdit (entry);
 }
@@ -865,7 +890,7 @@ void gncEntryCopy (const GncEntry *src, GncEntry *dest, gboolean add_entry)
             gncBillAddEntry (src->bill, dest);
     }
 
-    dest->values_dirty = TRUE;
+    mark_entry_values (dest);
     mark_entry (dest);
     gncEntryCommitEdit (dest);
 }
@@ -1324,20 +1349,20 @@ gncEntryRecomputeValues (GncEntry *entry)
     /* See if either tax table changed since we last computed values */
     if (entry->i_tax_table)
     {
-        time64 modtime = gncTaxTableLastModifiedSecs (entry->i_tax_table);
-        if (entry->i_taxtable_modtime != modtime)
+        guint64 version = gncTaxTableGetVersion (entry->i_tax_table);
+        if (entry->i_taxtable_version != version)
         {
             entry->values_dirty = TRUE;
-            entry->i_taxtable_modtime = modtime;
+            entry->i_taxtable_version = version;
         }
     }
     if (entry->b_tax_table)
     {
-        time64 modtime = gncTaxTableLastModifiedSecs (entry->b_tax_table);
-        if (entry->b_taxtable_modtime != modtime)
+        guint64 version = gncTaxTableGetVersion (entry->b_tax_table);
+        if (entry->b_taxtable_version != version)
         {
             entry->values_dirty = TRUE;
-            entry->b_taxtable_modtime = modtime;
+            entry->b_taxtable_version = version;
         }
     }
 
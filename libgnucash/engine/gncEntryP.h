@@ -38,6 +38,13 @@ void gncEntrySetInvoice (GncEntry *entry, GncInvoice *invoice);
 void gncEntrySetBill (GncEntry *entry, GncInvoice *bill);
 void gncEntrySetDirty (GncEntry *entry, gboolean dirty);
 
+/* The generation of the values of all the entries: it changes whenever
+ * the value of one might, be it through an edit of the entry, of its
+ * invoice or of a tax table.  Whatever is computed from entry values
+ * stays valid as long as it doesn't change. */
+guint64 gncEntryGetValuesGeneration (void);
+void gncEntryBumpValuesGeneration (void);
+
 #define gncEntrySetGUID(E,G) qof_instance_set_guid(QOF_INSTANCE(E),(G))
 
 #endif /* GNC_ENTRYP_H_ */
@@ -83,81 +83,49 @@ gnc_search_vendor_on_id (QofBook * book, const gchar *id)
 /******************************************************************
  * Generic search called after setting up stuff
  * DO NOT call directly but type tests should fail anyway
+ * The objects are looked up in the ID index of their type, so
+ * importing many rows doesn't query the whole book for each.
  ****************************************************************/
 static void * search(QofBook * book, const gchar *id, void * object, GncSearchType type)
 {
     void *c;
     GList *result;
-    QofQuery *q;
-    gint len;
-    QofQueryPredData* string_pred_data;
-    
+    QofIdTypeConst type_name = NULL;
+
     PINFO("Type = %d", type);
     g_return_val_if_fail (type, NULL);
     g_return_val_if_fail (id, NULL);
     g_return_val_if_fail (book, NULL);
 
-    // Build the query
-    q = qof_query_create ();
-    qof_query_set_book (q, book);
-    // Search only the id field
-    string_pred_data = qof_query_string_predicate (QOF_COMPARE_EQUAL, id, QOF_STRING_MATCH_NORMAL, FALSE);
     if (type == CUSTOMER)
-    {
-        qof_query_search_for(q,GNC_CUSTOMER_MODULE_NAME);
-        qof_query_add_term (q, qof_query_build_param_list("CUSTOMER_ID"), string_pred_data, QOF_QUERY_AND);
-    }
+        type_name = GNC_CUSTOMER_MODULE_NAME;
     else if (type ==  INVOICE || type ==  BILL)
-    {
-        qof_query_search_for(q,GNC_INVOICE_MODULE_NAME);
-        qof_query_add_term (q, qof_query_build_param_list("INVOICE_ID"), string_pred_data, QOF_QUERY_AND);
-    }
+        type_name = GNC_INVOICE_MODULE_NAME;
     else if (type == VENDOR)
-    {
-        qof_query_search_for(q,GNC_VENDOR_MODULE_NAME);
-        qof_query_add_term (q, qof_query_build_param_list("VENDOR_ID"), string_pred_data, QOF_QUERY_AND);
-    }
+        type_name = GNC_VENDOR_MODULE_NAME;
 
-
-    // Run the query
-    result = qof_query_run (q);
-
-    // now compare _exactly_
-    len = g_list_length (result);
-    if (result && (len > 0))
+    for (result = gncBusinessLookupID (book, type_name, id); result;
+         result = g_list_next (result))
     {
-        result = g_list_first (result);
+        c = result->data;
 
-        while (result)
+        if (type == CUSTOMER || type == VENDOR)
+        {
+            object = c;
+            break;
+        }
+        else if (type == INVOICE
+                    && gncInvoiceGetType(c) == GNC_INVOICE_CUST_INVOICE)
+        {
+            object = c;
+            break;
+        }
+        else if (type == BILL
+                    && gncInvoiceGetType(c) == GNC_INVOICE_VEND_INVOICE)
         {
-            c = result->data;
-            
-            if (type == CUSTOMER && strcmp(id, gncCustomerGetID(c)) == 0)
-            {
-                // correct id found
-                object = c;
-                break;
-            }
-            else if (type == INVOICE && strcmp(id, gncInvoiceGetID(c)) == 0 
-                        && gncInvoiceGetType(c) == GNC_INVOICE_CUST_INVOICE)
-            {
-                object = c;
-                break;
-            }
-            else if (type == BILL && strcmp(id, gncInvoiceGetID(c)) == 0 
-                        && gncInvoiceGetType(c) == GNC_INVOICE_VEND_INVOICE)
-            {
-                object = c;
-                break;
-            }
-            else if (type == VENDOR && strcmp(id, gncVendorGetID(c)) == 0)
-            {
-                object = c;
-                break;
-            }
-            result = g_list_next (result);
+            object = c;
+            break;
         }
     }
-    qof_query_destroy (q);
     return object;
 }
@@ -37,6 +37,7 @@
 #include "Transaction.h"
 #include "Account.h"
 #include "gncBillTermP.h"
+#include "gncBusinessP.h"
 #include "gncEntry.h"
 #include "gncEntryP.h"
 #include "gnc-features.h"
@@ -72,6 +73,13 @@ struct _gncInvoice
     Account       *posted_acc;
     Transaction   *posted_txn;
     GNCLot        *posted_lot;
+
+    /* The totals, as of this generation of the entry values; 0 when
+     * they have to be computed. */
+    guint64       totals_generation;
+    gnc_numeric   total;
+    gnc_numeric   total_subtotal;
+    gnc_numeric   total_tax;
 };
 
 struct _gncInvoiceClass
@@ -100,6 +108,8 @@ static void mark_invoice (GncInvoice *invoice);
 static void
 mark_invoice (GncInvoice *invoice)
 {
+    /* Its currency, owner, entries or credit note flag may change them */
+    invoice->totals_generation = 0;
     qof_instance_set_dirty (&invoice->inst);
     qof_event_gen (&invoice->inst, QOF_EVENT_MODIFY, NULL);
 }
@@ -324,6 +334,7 @@ GncInvoice *gncInvoiceCreate (QofBook *book)
     qof_instance_init_data (&invoice->inst, _GNC_MOD_NAME, book);
 
     invoice->id = CACHE_INSERT ("");
+    gncBusinessIDIndexUpdate (&invoice->inst, invoice->id);
     invoice->notes = CACHE_INSERT ("");
     invoice->billing_id = CACHE_INSERT ("");
 
@@ -354,6 +365,7 @@ GncInvoice *gncInvoiceCopy (const GncInvoice *from)
     gncInvoiceBeginEdit (invoice);
 
     invoice->id = CACHE_INSERT (from->id);
+    gncBusinessIDIndexUpdate (&invoice->inst, invoice->id);
     invoice->notes = CACHE_INSERT (from->notes);
     invoice->billing_id = CACHE_INSERT (from->billing_id);
     invoice->active = from->active;
@@ -420,6 +432,7 @@ static void gncInvoiceFree (GncInvoice *invoice)
 
     qof_event_gen (&invoice->inst, QOF_EVENT_DESTROY, NULL);
 
+    gncBusinessIDIndexRemove (&invoice->inst);
     CACHE_REMOVE (invoice->id);
     CACHE_REMOVE (invoice->notes);
     CACHE_REMOVE (invoice->billing_id);
@@ -442,6 +455,7 @@ void gncInvoiceSetID (GncInvoice *invoice, const char *id)
 {
     if (!invoice || !id) return;
     SET_STR (invoice, invoice->id, id);
+    gncBusinessIDIndexUpdate (&invoice->inst, invoice->id);
     mark_invoice (invoice);
     gncInvoiceCommitEdit (invoice);
 }
@@ -454,6 +468,7 @@ void gncInvoiceSetOwner (GncInvoice *invoice, GncOwner *owner)
     gncOwnerCopy (owner, &invoice->owner);
     mark_invoice (invoice);
     gncInvoiceCommitEdit (invoice);
+    gncOwnerLotIndexUpdate (invoice->posted_lot);
 }
 
 static void
@@ -467,6 +482,7 @@ qofInvoiceSetOwner (GncInvoice *invoice, QofInstance *ent)
     qofOwnerSetEntity (&invoice->owner, ent);
     mark_invoice (invoice);
     gncInvoiceCommitEdit (invoice);
+    gncOwnerLotIndexUpdate (invoice->posted_lot);
 }
 
 static void
@@ -990,22 +1006,49 @@ static gnc_numeric gncInvoiceGetTotalInternal (GncInvoice *invoice, gboolean use
     return total;
 }
 
+/* Compute the total, subtotal and tax total in one go, as
+ * gncInvoiceGetTotalInternal would, unless none of the entry values
+ * changed since they last were. */
+static void gncInvoiceUpdateTotals (GncInvoice *invoice)
+{
+    AccountValueList *taxes;
+    gnc_numeric net, tax;
+    guint64 generation = gncEntryGetValuesGeneration ();
+
+    if (invoice->totals_generation == generation)
+        return;
+
+    net = gncInvoiceGetNetAndTaxesInternal (invoice, TRUE, &taxes, FALSE, 0);
+    tax = gncInvoiceSumTaxesInternal (taxes);
+    gncAccountValueDestroy (taxes);
+
+    invoice->total_subtotal = net;
+    invoice->total = gnc_numeric_add (net, tax, GNC_DENOM_AUTO,
+                                      GNC_HOW_DENOM_EXACT | GNC_HOW_RND_ROUND_HALF_UP);
+    invoice->total_tax = gnc_numeric_add (gnc_numeric_zero (), tax, GNC_DENOM_AUTO,
+                                          GNC_HOW_DENOM_EXACT | GNC_HOW_RND_ROUND_HALF_UP);
+    invoice->totals_generation = generation;
+}
+
 gnc_numeric gncInvoiceGetTotal (GncInvoice *invoice)
 {
     if (!invoice) return gnc_numeric_zero ();
-    return gncInvoiceGetTotalInternal (invoice, TRUE, TRUE, FALSE, 0);
+    gncInvoiceUpdateTotals (invoice);
+    return invoice->total;
 }
 
 gnc_numeric gncInvoiceGetTotalSubtotal (GncInvoice *invoice)
 {
     if (!invoice) return gnc_numeric_zero ();
-    return gncInvoiceGetTotalInternal (invoice, TRUE, FALSE, FALSE, 0);
+    gncInvoiceUpdateTotals (invoice);
+    return invoice->total_subtotal;
 }
 
 gnc_numeric gncInvoiceGetTotalTax (GncInvoice *invoice)
 {
     if (!invoice) return gnc_numeric_zero ();
-    return gncInvoiceGetTotalInternal (invoice, FALSE, TRUE, FALSE, 0);
+    gncInvoiceUpdateTotals (invoice);
+    return invoice->total_tax;
 }
 
 gnc_numeric gncInvoiceGetTotalOf (GncInvoice *invoice, GncEntryPaymentType type)
@@ -1252,6 +1295,7 @@ gncInvoiceDetachFromLot (GNCLot *lot)
     qof_instance_set (QOF_INSTANCE (lot), "invoice", NULL, NULL);
     gnc_lot_commit_edit (lot);
     gnc_lot_set_cached_invoice (lot, NULL);
+    gncOwnerLotIndexUpdate (lot);
 }
 
 void
@@ -1268,6 +1312,7 @@ gncInvoiceAttachToLot (GncInvoice *invoice, GNCLot *lot)
     gnc_lot_commit_edit (lot);
     gnc_lot_set_cached_invoice (lot, invoice);
     gncInvoiceSetPostedLot (invoice, lot);
+    gncOwnerLotIndexUpdate (lot);
 }
 
 GncInvoice * gncInvoiceGetInvoiceFromLot (GNCLot *lot)
@@ -1494,8 +1539,9 @@ Transaction * gncInvoicePostToAccount (GncInvoice *invoice, Account *acc,
     if (!invoice || !acc) return NULL;
     if (gncInvoiceIsPosted (invoice)) return NULL;
 
-    gncInvoiceBeginEdit (invoice);
     book = qof_instance_get_book (invoice);
+    qof_book_begin_batch (book);
+    gncInvoiceBeginEdit (invoice);
 
     /* Stabilize the Billing Terms of this invoice */
     if (invoice->terms)
@@ -1614,6 +1660,7 @@ Transaction * gncInvoicePostToAccount (GncInvoice *invoice, Account *acc,
                       We can't really do anything sensible about it, and this is
                       a user-interface free zone so we can't try asking the user
                       again either, have to return NULL*/
+                    qof_book_end_batch (book);
                     return NULL;
                 }
 
@@ -1676,6 +1723,7 @@ Transaction * gncInvoicePostToAccount (GncInvoice *invoice, Account *acc,
               We can't really do anything sensible about it, and this is
               a user-interface free zone so we can't try asking the user
               again either, have to return NULL*/
+            qof_book_end_batch (book);
             return NULL;
         }
     }
@@ -1750,9 +1798,86 @@ Transaction * gncInvoicePostToAccount (GncInvoice *invoice, Account *acc,
     if (autopay)
         gncInvoiceAutoApplyPayments (invoice);
 
+    qof_book_end_batch (book);
     return txn;
 }
 
+static void
+invoice_post_defer_account (GHashTable *accounts, Account *acc)
+{
+    if (!acc || g_hash_table_contains (accounts, acc))
+        return;
+
+    /* The value tells whether its computation was already deferred */
+    g_hash_table_insert (accounts, acc,
+                         GINT_TO_POINTER (gnc_account_get_defer_bal_computation (acc)));
+    xaccAccountBeginEdit (acc);
+    gnc_account_set_defer_bal_computation (acc, TRUE);
+}
+
+static void
+invoice_post_resume_account (gpointer key, gpointer value, gpointer user_data)
+{
+    Account *acc = key;
+
+    gnc_account_set_defer_bal_computation (acc, GPOINTER_TO_INT (value));
+    xaccAccountRecomputeBalance (acc);
+    xaccAccountCommitEdit (acc);
+}
+
+GList *
+gncInvoicePostListToAccount (GList *invoices, Account *acc,
+                             time64 post_date, time64 due_date,
+                             const char *memo, gboolean accumulatesplits,
+                             gboolean autopay)
+{
+    GHashTable *accounts;
+    GList *node, *txns = NULL;
+    QofBook *book;
+
+    if (!invoices || !acc) return NULL;
+
+    book = gnc_account_get_book (acc);
+
+    /* One backend batch and one round of events for all of them, and
+     * the balances of the accounts posted to only computed at the end */
+    qof_event_begin_batch ();
+    qof_book_begin_batch (book);
+
+    accounts = g_hash_table_new (g_direct_hash, g_direct_equal);
+    invoice_post_defer_account (accounts, acc);
+    for (node = invoices; node; node = node->next)
+    {
+        GList *entries;
+
+        if (!node->data || gncInvoiceIsPosted (node->data))
+            continue;
+        for (entries = gncInvoiceGetEntries (node->data); entries;
+             entries = entries->next)
+        {
+            invoice_post_defer_account (accounts,
+                                        gncEntryGetInvAccount (entries->data));
+            invoice_post_defer_account (accounts,
+                                        gncEntryGetBillAccount (entries->data));
+        }
+    }
+
+    for (node = invoices; node; node = node->next)
+        txns = g_list_prepend (txns,
+                               gncInvoicePostToAccount (node->data, acc,
+                                                        post_date, due_date,
+                                                        memo, accumulatesplits,
+                                                        autopay));
+
+    g_hash_table_foreach (accounts, invoice_post_resume_account, NULL);
+    g_hash_table_destroy (accounts);
+
+    qof_book_end_batch (book);
+    qof_event_end_batch ();
+
+    return g_list_reverse (txns);
+}
+
 gboolean
 gncInvoiceUnpost (GncInvoice *invoice, gboolean reset_tax_tables)
 {
@@ -1950,8 +2075,8 @@ void gncInvoiceAutoApplyPayments (GncInvoice *invoice)
      * could be used. */
     lm.positive_balance =  gnc_numeric_positive_p (gnc_lot_get_balance (inv_lot));
     lm.owner = owner;
-    lot_list = xaccAccountFindOpenLots (acct, gnc_lot_match_owner_balancing,
-                                        &lm, NULL);
+    lot_list = gncOwnerFindOpenLots (owner, acct, gnc_lot_match_owner_balancing,
+                                     &lm, NULL);
 
     lot_list = g_list_prepend (lot_list, inv_lot);
     gncOwnerAutoApplyPaymentsWithLots (owner, lot_list);
@@ -218,6 +218,20 @@ gncInvoicePostToAccount (GncInvoice *invoice, Account *acc,
                          const char *memo, gboolean accumulatesplits,
                          gboolean autopay);
 
+/** Post each of a list of invoices to an account, as
+ * gncInvoicePostToAccount() would, but together: their backend commits
+ * are batched, the event handlers get all the changes at once at the
+ * end, and the balances of the accounts posted to are only computed
+ * then.  Returns the list of the new transactions, one for each invoice
+ * in the same order, NULL for those that couldn't be posted, e.g.
+ * because they already were.  Free it with g_list_free().
+ */
+GList *
+gncInvoicePostListToAccount (GList *invoices, Account *acc,
+                             time64 posted_date, time64 due_date,
+                             const char *memo, gboolean accumulatesplits,
+                             gboolean autopay);
+
 /**
  * Unpost this invoice.  This will destroy the posted transaction and
  * return the invoice to its unposted state.  It may leave empty lots
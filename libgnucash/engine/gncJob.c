@@ -33,6 +33,7 @@
 #include <qofinstance-p.h>
 
 #include "gnc-features.h"
+#include "gncEntryP.h"
 #include "gncInvoice.h"
 #include "gncJob.h"
 #include "gncJobP.h"
@@ -372,6 +373,10 @@ void gncJobSetOwner (GncJob *job, GncOwner *owner)
 
     mark_job (job);
     gncJobCommitEdit (job);
+    /* The lots of the job's invoices now have another end owner, and
+     * their entries may be for the other side of the documents */
+    gncOwnerLotIndexInvalidate (qof_instance_get_book (job));
+    gncEntryBumpValuesGeneration ();
 }
 
 void gncJobSetActive (GncJob *job, gboolean active)
@@ -42,6 +42,7 @@
 #include "gncOwner.h"
 #include "gncOwnerP.h"
 #include "gncVendorP.h"
+#include "AccountP.h"
 #include "gncInvoice.h"
 #include "gnc-commodity.h"
 #include "Scrub2.h"
@@ -53,6 +54,13 @@
 
 #define GNC_OWNER_ID    "gncOwner"
 
+/* Book data: the events dropped when the cached owner balances of the
+ * book were last known to be up to date */
+#define OWNER_BALANCES_DROPPED "gnc-owner-balances-dropped"
+
+/* Book data: the OwnerLotIndex of the book */
+#define OWNER_LOT_INDEX "gnc-owner-lot-index"
+
 static QofLogModule log_module = GNC_MOD_ENGINE;
 
 GncOwner * gncOwnerNew (void)
@@ -632,6 +640,7 @@ void gncOwnerAttachToLot (const GncOwner *owner, GNCLot *lot)
 		      GNC_OWNER_GUID, gncOwnerGetGUID (owner),
 		      NULL);
     gnc_lot_commit_edit (lot);
+    gncOwnerLotIndexUpdate (lot);
 }
 
 gboolean gncOwnerGetOwnerFromLot (GNCLot *lot, GncOwner *owner)
@@ -725,6 +734,378 @@ gncOwnerLotMatchOwnerFunc (GNCLot *lot, gpointer user_data)
     return gncOwnerEqual (end_owner, req_owner);
 }
 
+/* The lots of each owner, so that finding them doesn't mean going
+ * through all the lots of the A/R or A/P account.  A lot is filed under
+ * the end owner of its invoice and under the end owner it has itself,
+ * if those differ; both ways of matching lots to owners then only need
+ * to look at the lots filed under the owner.  The index holds GUIDs,
+ * for lots may go without it hearing of it, and the lots are always
+ * matched again when they are looked up. */
+typedef struct
+{
+    GncGUID owners[2];
+    guint   n_owners;
+} LotOwners;
+
+typedef struct
+{
+    QofBook    *book;
+    /* Owner GUID -> set of lot GUIDs */
+    GHashTable *owners;
+    /* Lot GUID -> LotOwners */
+    GHashTable *lots;
+    /* Set when some lots may have another end owner than they are filed
+     * under, which can't be told from the lots. */
+    gboolean    stale;
+} OwnerLotIndex;
+
+static void
+lot_index_get_owners (GNCLot *lot, LotOwners *lo)
+{
+    GncInvoice *invoice = gncInvoiceGetInvoiceFromLot (lot);
+    GncOwner lot_owner;
+    const GncGUID *guid;
+
+    lo->n_owners = 0;
+    if (invoice)
+    {
+        guid = gncOwnerGetEndGUID (gncInvoiceGetOwner (invoice));
+        if (guid)
+            lo->owners[lo->n_owners++] = *guid;
+    }
+    if (gncOwnerGetOwnerFromLot (lot, &lot_owner))
+    {
+        guid = gncOwnerGetEndGUID (&lot_owner);
+        if (guid && !(lo->n_owners && guid_equal (guid, &lo->owners[0])))
+            lo->owners[lo->n_owners++] = *guid;
+    }
+}
+
+static void
+lot_index_forget (OwnerLotIndex *index, const GncGUID *lot_guid)
+{
+    LotOwners *lo = g_hash_table_lookup (index->lots, lot_guid);
+    guint i;
+
+    if (!lo)
+        return;
+
+    for (i = 0; i < lo->n_owners; i++)
+    {
+        GHashTable *lots = g_hash_table_lookup (index->owners, &lo->owners[i]);
+        if (!lots)
+            continue;
+        g_hash_table_remove (lots, lot_guid);
+        if (g_hash_table_size (lots) == 0)
+            g_hash_table_remove (index->owners, &lo->owners[i]);
+    }
+    g_hash_table_remove (index->lots, lot_guid);
+}
+
+static void
+lot_index_file (OwnerLotIndex *index, GNCLot *lot)
+{
+    const GncGUID *lot_guid = qof_instance_get_guid (QOF_INSTANCE (lot));
+    LotOwners *lo;
+    guint i;
+
+    lot_index_forget (index, lot_guid);
+    if (qof_instance_get_destroying (lot))
+        return;
+
+    lo = g_new (LotOwners, 1);
+    lot_index_get_owners (lot, lo);
+    if (!lo->n_owners)
+    {
+        g_free (lo);
+        return;
+    }
+
+    g_hash_table_insert (index->lots, guid_copy (lot_guid), lo);
+    for (i = 0; i < lo->n_owners; i++)
+    {
+        GHashTable *lots = g_hash_table_lookup (index->owners, &lo->owners[i]);
+        if (!lots)
+        {
+            lots = g_hash_table_new_full (guid_hash_to_guint,
+                                          guid_g_hash_table_equal,
+                                          (GDestroyNotify) guid_free, NULL);
+            g_hash_table_insert (index->owners, guid_copy (&lo->owners[i]),
+                                 lots);
+        }
+        g_hash_table_add (lots, guid_copy (lot_guid));
+    }
+}
+
+static void
+lot_index_file_cb (QofInstance *inst, gpointer user_data)
+{
+    lot_index_file (user_data, GNC_LOT (inst));
+}
+
+static void
+lot_index_fill (OwnerLotIndex *index)
+{
+    g_hash_table_remove_all (index->owners);
+    g_hash_table_remove_all (index->lots);
+    qof_collection_foreach (qof_book_get_collection (index->book, GNC_ID_LOT),
+                            lot_index_file_cb, index);
+    index->stale = FALSE;
+}
+
+static void
+lot_index_destroy (QofBook *book, gpointer key, gpointer data)
+{
+    OwnerLotIndex *index = data;
+
+    g_hash_table_destroy (index->owners);
+    g_hash_table_destroy (index->lots);
+    g_free (index);
+}
+
+/* The index of the book, made on first use */
+static OwnerLotIndex *
+lot_index_get (QofBook *book)
+{
+    OwnerLotIndex *index = qof_book_get_data (book, OWNER_LOT_INDEX);
+
+    if (!index)
+    {
+        index = g_new0 (OwnerLotIndex, 1);
+        index->book = book;
+        index->owners = g_hash_table_new_full (guid_hash_to_guint,
+                                               guid_g_hash_table_equal,
+                                               (GDestroyNotify) guid_free,
+                                               (GDestroyNotify) g_hash_table_destroy);
+        index->lots = g_hash_table_new_full (guid_hash_to_guint,
+                                             guid_g_hash_table_equal,
+                                             (GDestroyNotify) guid_free,
+                                             g_free);
+        index->stale = TRUE;
+        qof_book_set_data_fin (book, OWNER_LOT_INDEX, index, lot_index_destroy);
+    }
+    if (index->stale)
+        lot_index_fill (index);
+    return index;
+}
+
+void
+gncOwnerLotIndexUpdate (GNCLot *lot)
+{
+    OwnerLotIndex *index;
+
+    if (!lot)
+        return;
+
+    /* Nothing to do before the index is made */
+    index = qof_book_get_data (gnc_lot_get_book (lot), OWNER_LOT_INDEX);
+    if (index && !index->stale)
+        lot_index_file (index, lot);
+}
+
+void
+gncOwnerLotIndexInvalidate (QofBook *book)
+{
+    OwnerLotIndex *index;
+
+    if (!book)
+        return;
+
+    index = qof_book_get_data (book, OWNER_LOT_INDEX);
+    if (index)
+        index->stale = TRUE;
+}
+
+static gint
+lot_index_seq_cmp (gconstpointer a, gconstpointer b, gpointer account)
+{
+    guint64 sa = gnc_account_get_lot_seq (account, (GNCLot *) a);
+    guint64 sb = gnc_account_get_lot_seq (account, (GNCLot *) b);
+
+    return sa < sb ? 1 : sa > sb ? -1 : 0;
+}
+
+GList *
+gncOwnerFindOpenLots (const GncOwner *owner, Account *account,
+                      gboolean (*match_func)(GNCLot *lot, gpointer user_data),
+                      gpointer user_data, GCompareFunc sort_func)
+{
+    OwnerLotIndex *index;
+    QofBook *book;
+    const GncGUID *guid;
+    GHashTable *lots;
+    GHashTableIter iter;
+    gpointer lot_guid;
+    GList *retval = NULL;
+
+    g_return_val_if_fail (owner, NULL);
+    g_return_val_if_fail (GNC_IS_ACCOUNT (account), NULL);
+
+    guid = gncOwnerGetGUID (owner);
+    if (!guid)
+        return NULL;
+
+    book = gnc_account_get_book (account);
+    index = lot_index_get (book);
+    lots = g_hash_table_lookup (index->owners, guid);
+    if (!lots)
+        return NULL;
+
+    g_hash_table_iter_init (&iter, lots);
+    while (g_hash_table_iter_next (&iter, &lot_guid, NULL))
+    {
+        GNCLot *lot = gnc_lot_lookup (lot_guid, book);
+
+        if (!lot || gnc_lot_get_account (lot) != account ||
+            gnc_lot_is_closed (lot))
+            continue;
+        if (match_func && !(match_func)(lot, user_data))
+            continue;
+        retval = g_list_prepend (retval, lot);
+    }
+
+    /* In the order xaccAccountFindOpenLots has them */
+    retval = g_list_sort_with_data (retval, lot_index_seq_cmp, account);
+    if (sort_func)
+        retval = g_list_sort (retval, sort_func);
+
+    return retval;
+}
+
+/* What of lot is posted up to date, FALSE if nothing is. */
+static gboolean
+lot_balance_as_of (GNCLot *lot, time64 date, gnc_numeric *balance)
+{
+    gboolean found = FALSE;
+    SplitList *node;
+
+    *balance = gnc_numeric_zero ();
+    for (node = gnc_lot_get_split_list (lot); node; node = node->next)
+    {
+        Split *split = node->data;
+
+        if (xaccTransGetDate (xaccSplitGetParent (split)) > date)
+            continue;
+        *balance = gnc_numeric_add_fixed (*balance, xaccSplitGetAmount (split));
+        found = TRUE;
+    }
+    return found;
+}
+
+static gint
+owner_aging_name_cmp (gconstpointer a, gconstpointer b)
+{
+    const GncOwnerAging *aa = a, *ab = b;
+
+    return safe_utf8_collate (gncOwnerGetName (&aa->owner),
+                              gncOwnerGetName (&ab->owner));
+}
+
+GList *
+gncOwnerGetAging (Account *account, time64 date, const time64 *bounds,
+                  guint n_bounds, gboolean use_due_date)
+{
+    OwnerLotIndex *index;
+    QofBook *book;
+    GHashTable *agings;
+    GHashTableIter iter;
+    gpointer lot_guid, aging;
+    GList *retval = NULL;
+
+    g_return_val_if_fail (GNC_IS_ACCOUNT (account), NULL);
+    g_return_val_if_fail (bounds || !n_bounds, NULL);
+
+    book = gnc_account_get_book (account);
+    index = lot_index_get (book);
+    /* End owner GUID -> GncOwnerAging, the GUIDs being the owners' */
+    agings = g_hash_table_new (guid_hash_to_guint, guid_g_hash_table_equal);
+
+    g_hash_table_iter_init (&iter, index->lots);
+    while (g_hash_table_iter_next (&iter, &lot_guid, NULL))
+    {
+        GNCLot *lot = gnc_lot_lookup (lot_guid, book);
+        GncInvoice *invoice;
+        GncOwner lot_owner;
+        const GncOwner *owner;
+        GncOwnerAging *owner_aging;
+        gnc_numeric balance;
+        guint bucket;
+
+        if (!lot || gnc_lot_get_account (lot) != account)
+            continue;
+
+        /* Filed under the invoice's owner if it has one, as payments
+         * are applied to the invoice and not to the lot's owner. */
+        invoice = gncInvoiceGetInvoiceFromLot (lot);
+        if (invoice)
+        {
+            Transaction *posted = gncInvoiceGetPostedTxn (invoice);
+            if (!posted || xaccTransGetDate (posted) > date)
+                continue;
+            owner = gncOwnerGetEndOwner (gncInvoiceGetOwner (invoice));
+        }
+        else if (gncOwnerGetOwnerFromLot (lot, &lot_owner))
+            owner = gncOwnerGetEndOwner (&lot_owner);
+        else
+            continue;
+        if (!gncOwnerIsValid (owner) ||
+            !lot_balance_as_of (lot, date, &balance))
+            continue;
+
+        owner_aging = g_hash_table_lookup (agings, gncOwnerGetGUID (owner));
+        if (!owner_aging)
+        {
+            guint i;
+
+            owner_aging = g_new0 (GncOwnerAging, 1);
+            gncOwnerCopy (owner, &owner_aging->owner);
+            owner_aging->n_buckets = n_bounds + 2;
+            owner_aging->buckets = g_new (gnc_numeric, n_bounds + 2);
+            for (i = 0; i < n_bounds + 2; i++)
+                owner_aging->buckets[i] = gnc_numeric_zero ();
+            owner_aging->total = gnc_numeric_zero ();
+            g_hash_table_insert (agings,
+                                 (gpointer) gncOwnerGetGUID (&owner_aging->owner),
+                                 owner_aging);
+        }
+
+        if (invoice)
+        {
+            time64 due = use_due_date ? gncInvoiceGetDateDue (invoice) :
+                                        gncInvoiceGetDatePosted (invoice);
+            for (bucket = 0; bucket < n_bounds && due >= bounds[bucket]; bucket++)
+                ;
+        }
+        else
+            bucket = n_bounds + 1; /* a prepayment */
+
+        owner_aging->buckets[bucket] =
+            gnc_numeric_add_fixed (owner_aging->buckets[bucket], balance);
+        owner_aging->total = gnc_numeric_add_fixed (owner_aging->total, balance);
+    }
+
+    g_hash_table_iter_init (&iter, agings);
+    while (g_hash_table_iter_next (&iter, NULL, &aging))
+        retval = g_list_prepend (retval, aging);
+    g_hash_table_destroy (agings);
+
+    return g_list_sort (retval, owner_aging_name_cmp);
+}
+
+void
+gncOwnerAgingFree (GList *agings)
+{
+    GList *node;
+
+    for (node = agings; node; node = node->next)
+    {
+        GncOwnerAging *aging = node->data;
+        g_free (aging->buckets);
+        g_free (aging);
+    }
+    g_list_free (agings);
+}
+
 gint
 gncOwnerLotsSortFunc (GNCLot *lotA, GNCLot *lotB)
 {
@@ -1428,8 +1809,9 @@ gncOwnerApplyPaymentSecs (const GncOwner *owner, Transaction **preset_txn,
     if (lots)
         selected_lots = lots;
     else if (auto_pay)
-        selected_lots = xaccAccountFindOpenLots (posted_acc, gncOwnerLotMatchOwnerFunc,
-                        (gpointer)owner, NULL);
+        selected_lots = gncOwnerFindOpenLots (owner, posted_acc,
+                                              gncOwnerLotMatchOwnerFunc,
+                                              (gpointer)owner, NULL);
 
     /* And link the selected lots and the payment lot together as well as possible.
      * If the payment was bigger than the selected documents/overpayments, only
@@ -1471,6 +1853,150 @@ gncOwnerGetCommoditiesList (const GncOwner *owner)
 /*********************************************************************/
 /* Owner balance calculation routines                                */
 
+typedef struct
+{
+    GHashTable *balances;       /* owner instance -> gnc_numeric */
+    gboolean    clear;
+} OwnerBalanceFill;
+
+static void
+owner_balances_dropped_free (QofBook *book, gpointer key, gpointer data)
+{
+    g_free (data);
+}
+
+static GNCAccountType
+owner_lot_account_type (const GncOwner *owner)
+{
+    switch (gncOwnerGetType (owner))
+    {
+    case GNC_OWNER_CUSTOMER:
+        return ACCT_TYPE_RECEIVABLE;
+    case GNC_OWNER_VENDOR:
+    case GNC_OWNER_EMPLOYEE:
+        return ACCT_TYPE_PAYABLE;
+    default:
+        return ACCT_TYPE_NONE;
+    }
+}
+
+static void
+owner_set_balance_cb (QofInstance *inst, gpointer user_data)
+{
+    OwnerBalanceFill *fill = user_data;
+    gnc_numeric *found;
+    GncOwner owner;
+    gnc_numeric balance;
+
+    qofOwnerSetEntity (&owner, inst);
+    if (fill->clear)
+    {
+        gncOwnerSetCachedBalance (&owner, NULL);
+        return;
+    }
+    if (gncOwnerGetCachedBalance (&owner))
+        return;
+
+    found = g_hash_table_lookup (fill->balances, inst);
+    balance = found ? *found : gnc_numeric_zero ();
+    gncOwnerSetCachedBalance (&owner, &balance);
+}
+
+static void
+owner_foreach_cacheable (QofBook *book, QofInstanceForeachCB cb,
+                         gpointer user_data)
+{
+    qof_collection_foreach (qof_book_get_collection (book, GNC_ID_CUSTOMER),
+                            cb, user_data);
+    qof_collection_foreach (qof_book_get_collection (book, GNC_ID_VENDOR),
+                            cb, user_data);
+    qof_collection_foreach (qof_book_get_collection (book, GNC_ID_EMPLOYEE),
+                            cb, user_data);
+}
+
+/* Compute the balances of all the customers, vendors and employees of
+ * the book without a cached one, and cache them.  Computing one owner's
+ * balance means going through the open lots of all its accounts anyway,
+ * so going through them once for all of the owners saves doing it again
+ * for each of them when a list of owners is shown. */
+static void
+owner_fill_cached_balances (QofBook *book)
+{
+    GList *acct_list = gnc_account_get_descendants (gnc_book_get_root_account (book));
+    GList *acct_node;
+    OwnerBalanceFill fill;
+    guint *dropped = qof_book_get_data (book, OWNER_BALANCES_DROPPED);
+
+    /* The lot changes of events that were dropped never cleared the
+     * cached balances they changed, so none of them can be trusted. */
+    fill.clear = TRUE;
+    if (!dropped)
+    {
+        dropped = g_new0 (guint, 1);
+        qof_book_set_data_fin (book, OWNER_BALANCES_DROPPED, dropped,
+                               owner_balances_dropped_free);
+        owner_foreach_cacheable (book, owner_set_balance_cb, &fill);
+    }
+    else if (*dropped != qof_event_get_dropped_count ())
+        owner_foreach_cacheable (book, owner_set_balance_cb, &fill);
+    *dropped = qof_event_get_dropped_count ();
+    fill.clear = FALSE;
+
+    fill.balances = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+                                           NULL, g_free);
+
+    /* The same lots, in the same order, as for each owner alone */
+    for (acct_node = acct_list; acct_node; acct_node = acct_node->next)
+    {
+        Account *account = acct_node->data;
+        GNCAccountType type = xaccAccountGetType (account);
+        gnc_commodity *commodity = xaccAccountGetCommodity (account);
+        GList *lot_list, *lot_node;
+
+        if (type != ACCT_TYPE_RECEIVABLE && type != ACCT_TYPE_PAYABLE)
+            continue;
+
+        lot_list = xaccAccountFindOpenLots (account, NULL, NULL, NULL);
+        for (lot_node = lot_list; lot_node; lot_node = lot_node->next)
+        {
+            GNCLot *lot = lot_node->data;
+            GncInvoice *invoice = gncInvoiceGetInvoiceFromLot (lot);
+            const GncOwner *end_owner;
+            QofInstance *inst;
+            gnc_numeric *balance;
+            gnc_commodity *owner_currency;
+
+            /* Only invoice lots make up the balance */
+            if (!invoice)
+                continue;
+
+            end_owner = gncOwnerGetEndOwner (gncInvoiceGetOwner (invoice));
+            inst = qofOwnerGetOwner (end_owner);
+            if (!inst || owner_lot_account_type (end_owner) != type)
+                continue;
+            owner_currency = gncOwnerGetCurrency (end_owner);
+            if (!gnc_commodity_equal (owner_currency, commodity))
+                continue;
+
+            balance = g_hash_table_lookup (fill.balances, inst);
+            if (!balance)
+            {
+                balance = g_new (gnc_numeric, 1);
+                *balance = gnc_numeric_zero ();
+                g_hash_table_insert (fill.balances, inst, balance);
+            }
+            *balance = gnc_numeric_add (*balance, gnc_lot_get_balance (lot),
+                                        gnc_commodity_get_fraction (owner_currency),
+                                        GNC_HOW_RND_ROUND_HALF_UP);
+        }
+        g_list_free (lot_list);
+    }
+    g_list_free (acct_list);
+
+    owner_foreach_cacheable (book, owner_set_balance_cb, &fill);
+    g_hash_table_destroy (fill.balances);
+}
+
 /*
  * Given an owner, extract the open balance from the owner and then
  * convert it to the desired currency.
@@ -1484,18 +2010,28 @@ gncOwnerGetBalanceInCurrency (const GncOwner *owner,
     gnc_commodity *owner_currency;
     GNCPriceDB *pdb;
     const gnc_numeric *cached_balance = NULL;
+    guint *dropped;
 
     g_return_val_if_fail (owner, gnc_numeric_zero ());
 
     book       = qof_instance_get_book (qofOwnerGetOwner (owner));
     owner_currency = gncOwnerGetCurrency (owner);
 
+    /* Balances may have been cached before events were dropped */
+    dropped = qof_book_get_data (book, OWNER_BALANCES_DROPPED);
     cached_balance = gncOwnerGetCachedBalance (owner);
+    if (!cached_balance || !dropped ||
+        *dropped != qof_event_get_dropped_count ())
+    {
+        owner_fill_cached_balances (book);
+        cached_balance = gncOwnerGetCachedBalance (owner);
+    }
+
     if (cached_balance)
         balance = *cached_balance;
     else
     {
-        /* No valid cache value found for balance. Let's recalculate */
+        /* Jobs have no cached balance. Let's calculate */
         GList *acct_list  = gnc_account_get_descendants (gnc_book_get_root_account (book));
         GList *acct_types = gncOwnerGetAccountTypesList (owner);
         GList *acct_node;
@@ -1516,8 +2052,9 @@ gncOwnerGetBalanceInCurrency (const GncOwner *owner,
                 continue;
 
             /* Get a list of open lots for this owner and account */
-            lot_list = xaccAccountFindOpenLots (account, gncOwnerLotMatchOwnerFunc,
-                                                (gpointer)owner, NULL);
+            lot_list = gncOwnerFindOpenLots (owner, account,
+                                             gncOwnerLotMatchOwnerFunc,
+                                             (gpointer)owner, NULL);
             /* For each lot */
             for (lot_node = lot_list; lot_node; lot_node = lot_node->next)
             {
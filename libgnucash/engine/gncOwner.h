@@ -186,6 +186,58 @@ void gncOwnerAttachToLot (const GncOwner *owner, GNCLot *lot);
  */
 gboolean gncOwnerLotMatchOwnerFunc (GNCLot *lot, gpointer user_data);
 
+/** Find the open lots of account that may be the owner's and that
+ * match_func, if given, accepts, sorted with sort_func if given, just as
+ * xaccAccountFindOpenLots (account, match_func, user_data, sort_func)
+ * does.  Only the lots whose invoice or own owner has the owner as its
+ * end owner are looked at, from an index kept with the book, so
+ * match_func must not accept any others.  gncOwnerLotMatchOwnerFunc with
+ * the owner is such a function.
+ */
+GList * gncOwnerFindOpenLots (const GncOwner *owner, Account *account,
+                              gboolean (*match_func)(GNCLot *lot,
+                                                     gpointer user_data),
+                              gpointer user_data, GCompareFunc sort_func);
+
+#ifndef SWIG
+/** What an owner owes or is owed in an A/R or A/P account at a date,
+ * by how old the debts are. */
+typedef struct
+{
+    GncOwner      owner;        /**< the end owner */
+    guint         n_buckets;
+    /** The balances of the invoices by their due or posted date: bucket
+     * i < n_bounds holds those dated before bounds[i] (and not before
+     * bounds[i - 1]), bucket n_bounds those dated on or after the last
+     * bound, and the last bucket the prepayments, what is left of the
+     * payments not applied to any invoice. */
+    gnc_numeric  *buckets;
+    gnc_numeric   total;        /**< of all the buckets */
+} GncOwnerAging;
+#endif /* SWIG */
+
+/** Age the debts of all the owners with lots in account, as of the end
+ * of the transactions posted up to and including date.  The lots are
+ * gone through once, from the index of owner lots; the balance of a lot
+ * is what of it is posted up to date, and that of an invoice lot counts
+ * if the invoice is posted by date.  The amounts are as they are in the
+ * account, so that debts to vendors are negative.
+ *
+ * @param bounds n_bounds dates, in increasing order.
+ *
+ * @param use_due_date TRUE to age invoices by their due date, FALSE to
+ * age them by their posted date.
+ *
+ * @return A list of GncOwnerAging, one per end owner with any lot in
+ * account posted by date, sorted by name, to be freed with
+ * gncOwnerAgingFree().
+ */
+GList * gncOwnerGetAging (Account *account, time64 date,
+                          const time64 *bounds, guint n_bounds,
+                          gboolean use_due_date);
+
+void gncOwnerAgingFree (GList *agings);
+
 /** Helper function used to sort lots by date. If the lot is
  * linked to an invoice, use the invoice posted date, otherwise
  * use the lot's opened date.
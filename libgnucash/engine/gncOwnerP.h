@@ -34,5 +34,13 @@ gboolean gncOwnerRegister (void);
 const gnc_numeric *gncOwnerGetCachedBalance (const GncOwner *owner);
 void gncOwnerSetCachedBalance (const GncOwner *owner, const gnc_numeric *new_bal);
 
+/* File the lot again in the index of owner lots of its book, after its
+ * invoice or its owner was set. */
+void gncOwnerLotIndexUpdate (GNCLot *lot);
+/* Rebuild the index of owner lots of the book when it is next used,
+ * after a change to the owners of lots that can't be told from them,
+ * like the owner of a job. */
+void gncOwnerLotIndexInvalidate (QofBook *book);
+
 
 #endif /* GNC_OWNERP_H_ */
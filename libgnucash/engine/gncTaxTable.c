@@ -33,6 +33,7 @@
 
 #include "gnc-features.h"
 #include "gncTaxTableP.h"
+#include "gncEntryP.h"
 
 struct _gncTaxTable
 {
@@ -40,6 +41,7 @@ struct _gncTaxTable
     char *          name;
     GncTaxTableEntryList*  entries;
     time64          modtime;      /* internal date of last modtime */
+    guint64         version;      /* bumped whenever modtime is set */
 
     /* See src/doc/business.txt for an explanation of the following */
     /* Code that handles this is *identical* to that in gncBillTerm */
@@ -166,6 +168,9 @@ static inline void
 mod_table (GncTaxTable *table)
 {
     table->modtime = gnc_time (NULL);
+    /* The modtime won't tell edits within a second apart */
+    table->version++;
+    gncEntryBumpValuesGeneration ();
 }
 
 static inline void addObj (GncTaxTable *table)
@@ -788,6 +793,12 @@ time64 gncTaxTableLastModifiedSecs (const GncTaxTable *table)
     return table->modtime;
 }
 
+guint64 gncTaxTableGetVersion (const GncTaxTable *table)
+{
+    if (!table) return 0;
+    return table->version;
+}
+
 gboolean gncTaxTableGetInvisible (const GncTaxTable *table)
 {
     if (!table) return FALSE;
@@ -40,6 +40,11 @@ void gncTaxTableMakeInvisible (GncTaxTable *table);
 
 gboolean gncTaxTableGetInvisible (const GncTaxTable *table);
 
+/* Changes whenever the entries of the table, thus the values of the
+ * entries using it, do; unlike gncTaxTableLastModifiedSecs(), even
+ * within the same second. */
+guint64 gncTaxTableGetVersion (const GncTaxTable *table);
+
 GncTaxTable* gncTaxTableEntryGetTable( const GncTaxTableEntry* entry );
 
 #define gncTaxTableSetGUID(E,G) qof_instance_set_guid(QOF_INSTANCE(E),(G))
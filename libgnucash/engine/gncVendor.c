@@ -35,6 +35,7 @@
 #include "gnc-commodity.h"
 #include "gncAddressP.h"
 #include "gncBillTermP.h"
+#include "gncBusinessP.h"
 #include "gncInvoice.h"
 #include "gncJobP.h"
 #include "gncTaxTableP.h"
@@ -462,6 +463,7 @@ GncVendor *gncVendorCreate (QofBook *book)
     qof_instance_init_data (&vendor->inst, _GNC_MOD_NAME, book);
 
     vendor->id = CACHE_INSERT ("");
+    gncBusinessIDIndexUpdate (&vendor->inst, vendor->id);
     vendor->name = CACHE_INSERT ("");
     vendor->notes = CACHE_INSERT ("");
     vendor->addr = gncAddressCreate (book, &vendor->inst);
@@ -491,6 +493,7 @@ static void gncVendorFree (GncVendor *vendor)
 
     qof_event_gen (&vendor->inst, QOF_EVENT_DESTROY, NULL);
 
+    gncBusinessIDIndexRemove (&vendor->inst);
     CACHE_REMOVE (vendor->id);
     CACHE_REMOVE (vendor->name);
     CACHE_REMOVE (vendor->notes);
@@ -526,6 +529,7 @@ void gncVendorSetID (GncVendor *vendor, const char *id)
     if (!vendor) return;
     if (!id) return;
     SET_STR(vendor, vendor->id, id);
+    gncBusinessIDIndexUpdate (&vendor->inst, vendor->id);
     mark_vendor (vendor);
     gncVendorCommitEdit (vendor);
 }
@@ -56,9 +56,19 @@ extern "C"
 #include <boost/uuid/uuid.hpp>
 #include <boost/uuid/uuid_generators.hpp>
 #include <boost/uuid/uuid_io.hpp>
+#include <boost/uuid/detail/random_provider.hpp>
+#include <array>
 #include <sstream>
 #include <string>
 
+#if defined(__SSE2__) || defined(_M_X64)
+# include <emmintrin.h>
+# define GUID_HEX_SSE2 1
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+# include <arm_neon.h>
+# define GUID_HEX_NEON 1
+#endif
+
 /* This static indicates the debugging module that this .o belongs to.  */
 static QofLogModule log_module = QOF_MOD_ENGINE;
 
@@ -161,13 +171,192 @@ guid_new_return (void)
     return gnc::GUID::create_random ();
 }
 
+namespace
+{
+/* Stamp random bytes as a version 4, RFC 4122 variant UUID, as
+ * boost::uuids::random_generator does. */
+void
+set_random_version (unsigned char * bytes) noexcept
+{
+    bytes[6] = (bytes[6] & 0x0F) | 0x40;
+    bytes[8] = (bytes[8] & 0x3F) | 0x80;
+}
+
+/* Every call of boost's random_generator asks the OS for 16 bytes of
+ * entropy. Instead each thread refills a buffer of GUIDs with one request
+ * and hands them out from there. */
+class GuidPool
+{
+public:
+    boost::uuids::uuid next ()
+    {
+        if (m_next == m_buffer.size ())
+        {
+            fill (m_buffer.data (), m_buffer.size ());
+            m_next = 0;
+        }
+        return m_buffer[m_next++];
+    }
+
+    void fill (void * out, std::size_t count)
+    {
+        auto bytes = static_cast<unsigned char*> (out);
+        m_provider.get_random_bytes (bytes, count * sizeof (GncGUID));
+        for (std::size_t i = 0; i < count; ++i)
+            set_random_version (bytes + i * sizeof (GncGUID));
+    }
+
+private:
+    static constexpr std::size_t batch_size = 64;
+    boost::uuids::detail::random_provider m_provider;
+    std::array<boost::uuids::uuid, batch_size> m_buffer;
+    std::size_t m_next = batch_size;
+};
+
+thread_local GuidPool guid_pool;
+}
+
+void
+guid_new_batch (GncGUID *guids, guint count)
+{
+    if (!guids || !count) return;
+    static_assert (sizeof (GncGUID) == sizeof (boost::uuids::uuid),
+                   "GncGUID must have the layout of a uuid");
+    guid_pool.fill (guids, count);
+}
+
+/* Hex encoding and decoding of the 16 GUID bytes as the 32 lower case
+ * digits that GnuCash writes everywhere. These run for every reference
+ * saved or loaded, so they use SSE2 or NEON where available. Decoding only
+ * handles exactly 32 hex digits; anything else (dashes, braces) is left to
+ * boost's string_generator.
+ */
+namespace
+{
+#if !defined(GUID_HEX_SSE2) && !defined(GUID_HEX_NEON)
+int
+hex_digit_value (char c) noexcept
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+#endif
+
+void
+guid_hex_encode (const unsigned char * bytes, char * out) noexcept
+{
+#if defined(GUID_HEX_SSE2)
+    auto v = _mm_loadu_si128 (reinterpret_cast<const __m128i*> (bytes));
+    auto low_nibble = _mm_set1_epi8 (0x0F);
+    auto hi = _mm_and_si128 (_mm_srli_epi16 (v, 4), low_nibble);
+    auto lo = _mm_and_si128 (v, low_nibble);
+    auto to_ascii = [](__m128i x)
+    {
+        /* '0' + x, plus 'a' - '0' - 10 for the letters. */
+        auto letters = _mm_cmpgt_epi8 (x, _mm_set1_epi8 (9));
+        x = _mm_add_epi8 (x, _mm_set1_epi8 ('0'));
+        return _mm_add_epi8 (x, _mm_and_si128 (letters, _mm_set1_epi8 (39)));
+    };
+    _mm_storeu_si128 (reinterpret_cast<__m128i*> (out),
+                      to_ascii (_mm_unpacklo_epi8 (hi, lo)));
+    _mm_storeu_si128 (reinterpret_cast<__m128i*> (out + 16),
+                      to_ascii (_mm_unpackhi_epi8 (hi, lo)));
+#elif defined(GUID_HEX_NEON)
+    auto v = vld1q_u8 (bytes);
+    auto digits = vzipq_u8 (vshrq_n_u8 (v, 4), vandq_u8 (v, vdupq_n_u8 (0x0F)));
+    auto to_ascii = [](uint8x16_t x)
+    {
+        auto letters = vcgtq_u8 (x, vdupq_n_u8 (9));
+        x = vaddq_u8 (x, vdupq_n_u8 ('0'));
+        return vaddq_u8 (x, vandq_u8 (letters, vdupq_n_u8 (39)));
+    };
+    vst1q_u8 (reinterpret_cast<uint8_t*> (out), to_ascii (digits.val[0]));
+    vst1q_u8 (reinterpret_cast<uint8_t*> (out + 16), to_ascii (digits.val[1]));
+#else
+    static const char hex[] = "0123456789abcdef";
+    for (int i = 0; i < GUID_DATA_SIZE; ++i)
+    {
+        out[2 * i] = hex[bytes[i] >> 4];
+        out[2 * i + 1] = hex[bytes[i] & 0x0F];
+    }
+#endif
+}
+
+/* Decodes exactly 32 hex digits of either case from in, which must have
+ * that many readable characters. out is only written on success. */
+bool
+guid_hex_decode (const char * in, unsigned char * out) noexcept
+{
+#if defined(GUID_HEX_SSE2)
+    auto zero = _mm_setzero_si128 ();
+    auto decode = [zero](__m128i c, __m128i & ok)
+    {
+        /* Unsigned saturation makes anything below '0' or 'a' fail too. */
+        auto d = _mm_sub_epi8 (c, _mm_set1_epi8 ('0'));
+        auto is_digit = _mm_cmpeq_epi8 (_mm_subs_epu8 (d, _mm_set1_epi8 (9)), zero);
+        auto l = _mm_sub_epi8 (_mm_or_si128 (c, _mm_set1_epi8 (0x20)),
+                               _mm_set1_epi8 ('a'));
+        auto is_letter = _mm_cmpeq_epi8 (_mm_subs_epu8 (l, _mm_set1_epi8 (5)), zero);
+        ok = _mm_or_si128 (is_digit, is_letter);
+        auto val = _mm_or_si128 (_mm_and_si128 (is_digit, d),
+                                 _mm_and_si128 (is_letter,
+                                                _mm_add_epi8 (l, _mm_set1_epi8 (10))));
+        /* Each 16-bit lane holds a high nibble in its low byte and a low
+         * nibble in its high byte; fold them into one byte value. */
+        return _mm_or_si128 (_mm_slli_epi16 (_mm_and_si128 (val, _mm_set1_epi16 (0x00FF)), 4),
+                             _mm_srli_epi16 (val, 8));
+    };
+    __m128i ok_a, ok_b;
+    auto a = decode (_mm_loadu_si128 (reinterpret_cast<const __m128i*> (in)), ok_a);
+    auto b = decode (_mm_loadu_si128 (reinterpret_cast<const __m128i*> (in + 16)), ok_b);
+    if (_mm_movemask_epi8 (_mm_and_si128 (ok_a, ok_b)) != 0xFFFF)
+        return false;
+    _mm_storeu_si128 (reinterpret_cast<__m128i*> (out), _mm_packus_epi16 (a, b));
+    return true;
+#elif defined(GUID_HEX_NEON)
+    /* De-interleave into the high nibble and low nibble characters. */
+    auto chars = vld2q_u8 (reinterpret_cast<const uint8_t*> (in));
+    auto decode = [](uint8x16_t c, uint8x16_t & ok)
+    {
+        auto d = vsubq_u8 (c, vdupq_n_u8 ('0'));
+        auto is_digit = vcleq_u8 (d, vdupq_n_u8 (9));
+        auto l = vsubq_u8 (vorrq_u8 (c, vdupq_n_u8 (0x20)), vdupq_n_u8 ('a'));
+        auto is_letter = vcleq_u8 (l, vdupq_n_u8 (5));
+        ok = vorrq_u8 (is_digit, is_letter);
+        return vbslq_u8 (is_digit, d, vaddq_u8 (l, vdupq_n_u8 (10)));
+    };
+    uint8x16_t ok_hi, ok_lo;
+    auto hi = decode (chars.val[0], ok_hi);
+    auto lo = decode (chars.val[1], ok_lo);
+    if (vminvq_u8 (vandq_u8 (ok_hi, ok_lo)) != 0xFF)
+        return false;
+    vst1q_u8 (out, vorrq_u8 (vshlq_n_u8 (hi, 4), lo));
+    return true;
+#else
+    unsigned char bytes[GUID_DATA_SIZE];
+    for (int i = 0; i < GUID_DATA_SIZE; ++i)
+    {
+        auto hi = hex_digit_value (in[2 * i]);
+        auto lo = hex_digit_value (in[2 * i + 1]);
+        if (hi < 0 || lo < 0)
+            return false;
+        bytes[i] = hi << 4 | lo;
+    }
+    memcpy (out, bytes, GUID_DATA_SIZE);
+    return true;
+#endif
+}
+}
+
 gchar *
 guid_to_string (const GncGUID * guid)
 {
     if (!guid) return nullptr;
-    gnc::GUID temp {*guid};
-    auto temp_str = temp.to_string ();
-    return g_strdup (temp_str.c_str ());
+    auto str = static_cast<gchar*> (g_malloc (GUID_ENCODING_LENGTH + 1));
+    guid_to_string_buff (guid, str);
+    return str;
 }
 
 gchar *
@@ -175,13 +364,9 @@ guid_to_string_buff (const GncGUID * guid, gchar *str)
 {
     if (!str || !guid) return NULL;
 
-    gnc::GUID temp {*guid};
-    auto val = temp.to_string ();
-    /*We need to be sure to copy the terminating null character.
-     * The standard guarantees that std::basic_string::c_str ()
-     * returns with a terminating null character, too.*/
-    std::copy (val.c_str (), val.c_str () + val.size () + 1, str);
-    return str + val.size ();
+    guid_hex_encode (guid->reserved, str);
+    str[GUID_ENCODING_LENGTH] = '\0';
+    return str + GUID_ENCODING_LENGTH;
 }
 
 gboolean
@@ -189,6 +374,10 @@ string_to_guid (const char * str, GncGUID * guid)
 {
     if (!guid || !str) return false;
 
+    if (strnlen (str, GUID_ENCODING_LENGTH + 1) == GUID_ENCODING_LENGTH &&
+        guid_hex_decode (str, guid->reserved))
+        return true;
+
     try
     {
         guid_assign (*guid, gnc::GUID::from_string (str));
@@ -318,8 +507,7 @@ namespace gnc
 GUID
 GUID::create_random () noexcept
 {
-    static boost::uuids::random_generator gen;
-    return {gen ()};
+    return {guid_pool.next ()};
 }
 
 GUID::GUID (boost::uuids::uuid const & other) noexcept
@@ -336,17 +524,18 @@ GUID::null_guid () noexcept
 std::string
 GUID::to_string () const noexcept
 {
-    auto const & val = boost::uuids::to_string (implementation);
-    std::string ret;
-    std::for_each (val.begin (), val.end (), [&ret] (char a) {
-        if (a != '-') ret.push_back (a);
-    });
+    std::string ret (GUID_ENCODING_LENGTH, '\0');
+    guid_hex_encode (implementation.data, &ret[0]);
     return ret;
 }
 
 GUID
 GUID::from_string (std::string const & str)
 {
+    boost::uuids::uuid ret;
+    if (str.size () == GUID_ENCODING_LENGTH &&
+        guid_hex_decode (str.data (), ret.data))
+        return ret;
     try
     {
         static boost::uuids::string_generator strgen;
@@ -361,6 +550,10 @@ GUID::from_string (std::string const & str)
 bool
 GUID::is_valid_guid (std::string const & str)
 {
+    unsigned char bytes[GUID_DATA_SIZE];
+    if (str.size () == GUID_ENCODING_LENGTH &&
+        guid_hex_decode (str.data (), bytes))
+        return true;
     try
     {
         static boost::uuids::string_generator strgen;
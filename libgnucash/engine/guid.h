@@ -96,6 +96,16 @@ void guid_replace (GncGUID *guid);
  */
 GncGUID guid_new_return (void);
 
+/** Generate count new ids at once.
+ *
+ * This fetches the entropy for all of them in one request, so importers
+ * and other bulk creators can preassign the ids of a whole batch.
+ *
+ * @param guids An array of at least count GncGUIDs to fill.
+ * @param count The number of ids to generate.
+ */
+void guid_new_batch (GncGUID *guids, guint count);
+
 /** Returns a GncGUID which is guaranteed to never reference any entity.
  * 
  * Do not free this value! The same pointer is returned on each call.*/
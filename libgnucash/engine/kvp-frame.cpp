@@ -39,27 +39,116 @@ extern "C"
 #include <algorithm>
 #include <vector>
 #include <numeric>
+#include <boost/pool/singleton_pool.hpp>
 
 /* This static indicates the debugging module that this .o belongs to.  */
 static QofLogModule log_module = "qof.kvp";
 
 static const char delim = '/';
 
+KvpFrameImpl::map_type::flat_type::const_iterator
+KvpFrameImpl::map_type::flat_lower_bound (const char * key) const noexcept
+{
+    return std::lower_bound (m_flat.begin (), m_flat.end (), key,
+        [](const value_type & a, const char * k)
+        {
+            return std::strcmp (a.first, k) < 0;
+        });
+}
+
+KvpValue *
+KvpFrameImpl::map_type::find (const char * key) const noexcept
+{
+    if (m_tree)
+    {
+        auto spot = m_tree->find (key);
+        return spot == m_tree->end () ? nullptr : spot->second;
+    }
+    auto spot = flat_lower_bound (key);
+    if (spot == m_flat.end () || std::strcmp (spot->first, key) != 0)
+        return nullptr;
+    return spot->second;
+}
+
+void
+KvpFrameImpl::map_type::insert (const char * key, KvpValue * value)
+{
+    if (!m_tree && m_flat.size () < flat_limit)
+    {
+        m_flat.insert (flat_lower_bound (key), value_type {key, value});
+        return;
+    }
+    if (!m_tree)
+    {
+        /* m_flat is sorted, so every element goes in at the end. */
+        m_tree = new tree_type;
+        for (auto const & a : m_flat)
+            m_tree->emplace_hint (m_tree->end (), a.first, a.second);
+        m_flat.clear ();
+        m_flat.shrink_to_fit ();
+    }
+    m_tree->emplace (key, value);
+}
+
+KvpFrameImpl::map_type::value_type
+KvpFrameImpl::map_type::remove (const char * key) noexcept
+{
+    value_type ret {nullptr, nullptr};
+    if (m_tree)
+    {
+        auto spot = m_tree->find (key);
+        if (spot != m_tree->end ())
+        {
+            ret = {spot->first, spot->second};
+            m_tree->erase (spot);
+        }
+        return ret;
+    }
+    auto spot = flat_lower_bound (key);
+    if (spot != m_flat.end () && std::strcmp (spot->first, key) == 0)
+    {
+        ret = *spot;
+        m_flat.erase (spot);
+    }
+    return ret;
+}
+
+void
+KvpFrameImpl::map_type::clear () noexcept
+{
+    delete m_tree;
+    m_tree = nullptr;
+    m_flat.clear ();
+}
+
+std::size_t
+KvpFrameImpl::map_type::container_bytes () const noexcept
+{
+    /* A tree node holds a slot, three links and its colour. */
+    if (m_tree)
+        return sizeof (tree_type) + m_tree->size () *
+            (sizeof (tree_type::value_type) + 4 * sizeof (void *));
+    /* The first few slots live in the frame itself. */
+    if (m_flat.capacity () > flat_inline)
+        return m_flat.capacity () * sizeof (value_type);
+    return 0;
+}
+
 KvpFrameImpl::KvpFrameImpl(const KvpFrameImpl & rhs) noexcept
 {
-    std::for_each(rhs.m_valuemap.begin(), rhs.m_valuemap.end(),
+    rhs.m_valuemap.for_each (
         [this](const map_type::value_type & a)
         {
             auto key = static_cast<char *>(qof_string_cache_insert(a.first));
             auto val = new KvpValueImpl(*a.second);
-            this->m_valuemap.insert({key,val});
+            this->m_valuemap.insert(key, val);
         }
     );
 }
 
 KvpFrameImpl::~KvpFrameImpl() noexcept
 {
-    std::for_each(m_valuemap.begin(), m_valuemap.end(),
+    m_valuemap.for_each (
 		 [](const map_type::value_type &a){
 		      qof_string_cache_remove(a.first);
 		      delete a.second;
@@ -68,15 +157,41 @@ KvpFrameImpl::~KvpFrameImpl() noexcept
     m_valuemap.clear();
 }
 
+struct KvpFramePoolTag {};
+using KvpFramePool = boost::singleton_pool<KvpFramePoolTag, sizeof(KvpFrameImpl)>;
+
+void*
+KvpFrameImpl::operator new (std::size_t size)
+{
+    if (size != sizeof(KvpFrameImpl))
+        return ::operator new (size);
+    auto ptr = KvpFramePool::malloc ();
+    if (!ptr)
+        throw std::bad_alloc ();
+    return ptr;
+}
+
+void
+KvpFrameImpl::operator delete (void* ptr, std::size_t size) noexcept
+{
+    if (!ptr)
+        return;
+    if (size != sizeof(KvpFrameImpl))
+        ::operator delete (ptr);
+    else
+        KvpFramePool::free (ptr);
+}
+
 KvpFrame *
 KvpFrame::get_child_frame_or_nullptr (Path const & path) noexcept
 {
     if (!path.size ())
         return this;
     auto key = path.front ();
-    if (m_valuemap.find (key.c_str ()) == m_valuemap.end ())
+    auto child_val = m_valuemap.find (key.c_str ());
+    if (!child_val)
         return nullptr;
-    auto child = m_valuemap.at (key.c_str ())->get <KvpFrame *> ();
+    auto child = child_val->get <KvpFrame *> ();
     Path send;
     std::copy (path.begin () + 1, path.end (), std::back_inserter (send));
     return child->get_child_frame_or_nullptr (send);
@@ -89,33 +204,36 @@ KvpFrame::get_child_frame_or_create (Path const & path) noexcept
         return this;
     auto key = path.front ();
     auto spot = m_valuemap.find (key.c_str ());
-    if (spot == m_valuemap.end () || spot->second->get_type () != KvpValue::Type::FRAME)
+    if (!spot || spot->get_type () != KvpValue::Type::FRAME)
         delete set_impl (key.c_str (), new KvpValue {new KvpFrame});
     Path send;
     std::copy (path.begin () + 1, path.end (), std::back_inserter (send));
-    auto child_val = m_valuemap.at (key.c_str ());
+    auto child_val = m_valuemap.find (key.c_str ());
     auto child = child_val->get <KvpFrame *> ();
     return child->get_child_frame_or_create (send);
 }
 
 
 KvpValue *
-KvpFrame::set_impl (std::string const & key, KvpValue * value) noexcept
+KvpFrame::set_impl (const char * key, KvpValue * value) noexcept
 {
-    KvpValue * ret {};
-    auto spot = m_valuemap.find (key.c_str ());
-    if (spot != m_valuemap.end ())
-    {
-        qof_string_cache_remove (spot->first);
-        ret = spot->second;
-        m_valuemap.erase (spot);
-    }
+    auto old = m_valuemap.remove (key);
+    if (old.first)
+        qof_string_cache_remove (old.first);
     if (value)
     {
-        auto cachedkey = static_cast <char const *> (qof_string_cache_insert (key.c_str ()));
-        m_valuemap.emplace (cachedkey, value);
+        auto cachedkey = static_cast <char const *> (qof_string_cache_insert (key));
+        m_valuemap.insert (cachedkey, value);
     }
-    return ret;
+    return old.second;
+}
+
+KvpValue *
+KvpFrameImpl::set (const char * key, KvpValue* value) noexcept
+{
+    if (!key)
+        return nullptr;
+    return set_impl (key, value);
 }
 
 KvpValue *
@@ -128,7 +246,7 @@ KvpFrameImpl::set (Path path, KvpValue* value) noexcept
     auto target = get_child_frame_or_nullptr (path);
     if (!target)
         return nullptr;
-    return target->set_impl (key, value);
+    return target->set_impl (key.c_str (), value);
 }
 
 KvpValue *
@@ -139,7 +257,7 @@ KvpFrameImpl::set_path (Path path, KvpValue* value) noexcept
     auto target = get_child_frame_or_create (path);
     if (!target)
         return nullptr;
-    return target->set_impl (key, value);
+    return target->set_impl (key.c_str (), value);
 }
 
 KvpValue *
@@ -150,10 +268,51 @@ KvpFrameImpl::get_slot (Path path) noexcept
     auto target = get_child_frame_or_nullptr (path);
     if (!target)
         return nullptr;
-    auto spot = target->m_valuemap.find (key.c_str ());
-    if (spot != target->m_valuemap.end ())
-        return spot->second;
-    return nullptr;
+    return target->m_valuemap.find (key.c_str ());
+}
+
+KvpValue *
+KvpFrameImpl::get_slot (const char * key) noexcept
+{
+    if (!key)
+        return nullptr;
+    return m_valuemap.find (key);
+}
+
+KvpValue *
+KvpFrameImpl::get_slot (const char * const * keys, std::size_t count) noexcept
+{
+    if (!count)
+        return nullptr;
+    auto target = this;
+    for (std::size_t i = 0; i + 1 < count; ++i)
+    {
+        auto child = target->m_valuemap.find (keys[i]);
+        if (!child || child->get_type () != KvpValue::Type::FRAME)
+            return nullptr;
+        target = child->get<KvpFrame*> ();
+    }
+    return target->m_valuemap.find (keys[count - 1]);
+}
+
+KvpValue *
+KvpFrameImpl::set_path (const char * const * keys, std::size_t count,
+                        KvpValue * value) noexcept
+{
+    if (!count)
+        return nullptr;
+    auto target = this;
+    for (std::size_t i = 0; i + 1 < count; ++i)
+    {
+        auto child = target->m_valuemap.find (keys[i]);
+        if (!child || child->get_type () != KvpValue::Type::FRAME)
+        {
+            child = new KvpValue {new KvpFrame};
+            delete target->set_impl (keys[i], child);
+        }
+        target = child->get<KvpFrame*> ();
+    }
+    return target->set_impl (keys[count - 1], value);
 }
 
 std::string
@@ -168,7 +327,7 @@ KvpFrameImpl::to_string(std::string const & prefix) const noexcept
     if (!m_valuemap.size())
         return prefix;
     std::ostringstream ret;
-    std::for_each(m_valuemap.begin(), m_valuemap.end(),
+    m_valuemap.for_each (
         [this,&ret,&prefix](const map_type::value_type &a)
         {
             std::string new_prefix {prefix};
@@ -190,7 +349,7 @@ std::vector<std::string>
 KvpFrameImpl::get_keys() const noexcept
 {
     std::vector<std::string> ret;
-    std::for_each(m_valuemap.begin(), m_valuemap.end(),
+    m_valuemap.for_each (
         [&ret](const KvpFrameImpl::map_type::value_type &a)
         {
             ret.push_back(a.first);
@@ -199,6 +358,19 @@ KvpFrameImpl::get_keys() const noexcept
     return ret;
 }
 
+void
+KvpFrameImpl::add_memory_usage(QofMemoryUsage & usage) const noexcept
+{
+    ++usage.kvp_frames;
+    usage.kvp_bytes += sizeof (KvpFrameImpl) + m_valuemap.container_bytes ();
+    m_valuemap.for_each (
+        [&usage](const KvpFrameImpl::map_type::value_type &a)
+        {
+            a.second->add_memory_usage (usage);
+        }
+    );
+}
+
 int compare(const KvpFrameImpl * one, const KvpFrameImpl * two) noexcept
 {
     if (one && !two) return 1;
@@ -216,18 +388,21 @@ int compare(const KvpFrameImpl * one, const KvpFrameImpl * two) noexcept
  */
 int compare(const KvpFrameImpl & one, const KvpFrameImpl & two) noexcept
 {
-    for (const auto & a : one.m_valuemap)
-    {
-        auto otherspot = two.m_valuemap.find(a.first);
-        if (otherspot == two.m_valuemap.end())
+    int comparison = 0;
+    one.m_valuemap.for_each (
+        [&two,&comparison](const KvpFrameImpl::map_type::value_type & a)
         {
-            return 1;
+            if (comparison != 0)
+                return;
+            auto otherspot = two.m_valuemap.find(a.first);
+            if (!otherspot)
+                comparison = 1;
+            else
+                comparison = compare(a.second, otherspot);
         }
-        auto comparison = compare(a.second,otherspot->second);
-
-        if (comparison != 0)
-            return comparison;
-    }
+    );
+    if (comparison != 0)
+        return comparison;
 
     if (one.m_valuemap.size() < two.m_valuemap.size())
         return -1;
@@ -427,7 +602,7 @@ gnc_value_list_get_type (void)
 void
 KvpFrame::flatten_kvp_impl(std::vector <std::string> path, std::vector <KvpEntry> & entries) const noexcept
 {
-    for (auto const & entry : m_valuemap)
+    m_valuemap.for_each ([&path,&entries](const map_type::value_type & entry)
     {
         std::vector<std::string> new_path {path};
         new_path.push_back("/");
@@ -441,7 +616,7 @@ KvpFrame::flatten_kvp_impl(std::vector <std::string> path, std::vector <KvpEntry
             new_path.emplace_back (entry.first);
             entries.emplace_back (new_path, entry.second);
         }
-    }
+    });
 }
 
 std::vector <KvpEntry>
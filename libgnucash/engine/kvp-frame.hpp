@@ -91,6 +91,8 @@
 #include <cstring>
 #include <algorithm>
 #include <iostream>
+#include <boost/pool/pool_alloc.hpp>
+#include <boost/container/small_vector.hpp>
 using Path = std::vector<std::string>;
 using KvpEntry = std::pair <std::vector <std::string>, KvpValue*>;
 
@@ -118,7 +120,65 @@ struct KvpFrameImpl
 		return ret;
 	    }
     };
-    using map_type = std::map<const char *, KvpValue*, cstring_comparer>;
+    /* The map nodes come from a pool shared by all frames. */
+    using map_allocator =
+        boost::fast_pool_allocator<std::pair<const char * const, KvpValue*>>;
+    using tree_type = std::map<const char *, KvpValue*, cstring_comparer,
+                               map_allocator>;
+
+    /**
+     * The slots of one frame, kept sorted by key.
+     *
+     * Most frames hold only a few slots, so they're stored in a flat sorted
+     * vector whose first few elements live inside the frame itself. Once a
+     * frame grows past flat_limit slots they're moved to a tree so that
+     * large frames (e.g. the import maps) don't pay for linear inserts.
+     * Either way iteration is in key order.
+     */
+    class map_type
+    {
+    public:
+        using value_type = std::pair<const char *, KvpValue*>;
+        static constexpr std::size_t flat_limit = 16;
+
+        map_type() noexcept = default;
+        map_type(const map_type &) = delete;
+        map_type & operator=(const map_type &) = delete;
+        ~map_type() noexcept { delete m_tree; }
+
+        bool empty() const noexcept { return size() == 0; }
+        std::size_t size() const noexcept
+        {
+            return m_tree ? m_tree->size() : m_flat.size();
+        }
+        /** @return The value at key or nullptr. */
+        KvpValue * find(const char * key) const noexcept;
+        /** Adds a slot; key must not already be present. */
+        void insert(const char * key, KvpValue * value);
+        /** Removes the slot at key, returning it or {nullptr, nullptr}. */
+        value_type remove(const char * key) noexcept;
+        void clear() noexcept;
+        /** The bytes taken by the slots outside the frame itself. */
+        std::size_t container_bytes() const noexcept;
+
+        template <typename func_type>
+        void for_each(func_type const & func) const
+        {
+            if (m_tree)
+                for (auto const & a : *m_tree)
+                    func(value_type{a.first, a.second});
+            else
+                for (auto const & a : m_flat)
+                    func(a);
+        }
+
+    private:
+        static constexpr std::size_t flat_inline = 3;
+        using flat_type = boost::container::small_vector<value_type, flat_inline>;
+        flat_type::const_iterator flat_lower_bound(const char *) const noexcept;
+        flat_type m_flat;
+        tree_type * m_tree {nullptr};
+    };
 
     public:
     KvpFrameImpl() noexcept {};
@@ -133,16 +193,24 @@ struct KvpFrameImpl
      */
     ~KvpFrameImpl() noexcept;
 
+    /**
+     * Frames are allocated from a pool like the values they hold.
+     */
+    static void* operator new (std::size_t size);
+    static void operator delete (void* ptr, std::size_t size) noexcept;
+
     /**
      * Set the value with the key in the immediate frame, replacing and
      * returning the old value if it exists or nullptr if it doesn't. Takes
      * ownership of new value and releases ownership of the returned old
      * value. Values must be allocated on the free store with operator new.
+     * This overload is also chosen for set({key}, value) with a single C
+     * string key, which saves building a Path for the common case.
      * @param key: The key to insert/replace.
      * @param newvalue: The value to set at key.
      * @return The old value if there was one or nullptr.
      */
-    //KvpValue* set(const char * key, KvpValue* newvalue) noexcept;
+    KvpValue* set(const char * key, KvpValue* newvalue) noexcept;
     /**
      * Set the value with the key in a subframe following the keys in path,
      * replacing and returning the old value if it exists or nullptr if it
@@ -169,6 +237,12 @@ struct KvpFrameImpl
      * @return The old value if there was one or nullptr.
      */
     KvpValue* set_path(Path path, KvpValue* newvalue) noexcept;
+    /**
+     * Like set_path(Path, KvpValue*) but with the path given as count C
+     * string keys, so that no Path is built.
+     */
+    KvpValue* set_path(const char * const * keys, std::size_t count,
+                       KvpValue* newvalue) noexcept;
     /**
      * Make a string representation of the frame. Mostly useful for debugging.
      * @return A std::string representing the frame and all its children.
@@ -193,6 +267,19 @@ struct KvpFrameImpl
      */
     KvpValue* get_slot(Path keys) noexcept;
 
+    /** Get the value at key in the immediate frame or nullptr if it doesn't
+     * exist. Like set(const char*, KvpValue*) this is chosen for get_slot({key})
+     * with a single C string key.
+     * @param key: The key of the desired value.
+     * @return The value at the key or nullptr.
+     */
+    KvpValue* get_slot(const char * key) noexcept;
+
+    /** Get the value at the path given as count C string keys or nullptr if
+     * it doesn't exist.
+     */
+    KvpValue* get_slot(const char * const * keys, std::size_t count) noexcept;
+
     /** The function should be of the form:
      * <anything> func (char const *, KvpValue *, data_type &);
      * Do not pass nullptr as the function.
@@ -224,6 +311,13 @@ struct KvpFrameImpl
      * @return true if the frame contains nothing.
      */
     bool empty() const noexcept { return m_valuemap.empty(); }
+
+    /**
+     * Adds the frame, its slots and their values, recursively, to usage's
+     * KVP tallies. The keys are in the string cache and aren't counted.
+     */
+    void add_memory_usage(QofMemoryUsage & usage) const noexcept;
+
     friend int compare(const KvpFrameImpl&, const KvpFrameImpl&) noexcept;
 
     private:
@@ -232,14 +326,14 @@ struct KvpFrameImpl
     KvpFrame * get_child_frame_or_nullptr (Path const &) noexcept;
     KvpFrame * get_child_frame_or_create (Path const &) noexcept;
     void flatten_kvp_impl(std::vector <std::string>, std::vector <KvpEntry> &) const noexcept;
-    KvpValue * set_impl (std::string const &, KvpValue *) noexcept;
+    KvpValue * set_impl (const char *, KvpValue *) noexcept;
 };
 
 template<typename func_type, typename data_type>
 void KvpFrame::for_each_slot_prefix(std::string const & prefix,
         func_type const & func, data_type & data) const noexcept
 {
-    std::for_each (m_valuemap.begin(), m_valuemap.end(),
+    m_valuemap.for_each (
         [&prefix,&func,&data](const KvpFrameImpl::map_type::value_type & a)
         {
             /* Testing for prefix matching */
@@ -252,7 +346,7 @@ void KvpFrame::for_each_slot_prefix(std::string const & prefix,
 template <typename func_type>
 void KvpFrame::for_each_slot_temp(func_type const & func) const noexcept
 {
-    std::for_each (m_valuemap.begin(), m_valuemap.end(),
+    m_valuemap.for_each (
         [&func](const KvpFrameImpl::map_type::value_type & a)
         {
             func (a.first, a.second);
@@ -263,7 +357,7 @@ void KvpFrame::for_each_slot_temp(func_type const & func) const noexcept
 template <typename func_type, typename data_type>
 void KvpFrame::for_each_slot_temp(func_type const & func, data_type & data) const noexcept
 {
-    std::for_each (m_valuemap.begin(), m_valuemap.end(),
+    m_valuemap.for_each (
         [&func,&data](const KvpFrameImpl::map_type::value_type & a)
         {
             func (a.first, a.second, data);
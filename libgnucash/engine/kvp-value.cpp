@@ -28,6 +28,32 @@
 #include <sstream>
 #include <iomanip>
 #include <stdexcept>
+#include <boost/pool/singleton_pool.hpp>
+
+struct KvpValuePoolTag {};
+using KvpValuePool = boost::singleton_pool<KvpValuePoolTag, sizeof(KvpValueImpl)>;
+
+void*
+KvpValueImpl::operator new (std::size_t size)
+{
+    if (size != sizeof(KvpValueImpl))
+        return ::operator new (size);
+    auto ptr = KvpValuePool::malloc ();
+    if (!ptr)
+        throw std::bad_alloc ();
+    return ptr;
+}
+
+void
+KvpValueImpl::operator delete (void* ptr, std::size_t size) noexcept
+{
+    if (!ptr)
+        return;
+    if (size != sizeof(KvpValueImpl))
+        ::operator delete (ptr);
+    else
+        KvpValuePool::free (ptr);
+}
 
 KvpValueImpl::KvpValueImpl(KvpValueImpl const & other) noexcept
 {
@@ -221,6 +247,51 @@ KvpValueImpl::to_string() const noexcept
     return to_string("");
 }
 
+struct memory_usage_visitor : boost::static_visitor<void>
+{
+    QofMemoryUsage & usage;
+
+    memory_usage_visitor(QofMemoryUsage & val) : usage(val){}
+
+    template <typename T> void
+    operator()(T const &) const { /* nothing outside the value */ }
+
+    void operator()(const char * const & val) const
+    {
+        if (val)
+            usage.kvp_bytes += strlen (val) + 1;
+    }
+
+    void operator()(GncGUID * const & val) const
+    {
+        if (val)
+            usage.kvp_bytes += sizeof (GncGUID);
+    }
+
+    void operator()(GList * const & val) const
+    {
+        for (auto node = val; node; node = node->next)
+        {
+            usage.kvp_bytes += sizeof (GList);
+            static_cast<const KvpValue *>(node->data)->add_memory_usage (usage);
+        }
+    }
+
+    void operator()(KvpFrame * const & val) const
+    {
+        if (val)
+            val->add_memory_usage (usage);
+    }
+};
+
+void
+KvpValueImpl::add_memory_usage(QofMemoryUsage & usage) const noexcept
+{
+    ++usage.kvp_values;
+    usage.kvp_bytes += sizeof (KvpValueImpl);
+    boost::apply_visitor (memory_usage_visitor {usage}, datastore);
+}
+
 static int
 kvp_glist_compare(const GList * list1, const GList * list2)
 {
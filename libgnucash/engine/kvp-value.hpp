@@ -106,6 +106,13 @@ struct KvpValueImpl
      */
     ~KvpValueImpl() noexcept;
 
+    /**
+     * KvpValues are allocated from a pool of equal-sized blocks, so the
+     * many small values made while loading a book are packed together.
+     */
+    static void* operator new (std::size_t size);
+    static void operator delete (void* ptr, std::size_t size) noexcept;
+
     /**
      * Replaces the frame within this KvpValueImpl.
      *
@@ -140,6 +147,12 @@ struct KvpValueImpl
     std::string to_string() const noexcept;
     std::string to_string(std::string const & prefix) const noexcept;
 
+    /**
+     * Adds the value and whatever it owns, strings, lists and frames, to
+     * usage's KVP tallies.
+     */
+    void add_memory_usage(QofMemoryUsage & usage) const noexcept;
+
     template <typename T>
     T get() const noexcept;
 
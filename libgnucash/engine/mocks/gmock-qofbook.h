@@ -34,6 +34,7 @@ public:
 
         cached_num_field_source_isvalid      = FALSE;
         cached_num_days_autoreadonly_isvalid = FALSE;
+        cached_features_isvalid              = FALSE;
     }
     void* operator new(size_t size)
     {
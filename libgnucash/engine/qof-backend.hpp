@@ -53,6 +53,7 @@ extern "C"
 #include "qofinstance-p.h"
 #include <string>
 #include <algorithm>
+#include <functional>
 #include <vector>
 /* NOTE: The following comments were musings by the original developer about how
  * some additional API might work. The compile/free/run_query functions were
@@ -212,6 +213,25 @@ public:
  *    better to wait for the query).
  */
     virtual void load (QofBook*, QofBackendLoadType) = 0;
+/**
+ *    Load the objects belonging to inst that the initial load left out,
+ *    e.g. an account's transactions.  The engine calls it the first time
+ *    it needs them.
+ */
+    virtual void load_on_demand (QofInstance*) {}
+/**
+ *    Load the objects that the query could find but the initial load left
+ *    out.  Called before the query is run over the book.
+ */
+    virtual void load_for_query (QofBook*, QofQuery*) {}
+/**
+ *    Whether others sharing the data store have changed it since the engine
+ *    was last brought up to date with it, which process_events() does.  The
+ *    user interface asks every few seconds.  process_events() returns true
+ *    if it changed the engine while engine events were suspended.
+ */
+    virtual bool events_pending() { return false; }
+    virtual bool process_events() { return false; }
 /**
  *    Called when the engine is about to make a change to a data structure. It
  *    could provide an advisory lock on data, but no backend does this.
@@ -225,6 +245,14 @@ public:
  *    Revert changes in the engine and unlock the backend.
  */
     virtual void rollback(QofInstance*) {}
+/**
+ *    Bracket a group of commits that belong together, e.g. the splits,
+ *    lot and transaction of a posted invoice, so that the backend can
+ *    store them in one go.  Calls don't nest; qof_book_begin_batch()
+ *    passes on only the outermost one.
+ */
+    virtual void begin_batch() {}
+    virtual void end_batch() {}
 /**
  *    Synchronizes the engine contents to the backend.
  *    This should done by using version numbers (hack alert -- the engine
@@ -246,6 +274,46 @@ public:
 /** Perform a sync in a way that prevents data loss on a DBI backend.
  */
     virtual void safe_sync(QofBook *) = 0;
+/** Start a sync that writes the data out on a worker thread, so that the
+ *  engine can be used meanwhile.  Whatever is needed from the book is
+ *  taken before this returns, and the book is marked saved; changes made
+ *  afterwards are left for the next sync.
+ *
+ *  done is called exactly once, from the worker, when the data is
+ *  written; the caller must then call finish_background_sync() from the
+ *  thread that started it.  Until then only finish_background_sync() may
+ *  be called; the other methods wait for the worker themselves.
+ *
+ *  @return false if the backend can't sync in the background, in which
+ *  case nothing was done and done isn't called.
+ */
+    virtual bool begin_background_sync(QofBook *, std::function<void()> done)
+    { return false; }
+/** Wait for the background sync to finish and report its errors as
+ *  sync() would.  Does nothing if there's none.
+ */
+    virtual void finish_background_sync() {}
+/** Copy a book into this backend while another backend reads it, instead
+ *  of reading it into memory whole and then calling sync().
+ *
+ *  begin_stream() empties the store as sync() would.  stream_instance()
+ *  writes an object the reader has finished with, so that the reader can
+ *  destroy it; end_stream() writes whatever is still in the book, or when
+ *  complete is false abandons the copy.
+ *
+ *  @return false from begin_stream() if the backend can't do this, in
+ *  which case nothing was done.
+ */
+    virtual bool begin_stream(QofBook *) { return false; }
+    virtual bool stream_instance(QofInstance *) { return false; }
+    virtual bool end_stream(QofBook *, bool complete) { return false; }
+/** Load a book as load() would, handing each object that nothing else in
+ *  the book needs to target's stream_instance() and then destroying it.
+ *
+ *  @return false if the backend can't load this way, in which case nothing
+ *  was read.
+ */
+    virtual bool load_streaming(QofBook *, QofBackend *target) { return false; }
 /**   Extract the chart of accounts from the current database and create a new
  *   database with it. Implemented only in the XML backend at present.
  */
@@ -37,99 +37,145 @@ extern "C"
 #include "qof.h"
 }
 
+#include <cstddef>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+
 /* Uncomment if you need to log anything.
 static QofLogModule log_module = QOF_MOD_UTIL;
 */
 /* =================================================================== */
 /* The QOF string cache                                                */
 /*                                                                     */
-/* The cache is a GHashTable where a copy of the string is the key,    */
-/* and a ref count is the value                                        */
+/* Each cached string lives in a single allocation together with its   */
+/* ref count.  The table maps a view of the cached characters to that  */
+/* entry, so a lookup hashes the string once and the entry's address   */
+/* never changes while it is referenced, which is what lets callers    */
+/* compare cached strings by pointer.  A mutex guards the table so     */
+/* that loader threads may insert and remove concurrently.             */
 /* =================================================================== */
 
-static GHashTable* qof_string_cache = NULL;
+struct StringCacheEntry
+{
+    guint refcount;
+    char str[1];
+};
+
+using StringCacheMap = std::unordered_map<std::string_view, StringCacheEntry*>;
 
-static GHashTable*
-qof_get_string_cache(void)
+static StringCacheMap* qof_string_cache = nullptr;
+static std::mutex qof_string_cache_mutex;
+
+static StringCacheEntry*
+string_cache_entry_new (std::string_view key)
+{
+    auto size = offsetof (StringCacheEntry, str) + key.size () + 1;
+    auto entry = static_cast<StringCacheEntry*> (g_malloc (size));
+    entry->refcount = 1;
+    memcpy (entry->str, key.data (), key.size ());
+    entry->str[key.size ()] = '\0';
+    return entry;
+}
+
+/* Must be called with qof_string_cache_mutex held. */
+static StringCacheMap&
+qof_get_string_cache (void)
 {
     if (!qof_string_cache)
-    {
-        qof_string_cache = g_hash_table_new_full(
-                               g_str_hash,               /* hash_func          */
-                               g_str_equal,              /* key_equal_func     */
-                               g_free,                   /* key_destroy_func   */
-                               g_free);                  /* value_destroy_func */
-    }
-    return qof_string_cache;
+        qof_string_cache = new StringCacheMap;
+    return *qof_string_cache;
 }
 
 void
-qof_string_cache_init(void)
+qof_string_cache_init (void)
 {
-    (void)qof_get_string_cache();
+    std::lock_guard<std::mutex> lock {qof_string_cache_mutex};
+    (void)qof_get_string_cache ();
 }
 
 void
 qof_string_cache_destroy (void)
 {
+    std::lock_guard<std::mutex> lock {qof_string_cache_mutex};
     if (qof_string_cache)
     {
-        g_hash_table_destroy(qof_string_cache);
+        for (auto& item : *qof_string_cache)
+            g_free (item.second);
+        delete qof_string_cache;
     }
-    qof_string_cache = NULL;
+    qof_string_cache = nullptr;
+}
+
+void
+qof_string_cache_reserve (guint count)
+{
+    std::lock_guard<std::mutex> lock {qof_string_cache_mutex};
+    auto& cache = qof_get_string_cache ();
+    cache.reserve (cache.size () + count);
+}
+
+void
+qof_string_cache_get_usage (guint *count, gsize *bytes)
+{
+    std::lock_guard<std::mutex> lock {qof_string_cache_mutex};
+    auto& cache = qof_get_string_cache ();
+    /* Each map node holds the view, the entry pointer, the next link
+     * and the cached hash. */
+    gsize total = cache.bucket_count () * sizeof (void*) +
+        cache.size () * (sizeof (StringCacheMap::value_type) +
+                         sizeof (void*) + sizeof (size_t));
+    for (auto& item : cache)
+        total += offsetof (StringCacheEntry, str) + item.first.size () + 1;
+    if (count)
+        *count = cache.size ();
+    if (bytes)
+        *bytes = total;
 }
 
 /* If the key exists in the cache, check the refcount.  If 1, just
  * remove the key.  Otherwise, decrement the refcount */
 void
-qof_string_cache_remove(const char * key)
+qof_string_cache_remove (const char * key)
 {
-    if (key)
+    if (!key)
+        return;
+
+    std::lock_guard<std::mutex> lock {qof_string_cache_mutex};
+    auto& cache = qof_get_string_cache ();
+    auto iter = cache.find (key);
+    if (iter == cache.end ())
+        return;
+
+    auto entry = iter->second;
+    if (--entry->refcount == 0)
     {
-        GHashTable* cache = qof_get_string_cache();
-        gpointer value;
-        gpointer cache_key;
-        if (g_hash_table_lookup_extended(cache, key, &cache_key, &value))
-        {
-            guint* refcount = (guint*)value;
-            if (*refcount == 1)
-            {
-                g_hash_table_remove(cache, key);
-            }
-            else
-            {
-                --(*refcount);
-            }
-        }
+        cache.erase (iter);
+        g_free (entry);
     }
 }
 
 /* If the key exists in the cache, increment the refcount.  Otherwise,
  * add it with a refcount of 1. */
 char *
-qof_string_cache_insert(const char * key)
+qof_string_cache_insert (const char * key)
 {
-    if (key)
+    if (!key)
+        return nullptr;
+
+    std::lock_guard<std::mutex> lock {qof_string_cache_mutex};
+    auto& cache = qof_get_string_cache ();
+    std::string_view view {key};
+    auto iter = cache.find (view);
+    if (iter != cache.end ())
     {
-        GHashTable* cache = qof_get_string_cache();
-        gpointer value;
-        gpointer cache_key;
-        if (g_hash_table_lookup_extended(cache, key, &cache_key, &value))
-        {
-            guint* refcount = (guint*)value;
-            ++(*refcount);
-            return static_cast <char *> (cache_key);
-        }
-        else
-        {
-            gpointer new_key = g_strdup(static_cast<const char*>(key));
-            guint* refcount = static_cast<unsigned int*>(g_malloc(sizeof(guint)));
-            *refcount = 1;
-            g_hash_table_insert(cache, new_key, refcount);
-            return static_cast <char *> (new_key);
-        }
+        ++iter->second->refcount;
+        return iter->second->str;
     }
-    return NULL;
+
+    auto entry = string_cache_entry_new (view);
+    cache.emplace (std::string_view {entry->str, view.size ()}, entry);
+    return entry->str;
 }
 
 char *
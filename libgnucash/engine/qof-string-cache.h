@@ -66,6 +66,14 @@ extern "C"
  * Note that all the work is done when inserting or removing.  Once
  * cached the strings are just plain C strings.
  *
+ * A cached string keeps its address for as long as it has references,
+ * so two strings returned by the cache are equal exactly when the
+ * pointers are equal; callers holding only cached strings may compare
+ * them with == instead of strcmp.
+ *
+ * Insert and remove may be called concurrently from several threads,
+ * e.g. by backend loaders.
+ *
  * The string cache is demand-created on first use.
  *
  **/
@@ -76,6 +84,17 @@ void qof_string_cache_init(void);
 /** Destroy the qof_string_cache */
 void qof_string_cache_destroy(void);
 
+/** Make room for count more strings than the cache now holds, so that a
+ * loader which knows roughly how many it is about to insert doesn't make
+ * the cache rehash repeatedly.  It's only a hint; later calls with a
+ * smaller count have no effect.
+ */
+void qof_string_cache_reserve(guint count);
+
+/** Report the number of strings in the cache and the approximate bytes
+ * it takes, the strings and the table. Either pointer may be NULL. */
+void qof_string_cache_get_usage(guint *count, gsize *bytes);
+
 /** You can use this function as a destroy notifier for a GHashTable
    that uses common strings as keys (or values, for that matter.)
 */
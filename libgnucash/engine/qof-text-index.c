@@ -0,0 +1,323 @@
+/********************************************************************\
+ * qof-text-index.c -- trigram indexes of the strings of objects     *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ *                                                                  *
+\********************************************************************/
+
+#include <config.h>
+
+#include <glib.h>
+#include <string.h>
+
+#include "qof.h"
+#include "qofquerycore-p.h"
+#include "qof-text-index.h"
+
+/* Compact the index when more than this many of its entries, and more
+ * than half of them, are for texts that are gone. */
+#define TEXT_INDEX_MIN_STALE 4096
+
+struct _QofTextIndex
+{
+    /* Trigram -> GPtrArray of the objects whose text has it, and of
+     * some whose text no longer does */
+    GHashTable *grams;
+    /* Object -> its text, from the string cache */
+    GHashTable *texts;
+    /* The objects whose text isn't plain ASCII.  Case insensitive
+     * matches fold those as UTF-8, so their trigrams can't be trusted
+     * for them. */
+    GHashTable *non_ascii;
+    guint entries;              /* in all of the lists of grams */
+    guint stale;                /* of those, the no longer needed ones */
+};
+
+static void
+text_index_string_free (gpointer text)
+{
+    qof_string_cache_remove (text);
+}
+
+static void
+text_index_list_free (gpointer list)
+{
+    g_ptr_array_free (list, TRUE);
+}
+
+static gint
+text_index_gram_cmp (gconstpointer a, gconstpointer b)
+{
+    guint32 ga = *(const guint32 *)a, gb = *(const guint32 *)b;
+    return ga < gb ? -1 : ga > gb;
+}
+
+/* Return the distinct trigrams of the ASCII lower cased text, in
+ * *n_grams.  None of them is 0, the text having no NULs. */
+static guint32 *
+text_index_grams (const char *text, guint *n_grams)
+{
+    gsize len = text ? strlen (text) : 0, i;
+    guint32 *grams;
+    guint n = 0;
+
+    *n_grams = 0;
+    if (len < 3)
+        return NULL;
+
+    grams = g_new (guint32, len - 2);
+    for (i = 0; i + 2 < len; i++)
+        grams[i] = (guint32)(guchar)g_ascii_tolower (text[i]) << 16 |
+                   (guint32)(guchar)g_ascii_tolower (text[i + 1]) << 8 |
+                   (guint32)(guchar)g_ascii_tolower (text[i + 2]);
+
+    qsort (grams, len - 2, sizeof (guint32), text_index_gram_cmp);
+    for (i = 0; i < len - 2; i++)
+        if (n == 0 || grams[i] != grams[n - 1])
+            grams[n++] = grams[i];
+
+    *n_grams = n;
+    return grams;
+}
+
+static guint
+text_index_count_grams (const char *text)
+{
+    guint n;
+    g_free (text_index_grams (text, &n));
+    return n;
+}
+
+static void
+text_index_add_grams (QofTextIndex *index, gpointer object, const char *text)
+{
+    guint n, i;
+    guint32 *grams = text_index_grams (text, &n);
+
+    for (i = 0; i < n; i++)
+    {
+        gpointer key = GUINT_TO_POINTER (grams[i]);
+        GPtrArray *list = g_hash_table_lookup (index->grams, key);
+
+        if (!list)
+        {
+            list = g_ptr_array_sized_new (1);
+            g_hash_table_insert (index->grams, key, list);
+        }
+        g_ptr_array_add (list, object);
+    }
+    index->entries += n;
+    g_free (grams);
+}
+
+static void
+text_index_compact (QofTextIndex *index)
+{
+    GHashTableIter iter;
+    gpointer object, text;
+
+    g_hash_table_remove_all (index->grams);
+    index->entries = index->stale = 0;
+
+    g_hash_table_iter_init (&iter, index->texts);
+    while (g_hash_table_iter_next (&iter, &object, &text))
+        text_index_add_grams (index, object, text);
+}
+
+static void
+text_index_maybe_compact (QofTextIndex *index)
+{
+    if (index->stale > TEXT_INDEX_MIN_STALE &&
+        index->stale > index->entries / 2)
+        text_index_compact (index);
+}
+
+static gboolean
+text_is_ascii (const char *text)
+{
+    for (; *text; text++)
+        if (*text & 0x80)
+            return FALSE;
+    return TRUE;
+}
+
+QofTextIndex *
+qof_text_index_new (void)
+{
+    QofTextIndex *index = g_new0 (QofTextIndex, 1);
+
+    index->grams = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+                                          NULL, text_index_list_free);
+    index->texts = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+                                          NULL, text_index_string_free);
+    index->non_ascii = g_hash_table_new (g_direct_hash, g_direct_equal);
+    return index;
+}
+
+void
+qof_text_index_destroy (QofTextIndex *index)
+{
+    if (!index)
+        return;
+
+    g_hash_table_destroy (index->grams);
+    g_hash_table_destroy (index->texts);
+    g_hash_table_destroy (index->non_ascii);
+    g_free (index);
+}
+
+void
+qof_text_index_set (QofTextIndex *index, gpointer object, const char *text)
+{
+    const char *old;
+
+    g_return_if_fail (index && object);
+
+    if (!text)
+        text = "";
+
+    old = g_hash_table_lookup (index->texts, object);
+    if (old && strcmp (old, text) == 0)
+        return;
+
+    /* The old text's entries stay until the next compaction */
+    if (old)
+        index->stale += text_index_count_grams (old);
+
+    g_hash_table_insert (index->texts, object, qof_string_cache_insert (text));
+    if (text_is_ascii (text))
+        g_hash_table_remove (index->non_ascii, object);
+    else
+        g_hash_table_add (index->non_ascii, object);
+
+    text_index_add_grams (index, object, text);
+    text_index_maybe_compact (index);
+}
+
+void
+qof_text_index_remove (QofTextIndex *index, gpointer object)
+{
+    const char *text;
+
+    g_return_if_fail (index);
+
+    text = g_hash_table_lookup (index->texts, object);
+    if (!text)
+        return;
+
+    /* Its entries stay until the next compaction too */
+    index->stale += text_index_count_grams (text);
+    g_hash_table_remove (index->texts, object);
+    g_hash_table_remove (index->non_ascii, object);
+    text_index_maybe_compact (index);
+}
+
+/* Return the shortest list of objects for a trigram of needle, NULL if
+ * one of its trigrams isn't in the index at all. */
+static GPtrArray *
+text_index_rarest_list (QofTextIndex *index, const char *needle)
+{
+    GPtrArray *best = NULL;
+    guint n, i;
+    guint32 *grams = text_index_grams (needle, &n);
+
+    for (i = 0; i < n; i++)
+    {
+        GPtrArray *list = g_hash_table_lookup (index->grams,
+                                               GUINT_TO_POINTER (grams[i]));
+        if (!list)
+        {
+            best = NULL;
+            break;
+        }
+        if (!best || list->len < best->len)
+            best = list;
+    }
+    g_free (grams);
+    return best;
+}
+
+gboolean
+qof_text_index_lookup (QofTextIndex *index, GSList *pred_data,
+                       QofInstanceForeachCB cb, gpointer user_data)
+{
+    GPtrArray *best = NULL;
+    gboolean found = FALSE, best_nocase = FALSE;
+    guint best_len = 0, i;
+    GSList *node;
+
+    g_return_val_if_fail (index, FALSE);
+
+    for (node = pred_data; node; node = node->next)
+    {
+        const query_string_t pdata = node->data;
+        const char *needle = NULL;
+        gboolean nocase = pdata->options == QOF_STRING_MATCH_CASEINSENSITIVE;
+        GPtrArray *list;
+        guint len;
+
+        if (g_strcmp0 (pdata->pd.type_name, QOF_TYPE_STRING) ||
+            pdata->is_regex)
+            continue;
+
+        /* A case insensitive match is found among the texts having the
+         * trigrams of the folded match string, if it is plain ASCII, or
+         * among the texts that aren't.  Equality of folded strings is a
+         * matter of collation, so that one can't be looked up. */
+        if (pdata->pd.how == QOF_COMPARE_CONTAINS)
+            needle = !nocase ? pdata->matchstring :
+                     pdata->folded_ascii ? pdata->folded : NULL;
+        else if (pdata->pd.how == QOF_COMPARE_EQUAL && !nocase)
+            needle = pdata->matchstring;
+
+        if (!needle || strlen (needle) < 3)
+            continue;
+
+        list = text_index_rarest_list (index, needle);
+        len = (list ? list->len : 0) +
+              (nocase ? g_hash_table_size (index->non_ascii) : 0);
+        if (!found || len < best_len)
+        {
+            found = TRUE;
+            best = list;
+            best_len = len;
+            best_nocase = nocase;
+        }
+    }
+    if (!found)
+        return FALSE;
+
+    for (i = 0; best && i < best->len; i++)
+    {
+        gpointer object = g_ptr_array_index (best, i);
+
+        /* The list may still have objects that are gone */
+        if (g_hash_table_contains (index->texts, object))
+            cb (object, user_data);
+    }
+    if (best_nocase)
+    {
+        GHashTableIter iter;
+        gpointer object;
+
+        g_hash_table_iter_init (&iter, index->non_ascii);
+        while (g_hash_table_iter_next (&iter, &object, NULL))
+            cb (object, user_data);
+    }
+    return TRUE;
+}
@@ -0,0 +1,74 @@
+/********************************************************************\
+ * qof-text-index.h -- trigram indexes of the strings of objects     *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ *                                                                  *
+\********************************************************************/
+/** @file qof-text-index.h
+ *  @brief Trigram indexes for string query terms
+ *
+ *  A QofTextIndex maps every three byte sequence of the ASCII lower
+ *  cased text of a string parameter to the objects having it, so that
+ *  the candidates for a "contains" term are those with the rarest
+ *  trigram of the match string rather than every object in the book.
+ *  It is meant for the QofQueryIndexFunc of the parameter.
+ *
+ *  The texts are set as they change, and a changed or removed text
+ *  leaves its old trigrams behind until there are enough of them to be
+ *  worth dropping, so keeping the index up to date is cheap.  The
+ *  index never dereferences the objects.
+ */
+
+#ifndef QOF_TEXT_INDEX_H
+#define QOF_TEXT_INDEX_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <glib.h>
+#include "qof.h"
+
+typedef struct _QofTextIndex QofTextIndex;
+
+QofTextIndex * qof_text_index_new (void);
+void qof_text_index_destroy (QofTextIndex *index);
+
+/** Index object under text, a NULL text being the empty string.
+ *  Setting the text it already has does nothing. */
+void qof_text_index_set (QofTextIndex *index, gpointer object,
+                         const char *text);
+
+/** Forget object, e.g. because it is being freed. */
+void qof_text_index_remove (QofTextIndex *index, gpointer object);
+
+/** Call cb for every object that may satisfy all of the string
+ *  predicates in pred_data, as a QofQueryIndexFunc does.  Only
+ *  "contains" matches, and case sensitive "equal" ones, of at least
+ *  three bytes can be answered; FALSE is returned, without calling cb,
+ *  if none of the predicates is one.
+ */
+gboolean qof_text_index_lookup (QofTextIndex *index, GSList *pred_data,
+                                QofInstanceForeachCB cb, gpointer user_data);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* QOF_TEXT_INDEX_H */
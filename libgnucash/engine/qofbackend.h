@@ -84,6 +84,7 @@ typedef enum
   contains invalid data in a field that is meant to hold a signed long integer or signed long long
   integer.
   */
+    ERR_BACKEND_CANCELLED,    /**< the operation was cancelled */
 
     /* fileio errors */
     ERR_FILEIO_FILE_BAD_READ = 1000,  /**< read failed or file prematurely truncated */
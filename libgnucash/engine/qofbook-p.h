@@ -81,6 +81,12 @@ gchar *qof_book_normalize_counter_format_internal(const gchar *p,
  */
 void qof_book_print_dirty (const QofBook *book);
 
+/** Add inst to the book's set of dirty instances or take it out.  This
+ *    is for QofInstance, which calls it whenever the flag changes.
+ */
+void qof_book_set_instance_dirty (QofBook *book, QofInstance *inst,
+                                  gboolean dirty);
+
 /* @} */
 /* @} */
 /* @} */
@@ -58,6 +58,7 @@ extern "C"
 #include "qofobject-p.h"
 #include "qofbookslots.h"
 #include "kvp-frame.hpp"
+#include "qof-backend.hpp"
 // For GNC_ID_ROOT_ACCOUNT:
 #include "AccountP.h"
 
@@ -141,8 +142,10 @@ qof_book_init (QofBook *book)
     book->read_only = FALSE;
     book->session_dirty = FALSE;
     book->version = 0;
+    book->archive_date = G_MININT64;
     book->cached_num_field_source_isvalid = FALSE;
     book->cached_num_days_autoreadonly_isvalid = FALSE;
+    book->cached_features_isvalid = FALSE;
 
     // Register a callback on this NUM_FIELD_SOURCE property of that object
     // because it gets called quite a lot, so that its value must be stored in
@@ -425,18 +428,26 @@ qof_book_destroy (QofBook *book)
 
     book->shutting_down = TRUE;
     qof_event_force (&book->inst, QOF_EVENT_DESTROY, NULL);
+    qof_event_batch_forget_book (book);
 
     /* Call the list of finalizers, let them do their thing.
      * Do this before tearing into the rest of the book.
      */
     g_hash_table_foreach (book->data_table_finalizers, book_final, book);
 
+    /* Everything in the book goes now.  The book's own destroy event
+     * above tells listeners so; don't send them one for each instance. */
+    qof_event_suspend ();
     qof_object_book_end (book);
+    qof_event_resume ();
 
     g_hash_table_destroy (book->data_table_finalizers);
     book->data_table_finalizers = NULL;
     g_hash_table_destroy (book->data_tables);
     book->data_tables = NULL;
+    if (book->dirty_instances)
+        g_hash_table_destroy (book->dirty_instances);
+    book->dirty_instances = NULL;
 
     /* qof_instance_release (&book->inst); */
 
@@ -500,12 +511,194 @@ qof_book_print_dirty (const QofBook *book)
     (book, (QofCollectionForeachCB)qof_collection_print_dirty, NULL);
 }
 
+gsize
+qof_memory_usage_total (const QofMemoryUsage *usage)
+{
+    g_return_val_if_fail (usage, 0);
+    return usage->instance_bytes + usage->kvp_bytes +
+        usage->list_nodes * sizeof (GList) + usage->other_bytes;
+}
+
+static void
+add_instance_memory_usage (QofInstance *inst, gpointer data)
+{
+    qof_instance_add_memory_usage (inst, static_cast<QofMemoryUsage*>(data));
+}
+
+static void
+add_collection_memory_usage (QofCollection *col, gpointer data)
+{
+    auto list = static_cast<GList**>(data);
+    auto type_usage = g_new0 (QofTypeMemoryUsage, 1);
+
+    type_usage->type = qof_collection_get_type (col);
+    type_usage->count = qof_collection_count (col);
+    type_usage->usage.other_bytes = qof_collection_get_memory_size (col);
+    qof_collection_foreach (col, add_instance_memory_usage, &type_usage->usage);
+    *list = g_list_prepend (*list, type_usage);
+}
+
+static gint
+compare_type_memory_usage (gconstpointer a, gconstpointer b)
+{
+    auto total_a = qof_memory_usage_total (&static_cast<const QofTypeMemoryUsage*>(a)->usage);
+    auto total_b = qof_memory_usage_total (&static_cast<const QofTypeMemoryUsage*>(b)->usage);
+    return total_a < total_b ? 1 : total_a > total_b ? -1 : 0;
+}
+
+GList *
+qof_book_get_memory_usage (const QofBook *book)
+{
+    GList *list = NULL;
+
+    g_return_val_if_fail (book, NULL);
+
+    qof_book_foreach_collection (book, add_collection_memory_usage, &list);
+    list = g_list_sort (list, compare_type_memory_usage);
+
+    auto book_usage = g_new0 (QofTypeMemoryUsage, 1);
+    book_usage->type = QOF_ID_BOOK;
+    book_usage->count = 1;
+    qof_instance_add_memory_usage (QOF_INSTANCE (book), &book_usage->usage);
+    book_usage->usage.other_bytes += g_hash_table_size (book->hash_of_collections) *
+        (2 * sizeof (gpointer) + sizeof (guint));
+    return g_list_prepend (list, book_usage);
+}
+
+void
+qof_book_memory_usage_free (GList *usage)
+{
+    g_list_free_full (usage, g_free);
+}
+
+gchar *
+qof_book_memory_report (const QofBook *book)
+{
+    QofTypeMemoryUsage total {};
+    guint strings;
+    gsize string_bytes;
+
+    g_return_val_if_fail (book, NULL);
+
+    auto usage = qof_book_get_memory_usage (book);
+    auto report = g_string_new (NULL);
+    g_string_append_printf (report, "%-20s %9s %12s %10s %10s %12s %10s %12s %12s\n",
+                            "type", "count", "instance", "kvp frames",
+                            "kvp values", "kvp bytes", "list nodes",
+                            "other", "total bytes");
+    auto add_line = [report](const QofTypeMemoryUsage *type_usage)
+    {
+        auto u = &type_usage->usage;
+        g_string_append_printf (report,
+                                "%-20s %9u %12" G_GSIZE_FORMAT
+                                " %10" G_GSIZE_FORMAT " %10" G_GSIZE_FORMAT
+                                " %12" G_GSIZE_FORMAT " %10" G_GSIZE_FORMAT
+                                " %12" G_GSIZE_FORMAT " %12" G_GSIZE_FORMAT "\n",
+                                type_usage->type, type_usage->count,
+                                u->instance_bytes, u->kvp_frames,
+                                u->kvp_values, u->kvp_bytes, u->list_nodes,
+                                u->other_bytes, qof_memory_usage_total (u));
+    };
+    for (auto node = usage; node; node = node->next)
+    {
+        auto type_usage = static_cast<QofTypeMemoryUsage*>(node->data);
+        if (!type_usage->count)
+            continue;
+        add_line (type_usage);
+        total.count += type_usage->count;
+        total.usage.instance_bytes += type_usage->usage.instance_bytes;
+        total.usage.kvp_frames += type_usage->usage.kvp_frames;
+        total.usage.kvp_values += type_usage->usage.kvp_values;
+        total.usage.kvp_bytes += type_usage->usage.kvp_bytes;
+        total.usage.list_nodes += type_usage->usage.list_nodes;
+        total.usage.other_bytes += type_usage->usage.other_bytes;
+    }
+    qof_book_memory_usage_free (usage);
+
+    total.type = "total";
+    add_line (&total);
+    qof_string_cache_get_usage (&strings, &string_bytes);
+    g_string_append_printf (report, "%-20s %9u %12s %10s %10s %12s %10s %12s %12"
+                            G_GSIZE_FORMAT "\n", "string cache", strings,
+                            "", "", "", "", "", "", string_bytes);
+    return g_string_free (report, FALSE);
+}
+
+void
+qof_book_set_instance_dirty (QofBook *book, QofInstance *inst, gboolean dirty)
+{
+    if (!book || !inst) return;
+    if (dirty)
+    {
+        if (!book->dirty_instances)
+            book->dirty_instances = g_hash_table_new (g_direct_hash,
+                                                      g_direct_equal);
+        g_hash_table_add (book->dirty_instances, inst);
+    }
+    else if (book->dirty_instances)
+        g_hash_table_remove (book->dirty_instances, inst);
+}
+
+gboolean
+qof_book_has_dirty_instances (const QofBook *book)
+{
+    if (!book || !book->dirty_instances) return FALSE;
+    return g_hash_table_size (book->dirty_instances) != 0;
+}
+
+GList *
+qof_book_get_dirty_instances (const QofBook *book)
+{
+    if (!book || !book->dirty_instances) return NULL;
+    return g_hash_table_get_keys (book->dirty_instances);
+}
+
+void
+qof_book_mark_instances_clean (QofBook *book)
+{
+    GHashTable *dirty;
+    GHashTableIter iter;
+    gpointer inst;
+
+    if (!book || !book->dirty_instances) return;
+
+    /* Marking an instance clean takes it out of the set; walk a
+     * detached set instead. */
+    dirty = book->dirty_instances;
+    book->dirty_instances = NULL;
+    g_hash_table_iter_init (&iter, dirty);
+    while (g_hash_table_iter_next (&iter, &inst, NULL))
+        qof_instance_mark_clean (QOF_INSTANCE (inst));
+    g_hash_table_destroy (dirty);
+}
+
 time64
 qof_book_get_session_dirty_time (const QofBook *book)
 {
     return book->dirty_time;
 }
 
+void
+qof_book_begin_batch (QofBook *book)
+{
+    g_return_if_fail (book);
+    if (book->backend_batch_level++ > 0)
+        return;
+    if (book->backend)
+        book->backend->begin_batch ();
+}
+
+void
+qof_book_end_batch (QofBook *book)
+{
+    g_return_if_fail (book);
+    g_return_if_fail (book->backend_batch_level > 0);
+    if (--book->backend_batch_level > 0)
+        return;
+    if (book->backend)
+        book->backend->end_batch ();
+}
+
 void
 qof_book_set_dirty_cb(QofBook *book, QofBookDirtyCB cb, gpointer user_data)
 {
@@ -534,9 +727,23 @@ qof_book_shutting_down (const QofBook *book)
     return book->shutting_down;
 }
 
+time64
+qof_book_get_archive_date (const QofBook *book)
+{
+    if (!book) return G_MININT64;
+    return book->archive_date;
+}
+
 /* ====================================================================== */
 /* setters */
 
+void
+qof_book_set_archive_date (QofBook *book, time64 date)
+{
+    if (!book) return;
+    book->archive_date = date;
+}
+
 void
 qof_book_set_backend (QofBook *book, QofBackend *be)
 {
@@ -1253,9 +1460,17 @@ qof_book_set_feature (QofBook *book, const gchar *key, const gchar *descr)
         delete frame->set_path({GNC_FEATURES, key}, new KvpValue(g_strdup (descr)));
         qof_instance_set_dirty (QOF_INSTANCE (book));
         qof_book_commit_edit (book);
+        book->cached_features_isvalid = FALSE;
     }
 }
 
+void
+qof_book_features_changed (QofBook *book)
+{
+    g_return_if_fail (book);
+    book->cached_features_isvalid = FALSE;
+}
+
 void
 qof_book_load_options (QofBook *book, GNCOptionLoad load_cb, GNCOptionDB *odb)
 {
@@ -161,6 +161,25 @@ struct _QofBook
     gint cached_num_days_autoreadonly;
     /* Whether the above cached value is valid. */
     gboolean cached_num_days_autoreadonly_isvalid;
+
+    /* The known features this book uses, one bit each, as computed and
+     * tested by gnc-features.c so that checking a feature doesn't walk
+     * the "features" frame. */
+    guint64 cached_features;
+    /* Whether the above cached value is valid; cleared by
+     * qof_book_features_changed(). */
+    gboolean cached_features_isvalid;
+
+    /* The set of this book's instances whose dirty flag is set, kept
+     * up to date by the QofInstance functions changing the flag. */
+    GHashTable *dirty_instances;
+
+    /* Nesting depth of qof_book_begin_batch(). */
+    gint backend_batch_level;
+
+    /* Transactions posted before this weren't loaded; G_MININT64 if all
+     * of them were. */
+    time64 archive_date;
 };
 
 struct _QofBookClass
@@ -234,6 +253,32 @@ QofCollection  * qof_book_get_collection (const QofBook *, QofIdType);
 typedef void (*QofCollectionForeachCB) (QofCollection *, gpointer user_data);
 void qof_book_foreach_collection (const QofBook *, QofCollectionForeachCB, gpointer);
 
+/** The memory used by all the objects of one type in a book. */
+typedef struct
+{
+    QofIdType type;        /**< Valid as long as the book is */
+    guint count;
+    QofMemoryUsage usage;  /**< other_bytes includes the collection */
+} QofTypeMemoryUsage;
+
+/** @return The approximate bytes in usage, with the list nodes. */
+gsize qof_memory_usage_total (const QofMemoryUsage *usage);
+
+/** Tally the memory used by the book and each type of object in it,
+ *  walking the collections.  This visits every object, so it takes
+ *  about as long as a scrub of the book.
+ *  @return A GList of QofTypeMemoryUsage, the book itself first and then
+ *  the types by descending total, to be freed with
+ *  qof_book_memory_usage_free(). */
+GList *qof_book_get_memory_usage (const QofBook *book);
+
+/** Free the list returned by qof_book_get_memory_usage(). */
+void qof_book_memory_usage_free (GList *usage);
+
+/** @return A table of qof_book_get_memory_usage() with a line for the
+ *  string cache shared by all books.  The caller must g_free() it. */
+gchar *qof_book_memory_report (const QofBook *book);
+
 /** The qof_book_set_data() allows arbitrary pointers to structs
  *    to be stored in QofBook. This is the "preferred" method for
  *    extending QofBook to hold new data types.  This is also
@@ -313,6 +358,16 @@ gboolean qof_book_use_split_action_for_num_field (const QofBook *book);
 /** Is the book shutting down? */
 gboolean qof_book_shutting_down (const QofBook *book);
 
+/** Returns the date before which the backend left the book's
+ * transactions unloaded, standing in for them with the accounts'
+ * starting balances, or G_MININT64 if every transaction is loaded.
+ * qof_session_ensure_all_data_loaded() loads the rest, as does running a
+ * query for transactions posted before then. */
+time64 qof_book_get_archive_date (const QofBook *book);
+
+/** Used by backends to record what qof_book_get_archive_date() returns. */
+void qof_book_set_archive_date (QofBook *book, time64 date);
+
 /** qof_book_not_saved() returns the value of the session_dirty flag,
  * set when changes to any object in the book are committed
  * (qof_backend->commit_edit has been called) and the backend hasn't
@@ -341,6 +396,26 @@ void qof_book_mark_session_dirty(QofBook *book);
 /** Retrieve the earliest modification time on the book. */
 time64 qof_book_get_session_dirty_time(const QofBook *book);
 
+/** Report whether any instance of the book has its dirty flag set,
+ *    i.e. has changes not yet committed to the backend. */
+gboolean qof_book_has_dirty_instances (const QofBook *book);
+
+/** Return the instances of the book whose dirty flag is set, in no
+ *    particular order.  The caller owns the list but not the instances
+ *    and must free it with g_list_free(). */
+GList * qof_book_get_dirty_instances (const QofBook *book);
+
+/** Clear the dirty flag of every instance of the book, e.g. after a
+ *    backend wrote them out. */
+void qof_book_mark_instances_clean (QofBook *book);
+
+/** Group the backend commits made until the matching
+ *    qof_book_end_batch(), so that the backend can store them together,
+ *    e.g. in one SQL transaction.  Each commit still reaches the backend
+ *    as it happens.  Batches nest; only the outermost one is passed on. */
+void qof_book_begin_batch (QofBook *book);
+void qof_book_end_batch (QofBook *book);
+
 /** Set the function to call when a book transitions from clean to
  *    dirty, or vice versa.
  */
@@ -383,6 +458,12 @@ void qof_book_option_frame_delete (QofBook *book, const char* opt_name);
 GHashTable *qof_book_get_features (QofBook *book);
 void qof_book_set_feature (QofBook *book, const gchar *key, const gchar *descr);
 
+/** Forget the cached set of features used by the book.  Setting a feature
+ *  does this itself; code filling the book's slots behind its back, like
+ *  the backends loading them, must call it afterwards.
+ */
+void qof_book_features_changed (QofBook *book);
+
 void qof_book_begin_edit(QofBook *book);
 void qof_book_commit_edit(QofBook *book);
 
@@ -34,9 +34,16 @@ typedef struct
     gpointer user_data;
 
     gint handler_id;
+    gchar *type;            /* NULL for handlers of every type */
+    QofEventId event_mask;
+    QofEventBatchHandler batch_handler;
 } HandlerInfo;
 
 /* generates an event even when events are suspended! */
 void qof_event_force (QofInstance *entity, QofEventId event_id, gpointer event_data);
 
+/* Drops the changes to instances of book from the running batch; the
+ * book is being destroyed and the instances won't outlive it. */
+void qof_event_batch_forget_book (QofBook *book);
+
 #endif
@@ -36,52 +36,88 @@ static guint   suspend_counter   = 0;
 static gint    next_handler_id   = 1;
 static guint   handler_run_level = 0;
 static guint   pending_deletes   = 0;
+static guint   dropped_events    = 0;
+static guint   batch_level       = 0;
+static guint   batch_handlers    = 0;
 static GList   *handlers  =   NULL;
+/* QofIdType -> GList of HandlerInfo, for handlers of a single type */
+static GHashTable *typed_handlers = NULL;
+/* The changes collected by a batch: a list of QofEventBatchEntry in the
+ * order they were first seen, and a map from each live entity to its
+ * entry. */
+static GList      *batch_entries = NULL;
+static GHashTable *batch_map = NULL;
 
 /* This static indicates the debugging module that this .o belongs to.  */
 static QofLogModule log_module = QOF_MOD_ENGINE;
 
 /* Implementations *************************************************/
 
+static gboolean
+handler_id_in_list (GList *list, gint handler_id)
+{
+    for (GList *node = list; node; node = node->next)
+    {
+        HandlerInfo *hi = static_cast<HandlerInfo*>(node->data);
+        if (hi->handler_id == handler_id)
+            return TRUE;
+    }
+    return FALSE;
+}
+
+static gboolean
+handler_id_in_use (gint handler_id)
+{
+    GHashTableIter iter;
+    gpointer value;
+
+    if (handler_id_in_list (handlers, handler_id))
+        return TRUE;
+    if (!typed_handlers)
+        return FALSE;
+
+    g_hash_table_iter_init (&iter, typed_handlers);
+    while (g_hash_table_iter_next (&iter, NULL, &value))
+        if (handler_id_in_list (static_cast<GList*>(value), handler_id))
+            return TRUE;
+    return FALSE;
+}
+
 static gint
 find_next_handler_id(void)
 {
-    HandlerInfo *hi;
     gint handler_id;
-    GList *node;
 
     /* look for a free handler id */
     handler_id = next_handler_id;
-    node = handlers;
+    while (handler_id_in_use (handler_id))
+        handler_id++;
 
-    while (node)
-    {
-        hi = static_cast<HandlerInfo*>(node->data);
-
-        if (hi->handler_id == handler_id)
-        {
-            handler_id++;
-            node = handlers;
-            continue;
-        }
-
-        node = node->next;
-    }
     /* Update id for next registration */
     next_handler_id = handler_id + 1;
     return handler_id;
 }
 
-gint
-qof_event_register_handler (QofEventHandler handler, gpointer user_data)
+static void
+handler_info_free (HandlerInfo *hi)
+{
+    g_free (hi->type);
+    g_free (hi);
+}
+
+static gint
+register_handler (QofIdTypeConst type, QofEventId event_mask,
+                  QofEventHandler handler, QofEventBatchHandler batch_handler,
+                  gpointer user_data)
 {
     HandlerInfo *hi;
     gint handler_id;
 
-    ENTER ("(handler=%p, data=%p)", handler, user_data);
+    ENTER ("(type=%s, mask=%x, handler=%p, data=%p)", type ? type : "(all)",
+           event_mask, handler, user_data);
 
     /* sanity check */
-    if (!handler)
+    if (!handler && !batch_handler)
     {
         PERR ("no handler specified");
         return 0;
@@ -96,52 +132,159 @@ qof_event_register_handler (QofEventHandler handler, gpointer user_data)
     hi->handler = handler;
     hi->user_data = user_data;
     hi->handler_id = handler_id;
+    hi->type = g_strdup (type);
+    hi->event_mask = event_mask;
+    hi->batch_handler = batch_handler;
+    if (batch_handler)
+        batch_handlers++;
+
+    if (type)
+    {
+        GList *list;
+
+        if (!typed_handlers)
+            typed_handlers = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                                    g_free, NULL);
+        list = static_cast<GList*>(g_hash_table_lookup (typed_handlers, type));
+        list = g_list_prepend (list, hi);
+        g_hash_table_replace (typed_handlers, g_strdup (type), list);
+    }
+    else
+        handlers = g_list_prepend (handlers, hi);
 
-    handlers = g_list_prepend (handlers, hi);
     LEAVE ("(handler=%p, data=%p) handler_id=%d", handler, user_data, handler_id);
     return handler_id;
 }
 
-void
-qof_event_unregister_handler (gint handler_id)
+gint
+qof_event_register_filtered_handler (QofIdTypeConst type, QofEventId event_mask,
+                                     QofEventHandler handler, gpointer user_data)
 {
-    GList *node;
-
-    ENTER ("(handler_id=%d)", handler_id);
-    for (node = handlers; node; node = node->next)
-    {
-        HandlerInfo *hi = static_cast<HandlerInfo*>(node->data);
+    return register_handler (type, event_mask, handler, NULL, user_data);
+}
 
-        if (hi->handler_id != handler_id)
-            continue;
+gint
+qof_event_register_handler (QofEventHandler handler, gpointer user_data)
+{
+    return register_handler (NULL, ~QOF_EVENT_NONE, handler, NULL, user_data);
+}
 
-        /* Normally, we could actually remove the handler's node from the
-           list, but we may be unregistering the event handler as a result
-           of a generated event, such as QOF_EVENT_DESTROY.  In that case,
-           we're in the middle of walking the GList and it is wrong to
-           modify the list. So, instead, we just NULL the handler. */
-        if (hi->handler)
-            LEAVE ("(handler_id=%d) handler=%p data=%p", handler_id,
-                   hi->handler, hi->user_data);
+gint
+qof_event_register_batch_handler (QofEventHandler handler,
+                                  QofEventBatchHandler batch_handler,
+                                  gpointer user_data)
+{
+    if (!batch_handler)
+    {
+        PERR ("no batch handler specified");
+        return 0;
+    }
+    return register_handler (NULL, ~QOF_EVENT_NONE, handler, batch_handler,
+                             user_data);
+}
 
-        /* safety -- clear the handler in case we're running events now */
-        hi->handler = NULL;
+/* Removes the NULLed handlers from list and returns its new head. */
+static GList *
+handler_list_purge (GList *list)
+{
+    GList *node, *next_node;
 
-        if (handler_run_level == 0)
+    for (node = list; node; node = next_node)
+    {
+        HandlerInfo *hi = static_cast<HandlerInfo*>(node->data);
+        next_node = node->next;
+        if (hi->handler == NULL && hi->batch_handler == NULL)
         {
-            handlers = g_list_remove_link (handlers, node);
+            /* remove this node from the list, then free this node */
+            list = g_list_remove_link (list, node);
             g_list_free_1 (node);
-            g_free (hi);
+            handler_info_free (hi);
         }
+    }
+    return list;
+}
+
+static void
+handlers_purge (void)
+{
+    GHashTableIter iter;
+    gpointer value;
+
+    handlers = handler_list_purge (handlers);
+    if (!typed_handlers)
+        return;
+
+    g_hash_table_iter_init (&iter, typed_handlers);
+    while (g_hash_table_iter_next (&iter, NULL, &value))
+    {
+        GList *list = handler_list_purge (static_cast<GList*>(value));
+        if (list)
+            g_hash_table_iter_replace (&iter, list);
         else
+            g_hash_table_iter_remove (&iter);
+    }
+}
+
+static HandlerInfo *
+find_handler (gint handler_id)
+{
+    GHashTableIter iter;
+    gpointer value;
+
+    for (GList *node = handlers; node; node = node->next)
+    {
+        HandlerInfo *hi = static_cast<HandlerInfo*>(node->data);
+        if (hi->handler_id == handler_id)
+            return hi;
+    }
+    if (!typed_handlers)
+        return NULL;
+
+    g_hash_table_iter_init (&iter, typed_handlers);
+    while (g_hash_table_iter_next (&iter, NULL, &value))
+        for (GList *node = static_cast<GList*>(value); node; node = node->next)
         {
-            pending_deletes++;
+            HandlerInfo *hi = static_cast<HandlerInfo*>(node->data);
+            if (hi->handler_id == handler_id)
+                return hi;
         }
+    return NULL;
+}
+
+void
+qof_event_unregister_handler (gint handler_id)
+{
+    HandlerInfo *hi;
 
+    ENTER ("(handler_id=%d)", handler_id);
+    hi = find_handler (handler_id);
+    if (!hi)
+    {
+        PERR ("no such handler: %d", handler_id);
         return;
     }
 
-    PERR ("no such handler: %d", handler_id);
+    /* Normally, we could actually remove the handler's node from the
+       list, but we may be unregistering the event handler as a result
+       of a generated event, such as QOF_EVENT_DESTROY.  In that case,
+       we're in the middle of walking the GList and it is wrong to
+       modify the list. So, instead, we just NULL the handler. */
+    if (hi->handler)
+        LEAVE ("(handler_id=%d) handler=%p data=%p", handler_id,
+               hi->handler, hi->user_data);
+
+    /* safety -- clear the handler in case we're running events now */
+    hi->handler = NULL;
+    if (hi->batch_handler)
+    {
+        hi->batch_handler = NULL;
+        batch_handlers--;
+    }
+
+    if (handler_run_level == 0)
+        handlers_purge ();
+    else
+        pending_deletes++;
 }
 
 void
@@ -167,13 +310,74 @@ qof_event_resume (void)
     suspend_counter--;
 }
 
+static const char *
+event_name (QofEventId event_id)
+{
+    switch (event_id)
+    {
+    case QOF_EVENT_CREATE:
+        return "create";
+    case QOF_EVENT_MODIFY:
+        return "modify";
+    case QOF_EVENT_DESTROY:
+        return "destroy";
+    case QOF_EVENT_ADD:
+        return "add";
+    case QOF_EVENT_REMOVE:
+        return "remove";
+    default:
+        return "other";
+    }
+}
+
+/* Handlers are only known by number; the address is for a debugger. */
 static void
-qof_event_generate_internal (QofInstance *entity, QofEventId event_id,
-                             gpointer event_data)
+trace_handler (gint64 start, gint handler_id, gpointer handler,
+               const char *what)
+{
+    auto name = g_strdup_printf ("handler %d", handler_id);
+    auto detail = g_strdup_printf ("%s, handler %p", what, handler);
+    qof_trace_span ("event", name, start, detail);
+    g_free (detail);
+    g_free (name);
+}
+
+static void
+run_handler_list (GList *list, QofInstance *entity, QofEventId event_id,
+                  gpointer event_data)
 {
     GList *node;
     GList *next_node = NULL;
 
+    for (node = list; node; node = next_node)
+    {
+        HandlerInfo *hi = static_cast<HandlerInfo*>(node->data);
+
+        next_node = node->next;
+        if (hi->handler && (hi->event_mask & event_id))
+        {
+            PINFO("id=%d hi=%p han=%p data=%p", hi->handler_id, hi,
+                  hi->handler, event_data);
+            /* The handler may unregister itself or destroy the entity. */
+            auto handler = hi->handler;
+            auto trace = qof_trace_now ();
+            auto type = entity->e_type;
+            handler (entity, event_id, hi->user_data, event_data);
+            if (trace)
+            {
+                auto what = g_strdup_printf ("%s %s", event_name (event_id),
+                                             type ? type : "");
+                trace_handler (trace, hi->handler_id, (gpointer)handler, what);
+                g_free (what);
+            }
+        }
+    }
+}
+
+static void
+qof_event_generate_internal (QofInstance *entity, QofEventId event_id,
+                             gpointer event_data)
+{
     g_return_if_fail(entity);
 
     switch (event_id)
@@ -186,18 +390,15 @@ qof_event_generate_internal (QofInstance *entity, QofEventId event_id,
     }
 
     handler_run_level++;
-    for (node = handlers; node; node = next_node)
+    /* Handlers registered while we run are prepended, so holding on to
+     * the list heads here keeps them out of this event as before. */
+    if (typed_handlers && entity->e_type)
     {
-        HandlerInfo *hi = static_cast<HandlerInfo*>(node->data);
-
-        next_node = node->next;
-        if (hi->handler)
-        {
-            PINFO("id=%d hi=%p han=%p data=%p", hi->handler_id, hi,
-                  hi->handler, event_data);
-            hi->handler (entity, event_id, hi->user_data, event_data);
-        }
+        GList *list = static_cast<GList*>(g_hash_table_lookup (typed_handlers,
+                                                               entity->e_type));
+        run_handler_list (list, entity, event_id, event_data);
     }
+    run_handler_list (handlers, entity, event_id, event_data);
     handler_run_level--;
 
     /* If we're the outermost event runner and we have pending deletes
@@ -205,20 +406,126 @@ qof_event_generate_internal (QofInstance *entity, QofEventId event_id,
      */
     if (handler_run_level == 0 && pending_deletes)
     {
-        for (node = handlers; node; node = next_node)
+        handlers_purge ();
+        pending_deletes = 0;
+    }
+}
+
+static void
+batch_record (QofInstance *entity, QofEventId event_id)
+{
+    QofEventBatchEntry *entry;
+    QofBook *book = qof_instance_get_book (entity);
+
+    /* A book going away frees its instances without telling anyone;
+     * nothing of it may be kept. */
+    if (event_id == QOF_EVENT_NONE || (book && qof_book_shutting_down (book)))
+        return;
+
+    if (!batch_map)
+        batch_map = g_hash_table_new (g_direct_hash, g_direct_equal);
+
+    entry = static_cast<QofEventBatchEntry*>(g_hash_table_lookup (batch_map,
+                                                                  entity));
+    if (!entry)
+    {
+        entry = g_new0 (QofEventBatchEntry, 1);
+        entry->entity = entity;
+        entry->guid = *qof_instance_get_guid (entity);
+        entry->type = entity->e_type;
+        entry->book = book;
+        batch_entries = g_list_prepend (batch_entries, entry);
+        g_hash_table_insert (batch_map, entity, entry);
+    }
+    entry->events |= event_id;
+
+    /* The entity is about to be freed and its address may be reused
+     * before the batch ends. */
+    if (event_id & QOF_EVENT_DESTROY)
+    {
+        g_hash_table_remove (batch_map, entity);
+        entry->entity = NULL;
+    }
+}
+
+static void
+batch_deliver (void)
+{
+    GList *changes = g_list_reverse (batch_entries);
+
+    batch_entries = NULL;
+    if (batch_map)
+        g_hash_table_remove_all (batch_map);
+    if (!changes)
+        return;
+
+    handler_run_level++;
+    for (GList *node = handlers; node; node = node->next)
+    {
+        HandlerInfo *hi = static_cast<HandlerInfo*>(node->data);
+        if (hi->batch_handler)
         {
-            HandlerInfo *hi = static_cast<HandlerInfo*>(node->data);
-            next_node = node->next;
-            if (hi->handler == NULL)
+            PINFO("id=%d hi=%p batch=%p", hi->handler_id, hi,
+                  hi->batch_handler);
+            auto handler = hi->batch_handler;
+            auto trace = qof_trace_now ();
+            handler (changes, hi->user_data);
+            if (trace)
             {
-                /* remove this node from the list, then free this node */
-                handlers = g_list_remove_link (handlers, node);
-                g_list_free_1 (node);
-                g_free (hi);
+                auto what = g_strdup_printf ("batch of %u", g_list_length (changes));
+                trace_handler (trace, hi->handler_id, (gpointer)handler, what);
+                g_free (what);
             }
         }
+    }
+    handler_run_level--;
+
+    if (handler_run_level == 0 && pending_deletes)
+    {
+        handlers_purge ();
         pending_deletes = 0;
     }
+    g_list_free_full (changes, g_free);
+}
+
+void
+qof_event_begin_batch (void)
+{
+    batch_level++;
+    qof_event_suspend ();
+}
+
+void
+qof_event_end_batch (void)
+{
+    if (batch_level == 0)
+    {
+        PERR ("batch level underflow");
+        return;
+    }
+
+    qof_event_resume ();
+    if (--batch_level == 0)
+        batch_deliver ();
+}
+
+void
+qof_event_batch_forget_book (QofBook *book)
+{
+    GList *node, *next_node;
+
+    for (node = batch_entries; node; node = next_node)
+    {
+        QofEventBatchEntry *entry = static_cast<QofEventBatchEntry*>(node->data);
+
+        next_node = node->next;
+        if (entry->book != book)
+            continue;
+        if (entry->entity)
+            g_hash_table_remove (batch_map, entry->entity);
+        batch_entries = g_list_delete_link (batch_entries, node);
+        g_free (entry);
+    }
 }
 
 void
@@ -237,9 +544,20 @@ qof_event_gen (QofInstance *entity, QofEventId event_id, gpointer event_data)
         return;
 
     if (suspend_counter)
+    {
+        dropped_events++;
+        if (batch_level && batch_handlers)
+            batch_record (entity, event_id);
         return;
+    }
 
     qof_event_generate_internal (entity, event_id, event_data);
 }
 
+guint
+qof_event_get_dropped_count (void)
+{
+    return dropped_events;
+}
+
 /* =========================== END OF FILE ======================= */
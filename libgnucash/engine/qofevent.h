@@ -98,6 +98,70 @@ typedef void (*QofEventHandler) (QofInstance *ent,  QofEventId event_type,
  */
 gint qof_event_register_handler (QofEventHandler handler, gpointer handler_data);
 
+/** \brief Register a handler for some events of a single type.
+ *
+ * The handler is only invoked for instances of the given type and only
+ * for events sharing a bit with event_mask, so the engine doesn't call
+ * it at all for everything else.  It's unregistered with
+ * qof_event_unregister_handler() like any other handler.
+ *
+ * @param type:  the type of instance to handle events for, or NULL for
+ *               every type
+ * @param event_mask: the events to handle, e.g. QOF_EVENT_MODIFY |
+ *               QOF_EVENT_DESTROY.  Application events made with
+ *               QOF_MAKE_EVENT() above QOF_EVENT_ALL must be listed
+ *               explicitly.
+ * @param handler:   handler to register
+ * @param handler_data: data provided when handler is invoked
+ *
+ * @return id identifying handler
+ */
+gint qof_event_register_filtered_handler (QofIdTypeConst type,
+                                          QofEventId event_mask,
+                                          QofEventHandler handler,
+                                          gpointer handler_data);
+
+/** \brief One instance's changes collected during an event batch. */
+typedef struct
+{
+    /** The changed instance, or NULL if it was destroyed during the
+     *  batch; guid and type still identify it. */
+    QofInstance *entity;
+    GncGUID guid;
+    QofIdType type;
+    QofBook *book;
+    /** Every event generated for the instance, or'd together. */
+    QofEventId events;
+} QofEventBatchEntry;
+
+/** \brief Handler invoked once at the end of an event batch.
+ *
+ * @param changes: a GList of QofEventBatchEntry, one per changed instance
+ *                 in the order of their first change.  It belongs to the
+ *                 engine and is only valid during the call.
+ * @param handler_data: data supplied when handler was registered.
+ */
+typedef void (*QofEventBatchHandler) (GList *changes, gpointer handler_data);
+
+/** \brief Register a handler that can also take batches of changes.
+ *
+ * handler is invoked for every event like one registered with
+ * qof_event_register_handler().  The events generated between
+ * qof_event_begin_batch() and qof_event_end_batch() are not sent to it;
+ * instead batch_handler gets the collected changes once the outermost
+ * batch ends.  The per-event data (e.g. the GncEventData of ADD and
+ * REMOVE events) isn't kept.
+ *
+ * @param handler:   handler for single events, may be NULL
+ * @param batch_handler: handler for batches of changes
+ * @param handler_data: data provided when either handler is invoked
+ *
+ * @return id identifying handler
+ */
+gint qof_event_register_batch_handler (QofEventHandler handler,
+                                       QofEventBatchHandler batch_handler,
+                                       gpointer handler_data);
+
 /** \brief Unregister an event handler.
  *
  * @param handler_id: the id of the handler to unregister
@@ -139,6 +203,27 @@ void qof_event_suspend (void);
 /** Resume engine event generation. */
 void qof_event_resume (void);
 
+/** The number of events not generated because events were suspended.
+ * Whoever keeps state up to date from the events can compare it to
+ * find out that it missed some. */
+guint qof_event_get_dropped_count (void);
+
+/** \brief Start a bulk operation.
+ *
+ * Suspends events like qof_event_suspend().  While batches are running
+ * the events that would have been dropped are also collected, one entry
+ * per instance, for the handlers registered with
+ * qof_event_register_batch_handler().  Batches can be nested.
+ */
+void qof_event_begin_batch (void);
+
+/** \brief End a bulk operation.
+ *
+ * Resumes events.  When the outermost batch ends, the collected changes
+ * are handed to each batch handler in a single call.
+ */
+void qof_event_end_batch (void);
+
 #ifdef __cplusplus
 }
 #endif
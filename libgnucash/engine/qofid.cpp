@@ -33,14 +33,143 @@ extern "C"
 #include "qofid-p.h"
 #include "qofinstance-p.h"
 
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
 static QofLogModule log_module = QOF_MOD_ENGINE;
 
+/* The entities of a collection, keyed by GUID.
+ *
+ * This is an open-addressing table with linear probing. Each slot holds a
+ * copy of the 16 GUID bytes next to the entity pointer, so a probe compares
+ * contiguous memory instead of chasing the entity's own GUID. GUIDs are
+ * random, so a multiplicative hash of their first word spreads them well.
+ * Removal shifts the following run back, so no tombstones accumulate.
+ */
+class GuidTable
+{
+public:
+    QofInstance * lookup (const GncGUID * guid) const noexcept
+    {
+        if (m_slots.empty ())
+            return nullptr;
+        for (auto i = home (guid); m_slots[i].ent; i = (i + 1) & mask ())
+            if (std::memcmp (&m_slots[i].guid, guid, sizeof (GncGUID)) == 0)
+                return m_slots[i].ent;
+        return nullptr;
+    }
+
+    /* Adds or replaces the entity at guid. */
+    void insert (const GncGUID * guid, QofInstance * ent)
+    {
+        if ((m_count + 1) * 4 > m_slots.size () * 3)
+            rehash (m_slots.empty () ? min_capacity : m_slots.size () * 2);
+        auto i = home (guid);
+        for (; m_slots[i].ent; i = (i + 1) & mask ())
+            if (std::memcmp (&m_slots[i].guid, guid, sizeof (GncGUID)) == 0)
+            {
+                m_slots[i].ent = ent;
+                return;
+            }
+        m_slots[i].guid = *guid;
+        m_slots[i].ent = ent;
+        ++m_count;
+    }
+
+    void remove (const GncGUID * guid) noexcept
+    {
+        if (m_slots.empty ())
+            return;
+        auto i = home (guid);
+        for (; m_slots[i].ent; i = (i + 1) & mask ())
+            if (std::memcmp (&m_slots[i].guid, guid, sizeof (GncGUID)) == 0)
+                break;
+        if (!m_slots[i].ent)
+            return;
+        /* Close the gap: move back any later slot in the run whose home
+         * isn't cyclically within (i, j]. */
+        for (auto j = (i + 1) & mask (); m_slots[j].ent; j = (j + 1) & mask ())
+        {
+            auto k = home (&m_slots[j].guid);
+            if (i <= j ? (i < k && k <= j) : (i < k || k <= j))
+                continue;
+            m_slots[i] = m_slots[j];
+            i = j;
+        }
+        m_slots[i].ent = nullptr;
+        --m_count;
+    }
+
+    /* Make room for count entities without rehashing. */
+    void reserve (std::size_t count)
+    {
+        auto capacity = m_slots.empty () ? min_capacity : m_slots.size ();
+        while (count * 4 > capacity * 3)
+            capacity *= 2;
+        if (capacity > m_slots.size ())
+            rehash (capacity);
+    }
+
+    std::size_t size () const noexcept { return m_count; }
+
+    std::size_t memory_size () const noexcept
+    {
+        return sizeof (*this) + m_slots.capacity () * sizeof (Slot);
+    }
+
+    std::vector<QofInstance*> values () const
+    {
+        std::vector<QofInstance*> ret;
+        ret.reserve (m_count);
+        for (auto const & slot : m_slots)
+            if (slot.ent)
+                ret.push_back (slot.ent);
+        return ret;
+    }
+
+private:
+    struct Slot
+    {
+        GncGUID guid;
+        QofInstance * ent;
+    };
+    static constexpr std::size_t min_capacity = 16;
+
+    std::size_t mask () const noexcept { return m_slots.size () - 1; }
+
+    std::size_t home (const GncGUID * guid) const noexcept
+    {
+        uint64_t word;
+        std::memcpy (&word, guid, sizeof (word));
+        return (word * UINT64_C (0x9E3779B97F4A7C15)) >> 32 & mask ();
+    }
+
+    void rehash (std::size_t capacity)
+    {
+        std::vector<Slot> old (capacity, Slot {{}, nullptr});
+        old.swap (m_slots);
+        for (auto const & slot : old)
+        {
+            if (!slot.ent)
+                continue;
+            auto i = home (&slot.guid);
+            while (m_slots[i].ent)
+                i = (i + 1) & mask ();
+            m_slots[i] = slot;
+        }
+    }
+
+    std::vector<Slot> m_slots;
+    std::size_t m_count = 0;
+};
+
 struct QofCollection_s
 {
     QofIdType    e_type;
     gboolean     is_dirty;
 
-    GHashTable * hash_of_entities;
+    GuidTable  * hash_of_entities;
     gpointer     data;       /* place where object class can hang arbitrary data */
 };
 
@@ -52,7 +181,7 @@ qof_collection_new (QofIdType type)
     QofCollection *col;
     col = g_new0(QofCollection, 1);
     col->e_type = static_cast<QofIdType>(CACHE_INSERT (type));
-    col->hash_of_entities = guid_hash_table_new();
+    col->hash_of_entities = new GuidTable;
     col->data = NULL;
     return col;
 }
@@ -61,7 +190,7 @@ void
 qof_collection_destroy (QofCollection *col)
 {
     CACHE_REMOVE (col->e_type);
-    g_hash_table_destroy(col->hash_of_entities);
+    delete col->hash_of_entities;
     col->e_type = NULL;
     col->hash_of_entities = NULL;
     col->data = NULL;   /** XXX there should be a destroy notifier for this */
@@ -89,7 +218,7 @@ qof_collection_remove_entity (QofInstance *ent)
     col = qof_instance_get_collection(ent);
     if (!col) return;
     guid = qof_instance_get_guid(ent);
-    g_hash_table_remove (col->hash_of_entities, guid);
+    col->hash_of_entities->remove (guid);
     qof_instance_set_collection(ent, NULL);
 }
 
@@ -103,7 +232,7 @@ qof_collection_insert_entity (QofCollection *col, QofInstance *ent)
     if (guid_equal(guid, guid_null())) return;
     g_return_if_fail (col->e_type == ent->e_type);
     qof_collection_remove_entity (ent);
-    g_hash_table_insert (col->hash_of_entities, (gpointer)guid, ent);
+    col->hash_of_entities->insert (guid, ent);
     qof_instance_set_collection(ent, col);
 }
 
@@ -129,7 +258,7 @@ qof_collection_add_entity (QofCollection *coll, QofInstance *ent)
     {
         return FALSE;
     }
-    g_hash_table_insert (coll->hash_of_entities, (gpointer)guid, ent);
+    coll->hash_of_entities->insert (guid, ent);
     return TRUE;
 }
 
@@ -213,12 +342,9 @@ qof_collection_compare (QofCollection *target, QofCollection *merge)
 QofInstance *
 qof_collection_lookup_entity (const QofCollection *col, const GncGUID * guid)
 {
-    QofInstance *ent;
     g_return_val_if_fail (col, NULL);
     if (guid == NULL) return NULL;
-    ent = static_cast<QofInstance*>(g_hash_table_lookup (col->hash_of_entities,
-							 guid));
-    return ent;
+    return col->hash_of_entities->lookup (guid);
 }
 
 QofCollection *
@@ -246,10 +372,24 @@ qof_collection_count (const QofCollection *col)
 {
     guint c;
 
-    c = g_hash_table_size(col->hash_of_entities);
+    c = col->hash_of_entities->size ();
     return c;
 }
 
+gsize
+qof_collection_get_memory_size (const QofCollection *col)
+{
+    g_return_val_if_fail (col, 0);
+    return sizeof (*col) + col->hash_of_entities->memory_size ();
+}
+
+void
+qof_collection_reserve (QofCollection *col, guint count)
+{
+    g_return_if_fail (col);
+    col->hash_of_entities->reserve (count);
+}
+
 /* =============================================================== */
 
 gboolean
@@ -303,40 +443,19 @@ qof_collection_set_data (QofCollection *col, gpointer user_data)
 
 /* =============================================================== */
 
-struct _qofid_iterate
-{
-    QofInstanceForeachCB      fcn;
-    gpointer                data;
-};
-
-static void
-foreach_cb (gpointer item, gpointer arg)
-{
-    struct _qofid_iterate *iter = static_cast<_qofid_iterate*>(arg);
-    QofInstance *ent = static_cast<QofInstance*>(item);
-
-    iter->fcn (ent, iter->data);
-}
-
 void
 qof_collection_foreach (const QofCollection *col, QofInstanceForeachCB cb_func,
                         gpointer user_data)
 {
-    struct _qofid_iterate iter;
-    GList *entries;
-
     g_return_if_fail (col);
     g_return_if_fail (cb_func);
 
-    iter.fcn = cb_func;
-    iter.data = user_data;
-
-    PINFO("Hash Table size of %s before is %d", col->e_type, g_hash_table_size(col->hash_of_entities));
+    PINFO("Hash Table size of %s before is %zu", col->e_type, col->hash_of_entities->size ());
 
-    entries = g_hash_table_get_values (col->hash_of_entities);
-    g_list_foreach (entries, foreach_cb, &iter);
-    g_list_free (entries);
+    /* Work on a copy, the callback may add or remove entities. */
+    for (auto ent : col->hash_of_entities->values ())
+        cb_func (ent, user_data);
 
-    PINFO("Hash Table size of %s after is %d", col->e_type, g_hash_table_size(col->hash_of_entities));
+    PINFO("Hash Table size of %s after is %zu", col->e_type, col->hash_of_entities->size ());
 }
 /* =============================================================== */
@@ -132,6 +132,14 @@ QofCollection * qof_collection_new (QofIdType type);
 /** return the number of entities in the collection. */
 guint qof_collection_count (const QofCollection *col);
 
+/** return the approximate bytes taken by the collection and its table of
+ *  entities, but not by the entities themselves. */
+gsize qof_collection_get_memory_size (const QofCollection *col);
+
+/** Make room for count entities in the collection, so that loading a
+ *  known number of them doesn't grow the table repeatedly. */
+void qof_collection_reserve (QofCollection *col, guint count);
+
 /** destroy the collection */
 void qof_collection_destroy (QofCollection *col);
 
@@ -71,6 +71,11 @@ void qof_instance_copy_guid (gpointer to, gconstpointer from);
 /** Return the pointer to the kvp_data */
 /*@ dependent @*/
 KvpFrame* qof_instance_get_slots (const QofInstance *);
+/** Free the instance's kvp frame if it holds no slots.  The frame is
+ *  recreated on the next slot access, so object types with many
+ *  instances that seldom use kvp can call this from their init
+ *  function to save the allocation. */
+void qof_instance_release_empty_slots (QofInstance *inst);
 void qof_instance_set_editlevel(gpointer inst, gint level);
 void qof_instance_increase_editlevel (gpointer ptr);
 void qof_instance_decrease_editlevel (gpointer ptr);
@@ -134,6 +139,43 @@ void qof_instance_set_kvp (QofInstance *, GValue const * value, unsigned count,
  */
 void qof_instance_get_kvp (QofInstance *, GValue * value, unsigned count, ...);
 
+#define QOF_KVP_PATH_MAX_DEPTH 4
+
+/** A KVP path whose keys are fixed C strings, for slots that are read on
+ * hot paths. Declare one per slot, e.g.
+ *
+ *     static const QofKvpPath notes_path = {1, {"notes"}};
+ *
+ * and pass it to the _at functions below. They walk the frames with the
+ * keys as given, so unlike qof_instance_get_kvp nothing is built per call.
+ */
+typedef struct
+{
+    unsigned count;
+    const char *keys[QOF_KVP_PATH_MAX_DEPTH];
+} QofKvpPath;
+
+/** Like qof_instance_set_kvp, but with a QofKvpPath. */
+void qof_instance_set_kvp_at (QofInstance *, GValue const * value,
+                              const QofKvpPath *path);
+
+/** Like qof_instance_get_kvp, but with a QofKvpPath. */
+void qof_instance_get_kvp_at (const QofInstance *, GValue * value,
+                              const QofKvpPath *path);
+
+/** Retrieves a string slot without copying it.
+ * @return The string in the slot, owned by the instance and valid until the
+ * slot is next changed, or NULL if the slot is missing or not a string.
+ */
+const char * qof_instance_get_kvp_string_at (const QofInstance *,
+                                             const QofKvpPath *path);
+
+/** Retrieves a GncGUID slot without copying it, with the same lifetime as
+ * qof_instance_get_kvp_string_at.
+ */
+const GncGUID * qof_instance_get_kvp_guid_at (const QofInstance *,
+                                              const QofKvpPath *path);
+
 /** @} Close out the DOxygen ingroup */
 /* Functions to isolate the KVP mechanism inside QOF for cases where
 GValue * operations won't work.
@@ -183,7 +225,7 @@ template<typename func_type, typename data_type>
 void qof_instance_foreach_slot_prefix(QofInstance const * inst, std::string const & path_prefix,
         func_type const & func, data_type & data)
 {
-    inst->kvp_data->for_each_slot_prefix(path_prefix, func, data);
+    qof_instance_get_slots(inst)->for_each_slot_prefix(path_prefix, func, data);
 }
 
 #endif
@@ -114,6 +114,39 @@ typedef struct QofInstancePrivate
 #define GET_PRIVATE(o)  \
     ((QofInstancePrivate*)g_type_instance_get_private((GTypeInstance*)o, QOF_TYPE_INSTANCE))
 
+/* Every change of the dirty flag goes through here so that the book's
+ * set of dirty instances stays accurate. */
+static void
+instance_set_dirty (QofInstance *inst, QofInstancePrivate *priv, gboolean dirty)
+{
+    dirty = dirty ? TRUE : FALSE;
+    if (priv->dirty == dirty)
+        return;
+    priv->dirty = dirty;
+    qof_book_set_instance_dirty (priv->book, inst, dirty);
+}
+
+/* Instances that rarely carry slots (e.g. prices) may release their empty
+ * frame; it is recreated here the first time anything touches the slots. */
+static KvpFrame*
+instance_kvp_frame (const QofInstance *inst)
+{
+    auto slot = &const_cast<QofInstance*>(inst)->kvp_data;
+    auto frame = static_cast<KvpFrame*>(g_atomic_pointer_get (slot));
+    if (frame)
+        return frame;
+    /* Concurrent readers may get here at the same time. */
+    qof_engine_cache_lock ();
+    frame = *slot;
+    if (!frame)
+    {
+        frame = new KvpFrame;
+        g_atomic_pointer_set (slot, frame);
+    }
+    qof_engine_cache_unlock ();
+    return frame;
+}
+
 G_DEFINE_TYPE_WITH_PRIVATE(QofInstance, qof_instance, G_TYPE_OBJECT);
 QOF_GOBJECT_FINALIZE(qof_instance);
 #undef G_PARAM_READWRITE
@@ -281,6 +314,8 @@ qof_instance_init_data (QofInstance *inst, QofIdType type, QofBook *book)
     g_return_if_fail(!priv->book);
 
     priv->book = book;
+    if (priv->dirty)
+        qof_book_set_instance_dirty (book, inst, TRUE);
     col = qof_book_get_collection (book, type);
     g_return_if_fail(col != NULL);
 
@@ -319,6 +354,8 @@ qof_instance_dispose (GObject *instp)
     QofInstance* inst = QOF_INSTANCE(instp);
 
     priv = GET_PRIVATE(instp);
+    if (priv->dirty)
+        qof_book_set_instance_dirty (priv->book, inst, FALSE);
     if (!priv->collection)
         return;
     qof_collection_remove_entity(inst);
@@ -542,8 +579,16 @@ qof_instance_get_book (gconstpointer inst)
 void
 qof_instance_set_book (gconstpointer inst, QofBook *book)
 {
+    QofInstancePrivate *priv;
+
     g_return_if_fail(QOF_IS_INSTANCE(inst));
-    GET_PRIVATE(inst)->book = book;
+    priv = GET_PRIVATE(inst);
+    if (priv->dirty)
+    {
+        qof_book_set_instance_dirty (priv->book, QOF_INSTANCE(inst), FALSE);
+        qof_book_set_instance_dirty (book, QOF_INSTANCE(inst), TRUE);
+    }
+    priv->book = book;
 }
 
 void
@@ -552,7 +597,7 @@ qof_instance_copy_book (gpointer ptr1, gconstpointer ptr2)
     g_return_if_fail(QOF_IS_INSTANCE(ptr1));
     g_return_if_fail(QOF_IS_INSTANCE(ptr2));
 
-    GET_PRIVATE(ptr1)->book = GET_PRIVATE(ptr2)->book;
+    qof_instance_set_book (ptr1, GET_PRIVATE(ptr2)->book);
 }
 
 gboolean
@@ -574,7 +619,15 @@ KvpFrame*
 qof_instance_get_slots (const QofInstance *inst)
 {
     if (!inst) return NULL;
-    return inst->kvp_data;
+    return instance_kvp_frame (inst);
+}
+
+void
+qof_instance_release_empty_slots (QofInstance *inst)
+{
+    if (!inst || !inst->kvp_data || !inst->kvp_data->empty ()) return;
+    delete inst->kvp_data;
+    inst->kvp_data = nullptr;
 }
 
 void
@@ -590,8 +643,10 @@ qof_instance_set_slots (QofInstance *inst, KvpFrame *frm)
         delete inst->kvp_data;
     }
 
-    priv->dirty = TRUE;
+    instance_set_dirty (inst, priv, TRUE);
     inst->kvp_data = frm;
+    if (QOF_IS_BOOK (inst))
+        qof_book_features_changed (QOF_BOOK (inst));
 }
 
 void
@@ -666,14 +721,14 @@ void
 qof_instance_set_dirty_flag (gconstpointer inst, gboolean flag)
 {
     g_return_if_fail(QOF_IS_INSTANCE(inst));
-    GET_PRIVATE(inst)->dirty = flag;
+    instance_set_dirty (QOF_INSTANCE(inst), GET_PRIVATE(inst), flag);
 }
 
 void
 qof_instance_mark_clean (QofInstance *inst)
 {
     if (!inst) return;
-    GET_PRIVATE(inst)->dirty = FALSE;
+    instance_set_dirty (inst, GET_PRIVATE(inst), FALSE);
 }
 
 void
@@ -712,7 +767,7 @@ qof_instance_set_dirty(QofInstance* inst)
     QofCollection *coll;
 
     priv = GET_PRIVATE(inst);
-    priv->dirty = TRUE;
+    instance_set_dirty (inst, priv, TRUE);
 }
 
 gboolean
@@ -919,6 +974,29 @@ gboolean qof_instance_refers_to_object(const QofInstance* inst, const QofInstanc
     }
 }
 
+void
+qof_instance_add_memory_usage (const QofInstance* inst, QofMemoryUsage* usage)
+{
+    GTypeQuery query;
+
+    g_return_if_fail (QOF_IS_INSTANCE (inst));
+    g_return_if_fail (usage != NULL);
+
+    g_type_query (G_TYPE_FROM_INSTANCE (inst), &query);
+    usage->instance_bytes += query.instance_size + sizeof (QofInstancePrivate);
+    if (inst->kvp_data)
+        inst->kvp_data->add_memory_usage (*usage);
+    if (QOF_INSTANCE_GET_CLASS (inst)->add_memory_usage != NULL)
+        QOF_INSTANCE_GET_CLASS (inst)->add_memory_usage (inst, usage);
+}
+
+void
+qof_memory_usage_add_list (QofMemoryUsage* usage, const GList* list)
+{
+    g_return_if_fail (usage != NULL);
+    usage->list_nodes += g_list_length (const_cast<GList*>(list));
+}
+
 /* g_object_set/get wrappers */
 void
 qof_instance_get (const QofInstance *inst, const gchar *first_prop, ...)
@@ -944,6 +1022,113 @@ qof_instance_set (QofInstance *inst, const gchar *first_prop, ...)
 }
 
 
+/* =================================================================== */
+/* Concurrent read mode */
+/* =================================================================== */
+
+static gboolean concurrent_reads = FALSE;
+static GRWLock engine_lock;
+/* Serializes the readers filling the engine's lazy caches. */
+static GRecMutex engine_cache_mutex;
+/* The thread holding engine_lock for writing, and how often it took it. */
+static gpointer engine_writer = NULL;
+static guint engine_write_depth = 0;
+
+void
+qof_engine_set_concurrent_reads (gboolean enabled)
+{
+    if (g_atomic_pointer_get (&engine_writer))
+    {
+        PERR ("can't switch modes while the engine is write-locked");
+        return;
+    }
+    concurrent_reads = enabled;
+}
+
+gboolean
+qof_engine_get_concurrent_reads (void)
+{
+    return concurrent_reads;
+}
+
+void
+qof_engine_read_lock (void)
+{
+    if (concurrent_reads)
+        g_rw_lock_reader_lock (&engine_lock);
+}
+
+void
+qof_engine_read_unlock (void)
+{
+    if (concurrent_reads)
+        g_rw_lock_reader_unlock (&engine_lock);
+}
+
+void
+qof_engine_write_lock (void)
+{
+    if (!concurrent_reads) return;
+    if (g_atomic_pointer_get (&engine_writer) == g_thread_self ())
+    {
+        engine_write_depth++;
+        return;
+    }
+    g_rw_lock_writer_lock (&engine_lock);
+    g_atomic_pointer_set (&engine_writer, g_thread_self ());
+    engine_write_depth = 1;
+}
+
+void
+qof_engine_write_unlock (void)
+{
+    if (g_atomic_pointer_get (&engine_writer) != g_thread_self ())
+        return;
+    if (--engine_write_depth > 0)
+        return;
+    g_atomic_pointer_set (&engine_writer, NULL);
+    g_rw_lock_writer_unlock (&engine_lock);
+}
+
+void
+qof_engine_cache_lock (void)
+{
+    if (concurrent_reads)
+        g_rec_mutex_lock (&engine_cache_mutex);
+}
+
+void
+qof_engine_cache_unlock (void)
+{
+    if (concurrent_reads)
+        g_rec_mutex_unlock (&engine_cache_mutex);
+}
+
+static gboolean
+engine_write_unlock_idle (gpointer unused)
+{
+    qof_engine_write_unlock ();
+    return FALSE;
+}
+
+/* Starting an edit write-locks the engine.  The main loop's thread keeps
+ * the lock until it's idle again, i.e. until whatever it's doing with
+ * the instance (including the commit and its aftermath) is done. */
+static void
+engine_lock_for_edit (void)
+{
+    if (!concurrent_reads ||
+        g_atomic_pointer_get (&engine_writer) == g_thread_self ())
+        return;
+    if (!g_main_context_is_owner (g_main_context_default ()))
+    {
+        PERR ("editing outside of the main loop needs qof_engine_write_lock()");
+        return;
+    }
+    qof_engine_write_lock ();
+    g_idle_add (engine_write_unlock_idle, NULL);
+}
+
 /* =================================================================== */
 /* Entity edit and commit utilities */
 /* =================================================================== */
@@ -961,11 +1146,13 @@ qof_begin_edit (QofInstance *inst)
     if (0 >= priv->editlevel)
         priv->editlevel = 1;
 
+    engine_lock_for_edit ();
+
     auto be = qof_book_get_backend(priv->book);
     if (be)
         be->begin(inst);
     else
-        priv->dirty = TRUE;
+        instance_set_dirty (inst, priv, TRUE);
 
     return TRUE;
 }
@@ -1017,7 +1204,9 @@ qof_commit_edit_part2(QofInstance *inst,
         }
         while (errcode != ERR_BACKEND_NO_ERR);
 
+        QOF_TIMER_START (commit, "backend.commit");
         be->commit(inst);
+        QOF_TIMER_STOP (commit);
         errcode = be->get_error();
         if (errcode != ERR_BACKEND_NO_ERR)
         {
@@ -1054,7 +1243,7 @@ qof_instance_has_kvp (QofInstance *inst)
 
 void qof_instance_set_path_kvp (QofInstance * inst, GValue const * value, std::vector<std::string> const & path)
 {
-    delete inst->kvp_data->set_path (path, kvp_value_from_gvalue (value));
+    delete instance_kvp_frame (inst)->set_path (path, kvp_value_from_gvalue (value));
 }
 
 void
@@ -1066,12 +1255,12 @@ qof_instance_set_kvp (QofInstance * inst, GValue const * value, unsigned count,
     for (unsigned i{0}; i < count; ++i)
         path.push_back (va_arg (args, char const *));
     va_end (args);
-    delete inst->kvp_data->set_path (path, kvp_value_from_gvalue (value));
+    delete instance_kvp_frame (inst)->set_path (path, kvp_value_from_gvalue (value));
 }
 
 void qof_instance_get_path_kvp (QofInstance * inst, GValue * value, std::vector<std::string> const & path)
 {
-    auto temp = gvalue_from_kvp_value (inst->kvp_data->get_slot (path));
+    auto temp = gvalue_from_kvp_value (instance_kvp_frame (inst)->get_slot (path));
     if (G_IS_VALUE (temp))
     {
         if (G_IS_VALUE (value))
@@ -1091,7 +1280,33 @@ qof_instance_get_kvp (QofInstance * inst, GValue * value, unsigned count, ...)
     for (unsigned i{0}; i < count; ++i)
         path.push_back (va_arg (args, char const *));
     va_end (args);
-    auto temp = gvalue_from_kvp_value (inst->kvp_data->get_slot (path));
+    auto temp = gvalue_from_kvp_value (instance_kvp_frame (inst)->get_slot (path));
+    if (G_IS_VALUE (temp))
+    {
+        if (G_IS_VALUE (value))
+            g_value_unset (value);
+        g_value_init (value, G_VALUE_TYPE (temp));
+        g_value_copy (temp, value);
+        gnc_gvalue_free (temp);
+    }
+}
+
+void
+qof_instance_set_kvp_at (QofInstance * inst, GValue const * value,
+                         const QofKvpPath * path)
+{
+    g_return_if_fail (path && path->count && path->count <= QOF_KVP_PATH_MAX_DEPTH);
+    delete instance_kvp_frame (inst)->set_path (path->keys, path->count,
+                                     kvp_value_from_gvalue (value));
+}
+
+void
+qof_instance_get_kvp_at (const QofInstance * inst, GValue * value,
+                         const QofKvpPath * path)
+{
+    g_return_if_fail (path && path->count && path->count <= QOF_KVP_PATH_MAX_DEPTH);
+    auto temp = gvalue_from_kvp_value (instance_kvp_frame (inst)->get_slot (path->keys,
+                                                                 path->count));
     if (G_IS_VALUE (temp))
     {
         if (G_IS_VALUE (value))
@@ -1102,11 +1317,33 @@ qof_instance_get_kvp (QofInstance * inst, GValue * value, unsigned count, ...)
     }
 }
 
+const char *
+qof_instance_get_kvp_string_at (const QofInstance * inst,
+                                const QofKvpPath * path)
+{
+    g_return_val_if_fail (path && path->count && path->count <= QOF_KVP_PATH_MAX_DEPTH, nullptr);
+    auto slot = instance_kvp_frame (inst)->get_slot (path->keys, path->count);
+    if (!slot || slot->get_type () != KvpValue::Type::STRING)
+        return nullptr;
+    return slot->get<const char*> ();
+}
+
+const GncGUID *
+qof_instance_get_kvp_guid_at (const QofInstance * inst,
+                              const QofKvpPath * path)
+{
+    g_return_val_if_fail (path && path->count && path->count <= QOF_KVP_PATH_MAX_DEPTH, nullptr);
+    auto slot = instance_kvp_frame (inst)->get_slot (path->keys, path->count);
+    if (!slot || slot->get_type () != KvpValue::Type::GUID)
+        return nullptr;
+    return slot->get<GncGUID*> ();
+}
+
 void
 qof_instance_copy_kvp (QofInstance *to, const QofInstance *from)
 {
     delete to->kvp_data;
-    to->kvp_data = new KvpFrame(*from->kvp_data);
+    to->kvp_data = from->kvp_data ? new KvpFrame(*from->kvp_data) : nullptr;
 }
 
 void
@@ -1118,14 +1355,14 @@ qof_instance_swap_kvp (QofInstance *a, QofInstance *b)
 int
 qof_instance_compare_kvp (const QofInstance *a, const QofInstance *b)
 {
-    return compare(a->kvp_data, b->kvp_data);
+    return compare(instance_kvp_frame (a), instance_kvp_frame (b));
 }
 
 char*
 qof_instance_kvp_as_string (const QofInstance *inst)
 {
     //The std::string is a local temporary and doesn't survive this function.
-    return g_strdup(inst->kvp_data->to_string().c_str());
+    return g_strdup(instance_kvp_frame (inst)->to_string().c_str());
 }
 
 void
@@ -1133,13 +1370,13 @@ qof_instance_kvp_add_guid (const QofInstance *inst, const char* path,
                            time64 time, const char *key,
                            const GncGUID *guid)
 {
-    g_return_if_fail (inst->kvp_data != NULL);
+    g_return_if_fail (inst != NULL);
 
     auto container = new KvpFrame;
     Time64 t{time};
     container->set({key}, new KvpValue(const_cast<GncGUID*>(guid)));
     container->set({"date"}, new KvpValue(t));
-    delete inst->kvp_data->set_path({path}, new KvpValue(container));
+    delete instance_kvp_frame (inst)->set_path({path}, new KvpValue(container));
 }
 
 inline static gboolean
@@ -1160,10 +1397,10 @@ gboolean
 qof_instance_kvp_has_guid (const QofInstance *inst, const char *path,
                            const char* key, const GncGUID *guid)
 {
-    g_return_val_if_fail (inst->kvp_data != NULL, FALSE);
+    g_return_val_if_fail (inst != NULL, FALSE);
     g_return_val_if_fail (guid != NULL, FALSE);
 
-    auto v = inst->kvp_data->get_slot({path});
+    auto v = instance_kvp_frame (inst)->get_slot({path});
     if (v == nullptr) return FALSE;
 
     switch (v->get_type())
@@ -1195,10 +1432,10 @@ void
 qof_instance_kvp_remove_guid (const QofInstance *inst, const char *path,
                           const char *key, const GncGUID *guid)
 {
-    g_return_if_fail (inst->kvp_data != NULL);
+    g_return_if_fail (inst != NULL);
     g_return_if_fail (guid != NULL);
 
-    auto v = inst->kvp_data->get_slot({path});
+    auto v = instance_kvp_frame (inst)->get_slot({path});
     if (v == NULL) return;
 
     switch (v->get_type())
@@ -1206,7 +1443,7 @@ qof_instance_kvp_remove_guid (const QofInstance *inst, const char *path,
     case KvpValue::Type::FRAME:
         if (kvp_match_guid (v, {key}, guid))
         {
-            delete inst->kvp_data->set_path({path}, nullptr);
+            delete instance_kvp_frame (inst)->set_path({path}, nullptr);
             delete v;
         }
         break;
@@ -1241,18 +1478,18 @@ qof_instance_kvp_merge_guids (const QofInstance *target,
     g_return_if_fail (donor != NULL);
 
     if (! qof_instance_has_slot (donor, path)) return;
-    auto v = donor->kvp_data->get_slot({path});
+    auto v = instance_kvp_frame (donor)->get_slot({path});
     if (v == NULL) return;
 
-    auto target_val = target->kvp_data->get_slot({path});
+    auto target_val = instance_kvp_frame (target)->get_slot({path});
     switch (v->get_type())
     {
     case KvpValue::Type::FRAME:
         if (target_val)
             target_val->add(v);
         else
-            target->kvp_data->set_path({path}, v);
-        donor->kvp_data->set({path}, nullptr); //Contents moved, Don't delete!
+            instance_kvp_frame (target)->set_path({path}, v);
+        instance_kvp_frame (donor)->set({path}, nullptr); //Contents moved, Don't delete!
         break;
     case KvpValue::Type::GLIST:
         if (target_val)
@@ -1262,8 +1499,8 @@ qof_instance_kvp_merge_guids (const QofInstance *target,
             target_val->set(list);
         }
         else
-            target->kvp_data->set({path}, v);
-        donor->kvp_data->set({path}, nullptr); //Contents moved, Don't delete!
+            instance_kvp_frame (target)->set({path}, v);
+        instance_kvp_frame (donor)->set({path}, nullptr); //Contents moved, Don't delete!
         break;
     default:
         PWARN ("Instance KVP on path %s contains the wrong type.", path);
@@ -1273,46 +1510,46 @@ qof_instance_kvp_merge_guids (const QofInstance *target,
 
 bool qof_instance_has_path_slot (QofInstance const * inst, std::vector<std::string> const & path)
 {
-    return inst->kvp_data->get_slot (path) != nullptr;
+    return instance_kvp_frame (inst)->get_slot (path) != nullptr;
 }
 
 gboolean
 qof_instance_has_slot (const QofInstance *inst, const char *path)
 {
-    return inst->kvp_data->get_slot({path}) != NULL;
+    return instance_kvp_frame (inst)->get_slot({path}) != NULL;
 }
 
 void qof_instance_slot_path_delete (QofInstance const * inst, std::vector<std::string> const & path)
 {
-    delete inst->kvp_data->set (path, nullptr);
+    delete instance_kvp_frame (inst)->set (path, nullptr);
 }
 
 void
 qof_instance_slot_delete (QofInstance const *inst, char const * path)
 {
-    delete inst->kvp_data->set ({path}, nullptr);
+    delete instance_kvp_frame (inst)->set ({path}, nullptr);
 }
 
 void qof_instance_slot_path_delete_if_empty (QofInstance const * inst, std::vector<std::string> const & path)
 {
-    auto slot = inst->kvp_data->get_slot (path);
+    auto slot = instance_kvp_frame (inst)->get_slot (path);
     if (slot)
     {
         auto frame = slot->get <KvpFrame*> ();
         if (frame && frame->empty())
-            delete inst->kvp_data->set (path, nullptr);
+            delete instance_kvp_frame (inst)->set (path, nullptr);
     }
 }
 
 void
 qof_instance_slot_delete_if_empty (QofInstance const *inst, char const * path)
 {
-    auto slot = inst->kvp_data->get_slot ({path});
+    auto slot = instance_kvp_frame (inst)->get_slot ({path});
     if (slot)
     {
         auto frame = slot->get <KvpFrame*> ();
         if (frame && frame->empty ())
-            delete inst->kvp_data->set ({path}, nullptr);
+            delete instance_kvp_frame (inst)->set ({path}, nullptr);
     }
 }
 
@@ -1320,7 +1557,7 @@ std::vector <std::pair <std::string, KvpValue*>>
 qof_instance_get_slots_prefix (QofInstance const * inst, std::string const & prefix)
 {
     std::vector <std::pair <std::string, KvpValue*>> ret;
-    inst->kvp_data->for_each_slot_temp ([&prefix, &ret] (std::string const & key, KvpValue * val) {
+    instance_kvp_frame (inst)->for_each_slot_temp ([&prefix, &ret] (std::string const & key, KvpValue * val) {
         if (key.find (prefix) == 0)
             ret.emplace_back (key, val);
     });
@@ -1359,7 +1596,7 @@ qof_instance_foreach_slot (const QofInstance *inst, const char* head, const char
     if (category)
         path.emplace_back (category);
 
-    auto slot = inst->kvp_data->get_slot(path);
+    auto slot = instance_kvp_frame (inst)->get_slot(path);
     if (slot == nullptr || slot->get_type() != KvpValue::Type::FRAME)
         return;
     auto frame = slot->get<KvpFrame*>();
@@ -65,6 +65,20 @@ typedef struct KvpFrameImpl KvpFrame;
 #define __KVP_FRAME
 #endif
 
+/** The memory an instance uses, as tallied by
+ * qof_instance_add_memory_usage().  The byte counts are approximate:
+ * they leave out the allocator's own overhead and the strings in the
+ * string cache, which all books share. */
+typedef struct
+{
+    gsize instance_bytes;  /**< The instance struct and its private data */
+    gsize kvp_frames;
+    gsize kvp_values;
+    gsize kvp_bytes;       /**< The frames, their slots and values */
+    gsize list_nodes;      /**< GList nodes, e.g. of the split lists */
+    gsize other_bytes;     /**< Owned strings, vectors, hash tables, caches */
+} QofMemoryUsage;
+
 struct QofInstance_s
 {
     GObject object;
@@ -84,6 +98,10 @@ struct _QofInstanceClass
 
     /* Returns a list of my type of object which refers to an object */
     GList* (*get_typed_referring_object_list)(const QofInstance* inst, const QofInstance* ref);
+
+    /* Adds what the object allocates besides the QofInstance and its
+     * KVP to usage: its private data, lists and caches */
+    void (*add_memory_usage)(const QofInstance* inst, QofMemoryUsage* usage);
 };
 
 /** Return the GType of a QofInstance */
@@ -206,6 +224,13 @@ GList* qof_instance_get_typed_referring_object_list(const QofInstance* inst, con
  */
 GList* qof_instance_get_referring_object_list_from_collection(const QofCollection* coll, const QofInstance* ref);
 
+/** Adds the memory used by the instance, its KVP and whatever its class
+ *  reports to usage. */
+void qof_instance_add_memory_usage (const QofInstance* inst, QofMemoryUsage* usage);
+
+/** Adds the nodes of list to usage, for the classes' add_memory_usage. */
+void qof_memory_usage_add_list (QofMemoryUsage* usage, const GList* list);
+
 /* @} */
 /* @} */
 #endif /* QOF_INSTANCE_H */
@@ -43,6 +43,7 @@ extern "C"
 #  warning "<unistd.h> required."
 # endif
 #endif
+#include <errno.h>
 #include <stdarg.h>
 #include <stdlib.h>
 #include <string.h>
@@ -58,6 +59,8 @@ extern "C"
 #include <vector>
 #include <memory>
 #include <algorithm>
+#include <map>
+#include <mutex>
 
 #define QOF_LOG_MAX_CHARS 50
 #define QOF_LOG_MAX_CHARS_WITH_ALLOWANCE 100
@@ -65,12 +68,17 @@ extern "C"
 #define NUM_CLOCKS 10
 
 static FILE *fout = NULL;
-static gchar* function_buffer = NULL;
+/* Per thread, so that threads saving or searching in the background can
+ * log too. */
+static thread_local std::string function_buffer;
 static gint qof_log_num_spaces = 0;
 static GLogFunc previous_handler = NULL;
 static gchar* qof_logger_format = NULL;
 static QofLogModule log_module = "qof";
 
+/* Starts above the 0 that QofLogSites are initialized with. */
+gint qof_log_generation = 1;
+
 using StrVec = std::vector<std::string>;
 
 struct ModuleEntry;
@@ -270,15 +278,13 @@ qof_log_shutdown (void)
         fout = NULL;
     }
 
-    if (function_buffer)
-    {
-        g_free(function_buffer);
-        function_buffer = NULL;
-    }
+    function_buffer.clear();
+    function_buffer.shrink_to_fit();
 
     if (_modules != NULL)
     {
         _modules = nullptr;
+        g_atomic_int_inc (&qof_log_generation);
     }
 
     if (previous_handler != NULL)
@@ -315,6 +321,7 @@ qof_log_set_level(QofLogModule log_module, QofLogLevel level)
         }
     }
     module->m_level = level;
+    g_atomic_int_inc (&qof_log_generation);
 }
 
 
@@ -350,6 +357,18 @@ qof_log_check(QofLogModule domain, QofLogLevel level)
     return FALSE;
 }
 
+gboolean
+qof_log_site_refresh (QofLogSite *site, QofLogModule log_module,
+                      QofLogLevel log_level)
+{
+    /* Read the generation first so that a level change racing with us
+     * leaves the site stale rather than wrong. */
+    auto generation = g_atomic_int_get (&qof_log_generation);
+    site->enabled = qof_log_check (log_module, log_level);
+    g_atomic_int_set (&site->generation, generation);
+    return site->enabled;
+}
+
 const char *
 qof_log_prettify (const char *name)
 {
@@ -379,11 +398,9 @@ qof_log_prettify (const char *name)
     else
         p = buffer;
 
-    if (function_buffer)
-        g_free(function_buffer);
-    function_buffer = g_strdup(p);
+    function_buffer = p;
     g_free(buffer);
-    return function_buffer;
+    return function_buffer.c_str();
 }
 
 void
@@ -535,3 +552,257 @@ qof_log_level_from_string(const gchar *str)
     if (g_ascii_strncasecmp("debug", str, 5) == 0) return QOF_LOG_DEBUG;
     return QOF_LOG_DEBUG;
 }
+
+/* ************************ Instrumentation ************************ */
+
+static std::mutex counter_mutex;
+static QofCounter *counters = nullptr;
+
+void
+qof_counter_add (QofCounter *counter, gint64 usecs)
+{
+    std::lock_guard<std::mutex> lock (counter_mutex);
+    if (!counter->registered)
+    {
+        counter->next = counters;
+        counters = counter;
+        counter->registered = TRUE;
+    }
+    counter->count++;
+    counter->usecs += usecs;
+}
+
+void
+qof_counter_add_named (const gchar *name, gint64 usecs)
+{
+    /* The counters are kept for good, so the names they point to are the
+     * keys of this map, which don't move. */
+    static std::map<std::string, QofCounter> named_counters;
+    QofCounter *counter;
+    {
+        std::lock_guard<std::mutex> lock (counter_mutex);
+        auto it = named_counters.find (name);
+        if (it == named_counters.end ())
+        {
+            it = named_counters.emplace (name, QofCounter{}).first;
+            it->second.name = it->first.c_str ();
+        }
+        counter = &it->second;
+    }
+    qof_counter_add (counter, usecs);
+}
+
+gboolean
+qof_counters_enabled (void)
+{
+#ifdef ENABLE_INSTRUMENTATION
+    return TRUE;
+#else
+    return FALSE;
+#endif
+}
+
+static gchar *
+counter_report (bool by_category)
+{
+    std::map<std::string, std::pair<gint64, gint64>> totals;
+    {
+        std::lock_guard<std::mutex> lock (counter_mutex);
+        for (auto counter = counters; counter; counter = counter->next)
+        {
+            std::string name{counter->name};
+            if (by_category)
+                name = name.substr (0, name.find ('.'));
+            auto& total = totals[name];
+            total.first += counter->count;
+            total.second += counter->usecs;
+        }
+    }
+
+    auto report = g_string_new (NULL);
+    g_string_append_printf (report, "%-32s %12s %12s %10s\n",
+                            by_category ? "category" : "counter",
+                            "hits", "total ms", "avg us");
+    for (const auto& [name, total] : totals)
+        g_string_append_printf (report,
+                                "%-32s %12" G_GINT64_FORMAT " %12.3f %10.3f\n",
+                                name.c_str(), total.first,
+                                total.second / 1000.0,
+                                total.first ? (double)total.second / total.first
+                                : 0.0);
+    return g_string_free (report, FALSE);
+}
+
+gchar *
+qof_counter_report (void)
+{
+    return counter_report (false);
+}
+
+gchar *
+qof_counter_report_categories (void)
+{
+    return counter_report (true);
+}
+
+void
+qof_counter_dump (FILE *out)
+{
+    auto report = qof_counter_report ();
+    fputs (report, out ? out : stderr);
+    g_free (report);
+}
+
+void
+qof_counter_reset (void)
+{
+    std::lock_guard<std::mutex> lock (counter_mutex);
+    for (auto counter = counters; counter; counter = counter->next)
+        counter->count = counter->usecs = 0;
+}
+
+/* ************************ Tracing ************************ */
+
+/* The file is a JSON array of Chrome trace events:
+ * https://docs.google.com/document/d/1CvAClvFfyA5R-PhYUmn5OOQtYMH4h6I0nSsKchNAySU
+ */
+static std::mutex trace_mutex;
+static FILE *trace_file = nullptr;
+static gboolean trace_on = FALSE;
+static gint64 trace_origin = 0;
+static int trace_threads = 0;
+static int trace_generation = 0;
+static thread_local int trace_tid = 0;
+static thread_local int trace_tid_generation = 0;
+
+static void
+trace_append_escaped (std::string& out, const gchar *str)
+{
+    out += '"';
+    for (auto c = str; *c; ++c)
+    {
+        switch (*c)
+        {
+        case '"':
+            out += "\\\"";
+            break;
+        case '\\':
+            out += "\\\\";
+            break;
+        default:
+            if (static_cast<guchar>(*c) < 0x20)
+            {
+                gchar code[8];
+                g_snprintf (code, sizeof (code), "\\u%04x", *c);
+                out += code;
+            }
+            else
+                out += *c;
+        }
+    }
+    out += '"';
+}
+
+/* Call with trace_mutex held. */
+static void
+trace_write_thread_name (int tid)
+{
+    std::string event{",\n{\"ph\":\"M\",\"pid\":1,\"tid\":"};
+    event += std::to_string (tid);
+    event += ",\"name\":\"thread_name\",\"args\":{\"name\":";
+    auto name = tid == 1 ? g_strdup ("main") : g_strdup_printf ("thread %d", tid);
+    trace_append_escaped (event, name);
+    g_free (name);
+    event += "}}";
+    fputs (event.c_str (), trace_file);
+}
+
+gboolean
+qof_trace_start (const gchar *filename)
+{
+    g_return_val_if_fail (filename, FALSE);
+
+    qof_trace_stop ();
+    std::lock_guard<std::mutex> lock (trace_mutex);
+    trace_file = g_fopen (filename, "w");
+    if (!trace_file)
+    {
+        g_warning ("Can't write the trace to %s: %s", filename,
+                   g_strerror (errno));
+        return FALSE;
+    }
+
+    std::string start{"[\n{\"ph\":\"M\",\"pid\":1,\"tid\":1,"
+                      "\"name\":\"process_name\",\"args\":{\"name\":"};
+    trace_append_escaped (start, g_get_prgname () ? g_get_prgname () : "gnucash");
+    start += "}}";
+    fputs (start.c_str (), trace_file);
+
+    /* Tids are given out as threads first write a span, except that the
+     * thread tracing is started on is "main". */
+    trace_threads = trace_tid = 1;
+    trace_tid_generation = ++trace_generation;
+    trace_write_thread_name (trace_tid);
+    trace_origin = g_get_monotonic_time ();
+    trace_on = TRUE;
+    return TRUE;
+}
+
+void
+qof_trace_stop (void)
+{
+    std::lock_guard<std::mutex> lock (trace_mutex);
+    if (!trace_file)
+        return;
+    trace_on = FALSE;
+    fputs ("\n]\n", trace_file);
+    fclose (trace_file);
+    trace_file = nullptr;
+}
+
+gboolean
+qof_trace_enabled (void)
+{
+    return trace_on;
+}
+
+gint64
+qof_trace_now (void)
+{
+    return trace_on ? g_get_monotonic_time () : 0;
+}
+
+void
+qof_trace_span (const gchar *category, const gchar *name, gint64 start,
+                const gchar *detail)
+{
+    if (!start)
+        return;
+
+    auto now = g_get_monotonic_time ();
+    std::string event{",\n{\"ph\":\"X\",\"pid\":1,\"cat\":"};
+    trace_append_escaped (event, category ? category : "");
+    event += ",\"name\":";
+    trace_append_escaped (event, name ? name : "");
+    if (detail)
+    {
+        event += ",\"args\":{\"detail\":";
+        trace_append_escaped (event, detail);
+        event += '}';
+    }
+
+    std::lock_guard<std::mutex> lock (trace_mutex);
+    /* Tracing was stopped, or restarted since the span began. */
+    if (!trace_file || start < trace_origin)
+        return;
+    if (trace_tid_generation != trace_generation)
+    {
+        trace_tid = ++trace_threads;
+        trace_tid_generation = trace_generation;
+        trace_write_thread_name (trace_tid);
+    }
+    event += ",\"tid\":" + std::to_string (trace_tid) +
+        ",\"ts\":" + std::to_string (start - trace_origin) +
+        ",\"dur\":" + std::to_string (now - start) + '}';
+    fputs (event.c_str (), trace_file);
+}
@@ -173,6 +173,29 @@ gboolean qof_log_check(QofLogModule log_module, QofLogLevel log_level);
 /** Set the default level for QOF-related log paths. **/
 void qof_log_set_default(QofLogLevel log_level);
 
+/** Each PINFO, DEBUG, ENTER and LEAVE keeps the result of qof_log_check()
+ * for its module and level in a static QofLogSite, so a disabled
+ * statement costs a comparison and its arguments aren't evaluated.
+ * Changing any level bumps qof_log_generation, which makes every site
+ * check again the next time it runs. */
+typedef struct
+{
+    gint generation;
+    gboolean enabled;
+} QofLogSite;
+
+extern gint qof_log_generation;
+
+/** Redo qof_log_check() for a stale @a site and remember the result. */
+gboolean qof_log_site_refresh (QofLogSite *site, QofLogModule log_module,
+                               QofLogLevel log_level);
+
+#define QOF_LOG_SITE_ENABLED(site, level) \
+    (G_LIKELY ((site).generation == g_atomic_int_get (&qof_log_generation)) ? \
+     (site).enabled : qof_log_site_refresh (&(site), log_module, (level)))
+
+#define QOF_LOG_SITE_DECLARE(site) static QofLogSite site = { 0, FALSE }
+
 #define PRETTY_FUNC_NAME qof_log_prettify(G_STRFUNC)
 
 #ifdef _MSC_VER
@@ -204,19 +227,24 @@ void qof_log_set_default(QofLogLevel log_level);
 
 /** Print an informational note */
 #define PINFO(format, ...) do { \
-    g_log (log_module, G_LOG_LEVEL_INFO, \
-      "[%s] " format, PRETTY_FUNC_NAME , __VA_ARGS__); \
+    QOF_LOG_SITE_DECLARE (qof_log_site); \
+    if (G_UNLIKELY (QOF_LOG_SITE_ENABLED (qof_log_site, QOF_LOG_INFO))) \
+      g_log (log_module, G_LOG_LEVEL_INFO, \
+        "[%s] " format, PRETTY_FUNC_NAME , __VA_ARGS__); \
 } while (0)
 
 /** Print a debugging message */
 #define DEBUG(format, ...) do { \
-    g_log (log_module, G_LOG_LEVEL_DEBUG, \
-      "[%s] " format, PRETTY_FUNC_NAME , __VA_ARGS__); \
+    QOF_LOG_SITE_DECLARE (qof_log_site); \
+    if (G_UNLIKELY (QOF_LOG_SITE_ENABLED (qof_log_site, QOF_LOG_DEBUG))) \
+      g_log (log_module, G_LOG_LEVEL_DEBUG, \
+        "[%s] " format, PRETTY_FUNC_NAME , __VA_ARGS__); \
 } while (0)
 
 /** Print a function entry debugging message */
 #define ENTER(format, ...) do { \
-    if (qof_log_check(log_module, (QofLogLevel)G_LOG_LEVEL_DEBUG)) { \
+    QOF_LOG_SITE_DECLARE (qof_log_site); \
+    if (G_UNLIKELY (QOF_LOG_SITE_ENABLED (qof_log_site, QOF_LOG_DEBUG))) { \
       g_log (log_module, G_LOG_LEVEL_DEBUG, \
         "[enter %s:%s()] " format, __FILE__, \
         PRETTY_FUNC_NAME , __VA_ARGS__); \
@@ -226,7 +254,8 @@ void qof_log_set_default(QofLogLevel log_level);
 
 /** Print a function exit debugging message. **/
 #define LEAVE(format, ...) do { \
-    if (qof_log_check(log_module, (QofLogLevel)G_LOG_LEVEL_DEBUG)) { \
+    QOF_LOG_SITE_DECLARE (qof_log_site); \
+    if (G_UNLIKELY (QOF_LOG_SITE_ENABLED (qof_log_site, QOF_LOG_DEBUG))) { \
       qof_log_dedent(); \
       g_log (log_module, G_LOG_LEVEL_DEBUG, \
         "[leave %s()] " format, \
@@ -256,19 +285,24 @@ void qof_log_set_default(QofLogLevel log_level);
 
 /** Print an informational note */
 #define PINFO(format, args...) do { \
-    g_log (log_module, G_LOG_LEVEL_INFO, \
-      "[%s] " format, PRETTY_FUNC_NAME , ## args); \
+    QOF_LOG_SITE_DECLARE (qof_log_site); \
+    if (G_UNLIKELY (QOF_LOG_SITE_ENABLED (qof_log_site, QOF_LOG_INFO))) \
+      g_log (log_module, G_LOG_LEVEL_INFO, \
+        "[%s] " format, PRETTY_FUNC_NAME , ## args); \
 } while (0)
 
 /** Print a debugging message */
 #define DEBUG(format, args...) do { \
-    g_log (log_module, G_LOG_LEVEL_DEBUG, \
-      "[%s] " format, PRETTY_FUNC_NAME , ## args); \
+    QOF_LOG_SITE_DECLARE (qof_log_site); \
+    if (G_UNLIKELY (QOF_LOG_SITE_ENABLED (qof_log_site, QOF_LOG_DEBUG))) \
+      g_log (log_module, G_LOG_LEVEL_DEBUG, \
+        "[%s] " format, PRETTY_FUNC_NAME , ## args); \
 } while (0)
 
 /** Print a function entry debugging message */
 #define ENTER(format, args...) do { \
-    if (qof_log_check(log_module, (QofLogLevel)G_LOG_LEVEL_DEBUG)) { \
+    QOF_LOG_SITE_DECLARE (qof_log_site); \
+    if (G_UNLIKELY (QOF_LOG_SITE_ENABLED (qof_log_site, QOF_LOG_DEBUG))) { \
       g_log (log_module, G_LOG_LEVEL_DEBUG, \
         "[enter %s:%s()] " format, __FILE__, \
         PRETTY_FUNC_NAME , ## args); \
@@ -278,7 +312,8 @@ void qof_log_set_default(QofLogLevel log_level);
 
 /** Print a function exit debugging message. **/
 #define LEAVE(format, args...) do { \
-    if (qof_log_check(log_module, (QofLogLevel)G_LOG_LEVEL_DEBUG)) { \
+    QOF_LOG_SITE_DECLARE (qof_log_site); \
+    if (G_UNLIKELY (QOF_LOG_SITE_ENABLED (qof_log_site, QOF_LOG_DEBUG))) { \
       qof_log_dedent(); \
       g_log (log_module, G_LOG_LEVEL_DEBUG, \
         "[leave %s()] " format, \
@@ -301,6 +336,133 @@ void qof_log_set_default(QofLogLevel log_level);
 } while (0);
 
 
+/** @name Instrumentation
+ *
+ * Named counters and cumulative timers for the engine's hot paths.  They
+ * are compiled in only when GnuCash is configured with
+ * <tt>-DENABLE_INSTRUMENTATION=ON</tt>; otherwise the macros expand to
+ * nothing.  Each use site keeps its own static counter; sites sharing a
+ * name are summed in the report.
+ *
+ * @code
+ *     QOF_TIMER_START (sort, "account.sort-splits");
+ *     ... the work ...
+ *     QOF_TIMER_STOP (sort);
+ * @endcode
+ * @{
+ */
+typedef struct QofCounter
+{
+    const gchar *name;
+    gint64 count;
+    gint64 usecs;
+    gboolean registered;
+    struct QofCounter *next;
+} QofCounter;
+
+/** Count one hit of @a counter, taking @a usecs microseconds. Use the
+ * macros rather than calling this directly. */
+void qof_counter_add (QofCounter *counter, gint64 usecs);
+
+/** Count one hit of the counter named @a name, taking @a usecs
+ * microseconds.  Unlike the macros this works in every build; it is for
+ * code that times its own work at run time, like the report profiler,
+ * and costs a lookup by name per call. */
+void qof_counter_add_named (const gchar *name, gint64 usecs);
+
+/** @return TRUE if this build collects counters. */
+gboolean qof_counters_enabled (void);
+
+/** @return A table of all counters hit so far: name, hits, total and
+ * average time.  The caller must g_free() it. */
+gchar *qof_counter_report (void);
+
+/** @return A table like qof_counter_report() but summed by category,
+ * the part of the counter names before the first '.', e.g. "query" or
+ * "pricedb".  Timers that run inside others are counted in both, so
+ * the categories may add up to more than the time spent.  The caller
+ * must g_free() it. */
+gchar *qof_counter_report_categories (void);
+
+/** Write qof_counter_report() to @a out. */
+void qof_counter_dump (FILE *out);
+
+/** Zero all counters. */
+void qof_counter_reset (void);
+
+#ifdef ENABLE_INSTRUMENTATION
+/** Count a hit on the named counter. */
+#define QOF_COUNT(name) do { \
+    static QofCounter qof_counter_site = { name, 0, 0, FALSE, NULL }; \
+    qof_counter_add (&qof_counter_site, 0); \
+} while (0)
+
+/** Start timing into the named counter; @a timer names this measurement
+ * for the matching QOF_TIMER_STOP in the same scope. */
+#define QOF_TIMER_START(timer, name) \
+    static QofCounter timer##_counter = { name, 0, 0, FALSE, NULL }; \
+    gint64 timer##_start = g_get_monotonic_time ()
+
+/** Stop timing @a timer and add the elapsed time to its counter. */
+#define QOF_TIMER_STOP(timer) \
+    qof_counter_add (&timer##_counter, g_get_monotonic_time () - timer##_start)
+#else
+#define QOF_COUNT(name) do { } while (0)
+#define QOF_TIMER_START(timer, name)
+#define QOF_TIMER_STOP(timer)
+#endif
+/** @} */
+
+/** @name Tracing
+ *
+ * Spans of time written as Chrome trace events, a JSON file that
+ * chrome://tracing and https://ui.perfetto.dev show as a timeline with
+ * a row per thread.  Unlike the counters, tracing works in every build;
+ * while it is off each span costs a test.  gnucash and gnucash-cli turn
+ * it on for <tt>--trace FILE</tt> or when the GNC_TRACE environment
+ * variable names a file.
+ *
+ * @code
+ *     QOF_TRACE_BEGIN (load);
+ *     ... the work ...
+ *     QOF_TRACE_END (load, "backend", "load");
+ * @endcode
+ * @{
+ */
+
+/** Start writing trace events to @a filename, replacing it.
+ * @return FALSE if the file couldn't be opened. */
+gboolean qof_trace_start (const gchar *filename);
+
+/** Finish the trace file and stop tracing.  A file left unfinished by a
+ * crash can still be loaded. */
+void qof_trace_stop (void);
+
+/** @return TRUE while tracing. */
+gboolean qof_trace_enabled (void);
+
+/** @return The time for the start of a span in microseconds, or 0 when
+ * not tracing. */
+gint64 qof_trace_now (void);
+
+/** Write a span from @a start, a time returned by qof_trace_now(), to
+ * now.  @a detail, if not NULL, is shown with it; building it is best
+ * left until @a start is known not to be 0.  Does nothing if @a start is
+ * 0. */
+void qof_trace_span (const gchar *category, const gchar *name,
+                     gint64 start, const gchar *detail);
+
+/** Note the start of a span; @a span names it for the matching
+ * QOF_TRACE_END in the same scope. */
+#define QOF_TRACE_BEGIN(span) \
+    gint64 span##_trace_start = qof_trace_now ()
+
+/** End @a span, writing it to the trace under @a category and @a name. */
+#define QOF_TRACE_END(span, category, name) \
+    qof_trace_span (category, name, span##_trace_start, NULL)
+/** @} */
+
+
 #ifdef __cplusplus
 }
 #endif
@@ -32,15 +32,31 @@ extern "C"
 #include <string.h>
 }
 
+#include <algorithm>
+#include <vector>
+
 #include "qof.h"
 #include "qof-backend.hpp"
 #include "qofbook-p.h"
 #include "qofclass-p.h"
+#include "qofevent-p.h"
 #include "qofquery-p.h"
 #include "qofquerycore-p.h"
 
 static QofLogModule log_module = QOF_MOD_QUERY;
 
+/* An index registered with qof_query_register_index(). */
+typedef struct _QofQueryIndex
+{
+    QofIdTypeConst          obj_type;
+    QofQueryParamList *     param_list;
+    QofQueryIndexFunc       index_fcn;
+    guint                   order;      /* Lower is preferred */
+} QofQueryIndex;
+
+/* The registered indexes, in the order of registration */
+static GList *query_indexes = NULL;
+
 struct _QofQueryTerm
 {
     QofQueryParamList *     param_list;
@@ -54,6 +70,7 @@ struct _QofQueryTerm
      */
     GSList *                param_fcns;
     QofQueryPredicateFunc   pred_fcn;
+    const QofQueryIndex *   index;      /* NULL if param_list isn't indexed */
 };
 
 struct _QofQuerySort
@@ -104,6 +121,18 @@ struct _QofQuery
     gint              changed;
 
     GList *           results;
+
+    /* When cache_results is set, results stay valid across runs, see
+     * qof_query_set_cache_results() */
+    gboolean          cache_results;
+    gint              cache_handler_id;
+    gboolean          cache_valid;
+    guint             cache_dropped_events;
+    GList *           cache_types;    /* Other types the terms reach */
+    GHashTable *      cache_pending;  /* Changed object -> last event */
+
+    /* Check the objects on several threads */
+    gboolean          parallel;
 };
 
 typedef struct _QofQueryCB
@@ -276,84 +305,260 @@ static void free_members (QofQuery *q)
     q->results = NULL;
 }
 
-static int cmp_func (const QofQuerySort *sort, QofSortFunc default_sort,
-                     const gconstpointer a, const gconstpointer b)
+/* Sorting extracts the keys of every object once up front instead of
+ * walking the parameter chains of both objects in every comparison.
+ * The values of the core types that are compared by value are pulled
+ * out too; other keys are compared with the sort's compare function on
+ * the object at the end of the chain. */
+typedef enum
+{
+    SORT_KEY_NONE,              /* Every object compares equal */
+    SORT_KEY_DEFAULT,           /* The searched-for type's default sort */
+    SORT_KEY_OBJECT,
+    SORT_KEY_DATE,
+    SORT_KEY_NUMERIC,
+    SORT_KEY_INTEGER,
+    SORT_KEY_DOUBLE,
+} QuerySortKeyType;
+
+typedef time64 (*query_date_getter) (gpointer, QofParam *);
+typedef gnc_numeric (*query_numeric_getter) (gpointer, QofParam *);
+typedef gint32 (*query_int32_getter) (gpointer, QofParam *);
+typedef gint64 (*query_int64_getter) (gpointer, QofParam *);
+typedef double (*query_double_getter) (gpointer, QofParam *);
+typedef gboolean (*query_boolean_getter) (gpointer, QofParam *);
+
+struct QuerySortLevel
+{
+    const QofQuerySort *sort;
+    QuerySortKeyType    type;
+    QofParam *          param;      /* The last one of the chain */
+};
+
+struct QuerySortKey
 {
-    QofParam *param = NULL;
-    GSList *node;
-    gpointer conva, convb;
+    gpointer conv;                  /* The object at the end of the chain */
+    union
+    {
+        time64      date;
+        gnc_numeric numeric;
+        gint64      integer;
+        double      dbl;
+    };
+};
+
+/* A match with its keys and its position in the match list, which
+ * breaks ties the way the stable g_list_sort() would. */
+struct QueryMatch
+{
+    gpointer        object;
+    guint           pos;
+    QuerySortKey    keys[3];
+};
 
-    g_return_val_if_fail (sort, 0);
+static QuerySortLevel
+query_sort_level (const QofQuery *q, const QofQuerySort *sort)
+{
+    QuerySortLevel level {sort, SORT_KEY_NONE, NULL};
+    QofIdTypeConst type;
 
-    /* See if this is a default sort */
     if (sort->use_default)
     {
-        if (default_sort) return default_sort (a, b);
-        return 0;
+        if (q->defaultSort)
+            level.type = SORT_KEY_DEFAULT;
+        return level;
     }
 
-    /* If no parameters, consider them equal */
-    if (!sort->param_fcns) return 0;
+    /* Without parameters or a compare function all are equal */
+    if (!sort->param_fcns || (!sort->comp_fcn && !sort->obj_cmp))
+        return level;
 
-    /* no compare function, consider the two objects equal */
-    if (!sort->comp_fcn && !sort->obj_cmp) return 0;
+    level.type = SORT_KEY_OBJECT;
+    level.param = static_cast<QofParam*>(g_slist_last (sort->param_fcns)->data);
 
-    /* Do the list of conversions */
-    conva = (gpointer)a;
-    convb = (gpointer)b;
-    for (node = static_cast<GSList*>(sort->param_fcns); node;
-	 node = static_cast<GSList*>(node->next))
-    {
-        param = static_cast<QofParam*>(node->data);
+    /* A parameter's own compare function may not compare by value */
+    if (sort->obj_cmp || level.param->param_compfcn)
+        return level;
 
-        /* The last term is really the "parameter getter",
-         * unless we're comparing objects ;) */
-        if (!node->next && !sort->obj_cmp)
-            break;
+    type = level.param->param_type;
+    if (!g_strcmp0 (type, QOF_TYPE_DATE))
+        level.type = SORT_KEY_DATE;
+    else if (!g_strcmp0 (type, QOF_TYPE_NUMERIC) ||
+             !g_strcmp0 (type, QOF_TYPE_DEBCRED))
+        level.type = SORT_KEY_NUMERIC;
+    else if (!g_strcmp0 (type, QOF_TYPE_INT32) ||
+             !g_strcmp0 (type, QOF_TYPE_INT64) ||
+             !g_strcmp0 (type, QOF_TYPE_BOOLEAN))
+        level.type = SORT_KEY_INTEGER;
+    else if (!g_strcmp0 (type, QOF_TYPE_DOUBLE))
+        level.type = SORT_KEY_DOUBLE;
+    return level;
+}
+
+static void
+query_sort_key (const QuerySortLevel& level, gpointer object, QuerySortKey& key)
+{
+    QofParam *param = level.param;
+    GSList *node;
+
+    key.conv = object;
+    if (level.type == SORT_KEY_NONE || level.type == SORT_KEY_DEFAULT)
+        return;
 
-        /* Do the conversions */
-        conva = (param->param_getfcn) (conva, param);
-        convb = (param->param_getfcn) (convb, param);
+    /* The last parameter is really the "parameter getter", unless
+     * we're comparing objects */
+    for (node = level.sort->param_fcns; node; node = node->next)
+    {
+        QofParam *conv_param = static_cast<QofParam*>(node->data);
+        if (!node->next && !level.sort->obj_cmp)
+            break;
+        key.conv = (conv_param->param_getfcn) (key.conv, conv_param);
     }
+    if (!key.conv)
+        return;
 
-    /* And now return the (appropriate) compare */
-    if (sort->comp_fcn)
+    switch (level.type)
     {
-        int rc = sort->comp_fcn (conva, convb, sort->options, param);
-        return rc;
+    case SORT_KEY_DATE:
+        key.date = ((query_date_getter)param->param_getfcn) (key.conv, param);
+        if (level.sort->options == QOF_DATE_MATCH_DAY)
+            key.date = time64CanonicalDayTime (key.date);
+        break;
+    case SORT_KEY_NUMERIC:
+        key.numeric = ((query_numeric_getter)param->param_getfcn) (key.conv, param);
+        break;
+    case SORT_KEY_INTEGER:
+        if (!g_strcmp0 (param->param_type, QOF_TYPE_INT64))
+            key.integer = ((query_int64_getter)param->param_getfcn) (key.conv, param);
+        else if (!g_strcmp0 (param->param_type, QOF_TYPE_INT32))
+            key.integer = ((query_int32_getter)param->param_getfcn) (key.conv, param);
+        else
+            key.integer = ((query_boolean_getter)param->param_getfcn) (key.conv, param) != 0;
+        break;
+    case SORT_KEY_DOUBLE:
+        key.dbl = ((query_double_getter)param->param_getfcn) (key.conv, param);
+        break;
+    default:
+        break;
     }
+}
 
-    return sort->obj_cmp (conva, convb);
+template <typename T> static int
+query_value_cmp (T a, T b)
+{
+    return a < b ? -1 : (a > b ? 1 : 0);
 }
 
 static int
-sort_func (const gconstpointer a, const gconstpointer b, const gpointer q)
+query_key_cmp (const QuerySortLevel& level, QofSortFunc default_sort,
+               const QueryMatch& a, const QueryMatch& b, int i)
 {
-    int retval;
-    const QofQuery *sortQuery = static_cast<const QofQuery*>(q);
+    const QuerySortKey& ka = a.keys[i];
+    const QuerySortKey& kb = b.keys[i];
+
+    switch (level.type)
+    {
+    case SORT_KEY_NONE:
+        return 0;
+    case SORT_KEY_DEFAULT:
+        return default_sort (a.object, b.object);
+    default:
+        break;
+    }
 
-    g_return_val_if_fail (sortQuery, 0);
+    /* The core compare functions can't compare missing objects and
+     * the sort needs a consistent order, so those go first. */
+    if (level.sort->comp_fcn && (!ka.conv || !kb.conv))
+        return (ka.conv != NULL) - (kb.conv != NULL);
 
-    retval = cmp_func (&(sortQuery->primary_sort), sortQuery->defaultSort, a, b);
-    if (retval == 0)
+    if (level.type == SORT_KEY_OBJECT)
     {
-        retval = cmp_func (&(sortQuery->secondary_sort), sortQuery->defaultSort,
-                           a, b);
-        if (retval == 0)
-        {
-            retval = cmp_func (&(sortQuery->tertiary_sort), sortQuery->defaultSort,
-                               a, b);
-            return sortQuery->tertiary_sort.increasing ? retval : -retval;
-        }
-        else
+        if (level.sort->comp_fcn)
+            return level.sort->comp_fcn (ka.conv, kb.conv, level.sort->options,
+                                         level.param);
+        return level.sort->obj_cmp (ka.conv, kb.conv);
+    }
+
+    switch (level.type)
+    {
+    case SORT_KEY_DATE:
+        return query_value_cmp (ka.date, kb.date);
+    case SORT_KEY_NUMERIC:
+        return gnc_numeric_compare (ka.numeric, kb.numeric);
+    case SORT_KEY_INTEGER:
+        return query_value_cmp (ka.integer, kb.integer);
+    case SORT_KEY_DOUBLE:
+        return query_value_cmp (ka.dbl, kb.dbl);
+    default:
+        return 0;
+    }
+}
+
+/* Sort the matches, freeing the list.  If there are more than
+ * max_results > 0 of them, only the last max_results in the sort order
+ * are returned, as sorting the whole list and cropping it would, but
+ * they are picked out with a bounded heap: it keeps the greatest
+ * max_results matches seen so far with the least of them on top, so
+ * only those get sorted. */
+static GList *
+query_sort_matches (const QofQuery *q, GList *matches, gint max_results)
+{
+    const QuerySortLevel levels[3] = {
+        query_sort_level (q, &q->primary_sort),
+        query_sort_level (q, &q->secondary_sort),
+        query_sort_level (q, &q->tertiary_sort),
+    };
+    auto less = [q, &levels](const QueryMatch& a, const QueryMatch& b)
+    {
+        for (int i = 0; i < 3; i++)
         {
-            return sortQuery->secondary_sort.increasing ? retval : -retval;
+            int ret = query_key_cmp (levels[i], q->defaultSort, a, b, i);
+            if (ret)
+                return levels[i].sort->increasing ? ret < 0 : ret > 0;
         }
+        return a.pos < b.pos;
+    };
+    auto greater = [&less](const QueryMatch& a, const QueryMatch& b)
+    {
+        return less (b, a);
+    };
+    std::vector<QueryMatch> items;
+    GList *node, *result = NULL;
+    guint pos = 0;
+
+    items.reserve (g_list_length (matches));
+    for (node = matches; node; node = node->next, ++pos)
+    {
+        QueryMatch match;
+        match.object = node->data;
+        match.pos = pos;
+        for (int i = 0; i < 3; i++)
+            query_sort_key (levels[i], match.object, match.keys[i]);
+        items.push_back (match);
     }
-    else
+    g_list_free (matches);
+
+    if (max_results > 0 && items.size () > static_cast<size_t>(max_results))
     {
-        return sortQuery->primary_sort.increasing ? retval : -retval;
+        auto end = items.begin () + max_results;
+        std::make_heap (items.begin (), end, greater);
+        for (auto it = end; it != items.end (); ++it)
+        {
+            if (!less (items.front (), *it))
+                continue;
+            std::pop_heap (items.begin (), end, greater);
+            *(end - 1) = *it;
+            std::push_heap (items.begin (), end, greater);
+        }
+        items.erase (end, items.end ());
     }
+
+    /* The positions make the order total, so this is as stable as
+     * g_list_sort() */
+    std::sort (items.begin (), items.end (), less);
+    for (auto it = items.rbegin (); it != items.rend (); ++it)
+        result = g_list_prepend (result, it->object);
+    return result;
 }
 
 /* ==================================================================== */
@@ -508,6 +713,24 @@ compile_sort (QofQuerySort *sort, QofIdType obj)
     LEAVE ("sort=%p id=%s", sort, obj);
 }
 
+static int param_list_cmp (const QofQueryParamList *l1,
+                           const QofQueryParamList *l2);
+
+static const QofQueryIndex *
+find_query_index (QofIdTypeConst obj_type, const QofQueryParamList *param_list)
+{
+    GList *node;
+
+    for (node = query_indexes; node; node = node->next)
+    {
+        const QofQueryIndex *index = static_cast<QofQueryIndex*>(node->data);
+        if (!g_strcmp0 (index->obj_type, obj_type) &&
+            !param_list_cmp (index->param_list, param_list))
+            return index;
+    }
+    return NULL;
+}
+
 static void compile_terms (QofQuery *q)
 {
     GList *or_ptr, *and_ptr, *node;
@@ -539,6 +762,13 @@ static void compile_terms (QofQuery *q)
                 qt->pred_fcn = qof_query_core_get_predicate (resObj->param_type);
             else
                 qt->pred_fcn = NULL;
+
+            /* An index can only narrow the search down to the objects
+             * that match a term, not to those that don't. */
+            if (qt->pred_fcn && !qt->invert)
+                qt->index = find_query_index (q->search_for, qt->param_list);
+            else
+                qt->index = NULL;
         }
     }
 
@@ -772,11 +1002,15 @@ static GList * qof_query_run_internal (QofQuery *q,
      */
     matching_objects = g_list_reverse(matching_objects);
 
-    /* Now sort the matching objects based on the search criteria */
+    /* Now sort the matching objects based on the search criteria.  If
+     * only the last few are wanted, only pick those out. */
     if (q->primary_sort.comp_fcn || q->primary_sort.obj_cmp ||
             (q->primary_sort.use_default && q->defaultSort))
     {
-        matching_objects = g_list_sort_with_data(matching_objects, sort_func, q);
+        matching_objects = query_sort_matches (q, matching_objects,
+                                               q->max_results);
+        if (q->max_results > 0 && object_count > q->max_results)
+            object_count = q->max_results;
     }
 
     /* Crop the list to limit the number of splits. */
@@ -814,6 +1048,162 @@ static GList * qof_query_run_internal (QofQuery *q,
     return matching_objects;
 }
 
+typedef struct
+{
+    GHashTable *    seen;
+    GList *         list;
+} QofQueryCandidates;
+
+static void
+collect_candidate_cb (QofInstance *inst, gpointer user_data)
+{
+    QofQueryCandidates *cand = static_cast<QofQueryCandidates*>(user_data);
+
+    /* The clauses of an OR may well return the same objects */
+    if (inst && g_hash_table_add (cand->seen, inst))
+        cand->list = g_list_prepend (cand->list, inst);
+}
+
+/* Return the term of the AND clause with the preferred index, or NULL
+ * if none of its terms is indexed. */
+static QofQueryTerm *
+clause_index_term (GList *and_terms)
+{
+    QofQueryTerm *best = NULL;
+    GList *node;
+
+    for (node = and_terms; node; node = node->next)
+    {
+        QofQueryTerm *qt = static_cast<QofQueryTerm*>(node->data);
+        if (qt->index && (!best || qt->index->order < best->index->order))
+            best = qt;
+    }
+    return best;
+}
+
+/* Collect the objects of book that may match the query from the
+ * indexes of its OR clauses.  Returns FALSE if one of the clauses
+ * isn't indexed or its index can't answer it, in which case the whole
+ * collection has to be searched. */
+static gboolean
+query_index_candidates (const QofQuery *q, QofBook *book, GList **candidates)
+{
+    QofQueryCandidates cand;
+    GList *or_ptr, *and_ptr;
+    gboolean ok = TRUE;
+
+    if (!q->terms)
+        return FALSE;
+    for (or_ptr = q->terms; or_ptr; or_ptr = or_ptr->next)
+        if (!clause_index_term (static_cast<GList*>(or_ptr->data)))
+            return FALSE;
+
+    cand.seen = g_hash_table_new (g_direct_hash, g_direct_equal);
+    cand.list = NULL;
+    for (or_ptr = q->terms; ok && or_ptr; or_ptr = or_ptr->next)
+    {
+        GList *and_terms = static_cast<GList*>(or_ptr->data);
+        const QofQueryIndex *index = clause_index_term (and_terms)->index;
+        GSList *pred_data = NULL;
+
+        for (and_ptr = and_terms; and_ptr; and_ptr = and_ptr->next)
+        {
+            QofQueryTerm *qt = static_cast<QofQueryTerm*>(and_ptr->data);
+            if (qt->index == index)
+                pred_data = g_slist_prepend (pred_data, qt->pdata);
+        }
+        pred_data = g_slist_reverse (pred_data);
+
+        ok = (index->index_fcn) (book, pred_data, collect_candidate_cb, &cand);
+        g_slist_free (pred_data);
+    }
+    g_hash_table_destroy (cand.seen);
+
+    if (!ok)
+    {
+        g_list_free (cand.list);
+        return FALSE;
+    }
+    *candidates = g_list_reverse (cand.list);
+    return TRUE;
+}
+
+/* Below this many objects per thread a parallel search isn't worth
+ * starting the threads for. */
+#define QUERY_OBJECTS_PER_THREAD 10000
+
+typedef struct
+{
+    const QofQuery *    query;
+    gpointer *          objects;
+    guint               n_objects;
+    GPtrArray *         found;
+} QofQuerySearch;
+
+static gpointer
+query_search_thread (gpointer data)
+{
+    QofQuerySearch *search = static_cast<QofQuerySearch*>(data);
+    guint i;
+
+    for (i = 0; i < search->n_objects; i++)
+        if (check_object (search->query, search->objects[i]))
+            g_ptr_array_add (search->found, search->objects[i]);
+    return NULL;
+}
+
+static void
+add_object_cb (QofInstance *inst, gpointer data)
+{
+    g_ptr_array_add (static_cast<GPtrArray*>(data), inst);
+}
+
+/* Check the objects in runs of about the same size on as many threads
+ * as there are processors and enough objects for, adding the matches
+ * to qcb in the objects' order, as check_item_cb does. */
+static void
+query_check_parallel (QofQueryCB *qcb, GPtrArray *objects)
+{
+    guint n_threads, i, j;
+    QofQuerySearch *searches;
+    GThread **threads;
+
+    n_threads = MIN ((guint)g_get_num_processors (),
+                     objects->len / QUERY_OBJECTS_PER_THREAD);
+    n_threads = MAX (n_threads, 1);
+    searches = g_new0 (QofQuerySearch, n_threads);
+    threads = g_new0 (GThread*, n_threads);
+
+    for (i = 0; i < n_threads; i++)
+    {
+        guint start = (guint64)objects->len * i / n_threads;
+        guint end = (guint64)objects->len * (i + 1) / n_threads;
+
+        searches[i].query = qcb->query;
+        searches[i].objects = objects->pdata + start;
+        searches[i].n_objects = end - start;
+        searches[i].found = g_ptr_array_new ();
+    }
+
+    for (i = 1; i < n_threads; i++)
+        threads[i] = g_thread_new ("query_search", query_search_thread,
+                                   &searches[i]);
+    query_search_thread (&searches[0]);
+
+    for (i = 0; i < n_threads; i++)
+    {
+        if (threads[i])
+            g_thread_join (threads[i]);
+        for (j = 0; j < searches[i].found->len; j++)
+            qcb->list = g_list_prepend (qcb->list,
+                                        g_ptr_array_index (searches[i].found, j));
+        qcb->count += searches[i].found->len;
+        g_ptr_array_free (searches[i].found, TRUE);
+    }
+    g_free (threads);
+    g_free (searches);
+}
+
 static void qof_query_run_cb(QofQueryCB* qcb, gpointer cb_arg)
 {
     GList *node;
@@ -839,16 +1229,202 @@ static void qof_query_run_cb(QofQueryCB* qcb, gpointer cb_arg)
             }
         }
 #endif
-        /* And then iterate over all the objects */
-        qof_object_foreach (qcb->query->search_for, book,
-                            (QofInstanceForeachCB) check_item_cb, qcb);
+        GList *candidates = NULL;
+        gboolean indexed;
+
+        /* And then iterate over the objects the indexes turn up, or
+         * over all the objects if they can't help. */
+        indexed = query_index_candidates (qcb->query, book, &candidates);
+        if (qcb->query->parallel)
+        {
+            GPtrArray *objects = g_ptr_array_new ();
+
+            if (indexed)
+                for (GList *cnode = candidates; cnode; cnode = cnode->next)
+                    g_ptr_array_add (objects, cnode->data);
+            else
+                qof_object_foreach (qcb->query->search_for, book,
+                                    add_object_cb, objects);
+            query_check_parallel (qcb, objects);
+            g_ptr_array_free (objects, TRUE);
+        }
+        else if (indexed)
+            g_list_foreach (candidates, check_item_cb, qcb);
+        else
+            qof_object_foreach (qcb->query->search_for, book,
+                                (QofInstanceForeachCB) check_item_cb, qcb);
+        g_list_free (candidates);
+    }
+}
+
+/* Add the object types param_fcns passes through on its way from the
+ * searched-for object to the value, and the type of the value too if
+ * it is an object compared with obj_cmp. */
+static GList *
+query_cache_add_types (GList *types, const GSList *param_fcns,
+                       gboolean obj_cmp)
+{
+    const GSList *node;
+
+    for (node = param_fcns; node; node = node->next)
+    {
+        const QofParam *param = static_cast<const QofParam*>(node->data);
+
+        if (!node->next && !obj_cmp)
+            break;
+        if (!g_list_find_custom (types, param->param_type,
+                                 (GCompareFunc)g_strcmp0))
+            types = g_list_prepend (types, (gpointer)param->param_type);
+    }
+    return types;
+}
+
+static gboolean
+query_is_sorted (const QofQuery *q)
+{
+    return (q->primary_sort.comp_fcn || q->primary_sort.obj_cmp ||
+            (q->primary_sort.use_default && q->defaultSort));
+}
+
+static void
+query_cache_event_handler (QofInstance *ent, QofEventId event_type,
+                           gpointer handler_data, gpointer event_data)
+{
+    QofQuery *q = static_cast<QofQuery*>(handler_data);
+
+    if (!q->cache_valid || !ent)
+        return;
+
+    if (!g_list_find (q->books, qof_instance_get_book (ent)))
+    {
+        /* The results die with their book */
+        if ((event_type & QOF_EVENT_DESTROY) && g_list_find (q->books, ent))
+            q->cache_valid = FALSE;
+        return;
+    }
+
+    if (!g_strcmp0 (ent->e_type, q->search_for))
+        g_hash_table_insert (q->cache_pending, ent, GINT_TO_POINTER (event_type));
+    else if (g_list_find_custom (q->cache_types, ent->e_type,
+                                 (GCompareFunc)g_strcmp0))
+        q->cache_valid = FALSE;
+}
+
+/* Bring the kept results up to date with the objects changed since
+ * the last run.  Returns FALSE if they can't be and the query must be
+ * run again. */
+static gboolean
+query_cache_update (QofQuery *q)
+{
+    GHashTableIter iter;
+    gpointer key, value;
+    GList *node, *next, *added = NULL;
+
+    if (!q->cache_valid || q->changed ||
+        q->cache_dropped_events != qof_event_get_dropped_count ())
+        return FALSE;
+    if (!g_hash_table_size (q->cache_pending))
+        return TRUE;
+
+    /* Which objects are cropped depends on all the others */
+    if (q->max_results > -1)
+        return FALSE;
+
+    for (node = q->results; node; node = next)
+    {
+        next = node->next;
+        if (g_hash_table_contains (q->cache_pending, node->data))
+            q->results = g_list_delete_link (q->results, node);
+    }
+
+    /* Destroyed and removed objects may be gone already, only look at
+     * the others. */
+    g_hash_table_iter_init (&iter, q->cache_pending);
+    while (g_hash_table_iter_next (&iter, &key, &value))
+    {
+        QofEventId event_type = GPOINTER_TO_INT (value);
+        if (event_type & (QOF_EVENT_DESTROY | QOF_EVENT_REMOVE))
+            continue;
+        if (qof_instance_get_destroying (key))
+            continue;
+        if (check_object (q, key))
+            added = g_list_prepend (added, key);
+    }
+    g_hash_table_remove_all (q->cache_pending);
+
+    if (added)
+    {
+        q->results = g_list_concat (q->results, added);
+        if (query_is_sorted (q))
+            q->results = query_sort_matches (q, q->results, -1);
+    }
+    return TRUE;
+}
+
+static void
+query_cache_fill (QofQuery *q)
+{
+    GList *or_ptr, *and_ptr;
+
+    g_list_free (q->cache_types);
+    q->cache_types = NULL;
+    for (or_ptr = q->terms; or_ptr; or_ptr = or_ptr->next)
+        for (and_ptr = static_cast<GList*>(or_ptr->data); and_ptr;
+             and_ptr = and_ptr->next)
+        {
+            QofQueryTerm *qt = static_cast<QofQueryTerm*>(and_ptr->data);
+            q->cache_types = query_cache_add_types (q->cache_types,
+                                                    qt->param_fcns, FALSE);
+        }
+    q->cache_types = query_cache_add_types (q->cache_types,
+                                            q->primary_sort.param_fcns,
+                                            q->primary_sort.obj_cmp != NULL);
+    q->cache_types = query_cache_add_types (q->cache_types,
+                                            q->secondary_sort.param_fcns,
+                                            q->secondary_sort.obj_cmp != NULL);
+    q->cache_types = query_cache_add_types (q->cache_types,
+                                            q->tertiary_sort.param_fcns,
+                                            q->tertiary_sort.obj_cmp != NULL);
+
+    g_hash_table_remove_all (q->cache_pending);
+    q->cache_dropped_events = qof_event_get_dropped_count ();
+    q->cache_valid = TRUE;
+}
+
+/* Give the backends that left objects out of their books the chance to
+ * load those the query could find. */
+static void
+query_load_on_demand (QofQuery *q)
+{
+    for (GList *node = q->books; node; node = node->next)
+    {
+        QofBook* book = static_cast<QofBook*>(node->data);
+        if (book->backend)
+            book->backend->load_for_query (book, q);
     }
 }
 
 GList * qof_query_run (QofQuery *q)
 {
-    /* Just a wrapper */
-    return qof_query_run_internal(q, qof_query_run_cb, NULL);
+    GList *results;
+
+    /* Loading objects drops the events that would update the cache, so
+     * this comes first. */
+    if (q)
+        query_load_on_demand (q);
+
+    if (q && q->cache_results && query_cache_update (q))
+    {
+        QOF_COUNT ("query.run-cached");
+        return q->results;
+    }
+
+    QOF_TIMER_START (run, "query.run");
+    results = qof_query_run_internal(q, qof_query_run_cb, NULL);
+    if (q && q->cache_results && !q->changed)
+        query_cache_fill (q);
+    QOF_TIMER_STOP (run);
+    return results;
 }
 
 static void qof_query_run_subq_cb(QofQueryCB* qcb, gpointer cb_arg)
@@ -992,6 +1568,7 @@ GSList * qof_query_get_term_type (QofQuery *q, QofQueryParamList *term_param)
 void qof_query_destroy (QofQuery *q)
 {
     if (!q) return;
+    qof_query_set_cache_results (q, FALSE);
     free_members (q);
     query_clear_compiles (q);
     g_hash_table_destroy (q->be_compiled);
@@ -1021,6 +1598,12 @@ QofQuery * qof_query_copy (QofQuery *q)
 
     copy->changed = 1;
 
+    copy->cache_results = FALSE;
+    copy->cache_handler_id = 0;
+    copy->cache_valid = FALSE;
+    copy->cache_types = NULL;
+    copy->cache_pending = NULL;
+
     return copy;
 }
 
@@ -1257,6 +1840,7 @@ void qof_query_set_sort_options (QofQuery *q, gint prim_op, gint sec_op,
     q->primary_sort.options = prim_op;
     q->secondary_sort.options = sec_op;
     q->tertiary_sort.options = tert_op;
+    q->cache_valid = FALSE;
 }
 
 void qof_query_set_sort_increasing (QofQuery *q, gboolean prim_inc,
@@ -1266,12 +1850,43 @@ void qof_query_set_sort_increasing (QofQuery *q, gboolean prim_inc,
     q->primary_sort.increasing = prim_inc;
     q->secondary_sort.increasing = sec_inc;
     q->tertiary_sort.increasing = tert_inc;
+    q->cache_valid = FALSE;
 }
 
 void qof_query_set_max_results (QofQuery *q, int n)
 {
     if (!q) return;
     q->max_results = n;
+    q->cache_valid = FALSE;
+}
+
+void qof_query_set_parallel (QofQuery *q, gboolean parallel)
+{
+    if (!q) return;
+    q->parallel = parallel;
+}
+
+void qof_query_set_cache_results (QofQuery *q, gboolean cache)
+{
+    if (!q) return;
+
+    if (cache && !q->cache_handler_id)
+    {
+        q->cache_pending = g_hash_table_new (g_direct_hash, g_direct_equal);
+        q->cache_handler_id =
+            qof_event_register_handler (query_cache_event_handler, q);
+    }
+    else if (!cache && q->cache_handler_id)
+    {
+        qof_event_unregister_handler (q->cache_handler_id);
+        q->cache_handler_id = 0;
+        g_hash_table_destroy (q->cache_pending);
+        q->cache_pending = NULL;
+        g_list_free (q->cache_types);
+        q->cache_types = NULL;
+    }
+    q->cache_results = cache;
+    q->cache_valid = FALSE;
 }
 
 void qof_query_add_guid_list_match (QofQuery *q, QofQueryParamList *param_list,
@@ -1349,10 +1964,37 @@ void qof_query_init (void)
 
 void qof_query_shutdown (void)
 {
+    GList *node;
+
+    for (node = query_indexes; node; node = node->next)
+    {
+        QofQueryIndex *index = static_cast<QofQueryIndex*>(node->data);
+        g_slist_free (index->param_list);
+        g_free (index);
+    }
+    g_list_free (query_indexes);
+    query_indexes = NULL;
+
     qof_class_shutdown ();
     qof_query_core_shutdown ();
 }
 
+void qof_query_register_index (QofIdTypeConst obj_type,
+                               QofQueryParamList *param_list,
+                               QofQueryIndexFunc index_fcn)
+{
+    QofQueryIndex *index;
+
+    g_return_if_fail (obj_type && param_list && index_fcn);
+
+    index = g_new0 (QofQueryIndex, 1);
+    index->obj_type = obj_type;
+    index->param_list = param_list;
+    index->index_fcn = index_fcn;
+    index->order = g_list_length (query_indexes);
+    query_indexes = g_list_append (query_indexes, index);
+}
+
 int qof_query_get_max_results (const QofQuery *q)
 {
     if (!q) return 0;
@@ -127,6 +127,35 @@ void qof_query_init (void);
 void qof_query_shutdown (void);
 // @}
 
+/* --------------------------------------------------------- */
+/** \name Query Indexes */
+// @{
+/** An index function calls cb for every object in book that may
+ *  satisfy all of the predicates in pred_data, which are the
+ *  non-inverted terms of one AND clause on the indexed parameter.
+ *  Passing objects that turn out not to match is fine, the query
+ *  checks every term on each candidate anyway; leaving out one that
+ *  does match is not.  Return FALSE, before calling cb, if the index
+ *  can't answer these predicates; the query then scans the whole
+ *  collection.
+ */
+typedef gboolean (*QofQueryIndexFunc) (QofBook *book, GSList *pred_data,
+                                       QofInstanceForeachCB cb,
+                                       gpointer user_data);
+
+/** Register an index for the parameter param_list of obj_type objects.
+ *  When every OR clause of a query for obj_type has a term on an
+ *  indexed parameter, the query only visits the candidates the
+ *  indexes return instead of every object in the book.  If a clause
+ *  has terms on more than one indexed parameter, the index registered
+ *  first is used, so register the most selective ones first.  The
+ *  param_list becomes the property of the query subsystem.
+ */
+void qof_query_register_index (QofIdTypeConst obj_type,
+                               QofQueryParamList *param_list,
+                               QofQueryIndexFunc index_fcn);
+// @}
+
 /* --------------------------------------------------------- */
 /** \name Low-Level API Functions */
 // @{
@@ -360,6 +389,30 @@ void qof_query_set_sort_increasing (QofQuery *q, gboolean prim_inc,
  */
 void qof_query_set_max_results (QofQuery *q, int n);
 
+/**
+ * Keep the results of the query from one qof_query_run() to the next.
+ * While caching, the query listens to the QOF events of its books.
+ * Changes to objects of the searched-for type are noted and applied
+ * to the kept results at the next run by checking only those objects
+ * again.  Any change to an object of another type that the terms or
+ * sorts reach through, or a missed event while events were suspended,
+ * makes the next run a full search.  So does changing the query
+ * itself.  Copies of the query don't cache.
+ */
+void qof_query_set_cache_results (QofQuery *q, gboolean cache);
+
+/**
+ * Check the objects against the terms on several threads.  Only set
+ * this if the getters of the terms' parameters and their predicates
+ * may run concurrently, that is if they only read the objects.  The
+ * plain fields of splits and transactions can, but running balances
+ * and account full names, which are computed and cached on first use,
+ * can't.  Searches over a large book get faster with the number of
+ * processors; small ones still run on the calling thread.  The
+ * results are the same as without it.
+ */
+void qof_query_set_parallel (QofQuery *q, gboolean parallel);
+
 /** Compare two queries for equality.
  * Query terms are compared each to each.
  * This is a simplistic
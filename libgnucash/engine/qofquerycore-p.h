@@ -69,6 +69,13 @@ typedef struct
     gboolean		is_regex;
     gchar *		matchstring;
     regex_t		compiled;
+    /* For case-insensitive matches, matchstring case-folded once, and
+     * normalized too for CONTAINS and NCONTAINS, with the shifts of a
+     * Horspool search for it if it is plain ASCII. */
+    gchar *		folded;
+    gsize		folded_len;
+    gboolean		folded_ascii;
+    guint8		skip[256];
 } query_string_def, *query_string_t;
 
 typedef struct
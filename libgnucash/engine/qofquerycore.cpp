@@ -125,6 +125,79 @@ static GHashTable *predEqualTable = NULL;
 
 /* QOF_TYPE_STRING */
 
+/* Return TRUE and the length of s if it is plain ASCII. */
+static gboolean
+string_is_ascii (const char *s, gsize *len)
+{
+    const char *p;
+
+    for (p = s; *p; p++)
+        if (*p & 0x80)
+            return FALSE;
+    *len = p - s;
+    return TRUE;
+}
+
+/* A Horspool search for the folded ASCII needle in the s of length n,
+ * folding s on the fly. */
+static gboolean
+ascii_substr_nocase (const char *s, gsize n, const query_string_def *pdata)
+{
+    const char *needle = pdata->folded;
+    gsize m = pdata->folded_len, i = 0;
+
+    if (m == 0)
+        return TRUE;
+
+    while (i + m <= n)
+    {
+        guchar last = g_ascii_tolower (s[i + m - 1]);
+        if (last == (guchar)needle[m - 1] &&
+            g_ascii_strncasecmp (s + i, needle, m - 1) == 0)
+            return TRUE;
+        i += pdata->skip[last];
+    }
+    return FALSE;
+}
+
+/* Case-fold and normalize a string as qof_utf8_substr_nocase() does.
+ * ASCII strings are left alone by both, save for the case. */
+static gboolean
+string_contains_nocase (const char *s, const query_string_def *pdata)
+{
+    gchar *casefold, *normalized;
+    gboolean ret;
+    gsize len;
+
+    if (string_is_ascii (s, &len))
+        return pdata->folded_ascii && ascii_substr_nocase (s, len, pdata);
+
+    casefold = g_utf8_casefold (s, -1);
+    normalized = g_utf8_normalize (casefold, -1, G_NORMALIZE_ALL);
+    g_free (casefold);
+    ret = strstr (normalized, pdata->folded) != NULL;
+    g_free (normalized);
+    return ret;
+}
+
+/* Compare as safe_strcasecmp() does: collate the case-folded strings. */
+static gboolean
+string_equal_nocase (const char *s, const query_string_def *pdata)
+{
+    gchar *casefold;
+    gboolean ret;
+    gsize len;
+
+    if (pdata->folded_ascii && string_is_ascii (s, &len))
+        return len == pdata->folded_len &&
+            g_ascii_strcasecmp (s, pdata->folded) == 0;
+
+    casefold = g_utf8_casefold (s, -1);
+    ret = g_utf8_collate (casefold, pdata->folded) == 0;
+    g_free (casefold);
+    return ret;
+}
+
 static int
 string_match_predicate (gpointer object,
                         QofParam *getter,
@@ -151,15 +224,9 @@ string_match_predicate (gpointer object,
         if (pdata->options == QOF_STRING_MATCH_CASEINSENSITIVE)
         {
             if (pd->how == QOF_COMPARE_CONTAINS || pd->how == QOF_COMPARE_NCONTAINS)
-            {
-                if (qof_utf8_substr_nocase (s, pdata->matchstring)) //uses strstr
-                    ret = 1;
-            }
+                ret = string_contains_nocase (s, pdata);
             else
-            {
-                 if (safe_strcasecmp (s, pdata->matchstring) == 0) //uses collate
-                    ret = 1;
-            }
+                ret = string_equal_nocase (s, pdata);
         }
         else
         {
@@ -248,6 +315,7 @@ string_free_pdata (QofQueryPredData *pd)
     if (pdata->is_regex)
         regfree (&pdata->compiled);
 
+    g_free (pdata->folded);
     g_free (pdata->matchstring);
     g_free (pdata);
 }
@@ -309,6 +377,29 @@ qof_query_string_predicate (QofQueryCompare how,
         }
         pdata->is_regex = TRUE;
     }
+    else if (options == QOF_STRING_MATCH_CASEINSENSITIVE)
+    {
+        gchar *casefold = g_utf8_casefold (str, -1);
+        gsize i;
+
+        if (how == QOF_COMPARE_CONTAINS || how == QOF_COMPARE_NCONTAINS)
+        {
+            pdata->folded = g_utf8_normalize (casefold, -1, G_NORMALIZE_ALL);
+            g_free (casefold);
+        }
+        else
+            pdata->folded = casefold;
+
+        pdata->folded_ascii = string_is_ascii (pdata->folded,
+                                               &pdata->folded_len);
+        if (pdata->folded_ascii)
+        {
+            gsize m = pdata->folded_len;
+            memset (pdata->skip, MIN (m, G_MAXUINT8), sizeof (pdata->skip));
+            for (i = 0; i + 1 < m; i++)
+                pdata->skip[(guchar)pdata->folded[i]] = MIN (m - 1 - i, G_MAXUINT8);
+        }
+    }
 
     return ((QofQueryPredData*)pdata);
 }
@@ -64,8 +64,12 @@ static QofLogModule log_module = QOF_MOD_SESSION;
 #include <boost/algorithm/string.hpp>
 #include <vector>
 #include <algorithm>
+#include <atomic>
+#include <mutex>
 #include <string>
 #include <sstream>
+#include <system_error>
+#include <thread>
 
 using ProviderVec =  std::vector<QofBackendProvider_ptr>;
 static ProviderVec s_providers;
@@ -124,6 +128,7 @@ QofSessionImpl::QofSessionImpl (QofBook* book) noexcept
     m_book {book},
     m_uri {},
     m_saving {false},
+    m_background_save {nullptr},
     m_last_err {},
     m_error_message {}
 {
@@ -157,6 +162,7 @@ QofSessionImpl::destroy_backend () noexcept
 {
     if (m_backend)
     {
+        finish_background_save ();
         clear_error ();
         delete m_backend;
         m_backend = nullptr;
@@ -227,7 +233,11 @@ QofSessionImpl::load (QofPercentageFunc percentage_func) noexcept
     if (m_backend)
     {
         m_backend->set_percentage(percentage_func);
+        QOF_TIMER_START (load, "backend.load");
+        QOF_TRACE_BEGIN (load);
         m_backend->load (m_book, LOAD_TYPE_INITIAL_LOAD);
+        QOF_TRACE_END (load, "backend", "load");
+        QOF_TIMER_STOP (load);
         push_error (m_backend->get_error(), {});
     }
 
@@ -250,6 +260,15 @@ QofSessionImpl::load (QofPercentageFunc percentage_func) noexcept
     LEAVE ("sess = %p, uri=%s", this, m_uri.c_str ());
 }
 
+void
+QofSessionImpl::discard_load (QofBackendError err) noexcept
+{
+    destroy_backend();
+    qof_book_destroy (m_book);
+    m_book = qof_book_new();
+    push_error (err, {});
+}
+
 void
 QofSessionImpl::begin (const char* new_uri, SessionOpenMode mode) noexcept
 {
@@ -338,6 +357,7 @@ void
 QofSessionImpl::end () noexcept
 {
     ENTER ("sess=%p uri=%s", this, m_uri.c_str ());
+    finish_background_save ();
     auto backend = qof_book_get_backend (m_book);
     if (backend != nullptr)
         backend->session_end();
@@ -440,6 +460,7 @@ QofSessionImpl::is_saving () const noexcept
 void
 QofSessionImpl::save (QofPercentageFunc percentage_func) noexcept
 {
+    finish_background_save ();
     if (!qof_book_session_not_saved (m_book)) //Clean book, nothing to do.
         return;
     m_saving = true;
@@ -457,7 +478,11 @@ QofSessionImpl::save (QofPercentageFunc percentage_func) noexcept
         if (qof_book_get_backend (m_book) != m_backend)
             qof_book_set_backend (m_book, m_backend);
         m_backend->set_percentage(percentage_func);
+        QOF_TIMER_START (sync, "backend.sync");
+        QOF_TRACE_BEGIN (sync);
         m_backend->sync(m_book);
+        QOF_TRACE_END (sync, "backend", "sync");
+        QOF_TIMER_STOP (sync);
         auto err = m_backend->get_error();
         if (err != ERR_BACKEND_NO_ERR)
         {
@@ -481,11 +506,16 @@ QofSessionImpl::save (QofPercentageFunc percentage_func) noexcept
 void
 QofSessionImpl::safe_save (QofPercentageFunc percentage_func) noexcept
 {
+    finish_background_save ();
     if (!(m_backend && m_book)) return;
     if (qof_book_get_backend (m_book) != m_backend)
         qof_book_set_backend (m_book, m_backend);
     m_backend->set_percentage(percentage_func);
+    QOF_TIMER_START (sync, "backend.sync");
+    QOF_TRACE_BEGIN (sync);
     m_backend->safe_sync(get_book ());
+    QOF_TRACE_END (sync, "backend", "safe-sync");
+    QOF_TIMER_STOP (sync);
     auto err = m_backend->get_error();
     auto msg = m_backend->get_message();
     if (err != ERR_BACKEND_NO_ERR)
@@ -495,13 +525,89 @@ QofSessionImpl::safe_save (QofPercentageFunc percentage_func) noexcept
     }
 }
 
+struct QofSessionSave
+{
+    /* Cleared if the save was finished before the idle callback ran. */
+    QofSessionImpl *session;
+    QofSessionSaveDone done_cb;
+    gpointer user_data;
+};
+
+static gboolean
+session_save_done_idle (gpointer data)
+{
+    auto save = static_cast<QofSessionSave*>(data);
+    if (save->session)
+    {
+        auto session = save->session;
+        auto err = session->finish_background_save ();
+        if (save->done_cb)
+            save->done_cb (session, err, save->user_data);
+    }
+    delete save;
+    return FALSE;
+}
+
+bool
+QofSessionImpl::save_in_background (QofSessionSaveDone done,
+                                    gpointer user_data) noexcept
+{
+    if (!m_backend || m_saving || !qof_book_session_not_saved (m_book))
+        return false;
+    ENTER ("sess=%p uri=%s", this, m_uri.c_str ());
+
+    if (qof_book_get_backend (m_book) != m_backend)
+        qof_book_set_backend (m_book, m_backend);
+    m_backend->set_percentage (nullptr);
+    auto save = new QofSessionSave {this, done, user_data};
+    m_saving = true;
+    m_background_save = save;
+    QOF_TRACE_BEGIN (sync);
+    auto started = m_backend->begin_background_sync (m_book, [save] {
+            g_idle_add (session_save_done_idle, save); });
+    QOF_TRACE_END (sync, "backend", "begin-background-sync");
+    if (!started)
+    {
+        m_background_save = nullptr;
+        m_saving = false;
+        delete save;
+        LEAVE ("backend can't save in the background");
+        return false;
+    }
+    LEAVE ("");
+    return true;
+}
+
+QofBackendError
+QofSessionImpl::finish_background_save () noexcept
+{
+    if (!m_background_save)
+        return ERR_BACKEND_NO_ERR;
+
+    /* The idle callback still frees it. */
+    m_background_save->session = nullptr;
+    m_background_save = nullptr;
+    m_backend->finish_background_sync ();
+    m_saving = false;
+    auto err = m_backend->get_error ();
+    if (err != ERR_BACKEND_NO_ERR)
+        push_error (err, m_backend->get_message ());
+    else
+        clear_error ();
+    return err;
+}
+
 void
 QofSessionImpl::ensure_all_data_loaded () noexcept
 {
     if (!(m_backend && m_book)) return;
     if (qof_book_get_backend (m_book) != m_backend)
         qof_book_set_backend (m_book, m_backend);
+    QOF_TIMER_START (load, "backend.load");
+    QOF_TRACE_BEGIN (load);
     m_backend->load(m_book, LOAD_TYPE_LOAD_ALL);
+    QOF_TRACE_END (load, "backend", "load-all");
+    QOF_TIMER_STOP (load);
     push_error (m_backend->get_error(), {});
 }
 
@@ -509,6 +615,8 @@ void
 QofSessionImpl::swap_books (QofSessionImpl & other) noexcept
 {
     ENTER ("sess1=%p sess2=%p", this, &other);
+    finish_background_save ();
+    other.finish_background_save ();
     // don't swap (that is, double-swap) read_only flags
     if (m_book && other.m_book)
         std::swap (m_book->read_only, other.m_book->read_only);
@@ -522,13 +630,13 @@ QofSessionImpl::swap_books (QofSessionImpl & other) noexcept
 bool
 QofSessionImpl::events_pending () const noexcept
 {
-    return false;
+    return m_backend && m_backend->events_pending ();
 }
 
 bool
 QofSessionImpl::process_events () const noexcept
 {
-    return false;
+    return m_backend && m_backend->process_events ();
 }
 
 /* XXX This exports the list of accounts to a file.  It does not
@@ -557,6 +665,63 @@ QofSessionImpl::export_session (QofSessionImpl & real_session,
     return true;
 }
 
+bool
+QofSessionImpl::stream_to (QofSessionImpl & target,
+                           QofPercentageFunc percentage_func) noexcept
+{
+    /* As in load(), there must be an empty book to load into. */
+    g_return_val_if_fail (m_book && qof_book_empty (m_book), false);
+
+    ENTER ("sess=%p uri=%s target uri=%s", this, m_uri.c_str (),
+           target.m_uri.c_str ());
+    clear_error ();
+    target.clear_error ();
+    if (!m_backend || !target.m_backend)
+    {
+        push_error (ERR_BACKEND_NO_HANDLER, "failed to load backend");
+        LEAVE ("error -- No backend!");
+        return false;
+    }
+
+    auto target_be = target.m_backend;
+    qof_book_set_backend (m_book, m_backend);
+    m_backend->set_percentage (percentage_func);
+    target_be->set_percentage (percentage_func);
+    if (!target_be->begin_stream (m_book))
+    {
+        auto err = target_be->get_error ();
+        target.push_error (err != ERR_BACKEND_NO_ERR ? err :
+                           ERR_BACKEND_NO_HANDLER, {});
+        LEAVE ("target can't be streamed to");
+        return false;
+    }
+
+    /* A backend that can't stream a book loads it whole instead, and the
+     * target writes it all in end_stream(). */
+    QOF_TIMER_START (stream, "backend.stream");
+    QOF_TRACE_BEGIN (stream);
+    if (!m_backend->load_streaming (m_book, target_be))
+        m_backend->load (m_book, LOAD_TYPE_INITIAL_LOAD);
+    QOF_TRACE_END (stream, "backend", "stream");
+    QOF_TIMER_STOP (stream);
+    push_error (m_backend->get_error (), {});
+
+    auto err = get_error ();
+    auto loaded = (err == ERR_BACKEND_NO_ERR ||
+                   err == ERR_FILEIO_FILE_TOO_OLD ||
+                   err == ERR_FILEIO_NO_ENCODING ||
+                   err == ERR_FILEIO_FILE_UPGRADE ||
+                   err == ERR_SQL_DB_TOO_OLD);
+    auto written = target_be->end_stream (m_book, loaded);
+    auto target_err = target_be->get_error ();
+    if (target_err != ERR_BACKEND_NO_ERR)
+        target.push_error (target_err, {});
+    else if (!written && loaded)
+        target.push_error (ERR_BACKEND_SERVER_ERR, {});
+    LEAVE ("sess=%p loaded=%d written=%d", this, loaded, written);
+    return loaded && written;
+}
+
 /* C Wrapper Functions */
 /* ====================================================================== */
 
@@ -625,6 +790,131 @@ qof_session_load (QofSession *session,
     session->load (percentage_func);
 }
 
+struct QofSessionLoad
+{
+    QofSession *session;
+    QofSessionLoadDone done_cb;
+    gpointer user_data;
+    std::thread worker;
+    std::atomic<bool> done {false};
+    std::atomic<bool> cancelled {false};
+    std::atomic<double> progress {0.0};
+    std::mutex message_mutex;
+    std::string message;
+};
+
+/* QofPercentageFunc has no user data, so the worker thread tells the
+ * progress callback which load it belongs to. */
+static thread_local QofSessionLoad *current_load = nullptr;
+
+static void
+session_load_progress (const char *message, double percent)
+{
+    auto load = current_load;
+    if (!load) return;
+    load->progress = percent;
+    if (message)
+    {
+        std::lock_guard<std::mutex> lock {load->message_mutex};
+        load->message = message;
+    }
+}
+
+static gboolean
+session_load_done_idle (gpointer data)
+{
+    auto load = static_cast<QofSessionLoad*>(data);
+    auto session = load->session;
+    auto done_cb = load->done_cb;
+    auto user_data = load->user_data;
+    auto err = qof_session_load_finish (load);
+    done_cb (session, err, user_data);
+    return FALSE;
+}
+
+QofSessionLoad *
+qof_session_load_async (QofSession *session, QofSessionLoadDone done,
+                        gpointer user_data)
+{
+    g_return_val_if_fail (session, nullptr);
+
+    auto load = new QofSessionLoad;
+    load->session = session;
+    load->done_cb = done;
+    load->user_data = user_data;
+
+    qof_event_suspend ();
+    try
+    {
+        load->worker = std::thread ([load] {
+            current_load = load;
+            qof_engine_write_lock ();
+            load->session->load (session_load_progress);
+            qof_engine_write_unlock ();
+            current_load = nullptr;
+            load->done = true;
+            if (load->done_cb)
+                g_idle_add (session_load_done_idle, load);
+        });
+    }
+    catch (const std::system_error& err)
+    {
+        PERR ("can't start the load thread: %s", err.what ());
+        qof_event_resume ();
+        delete load;
+        return nullptr;
+    }
+    return load;
+}
+
+gboolean
+qof_session_load_is_done (const QofSessionLoad *load)
+{
+    g_return_val_if_fail (load, TRUE);
+    return load->done;
+}
+
+double
+qof_session_load_get_progress (QofSessionLoad *load, char **message)
+{
+    g_return_val_if_fail (load, 0.0);
+    if (message)
+    {
+        std::lock_guard<std::mutex> lock {load->message_mutex};
+        *message = load->message.empty () ? nullptr :
+            g_strdup (load->message.c_str ());
+    }
+    return load->progress;
+}
+
+void
+qof_session_load_cancel (QofSessionLoad *load)
+{
+    g_return_if_fail (load);
+    load->cancelled = true;
+}
+
+QofBackendError
+qof_session_load_finish (QofSessionLoad *load)
+{
+    g_return_val_if_fail (load, ERR_BACKEND_MISC);
+
+    load->worker.join ();
+    qof_event_resume ();
+
+    auto session = load->session;
+    QofBackendError err;
+    if (load->cancelled)
+    {
+        session->discard_load (ERR_BACKEND_CANCELLED);
+        err = ERR_BACKEND_CANCELLED;
+    }
+    else
+        err = session->get_error ();
+    delete load;
+    return err;
+}
+
 void
 qof_session_save (QofSession *session,
                   QofPercentageFunc percentage_func)
@@ -633,6 +923,17 @@ qof_session_save (QofSession *session,
     session->save (percentage_func);
 }
 
+gboolean
+qof_session_stream (QofSession *session, QofSession *target,
+                    QofPercentageFunc percentage_func)
+{
+    if (!session || !target || session == target) return FALSE;
+    qof_event_suspend ();
+    auto ok = session->stream_to (*target, percentage_func);
+    qof_event_resume ();
+    return ok;
+}
+
 void
 qof_session_safe_save(QofSession *session, QofPercentageFunc percentage_func)
 {
@@ -640,6 +941,21 @@ qof_session_safe_save(QofSession *session, QofPercentageFunc percentage_func)
     session->safe_save (percentage_func);
 }
 
+gboolean
+qof_session_save_in_background (QofSession *session, QofSessionSaveDone done,
+                                gpointer user_data)
+{
+    if (!session) return FALSE;
+    return session->save_in_background (done, user_data);
+}
+
+QofBackendError
+qof_session_finish_background_save (QofSession *session)
+{
+    if (!session) return ERR_BACKEND_NO_ERR;
+    return session->finish_background_save ();
+}
+
 gboolean
 qof_session_save_in_progress(const QofSession *session)
 {
@@ -200,6 +200,69 @@ typedef void (*QofPercentageFunc) (const char *message, double percent);
 void qof_session_load (QofSession *session,
                        QofPercentageFunc percentage_func);
 
+/**
+ * The qof_session_stream() method loads the book of @a session, which
+ *    must be empty, and writes it to the new store @a target was begun
+ *    with as it goes.  Backends that support it, i.e. XML files read into
+ *    SQL databases, keep only what's still needed in memory, so that the
+ *    largest books can be converted; otherwise the whole book is loaded
+ *    and then written.
+ *
+ *    Errors reading are reported by @a session and errors writing by
+ *    @a target; either way the target store is left empty.
+ *
+ * @return TRUE if the whole book was written.
+ */
+gboolean qof_session_stream (QofSession *session, QofSession *target,
+                             QofPercentageFunc percentage_func);
+
+/** @name Asynchronous Loading
+ *
+ * qof_session_load_async() runs qof_session_load() on a worker thread
+ * and returns at once with a handle for following its progress.
+ *
+ * Until the load is finished the caller must leave the session and its
+ * book alone.  Events are suspended for the duration, so event handlers
+ * don't see the half-loaded book from the worker thread; in concurrent
+ * read mode (see qof_engine_set_concurrent_reads()) the worker holds
+ * the engine write lock.
+ *
+ * Backends can't be interrupted, so cancelling lets the load run to its
+ * end and then throws the result away, leaving an empty book and
+ * ERR_BACKEND_CANCELLED.
+ @{ */
+typedef struct QofSessionLoad QofSessionLoad;
+
+/** Called from the main loop when an asynchronous load is finished.  The
+ * handle has already been released. */
+typedef void (*QofSessionLoadDone) (QofSession *session, QofBackendError err,
+                                    gpointer user_data);
+
+/** Start loading @a session on a worker thread.  If @a done is given it is
+ * run from the default main context when the load is over and releases
+ * the handle; otherwise the caller must call qof_session_load_finish().
+ * @return The load handle, or NULL if the thread couldn't be started. */
+QofSessionLoad *qof_session_load_async (QofSession *session,
+                                        QofSessionLoadDone done,
+                                        gpointer user_data);
+
+/** @return TRUE once the worker thread has finished loading. */
+gboolean qof_session_load_is_done (const QofSessionLoad *load);
+
+/** @return The last percentage the backend reported.  If @a message isn't
+ * NULL it's set to a copy of the last progress message, or NULL; free it
+ * with g_free(). */
+double qof_session_load_get_progress (QofSessionLoad *load, char **message);
+
+/** Ask for the load to be discarded when the backend is finished. */
+void qof_session_load_cancel (QofSessionLoad *load);
+
+/** Wait for a load started without a @a done callback, release the
+ * handle and resume events.
+ * @return The session's error, or ERR_BACKEND_CANCELLED. */
+QofBackendError qof_session_load_finish (QofSessionLoad *load);
+/** @} */
+
 /** @name Session Errors
  @{ */
 /** The qof_session_get_error() routine can be used to obtain the reason
@@ -249,6 +312,35 @@ const char * qof_session_get_url (const QofSession *session);
 /* gboolean qof_session_not_saved(const QofSession *session); <- unimplemented */
 gboolean qof_session_save_in_progress(const QofSession *session);
 
+/** @name Background Saving
+ *
+ * qof_session_save_in_background() saves the way qof_session_save() does,
+ * except that if the backend supports it the data is written out on a
+ * worker thread.  The backend takes what it needs from the book before
+ * returning, so the book may be edited while the save runs; the changes
+ * are left for the next save.
+ *
+ * qof_session_save_in_progress() is TRUE until the save has ended.
+ * Saving again or ending the session first waits for it.
+ @{ */
+/** Called from the default main context when a background save has
+ *  ended, with the error qof_session_get_error() would give. */
+typedef void (*QofSessionSaveDone) (QofSession *session, QofBackendError err,
+                                    gpointer user_data);
+
+/** Start saving @a session in the background.
+ * @return TRUE if the save was started, in which case @a done (if given)
+ * is called when it ends.  FALSE if there's nothing to save, a save is
+ * already running, or the backend can only save with qof_session_save(). */
+gboolean qof_session_save_in_background (QofSession *session,
+                                         QofSessionSaveDone done,
+                                         gpointer user_data);
+/** Wait for a background save to end, without calling its @a done.  If
+ * it failed the book is left marked unsaved.
+ * @return The save's error, or ERR_BACKEND_NO_ERR if none was running. */
+QofBackendError qof_session_finish_background_save (QofSession *session);
+/** @} */
+
 /**
  * Returns the qof session's backend.
  */
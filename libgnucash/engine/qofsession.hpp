@@ -49,8 +49,14 @@ struct QofSessionImpl
     void load (QofPercentageFunc) noexcept;
     void save (QofPercentageFunc) noexcept;
     void safe_save (QofPercentageFunc) noexcept;
+    bool save_in_background (QofSessionSaveDone, gpointer) noexcept;
+    /** Wait for a background save and record its error.  Returns the
+     * error, or ERR_BACKEND_NO_ERR if there was no save to wait for. */
+    QofBackendError finish_background_save () noexcept;
     bool save_in_progress () const noexcept;
     bool export_session (QofSessionImpl & real_session, QofPercentageFunc) noexcept;
+    /** Load this session's book while writing it to target's store. */
+    bool stream_to (QofSessionImpl & target, QofPercentageFunc) noexcept;
 
     bool events_pending () const noexcept;
     bool process_events () const noexcept;
@@ -79,6 +85,8 @@ struct QofSessionImpl
      */
     void end () noexcept;
     void destroy_backend () noexcept;
+    /** Throw away whatever was loaded, leaving an empty book and @a err. */
+    void discard_load (QofBackendError err) noexcept;
 
 private:
     void push_error (QofBackendError const err, std::string message) noexcept;
@@ -99,6 +107,8 @@ private:
 
     bool m_saving;
     bool m_creating;
+    /* The background save in progress, if any. */
+    struct QofSessionSave* m_background_save;
 
     /* If any book subroutine failed, this records the failure reason
      * (file not found, etc).
@@ -215,6 +215,48 @@ gboolean gnc_strisnum(const gchar *s);
 #define stpcpy g_stpcpy
 #endif
 
+/** @name Concurrent reads
+ *
+ * By default the engine must only be used from one thread.  In
+ * concurrent read mode other threads may call the engine's getters
+ * (accounts, splits, transactions, price lookups) as long as they hold
+ * the read lock, while edits write-lock the engine: qof_begin_edit()
+ * takes the write lock for the main loop's thread until the loop is
+ * idle again, so readers never see an edit in progress.  Other threads
+ * making changes must bracket them with qof_engine_write_lock() and
+ * qof_engine_write_unlock().  A thread holding the read lock must not
+ * make changes.
+ *
+ * The caches the engine fills lazily while reading (account balances,
+ * split lists, subtree balances and full names, the transaction query
+ * indexes, the pricedb's conversion paths and the instances' slot
+ * frames) are guarded in this mode.
+ * @{
+ */
+
+/** Switch concurrent read mode on or off.  Do this while no other
+ *  thread uses the engine. */
+void qof_engine_set_concurrent_reads (gboolean enabled);
+gboolean qof_engine_get_concurrent_reads (void);
+
+/** Take and release the shared lock for reading.  No-ops unless
+ *  concurrent read mode is on. */
+void qof_engine_read_lock (void);
+void qof_engine_read_unlock (void);
+
+/** Take and release the exclusive lock for changes.  The calls nest
+ *  within a thread.  No-ops unless concurrent read mode is on. */
+void qof_engine_write_lock (void);
+void qof_engine_write_unlock (void);
+
+/** Take and release the lock for filling a lazy cache while reading.
+ *  Only the writer empties such caches, so what a reader finds filled
+ *  stays valid while it holds the read lock.  The calls nest within a
+ *  thread.  No-ops unless concurrent read mode is on. */
+void qof_engine_cache_lock (void);
+void qof_engine_cache_unlock (void);
+/** @} */
+
 /** begin_edit
  *
  * @param  inst: an instance of QofInstance
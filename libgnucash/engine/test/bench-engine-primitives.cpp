@@ -0,0 +1,372 @@
+/********************************************************************
+ * bench-engine-primitives.cpp: Google Benchmark timings of the     *
+ * numeric, date, GUID and KVP primitives of the engine.            *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, you can retrieve it from        *
+ * https://www.gnu.org/licenses/old-licenses/gpl-2.0.html            *
+ * or contact:                                                      *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ ********************************************************************/
+
+/* Run with --benchmark_filter=<regex> to time only some of them, and
+ * compare runs before and after a change with Google Benchmark's
+ * tools/compare.py. */
+
+#include <config.h>
+#include <guid.hpp>
+#include "../gnc-int128.hpp"
+#include "../gnc-numeric.hpp"
+#include "../gnc-datetime.hpp"
+#include "../gnc-timezone.hpp"
+#include "../kvp-value.hpp"
+#include "../kvp-frame.hpp"
+#include <benchmark/benchmark.h>
+#include <string>
+#include <vector>
+
+/* The denominators the numeric benchmarks are run with: the same as the
+ * other operand's, a multiple of it, a power of ten it doesn't divide,
+ * and one that isn't a power of ten. */
+static void
+denominators (benchmark::internal::Benchmark* b)
+{
+    for (int64_t denom : {100, 10000, 1000000, 7})
+        b->Arg (denom);
+}
+
+static void
+BM_GncNumericAdd (benchmark::State& state)
+{
+    GncNumeric a{1234567, 100}, b{7654321, state.range (0)};
+    for (auto _ : state)
+        benchmark::DoNotOptimize (a + b);
+}
+BENCHMARK(BM_GncNumericAdd)->Apply (denominators);
+
+static void
+BM_GncNumericSub (benchmark::State& state)
+{
+    GncNumeric a{1234567, 100}, b{7654321, state.range (0)};
+    for (auto _ : state)
+        benchmark::DoNotOptimize (a - b);
+}
+BENCHMARK(BM_GncNumericSub)->Apply (denominators);
+
+static void
+BM_GncNumericMul (benchmark::State& state)
+{
+    GncNumeric a{1234567, 100}, b{7654321, state.range (0)};
+    for (auto _ : state)
+        benchmark::DoNotOptimize (a * b);
+}
+BENCHMARK(BM_GncNumericMul)->Apply (denominators);
+
+static void
+BM_GncNumericDiv (benchmark::State& state)
+{
+    GncNumeric a{1234567, 100}, b{7654321, state.range (0)};
+    for (auto _ : state)
+        benchmark::DoNotOptimize (a / b);
+}
+BENCHMARK(BM_GncNumericDiv)->Apply (denominators);
+
+static void
+BM_GncNumericConvert (benchmark::State& state)
+{
+    GncNumeric a{123456789, 1000000};
+    for (auto _ : state)
+        benchmark::DoNotOptimize (a.convert<RoundType::half_up>(state.range (0)));
+}
+BENCHMARK(BM_GncNumericConvert)->Apply (denominators);
+
+static void
+BM_GncNumericReduce (benchmark::State& state)
+{
+    GncNumeric a{123450000, 1000000};
+    for (auto _ : state)
+        benchmark::DoNotOptimize (a.reduce ());
+}
+BENCHMARK(BM_GncNumericReduce);
+
+static void
+BM_GncNumericFromString (benchmark::State& state)
+{
+    std::string str{"12345.67"};
+    for (auto _ : state)
+        benchmark::DoNotOptimize (GncNumeric{str});
+}
+BENCHMARK(BM_GncNumericFromString);
+
+static void
+BM_GncNumericToString (benchmark::State& state)
+{
+    GncNumeric a{1234567, 100};
+    for (auto _ : state)
+        benchmark::DoNotOptimize (a.to_string ());
+}
+BENCHMARK(BM_GncNumericToString);
+
+/* The C API, as most of the engine still calls it. */
+static void
+BM_gnc_numeric_add (benchmark::State& state)
+{
+    auto a = gnc_numeric_create (1234567, 100);
+    auto b = gnc_numeric_create (7654321, state.range (0));
+    for (auto _ : state)
+        benchmark::DoNotOptimize (gnc_numeric_add (a, b, GNC_DENOM_AUTO,
+                                                   GNC_HOW_DENOM_LCD));
+}
+BENCHMARK(BM_gnc_numeric_add)->Apply (denominators);
+
+static void
+BM_gnc_numeric_mul_round (benchmark::State& state)
+{
+    auto a = gnc_numeric_create (1234567, 100);
+    auto b = gnc_numeric_create (7654321, state.range (0));
+    for (auto _ : state)
+        benchmark::DoNotOptimize (gnc_numeric_mul (a, b, 100,
+                                                   GNC_HOW_RND_ROUND_HALF_UP));
+}
+BENCHMARK(BM_gnc_numeric_mul_round)->Apply (denominators);
+
+/* The GncInt128 operands are small (both halves in the lower leg) or
+ * big (a full upper leg), the operations' fast and slow paths. */
+static GncInt128
+int128_operand (bool big, int64_t lower)
+{
+    return big ? GncInt128 (INT64_C (0x1234567), static_cast<uint64_t>(lower))
+               : GncInt128 (lower);
+}
+
+static void
+BM_GncInt128Add (benchmark::State& state)
+{
+    auto a = int128_operand (state.range (0), INT64_C (123456789012345));
+    auto b = int128_operand (state.range (0), INT64_C (987654321098765));
+    for (auto _ : state)
+        benchmark::DoNotOptimize (a + b);
+}
+BENCHMARK(BM_GncInt128Add)->Arg (0)->Arg (1);
+
+static void
+BM_GncInt128Mul (benchmark::State& state)
+{
+    auto a = int128_operand (state.range (0), INT64_C (123456789012345));
+    GncInt128 b{INT64_C (987654321)};
+    for (auto _ : state)
+        benchmark::DoNotOptimize (a * b);
+}
+BENCHMARK(BM_GncInt128Mul)->Arg (0)->Arg (1);
+
+static void
+BM_GncInt128Div (benchmark::State& state)
+{
+    auto a = int128_operand (state.range (0), INT64_C (123456789012345));
+    GncInt128 b{INT64_C (987654321)};
+    for (auto _ : state)
+        benchmark::DoNotOptimize (a / b);
+}
+BENCHMARK(BM_GncInt128Div)->Arg (0)->Arg (1);
+
+static void
+BM_GncInt128Gcd (benchmark::State& state)
+{
+    auto a = int128_operand (state.range (0), INT64_C (123456789012345));
+    GncInt128 b{INT64_C (1000000)};
+    for (auto _ : state)
+        benchmark::DoNotOptimize (a.gcd (b));
+}
+BENCHMARK(BM_GncInt128Gcd)->Arg (0)->Arg (1);
+
+static void
+BM_GncDateTimeFromTime64 (benchmark::State& state)
+{
+    time64 t = INT64_C (1592224496);
+    for (auto _ : state)
+        benchmark::DoNotOptimize (GncDateTime{t++});
+}
+BENCHMARK(BM_GncDateTimeFromTime64);
+
+static void
+BM_GncDateTimeNow (benchmark::State& state)
+{
+    for (auto _ : state)
+        benchmark::DoNotOptimize (GncDateTime{});
+}
+BENCHMARK(BM_GncDateTimeNow);
+
+static void
+BM_GncDateTimeFormat (benchmark::State& state)
+{
+    GncDateTime dt{static_cast<time64>(INT64_C (1592224496))};
+    for (auto _ : state)
+        benchmark::DoNotOptimize (dt.format ("%Y-%m-%d %H:%M:%S"));
+}
+BENCHMARK(BM_GncDateTimeFormat);
+
+static void
+BM_GncDateTimeFormatIso8601 (benchmark::State& state)
+{
+    GncDateTime dt{static_cast<time64>(INT64_C (1592224496))};
+    for (auto _ : state)
+        benchmark::DoNotOptimize (dt.format_iso8601 ());
+}
+BENCHMARK(BM_GncDateTimeFormatIso8601);
+
+static void
+BM_GncDateTimeParse (benchmark::State& state)
+{
+    std::string str{"2020-06-15 12:34:56"};
+    for (auto _ : state)
+        benchmark::DoNotOptimize (GncDateTime{str});
+}
+BENCHMARK(BM_GncDateTimeParse);
+
+static void
+BM_GncDateParse (benchmark::State& state)
+{
+    std::string str{"2020-06-15"}, fmt{"y-m-d"};
+    for (auto _ : state)
+        benchmark::DoNotOptimize (GncDate{str, fmt});
+}
+BENCHMARK(BM_GncDateParse);
+
+static void
+BM_gnc_mktime (benchmark::State& state)
+{
+    struct tm tm{};
+    tm.tm_year = 120;
+    tm.tm_mon = 5;
+    tm.tm_mday = 15;
+    tm.tm_hour = 12;
+    for (auto _ : state)
+    {
+        auto copy = tm;
+        benchmark::DoNotOptimize (gnc_mktime (&copy));
+    }
+}
+BENCHMARK(BM_gnc_mktime);
+
+static void
+BM_TimeZoneProviderGet (benchmark::State& state)
+{
+    static TimeZoneProvider tzp;
+    int year = 1900;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize (tzp.get (year));
+        year = year == 2100 ? 1900 : year + 1;
+    }
+}
+BENCHMARK(BM_TimeZoneProviderGet);
+
+static void
+BM_guid_to_string_buff (benchmark::State& state)
+{
+    auto guid = guid_new_return ();
+    char buff[GUID_ENCODING_LENGTH + 1];
+    for (auto _ : state)
+        benchmark::DoNotOptimize (guid_to_string_buff (&guid, buff));
+}
+BENCHMARK(BM_guid_to_string_buff);
+
+static void
+BM_guid_to_string (benchmark::State& state)
+{
+    auto guid = guid_new_return ();
+    for (auto _ : state)
+        g_free (guid_to_string (&guid));
+}
+BENCHMARK(BM_guid_to_string);
+
+static void
+BM_string_to_guid (benchmark::State& state)
+{
+    auto guid = guid_new_return ();
+    auto str = guid_to_string (&guid);
+    GncGUID result;
+    for (auto _ : state)
+        benchmark::DoNotOptimize (string_to_guid (str, &result));
+    g_free (str);
+}
+BENCHMARK(BM_string_to_guid);
+
+static void
+BM_guid_new (benchmark::State& state)
+{
+    for (auto _ : state)
+        benchmark::DoNotOptimize (guid_new_return ());
+}
+BENCHMARK(BM_guid_new);
+
+/* A frame with range(0) slots at the top, as a busy object has. */
+static void
+fill_frame (KvpFrame& frame, int64_t n_slots)
+{
+    for (int64_t i = 0; i < n_slots; ++i)
+    {
+        auto key = "key-" + std::to_string (i);
+        delete frame.set (key.c_str(), new KvpValue{i});
+    }
+}
+
+static void
+BM_KvpFrameGetSlot (benchmark::State& state)
+{
+    KvpFrame frame;
+    fill_frame (frame, state.range (0));
+    auto key = "key-" + std::to_string (state.range (0) / 2);
+    for (auto _ : state)
+        benchmark::DoNotOptimize (frame.get_slot (key.c_str()));
+}
+BENCHMARK(BM_KvpFrameGetSlot)->Arg (1)->Arg (8)->Arg (64);
+
+static void
+BM_KvpFrameSet (benchmark::State& state)
+{
+    KvpFrame frame;
+    fill_frame (frame, state.range (0));
+    auto key = "key-" + std::to_string (state.range (0) / 2);
+    int64_t i = 0;
+    for (auto _ : state)
+        delete frame.set (key.c_str(), new KvpValue{i++});
+}
+BENCHMARK(BM_KvpFrameSet)->Arg (1)->Arg (8)->Arg (64);
+
+static void
+BM_KvpFrameGetSlotPath (benchmark::State& state)
+{
+    KvpFrame frame;
+    delete frame.set_path ({"online_id", "bank", "account"},
+                           new KvpValue{g_strdup ("12345678")});
+    for (auto _ : state)
+        benchmark::DoNotOptimize (frame.get_slot ({"online_id", "bank", "account"}));
+}
+BENCHMARK(BM_KvpFrameGetSlotPath);
+
+static void
+BM_KvpFrameSetPath (benchmark::State& state)
+{
+    KvpFrame frame;
+    int64_t i = 0;
+    for (auto _ : state)
+        delete frame.set_path ({"online_id", "bank", "account"},
+                               new KvpValue{i++});
+}
+BENCHMARK(BM_KvpFrameSetPath);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,132 @@
+/********************************************************************
+ * gtest-book-archive.cpp -- Tests of the archived starting balances *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or   *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+\********************************************************************/
+
+extern "C"
+{
+#include <config.h>
+#include "../Account.h"
+#include "../Transaction.h"
+#include "../gnc-book-archive.h"
+#include <qof.h>
+}
+
+#include <qofinstance-p.h>
+#include <gtest/gtest.h>
+
+class BookArchiveTest : public testing::Test
+{
+protected:
+    void SetUp() {
+        m_book = qof_book_new();
+        auto root = gnc_account_create_root(m_book);
+
+        m_bank = xaccMallocAccount(m_book);
+        xaccAccountSetName(m_bank, "Bank");
+        gnc_account_append_child(root, m_bank);
+
+        m_expense = xaccMallocAccount(m_book);
+        xaccAccountSetName(m_expense, "Expense");
+        gnc_account_append_child(root, m_expense);
+
+        auto trans = xaccMallocTransaction(m_book);
+        xaccTransBeginEdit(trans);
+        for (auto acc : {m_bank, m_expense})
+        {
+            auto split = xaccMallocSplit(m_book);
+            auto amount = gnc_numeric_create(acc == m_bank ? -500 : 500, 100);
+            xaccSplitSetParent(split, trans);
+            xaccSplitSetAccount(split, acc);
+            xaccSplitSetAmount(split, amount);
+            xaccSplitSetValue(split, amount);
+        }
+        xaccTransCommitEdit(trans);
+    }
+    void TearDown() {
+        auto root = gnc_book_get_root_account(m_book);
+        xaccAccountBeginEdit(root);
+        xaccAccountDestroy(root);
+        qof_book_destroy(m_book);
+    }
+
+    /* What gnc_book_archive_transactions leaves in the book and the
+     * bank account after moving a 100.00 deposit, 40.00 of it cleared. */
+    void archive() {
+        GValue v = G_VALUE_INIT;
+        g_value_init(&v, G_TYPE_STRING);
+        g_value_set_string(&v, "file:///tmp/archive.gnucash");
+        qof_instance_set_kvp(QOF_INSTANCE(m_book), &v, 2, "archive-file", "uri");
+        g_value_unset(&v);
+
+        for (auto slot : {"balance", "cleared-balance"})
+        {
+            auto amount = gnc_numeric_create(g_strcmp0(slot, "balance") ?
+                                             4000 : 10000, 100);
+            g_value_init(&v, GNC_TYPE_NUMERIC);
+            g_value_set_boxed(&v, &amount);
+            qof_instance_set_kvp(QOF_INSTANCE(m_bank), &v, 2, "archive-file", slot);
+            g_value_unset(&v);
+        }
+    }
+
+    QofBook *m_book {};
+    Account *m_bank {};
+    Account *m_expense {};
+};
+
+TEST_F(BookArchiveTest, no_archive)
+{
+    EXPECT_EQ(nullptr, gnc_book_archive_get_uri(m_book));
+    EXPECT_EQ(G_MININT64, gnc_book_archive_get_date(m_book));
+    EXPECT_EQ(nullptr, gnc_book_archive_get_book(m_book));
+
+    gnc_numeric balance, cleared;
+    gnc_account_get_archived_balances(m_bank, &balance, &cleared, nullptr,
+                                      nullptr);
+    EXPECT_TRUE(gnc_numeric_zero_p(balance));
+    EXPECT_TRUE(gnc_numeric_zero_p(cleared));
+
+    gnc_book_archive_set_start_balances(m_book);
+    EXPECT_TRUE(gnc_numeric_equal(gnc_numeric_create(-500, 100),
+                                  xaccAccountGetBalance(m_bank)));
+}
+
+TEST_F(BookArchiveTest, start_balances)
+{
+    archive();
+    auto uri = gnc_book_archive_get_uri(m_book);
+    EXPECT_STREQ("file:///tmp/archive.gnucash", uri);
+    g_free(uri);
+
+    gnc_numeric balance, cleared, reconciled;
+    gnc_account_get_archived_balances(m_bank, &balance, &cleared, &reconciled,
+                                      nullptr);
+    EXPECT_TRUE(gnc_numeric_equal(gnc_numeric_create(100, 1), balance));
+    EXPECT_TRUE(gnc_numeric_equal(gnc_numeric_create(40, 1), cleared));
+    EXPECT_TRUE(gnc_numeric_zero_p(reconciled));
+
+    gnc_book_archive_set_start_balances(m_book);
+    EXPECT_TRUE(gnc_numeric_equal(gnc_numeric_create(9500, 100),
+                                  xaccAccountGetBalance(m_bank)));
+    EXPECT_TRUE(gnc_numeric_equal(gnc_numeric_create(40, 1),
+                                  xaccAccountGetClearedBalance(m_bank)));
+    EXPECT_TRUE(gnc_numeric_equal(gnc_numeric_create(500, 100),
+                                  xaccAccountGetBalance(m_expense)));
+}
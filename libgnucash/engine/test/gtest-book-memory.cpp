@@ -0,0 +1,167 @@
+/********************************************************************
+ * gtest-book-memory.cpp -- Tests of the book's memory accounting    *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or   *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+\********************************************************************/
+
+extern "C"
+{
+#include <config.h>
+#include "../Account.h"
+#include "../Transaction.h"
+#include <qof.h>
+}
+
+#include <gtest/gtest.h>
+#include <string>
+
+class BookMemoryTest : public testing::Test
+{
+protected:
+    void SetUp() {
+        m_book = qof_book_new();
+        auto root = gnc_account_create_root(m_book);
+
+        m_bank = xaccMallocAccount(m_book);
+        xaccAccountSetName(m_bank, "Bank");
+        gnc_account_append_child(root, m_bank);
+
+        m_expense = xaccMallocAccount(m_book);
+        xaccAccountSetName(m_expense, "Expense");
+        gnc_account_append_child(root, m_expense);
+
+        for (int i = 0; i < 3; ++i)
+        {
+            auto trans = xaccMallocTransaction(m_book);
+            xaccTransBeginEdit(trans);
+            xaccTransSetDescription(trans, "Groceries");
+            for (auto acc : {m_bank, m_expense})
+            {
+                auto split = xaccMallocSplit(m_book);
+                xaccSplitSetParent(split, trans);
+                xaccSplitSetAccount(split, acc);
+            }
+            xaccTransCommitEdit(trans);
+        }
+    }
+    void TearDown() {
+        auto root = gnc_book_get_root_account(m_book);
+        xaccAccountBeginEdit(root);
+        xaccAccountDestroy(root);
+        qof_book_destroy(m_book);
+    }
+
+    const QofTypeMemoryUsage* find(GList *usage, QofIdType type)
+    {
+        for (auto node = usage; node; node = node->next)
+        {
+            auto type_usage = static_cast<QofTypeMemoryUsage*>(node->data);
+            if (!g_strcmp0(type_usage->type, type))
+                return type_usage;
+        }
+        return nullptr;
+    }
+
+    QofBook *m_book {};
+    Account *m_bank {};
+    Account *m_expense {};
+};
+
+TEST_F(BookMemoryTest, counts_by_type)
+{
+    auto usage = qof_book_get_memory_usage(m_book);
+    auto book = static_cast<QofTypeMemoryUsage*>(usage->data);
+    EXPECT_STREQ(QOF_ID_BOOK, book->type);
+    EXPECT_EQ(1u, book->count);
+
+    auto accounts = find(usage, GNC_ID_ACCOUNT);
+    ASSERT_NE(nullptr, accounts);
+    EXPECT_EQ(3u, accounts->count);
+    EXPECT_GT(accounts->usage.instance_bytes, 3 * sizeof(QofInstance));
+    /* The root's two children. */
+    EXPECT_GE(accounts->usage.list_nodes, 2u);
+
+    auto trans = find(usage, GNC_ID_TRANS);
+    ASSERT_NE(nullptr, trans);
+    EXPECT_EQ(3u, trans->count);
+    /* Each transaction's list of its two splits. */
+    EXPECT_EQ(6u, trans->usage.list_nodes);
+
+    auto splits = find(usage, GNC_ID_SPLIT);
+    ASSERT_NE(nullptr, splits);
+    EXPECT_EQ(6u, splits->count);
+    EXPECT_EQ(qof_memory_usage_total(&splits->usage),
+              splits->usage.instance_bytes + splits->usage.kvp_bytes +
+              splits->usage.other_bytes);
+
+    /* The types come by descending size after the book. */
+    for (auto node = usage->next; node && node->next; node = node->next)
+        EXPECT_GE(qof_memory_usage_total(&static_cast<QofTypeMemoryUsage*>(node->data)->usage),
+                  qof_memory_usage_total(&static_cast<QofTypeMemoryUsage*>(node->next->data)->usage));
+    qof_book_memory_usage_free(usage);
+}
+
+TEST_F(BookMemoryTest, kvp)
+{
+    auto usage = qof_book_get_memory_usage(m_book);
+    auto before = find(usage, GNC_ID_ACCOUNT)->usage;
+    qof_book_memory_usage_free(usage);
+
+    xaccAccountSetNotes(m_bank, "Joint account");
+    xaccAccountSetColor(m_bank, "#ff0000");
+
+    usage = qof_book_get_memory_usage(m_book);
+    auto after = find(usage, GNC_ID_ACCOUNT)->usage;
+    qof_book_memory_usage_free(usage);
+    EXPECT_EQ(before.kvp_values + 2, after.kvp_values);
+    EXPECT_GE(after.kvp_frames, before.kvp_frames);
+    EXPECT_GT(after.kvp_bytes, before.kvp_bytes + sizeof("Joint account") +
+              sizeof("#ff0000"));
+}
+
+TEST_F(BookMemoryTest, string_cache)
+{
+    guint count;
+    gsize bytes;
+
+    qof_string_cache_get_usage(&count, &bytes);
+    EXPECT_GT(count, 0u);
+    EXPECT_GT(bytes, count * sizeof("Groceries"));
+
+    auto new_string = qof_string_cache_insert("gtest-book-memory only");
+    guint count_after;
+    gsize bytes_after;
+    qof_string_cache_get_usage(&count_after, &bytes_after);
+    EXPECT_EQ(count + 1, count_after);
+    EXPECT_GT(bytes_after, bytes);
+    qof_string_cache_remove(new_string);
+}
+
+TEST_F(BookMemoryTest, report)
+{
+    auto report = qof_book_memory_report(m_book);
+    std::string text {report};
+    g_free(report);
+
+    EXPECT_NE(std::string::npos, text.find(GNC_ID_ACCOUNT));
+    EXPECT_NE(std::string::npos, text.find(GNC_ID_SPLIT));
+    EXPECT_NE(std::string::npos, text.find("total"));
+    EXPECT_NE(std::string::npos, text.find("string cache"));
+    /* Empty collections are left out. */
+    EXPECT_EQ(std::string::npos, text.find(GNC_ID_LOT));
+}
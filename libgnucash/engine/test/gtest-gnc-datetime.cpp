@@ -129,6 +129,13 @@ TEST(gnc_date_constructors, test_str_format_constructor)
         {   "m-d",        "6'8",   curr_year,  6,  8},
         {   "m-d",       "0801",   curr_year,  8,  1},
 
+        // runs of separators and surrounding text
+        { "y-m-d", "2013--08//01", 2013,  8,  1},
+        { "y-m-d", " 2013-08-01", 2013,  8,  1},
+        { "y-m-d", "2013-08-01 ", 2013,  8,  1},
+        { "d-m-y",  "01082013x", 2013,  8,  1},
+        {   "d-m",     "01-08-",   curr_year,  8,  1},
+
         // ambiguous date formats
         // current parser doesn't know how to disambiguate
         // and hence refuses to parse
@@ -530,3 +537,54 @@ TEST(gnc_datetime_functions, test_timezone_offset)
     EXPECT_EQ(-25200, gncdt3.offset());
 }
 */
+
+static bool
+tm_equal(const struct tm& a, const struct tm& b)
+{
+    return a.tm_year == b.tm_year && a.tm_mon == b.tm_mon &&
+        a.tm_mday == b.tm_mday && a.tm_hour == b.tm_hour &&
+        a.tm_min == b.tm_min && a.tm_sec == b.tm_sec &&
+        a.tm_wday == b.tm_wday && a.tm_yday == b.tm_yday &&
+        a.tm_isdst == b.tm_isdst
+#if HAVE_STRUCT_TM_GMTOFF
+        && a.tm_gmtoff == b.tm_gmtoff
+#endif
+        ;
+}
+
+TEST(gnc_datetime_functions, test_local_tm_cache)
+{
+#ifdef __MINGW32__
+    TimeZoneProvider tzp_can{"A.U.S Eastern Standard Time"};
+    TimeZoneProvider tzp_la{"Pacific Standard Time"};
+#else
+    TimeZoneProvider tzp_can("Australia/Canberra");
+    TimeZoneProvider tzp_la("America/Los_Angeles");
+#endif
+    for (auto tz : {&tzp_la, &tzp_can})
+    {
+        _set_tzp(*tz);
+        // 2019-12-31 to 2021-01-02 in steps of 3:17:07, twice so the
+        // second pass hits the cache, plus a few far-off dates.
+        for (auto pass = 0; pass < 2; ++pass)
+            for (time64 time = 1577750400; time < 1609545600; time += 11827)
+            {
+                auto expected = static_cast<struct tm>(GncDateTime(time));
+                auto local = GncDateTime::local_tm(time);
+                EXPECT_TRUE(tm_equal(expected, local)) << "at " << time;
+                GncDateTime from_tm(local);
+                EXPECT_EQ(static_cast<time64>(from_tm),
+                          GncDateTime::local_time64(local)) << "at " << time;
+                EXPECT_TRUE(tm_equal(static_cast<struct tm>(from_tm), local))
+                    << "at " << time;
+            }
+        for (time64 time : {MINTIME + 86400, INT64_C(-2208988800), INT64_C(0),
+                            INT64_C(-1), INT64_C(951825600), MAXTIME - 86400})
+        {
+            auto expected = static_cast<struct tm>(GncDateTime(time));
+            EXPECT_TRUE(tm_equal(expected, GncDateTime::local_tm(time)))
+                << "at " << time;
+        }
+        _reset_tzp();
+    }
+}
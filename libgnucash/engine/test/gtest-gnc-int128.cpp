@@ -558,6 +558,28 @@ TEST(GncInt128_functions, divide)
       });
 }
 
+TEST(GncInt128_functions, divide_multi_leg)
+{
+    GncInt128 q {}, r {};
+    /* The normalized remainder doesn't fit in a GncInt128. */
+    GncInt128 big (UINT64_C(0xb96b8c4d8107a), UINT64_C(0x6c3d320e6181eac));
+    GncInt128 divisor (UINT64_C(0x37e39db806c), UINT64_C(0xffdaf4e));
+    big.div (divisor, q, r);
+    EXPECT_EQ (GncInt128(INT64_C(849)), q);
+    EXPECT_EQ (GncInt128(UINT64_C(0x11ae3e32a4e), UINT64_C(0x6c3d2ebddc5bcfe)), r);
+    EXPECT_EQ (big, q * divisor + r);
+
+    /* A normalized divisor subleg of 0xffffffff */
+    GncInt128 wide (UINT64_C(0x123456789), UINT64_C(0));
+    GncInt128 narrow (UINT64_C(0x80000000ffffffff));
+    wide.div (narrow, q, r);
+    EXPECT_EQ (GncInt128(INT64_C(0x2468acf0d)), q);
+    EXPECT_EQ (GncInt128(UINT64_C(0x397530f5468acf0d)), r);
+    (-wide).div (narrow, q, r);
+    EXPECT_EQ (GncInt128(INT64_C(-0x2468acf0d)), q);
+    EXPECT_EQ (-GncInt128(UINT64_C(0x397530f5468acf0d)), r);
+}
+
 TEST(GncInt128_functions, GCD)
 {
     int64_t barg {INT64_C(4878849681579065407)};
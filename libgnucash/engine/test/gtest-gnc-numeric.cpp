@@ -177,6 +177,17 @@ TEST(gncnumeric_constructors, test_string_constructor)
     EXPECT_EQ(488, overflow.denom());
     EXPECT_THROW(GncNumeric auto_round("12345678987654321234/256", true),
                  std::out_of_range);
+    GncNumeric places17("0.12345678901234567");
+    EXPECT_EQ(12345678901234567, places17.num());
+    EXPECT_EQ(100000000000000000, places17.denom());
+    GncNumeric places18("0.123456789012345678");
+    EXPECT_EQ(123456789012345678, places18.num());
+    EXPECT_EQ(1000000000000000000, places18.denom());
+    EXPECT_THROW(GncNumeric places19("0.1234567890123456789"),
+                 std::overflow_error);
+    GncNumeric places19("0.1234567890123456789", true);
+    EXPECT_EQ(123456789012345678, places19.num());
+    EXPECT_EQ(1000000000000000000, places19.denom());
     EXPECT_THROW(GncNumeric bad_string("Four score and seven"),
                  std::invalid_argument);
     GncNumeric neg_decimal_frac("-0.12345");
@@ -376,6 +387,34 @@ TEST(gncnumeric_operators, test_division)
 
 }
 
+TEST(gncnumeric_operators, test_checked_arithmetic)
+{
+    GncNumeric a(123456789987654321, 1000000000);
+    GncNumeric b(65432198765432198, 100000000);
+    GncNumeric c;
+    EXPECT_EQ(GNC_ERROR_OK, add(a, b, c));
+    EXPECT_EQ(0, c.cmp(a + b));
+    EXPECT_EQ(GNC_ERROR_OK, subtract(a, b, c));
+    EXPECT_EQ(0, c.cmp(a - b));
+    EXPECT_EQ(GNC_ERROR_OK, multiply(a, b, c));
+    EXPECT_EQ(0, c.cmp(a * b));
+    EXPECT_EQ(GNC_ERROR_OK, divide(a, b, c));
+    EXPECT_EQ(0, c.cmp(a / b));
+
+    GncNumeric big(INT64_MAX, 1), untouched(1, 3);
+    c = untouched;
+    EXPECT_EQ(GNC_ERROR_OVERFLOW, multiply(big, big, c));
+    EXPECT_EQ(GNC_ERROR_OVERFLOW, divide(a, GncNumeric(), c));
+    EXPECT_EQ(untouched.num(), c.num());
+    EXPECT_EQ(untouched.denom(), c.denom());
+
+    EXPECT_EQ(GNC_ERROR_REMAINDER, untouched.convert<RoundType::never>(100, c));
+    EXPECT_EQ(GNC_ERROR_OVERFLOW, big.convert<RoundType::bankers>(3, c));
+    EXPECT_EQ(GNC_ERROR_OK, untouched.convert<RoundType::bankers>(100, c));
+    EXPECT_EQ(33, c.num());
+    EXPECT_EQ(100, c.denom());
+}
+
 TEST(gncnumeric_functions, test_cmp)
 {
     GncNumeric a(123456789, 9876), b(567894321, 6543);
@@ -527,6 +566,30 @@ TEST(gncnumeric_functions, test_convert)
     EXPECT_EQ(100, c.denom());
 }
 
+TEST(gncnumeric_functions, test_convert_decimal)
+{
+    static_assert(powten(2) == 100, "powten is evaluated at compile time");
+    static_assert(powten(18) == INT64_C(1000000000000000000), "powten reaches 10^18");
+    static_assert(powten(20) == powten(18), "powten caps the exponent");
+    GncNumeric a(-123456789, 1000000), c;
+    ASSERT_NO_THROW(c = a.convert<RoundType::half_up>(100));
+    EXPECT_EQ(-12346, c.num());
+    EXPECT_EQ(100, c.denom());
+    ASSERT_NO_THROW(c = a.convert<RoundType::floor>(1000));
+    EXPECT_EQ(-123457, c.num());
+    ASSERT_NO_THROW(c = a.convert<RoundType::ceiling>(1000));
+    EXPECT_EQ(-123456, c.num());
+    ASSERT_NO_THROW(c = GncNumeric(-5, 1000).convert<RoundType::promote>(100));
+    EXPECT_EQ(-1, c.num());
+    EXPECT_THROW(c = a.convert<RoundType::never>(100), std::domain_error);
+    ASSERT_NO_THROW(c = a.convert<RoundType::never>(100000000));
+    EXPECT_EQ(-12345678900, c.num());
+    EXPECT_EQ(100000000, c.denom());
+    /* Scaling up by a factor that overflows takes the general path. */
+    GncNumeric big(INT64_C(1234567890123456789), 100);
+    EXPECT_THROW(c = big.convert<RoundType::half_up>(10000), std::overflow_error);
+}
+
 TEST(gnc_numeric_functions, test_is_decimal)
 {
     EXPECT_TRUE(GncNumeric(123, 1).is_decimal());
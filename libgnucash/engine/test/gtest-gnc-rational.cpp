@@ -177,3 +177,45 @@ TEST(gncrational_functions, test_round_to_numeric)
 
     }
 }
+
+TEST(gncrational_functions, test_checked_arithmetic)
+{
+    GncRational a(123456789987654321, 1000000000);
+    GncRational b(65432198765432198, 100000000);
+    GncRational c;
+    EXPECT_EQ(GNC_ERROR_OK, add(a, b, c));
+    EXPECT_EQ(a + b, c);
+    EXPECT_EQ(GNC_ERROR_OK, subtract(a, b, c));
+    EXPECT_EQ(a - b, c);
+    EXPECT_EQ(GNC_ERROR_OK, multiply(a, b, c));
+    EXPECT_EQ(a * b, c);
+    EXPECT_EQ(GNC_ERROR_OK, divide(a, b, c));
+    EXPECT_EQ(a / b, c);
+
+    GncRational big(GncInt128(UINT64_C(0x1000000000000000), 0), 1);
+    GncRational huge(GncInt128(UINT64_C(0x1fffffffffffffff), UINT64_MAX), 1);
+    GncRational untouched(1, 3);
+    c = untouched;
+    EXPECT_EQ(GNC_ERROR_OVERFLOW, multiply(big, big, c));
+    EXPECT_EQ(GNC_ERROR_OVERFLOW, add(huge, huge, c));
+    EXPECT_EQ(GNC_ERROR_OVERFLOW, divide(a, GncRational(0, 1), c));
+    EXPECT_EQ(untouched, c);
+    EXPECT_EQ(GNC_ERROR_OVERFLOW, big.round_to_numeric(c));
+    EXPECT_EQ(untouched, c);
+
+    GncRational third(1, 3);
+    EXPECT_EQ(GNC_ERROR_REMAINDER,
+              third.convert<RoundType::never>(100, c));
+    EXPECT_EQ(GNC_ERROR_OK, third.convert<RoundType::bankers>(100, c));
+    EXPECT_EQ(33, c.num());
+    EXPECT_EQ(100, c.denom());
+    EXPECT_EQ(GNC_ERROR_OK, GncRational(10, 30).reduce(c));
+    EXPECT_EQ(1, c.num());
+    EXPECT_EQ(3, c.denom());
+
+    /* Only an integer approximation fits; this used to loop forever. */
+    GncRational nearly_max(-GncInt128(2, UINT64_C(14011352917268051361)), 10);
+    EXPECT_EQ(GNC_ERROR_OK, nearly_max.round_to_numeric(c));
+    EXPECT_EQ(INT64_C(-5090484106468715459), c.num());
+    EXPECT_EQ(1, c.denom());
+}
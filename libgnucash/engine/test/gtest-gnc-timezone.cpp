@@ -23,6 +23,8 @@
 
 #include <gtest/gtest.h>
 #include <string>
+#include <chrono>
+#include <iostream>
 #include "../gnc-timezone.hpp"
 
 TEST(gnc_timezone_constructors, test_default_constructor)
@@ -305,3 +307,44 @@ TEST(gnc_timezone_constructors, test_bogus_time_constructor)
 	      tzp.get(2006)->std_zone_abbrev());
 #endif
 }
+
+TEST(gnc_timezone_constructors, test_out_of_range_years)
+{
+#if PLATFORM(WINDOWS)
+    TimeZoneProvider tzp ("W. Australia Standard Time");
+#else
+    TimeZoneProvider tzp ("Australia/Perth");
+#endif
+    auto first = tzp.get(TimeZoneProvider::min_year);
+    auto last = tzp.get(TimeZoneProvider::max_year);
+    EXPECT_EQ(first, tzp.get(-200));
+    EXPECT_EQ(first, tzp.get(0));
+    EXPECT_EQ(last, tzp.get(TimeZoneProvider::max_year + 1));
+    EXPECT_EQ(last, tzp.get(100000));
+    EXPECT_EQ(tzp.get(2006), tzp.get(2006));
+}
+
+/* A microbenchmark of TimeZoneProvider::get, which every GncDateTime
+ * construction calls. It's disabled so that it doesn't slow down the test
+ * suite; run it with
+ * test-gnc-timezone --gtest_also_run_disabled_tests --gtest_filter='*speed*'
+ */
+TEST(gnc_timezone_constructors, DISABLED_get_speed)
+{
+    constexpr auto count = 2000000;
+#if PLATFORM(WINDOWS)
+    TimeZoneProvider tzp ("Pacific Standard Time");
+#else
+    TimeZoneProvider tzp ("America/Los_Angeles");
+#endif
+    long check = 0;
+    auto start = std::chrono::steady_clock::now ();
+    for (auto i = 0; i < count; ++i)
+        check += tzp.get(1900 + i % 150)->base_utc_offset().total_seconds();
+    auto end = std::chrono::steady_clock::now ();
+
+    using ns = std::chrono::duration<double, std::nano>;
+    std::cout << "TimeZoneProvider::get: "
+              << ns (end - start).count () / count << " ns\n"
+              << "(checksum " << check << ")" << std::endl;
+}
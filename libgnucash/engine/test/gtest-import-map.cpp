@@ -326,6 +326,28 @@ TEST_F(ImapBayesTest, AddAccountBayes)
     EXPECT_EQ(2, value->get<int64_t>());
 }
 
+TEST_F(ImapBayesTest, FindAccountBayesAfterChanges)
+{
+    auto root = qof_instance_get_slots(QOF_INSTANCE(t_bank_account));
+    auto acct1_guid = guid_to_string (xaccAccountGetGUID(t_expense_account1));
+    auto value = new KvpValue(INT64_C(42));
+
+    root->set_path({std::string{IMAP_FRAME_BAYES} + "/" + foo + "/" + acct1_guid}, value);
+    root->set_path({std::string{IMAP_FRAME_BAYES} + "/" + bar + "/" + acct1_guid}, new KvpValue{*value});
+    EXPECT_EQ(t_expense_account1, gnc_account_imap_find_account_bayes(t_imap, t_list1));
+
+    // The lookups must see the tokens added since the first one
+    qof_instance_increase_editlevel(QOF_INSTANCE(t_bank_account));
+    for (int i = 0; i < 400; ++i)
+        gnc_account_imap_add_account_bayes(t_imap, t_list1, t_expense_account2);
+    qof_instance_reset_editlevel(QOF_INSTANCE(t_bank_account));
+    EXPECT_EQ(t_expense_account2, gnc_account_imap_find_account_bayes(t_imap, t_list1));
+
+    // and forget the deleted ones
+    gnc_account_delete_all_bayes_maps(t_bank_account);
+    EXPECT_EQ(nullptr, gnc_account_imap_find_account_bayes(t_imap, t_list1));
+}
+
 TEST_F(ImapBayesTest, ConvertBayesData)
 {
     auto root = qof_instance_get_slots(QOF_INSTANCE(t_bank_account));
@@ -0,0 +1,212 @@
+/********************************************************************\
+ * gtest-qoflog.cpp -- Unit tests for qoflog                        *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ *                                                                  *
+ \ *********************************************************************/
+
+#include <config.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+#include "../qoflog.h"
+#include <gtest/gtest.h>
+#include <string>
+
+static QofCounter counter_a = { "test.shared", 0, 0, FALSE, NULL };
+static QofCounter counter_b = { "test.shared", 0, 0, FALSE, NULL };
+static QofCounter counter_c = { "test.other", 0, 0, FALSE, NULL };
+
+TEST(qof_counter, add_and_report)
+{
+    qof_counter_add (&counter_a, 10);
+    qof_counter_add (&counter_a, 20);
+    qof_counter_add (&counter_b, 30);
+    qof_counter_add (&counter_c, 0);
+    EXPECT_EQ (2, counter_a.count);
+    EXPECT_EQ (30, counter_a.usecs);
+    EXPECT_TRUE (counter_a.registered);
+
+    auto report = qof_counter_report ();
+    std::string text {report};
+    g_free (report);
+    /* Sites sharing a name are reported as one line. */
+    auto line = text.find ("test.shared");
+    ASSERT_NE (std::string::npos, line);
+    EXPECT_EQ (std::string::npos, text.find ("test.shared", line + 1));
+    EXPECT_NE (std::string::npos, text.find (" 3 ", line));
+    EXPECT_NE (std::string::npos, text.find ("test.other"));
+}
+
+TEST(qof_counter, reset)
+{
+    qof_counter_add (&counter_c, 5);
+    qof_counter_reset ();
+    EXPECT_EQ (0, counter_a.count);
+    EXPECT_EQ (0, counter_b.usecs);
+    EXPECT_EQ (0, counter_c.count);
+    /* A reset counter stays registered and counts again. */
+    qof_counter_add (&counter_c, 5);
+    EXPECT_EQ (1, counter_c.count);
+}
+
+TEST(qof_counter, macros)
+{
+    qof_counter_reset ();
+    for (int i = 0; i < 3; ++i)
+    {
+        QOF_TIMER_START (loop, "test.macro");
+        QOF_COUNT ("test.macro-count");
+        QOF_TIMER_STOP (loop);
+    }
+    auto report = qof_counter_report ();
+    std::string text {report};
+    g_free (report);
+#ifdef ENABLE_INSTRUMENTATION
+    EXPECT_TRUE (qof_counters_enabled ());
+    EXPECT_NE (std::string::npos, text.find ("test.macro "));
+    EXPECT_NE (std::string::npos, text.find ("test.macro-count"));
+#else
+    EXPECT_FALSE (qof_counters_enabled ());
+    EXPECT_EQ (std::string::npos, text.find ("test.macro"));
+#endif
+}
+
+TEST(qof_counter, named_and_categories)
+{
+    qof_counter_reset ();
+    qof_counter_add_named ("named.first", 100);
+    qof_counter_add_named ("named.first", 200);
+    qof_counter_add_named ("named.second", 300);
+    qof_counter_add_named ("lone", 50);
+
+    auto report = qof_counter_report ();
+    std::string text {report};
+    g_free (report);
+    auto line = text.find ("named.first");
+    ASSERT_NE (std::string::npos, line);
+    EXPECT_EQ (std::string::npos, text.find ("named.first", line + 1));
+    EXPECT_NE (std::string::npos, text.find (" 2 ", line));
+
+    report = qof_counter_report_categories ();
+    text = report;
+    g_free (report);
+    line = text.find ("named ");
+    ASSERT_NE (std::string::npos, line);
+    EXPECT_NE (std::string::npos, text.find (" 3 ", line));
+    /* 600 microseconds in all. */
+    EXPECT_NE (std::string::npos, text.find ("0.600", line));
+    EXPECT_EQ (std::string::npos, text.find ("named.first"));
+    EXPECT_NE (std::string::npos, text.find ("lone"));
+}
+
+static QofLogModule log_module = "test.qoflog.site";
+static int evaluations = 0;
+
+static int
+count_evaluation (void)
+{
+    return ++evaluations;
+}
+
+static void
+log_info_once (void)
+{
+    PINFO ("evaluated %d", count_evaluation ());
+}
+
+TEST(qof_log_site, disabled_skips_arguments)
+{
+    qof_log_set_level (log_module, QOF_LOG_WARNING);
+    evaluations = 0;
+    log_info_once ();
+    log_info_once ();
+    EXPECT_EQ (0, evaluations);
+}
+
+TEST(qof_log_site, level_change_reaches_site)
+{
+    auto hdlr = g_log_set_handler (log_module, G_LOG_LEVEL_INFO,
+                                   [](const gchar*, GLogLevelFlags,
+                                      const gchar*, gpointer) {}, nullptr);
+    qof_log_set_level (log_module, QOF_LOG_WARNING);
+    evaluations = 0;
+    log_info_once ();
+    EXPECT_EQ (0, evaluations);
+    qof_log_set_level (log_module, QOF_LOG_INFO);
+    log_info_once ();
+    EXPECT_EQ (1, evaluations);
+    qof_log_set_level (log_module, QOF_LOG_WARNING);
+    log_info_once ();
+    EXPECT_EQ (1, evaluations);
+    g_log_remove_handler (log_module, hdlr);
+}
+
+static std::string
+read_trace (const gchar *filename)
+{
+    gchar *contents = nullptr;
+    g_file_get_contents (filename, &contents, nullptr, nullptr);
+    std::string trace{contents ? contents : ""};
+    g_free (contents);
+    return trace;
+}
+
+TEST(qof_trace, off)
+{
+    EXPECT_FALSE (qof_trace_enabled ());
+    EXPECT_EQ (0, qof_trace_now ());
+    QOF_TRACE_BEGIN (span);
+    EXPECT_EQ (0, span_trace_start);
+    QOF_TRACE_END (span, "test", "nothing");
+}
+
+TEST(qof_trace, spans)
+{
+    auto filename = g_build_filename (g_get_tmp_dir (), "gtest-qoflog-trace.json",
+                                      nullptr);
+    ASSERT_TRUE (qof_trace_start (filename));
+    EXPECT_TRUE (qof_trace_enabled ());
+    {
+        QOF_TRACE_BEGIN (outer);
+        EXPECT_NE (0, outer_trace_start);
+        QOF_TRACE_END (outer, "test", "outer");
+    }
+    qof_trace_span ("test", "with \"quotes\"", qof_trace_now (), "a\nb");
+    qof_trace_stop ();
+    EXPECT_FALSE (qof_trace_enabled ());
+
+    auto trace = read_trace (filename);
+    EXPECT_EQ ('[', trace.front ());
+    EXPECT_EQ ("]\n", trace.substr (trace.size () - 2));
+    EXPECT_NE (std::string::npos, trace.find ("\"name\":\"process_name\""));
+    EXPECT_NE (std::string::npos, trace.find ("\"args\":{\"name\":\"main\"}"));
+    EXPECT_NE (std::string::npos,
+               trace.find ("{\"ph\":\"X\",\"pid\":1,\"cat\":\"test\",\"name\":\"outer\",\"tid\":1,"));
+    EXPECT_NE (std::string::npos, trace.find ("\"name\":\"with \\\"quotes\\\"\""));
+    EXPECT_NE (std::string::npos, trace.find ("\"args\":{\"detail\":\"a\\u000ab\"}"));
+
+    /* A span begun before tracing stopped isn't written afterwards. */
+    ASSERT_TRUE (qof_trace_start (filename));
+    auto start = qof_trace_now ();
+    qof_trace_stop ();
+    qof_trace_span ("test", "late", start, nullptr);
+    EXPECT_EQ (std::string::npos, read_trace (filename).find ("late"));
+
+    g_remove (filename);
+    g_free (filename);
+}
@@ -45,6 +45,22 @@ TEST(qof_query_construct_predicate, string)
     EXPECT_EQ (FALSE,                   pdata->is_regex);
 }
 
+TEST(qof_query_construct_predicate, string_caseinsensitive)
+{
+    query_string_def *pdata;
+    pdata = (query_string_def*)qof_query_string_predicate(
+        QOF_COMPARE_CONTAINS,
+        "TeSt",
+        QOF_STRING_MATCH_CASEINSENSITIVE,
+        FALSE
+    );
+    EXPECT_STREQ ("TeSt",               pdata->matchstring);
+    EXPECT_STREQ ("test",               pdata->folded);
+    EXPECT_EQ (4u,                      pdata->folded_len);
+    EXPECT_TRUE (pdata->folded_ascii);
+    qof_query_core_predicate_free ((QofQueryPredData*)pdata);
+}
+
 TEST(qof_query_construct_predicate, date)
 {
     query_date_def *pdata;
@@ -0,0 +1,144 @@
+/***************************************************************************
+ *            test-book-snapshot.cpp
+ *
+ *  Copyright  2026  Gnucash team
+ ****************************************************************************/
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ *  02110-1301, USA.
+ */
+extern "C"
+{
+#include <config.h>
+#include <glib.h>
+#include "qof.h"
+#include "cashobjects.h"
+#include "Account.h"
+#include "TransLog.h"
+#include "gnc-book-snapshot.h"
+#include "gnc-engine.h"
+#include "gnc-pricedb.h"
+#include "test-engine-stuff.h"
+#include "test-stuff.h"
+}
+
+static gboolean
+account_matches (Account *acc, QofBook *snapshot)
+{
+    Account *twin = xaccAccountLookup (xaccAccountGetGUID (acc), snapshot);
+
+    if (!twin || twin == acc)
+        return FALSE;
+    if (g_strcmp0 (xaccAccountGetName (acc), xaccAccountGetName (twin)) != 0)
+        return FALSE;
+    if (!gnc_numeric_equal (xaccAccountGetBalance (acc),
+                            xaccAccountGetBalance (twin)))
+        return FALSE;
+    return g_list_length (xaccAccountGetSplitList (acc)) ==
+        g_list_length (xaccAccountGetSplitList (twin));
+}
+
+static void
+run_test (void)
+{
+    QofBook *book;
+    QofBook *snapshot;
+    GList *accounts, *node;
+    Transaction *trans;
+    Account *root;
+
+    book = get_random_book ();
+    add_random_transactions_to_book (book, 20);
+    root = gnc_book_get_root_account (book);
+
+    snapshot = gnc_book_snapshot_new (book);
+    if (!snapshot || snapshot == book)
+    {
+        failure("snapshot not created");
+        exit(get_rv());
+    }
+    if (!gnc_book_is_snapshot (snapshot) || gnc_book_is_snapshot (book))
+    {
+        failure("book not marked as snapshot");
+        exit(get_rv());
+    }
+    if (!qof_book_is_readonly (snapshot))
+    {
+        failure("snapshot isn't read-only");
+        exit(get_rv());
+    }
+
+    accounts = gnc_account_get_descendants (root);
+    for (node = accounts; node; node = node->next)
+    {
+        if (!account_matches (GNC_ACCOUNT (node->data), snapshot))
+        {
+            failure("snapshot account differs");
+            exit(get_rv());
+        }
+    }
+
+    if (qof_collection_count (qof_book_get_collection (book, GNC_ID_TRANS)) !=
+        qof_collection_count (qof_book_get_collection (snapshot, GNC_ID_TRANS)))
+    {
+        failure("snapshot transaction count differs");
+        exit(get_rv());
+    }
+    if (gnc_pricedb_get_num_prices (gnc_pricedb_get_db (book)) !=
+        gnc_pricedb_get_num_prices (gnc_pricedb_get_db (snapshot)))
+    {
+        failure("snapshot price count differs");
+        exit(get_rv());
+    }
+
+    /* Changes to the live book don't show in the snapshot. */
+    trans = get_random_transaction (book);
+    if (trans && xaccTransLookup (xaccTransGetGUID (trans), snapshot))
+    {
+        failure("snapshot sees a new transaction");
+        exit(get_rv());
+    }
+    qof_book_destroy (snapshot);
+
+    for (node = accounts; node; node = node->next)
+    {
+        if (gnc_account_get_book (GNC_ACCOUNT (node->data)) != book)
+        {
+            failure("destroying the snapshot touched the book");
+            exit(get_rv());
+        }
+    }
+    g_list_free (accounts);
+    qof_book_destroy (book);
+}
+
+int
+main (int argc, char **argv)
+{
+    gint i;
+    qof_init();
+    if (cashobjects_register())
+    {
+        xaccLogDisable ();
+        for (i = 0; i < 5; i++)
+        {
+            run_test ();
+        }
+        success ("book snapshots seem to work");
+        print_test_results();
+    }
+    qof_close();
+    return get_rv();
+}
@@ -181,6 +181,69 @@ test_commodity(void)
         }
     }
 
+    {
+        QofBook *book = qof_book_new ();
+        gnc_commodity_table *tbl = gnc_commodity_table_get_table (book);
+        gnc_commodity *gnm, *abc, *rub, *found;
+
+        gnm = gnc_commodity_table_insert (
+            tbl, gnc_commodity_new (book, "Gnome, Inc.", "NYSE", "GNM",
+                                    "US1234567890", 1));
+        abc = gnc_commodity_table_insert (
+            tbl, gnc_commodity_new (book, "ABC Fund", "FUND", "ABC",
+                                    "DE0001234567", 1000));
+
+        do_test (gnc_commodity_table_lookup (tbl, "NYSE", "GNM") == gnm,
+                 "lookup by namespace and mnemonic");
+        do_test (gnc_commodity_table_lookup_unique (tbl, "FUND::ABC") == abc,
+                 "lookup by unique name");
+        do_test (gnc_commodity_table_lookup_unique (tbl, "FUND::GNM") == NULL,
+                 "unique name in the wrong namespace");
+        do_test (gnc_commodity_table_lookup_unique (tbl, "FUNDABC") == NULL,
+                 "unique name without separator");
+        do_test (gnc_commodity_table_lookup_cusip (tbl, "US1234567890") == gnm,
+                 "lookup by ISIN");
+        do_test (gnc_commodity_table_lookup_cusip (tbl, "") == NULL,
+                 "empty codes aren't looked up");
+        do_test (gnc_commodity_table_find_full (tbl, "FUND", "ABC (ABC Fund)") == abc,
+                 "find by printname");
+
+        gnc_commodity_set_cusip (abc, "DE0007654321");
+        do_test (gnc_commodity_table_lookup_cusip (tbl, "DE0001234567") == NULL,
+                 "old code is forgotten");
+        do_test (gnc_commodity_table_lookup_cusip (tbl, "DE0007654321") == abc,
+                 "new code is found");
+
+        /* A second commodity with the same code takes over when the first
+         * leaves the table. */
+        found = gnc_commodity_table_insert (
+            tbl, gnc_commodity_new (book, "Gnome Pref", "NASDAQ", "GNMP",
+                                    "US1234567890", 1));
+        do_test (gnc_commodity_table_lookup_cusip (tbl, "US1234567890") == gnm,
+                 "the first commodity with a code is found");
+        gnc_commodity_table_remove (tbl, gnm);
+        do_test (gnc_commodity_table_lookup (tbl, "NYSE", "GNM") == NULL,
+                 "removed commodity isn't found");
+        do_test (gnc_commodity_table_lookup_cusip (tbl, "US1234567890") == found,
+                 "the other commodity with the code is found");
+        gnc_commodity_destroy (gnm);
+
+        rub = gnc_commodity_table_insert (
+            tbl, gnc_commodity_new (book, "Russian Ruble", GNC_COMMODITY_NS_CURRENCY,
+                                    "RUB", "643", 100));
+        do_test (gnc_commodity_table_lookup (tbl, GNC_COMMODITY_NS_ISO, "RUB") == rub,
+                 "ISO4217 namespace maps to CURRENCY");
+        do_test (gnc_commodity_table_lookup (tbl, GNC_COMMODITY_NS_CURRENCY, "RUR") == rub,
+                 "old currency codes map to the new ones");
+
+        gnc_commodity_table_delete_namespace (tbl, "NASDAQ");
+        do_test (gnc_commodity_table_lookup (tbl, "NASDAQ", "GNMP") == NULL,
+                 "commodities of a deleted namespace aren't found");
+        do_test (gnc_commodity_table_lookup_cusip (tbl, "US1234567890") == NULL,
+                 "nor are their codes");
+
+        qof_book_destroy (book);
+    }
 }
 
 int
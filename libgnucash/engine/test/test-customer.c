@@ -31,6 +31,7 @@
 
 #include "cashobjects.h"
 #include "gncCustomerP.h"
+#include "gncIDSearch.h"
 #include "gncInvoiceP.h"
 #include "gncJobP.h"
 #include "test-stuff.h"
@@ -132,6 +133,33 @@ test_customer (void)
         do_test (gncCustomerLookup (book, guid) == customer, "Entity Table");
     }
 
+    /* Test the lookup by ID, before and after the index is made */
+    {
+        GncCustomer *other;
+
+        gncCustomerSetID (customer, "ID-1");
+        do_test (gnc_search_customer_on_id (book, "ID-1") == customer,
+                 "search on id");
+        do_test (gnc_search_customer_on_id (book, "ID-2") == NULL,
+                 "search on missing id");
+
+        other = gncCustomerCreate (book);
+        gncCustomerSetID (other, "ID-2");
+        do_test (gnc_search_customer_on_id (book, "ID-2") == other,
+                 "search on new id");
+
+        gncCustomerSetID (customer, "ID-3");
+        do_test (gnc_search_customer_on_id (book, "ID-1") == NULL,
+                 "search on old id");
+        do_test (gnc_search_customer_on_id (book, "ID-3") == customer,
+                 "search on changed id");
+
+        gncCustomerBeginEdit (other);
+        gncCustomerDestroy (other);
+        do_test (gnc_search_customer_on_id (book, "ID-2") == NULL,
+                 "search on destroyed id");
+    }
+
     /* Note: JobList is tested from the Job tests */
     qof_book_destroy (book);
 }
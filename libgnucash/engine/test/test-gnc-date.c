@@ -925,6 +925,37 @@ test_qof_print_date_buff (void)
     setlocale (LC_TIME, locale);
     g_free (locale);
 }
+
+/* Times on the same day share the day's text, but formats showing the
+ * time must not.
+ */
+static void
+test_qof_print_date_buff_same_day (void)
+{
+    gchar buff[MAX_DATE_LENGTH + 1];
+    gchar *text;
+    struct tm morning = {0, 5, 1, 23, 10, 74};
+    struct tm evening = {0, 55, 22, 23, 10, 74};
+    time64 time1 = gnc_mktime(&morning);
+    time64 time2 = gnc_mktime(&evening);
+
+    qof_date_format_set (QOF_DATE_FORMAT_UK);
+    qof_print_date_buff (buff, MAX_DATE_LENGTH, time1);
+    g_assert_cmpstr (buff, ==, "23/11/1974");
+    qof_print_date_buff (buff, MAX_DATE_LENGTH, time2);
+    g_assert_cmpstr (buff, ==, "23/11/1974");
+
+    qof_date_format_set (QOF_DATE_FORMAT_ISO);
+    qof_print_date_buff (buff, MAX_DATE_LENGTH, time2);
+    g_assert_cmpstr (buff, ==, "1974-11-23");
+
+    text = gnc_print_time64 (time1, "%d %H:%M");
+    g_assert_cmpstr (text, ==, "23 01:05");
+    g_free (text);
+    text = gnc_print_time64 (time2, "%d %H:%M");
+    g_assert_cmpstr (text, ==, "23 22:55");
+    g_free (text);
+}
 /* qof_print_gdate
 size_t
 qof_print_gdate( char *buf, size_t len, const GDate *gd )// C: 6 in 5  Local: 0:0:0
@@ -1816,6 +1847,85 @@ test_gnc_time64_get_day_end (FixtureA *f, gconstpointer pData)
     g_assert_cmpint (t_time, ==, r_time);
 
 }
+/* gnc_date_period_starts
+time64*
+gnc_date_period_starts (time64 start, time64 end, GncDatePeriod period,
+                        const GDate *fy_end, size_t *count)
+*/
+static void
+test_gnc_date_period_starts (void)
+{
+    time64 start = gnc_dmy2time64_neutral (24, 9, 2003);
+    time64 end = gnc_dmy2time64_neutral (2, 11, 2003);
+    GDate *fy_end = g_date_new_dmy (31, G_DATE_JULY, 1999);
+    size_t count;
+    time64 *starts;
+
+    starts = gnc_date_period_starts (start, end, GNC_DATE_PERIOD_MONTH,
+                                     NULL, &count);
+    g_assert_cmpuint (count, ==, 4);
+    g_assert_cmpint (starts[0], ==, gnc_dmy2time64 (1, 9, 2003));
+    g_assert_cmpint (starts[1], ==, gnc_dmy2time64 (1, 10, 2003));
+    g_assert_cmpint (starts[2], ==, gnc_dmy2time64 (1, 11, 2003));
+    g_assert_cmpint (starts[3], ==, gnc_dmy2time64 (1, 12, 2003));
+    g_free (starts);
+
+    starts = gnc_date_period_starts (start, end, GNC_DATE_PERIOD_QUARTER,
+                                     NULL, &count);
+    g_assert_cmpuint (count, ==, 3);
+    g_assert_cmpint (starts[0], ==, gnc_dmy2time64 (1, 7, 2003));
+    g_assert_cmpint (starts[1], ==, gnc_dmy2time64 (1, 10, 2003));
+    g_assert_cmpint (starts[2], ==, gnc_dmy2time64 (1, 1, 2004));
+    g_free (starts);
+
+    starts = gnc_date_period_starts (start, end, GNC_DATE_PERIOD_YEAR,
+                                     NULL, &count);
+    g_assert_cmpuint (count, ==, 2);
+    g_assert_cmpint (starts[0], ==, gnc_dmy2time64 (1, 1, 2003));
+    g_assert_cmpint (starts[1], ==, gnc_dmy2time64 (1, 1, 2004));
+    g_free (starts);
+
+    end = gnc_dmy2time64_neutral (1, 8, 2005);
+    starts = gnc_date_period_starts (start, end, GNC_DATE_PERIOD_FISCAL_YEAR,
+                                     fy_end, &count);
+    g_assert_cmpuint (count, ==, 4);
+    g_assert_cmpint (starts[0], ==, gnc_dmy2time64 (1, 8, 2003));
+    g_assert_cmpint (starts[1], ==, gnc_dmy2time64 (1, 8, 2004));
+    g_assert_cmpint (starts[2], ==, gnc_dmy2time64 (1, 8, 2005));
+    g_assert_cmpint (starts[3], ==, gnc_dmy2time64 (1, 8, 2006));
+    g_free (starts);
+
+    starts = gnc_date_period_starts (end, start, GNC_DATE_PERIOD_MONTH,
+                                     NULL, &count);
+    g_assert_null (starts);
+    g_assert_cmpuint (count, ==, 0);
+    g_date_free (fy_end);
+}
+
+/* gnc_date_bucket_times
+void
+gnc_date_bucket_times (const time64 *boundaries, size_t n_boundaries,
+                       const time64 *times, size_t n_times, gint *buckets)
+*/
+static void
+test_gnc_date_bucket_times (void)
+{
+    const time64 boundaries[] = {100, 200, 300, 400, 500};
+    const time64 times[] = {50, 100, 150, 199, 200, 450, 500, 9999, 120};
+    const gint expected[] = {-1, 0, 0, 0, 1, 3, 4, 4, 0};
+    gint buckets[G_N_ELEMENTS (times)];
+    size_t i;
+
+    gnc_date_bucket_times (boundaries, G_N_ELEMENTS (boundaries),
+                           times, G_N_ELEMENTS (times), buckets);
+    for (i = 0; i < G_N_ELEMENTS (times); ++i)
+        g_assert_cmpint (buckets[i], ==, expected[i]);
+
+    gnc_date_bucket_times (boundaries, 0, times, G_N_ELEMENTS (times),
+                           buckets);
+    for (i = 0; i < G_N_ELEMENTS (times); ++i)
+        g_assert_cmpint (buckets[i], ==, -1);
+}
 /* gnc_tm_get_today_start
 void
 gnc_tm_get_today_start (struct tm *tm)// C: 3 in 3  Local: 0:0:0
@@ -1897,6 +2007,7 @@ test_suite_gnc_date (void)
 // GNC_TEST_ADD_FUNC (suitename, "qof date completion set", test_qof_date_completion_set);
     GNC_TEST_ADD_FUNC (suitename, "qof print date dmy buff", test_qof_print_date_dmy_buff);
     GNC_TEST_ADD_FUNC (suitename, "qof print date buff", test_qof_print_date_buff);
+    GNC_TEST_ADD_FUNC (suitename, "qof print date buff same day", test_qof_print_date_buff_same_day);
     GNC_TEST_ADD_FUNC (suitename, "qof print gdate", test_qof_print_gdate);
     GNC_TEST_ADD_FUNC (suitename, "qof print date", test_qof_print_date);
 // GNC_TEST_ADD_FUNC (suitename, "floordiv", test_floordiv);
@@ -1922,6 +2033,8 @@ test_suite_gnc_date (void)
 // GNC_TEST_ADD_FUNC (suitename, "gnc tm get day end", test_gnc_tm_get_day_end);
     GNC_TEST_ADD (suitename, "gnc time64 get day start", FixtureA, NULL, setup, test_gnc_time64_get_day_start, NULL);
     GNC_TEST_ADD (suitename, "gnc time64 get day end", FixtureA, NULL, setup, test_gnc_time64_get_day_end, NULL);
+    GNC_TEST_ADD_FUNC (suitename, "gnc date period starts", test_gnc_date_period_starts);
+    GNC_TEST_ADD_FUNC (suitename, "gnc date bucket times", test_gnc_date_bucket_times);
 // GNC_TEST_ADD_FUNC (suitename, "gnc tm get today start", test_gnc_tm_get_today_start);
 // GNC_TEST_ADD_FUNC (suitename, "gnc timet get today start", test_gnc_time64_get_today_start);
 // GNC_TEST_ADD_FUNC (suitename, "gnc timet get today end", test_gnc_time64_get_today_end);
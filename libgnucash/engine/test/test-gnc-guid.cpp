@@ -24,10 +24,14 @@
 
 #include "../guid.hpp"
 
+#include <algorithm>
+#include <chrono>
+#include <cctype>
 #include <random>
 #include <sstream>
 #include <iomanip>
 #include <string>
+#include <vector>
 #include <iostream>
 #include <gtest/gtest.h>
 #include <boost/version.hpp>
@@ -40,6 +44,26 @@ TEST (GncGUID, creation)
     GncGUID other;
 }
 
+TEST (GncGUID, batch)
+{
+    // More than one pool refill, all distinct and all version 4 UUIDs.
+    std::vector<GncGUID> guids (300);
+    guid_new_batch (guids.data (), 200);
+    for (auto i = 200u; i < guids.size (); ++i)
+        guids[i] = gnc::GUID::create_random ();
+    for (auto const & guid : guids)
+    {
+        EXPECT_EQ (0x40, guid.reserved[6] & 0xF0);
+        EXPECT_EQ (0x80, guid.reserved[8] & 0xC0);
+    }
+    std::sort (guids.begin (), guids.end (),
+               [](GncGUID const & a, GncGUID const & b)
+               { return guid_compare (&a, &b) < 0; });
+    EXPECT_EQ (guids.end (), std::adjacent_find (guids.begin (), guids.end (),
+               [](GncGUID const & a, GncGUID const & b)
+               { return guid_equal (&a, &b); }));
+}
+
 TEST (GncGUID, copy)
 {
     auto guid = gnc::GUID::create_random ();
@@ -97,3 +121,74 @@ TEST (GncGUID, round_trip)
     EXPECT_EQ (guid1, guid2);
 }
 
+
+TEST (GncGUID, hex_digits)
+{
+    // The fast encoder must agree with boost's formatting, and the fast
+    // decoder must accept either case and reject anything that isn't hex.
+    for (auto i = 0; i < 1000; ++i)
+    {
+        auto guid = gnc::GUID::create_random ();
+        GncGUID c_guid = guid;
+        std::ostringstream ref;
+        for (auto byte : c_guid.reserved)
+            ref << std::hex << std::setw (2) << std::setfill ('0') << unsigned (byte);
+        auto expected = ref.str ();
+        auto str = guid.to_string ();
+        EXPECT_EQ (expected, str);
+
+        char buff[GUID_ENCODING_LENGTH + 1];
+        EXPECT_EQ (buff + GUID_ENCODING_LENGTH, guid_to_string_buff (&c_guid, buff));
+        EXPECT_STREQ (expected.c_str (), buff);
+
+        std::transform (str.begin (), str.end (), str.begin (), ::toupper);
+        EXPECT_EQ (guid, gnc::GUID::from_string (str));
+        str[i % GUID_ENCODING_LENGTH] = 'g';
+        EXPECT_FALSE (gnc::GUID::is_valid_guid (str));
+        GncGUID parsed;
+        EXPECT_FALSE (string_to_guid (str.c_str (), &parsed));
+    }
+    // Other spellings still go through boost.
+    GncGUID parsed;
+    EXPECT_TRUE (string_to_guid ("01234567-89ab-cdef-0123-456789abcdef", &parsed));
+    EXPECT_EQ ("0123456789abcdef0123456789abcdef",
+               gnc::GUID {parsed}.to_string ());
+    EXPECT_FALSE (string_to_guid ("0123456789abcdef0123456789abcde", &parsed));
+    EXPECT_FALSE (string_to_guid ("0123456789abcdef0123456789abcdef0", &parsed));
+}
+
+/* A microbenchmark of the GUID string conversions. It's disabled so that it
+ * doesn't slow down the test suite; run it with
+ * test-gnc-guid --gtest_also_run_disabled_tests --gtest_filter='*speed*'
+ */
+TEST (GncGUID, DISABLED_string_speed)
+{
+    constexpr auto count = 1000000;
+    std::vector<GncGUID> guids (1000);
+    guid_new_batch (guids.data (), guids.size ());
+    char buff[GUID_ENCODING_LENGTH + 1];
+    GncGUID parsed;
+    unsigned check = 0;
+
+    auto start = std::chrono::steady_clock::now ();
+    for (auto i = 0; i < count; ++i)
+    {
+        guid_to_string_buff (&guids[i % guids.size ()], buff);
+        check += buff[i % GUID_ENCODING_LENGTH];
+    }
+    auto encoded = std::chrono::steady_clock::now ();
+    for (auto i = 0; i < count; ++i)
+    {
+        buff[i % GUID_ENCODING_LENGTH] = "0123456789abcdef"[i % 16];
+        string_to_guid (buff, &parsed);
+        check += parsed.reserved[i % GUID_DATA_SIZE];
+    }
+    auto decoded = std::chrono::steady_clock::now ();
+
+    using ns = std::chrono::duration<double, std::nano>;
+    std::cout << "guid_to_string_buff: "
+              << ns (encoded - start).count () / count << " ns\n"
+              << "string_to_guid:      "
+              << ns (decoded - encoded).count () / count << " ns\n"
+              << "(checksum " << check << ")" << std::endl;
+}
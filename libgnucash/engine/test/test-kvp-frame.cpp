@@ -70,6 +70,41 @@ TEST_F (KvpFrameTest, SetLocal)
     delete v1;
 }
 
+TEST_F (KvpFrameTest, SetLocalKey)
+{
+    /* A single key doesn't need a Path and doesn't split on the delimiter. */
+    KvpFrameImpl frame;
+    auto v1 = new KvpValueImpl {(int64_t)7};
+    std::string key {"a/b"};
+
+    EXPECT_EQ (nullptr, frame.set (key.c_str (), v1));
+    EXPECT_EQ (v1, frame.get_slot (key.c_str ()));
+    EXPECT_EQ (v1, frame.get_slot (Path {key}));
+    EXPECT_EQ (nullptr, frame.get_slot ({"a", "b"}));
+    EXPECT_EQ (nullptr, frame.set (nullptr, v1));
+    EXPECT_EQ (v1, frame.set (key.c_str (), nullptr));
+    EXPECT_TRUE (frame.empty ());
+    delete v1;
+}
+
+TEST_F (KvpFrameTest, KeyArrayPath)
+{
+    const char * keys[] {"top", "second", "new"};
+    auto v1 = new KvpValueImpl {(int64_t)9};
+
+    EXPECT_EQ (nullptr, t_root.get_slot (keys, 3));
+    EXPECT_EQ (nullptr, t_root.set_path (keys, 3, v1));
+    EXPECT_EQ (v1, t_root.get_slot (keys, 3));
+    EXPECT_EQ (v1, t_root.get_slot ({"top", "second", "new"}));
+    EXPECT_EQ (t_root.get_slot ({"top", "second"}), t_root.get_slot (keys, 2));
+    EXPECT_EQ (nullptr, t_root.get_slot (keys, 0));
+
+    /* A non-frame value in the middle of the path is replaced by a frame. */
+    const char * deeper[] {"top", "second", "new", "leaf"};
+    EXPECT_EQ (nullptr, t_root.set_path (deeper, 4, new KvpValueImpl {1.5}));
+    EXPECT_EQ (1.5, t_root.get_slot (deeper, 4)->get<double> ());
+}
+
 TEST_F (KvpFrameTest, SetPath)
 {
     Path path1 {"top", "second", "twenty-first"};
@@ -189,6 +224,32 @@ TEST_F (KvpFrameTest, Empty)
     EXPECT_FALSE(f2.empty());
 }
 
+TEST_F (KvpFrameTest, ManySlots)
+{
+    /* Grow a frame well past the flat storage limit and check that the
+     * slots stay in key order and can be found, replaced and removed. */
+    KvpFrameImpl frame;
+    auto count = 3 * KvpFrameImpl::map_type::flat_limit;
+    for (auto i = count; i > 0; --i)
+    {
+        auto key = std::to_string (1000 + i);
+        EXPECT_EQ (nullptr, frame.set ({key}, new KvpValue {int64_t (i)}));
+    }
+    auto keys = frame.get_keys ();
+    ASSERT_EQ (count, keys.size ());
+    EXPECT_TRUE (std::is_sorted (keys.begin (), keys.end ()));
+    EXPECT_EQ (7, frame.get_slot ({"1007"})->get<int64_t> ());
+
+    delete frame.set ({"1007"}, new KvpValue {int64_t (70)});
+    EXPECT_EQ (70, frame.get_slot ({"1007"})->get<int64_t> ());
+    delete frame.set ({"1007"}, nullptr);
+    EXPECT_EQ (nullptr, frame.get_slot ({"1007"}));
+    EXPECT_EQ (count - 1, frame.get_keys ().size ());
+
+    KvpFrameImpl copy {frame};
+    EXPECT_EQ (0, compare (frame, copy));
+}
+
 TEST (KvpFrameTestForEachPrefix, for_each_prefix_1)
 {
     KvpFrame fr;
@@ -542,7 +542,89 @@ check_add_subtract (void)
         check_binary_op (e,
                          gnc_numeric_sub(a, b, GNC_DENOM_AUTO, GNC_HOW_DENOM_EXACT),
                          a, b, "expected %s got %s = %s - %s for exact subtraction");
+
+        /* The same-denominator shortcuts */
+        e = gnc_numeric_create(na + nb, deno);
+        check_binary_op (e, gnc_numeric_add_fixed(a, b),
+                         a, b, "expected %s got %s = %s + %s for add fixed");
+        e = gnc_numeric_create(na - nb, deno);
+        check_binary_op (e, gnc_numeric_sub_fixed(a, b),
+                         a, b, "expected %s got %s = %s - %s for sub fixed");
+    }
+
+    /* A same-denominator sum which overflows 64 bits must go through
+     * the general code, not wrap around. */
+    a = gnc_numeric_create(G_MAXINT64 - 5, 100);
+    b = gnc_numeric_create(10, 100);
+    c = gnc_numeric_add_fixed(a, b);
+    do_test (gnc_numeric_check (c) != GNC_ERROR_OK ||
+             gnc_numeric_positive_p (c), "add fixed overflow wrapped");
+    c = gnc_numeric_sub_fixed(gnc_numeric_neg (a), b);
+    do_test (gnc_numeric_check (c) != GNC_ERROR_OK ||
+             gnc_numeric_negative_p (c), "sub fixed overflow wrapped");
+
+    /* Reducing is left to the general code too. */
+    a = gnc_numeric_create(25, 100);
+    check_binary_op (gnc_numeric_create(1, 2),
+                     gnc_numeric_add(a, a, GNC_DENOM_AUTO, GNC_HOW_DENOM_REDUCE),
+                     a, a, "expected %s got %s = %s + %s for add reduce");
+}
+
+static void
+check_sum_array (void)
+{
+    gnc_numeric values[6], sums[6], total;
+    gsize count;
+    int i;
+
+    do_test (gnc_numeric_zero_p (gnc_numeric_sum_array (NULL, 0)),
+             "sum of no values");
+
+    for (i = 0; i < NREPS; i++)
+    {
+        gint64 deno = rand() % 3 ? 100 : 1000;
+        gnc_numeric expected = gnc_numeric_zero ();
+        int j;
+
+        for (j = 0; j < 6; j++)
+        {
+            values[j] = gnc_numeric_create (get_random_gint64 () / 1000000,
+                                            j == 3 ? deno : 100);
+            expected = gnc_numeric_add_fixed (expected, values[j]);
+        }
+        check_binary_op (expected, gnc_numeric_sum_array (values, 6),
+                         values[0], values[1],
+                         "expected %s got %s = sum of array from %s, %s");
     }
+
+    /* The running total leaves 64 bits but the final one is back in range. */
+    values[0] = gnc_numeric_create (G_MAXINT64, 100);
+    values[1] = gnc_numeric_create (G_MAXINT64, 100);
+    values[2] = gnc_numeric_create (-G_MAXINT64, 100);
+    values[3] = gnc_numeric_create (-G_MAXINT64, 100);
+    values[4] = gnc_numeric_create (5, 100);
+    total = gnc_numeric_sum_array (values, 5);
+    check_binary_op (gnc_numeric_create (5, 100), total, values[0], values[4],
+                     "expected %s got %s = sum of array from %s ... %s");
+
+    values[0] = gnc_numeric_create (1234, 100);
+    values[1] = gnc_numeric_create (1, 1000);
+    values[2] = gnc_numeric_create (-34, 100);
+    values[3] = gnc_numeric_create (2, 1000);
+    values[4] = gnc_numeric_create (7, 100);
+    count = gnc_numeric_sum_array_by_denom (values, 5, sums);
+    do_test (count == 2, "two denominators");
+    check_binary_op (gnc_numeric_create (1207, 100), sums[0],
+                     values[0], values[2],
+                     "expected %s got %s = hundredths from %s, %s");
+    check_binary_op (gnc_numeric_create (3, 1000), sums[1],
+                     values[1], values[3],
+                     "expected %s got %s = thousandths from %s, %s");
+
+    values[2] = gnc_numeric_error (GNC_ERROR_ARG);
+    total = gnc_numeric_sum_array (values, 5);
+    do_test (gnc_numeric_check (total) != GNC_ERROR_OK,
+             "error values spoil the sum");
 }
 
 static const gint64 pten[] = { 1, 10, 100, 1000, 10000, 100000, 1000000,
@@ -898,6 +980,7 @@ run_test (void)
     check_neg();
     check_add_subtract();
     check_add_subtract_overflow ();
+    check_sum_array ();
     check_mult_div ();
 }
 
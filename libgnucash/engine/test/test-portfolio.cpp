@@ -0,0 +1,268 @@
+/***************************************************************************
+ *            test-portfolio.cpp
+ *
+ *  Copyright  2026  Gnucash team
+ ****************************************************************************/
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ *  02110-1301, USA.
+ */
+extern "C"
+{
+#include <config.h>
+#include <glib.h>
+#include "qof.h"
+#include "cashobjects.h"
+#include "Account.h"
+#include "Transaction.h"
+#include "TransLog.h"
+#include "gnc-engine.h"
+#include "gnc-lot.h"
+#include "gnc-portfolio.h"
+#include "gnc-pricedb.h"
+#include "test-stuff.h"
+}
+
+struct Book
+{
+    QofBook *book;
+    gnc_commodity *usd;
+    gnc_commodity *stock_commodity;
+    Account *stock, *bank, *income, *fees;
+    GNCLot *first_lot, *second_lot;
+};
+
+static Account *
+make_account (QofBook *book, Account *parent, const char *name,
+              GNCAccountType type, gnc_commodity *commodity)
+{
+    auto account = xaccMallocAccount (book);
+
+    xaccAccountBeginEdit (account);
+    xaccAccountSetName (account, name);
+    xaccAccountSetType (account, type);
+    xaccAccountSetCommodity (account, commodity);
+    gnc_account_append_child (parent, account);
+    xaccAccountCommitEdit (account);
+    return account;
+}
+
+static Split *
+add_split (Transaction *trans, Account *account, gnc_numeric amount,
+           gint64 cents)
+{
+    auto split = xaccMallocSplit (qof_instance_get_book (trans));
+
+    xaccSplitSetAccount (split, account);
+    xaccSplitSetParent (split, trans);
+    xaccSplitSetAmount (split, amount);
+    xaccSplitSetValue (split, gnc_numeric_create (cents, 100));
+    return split;
+}
+
+static Transaction *
+begin_trans (Book& b, gint day, gint month)
+{
+    auto trans = xaccMallocTransaction (b.book);
+
+    xaccTransBeginEdit (trans);
+    xaccTransSetCurrency (trans, b.usd);
+    xaccTransSetDatePostedSecsNormalized (trans,
+                                          gnc_dmy2time64_neutral (day, month, 2020));
+    return trans;
+}
+
+/* Buys units of the stock for cents, paying fee_cents in brokerage. */
+static Split *
+buy (Book& b, gint day, gint month, gint64 units, gint64 cents,
+     gint64 fee_cents)
+{
+    auto trans = begin_trans (b, day, month);
+    auto split = add_split (trans, b.stock, gnc_numeric_create (units, 1), cents);
+
+    add_split (trans, b.bank, gnc_numeric_create (-cents - fee_cents, 100),
+               -cents - fee_cents);
+    if (fee_cents)
+        add_split (trans, b.fees, gnc_numeric_create (fee_cents, 100), fee_cents);
+    xaccTransCommitEdit (trans);
+    return split;
+}
+
+static void
+setup (Book& b)
+{
+    b.book = qof_book_new ();
+    auto table = gnc_commodity_table_get_table (b.book);
+    b.usd = gnc_commodity_table_lookup (table, GNC_COMMODITY_NS_CURRENCY, "USD");
+    b.stock_commodity = gnc_commodity_new (b.book, "Gnome, Inc.", "NYSE",
+                                           "GNM", "", 1);
+    gnc_commodity_table_insert (table, b.stock_commodity);
+
+    auto root = gnc_account_create_root (b.book);
+    b.stock = make_account (b.book, root, "Gnome", ACCT_TYPE_STOCK,
+                            b.stock_commodity);
+    b.bank = make_account (b.book, root, "Bank", ACCT_TYPE_BANK, b.usd);
+    b.income = make_account (b.book, root, "Dividends", ACCT_TYPE_INCOME, b.usd);
+    b.fees = make_account (b.book, root, "Brokerage", ACCT_TYPE_EXPENSE, b.usd);
+
+    /* 10 units for $100 with $5 brokerage, in the first lot. */
+    auto split = buy (b, 1, 1, 10, 10000, 500);
+    b.first_lot = gnc_lot_new (b.book);
+    gnc_lot_add_split (b.first_lot, split);
+
+    /* 10 units for $200, in the second lot. */
+    split = buy (b, 1, 2, 10, 20000, 0);
+    b.second_lot = gnc_lot_new (b.book);
+    gnc_lot_add_split (b.second_lot, split);
+
+    /* A $30 dividend reinvested in 1 unit, in no lot. */
+    auto trans = begin_trans (b, 1, 3);
+    add_split (trans, b.stock, gnc_numeric_create (1, 1), 3000);
+    add_split (trans, b.income, gnc_numeric_create (-3000, 100), -3000);
+    xaccTransCommitEdit (trans);
+
+    /* 8 units sold for $200, from the second lot. */
+    trans = begin_trans (b, 1, 4);
+    split = add_split (trans, b.stock, gnc_numeric_create (-8, 1), -20000);
+    add_split (trans, b.bank, gnc_numeric_create (20000, 100), 20000);
+    xaccTransCommitEdit (trans);
+    gnc_lot_add_split (b.second_lot, split);
+
+    /* A 2 for 1 split of the 13 units held. */
+    trans = begin_trans (b, 1, 5);
+    add_split (trans, b.stock, gnc_numeric_create (13, 1), 0);
+    xaccTransCommitEdit (trans);
+
+    auto price = gnc_price_create (b.book);
+    gnc_price_begin_edit (price);
+    gnc_price_set_commodity (price, b.stock_commodity);
+    gnc_price_set_currency (price, b.usd);
+    gnc_price_set_time64 (price, gnc_dmy2time64_neutral (1, 6, 2020));
+    gnc_price_set_value (price, gnc_numeric_create (25, 1));
+    gnc_price_commit_edit (price);
+    gnc_pricedb_add_price (gnc_pricedb_get_db (b.book), price);
+    gnc_price_unref (price);
+}
+
+static GncPortfolioHolding
+get_holding (Book& b, time64 date, GncPortfolioBasis method,
+             gboolean fees_in_basis)
+{
+    GList accounts = { b.stock, NULL, NULL };
+    auto holdings = gnc_portfolio_get_holdings (&accounts, date, b.usd, method,
+                                                fees_in_basis);
+    GncPortfolioHolding holding = *static_cast<GncPortfolioHolding*>(holdings->data);
+
+    do_test (g_list_length (holdings) == 1, "one holding per account");
+    gnc_portfolio_holdings_free (holdings);
+    return holding;
+}
+
+static bool
+equal (gnc_numeric n, gint64 num, gint64 denom)
+{
+    return gnc_numeric_equal (n, gnc_numeric_create (num, denom));
+}
+
+static void
+check (bool ok, const char *method, const char *what)
+{
+    auto title = g_strdup_printf ("%s: %s", method, what);
+    do_test (ok, title);
+    g_free (title);
+}
+
+static void
+test_methods (Book& b)
+{
+    struct
+    {
+        GncPortfolioBasis method;
+        gint64 basis_cents;
+        gint64 gain_cents;
+        const char *name;
+    } expected[] =
+    {
+        /* 2 of the first 10 units, and the later ones at $20 and $30. */
+        { GNC_PORTFOLIO_BASIS_FIFO, 25000, 12000, "FIFO" },
+        /* The unit at $30, 7 at $20; 10 at $10 and 3 at $20 are left. */
+        { GNC_PORTFOLIO_BASIS_LIFO, 16000, 3000, "LIFO" },
+        /* 13 of 21 units costing $330. */
+        { GNC_PORTFOLIO_BASIS_AVERAGE, 20429, 7429, "average" },
+        /* 8 of the second lot's 10 units at $20. */
+        { GNC_PORTFOLIO_BASIS_LOTS, 17000, 4000, "lots" },
+    };
+    auto date = gnc_dmy2time64_neutral (1, 7, 2020);
+
+    for (const auto& e : expected)
+    {
+        auto h = get_holding (b, date, e.method, FALSE);
+        check (equal (h.units, 26, 1), e.name, "units after the stock split");
+        check (equal (h.basis, e.basis_cents, 100), e.name, "basis");
+        check (equal (h.realized_gain, e.gain_cents, 100), e.name,
+               "realized gain");
+        check (h.have_price && equal (h.value, 65000, 100), e.name, "value");
+        check (equal (h.unrealized_gain, 65000 - e.basis_cents, 100), e.name,
+               "unrealized gain");
+        check (equal (h.income, 3000, 100), e.name, "income");
+        check (equal (h.brokerage, 500, 100), e.name, "brokerage");
+        check (equal (h.money_in, 30000, 100), e.name,
+               "money in leaves out the reinvested dividend");
+        check (equal (h.money_out, 20000, 100), e.name, "money out");
+    }
+}
+
+static void
+test_fees_in_basis (Book& b)
+{
+    auto h = get_holding (b, gnc_dmy2time64_neutral (1, 7, 2020),
+                          GNC_PORTFOLIO_BASIS_FIFO, TRUE);
+
+    /* The first 10 units cost $105, 8 of them $84. */
+    do_test (equal (h.realized_gain, 11600, 100), "brokerage adds to the cost");
+    do_test (equal (h.basis, 25100, 100), "brokerage adds to the basis");
+    do_test (equal (h.money_in, 30500, 100), "brokerage adds to money in");
+}
+
+static void
+test_date (Book& b)
+{
+    auto h = get_holding (b, gnc_dmy2time64_neutral (15, 2, 2020),
+                          GNC_PORTFOLIO_BASIS_FIFO, FALSE);
+
+    do_test (equal (h.units, 20, 1), "only the splits up to the date count");
+    do_test (equal (h.basis, 30000, 100), "basis at the date");
+    do_test (gnc_numeric_zero_p (h.realized_gain), "nothing sold by the date");
+    do_test (gnc_numeric_zero_p (h.income), "no income by the date");
+}
+
+int
+main (int argc, char **argv)
+{
+    qof_init();
+    if (cashobjects_register())
+    {
+        Book b;
+        xaccLogDisable ();
+        setup (b);
+        test_methods (b);
+        test_fees_in_basis (b);
+        test_date (b);
+        qof_book_destroy (b.book);
+        print_test_results();
+    }
+    qof_close();
+    return get_rv();
+}
@@ -77,8 +77,68 @@ test_qof_string_cache( void )
     g_assert(str1_1 != str1_4);
 }
 
+static void
+test_qof_string_cache_reserve( void )
+{
+    /* Reserving room, even repeatedly, mustn't move cached strings. */
+    gchar* held = qof_string_cache_insert ("reserved");
+    gchar* again;
+
+    qof_string_cache_reserve (1000);
+    qof_string_cache_reserve (10);
+    again = qof_string_cache_insert ("reserved");
+    g_assert (again == held);
+    g_assert_cmpstr (again, ==, "reserved");
+    qof_string_cache_remove (again);
+    qof_string_cache_remove (held);
+}
+
+#define CACHE_THREADS 4
+#define CACHE_ROUNDS 1000
+
+static gpointer
+string_cache_thread (gpointer data)
+{
+    gchar** result = data;
+    gint i;
+    for (i = 0; i < CACHE_ROUNDS; ++i)
+    {
+        gchar* str = qof_string_cache_insert ("shared");
+        qof_string_cache_remove (str);
+    }
+    *result = qof_string_cache_insert ("shared");
+    return NULL;
+}
+
+static void
+test_qof_string_cache_threads( void )
+{
+    /* Concurrent users of the same string must all get the same cached
+     * address, and the refcount must come out exact. */
+    GThread* threads[CACHE_THREADS];
+    gchar* results[CACHE_THREADS];
+    gchar* held = qof_string_cache_insert ("shared");
+    gint i;
+
+    for (i = 0; i < CACHE_THREADS; ++i)
+        threads[i] = g_thread_new ("string-cache", string_cache_thread,
+                                   &results[i]);
+    for (i = 0; i < CACHE_THREADS; ++i)
+    {
+        g_thread_join (threads[i]);
+        g_assert (results[i] == held);
+    }
+    for (i = 0; i < CACHE_THREADS; ++i)
+        qof_string_cache_remove (results[i]);
+    g_assert (qof_string_cache_insert ("shared") == held);
+    qof_string_cache_remove (held);
+    qof_string_cache_remove (held);
+}
+
 void
 test_suite_qof_string_cache ( void )
 {
     GNC_TEST_ADD_FUNC( suitename, "string-cache", test_qof_string_cache);
+    GNC_TEST_ADD_FUNC( suitename, "string-cache reserve", test_qof_string_cache_reserve);
+    GNC_TEST_ADD_FUNC( suitename, "string-cache threads", test_qof_string_cache_threads);
 }
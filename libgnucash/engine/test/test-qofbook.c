@@ -36,6 +36,8 @@ extern "C"
 #include "../qof.h"
 #include "../qofbook-p.h"
 #include "../qofbookslots.h"
+#include "../qofinstance-p.h"
+#include "../gnc-features.h"
 /* For gnc_account_create_root() */
 #include "../Account.h"
 
@@ -292,6 +294,40 @@ test_book_session_not_saved( Fixture *fixture, gconstpointer pData )
     g_assert( qof_book_session_not_saved( fixture->book ) );
 }
 
+static void
+test_book_dirty_instances( Fixture *fixture, gconstpointer pData )
+{
+    Account *acc;
+    GList *dirty;
+
+    qof_book_mark_instances_clean( fixture->book );
+    g_assert( !qof_book_has_dirty_instances( fixture->book ) );
+    g_assert( qof_book_get_dirty_instances( fixture->book ) == NULL );
+    g_assert( !qof_instance_is_dirty( QOF_INSTANCE( fixture->book ) ) );
+
+    acc = xaccMallocAccount( fixture->book );
+    qof_book_mark_instances_clean( fixture->book );
+    qof_instance_set_dirty( QOF_INSTANCE( acc ) );
+    g_assert( qof_book_has_dirty_instances( fixture->book ) );
+    dirty = qof_book_get_dirty_instances( fixture->book );
+    g_assert_cmpint( g_list_length( dirty ), == , 1 );
+    g_assert( dirty->data == acc );
+    g_list_free( dirty );
+
+    qof_instance_mark_clean( QOF_INSTANCE( acc ) );
+    g_assert( !qof_book_has_dirty_instances( fixture->book ) );
+
+    qof_instance_set_dirty( QOF_INSTANCE( acc ) );
+    qof_instance_set_dirty( QOF_INSTANCE( fixture->book ) );
+    dirty = qof_book_get_dirty_instances( fixture->book );
+    g_assert_cmpint( g_list_length( dirty ), == , 2 );
+    g_list_free( dirty );
+    qof_book_mark_instances_clean( fixture->book );
+    g_assert( !qof_book_has_dirty_instances( fixture->book ) );
+    g_assert( !qof_instance_is_dirty( QOF_INSTANCE( acc ) ) );
+    g_assert( !qof_instance_is_dirty( QOF_INSTANCE( fixture->book ) ) );
+}
+
 static void
 test_book_mark_session_saved( Fixture *fixture, gconstpointer pData )
 {
@@ -614,6 +650,30 @@ test_book_use_split_action_for_num_field( Fixture *fixture, gconstpointer pData
     qof_book_commit_edit (fixture->book);
 }
 
+static void
+test_book_features( Fixture *fixture, gconstpointer pData )
+{
+    g_assert( !gnc_features_check_used( fixture->book, GNC_FEATURE_CREDIT_NOTES ) );
+    g_assert( fixture->book->cached_features_isvalid );
+
+    g_test_message( "Testing that setting a feature updates the cached features" );
+    gnc_features_set_used( fixture->book, GNC_FEATURE_CREDIT_NOTES );
+    g_assert( gnc_features_check_used( fixture->book, GNC_FEATURE_CREDIT_NOTES ) );
+    g_assert( !gnc_features_check_used( fixture->book, GNC_FEATURE_BOOK_CURRENCY ) );
+
+    g_test_message( "Testing a feature unknown to this version" );
+    qof_book_set_feature( fixture->book, "Some later feature", "A later feature" );
+    g_assert( gnc_features_check_used( fixture->book, "Some later feature" ) );
+    g_assert( gnc_features_check_used( fixture->book, GNC_FEATURE_CREDIT_NOTES ) );
+
+    g_test_message( "Testing a change of the features frame behind the book's back" );
+    qof_instance_set_kvp( QOF_INSTANCE( fixture->book ), NULL, 2, "features",
+                          GNC_FEATURE_CREDIT_NOTES );
+    qof_book_features_changed( fixture->book );
+    g_assert( !gnc_features_check_used( fixture->book, GNC_FEATURE_CREDIT_NOTES ) );
+    g_assert( gnc_features_check_used( fixture->book, "Some later feature" ) );
+}
+
 static void
 test_book_mark_session_dirty( Fixture *fixture, gconstpointer pData )
 {
@@ -927,6 +987,7 @@ test_suite_qofbook ( void )
     GNC_TEST_ADD( suitename, "set string option", Fixture, NULL, setup, test_book_set_string_option, teardown );
     GNC_TEST_ADD( suitename, "session not saved", Fixture, NULL, setup, test_book_session_not_saved, teardown );
     GNC_TEST_ADD( suitename, "session mark saved", Fixture, NULL, setup, test_book_mark_session_saved, teardown );
+    GNC_TEST_ADD( suitename, "dirty instances", Fixture, NULL, setup, test_book_dirty_instances, teardown );
     GNC_TEST_ADD( suitename, "get counter", Fixture, NULL, setup, test_book_get_counter, teardown );
     GNC_TEST_ADD( suitename, "get counter format", Fixture, NULL, setup, test_book_get_counter_format, teardown );
     GNC_TEST_ADD( suitename, "increment and format counter", Fixture, NULL, setup, test_book_increment_and_format_counter, teardown );
@@ -934,6 +995,7 @@ test_suite_qofbook ( void )
     GNC_TEST_ADD( suitename, "use book-currency", Fixture, NULL, setup, test_book_use_book_currency, teardown );
     GNC_TEST_ADD( suitename, "get autofreeze days", Fixture, NULL, setup, test_book_get_num_days_autofreeze, teardown );
     GNC_TEST_ADD( suitename, "use split action for num field", Fixture, NULL, setup, test_book_use_split_action_for_num_field, teardown );
+    GNC_TEST_ADD( suitename, "features", Fixture, NULL, setup, test_book_features, teardown );
     GNC_TEST_ADD( suitename, "mark session dirty", Fixture, NULL, setup, test_book_mark_session_dirty, teardown );
     GNC_TEST_ADD( suitename, "session dirty time", Fixture, NULL, setup, test_book_get_session_dirty_time, teardown );
     GNC_TEST_ADD( suitename, "set dirty callback", Fixture, NULL, setup, test_book_set_dirty_cb, teardown );
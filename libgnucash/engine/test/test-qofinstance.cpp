@@ -436,6 +436,56 @@ test_instance_display_name( Fixture *fixture, gconstpointer pData )
     qof_collection_destroy( col );
 }
 
+static void
+count_entity_cb( QofInstance *inst, gpointer data )
+{
+    ++*static_cast<guint*>( data );
+}
+
+static void
+test_collection_lookup( void )
+{
+    /* Enough entities to grow the table several times, with half of them
+     * removed again to exercise removal from the middle of probe runs. */
+    const guint count = 1000;
+    QofIdType type = "test type";
+    QofBook *book = qof_book_new();
+    QofCollection *col = qof_book_get_collection( book, type );
+    std::vector<QofInstance*> insts;
+    guint seen = 0;
+
+    qof_collection_reserve( col, count / 2 );
+    for ( guint i = 0; i < count; ++i )
+    {
+        auto inst = static_cast<QofInstance*>( g_object_new( QOF_TYPE_INSTANCE, NULL ) );
+        qof_instance_init_data( inst, type, book );
+        insts.push_back( inst );
+    }
+    g_assert_cmpint( qof_collection_count( col ), == , count );
+
+    for ( guint i = 0; i < count; i += 2 )
+        qof_collection_remove_entity( insts[i] );
+    g_assert_cmpint( qof_collection_count( col ), == , count / 2 );
+
+    for ( guint i = 0; i < count; ++i )
+    {
+        auto found = qof_collection_lookup_entity( col, qof_instance_get_guid( insts[i] ) );
+        g_assert( found == ( i % 2 ? insts[i] : NULL ) );
+    }
+    g_assert( qof_collection_lookup_entity( col, guid_null() ) == NULL );
+
+    qof_collection_foreach( col, count_entity_cb, &seen );
+    g_assert_cmpint( seen, == , count / 2 );
+
+    for ( auto inst : insts )
+    {
+        qof_collection_remove_entity( inst );
+        g_object_unref( inst );
+    }
+    g_assert_cmpint( qof_collection_count( col ), == , 0 );
+    qof_book_destroy( book );
+}
+
 static void
 mock_backend_begin( QofBackend *be, QofInstance *inst )
 {
@@ -497,6 +547,56 @@ test_instance_begin_edit( Fixture *fixture, gconstpointer pData )
 
 }
 
+static gint reader_done = FALSE;
+
+static gpointer
+read_locked_thread( gpointer data )
+{
+    qof_engine_read_lock();
+    g_atomic_int_set( &reader_done, TRUE );
+    qof_engine_read_unlock();
+    return NULL;
+}
+
+static void
+test_engine_concurrent_reads( Fixture *fixture, gconstpointer pData )
+{
+    GThread *reader;
+
+    qof_engine_set_concurrent_reads( TRUE );
+    g_assert( qof_engine_get_concurrent_reads() );
+
+    g_test_message( "Test that the write lock nests and holds off readers" );
+    qof_engine_write_lock();
+    qof_engine_write_lock();
+    g_atomic_int_set( &reader_done, FALSE );
+    reader = g_thread_new( "reader", read_locked_thread, NULL );
+    qof_engine_write_unlock();
+    g_usleep( 50000 );
+    g_assert( !g_atomic_int_get( &reader_done ) );
+    qof_engine_write_unlock();
+    g_thread_join( reader );
+    g_assert( g_atomic_int_get( &reader_done ) );
+
+    g_test_message( "Test that an edit holds off readers until the main loop is idle" );
+    g_assert( g_main_context_acquire( g_main_context_default() ) );
+    g_atomic_int_set( &reader_done, FALSE );
+    g_assert( qof_begin_edit( fixture->inst ) );
+    reader = g_thread_new( "reader", read_locked_thread, NULL );
+    g_usleep( 50000 );
+    g_assert( !g_atomic_int_get( &reader_done ) );
+    g_assert( qof_commit_edit( fixture->inst ) );
+    g_usleep( 50000 );
+    g_assert( !g_atomic_int_get( &reader_done ) );
+    while (g_main_context_iteration( NULL, FALSE ));
+    g_thread_join( reader );
+    g_assert( g_atomic_int_get( &reader_done ) );
+    g_main_context_release( g_main_context_default() );
+
+    qof_engine_set_concurrent_reads( FALSE );
+    g_assert( !qof_engine_get_concurrent_reads() );
+}
+
 static void
 test_instance_commit_edit( Fixture *fixture, gconstpointer pData )
 {
@@ -995,8 +1095,10 @@ test_suite_qofinstance ( void )
     GNC_TEST_ADD_FUNC( suitename, "version compare", test_instance_version_cmp );
     GNC_TEST_ADD( suitename, "get set dirty", Fixture, NULL, setup, test_instance_get_set_dirty, teardown );
     GNC_TEST_ADD( suitename, "display name", Fixture, NULL, setup, test_instance_display_name, teardown );
+    GNC_TEST_ADD_FUNC( suitename, "collection lookup", test_collection_lookup );
     GNC_TEST_ADD( suitename, "begin edit", Fixture, NULL, setup, test_instance_begin_edit, teardown );
     GNC_TEST_ADD( suitename, "commit edit", Fixture, NULL, setup, test_instance_commit_edit, teardown );
+    GNC_TEST_ADD( suitename, "engine concurrent reads", Fixture, NULL, setup, test_engine_concurrent_reads, teardown );
     GNC_TEST_ADD( suitename, "commit edit part 2", Fixture, NULL, setup, test_instance_commit_edit_part2, teardown );
     GNC_TEST_ADD( suitename, "instance refers to object", Fixture, NULL, setup, test_instance_refers_to_object, teardown );
     GNC_TEST_ADD_FUNC( suitename, "instance get referring object list from collection", test_instance_get_referring_object_list_from_collection );
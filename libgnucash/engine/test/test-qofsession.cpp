@@ -29,6 +29,7 @@
 #include <cstdlib>
 #include "../gnc-backend-prov.hpp"
 #include "../Account.h"
+#include <thread>
 
 static QofBook * exported_book {nullptr};
 static bool safe_sync_called {false};
@@ -36,6 +37,10 @@ static bool sync_called {false};
 static bool load_error {true};
 static bool hook_called {false};
 static bool data_loaded {false};
+static int batches_begun {0};
+static int batches_ended {0};
+static bool background_sync {false};
+static bool background_finished {false};
 
 class QofSessionMockBackend : public QofBackend
 {
@@ -49,7 +54,13 @@ public:
     void load(QofBook*, QofBackendLoadType);
     void sync(QofBook*);
     void safe_sync(QofBook*);
+    bool begin_background_sync(QofBook*, std::function<void()>);
+    void finish_background_sync();
     void export_coa(QofBook*);
+    void begin_batch() { ++batches_begun; }
+    void end_batch() { ++batches_ended; }
+private:
+    std::thread m_worker;
 };
 
 static void
@@ -60,6 +71,8 @@ example_hook (QofSession & session)
 
 void QofSessionMockBackend::load (QofBook *book, QofBackendLoadType)
 {
+    if (auto percentage = get_percentage ())
+        percentage ("Loading", 50.0);
     if (load_error)
         set_error(ERR_BACKEND_NO_BACKEND);
     else
@@ -77,6 +90,24 @@ void QofSessionMockBackend::sync (QofBook *)
     sync_called = true;
 }
 
+bool QofSessionMockBackend::begin_background_sync (QofBook *book,
+                                                   std::function<void()> done)
+{
+    if (!background_sync)
+        return false;
+    qof_book_mark_session_saved (book);
+    m_worker = std::thread (done);
+    return true;
+}
+
+void QofSessionMockBackend::finish_background_sync ()
+{
+    if (!m_worker.joinable ())
+        return;
+    m_worker.join ();
+    background_finished = true;
+}
+
 void QofSessionMockBackend::export_coa(QofBook * book)
 {
     exported_book = book;
@@ -202,6 +233,62 @@ TEST (QofSessionTest, load)
     qof_backend_unregister_all_providers ();
 }
 
+TEST (QofSessionTest, load_async)
+{
+    qof_backend_register_provider (get_provider ());
+    QofSession s{qof_book_new()};
+    s.begin ("book1", SESSION_NORMAL_OPEN);
+    load_error = false;
+    auto load = qof_session_load_async (&s, nullptr, nullptr);
+    ASSERT_NE (load, nullptr);
+    while (!qof_session_load_is_done (load))
+        g_thread_yield ();
+    char *message = nullptr;
+    EXPECT_EQ (qof_session_load_get_progress (load, &message), 50.0);
+    EXPECT_STREQ (message, "Loading");
+    g_free (message);
+    EXPECT_EQ (qof_session_load_finish (load), ERR_BACKEND_NO_ERR);
+    EXPECT_NE (gnc_book_get_root_account (s.get_book ()), nullptr);
+    load_error = true;
+    qof_backend_unregister_all_providers ();
+}
+
+TEST (QofSessionTest, load_async_cancel)
+{
+    qof_backend_register_provider (get_provider ());
+    QofSession s{qof_book_new()};
+    s.begin ("book1", SESSION_NORMAL_OPEN);
+    load_error = false;
+    auto load = qof_session_load_async (&s, nullptr, nullptr);
+    ASSERT_NE (load, nullptr);
+    qof_session_load_cancel (load);
+    EXPECT_EQ (qof_session_load_finish (load), ERR_BACKEND_CANCELLED);
+    EXPECT_EQ (s.get_error (), ERR_BACKEND_CANCELLED);
+    EXPECT_TRUE (qof_book_empty (s.get_book ()));
+    load_error = true;
+    qof_backend_unregister_all_providers ();
+}
+
+TEST (QofSessionTest, book_batch)
+{
+    qof_backend_register_provider (get_provider ());
+    QofSession s{qof_book_new()};
+    s.begin ("book1", SESSION_NORMAL_OPEN);
+    load_error = false;
+    s.load (nullptr);
+    auto book = s.get_book ();
+    batches_begun = batches_ended = 0;
+    qof_book_begin_batch (book);
+    qof_book_begin_batch (book);
+    qof_book_end_batch (book);
+    EXPECT_EQ (batches_begun, 1);
+    EXPECT_EQ (batches_ended, 0);
+    qof_book_end_batch (book);
+    EXPECT_EQ (batches_ended, 1);
+    load_error = true;
+    qof_backend_unregister_all_providers ();
+}
+
 TEST (QofSessionTest, save)
 {
     qof_backend_register_provider (get_provider ());
@@ -217,6 +304,55 @@ TEST (QofSessionTest, save)
     load_error = true;
 }
 
+static void
+background_save_done (QofSession *session, QofBackendError err, gpointer data)
+{
+    *static_cast<QofBackendError*>(data) = err;
+}
+
+TEST (QofSessionTest, save_in_background)
+{
+    qof_backend_register_provider (get_provider ());
+    QofSession s(qof_book_new());
+    s.begin ("book1", SESSION_NORMAL_OPEN);
+    load_error = false;
+    s.load (nullptr);
+    qof_book_mark_session_dirty (s.get_book ());
+    /* Backends that can't save in the background are left alone. */
+    EXPECT_FALSE (qof_session_save_in_background (&s, nullptr, nullptr));
+    EXPECT_FALSE (qof_session_save_in_progress (&s));
+
+    background_sync = true;
+    auto result = ERR_BACKEND_MISC;
+    EXPECT_TRUE (qof_session_save_in_background (&s, background_save_done,
+                                                 &result));
+    EXPECT_TRUE (qof_session_save_in_progress (&s));
+    EXPECT_FALSE (qof_book_session_not_saved (s.get_book ()));
+    /* Nothing left to save. */
+    EXPECT_FALSE (qof_session_save_in_background (&s, nullptr, nullptr));
+    while (qof_session_save_in_progress (&s))
+        g_main_context_iteration (nullptr, TRUE);
+    EXPECT_TRUE (background_finished);
+    EXPECT_EQ (result, ERR_BACKEND_NO_ERR);
+
+    /* Waiting for the save skips the callback. */
+    background_finished = false;
+    result = ERR_BACKEND_MISC;
+    qof_book_mark_session_dirty (s.get_book ());
+    EXPECT_TRUE (qof_session_save_in_background (&s, background_save_done,
+                                                 &result));
+    EXPECT_EQ (qof_session_finish_background_save (&s), ERR_BACKEND_NO_ERR);
+    EXPECT_TRUE (background_finished);
+    EXPECT_FALSE (qof_session_save_in_progress (&s));
+    while (g_main_context_iteration (nullptr, FALSE));
+    EXPECT_EQ (result, ERR_BACKEND_MISC);
+
+    qof_backend_unregister_all_providers ();
+    background_sync = false;
+    background_finished = false;
+    load_error = true;
+}
+
 TEST (QofSessionTest, safe_save)
 {
     qof_backend_register_provider (get_provider ());
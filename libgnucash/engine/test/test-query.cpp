@@ -24,9 +24,12 @@ extern "C"
 {
 #include <config.h>
 #include <glib.h>
+#include <string.h>
 #include "qof.h"
 #include "cashobjects.h"
 #include "Transaction.h"
+#include "Account.h"
+#include "Query.h"
 #include "TransLog.h"
 #include "gnc-engine.h"
 #include "test-engine-stuff.h"
@@ -67,6 +70,439 @@ test_trans_query (Transaction *trans, gpointer data)
     return 0;
 }
 
+/* A ledger's query: the account's splits within a date range.  It is
+ * answered from the account's split list rather than by a scan. */
+static void
+test_account_date_query (Account *acc, gpointer data)
+{
+    QofBook *book = QOF_BOOK(data);
+    GList *splits = xaccAccountGetSplitList (acc);
+    GList *list, *node;
+    time64 start, end;
+    guint expected = 0;
+    QofQuery *q;
+
+    if (!splits)
+        return;
+
+    /* The split list is in date order, so this is about half of it */
+    start = xaccTransGetDate (xaccSplitGetParent (GNC_SPLIT(splits->data)));
+    end = xaccTransGetDate (xaccSplitGetParent (GNC_SPLIT(g_list_nth_data (splits, g_list_length (splits) / 2))));
+    for (node = splits; node; node = node->next)
+    {
+        time64 date = xaccTransGetDate (xaccSplitGetParent (GNC_SPLIT(node->data)));
+        if (date >= start && date <= end)
+            expected++;
+    }
+
+    q = qof_query_create_for (GNC_ID_SPLIT);
+    qof_query_set_book (q, book);
+    xaccQueryAddSingleAccountMatch (q, acc, QOF_QUERY_AND);
+    xaccQueryAddDateMatchTT (q, TRUE, start, TRUE, end, QOF_QUERY_AND);
+
+    list = qof_query_run (q);
+    if (g_list_length (list) != expected)
+    {
+        failure_args ("test number returned", __FILE__, __LINE__,
+                      "number of matching splits %d not %d",
+                      g_list_length (list), expected);
+        qof_query_destroy (q);
+        return;
+    }
+    for (node = list; node; node = node->next)
+    {
+        if (xaccSplitGetAccount (GNC_SPLIT(node->data)) != acc)
+        {
+            failure ("matching split is in the wrong account");
+            qof_query_destroy (q);
+            return;
+        }
+    }
+
+    success ("found the account's splits in the date range");
+    qof_query_destroy (q);
+}
+
+/* The parallel search finds the same splits in the same order. */
+static int
+test_parallel_query (Transaction *trans, gpointer data)
+{
+    QofBook *book = QOF_BOOK(data);
+    QofQuery *q, *pq;
+    GList *list, *plist;
+
+    q = make_trans_query (trans, SIMPLE_QT);
+    qof_query_set_book (q, book);
+    pq = qof_query_copy (q);
+    qof_query_set_parallel (pq, TRUE);
+
+    list = qof_query_run (q);
+    plist = qof_query_run (pq);
+    while (list && plist && list->data == plist->data)
+    {
+        list = list->next;
+        plist = plist->next;
+    }
+    if (list || plist)
+    {
+        failure ("parallel query results differ");
+        qof_query_destroy (pq);
+        qof_query_destroy (q);
+        return 14;
+    }
+
+    success ("parallel query found the same splits");
+    qof_query_destroy (pq);
+    qof_query_destroy (q);
+    return 0;
+}
+
+/* Only picking out the last few keeps the same ones as cropping the
+ * fully sorted list. */
+static void
+test_max_results_query (QofBook *book)
+{
+    QofQuery *q, *mq;
+    GList *list, *mlist;
+    guint n;
+
+    q = qof_query_create_for (GNC_ID_SPLIT);
+    qof_query_set_book (q, book);
+    mq = qof_query_copy (q);
+    qof_query_set_max_results (mq, 5);
+
+    list = qof_query_run (q);
+    mlist = qof_query_run (mq);
+    n = g_list_length (list);
+    if (n > 5)
+        list = g_list_nth (list, n - 5);
+    while (list && mlist && list->data == mlist->data)
+    {
+        list = list->next;
+        mlist = mlist->next;
+    }
+    if (list || mlist)
+    {
+        failure ("the last results differ from the cropped sorted list");
+    }
+    else
+    {
+        success ("found the last results");
+    }
+
+    qof_query_destroy (mq);
+    qof_query_destroy (q);
+}
+
+/* Sorting on a date through the transaction orders by that date. */
+static void
+test_sorted_query (QofBook *book)
+{
+    QofQuery *q;
+    GList *node;
+    time64 last = G_MAXINT64;
+
+    q = qof_query_create_for (GNC_ID_SPLIT);
+    qof_query_set_book (q, book);
+    qof_query_set_sort_order (q,
+                              qof_query_build_param_list (SPLIT_TRANS,
+                                                          TRANS_DATE_POSTED,
+                                                          NULL),
+                              NULL, NULL);
+    qof_query_set_sort_increasing (q, FALSE, TRUE, TRUE);
+
+    for (node = qof_query_run (q); node; node = node->next)
+    {
+        time64 date = xaccTransGetDate (xaccSplitGetParent (GNC_SPLIT(node->data)));
+        if (date > last)
+        {
+            failure ("splits not in decreasing date order");
+            qof_query_destroy (q);
+            return;
+        }
+        last = date;
+    }
+
+    success ("splits sorted by date");
+    qof_query_destroy (q);
+}
+
+static void
+test_cached_query (QofBook *book, Account *acc)
+{
+    Transaction *trans;
+    Split *split;
+    QofQuery *q;
+    GList *list;
+
+    if (!acc)
+        return;
+
+    q = qof_query_create_for (GNC_ID_SPLIT);
+    qof_query_set_book (q, book);
+    xaccQueryAddMemoMatch (q, "cached query", TRUE, FALSE,
+                           QOF_COMPARE_EQUAL, QOF_QUERY_AND);
+    qof_query_set_cache_results (q, TRUE);
+
+    if (qof_query_run (q) != NULL)
+    {
+        failure ("cached query matched before the split was made");
+        qof_query_destroy (q);
+        return;
+    }
+
+    trans = xaccMallocTransaction (book);
+    xaccTransBeginEdit (trans);
+    xaccTransSetCurrency (trans, xaccAccountGetCommodity (acc));
+    xaccTransSetDatePostedSecs (trans, gnc_time (NULL));
+    split = xaccMallocSplit (book);
+    xaccSplitSetParent (split, trans);
+    xaccSplitSetAccount (split, acc);
+    xaccSplitSetMemo (split, "cached query");
+    xaccTransCommitEdit (trans);
+
+    list = qof_query_run (q);
+    if (g_list_length (list) != 1 || list->data != split)
+    {
+        failure ("cached query didn't pick up the new split");
+        qof_query_destroy (q);
+        return;
+    }
+
+    xaccTransBeginEdit (trans);
+    xaccSplitSetMemo (split, "changed");
+    xaccTransCommitEdit (trans);
+
+    if (qof_query_run (q) != NULL)
+    {
+        failure ("cached query kept the changed split");
+        qof_query_destroy (q);
+        return;
+    }
+
+    xaccTransBeginEdit (trans);
+    xaccSplitSetMemo (split, "cached query");
+    xaccTransCommitEdit (trans);
+    xaccTransBeginEdit (trans);
+    xaccTransDestroy (trans);
+    xaccTransCommitEdit (trans);
+
+    if (qof_query_run (q) != NULL)
+    {
+        failure ("cached query kept the destroyed split");
+        qof_query_destroy (q);
+        return;
+    }
+
+    success ("cached query follows the changes");
+    qof_query_destroy (q);
+}
+
+/* A description search answered by the text index finds the same
+ * splits as checking every one of them, and follows the edits. */
+typedef struct
+{
+    const char *match;
+    guint count;
+} DescriptionCount;
+
+static void
+count_description_cb (QofInstance *inst, gpointer data)
+{
+    DescriptionCount *counter = static_cast<DescriptionCount*>(data);
+    const char *desc = xaccTransGetDescription (xaccSplitGetParent (GNC_SPLIT(inst)));
+
+    if (desc && strstr (desc, counter->match))
+        counter->count++;
+}
+
+static guint
+description_query_count (QofBook *book, const char *match)
+{
+    QofQuery *q = qof_query_create_for (GNC_ID_SPLIT);
+    guint n;
+
+    qof_query_set_book (q, book);
+    xaccQueryAddDescriptionMatch (q, match, TRUE, FALSE,
+                                  QOF_COMPARE_CONTAINS, QOF_QUERY_AND);
+    n = g_list_length (qof_query_run (q));
+    qof_query_destroy (q);
+    return n;
+}
+
+static int
+test_description_query (Transaction *trans, gpointer data)
+{
+    QofBook *book = QOF_BOOK(data);
+    const char *desc = xaccTransGetDescription (trans);
+    DescriptionCount counter;
+    gchar *match;
+    guint n;
+
+    if (!desc || strlen (desc) < 5)
+        return 0;
+
+    match = g_strndup (desc + 1, 3);
+    counter.match = match;
+    counter.count = 0;
+    qof_collection_foreach (qof_book_get_collection (book, GNC_ID_SPLIT),
+                            count_description_cb, &counter);
+    n = description_query_count (book, match);
+    g_free (match);
+    if (n != counter.count)
+    {
+        failure_args ("test number returned", __FILE__, __LINE__,
+                      "number of splits with the description %d not %d",
+                      n, counter.count);
+        return 15;
+    }
+
+    success ("found the splits with the description");
+    return 0;
+}
+
+static void
+test_description_edit_query (QofBook *book, Account *acc)
+{
+    Transaction *trans;
+    Split *split;
+
+    if (!acc)
+        return;
+
+    trans = xaccMallocTransaction (book);
+    xaccTransBeginEdit (trans);
+    xaccTransSetCurrency (trans, xaccAccountGetCommodity (acc));
+    xaccTransSetDatePostedSecs (trans, gnc_time (NULL));
+    xaccTransSetDescription (trans, "Indexed description one");
+    split = xaccMallocSplit (book);
+    xaccSplitSetParent (split, trans);
+    xaccSplitSetAccount (split, acc);
+    xaccTransCommitEdit (trans);
+
+    if (description_query_count (book, "description one") != 1)
+    {
+        failure ("the new description wasn't found");
+        return;
+    }
+
+    xaccTransBeginEdit (trans);
+    xaccTransSetDescription (trans, "Indexed description two");
+    xaccTransCommitEdit (trans);
+    if (description_query_count (book, "description one") != 0 ||
+        description_query_count (book, "description two") != 1)
+    {
+        failure ("the changed description wasn't followed");
+        return;
+    }
+
+    xaccTransBeginEdit (trans);
+    xaccTransSetDescription (trans, "Indexed description three");
+    xaccTransRollbackEdit (trans);
+    if (description_query_count (book, "description three") != 0 ||
+        description_query_count (book, "description two") != 1)
+    {
+        failure ("the rolled back description wasn't followed");
+        return;
+    }
+
+    xaccTransBeginEdit (trans);
+    xaccTransDestroy (trans);
+    xaccTransCommitEdit (trans);
+    if (description_query_count (book, "description two") != 0)
+    {
+        failure ("the destroyed transaction was found");
+        return;
+    }
+
+    success ("description index follows the changes");
+}
+
+static gint
+date_query_count (QofBook *book, time64 date)
+{
+    QofQuery *q = qof_query_create_for (GNC_ID_TRANS);
+    gint count;
+
+    qof_query_set_book (q, book);
+    qof_query_add_term (q, qof_query_build_param_list (TRANS_DATE_POSTED, NULL),
+                        qof_query_date_predicate (QOF_COMPARE_GTE,
+                                                  QOF_DATE_MATCH_NORMAL, date),
+                        QOF_QUERY_AND);
+    count = g_list_length (qof_query_run (q));
+    qof_query_destroy (q);
+    return count;
+}
+
+typedef struct
+{
+    QofBook *book;
+    Transaction *trans;
+    time64 date;
+    gint count;
+} DestroyQueryData;
+
+/* Run an indexed query while the transaction is being destroyed, like
+ * a register refreshing on the destroy event. */
+static void
+destroy_query_handler (QofInstance *ent, QofEventId event_type,
+                       gpointer handler_data, gpointer event_data)
+{
+    DestroyQueryData *data = static_cast<DestroyQueryData*>(handler_data);
+
+    if (event_type == QOF_EVENT_DESTROY && ent == QOF_INSTANCE(data->trans))
+        data->count = date_query_count (data->book, data->date);
+}
+
+static void
+test_destroy_date_query (QofBook *book, Account *acc)
+{
+    DestroyQueryData data;
+    Split *split;
+    gint handler, before;
+
+    if (!acc)
+        return;
+
+    data.book = book;
+    data.date = gnc_time (NULL);
+    data.count = -1;
+    before = date_query_count (book, data.date);
+    data.trans = xaccMallocTransaction (book);
+    xaccTransBeginEdit (data.trans);
+    xaccTransSetCurrency (data.trans, xaccAccountGetCommodity (acc));
+    xaccTransSetDatePostedSecs (data.trans, data.date);
+    split = xaccMallocSplit (book);
+    xaccSplitSetParent (split, data.trans);
+    xaccSplitSetAccount (split, acc);
+    xaccTransCommitEdit (data.trans);
+
+    if (date_query_count (book, data.date) != before + 1)
+    {
+        failure ("the new transaction wasn't found by date");
+        return;
+    }
+
+    handler = qof_event_register_handler (destroy_query_handler, &data);
+    xaccTransBeginEdit (data.trans);
+    xaccTransDestroy (data.trans);
+    xaccTransCommitEdit (data.trans);
+    qof_event_unregister_handler (handler);
+
+    if (data.count != before + 1)
+    {
+        failure ("the destroy event handler's query didn't run");
+        return;
+    }
+    if (date_query_count (book, data.date) != before)
+    {
+        failure ("the destroyed transaction was found by date");
+        return;
+    }
+
+    success ("date index forgets destroyed transactions");
+}
+
 static void
 run_test (void)
 {
@@ -81,6 +517,14 @@ run_test (void)
     add_random_transactions_to_book (book, 20);
 
     xaccAccountTreeForEachTransaction (root, test_trans_query, book);
+    xaccAccountTreeForEachTransaction (root, test_parallel_query, book);
+    gnc_account_foreach_descendant (root, test_account_date_query, book);
+    test_cached_query (book, gnc_account_nth_child (root, 0));
+    xaccAccountTreeForEachTransaction (root, test_description_query, book);
+    test_description_edit_query (book, gnc_account_nth_child (root, 0));
+    test_destroy_date_query (book, gnc_account_nth_child (root, 0));
+    test_max_results_query (book);
+    test_sorted_query (book);
 
     qof_session_end (session);
 }
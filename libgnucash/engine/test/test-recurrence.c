@@ -398,6 +398,69 @@ static void test_some()
     test_specific(PERIOD_DAY, 7,    4, 1, 2000,    4, 8, 2000,  4, 15, 2000);
 }
 
+#define NUM_INSTANCES_TO_TEST 40
+
+/* The closed-form nth instance and first instance on or after a date
+   must be the ones stepping with recurrenceNextInstance() finds. */
+static void test_nth_instance()
+{
+    Recurrence r;
+    GDate d_start, d_step, d_ref, d_nth, d_after, d_day;
+    PeriodType pt;
+    WeekendAdjust wadj;
+    guint16 mult;
+    gint32 j;
+    guint n;
+
+    for (pt = PERIOD_ONCE; pt < NUM_PERIOD_TYPES; pt++)
+        for (wadj = WEEKEND_ADJ_NONE; wadj < NUM_WEEKEND_ADJS; wadj++)
+            for (j = JULIAN_START; j < JULIAN_START + 400; j += 3)
+                for (mult = 1; mult < 4; mult++)
+                {
+                    g_date_set_julian(&d_start, j);
+                    recurrenceSet(&r, mult, pt, &d_start, wadj);
+                    d_step = d_start;
+                    for (n = 0; n < NUM_INSTANCES_TO_TEST; n++)
+                    {
+                        if (n > 0)
+                        {
+                            if (!g_date_valid(&d_step))
+                                break;
+                            d_ref = d_step;
+                            recurrenceNextInstance(&r, &d_ref, &d_step);
+                        }
+                        recurrenceNthInstance(&r, n, &d_nth);
+                        if (!g_date_valid(&d_step))
+                        {
+                            if (!do_test(!g_date_valid(&d_nth), "nth instance"))
+                                return;
+                            break;
+                        }
+                        if (!test_equal(&d_nth, &d_step))
+                        {
+                            printf("pt = %d; wadj = %d; mult = %d; n = %u\n",
+                                   pt, wadj, mult, n);
+                            return;
+                        }
+
+                        /* The instance is the first on or after itself
+                           and after the day before it. */
+                        if (!do_test(recurrenceFirstInstanceOnOrAfter(&r, &d_step,
+                                                                      &d_after) == n,
+                                     "first instance on or after"))
+                            return;
+                        test_equal(&d_after, &d_step);
+                        d_day = d_step;
+                        g_date_subtract_days(&d_day, 1);
+                        if (n > 0 && g_date_compare(&d_day, &d_ref) > 0 &&
+                            !do_test(recurrenceFirstInstanceOnOrAfter(&r, &d_day,
+                                                                      NULL) == n,
+                                     "first instance on or after the day before"))
+                            return;
+                    }
+                }
+}
+
 static void test_use()
 {
     Recurrence *r;
@@ -418,6 +481,8 @@ static void test_main()
 
     test_all();
 
+    test_nth_instance();
+
     qof_book_destroy (book);
 }
 
@@ -0,0 +1,242 @@
+/***************************************************************************
+ *            test-split-table.cpp
+ *
+ *  Copyright  2026  Gnucash team
+ ****************************************************************************/
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ *  02110-1301, USA.
+ */
+extern "C"
+{
+#include <config.h>
+#include <glib.h>
+#include "qof.h"
+#include "cashobjects.h"
+#include "Account.h"
+#include "Query.h"
+#include "TransLog.h"
+#include "gnc-engine.h"
+#include "gnc-split-table.h"
+#include "test-engine-stuff.h"
+#include "test-stuff.h"
+}
+
+static gint
+split_month (Split *split)
+{
+    time64 time = xaccTransGetDate (xaccSplitGetParent (split));
+    struct tm tm;
+
+    gnc_localtime_r (&time, &tm);
+    return tm.tm_year * 12 + tm.tm_mon;
+}
+
+static const char *
+split_account_name (Split *split)
+{
+    return gnc_account_get_full_name_const (xaccSplitGetAccount (split));
+}
+
+static gboolean
+sums_match (MonetaryList *sums, GList *splits, gboolean values)
+{
+    MonetaryList *expected = NULL, *node;
+    gboolean match = TRUE;
+
+    for (GList *s = splits; s; s = s->next)
+    {
+        Split *split = static_cast<Split*>(s->data);
+        if (values)
+            expected = gnc_monetary_list_add_value (
+                expected, xaccTransGetCurrency (xaccSplitGetParent (split)),
+                xaccSplitGetValue (split));
+        else
+            expected = gnc_monetary_list_add_value (
+                expected, xaccAccountGetCommodity (xaccSplitGetAccount (split)),
+                xaccSplitGetAmount (split));
+    }
+
+    if (g_list_length (sums) != g_list_length (expected))
+        match = FALSE;
+    for (node = expected; match && node; node = node->next)
+    {
+        gnc_monetary *want = static_cast<gnc_monetary*>(node->data);
+        MonetaryList *got;
+
+        for (got = sums; got; got = got->next)
+        {
+            gnc_monetary *mon = static_cast<gnc_monetary*>(got->data);
+            if (gnc_commodity_equiv (mon->commodity, want->commodity))
+                break;
+        }
+        if (!got || !gnc_numeric_equal (static_cast<gnc_monetary*>(got->data)->value,
+                                        want->value))
+            match = FALSE;
+    }
+    gnc_monetary_list_free (expected);
+    return match;
+}
+
+static void
+run_test (void)
+{
+    GncSplitTableSort primary = { GNC_SPLIT_TABLE_KEY_ACCOUNT_NAME,
+                                  GNC_SPLIT_TABLE_DATE_NONE, TRUE, TRUE };
+    GncSplitTableSort secondary = { GNC_SPLIT_TABLE_KEY_DATE,
+                                    GNC_SPLIT_TABLE_DATE_MONTH, FALSE, TRUE };
+    QofBook *book = get_random_book ();
+    QofQuery *query;
+    GncSplitTable *table;
+    GList *splits, *rows;
+    GHashTable *balances;
+    guint n_rows, row;
+
+    add_random_transactions_to_book (book, 20);
+    query = qof_query_create_for (GNC_ID_SPLIT);
+    qof_query_set_book (query, book);
+
+    table = gnc_split_table_new_from_query (query, FALSE, &primary, &secondary);
+    splits = qof_query_last_run (query);
+    n_rows = gnc_split_table_get_num_rows (table);
+    if (n_rows != g_list_length (splits))
+    {
+        failure("table has the wrong number of rows");
+        exit(get_rv());
+    }
+
+    balances = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, g_free);
+    for (row = 0; row < n_rows; row++)
+    {
+        Split *split = gnc_split_table_get_split (table, row);
+        Split *prev = row ? gnc_split_table_get_split (table, row - 1) : NULL;
+        Account *account = xaccSplitGetAccount (split);
+        gnc_numeric *balance = static_cast<gnc_numeric*>(g_hash_table_lookup (balances, account));
+        gboolean new_account = !prev ||
+            g_strcmp0 (split_account_name (prev), split_account_name (split));
+        gboolean new_month = new_account ||
+            split_month (prev) != split_month (split);
+
+        if (!balance)
+        {
+            balance = g_new (gnc_numeric, 1);
+            *balance = gnc_numeric_zero ();
+            g_hash_table_insert (balances, account, balance);
+        }
+        *balance = gnc_numeric_add (*balance, xaccSplitGetAmount (split),
+                                    GNC_DENOM_AUTO, GNC_HOW_DENOM_EXACT);
+        if (!gnc_numeric_equal (*balance, gnc_split_table_get_balance (table, row)))
+        {
+            failure("running balance is wrong");
+            exit(get_rv());
+        }
+
+        if (prev && !new_account && split_month (prev) < split_month (split))
+        {
+            failure("secondary key not descending");
+            exit(get_rv());
+        }
+        if (prev && new_account &&
+            g_utf8_collate (split_account_name (prev),
+                            split_account_name (split)) > 0)
+        {
+            failure("primary key not ascending");
+            exit(get_rv());
+        }
+        if (gnc_split_table_row_starts_group (table, row,
+                                              GNC_SPLIT_TABLE_PRIMARY) != new_account ||
+            gnc_split_table_row_starts_group (table, row,
+                                              GNC_SPLIT_TABLE_SECONDARY) != new_month)
+        {
+            failure("groups start at the wrong rows");
+            exit(get_rv());
+        }
+        if (prev &&
+            gnc_split_table_row_ends_group (table, row - 1,
+                                            GNC_SPLIT_TABLE_PRIMARY) != new_account)
+        {
+            failure("groups end at the wrong rows");
+            exit(get_rv());
+        }
+    }
+    g_hash_table_destroy (balances);
+
+    if (gnc_split_table_get_num_groups (table, GNC_SPLIT_TABLE_TOTAL) != (n_rows ? 1 : 0))
+    {
+        failure("there isn't one total group");
+        exit(get_rv());
+    }
+
+    rows = gnc_split_table_get_splits (table);
+    for (guint group = 0;
+         group < gnc_split_table_get_num_groups (table, GNC_SPLIT_TABLE_PRIMARY);
+         group++)
+    {
+        guint first = gnc_split_table_get_group_first_row (table, GNC_SPLIT_TABLE_PRIMARY, group);
+        guint last = gnc_split_table_get_group_last_row (table, GNC_SPLIT_TABLE_PRIMARY, group);
+        GList *group_splits = NULL;
+        MonetaryList *amounts, *values;
+
+        for (row = last + 1; row-- > first;)
+            group_splits = g_list_prepend (group_splits, g_list_nth_data (rows, row));
+
+        amounts = gnc_split_table_get_group_amounts (table, GNC_SPLIT_TABLE_PRIMARY, group);
+        values = gnc_split_table_get_group_values (table, GNC_SPLIT_TABLE_PRIMARY, group);
+        if (!sums_match (amounts, group_splits, FALSE) ||
+            !sums_match (values, group_splits, TRUE))
+        {
+            failure("group subtotals are wrong");
+            exit(get_rv());
+        }
+        gnc_monetary_list_free (amounts);
+        gnc_monetary_list_free (values);
+        g_list_free (group_splits);
+    }
+
+    if (n_rows)
+    {
+        MonetaryList *values = gnc_split_table_get_group_values (table, GNC_SPLIT_TABLE_TOTAL, 0);
+        if (!sums_match (values, splits, TRUE))
+        {
+            failure("total is wrong");
+            exit(get_rv());
+        }
+        gnc_monetary_list_free (values);
+    }
+
+    g_list_free (rows);
+    gnc_split_table_destroy (table);
+    qof_query_destroy (query);
+    qof_book_destroy (book);
+}
+
+int
+main (int argc, char **argv)
+{
+    gint i;
+    qof_init();
+    if (cashobjects_register())
+    {
+        xaccLogDisable ();
+        for (i = 0; i < 5; i++)
+        {
+            run_test ();
+        }
+        success ("split tables seem to work");
+        print_test_results();
+    }
+    qof_close();
+    return get_rv();
+}
@@ -43,6 +43,7 @@ void test_suite_account (void);
 
 #include <qofinstance-p.h>
 #include <kvp-frame.hpp>
+#include "../AccountP.hpp"
 
 typedef struct
 {
@@ -889,7 +890,7 @@ test_xaccFreeAccount (Fixture *fixture, gconstpointer pData)
     /* Check that we've got children, lots, and splits to remove */
     g_assert (p_priv->children != NULL);
     g_assert (p_priv->lots != NULL);
-    g_assert (p_priv->splits != NULL);
+    g_assert (!p_priv->splits.empty());
     g_assert (p_priv->parent != NULL);
     g_assert (p_priv->commodity != NULL);
     g_assert_cmpint (check1->hits, ==, 0);
@@ -1004,7 +1005,7 @@ test_xaccAccountCommitEdit (Fixture *fixture, gconstpointer pData)
     /* Check that we've got children, lots, and splits to remove */
     g_assert (p_priv->children != NULL);
     g_assert (p_priv->lots != NULL);
-    g_assert (p_priv->splits != NULL);
+    g_assert (!p_priv->splits.empty());
     g_assert (p_priv->parent != NULL);
     g_assert (p_priv->commodity != NULL);
     g_assert_cmpint (check1->hits, ==, 0);
@@ -1020,7 +1021,7 @@ test_xaccAccountCommitEdit (Fixture *fixture, gconstpointer pData)
     test_signal_assert_hits (sig2, 0);
     g_assert (p_priv->children != NULL);
     g_assert (p_priv->lots != NULL);
-    g_assert (p_priv->splits != NULL);
+    g_assert (!p_priv->splits.empty());
     g_assert (p_priv->parent != NULL);
     g_assert (p_priv->commodity != NULL);
     g_assert_cmpint (check1->hits, ==, 0);
@@ -1104,19 +1105,19 @@ test_gnc_account_insert_remove_split (Fixture *fixture, gconstpointer pData)
 
     /* Check that the call fails with invalid account and split (throws) */
     g_assert (!gnc_account_insert_split (NULL, split1));
-    g_assert_cmpuint (g_list_length (priv->splits), == , 0);
+    g_assert_cmpuint (priv->splits.size(), == , 0);
     g_assert (!priv->sort_dirty);
     g_assert (!priv->balance_dirty);
     test_signal_assert_hits (sig1, 0);
     test_signal_assert_hits (sig2, 0);
     g_assert (!gnc_account_insert_split (fixture->acct, NULL));
-    g_assert_cmpuint (g_list_length (priv->splits), == , 0);
+    g_assert_cmpuint (priv->splits.size(), == , 0);
     g_assert (!priv->sort_dirty);
     g_assert (!priv->balance_dirty);
     test_signal_assert_hits (sig1, 0);
     test_signal_assert_hits (sig2, 0);
     /* g_assert (!gnc_account_insert_split (fixture->acct, (Split*)priv)); */
-    /* g_assert_cmpuint (g_list_length (priv->splits), == , 0); */
+    /* g_assert_cmpuint (priv->splits.size(), == , 0); */
     /* g_assert (!priv->sort_dirty); */
     /* g_assert (!priv->balance_dirty); */
     /* test_signal_assert_hits (sig1, 0); */
@@ -1129,7 +1130,7 @@ test_gnc_account_insert_remove_split (Fixture *fixture, gconstpointer pData)
 
     /* Check that it works the first time */
     g_assert (gnc_account_insert_split (fixture->acct, split1));
-    g_assert_cmpuint (g_list_length (priv->splits), == , 1);
+    g_assert_cmpuint (priv->splits.size(), == , 1);
     g_assert (!priv->sort_dirty);
     g_assert (priv->balance_dirty);
     test_signal_assert_hits (sig1, 1);
@@ -1141,7 +1142,7 @@ test_gnc_account_insert_remove_split (Fixture *fixture, gconstpointer pData)
     sig3 = test_signal_new (&fixture->acct->inst, GNC_EVENT_ITEM_ADDED, split2);
     /* Now add a second split to the account and check that sort_dirty isn't set. We have to bump the editlevel to force this. */
     g_assert (gnc_account_insert_split (fixture->acct, split2));
-    g_assert_cmpuint (g_list_length (priv->splits), == , 2);
+    g_assert_cmpuint (priv->splits.size(), == , 2);
     g_assert (!priv->sort_dirty);
     g_assert (priv->balance_dirty);
     test_signal_assert_hits (sig1, 2);
@@ -1152,7 +1153,7 @@ test_gnc_account_insert_remove_split (Fixture *fixture, gconstpointer pData)
     qof_instance_increase_editlevel (fixture->acct);
     g_assert (gnc_account_insert_split (fixture->acct, split3));
     qof_instance_decrease_editlevel (fixture->acct);
-    g_assert_cmpuint (g_list_length (priv->splits), == , 3);
+    g_assert_cmpuint (priv->splits.size(), == , 3);
     g_assert (priv->sort_dirty);
     g_assert (priv->balance_dirty);
     test_signal_assert_hits (sig1, 3);
@@ -1163,7 +1164,7 @@ test_gnc_account_insert_remove_split (Fixture *fixture, gconstpointer pData)
     sig3 = test_signal_new (&fixture->acct->inst, GNC_EVENT_ITEM_REMOVED,
                             split3);
     g_assert (gnc_account_remove_split (fixture->acct, split3));
-    g_assert_cmpuint (g_list_length (priv->splits), == , 2);
+    g_assert_cmpuint (priv->splits.size(), == , 2);
     g_assert (priv->sort_dirty);
     g_assert (!priv->balance_dirty);
     test_signal_assert_hits (sig1, 4);
@@ -1171,7 +1172,7 @@ test_gnc_account_insert_remove_split (Fixture *fixture, gconstpointer pData)
     /* And do it again to make sure that it fails when the split has
      * already been removed */
     g_assert (!gnc_account_remove_split (fixture->acct, split3));
-    g_assert_cmpuint (g_list_length (priv->splits), == , 2);
+    g_assert_cmpuint (priv->splits.size(), == , 2);
     g_assert (priv->sort_dirty);
     g_assert (!priv->balance_dirty);
     test_signal_assert_hits (sig1, 4);
@@ -1236,6 +1237,7 @@ test_xaccAccountInsertRemoveLot (Fixture *fixture, gconstpointer pData)
     xaccAccountInsertLot (fixture->acct, lot);
     g_assert (gnc_lot_get_account (lot) == fixture->acct);
     g_assert_cmpuint (g_list_length (a_priv->lots), == , 1);
+    g_assert_cmpuint (a_priv->open_lots.size (), == , 1);
     test_signal_assert_hits (sig1, 1);
     test_signal_assert_hits (sig2, 1);
     /* Make sure that inserting again doesn't do anything */
@@ -1249,6 +1251,8 @@ test_xaccAccountInsertRemoveLot (Fixture *fixture, gconstpointer pData)
     g_assert (gnc_lot_get_account (lot) == parent);
     g_assert_cmpuint (g_list_length (a_priv->lots), == , 0);
     g_assert_cmpuint (g_list_length (p_priv->lots), == , 1);
+    g_assert_cmpuint (a_priv->open_lots.size (), == , 0);
+    g_assert_cmpuint (p_priv->open_lots.size (), == , 1);
     test_signal_assert_hits (sig1, 2);
     test_signal_assert_hits (sig4, 1);
     test_signal_assert_hits (sig2, 1);
@@ -1260,6 +1264,7 @@ test_xaccAccountInsertRemoveLot (Fixture *fixture, gconstpointer pData)
     g_assert (gnc_lot_get_account (lot) != NULL);
     g_assert_cmpuint (g_list_length (a_priv->lots), == , 0);
     g_assert_cmpuint (g_list_length (p_priv->lots), == , 0);
+    g_assert_cmpuint (p_priv->open_lots.size (), == , 0);
     test_signal_assert_hits (sig3, 1);
     test_signal_assert_hits (sig4, 2);
     test_signal_assert_hits (sig2, 1);
@@ -1298,6 +1303,187 @@ xaccAccountMoveAllSplits (Account *accfrom, Account *accto)// C: 5 in 3
 * wouldn't know.
 */
 
+static Split*
+move_test_txn (QofBook *book, gnc_commodity *curr, Account *acc1,
+               Account *acc2, time64 date, gint64 num)
+{
+    Transaction *txn = xaccMallocTransaction (book);
+    Split *split1 = xaccMallocSplit (book);
+    Split *split2 = xaccMallocSplit (book);
+    gnc_numeric amt = gnc_numeric_create (num, 100);
+
+    xaccTransBeginEdit (txn);
+    xaccTransSetCurrency (txn, curr);
+    xaccTransSetDatePostedSecsNormalized (txn, date);
+    xaccSplitSetParent (split1, txn);
+    xaccSplitSetParent (split2, txn);
+    xaccSplitSetAccount (split1, acc1);
+    xaccSplitSetAccount (split2, acc2);
+    xaccSplitSetAmount (split1, amt);
+    xaccSplitSetValue (split1, amt);
+    xaccSplitSetAmount (split2, gnc_numeric_neg (amt));
+    xaccSplitSetValue (split2, gnc_numeric_neg (amt));
+    xaccTransCommitEdit (txn);
+    return split1;
+}
+
+static void
+test_xaccAccountSortSplits (void)
+{
+    QofBook *book = qof_book_new ();
+    Account *root = gnc_account_create_root (book);
+    Account *acc = xaccMallocAccount (book);
+    Account *other = xaccMallocAccount (book);
+    gnc_commodity *curr = gnc_commodity_new (book, "US Dollar", "CURRENCY",
+                                             "USD", "0", 100);
+    const char *descs[] = {"\xc3\xa9clair", "Eclair", "apple", "Zebra", "",
+                           "eclair"};
+    const char *nums[] = {"2", "10", "", "1"};
+    time64 now = gnc_time (NULL);
+
+    xaccAccountSetCommodity (acc, curr);
+    xaccAccountSetCommodity (other, curr);
+    gnc_account_append_child (root, acc);
+    gnc_account_append_child (root, other);
+
+    /* Add them unsorted, in one edit, with ties on the date, num and
+     * entered date for the descriptions to decide. */
+    for (int i = 0; i < 24; ++i)
+    {
+        if (i == 1)
+        {
+            /* Have the split list kept alongside the splits. */
+            g_assert (xaccAccountGetSplitList (acc) != NULL);
+            xaccAccountBeginEdit (acc);
+        }
+        Split *split = move_test_txn (book, curr, acc, other,
+                                      now - (i % 2) * 86400, i + 1);
+        Transaction *txn = xaccSplitGetParent (split);
+        xaccTransBeginEdit (txn);
+        xaccTransSetNum (txn, nums[i % 4]);
+        xaccTransSetDescription (txn, descs[i % 6]);
+        xaccTransCommitEdit (txn);
+    }
+    xaccAccountCommitEdit (acc);
+    xaccAccountSortSplits (acc, TRUE);
+
+    GList *splits = xaccAccountGetSplitList (acc);
+    g_assert_cmpint (g_list_length (splits), ==, 24);
+    for (auto node = splits; node->next; node = node->next)
+        g_assert_cmpint (xaccSplitOrder (static_cast<Split*>(node->data),
+                                         static_cast<Split*>(node->next->data)),
+                         <, 0);
+
+    qof_book_destroy (book);
+}
+
+/* A transaction with several splits in the account moving them all */
+static void
+test_gnc_account_split_changed (void)
+{
+    QofBook *book = qof_book_new ();
+    Account *root = gnc_account_create_root (book);
+    Account *acc = xaccMallocAccount (book);
+    Account *other = xaccMallocAccount (book);
+    gnc_commodity *curr = gnc_commodity_new (book, "US Dollar", "CURRENCY",
+                                             "USD", "0", 100);
+    time64 now = gnc_time (NULL);
+    const gint64 day = 86400;
+    gnc_numeric balance = gnc_numeric_zero ();
+
+    xaccAccountSetCommodity (acc, curr);
+    xaccAccountSetCommodity (other, curr);
+    gnc_account_append_child (root, acc);
+    gnc_account_append_child (root, other);
+
+    for (int i = 1; i <= 4; ++i)
+        move_test_txn (book, curr, acc, other, now - i * day, i * 100);
+    Split *split = move_test_txn (book, curr, acc, acc, now - 5 * day, 7);
+    Transaction *txn = xaccSplitGetParent (split);
+    g_assert (xaccAccountGetSplitList (acc)->data == split ||
+              xaccAccountGetSplitList (acc)->next->data == split);
+
+    xaccTransBeginEdit (txn);
+    xaccTransSetDatePostedSecsNormalized (txn, now);
+    xaccTransCommitEdit (txn);
+
+    GList *splits = xaccAccountGetSplitList (acc);
+    g_assert_cmpint (g_list_length (splits), ==, 6);
+    for (auto node = splits; node; node = node->next)
+    {
+        auto s = static_cast<Split*>(node->data);
+        if (node->next)
+            g_assert_cmpint (xaccSplitOrder (s, static_cast<Split*>
+                                             (node->next->data)), <, 0);
+        balance = gnc_numeric_add_fixed (balance, xaccSplitGetAmount (s));
+        g_assert (gnc_numeric_equal (xaccSplitGetBalance (s), balance));
+    }
+    g_assert (xaccSplitGetParent (static_cast<Split*>(g_list_last (splits)->data)) == txn);
+
+    qof_book_destroy (book);
+}
+
+static void
+test_xaccAccountMoveAllSplits (void)
+{
+    QofBook *book = qof_book_new ();
+    Account *root = gnc_account_create_root (book);
+    Account *from = xaccMallocAccount (book);
+    Account *to = xaccMallocAccount (book);
+    Account *other = xaccMallocAccount (book);
+    gnc_commodity *curr = gnc_commodity_new (book, "US Dollar", "CURRENCY",
+                                             "USD", "0", 100);
+    time64 now = gnc_time (NULL);
+    const gint64 day = 86400;
+    Split *from_split, *to_split;
+
+    xaccAccountSetCommodity (from, curr);
+    xaccAccountSetCommodity (to, curr);
+    xaccAccountSetCommodity (other, curr);
+    gnc_account_append_child (root, from);
+    gnc_account_append_child (root, to);
+    gnc_account_append_child (root, other);
+
+    /* Interleave the dates so that the merge has to do some work, and
+     * include a transaction between the two accounts. */
+    to_split = move_test_txn (book, curr, to, other, now - 4 * day, 1000);
+    move_test_txn (book, curr, from, other, now - 3 * day, 200);
+    move_test_txn (book, curr, to, other, now - 2 * day, 30000);
+    from_split = move_test_txn (book, curr, from, other, now - day, 4);
+    move_test_txn (book, curr, from, to, now, 50);
+
+    g_assert_cmpint (xaccAccountCountSplits (from, FALSE), ==, 3);
+    g_assert_cmpint (xaccAccountCountSplits (to, FALSE), ==, 3);
+
+    xaccAccountMoveAllSplits (from, to);
+
+    g_assert_cmpint (xaccAccountCountSplits (from, FALSE), ==, 0);
+    g_assert (xaccAccountGetSplitList (from) == NULL);
+    g_assert (gnc_numeric_zero_p (xaccAccountGetBalance (from)));
+    g_assert_cmpint (xaccAccountCountSplits (to, FALSE), ==, 6);
+    g_assert (xaccSplitGetAccount (from_split) == to);
+    g_assert (xaccAccountGetSplitList (to)->data == to_split);
+    for (auto node = xaccAccountGetSplitList (to); node && node->next;
+         node = node->next)
+        g_assert_cmpint (xaccSplitOrder (static_cast<Split*>(node->data),
+                                         static_cast<Split*>(node->next->data)),
+                         <=, 0);
+    g_assert (gnc_numeric_eq (xaccAccountGetBalance (to),
+                              gnc_numeric_create (31204, 100)));
+    g_assert (gnc_numeric_eq (xaccSplitGetBalance (from_split),
+                              gnc_numeric_create (31204, 100)));
+
+    /* The splits stay tracked by their new account. */
+    xaccTransBeginEdit (xaccSplitGetParent (from_split));
+    xaccSplitSetAccount (from_split, other);
+    xaccTransCommitEdit (xaccSplitGetParent (from_split));
+    g_assert_cmpint (xaccAccountCountSplits (to, FALSE), ==, 5);
+    g_assert (gnc_numeric_eq (xaccAccountGetBalance (to),
+                              gnc_numeric_create (31200, 100)));
+
+    qof_book_destroy (book);
+}
+
 /* xaccAccountRecomputeBalance
 void
 xaccAccountRecomputeBalance (Account * acc)// C: 9 in 5 */
@@ -1329,6 +1515,59 @@ test_xaccAccountRecomputeBalance (Fixture *fixture, gconstpointer pData)
     g_assert (gnc_numeric_eq (priv->cleared_balance, clr_bal));
     g_assert (gnc_numeric_eq (priv->reconciled_balance, rec_bal));
     g_assert (!priv->balance_dirty);
+    g_assert_cmpuint (priv->balance_dirty_from, ==, priv->splits.size ());
+    /* Only the last split is stale: the sums resume from the one before */
+    priv->balance = gnc_numeric_zero ();
+    priv->balance_dirty = TRUE;
+    priv->balance_dirty_from = priv->splits.size () - 1;
+    xaccAccountRecomputeBalance (fixture->acct);
+    g_assert (gnc_numeric_eq (priv->balance, bal));
+    g_assert (gnc_numeric_eq (priv->cleared_balance, clr_bal));
+    g_assert (gnc_numeric_eq (priv->reconciled_balance, rec_bal));
+    g_assert (!priv->balance_dirty);
+}
+
+/* gnc_account_remove_start_balance_split
+void
+gnc_account_remove_start_balance_split (Account *acc, const Split *split)*/
+static void
+test_gnc_account_remove_start_balance_split (Fixture *fixture,
+                                             gconstpointer pData)
+{
+    AccountPrivate *priv = fixture->func->get_private (fixture->acct);
+    gnc_numeric bal = gnc_numeric_zero (), rec_bal = gnc_numeric_zero (),
+                clr_bal = gnc_numeric_zero ();
+
+    g_assert (!gnc_account_get_splits_pending (fixture->acct));
+    for (auto split : priv->splits)
+    {
+        gnc_numeric amount = xaccSplitGetAmount (split);
+        char reconciled = xaccSplitGetReconcile (split);
+        bal = gnc_numeric_add_fixed (bal, amount);
+        if (reconciled != NREC)
+            clr_bal = gnc_numeric_add_fixed (clr_bal, amount);
+        if (reconciled == YREC || reconciled == FREC)
+            rec_bal = gnc_numeric_add_fixed (rec_bal, amount);
+    }
+    /* As a backend would leave them before loading the splits */
+    gnc_account_set_splits_pending (fixture->acct, TRUE);
+    gnc_account_set_start_balance (fixture->acct, bal);
+    gnc_account_set_start_noclosing_balance (fixture->acct, bal);
+    gnc_account_set_start_cleared_balance (fixture->acct, clr_bal);
+    gnc_account_set_start_reconciled_balance (fixture->acct, rec_bal);
+    g_assert (gnc_account_get_splits_pending (fixture->acct));
+
+    for (auto split : priv->splits)
+        gnc_account_remove_start_balance_split (fixture->acct, split);
+    g_assert (gnc_numeric_zero_p (priv->starting_balance));
+    g_assert (gnc_numeric_zero_p (priv->starting_noclosing_balance));
+    g_assert (gnc_numeric_zero_p (priv->starting_cleared_balance));
+    g_assert (gnc_numeric_zero_p (priv->starting_reconciled_balance));
+    g_assert (priv->balance_dirty);
+
+    /* Without a backend there's nothing to load. */
+    g_assert (xaccAccountGetSplitList (fixture->acct) != NULL);
+    gnc_account_set_splits_pending (fixture->acct, FALSE);
 }
 
 /* xaccAccountOrder
@@ -1640,6 +1879,55 @@ test_gnc_account_get_descendants_sorted (Fixture *fixture, gconstpointer pData)
     g_assert_cmpint (g_list_index (list, fixture->acct), == , 10);
     g_list_free (list);
 }
+static void
+check_children_sorted (Account *parent)
+{
+    GList *cached = gnc_account_get_children_sorted (parent);
+    GList *sorted = g_list_sort (gnc_account_get_children (parent),
+                                 (GCompareFunc)xaccAccountOrder);
+    GList *node, *snode;
+
+    g_assert_cmpuint (g_list_length (cached), == , g_list_length (sorted));
+    for (node = cached, snode = sorted; node; node = node->next,
+         snode = snode->next)
+        g_assert (node->data == snode->data);
+    g_list_free (cached);
+    g_list_free (sorted);
+}
+
+static void
+test_gnc_account_children_sorted_edits (Fixture *fixture, gconstpointer pData)
+{
+    Account *parent = gnc_account_get_root (fixture->acct);
+    GList *children = gnc_account_get_children (parent);
+    Account *acct, *sibling, *child;
+    QofBook *book = gnc_account_get_book (parent);
+
+    g_assert_cmpuint (g_list_length (children), >, 2);
+    acct = static_cast<Account*>(children->data);
+    sibling = static_cast<Account*>(children->next->data);
+    g_list_free (children);
+
+    check_children_sorted (parent);
+    xaccAccountSetCode (acct, "");
+    xaccAccountSetCode (sibling, "");
+    check_children_sorted (parent);
+    xaccAccountSetName (acct, "zzzz");
+    check_children_sorted (parent);
+    xaccAccountSetName (acct, "aaaa");
+    check_children_sorted (parent);
+    xaccAccountSetType (sibling, ACCT_TYPE_EQUITY);
+    check_children_sorted (parent);
+
+    child = xaccMallocAccount (book);
+    xaccAccountSetName (child, "mmmm");
+    gnc_account_append_child (parent, child);
+    check_children_sorted (parent);
+    gnc_account_remove_child (parent, child);
+    check_children_sorted (parent);
+    xaccAccountBeginEdit (child);
+    xaccAccountDestroy (child);
+}
 /* gnc_account_lookup_by_name
 Account *
 gnc_account_lookup_by_name (const Account *parent, const char * name)// C: 22 in 12 */
@@ -1668,6 +1956,39 @@ test_gnc_account_lookup_by_name (Fixture *fixture, gconstpointer pData)
     g_free (code);
 
 }
+/* gnc_account_lookup_by_full_name
+Account *
+gnc_account_lookup_by_full_name (const Account *any_acc, const gchar *name)
+The lookups go through a book-wide index by name and by code; check that
+it follows the changes to the tree and still honors the tree order.
+*/
+static void
+test_gnc_account_lookup_index (Fixture *fixture, gconstpointer pData)
+{
+    Account *root = gnc_account_get_root (fixture->acct);
+    Account *taxable = gnc_account_lookup_by_full_name (root, "income:taxable");
+    Account *target = gnc_account_lookup_by_full_name (root, "income:taxable:int");
+    g_assert (taxable != NULL);
+    g_assert (target != NULL);
+    g_assert (target == gnc_account_lookup_by_code (root, "4160"));
+    g_assert (gnc_account_lookup_by_full_name (root, "income:int") == NULL);
+    /* Names and codes used more than once are found in tree order */
+    g_assert (gnc_account_lookup_by_name (root, "int") == target);
+    g_assert (gnc_account_lookup_by_code (taxable, "4140") ==
+              gnc_account_lookup_by_name (taxable, "div"));
+
+    xaccAccountSetName (taxable, "taxed");
+    g_assert (gnc_account_lookup_by_full_name (root, "income:taxable:int") == NULL);
+    g_assert (gnc_account_lookup_by_full_name (root, "income:taxed:int") == target);
+    xaccAccountSetCode (target, "4165");
+    g_assert (gnc_account_lookup_by_code (root, "4160") == NULL);
+    g_assert (gnc_account_lookup_by_code (root, "4165") == target);
+
+    gnc_account_append_child (root, target);
+    g_assert (gnc_account_lookup_by_full_name (root, "int") == target);
+    g_assert (gnc_account_lookup_by_full_name (root, "income:taxed:int") == NULL);
+    g_assert (gnc_account_lookup_by_code (taxable, "4165") == NULL);
+}
 /* gnc_account_lookup_by_code
 Account *
 gnc_account_lookup_by_code (const Account *parent, const char * code)// C: 5 in 3 */
@@ -1870,6 +2191,22 @@ test_gnc_account_get_full_name (Fixture *fixture, gconstpointer pData)
     g_assert_cmpstr (result, == , "foo:baz:waldo");
     g_free (result);
 
+    /* The cached name follows renames, moves and the separator */
+    auto parent = gnc_account_get_parent (fixture->acct);
+    auto root = gnc_account_get_root (fixture->acct);
+    g_assert_cmpstr (gnc_account_get_full_name_const (fixture->acct), == ,
+                     "foo:baz:waldo");
+    xaccAccountSetName (gnc_account_get_parent (parent), "bar");
+    g_assert_cmpstr (gnc_account_get_full_name_const (fixture->acct), == ,
+                     "bar:baz:waldo");
+    gnc_set_account_separator ("-");
+    g_assert_cmpstr (gnc_account_get_full_name_const (fixture->acct), == ,
+                     "bar-baz-waldo");
+    gnc_set_account_separator (":");
+    gnc_account_append_child (root, parent);
+    g_assert_cmpstr (gnc_account_get_full_name_const (fixture->acct), == ,
+                     "baz:waldo");
+    g_assert_cmpstr (gnc_account_get_full_name_const (NULL), == , "");
 }
 
 /* DxaccAccountGetCurrency
@@ -1933,6 +2270,110 @@ test_xaccAccountGetBalanceAsOfDate (Fixture *fixture, gconstpointer pData)
                                          (gnc_time (NULL) - offset));
     dval = gnc_numeric_to_double (val);
     g_assert_cmpfloat (dval, == , dbal);
+    /* Before the first split and after the last one */
+    val = xaccAccountGetBalanceAsOfDate (fixture->acct, 0);
+    g_assert (gnc_numeric_zero_p (val));
+    val = xaccAccountGetBalanceAsOfDate (fixture->acct, G_MAXINT64);
+    g_assert (gnc_numeric_equal (val, xaccAccountGetBalance (fixture->acct)));
+    /* A starting balance stands in for splits the backend didn't load. */
+    gnc_account_set_start_balance (fixture->acct, gnc_numeric_create (10000, 100));
+    xaccAccountRecomputeBalance (fixture->acct);
+    val = xaccAccountGetBalanceAsOfDate (fixture->acct, 0);
+    g_assert (gnc_numeric_equal (val, gnc_numeric_create (10000, 100)));
+    val = xaccAccountGetBalanceAsOfDate (fixture->acct, G_MAXINT64);
+    g_assert (gnc_numeric_equal (val, xaccAccountGetBalance (fixture->acct)));
+}
+/* xaccAccountGetBalanceChangesForPeriods
+std::vector<gnc_numeric>
+xaccAccountGetBalanceChangesForPeriods (Account *account,
+                                        const std::vector<time64>& boundaries,
+                                        gboolean recurse)
+*/
+static void
+test_xaccAccountGetBalanceChangesForPeriods (Fixture *fixture, gconstpointer pData)
+{
+    auto book = gnc_account_get_book (fixture->acct);
+    auto parent = gnc_account_get_parent (fixture->acct);
+    auto curr = gnc_commodity_new (book, "US Dollar", "CURRENCY", "USD", "0", 100);
+    auto now = gnc_time (NULL);
+    const time64 day = 24 * 3600;
+    std::vector<time64> boundaries { now - 30 * day, now - 8 * day,
+                                     now - 3 * day, now, now + 4 * day,
+                                     now + 30 * day };
+
+    xaccAccountSetCommodity (fixture->acct, curr);
+    xaccAccountSetCommodity (parent, curr);
+    auto changes = xaccAccountGetBalanceChangesForPeriods (fixture->acct,
+                                                           boundaries, FALSE);
+    g_assert_cmpuint (changes.size (), ==, boundaries.size () - 1);
+    for (size_t i = 0; i < changes.size (); ++i)
+        g_assert (gnc_numeric_equal (changes[i],
+                      xaccAccountGetBalanceChangeForPeriod (fixture->acct,
+                                                            boundaries[i],
+                                                            boundaries[i + 1],
+                                                            FALSE)));
+    g_assert (!gnc_numeric_zero_p (changes[1]));
+
+    changes = xaccAccountGetBalanceChangesForPeriods (parent, boundaries, TRUE);
+    g_assert_cmpuint (changes.size (), ==, boundaries.size () - 1);
+    for (size_t i = 0; i < changes.size (); ++i)
+        g_assert (gnc_numeric_equal (changes[i],
+                      xaccAccountGetBalanceChangeForPeriod (parent,
+                                                            boundaries[i],
+                                                            boundaries[i + 1],
+                                                            TRUE)));
+
+    g_assert (xaccAccountGetBalanceChangesForPeriods (parent, {now}, TRUE).empty ());
+}
+/* xaccAccountsGetBalancesAsOfDates
+void
+xaccAccountsGetBalancesAsOfDates (AccountList *accounts,
+                                  const time64 *dates, guint n_dates,
+                                  gboolean include_children,
+                                  const GNCPriceTable *rates,
+                                  gnc_numeric *balances)
+*/
+static void
+test_xaccAccountsGetBalancesAsOfDates (Fixture *fixture, gconstpointer pData)
+{
+    auto book = gnc_account_get_book (fixture->acct);
+    auto parent = gnc_account_get_parent (fixture->acct);
+    auto curr = gnc_commodity_new (book, "US Dollar", "CURRENCY", "USD", "0", 100);
+    auto now = gnc_time (NULL);
+    const time64 day = 24 * 3600;
+    const time64 dates[] = { 0, now - 8 * day, now - 3 * day, now,
+                             now + 30 * day, G_MAXINT64 };
+    const guint n_dates = G_N_ELEMENTS (dates);
+    GList *accounts = g_list_prepend (g_list_prepend (NULL, parent),
+                                      fixture->acct);
+    gnc_numeric balances[2 * n_dates];
+
+    xaccAccountSetCommodity (fixture->acct, curr);
+    xaccAccountSetCommodity (parent, curr);
+    xaccAccountsGetBalancesAsOfDates (accounts, dates, n_dates, FALSE, NULL,
+                                      balances);
+    for (guint i = 0; i < n_dates; ++i)
+    {
+        g_assert (gnc_numeric_equal (balances[i],
+                      xaccAccountGetBalanceAsOfDate (fixture->acct, dates[i])));
+        g_assert (gnc_numeric_equal (balances[n_dates + i],
+                      xaccAccountGetBalanceAsOfDate (parent, dates[i])));
+    }
+    g_assert (gnc_numeric_zero_p (balances[0]));
+
+    xaccAccountsGetBalancesAsOfDates (accounts, dates, n_dates, TRUE, NULL,
+                                      balances);
+    for (guint i = 0; i < n_dates; ++i)
+    {
+        g_assert (gnc_numeric_equal (balances[i],
+                      xaccAccountGetBalanceAsOfDateInCurrency (fixture->acct,
+                                                               dates[i], NULL,
+                                                               TRUE)));
+        g_assert (gnc_numeric_equal (balances[n_dates + i],
+                      xaccAccountGetBalanceAsOfDateInCurrency (parent, dates[i],
+                                                               NULL, TRUE)));
+    }
+    g_list_free (accounts);
 }
 /* xaccAccountGetPresentBalance
 gnc_numeric
@@ -1974,7 +2415,6 @@ test_xaccAccountGetPresentBalance (Fixture *fixture, gconstpointer pData)
  * xaccAccountGetXxxBalanceInCurrency
  * xaccAccountGetXxxBalanceAsOfDateInCurrency
  * xaccAccountBalanceHelper
- * xaccAccountBalanceAsOfDateHelper
  * xaccAccountGetXxxBalanceInCurrencyRecursive
  * xaccAccountGetXxxBalanceAsOfDateInCurrencyRecursive
  * xaccAccountGetBalanceInCurrency
@@ -1984,7 +2424,82 @@ test_xaccAccountGetPresentBalance (Fixture *fixture, gconstpointer pData)
  * xaccAccountGetProjectedMinimumBalanceInCurrency
  * xaccAccountGetBalanceAsOfDateInCurrency
  * xaccAccountGetBalanceChangeForPeriod
+ *
+ * The subtree balances are cached, though, so check that the cache
+ * follows changes to the splits and to the tree.
  */
+static void
+test_xaccAccountGetBalanceInCurrency_cache ()
+{
+    QofBook *book = qof_book_new ();
+    Account *root = gnc_account_create_root (book);
+    Account *parent = xaccMallocAccount (book);
+    Account *child = xaccMallocAccount (book);
+    Account *other = xaccMallocAccount (book);
+    gnc_commodity *curr = gnc_commodity_new (book, "US Dollar", "CURRENCY",
+                                             "USD", "0", 100);
+    Transaction *txn = xaccMallocTransaction (book);
+    Split *split1 = xaccMallocSplit (book);
+    Split *split2 = xaccMallocSplit (book);
+    gnc_numeric amt = gnc_numeric_create (12345, 100);
+    gnc_numeric amt2 = gnc_numeric_create (-3000, 100);
+    time64 later = gnc_time (NULL) + 86400;
+
+    xaccAccountSetCommodity (root, curr);
+    xaccAccountSetCommodity (parent, curr);
+    xaccAccountSetCommodity (child, curr);
+    xaccAccountSetCommodity (other, curr);
+    gnc_account_append_child (root, parent);
+    gnc_account_append_child (parent, child);
+    gnc_account_append_child (root, other);
+
+    xaccTransBeginEdit (txn);
+    xaccTransSetCurrency (txn, curr);
+    xaccTransSetDatePostedSecsNormalized (txn, gnc_time (NULL));
+    xaccSplitSetParent (split1, txn);
+    xaccSplitSetParent (split2, txn);
+    xaccSplitSetAccount (split1, child);
+    xaccSplitSetAccount (split2, other);
+    xaccSplitSetAmount (split1, amt);
+    xaccSplitSetValue (split1, amt);
+    xaccSplitSetAmount (split2, gnc_numeric_neg (amt));
+    xaccSplitSetValue (split2, gnc_numeric_neg (amt));
+    xaccTransCommitEdit (txn);
+
+    g_assert (gnc_numeric_zero_p (
+                  xaccAccountGetBalanceInCurrency (parent, curr, FALSE)));
+    g_assert (gnc_numeric_eq (
+                  xaccAccountGetBalanceInCurrency (parent, curr, TRUE), amt));
+    g_assert (gnc_numeric_eq (
+                  xaccAccountGetBalanceAsOfDateInCurrency (parent, later,
+                                                           curr, TRUE), amt));
+    g_assert (gnc_numeric_zero_p (
+                  xaccAccountGetBalanceInCurrency (root, curr, TRUE)));
+
+    /* Editing a split updates the totals of the ancestors */
+    xaccTransBeginEdit (txn);
+    xaccSplitSetAmount (split1, amt2);
+    xaccSplitSetValue (split1, amt2);
+    xaccSplitSetAmount (split2, gnc_numeric_neg (amt2));
+    xaccSplitSetValue (split2, gnc_numeric_neg (amt2));
+    xaccTransCommitEdit (txn);
+    g_assert (gnc_numeric_eq (
+                  xaccAccountGetBalanceInCurrency (parent, curr, TRUE), amt2));
+    g_assert (gnc_numeric_eq (
+                  xaccAccountGetBalanceAsOfDateInCurrency (parent, later,
+                                                           curr, TRUE), amt2));
+
+    /* So does moving an account */
+    gnc_account_append_child (other, child);
+    g_assert (gnc_numeric_zero_p (
+                  xaccAccountGetBalanceInCurrency (parent, curr, TRUE)));
+    g_assert (gnc_numeric_zero_p (
+                  xaccAccountGetBalanceInCurrency (other, curr, TRUE)));
+    g_assert (gnc_numeric_eq (
+                  xaccAccountGetBalanceInCurrency (child, curr, TRUE), amt2));
+
+    qof_book_destroy (book);
+}
 /*
  * Yet more getters & setters:
  * xaccAccountGetSplitList
@@ -2022,9 +2537,13 @@ test_xaccAccountFindOpenLots (Fixture *fixture, gconstpointer pData)
     LotList* lots;
 
     g_assert (acct);
+    auto priv = fixture->func->get_private (acct);
+    g_assert_cmpuint (g_list_length (priv->lots), == , 3);
     lots = xaccAccountFindOpenLots (acct, NULL, NULL, NULL);
     g_assert (g_list_length (lots) == 2);
     if (lots) g_list_free (lots);
+    /* The closed lot has been dropped from the open-lot index. */
+    g_assert_cmpuint (priv->open_lots.size (), == , 2);
     lots = xaccAccountFindOpenLots (acct, bogus_lot_match_func_true,
                                     NULL, NULL);
     g_assert (g_list_length (lots) == 2);
@@ -2040,6 +2559,55 @@ test_xaccAccountFindOpenLots (Fixture *fixture, gconstpointer pData)
     count_sorts = 0;
 }
 
+static gnc_numeric
+sum_lot_amounts (GNCLot *lot)
+{
+    gnc_numeric sum = gnc_numeric_zero ();
+    for (auto node = gnc_lot_get_split_list (lot); node; node = node->next)
+        sum = gnc_numeric_add_fixed (sum, xaccSplitGetAmount (static_cast<Split*>(node->data)));
+    return sum;
+}
+
+static void
+test_gnc_lot_get_balance_cached (Fixture *fixture, gconstpointer pData)
+{
+    Account *root = gnc_account_get_root (fixture->acct);
+    Account *acct = gnc_account_lookup_by_name (root, "baz");
+    GNCLot *lot = NULL;
+
+    g_assert (acct);
+    for (auto node = xaccAccountGetLotList (acct); node; node = node->next)
+    {
+        auto l = static_cast<GNCLot*>(node->data);
+        g_assert (gnc_numeric_equal (gnc_lot_get_balance (l),
+                                     sum_lot_amounts (l)));
+        if (g_list_length (gnc_lot_get_split_list (l)) > 1)
+            lot = l;
+    }
+    g_assert (lot);
+
+    auto split = static_cast<Split*>(gnc_lot_get_split_list (lot)->data);
+    auto amount = xaccSplitGetAmount (split);
+    auto before = gnc_lot_get_balance (lot);
+    gnc_lot_remove_split (lot, split);
+    g_assert (gnc_numeric_equal (gnc_lot_get_balance (lot),
+                                 gnc_numeric_sub_fixed (before, amount)));
+    g_assert (gnc_numeric_equal (gnc_lot_get_balance (lot),
+                                 sum_lot_amounts (lot)));
+    gnc_lot_add_split (lot, split);
+    g_assert (gnc_numeric_equal (gnc_lot_get_balance (lot), before));
+
+    auto trans = xaccSplitGetParent (split);
+    xaccTransBeginEdit (trans);
+    xaccSplitSetAmount (split, gnc_numeric_add_fixed (amount, amount));
+    g_assert (gnc_numeric_equal (gnc_lot_get_balance (lot),
+                                 gnc_numeric_add_fixed (before, amount)));
+    xaccSplitSetAmount (split, amount);
+    g_assert (gnc_numeric_equal (gnc_lot_get_balance (lot), before));
+    xaccTransRollbackEdit (trans);
+    g_assert (gnc_numeric_equal (gnc_lot_get_balance (lot), before));
+}
+
 static gpointer
 bogus_for_each_lot_func (GNCLot *lot, gpointer data)
 {
@@ -2561,7 +3129,11 @@ test_suite_account (void)
 // GNC_TEST_ADD (suitename, "xaccAccountEqual", Fixture, NULL, setup, test_xaccAccountEqual,  teardown );
     GNC_TEST_ADD (suitename, "gnc account insert & remove split", Fixture, NULL, setup, test_gnc_account_insert_remove_split,  teardown );
     GNC_TEST_ADD (suitename, "xaccAccount Insert and Remove Lot", Fixture, &good_data, setup, test_xaccAccountInsertRemoveLot,  teardown );
+    GNC_TEST_ADD_FUNC (suitename, "xaccAccountSortSplits", test_xaccAccountSortSplits);
+    GNC_TEST_ADD_FUNC (suitename, "gnc_account_split_changed", test_gnc_account_split_changed);
+    GNC_TEST_ADD_FUNC (suitename, "xaccAccountMoveAllSplits", test_xaccAccountMoveAllSplits);
     GNC_TEST_ADD (suitename, "xaccAccountRecomputeBalance", Fixture, &some_data, setup, test_xaccAccountRecomputeBalance,  teardown );
+    GNC_TEST_ADD (suitename, "gnc_account_remove_start_balance_split", Fixture, &some_data, setup, test_gnc_account_remove_start_balance_split,  teardown );
     GNC_TEST_ADD_FUNC (suitename, "xaccAccountOrder", test_xaccAccountOrder );
     GNC_TEST_ADD (suitename, "qofAccountSetParent", Fixture, &some_data, setup, test_qofAccountSetParent,  teardown );
     GNC_TEST_ADD (suitename, "gnc account append/remove child", Fixture, NULL, setup, test_gnc_account_append_remove_child,  teardown );
@@ -2570,8 +3142,10 @@ test_suite_account (void)
     GNC_TEST_ADD (suitename, "gnc account get tree depth", Fixture, &complex, setup, test_gnc_account_get_tree_depth,  teardown );
     GNC_TEST_ADD (suitename, "gnc account get descendants", Fixture, &complex, setup, test_gnc_account_get_descendants,  teardown );
     GNC_TEST_ADD (suitename, "gnc account get descendants sorted", Fixture, &complex, setup, test_gnc_account_get_descendants_sorted,  teardown );
+    GNC_TEST_ADD (suitename, "gnc account children sorted edits", Fixture, &complex, setup, test_gnc_account_children_sorted_edits,  teardown );
     GNC_TEST_ADD (suitename, "gnc account lookup by name", Fixture, &complex, setup, test_gnc_account_lookup_by_name,  teardown );
     GNC_TEST_ADD (suitename, "gnc account lookup by code", Fixture, &complex, setup, test_gnc_account_lookup_by_code,  teardown );
+    GNC_TEST_ADD (suitename, "gnc account lookup index", Fixture, &complex, setup, test_gnc_account_lookup_index,  teardown );
     GNC_TEST_ADD (suitename, "gnc account lookup by full name helper", Fixture, &complex, setup, test_gnc_account_lookup_by_full_name_helper,  teardown );
     GNC_TEST_ADD (suitename, "gnc account lookup by full name", Fixture, &complex, setup, test_gnc_account_lookup_by_full_name,  teardown );
     GNC_TEST_ADD (suitename, "gnc account foreach child", Fixture, &complex, setup, test_gnc_account_foreach_child,  teardown );
@@ -2580,8 +3154,12 @@ test_suite_account (void)
     GNC_TEST_ADD (suitename, "gnc account get full name", Fixture, &good_data, setup, test_gnc_account_get_full_name,  teardown );
     GNC_TEST_ADD (suitename, "xaccAccountGetProjectedMinimumBalance", Fixture, &some_data, setup, test_xaccAccountGetProjectedMinimumBalance,  teardown );
     GNC_TEST_ADD (suitename, "xaccAccountGetBalanceAsOfDate", Fixture, &some_data, setup, test_xaccAccountGetBalanceAsOfDate,  teardown );
+    GNC_TEST_ADD (suitename, "xaccAccountGetBalanceChangesForPeriods", Fixture, &some_data, setup, test_xaccAccountGetBalanceChangesForPeriods,  teardown );
+    GNC_TEST_ADD (suitename, "xaccAccountsGetBalancesAsOfDates", Fixture, &some_data, setup, test_xaccAccountsGetBalancesAsOfDates,  teardown );
     GNC_TEST_ADD (suitename, "xaccAccountGetPresentBalance", Fixture, &some_data, setup, test_xaccAccountGetPresentBalance,  teardown );
+    GNC_TEST_ADD_FUNC (suitename, "xaccAccountGetBalanceInCurrency cache", test_xaccAccountGetBalanceInCurrency_cache);
     GNC_TEST_ADD (suitename, "xaccAccountFindOpenLots", Fixture, &complex_data, setup, test_xaccAccountFindOpenLots,  teardown );
+    GNC_TEST_ADD (suitename, "gnc_lot_get_balance cached", Fixture, &complex_data, setup, test_gnc_lot_get_balance_cached,  teardown );
     GNC_TEST_ADD (suitename, "xaccAccountForEachLot", Fixture, &complex_data, setup, test_xaccAccountForEachLot,  teardown );
 
     GNC_TEST_ADD (suitename, "xaccAccountHasAncestor", Fixture, &complex, setup, test_xaccAccountHasAncestor,  teardown );
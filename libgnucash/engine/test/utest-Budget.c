@@ -24,6 +24,7 @@
 #include <glib.h>
 #include <unittest-support.h>
 #include <gnc-event.h>
+#include <qofinstance-p.h>
 /* Add specific headers for this class */
 #include "gnc-budget.h"
 
@@ -156,6 +157,52 @@ test_gnc_set_budget_account_period_value()
     qof_book_destroy(book);
 }
 
+static void
+test_gnc_budget_account_period_value_cache()
+{
+    QofBook *book = qof_book_new();
+    GncBudget* budget = gnc_budget_new(book);
+    Account *acc = gnc_account_create_root(book);
+    gnc_numeric val = gnc_numeric_create(250, 1);
+    gchar guid_str[GUID_ENCODING_LENGTH + 1];
+    GValue v = G_VALUE_INIT;
+
+    /* Amounts written straight to the KVP, as a backend loading the
+     * budget does, are seen on the first lookup. */
+    guid_to_string_buff(xaccAccountGetGUID(acc), guid_str);
+    g_value_init(&v, GNC_TYPE_NUMERIC);
+    g_value_set_boxed(&v, &val);
+    qof_begin_edit(QOF_INSTANCE(budget));
+    qof_instance_set_kvp(QOF_INSTANCE(budget), &v, 2, guid_str, "3");
+    qof_commit_edit(QOF_INSTANCE(budget));
+    g_value_unset(&v);
+
+    g_assert(gnc_budget_is_account_period_value_set(budget, acc, 3));
+    g_assert(gnc_numeric_equal(gnc_budget_get_account_period_value(budget, acc, 3), val));
+    g_assert(!gnc_budget_is_account_period_value_set(budget, acc, 4));
+
+    /* Once they have been looked up, setting and unsetting keeps them
+     * in step with the KVP. */
+    gnc_budget_set_account_period_value(budget, acc, 4, gnc_numeric_create(-7, 2));
+    g_assert(gnc_budget_is_account_period_value_set(budget, acc, 4));
+    g_assert(gnc_numeric_equal(gnc_budget_get_account_period_value(budget, acc, 4),
+                               gnc_numeric_create(-7, 2)));
+    gnc_budget_unset_account_period_value(budget, acc, 3);
+    g_assert(!gnc_budget_is_account_period_value_set(budget, acc, 3));
+    g_assert(gnc_numeric_zero_p(gnc_budget_get_account_period_value(budget, acc, 3)));
+    gnc_budget_set_account_period_value(budget, acc, 4, gnc_numeric_error(GNC_ERROR_ARG));
+    g_assert(!gnc_budget_is_account_period_value_set(budget, acc, 4));
+
+    /* More periods make room for more amounts. */
+    gnc_budget_set_num_periods(budget, 24);
+    gnc_budget_set_account_period_value(budget, acc, 20, val);
+    g_assert(gnc_budget_is_account_period_value_set(budget, acc, 20));
+    g_assert(gnc_numeric_equal(gnc_budget_get_account_period_value(budget, acc, 20), val));
+
+    gnc_budget_destroy(budget);
+    qof_book_destroy(book);
+}
+
 void
 test_suite_budget(void)
 {
@@ -165,5 +212,6 @@ test_suite_budget(void)
     GNC_TEST_ADD_FUNC(suitename, "gnc_budget_set_num_periods()", test_gnc_set_budget_num_periods);
     GNC_TEST_ADD_FUNC(suitename, "gnc_budget_set_recurrence()", test_gnc_set_budget_recurrence);
     GNC_TEST_ADD_FUNC(suitename, "gnc_budget_set_account_period_value()", test_gnc_set_budget_account_period_value);
+    GNC_TEST_ADD_FUNC(suitename, "gnc_budget account period value cache", test_gnc_budget_account_period_value_cache);
 
 }
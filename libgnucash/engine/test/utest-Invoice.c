@@ -25,6 +25,7 @@
 #include <qof.h>
 #include <unittest-support.h>
 #include "../gncInvoice.h"
+#include "../gncTaxTableP.h"
 
 static const gchar *suitename = "/engine/gncInvoice";
 void test_suite_gncInvoice ( void );
@@ -208,10 +209,201 @@ test_invoice_posted_trans ( Fixture *fixture, gconstpointer pData )
     }
 }
 
+static gboolean
+owner_has_only_lot (Fixture *fixture, GNCLot *lot)
+{
+    GList *lots = gncOwnerFindOpenLots (&fixture->owner, fixture->account2,
+                                        gncOwnerLotMatchOwnerFunc,
+                                        &fixture->owner, NULL);
+    gboolean ok = lot ? (lots && !lots->next && lots->data == lot) : !lots;
+
+    g_list_free (lots);
+    return ok;
+}
+
+/* Make account2 the owner's A/R or A/P account */
+static void
+setup_owner_account (Fixture *fixture, const InvoiceData *data)
+{
+    xaccAccountSetType(fixture->account2, data->is_cust_doc ?
+                       ACCT_TYPE_RECEIVABLE : ACCT_TYPE_PAYABLE);
+    gnc_account_append_child(gnc_book_get_root_account(fixture->book),
+                             fixture->account2);
+    if (data->is_cust_doc)
+        gncCustomerSetCurrency(fixture->customer, fixture->commodity);
+    else
+        gncVendorSetCurrency(fixture->vendor, fixture->commodity);
+}
+
+/* Give the invoice the owner and an entry for it, dated ts */
+static void
+add_owner_entry (Fixture *fixture, const InvoiceData *data, time64 ts)
+{
+    GncEntry *entry = gncEntryCreate(fixture->book);
+
+    gncInvoiceSetCurrency(fixture->invoice, fixture->commodity);
+    gncInvoiceSetOwner(fixture->invoice, &fixture->owner);
+    gncEntrySetDate (entry, ts);
+    gncEntrySetDateEntered (entry, ts);
+    gncEntrySetDocQuantity (entry, data->quantity, data->is_cn);
+    if (data->is_cust_doc)
+    {
+        gncEntrySetInvAccount(entry, fixture->account);
+        gncEntrySetInvPrice(entry, data->price);
+        gncInvoiceAddEntry (fixture->invoice, entry);
+    }
+    else
+    {
+        gncEntrySetBillAccount(entry, fixture->account);
+        gncEntrySetBillPrice(entry, data->price);
+        gncBillAddEntry(fixture->invoice, entry);
+    }
+}
+
+static void
+test_owner_balance ( Fixture *fixture, gconstpointer pData )
+{
+    const InvoiceData *data = (InvoiceData*) pData;
+    time64 ts = gnc_time(NULL);
+    gnc_numeric lot_balance;
+
+    setup_owner_account (fixture, data);
+    g_assert (gnc_numeric_zero_p (gncOwnerGetBalanceInCurrency (&fixture->owner, NULL)));
+    g_assert (owner_has_only_lot (fixture, NULL));
+    add_owner_entry (fixture, data, ts);
+
+    /* The cached zero balance must not survive a post nobody heard of */
+    qof_event_suspend();
+    gncInvoicePostToAccount(fixture->invoice, fixture->account2, ts, ts, "memo", TRUE, FALSE);
+    qof_event_resume();
+    lot_balance = gnc_lot_get_balance (gncInvoiceGetPostedLot (fixture->invoice));
+    g_assert (!gnc_numeric_zero_p (lot_balance));
+    g_assert (gnc_numeric_equal (gncOwnerGetBalanceInCurrency (&fixture->owner, NULL),
+                                 lot_balance));
+    g_assert (owner_has_only_lot (fixture, gncInvoiceGetPostedLot (fixture->invoice)));
+
+    gncInvoiceUnpost(fixture->invoice, TRUE);
+    g_assert (gnc_numeric_zero_p (gncOwnerGetBalanceInCurrency (&fixture->owner, NULL)));
+
+    gncInvoicePostToAccount(fixture->invoice, fixture->account2, ts, ts, "memo", TRUE, FALSE);
+    g_assert (gnc_numeric_equal (gncOwnerGetBalanceInCurrency (&fixture->owner, NULL),
+                                 lot_balance));
+    g_assert (owner_has_only_lot (fixture, gncInvoiceGetPostedLot (fixture->invoice)));
+}
+
+static void
+test_owner_aging ( Fixture *fixture, gconstpointer pData )
+{
+    const InvoiceData *data = (InvoiceData*) pData;
+    time64 now = gnc_time(NULL);
+    time64 posted = now - 50 * 86400, due = now - 40 * 86400;
+    time64 bounds[] = { now - 60 * 86400, now - 30 * 86400, now };
+    GncOwnerAging *aging;
+    gnc_numeric lot_balance;
+    GList *agings;
+    guint i;
+
+    setup_owner_account (fixture, data);
+    add_owner_entry (fixture, data, posted);
+    gncInvoicePostToAccount(fixture->invoice, fixture->account2, posted, due, "memo", TRUE, FALSE);
+    lot_balance = gnc_lot_get_balance (gncInvoiceGetPostedLot (fixture->invoice));
+
+    agings = gncOwnerGetAging (fixture->account2, now, bounds, 3, TRUE);
+    g_assert (agings && !agings->next);
+    aging = agings->data;
+    g_assert (gncOwnerEqual (&aging->owner, &fixture->owner));
+    g_assert_cmpuint (aging->n_buckets, ==, 5);
+    /* Due between 60 and 30 days ago */
+    for (i = 0; i < aging->n_buckets; i++)
+        g_assert (gnc_numeric_equal (aging->buckets[i], i == 1 ? lot_balance :
+                                     gnc_numeric_zero ()));
+    g_assert (gnc_numeric_equal (aging->total, lot_balance));
+    gncOwnerAgingFree (agings);
+
+    /* The same by the posted date, but as of before the due date */
+    agings = gncOwnerGetAging (fixture->account2, due - 86400, bounds, 3, FALSE);
+    g_assert (agings && !agings->next);
+    aging = agings->data;
+    g_assert (gnc_numeric_equal (aging->buckets[1], lot_balance));
+    gncOwnerAgingFree (agings);
+
+    /* Nothing was posted by the day before */
+    agings = gncOwnerGetAging (fixture->account2, posted - 86400, bounds, 3, TRUE);
+    g_assert (!agings);
+
+    /* A payment that isn't applied to the invoice is a prepayment */
+    gncOwnerApplyPaymentSecs (&fixture->owner, NULL, NULL, fixture->account2,
+                              fixture->account, gnc_numeric_create (1, 1),
+                              gnc_numeric_create (1, 1), now, "memo", "num",
+                              FALSE);
+    agings = gncOwnerGetAging (fixture->account2, now, bounds, 3, TRUE);
+    g_assert (agings && !agings->next);
+    aging = agings->data;
+    g_assert (!gnc_numeric_zero_p (aging->buckets[4]));
+    g_assert (gnc_numeric_equal (aging->total,
+                                 gnc_numeric_add_fixed (lot_balance,
+                                                        aging->buckets[4])));
+    gncOwnerAgingFree (agings);
+}
+
+static void
+test_invoice_totals ( Fixture *fixture, gconstpointer pData )
+{
+    GncEntry *entry = gncEntryCreate(fixture->book);
+    GncTaxTable *taxtable;
+    GncTaxTableEntry *tt_entry;
+
+    gncTaxTableRegister();
+    taxtable = gncTaxTableCreate(fixture->book);
+    tt_entry = gncTaxTableEntryCreate();
+    gncTaxTableSetName(taxtable, "Percent tax");
+    gncTaxTableEntrySetAccount(tt_entry, fixture->account2);
+    gncTaxTableEntrySetType(tt_entry, GNC_AMT_TYPE_PERCENT);
+    gncTaxTableEntrySetAmount(tt_entry, gnc_numeric_create(10, 1));
+    gncTaxTableAddEntry(taxtable, tt_entry);
+
+    gncInvoiceSetCurrency(fixture->invoice, fixture->commodity);
+    gncInvoiceSetOwner(fixture->invoice, &fixture->owner);
+    gncEntrySetInvAccount(entry, fixture->account);
+    gncEntrySetInvTaxable(entry, TRUE);
+    gncEntrySetInvTaxIncluded(entry, FALSE);
+    gncEntrySetInvTaxTable(entry, taxtable);
+    gncEntrySetQuantity(entry, gnc_numeric_create (2, 1));
+    gncEntrySetInvPrice(entry, gnc_numeric_create (10, 1));
+    gncInvoiceAddEntry (fixture->invoice, entry);
+
+    g_assert (gnc_numeric_equal (gncInvoiceGetTotalSubtotal(fixture->invoice), gnc_numeric_create (20, 1)));
+    g_assert (gnc_numeric_equal (gncInvoiceGetTotalTax(fixture->invoice), gnc_numeric_create (2, 1)));
+    g_assert (gnc_numeric_equal (gncInvoiceGetTotal(fixture->invoice), gnc_numeric_create (22, 1)));
+
+    /* Within the same second as the above, so only the version of the
+     * tax table tells the cached values are stale */
+    gncTaxTableEntrySetAmount(tt_entry, gnc_numeric_create(20, 1));
+    g_assert (gnc_numeric_equal (gncInvoiceGetTotalTax(fixture->invoice), gnc_numeric_create (4, 1)));
+    g_assert (gnc_numeric_equal (gncInvoiceGetTotal(fixture->invoice), gnc_numeric_create (24, 1)));
+
+    gncEntrySetInvPrice(entry, gnc_numeric_create (5, 1));
+    g_assert (gnc_numeric_equal (gncInvoiceGetTotalSubtotal(fixture->invoice), gnc_numeric_create (10, 1)));
+    g_assert (gnc_numeric_equal (gncInvoiceGetTotal(fixture->invoice), gnc_numeric_create (12, 1)));
+
+    gncInvoiceSetIsCreditNote(fixture->invoice, TRUE);
+    g_assert (gnc_numeric_equal (gncInvoiceGetTotal(fixture->invoice), gnc_numeric_create (-12, 1)));
+    gncInvoiceSetIsCreditNote(fixture->invoice, FALSE);
+
+    gncInvoiceRemoveEntry (fixture->invoice, entry);
+    g_assert (gnc_numeric_zero_p (gncInvoiceGetTotal(fixture->invoice)));
+    g_assert (gnc_numeric_zero_p (gncInvoiceGetTotalTax(fixture->invoice)));
+
+    gncEntryBeginEdit(entry);
+    gncEntryDestroy(entry);
+}
+
 void
 test_suite_gncInvoice ( void )
 {
     static InvoiceData pData = { FALSE, FALSE, { 1000, 100 }, { 2000, 100 } };  // Vendor bill
+    static InvoiceData custData = { FALSE, TRUE, { 1000, 100 }, { 2000, 100 } };  // Customer invoice
+    static InvoiceData vendData = { FALSE, FALSE, { 1000, 100 }, { 2000, 100 } };  // Vendor bill
     GNC_TEST_ADD( suitename, "post/unpost", Fixture, &pData, setup, test_invoice_post, teardown );
 
     GNC_TEST_ADD( suitename, "post trans - vendor bill", Fixture, &pData, setup_with_invoice, test_invoice_posted_trans, teardown_with_invoice );
@@ -221,4 +413,9 @@ test_suite_gncInvoice ( void )
     GNC_TEST_ADD( suitename, "post trans - customer creditnote", Fixture, &pData, setup_with_invoice, test_invoice_posted_trans, teardown_with_invoice );
     pData.is_cn = FALSE;   // Customer invoice
     GNC_TEST_ADD( suitename, "post trans - customer invoice", Fixture, &pData, setup_with_invoice, test_invoice_posted_trans, teardown_with_invoice );
+    GNC_TEST_ADD( suitename, "owner balance and lots - customer invoice", Fixture, &custData, setup, test_owner_balance, teardown_with_invoice );
+    GNC_TEST_ADD( suitename, "owner balance and lots - vendor bill", Fixture, &vendData, setup, test_owner_balance, teardown_with_invoice );
+    GNC_TEST_ADD( suitename, "owner aging - customer invoice", Fixture, &custData, setup, test_owner_aging, teardown_with_invoice );
+    GNC_TEST_ADD( suitename, "owner aging - vendor bill", Fixture, &vendData, setup, test_owner_aging, teardown_with_invoice );
+    GNC_TEST_ADD( suitename, "totals", Fixture, &custData, setup, test_invoice_totals, teardown_with_invoice );
 }
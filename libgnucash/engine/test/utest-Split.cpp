@@ -359,12 +359,17 @@ Not testable and wrong besides.
 */
 /* mark_split
 void mark_split (Split *s)// C: 2 in 2 SCM: 10 in 1 Local: 8:0:0
-OK, weird. Doesn't mark the split, marks the account sort-dirty and balance-dirty parameters.
+OK, weird. Doesn't mark the split, tells the account that the split
+changed so that it marks its balances dirty from the split onwards.
 */
 static void
 test_mark_split (Fixture *fixture, gconstpointer pData)
 {
     gboolean sort_dirty, balance_dirty;
+    /* The fixture only sets split->acc; the account must hold the split
+     * for it to take notice. */
+    gnc_account_insert_split (fixture->split->acc, fixture->split);
+    xaccAccountRecomputeBalance (fixture->split->acc);
     g_object_get (fixture->split->acc,
                   "sort-dirty", &sort_dirty,
                   "balance-dirty", &balance_dirty,
@@ -378,8 +383,10 @@ test_mark_split (Fixture *fixture, gconstpointer pData)
                   "sort-dirty", &sort_dirty,
                   "balance-dirty", &balance_dirty,
                   NULL);
-    g_assert_cmpint (sort_dirty, ==, TRUE);
+    /* A lone split can't be out of order, so the account isn't resorted */
+    g_assert_cmpint (sort_dirty, ==, FALSE);
     g_assert_cmpint (balance_dirty, ==, TRUE);
+    gnc_account_remove_split (fixture->split->acc, fixture->split);
 }
 // Not Used
 /* xaccSplitEqualCheckBal
@@ -399,10 +406,12 @@ test_xaccSplitEqualCheckBal (Fixture *fixture, gconstpointer pData)
 
     hdlr = g_log_set_handler ("gnc.engine", loglevel,
                               (GLogFunc)test_checked_handler, &check);
+    qof_log_set_level ("gnc.engine", QOF_LOG_INFO);
 
     g_assert_cmpint (fixture->func->xaccSplitEqualCheckBal ("test ", foo, foo), ==, TRUE);
     g_assert_cmpint (fixture->func->xaccSplitEqualCheckBal ("test ", foo, bar), ==, FALSE);
     g_assert_cmpint (check.hits, ==, 1);
+    qof_log_set_level ("gnc.engine", QOF_LOG_WARNING);
     g_log_remove_handler ("gnc.engine", hdlr);
 
 }
@@ -444,6 +453,7 @@ test_xaccSplitEqual (Fixture *fixture, gconstpointer pData)
 
     hdlr  = g_log_set_handler (logdomain, loglevel,
                                (GLogFunc)test_list_handler, &checkA);
+    qof_log_set_level (logdomain, QOF_LOG_INFO);
     /* Note that check_splits is just passed through to xaccTransEqual, so we don't vary it here. */
     /* Test that a NULL comparison fails */
     g_assert (xaccSplitEqual (fixture->split, NULL, TRUE, TRUE, TRUE) == FALSE);
@@ -526,6 +536,7 @@ test_xaccSplitEqual (Fixture *fixture, gconstpointer pData)
     g_object_unref (split1);
     g_object_unref (split2);
     test_clear_error_list ();
+    qof_log_set_level (logdomain, QOF_LOG_WARNING);
     g_log_remove_handler (logdomain, hdlr);
 
     g_free (msg03);
@@ -592,7 +603,8 @@ test_xaccSplitCommitEdit (Fixture *fixture, gconstpointer pData)
                   "sort-dirty", &sort_dirty,
                   "balance-dirty", &balance_dirty,
                   NULL);
-    g_assert_cmpint (sort_dirty, ==, TRUE);
+    /* The split was inserted in its sorted position */
+    g_assert_cmpint (sort_dirty, ==, FALSE);
     g_assert_cmpint (balance_dirty, ==, FALSE);
     g_assert (qof_instance_is_dirty (QOF_INSTANCE (fixture->split->parent)));
     g_assert (qof_instance_is_dirty (QOF_INSTANCE (fixture->split)));
@@ -34,6 +34,7 @@ extern "C"
 #include "../Account.h"
 #include "../gnc-lot.h"
 #include "../gnc-event.h"
+#include "../Scrub.h"
 #include <qof.h>
 
 #if defined(__clang__) && (__clang_major__ == 5 || (__clang_major__ == 3 && __clang_minor__ < 5))
@@ -779,6 +780,7 @@ test_xaccTransEqual (Fixture *fixture, gconstpointer pData)
 
     fixture->hdlrs = test_log_set_handler (fixture->hdlrs, check,
                                            (GLogFunc)test_list_handler);
+    qof_log_set_level (logdomain, QOF_LOG_INFO);
     /* Booleans are check_guids, check_splits, check_balances, assume_ordered */
     g_assert (xaccTransEqual (NULL, NULL, TRUE, TRUE, TRUE, TRUE));
     g_assert (!xaccTransEqual (txn0, NULL, TRUE, TRUE, TRUE, TRUE));
@@ -940,6 +942,7 @@ test_xaccTransEqual (Fixture *fixture, gconstpointer pData)
         split11->noclosing_balance = split01->noclosing_balance;
         g_assert (xaccTransEqual (txn1, txn0, TRUE, TRUE, TRUE, TRUE));
     }
+    qof_log_set_level (logdomain, QOF_LOG_WARNING);
     g_free (check3->msg);
     g_free (check2->msg);
 }
@@ -984,6 +987,15 @@ test_xaccTransGetImbalanceValue (Fixture *fixture, gconstpointer pData)
     g_assert (gnc_numeric_equal (xaccTransGetImbalanceValue (fixture->txn),
                                  split1->value));
     xaccTransCommitEdit (fixture->txn);
+    /* The cached imbalance follows changes to the splits. */
+    xaccTransBeginEdit (fixture->txn);
+    xaccSplitSetValue (split1, gnc_numeric_create (1600, 240));
+    g_assert (gnc_numeric_equal (xaccTransGetImbalanceValue (fixture->txn),
+                                 gnc_numeric_create (1600, 240)));
+    xaccSplitDestroy (split1);
+    g_assert (gnc_numeric_zero_p (xaccTransGetImbalanceValue (fixture->txn)));
+    xaccTransCommitEdit (fixture->txn);
+    g_assert (gnc_numeric_zero_p (xaccTransGetImbalanceValue (fixture->txn)));
 }
 /* xaccTransGetImbalance
 MonetaryList *
@@ -1321,6 +1333,7 @@ test_xaccTransBeginEdit ()
     auto check2 = test_error_struct_new (logdomain, loglevel, msg2);
     guint hdlr = g_log_set_handler (logdomain, loglevel,
                                     (GLogFunc)test_list_handler, NULL);
+    qof_log_set_level (logdomain, QOF_LOG_INFO);
     test_add_error (check1);
     test_add_error (check2);
 
@@ -1353,6 +1366,7 @@ test_xaccTransBeginEdit ()
     g_assert_cmpint (0, ==, qof_instance_get_editlevel (QOF_INSTANCE (txn)));
     g_assert (txn->orig == NULL);
 
+    qof_log_set_level (logdomain, QOF_LOG_WARNING);
     g_log_remove_handler (logdomain, hdlr);
     test_clear_error_list ();
     test_error_struct_free (check1);
@@ -1980,17 +1994,264 @@ test_xaccTransScrubGainsDate_gains_dirty (GainsFixture *fixture,
                      ==, 0);
 }
 
+static void
+ignore_percentage (const char *message, double percent)
+{
+}
+
+static gboolean
+book_has_scrub_record (QofBook *book)
+{
+    auto frame = qof_instance_get_slots (QOF_INSTANCE (book));
+    return frame->get_slot ({"scrubbed-up-to"}) != nullptr;
+}
+
+/* xaccBookScrubChanged */
+static void
+test_xaccBookScrubChanged (Fixture *fixture, gconstpointer pData)
+{
+    auto book = qof_instance_get_book (QOF_INSTANCE (fixture->txn));
+
+    xaccBookScrubChanged (book, ignore_percentage);
+    xaccTransBeginEdit (fixture->txn);
+    xaccTransSetDescription (fixture->txn, "Gnu Pepper");
+    xaccTransCommitEdit (fixture->txn);
+    xaccBookScrubChanged (book, ignore_percentage);
+    g_assert_cmpstr (xaccTransGetDescription (fixture->txn), ==, "Gnu Pepper");
+    /* A change made with events suspended isn't seen, so the whole tree
+     * is scrubbed again. */
+    qof_event_suspend ();
+    xaccTransBeginEdit (fixture->txn);
+    xaccTransSetDescription (fixture->txn, "Waldo Pepper");
+    xaccTransCommitEdit (fixture->txn);
+    qof_event_resume ();
+    xaccBookScrubChanged (book, ignore_percentage);
+    g_assert_cmpstr (xaccTransGetDescription (fixture->txn), ==, "Waldo Pepper");
+    /* What was scrubbed is only known to the session, not saved. */
+    g_assert (!book_has_scrub_record (book));
+}
+
+/* xaccAccountTreeScrubImbalance */
+static void
+test_xaccAccountTreeScrubImbalance (Fixture *fixture, gconstpointer pData)
+{
+    auto book = qof_instance_get_book (QOF_INSTANCE (fixture->txn));
+    auto root = gnc_book_get_root_account (book);
+    auto split = static_cast<Split*>(fixture->txn->splits->data);
+
+    gnc_account_append_child (root, fixture->acc1);
+    gnc_account_append_child (root, fixture->acc2);
+    /* A balanced transaction is left alone. */
+    xaccAccountTreeScrubImbalance (root, ignore_percentage);
+    g_assert_cmpint (g_list_length (fixture->txn->splits), ==, 2);
+
+    xaccDisableDataScrubbing ();
+    xaccTransBeginEdit (fixture->txn);
+    xaccSplitSetValue (split, gnc_numeric_create (3300, 240));
+    xaccTransCommitEdit (fixture->txn);
+    xaccEnableDataScrubbing ();
+    g_assert (!xaccTransIsBalanced (fixture->txn));
+
+    xaccAccountTreeScrubImbalance (root, ignore_percentage);
+    g_assert (xaccTransIsBalanced (fixture->txn));
+    g_assert_cmpint (g_list_length (fixture->txn->splits), ==, 3);
+}
+
+/* xaccAccountTreeScrubSplits */
+static void
+test_xaccAccountTreeScrubSplits (Fixture *fixture, gconstpointer pData)
+{
+    auto book = qof_instance_get_book (QOF_INSTANCE (fixture->txn));
+    auto root = gnc_book_get_root_account (book);
+    auto split1 = static_cast<Split*>(fixture->txn->splits->data);
+    auto split2 = static_cast<Split*>(fixture->txn->splits->next->data);
+    auto fund_amount = split1->amount;
+
+    gnc_account_append_child (root, fixture->acc1);
+    gnc_account_append_child (root, fixture->acc2);
+    xaccDisableDataScrubbing ();
+    xaccTransBeginEdit (fixture->txn);
+    xaccSplitSetAmount (split2, gnc_numeric_create (-3300, 240));
+    xaccTransCommitEdit (fixture->txn);
+    xaccEnableDataScrubbing ();
+
+    xaccAccountTreeScrubSplits (root);
+    /* The currency split's amount follows its value; the fund split's
+     * amount is in another commodity and is left alone. */
+    g_assert (gnc_numeric_equal (split2->amount, split2->value));
+    g_assert (gnc_numeric_equal (split1->amount, fund_amount));
+}
+
 /* xaccTransScrubGains Local: 1:0:0
  * Non-trivial, but it passes through selected splits to functions in
  * cap-gains.c and Scrub3.c that are beyond the scope of this test
  * program.
  */
 /* xaccTransFindSplitByAccount C: 7 in 5  Local: 0:0:0
- * destroy_tx_on_book_close Local: 0:1:0
- * gnc_transaction_book_end Local: 0:1:0
  * trans_is_balanced_p Local: 0:1:0
  * Trivial pass-through.
  */
+/* free_tx_on_book_close Local: 0:1:0
+ * gnc_transaction_book_end Local: 0:1:0
+ */
+static void
+count_instance_events (QofInstance *ent, QofEventId event_type,
+                       gpointer handler_data, gpointer event_data)
+{
+    if (!QOF_IS_BOOK (ent))
+        ++*static_cast<int*>(handler_data);
+}
+
+static void
+test_gnc_transaction_book_end (void)
+{
+    auto book = qof_book_new ();
+    auto root = gnc_book_get_root_account (book);
+    auto curr = gnc_commodity_new (book, "Gnu Rand", "CURRENCY", "GNR", "", 240);
+    auto acc1 = xaccMallocAccount (book);
+    auto acc2 = xaccMallocAccount (book);
+    auto txn = xaccMallocTransaction (book);
+    auto split1 = xaccMallocSplit (book);
+    auto split2 = xaccMallocSplit (book);
+    auto lot = gnc_lot_new (book);
+    int events = 0;
+
+    xaccAccountSetCommodity (acc1, curr);
+    xaccAccountSetCommodity (acc2, curr);
+    gnc_account_append_child (root, acc1);
+    gnc_account_append_child (root, acc2);
+    xaccTransBeginEdit (txn);
+    xaccTransSetCurrency (txn, curr);
+    xaccSplitSetParent (split1, txn);
+    xaccSplitSetParent (split2, txn);
+    xaccSplitSetAccount (split1, acc1);
+    xaccSplitSetAccount (split2, acc2);
+    xaccSplitSetAmount (split1, gnc_numeric_create (1000, 240));
+    xaccSplitSetValue (split1, gnc_numeric_create (1000, 240));
+    xaccSplitSetAmount (split2, gnc_numeric_create (-1000, 240));
+    xaccSplitSetValue (split2, gnc_numeric_create (-1000, 240));
+    xaccTransCommitEdit (txn);
+    gnc_lot_add_split (lot, split1);
+
+    /* Closing the book frees everything without per-instance events. */
+    auto id = qof_event_register_handler (count_instance_events, &events);
+    qof_book_destroy (book);
+    qof_event_unregister_handler (id);
+    g_assert_cmpint (events, ==, 0);
+}
+
+static void
+test_gnc_transaction_filtered_events (void)
+{
+    auto book = qof_book_new ();
+    auto curr = gnc_commodity_new (book, "Gnu Rand", "CURRENCY", "GNR", "", 240);
+    auto txn = xaccMallocTransaction (book);
+    int trans_events = 0, destroy_events = 0, commodity_events = 0;
+
+    xaccTransBeginEdit (txn);
+    xaccTransSetCurrency (txn, curr);
+    xaccTransCommitEdit (txn);
+
+    auto trans_id = qof_event_register_filtered_handler (GNC_ID_TRANS,
+                                                         QOF_EVENT_MODIFY,
+                                                         count_instance_events,
+                                                         &trans_events);
+    auto destroy_id = qof_event_register_filtered_handler (GNC_ID_TRANS,
+                                                           QOF_EVENT_DESTROY,
+                                                           count_instance_events,
+                                                           &destroy_events);
+    auto commodity_id = qof_event_register_filtered_handler (GNC_ID_COMMODITY,
+                                                             QOF_EVENT_ALL,
+                                                             count_instance_events,
+                                                             &commodity_events);
+    xaccTransBeginEdit (txn);
+    xaccTransSetDescription (txn, "Filtered");
+    xaccTransCommitEdit (txn);
+    g_assert_cmpint (trans_events, >, 0);
+    g_assert_cmpint (destroy_events, ==, 0);
+    g_assert_cmpint (commodity_events, ==, 0);
+
+    qof_event_unregister_handler (trans_id);
+    qof_event_unregister_handler (destroy_id);
+    qof_event_unregister_handler (commodity_id);
+    trans_events = 0;
+    xaccTransBeginEdit (txn);
+    xaccTransSetDescription (txn, "Unfiltered");
+    xaccTransCommitEdit (txn);
+    g_assert_cmpint (trans_events, ==, 0);
+    qof_book_destroy (book);
+}
+
+struct BatchCounts
+{
+    int events;
+    int batches;
+    GList *entries;
+};
+
+static void
+count_batch_events (QofInstance *ent, QofEventId event_type,
+                    gpointer handler_data, gpointer event_data)
+{
+    if (GNC_IS_TRANSACTION (ent))
+        ++static_cast<BatchCounts*>(handler_data)->events;
+}
+
+static void
+count_batches (GList *changes, gpointer handler_data)
+{
+    auto counts = static_cast<BatchCounts*>(handler_data);
+    ++counts->batches;
+    for (auto node = changes; node; node = node->next)
+    {
+        auto entry = static_cast<QofEventBatchEntry*>(node->data);
+        if (g_strcmp0 (entry->type, GNC_ID_TRANS) == 0)
+            counts->entries = g_list_append (counts->entries,
+                                             g_memdup (entry, sizeof (*entry)));
+    }
+}
+
+static void
+test_gnc_transaction_batch_events (void)
+{
+    auto book = qof_book_new ();
+    auto curr = gnc_commodity_new (book, "Gnu Rand", "CURRENCY", "GNR", "", 240);
+    auto txn = xaccMallocTransaction (book);
+    BatchCounts counts {0, 0, nullptr};
+
+    auto id = qof_event_register_batch_handler (count_batch_events,
+                                                count_batches, &counts);
+    qof_event_begin_batch ();
+    xaccTransBeginEdit (txn);
+    xaccTransSetCurrency (txn, curr);
+    xaccTransCommitEdit (txn);
+    qof_event_begin_batch ();
+    xaccTransBeginEdit (txn);
+    xaccTransSetDescription (txn, "Batched");
+    xaccTransCommitEdit (txn);
+    qof_event_end_batch ();
+    g_assert_cmpint (counts.batches, ==, 0);
+    qof_event_end_batch ();
+
+    g_assert_cmpint (counts.events, ==, 0);
+    g_assert_cmpint (counts.batches, ==, 1);
+    g_assert_cmpint (g_list_length (counts.entries), ==, 1);
+    auto entry = static_cast<QofEventBatchEntry*>(counts.entries->data);
+    g_assert (entry->entity == QOF_INSTANCE (txn));
+    g_assert (guid_equal (&entry->guid, xaccTransGetGUID (txn)));
+    g_assert_cmpint (entry->events & QOF_EVENT_MODIFY, !=, 0);
+    g_list_free_full (counts.entries, g_free);
+
+    /* Outside of a batch the handler gets the events one by one. */
+    xaccTransBeginEdit (txn);
+    xaccTransSetDescription (txn, "Unbatched");
+    xaccTransCommitEdit (txn);
+    g_assert_cmpint (counts.events, >, 0);
+    g_assert_cmpint (counts.batches, ==, 1);
+
+    qof_event_unregister_handler (id);
+    qof_book_destroy (book);
+}
 
 
 void
@@ -2003,6 +2264,9 @@ test_suite_transaction (void)
     GNC_TEST_ADD_FUNC (suitename, "gnc transaction init", test_gnc_transaction_init);
     GNC_TEST_ADD_FUNC (suitename, "gnc transaction dispose", test_gnc_transaction_dispose);
     GNC_TEST_ADD_FUNC (suitename, "gnc transaction finalize", test_gnc_transaction_finalize);
+    GNC_TEST_ADD_FUNC (suitename, "gnc transaction book end", test_gnc_transaction_book_end);
+    GNC_TEST_ADD_FUNC (suitename, "gnc transaction filtered events", test_gnc_transaction_filtered_events);
+    GNC_TEST_ADD_FUNC (suitename, "gnc transaction batch events", test_gnc_transaction_batch_events);
     GNC_TEST_ADD (suitename, "gnc transaction set/get property", Fixture, NULL, setup, test_gnc_transaction_set_get_property, teardown);
     GNC_TEST_ADD (suitename, "xaccMallocTransaction", Fixture, NULL, setup, test_xaccMallocTransaction, teardown);
     GNC_TEST_ADD (suitename, "xaccTransSortSplits", Fixture, NULL, setup, test_xaccTransSortSplits, teardown);
@@ -2043,5 +2307,8 @@ test_suite_transaction (void)
     GNC_TEST_ADD (suitename, "xaccTransScrubGainsDate_no_dirty", GainsFixture, NULL, setup_with_gains, test_xaccTransScrubGainsDate_no_dirty, teardown_with_gains);
     GNC_TEST_ADD (suitename, "xaccTransScrubGainsDate_base_dirty", GainsFixture, NULL, setup_with_gains, test_xaccTransScrubGainsDate_base_dirty, teardown_with_gains);
     GNC_TEST_ADD (suitename, "xaccTransScrubGainsDate_gains_dirty", GainsFixture, NULL, setup_with_gains, test_xaccTransScrubGainsDate_gains_dirty, teardown_with_gains);
+    GNC_TEST_ADD (suitename, "xaccBookScrubChanged", Fixture, NULL, setup, test_xaccBookScrubChanged, teardown);
+    GNC_TEST_ADD (suitename, "xaccAccountTreeScrubImbalance", Fixture, NULL, setup, test_xaccAccountTreeScrubImbalance, teardown);
+    GNC_TEST_ADD (suitename, "xaccAccountTreeScrubSplits", Fixture, NULL, setup, test_xaccAccountTreeScrubSplits, teardown);
 
 }
@@ -28,6 +28,7 @@
 /* Add specific headers for this class */
 #include <gnc-pricedb.h>
 #include <gnc-pricedb-p.h>
+#include <qofinstance-p.h>
 
 static const gchar *suitename = "/engine/gnc-pricedb";
 void test_suite_gnc_pricedb ( void );
@@ -601,6 +602,28 @@ teardown(PriceDBFixture *fixture, gconstpointer data)
     qof_book_destroy(book);
     g_free(fixture->com);
 }
+
+static void
+test_gnc_price_create (PriceDBFixture *fixture, gconstpointer pData)
+{
+    QofBook *book = qof_instance_get_book(fixture->pricedb);
+    GNCPrice *price = gnc_price_create(book);
+    GValue value = G_VALUE_INIT, result = G_VALUE_INIT;
+
+    g_assert_null(QOF_INSTANCE(price)->kvp_data);
+    g_assert_false(qof_instance_has_kvp(QOF_INSTANCE(price)));
+
+    g_value_init(&value, G_TYPE_STRING);
+    g_value_set_string(&value, "note");
+    qof_instance_set_kvp(QOF_INSTANCE(price), &value, 1, "test-slot");
+    g_assert_true(qof_instance_has_kvp(QOF_INSTANCE(price)));
+    qof_instance_get_kvp(QOF_INSTANCE(price), &result, 1, "test-slot");
+    g_assert_cmpstr(g_value_get_string(&result), ==, "note");
+
+    g_value_unset(&value);
+    g_value_unset(&result);
+    gnc_price_unref(price);
+}
 /* gnc_pricedb_init
 static void
 gnc_pricedb_init(GNCPriceDB* pdb)*/
@@ -737,6 +760,76 @@ gnc_pricedb_add_price(GNCPriceDB *db, GNCPrice *p)// C: 7 in 7 SCM: 1  Local: 0:
 test_gnc_pricedb_add_price (Fixture *fixture, gconstpointer pData)
 {
 }*/
+static void
+count_price_adds (QofInstance *entity, QofEventId event_type,
+                  gpointer handler_data, gpointer event_data)
+{
+    guint *adds = handler_data;
+    if (GNC_IS_PRICE (entity) && event_type == QOF_EVENT_ADD)
+        ++*adds;
+}
+
+/* gnc_pricedb_add_prices
+guint
+gnc_pricedb_add_prices(GNCPriceDB *db, GNCPrice **prices, guint n_prices)
+*/
+static void
+test_gnc_pricedb_add_prices (PriceDBFixture *fixture, gconstpointer pData)
+{
+    QofBook *book = qof_instance_get_book(fixture->pricedb);
+    Commodities *c = fixture->com;
+    time64 d1 = gnc_dmy2time64(3, 2, 2015);
+    time64 d2 = gnc_dmy2time64(4, 2, 2015);
+    time64 d3 = gnc_dmy2time64(5, 2, 2015);
+    time64 old_day = gnc_dmy2time64(12, 11, 2014);
+    GNCPrice *batch[] = {
+        construct_price(book, c->bgn, c->eur, d1, PRICE_SOURCE_FQ,
+                        gnc_numeric_create(51129, 100000)),
+        construct_price(book, c->bgn, c->eur, d3, PRICE_SOURCE_FQ,
+                        gnc_numeric_create(51130, 100000)),
+        construct_price(book, c->bgn, c->eur, d2, PRICE_SOURCE_FQ,
+                        gnc_numeric_create(51131, 100000)),
+        /* Loses to the FQ price of the same day. */
+        construct_price(book, c->bgn, c->eur, d2 + 3600,
+                        PRICE_SOURCE_USER_PRICE,
+                        gnc_numeric_create(51132, 100000)),
+        /* Replaces the price already in the db. */
+        construct_price(book, c->usd, c->aud, old_day, PRICE_SOURCE_EDIT_DLG,
+                        gnc_numeric_create(114000, 100000)),
+        /* Replaces the first price in the batch. */
+        construct_price(book, c->bgn, c->eur, d1 + 3600, PRICE_SOURCE_EDIT_DLG,
+                        gnc_numeric_create(51133, 100000)),
+    };
+    guint generation = gnc_pricedb_get_generation(fixture->pricedb);
+    PriceList *prices;
+    GNCPrice *price;
+    guint adds = 0;
+    gint id;
+
+    id = qof_event_register_handler (count_price_adds, &adds);
+    g_assert_cmpint(gnc_pricedb_add_prices(fixture->pricedb, batch,
+                                           G_N_ELEMENTS(batch)), ==, 4);
+    qof_event_unregister_handler (id);
+    g_assert_cmpint(adds, ==, 4);
+    g_assert_cmpint(gnc_pricedb_get_generation(fixture->pricedb), !=, generation);
+
+    prices = gnc_pricedb_get_prices(fixture->pricedb, c->bgn, c->eur);
+    g_assert_cmpint(g_list_length(prices), ==, 3);
+    g_assert(prices->data == batch[1]);
+    g_assert(prices->next->data == batch[2]);
+    g_assert(prices->next->next->data == batch[5]);
+    gnc_price_list_destroy(prices);
+
+    prices = gnc_pricedb_get_prices(fixture->pricedb, c->usd, c->aud);
+    g_assert_cmpint(g_list_length(prices), ==, 5);
+    g_assert(prices->data == batch[4]);
+    gnc_price_list_destroy(prices);
+
+    price = gnc_pricedb_lookup_nearest_in_time64(fixture->pricedb, c->bgn,
+                                                 c->eur, d2 + 60);
+    g_assert(price == batch[2]);
+    gnc_price_unref(price);
+}
 /* remove_price
 static gboolean
 remove_price(GNCPriceDB *db, GNCPrice *p, gboolean cleanup)// Local: 4:0:0
@@ -850,6 +943,49 @@ static void test_gnc_pricedb_remove_old_prices (PriceDBFixture *fixture, gconstp
     g_list_free (comm_list);
     g_date_free (fiscal_end_date);
 }
+typedef struct
+{
+    guint price_removes;
+    guint db_modifies;
+} RemovalEvents;
+
+static void
+count_removal_events (QofInstance *entity, QofEventId event_type,
+                      gpointer handler_data, gpointer event_data)
+{
+    RemovalEvents *counts = handler_data;
+    if (GNC_IS_PRICE (entity) && event_type == QOF_EVENT_REMOVE)
+        ++counts->price_removes;
+    else if (GNC_IS_PRICEDB (entity) && event_type == QOF_EVENT_MODIFY)
+        ++counts->db_modifies;
+}
+
+static void
+test_gnc_pricedb_remove_old_prices_events (PriceDBFixture *fixture,
+                                           gconstpointer pData)
+{
+    GList *comm_list = g_list_append (NULL, fixture->com->gbp);
+    RemovalEvents counts = {0, 0};
+    time64 t_cut = gnc_dmy2time64(1, 1, 2010);
+    gint id;
+
+    id = qof_event_register_handler (count_removal_events, &counts);
+    g_assert (gnc_pricedb_remove_old_prices(fixture->pricedb, comm_list,
+                                           NULL, t_cut,
+                                           PRICE_REMOVE_SOURCE_FQ |
+                                           PRICE_REMOVE_SOURCE_USER |
+                                           PRICE_REMOVE_SOURCE_APP,
+                                           PRICE_REMOVE_KEEP_NONE));
+    qof_event_unregister_handler (id);
+
+    g_assert_cmpint (counts.price_removes, ==, 0);
+    g_assert_cmpint (counts.db_modifies, ==, 1);
+    g_assert_null (gnc_pricedb_lookup_latest_before_t64 (fixture->pricedb,
+                                                         fixture->com->gbp,
+                                                         fixture->com->usd,
+                                                         t_cut - 1));
+    g_list_free (comm_list);
+}
 /* price_list_from_hashtable
 static PriceList *
 price_list_from_hashtable (GHashTable *hash, const gnc_commodity *currency)// Local: 2:0:0
@@ -973,6 +1109,42 @@ test_gnc_pricedb_lookup_latest_any_currency (PriceDBFixture *fixture, gconstpoin
     g_assert_cmpstr(GET_COM_NAME(prices->next->next->next->data), ==, "GBP");
     gnc_price_list_destroy(prices);
 }
+
+static void
+test_gnc_pricedb_lookup_latest_any_currency_index (PriceDBFixture *fixture,
+                                                  gconstpointer pData)
+{
+    QofBook *book = qof_instance_get_book(fixture->pricedb);
+    Commodities *c = fixture->com;
+    GNCPrice *price, *batch[1];
+    PriceList *prices;
+
+    /* Dropping every USD/DKK price has to take DKK out of USD's
+     * counterparts... */
+    while ((price = gnc_pricedb_lookup_latest(fixture->pricedb, c->usd,
+                                              c->dkk)))
+    {
+        gnc_pricedb_remove_price(fixture->pricedb, price);
+        gnc_price_unref(price);
+    }
+    prices = gnc_pricedb_lookup_latest_any_currency(fixture->pricedb, c->usd);
+    g_assert_cmpint(g_list_length(prices), ==, 3);
+    prices = g_list_sort(prices, compare_price_commodities);
+    g_assert_cmpstr(GET_COM_NAME(prices->next->next->data), ==, "GBP");
+    gnc_price_list_destroy(prices);
+
+    /* ...and a batch insert has to put it back. */
+    batch[0] = construct_price(book, c->dkk, c->usd,
+                               gnc_dmy2time64(1, 2, 2014), PRICE_SOURCE_FQ,
+                               gnc_numeric_create(18, 100));
+    g_assert_cmpint(gnc_pricedb_add_prices(fixture->pricedb, batch, 1), ==, 1);
+    gnc_price_unref(batch[0]);
+    prices = gnc_pricedb_lookup_latest_any_currency(fixture->pricedb, c->usd);
+    g_assert_cmpint(g_list_length(prices), ==, 4);
+    prices = g_list_sort(prices, compare_price_commodities);
+    g_assert_cmpstr(GET_COM_NAME(prices->next->next->data), ==, "DKK");
+    gnc_price_list_destroy(prices);
+}
 // Make Static
 /* gnc_pricedb_lookup_nearest_in_time_any_currency_t64
 PriceList *
@@ -1064,6 +1236,34 @@ test_gnc_pricedb_get_prices (PriceDBFixture *fixture, gconstpointer pData)
     g_assert_cmpint(g_list_length(prices), ==, 5);
     gnc_price_list_destroy(prices);
 }
+/* gnc_pricedb_nth_price
+GNCPrice *
+gnc_pricedb_nth_price (GNCPriceDB *db,// C: 4 in 1  Local: 0:0:0
+*/
+static void
+test_gnc_pricedb_nth_price (PriceDBFixture *fixture, gconstpointer pData)
+{
+    gnc_commodity *gbp = fixture->com->gbp;
+    int num = gnc_pricedb_num_prices(fixture->pricedb, gbp);
+    time64 oldest = G_MAXINT64;
+    int n;
+
+    g_assert_cmpint(num, ==, 23);
+    for (n = 0; n < num; n++)
+    {
+        GNCPrice *price = gnc_pricedb_nth_price(fixture->pricedb, gbp, n);
+        g_assert(price != NULL);
+        g_assert(gnc_price_get_commodity(price) == gbp);
+        g_assert_cmpint(gnc_pricedb_nth_price_index(fixture->pricedb, price),
+                        ==, n);
+        oldest = MIN(oldest, gnc_price_get_time64(price));
+    }
+    g_assert(gnc_pricedb_nth_price(fixture->pricedb, gbp, num) == NULL);
+    g_assert_cmpint(gnc_pricedb_get_oldest_price_time(fixture->pricedb, gbp),
+                    ==, oldest);
+    g_assert_cmpint(gnc_pricedb_get_oldest_price_time(fixture->pricedb, NULL),
+                    ==, G_MAXINT64);
+}
 /* gnc_pricedb_lookup_day_t64
 GNCPrice *
 gnc_pricedb_lookup_day_t64(GNCPriceDB *db,// C: 4 in 2 SCM: 2 in 1 Local: 1:0:0
@@ -1095,11 +1295,25 @@ test_gnc_pricedb_lookup_day_t64 (PriceDBFixture *fixture, gconstpointer pData)
     g_log_set_default_handler (hdlr, 0);
 }
 
-// Not Used
 /* gnc_pricedb_lookup_at_time64
 GNCPrice *
 gnc_pricedb_lookup_at_time64(GNCPriceDB *db,// Local: 0:0:0
 */
+static void
+test_gnc_pricedb_lookup_at_time64 (PriceDBFixture *fixture, gconstpointer pData)
+{
+    time64 t = gnc_dmy2time64(17, 11, 2012);
+    GNCPrice *price = gnc_pricedb_lookup_at_time64(fixture->pricedb,
+                                                   fixture->com->usd,
+                                                   fixture->com->aud, t);
+    g_assert_cmpstr(GET_COM_NAME(price), ==, "AUD");
+    g_assert_cmpint(gnc_price_get_time64(price), ==, t);
+    gnc_price_unref(price);
+    price = gnc_pricedb_lookup_at_time64(fixture->pricedb,
+                                         fixture->com->usd,
+                                         fixture->com->aud, t + 1);
+    g_assert(price == NULL);
+}
 /* lookup_nearest_in_time
 static GNCPrice *
 lookup_nearest_in_time(GNCPriceDB *db,// Local: 2:0:0
@@ -1129,11 +1343,37 @@ test_gnc_pricedb_lookup_nearest_in_time64 (PriceDBFixture *fixture, gconstpointe
     g_assert_cmpstr(GET_CUR_NAME(price), ==, "AUD");
     g_assert_cmpstr(GET_COM_NAME(price), ==, "USD");
 }
-// Not Used
 /* gnc_pricedb_lookup_latest_before_t64
 GNCPrice *
 gnc_pricedb_lookup_latest_before_t64 (GNCPriceDB *db,// Local: 0:0:0
 */
+static void
+test_gnc_pricedb_lookup_latest_before_t64 (PriceDBFixture *fixture, gconstpointer pData)
+{
+    time64 t1 = gnc_dmy2time64(1, 1, 2012);
+    time64 t2 = gnc_dmy2time64(1, 1, 2014);
+    GNCPrice *price =
+        gnc_pricedb_lookup_latest_before_t64(fixture->pricedb,
+                                             fixture->com->usd,
+                                             fixture->com->aud, t1);
+    /* The AUD->USD price on 20 Jul 2011 beats the USD->AUD one of 2010. */
+    g_assert_cmpstr(GET_COM_NAME(price), ==, "AUD");
+    g_assert_cmpint(gnc_price_get_time64(price), ==,
+                    gnc_dmy2time64(20, 7, 2011));
+    gnc_price_unref(price);
+    price = gnc_pricedb_lookup_latest_before_t64(fixture->pricedb,
+                                                 fixture->com->usd,
+                                                 fixture->com->aud, t2);
+    g_assert_cmpstr(GET_COM_NAME(price), ==, "USD");
+    g_assert_cmpint(gnc_price_get_time64(price), ==,
+                    gnc_dmy2time64(1, 8, 2013));
+    gnc_price_unref(price);
+    price = gnc_pricedb_lookup_latest_before_t64(fixture->pricedb,
+                                                 fixture->com->usd,
+                                                 fixture->com->aud,
+                                                 gnc_dmy2time64(1, 1, 2009));
+    g_assert(price == NULL);
+}
 /* direct_balance_conversion
 static gnc_numeric
 direct_balance_conversion (GNCPriceDB *db, gnc_numeric bal,// Local: 2:0:0
@@ -1326,6 +1566,88 @@ test_gnc_pricedb_get_nearest_price (PriceDBFixture *fixture, gconstpointer pData
     g_assert_cmpint(result.denom, ==, 1331);
 }
 
+static void
+test_gnc_pricedb_get_nearest_price_new_path (PriceDBFixture *fixture,
+                                             gconstpointer pData)
+{
+    time64 t = gnc_dmy2time64(15, 8, 2011);
+    QofBook *book = qof_instance_get_book(fixture->pricedb);
+    GNCPrice *price;
+    gnc_numeric result;
+
+    result = gnc_pricedb_get_nearest_price (fixture->pricedb,
+                                            fixture->com->bgn,
+                                            fixture->com->gbp, t);
+    g_assert(gnc_numeric_zero_p(result));
+
+    /* A BGN->EUR price connects BGN to GBP through the GBP->EUR prices. */
+    price = construct_price(book, fixture->com->bgn, fixture->com->eur, t,
+                            PRICE_SOURCE_FQ, gnc_numeric_create(51129, 100000));
+    gnc_pricedb_add_price(fixture->pricedb, price);
+    result = gnc_pricedb_get_nearest_price (fixture->pricedb,
+                                            fixture->com->bgn,
+                                            fixture->com->gbp, t);
+    g_assert(gnc_numeric_equal(result, gnc_numeric_create(51129, 113289)));
+
+    gnc_pricedb_remove_price(fixture->pricedb, price);
+    result = gnc_pricedb_get_nearest_price (fixture->pricedb,
+                                            fixture->com->bgn,
+                                            fixture->com->gbp, t);
+    g_assert(gnc_numeric_zero_p(result));
+}
+
+/* gnc_pricedb_build_price_table
+GNCPriceTable *
+gnc_pricedb_build_price_table (GNCPriceDB *db, CommodityList *commodities,
+*/
+static void
+test_gnc_pricedb_build_price_table (PriceDBFixture *fixture, gconstpointer pData)
+{
+    time64 dates[] = { gnc_dmy2time64(15, 8, 2011), gnc_dmy2time64(1, 1, 2013),
+                       INT64_MAX };
+    gnc_commodity *coms[] = { fixture->com->usd, fixture->com->amzn,
+                              fixture->com->gbp };
+    GList *commodities = NULL;
+    GNCPriceTable *table;
+    guint i, j;
+
+    for (i = 0; i < G_N_ELEMENTS (coms); i++)
+        commodities = g_list_append (commodities, coms[i]);
+    commodities = g_list_append (commodities, fixture->com->bgn);
+    table = gnc_pricedb_build_price_table (fixture->pricedb, commodities, dates,
+                                           G_N_ELEMENTS (dates),
+                                           fixture->com->aud);
+    g_list_free (commodities);
+
+    for (i = 0; i < G_N_ELEMENTS (coms); i++)
+        for (j = 0; j < G_N_ELEMENTS (dates); j++)
+        {
+            gnc_numeric expected =
+                gnc_pricedb_get_nearest_price (fixture->pricedb, coms[i],
+                                               fixture->com->aud, dates[j]);
+            gnc_numeric rate = gnc_price_table_get_rate (table, coms[i], j);
+            g_assert (!gnc_numeric_zero_p (rate));
+            g_assert (gnc_numeric_equal (rate, expected));
+        }
+    g_assert_cmpint (gnc_price_table_get_rate (table, fixture->com->usd, 0).num,
+                     ==, 1250);
+    g_assert (gnc_numeric_zero_p (gnc_price_table_get_rate (table, fixture->com->bgn, 0)));
+    g_assert (gnc_numeric_zero_p (gnc_price_table_get_rate (table, fixture->com->dkk, 0)));
+    g_assert (gnc_numeric_equal (gnc_price_table_get_rate (table, fixture->com->aud, 1),
+                                 gnc_numeric_create (1, 1)));
+    g_assert (gnc_numeric_equal (gnc_price_table_convert_balance (table,
+                                                                  gnc_numeric_create (1331, 1),
+                                                                  fixture->com->usd, 0),
+                                 gnc_numeric_create (1250, 1)));
+
+    g_assert_cmpint (gnc_price_table_date_index (table, gnc_dmy2time64(1, 1, 2000)), ==, 0);
+    g_assert_cmpint (gnc_price_table_date_index (table, dates[0]), ==, 0);
+    g_assert_cmpint (gnc_price_table_date_index (table, dates[1] - 1), ==, 0);
+    g_assert_cmpint (gnc_price_table_date_index (table, dates[1]), ==, 1);
+    g_assert_cmpint (gnc_price_table_date_index (table, INT64_MAX), ==, 2);
+    gnc_price_table_destroy (table);
+}
+
 /* pricedb_foreach_pricelist
 static void
 pricedb_foreach_pricelist(gpointer key, gpointer val, gpointer user_data)// Local: 0:1:0
@@ -1503,7 +1825,7 @@ test_suite_gnc_pricedb (void)
 // GNC_TEST_ADD (suitename, "gnc price get property", Fixture, NULL, setup, test_gnc_price_get_property, teardown);
 // GNC_TEST_ADD (suitename, "gnc price set property", Fixture, NULL, setup, test_gnc_price_set_property, teardown);
 // GNC_TEST_ADD (suitename, "gnc price class init", Fixture, NULL, setup, test_gnc_price_class_init, teardown);
-// GNC_TEST_ADD (suitename, "gnc price create", Fixture, NULL, setup, test_gnc_price_create, teardown);
+    GNC_TEST_ADD (suitename, "gnc price create", PriceDBFixture, NULL, setup, test_gnc_price_create, teardown);
 // GNC_TEST_ADD (suitename, "gnc price destroy", Fixture, NULL, setup, test_gnc_price_destroy, teardown);
 // GNC_TEST_ADD (suitename, "gnc price ref", Fixture, NULL, setup, test_gnc_price_ref, teardown);
 // GNC_TEST_ADD (suitename, "gnc price unref", Fixture, NULL, setup, test_gnc_price_unref, teardown);
@@ -1552,12 +1874,14 @@ test_suite_gnc_pricedb (void)
 // GNC_TEST_ADD (suitename, "insert or replace price", Fixture, NULL, setup, test_insert_or_replace_price, teardown);
 // GNC_TEST_ADD (suitename, "add price", Fixture, NULL, setup, test_add_price, teardown);
 // GNC_TEST_ADD (suitename, "gnc pricedb add price", Fixture, NULL, setup, test_gnc_pricedb_add_price, teardown);
+    GNC_TEST_ADD (suitename, "gnc pricedb add prices", PriceDBFixture, NULL, setup, test_gnc_pricedb_add_prices, teardown);
 // GNC_TEST_ADD (suitename, "remove price", Fixture, NULL, setup, test_remove_price, teardown);
 // GNC_TEST_ADD (suitename, "gnc pricedb remove price", Fixture, NULL, setup, test_gnc_pricedb_remove_price, teardown);
 // GNC_TEST_ADD (suitename, "check one price date", Fixture, NULL, setup, test_check_one_price_date, teardown);
 // GNC_TEST_ADD (suitename, "pricedb remove foreach pricelist", Fixture, NULL, setup, test_pricedb_remove_foreach_pricelist, teardown);
 // GNC_TEST_ADD (suitename, "pricedb remove foreach currencies hash", Fixture, NULL, setup, test_pricedb_remove_foreach_currencies_hash, teardown);
     GNC_TEST_ADD (suitename, "gnc pricedb remove old prices", PriceDBFixture, NULL, setup, test_gnc_pricedb_remove_old_prices, teardown);
+    GNC_TEST_ADD (suitename, "gnc pricedb remove old prices events", PriceDBFixture, NULL, setup, test_gnc_pricedb_remove_old_prices_events, teardown);
 // GNC_TEST_ADD (suitename, "price list from hashtable", Fixture, NULL, setup, test_price_list_from_hashtable, teardown);
 // GNC_TEST_ADD (suitename, "pricedb get prices internal", Fixture, NULL, setup, test_pricedb_get_prices_internal, teardown);
     GNC_TEST_ADD (suitename, "gnc pricedb lookup latest", PriceDBFixture, NULL, setup, test_gnc_pricedb_lookup_latest, teardown);
@@ -1568,14 +1892,18 @@ test_suite_gnc_pricedb (void)
 // GNC_TEST_ADD (suitename, "add nearest price", Fixture, NULL, setup, test_add_nearest_price, teardown);
 // GNC_TEST_ADD (suitename, "nearest to", Fixture, NULL, setup, test_nearest_to, teardown);
     GNC_TEST_ADD (suitename, "gnc pricedb lookup latest any currency", PriceDBFixture, NULL, setup, test_gnc_pricedb_lookup_latest_any_currency, teardown);
+    GNC_TEST_ADD (suitename, "gnc pricedb lookup latest any currency index", PriceDBFixture, NULL, setup, test_gnc_pricedb_lookup_latest_any_currency_index, teardown);
     GNC_TEST_ADD (suitename, "gnc pricedb lookup nearest in time any currency", PriceDBFixture, NULL, setup, test_gnc_pricedb_lookup_nearest_in_time_any_currency_t64, teardown);
     GNC_TEST_ADD (suitename, "gnc pricedb lookup latest before any currency", PriceDBFixture, NULL, setup, test_gnc_pricedb_lookup_latest_before_any_currency_t64, teardown);
 // GNC_TEST_ADD (suitename, "hash values helper", PriceDBFixture, NULL, setup, test_hash_values_helper, teardown);
     GNC_TEST_ADD (suitename, "gnc pricedb has prices", PriceDBFixture, NULL, setup, test_gnc_pricedb_has_prices, teardown);
     GNC_TEST_ADD (suitename, "gnc pricedb get prices", PriceDBFixture, NULL, setup, test_gnc_pricedb_get_prices, teardown);
+    GNC_TEST_ADD (suitename, "gnc pricedb nth price", PriceDBFixture, NULL, setup, test_gnc_pricedb_nth_price, teardown);
     GNC_TEST_ADD (suitename, "gnc pricedb lookup day", PriceDBFixture, NULL, setup, test_gnc_pricedb_lookup_day_t64, teardown);
 // GNC_TEST_ADD (suitename, "lookup nearest in time", Fixture, NULL, setup, test_lookup_nearest_in_time, teardown);
     GNC_TEST_ADD (suitename, "gnc pricedb lookup nearest in time", PriceDBFixture, NULL, setup, test_gnc_pricedb_lookup_nearest_in_time64, teardown);
+    GNC_TEST_ADD (suitename, "gnc pricedb lookup at time", PriceDBFixture, NULL, setup, test_gnc_pricedb_lookup_at_time64, teardown);
+    GNC_TEST_ADD (suitename, "gnc pricedb lookup latest before", PriceDBFixture, NULL, setup, test_gnc_pricedb_lookup_latest_before_t64, teardown);
 // GNC_TEST_ADD (suitename, "direct balance conversion", Fixture, NULL, setup, test_direct_balance_conversion, teardown);
 // GNC_TEST_ADD (suitename, "extract common prices", Fixture, NULL, setup, test_extract_common_prices, teardown);
 // GNC_TEST_ADD (suitename, "convert balance", Fixture, NULL, setup, test_convert_balance, teardown);
@@ -1584,6 +1912,8 @@ test_suite_gnc_pricedb (void)
     GNC_TEST_ADD (suitename, "gnc pricedb convert balance nearest price", PriceDBFixture, NULL, setup, test_gnc_pricedb_convert_balance_nearest_price_t64, teardown);
     GNC_TEST_ADD (suitename, "gnc pricedb get latest price", PriceDBFixture, NULL, setup, test_gnc_pricedb_get_latest_price, teardown);
     GNC_TEST_ADD (suitename, "gnc pricedb get nearest price", PriceDBFixture, NULL, setup, test_gnc_pricedb_get_nearest_price, teardown);
+    GNC_TEST_ADD (suitename, "gnc pricedb get nearest price new path", PriceDBFixture, NULL, setup, test_gnc_pricedb_get_nearest_price_new_path, teardown);
+    GNC_TEST_ADD (suitename, "gnc pricedb build price table", PriceDBFixture, NULL, setup, test_gnc_pricedb_build_price_table, teardown);
 // GNC_TEST_ADD (suitename, "pricedb foreach pricelist", Fixture, NULL, setup, test_pricedb_foreach_pricelist, teardown);
 // GNC_TEST_ADD (suitename, "pricedb foreach currencies hash", Fixture, NULL, setup, test_pricedb_foreach_currencies_hash, teardown);
 // GNC_TEST_ADD (suitename, "unstable price traversal", Fixture, NULL, setup, test_unstable_price_traversal, teardown);